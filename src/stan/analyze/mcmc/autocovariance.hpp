@@ -74,17 +74,17 @@ void autocorrelation(const Eigen::MatrixBase<DerivedA>& y,
  * <p>The implementation involves a fast Fourier transform,
  * followed by a normalization, followed by an inverse transform.
  *
- * <p>This method is just a light wrapper around the three-argument
- * autocovariance function
+ * <p>Reusing the FFT engine across calls saves setting up the
+ * transform plans again for sequences of the same length.
  *
  * @tparam T Scalar type.
  * @param y Input sequence.
  * @param acov Autocovariances.
+ * @param fft FFT engine instance.
  */
 template <typename T, typename DerivedA, typename DerivedB>
 void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
-                    Eigen::MatrixBase<DerivedB>& acov) {
-  Eigen::FFT<T> fft;
+                    Eigen::MatrixBase<DerivedB>& acov, Eigen::FFT<T>& fft) {
   autocorrelation(y, acov, fft);
 
   using boost::accumulators::accumulator_set;
@@ -99,6 +99,29 @@ void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
   acov = acov.array() * boost::accumulators::variance(acc);
 }
 
+/**
+ * Write autocovariance estimates for every lag for the specified
+ * input sequence into the specified result.  Normalizes lag-k
+ * autocovariance estimators by N instead of (N - k), yielding biased
+ * but more stable estimators as discussed in Geyer (1992); see
+ * https://projecteuclid.org/euclid.ss/1177011137. The return vector
+ * will be resized to the same length as the input sequence with
+ * lags given by array index.
+ *
+ * <p>This method is just a light wrapper around the three-argument
+ * autocovariance function, using a new FFT engine for every call.
+ *
+ * @tparam T Scalar type.
+ * @param y Input sequence.
+ * @param acov Autocovariances.
+ */
+template <typename T, typename DerivedA, typename DerivedB>
+void autocovariance(const Eigen::MatrixBase<DerivedA>& y,
+                    Eigen::MatrixBase<DerivedB>& acov) {
+  Eigen::FFT<T> fft;
+  autocovariance(y, acov, fft);
+}
+
 /**
  * Write autocovariance estimates for every lag for the specified
  * input sequence into the specified result using the specified FFT
@@ -0,0 +1,171 @@
+#ifndef STAN_ANALYZE_MCMC_AUTOCOVARIANCE_ENGINE_HPP
+#define STAN_ANALYZE_MCMC_AUTOCOVARIANCE_ENGINE_HPP
+
+#include <stan/math/prim.hpp>
+#include <boost/accumulators/accumulators.hpp>
+#include <boost/accumulators/statistics/stats.hpp>
+#include <boost/accumulators/statistics/variance.hpp>
+#include <unsupported/Eigen/FFT>
+#include <complex>
+#include <map>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Computes autocovariance estimates as <code>autocovariance</code> does,
+ * keeping everything a call sets up for reuse by later calls.  The FFT
+ * plans are kept by the FFT engine and the zero padded signal and
+ * spectrum buffers are kept per padded length, so repeatedly summarizing
+ * chains of the same lengths does not set them up again.
+ *
+ * Several sequences of the same length can be processed in one call.
+ * They are transformed two at a time, as the real and imaginary parts
+ * of a single complex signal, which halves the number of transforms.
+ *
+ * An engine must not be used from several threads at once; give each
+ * thread its own.
+ */
+class autocovariance_engine {
+ public:
+  /**
+   * Write autocovariance estimates for every lag of the specified
+   * sequence into the specified result, as the two-argument
+   * <code>autocovariance</code> function does.
+   *
+   * @tparam Derived type of the input sequence
+   * @param[in] y input sequence
+   * @param[out] acov autocovariances, resized to the length of the
+   *   sequence with lags given by index
+   */
+  template <typename Derived>
+  void autocovariance(const Eigen::MatrixBase<Derived>& y,
+                      Eigen::VectorXd& acov) {
+    acov.resize(y.size());
+    if (y.size() > 0)
+      compute_one(y, acov);
+  }
+
+  /**
+   * Write autocovariance estimates for every lag of each of the
+   * specified sequences, one per column, into the matching column of
+   * the result.
+   *
+   * @tparam Derived type of the input sequences
+   * @param[in] ys input sequences, one per column
+   * @param[out] acovs autocovariances, resized to the size of the input
+   */
+  template <typename Derived>
+  void autocovariances(const Eigen::MatrixBase<Derived>& ys,
+                       Eigen::MatrixXd& acovs) {
+    const Eigen::Index N = ys.rows();
+    const Eigen::Index num_sequences = ys.cols();
+    acovs.resize(N, num_sequences);
+    if (N == 0)
+      return;
+    buffers& b = buffers_for(N);
+    const Eigen::Index L = b.packed.size();
+
+    Eigen::Index col = 0;
+    for (; col + 1 < num_sequences; col += 2) {
+      b.packed.setZero();
+      b.packed.head(N).real() = ys.col(col).array() - ys.col(col).mean();
+      b.packed.head(N).imag()
+          = ys.col(col + 1).array() - ys.col(col + 1).mean();
+      fft_.fwd(b.freq, b.packed);
+
+      // Separate the spectra of the real and imaginary parts, X_k =
+      // (Z_k + conj(Z_{L-k})) / 2 and Y_k = (Z_k - conj(Z_{L-k})) / 2i,
+      // and pack their power spectra back into one complex signal.
+      for (Eigen::Index k = 0; k < L; ++k) {
+        std::complex<double> z = b.freq(k);
+        std::complex<double> z_conj = std::conj(b.freq(k == 0 ? 0 : L - k));
+        b.power(k) = std::complex<double>(std::norm(z + z_conj) / 4,
+                                          std::norm(z - z_conj) / 4);
+      }
+      fft_.inv(b.result, b.power);
+
+      acovs.col(col) = b.result.head(N).real();
+      acovs.col(col) *= variance(ys.col(col)) / acovs(0, col);
+      acovs.col(col + 1) = b.result.head(N).imag();
+      acovs.col(col + 1) *= variance(ys.col(col + 1)) / acovs(0, col + 1);
+    }
+    if (col < num_sequences)
+      compute_one(ys.col(col), acovs.col(col));
+  }
+
+  /**
+   * Return the number of padded lengths buffers are kept for.
+   */
+  size_t num_cached_lengths() const noexcept { return buffers_.size(); }
+
+  /**
+   * Release the buffers and plans of every length.
+   */
+  void clear() {
+    buffers_.clear();
+    fft_ = Eigen::FFT<double>();
+  }
+
+ private:
+  struct buffers {
+    Eigen::VectorXd signal;
+    Eigen::VectorXcd packed;
+    Eigen::VectorXcd freq;
+    Eigen::VectorXcd power;
+    Eigen::VectorXcd result;
+  };
+
+  Eigen::FFT<double> fft_;
+  std::map<size_t, buffers> buffers_;
+
+  buffers& buffers_for(size_t N) {
+    const size_t Mt2 = 2 * math::internal::fft_next_good_size(N);
+    buffers& b = buffers_[Mt2];
+    if (b.signal.size() == 0) {
+      b.signal.resize(Mt2);
+      b.packed.resize(Mt2);
+      b.freq.resize(Mt2);
+      b.power.resize(Mt2);
+      b.result.resize(Mt2);
+    }
+    return b;
+  }
+
+  /**
+   * Write the autocovariances of a nonempty sequence into a result of
+   * the same length.
+   */
+  template <typename Derived, typename Result>
+  void compute_one(const Eigen::MatrixBase<Derived>& y, Result&& acov) {
+    const Eigen::Index N = y.size();
+    buffers& b = buffers_for(N);
+    b.signal.setZero();
+    b.signal.head(N) = y.array() - y.mean();
+    fft_.fwd(b.freq, b.signal);
+    b.freq = b.freq.cwiseAbs2();
+    fft_.inv(b.result, b.freq);
+
+    acov = b.result.head(N).real() / (N * N * 2);
+    acov /= acov(0);
+    acov *= variance(y);
+  }
+
+  template <typename Derived>
+  static double variance(const Eigen::MatrixBase<Derived>& y) {
+    using boost::accumulators::accumulator_set;
+    using boost::accumulators::stats;
+    using boost::accumulators::tag::variance;
+
+    accumulator_set<double, stats<variance>> acc;
+    for (Eigen::Index n = 0; n < y.size(); ++n) {
+      acc(y(n));
+    }
+    return boost::accumulators::variance(acc);
+  }
+};
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
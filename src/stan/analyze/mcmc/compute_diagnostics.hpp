@@ -0,0 +1,180 @@
+#ifndef STAN_ANALYZE_MCMC_COMPUTE_DIAGNOSTICS_HPP
+#define STAN_ANALYZE_MCMC_COMPUTE_DIAGNOSTICS_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/autocovariance_engine.hpp>
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
+#include <stan/analyze/mcmc/rank_normalization_engine.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Convergence diagnostics of a single parameter.  All of them are
+ * computed from the chains split in half.
+ */
+struct parameter_diagnostics {
+  /**
+   * Split effective sample size
+   */
+  double ess = std::numeric_limits<double>::quiet_NaN();
+
+  /**
+   * Split effective sample size of the rank normalized draws
+   */
+  double ess_bulk = std::numeric_limits<double>::quiet_NaN();
+
+  /**
+   * Smaller of the split effective sample sizes of the indicators of
+   * the draws being below the 5% and above the 95% quantile
+   */
+  double ess_tail = std::numeric_limits<double>::quiet_NaN();
+
+  /**
+   * Rank normalized split R-hat
+   */
+  double rhat_bulk = std::numeric_limits<double>::quiet_NaN();
+
+  /**
+   * Rank normalized split R-hat of the absolute deviations from the
+   * median
+   */
+  double rhat_tail = std::numeric_limits<double>::quiet_NaN();
+};
+
+namespace internal {
+
+/**
+ * Buffers reused by a thread across the parameters it summarizes.
+ */
+struct diagnostics_workspace {
+  autocovariance_engine engine;
+  Eigen::MatrixXd split;
+  Eigen::MatrixXd transformed;
+  Eigen::MatrixXd ranks;
+  rank_normalization_engine ranker;
+  std::vector<const double*> columns;
+  std::vector<size_t> sizes;
+
+  double ess(const Eigen::MatrixXd& chains) {
+    columns.resize(chains.cols());
+    for (Eigen::Index chain = 0; chain < chains.cols(); ++chain)
+      columns[chain] = chains.col(chain).data();
+    sizes.assign(chains.cols(), chains.rows());
+    return compute_effective_sample_size(columns, sizes, engine);
+  }
+};
+
+/**
+ * Compute the diagnostics of one parameter from its split chains,
+ * stored one half chain per column of <code>ws.split</code>.
+ */
+inline parameter_diagnostics compute_split_diagnostics(
+    diagnostics_workspace& ws) {
+  parameter_diagnostics result;
+  const Eigen::MatrixXd& split = ws.split;
+  if (split.size() == 0 || !split.allFinite())
+    return result;
+  bool all_const = true;
+  for (Eigen::Index chain = 0; chain < split.cols(); ++chain)
+    all_const &= split.col(chain).isApproxToConstant(split(0, chain));
+  if (all_const && split.row(0).isApproxToConstant(split(0, 0)))
+    return result;
+
+  result.ess = ws.ess(split);
+
+  ws.ranker.rank_transform(split, ws.ranks);
+  result.rhat_bulk = rhat(ws.ranks);
+  result.ess_bulk = ws.ess(ws.ranks);
+
+  ws.ranker.folded_rank_transform(ws.ranks);
+  result.rhat_tail = rhat(ws.ranks);
+
+  double lower = ws.ranker.quantile(0.05);
+  double upper = ws.ranker.quantile(0.95);
+  ws.transformed = (split.array() <= lower).cast<double>();
+  double ess_lower = ws.ess(ws.transformed);
+  ws.transformed = (split.array() >= upper).cast<double>();
+  double ess_upper = ws.ess(ws.transformed);
+  result.ess_tail = std::min(ess_lower, ess_upper);
+  return result;
+}
+
+}  // namespace internal
+
+/**
+ * Computes the split effective sample size, the bulk and tail effective
+ * sample sizes and the bulk and tail rank normalized split R-hat of
+ * every parameter, summarizing the parameters in parallel.  Based on
+ * paper https://arxiv.org/abs/1903.08008
+ *
+ * Each thread keeps its own autocovariance and rank normalization
+ * engines and buffers, reused for all of the parameters it summarizes.
+ * The rank transform of a parameter is shared by its bulk R-hat and
+ * bulk effective sample size, and its sorted draws by its tail R-hat
+ * and tail quantiles.
+ * The split effective sample size and R-hat match
+ * <code>compute_split_effective_sample_size</code> and
+ * <code>compute_split_potential_scale_reduction_rank</code>.
+ *
+ * Chains are trimmed from the back to match the length of the shortest
+ * chain.  When the number of draws N is odd, the (N+1)/2th draw is
+ * ignored.  All diagnostics of a parameter are NaN if any of its draws
+ * is not finite or if all of its draws are equal.
+ *
+ * @param draws draws of each chain, one row per draw and one column per
+ *   parameter, as in the samples of a <code>stan_csv</code>
+ * @return diagnostics of each parameter
+ * @throw std::invalid_argument if the chains have different numbers of
+ *   parameters
+ */
+inline std::vector<parameter_diagnostics> compute_diagnostics(
+    const std::vector<Eigen::MatrixXd>& draws) {
+  if (draws.empty())
+    return {};
+  const Eigen::Index num_params = draws[0].cols();
+  Eigen::Index num_draws = draws[0].rows();
+  for (const Eigen::MatrixXd& chain : draws) {
+    if (chain.cols() != num_params)
+      throw std::invalid_argument(
+          "compute_diagnostics: chains have different numbers of parameters");
+    num_draws = std::min(num_draws, chain.rows());
+  }
+  const Eigen::Index num_chains = draws.size();
+  const Eigen::Index half = num_draws / 2;
+  const Eigen::Index second_half = num_draws - half;
+
+  std::vector<parameter_diagnostics> result(num_params);
+  tbb::enumerable_thread_specific<internal::diagnostics_workspace> workspaces;
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, num_params),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        internal::diagnostics_workspace& ws = workspaces.local();
+        ws.split.resize(half, 2 * num_chains);
+        for (Eigen::Index param = r.begin(); param != r.end(); ++param) {
+          for (Eigen::Index chain = 0; chain < num_chains; ++chain) {
+            const Eigen::MatrixXd& chain_draws = draws[chain];
+            ws.split.col(2 * chain) = chain_draws.col(param).head(half);
+            ws.split.col(2 * chain + 1)
+                = chain_draws.col(param).segment(second_half, half);
+          }
+          result[param] = internal::compute_split_diagnostics(ws);
+        }
+      });
+  return result;
+}
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
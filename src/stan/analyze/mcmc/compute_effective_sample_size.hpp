@@ -2,7 +2,7 @@
 #define STAN_ANALYZE_MCMC_COMPUTE_EFFECTIVE_SAMPLE_SIZE_HPP
 
 #include <stan/math/prim/fun/Eigen.hpp>
-#include <stan/analyze/mcmc/autocovariance.hpp>
+#include <stan/analyze/mcmc/autocovariance_engine.hpp>
 #include <stan/analyze/mcmc/split_chains.hpp>
 #include <algorithm>
 #include <cmath>
@@ -27,10 +27,13 @@ namespace analyze {
  *
  * @param draws stores pointers to arrays of chains
  * @param sizes stores sizes of chains
+ * @param engine engine used for the autocovariances, which can be
+ *   reused across calls
  * @return effective sample size for the specified parameter
  */
-inline double compute_effective_sample_size(std::vector<const double*> draws,
-                                            std::vector<size_t> sizes) {
+inline double compute_effective_sample_size(
+    const std::vector<const double*>& draws, const std::vector<size_t>& sizes,
+    autocovariance_engine& engine) {
   int num_chains = sizes.size();
   size_t num_draws = sizes[0];
   for (int chain = 1; chain < num_chains; ++chain) {
@@ -71,12 +74,27 @@ inline double compute_effective_sample_size(std::vector<const double*> draws,
   }
 
   Eigen::Matrix<Eigen::VectorXd, Eigen::Dynamic, 1> acov(num_chains);
+  if (std::all_of(sizes.begin(), sizes.end(),
+                  [&](size_t size) { return size == sizes[0]; })) {
+    Eigen::MatrixXd chains(sizes[0], num_chains);
+    for (int chain = 0; chain < num_chains; ++chain)
+      chains.col(chain) = Eigen::Map<const Eigen::VectorXd>(draws[chain],
+                                                            sizes[chain]);
+    Eigen::MatrixXd acovs;
+    engine.autocovariances(chains, acovs);
+    for (int chain = 0; chain < num_chains; ++chain)
+      acov(chain) = acovs.col(chain);
+  } else {
+    for (int chain = 0; chain < num_chains; ++chain)
+      engine.autocovariance(
+          Eigen::Map<const Eigen::VectorXd>(draws[chain], sizes[chain]),
+          acov(chain));
+  }
   Eigen::VectorXd chain_mean(num_chains);
   Eigen::VectorXd chain_var(num_chains);
   for (int chain = 0; chain < num_chains; ++chain) {
     Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, 1>> draw(
         draws[chain], sizes[chain]);
-    autocovariance<double>(draw, acov(chain));
     chain_mean(chain) = draw.mean();
     chain_var(chain) = acov(chain)(0) * num_draws / (num_draws - 1);
   }
@@ -137,6 +155,30 @@ inline double compute_effective_sample_size(std::vector<const double*> draws,
                   num_total_draws * std::log10(num_total_draws));
 }
 
+/**
+ * Computes the effective sample size (ESS) for the specified
+ * parameter across all kept samples.  The value returned is the
+ * minimum of ESS and the number_total_draws *
+ * log10(number_total_draws).
+ *
+ * See more details in Stan reference manual section "Effective
+ * Sample Size". http://mc-stan.org/users/documentation
+ *
+ * Current implementation assumes draws are stored in contiguous
+ * blocks of memory.  Chains are trimmed from the back to match the
+ * length of the shortest chain.  Note that the effective sample size
+ * can not be estimated with less than four draws.
+ *
+ * @param draws stores pointers to arrays of chains
+ * @param sizes stores sizes of chains
+ * @return effective sample size for the specified parameter
+ */
+inline double compute_effective_sample_size(std::vector<const double*> draws,
+                                            std::vector<size_t> sizes) {
+  autocovariance_engine engine;
+  return compute_effective_sample_size(draws, sizes, engine);
+}
+
 /**
  * Computes the effective sample size (ESS) for the specified
  * parameter across all kept samples.  The value returned is the
@@ -0,0 +1,114 @@
+#ifndef STAN_ANALYZE_MCMC_COMPUTE_MANY_CHAIN_EFFECTIVE_SAMPLE_SIZE_HPP
+#define STAN_ANALYZE_MCMC_COMPUTE_MANY_CHAIN_EFFECTIVE_SAMPLE_SIZE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Computes the effective sample size (ESS) of a parameter from many
+ * short chains, as <code>compute_effective_sample_size</code> does.  The
+ * value returned is the minimum of ESS and the number_total_draws *
+ * log10(number_total_draws).
+ *
+ * See more details in Stan reference manual section "Effective
+ * Sample Size". http://mc-stan.org/users/documentation
+ *
+ * The draws are a single matrix with one column per chain, which may be
+ * a map of the output of a sampler rather than a copy.  Only the
+ * autocovariances averaged over the chains enter the estimate, so
+ * instead of transforming each chain this computes them directly, one
+ * lag at a time for all chains at once and only up to the lag where
+ * Geyer's initial positive sequence ends.  With hundreds of chains of a
+ * few hundred draws that lag is short and each lag is a single pass
+ * over the draws.  The draws are not split.  Note that the effective
+ * sample size can not be estimated with less than four draws.
+ *
+ * @param draws draws of a parameter, one row per draw and one column per
+ *   chain
+ * @return effective sample size for the specified parameter
+ */
+inline double compute_many_chain_effective_sample_size(
+    const Eigen::Ref<const Eigen::MatrixXd>& draws) {
+  const Eigen::Index num_draws = draws.rows();
+  const Eigen::Index num_chains = draws.cols();
+  if (num_draws < 4 || num_chains == 0 || !draws.allFinite())
+    return std::numeric_limits<double>::quiet_NaN();
+
+  // If some chain is constant and all chains start from the same value,
+  // return NaN as compute_effective_sample_size does
+  bool are_all_const = false;
+  for (Eigen::Index chain = 0; chain < num_chains; ++chain)
+    are_all_const |= draws.col(chain).isApproxToConstant(draws(0, chain));
+  if (are_all_const && draws.row(0).isApproxToConstant(draws(0, 0)))
+    return std::numeric_limits<double>::quiet_NaN();
+
+  const Eigen::RowVectorXd chain_mean = draws.colwise().mean();
+  const Eigen::MatrixXd centered = draws.rowwise() - chain_mean;
+  const double scale = 1.0 / (num_draws * num_chains);
+  // autocovariance at lag t averaged over the chains, with the "biased"
+  // normalization of autocovariance
+  auto mean_acov = [&](Eigen::Index t) {
+    return centered.topRows(num_draws - t)
+               .cwiseProduct(centered.bottomRows(num_draws - t))
+               .sum()
+           * scale;
+  };
+
+  double mean_var = mean_acov(0) * num_draws / (num_draws - 1);
+  double var_plus = mean_var * (num_draws - 1) / num_draws;
+  if (num_chains > 1)
+    var_plus += (chain_mean.array() - chain_mean.mean()).square().sum()
+                / (num_chains - 1);
+  Eigen::VectorXd rho_hat_s = Eigen::VectorXd::Zero(num_draws);
+  double rho_hat_even = 1.0;
+  rho_hat_s(0) = rho_hat_even;
+  double rho_hat_odd = 1 - (mean_var - mean_acov(1)) / var_plus;
+  rho_hat_s(1) = rho_hat_odd;
+
+  // Convert raw autocovariance estimators into Geyer's initial
+  // positive sequence. Loop only until num_draws - 4 to
+  // leave the last pair of autocorrelations as a bias term that
+  // reduces variance in the case of antithetical chains.
+  Eigen::Index s = 1;
+  while (s < (num_draws - 4) && (rho_hat_even + rho_hat_odd) > 0) {
+    rho_hat_even = 1 - (mean_var - mean_acov(s + 1)) / var_plus;
+    rho_hat_odd = 1 - (mean_var - mean_acov(s + 2)) / var_plus;
+    if ((rho_hat_even + rho_hat_odd) >= 0) {
+      rho_hat_s(s + 1) = rho_hat_even;
+      rho_hat_s(s + 2) = rho_hat_odd;
+    }
+    s += 2;
+  }
+
+  Eigen::Index max_s = s;
+  // this is used in the improved estimate, which reduces variance
+  // in antithetic case -- see tau_hat below
+  if (rho_hat_even > 0)
+    rho_hat_s(max_s + 1) = rho_hat_even;
+
+  // Convert Geyer's initial positive sequence into an initial
+  // monotone sequence
+  for (Eigen::Index s = 1; s <= max_s - 3; s += 2) {
+    if (rho_hat_s(s + 1) + rho_hat_s(s + 2) > rho_hat_s(s - 1) + rho_hat_s(s)) {
+      rho_hat_s(s + 1) = (rho_hat_s(s - 1) + rho_hat_s(s)) / 2;
+      rho_hat_s(s + 2) = rho_hat_s(s + 1);
+    }
+  }
+
+  double num_total_draws = num_chains * num_draws;
+  // Geyer's truncated estimator for the asymptotic variance
+  // Improved estimate reduces variance in antithetic case
+  double tau_hat = -1 + 2 * rho_hat_s.head(max_s).sum() + rho_hat_s(max_s + 1);
+  return std::min(num_total_draws / tau_hat,
+                  num_total_draws * std::log10(num_total_draws));
+}
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
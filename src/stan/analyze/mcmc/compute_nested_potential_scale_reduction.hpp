@@ -0,0 +1,193 @@
+#ifndef STAN_ANALYZE_MCMC_COMPUTE_NESTED_POTENTIAL_SCALE_REDUCTION_HPP
+#define STAN_ANALYZE_MCMC_COMPUTE_NESTED_POTENTIAL_SCALE_REDUCTION_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace stan {
+namespace analyze {
+namespace internal {
+
+/**
+ * Computes nested R-hat from the means and variances of the chains,
+ * grouped into superchains of consecutive chains.
+ *
+ * @param chain_means mean of each chain
+ * @param chain_vars variance of each chain, zero for chains of one draw
+ * @param num_superchains number of superchains, which divides the number
+ *   of chains
+ * @return nested potential scale reduction
+ */
+inline double nested_rhat(
+    const Eigen::Ref<const Eigen::RowVectorXd>& chain_means,
+    const Eigen::Ref<const Eigen::RowVectorXd>& chain_vars,
+    Eigen::Index num_superchains) {
+  const Eigen::Index chains_per = chain_means.size() / num_superchains;
+  Eigen::Map<const Eigen::MatrixXd> means(chain_means.data(), chains_per,
+                                          num_superchains);
+  Eigen::Map<const Eigen::MatrixXd> vars(chain_vars.data(), chains_per,
+                                         num_superchains);
+  const Eigen::RowVectorXd super_means = means.colwise().mean();
+  const double between
+      = (super_means.array() - super_means.mean()).square().sum()
+        / (num_superchains - 1);
+  double within = vars.mean();
+  if (chains_per > 1)
+    within += (means.rowwise() - super_means).array().square().sum()
+              / ((chains_per - 1) * num_superchains);
+  if (!(within > 0))
+    return std::numeric_limits<double>::quiet_NaN();
+  return std::sqrt(1 + between / within);
+}
+
+inline void check_superchains(Eigen::Index num_chains,
+                              Eigen::Index num_superchains,
+                              const char* function) {
+  if (num_superchains < 2 || num_chains % num_superchains != 0)
+    throw std::invalid_argument(
+        std::string(function) + ": the " + std::to_string(num_chains)
+        + " chains can not be grouped into "
+        + std::to_string(num_superchains)
+        + " superchains; there must be at least two superchains of the same"
+          " number of chains");
+}
+
+}  // namespace internal
+
+/**
+ * Computes the nested potential scale reduction (nested R-hat) of a
+ * parameter from many chains grouped into superchains, as in
+ * Margossian et al. (2023), https://arxiv.org/abs/2110.13017.  Chains of
+ * a superchain start from the same point, so nested R-hat compares the
+ * superchains, and unlike R-hat it tends to one as the number of chains
+ * grows even when each chain is short.
+ *
+ * The draws are a single matrix with one column per chain, which may be
+ * a map of the output of a sampler rather than a copy, and superchain
+ * <code>k</code> is the columns <code>k * M</code> to
+ * <code>(k + 1) * M - 1</code> for <code>M</code> chains per superchain.
+ * The chain means and variances are computed for all chains at once.
+ * The draws are not split.
+ *
+ * @param draws draws of a parameter, one row per draw and one column per
+ *   chain
+ * @param num_superchains number of superchains
+ * @return nested potential scale reduction, or NaN if a draw is not
+ *   finite or the draws do not vary within superchains
+ * @throw std::invalid_argument if there are fewer than two superchains
+ *   or they can not have the same number of chains
+ */
+inline double compute_nested_potential_scale_reduction(
+    const Eigen::Ref<const Eigen::MatrixXd>& draws,
+    Eigen::Index num_superchains) {
+  internal::check_superchains(draws.cols(), num_superchains,
+                              "compute_nested_potential_scale_reduction");
+  const Eigen::Index num_draws = draws.rows();
+  if (num_draws == 0 || !draws.allFinite())
+    return std::numeric_limits<double>::quiet_NaN();
+  const Eigen::RowVectorXd chain_means = draws.colwise().mean();
+  Eigen::RowVectorXd chain_vars = Eigen::RowVectorXd::Zero(draws.cols());
+  if (num_draws > 1)
+    chain_vars
+        = (draws.rowwise() - chain_means).array().square().colwise().sum()
+          / (num_draws - 1);
+  return internal::nested_rhat(chain_means, chain_vars, num_superchains);
+}
+
+/**
+ * <code>nested_rhat_accumulator</code> keeps the running means and
+ * variances of every parameter in every chain of an ensemble, from
+ * which the nested R-hat of each parameter is available after any
+ * number of draws.  It takes the positions of all chains at once, as
+ * samplers that advance their chains in lockstep hold them, so
+ * convergence can be monitored while they run without storing the
+ * draws.
+ *
+ * The running moments are updated with Welford's algorithm for all
+ * parameters and chains together.
+ */
+class nested_rhat_accumulator {
+ public:
+  /**
+   * @param num_params number of parameters
+   * @param num_chains number of chains
+   * @param num_superchains number of superchains, grouping consecutive
+   *   chains
+   * @throw std::invalid_argument if there are fewer than two superchains
+   *   or they can not have the same number of chains
+   */
+  nested_rhat_accumulator(Eigen::Index num_params, Eigen::Index num_chains,
+                          Eigen::Index num_superchains)
+      : num_superchains_(num_superchains),
+        num_draws_(0),
+        means_(Eigen::MatrixXd::Zero(num_params, num_chains)),
+        m2_(Eigen::MatrixXd::Zero(num_params, num_chains)),
+        delta_(num_params, num_chains) {
+    internal::check_superchains(num_chains, num_superchains,
+                                "nested_rhat_accumulator");
+  }
+
+  /**
+   * Add a draw of every chain.
+   *
+   * @param q position of each chain, one row per parameter and one
+   *   column per chain
+   * @throw std::invalid_argument if the positions have the wrong size
+   */
+  void add(const Eigen::Ref<const Eigen::MatrixXd>& q) {
+    if (q.rows() != means_.rows() || q.cols() != means_.cols())
+      throw std::invalid_argument(
+          "nested_rhat_accumulator: positions have the wrong size");
+    ++num_draws_;
+    delta_ = q - means_;
+    means_ += delta_ / static_cast<double>(num_draws_);
+    m2_.array() += delta_.array() * (q - means_).array();
+  }
+
+  /**
+   * Return the number of draws added to each chain.
+   */
+  size_t num_draws() const noexcept { return num_draws_; }
+
+  /**
+   * Return the nested R-hat of each parameter over the draws added so
+   * far, NaN for parameters that do not vary within superchains.
+   */
+  Eigen::VectorXd rhat() const {
+    Eigen::VectorXd result(means_.rows());
+    Eigen::RowVectorXd vars(means_.cols());
+    for (Eigen::Index param = 0; param < means_.rows(); ++param) {
+      if (num_draws_ > 1)
+        vars = m2_.row(param) / (num_draws_ - 1.0);
+      else
+        vars.setZero();
+      result(param)
+          = internal::nested_rhat(means_.row(param), vars, num_superchains_);
+    }
+    return result;
+  }
+
+  /**
+   * Forget all draws.
+   */
+  void reset() {
+    num_draws_ = 0;
+    means_.setZero();
+    m2_.setZero();
+  }
+
+ private:
+  Eigen::Index num_superchains_;
+  size_t num_draws_;
+  Eigen::MatrixXd means_;
+  Eigen::MatrixXd m2_;
+  Eigen::MatrixXd delta_;
+};
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stan/math/prim.hpp>
 #include <stan/analyze/mcmc/autocovariance.hpp>
+#include <stan/analyze/mcmc/rank_normalization_engine.hpp>
 #include <stan/analyze/mcmc/split_chains.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
@@ -21,15 +22,24 @@ namespace analyze {
  * Computes normalized average ranks for draws. Transforming them to normal
  * scores using inverse normal transformation and a fractional offset. Based on
  * paper https://arxiv.org/abs/1903.08008
+ *
+ * The sort buffer and the result are passed in so that they can be reused
+ * across parameters.
+ *
  * @param chains stores chains in columns
- * @return normal scores for average ranks of draws
+ * @param value_with_index sort buffer, resized as needed
+ * @param rank_matrix normal scores for average ranks of draws, resized to
+ *   the size of chains
  */
-inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
+inline void rank_transform(
+    const Eigen::MatrixXd& chains,
+    std::vector<std::pair<double, int>>& value_with_index,
+    Eigen::MatrixXd& rank_matrix) {
   const Eigen::Index rows = chains.rows();
   const Eigen::Index cols = chains.cols();
   const Eigen::Index size = rows * cols;
 
-  std::vector<std::pair<double, int>> value_with_index(size);
+  value_with_index.resize(size);
 
   for (Eigen::Index i = 0; i < size; ++i) {
     value_with_index[i] = {chains(i), i};
@@ -37,7 +47,7 @@ inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
 
   std::sort(value_with_index.begin(), value_with_index.end());
 
-  Eigen::MatrixXd rank_matrix = Eigen::MatrixXd::Zero(rows, cols);
+  rank_matrix.resize(rows, cols);
 
   // Assigning average ranks
   for (Eigen::Index i = 0; i < size; ++i) {
@@ -60,6 +70,19 @@ inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
     }
     i = j - 1;  // Skip over tied elements
   }
+}
+
+/**
+ * Computes normalized average ranks for draws. Transforming them to normal
+ * scores using inverse normal transformation and a fractional offset. Based on
+ * paper https://arxiv.org/abs/1903.08008
+ * @param chains stores chains in columns
+ * @return normal scores for average ranks of draws
+ */
+inline Eigen::MatrixXd rank_transform(const Eigen::MatrixXd& chains) {
+  rank_normalization_engine engine;
+  Eigen::MatrixXd rank_matrix;
+  engine.rank_transform(chains, rank_matrix);
   return rank_matrix;
 }
 
@@ -159,10 +182,12 @@ inline std::pair<double, double> compute_potential_scale_reduction_rank(
             std::numeric_limits<double>::quiet_NaN()};
   }
 
-  double rhat_bulk = rhat(rank_transform(draws_matrix));
-  double rhat_tail = rhat(rank_transform(
-      (draws_matrix.array() - math::quantile(draws_matrix.reshaped(), 0.5))
-          .abs()));
+  rank_normalization_engine engine;
+  Eigen::MatrixXd ranks;
+  engine.rank_transform(draws_matrix, ranks);
+  double rhat_bulk = rhat(ranks);
+  engine.folded_rank_transform(ranks);
+  double rhat_tail = rhat(ranks);
 
   return std::make_pair(rhat_bulk, rhat_tail);
 }
@@ -0,0 +1,321 @@
+#ifndef STAN_ANALYZE_MCMC_ONLINE_DIAGNOSTICS_HPP
+#define STAN_ANALYZE_MCMC_ONLINE_DIAGNOSTICS_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Streaming estimate of a single quantile with the P-square algorithm
+ * of Jain and Chlamtac (1985), which tracks five markers and uses
+ * constant memory regardless of the number of draws.
+ */
+class p2_quantile {
+ public:
+  explicit p2_quantile(double p) : p_(p), count_(0) {
+    increments_ = {0, p / 2, p, (1 + p) / 2, 1};
+  }
+
+  void add(double x) {
+    if (count_ < 5) {
+      heights_[count_++] = x;
+      if (count_ == 5) {
+        std::sort(heights_.begin(), heights_.end());
+        for (int i = 0; i < 5; ++i) {
+          positions_[i] = i + 1;
+          desired_[i] = 1 + 4 * increments_[i];
+        }
+      }
+      return;
+    }
+    ++count_;
+
+    int k;
+    if (x < heights_[0]) {
+      heights_[0] = x;
+      k = 0;
+    } else if (x >= heights_[4]) {
+      heights_[4] = std::max(heights_[4], x);
+      k = 3;
+    } else {
+      k = 0;
+      while (x >= heights_[k + 1])
+        ++k;
+    }
+    for (int i = k + 1; i < 5; ++i)
+      positions_[i] += 1;
+    for (int i = 0; i < 5; ++i)
+      desired_[i] += increments_[i];
+
+    for (int i = 1; i < 4; ++i) {
+      double d = desired_[i] - positions_[i];
+      if ((d >= 1 && positions_[i + 1] - positions_[i] > 1)
+          || (d <= -1 && positions_[i - 1] - positions_[i] < -1)) {
+        int sign = d > 0 ? 1 : -1;
+        double h = parabolic(i, sign);
+        if (!(heights_[i - 1] < h && h < heights_[i + 1]))
+          h = linear(i, sign);
+        heights_[i] = h;
+        positions_[i] += sign;
+      }
+    }
+  }
+
+  /**
+   * Return the current estimate, exact while fewer than five values have
+   * been added, or NaN if none have.
+   */
+  double value() const {
+    if (count_ == 0)
+      return std::numeric_limits<double>::quiet_NaN();
+    if (count_ >= 5)
+      return heights_[2];
+    std::array<double, 5> sorted = heights_;
+    std::sort(sorted.begin(), sorted.begin() + count_);
+    double index = p_ * (count_ - 1);
+    size_t lo = std::floor(index);
+    size_t hi = std::ceil(index);
+    return sorted[lo] + (index - lo) * (sorted[hi] - sorted[lo]);
+  }
+
+  double probability() const noexcept { return p_; }
+
+ private:
+  double p_;
+  size_t count_;
+  std::array<double, 5> heights_;
+  std::array<double, 5> positions_;
+  std::array<double, 5> desired_;
+  std::array<double, 5> increments_;
+
+  double parabolic(int i, int d) const {
+    return heights_[i]
+           + d / (positions_[i + 1] - positions_[i - 1])
+                 * ((positions_[i] - positions_[i - 1] + d)
+                        * (heights_[i + 1] - heights_[i])
+                        / (positions_[i + 1] - positions_[i])
+                    + (positions_[i + 1] - positions_[i] - d)
+                          * (heights_[i] - heights_[i - 1])
+                          / (positions_[i] - positions_[i - 1]));
+  }
+
+  double linear(int i, int d) const {
+    return heights_[i]
+           + d * (heights_[i + d] - heights_[i])
+                 / (positions_[i + d] - positions_[i]);
+  }
+};
+
+/**
+ * <code>online_diagnostics</code> is a writer that summarizes every
+ * column of the draws it receives without storing them, so that it can
+ * be attached next to the output writer (for instance with a
+ * <code>tee_writer</code>) to get summaries without reading the output
+ * back.  For each column it keeps Welford running moments, streaming
+ * quantile estimates and batch means from which the effective sample
+ * size is estimated.
+ *
+ * The batch means estimator keeps between <code>num_batches</code> and
+ * twice as many completed batches; whenever the upper bound is reached
+ * adjacent batches are merged and the batch size doubles.  The estimate
+ * is the number of draws in completed batches times the ratio of the
+ * draw variance to the batch size times the variance of the batch
+ * means.
+ *
+ * A header resets the summaries.  Comments are ignored, so warmup draws
+ * are included whenever they are written; attach the writer after
+ * warmup or call <code>reset()</code> to exclude them.
+ */
+class online_diagnostics : public callbacks::writer {
+ public:
+  /**
+   * @param[in] probabilities quantiles to track for each column
+   * @param[in] num_batches minimum number of batches kept for the
+   *   effective sample size estimate; must be at least 2
+   */
+  explicit online_diagnostics(
+      const std::vector<double>& probabilities = {0.05, 0.5, 0.95},
+      size_t num_batches = 32)
+      : probabilities_(probabilities), num_batches_(num_batches) {
+    if (num_batches_ < 2)
+      throw std::invalid_argument("num_batches must be at least 2");
+  }
+
+  void operator()(const std::vector<std::string>& names) {
+    names_ = names;
+    columns_.clear();
+  }
+
+  void operator()(const std::vector<double>& state) {
+    if (state.empty())
+      return;
+    if (columns_.empty())
+      columns_.resize(state.size(), column(probabilities_));
+    if (state.size() != columns_.size())
+      throw std::invalid_argument(
+          "online_diagnostics: draws have different numbers of values");
+    for (size_t i = 0; i < state.size(); ++i)
+      columns_[i].add(state[i], num_batches_);
+  }
+
+  /**
+   * Forget all draws, keeping the names.
+   */
+  void reset() { columns_.clear(); }
+
+  const std::vector<std::string>& names() const noexcept { return names_; }
+
+  size_t num_columns() const noexcept { return columns_.size(); }
+
+  size_t num_draws() const noexcept {
+    return columns_.empty() ? 0 : columns_[0].n;
+  }
+
+  double mean(size_t i) const { return columns_.at(i).mean; }
+
+  /**
+   * Return the sample variance of column <code>i</code>, or NaN with
+   * fewer than two draws.
+   */
+  double variance(size_t i) const {
+    const column& c = columns_.at(i);
+    if (c.n < 2)
+      return std::numeric_limits<double>::quiet_NaN();
+    return c.m2 / (c.n - 1);
+  }
+
+  double sd(size_t i) const { return std::sqrt(variance(i)); }
+
+  /**
+   * Return the streaming estimate of the <code>k</code>-th tracked
+   * quantile of column <code>i</code>.
+   */
+  double quantile(size_t i, size_t k) const {
+    return columns_.at(i).quantiles.at(k).value();
+  }
+
+  /**
+   * Return the batch means estimate of the effective sample size of
+   * column <code>i</code>, or NaN until there are at least
+   * <code>num_batches</code> completed batches.  Constant columns have
+   * an effective sample size equal to the number of draws.
+   */
+  double ess(size_t i) const {
+    const column& c = columns_.at(i);
+    size_t k = c.batch_sums.size();
+    if (k < num_batches_)
+      return std::numeric_limits<double>::quiet_NaN();
+    double n = static_cast<double>(k * c.batch_size);
+    double mean = 0;
+    double m2 = 0;
+    for (size_t j = 0; j < k; ++j) {
+      double x = c.batch_sums[j] / c.batch_size;
+      double delta = x - mean;
+      mean += delta / (j + 1);
+      m2 += delta * (x - mean);
+    }
+    double batch_var = m2 / (k - 1);
+    double var = variance(i);
+    if (batch_var == 0 || var == 0)
+      return n;
+    return n * var / (c.batch_size * batch_var);
+  }
+
+ private:
+  struct column {
+    size_t n = 0;
+    double mean = 0;
+    double m2 = 0;
+    std::vector<p2_quantile> quantiles;
+    std::vector<double> batch_sums;
+    size_t batch_size = 1;
+    double partial_sum = 0;
+    size_t partial_count = 0;
+
+    explicit column(const std::vector<double>& probabilities) {
+      for (double p : probabilities)
+        quantiles.emplace_back(p);
+    }
+
+    void add(double x, size_t num_batches) {
+      ++n;
+      double delta = x - mean;
+      mean += delta / n;
+      m2 += delta * (x - mean);
+
+      for (p2_quantile& q : quantiles)
+        q.add(x);
+
+      partial_sum += x;
+      if (++partial_count < batch_size)
+        return;
+      batch_sums.push_back(partial_sum);
+      partial_sum = 0;
+      partial_count = 0;
+      if (batch_sums.size() == 2 * num_batches) {
+        for (size_t j = 0; j < num_batches; ++j)
+          batch_sums[j] = batch_sums[2 * j] + batch_sums[2 * j + 1];
+        batch_sums.resize(num_batches);
+        batch_size *= 2;
+      }
+    }
+  };
+
+  std::vector<double> probabilities_;
+  size_t num_batches_;
+  std::vector<std::string> names_;
+  std::vector<column> columns_;
+};
+
+/**
+ * Return the potential scale reduction of column <code>i</code> over
+ * chains summarized by <code>online_diagnostics</code>, from their running
+ * means and variances.  This is the estimate of Gelman and Rubin (1992),
+ * without the splitting and rank normalization of
+ * <code>compute_potential_scale_reduction</code>, so that it can follow
+ * chains that are still running.  Chains with different numbers of draws
+ * count as many draws as the shortest.
+ *
+ * @param[in] chains summaries of each chain
+ * @param[in] i index of the column
+ * @return square root of ((N-1)/N)W + B/N over W, or NaN with fewer than
+ *   two chains, fewer than two draws in a chain, or constant chains
+ */
+inline double online_potential_scale_reduction(
+    const std::vector<online_diagnostics>& chains, size_t i) {
+  const size_t num_chains = chains.size();
+  if (num_chains < 2)
+    return std::numeric_limits<double>::quiet_NaN();
+  size_t num_draws = chains[0].num_draws();
+  for (const online_diagnostics& chain : chains)
+    num_draws = std::min(num_draws, chain.num_draws());
+  if (num_draws < 2)
+    return std::numeric_limits<double>::quiet_NaN();
+
+  double mean = 0;
+  double m2 = 0;
+  double var_within = 0;
+  for (size_t j = 0; j < num_chains; ++j) {
+    double x = chains[j].mean(i);
+    double delta = x - mean;
+    mean += delta / (j + 1);
+    m2 += delta * (x - mean);
+    var_within += chains[j].variance(i) / num_chains;
+  }
+  if (var_within == 0)
+    return std::numeric_limits<double>::quiet_NaN();
+  double var_between = num_draws * m2 / (num_chains - 1);
+  return std::sqrt((var_between / var_within + num_draws - 1) / num_draws);
+}
+
+}  // namespace analyze
+}  // namespace stan
+#endif
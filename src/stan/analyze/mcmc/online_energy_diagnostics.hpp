@@ -0,0 +1,131 @@
+#ifndef STAN_ANALYZE_MCMC_ONLINE_ENERGY_DIAGNOSTICS_HPP
+#define STAN_ANALYZE_MCMC_ONLINE_ENERGY_DIAGNOSTICS_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * <code>online_energy_diagnostics</code> is a writer that accumulates the
+ * energy diagnostics of a Hamiltonian Monte Carlo chain, the estimated
+ * Bayesian fraction of missing information (E-BFMI) and the rate of
+ * divergent transitions, from its <code>energy__</code> and
+ * <code>divergent__</code> values, without storing them.
+ *
+ * The E-BFMI is the mean squared change of the energy between successive
+ * iterations over its variance,
+ *
+ * <pre>
+ *   sum_{n > 1} (E_n - E_{n-1})^2 / sum_n (E_n - mean(E))^2;
+ * </pre>
+ *
+ * values below 0.3 indicate that the momentum resampling explores the
+ * energy distribution poorly.
+ *
+ * The header locates <code>energy__</code> and <code>divergent__</code>,
+ * so the writer can be fed either the rows of the sample writer or,
+ * every iteration, the names from <code>get_sampler_param_names</code>
+ * and the values from <code>get_sampler_params</code> of the sampler.
+ * A header resets the accumulators; comments are ignored.
+ */
+class online_energy_diagnostics : public callbacks::writer {
+ public:
+  void operator()(const std::vector<std::string>& names) {
+    energy_index_ = -1;
+    divergent_index_ = -1;
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == "energy__")
+        energy_index_ = i;
+      else if (names[i] == "divergent__")
+        divergent_index_ = i;
+    }
+    reset();
+  }
+
+  void operator()(const std::vector<double>& state) {
+    if (state.empty())
+      return;
+    ++num_draws_;
+    if (divergent_index_ >= 0
+        && static_cast<size_t>(divergent_index_) < state.size()
+        && state[divergent_index_] > 0)
+      ++num_divergent_;
+    if (energy_index_ < 0
+        || static_cast<size_t>(energy_index_) >= state.size())
+      return;
+    const double energy = state[energy_index_];
+    if (!std::isfinite(energy))
+      return;
+    if (num_energies_ > 0) {
+      const double change = energy - last_energy_;
+      sum_squared_changes_ += change * change;
+    }
+    last_energy_ = energy;
+    ++num_energies_;
+    const double delta = energy - mean_;
+    mean_ += delta / num_energies_;
+    m2_ += delta * (energy - mean_);
+  }
+
+  /**
+   * Forget all draws, keeping the locations of the columns.
+   */
+  void reset() {
+    num_draws_ = 0;
+    num_divergent_ = 0;
+    num_energies_ = 0;
+    mean_ = 0;
+    m2_ = 0;
+    sum_squared_changes_ = 0;
+  }
+
+  /**
+   * Return the number of draws received since the last reset.
+   */
+  size_t num_draws() const noexcept { return num_draws_; }
+
+  /**
+   * Return the number of divergent transitions.
+   */
+  size_t num_divergent() const noexcept { return num_divergent_; }
+
+  /**
+   * Return the fraction of the draws that are divergent transitions, or
+   * NaN without draws.
+   */
+  double divergence_rate() const {
+    if (num_draws_ == 0)
+      return std::numeric_limits<double>::quiet_NaN();
+    return static_cast<double>(num_divergent_) / num_draws_;
+  }
+
+  /**
+   * Return the E-BFMI of the finite energies, or NaN with fewer than two
+   * of them or if they are all the same.
+   */
+  double ebfmi() const {
+    if (num_energies_ < 2 || !(m2_ > 0))
+      return std::numeric_limits<double>::quiet_NaN();
+    return sum_squared_changes_ / m2_;
+  }
+
+ private:
+  long energy_index_ = -1;
+  long divergent_index_ = -1;
+  size_t num_draws_ = 0;
+  size_t num_divergent_ = 0;
+  size_t num_energies_ = 0;
+  double last_energy_ = 0;
+  double mean_ = 0;
+  double m2_ = 0;
+  double sum_squared_changes_ = 0;
+};
+
+}  // namespace analyze
+}  // namespace stan
+#endif
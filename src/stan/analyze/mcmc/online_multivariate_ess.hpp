@@ -0,0 +1,255 @@
+#ifndef STAN_ANALYZE_MCMC_ONLINE_MULTIVARIATE_ESS_HPP
+#define STAN_ANALYZE_MCMC_ONLINE_MULTIVARIATE_ESS_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * <code>online_multivariate_ess</code> is a writer that estimates the
+ * multivariate effective sample size of Vats, Flegal and Jones (2019) of
+ * the draws it receives without storing them,
+ *
+ * <pre>
+ *   n (det(Lambda) / det(Sigma))^(1 / p),
+ * </pre>
+ *
+ * where <code>Lambda</code> is the covariance of the draws and
+ * <code>Sigma</code> the covariance of their mean times the number of
+ * draws, estimated by batch means.  Unlike the smallest univariate
+ * effective sample size, it accounts for the correlations between the
+ * parameters.
+ *
+ * So that the memory and the time per draw stay small for many
+ * parameters, the estimate is that of a projection of the draws on
+ * <code>num_projections</code> random Gaussian directions, fixed by the
+ * seed, which keeps the cost per draw linear in the number of parameters.
+ * With no more parameters than directions the draws are not projected
+ * and the estimate is exact.  Directions in which the draws do not vary,
+ * such as those of constant columns, are left out of the determinants.
+ *
+ * The batch means are kept as by <code>online_diagnostics</code>: between
+ * <code>num_batches</code> and twice as many completed batches, merged in
+ * pairs whenever the upper bound is reached.
+ *
+ * A header selects the columns whose names do not end in <code>__</code>,
+ * leaving out <code>lp__</code> and the sampler parameters, and resets the
+ * estimate.  Without a header every column is used.  Comments are ignored.
+ */
+class online_multivariate_ess : public callbacks::writer {
+ public:
+  /**
+   * @param[in] num_projections largest number of random directions to
+   *   project the draws on
+   * @param[in] num_batches minimum number of batches kept for the
+   *   estimate; must be at least 2
+   * @param[in] seed seed of the random directions
+   * @throw std::invalid_argument if <code>num_projections</code> is zero
+   *   or <code>num_batches</code> is less than 2
+   */
+  explicit online_multivariate_ess(size_t num_projections = 16,
+                                   size_t num_batches = 32,
+                                   unsigned int seed = 1)
+      : num_projections_(num_projections),
+        num_batches_(num_batches),
+        seed_(seed) {
+    if (num_projections_ == 0)
+      throw std::invalid_argument("num_projections must be positive");
+    if (num_batches_ < 2)
+      throw std::invalid_argument("num_batches must be at least 2");
+  }
+
+  void operator()(const std::vector<std::string>& names) {
+    columns_.clear();
+    for (size_t i = 0; i < names.size(); ++i) {
+      const std::string& name = names[i];
+      if (name.size() < 2 || name.compare(name.size() - 2, 2, "__") != 0)
+        columns_.push_back(i);
+    }
+    has_header_ = true;
+    reset();
+  }
+
+  void operator()(const std::vector<double>& state) {
+    if (state.empty())
+      return;
+    if (!has_header_ && columns_.empty())
+      for (size_t i = 0; i < state.size(); ++i)
+        columns_.push_back(i);
+    if (columns_.empty())
+      return;
+    if (num_draws_ == 0)
+      start(state.size());
+    else if (state.size() != num_values_)
+      throw std::invalid_argument(
+          "online_multivariate_ess: draws have different numbers of values");
+    for (size_t j = 0; j < columns_.size(); ++j)
+      draw_(j) = state[columns_[j]];
+    if (projection_.size() > 0)
+      y_.noalias() = projection_ * draw_;
+    else
+      y_ = draw_;
+
+    ++num_draws_;
+    delta_ = y_ - mean_;
+    mean_ += delta_ / num_draws_;
+    m2_.noalias() += delta_ * (y_ - mean_).transpose();
+
+    partial_sum_ += y_;
+    if (++partial_count_ < batch_size_)
+      return;
+    batch_sums_.push_back(partial_sum_);
+    partial_sum_.setZero();
+    partial_count_ = 0;
+    if (batch_sums_.size() == 2 * num_batches_) {
+      for (size_t j = 0; j < num_batches_; ++j)
+        batch_sums_[j] = batch_sums_[2 * j] + batch_sums_[2 * j + 1];
+      batch_sums_.resize(num_batches_);
+      batch_size_ *= 2;
+    }
+  }
+
+  /**
+   * Forget all draws, keeping the selected columns.
+   */
+  void reset() {
+    num_draws_ = 0;
+    batch_sums_.clear();
+  }
+
+  /**
+   * Return the number of draws received since the last reset.
+   */
+  size_t num_draws() const noexcept { return num_draws_; }
+
+  /**
+   * Return the number of columns of the draws the estimate is of.
+   */
+  size_t num_parameters() const noexcept { return columns_.size(); }
+
+  /**
+   * Return the number of dimensions the draws are projected on, the
+   * number of parameters when they are not projected, or zero before the
+   * first draw.
+   */
+  size_t num_dimensions() const noexcept {
+    return num_draws_ == 0 ? 0 : mean_.size();
+  }
+
+  /**
+   * Return the multivariate effective sample size of the draws, or NaN
+   * until there are at least <code>num_batches</code> completed batches
+   * or if the draws are constant.
+   */
+  double ess() const {
+    const size_t k = batch_sums_.size();
+    if (k < num_batches_)
+      return std::numeric_limits<double>::quiet_NaN();
+    const double n = static_cast<double>(k * batch_size_);
+    const Eigen::Index p = mean_.size();
+
+    Eigen::VectorXd batch_mean = Eigen::VectorXd::Zero(p);
+    Eigen::MatrixXd batch_m2 = Eigen::MatrixXd::Zero(p, p);
+    for (size_t j = 0; j < k; ++j) {
+      Eigen::VectorXd x = batch_sums_[j] / batch_size_;
+      Eigen::VectorXd delta = x - batch_mean;
+      batch_mean += delta / (j + 1);
+      batch_m2.noalias() += delta * (x - batch_mean).transpose();
+    }
+    // covariance of the mean times the number of draws
+    Eigen::MatrixXd sigma = batch_m2 * (batch_size_ / (k - 1.0));
+    Eigen::MatrixXd lambda = m2_ / (num_draws_ - 1.0);
+
+    // whiten by the covariance of the draws in the directions they vary
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> lambda_eigen(lambda);
+    const Eigen::VectorXd& values = lambda_eigen.eigenvalues();
+    const double tol = 1e-12 * values.maxCoeff();
+    std::vector<Eigen::Index> kept;
+    for (Eigen::Index i = 0; i < p; ++i)
+      if (values(i) > tol && values(i) > 0)
+        kept.push_back(i);
+    if (kept.empty())
+      return std::numeric_limits<double>::quiet_NaN();
+    const Eigen::Index r = kept.size();
+    Eigen::MatrixXd whiten(p, r);
+    for (Eigen::Index i = 0; i < r; ++i)
+      whiten.col(i) = lambda_eigen.eigenvectors().col(kept[i])
+                      / std::sqrt(values(kept[i]));
+    Eigen::MatrixXd white_sigma = whiten.transpose() * sigma * whiten;
+    Eigen::LDLT<Eigen::MatrixXd> ldlt(white_sigma);
+    const Eigen::VectorXd d = ldlt.vectorD();
+    double log_det = 0;
+    for (Eigen::Index i = 0; i < r; ++i) {
+      if (!(d(i) > 0))
+        return n;
+      log_det += std::log(d(i));
+    }
+    return n * std::exp(-log_det / r);
+  }
+
+ private:
+  size_t num_projections_;
+  size_t num_batches_;
+  unsigned int seed_;
+  bool has_header_ = false;
+  std::vector<size_t> columns_;
+  size_t num_values_ = 0;
+  size_t num_draws_ = 0;
+  Eigen::MatrixXd projection_;
+  Eigen::VectorXd draw_;
+  Eigen::VectorXd y_;
+  Eigen::VectorXd delta_;
+  Eigen::VectorXd mean_;
+  Eigen::MatrixXd m2_;
+  std::vector<Eigen::VectorXd> batch_sums_;
+  size_t batch_size_ = 1;
+  Eigen::VectorXd partial_sum_;
+  size_t partial_count_ = 0;
+
+  /**
+   * Set up the accumulators for draws with the specified number of
+   * values, drawing the projection if there are more parameters than
+   * directions.
+   */
+  void start(size_t num_values) {
+    for (size_t c : columns_)
+      if (c >= num_values)
+        throw std::invalid_argument(
+            "online_multivariate_ess: draws have fewer values than names");
+    num_values_ = num_values;
+    const Eigen::Index d = columns_.size();
+    Eigen::Index p = d;
+    projection_.resize(0, 0);
+    if (static_cast<size_t>(d) > num_projections_) {
+      p = num_projections_;
+      boost::ecuyer1988 rng(seed_);
+      boost::normal_distribution<> std_normal;
+      projection_.resize(p, d);
+      for (Eigen::Index j = 0; j < d; ++j)
+        for (Eigen::Index i = 0; i < p; ++i)
+          projection_(i, j) = std_normal(rng);
+    }
+    draw_.resize(d);
+    y_.resize(p);
+    delta_.resize(p);
+    mean_ = Eigen::VectorXd::Zero(p);
+    m2_ = Eigen::MatrixXd::Zero(p, p);
+    batch_sums_.clear();
+    batch_size_ = 1;
+    partial_sum_ = Eigen::VectorXd::Zero(p);
+    partial_count_ = 0;
+  }
+};
+
+}  // namespace analyze
+}  // namespace stan
+#endif
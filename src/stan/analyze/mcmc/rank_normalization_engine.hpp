@@ -0,0 +1,248 @@
+#ifndef STAN_ANALYZE_MCMC_RANK_NORMALIZATION_ENGINE_HPP
+#define STAN_ANALYZE_MCMC_RANK_NORMALIZATION_ENGINE_HPP
+
+#include <stan/math/prim.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Computes the normal scores of the average ranks of draws as
+ * <code>rank_transform</code> does, keeping everything a call sets up
+ * for reuse by later calls.  Based on paper
+ * https://arxiv.org/abs/1903.08008
+ *
+ * The normal score of a rank depends only on the rank and the number of
+ * draws, so the scores of all ranks are computed once per number of
+ * draws and looked up afterwards; only tied draws, whose average rank
+ * may fall between two ranks, need the inverse normal distribution
+ * function.  The draws are sorted with a radix sort of their bits.
+ *
+ * The engine keeps the sorted draws of its last rank transform, from
+ * which it gives their quantiles and the normal scores of the ranks of
+ * their absolute deviations from the median without sorting again, so
+ * the bulk and tail diagnostics of a parameter share one sort.
+ *
+ * An engine must not be used from several threads at once; give each
+ * thread its own.
+ */
+class rank_normalization_engine {
+ public:
+  /**
+   * Write the normal scores of the average ranks of the specified draws
+   * into the specified result, as the three-argument
+   * <code>rank_transform</code> function does.
+   *
+   * @param[in] chains draws, with chains in columns
+   * @param[out] ranks normal scores for average ranks of draws, resized
+   *   to the size of chains
+   */
+  void rank_transform(const Eigen::MatrixXd& chains, Eigen::MatrixXd& ranks) {
+    rows_ = chains.rows();
+    cols_ = chains.cols();
+    const Eigen::Index size = chains.size();
+    keys_.resize(size);
+    order_.resize(size);
+    for (Eigen::Index i = 0; i < size; ++i) {
+      keys_[i] = sort_key(chains(i));
+      order_[i] = i;
+    }
+    radix_sort();
+    sorted_.resize(size);
+    for (Eigen::Index i = 0; i < size; ++i)
+      sorted_[i] = chains(order_[i]);
+    assign_scores(sorted_, order_, ranks);
+  }
+
+  /**
+   * Return the sample quantile of the draws of the last rank transform,
+   * interpolating between order statistics as <code>math::quantile</code>
+   * does.
+   *
+   * @param[in] p probability, between 0 and 1
+   * @return quantile of the draws
+   */
+  double quantile(double p) const {
+    const double index = (sorted_.size() - 1) * p;
+    const std::size_t lo = std::floor(index);
+    const std::size_t hi = std::ceil(index);
+    const double h = index - lo;
+    return (1 - h) * sorted_[lo] + h * sorted_[hi];
+  }
+
+  /**
+   * Write the normal scores of the average ranks of the absolute
+   * deviations of the draws of the last rank transform from their median
+   * into the specified result.  The deviations are ordered by merging
+   * those of the draws below and above the median, which are already
+   * sorted.
+   *
+   * @param[out] ranks normal scores for average ranks of the absolute
+   *   deviations, resized to the size of the draws
+   */
+  void folded_rank_transform(Eigen::MatrixXd& ranks) {
+    const double median = quantile(0.5);
+    const std::size_t size = sorted_.size();
+    const std::size_t split
+        = std::lower_bound(sorted_.begin(), sorted_.end(), median)
+          - sorted_.begin();
+    folded_.resize(size);
+    folded_order_.resize(size);
+    std::size_t below = split;
+    std::size_t above = split;
+    for (std::size_t k = 0; k < size; ++k) {
+      const bool take_below
+          = below > 0
+            && (above == size
+                || std::abs(sorted_[below - 1] - median)
+                       <= std::abs(sorted_[above] - median));
+      const std::size_t i = take_below ? --below : above++;
+      folded_[k] = std::abs(sorted_[i] - median);
+      folded_order_[k] = order_[i];
+    }
+    assign_scores(folded_, folded_order_, ranks);
+  }
+
+ private:
+  static constexpr int digit_bits = 11;
+  static constexpr int num_digits = (64 + digit_bits - 1) / digit_bits;
+  static constexpr std::size_t num_buckets = std::size_t{1} << digit_bits;
+  // below this many draws a comparison sort beats the radix passes
+  static constexpr std::size_t min_radix_size = 512;
+
+  Eigen::Index rows_ = 0;
+  Eigen::Index cols_ = 0;
+  std::vector<std::uint64_t> keys_;
+  std::vector<std::uint64_t> keys_buffer_;
+  std::vector<Eigen::Index> order_;
+  std::vector<Eigen::Index> order_buffer_;
+  std::vector<double> sorted_;
+  std::vector<double> folded_;
+  std::vector<Eigen::Index> folded_order_;
+  std::vector<double> scores_;
+  std::vector<std::array<std::size_t, num_buckets>> counts_;
+
+  /**
+   * Unsigned integer ordered as the draw is, with both zeros mapped to
+   * the same key so that they tie as they compare equal.
+   */
+  static std::uint64_t sort_key(double x) {
+    if (x == 0)
+      x = 0;
+    std::uint64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const std::uint64_t sign = std::uint64_t{1} << 63;
+    return (bits & sign) ? ~bits : bits | sign;
+  }
+
+  /**
+   * Sort the keys, permuting the indexes of the draws with them, with a
+   * least significant digit radix sort that skips the digits all keys
+   * share.
+   */
+  void radix_sort() {
+    const std::size_t size = keys_.size();
+    if (size < min_radix_size) {
+      std::sort(order_.begin(), order_.end(),
+                [this](Eigen::Index a, Eigen::Index b) {
+                  return keys_[a] < keys_[b];
+                });
+      keys_buffer_.resize(size);
+      for (std::size_t i = 0; i < size; ++i)
+        keys_buffer_[i] = keys_[order_[i]];
+      keys_.swap(keys_buffer_);
+      return;
+    }
+    counts_.resize(num_digits);
+    for (auto& count : counts_)
+      count.fill(0);
+    for (std::uint64_t key : keys_)
+      for (int d = 0; d < num_digits; ++d)
+        ++counts_[d][digit(key, d)];
+    keys_buffer_.resize(size);
+    order_buffer_.resize(size);
+    for (int d = 0; d < num_digits; ++d) {
+      std::array<std::size_t, num_buckets>& count = counts_[d];
+      if (count[digit(keys_[0], d)] == size)
+        continue;
+      std::size_t offset = 0;
+      for (std::size_t& c : count) {
+        const std::size_t n = c;
+        c = offset;
+        offset += n;
+      }
+      for (std::size_t i = 0; i < size; ++i) {
+        const std::size_t to = count[digit(keys_[i], d)]++;
+        keys_buffer_[to] = keys_[i];
+        order_buffer_[to] = order_[i];
+      }
+      keys_.swap(keys_buffer_);
+      order_.swap(order_buffer_);
+    }
+  }
+
+  static std::size_t digit(std::uint64_t key, int d) {
+    return (key >> (d * digit_bits)) & (num_buckets - 1);
+  }
+
+  /**
+   * Normal scores of the ranks 1 to size, recomputed only when the
+   * number of draws changes.
+   */
+  const std::vector<double>& scores(std::size_t size) {
+    if (scores_.size() != size) {
+      boost::math::normal_distribution<double> dist;
+      scores_.resize(size);
+      for (std::size_t i = 0; i < size; ++i)
+        scores_[i] = boost::math::quantile(dist, probability(i + 1.0, size));
+    }
+    return scores_;
+  }
+
+  static double probability(double avg_rank, std::size_t size) {
+    const double n = size;
+    return (avg_rank - 3.0 / 8.0) / (n - 2.0 * 3.0 / 8.0 + 1.0);
+  }
+
+  /**
+   * Write the normal scores of the average ranks of sorted values to the
+   * draws they came from.
+   */
+  void assign_scores(const std::vector<double>& values,
+                     const std::vector<Eigen::Index>& order,
+                     Eigen::MatrixXd& ranks) {
+    const std::size_t size = values.size();
+    const std::vector<double>& score = scores(size);
+    ranks.resize(rows_, cols_);
+    boost::math::normal_distribution<double> dist;
+    for (std::size_t i = 0; i < size;) {
+      std::size_t j = i + 1;
+      while (j < size && values[j] == values[i])
+        ++j;
+      if (j == i + 1) {
+        ranks(order[i]) = score[i];
+      } else {
+        double sum_ranks = 0;
+        for (std::size_t k = i; k < j; ++k)
+          sum_ranks += k + 1;
+        const double tied = boost::math::quantile(
+            dist, probability(sum_ranks / (j - i), size));
+        for (std::size_t k = i; k < j; ++k)
+          ranks(order[k]) = tied;
+      }
+      i = j;
+    }
+  }
+};
+
+}  // namespace analyze
+}  // namespace stan
+#endif
@@ -0,0 +1,217 @@
+#ifndef STAN_CALLBACKS_ASYNC_LOGGER_HPP
+#define STAN_CALLBACKS_ASYNC_LOGGER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>async_logger</code> is a <code>logger</code> decorator that
+ * queues messages and passes them on to the wrapped logger from a
+ * background thread, a batch at a time, so that a chain does not wait
+ * for its messages to be written.  One may be used per chain in front of
+ * a shared logger; messages are passed on in the order they are logged.
+ *
+ * Messages below <code>min_level</code> are discarded, and
+ * <code>is_enabled()</code> reports them so, so callers can skip
+ * building them.  With a positive <code>max_repeats</code>, a message
+ * logged again with the same level and text, as in bursts of rejected
+ * proposals, is only passed on the first <code>max_repeats</code> times;
+ * blank messages are always passed on, and the counts are forgotten once
+ * 1024 distinct messages are counted.  A note of how many messages were
+ * suppressed is logged at info level on <code>flush()</code>.
+ *
+ * Messages may be logged from several threads.  The wrapped logger is
+ * only used from the background thread until this logger is destroyed,
+ * except for <code>is_enabled()</code>, which must be safe to call
+ * concurrently with logging.  An exception thrown by the wrapped logger
+ * is rethrown from <code>flush()</code>.
+ */
+class async_logger final : public logger {
+ public:
+  /**
+   * Constructs an asynchronous logger and starts its background thread.
+   *
+   * @param[in,out] logger logger the messages are passed on to
+   * @param[in] min_level lowest level of the messages passed on
+   * @param[in] max_repeats number of times the same message is passed
+   *   on, or zero to pass on every message
+   */
+  explicit async_logger(logger& logger, log_level min_level = log_level::debug,
+                        size_t max_repeats = 0)
+      : logger_(logger),
+        min_level_(min_level),
+        max_repeats_(max_repeats),
+        consumer_([this]() { drain(); }) {}
+
+  async_logger(const async_logger&) = delete;
+  async_logger& operator=(const async_logger&) = delete;
+
+  /**
+   * Passes on all queued messages and stops the background thread.
+   */
+  ~async_logger() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    ready_.notify_one();
+    consumer_.join();
+  }
+
+  bool is_enabled(log_level level) const {
+    return level >= min_level_ && logger_.is_enabled(level);
+  }
+
+  void debug(const std::string& message) { add(log_level::debug, message); }
+  void debug(const std::stringstream& message) {
+    add(log_level::debug, message.str());
+  }
+  void info(const std::string& message) { add(log_level::info, message); }
+  void info(const std::stringstream& message) {
+    add(log_level::info, message.str());
+  }
+  void warn(const std::string& message) { add(log_level::warn, message); }
+  void warn(const std::stringstream& message) {
+    add(log_level::warn, message.str());
+  }
+  void error(const std::string& message) { add(log_level::error, message); }
+  void error(const std::stringstream& message) {
+    add(log_level::error, message.str());
+  }
+  void fatal(const std::string& message) { add(log_level::fatal, message); }
+  void fatal(const std::stringstream& message) {
+    add(log_level::fatal, message.str());
+  }
+
+  /**
+   * Waits until every queued message has been passed on, after logging
+   * how many repeated messages were suppressed since the last flush, if
+   * any.
+   */
+  void flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (num_suppressed_ > 0) {
+      queue_.emplace_back(log_level::info,
+                          "Suppressed " + std::to_string(num_suppressed_)
+                              + " repeated log messages.");
+      num_suppressed_ = 0;
+      ready_.notify_one();
+    }
+    idle_.wait(lock, [this]() { return queue_.empty() && !writing_; });
+    if (error_) {
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * Return the number of repeated messages suppressed since the last
+   * flush.
+   */
+  size_t num_suppressed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_suppressed_;
+  }
+
+ private:
+  using message_t = std::pair<log_level, std::string>;
+
+  logger& logger_;
+  log_level min_level_;
+  size_t max_repeats_;
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable idle_;
+  std::vector<message_t> queue_;
+  std::unordered_map<std::string, size_t> repeats_[5];
+  size_t num_suppressed_ = 0;
+  bool writing_ = false;
+  bool done_ = false;
+  std::exception_ptr error_;
+  std::thread consumer_;
+
+  void add(log_level level, const std::string& message) {
+    if (level < min_level_)
+      return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (max_repeats_ > 0 && !message.empty()) {
+      auto& repeats = repeats_[static_cast<int>(level)];
+      if (repeats.size() == 1024)
+        repeats.clear();
+      if (++repeats[message] > max_repeats_) {
+        ++num_suppressed_;
+        return;
+      }
+    }
+    queue_.emplace_back(level, message);
+    if (queue_.size() == 1)
+      ready_.notify_one();
+  }
+
+  void pass_on(const message_t& message) {
+    switch (message.first) {
+      case log_level::debug:
+        logger_.debug(message.second);
+        break;
+      case log_level::info:
+        logger_.info(message.second);
+        break;
+      case log_level::warn:
+        logger_.warn(message.second);
+        break;
+      case log_level::error:
+        logger_.error(message.second);
+        break;
+      case log_level::fatal:
+        logger_.fatal(message.second);
+        break;
+    }
+  }
+
+  /**
+   * Body of the background thread: pass on batches of queued messages
+   * until the logger is destroyed and the queue is empty.
+   */
+  void drain() {
+    std::vector<message_t> batch;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      ready_.wait(lock, [this]() { return done_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      batch.swap(queue_);
+      writing_ = true;
+      lock.unlock();
+      std::exception_ptr error;
+      try {
+        for (const message_t& message : batch)
+          pass_on(message);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      batch.clear();
+      lock.lock();
+      if (error && !error_)
+        error_ = error;
+      writing_ = false;
+      if (queue_.empty())
+        idle_.notify_all();
+    }
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
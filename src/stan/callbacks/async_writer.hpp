@@ -0,0 +1,335 @@
+#ifndef STAN_CALLBACKS_ASYNC_WRITER_HPP
+#define STAN_CALLBACKS_ASYNC_WRITER_HPP
+
+#include <stan/callbacks/event_tracer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>async_writer</code> is a <code>writer</code> decorator that
+ * hands every call to a background thread, which replays it on the
+ * wrapped writer.  Calls are queued in a bounded single producer,
+ * single consumer ring buffer whose slots are reused, so after warmup
+ * queuing a draw does not allocate.
+ *
+ * When the buffer is full the calling thread by default waits for the
+ * background thread to free a slot, so a writer that cannot keep up
+ * slows the sampler down instead of growing memory without bound.  With
+ * the <code>overflow::drop</code> policy, draws that find the buffer full
+ * are dropped and counted instead, so the sampler never waits for a
+ * draw; names, messages and blank lines are never dropped.  Independently,
+ * a writer can forward only one of every <code>keep_every</code> draws,
+ * starting with the first, for sinks such as monitors that only need a
+ * sample of the draws.  Both matrices and rows count as draws.  As for any
+ * other writer, calls must not be made concurrently from several
+ * threads.  The wrapped writer is only used from the background thread
+ * until this writer is destroyed.
+ *
+ * An exception thrown by the wrapped writer is rethrown from the next
+ * call, or from <code>flush()</code>.
+ */
+class async_writer final : public writer {
+ public:
+  /**
+   * What to do with a draw when the buffer is full.
+   */
+  enum class overflow {
+    block,  // wait for the background thread to free a slot
+    drop    // drop the draw
+  };
+
+  /**
+   * Constructs an asynchronous writer and starts its background thread.
+   *
+   * @param[in, out] writer writer the calls are forwarded to
+   * @param[in] capacity number of calls that can be queued; must be
+   *   positive
+   * @param[in] policy what to do with a draw when the buffer is full
+   * @param[in] keep_every forward one of every <code>keep_every</code>
+   *   draws; must be positive
+   * @throw std::invalid_argument if the capacity or
+   *   <code>keep_every</code> is zero
+   */
+  explicit async_writer(writer& writer, size_t capacity = 1024,
+                        overflow policy = overflow::block,
+                        size_t keep_every = 1)
+      : writer_(writer),
+        policy_(policy),
+        keep_every_(check_positive(keep_every, "keep_every")),
+        slots_(check_positive(capacity, "capacity") + 1),
+        head_(0),
+        tail_(0),
+        done_(false),
+        consumer_([this]() { drain(); }) {}
+
+  async_writer(const async_writer&) = delete;
+  async_writer& operator=(const async_writer&) = delete;
+
+  /**
+   * Writes all queued calls and stops the background thread.
+   */
+  ~async_writer() {
+    done_.store(true, std::memory_order_release);
+    consumer_.join();
+  }
+
+  void operator()(const std::vector<std::string>& names) {
+    slot& s = acquire();
+    s.kind = kind_t::names;
+    s.names = names;
+    publish();
+  }
+
+  bool accepts_schema() const { return writer_.accepts_schema(); }
+
+  void operator()(const output_schema& schema) {
+    slot& s = acquire();
+    s.kind = kind_t::schema;
+    s.schema = schema;
+    publish();
+  }
+
+  void operator()(const std::vector<double>& state) {
+    slot* s = acquire_draw();
+    if (s == nullptr)
+      return;
+    s->kind = kind_t::state;
+    s->state.assign(state.begin(), state.end());
+    publish();
+  }
+
+  void operator()() {
+    slot& s = acquire();
+    s.kind = kind_t::blank;
+    publish();
+  }
+
+  void operator()(const std::string& message) {
+    slot& s = acquire();
+    s.kind = kind_t::message;
+    s.message = message;
+    publish();
+  }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    slot* s = acquire_draw();
+    if (s == nullptr)
+      return;
+    s->kind = kind_t::matrix;
+    s->matrix = values;
+    publish();
+  }
+
+  /**
+   * Waits until every queued call has been written, then flushes the
+   * wrapped writer.
+   */
+  void flush() {
+    while (tail_.load(std::memory_order_acquire)
+           != head_.load(std::memory_order_relaxed)) {
+      rethrow_error();
+      std::this_thread::yield();
+    }
+    rethrow_error();
+    writer_.flush();
+  }
+
+  /**
+   * Return the number of calls that can be queued.
+   */
+  size_t capacity() const noexcept { return slots_.size() - 1; }
+
+  /**
+   * Return the number of draws dropped because the buffer was full.
+   * Draws skipped by <code>keep_every</code> are not counted.
+   */
+  size_t num_dropped() const noexcept { return num_dropped_; }
+
+  /**
+   * Return the number of calls queued and not yet written.  It is only
+   * exact on the calling thread once the buffer is flushed, as the
+   * background thread may be writing.
+   */
+  size_t queue_depth() const noexcept {
+    return depth(head_.load(std::memory_order_relaxed));
+  }
+
+  /**
+   * Return the largest number of calls that were queued at once, which
+   * is the capacity when a writer cannot keep up with the sampler.
+   */
+  size_t max_queue_depth() const noexcept { return max_queue_depth_; }
+
+ private:
+  enum class kind_t { names, schema, state, blank, message, matrix };
+
+  struct slot {
+    kind_t kind;
+    std::vector<std::string> names;
+    output_schema schema;
+    std::vector<double> state;
+    std::string message;
+    Eigen::MatrixXd matrix;
+  };
+
+  writer& writer_;
+  overflow policy_;
+  size_t keep_every_;
+  size_t num_draws_ = 0;
+  size_t num_dropped_ = 0;
+  size_t max_queue_depth_ = 0;
+  std::vector<slot> slots_;
+
+  /**
+   * Index of the next slot the producer fills
+   */
+  std::atomic<size_t> head_;
+
+  /**
+   * Index of the next slot the consumer writes
+   */
+  std::atomic<size_t> tail_;
+
+  std::atomic<bool> done_;
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+  std::thread consumer_;
+
+  // Checked before the background thread starts, which is constructed last
+  static size_t check_positive(size_t n, const char* name) {
+    if (n == 0)
+      throw std::invalid_argument(std::string("async writer ") + name
+                                  + " must be positive");
+    return n;
+  }
+
+  size_t next(size_t i) const noexcept {
+    return i + 1 == slots_.size() ? 0 : i + 1;
+  }
+
+  size_t depth(size_t head) const noexcept {
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return head >= tail ? head - tail : head + slots_.size() - tail;
+  }
+
+  void rethrow_error() {
+    if (failed_.load(std::memory_order_acquire) && error_) {
+      std::exception_ptr error = error_;
+      error_ = nullptr;
+      std::rethrow_exception(error);
+    }
+  }
+
+  /**
+   * Return the slot for the next call, waiting while the buffer is full.
+   */
+  slot& acquire() {
+    rethrow_error();
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (next(head) == tail_.load(std::memory_order_acquire)) {
+      trace_scope trace("writer", "blocked");
+      while (next(head) == tail_.load(std::memory_order_acquire)) {
+        rethrow_error();
+        std::this_thread::yield();
+      }
+    }
+    return slots_[head];
+  }
+
+  /**
+   * Return the slot for the next draw, or <code>nullptr</code> if the
+   * draw is skipped or dropped.
+   */
+  slot* acquire_draw() {
+    if (num_draws_++ % keep_every_ != 0)
+      return nullptr;
+    if (policy_ == overflow::drop) {
+      rethrow_error();
+      size_t head = head_.load(std::memory_order_relaxed);
+      if (next(head) == tail_.load(std::memory_order_acquire)) {
+        ++num_dropped_;
+        return nullptr;
+      }
+      return &slots_[head];
+    }
+    return &acquire();
+  }
+
+  void publish() {
+    const size_t head = next(head_.load(std::memory_order_relaxed));
+    head_.store(head, std::memory_order_release);
+    max_queue_depth_ = std::max(max_queue_depth_, depth(head));
+  }
+
+  void replay(slot& s) {
+    switch (s.kind) {
+      case kind_t::names:
+        writer_(s.names);
+        break;
+      case kind_t::schema:
+        writer_(s.schema);
+        break;
+      case kind_t::state:
+        writer_(s.state);
+        break;
+      case kind_t::blank:
+        writer_();
+        break;
+      case kind_t::message:
+        writer_(s.message);
+        break;
+      case kind_t::matrix:
+        writer_(s.matrix);
+        break;
+    }
+  }
+
+  /**
+   * Body of the background thread: write queued calls until the writer
+   * is destroyed and the buffer is empty, backing off while idle.
+   */
+  void drain() {
+    std::chrono::microseconds backoff(0);
+    while (true) {
+      size_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail == head_.load(std::memory_order_acquire)) {
+        if (done_.load(std::memory_order_acquire)
+            && tail == head_.load(std::memory_order_acquire))
+          return;
+        if (backoff.count() == 0) {
+          std::this_thread::yield();
+          backoff = std::chrono::microseconds(1);
+        } else {
+          std::this_thread::sleep_for(backoff);
+          backoff = std::min(backoff * 2, std::chrono::microseconds(1000));
+        }
+        continue;
+      }
+      backoff = std::chrono::microseconds(0);
+      if (!failed_.load(std::memory_order_relaxed)) {
+        try {
+          replay(slots_[tail]);
+        } catch (...) {
+          error_ = std::current_exception();
+          failed_.store(true, std::memory_order_release);
+        }
+      }
+      tail_.store(next(tail), std::memory_order_release);
+    }
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,272 @@
+#ifndef STAN_CALLBACKS_BINARY_WRITER_HPP
+#define STAN_CALLBACKS_BINARY_WRITER_HPP
+
+#include <stan/callbacks/output_schema.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>binary_writer</code> is an implementation of <code>writer</code>
+ * that writes draws to a stream in a chunked, columnar binary format
+ * instead of text.  Draws are buffered and written a chunk at a time,
+ * one column after another, so no per-value formatting is done and the
+ * stream is flushed once per chunk rather than once per row.
+ *
+ * The stream starts with the 8 byte magic string <code>MAGIC</code>,
+ * followed by a sequence of self-contained records.  Each record is a
+ * one byte tag followed by its payload; integers are
+ * <code>std::uint64_t</code> and all values are in native byte order.
+ *
+ * - <code>'H'</code> header: the number of names, then each name as its
+ *   length followed by its characters.
+ * - <code>'S'</code> schema header: the number of variables, then for
+ *   each its name, as for a header, its number of dimensions and its
+ *   dimensions.
+ * - <code>'T'</code> typed schema header: as a schema header, with the
+ *   size in bytes of the values of each variable, 4 or 8, as one byte
+ *   after its dimensions.  It is written instead of a schema header when
+ *   some variable is of single precision.
+ * - <code>'D'</code> draws: the number of rows and of columns, then the
+ *   values of each column in turn as doubles.
+ * - <code>'F'</code> typed draws: the number of rows and of columns, the
+ *   size in bytes of the values of each column as one byte each, then
+ *   the values of each column in turn, as floats or doubles.  It is
+ *   written instead of draws after a typed schema header, so single
+ *   precision columns take half the space.
+ * - <code>'C'</code> comment: the length of the message followed by its
+ *   characters; a blank line is a comment of length zero.
+ *
+ * Records are written in the order of the calls, so comments stay
+ * interleaved with the draws around them.  A stream truncated after any
+ * complete record is readable with <code>io::binary_draws_reader</code>.
+ */
+class binary_writer : public writer {
+ public:
+  static constexpr const char* MAGIC = "STANDRW1";
+  static constexpr char HEADER_TAG = 'H';
+  static constexpr char SCHEMA_TAG = 'S';
+  static constexpr char TYPED_SCHEMA_TAG = 'T';
+  static constexpr char DRAWS_TAG = 'D';
+  static constexpr char TYPED_DRAWS_TAG = 'F';
+  static constexpr char COMMENT_TAG = 'C';
+
+  /**
+   * Constructs a binary writer on an output stream opened in binary
+   * mode and writes the magic string.
+   *
+   * @param[in, out] output stream to write
+   * @param[in] chunk_size number of draws buffered per chunk; must be
+   *   positive
+   */
+  explicit binary_writer(std::ostream& output, size_t chunk_size = 1024)
+      : output_(output), chunk_size_(chunk_size), num_buffered_(0) {
+    output_.write(MAGIC, 8);
+  }
+
+  /**
+   * Writes any buffered draws.
+   */
+  virtual ~binary_writer() { flush_draws(); }
+
+  /**
+   * Writes a header record.
+   *
+   * @param[in] names Names in a std::vector
+   */
+  void operator()(const std::vector<std::string>& names) {
+    flush_draws();
+    precisions_.clear();
+    output_.put(HEADER_TAG);
+    write_size(names.size());
+    for (const std::string& name : names)
+      write_string(name);
+  }
+
+  /**
+   * Headers are written as schemas, one entry per variable.
+   */
+  bool accepts_schema() const { return true; }
+
+  /**
+   * Writes a schema header record, typed if some variable is of single
+   * precision.
+   *
+   * @param[in] schema variables of the columns
+   */
+  void operator()(const output_schema& schema) {
+    flush_draws();
+    const bool typed = schema.reduced_precision();
+    precisions_.clear();
+    if (typed)
+      precisions_ = schema.column_precisions();
+    output_.put(typed ? TYPED_SCHEMA_TAG : SCHEMA_TAG);
+    write_size(schema.variables().size());
+    for (const schema_variable& variable : schema.variables()) {
+      write_string(variable.name);
+      write_size(variable.dims.size());
+      for (size_t d : variable.dims)
+        write_size(d);
+      if (typed)
+        output_.put(value_bytes(variable.precision));
+    }
+  }
+
+  /**
+   * Return the size in bytes of a value of the specified precision.
+   */
+  static char value_bytes(value_precision precision) {
+    return precision == value_precision::float32 ? sizeof(float)
+                                                 : sizeof(double);
+  }
+
+  /**
+   * Buffers a draw, writing the chunk once it is full.  A draw with a
+   * different number of values than the buffered ones starts a new
+   * chunk.
+   *
+   * @param[in] state Values in a std::vector
+   */
+  void operator()(const std::vector<double>& state) {
+    if (state.empty())
+      return;
+    if (num_buffered_ > 0
+        && static_cast<Eigen::Index>(state.size()) != chunk_.cols())
+      flush_draws();
+    if (chunk_.rows() != static_cast<Eigen::Index>(chunk_size_)
+        || chunk_.cols() != static_cast<Eigen::Index>(state.size()))
+      chunk_.resize(chunk_size_, state.size());
+    chunk_.row(num_buffered_)
+        = Eigen::Map<const Eigen::RowVectorXd>(state.data(), state.size());
+    if (++num_buffered_ == chunk_size_)
+      flush_draws();
+  }
+
+  /**
+   * Writes an empty comment record.
+   */
+  void operator()() {
+    flush_draws();
+    output_.put(COMMENT_TAG);
+    write_size(0);
+  }
+
+  /**
+   * Writes a comment record.
+   *
+   * @param[in] message A string
+   */
+  void operator()(const std::string& message) {
+    flush_draws();
+    output_.put(COMMENT_TAG);
+    write_string(message);
+  }
+
+  /**
+   * Writes the draws in a matrix as a single chunk.
+   *
+   * @param[in] values A matrix of values. The input is expected to have
+   * parameters in the rows and samples in the columns.
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    flush_draws();
+    if (values.size() == 0)
+      return;
+    Eigen::MatrixXd draws = values.transpose();
+    write_chunk(draws, draws.rows());
+  }
+
+  /**
+   * Writes the buffered draws and flushes the stream.
+   */
+  void flush() {
+    flush_draws();
+    output_.flush();
+  }
+
+  /**
+   * Writes the buffered draws, if any, as a chunk and flushes the
+   * stream.
+   */
+  void flush_draws() {
+    if (num_buffered_ == 0)
+      return;
+    write_chunk(chunk_, num_buffered_);
+    num_buffered_ = 0;
+  }
+
+ private:
+  /**
+   * Output stream
+   */
+  std::ostream& output_;
+
+  /**
+   * Number of draws per chunk
+   */
+  size_t chunk_size_;
+
+  /**
+   * Buffered draws, one per row
+   */
+  Eigen::MatrixXd chunk_;
+
+  /**
+   * Number of rows of <code>chunk_</code> in use
+   */
+  size_t num_buffered_;
+
+  /**
+   * Precision of each column of the last typed schema, empty otherwise
+   */
+  std::vector<value_precision> precisions_;
+
+  /**
+   * Column converted to single precision
+   */
+  std::vector<float> floats_;
+
+  void write_size(std::uint64_t n) {
+    output_.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+
+  void write_string(const std::string& s) {
+    write_size(s.size());
+    output_.write(s.data(), s.size());
+  }
+
+  void write_chunk(const Eigen::MatrixXd& draws, size_t num_rows) {
+    // draws of another width than the schema's are written as doubles
+    const bool typed
+        = static_cast<Eigen::Index>(precisions_.size()) == draws.cols();
+    output_.put(typed ? TYPED_DRAWS_TAG : DRAWS_TAG);
+    write_size(num_rows);
+    write_size(draws.cols());
+    if (typed)
+      for (value_precision precision : precisions_)
+        output_.put(value_bytes(precision));
+    for (Eigen::Index col = 0; col < draws.cols(); ++col) {
+      if (typed && precisions_[col] == value_precision::float32) {
+        floats_.resize(num_rows);
+        for (size_t row = 0; row < num_rows; ++row)
+          floats_[row] = static_cast<float>(draws(row, col));
+        output_.write(reinterpret_cast<const char*>(floats_.data()),
+                      num_rows * sizeof(float));
+      } else {
+        output_.write(reinterpret_cast<const char*>(draws.col(col).data()),
+                      num_rows * sizeof(double));
+      }
+    }
+    output_.flush();
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,68 @@
+#ifndef STAN_CALLBACKS_BUFFERED_LOGGER_HPP
+#define STAN_CALLBACKS_BUFFERED_LOGGER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>buffered_logger</code> keeps its messages to pass them on later,
+ * so that work done concurrently can report in the order it would have
+ * been done one after another.
+ */
+class buffered_logger : public logger {
+ public:
+  void debug(const std::string& message) { add(0, message); }
+  void debug(const std::stringstream& message) { add(0, message.str()); }
+  void info(const std::string& message) { add(1, message); }
+  void info(const std::stringstream& message) { add(1, message.str()); }
+  void warn(const std::string& message) { add(2, message); }
+  void warn(const std::stringstream& message) { add(2, message.str()); }
+  void error(const std::string& message) { add(3, message); }
+  void error(const std::stringstream& message) { add(3, message.str()); }
+  void fatal(const std::string& message) { add(4, message); }
+  void fatal(const std::stringstream& message) { add(4, message.str()); }
+
+  /**
+   * Pass the messages on, in order, and forget them.
+   *
+   * @param[in,out] out logger to pass the messages to
+   */
+  void flush(logger& out) {
+    for (const auto& message : messages_) {
+      switch (message.first) {
+        case 0:
+          out.debug(message.second);
+          break;
+        case 1:
+          out.info(message.second);
+          break;
+        case 2:
+          out.warn(message.second);
+          break;
+        case 3:
+          out.error(message.second);
+          break;
+        default:
+          out.fatal(message.second);
+      }
+    }
+    messages_.clear();
+  }
+
+ private:
+  std::vector<std::pair<int, std::string>> messages_;
+
+  void add(int level, const std::string& message) {
+    messages_.emplace_back(level, message);
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
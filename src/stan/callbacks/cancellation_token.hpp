@@ -0,0 +1,94 @@
+#ifndef STAN_CALLBACKS_CANCELLATION_TOKEN_HPP
+#define STAN_CALLBACKS_CANCELLATION_TOKEN_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>cancellation_token</code> is an interrupt that a client can
+ * cancel from any thread, and which can expire at a deadline, so that a
+ * service stops within a bounded latency: the samplers poll
+ * <code>stop_requested()</code> before every leapfrog step, the
+ * optimizers and pathfinder before every gradient of their line
+ * searches, and ADVI at every iteration.  The service then finishes
+ * normally with the output produced so far.
+ *
+ * It may wrap another interrupt, such as a
+ * <code>termination_controller</code> or the signal handler of an
+ * interface, which it calls once an iteration and whose stop requests it
+ * passes on.
+ */
+class cancellation_token : public interrupt {
+ public:
+  /**
+   * Construct a token with no deadline.
+   *
+   * @param[in] inner interrupt called once an iteration and whose stop
+   *   requests are passed on, or null
+   */
+  explicit cancellation_token(interrupt* inner = nullptr) : inner_(inner) {}
+
+  /**
+   * Request a stop.  May be called from any thread.
+   */
+  void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+
+  /**
+   * Return true if <code>cancel()</code> was called.
+   */
+  bool cancelled() const noexcept {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Request a stop once the specified number of seconds from now have
+   * passed, replacing any earlier deadline.  May be called from any
+   * thread.
+   *
+   * @param[in] seconds seconds until the deadline; infinite for none
+   */
+  void set_deadline(double seconds) {
+    if (!(seconds < std::numeric_limits<double>::infinity())) {
+      deadline_.store(no_deadline, std::memory_order_relaxed);
+      return;
+    }
+    const auto duration = std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(std::fmax(seconds, 0)));
+    deadline_.store((clock::now() + duration).time_since_epoch().count(),
+                    std::memory_order_relaxed);
+  }
+
+  void operator()() {
+    if (inner_ != nullptr)
+      (*inner_)();
+  }
+
+  bool stop_requested() const {
+    if (cancelled())
+      return true;
+    const int64_t deadline = deadline_.load(std::memory_order_relaxed);
+    if (deadline != no_deadline
+        && clock::now().time_since_epoch().count() >= deadline)
+      return true;
+    return inner_ != nullptr && inner_->stop_requested();
+  }
+
+ private:
+  using clock = std::chrono::steady_clock;
+  static constexpr int64_t no_deadline = INT64_MAX;
+
+  interrupt* inner_;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<int64_t> deadline_{no_deadline};
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,281 @@
+#ifndef STAN_CALLBACKS_COMPRESSED_OSTREAM_HPP
+#define STAN_CALLBACKS_COMPRESSED_OSTREAM_HPP
+
+#include <stan/callbacks/compression_codec.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>compressing_streambuf</code> is a stream buffer that compresses
+ * what is written to it in independent frames and writes them to an
+ * output stream.  Any writer built on a stream, such as
+ * <code>stream_writer</code>, <code>unique_stream_writer</code> or
+ * <code>binary_writer</code>, writes compressed output when its stream
+ * uses this buffer, for example through a <code>compressed_ostream</code>.
+ *
+ * Bytes are gathered into a frame of <code>frame_size</code> bytes in the
+ * writing thread.  Full frames are compressed by a pool of background
+ * threads, which also write them to the output stream in order, so the
+ * writing thread only copies bytes and waits only when
+ * <code>2 * num_threads</code> frames are already waiting to be
+ * compressed or written.
+ *
+ * The output starts with the 8 byte magic string <code>MAGIC</code> and
+ * the byte <code>Codec::ID</code>.  Each frame is the number of bytes it
+ * decompresses to and the number of compressed bytes, both
+ * <code>std::uint64_t</code> in native byte order, followed by the
+ * compressed bytes.  Flushing the stream ends the current frame, so a
+ * stream truncated after a flush decompresses to everything written
+ * before it; <code>io::decompressing_streambuf</code> reads the frames
+ * back.
+ *
+ * @tparam Codec codec compressing the frames
+ */
+template <typename Codec>
+class compressing_streambuf : public std::streambuf {
+ public:
+  static constexpr const char* MAGIC = "STANCMP1";
+
+  /**
+   * Constructs a compressing buffer, writes the stream header and starts
+   * the background threads.
+   *
+   * @param[in, out] output stream the compressed frames are written to
+   * @param[in] frame_size number of bytes compressed per frame; must be
+   *   positive
+   * @param[in] num_threads number of threads compressing frames; must be
+   *   positive
+   * @param[in] codec codec compressing the frames
+   */
+  explicit compressing_streambuf(std::ostream& output,
+                                 size_t frame_size = 1 << 20,
+                                 size_t num_threads = 1,
+                                 const Codec& codec = Codec())
+      : output_(output),
+        codec_(codec),
+        frame_size_(frame_size),
+        max_pending_(2 * num_threads) {
+    output_.write(MAGIC, 8);
+    output_.put(Codec::ID);
+    start_frame();
+    for (size_t i = 0; i < num_threads; ++i)
+      workers_.emplace_back([this]() { work(); });
+  }
+
+  compressing_streambuf(const compressing_streambuf&) = delete;
+  compressing_streambuf& operator=(const compressing_streambuf&) = delete;
+
+  /**
+   * Writes the remaining frames and stops the background threads.
+   */
+  ~compressing_streambuf() { close(); }
+
+  /**
+   * Compresses and writes the bytes not yet written, stops the background
+   * threads and flushes the output stream.  Nothing more can be written.
+   *
+   * @return true if every frame was compressed and written
+   */
+  bool close() {
+    if (closed_)
+      return !failed_;
+    submit_frame();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    work_ready_.notify_all();
+    for (std::thread& worker : workers_)
+      worker.join();
+    closed_ = true;
+    setp(nullptr, nullptr);
+    output_.flush();
+    return !failed_ && output_.good();
+  }
+
+ protected:
+  int_type overflow(int_type c) {
+    if (closed_ || !submit_frame())
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(c);
+      pbump(1);
+    }
+    return traits_type::not_eof(c);
+  }
+
+  /**
+   * Ends the current frame and waits until every frame is written.
+   */
+  int sync() {
+    if (closed_)
+      return failed_ ? -1 : 0;
+    if (!submit_frame())
+      return -1;
+    std::unique_lock<std::mutex> lock(mutex_);
+    frame_written_.wait(lock, [this]() { return written_ == submitted_; });
+    lock.unlock();
+    output_.flush();
+    return failed_ || !output_.good() ? -1 : 0;
+  }
+
+ private:
+  struct frame {
+    size_t index;
+    std::vector<char> bytes;
+  };
+
+  std::ostream& output_;
+  Codec codec_;
+  size_t frame_size_;
+  size_t max_pending_;
+  std::vector<char> current_;  // Frame being filled
+
+  std::mutex mutex_;
+  std::condition_variable work_ready_;
+  std::condition_variable frame_written_;
+  std::deque<frame> queue_;               // Frames waiting for a thread
+  std::vector<std::vector<char>> spare_;  // Buffers of written frames
+  size_t submitted_ = 0;                  // Frames handed to the threads
+  size_t written_ = 0;                    // Frames written to the output
+  bool done_ = false;
+  std::atomic<bool> failed_{false};
+  bool closed_ = false;
+  std::vector<std::thread> workers_;
+
+  void start_frame() {
+    current_.resize(frame_size_);
+    setp(current_.data(), current_.data() + frame_size_);
+  }
+
+  /**
+   * Hands the current frame to the background threads, waiting while too
+   * many frames are pending, and starts a new one.
+   *
+   * @return false if a frame failed to be compressed or written
+   */
+  bool submit_frame() {
+    size_t size = pptr() - pbase();
+    if (size == 0)
+      return !failed_;
+    std::unique_lock<std::mutex> lock(mutex_);
+    frame_written_.wait(lock, [this]() {
+      return failed_ || submitted_ - written_ < max_pending_;
+    });
+    if (failed_)
+      return false;
+    current_.resize(size);
+    queue_.push_back(frame{submitted_++, std::move(current_)});
+    current_.clear();
+    if (!spare_.empty()) {
+      current_ = std::move(spare_.back());
+      spare_.pop_back();
+    }
+    lock.unlock();
+    work_ready_.notify_one();
+    start_frame();
+    return true;
+  }
+
+  void write_size(std::uint64_t n) {
+    output_.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+
+  /**
+   * Body of the background threads: compress frames as they arrive and
+   * write each once the frames before it are written.
+   */
+  void work() {
+    std::vector<char> compressed;
+    while (true) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_ready_.wait(lock, [this]() { return done_ || !queue_.empty(); });
+      if (queue_.empty())
+        return;
+      frame f = std::move(queue_.front());
+      queue_.pop_front();
+      lock.unlock();
+
+      size_t size = 0;
+      bool ok = true;
+      try {
+        compressed.resize(codec_.bound(f.bytes.size()));
+        size = codec_.compress(f.bytes.data(), f.bytes.size(),
+                               compressed.data(), compressed.size());
+      } catch (...) {
+        ok = false;
+      }
+
+      lock.lock();
+      frame_written_.wait(lock, [&]() { return written_ == f.index; });
+      if (ok && !failed_) {
+        write_size(f.bytes.size());
+        write_size(size);
+        output_.write(compressed.data(), size);
+        ok = output_.good();
+      }
+      if (!ok)
+        failed_ = true;
+      ++written_;
+      spare_.push_back(std::move(f.bytes));
+      lock.unlock();
+      frame_written_.notify_all();
+    }
+  }
+};
+
+/**
+ * <code>compressed_ostream</code> is an output stream that compresses
+ * what is written to it onto another stream through a
+ * <code>compressing_streambuf</code>.
+ *
+ * @tparam Codec codec compressing the frames
+ */
+template <typename Codec>
+class compressed_ostream : public std::ostream {
+ public:
+  /**
+   * Constructs a compressed stream.
+   *
+   * @param[in, out] output stream the compressed frames are written to
+   * @param[in] frame_size number of bytes compressed per frame; must be
+   *   positive
+   * @param[in] num_threads number of threads compressing frames; must be
+   *   positive
+   * @param[in] codec codec compressing the frames
+   */
+  explicit compressed_ostream(std::ostream& output,
+                              size_t frame_size = 1 << 20,
+                              size_t num_threads = 1,
+                              const Codec& codec = Codec())
+      : std::ostream(nullptr), buf_(output, frame_size, num_threads, codec) {
+    rdbuf(&buf_);
+  }
+
+  /**
+   * Writes everything written so far and closes the stream, setting the
+   * bad bit if a frame could not be compressed or written.
+   */
+  void close() {
+    if (!buf_.close())
+      setstate(std::ios_base::badbit);
+  }
+
+ private:
+  compressing_streambuf<Codec> buf_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,116 @@
+#ifndef STAN_CALLBACKS_COMPRESSION_CODEC_HPP
+#define STAN_CALLBACKS_COMPRESSION_CODEC_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#ifdef STAN_ZSTD
+#include <zstd.h>
+#endif
+#ifdef STAN_LZ4
+#include <lz4.h>
+#endif
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * Codecs compress and decompress the frames of a
+ * <code>compressed_ostream</code>.  A codec provides
+ *
+ * - <code>ID</code>, the byte identifying it in the stream header,
+ * - <code>bound(n)</code>, the largest compressed size of
+ *   <code>n</code> bytes,
+ * - <code>compress(src, n, dst, capacity)</code>, which returns the
+ *   compressed size, and
+ * - <code>decompress(src, n, dst, size)</code>, which decompresses
+ *   exactly <code>size</code> bytes.
+ *
+ * Both throw <code>std::runtime_error</code> on failure.  A codec is
+ * called from several threads at once and keeps no state between calls.
+ *
+ * <code>uncompressed_codec</code> stores frames as they are.  The zstd
+ * and lz4 codecs are only defined when Stan is built with
+ * <code>STAN_ZSTD</code> or <code>STAN_LZ4</code> and linked with the
+ * corresponding library.
+ */
+struct uncompressed_codec {
+  static constexpr char ID = 'N';
+
+  size_t bound(size_t n) const noexcept { return n; }
+
+  size_t compress(const char* src, size_t n, char* dst,
+                  size_t capacity) const {
+    std::memcpy(dst, src, n);
+    return n;
+  }
+
+  void decompress(const char* src, size_t n, char* dst, size_t size) const {
+    if (n != size)
+      throw std::runtime_error("uncompressed frame has the wrong size");
+    std::memcpy(dst, src, n);
+  }
+};
+
+#ifdef STAN_ZSTD
+/**
+ * zstd codec at the specified compression level.
+ */
+struct zstd_codec {
+  static constexpr char ID = 'Z';
+
+  explicit zstd_codec(int level = 3) : level_(level) {}
+
+  size_t bound(size_t n) const noexcept { return ZSTD_compressBound(n); }
+
+  size_t compress(const char* src, size_t n, char* dst,
+                  size_t capacity) const {
+    size_t result = ZSTD_compress(dst, capacity, src, n, level_);
+    if (ZSTD_isError(result))
+      throw std::runtime_error(std::string("zstd compression failed: ")
+                               + ZSTD_getErrorName(result));
+    return result;
+  }
+
+  void decompress(const char* src, size_t n, char* dst, size_t size) const {
+    size_t result = ZSTD_decompress(dst, size, src, n);
+    if (ZSTD_isError(result) || result != size)
+      throw std::runtime_error("zstd decompression failed");
+  }
+
+ private:
+  int level_;
+};
+#endif
+
+#ifdef STAN_LZ4
+/**
+ * lz4 codec, which trades compression ratio for speed.
+ */
+struct lz4_codec {
+  static constexpr char ID = 'L';
+
+  size_t bound(size_t n) const noexcept { return LZ4_compressBound(n); }
+
+  size_t compress(const char* src, size_t n, char* dst,
+                  size_t capacity) const {
+    int result = LZ4_compress_default(src, dst, static_cast<int>(n),
+                                      static_cast<int>(capacity));
+    if (result <= 0)
+      throw std::runtime_error("lz4 compression failed");
+    return result;
+  }
+
+  void decompress(const char* src, size_t n, char* dst, size_t size) const {
+    int result = LZ4_decompress_safe(src, dst, static_cast<int>(n),
+                                     static_cast<int>(size));
+    if (result < 0 || static_cast<size_t>(result) != size)
+      throw std::runtime_error("lz4 decompression failed");
+  }
+};
+#endif
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
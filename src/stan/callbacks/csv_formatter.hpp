@@ -0,0 +1,203 @@
+#ifndef STAN_CALLBACKS_CSV_FORMATTER_HPP
+#define STAN_CALLBACKS_CSV_FORMATTER_HPP
+
+#include <stan/callbacks/output_schema.hpp>
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <ios>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>csv_formatter</code> formats rows of values as comma separated
+ * lines into a character buffer that is reused from row to row, so that
+ * a writer can hand each row to its stream with a single write.
+ *
+ * Doubles are formatted without going through the stream.  By default
+ * the output is byte for byte what <code>operator<<</code> would write
+ * with the stream's precision; when the stream's flags or locale are
+ * anything but the defaults the formatter falls back to the stream
+ * formatting.  In round trip mode each double is instead written with
+ * the fewest digits that parse back to the same value.  Columns of single
+ * precision are rounded to <code>float</code> and written with the fewest
+ * digits that parse back to the same <code>float</code>, whatever the
+ * mode.
+ */
+class csv_formatter {
+ public:
+  /**
+   * @param[in] round_trip true to write doubles with the shortest
+   *   representation that round trips, ignoring the stream precision
+   */
+  explicit csv_formatter(bool round_trip = false) : round_trip_(round_trip) {}
+
+  /**
+   * Copy the mode of another formatter; the buffers are scratch space and
+   * start out empty, so writers holding a formatter stay copyable.
+   */
+  csv_formatter(const csv_formatter& other) : round_trip_(other.round_trip_) {}
+
+  csv_formatter& operator=(const csv_formatter& other) {
+    round_trip_ = other.round_trip_;
+    return *this;
+  }
+
+  bool round_trip() const noexcept { return round_trip_; }
+
+  /**
+   * Format values as a comma separated line ending in a newline.
+   *
+   * @tparam T <code>double</code> or <code>std::string</code>
+   * @param[in] v values to format
+   * @param[in] format stream whose formatting settings are followed
+   * @return buffer holding the line, valid until the next call
+   */
+  template <class T>
+  const std::string& format_row(const std::vector<T>& v,
+                                const std::ostream& format) {
+    buffer_.clear();
+    bool fast = fast_format(format);
+    for (size_t i = 0; i < v.size(); ++i) {
+      if (i > 0)
+        buffer_ += ',';
+      append(buffer_, v[i], format, fast);
+    }
+    buffer_ += '\n';
+    return buffer_;
+  }
+
+  /**
+   * Format values as a comma separated line ending in a newline, writing
+   * the columns of single precision as floats.
+   *
+   * @param[in] v values to format
+   * @param[in] format stream whose formatting settings are followed
+   * @param[in] precisions precision of each column; if it does not have
+   *   one per value every column is formatted as a double
+   * @return buffer holding the line, valid until the next call
+   */
+  const std::string& format_row(
+      const std::vector<double>& v, const std::ostream& format,
+      const std::vector<value_precision>& precisions) {
+    if (precisions.size() != v.size())
+      return format_row(v, format);
+    buffer_.clear();
+    bool fast = fast_format(format);
+    for (size_t i = 0; i < v.size(); ++i) {
+      if (i > 0)
+        buffer_ += ',';
+      if (precisions[i] == value_precision::float32)
+        append(buffer_, static_cast<float>(v[i]), format, fast);
+      else
+        append(buffer_, v[i], format, fast);
+    }
+    buffer_ += '\n';
+    return buffer_;
+  }
+
+  /**
+   * Return true if doubles are formatted for the stream without going
+   * through it, which holds in round trip mode or when the stream's
+   * flags and locale are the defaults.  The answer holds until the
+   * stream's flags or locale change.
+   *
+   * @param[in] format stream whose formatting settings are followed
+   */
+  bool fast_format(const std::ostream& format) const {
+    return round_trip_ || default_format(format);
+  }
+
+  /**
+   * Append a string to a buffer.
+   */
+  void append(std::string& out, const std::string& s,
+              const std::ostream& format, bool fast) {
+    out += s;
+  }
+
+  /**
+   * Append a double to a buffer, formatted as the formatter formats the
+   * values of a row.
+   *
+   * @param[in,out] out buffer to append to
+   * @param[in] x value to format
+   * @param[in] format stream whose formatting settings are followed
+   * @param[in] fast result of <code>fast_format(format)</code>
+   */
+  void append(std::string& out, double x, const std::ostream& format,
+              bool fast) {
+    if (!fast) {
+      fallback_.str(std::string());
+      fallback_.copyfmt(format);
+      fallback_ << x;
+      out += fallback_.str();
+      return;
+    }
+    char chars[64];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::to_chars_result result
+        = round_trip_ ? std::to_chars(chars, chars + sizeof(chars), x)
+                      : std::to_chars(chars, chars + sizeof(chars), x,
+                                      std::chars_format::general,
+                                      static_cast<int>(format.precision()));
+    out.append(chars, result.ptr);
+#else
+    int n = std::snprintf(
+        chars, sizeof(chars), "%.*g",
+        round_trip_ ? 17 : static_cast<int>(format.precision()), x);
+    out.append(chars, n);
+#endif
+  }
+
+  /**
+   * Append a float to a buffer with the fewest digits that parse back to
+   * it, or with the stream's formatting, at most at the precision of a
+   * float, when the stream's settings are not followed fast.
+   *
+   * @param[in,out] out buffer to append to
+   * @param[in] x value to format
+   * @param[in] format stream whose formatting settings are followed
+   * @param[in] fast result of <code>fast_format(format)</code>
+   */
+  void append(std::string& out, float x, const std::ostream& format,
+              bool fast) {
+    if (!fast) {
+      fallback_.str(std::string());
+      fallback_.copyfmt(format);
+      fallback_.precision(std::min<std::streamsize>(format.precision(), 9));
+      fallback_ << x;
+      out += fallback_.str();
+      return;
+    }
+    char chars[64];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::to_chars_result result
+        = std::to_chars(chars, chars + sizeof(chars), x);
+    out.append(chars, result.ptr);
+#else
+    int n = std::snprintf(chars, sizeof(chars), "%.9g", x);
+    out.append(chars, n);
+#endif
+  }
+
+ private:
+  bool round_trip_;
+  std::string buffer_;
+  std::ostringstream fallback_;
+
+  static bool default_format(const std::ostream& format) {
+    return (format.flags() & ~(std::ios_base::dec | std::ios_base::skipws))
+               == 0
+           && format.getloc() == std::locale::classic();
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
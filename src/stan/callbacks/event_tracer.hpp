@@ -0,0 +1,257 @@
+#ifndef STAN_CALLBACKS_EVENT_TRACER_HPP
+#define STAN_CALLBACKS_EVENT_TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>event_tracer</code> records a timeline of what the algorithms
+ * do, for viewing in the Chrome trace viewer or Perfetto: the warmup and
+ * sampling phases and the transitions of each chain, the ends of the
+ * adaptation windows, the tree doublings of NUTS, the L-BFGS iterations
+ * of Pathfinder, the writing of draws and the waits of writers whose
+ * buffer is full.
+ *
+ * A tracer records events while it is the active one, between calls to
+ * <code>start()</code> and <code>stop()</code>.  The algorithms find it
+ * with <code>active()</code> instead of taking it as an argument, so a
+ * run is traced without changing its calls; while no tracer is active,
+ * an event costs one atomic load.  Each thread records its events in its
+ * own buffer, without locking, and the buffers are merged when the trace
+ * is written, which must be after every thread is done recording.
+ *
+ * The names of the events and of their arguments must be string
+ * literals, or outlive the tracer, and need no escaping in JSON.
+ */
+class event_tracer {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  event_tracer() : id_(next_id()), origin_(clock::now()) {}
+
+  event_tracer(const event_tracer&) = delete;
+  event_tracer& operator=(const event_tracer&) = delete;
+
+  ~event_tracer() { stop(); }
+
+  /**
+   * Make this tracer the active one, in place of any other.
+   */
+  void start() { active_tracer().store(this, std::memory_order_release); }
+
+  /**
+   * Stop recording, if this tracer is the active one.
+   */
+  void stop() {
+    event_tracer* self = this;
+    active_tracer().compare_exchange_strong(self, nullptr,
+                                            std::memory_order_acq_rel);
+  }
+
+  /**
+   * Return the active tracer, or null if there is none.
+   */
+  static event_tracer* active() noexcept {
+    return active_tracer().load(std::memory_order_acquire);
+  }
+
+  /**
+   * Record an event that lasted from one time to another on the calling
+   * thread.
+   *
+   * @param[in] category category of the event
+   * @param[in] name name of the event
+   * @param[in] begin time the event began
+   * @param[in] end time the event ended
+   * @param[in] arg_name name of an integer argument, or null for none
+   * @param[in] arg value of the argument
+   */
+  void complete(const char* category, const char* name,
+                clock::time_point begin, clock::time_point end,
+                const char* arg_name = nullptr, long long arg = 0) {
+    local_buffer().events.push_back(
+        {category, name, 'X', nanoseconds(begin - origin_),
+         nanoseconds(end - begin), arg_name, arg});
+  }
+
+  /**
+   * Record an event happening now on the calling thread.
+   *
+   * @param[in] category category of the event
+   * @param[in] name name of the event
+   * @param[in] arg_name name of an integer argument, or null for none
+   * @param[in] arg value of the argument
+   */
+  void instant(const char* category, const char* name,
+               const char* arg_name = nullptr, long long arg = 0) {
+    local_buffer().events.push_back({category, name, 'i',
+                                     nanoseconds(clock::now() - origin_), 0,
+                                     arg_name, arg});
+  }
+
+  /**
+   * Return the number of events recorded.
+   */
+  size_t num_events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t n = 0;
+    for (const auto& buffer : buffers_)
+      n += buffer->events.size();
+    return n;
+  }
+
+  /**
+   * Write the events in the JSON format of Chrome traces, with times in
+   * microseconds since the tracer was constructed and the threads
+   * numbered in the order they first recorded an event.
+   *
+   * @param[in,out] out stream for the trace
+   */
+  void write(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::ios_base::fmtflags flags = out.flags();
+    const std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : buffers_) {
+      for (const trace_event& e : buffer->events) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+            << "\",\"ph\":\"" << e.phase << "\",\"ts\":" << e.begin * 1e-3;
+        if (e.phase == 'X')
+          out << ",\"dur\":" << e.duration * 1e-3;
+        else
+          out << ",\"s\":\"t\"";
+        out << ",\"pid\":1,\"tid\":" << buffer->thread;
+        if (e.arg_name)
+          out << ",\"args\":{\"" << e.arg_name << "\":" << e.arg << "}";
+        out << "}";
+      }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    out.flags(flags);
+    out.precision(precision);
+  }
+
+ private:
+  struct trace_event {
+    const char* category;
+    const char* name;
+    char phase;
+    std::int64_t begin;
+    std::int64_t duration;
+    const char* arg_name;
+    long long arg;
+  };
+
+  struct thread_buffer {
+    size_t thread;
+    std::vector<trace_event> events;
+  };
+
+  const std::uint64_t id_;
+  const clock::time_point origin_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<thread_buffer>> buffers_;
+
+  static std::atomic<event_tracer*>& active_tracer() {
+    static std::atomic<event_tracer*> tracer{nullptr};
+    return tracer;
+  }
+
+  // ids tell tracers apart in the buffer caches of the threads, even
+  // when a tracer is constructed where an earlier one was
+  static std::uint64_t next_id() {
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+  }
+
+  static std::int64_t nanoseconds(clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+
+  thread_buffer& local_buffer() {
+    thread_local std::uint64_t cached_id = 0;
+    thread_local thread_buffer* cached = nullptr;
+    if (cached_id != id_) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.emplace_back(new thread_buffer{buffers_.size(), {}});
+      cached = buffers_.back().get();
+      cached_id = id_;
+    }
+    return *cached;
+  }
+};
+
+/**
+ * <code>trace_scope</code> records an event of the active tracer lasting
+ * from its construction to its destruction, if a tracer was active when
+ * it was constructed.
+ */
+class trace_scope {
+ public:
+  /**
+   * Begin an event.
+   *
+   * @param[in] category category of the event
+   * @param[in] name name of the event
+   * @param[in] arg_name name of an integer argument, or null for none
+   * @param[in] arg value of the argument
+   */
+  trace_scope(const char* category, const char* name,
+              const char* arg_name = nullptr, long long arg = 0)
+      : tracer_(event_tracer::active()),
+        category_(category),
+        name_(name),
+        arg_name_(arg_name),
+        arg_(arg) {
+    if (tracer_)
+      begin_ = event_tracer::clock::now();
+  }
+
+  trace_scope(const trace_scope&) = delete;
+  trace_scope& operator=(const trace_scope&) = delete;
+
+  ~trace_scope() {
+    if (tracer_)
+      tracer_->complete(category_, name_, begin_,
+                        event_tracer::clock::now(), arg_name_, arg_);
+  }
+
+ private:
+  event_tracer* tracer_;
+  const char* category_;
+  const char* name_;
+  const char* arg_name_;
+  long long arg_;
+  event_tracer::clock::time_point begin_;
+};
+
+/**
+ * Record an event happening now, if a tracer is active.
+ *
+ * @param[in] category category of the event
+ * @param[in] name name of the event
+ * @param[in] arg_name name of an integer argument, or null for none
+ * @param[in] arg value of the argument
+ */
+inline void trace_instant(const char* category, const char* name,
+                          const char* arg_name = nullptr, long long arg = 0) {
+  if (event_tracer* tracer = event_tracer::active())
+    tracer->instant(category, name, arg_name, arg);
+}
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
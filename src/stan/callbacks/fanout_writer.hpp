@@ -0,0 +1,139 @@
+#ifndef STAN_CALLBACKS_FANOUT_WRITER_HPP
+#define STAN_CALLBACKS_FANOUT_WRITER_HPP
+
+#include <stan/callbacks/async_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>fanout_writer</code> is an implementation of <code>writer</code>
+ * that forwards every call to any number of sinks, each through its own
+ * <code>async_writer</code>.  Every sink has its own background thread
+ * and bounded queue, so a slow sink only ever delays the calling thread
+ * through its own overflow policy, instead of setting the pace for all
+ * of them as the sinks of a <code>tee_writer</code> do.
+ *
+ * A sink that must see every draw, such as the output file, keeps the
+ * default <code>async_writer::overflow::block</code> policy; a sink that
+ * may lose draws under load, such as a monitor, is added with the
+ * <code>async_writer::overflow::drop</code> policy and can be sent only
+ * one of every <code>keep_every</code> draws.
+ *
+ * An exception thrown by a sink is rethrown from a later call, or from
+ * <code>flush()</code>, once the other sinks have been forwarded the
+ * call.
+ */
+class fanout_writer final : public writer {
+ public:
+  /**
+   * Constructs a writer without sinks.
+   */
+  fanout_writer() {}
+
+  /**
+   * Adds a sink, which receives every call made from now on.
+   *
+   * @param[in, out] sink writer the calls are forwarded to
+   * @param[in] capacity number of calls that can be queued for the sink;
+   *   must be positive
+   * @param[in] policy what to do with a draw when the queue is full
+   * @param[in] keep_every forward one of every <code>keep_every</code>
+   *   draws; must be positive
+   * @return the asynchronous writer of the sink
+   */
+  async_writer& add_sink(
+      writer& sink, size_t capacity = 1024,
+      async_writer::overflow policy = async_writer::overflow::block,
+      size_t keep_every = 1) {
+    sinks_.push_back(
+        std::make_unique<async_writer>(sink, capacity, policy, keep_every));
+    return *sinks_.back();
+  }
+
+  /**
+   * Return the number of sinks.
+   */
+  size_t num_sinks() const noexcept { return sinks_.size(); }
+
+  /**
+   * Return the asynchronous writer of a sink.
+   *
+   * @param[in] i index of the sink, in the order they were added
+   */
+  async_writer& sink(size_t i) { return *sinks_[i]; }
+
+  void operator()(const std::vector<std::string>& names) {
+    forward([&](async_writer& sink) { sink(names); });
+  }
+
+  /**
+   * Return true if every sink takes headers as a schema.
+   */
+  bool accepts_schema() const {
+    for (const auto& sink : sinks_)
+      if (!sink->accepts_schema())
+        return false;
+    return true;
+  }
+
+  void operator()(const output_schema& schema) {
+    forward([&](async_writer& sink) { sink(schema); });
+  }
+
+  void operator()(const std::vector<double>& state) {
+    forward([&](async_writer& sink) { sink(state); });
+  }
+
+  void operator()() {
+    forward([](async_writer& sink) { sink(); });
+  }
+
+  void operator()(const std::string& message) {
+    forward([&](async_writer& sink) { sink(message); });
+  }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    forward([&](async_writer& sink) { sink(values); });
+  }
+
+  /**
+   * Waits until every sink has written its queued calls, then flushes
+   * the sinks.
+   */
+  void flush() {
+    forward([](async_writer& sink) { sink.flush(); });
+  }
+
+ private:
+  std::vector<std::unique_ptr<async_writer>> sinks_;
+
+  /**
+   * Make a call on every sink, rethrowing the first exception once all
+   * of them have been called.
+   */
+  template <typename F>
+  void forward(const F& call) {
+    std::exception_ptr error;
+    for (auto& sink : sinks_) {
+      try {
+        call(*sink);
+      } catch (...) {
+        if (!error)
+          error = std::current_exception();
+      }
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
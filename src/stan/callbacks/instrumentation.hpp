@@ -0,0 +1,122 @@
+#ifndef STAN_CALLBACKS_INSTRUMENTATION_HPP
+#define STAN_CALLBACKS_INSTRUMENTATION_HPP
+
+#include <cstddef>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * Measurements of one MCMC transition and the writing of its draw.
+ */
+struct transition_stats {
+  /**
+   * Id of the chain.
+   */
+  std::size_t chain_id = 1;
+
+  /**
+   * Iteration number, counting from one over warmup and sampling.
+   */
+  int iteration = 0;
+
+  /**
+   * Iteration number of the last transition of the run, over warmup and
+   * sampling.
+   */
+  int num_iterations = 0;
+
+  /**
+   * True if the transition is a warmup transition.
+   */
+  bool warmup = false;
+
+  /**
+   * Wall time in seconds of the transition.
+   */
+  double transition_time = 0;
+
+  /**
+   * Wall time in seconds of the transition spent evaluating gradients,
+   * the rest being the overhead of the sampler and its adaptation.
+   */
+  double gradient_time = 0;
+
+  /**
+   * Wall time in seconds spent writing the draw, zero if it was not
+   * written.
+   */
+  double write_time = 0;
+
+  /**
+   * Number of gradients evaluated in the transition.
+   */
+  std::size_t num_gradients = 0;
+
+  /**
+   * Number of leapfrog steps of the transition, from the
+   * <code>n_leapfrog__</code> sampler parameter, or -1 if the sampler
+   * does not report it.
+   */
+  int num_leapfrog = -1;
+
+  /**
+   * Depth of the trajectory tree of the transition, from the
+   * <code>treedepth__</code> sampler parameter, or -1 if the sampler does
+   * not report it.
+   */
+  int tree_depth = -1;
+
+  /**
+   * Number of entries the last gradient of the transition put on the
+   * autodiff stack.
+   */
+  std::size_t ad_stack_size = 0;
+
+  /**
+   * Bytes allocated on the heap for the autodiff tape in the transition.
+   */
+  std::size_t bytes_allocated = 0;
+
+  /**
+   * Bytes the arena of the autodiff stack of the chain held after the
+   * transition.  The arena only grows, so this is its peak size so far.
+   */
+  std::size_t ad_arena_bytes = 0;
+
+  /**
+   * Bytes of storage held by the sampler after the transition: its
+   * state, its metric and the estimators of its adaptation.
+   */
+  std::size_t sampler_bytes = 0;
+};
+
+/**
+ * <code>instrumentation</code> is a base class defining the interface
+ * for Stan instrumentation callbacks, which receive measurements of the
+ * work of each MCMC transition.
+ *
+ * Instrumentation is optional: the algorithms take a pointer to it, and
+ * do not measure anything when it is null.  The gradients are only timed
+ * while an instrumentation callback is given, which adds two reads of
+ * the clock to every gradient.
+ */
+class instrumentation {
+ public:
+  /**
+   * Callback function, called after each transition and the writing of
+   * its draw.
+   *
+   * @param[in] stats measurements of the transition
+   */
+  virtual void operator()(const transition_stats& stats) {}
+
+  /**
+   * Virtual destructor.
+   */
+  virtual ~instrumentation() {}
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -21,6 +21,14 @@ class interrupt {
    */
   virtual void operator()() {}
 
+  /**
+   * Return true if the algorithm should stop early, at the end of the
+   * current iteration, and finish normally with the output produced
+   * so far.  Unlike an exception thrown by the callback, this lets the
+   * algorithm write its remaining output.
+   */
+  virtual bool stop_requested() const { return false; }
+
   /**
    * Virtual destructor.
    */
@@ -3,9 +3,13 @@
 
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <stan/math/prim/meta.hpp>
+#include <stan/callbacks/csv_formatter.hpp>
 #include <stan/callbacks/structured_writer.hpp>
+#include <charconv>
 #include <ostream>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include <memory>
 #include <cstring>
@@ -24,6 +28,13 @@ namespace callbacks {
  * The writer doesn't try to validate the object's internal structure
  * or object completeness, only syntactic correctness.
  *
+ * Numeric values are formatted into a buffer that is handed to the
+ * stream in chunks of <code>CHUNK_SIZE</code> characters, so an array or
+ * matrix of any size takes a few writes to the stream rather than several
+ * per element.  Doubles are formatted as <code>operator<<</code> would
+ * format them with the stream's precision, without going through the
+ * stream unless the stream's flags or locale are not the defaults.
+ *
  * @tparam Stream A type with with a valid `operator<<(std::string)`
  * @tparam Deleter A class with a valid `operator()` method for deleting the
  * output stream
@@ -38,6 +49,40 @@ class json_writer final : public structured_writer {
   // Depth of records (used to determine whether or not to print comma
   // separator)
   int record_depth_ = 0;
+  // Formats doubles for the stream
+  csv_formatter formatter_;
+  // Numeric output not yet written to the stream
+  std::string buffer_;
+
+  /**
+   * Return the stream whose formatting settings numbers follow, which is
+   * the output stream when it is a <code>std::ostream</code>.
+   */
+  const std::ostream& format() const {
+    if constexpr (std::is_base_of<std::ostream, Stream>::value) {
+      return *output_;
+    } else {
+      static const std::ostringstream default_format;
+      return default_format;
+    }
+  }
+
+  /**
+   * Write the buffered output to the stream.
+   */
+  void write_buffer() {
+    *output_ << buffer_;
+    buffer_.clear();
+  }
+
+  /**
+   * Write the buffered output to the stream once it holds a chunk.
+   */
+  void write_full_buffer() {
+    if (buffer_.size() >= CHUNK_SIZE) {
+      write_buffer();
+    }
+  }
 
   /**
    * Determines whether a record's internal object requires a comma separator
@@ -112,57 +157,94 @@ class json_writer final : public structured_writer {
   }
 
   /**
-   * Writes a single value.  Corrects capitalization for inf and nans.
+   * Buffers a single value.  Corrects capitalization for inf and nans.
    *
    * @param[in] v value
+   * @param[in] fast result of <code>formatter_.fast_format(format())</code>
    */
-  void write_value(double v) {
+  void append_value(double v, bool fast) {
     if (unlikely(std::isinf(v))) {
       if (v > 0) {
-        *output_ << "Inf";
+        buffer_ += "Inf";
       } else {
-        *output_ << "-Inf";
+        buffer_ += "-Inf";
       }
     } else if (unlikely(std::isnan(v))) {
-      *output_ << "NaN";
+      buffer_ += "NaN";
+    } else {
+      formatter_.append(buffer_, v, format(), fast);
+    }
+  }
+
+  /**
+   * Buffers a single integer.
+   *
+   * @param[in] v value
+   * @param[in] fast result of <code>formatter_.fast_format(format())</code>
+   */
+  void append_value(int v, bool fast) {
+    if (fast) {
+      char chars[16];
+      std::to_chars_result result = std::to_chars(chars, chars + 16, v);
+      buffer_.append(chars, result.ptr);
     } else {
+      write_buffer();
       *output_ << v;
     }
   }
 
   /**
-   * Writes a single complex value.
+   * Buffers a single complex value.
    *
    * @param[in] v value
+   * @param[in] fast result of <code>formatter_.fast_format(format())</code>
    */
-  void write_complex_value(std::complex<double> v) {
-    *output_ << "[";
-    write_value(v.real());
-    *output_ << ", ";
-    write_value(v.imag());
-    *output_ << "]";
+  void append_value(const std::complex<double>& v, bool fast) {
+    buffer_ += '[';
+    append_value(v.real(), fast);
+    buffer_ += ", ";
+    append_value(v.imag(), fast);
+    buffer_ += ']';
   }
 
   /**
-   * Writes the set of comma separated values in an Eigen (row) vector.
+   * Buffers the set of comma separated values in a vector or an Eigen
+   * (row) vector.
    *
-   * @param[in] v Values in an `Eigen::Vector`
+   * @param[in] v values
+   * @param[in] fast result of <code>formatter_.fast_format(format())</code>
    */
-  template <typename Derived>
-  void write_eigen_vector(const Eigen::DenseBase<Derived>& v) {
-    *output_ << "[ ";
-    if (v.size() > 0) {
-      size_t last = v.size() - 1;
-      for (Eigen::Index i = 0; i < last; ++i) {
-        write_value(v[i]);
-        *output_ << ", ";
+  template <typename Vector>
+  void append_vector(const Vector& v, bool fast) {
+    buffer_ += "[ ";
+    for (size_t i = 0; i < static_cast<size_t>(v.size()); ++i) {
+      if (i > 0) {
+        buffer_ += ", ";
       }
-      write_value(v[last]);
+      append_value(v[i], fast);
+      write_full_buffer();
     }
-    *output_ << " ]";
+    buffer_ += " ]";
+  }
+
+  /**
+   * Writes a vector of numbers, read by elements, as a list.
+   *
+   * @param[in] v values
+   */
+  template <typename Vector>
+  void write_vector(const Vector& v) {
+    append_vector(v, formatter_.fast_format(format()));
+    write_buffer();
   }
 
  public:
+  /**
+   * Number of buffered characters of numeric output written to the stream
+   * at a time.
+   */
+  static constexpr size_t CHUNK_SIZE = 1 << 16;
+
   /**
    * Constructs a no-op json writer.
    *
@@ -335,7 +417,8 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-    write_value(value);
+    append_value(value, formatter_.fast_format(format()));
+    write_buffer();
   }
 
   /**
@@ -349,7 +432,8 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-    write_complex_value(value);
+    append_value(value, formatter_.fast_format(format()));
+    write_buffer();
   }
 
   /**
@@ -386,18 +470,7 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-
-    *output_ << "[ ";
-    if (values.size() > 0) {
-      auto last = values.end();
-      --last;
-      for (auto it = values.begin(); it != last; ++it) {
-        write_value(*it);
-        *output_ << ", ";
-      }
-      write_value(values.back());
-    }
-    *output_ << " ]";
+    write_vector(values);
   }
 
   /**
@@ -411,16 +484,7 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-
-    *output_ << "[ ";
-    if (values.size() > 0) {
-      auto last = values.end();
-      --last;
-      for (auto it = values.begin(); it != last; ++it) {
-        *output_ << *it << ", ";
-      }
-    }
-    *output_ << values.back() << " ]";
+    write_vector(values);
   }
 
   /**
@@ -435,17 +499,7 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-
-    *output_ << "[ ";
-    if (values.size() > 0) {
-      size_t last = values.size() - 1;
-      for (size_t i = 0; i < last; ++i) {
-        write_complex_value(values[i]);
-        *output_ << ", ";
-      }
-      write_complex_value(values[last]);
-    }
-    *output_ << " ]";
+    write_vector(values);
   }
 
   /**
@@ -459,7 +513,7 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-    write_eigen_vector(vec);
+    write_vector(vec);
   }
 
   /**
@@ -473,7 +527,7 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-    write_eigen_vector(vec);
+    write_vector(vec);
   }
 
   /**
@@ -487,16 +541,16 @@ class json_writer final : public structured_writer {
     }
     write_sep();
     write_key(key);
-    *output_ << "[ ";
-    if (mat.rows() > 0) {
-      Eigen::Index last = mat.rows() - 1;
-      for (Eigen::Index i = 0; i < last; ++i) {
-        write_eigen_vector(mat.row(i));
-        *output_ << ", ";
+    const bool fast = formatter_.fast_format(format());
+    buffer_ += "[ ";
+    for (Eigen::Index i = 0; i < mat.rows(); ++i) {
+      if (i > 0) {
+        buffer_ += ", ";
       }
-      write_eigen_vector(mat.row(last));
+      append_vector(mat.row(i), fast);
     }
-    *output_ << " ]";
+    buffer_ += " ]";
+    write_buffer();
   }
 };
 
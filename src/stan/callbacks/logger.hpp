@@ -7,6 +7,11 @@
 namespace stan {
 namespace callbacks {
 
+/**
+ * Levels of the messages of a <code>logger</code>, in order.
+ */
+enum class log_level { debug, info, warn, error, fatal };
+
 /**
  * The <code>logger</code> class defines the callback
  * used by Stan's algorithms to log messages in the
@@ -25,6 +30,16 @@ class logger {
  public:
   virtual ~logger() {}
 
+  /**
+   * Return false if messages of the level are discarded, so that callers
+   * can skip building them.  Messages may still be logged at a level that
+   * is not enabled, and are then discarded.  By default every level is
+   * enabled.
+   *
+   * @param[in] level log level
+   */
+  virtual bool is_enabled(log_level level) const { return true; }
+
   /**
    * Logs a message with debug log level
    *
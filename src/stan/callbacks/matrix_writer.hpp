@@ -0,0 +1,175 @@
+#ifndef STAN_CALLBACKS_MATRIX_WRITER_HPP
+#define STAN_CALLBACKS_MATRIX_WRITER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>matrix_writer</code> is a writer that stores the draws it
+ * receives directly in a buffer the caller allocated, one row per draw
+ * and one column per name of the header, for interfaces that embed Stan
+ * and hold the draws in memory.  The number of rows is known before the
+ * run from the arguments of the service, for instance with
+ * <code>num_draws()</code>.
+ *
+ * The number of rows written is published after each row is complete, so
+ * another thread may read the rows below <code>num_rows_written()</code>
+ * while sampling continues.  Comments and blank lines are not kept; a
+ * <code>tee_writer</code> passes them on to another writer.
+ */
+class matrix_writer : public writer {
+ public:
+  enum class layout { row_major, column_major };
+
+  /**
+   * Constructs a matrix writer.
+   *
+   * @param[in, out] buffer memory for <code>num_rows</code> times
+   *   <code>num_cols</code> values, owned by the caller, which must
+   *   outlive the writer
+   * @param[in] num_rows number of draws the buffer holds
+   * @param[in] num_cols number of values of each draw
+   * @param[in] order whether the values of a draw or those of a column
+   *   are contiguous
+   * @throw std::invalid_argument if <code>buffer</code> is null and the
+   *   buffer is not empty
+   */
+  matrix_writer(double* buffer, size_t num_rows, size_t num_cols,
+                layout order = layout::row_major)
+      : buffer_(buffer),
+        num_rows_(num_rows),
+        num_cols_(num_cols),
+        order_(order) {
+    if (buffer_ == nullptr && num_rows_ * num_cols_ > 0)
+      throw std::invalid_argument("matrix_writer: buffer is null");
+  }
+
+  /**
+   * Receives the header, which must have a name per column.
+   *
+   * @param[in] names names of the columns
+   * @throw std::invalid_argument if the number of names is not the
+   *   number of columns
+   */
+  void operator()(const std::vector<std::string>& names) {
+    if (names.size() != num_cols_)
+      throw std::invalid_argument(
+          "matrix_writer: expecting " + std::to_string(num_cols_)
+          + " columns, found " + std::to_string(names.size()) + " names");
+    names_ = names;
+  }
+
+  /**
+   * Copies a draw into the next row.
+   *
+   * @param[in] state values of the draw
+   * @throw std::invalid_argument if the number of values is not the
+   *   number of columns
+   * @throw std::out_of_range if every row is already written
+   */
+  void operator()(const std::vector<double>& state) {
+    if (state.size() != num_cols_)
+      throw std::invalid_argument(
+          "matrix_writer: expecting " + std::to_string(num_cols_)
+          + " values, found " + std::to_string(state.size()));
+    const size_t row = next_row();
+    for (size_t j = 0; j < num_cols_; ++j)
+      at(row, j) = state[j];
+    rows_written_.store(row + 1, std::memory_order_release);
+  }
+
+  /**
+   * Copies each column of a matrix of values into the next row.
+   *
+   * @param[in] values values, a parameter per row and a draw per column
+   * @throw std::invalid_argument if the number of rows of the values is
+   *   not the number of columns
+   * @throw std::out_of_range if every row is already written
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    if (static_cast<size_t>(values.rows()) != num_cols_)
+      throw std::invalid_argument(
+          "matrix_writer: expecting " + std::to_string(num_cols_)
+          + " values, found " + std::to_string(values.rows()));
+    for (Eigen::Index d = 0; d < values.cols(); ++d) {
+      const size_t row = next_row();
+      for (size_t j = 0; j < num_cols_; ++j)
+        at(row, j) = values(j, d);
+      rows_written_.store(row + 1, std::memory_order_release);
+    }
+  }
+
+  void operator()() {}
+
+  void operator()(const std::string& message) {}
+
+  /**
+   * Return the number of rows written so far.  The values of those rows
+   * may be read from any thread once this returns.
+   */
+  size_t num_rows_written() const noexcept {
+    return rows_written_.load(std::memory_order_acquire);
+  }
+
+  size_t num_rows() const noexcept { return num_rows_; }
+
+  size_t num_cols() const noexcept { return num_cols_; }
+
+  /**
+   * Return the names of the columns, empty until a header is received.
+   */
+  const std::vector<std::string>& names() const noexcept { return names_; }
+
+  /**
+   * Return the number of draws a sampler writes, for the number of rows
+   * of the buffer of its sample writer.
+   *
+   * @param[in] num_warmup number of warmup iterations
+   * @param[in] num_samples number of sampling iterations
+   * @param[in] num_thin period of the saved iterations
+   * @param[in] save_warmup whether warmup iterations are saved
+   */
+  static size_t num_draws(int num_warmup, int num_samples, int num_thin,
+                          bool save_warmup) {
+    if (num_thin < 1)
+      num_thin = 1;
+    auto saved = [num_thin](int n) {
+      return n > 0 ? static_cast<size_t>((n + num_thin - 1) / num_thin) : 0;
+    };
+    return saved(num_samples) + (save_warmup ? saved(num_warmup) : 0);
+  }
+
+ private:
+  double* buffer_;
+  size_t num_rows_;
+  size_t num_cols_;
+  layout order_;
+  std::vector<std::string> names_;
+  std::atomic<size_t> rows_written_{0};
+
+  // only the sampling thread writes, so the count read back is its own
+  size_t next_row() const {
+    const size_t row = rows_written_.load(std::memory_order_relaxed);
+    if (row == num_rows_)
+      throw std::out_of_range("matrix_writer: all "
+                              + std::to_string(num_rows_)
+                              + " rows are written");
+    return row;
+  }
+
+  double& at(size_t row, size_t col) {
+    return order_ == layout::row_major ? buffer_[row * num_cols_ + col]
+                                       : buffer_[col * num_rows_ + row];
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,308 @@
+#ifndef STAN_CALLBACKS_MULTI_CHAIN_WRITER_HPP
+#define STAN_CALLBACKS_MULTI_CHAIN_WRITER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>multi_chain_writer</code> writes the draws of all of the chains
+ * of a run to a single file, which the chains append to concurrently,
+ * instead of one file per chain to merge afterwards.
+ *
+ * Each chain writes through its own <code>chain_writer</code>, which
+ * buffers its draws into blocks of <code>block_rows</code> draws.  A full
+ * block is written at an offset reserved by an atomic addition to the end
+ * of the file, through a file stream of the chain, so chains never wait
+ * for each other.  Blocks are all the same size, so a block reserves its
+ * space before its values are known.
+ *
+ * The file, in native byte order with integers as
+ * <code>std::uint64_t</code>, is made of
+ *
+ * - a preamble of <code>ALIGNMENT</code> bytes starting with the magic
+ *   string <code>MAGIC</code>;
+ * - the blocks, each a header of <code>ALIGNMENT</code> bytes with the id
+ *   of its chain and its number of draws, then the values of each column
+ *   in turn as <code>block_rows</code> doubles, of which only the first
+ *   number of draws are set;
+ * - an index footer with the number of rows of a block, the names of the
+ *   columns as a count followed by each name as its length and its
+ *   characters, and the number of chains, then for each chain its id,
+ *   its number of draws, the offsets of its blocks in order as a count
+ *   followed by the offsets, and its comments as names are written;
+ * - the offset of the footer and the magic string <code>END_MAGIC</code>.
+ *
+ * The footer is written by <code>close</code>, which is called by the
+ * destructor, once every chain is done.  A file without a footer, left
+ * by a run that did not finish, can not be read.
+ *
+ * The chain writers are made before the chains start and must not be
+ * used after <code>close</code>; all of the chains must have the same
+ * header.  The file is read by <code>io::multi_chain_reader</code>.
+ */
+class multi_chain_writer {
+ public:
+  static constexpr const char* MAGIC = "STANMCW1";
+  static constexpr const char* END_MAGIC = "STANMCWE";
+  static constexpr std::uint64_t ALIGNMENT = 64;
+
+ private:
+  struct chain_state {
+    std::size_t chain_id = 0;
+    std::fstream file;
+    Eigen::MatrixXd block;
+    std::size_t num_buffered = 0;
+    std::size_t num_draws = 0;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::string> comments;
+  };
+
+ public:
+  /**
+   * <code>chain_writer</code> is the writer of the draws of one chain
+   * into a <code>multi_chain_writer</code>.  Headers must be the same for
+   * all chains, comments are kept for the index, and draws are buffered
+   * into blocks.  It is a handle to the state of the chain kept by the
+   * multi-chain writer, so copies write to the same chain.
+   */
+  class chain_writer : public writer {
+   public:
+    /**
+     * @throw std::invalid_argument if the header differs from that of
+     *   another chain, or if it is given after draws
+     */
+    void operator()(const std::vector<std::string>& names) {
+      owner_->set_header(names, state_->num_draws + state_->num_buffered);
+      if (state_->block.cols() != static_cast<Eigen::Index>(names.size()))
+        state_->block.resize(owner_->block_rows_, names.size());
+    }
+
+    /**
+     * @throw std::invalid_argument if the draw does not have a value for
+     *   each column of the header
+     */
+    void operator()(const std::vector<double>& state) {
+      if (state.empty())
+        return;
+      if (static_cast<Eigen::Index>(state.size()) != state_->block.cols())
+        throw std::invalid_argument(
+            "multi_chain_writer: a draw does not match the header");
+      state_->block.row(state_->num_buffered)
+          = Eigen::Map<const Eigen::RowVectorXd>(state.data(), state.size());
+      if (++state_->num_buffered == owner_->block_rows_)
+        owner_->write_block(*state_);
+    }
+
+    void operator()() { state_->comments.emplace_back(); }
+
+    void operator()(const std::string& message) {
+      state_->comments.push_back(message);
+    }
+
+    /**
+     * Write the buffered draws as a block.
+     */
+    void flush() {
+      if (state_->num_buffered > 0)
+        owner_->write_block(*state_);
+      state_->file.flush();
+    }
+
+    std::size_t chain_id() const noexcept { return state_->chain_id; }
+
+   private:
+    friend class multi_chain_writer;
+    chain_writer(multi_chain_writer* owner, chain_state* state)
+        : owner_(owner), state_(state) {}
+    multi_chain_writer* owner_;
+    chain_state* state_;
+  };
+
+  /**
+   * Create the file, writing its preamble.
+   *
+   * @param[in] filename name of the file
+   * @param[in] block_rows number of draws of a block; must be positive
+   * @throw std::invalid_argument if <code>block_rows</code> is zero or
+   *   the file can not be created
+   */
+  explicit multi_chain_writer(const std::string& filename,
+                              std::size_t block_rows = 256)
+      : filename_(filename), block_rows_(block_rows), end_(ALIGNMENT) {
+    if (block_rows_ == 0)
+      throw std::invalid_argument(
+          "multi_chain_writer: block_rows must be positive");
+    file_.open(filename_, std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!file_)
+      throw std::invalid_argument("multi_chain_writer: can not create "
+                                  + filename_);
+    std::vector<char> preamble(ALIGNMENT, 0);
+    std::copy(MAGIC, MAGIC + 8, preamble.begin());
+    file_.write(preamble.data(), preamble.size());
+    file_.flush();
+  }
+
+  multi_chain_writer(const multi_chain_writer&) = delete;
+  multi_chain_writer& operator=(const multi_chain_writer&) = delete;
+
+  /**
+   * Write the index footer if it was not written yet.
+   */
+  ~multi_chain_writer() {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  /**
+   * Return a writer for each of the specified number of chains, with
+   * consecutive ids, to give the multi-chain services as their sample
+   * writers.  It must be called before the chains start.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] init_chain_id id of the first chain
+   * @throw std::invalid_argument if a chain of one of the ids already has
+   *   a writer
+   */
+  std::vector<chain_writer> chain_writers(std::size_t num_chains,
+                                          std::size_t init_chain_id = 1) {
+    std::vector<chain_writer> writers;
+    for (std::size_t i = 0; i < num_chains; ++i) {
+      const std::size_t chain_id = init_chain_id + i;
+      for (const auto& chain : chains_)
+        if (chain->chain_id == chain_id)
+          throw std::invalid_argument(
+              "multi_chain_writer: chain " + std::to_string(chain_id)
+              + " already has a writer");
+      chains_.emplace_back(new chain_state());
+      chain_state& chain = *chains_.back();
+      chain.chain_id = chain_id;
+      chain.file.open(filename_,
+                      std::ios::in | std::ios::out | std::ios::binary);
+      if (!chain.file)
+        throw std::invalid_argument("multi_chain_writer: can not open "
+                                    + filename_);
+      writers.push_back(chain_writer(this, &chain));
+    }
+    return writers;
+  }
+
+  /**
+   * Write the buffered draws of every chain and the index footer.  It
+   * must only be called once the chains are done; later calls do
+   * nothing.
+   */
+  void close() {
+    if (closed_)
+      return;
+    closed_ = true;
+    for (auto& chain : chains_) {
+      if (chain->num_buffered > 0)
+        write_block(*chain);
+      chain->file.close();
+    }
+    const std::uint64_t footer = end_.load();
+    file_.seekp(footer);
+    write_size(block_rows_);
+    write_size(names_.size());
+    for (const std::string& name : names_)
+      write_string(name);
+    write_size(chains_.size());
+    for (const auto& chain : chains_) {
+      write_size(chain->chain_id);
+      write_size(chain->num_draws);
+      write_size(chain->offsets.size());
+      for (std::uint64_t offset : chain->offsets)
+        write_size(offset);
+      write_size(chain->comments.size());
+      for (const std::string& comment : chain->comments)
+        write_string(comment);
+    }
+    write_size(footer);
+    file_.write(END_MAGIC, 8);
+    file_.close();
+  }
+
+  /**
+   * Return the size in bytes of a block of the specified number of
+   * columns.
+   */
+  std::uint64_t block_bytes(std::size_t num_cols) const noexcept {
+    const std::uint64_t bytes = ALIGNMENT + block_rows_ * num_cols * 8;
+    return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+ private:
+  std::string filename_;
+  std::size_t block_rows_;
+  std::ofstream file_;
+  std::vector<std::unique_ptr<chain_state>> chains_;
+  std::atomic<std::uint64_t> end_;
+  std::once_flag header_once_;
+  std::vector<std::string> names_;
+  bool closed_ = false;
+
+  void set_header(const std::vector<std::string>& names,
+                  std::size_t num_written) {
+    std::call_once(header_once_, [&] { names_ = names; });
+    if (names != names_)
+      throw std::invalid_argument(
+          "multi_chain_writer: the chains have different headers");
+    if (num_written > 0)
+      throw std::invalid_argument(
+          "multi_chain_writer: a header was given after draws");
+  }
+
+  void write_block(chain_state& chain) {
+    const Eigen::Index cols = chain.block.cols();
+    const std::uint64_t offset = end_.fetch_add(block_bytes(cols));
+    std::vector<char> header(ALIGNMENT, 0);
+    const std::uint64_t fields[2] = {chain.chain_id, chain.num_buffered};
+    std::memcpy(header.data(), fields, sizeof(fields));
+    chain.file.seekp(offset);
+    chain.file.write(header.data(), header.size());
+    if (chain.num_buffered < block_rows_)
+      chain.block.bottomRows(block_rows_ - chain.num_buffered).setZero();
+    chain.file.write(reinterpret_cast<const char*>(chain.block.data()),
+                     chain.block.size() * sizeof(double));
+    const std::uint64_t padding
+        = block_bytes(cols) - ALIGNMENT - chain.block.size() * sizeof(double);
+    if (padding > 0) {
+      const std::vector<char> zeros(padding, 0);
+      chain.file.write(zeros.data(), zeros.size());
+    }
+    if (!chain.file)
+      throw std::runtime_error("multi_chain_writer: can not write "
+                               + filename_);
+    chain.offsets.push_back(offset);
+    chain.num_draws += chain.num_buffered;
+    chain.num_buffered = 0;
+  }
+
+  void write_size(std::uint64_t n) {
+    file_.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+
+  void write_string(const std::string& s) {
+    write_size(s.size());
+    file_.write(s.data(), s.size());
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,193 @@
+#ifndef STAN_CALLBACKS_OUTPUT_SCHEMA_HPP
+#define STAN_CALLBACKS_OUTPUT_SCHEMA_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * Precision at which the values of a variable are written.  Writers that
+ * store binary values keep single precision columns as
+ * <code>float</code>s and text writers write them with the fewest digits
+ * that parse back to the same <code>float</code>; the values are still
+ * passed to the writers as doubles.
+ */
+enum class value_precision { float64, float32 };
+
+/**
+ * A variable of an <code>output_schema</code>: its name, its dimensions,
+ * which are empty for a scalar, and the precision of its values.
+ */
+struct schema_variable {
+  std::string name;
+  std::vector<size_t> dims;
+  value_precision precision = value_precision::float64;
+
+  /**
+   * Return the number of columns of the variable.
+   */
+  size_t size() const {
+    size_t n = 1;
+    for (size_t d : dims)
+      n *= d;
+    return n;
+  }
+};
+
+/**
+ * <code>output_schema</code> describes the columns of a set of draws
+ * compactly, as one entry per variable with its dimensions rather than
+ * one name per column.  A model with millions of scalars has a schema
+ * with one entry per variable of its program, so building and writing
+ * it costs nothing next to the draws.
+ *
+ * The columns of a variable are in column major order, the first index
+ * varying fastest, as in Stan's output.  Complex scalars are a trailing
+ * dimension of 2 and tuples have the dimensions the model reports for
+ * them through <code>get_dims</code>.
+ */
+class output_schema {
+ public:
+  output_schema() {}
+
+  /**
+   * Construct a schema from its variables.
+   *
+   * @param[in] variables variables in column order
+   */
+  explicit output_schema(std::vector<schema_variable> variables)
+      : variables_(std::move(variables)) {}
+
+  /**
+   * Return the variables in column order.
+   */
+  const std::vector<schema_variable>& variables() const noexcept {
+    return variables_;
+  }
+
+  /**
+   * Append a scalar.
+   *
+   * @param[in] name name of the scalar
+   * @param[in] precision precision of its values
+   */
+  void add(const std::string& name,
+           value_precision precision = value_precision::float64) {
+    variables_.push_back(schema_variable{name, {}, precision});
+  }
+
+  /**
+   * Append a variable.
+   *
+   * @param[in] name name of the variable
+   * @param[in] dims dimensions of the variable
+   * @param[in] precision precision of its values
+   */
+  void add(const std::string& name, const std::vector<size_t>& dims,
+           value_precision precision = value_precision::float64) {
+    variables_.push_back(schema_variable{name, dims, precision});
+  }
+
+  /**
+   * Set the precision of the variables satisfying a predicate.
+   *
+   * @tparam F type of the predicate
+   * @param[in] selects predicate on the variable names
+   * @param[in] precision precision of their values
+   */
+  template <typename F>
+  void set_precision(const F& selects, value_precision precision) {
+    for (schema_variable& variable : variables_)
+      if (selects(variable.name))
+        variable.precision = precision;
+  }
+
+  /**
+   * Return true if some variable is written in single precision.
+   */
+  bool reduced_precision() const {
+    for (const schema_variable& variable : variables_)
+      if (variable.precision == value_precision::float32)
+        return true;
+    return false;
+  }
+
+  /**
+   * Return the precision of each column.
+   */
+  std::vector<value_precision> column_precisions() const {
+    std::vector<value_precision> precisions;
+    precisions.reserve(num_columns());
+    for (const schema_variable& variable : variables_)
+      precisions.insert(precisions.end(), variable.size(),
+                        variable.precision);
+    return precisions;
+  }
+
+  /**
+   * Append the variables of a model, from its parameter names and
+   * dimensions.
+   *
+   * @tparam Model type of model
+   * @param[in] model model
+   * @param[in] include_tparams true to include transformed parameters
+   * @param[in] include_gqs true to include generated quantities
+   */
+  template <class Model>
+  void add_model(const Model& model, bool include_tparams = true,
+                 bool include_gqs = true) {
+    std::vector<std::string> names;
+    std::vector<std::vector<size_t>> dims;
+    model.get_param_names(names, include_tparams, include_gqs);
+    model.get_dims(dims, include_tparams, include_gqs);
+    for (size_t i = 0; i < names.size(); ++i)
+      add(names[i], dims[i]);
+  }
+
+  /**
+   * Return the number of columns.
+   */
+  size_t num_columns() const {
+    size_t n = 0;
+    for (const schema_variable& variable : variables_)
+      n += variable.size();
+    return n;
+  }
+
+  /**
+   * Append one name per column, the variable name followed by the
+   * one-based indices of the column separated by periods.  These are the
+   * names Stan writes for real-valued variables; complex and tuple
+   * variables are named by their indices alone.
+   *
+   * @param[in,out] names names to append to
+   */
+  void flatten(std::vector<std::string>& names) const {
+    names.reserve(names.size() + num_columns());
+    std::vector<size_t> index;
+    for (const schema_variable& variable : variables_) {
+      const size_t size = variable.size();
+      index.assign(variable.dims.size(), 0);
+      for (size_t c = 0; c < size; ++c) {
+        std::string name = variable.name;
+        for (size_t i : index)
+          name += '.' + std::to_string(i + 1);
+        names.push_back(std::move(name));
+        for (size_t k = 0; k < index.size() && ++index[k] == variable.dims[k];
+             ++k)
+          index[k] = 0;
+      }
+    }
+  }
+
+ private:
+  std::vector<schema_variable> variables_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
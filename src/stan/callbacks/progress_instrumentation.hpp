@@ -0,0 +1,279 @@
+#ifndef STAN_CALLBACKS_PROGRESS_INSTRUMENTATION_HPP
+#define STAN_CALLBACKS_PROGRESS_INSTRUMENTATION_HPP
+
+#include <stan/callbacks/instrumentation.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * Throughput of a chain over the transitions since its last progress
+ * event.
+ */
+struct progress {
+  std::size_t chain_id = 1;
+  int iteration = 0;
+  int num_iterations = 0;
+  bool warmup = false;
+  double iterations_per_second = 0;
+  /** Leapfrog steps per second, zero if the sampler does not report them. */
+  double leapfrogs_per_second = 0;
+  double gradients_per_second = 0;
+  /** Seconds to the last iteration at the current rate, NaN if unknown. */
+  double eta = std::numeric_limits<double>::quiet_NaN();
+  /**
+   * Number of the transitions with each tree depth, from zero up to the
+   * deepest one, empty if the sampler does not report tree depths.
+   */
+  std::vector<int> tree_depths;
+};
+
+/**
+ * <code>progress_board</code> gathers the latest progress of concurrent
+ * chains, so that a scheduler can read the throughput of a run while it
+ * goes on.
+ *
+ * Each chain owns a slot, on its own cache line, which only its
+ * <code>progress_instrumentation</code> stores to, so chains publishing
+ * their progress neither lock nor contend.  Readers load the slots with
+ * no lock either; the fields of a slot are each consistent but may be
+ * from successive events.
+ */
+class progress_board {
+ public:
+  /**
+   * @param[in] num_chains number of chains, with ids from 1
+   */
+  explicit progress_board(std::size_t num_chains) : slots_(num_chains) {}
+
+  std::size_t num_chains() const noexcept { return slots_.size(); }
+
+  /**
+   * Store the progress of a chain in its slot.
+   *
+   * @param[in] p progress of the chain
+   * @throw std::out_of_range if the id of the chain is not that of a slot
+   */
+  void publish(const progress& p) {
+    slot& s = at(p.chain_id);
+    s.iteration.store(p.iteration, std::memory_order_relaxed);
+    s.num_iterations.store(p.num_iterations, std::memory_order_relaxed);
+    s.iterations_per_second.store(p.iterations_per_second,
+                                  std::memory_order_relaxed);
+    s.leapfrogs_per_second.store(p.leapfrogs_per_second,
+                                 std::memory_order_relaxed);
+    s.gradients_per_second.store(p.gradients_per_second,
+                                 std::memory_order_relaxed);
+    s.eta.store(p.eta, std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the fraction of the iterations of all chains done.
+   */
+  double fraction_done() const {
+    double done = 0;
+    double total = 0;
+    for (const slot& s : slots_) {
+      done += s.iteration.load(std::memory_order_relaxed);
+      total += s.num_iterations.load(std::memory_order_relaxed);
+    }
+    return total > 0 ? done / total : 0;
+  }
+
+  /**
+   * Return the iterations per second of all chains.
+   */
+  double iterations_per_second() const {
+    double sum = 0;
+    for (const slot& s : slots_)
+      sum += s.iterations_per_second.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  /**
+   * Return the leapfrog steps per second of all chains.
+   */
+  double leapfrogs_per_second() const {
+    double sum = 0;
+    for (const slot& s : slots_)
+      sum += s.leapfrogs_per_second.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  /**
+   * Return the gradients per second of all chains.
+   */
+  double gradients_per_second() const {
+    double sum = 0;
+    for (const slot& s : slots_)
+      sum += s.gradients_per_second.load(std::memory_order_relaxed);
+    return sum;
+  }
+
+  /**
+   * Return the seconds until the slowest chain finishes, or NaN until
+   * every chain has published an estimate.
+   */
+  double eta() const {
+    double max = 0;
+    for (const slot& s : slots_) {
+      const double eta = s.eta.load(std::memory_order_relaxed);
+      if (!(eta >= 0))
+        return std::numeric_limits<double>::quiet_NaN();
+      if (eta > max)
+        max = eta;
+    }
+    return max;
+  }
+
+  /**
+   * Write the aggregated progress of the chains as a record.
+   *
+   * @param[in,out] writer writer
+   */
+  void write(structured_writer& writer) const {
+    writer.begin_record();
+    writer.write("num_chains", num_chains());
+    writer.write("fraction_done", fraction_done());
+    writer.write("iterations_per_second", iterations_per_second());
+    writer.write("leapfrogs_per_second", leapfrogs_per_second());
+    writer.write("gradients_per_second", gradients_per_second());
+    writer.write("eta", eta());
+    writer.end_record();
+  }
+
+ private:
+  struct alignas(64) slot {
+    std::atomic<int> iteration{0};
+    std::atomic<int> num_iterations{0};
+    std::atomic<double> iterations_per_second{0};
+    std::atomic<double> leapfrogs_per_second{0};
+    std::atomic<double> gradients_per_second{0};
+    std::atomic<double> eta{std::numeric_limits<double>::quiet_NaN()};
+  };
+  std::vector<slot> slots_;
+
+  slot& at(std::size_t chain_id) {
+    if (chain_id < 1 || chain_id > slots_.size())
+      throw std::out_of_range("progress_board: no slot for the chain");
+    return slots_[chain_id - 1];
+  }
+};
+
+/**
+ * <code>progress_instrumentation</code> is an implementation of
+ * <code>instrumentation</code> that reports the throughput of a chain
+ * every <code>refresh</code> transitions, as a progress event with its
+ * iterations, leapfrog steps and gradients per second, the distribution
+ * of its tree depths and the estimated seconds to its last iteration,
+ * all over the transitions since the previous event.
+ *
+ * The time of a transition is its measured wall time plus that of writing
+ * its draw, so the rates leave out only the little time spent between
+ * transitions.  The events are written as records to a
+ * <code>structured_writer</code>, published to a
+ * <code>progress_board</code>, or both.
+ *
+ * It is not thread safe, so concurrent chains should each have their
+ * own; they may share a board.
+ */
+class progress_instrumentation : public instrumentation {
+ public:
+  /**
+   * @param[in] refresh number of transitions between events
+   * @param[in,out] writer writer of the events, or null
+   * @param[in,out] board board the events are published to, or null
+   * @throw std::invalid_argument if <code>refresh</code> is not positive
+   */
+  explicit progress_instrumentation(int refresh,
+                                    structured_writer* writer = nullptr,
+                                    progress_board* board = nullptr)
+      : refresh_(refresh), writer_(writer), board_(board) {
+    if (refresh_ < 1)
+      throw std::invalid_argument(
+          "progress_instrumentation: refresh must be positive");
+  }
+
+  void operator()(const transition_stats& stats) {
+    ++num_transitions_;
+    time_ += stats.transition_time + stats.write_time;
+    num_gradients_ += stats.num_gradients;
+    if (stats.num_leapfrog > 0)
+      num_leapfrog_ += stats.num_leapfrog;
+    if (stats.tree_depth >= 0) {
+      if (static_cast<std::size_t>(stats.tree_depth) >= tree_depths_.size())
+        tree_depths_.resize(stats.tree_depth + 1, 0);
+      ++tree_depths_[stats.tree_depth];
+    }
+    if (num_transitions_ < refresh_ && stats.iteration < stats.num_iterations)
+      return;
+
+    last_.chain_id = stats.chain_id;
+    last_.iteration = stats.iteration;
+    last_.num_iterations = stats.num_iterations;
+    last_.warmup = stats.warmup;
+    if (time_ > 0) {
+      last_.iterations_per_second = num_transitions_ / time_;
+      last_.leapfrogs_per_second = num_leapfrog_ / time_;
+      last_.gradients_per_second = num_gradients_ / time_;
+      last_.eta = (stats.num_iterations - stats.iteration)
+                  / last_.iterations_per_second;
+    }
+    last_.tree_depths.swap(tree_depths_);
+    if (writer_)
+      write(*writer_);
+    if (board_)
+      board_->publish(last_);
+
+    num_transitions_ = 0;
+    time_ = 0;
+    num_gradients_ = 0;
+    num_leapfrog_ = 0;
+    tree_depths_.clear();
+  }
+
+  /**
+   * Return the progress of the last event.
+   */
+  const progress& last() const noexcept { return last_; }
+
+  /**
+   * Write the progress of the last event as a record.
+   *
+   * @param[in,out] writer writer
+   */
+  void write(structured_writer& writer) const {
+    writer.begin_record();
+    writer.write("chain_id", last_.chain_id);
+    writer.write("iteration", last_.iteration);
+    writer.write("num_iterations", last_.num_iterations);
+    writer.write("warmup", last_.warmup);
+    writer.write("iterations_per_second", last_.iterations_per_second);
+    writer.write("leapfrogs_per_second", last_.leapfrogs_per_second);
+    writer.write("gradients_per_second", last_.gradients_per_second);
+    writer.write("eta", last_.eta);
+    writer.write("tree_depths", last_.tree_depths);
+    writer.end_record();
+  }
+
+ private:
+  int refresh_;
+  structured_writer* writer_;
+  progress_board* board_;
+  int num_transitions_ = 0;
+  double time_ = 0;
+  std::size_t num_gradients_ = 0;
+  std::size_t num_leapfrog_ = 0;
+  std::vector<int> tree_depths_;
+  progress last_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
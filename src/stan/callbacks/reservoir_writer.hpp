@@ -0,0 +1,186 @@
+#ifndef STAN_CALLBACKS_RESERVOIR_WRITER_HPP
+#define STAN_CALLBACKS_RESERVOIR_WRITER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>reservoir_writer</code> is a writer that keeps at most
+ * <code>capacity</code> of the draws it receives, without knowing in
+ * advance how many there will be, and writes them when
+ * <code>write_draws()</code> is called, at the end of a run or at a
+ * checkpoint.  Comments and blank lines are passed on as they arrive;
+ * the header is written along with the draws.
+ *
+ * Two policies pick the draws kept:
+ *
+ * - <code>reservoir</code> keeps a uniformly random subset of the draws
+ *   with reservoir sampling (Vitter's algorithm R), and
+ * - <code>thin</code> keeps evenly spaced draws, every
+ *   <code>stride()</code>-th one from the first, and doubles the stride
+ *   by dropping every other kept draw whenever the buffer is full, so
+ *   the kept draws are as far apart as the run length allows.
+ *
+ * Either way the draws are written in the order they were received.  A
+ * header, or the comment <code>Adaptation terminated</code> written at
+ * the end of warmup, starts a new set of draws, so saved warmup draws
+ * are not kept.
+ *
+ * @tparam RNG type of pseudo random number generator
+ */
+template <class RNG>
+class reservoir_writer : public writer {
+ public:
+  enum class policy { reservoir, thin };
+
+  /**
+   * Constructs a reservoir writer.
+   *
+   * @param[in, out] output writer the comments and kept draws are
+   *   written to
+   * @param[in] capacity maximum number of draws kept; must be positive
+   * @param[in] rng pseudo random number generator choosing the draws
+   *   kept by the <code>reservoir</code> policy
+   * @param[in] keep policy choosing the draws kept
+   * @throw std::invalid_argument if <code>capacity</code> is zero
+   */
+  reservoir_writer(writer& output, size_t capacity, RNG rng,
+                   policy keep = policy::reservoir)
+      : output_(output), capacity_(capacity), rng_(rng), policy_(keep) {
+    if (capacity_ == 0)
+      throw std::invalid_argument(
+          "reservoir_writer: capacity must be positive");
+    draws_.reserve(capacity_);
+  }
+
+  void operator()(const std::vector<std::string>& names) {
+    names_ = names;
+    reset();
+  }
+
+  void operator()(const std::vector<double>& state) { add(state); }
+
+  /**
+   * Receives each column of a matrix of values as a draw.
+   *
+   * @param[in] values values, a parameter per row and a draw per column
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    std::vector<double> draw(values.rows());
+    for (Eigen::Index j = 0; j < values.cols(); ++j) {
+      for (Eigen::Index i = 0; i < values.rows(); ++i)
+        draw[i] = values(i, j);
+      add(draw);
+    }
+  }
+
+  void operator()() { output_(); }
+
+  void operator()(const std::string& message) {
+    if (message == "Adaptation terminated")
+      reset();
+    output_(message);
+  }
+
+  void flush() { output_.flush(); }
+
+  /**
+   * Forget the draws received so far, keeping the header.
+   */
+  void reset() {
+    draws_.clear();
+    num_draws_ = 0;
+    stride_ = 1;
+  }
+
+  /**
+   * Return the number of draws received since the last reset.
+   */
+  size_t num_draws() const noexcept { return num_draws_; }
+
+  /**
+   * Return the number of draws kept.
+   */
+  size_t size() const noexcept { return draws_.size(); }
+
+  size_t capacity() const noexcept { return capacity_; }
+
+  /**
+   * Return the spacing of the draws kept by the <code>thin</code> policy.
+   */
+  size_t stride() const noexcept { return stride_; }
+
+  /**
+   * Writes the header and the draws kept so far to the output.
+   */
+  void write_draws() { write_draws(output_); }
+
+  /**
+   * Writes the header and the draws kept so far to another writer, for
+   * instance the file of a checkpoint.  The draws are still kept.
+   *
+   * @param[in, out] out writer
+   */
+  void write_draws(writer& out) {
+    std::sort(draws_.begin(), draws_.end(),
+              [](const draw& a, const draw& b) { return a.first < b.first; });
+    out(names_);
+    for (const draw& d : draws_)
+      out(d.second);
+    out.flush();
+  }
+
+ private:
+  // Index of a draw and its values
+  using draw = std::pair<size_t, std::vector<double>>;
+
+  writer& output_;
+  size_t capacity_;
+  RNG rng_;
+  policy policy_;
+  std::vector<std::string> names_;
+  std::vector<draw> draws_;
+  size_t num_draws_ = 0;
+  size_t stride_ = 1;
+
+  void add(const std::vector<double>& state) {
+    const size_t index = num_draws_++;
+    if (policy_ == policy::reservoir) {
+      if (draws_.size() < capacity_) {
+        draws_.emplace_back(index, state);
+        return;
+      }
+      boost::random::uniform_int_distribution<size_t> uniform(0, index);
+      size_t slot = uniform(rng_);
+      if (slot < capacity_)
+        draws_[slot] = draw(index, state);
+      return;
+    }
+    if (index % stride_ != 0)
+      return;
+    while (draws_.size() == capacity_) {
+      // keep the even positions, which are the multiples of twice the
+      // stride as draws are kept in order
+      size_t kept = 1;
+      for (size_t i = 2; i < draws_.size(); i += 2)
+        draws_[kept++] = std::move(draws_[i]);
+      draws_.resize(kept);
+      stride_ *= 2;
+      if (index % stride_ != 0)
+        return;
+    }
+    draws_.emplace_back(index, state);
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
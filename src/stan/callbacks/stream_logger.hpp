@@ -21,6 +21,7 @@ class stream_logger final : public logger {
   std::ostream& warn_;
   std::ostream& error_;
   std::ostream& fatal_;
+  log_level min_level_;
 
  public:
   /**
@@ -32,39 +33,69 @@ class stream_logger final : public logger {
    * @param[in,out] warn stream to output warn messages
    * @param[in,out] error stream to output error messages
    * @param[in,out] fatal stream to output fatal messages
+   * @param[in] min_level lowest level of the messages output; messages
+   *   of lower levels are discarded (optional, default == debug)
    */
   stream_logger(std::ostream& debug, std::ostream& info, std::ostream& warn,
-                std::ostream& error, std::ostream& fatal)
-      : debug_(debug), info_(info), warn_(warn), error_(error), fatal_(fatal) {}
+                std::ostream& error, std::ostream& fatal,
+                log_level min_level = log_level::debug)
+      : debug_(debug),
+        info_(info),
+        warn_(warn),
+        error_(error),
+        fatal_(fatal),
+        min_level_(min_level) {}
 
-  void debug(const std::string& message) { debug_ << message << std::endl; }
+  bool is_enabled(log_level level) const { return level >= min_level_; }
+
+  void debug(const std::string& message) {
+    if (is_enabled(log_level::debug))
+      debug_ << message << std::endl;
+  }
 
   void debug(const std::stringstream& message) {
-    debug_ << message.str() << std::endl;
+    if (is_enabled(log_level::debug))
+      debug_ << message.str() << std::endl;
   }
 
-  void info(const std::string& message) { info_ << message << std::endl; }
+  void info(const std::string& message) {
+    if (is_enabled(log_level::info))
+      info_ << message << std::endl;
+  }
 
   void info(const std::stringstream& message) {
-    info_ << message.str() << std::endl;
+    if (is_enabled(log_level::info))
+      info_ << message.str() << std::endl;
   }
 
-  void warn(const std::string& message) { warn_ << message << std::endl; }
+  void warn(const std::string& message) {
+    if (is_enabled(log_level::warn))
+      warn_ << message << std::endl;
+  }
 
   void warn(const std::stringstream& message) {
-    warn_ << message.str() << std::endl;
+    if (is_enabled(log_level::warn))
+      warn_ << message.str() << std::endl;
   }
 
-  void error(const std::string& message) { error_ << message << std::endl; }
+  void error(const std::string& message) {
+    if (is_enabled(log_level::error))
+      error_ << message << std::endl;
+  }
 
   void error(const std::stringstream& message) {
-    error_ << message.str() << std::endl;
+    if (is_enabled(log_level::error))
+      error_ << message.str() << std::endl;
   }
 
-  void fatal(const std::string& message) { fatal_ << message << std::endl; }
+  void fatal(const std::string& message) {
+    if (is_enabled(log_level::fatal))
+      fatal_ << message << std::endl;
+  }
 
   void fatal(const std::stringstream& message) {
-    fatal_ << message.str() << std::endl;
+    if (is_enabled(log_level::fatal))
+      fatal_ << message.str() << std::endl;
   }
 };
 
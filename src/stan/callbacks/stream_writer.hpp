@@ -1,6 +1,7 @@
 #ifndef STAN_CALLBACKS_STREAM_WRITER_HPP
 #define STAN_CALLBACKS_STREAM_WRITER_HPP
 
+#include <stan/callbacks/csv_formatter.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <ostream>
 #include <vector>
@@ -12,6 +13,10 @@ namespace callbacks {
 /**
  * <code>stream_writer</code> is an implementation
  * of <code>writer</code> that writes to a stream.
+ *
+ * Lines end in a newline without flushing the stream; the stream is
+ * flushed by <code>flush()</code>, which the services call at the end of
+ * each phase.
  */
 class stream_writer : public writer {
  public:
@@ -22,10 +27,16 @@ class stream_writer : public writer {
    * @param[in, out] output stream to write
    * @param[in] comment_prefix string to stream before
    *   each comment line. Default is "".
+   * @param[in] round_trip true to write values with the shortest
+   *   representation that round trips instead of the stream precision.
+   *   Default is false.
    */
   explicit stream_writer(std::ostream& output,
-                         const std::string& comment_prefix = "")
-      : output_(output), comment_prefix_(comment_prefix) {}
+                         const std::string& comment_prefix = "",
+                         bool round_trip = false)
+      : output_(output),
+        comment_prefix_(comment_prefix),
+        formatter_(round_trip) {}
 
   /**
    * Virtual destructor
@@ -41,14 +52,31 @@ class stream_writer : public writer {
    * @param[in] names Names in a std::vector
    */
   void operator()(const std::vector<std::string>& names) {
+    precisions_.clear();
     write_vector(names);
   }
 
+  /**
+   * Writes the names of the columns of a schema, one per column as for
+   * a set of names, and writes the values of its columns of single
+   * precision as floats until the next header.
+   *
+   * @param[in] schema variables of the columns
+   */
+  void operator()(const output_schema& schema) {
+    std::vector<std::string> names;
+    schema.flatten(names);
+    (*this)(names);
+    if (schema.reduced_precision())
+      precisions_ = schema.column_precisions();
+  }
+
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
+   * Note: unless the writer was constructed in round trip mode, the
+   *  precision of the output is determined by the settings of the
+   *  stream.
    *
    * @param[in] state Values in a std::vector
    */
@@ -57,7 +85,7 @@ class stream_writer : public writer {
   /**
    * Writes the comment_prefix to the stream followed by a newline.
    */
-  void operator()() { output_ << comment_prefix_ << std::endl; }
+  void operator()() { output_ << comment_prefix_ << '\n'; }
 
   /**
    * Writes the comment_prefix then the message followed by a newline.
@@ -65,9 +93,14 @@ class stream_writer : public writer {
    * @param[in] message A string
    */
   void operator()(const std::string& message) {
-    output_ << comment_prefix_ << message << std::endl;
+    output_ << comment_prefix_ << message << '\n';
   }
 
+  /**
+   * Flushes the stream.
+   */
+  void flush() { output_.flush(); }
+
  private:
   /**
    * Output stream
@@ -79,26 +112,40 @@ class stream_writer : public writer {
    */
   std::string comment_prefix_;
 
+  /**
+   * Formatter for rows of values
+   */
+  csv_formatter formatter_;
+
+  /**
+   * Precision of each column, empty when all are doubles
+   */
+  std::vector<value_precision> precisions_;
+
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
-   *
    * @param[in] v Values in a std::vector
    */
   template <class T>
   void write_vector(const std::vector<T>& v) {
     if (v.empty())
       return;
+    const std::string& row = formatter_.format_row(v, output_);
+    output_.write(row.data(), row.size());
+  }
 
-    typename std::vector<T>::const_iterator last = v.end();
-    --last;
-
-    for (typename std::vector<T>::const_iterator it = v.begin(); it != last;
-         ++it)
-      output_ << *it << ",";
-    output_ << v.back() << std::endl;
+  /**
+   * Writes a set of values in csv format followed by a newline, with
+   * the columns of single precision as floats.
+   *
+   * @param[in] v Values in a std::vector
+   */
+  void write_vector(const std::vector<double>& v) {
+    if (v.empty())
+      return;
+    const std::string& row = formatter_.format_row(v, output_, precisions_);
+    output_.write(row.data(), row.size());
   }
 };
 
@@ -0,0 +1,110 @@
+#ifndef STAN_CALLBACKS_SUMMARY_INSTRUMENTATION_HPP
+#define STAN_CALLBACKS_SUMMARY_INSTRUMENTATION_HPP
+
+#include <stan/callbacks/instrumentation.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <cstddef>
+#include <string>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>summary_instrumentation</code> is an implementation of
+ * <code>instrumentation</code> that aggregates the measurements of the
+ * transitions of a chain into totals for warmup and for sampling, along
+ * with the slowest transition of each, at the cost of a few additions
+ * per transition.
+ *
+ * It is not thread safe, so concurrent chains should each have their
+ * own.
+ */
+class summary_instrumentation : public instrumentation {
+ public:
+  /**
+   * Aggregated measurements of the transitions of a phase.
+   */
+  struct summary {
+    int num_transitions = 0;
+    double transition_time = 0;
+    double gradient_time = 0;
+    double write_time = 0;
+    std::size_t num_gradients = 0;
+    std::size_t max_ad_stack_size = 0;
+    std::size_t bytes_allocated = 0;
+    std::size_t max_ad_arena_bytes = 0;
+    std::size_t max_sampler_bytes = 0;
+    double max_transition_time = 0;
+    int slowest_iteration = 0;
+
+    /**
+     * Return the wall time in seconds of the transitions not spent
+     * evaluating gradients.
+     */
+    double overhead_time() const { return transition_time - gradient_time; }
+  };
+
+  void operator()(const transition_stats& stats) {
+    summary& s = stats.warmup ? warmup_ : sampling_;
+    ++s.num_transitions;
+    s.transition_time += stats.transition_time;
+    s.gradient_time += stats.gradient_time;
+    s.write_time += stats.write_time;
+    s.num_gradients += stats.num_gradients;
+    if (stats.ad_stack_size > s.max_ad_stack_size)
+      s.max_ad_stack_size = stats.ad_stack_size;
+    s.bytes_allocated += stats.bytes_allocated;
+    if (stats.ad_arena_bytes > s.max_ad_arena_bytes)
+      s.max_ad_arena_bytes = stats.ad_arena_bytes;
+    if (stats.sampler_bytes > s.max_sampler_bytes)
+      s.max_sampler_bytes = stats.sampler_bytes;
+    if (s.num_transitions == 1
+        || stats.transition_time > s.max_transition_time) {
+      s.max_transition_time = stats.transition_time;
+      s.slowest_iteration = stats.iteration;
+    }
+  }
+
+  const summary& warmup() const noexcept { return warmup_; }
+
+  const summary& sampling() const noexcept { return sampling_; }
+
+  /**
+   * Write the summaries of warmup and sampling as a record of two
+   * records.
+   *
+   * @param[in,out] writer writer
+   */
+  void write(structured_writer& writer) const {
+    writer.begin_record();
+    write_summary(writer, "warmup", warmup_);
+    write_summary(writer, "sampling", sampling_);
+    writer.end_record();
+  }
+
+ private:
+  summary warmup_;
+  summary sampling_;
+
+  static void write_summary(structured_writer& writer, const std::string& key,
+                            const summary& s) {
+    writer.begin_record(key);
+    writer.write("num_transitions", s.num_transitions);
+    writer.write("transition_time", s.transition_time);
+    writer.write("gradient_time", s.gradient_time);
+    writer.write("overhead_time", s.overhead_time());
+    writer.write("write_time", s.write_time);
+    writer.write("num_gradients", s.num_gradients);
+    writer.write("max_ad_stack_size", s.max_ad_stack_size);
+    writer.write("bytes_allocated", s.bytes_allocated);
+    writer.write("max_ad_arena_bytes", s.max_ad_arena_bytes);
+    writer.write("max_sampler_bytes", s.max_sampler_bytes);
+    writer.write("max_transition_time", s.max_transition_time);
+    writer.write("slowest_iteration", s.slowest_iteration);
+    writer.end_record();
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -0,0 +1,131 @@
+#ifndef STAN_CALLBACKS_SUMMARY_WRITER_HPP
+#define STAN_CALLBACKS_SUMMARY_WRITER_HPP
+
+#include <stan/analyze/mcmc/online_diagnostics.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>summary_writer</code> is a writer that summarizes the draws it
+ * receives instead of writing them.  Used as the sample writer of a
+ * service, the output only holds the comments of the run and, once
+ * <code>write_summary()</code> is called, a summary table, so output
+ * that would grow with every draw of millions of generated quantities
+ * stays a few rows long.
+ *
+ * Each column is accumulated by an <code>analyze::online_diagnostics</code>
+ * in constant memory: Welford moments, streaming quantile estimates and,
+ * optionally, the batch means estimate of the effective sample size.
+ * The comment <code>Adaptation terminated</code>, written at the end of
+ * warmup, resets the summaries so saved warmup draws are excluded.
+ *
+ * The summary keeps the column names of the header as its header and has
+ * one row per statistic, in the order mean, standard deviation, the
+ * quantiles and the effective sample size, preceded by a comment naming
+ * them.  It can be read with <code>io::stan_csv_reader</code> like draws.
+ */
+class summary_writer : public writer {
+ public:
+  /**
+   * Constructs a summary writer.
+   *
+   * @param[in, out] output writer the comments and the summary are
+   *   written to
+   * @param[in] probabilities quantiles to estimate for each column
+   * @param[in] include_ess true to estimate effective sample sizes
+   * @param[in] num_batches minimum number of batches of the effective
+   *   sample size estimate; must be at least 2
+   * @throw std::invalid_argument if <code>num_batches</code> is less
+   *   than 2
+   */
+  explicit summary_writer(
+      writer& output,
+      const std::vector<double>& probabilities = {0.05, 0.5, 0.95},
+      bool include_ess = true, size_t num_batches = 32)
+      : output_(output),
+        probabilities_(probabilities),
+        include_ess_(include_ess),
+        diagnostics_(probabilities, num_batches) {}
+
+  void operator()(const std::vector<std::string>& names) {
+    diagnostics_(names);
+  }
+
+  void operator()(const std::vector<double>& state) { diagnostics_(state); }
+
+  /**
+   * Accumulates each column of a matrix of values, a draw per column.
+   *
+   * @param[in] values values, a parameter per row and a draw per column
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    std::vector<double> draw(values.rows());
+    for (Eigen::Index j = 0; j < values.cols(); ++j) {
+      for (Eigen::Index i = 0; i < values.rows(); ++i)
+        draw[i] = values(i, j);
+      diagnostics_(draw);
+    }
+  }
+
+  void operator()() { output_(); }
+
+  void operator()(const std::string& message) {
+    if (message == "Adaptation terminated")
+      diagnostics_.reset();
+    output_(message);
+  }
+
+  void flush() { output_.flush(); }
+
+  /**
+   * Return the summaries of the draws received so far.
+   */
+  const analyze::online_diagnostics& diagnostics() const noexcept {
+    return diagnostics_;
+  }
+
+  /**
+   * Writes the summary table of the draws received so far.
+   */
+  void write_summary() {
+    std::stringstream labels;
+    labels << "Summary of " << diagnostics_.num_draws()
+           << " draws; rows: Mean, StdDev";
+    for (double p : probabilities_)
+      labels << ", " << 100 * p << "%";
+    if (include_ess_)
+      labels << ", ESS";
+    output_(labels.str());
+    output_(diagnostics_.names());
+
+    const size_t n = diagnostics_.num_columns();
+    std::vector<double> row(n);
+    auto write_row = [&](auto stat) {
+      for (size_t i = 0; i < n; ++i)
+        row[i] = stat(i);
+      output_(row);
+    };
+    write_row([&](size_t i) { return diagnostics_.mean(i); });
+    write_row([&](size_t i) { return diagnostics_.sd(i); });
+    for (size_t k = 0; k < probabilities_.size(); ++k)
+      write_row([&](size_t i) { return diagnostics_.quantile(i, k); });
+    if (include_ess_)
+      write_row([&](size_t i) { return diagnostics_.ess(i); });
+    output_.flush();
+  }
+
+ private:
+  writer& output_;
+  std::vector<double> probabilities_;
+  bool include_ess_;
+  analyze::online_diagnostics diagnostics_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+#endif
@@ -34,6 +34,15 @@ class tee_writer final : public writer {
     writer2_(names);
   }
 
+  bool accepts_schema() const {
+    return writer1_.accepts_schema() && writer2_.accepts_schema();
+  }
+
+  void operator()(const output_schema& schema) {
+    writer1_(schema);
+    writer2_(schema);
+  }
+
   void operator()(const std::vector<double>& state) {
     writer1_(state);
     writer2_(state);
@@ -49,6 +58,11 @@ class tee_writer final : public writer {
     writer2_(message);
   }
 
+  void flush() {
+    writer1_.flush();
+    writer2_.flush();
+  }
+
  private:
   /**
    * The first writer
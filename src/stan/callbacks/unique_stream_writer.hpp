@@ -1,6 +1,7 @@
 #ifndef STAN_CALLBACKS_UNIQUE_STREAM_WRITER_HPP
 #define STAN_CALLBACKS_UNIQUE_STREAM_WRITER_HPP
 
+#include <stan/callbacks/csv_formatter.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <memory>
@@ -30,16 +31,24 @@ class unique_stream_writer final : public writer {
    * `std::ostream`
    * @param[in] comment_prefix string to stream before each comment line.
    *  Default is "".
+   * @param[in] round_trip true to write values with the shortest
+   *  representation that round trips instead of the stream precision.
+   *  Default is false.
    */
   explicit unique_stream_writer(std::unique_ptr<Stream, Deleter>&& output,
-                                const std::string& comment_prefix = "")
-      : output_(std::move(output)), comment_prefix_(comment_prefix) {}
+                                const std::string& comment_prefix = "",
+                                bool round_trip = false)
+      : output_(std::move(output)),
+        comment_prefix_(comment_prefix),
+        formatter_(round_trip) {}
 
   unique_stream_writer();
   unique_stream_writer(unique_stream_writer& other) = delete;
   unique_stream_writer(unique_stream_writer&& other)
       : output_(std::move(other.output_)),
-        comment_prefix_(std::move(other.comment_prefix_)) {}
+        comment_prefix_(std::move(other.comment_prefix_)),
+        formatter_(other.formatter_.round_trip()),
+        precisions_(std::move(other.precisions_)) {}
   /**
    * Virtual destructor
    */
@@ -54,11 +63,27 @@ class unique_stream_writer final : public writer {
    * @param[in] names Names in a std::vector
    */
   void operator()(const std::vector<std::string>& names) {
+    precisions_.clear();
     if (output_ == nullptr)
       return;
     write_vector(names);
   }
 
+  /**
+   * Writes the names of the columns of a schema, one per column as for
+   * a set of names, and writes the values of its columns of single
+   * precision as floats until the next header.
+   *
+   * @param[in] schema variables of the columns
+   */
+  void operator()(const output_schema& schema) {
+    std::vector<std::string> names;
+    schema.flatten(names);
+    (*this)(names);
+    if (schema.reduced_precision())
+      precisions_ = schema.column_precisions();
+  }
+
   /**
    * Get the underlying stream
    */
@@ -67,8 +92,9 @@ class unique_stream_writer final : public writer {
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
+   * Note: unless the writer was constructed in round trip mode, the
+   *  precision of the output is determined by the settings of the
+   *  stream.
    *
    * @param[in] values Values in a std::vector
    */
@@ -100,7 +126,7 @@ class unique_stream_writer final : public writer {
   void operator()() {
     if (output_ == nullptr)
       return;
-    *output_ << comment_prefix_ << std::endl;
+    *output_ << comment_prefix_ << '\n';
   }
 
   /**
@@ -111,7 +137,16 @@ class unique_stream_writer final : public writer {
   void operator()(const std::string& message) {
     if (output_ == nullptr)
       return;
-    *output_ << comment_prefix_ << message << std::endl;
+    *output_ << comment_prefix_ << message << '\n';
+  }
+
+  /**
+   * Flushes the stream.
+   */
+  void flush() {
+    if (output_ == nullptr)
+      return;
+    output_->flush();
   }
 
  private:
@@ -131,12 +166,19 @@ class unique_stream_writer final : public writer {
    */
   std::string comment_prefix_;
 
+  /**
+   * Formatter for rows of values
+   */
+  csv_formatter formatter_;
+
+  /**
+   * Precision of each column, empty when all are doubles
+   */
+  std::vector<value_precision> precisions_;
+
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
-   *
    * @param[in] v Values in a std::vector
    */
   template <class T>
@@ -146,12 +188,24 @@ class unique_stream_writer final : public writer {
     if (v.empty()) {
       return;
     }
-    auto last = v.end();
-    --last;
-    for (auto it = v.begin(); it != last; ++it) {
-      *output_ << *it << ",";
+    const std::string& row = formatter_.format_row(v, *output_);
+    output_->write(row.data(), row.size());
+  }
+
+  /**
+   * Writes a set of values in csv format followed by a newline, with
+   * the columns of single precision as floats.
+   *
+   * @param[in] v Values in a std::vector
+   */
+  void write_vector(const std::vector<double>& v) {
+    if (output_ == nullptr)
+      return;
+    if (v.empty()) {
+      return;
     }
-    *output_ << v.back() << std::endl;
+    const std::string& row = formatter_.format_row(v, *output_, precisions_);
+    output_->write(row.data(), row.size());
   }
 };
 
@@ -1,6 +1,7 @@
 #ifndef STAN_CALLBACKS_WRITER_HPP
 #define STAN_CALLBACKS_WRITER_HPP
 
+#include <stan/callbacks/output_schema.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <string>
 #include <vector>
@@ -27,6 +28,25 @@ class writer {
    */
   virtual void operator()(const std::vector<std::string>& names) {}
 
+  /**
+   * Return true if the writer takes headers as an
+   * <code>output_schema</code> instead of as one name per column.  Only
+   * then are headers sent to it as a schema.
+   */
+  virtual bool accepts_schema() const { return false; }
+
+  /**
+   * Writes the header of a set of draws as a schema.  By default the
+   * schema is flattened to one name per column.
+   *
+   * @param[in] schema variables of the columns
+   */
+  virtual void operator()(const output_schema& schema) {
+    std::vector<std::string> names;
+    schema.flatten(names);
+    (*this)(names);
+  }
+
   /**
    * Writes a set of values.
    *
@@ -58,6 +78,11 @@ class writer {
    */
   virtual void operator()(
       const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {}
+
+  /**
+   * Flushes any output buffered by the writer.
+   */
+  virtual void flush() {}
 };
 
 }  // namespace callbacks
@@ -361,6 +361,36 @@ class array_var_context : public var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name.  Integer variables are copied to doubles.
+   *
+   * @param name Name of variable.
+   * @return View of values of variable.
+   */
+  values_view<double> view_r(const std::string& name) const {
+    const auto ret_val_r = vars_r_.find(name);
+    if (ret_val_r != vars_r_.end()) {
+      return {ret_val_r->second.first.data(), ret_val_r->second.first.size()};
+    }
+    return var_context::view_r(name);
+  }
+
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of values.
+   */
+  values_view<int> view_i(const std::string& name) const {
+    auto ret_val_i = vars_i_.find(name);
+    if (ret_val_i != vars_i_.end()) {
+      return {ret_val_i->second.first.data(), ret_val_i->second.first.size()};
+    }
+    return {};
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
@@ -423,7 +453,7 @@ class array_var_context : public var_context {
   virtual void names_i(std::vector<std::string>& names) const {
     names.clear();
     names.reserve(vars_i_.size());
-    for (const auto& vars_i_iter : vars_r_) {
+    for (const auto& vars_i_iter : vars_i_) {
       names.push_back(vars_i_iter.first);
     }
   }
@@ -0,0 +1,279 @@
+#ifndef STAN_IO_BINARY_DRAWS_READER_HPP
+#define STAN_IO_BINARY_DRAWS_READER_HPP
+
+#include <stan/callbacks/binary_writer.hpp>
+#include <stan/callbacks/output_schema.hpp>
+#include <stan/mcmc/chains_buffer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+struct binary_draws {
+  std::vector<std::string> header;
+  // Schema of the last header, if it was written as a schema
+  callbacks::output_schema schema;
+  std::vector<std::string> comments;
+  Eigen::MatrixXd samples;
+  bool truncated;
+
+  binary_draws() : truncated(false) {}
+};
+
+/**
+ * Reads draws written by <code>callbacks::binary_writer</code>.
+ */
+class binary_draws_reader {
+ public:
+  binary_draws_reader() {}
+  ~binary_draws_reader() {}
+
+  /**
+   * Parses the stream.  The header is the last header record, with a
+   * schema header record flattened to one name per column, the
+   * comments are all comment records in order, and the samples are the
+   * rows of all draws records in order, single precision values
+   * converted to doubles.  A trailing incomplete record, as left by a
+   * run that was stopped mid write, is ignored and reported through
+   * <code>truncated</code>.
+   *
+   * @param[in] in input stream to parse, opened in binary mode
+   * @return contents of the stream
+   * @throw std::invalid_argument if the stream does not start with the
+   *   binary writer's magic string or if draws records disagree on the
+   *   number of columns
+   */
+  static binary_draws parse(std::istream& in) {
+    binary_draws data;
+    std::vector<Eigen::MatrixXd> chunks;
+    Eigen::Index num_rows = 0;
+    parse_records(in, data, [&](Eigen::MatrixXd& chunk) {
+      if (!chunks.empty() && chunk.cols() != chunks[0].cols())
+        throw std::invalid_argument(
+            "Error: draws records have different numbers of columns");
+      num_rows += chunk.rows();
+      chunks.push_back(std::move(chunk));
+    });
+
+    Eigen::Index num_cols = chunks.empty() ? 0 : chunks[0].cols();
+    data.samples.resize(num_rows, num_cols);
+    Eigen::Index row = 0;
+    for (const Eigen::MatrixXd& chunk : chunks) {
+      data.samples.middleRows(row, chunk.rows()) = chunk;
+      row += chunk.rows();
+    }
+    return data;
+  }
+
+  /**
+   * Parses the stream, appending the draws to a new chain of a buffer a
+   * record at a time instead of into the <code>samples</code> of the
+   * result, which is left empty.  Only one draws record is held at once,
+   * so single precision draws are converted to doubles as they are
+   * stored.  No chain is added if the stream has no draws.
+   *
+   * @param[in] in input stream to parse, opened in binary mode
+   * @param[in,out] draws buffer to which a chain is added
+   * @return contents of the stream other than the draws
+   * @throw std::invalid_argument if the stream does not start with the
+   *   binary writer's magic string or if a draws record does not have a
+   *   column per parameter of the buffer, in which case the new chain is
+   *   removed
+   */
+  static binary_draws parse(std::istream& in, mcmc::chains_buffer& draws) {
+    binary_draws data;
+    const int chain = draws.num_chains();
+    try {
+      parse_records(in, data, [&](Eigen::MatrixXd& chunk) {
+        if (chunk.cols() != draws.num_params())
+          throw std::invalid_argument(
+              "Error: number of columns in draws record does not match"
+              " buffer");
+        if (chunk.rows() > 0)
+          draws.append(chain, chunk);
+      });
+    } catch (const std::invalid_argument& e) {
+      if (draws.num_chains() > chain)
+        draws.pop_chain();
+      throw;
+    }
+    return data;
+  }
+
+  /**
+   * Reads the magic string at the start of a stream.
+   *
+   * @param[in] in input stream, opened in binary mode
+   * @throw std::invalid_argument if the stream does not start with the
+   *   binary writer's magic string
+   */
+  static void read_magic(std::istream& in) {
+    char magic[8];
+    if (!in.read(magic, 8)
+        || std::memcmp(magic, callbacks::binary_writer::MAGIC, 8) != 0)
+      throw std::invalid_argument(
+          "Error: stream is not in the binary draws format");
+  }
+
+  /**
+   * Reads records up to and including the next draws record, updating
+   * the header, schema and comments of the result, so that draws are
+   * read a record at a time.  A trailing incomplete record is reported
+   * through <code>truncated</code>.
+   *
+   * @param[in] in input stream past the magic string
+   * @param[in,out] data header, schema and comments read so far
+   * @param[out] chunk draws of the record, one row per draw
+   * @return false if the stream ends before another draws record
+   * @throw std::invalid_argument if a record is not one of the binary
+   *   writer's
+   */
+  static bool read_draws(std::istream& in, binary_draws& data,
+                         Eigen::MatrixXd& chunk) {
+    using writer = callbacks::binary_writer;
+    std::vector<float> floats;
+    char tag;
+    while (in.get(tag)) {
+      if (tag == writer::HEADER_TAG) {
+        std::uint64_t n;
+        if (!read_size(in, n)) {
+          data.truncated = true;
+          break;
+        }
+        std::vector<std::string> header(n);
+        bool complete = true;
+        for (std::string& name : header)
+          complete = complete && read_string(in, name);
+        if (!complete) {
+          data.truncated = true;
+          break;
+        }
+        data.header = header;
+        data.schema = callbacks::output_schema();
+      } else if (tag == writer::SCHEMA_TAG
+                 || tag == writer::TYPED_SCHEMA_TAG) {
+        callbacks::output_schema schema;
+        if (!read_schema(in, schema, tag == writer::TYPED_SCHEMA_TAG)) {
+          data.truncated = true;
+          break;
+        }
+        data.header.clear();
+        schema.flatten(data.header);
+        data.schema = std::move(schema);
+      } else if (tag == writer::DRAWS_TAG || tag == writer::TYPED_DRAWS_TAG) {
+        std::uint64_t rows, cols;
+        if (!read_size(in, rows) || !read_size(in, cols)) {
+          data.truncated = true;
+          break;
+        }
+        std::vector<char> bytes(cols, sizeof(double));
+        if (tag == writer::TYPED_DRAWS_TAG && cols > 0
+            && !in.read(bytes.data(), cols)) {
+          data.truncated = true;
+          break;
+        }
+        chunk.resize(rows, cols);
+        bool complete = true;
+        for (std::uint64_t col = 0; complete && col < cols; ++col) {
+          if (bytes[col] == sizeof(float)) {
+            floats.resize(rows);
+            complete = static_cast<bool>(
+                in.read(reinterpret_cast<char*>(floats.data()),
+                        rows * sizeof(float)));
+            for (std::uint64_t row = 0; complete && row < rows; ++row)
+              chunk(row, col) = floats[row];
+          } else if (bytes[col] == sizeof(double)) {
+            complete = static_cast<bool>(
+                in.read(reinterpret_cast<char*>(chunk.col(col).data()),
+                        rows * sizeof(double)));
+          } else {
+            throw std::invalid_argument(
+                "Error: unknown value size in binary draws stream");
+          }
+        }
+        if (!complete) {
+          data.truncated = true;
+          break;
+        }
+        return true;
+      } else if (tag == writer::COMMENT_TAG) {
+        std::string message;
+        if (!read_string(in, message)) {
+          data.truncated = true;
+          break;
+        }
+        data.comments.push_back(message);
+      } else {
+        throw std::invalid_argument(
+            "Error: unknown record in binary draws stream");
+      }
+    }
+    return false;
+  }
+
+ private:
+  /**
+   * Parses the records of the stream into the header, schema and
+   * comments of the result, handing each complete draws record to a
+   * callback as a matrix with a row per draw.
+   */
+  template <typename F>
+  static void parse_records(std::istream& in, binary_draws& data,
+                            const F& add_chunk) {
+    read_magic(in);
+    Eigen::MatrixXd chunk;
+    while (read_draws(in, data, chunk))
+      add_chunk(chunk);
+  }
+
+  static bool read_size(std::istream& in, std::uint64_t& n) {
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char*>(&n), sizeof(n)));
+  }
+
+  static bool read_schema(std::istream& in, callbacks::output_schema& schema,
+                          bool typed) {
+    std::uint64_t n;
+    if (!read_size(in, n))
+      return false;
+    for (std::uint64_t i = 0; i < n; ++i) {
+      std::string name;
+      std::uint64_t num_dims;
+      if (!read_string(in, name) || !read_size(in, num_dims))
+        return false;
+      std::vector<size_t> dims(num_dims);
+      for (size_t& d : dims) {
+        std::uint64_t dim;
+        if (!read_size(in, dim))
+          return false;
+        d = dim;
+      }
+      char bytes = sizeof(double);
+      if (typed && !in.get(bytes))
+        return false;
+      schema.add(name, dims,
+                 bytes == sizeof(float) ? callbacks::value_precision::float32
+                                        : callbacks::value_precision::float64);
+    }
+    return true;
+  }
+
+  static bool read_string(std::istream& in, std::string& s) {
+    std::uint64_t n;
+    if (!read_size(in, n))
+      return false;
+    s.resize(n);
+    return n == 0 || static_cast<bool>(in.read(&s[0], n));
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
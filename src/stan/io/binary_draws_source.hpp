@@ -0,0 +1,123 @@
+#ifndef STAN_IO_BINARY_DRAWS_SOURCE_HPP
+#define STAN_IO_BINARY_DRAWS_SOURCE_HPP
+
+#include <stan/io/binary_draws_reader.hpp>
+#include <stan/io/draws_source.hpp>
+#include <algorithm>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A source of the draws written by <code>callbacks::binary_writer</code>,
+ * read a draws record at a time, optionally keeping only some of the
+ * columns.  Single precision columns are converted to doubles as they
+ * are read.
+ *
+ * The records up to the first draws record are read on construction, so
+ * the header is that of the draws.  The comments are collected as they
+ * are read.
+ */
+class binary_draws_source : public draws_source {
+ public:
+  /**
+   * Construct a source of all the columns of a stream.
+   *
+   * @param[in,out] in stream opened in binary mode, which must outlive
+   *   the source
+   * @throw std::invalid_argument if the stream is not in the binary draws
+   *   format
+   */
+  explicit binary_draws_source(std::istream& in) : in_(in) {
+    start();
+    for (size_t i = 0; i < data_.header.size(); ++i)
+      columns_.push_back(i);
+  }
+
+  /**
+   * Construct a source of the specified columns of a stream, such as the
+   * constrained parameter names of a model.
+   *
+   * @param[in,out] in stream opened in binary mode, which must outlive
+   *   the source
+   * @param[in] names names of the columns kept, in the order they are
+   *   read
+   * @throw std::invalid_argument if the stream is not in the binary draws
+   *   format or has no column of one of the names
+   */
+  binary_draws_source(std::istream& in, const std::vector<std::string>& names)
+      : in_(in) {
+    start();
+    for (const std::string& name : names) {
+      auto column = std::find(data_.header.begin(), data_.header.end(), name);
+      if (column == data_.header.end())
+        throw std::invalid_argument("Error: no column " + name
+                                    + " in binary draws stream");
+      columns_.push_back(column - data_.header.begin());
+    }
+  }
+
+  size_t num_cols() const { return columns_.size(); }
+
+  /**
+   * @throw std::invalid_argument if a draws record does not have a value
+   *   for each column of the header
+   */
+  size_t read(size_t max_draws, Eigen::MatrixXd& draws) {
+    shape(max_draws, draws);
+    size_t n = 0;
+    while (n < max_draws) {
+      if (next_ == chunk_.rows()) {
+        next_ = 0;
+        if (!more_ || !(more_ = binary_draws_reader::read_draws(in_, data_,
+                                                                 chunk_))) {
+          chunk_.resize(0, chunk_.cols());
+          break;
+        }
+        if (chunk_.cols() != static_cast<Eigen::Index>(data_.header.size()))
+          throw std::invalid_argument(
+              "Error: number of columns in draws record does not match"
+              " header");
+      }
+      const size_t m = std::min<size_t>(max_draws - n, chunk_.rows() - next_);
+      for (size_t j = 0; j < columns_.size(); ++j)
+        draws.col(j).segment(n, m) = chunk_.col(columns_[j]).segment(next_, m);
+      n += m;
+      next_ += m;
+    }
+    return n;
+  }
+
+  /**
+   * Return the header, schema and comments read so far, without samples.
+   */
+  const binary_draws& data() const noexcept { return data_; }
+
+ private:
+  std::istream& in_;
+  binary_draws data_;
+  // Index in the header of each column kept
+  std::vector<size_t> columns_;
+  // Draws record being read and the next of its rows
+  Eigen::MatrixXd chunk_;
+  Eigen::Index next_ = 0;
+  bool more_ = true;
+
+  void start() {
+    binary_draws_reader::read_magic(in_);
+    more_ = binary_draws_reader::read_draws(in_, data_, chunk_);
+    if (!more_)
+      chunk_.resize(0, 0);
+    else if (chunk_.cols() != static_cast<Eigen::Index>(data_.header.size()))
+      throw std::invalid_argument(
+          "Error: number of columns in draws record does not match header");
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -0,0 +1,362 @@
+#ifndef STAN_IO_BINARY_VAR_CONTEXT_HPP
+#define STAN_IO_BINARY_VAR_CONTEXT_HPP
+
+#include <stan/io/var_context.hpp>
+#include <stan/io/validate_dims.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A var_context backed by a memory mapped file in the binary data
+ * format.  Values are read straight from the mapping, so the operating
+ * system pages them in as they are used and shares them between every
+ * process that maps the same file.  The views returned by
+ * <code>view_r</code> for real variables and <code>view_i</code> for
+ * integer variables refer to the mapping without copying it.
+ *
+ * The file starts with the 8 byte magic string <code>MAGIC</code> and
+ * the number of variables.  Each variable then has a header made of its
+ * name, its type (<code>REAL_TYPE</code> for doubles or
+ * <code>INT_TYPE</code> for 32 bit integers), its number of dimensions,
+ * its dimensions and the offset of its values from the start of the
+ * file.  Strings are a length followed by that many bytes, and all sizes
+ * and offsets are unsigned 64 bit integers.  The values of each variable
+ * are stored in last-index-major order at an offset that is a multiple
+ * of <code>ALIGNMENT</code>.  Everything is written in the byte order
+ * of the machine.
+ *
+ * Files are made with <code>write</code>, typically from a context
+ * parsed once from JSON.
+ */
+class binary_var_context : public var_context {
+ public:
+  static constexpr const char* MAGIC = "STANDAT1";
+  static constexpr char REAL_TYPE = 'R';
+  static constexpr char INT_TYPE = 'I';
+  static constexpr std::uint64_t ALIGNMENT = 64;
+
+  /**
+   * Map the specified file.
+   *
+   * @param filename name of a file in the binary data format
+   * @throw std::invalid_argument if the file is not in the binary data
+   * format or is truncated
+   */
+  explicit binary_var_context(const std::string& filename)
+      : binary_var_context(map_file(filename)) {}
+
+  bool contains_r(const std::string& name) const {
+    return vars_.find(name) != vars_.end();
+  }
+
+  bool contains_i(const std::string& name) const {
+    auto var = vars_.find(name);
+    return var != vars_.end() && var->second.type == INT_TYPE;
+  }
+
+  std::vector<double> vals_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var == vars_.end())
+      return {};
+    if (var->second.type == REAL_TYPE)
+      return {reals(var->second), reals(var->second) + var->second.size};
+    return {ints(var->second), ints(var->second) + var->second.size};
+  }
+
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var == vars_.end() || var->second.dims.empty())
+      return {};
+    std::vector<double> vals = vals_r(name);
+    // the real and imaginary parts are the last index
+    const size_t offset = vals.size() / 2;
+    std::vector<std::complex<double>> vals_c(offset);
+    for (size_t i = 0; i < offset; ++i)
+      vals_c[i] = {vals[i], vals[i + offset]};
+    return vals_c;
+  }
+
+  std::vector<size_t> dims_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    return var == vars_.end() ? std::vector<size_t>() : var->second.dims;
+  }
+
+  std::vector<int> vals_i(const std::string& name) const {
+    if (!contains_i(name))
+      return {};
+    const variable& var = vars_.find(name)->second;
+    return {ints(var), ints(var) + var.size};
+  }
+
+  std::vector<size_t> dims_i(const std::string& name) const {
+    return contains_i(name) ? vars_.find(name)->second.dims
+                            : std::vector<size_t>();
+  }
+
+  values_view<double> view_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var != vars_.end() && var->second.type == REAL_TYPE)
+      return {reals(var->second), var->second.size};
+    return var_context::view_r(name);
+  }
+
+  values_view<int> view_i(const std::string& name) const {
+    if (!contains_i(name))
+      return {};
+    const variable& var = vars_.find(name)->second;
+    return {ints(var), var.size};
+  }
+
+  void names_r(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (var.second.type == REAL_TYPE)
+        names.push_back(var.first);
+  }
+
+  void names_i(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (var.second.type == INT_TYPE)
+        names.push_back(var.first);
+  }
+
+  /**
+   * Check variable dimensions against variable declaration.
+   *
+   * @param stage stan program processing stage
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   * @throw std::runtime_error if mismatch between declared
+   *        dimensions and dimensions found in context.
+   */
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    stan::io::validate_dims(*this, stage, name, base_type, dims_declared);
+  }
+
+  /**
+   * Write the variables of the specified context in the binary data
+   * format.  Variables the context has as integers are written as
+   * integers and the others as doubles.
+   *
+   * @param[in,out] out stream to write to, opened in binary mode
+   * @param[in] context variables to write
+   */
+  static void write(std::ostream& out, const var_context& context) {
+    const layout file = make_layout(context);
+    out.write(MAGIC, 8);
+    write_size(out, file.names.size());
+    for (size_t n = 0; n < file.names.size(); ++n) {
+      write_size(out, file.names[n].size());
+      out.write(file.names[n].data(), file.names[n].size());
+      out.put(n < file.num_ints ? INT_TYPE : REAL_TYPE);
+      write_size(out, file.dims[n].size());
+      for (size_t d : file.dims[n])
+        write_size(out, d);
+      write_size(out, file.offsets[n]);
+    }
+
+    std::uint64_t position = file.header_size;
+    for (size_t n = 0; n < file.names.size(); ++n) {
+      for (; position < file.offsets[n]; ++position)
+        out.put(0);
+      if (n < file.num_ints) {
+        values_view<int> vals = context.view_i(file.names[n]);
+        out.write(reinterpret_cast<const char*>(vals.data()),
+                  vals.size() * sizeof(int));
+        position += vals.size() * sizeof(int);
+      } else {
+        values_view<double> vals = context.view_r(file.names[n]);
+        out.write(reinterpret_cast<const char*>(vals.data()),
+                  vals.size() * sizeof(double));
+        position += vals.size() * sizeof(double);
+      }
+    }
+  }
+
+  /**
+   * Return the number of bytes <code>write</code> writes for the
+   * specified context.
+   *
+   * @param[in] context variables to write
+   * @return size of the variables in the binary data format
+   */
+  static std::uint64_t written_size(const var_context& context) {
+    return make_layout(context).size;
+  }
+
+ protected:
+  /**
+   * Read the binary data format from the specified mapped region, which
+   * is then kept by this object.
+   *
+   * @param region mapping of the data
+   * @throw std::invalid_argument if the region is not in the binary data
+   * format or is truncated
+   */
+  explicit binary_var_context(boost::interprocess::mapped_region&& region)
+      : region_(std::move(region)),
+        begin_(static_cast<const char*>(region_.get_address())),
+        size_(region_.get_size()) {
+    parse();
+  }
+
+ private:
+  struct variable {
+    char type;
+    std::vector<size_t> dims;
+    size_t size;
+    std::uint64_t offset;
+  };
+
+  boost::interprocess::mapped_region region_;
+  const char* begin_;
+  size_t size_;
+  std::map<std::string, variable> vars_;
+
+  struct layout {
+    std::vector<std::string> names;
+    // the integer variables come first
+    size_t num_ints;
+    std::vector<std::vector<size_t>> dims;
+    std::uint64_t header_size;
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t size;
+  };
+
+  static boost::interprocess::mapped_region map_file(
+      const std::string& filename) {
+    namespace bip = boost::interprocess;
+    if (std::ifstream(filename, std::ios::binary | std::ios::ate).tellg()
+        <= 0)
+      throw std::invalid_argument("Error: file " + filename
+                                  + " is not in the binary data format");
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    return bip::mapped_region(file, bip::read_only);
+  }
+
+  static layout make_layout(const var_context& context) {
+    layout file;
+    std::vector<std::string> names_r;
+    context.names_i(file.names);
+    context.names_r(names_r);
+    file.num_ints = file.names.size();
+    for (const std::string& name : names_r)
+      if (std::find(file.names.begin(), file.names.begin() + file.num_ints,
+                    name)
+          == file.names.begin() + file.num_ints)
+        file.names.push_back(name);
+
+    file.dims.resize(file.names.size());
+    file.header_size = 8 + sizeof(std::uint64_t);
+    for (size_t n = 0; n < file.names.size(); ++n) {
+      file.dims[n] = n < file.num_ints ? context.dims_i(file.names[n])
+                                       : context.dims_r(file.names[n]);
+      file.header_size += 1 + file.names[n].size()
+                          + (3 + file.dims[n].size()) * sizeof(std::uint64_t);
+    }
+
+    file.offsets.resize(file.names.size());
+    file.size = file.header_size;
+    for (size_t n = 0; n < file.names.size(); ++n) {
+      file.size = align(file.size);
+      file.offsets[n] = file.size;
+      std::uint64_t size = 1;
+      for (size_t d : file.dims[n])
+        size *= d;
+      file.size += size * (n < file.num_ints ? sizeof(int) : sizeof(double));
+    }
+    return file;
+  }
+
+  const double* reals(const variable& var) const {
+    return reinterpret_cast<const double*>(begin_ + var.offset);
+  }
+
+  const int* ints(const variable& var) const {
+    return reinterpret_cast<const int*>(begin_ + var.offset);
+  }
+
+  static std::uint64_t align(std::uint64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  static void write_size(std::ostream& out, std::uint64_t n) {
+    out.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  }
+
+  [[noreturn]] static void invalid_file() {
+    throw std::invalid_argument(
+        "Error: file is not in the binary data format or is truncated");
+  }
+
+  void read(size_t& pos, void* dest, size_t n) const {
+    if (n > size_ - pos)
+      invalid_file();
+    std::memcpy(dest, begin_ + pos, n);
+    pos += n;
+  }
+
+  std::uint64_t read_size(size_t& pos) const {
+    std::uint64_t n;
+    read(pos, &n, sizeof(n));
+    return n;
+  }
+
+  void parse() {
+    size_t pos = 0;
+    char magic[8];
+    read(pos, magic, 8);
+    if (std::memcmp(magic, MAGIC, 8) != 0)
+      invalid_file();
+    const std::uint64_t num_vars = read_size(pos);
+    for (std::uint64_t n = 0; n < num_vars; ++n) {
+      const std::uint64_t name_size = read_size(pos);
+      if (name_size > size_ - pos)
+        invalid_file();
+      std::string name(begin_ + pos, name_size);
+      pos += name_size;
+      variable var;
+      read(pos, &var.type, 1);
+      if (var.type != REAL_TYPE && var.type != INT_TYPE)
+        invalid_file();
+      const std::uint64_t num_dims = read_size(pos);
+      if (num_dims > (size_ - pos) / sizeof(std::uint64_t))
+        invalid_file();
+      var.size = 1;
+      for (std::uint64_t d = 0; d < num_dims; ++d) {
+        var.dims.push_back(read_size(pos));
+        var.size *= var.dims.back();
+      }
+      var.offset = read_size(pos);
+      const size_t value_size
+          = var.type == REAL_TYPE ? sizeof(double) : sizeof(int);
+      if (var.offset % ALIGNMENT != 0 || var.offset > size_
+          || var.size > (size_ - var.offset) / value_size)
+        invalid_file();
+      vars_[name] = std::move(var);
+    }
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
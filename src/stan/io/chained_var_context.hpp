@@ -42,12 +42,20 @@ class chained_var_context : public var_context {
     return vc1_.contains_i(name) ? vc1_.vals_i(name) : vc2_.vals_i(name);
   }
 
+  values_view<double> view_r(const std::string& name) const {
+    return vc1_.contains_r(name) ? vc1_.view_r(name) : vc2_.view_r(name);
+  }
+
+  values_view<int> view_i(const std::string& name) const {
+    return vc1_.contains_i(name) ? vc1_.view_i(name) : vc2_.view_i(name);
+  }
+
   std::vector<size_t> dims_r(const std::string& name) const {
     return vc1_.contains_r(name) ? vc1_.dims_r(name) : vc2_.dims_r(name);
   }
 
   std::vector<size_t> dims_i(const std::string& name) const {
-    return vc1_.contains_r(name) ? vc1_.dims_i(name) : vc2_.dims_i(name);
+    return vc1_.contains_i(name) ? vc1_.dims_i(name) : vc2_.dims_i(name);
   }
 
   void names_r(std::vector<std::string>& names) const {
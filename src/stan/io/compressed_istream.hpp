@@ -0,0 +1,124 @@
+#ifndef STAN_IO_COMPRESSED_ISTREAM_HPP
+#define STAN_IO_COMPRESSED_ISTREAM_HPP
+
+#include <stan/callbacks/compressed_ostream.hpp>
+#include <stan/callbacks/compression_codec.hpp>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <streambuf>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * <code>decompressing_streambuf</code> is a stream buffer that reads the
+ * frames written by a <code>callbacks::compressing_streambuf</code> from
+ * an input stream and decompresses them one at a time as they are read,
+ * so only one frame is held in memory.  Output such as a Stan CSV file
+ * written through a <code>callbacks::compressed_ostream</code> is read
+ * back by handing a <code>compressed_istream</code> to the usual reader,
+ * for instance <code>stan_csv_reader::parse</code>.
+ *
+ * A frame that is truncated or fails to decompress makes the stream bad.
+ *
+ * @tparam Codec codec the frames were compressed with
+ */
+template <typename Codec>
+class decompressing_streambuf : public std::streambuf {
+ public:
+  /**
+   * Constructs a decompressing buffer and reads the stream header.
+   *
+   * @param[in, out] input stream holding the compressed frames
+   * @param[in] codec codec the frames were compressed with
+   * @throw std::invalid_argument if the stream does not start with the
+   * header of frames compressed with the codec
+   */
+  explicit decompressing_streambuf(std::istream& input,
+                                   const Codec& codec = Codec())
+      : input_(input), codec_(codec) {
+    char header[9];
+    if (!input_.read(header, 9)
+        || std::memcmp(header,
+                       callbacks::compressing_streambuf<Codec>::MAGIC, 8)
+               != 0)
+      throw std::invalid_argument("Input is not a compressed Stan stream");
+    if (header[8] != Codec::ID)
+      throw std::invalid_argument(
+          std::string("Input is compressed with codec '") + header[8]
+          + "', not '" + Codec::ID + "'");
+    setg(nullptr, nullptr, nullptr);
+  }
+
+ protected:
+  int_type underflow() {
+    if (gptr() == egptr() && !read_frame())
+      return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  std::istream& input_;
+  Codec codec_;
+  std::vector<char> compressed_;
+  std::vector<char> bytes_;  // Decompressed frame being read
+
+  /**
+   * Reads and decompresses the next frame.
+   *
+   * @return false at the end of the stream
+   * @throw std::runtime_error if the frame is truncated or does not
+   * decompress
+   */
+  bool read_frame() {
+    std::uint64_t sizes[2];
+    do {
+      input_.read(reinterpret_cast<char*>(sizes), sizeof(sizes));
+      if (input_.gcount() == 0)
+        return false;
+      if (input_.gcount() != sizeof(sizes))
+        throw std::runtime_error("Truncated compressed frame");
+    } while (sizes[0] == 0);
+    compressed_.resize(sizes[1]);
+    bytes_.resize(sizes[0]);
+    if (!input_.read(compressed_.data(), sizes[1]))
+      throw std::runtime_error("Truncated compressed frame");
+    codec_.decompress(compressed_.data(), sizes[1], bytes_.data(), sizes[0]);
+    setg(bytes_.data(), bytes_.data(), bytes_.data() + bytes_.size());
+    return true;
+  }
+};
+
+/**
+ * <code>compressed_istream</code> is an input stream that decompresses
+ * another stream through a <code>decompressing_streambuf</code>.
+ *
+ * @tparam Codec codec the frames were compressed with
+ */
+template <typename Codec>
+class compressed_istream : public std::istream {
+ public:
+  /**
+   * Constructs a decompressing stream and reads the stream header.
+   *
+   * @param[in, out] input stream holding the compressed frames
+   * @param[in] codec codec the frames were compressed with
+   * @throw std::invalid_argument if the stream does not start with the
+   * header of frames compressed with the codec
+   */
+  explicit compressed_istream(std::istream& input,
+                              const Codec& codec = Codec())
+      : std::istream(nullptr), buf_(input, codec) {
+    rdbuf(&buf_);
+  }
+
+ private:
+  decompressing_streambuf<Codec> buf_;
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -0,0 +1,135 @@
+#ifndef STAN_IO_CSV_DRAWS_SOURCE_HPP
+#define STAN_IO_CSV_DRAWS_SOURCE_HPP
+
+#include <stan/io/draws_source.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A source of the draws of a Stan CSV file, parsed a row at a time as
+ * they are read, optionally keeping only some of the columns.
+ *
+ * The metadata, the header and the adaptation are parsed on
+ * construction, as by <code>stan_csv_reader</code>, and saved warmup
+ * draws are skipped.  Comment and blank lines between the draws are
+ * skipped; the timing is accumulated as it is read.
+ */
+class csv_draws_source : public draws_source {
+ public:
+  /**
+   * Construct a source of all the columns of a file.
+   *
+   * @param[in,out] in stream of the file, which must outlive the source
+   * @throw std::invalid_argument if the file has no header
+   */
+  explicit csv_draws_source(std::istream& in) : in_(in) {
+    stan_csv_reader::parse_preamble(in_, csv_);
+    for (size_t i = 0; i < csv_.header.size(); ++i)
+      columns_.push_back(i);
+  }
+
+  /**
+   * Construct a source of the specified columns of a file, such as the
+   * constrained parameter names of a model.
+   *
+   * @param[in,out] in stream of the file, which must outlive the source
+   * @param[in] names names of the columns kept, in the order they are
+   *   read, either as in the file or as the header is parsed, so
+   *   <code>theta.2</code> is also <code>theta[2]</code>
+   * @throw std::invalid_argument if the file has no header or no column
+   *   of one of the names
+   */
+  csv_draws_source(std::istream& in, const std::vector<std::string>& names)
+      : in_(in) {
+    stan_csv_reader::parse_preamble(in_, csv_);
+    for (const std::string& name : names) {
+      std::string pretty = name;
+      prettify_stan_csv_name(pretty);
+      auto column = std::find(csv_.header.begin(), csv_.header.end(), pretty);
+      if (column == csv_.header.end())
+        throw std::invalid_argument("Error: no column " + name
+                                    + " in csv file");
+      columns_.push_back(column - csv_.header.begin());
+    }
+  }
+
+  size_t num_cols() const { return columns_.size(); }
+
+  /**
+   * @throw std::invalid_argument if a row does not have a value for each
+   *   column of the header
+   */
+  size_t read(size_t max_draws, Eigen::MatrixXd& draws) {
+    shape(max_draws, draws);
+    const size_t num_fields = csv_.header.size();
+    size_t n = 0;
+    while (n < max_draws && std::getline(in_, line_)) {
+      if (line_.empty())
+        continue;
+      if (line_[0] == '#') {
+        read_timing();
+        continue;
+      }
+      fields_.clear();
+      const char* p = line_.c_str();
+      while (true) {
+        char* end;
+        fields_.push_back(std::strtod(p, &end));
+        p = end;
+        while (*p != ',' && *p != '\0')
+          ++p;
+        if (*p == '\0')
+          break;
+        ++p;
+      }
+      if (fields_.size() != num_fields)
+        throw std::invalid_argument(
+            "Error: expected " + std::to_string(num_fields)
+            + " columns, but found " + std::to_string(fields_.size())
+            + " instead for row " + std::to_string(num_read_ + n + 1));
+      for (size_t j = 0; j < columns_.size(); ++j)
+        draws(n, j) = fields_[columns_[j]];
+      ++n;
+    }
+    num_read_ += n;
+    return n;
+  }
+
+  /**
+   * Return the metadata, header and adaptation of the file, with the
+   * timing read so far and no samples.
+   */
+  const stan_csv& csv() const noexcept { return csv_; }
+
+ private:
+  std::istream& in_;
+  stan_csv csv_;
+  // Index in the header of each column kept
+  std::vector<size_t> columns_;
+  size_t num_read_ = 0;
+  std::string line_;
+  std::vector<double> fields_;
+
+  void read_timing() {
+    const size_t seconds = line_.find(" seconds");
+    if (seconds == std::string::npos || line_.size() < 17)
+      return;
+    const double value = std::strtod(line_.c_str() + 17, nullptr);
+    if (line_.find("(Warm-up)") != std::string::npos)
+      csv_.timing.warmup += value;
+    else if (line_.find("(Sampling)") != std::string::npos)
+      csv_.timing.sampling += value;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -1,6 +1,7 @@
 #ifndef STAN_IO_DESERIALIZER_HPP
 #define STAN_IO_DESERIALIZER_HPP
 
+#include <stan/io/is_fixed_size_eigen.hpp>
 #include <stan/math/rev.hpp>
 
 namespace stan {
@@ -84,6 +85,59 @@ class deserializer {
   using is_fp_or_ad = bool_constant<std::is_floating_point<S>::value
                                     || is_autodiff<S>::value>;
 
+  template <typename S>
+  using is_fixed = internal::is_fixed_size_eigen<S>;
+
+  template <typename S, Eigen::Index N, typename K>
+  using fixed_free_t = typename internal::fixed_free<T, S, N, K>::type;
+
+  /**
+   * Check the sizes of a read of a fixed-size type match those of the
+   * type, as a vector size or as rows and columns.
+   */
+  template <typename Ret>
+  static void check_fixed_size() {}
+
+  template <typename Ret>
+  static void check_fixed_size(Eigen::Index m) {
+    stan::math::check_size_match("deserializer", "size", m,
+                                 "compile-time size",
+                                 std::decay_t<Ret>::SizeAtCompileTime);
+  }
+
+  template <typename Ret>
+  static void check_fixed_size(Eigen::Index rows, Eigen::Index cols) {
+    stan::math::check_size_match("deserializer", "rows", rows,
+                                 "compile-time rows",
+                                 std::decay_t<Ret>::RowsAtCompileTime);
+    stan::math::check_size_match("deserializer", "columns", cols,
+                                 "compile-time columns",
+                                 std::decay_t<Ret>::ColsAtCompileTime);
+  }
+
+  /**
+   * Read the unconstrained values of an array of objects as one block,
+   * checking the capacity once, and return the array of the objects made
+   * by the specified functor from consecutive segments of the block.
+   *
+   * @tparam Ret The type to return.
+   * @tparam F Type of the functor.
+   * @param vecsize The size of the return vector.
+   * @param size Number of unconstrained values of each object.
+   * @param f Functor taking a segment of `size` values and returning an
+   *  element of the return vector.
+   */
+  template <typename Ret, typename F>
+  inline auto read_blocks(size_t vecsize, Eigen::Index size, const F& f) {
+    std::decay_t<Ret> ret;
+    ret.reserve(vecsize);
+    auto block = this->read<vector_t>(vecsize * size);
+    for (size_t i = 0; i < vecsize; ++i) {
+      ret.emplace_back(f(block.segment(i * size, size)));
+    }
+    return ret;
+  }
+
  public:
   using matrix_t = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
   using vector_t = Eigen::Matrix<T, Eigen::Dynamic, 1>;
@@ -174,7 +228,8 @@ class deserializer {
    * @param m Size of column vector.
    */
   template <typename Ret, require_eigen_col_vector_t<Ret>* = nullptr,
-            require_not_vt_complex<Ret>* = nullptr>
+            require_not_vt_complex<Ret>* = nullptr,
+            require_not_t<is_fixed<Ret>>* = nullptr>
   inline auto read(Eigen::Index m) {
     if (unlikely(m == 0)) {
       return map_vector_t(nullptr, m);
@@ -212,7 +267,8 @@ class deserializer {
    * @param m Size of row vector.
    */
   template <typename Ret, require_eigen_row_vector_t<Ret>* = nullptr,
-            require_not_vt_complex<Ret>* = nullptr>
+            require_not_vt_complex<Ret>* = nullptr,
+            require_not_t<is_fixed<Ret>>* = nullptr>
   inline auto read(Eigen::Index m) {
     if (unlikely(m == 0)) {
       return map_row_vector_t(nullptr, m);
@@ -251,7 +307,8 @@ class deserializer {
    * @param cols The size of the cols of the matrix.
    */
   template <typename Ret, require_eigen_matrix_dynamic_t<Ret>* = nullptr,
-            require_not_vt_complex<Ret>* = nullptr>
+            require_not_vt_complex<Ret>* = nullptr,
+            require_not_t<is_fixed<Ret>>* = nullptr>
   inline auto read(Eigen::Index rows, Eigen::Index cols) {
     if (rows == 0 || cols == 0) {
       return map_matrix_t(nullptr, rows, cols);
@@ -261,6 +318,34 @@ class deserializer {
     }
   }
 
+  /**
+   * Return an Eigen vector or matrix with sizes fixed at compile time, as
+   * a fixed-size map, so that the operations on it are unrolled.  The
+   * sizes may be omitted, or given as for the dynamic sizes, in which
+   * case they are checked against those of the type.
+   * @tparam Ret The type to return.
+   * @tparam Sizes A parameter pack of integral types.
+   * @param sizes No size, the size of a vector, or the rows and columns of
+   *  a matrix.
+   * @throw std::invalid_argument if the sizes differ from those of `Ret`
+   */
+  template <typename Ret, typename... Sizes,
+            require_t<is_fixed<Ret>>* = nullptr,
+            require_not_vt_complex<Ret>* = nullptr>
+  inline auto read(Sizes... sizes) {
+    using fixed_t = Eigen::Matrix<T, std::decay_t<Ret>::RowsAtCompileTime,
+                                  std::decay_t<Ret>::ColsAtCompileTime>;
+    using map_fixed_t = Eigen::Map<const fixed_t>;
+    check_fixed_size<fixed_t>(sizes...);
+    constexpr Eigen::Index size = fixed_t::SizeAtCompileTime;
+    if (size == 0) {
+      return map_fixed_t(nullptr);
+    } else {
+      check_r_capacity(size);
+      return map_fixed_t(&scalar_ptr_increment(size));
+    }
+  }
+
   /**
    * Return an Eigen matrix of size `(rows, cols)` with complex inner type.
    * @tparam Ret The type to return.
@@ -362,6 +447,34 @@ class deserializer {
     }
   }
 
+  /**
+   * The type `read_arena<Ret>` reads: `Ret` with its containers allocated
+   * in the memory arena of the autodiff stack when the scalars are `var`,
+   * and `Ret` otherwise.
+   */
+  template <typename Ret>
+  using arena_read_t
+      = std::conditional_t<is_var<T>::value, stan::math::arena_t<Ret>, Ret>;
+
+  /**
+   * Return the next object as `read<Ret>` does, but with the containers of
+   * `std::vector` types, and their Eigen elements, allocated in the memory
+   * arena of the autodiff stack when the scalars are `var`.  Reading the
+   * parameters of a log density into these types does no allocation on
+   * the heap, and their memory is freed with the rest of the autodiff
+   * stack by <code>stan::math::recover_memory()</code>, so they must not
+   * be used after it.  The constrained reads take the same types as
+   * their `Ret`, as <code>arena_read_t<Ret></code>.
+   *
+   * @tparam Ret The type to read, with heap containers.
+   * @tparam Sizes integral types.
+   * @param sizes The sizes of the object, as for `read<Ret>`.
+   */
+  template <typename Ret, typename... Sizes>
+  inline auto read_arena(Sizes... sizes) {
+    return this->read<arena_read_t<Ret>>(sizes...);
+  }
+
   /**
    * Return the next object transformed to have the specified
    * lower bound, possibly incrementing the specified reference with the
@@ -510,7 +623,8 @@ class deserializer {
    * @throw std::invalid_argument if k is zero
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_unit_vector(LP& lp, const size_t vecsize,
                                          Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -523,6 +637,35 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next unit_vector of the specified size (using one fewer
+   * unconstrained scalars), incrementing the specified reference with the
+   * log absolute Jacobian determinant.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::unit_vector_constrain(Eigen::Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param size Number of cells in each element.
+   * @return The next unit_vector of the specified size.
+   * @throw std::invalid_argument if k is zero
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_unit_vector(LP& lp, const size_t vecsize,
+                                         Eigen::Index size) {
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::eval(
+          stan::math::unit_vector_constrain<Jacobian>(x, lp));
+    });
+  }
+
   /**
    * Return the next simplex of the specified size (using one fewer
    * unconstrained scalars), incrementing the specified reference with the
@@ -544,8 +687,9 @@ class deserializer {
             require_not_std_vector_t<Ret>* = nullptr>
   inline auto read_constrain_simplex(LP& lp, size_t size) {
     stan::math::check_positive("read_simplex", "size", size);
-    return stan::math::simplex_constrain<Jacobian>(this->read<Ret>(size - 1),
-                                                   lp);
+    using free_t = fixed_free_t<Ret, internal::fixed_dims<Ret>::rows - 1, Ret>;
+    return stan::math::simplex_constrain<Jacobian>(
+        this->read<free_t>(size - 1), lp);
   }
 
   /**
@@ -568,7 +712,8 @@ class deserializer {
    * @throws std::invalid_argument if number of dimensions (`k`) is zero
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_simplex(LP& lp, const size_t vecsize,
                                      Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -581,6 +726,37 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next simplex of the specified size (using one fewer
+   * unconstrained scalars), incrementing the specified reference with the
+   * log absolute Jacobian determinant.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::simplex_constrain(Eigen::Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param size Number of cells in each element.
+   * @return The next simplex of the specified size.
+   * @throws std::invalid_argument if number of dimensions (`k`) is zero
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_simplex(LP& lp, const size_t vecsize,
+                                     size_t size) {
+    if (vecsize > 0) {
+      stan::math::check_positive("read_simplex", "size", size);
+    }
+    return this->read_blocks<Ret>(vecsize, size - 1, [&](const auto& x) {
+      return stan::math::simplex_constrain<Jacobian>(x, lp);
+    });
+  }
+
   /**
    * Return the next zero sum vector of the specified size (using one fewer
    * unconstrained scalars), incrementing the specified reference with the
@@ -602,8 +778,9 @@ class deserializer {
             require_not_std_vector_t<Ret>* = nullptr>
   inline auto read_constrain_sum_to_zero(LP& lp, size_t size) {
     stan::math::check_positive("read_sum_to_zero", "size", size);
+    using free_t = fixed_free_t<Ret, internal::fixed_dims<Ret>::rows - 1, Ret>;
     return stan::math::sum_to_zero_constrain<Jacobian>(
-        this->read<Ret>(size - 1), lp);
+        this->read<free_t>(size - 1), lp);
   }
 
   /**
@@ -626,7 +803,8 @@ class deserializer {
    * @throws std::invalid_argument if number of dimensions (`k`) is zero
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_sum_to_zero(LP& lp, const size_t vecsize,
                                          Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -639,6 +817,37 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next zero sum vector of the specified size (using one fewer
+   * unconstrained scalars), incrementing the specified reference with the
+   * log absolute Jacobian determinant (no adjustment, in this case).
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::sum_to_zero_constrain(Eigen::Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param size Number of cells in each element.
+   * @return The next zero sum of the specified size.
+   * @throws std::invalid_argument if number of dimensions (`k`) is zero
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_sum_to_zero(LP& lp, const size_t vecsize,
+                                         size_t size) {
+    if (vecsize > 0) {
+      stan::math::check_positive("read_sum_to_zero", "size", size);
+    }
+    return this->read_blocks<Ret>(vecsize, size - 1, [&](const auto& x) {
+      return stan::math::sum_to_zero_constrain<Jacobian>(x, lp);
+    });
+  }
+
   /**
    * Return the next ordered vector of the specified
    * size, incrementing the specified reference with the log
@@ -682,7 +891,8 @@ class deserializer {
    * @return Next ordered vector of the specified size.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_ordered(LP& lp, const size_t vecsize,
                                      Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -695,6 +905,33 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next ordered vector of the specified
+   * size, incrementing the specified reference with the log
+   * absolute Jacobian of the determinant.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::ordered_constrain(Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param size Number of cells in each element.
+   * @return Next ordered vector of the specified size.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_ordered(LP& lp, const size_t vecsize,
+                                     Eigen::Index size) {
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::ordered_constrain<Jacobian>(x, lp);
+    });
+  }
+
   /**
    * Return the next positive_ordered vector of the specified
    * size, incrementing the specified reference with the log
@@ -738,7 +975,8 @@ class deserializer {
    * @return Next positive_ordered vector of the specified size.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_positive_ordered(LP& lp, const size_t vecsize,
                                               Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -751,6 +989,33 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next positive_ordered vector of the specified
+   * size, incrementing the specified reference with the log
+   * absolute Jacobian of the determinant.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::positive_ordered_constrain(Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param size Number of cells in each element.
+   * @return Next positive_ordered vector of the specified size.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_positive_ordered(LP& lp, const size_t vecsize,
+                                              Eigen::Index size) {
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::positive_ordered_constrain<Jacobian>(x, lp);
+    });
+  }
+
   /**
    * Return the next Cholesky factor with the specified
    * dimensionality, reading from an unconstrained vector of the
@@ -772,10 +1037,13 @@ class deserializer {
             require_matrix_t<Ret>* = nullptr>
   inline auto read_constrain_cholesky_factor_cov(LP& lp, Eigen::Index M,
                                                  Eigen::Index N) {
+    constexpr Eigen::Index fixed_M = internal::fixed_dims<Ret>::rows;
+    constexpr Eigen::Index fixed_N = internal::fixed_dims<Ret>::cols;
+    using free_t = fixed_free_t<
+        Ret, (fixed_N * (fixed_N + 1)) / 2 + (fixed_M - fixed_N) * fixed_N,
+        conditional_var_val_t<Ret, vector_t>>;
     return stan::math::cholesky_factor_constrain<Jacobian>(
-        this->read<conditional_var_val_t<Ret, vector_t>>((N * (N + 1)) / 2
-                                                         + (M - N) * N),
-        M, N, lp);
+        this->read<free_t>((N * (N + 1)) / 2 + (M - N) * N), M, N, lp);
   }
 
   /**
@@ -798,7 +1066,8 @@ class deserializer {
    *    Cholesky factor.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_cholesky_factor_cov(LP& lp, const size_t vecsize,
                                                  Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -811,6 +1080,36 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next Cholesky factor with the specified
+   * dimensionality, reading from an unconstrained vector of the
+   * appropriate size, and increment the log probability reference
+   * with the log Jacobian adjustment for the transform.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param M Rows of each element.
+   * @param N Columns of each element.
+   * @return Next Cholesky factor.
+   * @throw std::domain_error if the matrix is not a valid
+   *    Cholesky factor.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_cholesky_factor_cov(
+      LP& lp, const size_t vecsize, Eigen::Index M, Eigen::Index N) {
+    const Eigen::Index size = (N * (N + 1)) / 2 + (M - N) * N;
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::cholesky_factor_constrain<Jacobian>(x, M, N, lp);
+    });
+  }
+
   /**
    * Return the next Cholesky factor for a correlation matrix with
    * the specified dimensionality, reading from an unconstrained
@@ -831,9 +1130,11 @@ class deserializer {
   template <typename Ret, bool Jacobian, typename LP,
             require_matrix_t<Ret>* = nullptr>
   inline auto read_constrain_cholesky_factor_corr(LP& lp, Eigen::Index K) {
+    constexpr Eigen::Index fixed_K = internal::fixed_dims<Ret>::rows;
+    using free_t = fixed_free_t<Ret, (fixed_K * (fixed_K - 1)) / 2,
+                                conditional_var_val_t<Ret, vector_t>>;
     return stan::math::cholesky_corr_constrain<Jacobian>(
-        this->read<conditional_var_val_t<Ret, vector_t>>((K * (K - 1)) / 2), K,
-        lp);
+        this->read<free_t>((K * (K - 1)) / 2), K, lp);
   }
 
   /**
@@ -857,7 +1158,8 @@ class deserializer {
    *    Cholesky factor for a correlation matrix.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_cholesky_factor_corr(LP& lp, const size_t vecsize,
                                                   Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -870,6 +1172,36 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next Cholesky factor for a correlation matrix with
+   * the specified dimensionality, reading from an unconstrained
+   * vector of the appropriate size, and increment the log
+   * probability reference with the log Jacobian adjustment for
+   * the transform.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param K Rows and columns of each element.
+   * @return Next Cholesky factor for a correlation matrix.
+   * @throw std::domain_error if the matrix is not a valid
+   *    Cholesky factor for a correlation matrix.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_cholesky_factor_corr(LP& lp, const size_t vecsize,
+                                                  Eigen::Index K) {
+    const Eigen::Index size = (K * (K - 1)) / 2;
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::cholesky_corr_constrain<Jacobian>(x, K, lp);
+    });
+  }
+
   /**
    * Return the next covariance matrix of the specified dimensionality,
    * incrementing the specified reference with the log absolute Jacobian
@@ -888,9 +1220,11 @@ class deserializer {
   template <typename Ret, bool Jacobian, typename LP,
             require_matrix_t<Ret>* = nullptr>
   inline auto read_constrain_cov_matrix(LP& lp, Eigen::Index k) {
+    constexpr Eigen::Index fixed_k = internal::fixed_dims<Ret>::rows;
+    using free_t = fixed_free_t<Ret, fixed_k + (fixed_k * (fixed_k - 1)) / 2,
+                                conditional_var_val_t<Ret, vector_t>>;
     return stan::math::cov_matrix_constrain<Jacobian>(
-        this->read<conditional_var_val_t<Ret, vector_t>>(k + (k * (k - 1)) / 2),
-        k, lp);
+        this->read<free_t>(k + (k * (k - 1)) / 2), k, lp);
   }
 
   /**
@@ -912,7 +1246,8 @@ class deserializer {
    * @return The next covariance matrix of the specified dimensionality.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   auto read_constrain_cov_matrix(LP& lp, const size_t vecsize, Sizes... sizes) {
     std::decay_t<Ret> ret;
     ret.reserve(vecsize);
@@ -924,6 +1259,34 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Return the next covariance matrix of the specified dimensionality,
+   * incrementing the specified reference with the log absolute Jacobian
+   * determinant.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::cov_matrix_constrain(Matrix,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param k Rows and columns of each element.
+   * @return The next covariance matrix of the specified dimensionality.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_cov_matrix(LP& lp, const size_t vecsize,
+                                        Eigen::Index k) {
+    const Eigen::Index size = k + (k * (k - 1)) / 2;
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::cov_matrix_constrain<Jacobian>(x, k, lp);
+    });
+  }
+
   /**
    * Return the next object transformed to be a (partial)
    * correlation between -1 and 1, incrementing the specified
@@ -943,9 +1306,11 @@ class deserializer {
             require_not_std_vector_t<Ret>* = nullptr,
             require_matrix_t<Ret>* = nullptr>
   inline auto read_constrain_corr_matrix(LP& lp, Eigen::Index k) {
+    constexpr Eigen::Index fixed_k = internal::fixed_dims<Ret>::rows;
+    using free_t = fixed_free_t<Ret, (fixed_k * (fixed_k - 1)) / 2,
+                                conditional_var_val_t<Ret, vector_t>>;
     return stan::math::corr_matrix_constrain<Jacobian>(
-        this->read<conditional_var_val_t<Ret, vector_t>>((k * (k - 1)) / 2), k,
-        lp);
+        this->read<free_t>((k * (k - 1)) / 2), k, lp);
   }
 
   /**
@@ -965,7 +1330,8 @@ class deserializer {
    * @return The next scalar transformed to a correlation.
    */
   template <typename Ret, bool Jacobian, typename LP, typename... Sizes,
-            require_std_vector_t<Ret>* = nullptr>
+            require_std_vector_t<Ret>* = nullptr,
+            require_not_std_vector_vt<is_eigen, Ret>* = nullptr>
   inline auto read_constrain_corr_matrix(LP& lp, const size_t vecsize,
                                          Sizes... sizes) {
     std::decay_t<Ret> ret;
@@ -978,6 +1344,32 @@ class deserializer {
     return ret;
   }
 
+  /**
+   * Specialization of `read_corr` for `std::vector` return types.
+   * The unconstrained values of the whole array are read as one block.
+   *
+   * <p>See <code>stan::math::corr_constrain(T,T&)</code>.
+   *
+   * @tparam Ret The type to return.
+   * @tparam Jacobian Whether to increment the log of the absolute Jacobian
+   * determinant of the transform.
+   * @tparam LP Type of log probability.
+   * @param lp The reference to the variable holding the log
+   * probability to increment.
+   * @param vecsize The size of the return vector.
+   * @param k Rows and columns of each element.
+   * @return The next scalar transformed to a correlation.
+   */
+  template <typename Ret, bool Jacobian, typename LP,
+            require_std_vector_vt<is_eigen, Ret>* = nullptr>
+  inline auto read_constrain_corr_matrix(LP& lp, const size_t vecsize,
+                                         Eigen::Index k) {
+    const Eigen::Index size = (k * (k - 1)) / 2;
+    return this->read_blocks<Ret>(vecsize, size, [&](const auto& x) {
+      return stan::math::corr_matrix_constrain<Jacobian>(x, k, lp);
+    });
+  }
+
   /**
    * Return the next object transformed to a matrix with simplexes along the
    * columns
@@ -0,0 +1,78 @@
+#ifndef STAN_IO_DRAWS_SOURCE_HPP
+#define STAN_IO_DRAWS_SOURCE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cstddef>
+
+namespace stan {
+namespace io {
+
+/**
+ * <code>draws_source</code> is a base class for sources of draws read a
+ * chunk at a time, so that services taking draws from a previous fit
+ * need not hold all of them in memory.
+ */
+class draws_source {
+ public:
+  virtual ~draws_source() {}
+
+  /**
+   * Return the number of values of each draw.
+   */
+  virtual size_t num_cols() const = 0;
+
+  /**
+   * Read the next draws, at most the specified number, into the first
+   * rows of a matrix, which is resized to <code>num_cols()</code> columns
+   * and at most that number of rows if it does not have that shape.
+   *
+   * @param[in] max_draws largest number of draws read
+   * @param[out] draws one row per draw
+   * @return number of draws read, zero once the draws are exhausted
+   */
+  virtual size_t read(size_t max_draws, Eigen::MatrixXd& draws) = 0;
+
+ protected:
+  /**
+   * Give a matrix the shape to read the specified number of draws into.
+   */
+  void shape(size_t num_draws, Eigen::MatrixXd& draws) const {
+    if (draws.rows() != static_cast<Eigen::Index>(num_draws)
+        || draws.cols() != static_cast<Eigen::Index>(num_cols()))
+      draws.resize(num_draws, num_cols());
+  }
+};
+
+/**
+ * A source of the rows of a matrix of draws held by the caller, which
+ * must outlive the source.
+ */
+class matrix_draws_source : public draws_source {
+ public:
+  /**
+   * @param[in] draws one row per draw
+   */
+  explicit matrix_draws_source(const Eigen::MatrixXd& draws)
+      : draws_(draws) {}
+
+  size_t num_cols() const { return draws_.cols(); }
+
+  size_t read(size_t max_draws, Eigen::MatrixXd& draws) {
+    const size_t n = std::min<size_t>(max_draws, draws_.rows() - next_);
+    if (n == 0)
+      return 0;
+    shape(n, draws);
+    draws.topRows(n) = draws_.middleRows(next_, n);
+    next_ += n;
+    return n;
+  }
+
+ private:
+  const Eigen::MatrixXd& draws_;
+  Eigen::Index next_ = 0;
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
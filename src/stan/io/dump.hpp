@@ -5,11 +5,18 @@
 #include <stan/io/validate_dims.hpp>
 #include <stan/io/var_context.hpp>
 #include <stan/math/prim.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <sstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <utility>
 #include <vector>
@@ -578,6 +585,285 @@ class dump_reader {
   }
 };
 
+/**
+ * Reads data in the S-plus dump format from a memory buffer.
+ *
+ * A <code>dump_buffer_reader</code> reads the same definitions as a
+ * <code>dump_reader</code> and has the same scanner interface, except
+ * that the name, dimensions and values of the most recently read variable
+ * are returned by reference, so they can be moved out of the reader.
+ *
+ * <p>Definitions whose value is a sequence of numbers, either
+ * <code>c(...)</code> or <code>structure(c(...), .Dim = c(...))</code>,
+ * are scanned straight from the buffer: the end of the sequence is found
+ * with <code>memchr</code> and the numbers are converted in place with
+ * <code>std::from_chars</code>.  Any other definition, and any sequence
+ * holding something other than plain decimal numbers, is read by a
+ * <code>dump_reader</code> over the same characters, so both readers
+ * produce the same values and report the same errors.
+ */
+class dump_buffer_reader {
+ private:
+  // an input stream buffer over the characters, which are not copied
+  struct memory_buf : public std::streambuf {
+    memory_buf(const char* begin, const char* pos, const char* end) {
+      setg(const_cast<char*>(begin), const_cast<char*>(pos),
+           const_cast<char*>(end));
+    }
+    const char* pos() const { return gptr(); }
+  };
+
+  const char* begin_;
+  const char* pos_;
+  const char* end_;
+  std::string name_;
+  std::vector<int> stack_i_;
+  std::vector<double> stack_r_;
+  std::vector<size_t> dims_;
+
+  static bool is_space(char c) {
+    return std::isspace(static_cast<unsigned char>(c));
+  }
+
+  static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  void skip_space(const char*& p) const {
+    while (p != end_ && is_space(*p))
+      ++p;
+  }
+
+  bool scan_char(const char*& p, char c) const {
+    skip_space(p);
+    if (p == end_ || *p != c)
+      return false;
+    ++p;
+    return true;
+  }
+
+  bool scan_chars(const char*& p, const char* s) const {
+    skip_space(p);
+    for (; *s; ++s, ++p)
+      if (p == end_ || *p != *s)
+        return false;
+    return true;
+  }
+
+  bool scan_name(const char*& p) {
+    skip_space(p);
+    char quote = 0;
+    if (p != end_ && (*p == '"' || *p == '\'')) {
+      quote = *p++;
+      skip_space(p);
+    }
+    if (p == end_ || !std::isalpha(static_cast<unsigned char>(*p)))
+      return false;
+    const char* name_begin = p;
+    while (p != end_
+           && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_'
+               || *p == '.'))
+      ++p;
+    name_.assign(name_begin, p);
+    return quote == 0 || scan_char(p, quote);
+  }
+
+  bool scan_dim(const char*& p, size_t& d) const {
+    skip_space(p);
+    const char* digits_end = p;
+    while (digits_end != end_ && is_digit(*digits_end))
+      ++digits_end;
+    if (digits_end == p
+        || std::from_chars(p, digits_end, d).ec != std::errc())
+      return false;
+    p = digits_end;
+    return true;
+  }
+
+  /**
+   * Scan a number ending before the specified closing parenthesis,
+   * returning <code>false</code> if it is not a plain decimal number
+   * converted the same way by the <code>dump_reader</code>.
+   */
+  bool scan_number(const char*& p, const char* close) {
+    skip_space(p);
+    bool negate_val = false;
+    if (*p == '-') {
+      negate_val = true;
+      ++p;
+    } else if (*p == '+') {
+      ++p;
+    }
+    const char* token = p;
+    bool is_double = false;
+    for (; p != close; ++p) {
+      if (is_digit(*p))
+        continue;
+      if (*p == '.' || *p == 'e' || *p == 'E' || *p == '-' || *p == '+')
+        is_double = true;
+      else
+        break;
+    }
+    if (p == token || (!is_digit(*token) && *token != '.'))
+      return false;
+    if (!is_double && stack_r_.empty()) {
+      int n;
+      if (std::from_chars(token, p, n).ec != std::errc())
+        return false;
+      stack_i_.push_back(negate_val ? -n : n);
+      return true;
+    }
+    if (!stack_i_.empty()) {
+      stack_r_.assign(stack_i_.begin(), stack_i_.end());
+      stack_i_.clear();
+    }
+    double x;
+    std::from_chars_result result = std::from_chars(token, p, x);
+    // leave zeros that underflowed, subnormals and overflows to the
+    // dump_reader, which reports them
+    if (result.ec != std::errc() || result.ptr != p
+        || std::fabs(x) > std::numeric_limits<double>::max()
+        || (x != 0 && std::fabs(x) < std::numeric_limits<double>::min()))
+      return false;
+    if (x == 0) {
+      for (const char* q = token; q != p && *q != 'e' && *q != 'E'; ++q)
+        if (*q >= '1' && *q <= '9')
+          return false;
+    }
+    stack_r_.push_back(negate_val ? -x : x);
+    return true;
+  }
+
+  bool scan_seq_value(const char*& p) {
+    if (!scan_char(p, '('))
+      return false;
+    if (!scan_char(p, ')')) {
+      const char* close
+          = static_cast<const char*>(std::memchr(p, ')', end_ - p));
+      if (close == nullptr)
+        return false;
+      do {
+        if (!scan_number(p, close))
+          return false;
+      } while (scan_char(p, ','));
+      if (!scan_char(p, ')'))
+        return false;
+    }
+    dims_.push_back(stack_r_.size() + stack_i_.size());
+    return true;
+  }
+
+  bool scan_struct_value(const char*& p) {
+    if (!scan_char(p, '(') || !scan_char(p, 'c') || !scan_seq_value(p))
+      return false;
+    dims_.clear();
+    if (!scan_char(p, ',') || !scan_char(p, '.') || !scan_chars(p, "Dim")
+        || !scan_char(p, '=') || !scan_char(p, 'c') || !scan_char(p, '('))
+      return false;
+    do {
+      size_t dim;
+      if (!scan_dim(p, dim))
+        return false;
+      dims_.push_back(dim);
+    } while (scan_char(p, ','));
+    return scan_char(p, ')') && scan_char(p, ')');
+  }
+
+  bool scan_definition(const char*& p) {
+    if (!scan_name(p) || !scan_char(p, '<') || !scan_char(p, '-'))
+      return false;
+    if (scan_char(p, 'c'))
+      return scan_seq_value(p);
+    return scan_chars(p, "structure") && scan_struct_value(p);
+  }
+
+  void clear() {
+    stack_r_.clear();
+    stack_i_.clear();
+    dims_.clear();
+    name_.erase();
+  }
+
+ public:
+  /**
+   * Construct a reader for the specified buffer, which must outlive the
+   * reader.
+   *
+   * @param data pointer to the first character of the buffer
+   * @param size number of characters in the buffer
+   */
+  dump_buffer_reader(const char* data, size_t size)
+      : begin_(data), pos_(data), end_(data + size) {}
+
+  /**
+   * Return the name of the most recently read variable.
+   *
+   * @return Name of most recently read variable.
+   */
+  std::string& name() { return name_; }
+
+  /**
+   * Return the dimensions of the most recently
+   * read variable.
+   *
+   * @return Last dimensions.
+   */
+  std::vector<size_t>& dims() { return dims_; }
+
+  /**
+   * Checks if the last item read is integer.
+   *
+   * Return <code>true</code> if the value(s) in the most recently
+   * read item are integer values and <code>false</code> if
+   * they are floating point.
+   */
+  bool is_int() { return stack_r_.size() == 0; }
+
+  /**
+   * Returns the integer values from the last item if the
+   * last item read was an integer and the empty vector otherwise.
+   *
+   * @return Integer values of last item.
+   */
+  std::vector<int>& int_values() { return stack_i_; }
+
+  /**
+   * Returns the floating point values from the last item if the
+   * last item read contained floating point values and the empty
+   * vector otherwise.
+   *
+   * @return Floating point values of last item.
+   */
+  std::vector<double>& double_values() { return stack_r_; }
+
+  /**
+   * Read the next value from the buffer, returning
+   * <code>true</code> if successful and <code>false</code> if no
+   * further input may be read.
+   *
+   * @return Return <code>true</code> if a fresh variable was read.
+   * @throws std::invalid_argument if bad number values encountered.
+   */
+  bool next() {
+    clear();
+    const char* p = pos_;
+    if (scan_definition(p)) {
+      pos_ = p;
+      return true;
+    }
+    clear();
+    memory_buf buf(begin_, pos_, end_);
+    std::istream in(&buf);
+    dump_reader reader(in);
+    if (!reader.next())
+      return false;
+    name_ = reader.name();
+    dims_ = reader.dims();
+    stack_i_ = reader.int_values();
+    stack_r_ = reader.double_values();
+    pos_ = buf.pos();
+    return true;
+  }
+};
+
 /**
  * Represents named arrays with dimensions.
  *
@@ -639,6 +925,51 @@ class dump : public stan::io::var_context {
     }
   }
 
+  /**
+   * Construct a dump object from the specified buffer, moving the values
+   * read by a <code>dump_buffer_reader</code> into this object.
+   *
+   * @param data pointer to the first character of the buffer
+   * @param size number of characters in the buffer
+   */
+  dump(const char* data, size_t size) {
+    dump_buffer_reader reader(data, size);
+    while (reader.next()) {
+      if (reader.is_int()) {
+        vars_i_[reader.name()]
+            = std::pair<std::vector<int>, std::vector<size_t>>(
+                std::move(reader.int_values()), std::move(reader.dims()));
+      } else {
+        vars_r_[reader.name()]
+            = std::pair<std::vector<double>, std::vector<size_t>>(
+                std::move(reader.double_values()), std::move(reader.dims()));
+      }
+    }
+  }
+
+  /**
+   * Construct a dump object from the specified file, which is mapped into
+   * memory and read with a <code>dump_buffer_reader</code>.
+   *
+   * @param filename name of the file
+   * @throw std::invalid_argument if the file can not be opened
+   * @return dump object holding the variables in the file
+   */
+  static dump from_file(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in)
+      throw std::invalid_argument("Error: can not open file " + filename);
+    if (in.tellg() <= 0) {
+      // an empty file can not be mapped
+      return dump("", 0);
+    }
+    namespace bip = boost::interprocess;
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    return dump(static_cast<const char*>(region.get_address()),
+                region.get_size());
+  }
+
   /**
    * Return <code>true</code> if this dump contains the specified
    * variable name is defined. This method returns <code>true</code>
@@ -745,6 +1076,36 @@ class dump : public stan::io::var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name.  Integer variables are copied to doubles.
+   *
+   * @param name Name of variable.
+   * @return View of values of variable.
+   */
+  values_view<double> view_r(const std::string& name) const {
+    if (contains_r_only(name)) {
+      auto&& vec_r = (vars_r_.find(name)->second).first;
+      return {vec_r.data(), vec_r.size()};
+    }
+    return var_context::view_r(name);
+  }
+
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of values.
+   */
+  values_view<int> view_i(const std::string& name) const {
+    if (contains_i(name)) {
+      auto&& vec_i = (vars_i_.find(name)->second).first;
+      return {vec_i.data(), vec_i.size()};
+    }
+    return {};
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
@@ -0,0 +1,57 @@
+#ifndef STAN_IO_IS_FIXED_SIZE_EIGEN_HPP
+#define STAN_IO_IS_FIXED_SIZE_EIGEN_HPP
+
+#include <stan/math/prim/meta.hpp>
+#include <type_traits>
+
+namespace stan {
+namespace io {
+namespace internal {
+
+/**
+ * Whether a type is an Eigen type with sizes fixed at compile time, which
+ * the serializers read and write through fixed-size maps.
+ */
+template <typename S, typename = void>
+struct is_fixed_size_eigen : std::false_type {};
+
+template <typename S>
+struct is_fixed_size_eigen<
+    S, std::enable_if_t<is_eigen<std::decay_t<S>>::value>>
+    : bool_constant<std::decay_t<S>::SizeAtCompileTime != Eigen::Dynamic> {};
+
+/**
+ * Compile-time rows and columns of a fixed-size Eigen type, and dynamic
+ * for any other type.
+ */
+template <typename S, typename = void>
+struct fixed_dims {
+  static constexpr Eigen::Index rows = Eigen::Dynamic;
+  static constexpr Eigen::Index cols = Eigen::Dynamic;
+};
+
+template <typename S>
+struct fixed_dims<S, std::enable_if_t<is_fixed_size_eigen<S>::value>> {
+  static constexpr Eigen::Index rows = std::decay_t<S>::RowsAtCompileTime;
+  static constexpr Eigen::Index cols = std::decay_t<S>::ColsAtCompileTime;
+};
+
+/**
+ * The column vector of `N` unconstrained scalars of type `T` from which a
+ * constrained `S` is made, if `S` is fixed-size, and `K` otherwise.
+ */
+template <typename T, typename S, Eigen::Index N, typename K,
+          bool = is_fixed_size_eigen<S>::value>
+struct fixed_free {
+  using type = K;
+};
+
+template <typename T, typename S, Eigen::Index N, typename K>
+struct fixed_free<T, S, N, K, true> {
+  using type = Eigen::Matrix<T, N, 1>;
+};
+
+}  // namespace internal
+}  // namespace io
+}  // namespace stan
+#endif
@@ -1,14 +1,24 @@
 #ifndef STAN_IO_JSON_JSON_DATA_HPP
 #define STAN_IO_JSON_JSON_DATA_HPP
 
+#include <stan/io/json/json_data_fast_handler.hpp>
 #include <stan/io/json/json_data_handler.hpp>
 #include <stan/io/json/json_error.hpp>
+#include <stan/io/json/json_prescan.hpp>
 #include <stan/io/json/rapidjson_parser.hpp>
 #include <stan/io/var_context.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <atomic>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <set>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <complex>
@@ -61,6 +71,55 @@ class json_data : public stan::io::var_context {
     return vars_r_.find(name) != vars_r_.end();
   }
 
+  /**
+   * Parse the members of the top-level object of the specified text in
+   * parallel.
+   *
+   * @return <code>false</code>, leaving no variables, if the text has to
+   * be parsed serially
+   */
+  bool parse_in_parallel(const char *data, size_t size) {
+    std::vector<internal::json_member> members;
+    if (!internal::prescan_members(data, size, members))
+      return false;
+    // redefinitions are reported by the serial parse
+    std::set<std::string> keys;
+    for (const auto &member : members)
+      if (!keys.insert(member.key).second)
+        return false;
+    std::vector<vars_map_r> member_vars_r(members.size());
+    std::vector<vars_map_i> member_vars_i(members.size());
+    std::atomic<bool> failed(false);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, members.size(), 1),
+        [&](const tbb::blocked_range<size_t> &r) {
+          for (size_t n = r.begin(); n != r.end() && !failed; ++n) {
+            try {
+              json_data_fast_handler handler(member_vars_r[n],
+                                             member_vars_i[n]);
+              handler.start_text();
+              handler.start_object();
+              handler.key(members[n].key);
+              internal::rapidjson_parse_value(members[n].value,
+                                              members[n].size, handler);
+              handler.end_object();
+              handler.end_text();
+            } catch (const json_error &e) {
+              failed = true;
+            }
+          }
+        });
+    if (failed)
+      return false;
+    for (size_t n = 0; n < members.size(); ++n) {
+      for (auto &var : member_vars_r[n])
+        vars_r_[var.first] = std::move(var.second);
+      for (auto &var : member_vars_i[n])
+        vars_i_[var.first] = std::move(var.second);
+    }
+    return true;
+  }
+
  public:
   /**
    * Construct a json_data object from the specified input stream.
@@ -75,6 +134,59 @@ class json_data : public stan::io::var_context {
     rapidjson_parse(in, handler);
   }
 
+  /**
+   * Construct a json_data object from the JSON text in the specified
+   * buffer, which does not need to be null terminated.
+   *
+   * <p>Scalars and arrays of numbers are read with a
+   * <code>json_data_fast_handler</code>, which gives the same variables
+   * as the stream constructor.
+   *
+   * <p>If <code>parallel</code> is set, the members of the top-level
+   * object are found by a scan of the structure of the text and their
+   * values are parsed in parallel.  Texts the scan does not handle, and
+   * texts with errors, are parsed again serially, so the variables and
+   * the errors are the same either way.
+   *
+   * @param data Pointer to the first character of the text
+   * @param size Number of characters in the text
+   * @param parallel Whether to parse the variables in parallel
+   * @throws json_exception if data is not well-formed stan data declaration
+   */
+  json_data(const char *data, size_t size, bool parallel = false)
+      : vars_r_(), vars_i_() {
+    if (!parallel || !parse_in_parallel(data, size)) {
+      json_data_fast_handler handler(vars_r_, vars_i_);
+      rapidjson_parse(data, size, handler);
+    }
+  }
+
+  /**
+   * Read the JSON file with the specified name by memory mapping it and
+   * parsing the mapping as the buffer constructor does.
+   *
+   * @param filename Name of the file
+   * @param parallel Whether to parse the variables in parallel
+   * @return Variables in the file
+   * @throws json_exception if data is not well-formed stan data declaration
+   * @throws std::invalid_argument if the file can not be opened
+   */
+  static json_data from_file(const std::string &filename,
+                             bool parallel = false) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in)
+      throw std::invalid_argument("Error: can not open file " + filename);
+    if (in.tellg() <= 0) {
+      // an empty file can not be mapped
+      return json_data("", 0, parallel);
+    }
+    namespace bip = boost::interprocess;
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    return json_data(static_cast<const char *>(region.get_address()),
+                     region.get_size(), parallel);
+  }
+
   /**
    * Return <code>true</code> if this json_data contains the specified
    * variable name. This method returns <code>true</code>
@@ -189,6 +301,36 @@ class json_data : public stan::io::var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name.  Integer variables are copied to doubles.
+   *
+   * @param name Name of variable.
+   * @return View of values of variable.
+   */
+  stan::io::values_view<double> view_r(const std::string &name) const {
+    if (contains_r_only(name)) {
+      auto &&vec_r = (vars_r_.find(name)->second).first;
+      return {vec_r.data(), vec_r.size()};
+    }
+    return stan::io::var_context::view_r(name);
+  }
+
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of values.
+   */
+  stan::io::values_view<int> view_i(const std::string &name) const {
+    if (contains_i(name)) {
+      auto &&vec_i = (vars_i_.find(name)->second).first;
+      return {vec_i.data(), vec_i.size()};
+    }
+    return {};
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
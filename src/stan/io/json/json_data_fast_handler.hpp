@@ -0,0 +1,433 @@
+#ifndef STAN_IO_JSON_JSON_DATA_FAST_HANDLER_HPP
+#define STAN_IO_JSON_JSON_DATA_FAST_HANDLER_HPP
+
+#include <stan/io/json/json_data_handler.hpp>
+#include <stan/io/json/json_error.hpp>
+#include <stan/io/json/json_handler.hpp>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace stan {
+
+namespace json {
+
+/**
+ * A <code>json_data_fast_handler</code> fills the same maps as a
+ * <code>json_data_handler</code> from the same JSON text, but reads
+ * scalars and rectangular arrays of numbers without tracking slot paths.
+ *
+ * The values of such a variable are appended straight to the vector that
+ * ends up in the map, and its dimensions are checked one nesting level at
+ * a time.  Only arrays of two or more dimensions are copied once more, to
+ * reorder them from row-major to column-major order.
+ *
+ * Variables whose value holds a JSON object, that is tuples and arrays of
+ * tuples, are handed to a <code>json_data_handler</code> of their own and
+ * merged into the maps once they have been read.  Entries that are not
+ * legal Stan variable names are skipped, as the
+ * <code>json_data_handler</code> does.
+ */
+class json_data_fast_handler : public stan::json::json_handler {
+ private:
+  vars_map_r& vars_r_;
+  vars_map_i& vars_i_;
+  std::unordered_set<std::string> names_;
+  bool in_object_;
+  std::string name_;
+
+  enum class state { TOP, ARRAY, TUPLE, SKIP };
+  state state_;
+  // nesting of arrays and objects in the value of the current variable
+  size_t depth_;
+
+  // array being read
+  std::vector<size_t> counts_;
+  std::vector<size_t> dims_;
+  std::vector<bool> dims_known_;
+  size_t leaf_depth_;
+  // whether the value so far is only the opening of arrays
+  bool only_opened_;
+  bool is_int_;
+  std::vector<int> values_i_;
+  std::vector<double> values_r_;
+
+  // tuple being read
+  std::unique_ptr<json_data_handler> tuple_handler_;
+  vars_map_r tuple_vars_r_;
+  vars_map_i tuple_vars_i_;
+
+  static bool valid_varname(const std::string& name) {
+    auto is_letter = [](char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    };
+    if (name.empty() || !is_letter(name[0]))
+      return false;
+    for (char c : name)
+      if (!is_letter(c) && !(c >= '0' && c <= '9') && c != '_')
+        return false;
+    return true;
+  }
+
+  [[noreturn]] void error(const std::string& what) const {
+    std::stringstream errorMsg;
+    errorMsg << "Variable: " << name_ << ", error: " << what << ".";
+    throw json_error(errorMsg.str());
+  }
+
+  void start_variable(const std::string& name) {
+    name_ = name;
+    depth_ = 0;
+    if (!valid_varname(name)) {
+      state_ = state::SKIP;
+      return;
+    }
+    if (!names_.insert(name).second) {
+      std::stringstream errorMsg;
+      errorMsg << "Attempt to redefine variable: " << name << ".";
+      throw json_error(errorMsg.str());
+    }
+    state_ = state::ARRAY;
+    counts_.clear();
+    dims_.clear();
+    dims_known_.clear();
+    leaf_depth_ = 0;
+    only_opened_ = true;
+    is_int_ = true;
+    values_i_.clear();
+    values_r_.clear();
+  }
+
+  void promote_to_double() {
+    if (is_int_) {
+      is_int_ = false;
+      values_r_.assign(values_i_.begin(), values_i_.end());
+      values_i_.clear();
+    }
+  }
+
+  /**
+   * Called before a scalar element of an array, or the scalar value, of
+   * the current variable.
+   */
+  void start_scalar() {
+    only_opened_ = false;
+    if (depth_ == 0)
+      return;
+    if (leaf_depth_ == 0)
+      leaf_depth_ = depth_;
+    else if (depth_ != leaf_depth_)
+      error("non-rectangular array");
+    counts_[depth_ - 1]++;
+  }
+
+  /**
+   * Called after a scalar value.  The value of a variable that is a
+   * scalar ends with it.
+   */
+  void end_scalar() {
+    if (depth_ == 0)
+      save_array();
+  }
+
+  template <typename T>
+  void to_column_major(std::vector<T>& values) const {
+    std::vector<T> cm_values(values.size());
+    std::vector<size_t> idx(dims_.size(), 0);
+    std::vector<size_t> strides(dims_.size(), 1);
+    for (size_t k = 1; k < dims_.size(); ++k)
+      strides[k] = strides[k - 1] * dims_[k - 1];
+    size_t cm_offset = 0;
+    for (size_t i = 0; i < values.size(); ++i) {
+      cm_values[cm_offset] = values[i];
+      // advance the row-major index, last dimension fastest
+      for (size_t k = dims_.size(); k-- > 0;) {
+        cm_offset += strides[k];
+        if (++idx[k] < dims_[k])
+          break;
+        cm_offset -= strides[k] * dims_[k];
+        idx[k] = 0;
+      }
+    }
+    values.swap(cm_values);
+  }
+
+  void save_array() {
+    if (dims_.size() > 1) {
+      if (is_int_)
+        to_column_major(values_i_);
+      else
+        to_column_major(values_r_);
+    }
+    if (is_int_)
+      vars_i_[name_] = var_i(std::move(values_i_), std::move(dims_));
+    else
+      vars_r_[name_] = var_r(std::move(values_r_), std::move(dims_));
+    values_i_.clear();
+    values_r_.clear();
+    dims_.clear();
+    state_ = state::TOP;
+  }
+
+  /**
+   * Switch to reading the current variable as a tuple, replaying the
+   * arrays opened so far.
+   */
+  void start_tuple() {
+    if (!only_opened_)
+      error("ill-formed tuple");
+    tuple_vars_r_.clear();
+    tuple_vars_i_.clear();
+    tuple_handler_.reset(new json_data_handler(tuple_vars_r_, tuple_vars_i_));
+    tuple_handler_->start_text();
+    tuple_handler_->start_object();
+    tuple_handler_->key(name_);
+    for (size_t d = 0; d < depth_; ++d)
+      tuple_handler_->start_array();
+    state_ = state::TUPLE;
+  }
+
+  void end_tuple() {
+    tuple_handler_->end_object();
+    tuple_handler_->end_text();
+    for (auto& var : tuple_vars_r_)
+      vars_r_[var.first] = std::move(var.second);
+    for (auto& var : tuple_vars_i_)
+      vars_i_[var.first] = std::move(var.second);
+    tuple_handler_.reset();
+    state_ = state::TOP;
+  }
+
+ public:
+  /**
+   * Construct a json_data_fast_handler object.
+   *
+   * @param a_vars_r name-value map for real-valued variables
+   * @param a_vars_i name-value map for int-valued variables
+   */
+  json_data_fast_handler(vars_map_r& a_vars_r, vars_map_i& a_vars_i)
+      : json_handler(),
+        vars_r_(a_vars_r),
+        vars_i_(a_vars_i),
+        in_object_(false),
+        state_(state::TOP),
+        depth_(0),
+        leaf_depth_(0),
+        only_opened_(false),
+        is_int_(true) {}
+
+  void start_text() {
+    vars_r_.clear();
+    vars_i_.clear();
+    names_.clear();
+    in_object_ = false;
+    state_ = state::TOP;
+  }
+
+  void start_object() {
+    switch (state_) {
+      case state::TOP:
+        in_object_ = true;
+        return;
+      case state::ARRAY:
+        start_tuple();
+        tuple_handler_->start_object();
+        break;
+      case state::TUPLE:
+        tuple_handler_->start_object();
+        break;
+      case state::SKIP:
+        break;
+    }
+    ++depth_;
+  }
+
+  void end_object() {
+    if (state_ == state::TOP) {
+      in_object_ = false;
+      return;
+    }
+    --depth_;
+    if (state_ == state::TUPLE) {
+      tuple_handler_->end_object();
+      if (depth_ == 0)
+        end_tuple();
+    } else if (depth_ == 0) {
+      state_ = state::TOP;
+    }
+  }
+
+  void key(const std::string& key) {
+    switch (state_) {
+      case state::TOP:
+        start_variable(key);
+        break;
+      case state::TUPLE:
+        tuple_handler_->key(key);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void start_array() {
+    if (!in_object_)
+      throw json_error("Expecting JSON object, found array.");
+    if (state_ == state::TUPLE) {
+      tuple_handler_->start_array();
+    } else if (state_ == state::ARRAY) {
+      if (leaf_depth_ != 0 && depth_ >= leaf_depth_)
+        error("non-rectangular array");
+      if (depth_ > 0)
+        counts_[depth_ - 1]++;
+      if (counts_.size() <= depth_) {
+        counts_.push_back(0);
+        dims_.push_back(0);
+        dims_known_.push_back(false);
+      }
+      counts_[depth_] = 0;
+    }
+    ++depth_;
+  }
+
+  void end_array() {
+    --depth_;
+    if (state_ == state::TUPLE) {
+      tuple_handler_->end_array();
+      if (depth_ == 0)
+        end_tuple();
+    } else if (state_ == state::ARRAY) {
+      only_opened_ = false;
+      // an array without elements is innermost unless one was found
+      if (leaf_depth_ == 0 && counts_[depth_] == 0)
+        leaf_depth_ = depth_ + 1;
+      if (!dims_known_[depth_]) {
+        dims_[depth_] = counts_[depth_];
+        dims_known_[depth_] = true;
+      } else if (dims_[depth_] != counts_[depth_]) {
+        error("non-rectangular array");
+      }
+      if (depth_ == 0) {
+        if (leaf_depth_ != dims_.size())
+          error("non-rectangular array");
+        save_array();
+      }
+      return;
+    }
+    if (depth_ == 0 && state_ == state::SKIP)
+      state_ = state::TOP;
+  }
+
+  void null() {
+    if (state_ == state::TUPLE)
+      tuple_handler_->null();
+    else if (state_ == state::ARRAY)
+      error("null values not allowed");
+    else if (depth_ == 0)
+      state_ = state::TOP;
+  }
+
+  void boolean(bool p) {
+    if (state_ == state::TUPLE)
+      tuple_handler_->boolean(p);
+    else if (state_ == state::ARRAY)
+      error("boolean values not allowed");
+    else if (depth_ == 0)
+      state_ = state::TOP;
+  }
+
+  void string(const std::string& s) {
+    if (state_ != state::ARRAY) {
+      if (state_ == state::TUPLE)
+        tuple_handler_->string(s);
+      else if (depth_ == 0)
+        state_ = state::TOP;
+      return;
+    }
+    double tmp;
+    if (0 == s.compare("-Inf") || 0 == s.compare("-Infinity")) {
+      tmp = -std::numeric_limits<double>::infinity();
+    } else if (0 == s.compare("Inf") || 0 == s.compare("Infinity")) {
+      tmp = std::numeric_limits<double>::infinity();
+    } else if (0 == s.compare("NaN")) {
+      tmp = std::numeric_limits<double>::quiet_NaN();
+    } else {
+      error("string values not allowed");
+    }
+    number_double(tmp);
+  }
+
+  void number_double(double x) {
+    if (state_ != state::ARRAY) {
+      if (state_ == state::TUPLE)
+        tuple_handler_->number_double(x);
+      else if (depth_ == 0)
+        state_ = state::TOP;
+      return;
+    }
+    start_scalar();
+    promote_to_double();
+    values_r_.push_back(x);
+    end_scalar();
+  }
+
+  void number_int(int n) {
+    if (state_ != state::ARRAY) {
+      if (state_ == state::TUPLE)
+        tuple_handler_->number_int(n);
+      else if (depth_ == 0)
+        state_ = state::TOP;
+      return;
+    }
+    start_scalar();
+    if (is_int_)
+      values_i_.push_back(n);
+    else
+      values_r_.push_back(n);
+    end_scalar();
+  }
+
+  void number_unsigned_int(unsigned n) {
+    if (state_ != state::ARRAY) {
+      if (state_ == state::TUPLE)
+        tuple_handler_->number_unsigned_int(n);
+      else if (depth_ == 0)
+        state_ = state::TOP;
+      return;
+    }
+    start_scalar();
+    // if integer overflow, promote numeric data to double
+    if (n > (unsigned)std::numeric_limits<int>::max())
+      promote_to_double();
+    if (is_int_)
+      values_i_.push_back(static_cast<int>(n));
+    else
+      values_r_.push_back(n);
+    end_scalar();
+  }
+
+  void number_int64(int64_t n) {
+    if (state_ == state::TUPLE)
+      tuple_handler_->number_int64(n);
+    else
+      number_double(n);
+  }
+
+  void number_unsigned_int64(uint64_t n) {
+    if (state_ == state::TUPLE)
+      tuple_handler_->number_unsigned_int64(n);
+    else
+      number_double(n);
+  }
+};
+
+}  // namespace json
+
+}  // namespace stan
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef STAN_IO_JSON_JSON_PRESCAN_HPP
+#define STAN_IO_JSON_JSON_PRESCAN_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+
+namespace json {
+
+namespace internal {
+
+/**
+ * A member of the top-level JSON object: its key and the text of its
+ * value.
+ */
+struct json_member {
+  std::string key;
+  const char* value;
+  size_t size;
+};
+
+inline bool is_json_space(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/**
+ * Find the members of the top-level object of the JSON text in the
+ * specified buffer without parsing their values.  Only the structure is
+ * followed: strings are skipped and brackets are counted, so a value
+ * found is not necessarily well formed.
+ *
+ * The scan gives up on anything it does not expect, including keys with
+ * escapes or non-ASCII characters, so that the text can be parsed as a
+ * whole to report the error or decode the key.
+ *
+ * @param[in] data pointer to the first character of the text
+ * @param[in] size number of characters in the text
+ * @param[out] members members of the top-level object in order
+ * @return <code>true</code> if the text is a single object whose
+ * members were all found
+ */
+inline bool prescan_members(const char* data, size_t size,
+                            std::vector<json_member>& members) {
+  members.clear();
+  const char* p = data;
+  const char* end = data + size;
+  auto skip_space = [&]() {
+    while (p != end && is_json_space(*p))
+      ++p;
+  };
+  skip_space();
+  if (p == end || *p != '{')
+    return false;
+  ++p;
+  skip_space();
+  if (p != end && *p == '}') {
+    ++p;
+  } else {
+    while (true) {
+      skip_space();
+      if (p == end || *p != '"')
+        return false;
+      const char* key_begin = ++p;
+      while (p != end && *p != '"') {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '\\' || c < 0x20 || c >= 0x80)
+          return false;
+        ++p;
+      }
+      if (p == end)
+        return false;
+      json_member member;
+      member.key.assign(key_begin, p);
+      ++p;
+      skip_space();
+      if (p == end || *p != ':')
+        return false;
+      ++p;
+      skip_space();
+      member.value = p;
+      // the value ends at the first comma or closing brace outside of
+      // strings and brackets
+      size_t depth = 0;
+      while (p != end) {
+        const char c = *p;
+        if (c == '"') {
+          for (++p; p != end && *p != '"'; ++p)
+            if (*p == '\\' && ++p == end)
+              return false;
+          if (p == end)
+            return false;
+        } else if (c == '[' || c == '{') {
+          ++depth;
+        } else if (c == ']' || c == '}') {
+          if (depth == 0) {
+            if (c == ']')
+              return false;
+            break;
+          }
+          --depth;
+        } else if (c == ',' && depth == 0) {
+          break;
+        }
+        ++p;
+      }
+      if (p == end)
+        return false;
+      const char* value_end = p;
+      while (value_end != member.value && is_json_space(value_end[-1]))
+        --value_end;
+      member.size = value_end - member.value;
+      if (member.size == 0)
+        return false;
+      members.push_back(std::move(member));
+      if (*p++ == '}')
+        break;
+    }
+  }
+  skip_space();
+  return p == end;
+}
+
+}  // namespace internal
+
+}  // namespace json
+
+}  // namespace stan
+
+#endif
@@ -6,6 +6,7 @@
 #include <rapidjson/encodings.h>
 #include <rapidjson/error/en.h>
 #include <rapidjson/istreamwrapper.h>
+#include <rapidjson/memorystream.h>
 #include <rapidjson/reader.h>
 
 #include <cerrno>
@@ -99,23 +100,15 @@ struct RapidJSONHandler {
   std::string last_key_;
 };
 
-/**
- * Parse the JSON text represented by the specified input stream,
- * sending events to the specified handler.
- *
- * @tparam Handler
- * @param in Input stream from which to parse
- * @param handler Handler for events from parser
- */
-template <typename Handler>
-void rapidjson_parse(std::istream &in, Handler &handler) {
+namespace internal {
+template <typename Handler, typename Stream>
+void rapidjson_parse_stream(Stream &stream, Handler &handler) {
   rapidjson::Reader reader;
   RapidJSONHandler<Handler> filter(handler);
-  rapidjson::IStreamWrapper isw(in);
   handler.start_text();
   if (!reader.Parse<rapidjson::kParseNanAndInfFlag
                     | rapidjson::kParseValidateEncodingFlag
-                    | rapidjson::kParseFullPrecisionFlag>(isw, filter)) {
+                    | rapidjson::kParseFullPrecisionFlag>(stream, filter)) {
     rapidjson::ParseErrorCode err = reader.GetParseErrorCode();
     std::stringstream ss;
     ss << "Error in JSON parsing " << std::endl
@@ -129,6 +122,56 @@ void rapidjson_parse(std::istream &in, Handler &handler) {
   }
   handler.end_text();
 }
+
+/**
+ * Parse the single JSON value in the specified buffer, which may be a
+ * scalar, sending its events to the specified handler without starting
+ * or ending a text.
+ *
+ * @throw json_error if the buffer is not a single JSON value
+ */
+template <typename Handler>
+void rapidjson_parse_value(const char *data, size_t size, Handler &handler) {
+  rapidjson::Reader reader;
+  RapidJSONHandler<Handler> filter(handler);
+  filter.state_ = ParsingState::Started;
+  rapidjson::MemoryStream ms(data, size);
+  if (!reader.Parse<rapidjson::kParseNanAndInfFlag
+                    | rapidjson::kParseValidateEncodingFlag
+                    | rapidjson::kParseFullPrecisionFlag>(ms, filter)) {
+    throw json_error(rapidjson::GetParseError_En(reader.GetParseErrorCode()));
+  }
+}
+}  // namespace internal
+
+/**
+ * Parse the JSON text represented by the specified input stream,
+ * sending events to the specified handler.
+ *
+ * @tparam Handler
+ * @param in Input stream from which to parse
+ * @param handler Handler for events from parser
+ */
+template <typename Handler>
+void rapidjson_parse(std::istream &in, Handler &handler) {
+  rapidjson::IStreamWrapper isw(in);
+  internal::rapidjson_parse_stream(isw, handler);
+}
+
+/**
+ * Parse the JSON text in the specified buffer, sending events to the
+ * specified handler.  The buffer does not need to be null terminated.
+ *
+ * @tparam Handler
+ * @param data Pointer to the first character of the text
+ * @param size Number of characters in the text
+ * @param handler Handler for events from parser
+ */
+template <typename Handler>
+void rapidjson_parse(const char *data, size_t size, Handler &handler) {
+  rapidjson::MemoryStream ms(data, size);
+  internal::rapidjson_parse_stream(ms, handler);
+}
 }  // namespace json
 }  // namespace stan
 #endif
@@ -0,0 +1,219 @@
+#ifndef STAN_IO_MULTI_CHAIN_READER_HPP
+#define STAN_IO_MULTI_CHAIN_READER_HPP
+
+#include <stan/callbacks/multi_chain_writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * Reads the file of the draws of several chains written by
+ * <code>callbacks::multi_chain_writer</code>, by memory mapping it.
+ *
+ * The index footer is read on construction.  The draws of any chain, and
+ * of any range of its columns, are then read straight from the blocks of
+ * the chain, so reading a few parameters only touches their columns.
+ */
+class multi_chain_reader {
+ public:
+  /**
+   * Map the file and read its index.
+   *
+   * @param[in] filename name of the file
+   * @throw std::invalid_argument if the file is not one written by a
+   *   <code>multi_chain_writer</code>, or was not closed
+   */
+  explicit multi_chain_reader(const std::string& filename) {
+    namespace bip = boost::interprocess;
+    if (std::ifstream(filename, std::ios::binary | std::ios::ate).tellg()
+        < static_cast<std::streamoff>(callbacks::multi_chain_writer::ALIGNMENT
+                                      + 16))
+      invalid(filename);
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    region_ = bip::mapped_region(file, bip::read_only);
+    begin_ = static_cast<const char*>(region_.get_address());
+    size_ = region_.get_size();
+    if (std::memcmp(begin_, callbacks::multi_chain_writer::MAGIC, 8) != 0
+        || std::memcmp(begin_ + size_ - 8,
+                       callbacks::multi_chain_writer::END_MAGIC, 8)
+               != 0)
+      invalid(filename);
+
+    std::uint64_t pos = read_size(size_ - 16);
+    block_rows_ = read_size(pos);
+    pos += 8;
+    names_.resize(read_size(pos));
+    pos += 8;
+    for (std::string& name : names_)
+      name = read_string(pos);
+    chains_.resize(read_size(pos));
+    pos += 8;
+    for (chain& c : chains_) {
+      c.chain_id = read_size(pos);
+      c.num_draws = read_size(pos + 8);
+      c.offsets.resize(read_size(pos + 16));
+      pos += 24;
+      for (std::uint64_t& offset : c.offsets) {
+        offset = read_size(pos);
+        pos += 8;
+      }
+      c.comments.resize(read_size(pos));
+      pos += 8;
+      for (std::string& comment : c.comments)
+        comment = read_string(pos);
+    }
+    for (const chain& c : chains_)
+      for (std::uint64_t offset : c.offsets)
+        if (offset + block_bytes() > size_)
+          invalid(filename);
+  }
+
+  /**
+   * Return the names of the columns.
+   */
+  const std::vector<std::string>& header() const noexcept { return names_; }
+
+  /**
+   * Return the ids of the chains, in the order their writers were made.
+   */
+  std::vector<std::size_t> chain_ids() const {
+    std::vector<std::size_t> ids;
+    for (const chain& c : chains_)
+      ids.push_back(c.chain_id);
+    return ids;
+  }
+
+  /**
+   * Return the number of draws of a chain.
+   *
+   * @throw std::invalid_argument if there is no chain of the id
+   */
+  std::size_t num_draws(std::size_t chain_id) const {
+    return find(chain_id).num_draws;
+  }
+
+  /**
+   * Return the comments of a chain, in order.
+   *
+   * @throw std::invalid_argument if there is no chain of the id
+   */
+  const std::vector<std::string>& comments(std::size_t chain_id) const {
+    return find(chain_id).comments;
+  }
+
+  /**
+   * Return the draws of a chain, one per row, of a range of the columns.
+   *
+   * @param[in] chain_id id of the chain
+   * @param[in] first_col first column read
+   * @param[in] num_cols number of columns read, all of the rest if larger
+   * @throw std::invalid_argument if there is no chain of the id
+   */
+  Eigen::MatrixXd read(std::size_t chain_id, std::size_t first_col = 0,
+                       std::size_t num_cols = -1) const {
+    const chain& c = find(chain_id);
+    first_col = std::min(first_col, names_.size());
+    num_cols = std::min(num_cols, names_.size() - first_col);
+    Eigen::MatrixXd draws(c.num_draws, num_cols);
+    Eigen::Index row = 0;
+    for (std::uint64_t offset : c.offsets) {
+      const std::uint64_t rows = read_size(offset + 8);
+      const char* values = begin_ + offset
+                           + callbacks::multi_chain_writer::ALIGNMENT;
+      for (std::size_t j = 0; j < num_cols; ++j) {
+        const char* column
+            = values + (first_col + j) * block_rows_ * sizeof(double);
+        std::memcpy(&draws(row, j), column, rows * sizeof(double));
+      }
+      row += rows;
+    }
+    return draws;
+  }
+
+  /**
+   * Return the draws of a chain, one per row, of the named columns.
+   *
+   * @throw std::invalid_argument if there is no chain of the id or no
+   *   column of one of the names
+   */
+  Eigen::MatrixXd read(std::size_t chain_id,
+                       const std::vector<std::string>& columns) const {
+    Eigen::MatrixXd draws(num_draws(chain_id), columns.size());
+    for (std::size_t j = 0; j < columns.size(); ++j) {
+      auto column = std::find(names_.begin(), names_.end(), columns[j]);
+      if (column == names_.end())
+        throw std::invalid_argument("Error: no column " + columns[j]
+                                    + " in multi-chain file");
+      draws.col(j) = read(chain_id, column - names_.begin(), 1);
+    }
+    return draws;
+  }
+
+ private:
+  struct chain {
+    std::size_t chain_id = 0;
+    std::size_t num_draws = 0;
+    std::vector<std::uint64_t> offsets;
+    std::vector<std::string> comments;
+  };
+
+  boost::interprocess::mapped_region region_;
+  const char* begin_ = nullptr;
+  std::uint64_t size_ = 0;
+  std::uint64_t block_rows_ = 0;
+  std::vector<std::string> names_;
+  std::vector<chain> chains_;
+
+  [[noreturn]] static void invalid(const std::string& filename) {
+    throw std::invalid_argument("Error: " + filename
+                                + " is not a closed multi-chain file");
+  }
+
+  std::uint64_t block_bytes() const {
+    const std::uint64_t alignment = callbacks::multi_chain_writer::ALIGNMENT;
+    const std::uint64_t bytes
+        = alignment + block_rows_ * names_.size() * sizeof(double);
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+
+  std::uint64_t read_size(std::uint64_t pos) const {
+    if (pos + 8 > size_)
+      throw std::invalid_argument("Error: truncated multi-chain file");
+    std::uint64_t n;
+    std::memcpy(&n, begin_ + pos, sizeof(n));
+    return n;
+  }
+
+  std::string read_string(std::uint64_t& pos) const {
+    const std::uint64_t length = read_size(pos);
+    pos += 8;
+    if (pos + length > size_)
+      throw std::invalid_argument("Error: truncated multi-chain file");
+    std::string s(begin_ + pos, length);
+    pos += length;
+    return s;
+  }
+
+  const chain& find(std::size_t chain_id) const {
+    for (const chain& c : chains_)
+      if (c.chain_id == chain_id)
+        return c;
+    throw std::invalid_argument("Error: no chain "
+                                + std::to_string(chain_id)
+                                + " in multi-chain file");
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
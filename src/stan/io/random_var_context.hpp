@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace stan {
@@ -23,7 +24,8 @@ class random_var_context : public var_context {
    *
    * On construction, this var_context will generate random
    * numbers on the unconstrained scale for the model provided.
-   * Once generated, the class is immutable.
+   * The values only change when they are drawn again with
+   * <code>redraw</code>.
    *
    * This class only generates values for the parameters in the
    * Stan program and does not generate values for transformed parameters
@@ -41,27 +43,33 @@ class random_var_context : public var_context {
    */
   template <class Model, class RNG>
   random_var_context(Model& model, RNG& rng, double init_radius, bool init_zero)
-      : unconstrained_params_(model.num_params_r()) {
-    size_t num_unconstrained_ = model.num_params_r();
+      : init_radius_(init_radius),
+        init_zero_(init_zero),
+        unconstrained_params_(model.num_params_r()) {
     model.get_param_names(names_, false, false);
     model.get_dims(dims_, false, false);
-
-    if (init_zero) {
-      for (size_t n = 0; n < num_unconstrained_; ++n)
-        unconstrained_params_[n] = 0.0;
-    } else {
-      boost::random::uniform_real_distribution<double> unif(-init_radius,
-                                                            init_radius);
-      for (size_t n = 0; n < num_unconstrained_; ++n)
-        unconstrained_params_[n] = unif(rng);
+    offsets_.reserve(names_.size() + 1);
+    offsets_.push_back(0);
+    for (size_t i = 0; i < names_.size(); ++i) {
+      index_[names_[i]] = i;
+      offsets_.push_back(offsets_.back() + dim_size(dims_[i]));
     }
+    draw(model, rng);
+  }
 
-    std::vector<double> constrained_params;
-    std::vector<int> int_params;
-    model.write_array(rng, unconstrained_params_, int_params,
-                      constrained_params, false, false, 0);
-
-    vals_r_ = constrained_to_vals_r(constrained_params, dims_);
+  /**
+   * Draw new random values in place, reusing the names, dimensions and
+   * storage of this var_context.  The values are drawn the same way as on
+   * construction.  Views returned before are invalidated.
+   *
+   * @tparam Model Model class
+   * @tparam RNG Random number generator type
+   * @param[in] model the model this var_context was constructed for
+   * @param[in,out] rng pseudo-random number generator
+   */
+  template <class Model, class RNG>
+  void redraw(Model& model, RNG& rng) {
+    draw(model, rng);
   }
 
   /**
@@ -79,7 +87,7 @@ class random_var_context : public var_context {
    * model.
    */
   bool contains_r(const std::string& name) const {
-    return std::find(names_.begin(), names_.end(), name) != names_.end();
+    return index_.find(name) != index_.end();
   }
 
   /**
@@ -91,20 +99,31 @@ class random_var_context : public var_context {
    *   var_context; an empty vector is returned otherwise
    */
   std::vector<double> vals_r(const std::string& name) const {
-    std::vector<std::string>::const_iterator loc
-        = std::find(names_.begin(), names_.end(), name);
-    if (loc == names_.end())
-      return std::vector<double>();
-    return vals_r_[loc - names_.begin()];
+    return view_r(name).to_vector();
+  }
+
+  /**
+   * Returns a view of the values of the constrained variables, which
+   * is valid until the values are drawn again.
+   *
+   * @param name Name of variable.
+   * @return view of the constrained values if the variable is in the
+   *   var_context; an empty view is returned otherwise
+   */
+  values_view<double> view_r(const std::string& name) const {
+    auto loc = index_.find(name);
+    if (loc == index_.end())
+      return values_view<double>();
+    return values_view<double>(
+        constrained_params_.data() + offsets_[loc->second],
+        offsets_[loc->second + 1] - offsets_[loc->second]);
   }
 
   std::vector<std::complex<double>> vals_c(const std::string& name) const {
-    std::vector<std::string>::const_iterator loc
-        = std::find(names_.begin(), names_.end(), name);
-    if (loc == names_.end()) {
+    if (!contains_r(name)) {
       return std::vector<std::complex<double>>();
     } else {
-      const auto& val_r = vals_r_[loc - names_.begin()];
+      values_view<double> val_r = view_r(name);
       std::vector<std::complex<double>> ret_c(val_r.size() / 2);
       int comp_iter;
       int real_iter;
@@ -125,11 +144,10 @@ class random_var_context : public var_context {
    *   is returned otherwise
    */
   std::vector<size_t> dims_r(const std::string& name) const {
-    std::vector<std::string>::const_iterator loc
-        = std::find(names_.begin(), names_.end(), name);
-    if (loc == names_.end())
+    auto loc = index_.find(name);
+    if (loc == index_.end())
       return std::vector<size_t>();
-    return dims_[loc - names_.begin()];
+    return dims_[loc->second];
   }
 
   /**
@@ -208,14 +226,31 @@ class random_var_context : public var_context {
   }
 
  private:
+  /**
+   * Radius of the uniform draws on the unconstrained scale
+   */
+  double init_radius_;
+  /**
+   * Whether the unconstrained values are all zero
+   */
+  bool init_zero_;
   /**
    * Parameter names in the model
    */
   std::vector<std::string> names_;
+  /**
+   * Position of each parameter name in names_
+   */
+  std::unordered_map<std::string, size_t> index_;
   /**
    * Dimensions of parameters in the model
    */
   std::vector<std::vector<size_t>> dims_;
+  /**
+   * Offset of the values of each parameter in the constrained values,
+   * followed by the number of constrained values
+   */
+  std::vector<size_t> offsets_;
   /**
    * Random parameter values of the model in the
    * unconstrained space
@@ -223,9 +258,9 @@ class random_var_context : public var_context {
   std::vector<double> unconstrained_params_;
   /**
    * Random parameter values of the model in the
-   * constrained space
+   * constrained space, one parameter after the other
    */
-  std::vector<std::vector<double>> vals_r_;
+  std::vector<double> constrained_params_;
 
   /**
    * Computes the size of a variable based on the dim provided.
@@ -241,26 +276,30 @@ class random_var_context : public var_context {
   }
 
   /**
-   * Returns a vector of constrained values in the format expected
-   * out of the vals_r() function.
+   * Draw the unconstrained values and compute the constrained values
+   * from them.
    *
-   * @param[in] constrained constrained parameter values
-   * @param[in] dims dimensions of each of the parameter values
-   * @return constrained values reshaped to be returned in the vals_r
-   *   function
+   * @tparam Model Model class
+   * @tparam RNG Random number generator type
+   * @param[in] model instantiated model to generate variables for
+   * @param[in,out] rng pseudo-random number generator
    */
-  std::vector<std::vector<double>> constrained_to_vals_r(
-      const std::vector<double>& constrained,
-      const std::vector<std::vector<size_t>>& dims) {
-    std::vector<std::vector<double>> vals_r(dims.size());
-
-    std::vector<double>::const_iterator start = constrained.begin();
-    for (size_t i = 0; i < dims.size(); ++i) {
-      size_t size = dim_size(dims[i]);
-      vals_r[i] = std::vector<double>(start, start + size);
-      start += size;
+  template <class Model, class RNG>
+  void draw(Model& model, RNG& rng) {
+    if (init_zero_) {
+      std::fill(unconstrained_params_.begin(), unconstrained_params_.end(),
+                0.0);
+    } else {
+      boost::random::uniform_real_distribution<double> unif(-init_radius_,
+                                                            init_radius_);
+      for (size_t n = 0; n < unconstrained_params_.size(); ++n)
+        unconstrained_params_[n] = unif(rng);
     }
-    return vals_r;
+
+    std::vector<int> int_params;
+    model.write_array(rng, unconstrained_params_, int_params,
+                      constrained_params_, false, false, 0);
+    constrained_params_.resize(offsets_.back());
   }
 };
 
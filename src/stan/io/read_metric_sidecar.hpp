@@ -0,0 +1,205 @@
+#ifndef STAN_IO_READ_METRIC_SIDECAR_HPP
+#define STAN_IO_READ_METRIC_SIDECAR_HPP
+
+#include <stan/io/binary_var_context.hpp>
+#include <stan/io/json/json_handler.hpp>
+#include <stan/io/json/rapidjson_parser.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+namespace internal {
+
+/**
+ * Handler of the events of the JSON text of a metric writer, keeping the
+ * top-level <code>stepsize</code> and the values of the top-level
+ * <code>inv_metric</code>, either a list for a diagonal metric or a list
+ * of rows for a dense one, and ignoring every other member.
+ */
+class metric_sidecar_handler : public stan::json::json_handler {
+ public:
+  double step_size = std::numeric_limits<double>::quiet_NaN();
+  bool has_metric = false;
+  std::vector<double> values;
+  std::size_t rows = 0;
+  std::size_t cols = 0;
+  bool ragged = false;
+
+  void start_object() { ++depth_; }
+  void end_object() { --depth_; }
+
+  void start_array() {
+    ++depth_;
+    if (depth_ == 2 && key_ == "inv_metric") {
+      has_metric = true;
+      in_metric_ = true;
+    } else if (in_metric_ && depth_ == 3) {
+      row_begin_ = values.size();
+    }
+  }
+
+  void end_array() {
+    if (in_metric_ && depth_ == 3) {
+      const std::size_t row_size = values.size() - row_begin_;
+      if (rows == 0) {
+        cols = row_size;
+        values.reserve(cols * cols);
+      } else if (row_size != cols) {
+        ragged = true;
+      }
+      ++rows;
+    } else if (in_metric_ && depth_ == 2) {
+      in_metric_ = false;
+    }
+    --depth_;
+  }
+
+  void key(const std::string& s) {
+    if (depth_ == 1)
+      key_ = s;
+  }
+
+  void number_double(double x) { value(x); }
+  void number_int(int n) { value(n); }
+  void number_unsigned_int(unsigned n) { value(n); }
+  void number_int64(int64_t n) { value(n); }
+  void number_unsigned_int64(uint64_t n) { value(n); }
+
+  void string(const std::string& s) {
+    if (!in_metric_)
+      return;
+    if (s == "NaN")
+      value(std::numeric_limits<double>::quiet_NaN());
+    else if (s == "Inf" || s == "Infinity")
+      value(std::numeric_limits<double>::infinity());
+    else if (s == "-Inf" || s == "-Infinity")
+      value(-std::numeric_limits<double>::infinity());
+    else
+      ragged = true;
+  }
+
+ private:
+  int depth_ = 0;
+  std::string key_;
+  bool in_metric_ = false;
+  std::size_t row_begin_ = 0;
+
+  void value(double x) {
+    if (in_metric_)
+      values.push_back(x);
+    else if (depth_ == 1 && key_ == "stepsize")
+      step_size = x;
+  }
+};
+
+inline void read_metric_sidecar_binary(const std::string& filename,
+                                       stan_csv_adaptation& adaptation) {
+  binary_var_context context(filename);
+  if (!context.contains_r("stepsize") || !context.contains_r("inv_metric"))
+    throw std::invalid_argument("Metric file " + filename
+                                + " has no stepsize or inv_metric");
+  adaptation.step_size = context.vals_r("stepsize").at(0);
+  const std::vector<size_t> dims = context.dims_r("inv_metric");
+  const values_view<double> metric = context.view_r("inv_metric");
+  if (dims.size() == 1) {
+    adaptation.metric = Eigen::Map<const Eigen::RowVectorXd>(
+        metric.data(), metric.size());
+  } else if (dims.size() == 2) {
+    adaptation.metric
+        = Eigen::Map<const Eigen::MatrixXd>(metric.data(), dims[0], dims[1]);
+  } else {
+    throw std::invalid_argument("Metric file " + filename
+                                + " has an inv_metric that is not a vector"
+                                  " or a matrix");
+  }
+}
+
+inline void read_metric_sidecar_json(const char* data, std::size_t size,
+                                     const std::string& filename,
+                                     stan_csv_adaptation& adaptation) {
+  metric_sidecar_handler handler;
+  stan::json::rapidjson_parse(data, size, handler);
+  if (std::isnan(handler.step_size) || !handler.has_metric)
+    throw std::invalid_argument("Metric file " + filename
+                                + " has no stepsize or inv_metric");
+  if (handler.ragged
+      || (handler.rows > 0
+          && handler.values.size() != handler.rows * handler.cols))
+    throw std::invalid_argument("Metric file " + filename
+                                + " has an inv_metric with rows of different"
+                                  " sizes");
+  adaptation.step_size = handler.step_size;
+  if (handler.rows == 0) {
+    adaptation.metric = Eigen::Map<const Eigen::RowVectorXd>(
+        handler.values.data(), handler.values.size());
+  } else {
+    adaptation.metric = Eigen::Map<const Eigen::Matrix<
+        double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(
+        handler.values.data(), handler.rows, handler.cols);
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Read the adapted step size and inverse metric of a sampler from the
+ * file written for them by a metric writer, instead of from the
+ * adaptation comments of its csv output as
+ * <code>stan_csv_reader::read_adaptation</code> does.
+ *
+ * The file is either the JSON text <code>write_sampler_state_struct</code>
+ * writes through a <code>callbacks::json_writer</code>, with members
+ * <code>stepsize</code> and <code>inv_metric</code>, or a file in the
+ * binary data format of <code>binary_var_context</code> with variables
+ * of the same names, which is told apart by its magic string.  The file
+ * is memory mapped and its values are parsed straight into a buffer, so
+ * a large dense metric is read much faster than from the comments.
+ *
+ * As from the comments, a diagonal inverse metric is read as a single
+ * row and a dense one as a square matrix.
+ *
+ * @param[in] filename name of the file
+ * @param[out] adaptation step size and inverse metric
+ * @throw std::invalid_argument if the file can not be opened, lacks the
+ *   step size or the inverse metric, or its inverse metric is not a
+ *   vector or a matrix
+ * @throw stan::json::json_error if a JSON file is not well formed
+ */
+inline void read_metric_sidecar(const std::string& filename,
+                                stan_csv_adaptation& adaptation) {
+  std::ifstream in(filename, std::ios::binary | std::ios::ate);
+  if (!in)
+    throw std::invalid_argument("Error: can not open file " + filename);
+  const std::streamoff size = in.tellg();
+  if (size <= 0)
+    throw std::invalid_argument("Metric file " + filename + " is empty");
+  char magic[8] = {0};
+  in.seekg(0);
+  in.read(magic, sizeof(magic));
+  in.close();
+  if (size >= 8
+      && std::memcmp(magic, binary_var_context::MAGIC, sizeof(magic)) == 0) {
+    internal::read_metric_sidecar_binary(filename, adaptation);
+    return;
+  }
+  namespace bip = boost::interprocess;
+  bip::file_mapping file(filename.c_str(), bip::read_only);
+  bip::mapped_region region(file, bip::read_only);
+  internal::read_metric_sidecar_json(
+      static_cast<const char*>(region.get_address()), region.get_size(),
+      filename, adaptation);
+}
+
+}  // namespace io
+}  // namespace stan
+#endif
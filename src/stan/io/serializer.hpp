@@ -1,6 +1,7 @@
 #ifndef STAN_IO_SERIALIZER_HPP
 #define STAN_IO_SERIALIZER_HPP
 
+#include <stan/io/is_fixed_size_eigen.hpp>
 #include <stan/math/rev.hpp>
 
 namespace stan {
@@ -47,6 +48,9 @@ class serializer {
   using is_arithmetic_or_ad
       = bool_constant<std::is_arithmetic<S>::value || is_autodiff<S>::value>;
 
+  template <typename S>
+  using is_fixed = internal::is_fixed_size_eigen<S>;
+
  public:
   using matrix_t = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
   using vector_t = Eigen::Matrix<T, Eigen::Dynamic, 1>;
@@ -113,7 +117,8 @@ class serializer {
    * @param vec The Eigen column vector
    */
   template <typename Vec, require_eigen_col_vector_t<Vec>* = nullptr,
-            require_not_vt_complex<Vec>* = nullptr>
+            require_not_vt_complex<Vec>* = nullptr,
+            require_not_t<is_fixed<Vec>>* = nullptr>
   inline void write(Vec&& vec) {
     check_r_capacity(vec.size());
     map_vector_t(&map_r_.coeffRef(pos_r_), vec.size()) = vec;
@@ -144,7 +149,8 @@ class serializer {
    * @param vec The Eigen row vector
    */
   template <typename Vec, require_eigen_row_vector_t<Vec>* = nullptr,
-            require_not_vt_complex<Vec>* = nullptr>
+            require_not_vt_complex<Vec>* = nullptr,
+            require_not_t<is_fixed<Vec>>* = nullptr>
   inline void write(Vec&& vec) {
     check_r_capacity(vec.size());
     map_row_vector_t(&map_r_.coeffRef(pos_r_), vec.size()) = vec;
@@ -175,13 +181,34 @@ class serializer {
    * @param mat An Eigen object
    */
   template <typename Mat, require_eigen_matrix_dynamic_t<Mat>* = nullptr,
-            require_not_vt_complex<Mat>* = nullptr>
+            require_not_vt_complex<Mat>* = nullptr,
+            require_not_t<is_fixed<Mat>>* = nullptr>
   inline void write(Mat&& mat) {
     check_r_capacity(mat.size());
     map_matrix_t(&map_r_.coeffRef(pos_r_), mat.rows(), mat.cols()) = mat;
     pos_r_ += mat.size();
   }
 
+  /**
+   * Write an Eigen vector or matrix with sizes fixed at compile time to
+   * storage through a fixed-size map, so that the copy is unrolled.
+   * @tparam Mat An Eigen type with fixed rows and columns
+   * @param mat An Eigen object
+   */
+  template <typename Mat, require_t<is_fixed<Mat>>* = nullptr,
+            require_not_vt_complex<Mat>* = nullptr>
+  inline void write(Mat&& mat) {
+    using fixed_t = Eigen::Matrix<T, std::decay_t<Mat>::RowsAtCompileTime,
+                                  std::decay_t<Mat>::ColsAtCompileTime>;
+    constexpr Eigen::Index size = fixed_t::SizeAtCompileTime;
+    if (size == 0) {
+      return;
+    }
+    check_r_capacity(size);
+    Eigen::Map<fixed_t>(&map_r_.coeffRef(pos_r_)) = mat;
+    pos_r_ += size;
+  }
+
   /**
    * Write a Eigen matrix of size `(rows, cols)` with complex inner type to
    * storage
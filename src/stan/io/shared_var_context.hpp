@@ -0,0 +1,162 @@
+#ifndef STAN_IO_SHARED_VAR_CONTEXT_HPP
+#define STAN_IO_SHARED_VAR_CONTEXT_HPP
+
+#include <stan/io/binary_var_context.hpp>
+#include <stan/io/var_context.hpp>
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/exceptions.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <boost/interprocess/sync/named_mutex.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+namespace stan {
+namespace io {
+
+/**
+ * A var_context over data held in a named shared memory segment, so that
+ * every process on a host that reads the same data maps a single copy of
+ * it instead of parsing and holding its own.
+ *
+ * The segment holds the variables in the binary data format of
+ * <code>binary_var_context</code> and is mapped read-only.  It is made by
+ * the first process to construct a shared_var_context with a loader for
+ * the data; the others find it and never call their loader.  Creation is
+ * serialized with a named mutex, so processes started together agree on
+ * a single segment.
+ *
+ * Segments outlive the processes that use them, until they are removed
+ * with <code>remove</code> or the host restarts.  A process that dies
+ * while creating a segment leaves it and its mutex behind, and they must
+ * then be removed before the name is used again.
+ */
+class shared_var_context : public binary_var_context {
+ public:
+  /**
+   * Map the shared memory segment with the specified name, first making
+   * it from the data returned by the loader if it does not exist.
+   *
+   * @tparam F type of the loader
+   * @param name name of the segment, which must be a valid name for a
+   * shared memory object, typically without slashes
+   * @param load callable without arguments returning the var_context
+   * whose variables are written to the segment, called only if the
+   * segment is made by this call
+   * @throw std::invalid_argument if the segment is not in the binary data
+   * format
+   */
+  template <typename F>
+  shared_var_context(const std::string& name, F&& load)
+      : binary_var_context(open_or_create(name, load)) {}
+
+  /**
+   * Map the existing shared memory segment with the specified name.
+   *
+   * @param name name of the segment
+   * @throw std::invalid_argument if there is no segment with that name or
+   * it is not in the binary data format
+   */
+  explicit shared_var_context(const std::string& name)
+      : binary_var_context(open(name)) {}
+
+  /**
+   * Remove the shared memory segment with the specified name and its
+   * mutex.  Processes that have mapped it keep their mapping.
+   *
+   * @param name name of the segment
+   * @return <code>true</code> if the segment was removed
+   */
+  static bool remove(const std::string& name) {
+    boost::interprocess::named_mutex::remove(mutex_name(name).c_str());
+    return boost::interprocess::shared_memory_object::remove(name.c_str());
+  }
+
+ private:
+  static std::string mutex_name(const std::string& name) {
+    return name + "_mutex";
+  }
+
+  static boost::interprocess::mapped_region open(const std::string& name) {
+    namespace bip = boost::interprocess;
+    try {
+      bip::shared_memory_object shm(bip::open_only, name.c_str(),
+                                    bip::read_only);
+      return bip::mapped_region(shm, bip::read_only);
+    } catch (const bip::interprocess_exception& e) {
+      throw std::invalid_argument("Error: can not open shared data " + name
+                                  + ": " + e.what());
+    }
+  }
+
+  template <typename F>
+  static boost::interprocess::mapped_region open_or_create(
+      const std::string& name, F& load) {
+    namespace bip = boost::interprocess;
+    bip::named_mutex mutex(bip::open_or_create, mutex_name(name).c_str());
+    bip::scoped_lock<bip::named_mutex> lock(mutex);
+    try {
+      bip::shared_memory_object shm(bip::open_only, name.c_str(),
+                                    bip::read_only);
+      return bip::mapped_region(shm, bip::read_only);
+    } catch (const bip::interprocess_exception&) {
+      // not made yet
+    }
+    const var_context& context = load();
+    const std::uint64_t size = written_size(context);
+    bip::shared_memory_object shm(bip::create_only, name.c_str(),
+                                  bip::read_write);
+    try {
+      shm.truncate(size);
+      bip::mapped_region region(shm, bip::read_write);
+      bip::obufferstream out(static_cast<char*>(region.get_address()),
+                             region.get_size());
+      write(out, context);
+      if (!out)
+        throw std::runtime_error("Error: can not write shared data " + name);
+    } catch (...) {
+      bip::shared_memory_object::remove(name.c_str());
+      throw;
+    }
+    bip::shared_memory_object shm_read(bip::open_only, name.c_str(),
+                                       bip::read_only);
+    return bip::mapped_region(shm_read, bip::read_only);
+  }
+};
+
+/**
+ * Construct a model from data in the named shared memory segment, making
+ * the segment from the data returned by the loader if it does not exist.
+ *
+ * Concurrent processes running chains on the same data then parse it
+ * once per host.  The segment is only needed while the model is
+ * constructed.
+ *
+ * @tparam Model type of the model, constructed from a var_context, a
+ * seed and a message stream
+ * @tparam F type of the loader
+ * @param name name of the segment
+ * @param load callable without arguments returning the data as a
+ * var_context, only called by the process that makes the segment
+ * @param seed seed for the random number generator of the model
+ * @param msgs stream for messages from the model constructor
+ * @return model constructed from the shared data
+ */
+template <typename Model, typename F>
+std::unique_ptr<Model> make_model_from_shared_data(const std::string& name,
+                                                   F&& load,
+                                                   unsigned int seed,
+                                                   std::ostream* msgs) {
+  shared_var_context context(name, load);
+  return std::unique_ptr<Model>(new Model(context, seed, msgs));
+}
+
+}  // namespace io
+}  // namespace stan
+
+#endif
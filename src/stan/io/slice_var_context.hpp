@@ -0,0 +1,216 @@
+#ifndef STAN_IO_SLICE_VAR_CONTEXT_HPP
+#define STAN_IO_SLICE_VAR_CONTEXT_HPP
+
+#include <stan/io/var_context.hpp>
+#include <stan/io/validate_dims.hpp>
+#include <algorithm>
+#include <complex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A slice_var_context presents a minibatch of the rows of some of the
+ * variables of another var_context, leaving the other variables as they
+ * are.
+ *
+ * The rows are the leading index of each sliced variable.  The minibatch
+ * is the `batch_size` rows starting at row `offset`, wrapping around to
+ * the first row, so a rotating sequence of minibatches is made by
+ * advancing the offset by the batch size.  The integer variables given as
+ * size variables, typically the number of rows a model declares its data
+ * with, are presented as the batch size.
+ *
+ * The underlying var_context must outlive this object.
+ */
+class slice_var_context : public var_context {
+ private:
+  const var_context& context_;
+  std::vector<std::string> sliced_names_;
+  std::vector<std::string> size_names_;
+  size_t num_rows_;
+  size_t offset_;
+  size_t batch_size_;
+
+  bool is_sliced(const std::string& name) const {
+    return std::find(sliced_names_.begin(), sliced_names_.end(), name)
+           != sliced_names_.end();
+  }
+
+  bool is_size(const std::string& name) const {
+    return std::find(size_names_.begin(), size_names_.end(), name)
+           != size_names_.end();
+  }
+
+  template <typename T>
+  std::vector<T> slice(const std::vector<T>& vals) const {
+    const size_t num_blocks = vals.size() / num_rows_;
+    std::vector<T> sliced;
+    sliced.reserve(num_blocks * batch_size_);
+    for (size_t block = 0; block < num_blocks; ++block) {
+      for (size_t i = 0; i < batch_size_; ++i) {
+        sliced.push_back(vals[block * num_rows_ + (offset_ + i) % num_rows_]);
+      }
+    }
+    return sliced;
+  }
+
+  std::vector<size_t> sliced_dims(std::vector<size_t> dims) const {
+    dims[0] = batch_size_;
+    return dims;
+  }
+
+ public:
+  /**
+   * Construct a slice of the specified var_context.
+   *
+   * @param context var_context to slice
+   * @param sliced_names names of the variables whose rows are sliced
+   * @param size_names names of the integer scalars holding the number of
+   * rows
+   * @param offset index of the first row of the minibatch
+   * @param batch_size number of rows in the minibatch
+   * @throw std::invalid_argument if a sliced variable is missing or does
+   * not have the same number of rows as the others, if a size variable is
+   * not an integer scalar, or if the batch size is zero or more than the
+   * number of rows
+   */
+  slice_var_context(const var_context& context,
+                    const std::vector<std::string>& sliced_names,
+                    const std::vector<std::string>& size_names, size_t offset,
+                    size_t batch_size)
+      : context_(context),
+        sliced_names_(sliced_names),
+        size_names_(size_names),
+        num_rows_(0),
+        offset_(0),
+        batch_size_(batch_size) {
+    for (size_t n = 0; n < sliced_names_.size(); ++n) {
+      const std::string& name = sliced_names_[n];
+      if (!context_.contains_r(name)) {
+        throw std::invalid_argument("slice_var_context: variable " + name
+                                    + " not found");
+      }
+      std::vector<size_t> dims = context_.dims_r(name);
+      if (dims.empty()) {
+        throw std::invalid_argument("slice_var_context: variable " + name
+                                    + " is a scalar and has no rows");
+      }
+      if (n == 0) {
+        num_rows_ = dims[0];
+      } else if (dims[0] != num_rows_) {
+        std::stringstream msg;
+        msg << "slice_var_context: variable " << name << " has " << dims[0]
+            << " rows, but " << sliced_names_[0] << " has " << num_rows_;
+        throw std::invalid_argument(msg.str());
+      }
+    }
+    for (const std::string& name : size_names_) {
+      if (!context_.contains_i(name) || !context_.dims_i(name).empty()) {
+        throw std::invalid_argument("slice_var_context: size variable "
+                                    + name + " is not an integer scalar");
+      }
+    }
+    if (batch_size_ == 0 || batch_size_ > num_rows_) {
+      std::stringstream msg;
+      msg << "slice_var_context: batch size " << batch_size_
+          << " must be positive and no more than the number of rows "
+          << num_rows_;
+      throw std::invalid_argument(msg.str());
+    }
+    offset_ = offset % num_rows_;
+  }
+
+  /**
+   * Return the number of rows of the sliced variables in the underlying
+   * var_context.
+   */
+  size_t num_rows() const { return num_rows_; }
+
+  bool contains_r(const std::string& name) const {
+    return context_.contains_r(name);
+  }
+
+  bool contains_i(const std::string& name) const {
+    return context_.contains_i(name);
+  }
+
+  std::vector<double> vals_r(const std::string& name) const {
+    if (is_size(name))
+      return std::vector<double>(1, static_cast<double>(batch_size_));
+    if (is_sliced(name))
+      return slice(context_.vals_r(name));
+    return context_.vals_r(name);
+  }
+
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    if (is_sliced(name))
+      return slice(context_.vals_c(name));
+    return context_.vals_c(name);
+  }
+
+  std::vector<int> vals_i(const std::string& name) const {
+    if (is_size(name))
+      return std::vector<int>(1, static_cast<int>(batch_size_));
+    if (is_sliced(name))
+      return slice(context_.vals_i(name));
+    return context_.vals_i(name);
+  }
+
+  values_view<double> view_r(const std::string& name) const {
+    if (is_size(name) || is_sliced(name))
+      return var_context::view_r(name);
+    return context_.view_r(name);
+  }
+
+  values_view<int> view_i(const std::string& name) const {
+    if (is_size(name) || is_sliced(name))
+      return var_context::view_i(name);
+    return context_.view_i(name);
+  }
+
+  std::vector<size_t> dims_r(const std::string& name) const {
+    if (is_sliced(name))
+      return sliced_dims(context_.dims_r(name));
+    return context_.dims_r(name);
+  }
+
+  std::vector<size_t> dims_i(const std::string& name) const {
+    if (is_sliced(name))
+      return sliced_dims(context_.dims_i(name));
+    return context_.dims_i(name);
+  }
+
+  void names_r(std::vector<std::string>& names) const {
+    context_.names_r(names);
+  }
+
+  void names_i(std::vector<std::string>& names) const {
+    context_.names_i(names);
+  }
+
+  /**
+   * Check variable dimensions against variable declaration.
+   * Only used for data read in from file.
+   *
+   * @param stage stan program processing stage
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   * @throw std::runtime_error if mismatch between declared
+   *        dimensions and dimensions found in context.
+   */
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    stan::io::validate_dims(*this, stage, name, base_type, dims_declared);
+  }
+};
+}  // namespace io
+}  // namespace stan
+
+#endif
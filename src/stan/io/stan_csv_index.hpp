@@ -0,0 +1,265 @@
+#ifndef STAN_IO_STAN_CSV_INDEX_HPP
+#define STAN_IO_STAN_CSV_INDEX_HPP
+
+#include <stan/io/stan_csv_reader.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * An index of the draws of a Stan CSV file: the header, as parsed by
+ * <code>stan_csv_reader</code>, and the byte offset of each draw, so
+ * that a range of draws is read by seeking straight to it instead of
+ * parsing the file from the start.
+ *
+ * The index is built with a single scan of the file, and may be saved in
+ * a sidecar file next to it and loaded instead of scanning the file
+ * again, as by <code>load_or_build()</code>.  The sidecar records the
+ * size of the file it indexes, so one for a file that has since changed
+ * is not used.  The draws indexed are those <code>stan_csv_reader</code>
+ * parses into the samples, so saved warmup draws are not indexed.
+ */
+class stan_csv_index {
+ public:
+  stan_csv_index() {}
+
+  /**
+   * Build the index of a file with a single scan of it.
+   *
+   * @param[in,out] in stream of the file, opened in binary mode, at its
+   *   start
+   * @return index of the draws of the file
+   * @throw std::invalid_argument if the file has no header
+   */
+  static stan_csv_index build(std::istream& in) {
+    stan_csv data;
+    stan_csv_reader::parse_preamble(in, data);
+    stan_csv_index index;
+    index.header_ = data.header;
+    if (in.eof()) {
+      // no draws after the preamble
+      in.clear();
+      in.seekg(0, std::ios::end);
+      index.size_ = in.tellg();
+      return index;
+    }
+    std::streamoff offset = in.tellg();
+    if (offset < 0)
+      throw std::invalid_argument("Error: csv stream is not seekable");
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line[0] != '#')
+        index.offsets_.push_back(offset);
+      offset += line.size();
+      if (!in.eof())
+        ++offset;
+    }
+    index.size_ = offset;
+    return index;
+  }
+
+  /**
+   * Load the index of a file from its sidecar file, or build it and save
+   * it in the sidecar file if the sidecar file does not exist, cannot be
+   * read, or is for a file of a different size.  The index is still
+   * returned if it cannot be saved.
+   *
+   * @param[in] filename name of the csv file
+   * @param[in] index_filename name of the sidecar file
+   * @return index of the draws of the file
+   * @throw std::invalid_argument if the file cannot be opened or has no
+   *   header
+   */
+  static stan_csv_index load_or_build(const std::string& filename,
+                                      const std::string& index_filename) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in)
+      throw std::invalid_argument("Error: cannot open csv file " + filename);
+    const std::streamoff size = in.tellg();
+    {
+      std::ifstream sidecar(index_filename, std::ios::binary);
+      if (sidecar) {
+        try {
+          stan_csv_index index = read(sidecar);
+          if (index.size_ == size)
+            return index;
+        } catch (const std::invalid_argument&) {
+        }
+      }
+    }
+    in.seekg(0);
+    stan_csv_index index = build(in);
+    std::ofstream sidecar(index_filename, std::ios::binary);
+    if (sidecar)
+      index.write(sidecar);
+    return index;
+  }
+
+  /**
+   * Load the index of a file from the sidecar file named after it with
+   * <code>.index</code> appended, or build and save it, as by the
+   * overload taking the name of the sidecar file.
+   *
+   * @param[in] filename name of the csv file
+   * @return index of the draws of the file
+   * @throw std::invalid_argument if the file cannot be opened or has no
+   *   header
+   */
+  static stan_csv_index load_or_build(const std::string& filename) {
+    return load_or_build(filename, filename + ".index");
+  }
+
+  /**
+   * Write the index in the sidecar format: a format line, the size of
+   * the file, the number of columns then each name of the header, and
+   * the number of draws then the offset of each draw, one per line.
+   *
+   * @param[in,out] out stream of the sidecar file
+   */
+  void write(std::ostream& out) const {
+    out << "stan_csv_index 1\n" << size_ << '\n' << header_.size() << '\n';
+    for (const std::string& name : header_)
+      out << name << '\n';
+    out << offsets_.size() << '\n';
+    for (std::streamoff offset : offsets_)
+      out << offset << '\n';
+  }
+
+  /**
+   * Read an index in the sidecar format.
+   *
+   * @param[in,out] in stream of the sidecar file
+   * @return index read
+   * @throw std::invalid_argument if the stream is not in the sidecar
+   *   format
+   */
+  static stan_csv_index read(std::istream& in) {
+    stan_csv_index index;
+    std::string line;
+    if (!std::getline(in, line) || line != "stan_csv_index 1")
+      throw std::invalid_argument("Error: not a stan csv index");
+    size_t num_cols = 0;
+    if (!(in >> index.size_ >> num_cols) || !std::getline(in, line))
+      throw std::invalid_argument("Error: truncated stan csv index");
+    index.header_.resize(num_cols);
+    for (std::string& name : index.header_)
+      if (!std::getline(in, name))
+        throw std::invalid_argument("Error: truncated stan csv index");
+    size_t num_draws = 0;
+    if (!(in >> num_draws))
+      throw std::invalid_argument("Error: truncated stan csv index");
+    index.offsets_.resize(num_draws);
+    for (std::streamoff& offset : index.offsets_)
+      if (!(in >> offset))
+        throw std::invalid_argument("Error: truncated stan csv index");
+    return index;
+  }
+
+  /**
+   * Return the number of draws indexed.
+   */
+  size_t num_draws() const noexcept { return offsets_.size(); }
+
+  /**
+   * Return the header of the file, with the names as
+   * <code>stan_csv_reader</code> parses them.
+   */
+  const std::vector<std::string>& header() const noexcept { return header_; }
+
+  /**
+   * Read a range of draws, optionally keeping only some of the columns.
+   *
+   * @param[in,out] in stream of the file indexed, opened in binary mode
+   * @param[in] first index of the first draw read
+   * @param[in] count number of draws read, fewer if the file has fewer
+   *   draws from the first
+   * @param[in] columns names of the columns kept, either as in the file
+   *   or as the header is parsed, in the order they should appear in the
+   *   result; all columns are kept if empty
+   * @return one row per draw read and one column per column kept
+   * @throw std::out_of_range if the first draw is past the last one
+   * @throw std::invalid_argument if there is no column of one of the
+   *   names, or if a draw read does not have a value for each column of
+   *   the header
+   */
+  Eigen::MatrixXd read_draws(std::istream& in, size_t first, size_t count,
+                             const std::vector<std::string>& columns
+                             = {}) const {
+    if (first > offsets_.size())
+      throw std::out_of_range("Error: draw " + std::to_string(first)
+                              + " is past the last of "
+                              + std::to_string(offsets_.size()));
+    count = std::min(count, offsets_.size() - first);
+    std::vector<size_t> selected;
+    if (columns.empty()) {
+      for (size_t i = 0; i < header_.size(); ++i)
+        selected.push_back(i);
+    } else {
+      for (const std::string& name : columns) {
+        std::string pretty = name;
+        prettify_stan_csv_name(pretty);
+        auto column = std::find(header_.begin(), header_.end(), pretty);
+        if (column == header_.end())
+          throw std::invalid_argument("Error: no column " + name
+                                      + " in csv file");
+        selected.push_back(column - header_.begin());
+      }
+    }
+
+    Eigen::MatrixXd draws(count, selected.size());
+    std::string line;
+    std::vector<double> fields;
+    std::streamoff next = -1;
+    for (size_t n = 0; n < count; ++n) {
+      const std::streamoff offset = offsets_[first + n];
+      // consecutive draws are read without seeking
+      if (offset != next) {
+        in.clear();
+        in.seekg(offset);
+      }
+      if (!std::getline(in, line))
+        throw std::invalid_argument("Error: csv file is shorter than its "
+                                    "index");
+      next = offset + line.size() + 1;
+      fields.clear();
+      const char* p = line.c_str();
+      while (true) {
+        char* end;
+        fields.push_back(std::strtod(p, &end));
+        p = end;
+        while (*p != ',' && *p != '\0')
+          ++p;
+        if (*p == '\0')
+          break;
+        ++p;
+      }
+      if (fields.size() != header_.size())
+        throw std::invalid_argument(
+            "Error: expected " + std::to_string(header_.size())
+            + " columns, but found " + std::to_string(fields.size())
+            + " instead for row " + std::to_string(first + n + 1));
+      for (size_t j = 0; j < selected.size(); ++j)
+        draws(n, j) = fields[selected[j]];
+    }
+    return draws;
+  }
+
+ private:
+  std::vector<std::string> header_;
+  // Offset of each draw from the start of the file
+  std::vector<std::streamoff> offsets_;
+  // Size of the file indexed
+  std::streamoff size_ = 0;
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
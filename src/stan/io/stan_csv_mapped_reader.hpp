@@ -0,0 +1,211 @@
+#ifndef STAN_IO_STAN_CSV_MAPPED_READER_HPP
+#define STAN_IO_STAN_CSV_MAPPED_READER_HPP
+
+#include <stan/io/stan_csv_reader.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/streams/bufferstream.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * Reads a Stan output csv file by memory mapping it.  The comment
+ * blocks and the header are parsed as by <code>stan_csv_reader</code>;
+ * the sample rows are then located with a single scan of the mapping and
+ * parsed in parallel straight into the samples matrix, optionally
+ * keeping only some of the columns.
+ */
+class stan_csv_mapped_reader {
+ public:
+  stan_csv_mapped_reader() {}
+  ~stan_csv_mapped_reader() {}
+
+  /**
+   * Parses the file.
+   *
+   * Throws exception if contents can't be parsed into header + data rows.
+   *
+   * Emits warning message
+   *
+   * @param[in] filename name of the csv file
+   * @param[out] out output stream to send messages
+   * @param[in] columns names of the columns to keep, as they appear in
+   *   the parsed header, in the order they should appear in the result;
+   *   all columns are kept if empty
+   * @throw std::invalid_argument if the file has no column names, if a
+   *   row has the wrong number of columns, or if a requested column does
+   *   not exist
+   */
+  static stan_csv parse(const std::string& filename, std::ostream* out,
+                        const std::vector<std::string>& columns = {}) {
+    if (std::ifstream(filename, std::ios::binary | std::ios::ate).tellg()
+        <= 0)
+      throw std::invalid_argument("Error: no column names found in csv file");
+
+    namespace bip = boost::interprocess;
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    const char* begin = static_cast<const char*>(region.get_address());
+    const char* end = begin + region.get_size();
+
+    stan_csv data;
+    std::string line;
+    bip::ibufferstream in(begin, region.get_size());
+
+    stan_csv_reader::read_metadata(in, data.metadata);
+    if (!stan_csv_reader::read_header(in, data.header)) {
+      throw std::invalid_argument("Error: no column names found in csv file");
+    }
+
+    // skip warmup draws, if any
+    if (data.metadata.algorithm != "fixed_param" && data.metadata.num_warmup > 0
+        && data.metadata.save_warmup) {
+      while (in.peek() != '#') {
+        std::getline(in, line);
+      }
+    }
+
+    if (data.metadata.algorithm != "fixed_param") {
+      stan_csv_reader::read_adaptation(in, data.adaptation);
+    }
+
+    data.timing.warmup = 0;
+    data.timing.sampling = 0;
+
+    if (data.metadata.method == "variational") {
+      std::getline(in, line);  // discard variational estimate
+    }
+
+    std::vector<int> selected = select_columns(data.header, columns);
+    std::streamoff offset = in.tellg();
+    if (offset < 0 || begin + offset >= end || begin[offset] == '#') {
+      if (out)
+        *out << "Unable to parse sample" << std::endl;
+      data.samples.resize(0, selected.size());
+      if (!columns.empty())
+        data.header = columns;
+      return data;
+    }
+
+    std::vector<const char*> rows;
+    find_rows(begin + offset, end, rows, data.timing);
+    if (!columns.empty())
+      data.header = columns;
+    if (rows.empty())
+      return data;
+
+    const char* first_end = line_end(rows[0], end);
+    const int cols = std::count(rows[0], first_end, ',') + 1;
+    if (columns.empty()) {
+      selected.resize(cols);
+      for (int col = 0; col < cols; ++col)
+        selected[col] = col;
+    }
+    std::vector<int> target(cols, -1);
+    for (size_t k = 0; k < selected.size(); ++k) {
+      if (selected[k] < cols)
+        target[selected[k]] = k;
+    }
+
+    data.samples.resize(rows.size(), selected.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, rows.size()),
+                      [&](const tbb::blocked_range<size_t>& r) {
+                        for (size_t row = r.begin(); row != r.end(); ++row)
+                          parse_row(rows[row], line_end(rows[row], end), row,
+                                    cols, target, data.samples);
+                      });
+    return data;
+  }
+
+ private:
+  static const char* line_end(const char* p, const char* end) {
+    const void* nl = std::memchr(p, '\n', end - p);
+    return nl ? static_cast<const char*>(nl) : end;
+  }
+
+  static std::vector<int> select_columns(
+      const std::vector<std::string>& header,
+      const std::vector<std::string>& columns) {
+    std::vector<int> selected;
+    for (const std::string& name : columns) {
+      auto it = std::find(header.begin(), header.end(), name);
+      if (it == header.end())
+        throw std::invalid_argument("Error: column " + name
+                                    + " not found in csv file");
+      selected.push_back(it - header.begin());
+    }
+    return selected;
+  }
+
+  /**
+   * Collect the start of every sample row from <code>p</code> on,
+   * adding up the timing found in comment lines.
+   */
+  static void find_rows(const char* p, const char* end,
+                        std::vector<const char*>& rows,
+                        stan_csv_timing& timing) {
+    while (p < end) {
+      const char* eol = line_end(p, end);
+      if (eol == p) {
+        ++p;
+        continue;
+      }
+      if (*p == '#') {
+        std::string line(p, eol);
+        if (line.find("(Warm-up)") != std::string::npos) {
+          timing.warmup += parse_seconds(line);
+        } else if (line.find("(Sampling)") != std::string::npos) {
+          timing.sampling += parse_seconds(line);
+        }
+      } else {
+        rows.push_back(p);
+      }
+      p = eol + 1;
+    }
+  }
+
+  static double parse_seconds(const std::string& line) {
+    int left = 17;
+    int right = line.find(" seconds");
+    double seconds = 0;
+    std::stringstream(line.substr(left, right - left)) >> seconds;
+    return seconds;
+  }
+
+  static void parse_row(const char* p, const char* eol, size_t row, int cols,
+                        const std::vector<int>& target,
+                        Eigen::MatrixXd& samples) {
+    int col = 0;
+    while (true) {
+      const void* comma = std::memchr(p, ',', eol - p);
+      const char* field_end = comma ? static_cast<const char*>(comma) : eol;
+      if (col < cols && target[col] >= 0)
+        samples(row, target[col])
+            = stan_csv_reader::parse_double(p, field_end);
+      ++col;
+      if (!comma)
+        break;
+      p = field_end + 1;
+    }
+    if (col != cols) {
+      std::stringstream msg;
+      msg << "Error: expected " << cols << " columns, but found " << col
+          << " instead for row " << row + 1;
+      throw std::invalid_argument(msg.str());
+    }
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
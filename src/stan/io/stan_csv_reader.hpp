@@ -3,7 +3,12 @@
 
 #include <boost/algorithm/string.hpp>
 #include <stan/math/prim.hpp>
+#include <stan/mcmc/chains_buffer.hpp>
+#include <algorithm>
 #include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
 #include <istream>
 #include <iostream>
 #include <sstream>
@@ -219,53 +224,84 @@ class stan_csv_reader {
     return true;
   }
 
+  /**
+   * Read the adaptation block of the comments, the step size and the
+   * diagonal or dense inverse metric, if the stream is at its start.
+   *
+   * The block is read a line at a time without copying it, and the rows
+   * of the metric are scanned with <code>parse_double</code> straight
+   * into the metric, which for a dense metric is allocated square from
+   * the number of values of its first row.
+   *
+   * @param[in,out] in stream at the start of the adaptation comments
+   * @param[out] adaptation step size and inverse metric
+   */
   static void read_adaptation(std::istream& in,
                               stan_csv_adaptation& adaptation) {
-    std::stringstream ss;
     std::string line;
-    int lines = 0;
     if (in.peek() != '#' || in.good() == false)
       return;
-    while (in.peek() == '#') {
-      std::getline(in, line);
-      ss << line << std::endl;
-      lines++;
-    }
-    ss.seekg(std::ios_base::beg);
-    if (lines < 2)
+    std::getline(in, line);  // comment adaptation terminated
+    if (in.peek() != '#')
       return;
 
-    std::getline(ss, line);  // comment adaptation terminated
-
     // parse stepsize
-    std::getline(ss, line, '=');  // stepsize
-    boost::trim(line);
-    ss >> adaptation.step_size;
-    if (lines == 2)  // ADVI reports stepsize, no metric
+    std::getline(in, line);
+    const size_t equal = line.find('=');
+    adaptation.step_size
+        = equal == std::string::npos
+              ? 0
+              : parse_double(line.data() + equal + 1,
+                             line.data() + line.size());
+    if (in.peek() != '#')  // ADVI reports stepsize, no metric
       return;
 
-    std::getline(ss, line);  // consume end of stepsize line
-    std::getline(ss, line);  // comment elements of mass matrix
-    std::getline(ss, line);  // diagonal metric or row 1 of dense metric
-
-    int rows = lines - 3;
-    int cols = std::count(line.begin(), line.end(), ',') + 1;
-    adaptation.metric.resize(rows, cols);
-    char comment;  // Buffer for comment indicator, #
-
-    // parse metric, row by row, element by element
-    for (int row = 0; row < rows; row++) {
-      std::stringstream line_ss;
-      line_ss.str(line);
-      line_ss >> comment;
-      for (int col = 0; col < cols; col++) {
-        std::string token;
-        std::getline(line_ss, token, ',');
-        boost::trim(token);
-        std::stringstream(token) >> adaptation.metric(row, col);
-      }
-      std::getline(ss, line);
+    std::getline(in, line);  // comment elements of mass matrix
+    if (in.peek() != '#') {
+      adaptation.metric.resize(0, 0);
+      return;
     }
+    std::getline(in, line);  // diagonal metric or row 1 of dense metric
+
+    const int cols = std::count(line.begin(), line.end(), ',') + 1;
+    adaptation.metric.resize(cols > 1 ? cols : 1, cols);
+    int rows = 0;
+    while (true) {
+      if (rows == adaptation.metric.rows())
+        adaptation.metric.conservativeResize(2 * rows, cols);
+      parse_metric_row(line, rows, adaptation.metric);
+      ++rows;
+      if (in.peek() != '#')
+        break;
+      std::getline(in, line);
+    }
+    if (rows != adaptation.metric.rows())
+      adaptation.metric.conservativeResize(rows, cols);
+  }
+
+  /**
+   * Return the number in the specified characters of a field, ignoring
+   * white space around it and a leading plus sign, or zero if they do not
+   * start with a number.
+   *
+   * @param[in] first first character of the field
+   * @param[in] last one past the last character of the field
+   */
+  static double parse_double(const char* first, const char* last) {
+    while (first < last && std::isspace(static_cast<unsigned char>(*first)))
+      ++first;
+    while (last > first && std::isspace(static_cast<unsigned char>(last[-1])))
+      --last;
+    if (first < last && *first == '+')
+      ++first;
+    double value = 0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars(first, last, value);
+#else
+    std::string token(first, last);
+    value = std::strtod(token.c_str(), nullptr);
+#endif
+    return value;
   }
 
   static bool read_samples(std::istream& in, Eigen::MatrixXd& samples,
@@ -337,6 +373,77 @@ class stan_csv_reader {
     return true;
   }
 
+  /**
+   * Read the draws into a new chain of a buffer, parsing each row in
+   * place instead of collecting the rows first.
+   *
+   * @param[in] in input stream positioned at the first draw
+   * @param[in,out] draws buffer to which a chain is added
+   * @param[in,out] timing timing read from the comments
+   * @return false if there is no draw to read
+   * @throw std::invalid_argument if a row does not have a column for each
+   * parameter of the buffer, in which case the new chain is removed
+   */
+  static bool read_samples(std::istream& in, mcmc::chains_buffer& draws,
+                           stan_csv_timing& timing) {
+    std::string line;
+    std::string token;
+    const int chain = draws.num_chains();
+    const int cols = draws.num_params();
+    int rows = 0;
+
+    if (in.peek() == '#' || in.good() == false)
+      return false;  // need at least one data row
+
+    draws.resize_chains(chain + 1);
+    while (in.good()) {
+      bool comment_line = (in.peek() == '#');
+      bool empty_line = (in.peek() == '\n');
+
+      std::getline(in, line);
+      if (empty_line)
+        continue;
+      if (!line.length())
+        break;
+
+      if (comment_line) {
+        if (line.find("(Warm-up)") != std::string::npos) {
+          int left = 17;
+          int right = line.find(" seconds");
+          double warmup;
+          std::stringstream(line.substr(left, right - left)) >> warmup;
+          timing.warmup += warmup;
+        } else if (line.find("(Sampling)") != std::string::npos) {
+          int left = 17;
+          int right = line.find(" seconds");
+          double sampling;
+          std::stringstream(line.substr(left, right - left)) >> sampling;
+          timing.sampling += sampling;
+        }
+      } else {
+        int current_cols = std::count(line.begin(), line.end(), ',') + 1;
+        if (cols != current_cols) {
+          draws.pop_chain();
+          std::stringstream msg;
+          msg << "Error: expected " << cols << " columns, but found "
+              << current_cols << " instead for row " << rows + 1;
+          throw std::invalid_argument(msg.str());
+        }
+        auto draw = draws.append_draw(chain);
+        std::stringstream ls(line);
+        for (int col = 0; col < cols; col++) {
+          std::getline(ls, token, ',');
+          boost::trim(token);
+          std::stringstream(token) >> draw(col);
+        }
+        rows++;
+      }
+
+      in.peek();
+    }
+    return true;
+  }
+
   /**
    * Parses the file.
    *
@@ -349,6 +456,49 @@ class stan_csv_reader {
    */
   static stan_csv parse(std::istream& in, std::ostream* out) {
     stan_csv data;
+    parse_preamble(in, data);
+    if (!read_samples(in, data.samples, data.timing)) {
+      if (out)
+        *out << "Unable to parse sample" << std::endl;
+    }
+    return data;
+  }
+
+  /**
+   * Parses the file, reading the draws into a new chain of a buffer
+   * instead of into the <code>samples</code> of the result, which is left
+   * empty.
+   *
+   * @param[in] in input stream to parse
+   * @param[out] out output stream to send messages
+   * @param[in,out] draws buffer to which a chain is added
+   * @throw std::invalid_argument if the file has no header, or not one
+   * column for each parameter of the buffer
+   */
+  static stan_csv parse(std::istream& in, std::ostream* out,
+                        mcmc::chains_buffer& draws) {
+    stan_csv data;
+    parse_preamble(in, data);
+    if (data.header.size() != static_cast<size_t>(draws.num_params()))
+      throw std::invalid_argument(
+          "Error: number of columns in csv file does not match buffer");
+    if (!read_samples(in, draws, data.timing)) {
+      if (out)
+        *out << "Unable to parse sample" << std::endl;
+    }
+    return data;
+  }
+
+  /**
+   * Parses everything in front of the draws: the metadata, the header,
+   * any warmup draws and the adaptation, leaving the stream at the first
+   * draw.
+   *
+   * @param[in] in input stream to parse
+   * @param[out] data parsed metadata, header and adaptation
+   * @throw std::invalid_argument if the file has no header
+   */
+  static void parse_preamble(std::istream& in, stan_csv& data) {
     std::string line;
 
     read_metadata(in, data.metadata);
@@ -374,12 +524,30 @@ class stan_csv_reader {
     if (data.metadata.method == "variational") {
       std::getline(in, line);  // discard variational estimate
     }
+  }
 
-    if (!read_samples(in, data.samples, data.timing)) {
-      if (out)
-        *out << "Unable to parse sample" << std::endl;
+ private:
+  /**
+   * Parse the comma separated values of a comment line of the metric into
+   * a row of the metric, leaving the entries missing from the line zero.
+   */
+  static void parse_metric_row(const std::string& line, int row,
+                               Eigen::MatrixXd& metric) {
+    const char* p = line.data();
+    const char* eol = p + line.size();
+    const void* hash = std::memchr(p, '#', eol - p);
+    if (hash)
+      p = static_cast<const char*>(hash) + 1;
+    for (Eigen::Index col = 0; col < metric.cols(); ++col) {
+      const void* comma = std::memchr(p, ',', eol - p);
+      const char* field_end = comma ? static_cast<const char*>(comma) : eol;
+      metric(row, col) = parse_double(p, field_end);
+      if (!comma) {
+        metric.row(row).tail(metric.cols() - col - 1).setZero();
+        break;
+      }
+      p = field_end + 1;
     }
-    return data;
   }
 };
 
@@ -0,0 +1,237 @@
+#ifndef STAN_IO_STAN_CSV_TAIL_READER_HPP
+#define STAN_IO_STAN_CSV_TAIL_READER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * Reads a Stan CSV file that is still being written, such as the output
+ * of a running sampler, a little more at each call.
+ *
+ * The reader keeps its position in the file and the state of the parse
+ * between calls, so each call reads only the bytes appended since the
+ * last one and returns the complete draws among them; a line not yet
+ * terminated by a newline is kept until it is.  The metadata, the
+ * header, the adaptation and the timing are parsed as by
+ * <code>stan_csv_reader</code> as they are written, and saved warmup
+ * draws are skipped.  A file that does not exist yet is treated as
+ * empty.
+ *
+ * The draws may instead be forwarded to a writer, such as an
+ * <code>analyze::online_diagnostics</code> accumulator, which receives
+ * the header once it is read and then each draw, so that a monitor can
+ * track the summaries of a run without reading its output again.
+ */
+class stan_csv_tail_reader {
+ public:
+  /**
+   * @param[in] filename name of the csv file
+   */
+  explicit stan_csv_tail_reader(const std::string& filename)
+      : filename_(filename) {}
+
+  /**
+   * Read the draws appended since the last call into the rows of a
+   * matrix, which is resized to one row per draw read and one column per
+   * name of the header.
+   *
+   * @param[out] draws new draws
+   * @return number of new draws
+   * @throw std::invalid_argument if a draw does not have a value for each
+   *   column of the header
+   */
+  size_t read(Eigen::MatrixXd& draws) {
+    new_draws_.clear();
+    poll(nullptr);
+    const size_t num_cols = csv_.header.size();
+    draws.resize(new_draws_.size() / (num_cols > 0 ? num_cols : 1),
+                 num_cols);
+    for (Eigen::Index n = 0; n < draws.rows(); ++n)
+      for (size_t j = 0; j < num_cols; ++j)
+        draws(n, j) = new_draws_[n * num_cols + j];
+    return draws.rows();
+  }
+
+  /**
+   * Forward the header, once it is read, and the draws appended since
+   * the last call to a writer.
+   *
+   * @param[in,out] writer writer receiving the header and the draws
+   * @return number of new draws
+   * @throw std::invalid_argument if a draw does not have a value for each
+   *   column of the header
+   */
+  size_t read(callbacks::writer& writer) {
+    const size_t num_draws = num_draws_;
+    poll(&writer);
+    return num_draws_ - num_draws;
+  }
+
+  /**
+   * Return true once the header is read.
+   */
+  bool has_header() const noexcept { return state_ != state::metadata; }
+
+  /**
+   * Return the number of draws read so far.
+   */
+  size_t num_draws() const noexcept { return num_draws_; }
+
+  /**
+   * Return the metadata, header and adaptation read so far, with the
+   * timing read so far and no samples.
+   */
+  const stan_csv& csv() const noexcept { return csv_; }
+
+ private:
+  enum class state { metadata, warmup, adaptation, draws };
+
+  std::string filename_;
+  std::ifstream in_;
+  // Bytes of the file read so far
+  std::streamoff offset_ = 0;
+  // Start of a line not yet terminated
+  std::string pending_;
+  state state_ = state::metadata;
+  // Comment lines of the block being read
+  std::string comments_;
+  bool skip_estimate_ = false;
+  stan_csv csv_;
+  size_t num_draws_ = 0;
+  std::vector<double> fields_;
+  std::vector<double> new_draws_;
+
+  void poll(callbacks::writer* writer) {
+    if (!in_.is_open()) {
+      in_.open(filename_, std::ios::binary);
+      if (!in_.is_open())
+        return;
+    }
+    in_.clear();
+    in_.seekg(offset_);
+    char buffer[1 << 16];
+    while (in_.read(buffer, sizeof(buffer)) || in_.gcount() > 0) {
+      const std::streamsize n = in_.gcount();
+      offset_ += n;
+      size_t begin = 0;
+      for (std::streamsize i = 0; i < n; ++i) {
+        if (buffer[i] != '\n')
+          continue;
+        pending_.append(buffer + begin, i - begin);
+        line(pending_, writer);
+        pending_.clear();
+        begin = i + 1;
+      }
+      pending_.append(buffer + begin, n - begin);
+    }
+  }
+
+  void line(const std::string& text, callbacks::writer* writer) {
+    const bool comment = !text.empty() && text[0] == '#';
+    switch (state_) {
+      case state::metadata:
+        if (comment || text.empty()) {
+          comments_ += text + '\n';
+          return;
+        }
+        {
+          std::stringstream metadata(comments_);
+          stan_csv_reader::read_metadata(metadata, csv_.metadata);
+          std::stringstream header(text);
+          if (!stan_csv_reader::read_header(header, csv_.header))
+            throw std::invalid_argument(
+                "Error: no column names found in csv file");
+        }
+        comments_.clear();
+        skip_estimate_ = csv_.metadata.method == "variational";
+        state_ = csv_.metadata.algorithm != "fixed_param"
+                         && csv_.metadata.num_warmup > 0
+                         && csv_.metadata.save_warmup
+                     ? state::warmup
+                     : state::adaptation;
+        if (writer)
+          (*writer)(csv_.header);
+        return;
+      case state::warmup:
+        if (!comment)
+          return;
+        state_ = state::adaptation;
+        comments_ += text + '\n';
+        return;
+      case state::adaptation:
+        if (comment) {
+          comments_ += text + '\n';
+          return;
+        }
+        if (text.empty())
+          return;
+        if (csv_.metadata.algorithm != "fixed_param") {
+          std::stringstream adaptation(comments_);
+          stan_csv_reader::read_adaptation(adaptation, csv_.adaptation);
+        }
+        comments_.clear();
+        state_ = state::draws;
+        draw(text, writer);
+        return;
+      case state::draws:
+        if (comment)
+          read_timing(text);
+        else if (!text.empty())
+          draw(text, writer);
+        return;
+    }
+  }
+
+  void draw(const std::string& text, callbacks::writer* writer) {
+    if (skip_estimate_) {
+      skip_estimate_ = false;  // discard variational estimate
+      return;
+    }
+    fields_.clear();
+    const char* p = text.c_str();
+    while (true) {
+      char* end;
+      fields_.push_back(std::strtod(p, &end));
+      p = end;
+      while (*p != ',' && *p != '\0')
+        ++p;
+      if (*p == '\0')
+        break;
+      ++p;
+    }
+    if (fields_.size() != csv_.header.size())
+      throw std::invalid_argument(
+          "Error: expected " + std::to_string(csv_.header.size())
+          + " columns, but found " + std::to_string(fields_.size())
+          + " instead for row " + std::to_string(num_draws_ + 1));
+    ++num_draws_;
+    if (writer)
+      (*writer)(fields_);
+    else
+      new_draws_.insert(new_draws_.end(), fields_.begin(), fields_.end());
+  }
+
+  void read_timing(const std::string& text) {
+    const size_t seconds = text.find(" seconds");
+    if (seconds == std::string::npos || text.size() < 17)
+      return;
+    const double value = std::strtod(text.c_str() + 17, nullptr);
+    if (text.find("(Warm-up)") != std::string::npos)
+      csv_.timing.warmup += value;
+    else if (text.find("(Sampling)") != std::string::npos)
+      csv_.timing.sampling += value;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
@@ -1,9 +1,12 @@
 #ifndef STAN_IO_VAR_CONTEXT_HPP
 #define STAN_IO_VAR_CONTEXT_HPP
 
+#include <cstddef>
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include <complex>
 
@@ -11,6 +14,67 @@ namespace stan {
 
 namespace io {
 
+/**
+ * A read-only view of the values of a variable in a
+ * <code>var_context</code>.
+ *
+ * <p>A view either refers to storage owned by the context, which must
+ * outlive the view, or holds its own copy of the values when the
+ * context has no storage of the requested type to refer to.  Copies of
+ * a view share that copy.
+ *
+ * @tparam T type of the values
+ */
+template <typename T>
+class values_view {
+ public:
+  /**
+   * Construct an empty view.
+   */
+  values_view() : data_(nullptr), size_(0) {}
+
+  /**
+   * Construct a view of storage owned by someone else.
+   *
+   * @param data pointer to the first value
+   * @param size number of values
+   */
+  values_view(const T* data, size_t size) : data_(data), size_(size) {}
+
+  /**
+   * Construct a view that owns the specified values.
+   *
+   * @param values values to take ownership of
+   */
+  explicit values_view(std::vector<T>&& values)
+      : owned_(std::make_shared<const std::vector<T>>(std::move(values))),
+        data_(owned_->data()),
+        size_(owned_->size()) {}
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const T* begin() const { return data_; }
+  const T* end() const { return data_ + size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+  /**
+   * Return <code>true</code> if the view holds its own copy of the
+   * values rather than referring to the storage of the context.
+   */
+  bool owns_data() const { return owned_ != nullptr; }
+
+  /**
+   * Return a copy of the values.
+   */
+  std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+ private:
+  std::shared_ptr<const std::vector<T>> owned_;
+  const T* data_;
+  size_t size_;
+};
+
 /**
  * A <code>var_context</code> reads array variables of integer and
  * floating point type by name and dimension.
@@ -111,6 +175,38 @@ class var_context {
    */
   virtual std::vector<size_t> dims_i(const std::string& name) const = 0;
 
+  /**
+   * Return a view of the floating point values for the variable of
+   * the specified name, in the same order as <code>vals_r</code>.
+   *
+   * <p>Contexts that store floating point values should override
+   * this to refer to their storage, so that reading a variable does
+   * not copy it.  The default view holds the copy returned by
+   * <code>vals_r</code>.
+   *
+   * @param name Name of variable.
+   * @return View of the values for the named variable.
+   */
+  virtual values_view<double> view_r(const std::string& name) const {
+    return values_view<double>(vals_r(name));
+  }
+
+  /**
+   * Return a view of the integer values for the variable of the
+   * specified name, in the same order as <code>vals_i</code>.
+   *
+   * <p>Contexts that store integer values should override this to
+   * refer to their storage, so that reading a variable does not copy
+   * it.  The default view holds the copy returned by
+   * <code>vals_i</code>.
+   *
+   * @param name Name of variable.
+   * @return View of the integer values.
+   */
+  virtual values_view<int> view_i(const std::string& name) const {
+    return values_view<int>(vals_i(name));
+  }
+
   /**
    * Fill a list of the names of the floating point variables in
    * the context.
@@ -0,0 +1,187 @@
+#ifndef STAN_IO_VIEW_VAR_CONTEXT_HPP
+#define STAN_IO_VIEW_VAR_CONTEXT_HPP
+
+#include <stan/io/var_context.hpp>
+#include <stan/io/validate_dims.hpp>
+#include <complex>
+#include <cstddef>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A var_context over values held by the caller, so that data which an
+ * interface already has in contiguous arrays reaches the model without
+ * being copied.
+ *
+ * Each variable is a name, a pointer to its values in column-major
+ * order, and its dimensions.  Only the pointers are stored: the caller
+ * owns the values, which must not change or be freed while the context or
+ * any view returned by <code>view_r</code> or <code>view_i</code> is in
+ * use.  The views of real variables and of integer variables refer to
+ * the caller's memory; integer variables read as reals are copied, as
+ * with every context.
+ */
+class view_var_context : public var_context {
+ public:
+  /**
+   * A variable referring to values held by the caller.
+   *
+   * @tparam T type of the values
+   */
+  template <typename T>
+  struct variable {
+    // Name of the variable
+    std::string name;
+    // Values in column-major order, as many as the product of the dims
+    const T* data;
+    // Dimensions, empty for a scalar
+    std::vector<size_t> dims;
+  };
+
+  /**
+   * Construct a context referring to the specified variables.
+   *
+   * @param reals real variables
+   * @param ints integer variables
+   * @throw std::invalid_argument if a name is given twice or a variable
+   * with values has a null pointer
+   */
+  explicit view_var_context(const std::vector<variable<double>>& reals,
+                            const std::vector<variable<int>>& ints = {}) {
+    for (const auto& var : reals)
+      add(var).reals = var.data;
+    for (const auto& var : ints) {
+      entry& e = add(var);
+      e.ints = var.data;
+      e.is_int = true;
+    }
+  }
+
+  bool contains_r(const std::string& name) const {
+    return vars_.find(name) != vars_.end();
+  }
+
+  bool contains_i(const std::string& name) const {
+    auto var = vars_.find(name);
+    return var != vars_.end() && var->second.is_int;
+  }
+
+  std::vector<double> vals_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var == vars_.end())
+      return {};
+    const entry& e = var->second;
+    if (e.is_int)
+      return {e.ints, e.ints + e.size};
+    return {e.reals, e.reals + e.size};
+  }
+
+  std::vector<std::complex<double>> vals_c(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var == vars_.end() || var->second.dims.empty())
+      return {};
+    std::vector<double> vals = vals_r(name);
+    // the real and imaginary parts are the last index
+    const size_t offset = vals.size() / 2;
+    std::vector<std::complex<double>> vals_c(offset);
+    for (size_t i = 0; i < offset; ++i)
+      vals_c[i] = {vals[i], vals[i + offset]};
+    return vals_c;
+  }
+
+  std::vector<size_t> dims_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    return var == vars_.end() ? std::vector<size_t>() : var->second.dims;
+  }
+
+  std::vector<int> vals_i(const std::string& name) const {
+    if (!contains_i(name))
+      return {};
+    const entry& e = vars_.find(name)->second;
+    return {e.ints, e.ints + e.size};
+  }
+
+  std::vector<size_t> dims_i(const std::string& name) const {
+    return contains_i(name) ? vars_.find(name)->second.dims
+                            : std::vector<size_t>();
+  }
+
+  values_view<double> view_r(const std::string& name) const {
+    auto var = vars_.find(name);
+    if (var != vars_.end() && !var->second.is_int)
+      return {var->second.reals, var->second.size};
+    return var_context::view_r(name);
+  }
+
+  values_view<int> view_i(const std::string& name) const {
+    if (!contains_i(name))
+      return {};
+    const entry& e = vars_.find(name)->second;
+    return {e.ints, e.size};
+  }
+
+  void names_r(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (!var.second.is_int)
+        names.push_back(var.first);
+  }
+
+  void names_i(std::vector<std::string>& names) const {
+    names.clear();
+    for (const auto& var : vars_)
+      if (var.second.is_int)
+        names.push_back(var.first);
+  }
+
+  /**
+   * Check variable dimensions against variable declaration.
+   *
+   * @param stage stan program processing stage
+   * @param name variable name
+   * @param base_type declared stan variable type
+   * @param dims_declared variable dimensions
+   * @throw std::runtime_error if mismatch between declared
+   *        dimensions and dimensions found in context.
+   */
+  void validate_dims(const std::string& stage, const std::string& name,
+                     const std::string& base_type,
+                     const std::vector<size_t>& dims_declared) const {
+    stan::io::validate_dims(*this, stage, name, base_type, dims_declared);
+  }
+
+ private:
+  struct entry {
+    const double* reals = nullptr;
+    const int* ints = nullptr;
+    bool is_int = false;
+    std::vector<size_t> dims;
+    size_t size = 1;
+  };
+  std::map<std::string, entry> vars_;
+
+  template <typename T>
+  entry& add(const variable<T>& var) {
+    auto inserted = vars_.emplace(var.name, entry());
+    if (!inserted.second)
+      throw std::invalid_argument("view_var_context: variable " + var.name
+                                  + " is given more than once");
+    entry& e = inserted.first->second;
+    e.dims = var.dims;
+    for (size_t d : var.dims)
+      e.size *= d;
+    if (e.size > 0 && var.data == nullptr)
+      throw std::invalid_argument("view_var_context: variable " + var.name
+                                  + " has no values");
+    return e;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
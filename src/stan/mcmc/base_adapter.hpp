@@ -1,6 +1,8 @@
 #ifndef STAN_MCMC_BASE_ADAPTER_HPP
 #define STAN_MCMC_BASE_ADAPTER_HPP
 
+#include <cstddef>
+
 namespace stan {
 namespace mcmc {
 
@@ -14,6 +16,12 @@ class base_adapter {
 
   bool adapting() { return adapt_flag_; }
 
+  /**
+   * Return the bytes of storage held by the estimators of the
+   * adaptation, for memory accounting.
+   */
+  virtual size_t memory_bytes() const { return 0; }
+
  protected:
   bool adapt_flag_;
 };
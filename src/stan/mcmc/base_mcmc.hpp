@@ -1,9 +1,11 @@
 #ifndef STAN_MCMC_BASE_MCMC_HPP
 #define STAN_MCMC_BASE_MCMC_HPP
 
+#include <stan/callbacks/interrupt.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/mcmc/sample.hpp>
+#include <stan/model/gradient_stats.hpp>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -29,6 +31,64 @@ class base_mcmc {
       std::vector<std::string>& model_names, std::vector<std::string>& names) {}
 
   virtual void get_sampler_diagnostics(std::vector<double>& values) {}
+
+  /**
+   * Set whether the wall time of the gradients of the sampler is
+   * measured, for instrumentation.
+   */
+  virtual void set_gradient_timing(bool timing) {}
+
+  /**
+   * Return the work done by the gradients of the sampler since it was
+   * constructed, which is empty for samplers that do not report it.
+   */
+  virtual stan::model::gradient_stats get_gradient_stats() {
+    return stan::model::gradient_stats();
+  }
+
+  /**
+   * Write the counts of the proposals the sampler rejected since the last
+   * summary because the log density could not be evaluated, and start
+   * counting afresh.  Samplers that do not count them write nothing.
+   */
+  virtual void write_rejection_summary(callbacks::logger& logger) {}
+
+  /**
+   * Return the bytes of storage held by the state of the sampler, its
+   * metric and the estimators of its adaptation, for memory accounting.
+   * It does not include the autodiff arena, which the gradient stats
+   * report.
+   */
+  virtual size_t memory_bytes() const { return 0; }
+
+  /**
+   * Set the interrupt polled within a transition, through
+   * <code>stop_requested()</code>, by samplers whose transitions can be
+   * long, such as NUTS at a large tree depth, or clear it with null.  A
+   * transition cut short by a stop returns a valid state, but not a
+   * draw from the target, so it should not be kept.
+   *
+   * @param[in] interrupt interrupt, which must outlive its use here, or
+   *   null
+   */
+  void set_interrupt(const callbacks::interrupt* interrupt) {
+    interrupt_ = interrupt;
+  }
+
+  const callbacks::interrupt* get_interrupt() const noexcept {
+    return interrupt_;
+  }
+
+  /**
+   * Return true if the interrupt set with <code>set_interrupt</code>
+   * requests a stop.
+   */
+  bool stop_requested() const {
+    return interrupt_ != nullptr && interrupt_->stop_requested();
+  }
+
+ private:
+  const callbacks::interrupt* interrupt_ = nullptr;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,208 @@
+#ifndef STAN_MCMC_BATCHED_COVAR_ESTIMATOR_HPP
+#define STAN_MCMC_BATCHED_COVAR_ESTIMATOR_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Estimates the covariance of draws like
+ * <code>stan::math::welford_covar_estimator</code>, but buffers the draws
+ * and merges each batch of them into the estimate with one rank-k update
+ * of the lower triangle of the sum of squared deviations.
+ *
+ * A Welford update of every draw is a dense rank-one update of the whole
+ * matrix, which at thousands of dimensions reads and writes the whole
+ * matrix for every draw.  A batch is merged with the update of Chan,
+ * Golub and LeVeque (1979): the deviations of the draws from the mean of
+ * the batch, along with the deviation of that mean from the running mean,
+ * form a rank-k symmetric update that touches the matrix once per batch.
+ * The update is blocked by columns of the lower triangle, and the blocks
+ * may be updated in parallel on the TBB threads.
+ */
+class batched_covar_estimator {
+ public:
+  /**
+   * Construct an estimator of the covariance of draws of the specified
+   * dimension.
+   *
+   * @param n dimension of the draws
+   * @param batch_size number of draws merged at a time
+   */
+  explicit batched_covar_estimator(int n, int batch_size = 32)
+      : m_(Eigen::VectorXd::Zero(n)),
+        m2_(Eigen::MatrixXd::Zero(n, n)),
+        buffer_(n, batch_size > 0 ? batch_size : 1),
+        deviations_(n, buffer_.cols() + 1),
+        num_samples_(0),
+        num_buffered_(0),
+        parallel_(false) {}
+
+  void restart() {
+    num_samples_ = 0;
+    num_buffered_ = 0;
+    m_.setZero();
+    m2_.setZero();
+  }
+
+  /**
+   * Set whether the column blocks of a batch update are split over the
+   * TBB threads.
+   */
+  void set_parallel(bool parallel) { parallel_ = parallel; }
+
+  bool parallel() const noexcept { return parallel_; }
+
+  int batch_size() const noexcept { return buffer_.cols(); }
+
+  /**
+   * Return the bytes of storage held by the estimator.
+   */
+  size_t memory_bytes() const {
+    return (m_.size() + m2_.size() + buffer_.size() + deviations_.size())
+           * sizeof(double);
+  }
+
+  double num_samples() const noexcept { return num_samples_ + num_buffered_; }
+
+  void add_sample(const Eigen::VectorXd& q) {
+    buffer_.col(num_buffered_) = q;
+    if (++num_buffered_ == buffer_.cols())
+      merge_buffer();
+  }
+
+  void sample_mean(Eigen::VectorXd& mean) {
+    merge_buffer();
+    mean = m_;
+  }
+
+  void sample_covariance(Eigen::MatrixXd& covar) {
+    merge_buffer();
+    if (num_samples_ > 1) {
+      covar = m2_.selfadjointView<Eigen::Lower>();
+      covar /= num_samples_ - 1.0;
+    }
+  }
+
+  /**
+   * Merge the buffered draws into the estimate.
+   */
+  void merge_buffer() {
+    if (num_buffered_ == 0)
+      return;
+    const double n = num_samples_;
+    const double k = num_buffered_;
+    const auto batch = buffer_.leftCols(num_buffered_);
+    const Eigen::VectorXd batch_mean = batch.rowwise().mean();
+    const Eigen::VectorXd delta = batch_mean - m_;
+    deviations_.leftCols(num_buffered_) = batch.colwise() - batch_mean;
+    deviations_.col(num_buffered_) = delta * std::sqrt(n * k / (n + k));
+    rank_update(deviations_.leftCols(num_buffered_ + 1));
+    m_ += delta * (k / (n + k));
+    num_samples_ += k;
+    num_buffered_ = 0;
+  }
+
+  /**
+   * Write the state of the estimator to a checkpoint, under the keys of
+   * the state of a <code>welford_covar_estimator</code> with the
+   * buffered draws written as they are, so that the estimate is restored
+   * exactly.
+   *
+   * @param[in,out] writer checkpoint writer
+   * @param prefix prefix of the keys
+   */
+  void write_checkpoint(callbacks::structured_writer& writer,
+                        const std::string& prefix) const {
+    writer.write(prefix + "_num_samples", num_samples_);
+    writer.write(prefix + "_mean", m_);
+    writer.write(prefix + "_m2",
+                 Eigen::MatrixXd(m2_.selfadjointView<Eigen::Lower>()));
+    writer.write(prefix + "_num_buffered", num_buffered_);
+    if (num_buffered_ > 0)
+      writer.write(prefix + "_buffer",
+                   Eigen::MatrixXd(buffer_.leftCols(num_buffered_)));
+  }
+
+  /**
+   * Restore the state of the estimator from a checkpoint written by
+   * <code>write_checkpoint</code> or of a
+   * <code>welford_covar_estimator</code> of the same dimension.
+   *
+   * @param[in] context checkpoint
+   * @param prefix prefix of the keys
+   * @throw std::invalid_argument if the checkpoint has no such state or
+   * more buffered draws than fit in a batch
+   */
+  void read_checkpoint(const io::var_context& context,
+                       const std::string& prefix) {
+    const Eigen::Index n = m_.size();
+    num_samples_ = read_checkpoint_scalar(context, prefix + "_num_samples");
+    m_ = read_checkpoint_vector(context, prefix + "_mean", n);
+    m2_ = read_checkpoint_matrix(context, prefix + "_m2", n, n);
+    num_buffered_ = 0;
+    if (!context.contains_r(prefix + "_num_buffered"))
+      return;
+    const int num_buffered
+        = read_checkpoint_scalar(context, prefix + "_num_buffered");
+    if (num_buffered < 0 || num_buffered >= buffer_.cols())
+      throw std::invalid_argument("Checkpoint value " + prefix
+                                  + "_num_buffered is out of range");
+    if (num_buffered > 0)
+      buffer_.leftCols(num_buffered) = read_checkpoint_matrix(
+          context, prefix + "_buffer", n, num_buffered);
+    num_buffered_ = num_buffered;
+  }
+
+ protected:
+  static constexpr Eigen::Index block_size_ = 64;
+
+  /**
+   * Add the product of the specified matrix and its transpose to the lower
+   * triangle of the sum of squared deviations.
+   */
+  template <typename Mat>
+  void rank_update(const Mat& d) {
+    const Eigen::Index n = m2_.rows();
+    const Eigen::Index num_blocks = (n + block_size_ - 1) / block_size_;
+    if (!parallel_ || num_blocks < 2) {
+      m2_.selfadjointView<Eigen::Lower>().rankUpdate(d);
+      return;
+    }
+    // each block of columns from the diagonal down is a product of panels
+    auto update_blocks = [&](const tbb::blocked_range<Eigen::Index>& r) {
+      for (Eigen::Index b = r.begin(); b != r.end(); ++b) {
+        const Eigen::Index j = b * block_size_;
+        const Eigen::Index w = std::min(block_size_, n - j);
+        m2_.block(j, j, n - j, w).noalias()
+            += d.middleRows(j, n - j) * d.middleRows(j, w).transpose();
+      }
+    };
+    tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, num_blocks),
+                      update_blocks);
+  }
+
+  Eigen::VectorXd m_;           // Mean of the merged draws
+  Eigen::MatrixXd m2_;          // Lower triangle of squared deviations
+  Eigen::MatrixXd buffer_;      // Draws not yet merged
+  Eigen::MatrixXd deviations_;  // Deviations of a batch and its mean
+  double num_samples_;          // Number of merged draws
+  int num_buffered_;            // Number of draws not yet merged
+  bool parallel_;               // Whether blocks are updated in parallel
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
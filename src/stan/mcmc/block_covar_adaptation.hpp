@@ -0,0 +1,120 @@
+#ifndef STAN_MCMC_BLOCK_COVAR_ADAPTATION_HPP
+#define STAN_MCMC_BLOCK_COVAR_ADAPTATION_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/windowed_adaptation.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Windowed adaptation of a block diagonal inverse metric: at the end of
+ * each window every block is replaced with the regularized covariance of
+ * the draws of its parameters, as <code>covar_adaptation</code> does for
+ * a single block.  The covariances across blocks are not estimated, so
+ * each draw costs O(<code>sum b_i^2</code>) operations for blocks of
+ * sizes <code>b_i</code>.
+ */
+class block_covar_adaptation : public windowed_adaptation {
+ public:
+  /**
+   * Construct an adaptation for blocks of the specified sizes, which
+   * cover consecutive runs of the parameters.
+   *
+   * @param block_sizes number of parameters of each block
+   * @throw std::invalid_argument if a size is not positive
+   */
+  explicit block_covar_adaptation(const std::vector<int>& block_sizes)
+      : windowed_adaptation("block covariance"), block_sizes_(block_sizes) {
+    estimators_.reserve(block_sizes.size());
+    for (int size : block_sizes) {
+      if (size <= 0)
+        throw std::invalid_argument(
+            "Sizes of the metric blocks must be positive");
+      estimators_.emplace_back(size);
+    }
+  }
+
+  /**
+   * Return the bytes of storage held by the estimators of the blocks.
+   */
+  size_t memory_bytes() const {
+    size_t size = 0;
+    for (int block_size : block_sizes_)
+      size += block_size * (block_size + 1);
+    return size * sizeof(double);
+  }
+
+  /**
+   * Add a draw to the current window and, at the end of a window, replace
+   * each block of the inverse metric with the regularized covariance of
+   * its parameters over the window.
+   *
+   * @param[in,out] covar blocks of the inverse metric, of the sizes the
+   * adaptation was constructed with
+   * @param[in] q draw
+   * @return <code>true</code> if the inverse metric was updated
+   * @throw std::runtime_error if the estimate is not finite
+   */
+  bool learn_covariance(std::vector<Eigen::MatrixXd>& covar,
+                        const Eigen::VectorXd& q) {
+    if (adaptation_window()) {
+      Eigen::Index start = 0;
+      for (size_t b = 0; b < estimators_.size(); ++b) {
+        estimators_[b].add_sample(q.segment(start, block_sizes_[b]));
+        start += block_sizes_[b];
+      }
+    }
+
+    if (end_adaptation_window()) {
+      compute_next_window();
+
+      for (size_t b = 0; b < estimators_.size(); ++b) {
+        estimators_[b].sample_covariance(covar[b]);
+        regularize(estimators_[b].num_samples(), covar[b]);
+        estimators_[b].restart();
+      }
+
+      ++adapt_window_counter_;
+      return true;
+    }
+
+    ++adapt_window_counter_;
+    return false;
+  }
+
+ protected:
+  /**
+   * Shrink an estimate from <code>n</code> draws towards a small
+   * multiple of the identity, as <code>covar_adaptation</code> does.
+   *
+   * @param n number of draws behind the estimate
+   * @param[in,out] covar covariance estimate of a block
+   * @throw std::runtime_error if the result is not finite
+   */
+  static void regularize(double n, Eigen::MatrixXd& covar) {
+    covar = (n / (n + 5.0)) * covar
+            + 1e-3 * (5.0 / (n + 5.0))
+                  * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
+
+    if (!covar.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
+
+  std::vector<int> block_sizes_;
+  std::vector<stan::math::welford_covar_estimator> estimators_;
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
@@ -1,21 +1,25 @@
 #ifndef STAN_MCMC_CHAINS_HPP
 #define STAN_MCMC_CHAINS_HPP
 
+#include <stan/io/binary_draws_reader.hpp>
 #include <stan/io/stan_csv_reader.hpp>
+#include <stan/mcmc/chains_buffer.hpp>
 #include <stan/math/prim.hpp>
 #include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
 #include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/tail_quantile.hpp>
 #include <boost/accumulators/statistics/p_square_quantile.hpp>
 #include <boost/accumulators/statistics/variance.hpp>
 #include <boost/accumulators/statistics/covariance.hpp>
 #include <boost/accumulators/statistics/variates/covariate.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <stdexcept>
 #include <string>
@@ -33,22 +37,35 @@ using Eigen::Dynamic;
  * dimensionalities along with samples from multiple chains.
  *
  * <p><b>Synchronization</b>: For arbitrary concurrent use, the
- * read and write methods need to be read/write locked.  Multiple
- * writers can be used concurrently if they write to different
- * chains.  Readers for single chains need only be read/write locked
- * with writers of that chain.  For reading across chains, full
- * read/write locking is required.  Thus methods will be classified
- * as global or single-chain read or write methods.
+ * read and write methods need to be read/write locked.  Adding draws
+ * may grow the storage shared by all of the chains, so writers need to
+ * be locked against every reader and writer.  Concurrent readers need no
+ * locking.
  *
- * <p><b>Storage Order</b>: Storage is column/last-index major.
+ * <p><b>Storage Order</b>: The draws of all of the chains are stored in
+ * one <code>chains_buffer</code>, with the draws of each parameter in
+ * each chain contiguous, so per-chain views of a parameter are taken
+ * without copying.  The buffer may spill the draws to a memory mapped
+ * file rather than hold them in memory.
  */
 template <typename Unused = void*>
 class chains {
  private:
   std::vector<std::string> param_names_;
-  Eigen::Matrix<Eigen::MatrixXd, Dynamic, 1> samples_;
+  chains_buffer draws_;
   Eigen::VectorXi warmup_;
 
+  /**
+   * Give the chains added to the storage a warmup of zero.
+   */
+  void resize_warmup() {
+    const int n = warmup_.size();
+    if (n < num_chains()) {
+      warmup_.conservativeResize(num_chains());
+      warmup_.tail(num_chains() - n).setZero();
+    }
+  }
+
   static double mean(const Eigen::VectorXd& x) {
     return (x.array() / x.size()).sum();
   }
@@ -107,64 +124,70 @@ class chains {
                        * boost::accumulators::variance(acc_y));
   }
 
-  static double quantile(const Eigen::VectorXd& x, const double prob) {
-    using boost::accumulators::accumulator_set;
-    using boost::accumulators::left;
-    using boost::accumulators::quantile;
-    using boost::accumulators::quantile_probability;
-    using boost::accumulators::right;
-    using boost::accumulators::stats;
-    using boost::accumulators::tag::tail;
-    using boost::accumulators::tag::tail_quantile;
-    double M = x.rows();
-    // size_t cache_size = std::min(prob, 1-prob)*M + 2;
-    size_t cache_size = M;
-
+  /**
+   * Return the position in ascending order of the draw that is the
+   * quantile of the specified probability, or -1 if there is none.
+   *
+   * The positions are those of a Boost <code>tail_quantile</code>
+   * accumulator holding all of the draws: the left tail is used for
+   * probabilities below one half and the right tail otherwise.
+   *
+   * @param M number of draws
+   * @param prob probability
+   */
+  static Eigen::Index quantile_position(Eigen::Index M, double prob) {
     if (prob < 0.5) {
-      accumulator_set<double, stats<tail_quantile<left> > > acc(
-          tail<left>::cache_size = cache_size);
-      for (int i = 0; i < M; i++)
-        acc(x(i));
-      return quantile(acc, quantile_probability = prob);
+      double n = std::ceil(M * prob);
+      if (n >= M)
+        return -1;
+      return n > 0 ? static_cast<Eigen::Index>(n) - 1 : 0;
     }
-    accumulator_set<double, stats<tail_quantile<right> > > acc(
-        tail<right>::cache_size = cache_size);
-    for (int i = 0; i < M; i++)
-      acc(x(i));
-    return quantile(acc, quantile_probability = prob);
+    double n = std::ceil(M * (1. - prob));
+    if (n >= M)
+      return -1;
+    return n > 0 ? M - static_cast<Eigen::Index>(n) : M - 1;
   }
 
+  static double quantile(const Eigen::VectorXd& x, const double prob) {
+    return quantiles(x, Eigen::VectorXd::Constant(1, prob))(0);
+  }
+
+  /**
+   * Return the quantiles of the draws for the specified probabilities.
+   *
+   * The draws are copied once and partially ordered with one selection
+   * per distinct quantile, each over the draws above the previous one, so
+   * all of the quantiles take about as long as sorting the draws once.
+   *
+   * @param x draws
+   * @param probs probabilities
+   * @return quantiles, NaN where a probability has none
+   */
   static Eigen::VectorXd quantiles(const Eigen::VectorXd& x,
                                    const Eigen::VectorXd& probs) {
-    using boost::accumulators::accumulator_set;
-    using boost::accumulators::left;
-    using boost::accumulators::quantile;
-    using boost::accumulators::quantile_probability;
-    using boost::accumulators::right;
-    using boost::accumulators::stats;
-    using boost::accumulators::tag::tail;
-    using boost::accumulators::tag::tail_quantile;
-    double M = x.rows();
-
-    // size_t cache_size = M/2 + 2;
-    size_t cache_size = M;  // 2 + 2;
-
-    accumulator_set<double, stats<tail_quantile<left> > > acc_left(
-        tail<left>::cache_size = cache_size);
-    accumulator_set<double, stats<tail_quantile<right> > > acc_right(
-        tail<right>::cache_size = cache_size);
-
-    for (int i = 0; i < M; i++) {
-      acc_left(x(i));
-      acc_right(x(i));
-    }
-
     Eigen::VectorXd q(probs.size());
+    std::vector<std::pair<Eigen::Index, int> > positions;
+    positions.reserve(probs.size());
     for (int i = 0; i < probs.size(); i++) {
-      if (probs(i) < 0.5)
-        q(i) = quantile(acc_left, quantile_probability = probs(i));
+      Eigen::Index n = quantile_position(x.size(), probs(i));
+      if (n < 0)
+        q(i) = std::numeric_limits<double>::quiet_NaN();
       else
-        q(i) = quantile(acc_right, quantile_probability = probs(i));
+        positions.emplace_back(n, i);
+    }
+    if (positions.empty())
+      return q;
+    std::sort(positions.begin(), positions.end());
+
+    std::vector<double> draws(x.data(), x.data() + x.size());
+    auto first = draws.begin();
+    for (const auto& position : positions) {
+      auto nth = draws.begin() + position.first;
+      if (nth >= first) {
+        std::nth_element(first, nth, draws.end());
+        first = nth + 1;
+      }
+      q(position.second) = *nth;
     }
     return q;
   }
@@ -247,7 +270,22 @@ class chains {
 
  public:
   explicit chains(const std::vector<std::string>& param_names)
-      : param_names_(param_names) {}
+      : param_names_(param_names), draws_(param_names.size()) {}
+
+  /**
+   * Construct chains that spill their draws to a memory mapped scratch
+   * file, so that runs too long or too wide for memory can be summarized.
+   * The summaries of a parameter read only its column of the file, as
+   * explained for <code>chains_buffer</code>.
+   *
+   * @param param_names names of the parameters
+   * @param spill_file name of the scratch file, which is created and
+   *   removed when the chains are destroyed
+   * @throw std::invalid_argument if the file can not be created
+   */
+  chains(const std::vector<std::string>& param_names,
+         const std::string& spill_file)
+      : param_names_(param_names), draws_(param_names.size(), spill_file) {}
 
   explicit chains(const stan::io::stan_csv& stan_csv)
       : chains(stan_csv.header) {
@@ -255,7 +293,7 @@ class chains {
       add(stan_csv);
   }
 
-  inline int num_chains() const { return samples_.size(); }
+  inline int num_chains() const { return draws_.num_chains(); }
 
   inline int num_params() const { return param_names_.size(); }
 
@@ -281,7 +319,7 @@ class chains {
 
   int warmup(const int chain) const { return warmup_(chain); }
 
-  int num_samples(const int chain) const { return samples_(chain).rows(); }
+  int num_samples(const int chain) const { return draws_.num_draws(chain); }
 
   int num_samples() const {
     int n = 0;
@@ -306,33 +344,8 @@ class chains {
       throw std::invalid_argument(
           "add(chain, sample): number of columns"
           " in sample does not match chains");
-    if (num_chains() == 0 || chain >= num_chains()) {
-      int n = num_chains();
-
-      // Need this block for Windows. conservativeResize
-      // does not keep the references.
-      Eigen::Matrix<Eigen::MatrixXd, Dynamic, 1> samples_copy(num_chains());
-      Eigen::VectorXi warmup_copy(num_chains());
-      for (int i = 0; i < n; i++) {
-        samples_copy(i) = samples_(i);
-        warmup_copy(i) = warmup_(i);
-      }
-
-      samples_.resize(chain + 1);
-      warmup_.resize(chain + 1);
-      for (int i = 0; i < n; i++) {
-        samples_(i) = samples_copy(i);
-        warmup_(i) = warmup_copy(i);
-      }
-      for (int i = n; i < chain + 1; i++) {
-        samples_(i) = Eigen::MatrixXd(0, num_params());
-        warmup_(i) = 0;
-      }
-    }
-    int row = samples_(chain).rows();
-    Eigen::MatrixXd new_samples(row + sample.rows(), num_params());
-    new_samples << samples_(chain), sample;
-    samples_(chain) = new_samples;
+    draws_.append(chain, sample);
+    resize_warmup();
   }
 
   void add(const Eigen::MatrixXd& sample) {
@@ -383,8 +396,77 @@ class chains {
       set_warmup(num_chains() - 1, stan_csv.metadata.num_warmup);
   }
 
+  /**
+   * Parse a Stan CSV file and add its draws as a new chain, reading the
+   * draws straight into the storage of the chains.
+   *
+   * @param[in] in input stream to parse
+   * @param[out] out output stream to send messages
+   * @throw std::invalid_argument if the header does not match the
+   * parameters of the chains
+   */
+  void add(std::istream& in, std::ostream* out) {
+    const int chain = num_chains();
+    stan::io::stan_csv stan_csv
+        = stan::io::stan_csv_reader::parse(in, out, draws_);
+    for (int i = 0; i < num_params(); i++) {
+      if (param_names_[i] != stan_csv.header[i]) {
+        if (num_chains() > chain)
+          draws_.pop_chain();
+        std::stringstream ss;
+        ss << "add(stan_csv): header " << param_names_[i]
+           << " does not match chain's header (" << stan_csv.header[i] << ")";
+        throw std::invalid_argument(ss.str());
+      }
+    }
+    if (num_chains() == chain)
+      return;
+    resize_warmup();
+    if (stan_csv.metadata.save_warmup)
+      set_warmup(chain, stan_csv.metadata.num_warmup);
+  }
+
+  /**
+   * Parse draws written by <code>callbacks::binary_writer</code> and add
+   * them as a new chain, reading them straight into the storage of the
+   * chains a record at a time, so single precision draws are converted
+   * to doubles only as they are stored.
+   *
+   * @param[in] in input stream to parse, opened in binary mode
+   * @throw std::invalid_argument if the stream is not in the binary draws
+   * format or its header does not match the parameters of the chains
+   */
+  void add_binary(std::istream& in) {
+    const int chain = num_chains();
+    stan::io::binary_draws data
+        = stan::io::binary_draws_reader::parse(in, draws_);
+    if (data.header != param_names_) {
+      if (num_chains() > chain)
+        draws_.pop_chain();
+      throw std::invalid_argument(
+          "add_binary(in): header does not match chain's header");
+    }
+    if (num_chains() > chain)
+      resize_warmup();
+  }
+
+  /**
+   * Return a view of the kept draws of a parameter in a chain, which is
+   * valid until draws are next added.
+   */
+  Eigen::Map<const Eigen::VectorXd> kept_draws(const int chain,
+                                               const int index) const {
+    return Eigen::Map<const Eigen::VectorXd>(
+        draws_.data(index, chain) + warmup(chain), num_kept_samples(chain));
+  }
+
+  /**
+   * Return the storage of the draws, warmup included.
+   */
+  const chains_buffer& draws() const { return draws_; }
+
   Eigen::VectorXd samples(const int chain, const int index) const {
-    return samples_(chain).col(index).bottomRows(num_kept_samples(chain));
+    return kept_draws(chain, index);
   }
 
   Eigen::VectorXd samples(const int index) const {
@@ -392,7 +474,7 @@ class chains {
     int start = 0;
     for (int chain = 0; chain < num_chains(); chain++) {
       int n = num_kept_samples(chain);
-      s.middleRows(start, n) = samples_(chain).col(index).bottomRows(n);
+      s.middleRows(start, n) = kept_draws(chain, index);
       start += n;
     }
     return s;
@@ -514,6 +596,25 @@ class chains {
     return quantiles(index(name), probs);
   }
 
+  /**
+   * Return the quantiles of the draws of every parameter, pooled across
+   * the chains, for the specified probabilities.  The parameters are split
+   * over the TBB threads.
+   *
+   * @param probs probabilities
+   * @return matrix with a row for each parameter and a column for each
+   * probability
+   */
+  Eigen::MatrixXd quantiles(const Eigen::VectorXd& probs) const {
+    Eigen::MatrixXd q(num_params(), probs.size());
+    tbb::parallel_for(tbb::blocked_range<int>(0, num_params()),
+                      [&](const tbb::blocked_range<int>& r) {
+                        for (int i = r.begin(); i < r.end(); i++)
+                          q.row(i) = quantiles(samples(i), probs).transpose();
+                      });
+    return q;
+  }
+
   Eigen::Vector2d central_interval(int chain, int index, double prob) const {
     double low_prob = (1 - prob) / 2;
     double high_prob = 1 - low_prob;
@@ -566,8 +667,7 @@ class chains {
     int n_kept_samples = 0;
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
-      draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+      draws[chain] = draws_.data(index, chain) + warmup(chain);
       sizes[chain] = n_kept_samples;
     }
     return analyze::compute_effective_sample_size(draws, sizes);
@@ -584,8 +684,7 @@ class chains {
     int n_kept_samples = 0;
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
-      draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+      draws[chain] = draws_.data(index, chain) + warmup(chain);
       sizes[chain] = n_kept_samples;
     }
     return analyze::compute_split_effective_sample_size(draws, sizes);
@@ -603,8 +702,7 @@ class chains {
     int n_kept_samples = 0;
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
-      draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+      draws[chain] = draws_.data(index, chain) + warmup(chain);
       sizes[chain] = n_kept_samples;
     }
 
@@ -618,8 +716,7 @@ class chains {
     int n_kept_samples = 0;
     for (int chain = 0; chain < n_chains; ++chain) {
       n_kept_samples = num_kept_samples(chain);
-      draws[chain]
-          = samples_(chain).col(index).bottomRows(n_kept_samples).data();
+      draws[chain] = draws_.data(index, chain) + warmup(chain);
       sizes[chain] = n_kept_samples;
     }
 
@@ -0,0 +1,317 @@
+#ifndef STAN_MCMC_CHAINS_BUFFER_HPP
+#define STAN_MCMC_CHAINS_BUFFER_HPP
+
+#include <stan/math/prim.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Contiguous storage for the draws of several chains, laid out with the
+ * draws of a chain innermost, then the chains, then the parameters.
+ *
+ * The draws of each parameter in each chain are contiguous and the
+ * chains of each parameter are a fixed stride apart, so the draws of a
+ * parameter are viewed as a draws by chains matrix without copying.  The
+ * capacities for draws and chains grow geometrically, so appending draws
+ * one at a time costs amortized constant time per draw.
+ *
+ * For runs too long or too wide to hold in memory, the draws can be
+ * spilled to a scratch file that is memory mapped in the same layout, so
+ * each parameter is a contiguous column of the file.  The file pages are
+ * then cached by the operating system rather than held by the process:
+ * computing a summary of a parameter only touches the pages of its
+ * column, and the pages of the other columns can be evicted.  Copies of
+ * a spilled buffer are held in memory.
+ */
+class chains_buffer {
+ public:
+  /**
+   * Construct an empty buffer for draws of the specified number of
+   * parameters.
+   *
+   * @param num_params number of parameters
+   */
+  explicit chains_buffer(int num_params)
+      : num_params_(num_params), draw_capacity_(0), chain_capacity_(0) {}
+
+  /**
+   * Construct an empty buffer for draws of the specified number of
+   * parameters that spills its draws to a memory mapped scratch file,
+   * which it creates, replacing any file of the name, and removes when it
+   * is destroyed.
+   *
+   * @param num_params number of parameters
+   * @param spill_file name of the scratch file
+   * @throw std::invalid_argument if the file can not be created
+   */
+  chains_buffer(int num_params, const std::string& spill_file)
+      : chains_buffer(num_params) {
+    spill_ = make_spill(spill_file, 0);
+  }
+
+  chains_buffer(const chains_buffer& other)
+      : num_params_(other.num_params_),
+        draw_capacity_(other.draw_capacity_),
+        chain_capacity_(other.chain_capacity_),
+        num_draws_(other.num_draws_),
+        data_(other.base(), other.base() + other.size()) {}
+
+  chains_buffer(chains_buffer&& other) = default;
+
+  chains_buffer& operator=(const chains_buffer& other) {
+    if (this != &other)
+      *this = chains_buffer(other);
+    return *this;
+  }
+
+  chains_buffer& operator=(chains_buffer&& other) = default;
+
+  /**
+   * Return true if the draws are spilled to a memory mapped file.
+   */
+  bool spilled() const noexcept { return spill_ != nullptr; }
+
+  int num_params() const noexcept { return num_params_; }
+
+  int num_chains() const noexcept { return num_draws_.size(); }
+
+  int num_draws(int chain) const { return num_draws_[chain]; }
+
+  /**
+   * Distance between the first draws of consecutive chains of a
+   * parameter.
+   */
+  Eigen::Index chain_stride() const noexcept { return draw_capacity_; }
+
+  /**
+   * Return the bytes of storage held by the buffer, which grows
+   * geometrically and so may hold up to twice the draws it has.  The
+   * draws of a spilled buffer are held by the page cache and not counted.
+   */
+  size_t memory_bytes() const noexcept {
+    return data_.capacity() * sizeof(double)
+           + num_draws_.capacity() * sizeof(int);
+  }
+
+  /**
+   * Make sure the buffer has at least the specified number of chains,
+   * adding empty chains as needed.
+   */
+  void resize_chains(int num_chains) {
+    if (num_chains <= this->num_chains())
+      return;
+    reserve(draw_capacity_, num_chains);
+    num_draws_.resize(num_chains, 0);
+  }
+
+  /**
+   * Remove the last chain.
+   */
+  void pop_chain() {
+    if (!num_draws_.empty())
+      num_draws_.pop_back();
+  }
+
+  /**
+   * Append draws to a chain, adding chains as needed.
+   *
+   * @param chain chain to append to
+   * @param draws draws, with one row per draw and one column per parameter
+   * @throw std::invalid_argument if the number of columns is not the
+   * number of parameters
+   */
+  void append(int chain, const Eigen::Ref<const Eigen::MatrixXd>& draws) {
+    if (draws.cols() != num_params_)
+      throw std::invalid_argument(
+          "append(chain, draws): number of columns"
+          " in draws does not match buffer");
+    resize_chains(chain + 1);
+    const Eigen::Index start = num_draws_[chain];
+    reserve_draws(start + draws.rows());
+    for (int param = 0; param < num_params_; ++param)
+      Eigen::Map<Eigen::VectorXd>(column(param, chain) + start, draws.rows())
+          = draws.col(param);
+    num_draws_[chain] += draws.rows();
+  }
+
+  /**
+   * Append one draw to a chain, adding chains as needed, and return a
+   * view of it to be filled in place.
+   *
+   * @param chain chain to append to
+   * @return view of the parameters of the new draw, which is valid until
+   * the buffer grows again
+   */
+  Eigen::Map<Eigen::VectorXd, 0, Eigen::InnerStride<>> append_draw(
+      int chain) {
+    resize_chains(chain + 1);
+    const Eigen::Index draw = num_draws_[chain];
+    reserve_draws(draw + 1);
+    ++num_draws_[chain];
+    return Eigen::Map<Eigen::VectorXd, 0, Eigen::InnerStride<>>(
+        column(0, chain) + draw, num_params_,
+        Eigen::InnerStride<>(chain_capacity_ * draw_capacity_));
+  }
+
+  /**
+   * Return a pointer to the first draw of a parameter in a chain.  The
+   * draws of the chain follow contiguously.
+   */
+  const double* data(int param, int chain) const {
+    return base() + offset(param, chain);
+  }
+
+  /**
+   * Return a view of the draws of a parameter in a chain.
+   */
+  Eigen::Map<const Eigen::VectorXd> draws(int param, int chain) const {
+    return Eigen::Map<const Eigen::VectorXd>(data(param, chain),
+                                             num_draws_[chain]);
+  }
+
+  /**
+   * Return a view of the draws of a parameter in every chain, as a matrix
+   * with one column per chain and as many rows as the shortest chain has
+   * draws.
+   */
+  Eigen::Map<const Eigen::MatrixXd, 0, Eigen::OuterStride<>> draws(
+      int param) const {
+    const int rows
+        = num_draws_.empty()
+              ? 0
+              : *std::min_element(num_draws_.begin(), num_draws_.end());
+    return Eigen::Map<const Eigen::MatrixXd, 0, Eigen::OuterStride<>>(
+        base() + offset(param, 0), rows, num_chains(),
+        Eigen::OuterStride<>(draw_capacity_));
+  }
+
+  /**
+   * Make room for at least the specified number of draws in every chain.
+   */
+  void reserve_draws(Eigen::Index num_draws) {
+    if (num_draws > draw_capacity_)
+      reserve(std::max(num_draws, 2 * draw_capacity_), chain_capacity_);
+  }
+
+ private:
+  // a memory mapped scratch file, removed when it is unmapped
+  struct spill_file {
+    std::string filename;
+    boost::interprocess::mapped_region region;
+
+    ~spill_file() {
+      region = boost::interprocess::mapped_region();
+      std::remove(filename.c_str());
+    }
+
+    double* data() const {
+      return static_cast<double*>(region.get_address());
+    }
+  };
+
+  /**
+   * Create and map a scratch file of the specified number of doubles.
+   */
+  static std::unique_ptr<spill_file> make_spill(const std::string& filename,
+                                                size_t size) {
+    namespace bip = boost::interprocess;
+    std::unique_ptr<spill_file> spill(new spill_file());
+    spill->filename = filename;
+    {
+      std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+      if (size > 0) {
+        file.seekp(size * sizeof(double) - 1);
+        file.put(0);
+      }
+      if (!file)
+        throw std::invalid_argument("chains_buffer: can not create "
+                                    + filename);
+    }
+    if (size > 0) {
+      bip::file_mapping mapping(filename.c_str(), bip::read_write);
+      spill->region = bip::mapped_region(mapping, bip::read_write);
+    }
+    return spill;
+  }
+
+  size_t size() const {
+    return static_cast<size_t>(num_params_) * chain_capacity_
+           * draw_capacity_;
+  }
+
+  const double* base() const {
+    return spill_ ? spill_->data() : data_.data();
+  }
+
+  double* base() { return spill_ ? spill_->data() : data_.data(); }
+
+  Eigen::Index offset(int param, int chain) const {
+    return (param * chain_capacity_ + chain) * draw_capacity_;
+  }
+
+  double* column(int param, int chain) {
+    return base() + offset(param, chain);
+  }
+
+  /**
+   * Grow the capacities to at least the specified numbers of draws and
+   * chains, moving the stored draws to their new positions.
+   */
+  void reserve(Eigen::Index draw_capacity, Eigen::Index chains) {
+    Eigen::Index chain_capacity = chain_capacity_;
+    if (chains > chain_capacity)
+      chain_capacity = std::max(chains, 2 * chain_capacity);
+    if (draw_capacity == draw_capacity_ && chain_capacity == chain_capacity_)
+      return;
+    const size_t grown_size = num_params_ * chain_capacity * draw_capacity;
+    std::unique_ptr<spill_file> grown_spill;
+    std::vector<double> grown;
+    if (spill_)
+      grown_spill = make_spill(spill_->filename + ".grow", grown_size);
+    else
+      grown.resize(grown_size);
+    double* grown_data = spill_ ? grown_spill->data() : grown.data();
+    for (int param = 0; param < num_params_; ++param)
+      for (int chain = 0; chain < num_chains(); ++chain)
+        std::copy_n(data(param, chain), num_draws_[chain],
+                    grown_data
+                        + (param * chain_capacity + chain) * draw_capacity);
+    if (spill_) {
+      // the mapping of the grown file survives its renaming
+      const std::string filename = spill_->filename;
+      spill_.reset();
+      std::rename(grown_spill->filename.c_str(), filename.c_str());
+      grown_spill->filename = filename;
+      spill_ = std::move(grown_spill);
+    } else {
+      data_.swap(grown);
+    }
+    draw_capacity_ = draw_capacity;
+    chain_capacity_ = chain_capacity;
+  }
+
+  int num_params_;
+  Eigen::Index draw_capacity_;   // Draws of a chain that fit
+  Eigen::Index chain_capacity_;  // Chains that fit
+  std::vector<int> num_draws_;   // Draws in each chain
+  std::vector<double> data_;     // Draws, parameter by chain by draw
+  std::unique_ptr<spill_file> spill_;  // Draws, if spilled to a file
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
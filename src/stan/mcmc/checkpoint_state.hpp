@@ -0,0 +1,188 @@
+#ifndef STAN_MCMC_CHECKPOINT_STATE_HPP
+#define STAN_MCMC_CHECKPOINT_STATE_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+namespace internal {
+
+inline std::vector<double> checkpoint_values(const io::var_context& context,
+                                             const std::string& name,
+                                             size_t size) {
+  if (!context.contains_r(name))
+    throw std::invalid_argument("Checkpoint has no value for " + name);
+  std::vector<double> values = context.vals_r(name);
+  if (values.size() != size) {
+    std::stringstream msg;
+    msg << "Checkpoint value " << name << " has " << values.size()
+        << " elements, expecting " << size;
+    throw std::invalid_argument(msg.str());
+  }
+  return values;
+}
+
+// pointers to the protected members of the Welford estimators
+struct welford_var_access : public stan::math::welford_var_estimator {
+  static constexpr double stan::math::welford_var_estimator::*num_samples
+      = &welford_var_access::num_samples_;
+  static constexpr Eigen::VectorXd stan::math::welford_var_estimator::*mean
+      = &welford_var_access::m_;
+  static constexpr Eigen::VectorXd stan::math::welford_var_estimator::*m2
+      = &welford_var_access::m2_;
+};
+
+struct welford_covar_access : public stan::math::welford_covar_estimator {
+  static constexpr double stan::math::welford_covar_estimator::*num_samples
+      = &welford_covar_access::num_samples_;
+  static constexpr Eigen::VectorXd stan::math::welford_covar_estimator::*mean
+      = &welford_covar_access::m_;
+  static constexpr Eigen::MatrixXd stan::math::welford_covar_estimator::*m2
+      = &welford_covar_access::m2_;
+};
+
+}  // namespace internal
+
+/**
+ * Return the scalar of the specified name in a checkpoint.
+ *
+ * @throw std::invalid_argument if the checkpoint has no such scalar
+ */
+inline double read_checkpoint_scalar(const io::var_context& context,
+                                     const std::string& name) {
+  return internal::checkpoint_values(context, name, 1)[0];
+}
+
+/**
+ * Return the vector of the specified name and size in a checkpoint.
+ *
+ * @throw std::invalid_argument if the checkpoint has no such vector
+ */
+inline Eigen::VectorXd read_checkpoint_vector(const io::var_context& context,
+                                              const std::string& name,
+                                              Eigen::Index size) {
+  std::vector<double> values
+      = internal::checkpoint_values(context, name, size);
+  return Eigen::Map<Eigen::VectorXd>(values.data(), size);
+}
+
+/**
+ * Return the matrix of the specified name and size in a checkpoint,
+ * whose values the <code>var_context</code> holds in column-major order.
+ *
+ * @throw std::invalid_argument if the checkpoint has no such matrix
+ */
+inline Eigen::MatrixXd read_checkpoint_matrix(const io::var_context& context,
+                                              const std::string& name,
+                                              Eigen::Index rows,
+                                              Eigen::Index cols) {
+  std::vector<double> values
+      = internal::checkpoint_values(context, name, rows * cols);
+  return Eigen::Map<Eigen::MatrixXd>(values.data(), rows, cols);
+}
+
+/**
+ * Write the state of a Welford variance estimator to a checkpoint, under
+ * keys starting with the specified prefix.
+ */
+inline void write_welford_state(
+    callbacks::structured_writer& writer, const std::string& prefix,
+    const stan::math::welford_var_estimator& estimator) {
+  using access = internal::welford_var_access;
+  writer.write(prefix + "_num_samples", estimator.*access::num_samples);
+  writer.write(prefix + "_mean", estimator.*access::mean);
+  writer.write(prefix + "_m2", estimator.*access::m2);
+}
+
+/**
+ * Restore the state of a Welford variance estimator from a checkpoint.
+ *
+ * @throw std::invalid_argument if the checkpoint has no such state
+ */
+inline void read_welford_state(const io::var_context& context,
+                               const std::string& prefix,
+                               stan::math::welford_var_estimator& estimator) {
+  using access = internal::welford_var_access;
+  const Eigen::Index n = (estimator.*access::mean).size();
+  estimator.*access::num_samples
+      = read_checkpoint_scalar(context, prefix + "_num_samples");
+  estimator.*access::mean
+      = read_checkpoint_vector(context, prefix + "_mean", n);
+  estimator.*access::m2 = read_checkpoint_vector(context, prefix + "_m2", n);
+}
+
+/**
+ * Write the state of a Welford covariance estimator to a checkpoint,
+ * under keys starting with the specified prefix.
+ */
+inline void write_welford_state(
+    callbacks::structured_writer& writer, const std::string& prefix,
+    const stan::math::welford_covar_estimator& estimator) {
+  using access = internal::welford_covar_access;
+  writer.write(prefix + "_num_samples", estimator.*access::num_samples);
+  writer.write(prefix + "_mean", estimator.*access::mean);
+  writer.write(prefix + "_m2", estimator.*access::m2);
+}
+
+/**
+ * Restore the state of a Welford covariance estimator from a checkpoint.
+ *
+ * @throw std::invalid_argument if the checkpoint has no such state
+ */
+inline void read_welford_state(
+    const io::var_context& context, const std::string& prefix,
+    stan::math::welford_covar_estimator& estimator) {
+  using access = internal::welford_covar_access;
+  const Eigen::Index n = (estimator.*access::mean).size();
+  estimator.*access::num_samples
+      = read_checkpoint_scalar(context, prefix + "_num_samples");
+  estimator.*access::mean
+      = read_checkpoint_vector(context, prefix + "_mean", n);
+  estimator.*access::m2
+      = read_checkpoint_matrix(context, prefix + "_m2", n, n);
+}
+
+/**
+ * Write the state of a random number generator to a checkpoint, as the
+ * characters of its textual representation.
+ *
+ * @tparam RNG type of random number generator, which must support the
+ * stream operators
+ */
+template <typename RNG>
+void write_rng_state(callbacks::structured_writer& writer,
+                     const std::string& key, const RNG& rng) {
+  std::stringstream ss;
+  ss << rng;
+  const std::string state = ss.str();
+  writer.write(key, std::vector<int>(state.begin(), state.end()));
+}
+
+/**
+ * Restore the state of a random number generator from a checkpoint.
+ *
+ * @throw std::invalid_argument if the checkpoint has no valid state
+ */
+template <typename RNG>
+void read_rng_state(const io::var_context& context, const std::string& key,
+                    RNG& rng) {
+  if (!context.contains_i(key))
+    throw std::invalid_argument("Checkpoint has no value for " + key);
+  const std::vector<int> chars = context.vals_i(key);
+  std::stringstream ss(std::string(chars.begin(), chars.end()));
+  ss >> rng;
+  if (ss.fail())
+    throw std::invalid_argument("Checkpoint value " + key
+                                + " is not a random number generator state");
+}
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -2,7 +2,11 @@
 #define STAN_MCMC_COVAR_ADAPTATION_HPP
 
 #include <stan/math/prim.hpp>
+#include <stan/mcmc/batched_covar_estimator.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
 #include <stan/mcmc/windowed_adaptation.hpp>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace stan {
@@ -12,7 +16,98 @@ namespace mcmc {
 class covar_adaptation : public windowed_adaptation {
  public:
   explicit covar_adaptation(int n)
-      : windowed_adaptation("covariance"), estimator_(n) {}
+      : windowed_adaptation("covariance"),
+        estimator_(n),
+        pooling_(false),
+        window_complete_(false),
+        estimate_metric_scale_(false),
+        metric_scale_(std::numeric_limits<double>::quiet_NaN()) {}
+
+  /**
+   * When pooling, the end of an adaptation window leaves the estimator
+   * and the metric untouched and only flags the window as complete, so
+   * that the estimates of several chains can be combined with
+   * <code>pool_covariance</code>.
+   *
+   * @param pooling true to defer metric updates to the caller
+   */
+  void set_pooling(bool pooling) { pooling_ = pooling; }
+
+  bool pooling() const noexcept { return pooling_; }
+
+  /**
+   * Return the bytes of storage held by the estimator of the covariance.
+   */
+  size_t memory_bytes() const { return estimator_.memory_bytes(); }
+
+  bool window_complete() const noexcept { return window_complete_; }
+
+  /**
+   * Discard the draws of the current window without updating the
+   * metric, as for a chain restarted from the state of another one part
+   * way through warmup.  The window schedule is left as is.
+   */
+  void discard_window() {
+    estimator_.restart();
+    window_complete_ = false;
+  }
+
+  /**
+   * Set whether each update of the inverse metric also estimates how much
+   * the update changes the stable step size, as
+   * <code>1 / sqrt(lambda)</code> for the smallest eigenvalue
+   * <code>lambda</code> of <code>old^-1 new</code>, which is that change
+   * when the new inverse metric is the covariance of the target.  The
+   * estimate is a generalized eigenproblem solved once per window.
+   *
+   * @param estimate true to estimate the change of step size
+   */
+  void set_estimate_metric_scale(bool estimate) {
+    estimate_metric_scale_ = estimate;
+  }
+
+  /**
+   * Return the change of the stable step size estimated at the last
+   * update of the inverse metric, or NaN if it was not estimated.
+   */
+  double metric_scale() const noexcept { return metric_scale_; }
+
+  /**
+   * Set whether the batched covariance updates are split over the TBB
+   * threads, which pays off from a few hundred dimensions.
+   *
+   * @param parallel true to update in parallel
+   */
+  void set_parallel_estimation(bool parallel) {
+    estimator_.set_parallel(parallel);
+  }
+
+  /**
+   * Write the window schedule and the estimator of the current window
+   * to a checkpoint.
+   *
+   * @param[in,out] writer checkpoint writer
+   */
+  void write_checkpoint(callbacks::structured_writer& writer) const {
+    windowed_adaptation::write_checkpoint(writer);
+    estimator_.write_checkpoint(writer, "covariance_estimator");
+    writer.write("adaptation_window_complete",
+                 static_cast<int>(window_complete_));
+  }
+
+  /**
+   * Restore the window schedule and the estimator of the current window
+   * from a checkpoint.
+   *
+   * @param[in] context checkpoint
+   * @throw std::invalid_argument if the checkpoint lacks a value
+   */
+  void read_checkpoint(const io::var_context& context) {
+    windowed_adaptation::read_checkpoint(context);
+    estimator_.read_checkpoint(context, "covariance_estimator");
+    window_complete_
+        = read_checkpoint_scalar(context, "adaptation_window_complete") != 0;
+  }
 
   bool learn_covariance(Eigen::MatrixXd& covar, const Eigen::VectorXd& q) {
     if (adaptation_window())
@@ -21,20 +116,26 @@ class covar_adaptation : public windowed_adaptation {
     if (end_adaptation_window()) {
       compute_next_window();
 
-      estimator_.sample_covariance(covar);
+      if (pooling_) {
+        window_complete_ = true;
+        ++adapt_window_counter_;
+        return false;
+      }
+
+      metric_scale_ = std::numeric_limits<double>::quiet_NaN();
+      Eigen::MatrixXd prev_covar;
+      if (estimate_metric_scale_)
+        prev_covar = covar;
 
-      double n = static_cast<double>(estimator_.num_samples());
-      covar = (n / (n + 5.0)) * covar
-              + 1e-3 * (5.0 / (n + 5.0))
-                    * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
+      estimator_.sample_covariance(covar);
 
-      if (!covar.allFinite())
-        throw std::runtime_error(
-            "Numerical overflow in metric adaptation. "
-            "This occurs when the sampler encounters extreme values on the "
-            "unconstrained space; this may happen when the posterior density "
-            "function is too wide or improper. "
-            "There may be problems with your model specification.");
+      regularize(estimator_.num_samples(), covar);
+      if (estimate_metric_scale_) {
+        Eigen::GeneralizedSelfAdjointEigenSolver<Eigen::MatrixXd> solver(
+            covar, prev_covar, Eigen::EigenvaluesOnly);
+        if (solver.info() == Eigen::Success)
+          metric_scale_ = 1.0 / std::sqrt(solver.eigenvalues().minCoeff());
+      }
 
       estimator_.restart();
 
@@ -46,8 +147,98 @@ class covar_adaptation : public windowed_adaptation {
     return false;
   }
 
+  /**
+   * Combine the completed windows of several adaptations into a single
+   * regularized covariance estimate and restart their estimators.  The
+   * result is the covariance of the union of the windows' draws.
+   *
+   * @param adaptations adaptations whose windows are pooled
+   * @param[out] covar pooled covariance
+   * @throw std::runtime_error if the pooled estimate is not finite
+   */
+  static void pool_covariance(
+      const std::vector<covar_adaptation*>& adaptations,
+      Eigen::MatrixXd& covar) {
+    pool_covariance(adaptations, covar,
+                    [](double&, Eigen::VectorXd&, Eigen::MatrixXd&) {});
+  }
+
+  /**
+   * Pool the completed windows of several adaptations as above, passing
+   * the count, mean and sum of squared deviations of their draws through
+   * <code>combine_moments(n, mean, m2)</code> first, so that it can
+   * replace them with the moments of the windows of other processes as
+   * well.
+   *
+   * @tparam F type of the callable combining the moments
+   * @param adaptations adaptations whose windows are pooled
+   * @param[out] covar pooled covariance
+   * @param combine_moments callable updating the moments in place
+   * @throw std::runtime_error if the pooled estimate is not finite
+   */
+  template <typename F>
+  static void pool_covariance(
+      const std::vector<covar_adaptation*>& adaptations,
+      Eigen::MatrixXd& covar, F&& combine_moments) {
+    double n = 0;
+    Eigen::VectorXd mean = Eigen::VectorXd::Zero(covar.rows());
+    Eigen::MatrixXd m2 = Eigen::MatrixXd::Zero(covar.rows(), covar.cols());
+    Eigen::VectorXd mean_i(covar.rows());
+    Eigen::MatrixXd covar_i(covar.rows(), covar.cols());
+    for (covar_adaptation* adaptation : adaptations) {
+      double n_i = adaptation->estimator_.num_samples();
+      if (n_i == 0)
+        continue;
+      adaptation->estimator_.sample_mean(mean_i);
+      covar_i.setZero();
+      adaptation->estimator_.sample_covariance(covar_i);
+
+      double n_prev = n;
+      n += n_i;
+      Eigen::VectorXd delta = mean_i - mean;
+      mean += delta * (n_i / n);
+      m2 += covar_i * (n_i - 1.0)
+            + (delta * delta.transpose()) * (n_prev * n_i / n);
+    }
+
+    combine_moments(n, mean, m2);
+    covar = m2 / (n - 1.0);
+    regularize(n, covar);
+
+    for (covar_adaptation* adaptation : adaptations) {
+      adaptation->estimator_.restart();
+      adaptation->window_complete_ = false;
+    }
+  }
+
  protected:
-  stan::math::welford_covar_estimator estimator_;
+  /**
+   * Shrink an estimate from <code>n</code> draws towards a small
+   * multiple of the identity.
+   *
+   * @param n number of draws behind the estimate
+   * @param[in,out] covar covariance estimate
+   * @throw std::runtime_error if the result is not finite
+   */
+  static void regularize(double n, Eigen::MatrixXd& covar) {
+    covar = (n / (n + 5.0)) * covar
+            + 1e-3 * (5.0 / (n + 5.0))
+                  * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
+
+    if (!covar.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
+
+  batched_covar_estimator estimator_;
+  bool pooling_;
+  bool window_complete_;
+  bool estimate_metric_scale_;
+  double metric_scale_;
 };
 
 }  // namespace mcmc
@@ -4,6 +4,7 @@
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/callbacks/structured_writer.hpp>
+#include <stan/mcmc/base_adapter.hpp>
 #include <stan/mcmc/base_mcmc.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
 #include <boost/random/uniform_01.hpp>
@@ -86,8 +87,37 @@ class base_hmc : public base_mcmc {
 
   void seed(const Eigen::VectorXd& q) { z_.q = q; }
 
+  /**
+   * Seed the position along with the log density and its gradient there,
+   * such as those returned by <code>services::util::initialize</code>,
+   * so that the next initialization of the Hamiltonian reuses them
+   * instead of evaluating the gradient again, as long as the position
+   * has not changed.  This is only for Euclidean metrics, whose state at
+   * a position depends on the model only through the potential and its
+   * gradient.
+   *
+   * @param q position
+   * @param log_prob log density at the position, up to a constant, as
+   * from <code>log_prob_grad<true, true></code>
+   * @param gradient gradient of the log density at the position
+   */
+  void seed(const Eigen::VectorXd& q, double log_prob,
+            const Eigen::VectorXd& gradient) {
+    z_.q = q;
+    seed_q_ = q;
+    seed_V_ = -log_prob;
+    seed_g_ = -gradient;
+    has_seed_gradient_ = true;
+  }
+
   void init_hamiltonian(callbacks::logger& logger) {
-    this->hamiltonian_.init(this->z_, logger);
+    if (has_seed_gradient_ && this->z_.q == seed_q_) {
+      this->z_.V = seed_V_;
+      this->z_.g = seed_g_;
+    } else {
+      this->hamiltonian_.init(this->z_, logger);
+    }
+    has_seed_gradient_ = false;
   }
 
   void init_stepsize(callbacks::logger& logger) {
@@ -105,7 +135,7 @@ class base_hmc : public base_mcmc {
       return;
 
     this->hamiltonian_.sample_p(this->z_, this->rand_int_);
-    this->hamiltonian_.init(this->z_, logger);
+    init_hamiltonian(logger);
 
     // Guaranteed to be finite if randomly initialized
     double H0 = this->hamiltonian_.H(this->z_);
@@ -160,6 +190,42 @@ class base_hmc : public base_mcmc {
     this->z_.ps_point::operator=(z_init);
   }
 
+  /**
+   * Initialize the step size from an estimate, such as the step size
+   * adapted to the previous metric rescaled by the change of metric.
+   * The estimate costs one trial leapfrog step instead of the repeated
+   * trial steps of <code>init_stepsize(logger)</code>, which is only run,
+   * starting from the estimate, when the estimate is not positive and
+   * finite or when the acceptance probability of the trial step falls
+   * below the 0.8 that the heuristic stops at.
+   *
+   * @param epsilon estimate of the step size, or NaN for none
+   * @param logger logger for messages
+   * @return <code>true</code> if the estimate was used as it is
+   */
+  bool init_stepsize(double epsilon, callbacks::logger& logger) {
+    if (this->z_.q.size() == 0 || !(epsilon > 0 && epsilon <= 1e7)) {
+      init_stepsize(logger);
+      return false;
+    }
+    this->nom_epsilon_ = epsilon;
+
+    ps_point z_init(this->z_);
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    init_hamiltonian(logger);
+    double H0 = this->hamiltonian_.H(this->z_);
+    this->integrator_.evolve(this->z_, this->hamiltonian_, this->nom_epsilon_,
+                             logger);
+    double h = this->hamiltonian_.H(this->z_);
+    this->z_.ps_point::operator=(z_init);
+
+    if (!(H0 - h >= std::log(0.8))) {
+      init_stepsize(logger);
+      return false;
+    }
+    return true;
+  }
+
   /**
    * Gets the current point in the (unconstrained) parameter space.
    *
@@ -192,6 +258,27 @@ class base_hmc : public base_mcmc {
 
   double get_stepsize_jitter() const noexcept { return this->epsilon_jitter_; }
 
+  void set_gradient_timing(bool timing) {
+    this->hamiltonian_.set_gradient_timing(timing);
+  }
+
+  stan::model::gradient_stats get_gradient_stats() {
+    return this->hamiltonian_.get_gradient_stats();
+  }
+
+  void write_rejection_summary(callbacks::logger& logger) {
+    this->hamiltonian_.write_rejection_summary(logger);
+  }
+
+  size_t memory_bytes() const {
+    size_t bytes = this->z_.memory_bytes()
+                   + (seed_q_.size() + seed_g_.size()) * sizeof(double);
+    // the adaptive samplers are also adapters
+    if (const base_adapter* adapter = dynamic_cast<const base_adapter*>(this))
+      bytes += adapter->memory_bytes();
+    return bytes;
+  }
+
   void sample_stepsize() {
     this->epsilon_ = this->nom_epsilon_;
     if (this->epsilon_jitter_)
@@ -212,6 +299,12 @@ class base_hmc : public base_mcmc {
   double nom_epsilon_;
   double epsilon_;
   double epsilon_jitter_;
+
+  // potential and gradient given by seed, until used
+  Eigen::VectorXd seed_q_;
+  Eigen::VectorXd seed_g_;
+  double seed_V_ = 0;
+  bool has_seed_gradient_ = false;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,239 @@
+#ifndef STAN_MCMC_HMC_DR_HMC_BASE_DR_HMC_HPP
+#define STAN_MCMC_HMC_DR_HMC_BASE_DR_HMC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/static/base_static_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Delayed rejection Hamiltonian Monte Carlo using the endpoint of
+ * trajectories with a static integration time.
+ *
+ * A rejected proposal is retried from the same initial point and
+ * momentum with the step size divided by the reduction factor and as
+ * many more steps, keeping the integration time, for up to the number of
+ * stages.  In a funnel the first stage takes the step size suited to the
+ * bulk and the later stages those suited to the neck, instead of one
+ * step size small enough for both.
+ *
+ * Each proposal flips the momentum of the end of its trajectory, so that
+ * a stage is an involution, and the stage k proposal <code>y</code> from
+ * <code>x</code> is accepted with probability
+ *
+ * <code>min(1, pi(y) prod_{j < k} (1 - a_j(y))
+ *                / (pi(x) prod_{j < k} (1 - a_j(x))))</code>,
+ *
+ * where <code>a_j(y)</code> is the probability of accepting the stage j
+ * proposal from <code>y</code>, computed along the ghost trajectories
+ * from <code>y</code>.  The chain is then reversible with respect to the
+ * target.  The stage k proposal costs <code>L r^k</code> gradients and
+ * its ghosts as much as the stages before it from the proposal, so the
+ * cost grows exponentially with the stages and only a few are useful.
+ *
+ * The acceptance statistic is that of the first stage, so that step size
+ * adaptation tunes the first stage as it would static HMC, and the later
+ * stages only rescue its rejections.
+ */
+template <class Model, template <class, class> class Hamiltonian,
+          template <class> class Integrator, class BaseRNG>
+class base_dr_hmc
+    : public base_static_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
+ public:
+  base_dr_hmc(const Model& model, BaseRNG& rng)
+      : base_static_hmc<Model, Hamiltonian, Integrator, BaseRNG>(model, rng),
+        num_stages_(3),
+        stepsize_reduction_(2),
+        stage_(0),
+        n_leapfrog_(0) {}
+
+  ~base_dr_hmc() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    this->sample_stepsize();
+
+    this->seed(init_sample.cont_params());
+
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    this->hamiltonian_.init(this->z_, logger);
+
+    ps_point z_init(this->z_);
+    double H0 = this->hamiltonian_.H(this->z_);
+
+    n_leapfrog_ = 0;
+    stage_ = 0;
+    double accept_stat = 0;
+    // log probability of the earlier stages all rejecting
+    double log_reject = 0;
+
+    for (int k = 0; k < num_stages_; ++k) {
+      double h = propose(k, z_init, logger);
+      ps_point z_propose(this->z_);
+
+      double log_accept
+          = log_accept_prob(k, H0, log_reject, z_propose, h, logger);
+      if (k == 0)
+        accept_stat = std::exp(log_accept);
+
+      if (log_accept == 0 || this->rand_uniform_() < std::exp(log_accept)) {
+        this->z_.ps_point::operator=(z_propose);
+        stage_ = k + 1;
+        break;
+      }
+      log_reject += stan::math::log1m_exp(log_accept);
+    }
+
+    if (stage_ == 0)
+      this->z_.ps_point::operator=(z_init);
+
+    this->energy_ = this->hamiltonian_.H(this->z_);
+    return sample(this->z_.q, -this->hamiltonian_.V(this->z_), accept_stat);
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    base_static_hmc<Model, Hamiltonian, Integrator,
+                    BaseRNG>::get_sampler_param_names(names);
+    names.push_back("stage__");
+    names.push_back("n_leapfrog__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    base_static_hmc<Model, Hamiltonian, Integrator,
+                    BaseRNG>::get_sampler_params(values);
+    values.push_back(stage_);
+    values.push_back(n_leapfrog_);
+  }
+
+  /**
+   * Set the maximum number of proposals of a transition; one makes the
+   * sampler static HMC.
+   *
+   * @param n number of stages, ignored if not positive
+   */
+  void set_num_stages(int n) {
+    if (n > 0)
+      num_stages_ = n;
+  }
+
+  int get_num_stages() const noexcept { return num_stages_; }
+
+  /**
+   * Set the factor by which each stage divides the step size of the
+   * stage before it.
+   *
+   * @param r reduction factor, ignored unless greater than one
+   */
+  void set_stepsize_reduction(double r) {
+    if (r > 1)
+      stepsize_reduction_ = r;
+  }
+
+  double get_stepsize_reduction() const noexcept {
+    return stepsize_reduction_;
+  }
+
+  /**
+   * Return the stage of the proposal accepted by the last transition,
+   * from one, or zero if every stage rejected.
+   */
+  int get_stage() const noexcept { return stage_; }
+
+  /**
+   * Return the number of leapfrog steps of the last transition, ghost
+   * trajectories included.
+   */
+  int get_n_leapfrog() const noexcept { return n_leapfrog_; }
+
+ protected:
+  int num_stages_;
+  double stepsize_reduction_;
+  int stage_;
+  int n_leapfrog_;
+
+  /**
+   * Integrate the trajectory of the specified stage from the specified
+   * point into <code>z_</code> and flip its momentum.
+   *
+   * @param k stage, from zero
+   * @param z_start initial point
+   * @param logger logger for messages
+   * @return Hamiltonian of the proposal, infinite if not finite
+   */
+  double propose(int k, const ps_point& z_start, callbacks::logger& logger) {
+    const double scale = std::pow(stepsize_reduction_, k);
+    const double epsilon = this->epsilon_ / scale;
+    const int n_steps = std::max(1, static_cast<int>(std::round(
+                                        this->L_ * scale)));
+
+    this->z_.ps_point::operator=(z_start);
+    for (int i = 0; i < n_steps; ++i)
+      this->integrator_.evolve(this->z_, this->hamiltonian_, epsilon,
+                               logger);
+    n_leapfrog_ += n_steps;
+    this->z_.p = -this->z_.p;
+
+    double h = this->hamiltonian_.H(this->z_);
+    if (std::isnan(h))
+      h = std::numeric_limits<double>::infinity();
+    return h;
+  }
+
+  /**
+   * Return the log probability of accepting the stage k proposal from a
+   * point whose earlier stages all rejected.
+   *
+   * @param k stage, from zero
+   * @param H_start Hamiltonian of the initial point
+   * @param log_reject_start log probability of the earlier stages from
+   *   the initial point all rejecting
+   * @param z_propose proposal
+   * @param H_propose Hamiltonian of the proposal
+   * @param logger logger for messages
+   */
+  double log_accept_prob(int k, double H_start, double log_reject_start,
+                         const ps_point& z_propose, double H_propose,
+                         callbacks::logger& logger) {
+    if (std::isinf(H_propose))
+      return -std::numeric_limits<double>::infinity();
+    const double log_reject_ghost = log_reject_prob(k, z_propose, H_propose,
+                                                    logger);
+    if (std::isinf(log_reject_ghost))
+      return -std::numeric_limits<double>::infinity();
+    return std::min(0.0,
+                    H_start - H_propose + log_reject_ghost - log_reject_start);
+  }
+
+  /**
+   * Return the log probability of the first stages from a point all
+   * rejecting, following their trajectories.
+   *
+   * @param n number of stages
+   * @param z_start initial point
+   * @param H_start Hamiltonian of the initial point
+   * @param logger logger for messages
+   */
+  double log_reject_prob(int n, const ps_point& z_start, double H_start,
+                         callbacks::logger& logger) {
+    double log_reject = 0;
+    for (int k = 0; k < n; ++k) {
+      double h = propose(k, z_start, logger);
+      ps_point z_ghost(this->z_);
+      log_reject += stan::math::log1m_exp(
+          log_accept_prob(k, H_start, log_reject, z_ghost, h, logger));
+      if (std::isinf(log_reject))
+        break;
+    }
+    return log_reject;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
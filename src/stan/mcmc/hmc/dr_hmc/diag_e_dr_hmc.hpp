@@ -0,0 +1,26 @@
+#ifndef STAN_MCMC_HMC_DR_HMC_DIAG_E_DR_HMC_HPP
+#define STAN_MCMC_HMC_DR_HMC_DIAG_E_DR_HMC_HPP
+
+#include <stan/mcmc/hmc/dr_hmc/base_dr_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_metric.hpp>
+#include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Delayed rejection Hamiltonian Monte Carlo implementation using the
+ * endpoint of trajectories with a static integration time with a
+ * Gaussian-Euclidean disintegration and diagonal metric
+ */
+template <class Model, class BaseRNG>
+class diag_e_dr_hmc
+    : public base_dr_hmc<Model, diag_e_metric, expl_leapfrog, BaseRNG> {
+ public:
+  diag_e_dr_hmc(const Model& model, BaseRNG& rng)
+      : base_dr_hmc<Model, diag_e_metric, expl_leapfrog, BaseRNG>(model, rng) {}
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
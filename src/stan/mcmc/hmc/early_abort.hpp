@@ -0,0 +1,137 @@
+#ifndef STAN_MCMC_HMC_EARLY_ABORT_HPP
+#define STAN_MCMC_HMC_EARLY_ABORT_HPP
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Threshold on the energy error of the states of a trajectory beyond
+ * which a sampler that doubles its trajectories, such as NUTS, abandons
+ * the subtree it is building, as it does for a divergence, rather than
+ * spending the rest of its gradients on states whose multinomial weight
+ * \f$ \exp(H_0 - H) \f$ is negligible.
+ *
+ * The threshold is <code>multiplier</code> times an exponentially
+ * weighted average of the largest energy error of each transition, and
+ * never below <code>min_threshold</code>.  It is learned only until
+ * <code>complete_adaptation</code>, which the adaptive samplers call at
+ * the end of warmup, and stays fixed afterwards, so that the sampling
+ * transitions keep a fixed rule of the same kind as the divergence
+ * threshold.  The error of an abandoned state is counted in the average
+ * too, so a trajectory that keeps drifting raises the threshold rather
+ * than lowering it.  A multiplier of zero gives the fixed threshold
+ * <code>min_threshold</code> throughout.
+ *
+ * An abandoned subtree loses states of weight at most
+ * \f$ \exp(-\mathrm{min\_threshold}) \f$ relative to the initial state,
+ * so the default minimum of 20 keeps the bias from the abandoned states
+ * below one part in \f$ 10^8 \f$.
+ */
+class early_abort {
+ public:
+  /**
+   * Construct a threshold that never aborts a subtree.
+   */
+  early_abort() = default;
+
+  /**
+   * @param min_threshold smallest threshold on the energy error
+   * @param multiplier multiple of the average largest energy error of a
+   *   transition that is the threshold, or zero for a fixed threshold
+   * @param decay weight of the latest transition in the average
+   * @throw std::invalid_argument if the minimum is not positive, the
+   *   multiplier is negative, or the decay is not in (0, 1]
+   */
+  early_abort(double min_threshold, double multiplier, double decay = 0.05)
+      : enabled_(true),
+        min_threshold_(min_threshold),
+        multiplier_(multiplier),
+        decay_(decay) {
+    if (!(min_threshold > 0))
+      throw std::invalid_argument(
+          "early abort threshold must be positive");
+    if (!(multiplier >= 0))
+      throw std::invalid_argument(
+          "early abort multiplier must be non-negative");
+    if (!(decay > 0 && decay <= 1))
+      throw std::invalid_argument("early abort decay must be in (0, 1]");
+  }
+
+  /**
+   * Return whether subtrees are ever aborted.
+   */
+  bool enabled() const noexcept { return enabled_; }
+
+  /**
+   * Return the current threshold on the energy error, infinite when
+   * disabled.
+   */
+  double threshold() const noexcept {
+    if (!enabled_)
+      return std::numeric_limits<double>::infinity();
+    if (num_transitions_ == 0)
+      return multiplier_ > 0 ? std::numeric_limits<double>::infinity()
+                             : min_threshold_;
+    return std::max(min_threshold_, multiplier_ * average_);
+  }
+
+  /**
+   * Return whether a state of the given energy error dooms its subtree.
+   *
+   * @param delta_H energy error of the state, its Hamiltonian less the
+   *   one of the initial state
+   */
+  bool doomed(double delta_H) const noexcept { return delta_H > threshold(); }
+
+  /**
+   * Record the largest energy error of a transition, learning from it
+   * until the end of adaptation.
+   *
+   * @param max_delta_H largest energy error of the states of the
+   *   transition, capped by the caller at its divergence threshold
+   * @param aborted whether the threshold ended the trajectory
+   */
+  void record(double max_delta_H, bool aborted) noexcept {
+    num_aborted_ += aborted;
+    if (!enabled_ || !learning_ || multiplier_ == 0)
+      return;
+    max_delta_H = std::max(max_delta_H, 0.0);
+    if (num_transitions_ == 0)
+      average_ = max_delta_H;
+    else
+      average_ += decay_ * (max_delta_H - average_);
+    ++num_transitions_;
+  }
+
+  /**
+   * Stop learning the threshold, which stays fixed from then on.
+   */
+  void complete_adaptation() noexcept { learning_ = false; }
+
+  bool learning() const noexcept { return learning_; }
+  double min_threshold() const noexcept { return min_threshold_; }
+  double multiplier() const noexcept { return multiplier_; }
+
+  /**
+   * Return the number of transitions the threshold ended so far.
+   */
+  long num_aborted() const noexcept { return num_aborted_; }
+
+ private:
+  bool enabled_ = false;
+  bool learning_ = true;
+  double min_threshold_ = 0;
+  double multiplier_ = 0;
+  double decay_ = 0.05;
+  double average_ = 0;
+  long num_transitions_ = 0;
+  long num_aborted_ = 0;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,105 @@
+#ifndef STAN_MCMC_HMC_GRADIENT_BUDGET_HPP
+#define STAN_MCMC_HMC_GRADIENT_BUDGET_HPP
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Budget of gradient evaluations of the transitions of a sampler that
+ * doubles its trajectories, such as NUTS and XHMC, per transition and
+ * over the whole run.
+ *
+ * The budget is spent in whole doublings: a transition only goes on to a
+ * doubling whose leapfrog steps all fit in what is left of its budget.
+ * With a depth of at most <code>d</code> a trajectory takes at most
+ * \f$ 2^d - 1 \f$ steps, so the budget becomes a limit on the tree depth
+ * of each transition and a capped trajectory is still a valid one of a
+ * smaller maximum depth, never one cut off in the middle of a subtree.
+ * The per-transition budget alone thus leaves the sampler exact.  The
+ * per-run budget makes the limit of a transition depend on the steps of
+ * the earlier ones, which biases the draws slightly once it binds, and
+ * so it is meant for bounding latency rather than for inference.
+ *
+ * Every transition still takes its first step, so a spent run budget
+ * leaves transitions of a single step rather than none.
+ */
+class gradient_budget {
+ public:
+  /**
+   * Construct a budget that never caps a transition.
+   */
+  gradient_budget() = default;
+
+  /**
+   * @param per_transition largest number of leapfrog steps of a
+   *   transition, or zero for no limit
+   * @param per_run number of leapfrog steps of all of the transitions of
+   *   the run, or zero for no limit
+   * @throw std::invalid_argument if a budget is negative
+   */
+  gradient_budget(long per_transition, long per_run)
+      : per_transition_(per_transition), per_run_(per_run) {
+    if (per_transition < 0 || per_run < 0)
+      throw std::invalid_argument("gradient budgets must be non-negative");
+  }
+
+  /**
+   * Return whether there is any limit.
+   */
+  bool enabled() const noexcept { return per_transition_ > 0 || per_run_ > 0; }
+
+  /**
+   * Return the largest tree depth the next transition may reach, at least
+   * one.
+   *
+   * @param max_depth maximum tree depth of the sampler
+   */
+  int max_depth(int max_depth) const noexcept {
+    if (!enabled())
+      return max_depth;
+    long cap = per_transition_ > 0 ? per_transition_ : per_run_;
+    if (per_run_ > 0)
+      cap = std::min(cap, per_run_ - spent_);
+    int depth = 1;
+    while (depth < max_depth && (2L << depth) - 1 <= cap)
+      ++depth;
+    return std::min(depth, max_depth);
+  }
+
+  /**
+   * Record the steps of a transition.
+   *
+   * @param n_leapfrog number of leapfrog steps of the transition
+   * @param capped whether the budget ended its trajectory
+   */
+  void record(int n_leapfrog, bool capped) noexcept {
+    spent_ += n_leapfrog;
+    num_capped_ += capped;
+  }
+
+  long per_transition() const noexcept { return per_transition_; }
+  long per_run() const noexcept { return per_run_; }
+
+  /**
+   * Return the number of leapfrog steps of the transitions so far.
+   */
+  long spent() const noexcept { return spent_; }
+
+  /**
+   * Return the number of transitions the budget ended so far.
+   */
+  long num_capped() const noexcept { return num_capped_; }
+
+ private:
+  long per_transition_ = 0;
+  long per_run_ = 0;
+  long spent_ = 0;
+  long num_capped_ = 0;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
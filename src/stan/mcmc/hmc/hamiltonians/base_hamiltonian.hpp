@@ -3,11 +3,10 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
-#include <stan/model/gradient.hpp>
-#include <stan/model/log_prob_propto.hpp>
+#include <stan/mcmc/hmc/hamiltonians/rejection_reporter.hpp>
+#include <stan/model/gradient_evaluator.hpp>
 #include <iostream>
 #include <limits>
-#include <stdexcept>
 #include <vector>
 
 namespace stan {
@@ -16,7 +15,8 @@ namespace mcmc {
 template <class Model, class Point, class BaseRNG>
 class base_hamiltonian {
  public:
-  explicit base_hamiltonian(const Model& model) : model_(model) {}
+  explicit base_hamiltonian(const Model& model)
+      : model_(model), gradient_(model) {}
 
   ~base_hamiltonian() {}
 
@@ -45,25 +45,60 @@ class base_hamiltonian {
 
   virtual void sample_p(Point& z, BaseRNG& rng) = 0;
 
+  /**
+   * Take the momentum step <code>p -= kick * dphi_dq</code> followed by
+   * the position step <code>q += drift * dtau_dp</code> of an explicit
+   * leapfrog.  Metrics whose steps are elementwise override this with a
+   * single pass over the point.
+   */
+  virtual void kick_drift(Point& z, double kick, double drift,
+                          callbacks::logger& logger) {
+    z.p -= kick * this->dphi_dq(z, logger);
+    z.q += drift * this->dtau_dp(z);
+  }
+
+  /**
+   * Return the Hamiltonian at the point and write the sharp momentum
+   * <code>dtau_dp</code>, which metrics override to share the work of
+   * the kinetic energy and the sharp momentum.
+   *
+   * @param z point
+   * @param[out] p_sharp sharp momentum
+   * @return Hamiltonian
+   */
+  virtual double H_dtau_dp(Point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = this->dtau_dp(z);
+    return H(z);
+  }
+
   void init(Point& z, callbacks::logger& logger) {
     this->update_potential_gradient(z, logger);
   }
 
+  /**
+   * Update the potential at the point, or make it infinite to reject the
+   * proposal if the log density can not be evaluated there.  Rejections
+   * are reported through the rejection reporter of the Hamiltonian.
+   */
   void update_potential(Point& z, callbacks::logger& logger) {
-    try {
-      z.V = -stan::model::log_prob_propto<true>(model_, z.q);
-    } catch (const std::domain_error& e) {
-      this->write_error_msg_(e, logger);
+    if (gradient_.try_log_prob(z.q, z.V, logger)) {
+      z.V = -z.V;
+    } else {
+      rejections_.report(gradient_.error_message(), logger);
       z.V = std::numeric_limits<double>::infinity();
     }
   }
 
+  /**
+   * Update the potential and its gradient at the point, or make the
+   * potential infinite to reject the proposal if the log density can not
+   * be evaluated there.  See <code>update_potential</code>.
+   */
   void update_potential_gradient(Point& z, callbacks::logger& logger) {
-    try {
-      stan::model::gradient(model_, z.q, z.V, z.g, logger);
+    if (gradient_.try_gradient(z.q, z.V, z.g, logger)) {
       z.V = -z.V;
-    } catch (const std::domain_error& e) {
-      this->write_error_msg_(e, logger);
+    } else {
+      rejections_.report(gradient_.error_message(), logger);
       z.V = std::numeric_limits<double>::infinity();
     }
     z.g = -z.g;
@@ -77,23 +112,28 @@ class base_hamiltonian {
     update_potential_gradient(z, logger);
   }
 
- protected:
-  const Model& model_;
+  void set_gradient_timing(bool timing) { gradient_.set_timing(timing); }
 
-  void write_error_msg_(const std::exception& e, callbacks::logger& logger) {
-    logger.error(
-        "Informational Message: The current Metropolis proposal "
-        "is about to be rejected because of the following issue:");
-    logger.error(e.what());
-    logger.error(
-        "If this warning occurs sporadically, such as for highly "
-        "constrained variable types like covariance matrices, "
-        "then the sampler is fine,");
-    logger.error(
-        "but if this warning occurs often then your model may be "
-        "either severely ill-conditioned or misspecified.");
-    logger.error("");
+  const stan::model::gradient_stats& get_gradient_stats() const noexcept {
+    return gradient_.stats();
   }
+
+  const rejection_reporter& get_rejections() const noexcept {
+    return rejections_;
+  }
+
+  /**
+   * Write the counts of the rejections since the last summary and start
+   * counting afresh.
+   */
+  void write_rejection_summary(callbacks::logger& logger) {
+    rejections_.write_summary(logger);
+  }
+
+ protected:
+  const Model& model_;
+  stan::model::gradient_evaluator<Model> gradient_;
+  rejection_reporter rejections_;
 };
 
 }  // namespace mcmc
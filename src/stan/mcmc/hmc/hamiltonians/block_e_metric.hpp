@@ -0,0 +1,105 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_BLOCK_E_METRIC_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_BLOCK_E_METRIC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
+#include <stan/mcmc/hmc/hamiltonians/block_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Euclidean manifold with a block diagonal dense metric.
+ *
+ * Each block is handled as by <code>dense_e_metric</code>, with the
+ * Cholesky factor of the block cached in the point, so products with the
+ * inverse metric and momentum draws cost O(<code>sum b_i^2</code>)
+ * operations for blocks of sizes <code>b_i</code>.
+ */
+template <class Model, class BaseRNG>
+class block_e_metric : public base_hamiltonian<Model, block_e_point, BaseRNG> {
+ public:
+  explicit block_e_metric(const Model& model)
+      : base_hamiltonian<Model, block_e_point, BaseRNG>(model) {}
+
+  double T(block_e_point& z) {
+    // p^T L L^T p with the inverse metric L L^T of each block
+    double T = 0;
+    Eigen::Index start = 0;
+    for (const auto& llt : z.inv_e_metric_llt_) {
+      const Eigen::Index size = llt.rows();
+      T += (llt.matrixU() * z.p.segment(start, size)).squaredNorm();
+      start += size;
+    }
+    return 0.5 * T;
+  }
+
+  double tau(block_e_point& z) { return T(z); }
+
+  double phi(block_e_point& z) { return this->V(z); }
+
+  double dG_dt(block_e_point& z, callbacks::logger& logger) {
+    return 2 * T(z) - z.q.dot(z.g);
+  }
+
+  Eigen::VectorXd dtau_dq(block_e_point& z, callbacks::logger& logger) {
+    return Eigen::VectorXd::Zero(this->model_.num_params_r());
+  }
+
+  Eigen::VectorXd dtau_dp(block_e_point& z) {
+    Eigen::VectorXd p_sharp(z.p.size());
+    multiply_inv_metric(z, p_sharp);
+    return p_sharp;
+  }
+
+  Eigen::VectorXd dphi_dq(block_e_point& z, callbacks::logger& logger) {
+    return z.g;
+  }
+
+  void kick_drift(block_e_point& z, double kick, double drift,
+                  callbacks::logger& logger) {
+    z.p -= kick * z.g;
+    Eigen::Index start = 0;
+    for (const Eigen::MatrixXd& block : z.inv_e_metric_) {
+      const Eigen::Index size = block.rows();
+      z.q.segment(start, size).noalias()
+          += drift * (block * z.p.segment(start, size));
+      start += size;
+    }
+  }
+
+  double H_dtau_dp(block_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp.resize(z.p.size());
+    multiply_inv_metric(z, p_sharp);
+    return 0.5 * z.p.dot(p_sharp) + this->V(z);
+  }
+
+  void sample_p(block_e_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
+    Eigen::Index start = 0;
+    for (const auto& llt : z.inv_e_metric_llt_) {
+      const Eigen::Index size = llt.rows();
+      auto p = z.p.segment(start, size);
+      llt.matrixU().solveInPlace(p);
+      start += size;
+    }
+  }
+
+ private:
+  static void multiply_inv_metric(const block_e_point& z,
+                                  Eigen::VectorXd& p_sharp) {
+    Eigen::Index start = 0;
+    for (const Eigen::MatrixXd& block : z.inv_e_metric_) {
+      const Eigen::Index size = block.rows();
+      p_sharp.segment(start, size).noalias()
+          = block * z.p.segment(start, size);
+      start += size;
+    }
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,149 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_BLOCK_E_POINT_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_BLOCK_E_POINT_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Point in a phase space with a base Euclidean manifold whose inverse
+ * mass matrix is block diagonal: each block is a dense matrix over a run
+ * of consecutive parameters, such as the elements of one parameter of
+ * the model, and parameters of different blocks are uncorrelated.
+ *
+ * Only O(<code>sum b_i^2</code>) memory is used for blocks of sizes
+ * <code>b_i</code>, against O(<code>n^2</code>) for a dense metric.
+ */
+class block_e_point : public ps_point {
+ public:
+  /**
+   * Dense blocks of the inverse mass matrix, along its diagonal.
+   */
+  std::vector<Eigen::MatrixXd> inv_e_metric_;
+
+  /**
+   * Cholesky factorizations of the blocks of the inverse mass matrix,
+   * which are only recomputed by <code>set_metric</code> and
+   * <code>update_metric_factor</code>.
+   */
+  std::vector<Eigen::LLT<Eigen::MatrixXd>> inv_e_metric_llt_;
+
+  /**
+   * Construct a point in n-dimensional phase space with the identity
+   * matrix as inverse mass matrix, in blocks of one parameter.
+   *
+   * @param n number of dimensions
+   */
+  explicit block_e_point(int n)
+      : ps_point(n), inv_e_metric_(n, Eigen::MatrixXd::Identity(1, 1)) {
+    update_metric_factor();
+  }
+
+  /**
+   * Set the inverse mass matrix to the identity, in blocks of the
+   * specified sizes.
+   *
+   * @param block_sizes number of parameters of each block
+   * @throw std::invalid_argument if the sizes are not positive or do not
+   * add up to the number of dimensions
+   */
+  void set_block_sizes(const std::vector<int>& block_sizes) {
+    std::vector<Eigen::MatrixXd> inv_e_metric;
+    inv_e_metric.reserve(block_sizes.size());
+    for (int size : block_sizes) {
+      if (size <= 0)
+        throw std::invalid_argument(
+            "Sizes of the metric blocks must be positive");
+      inv_e_metric.push_back(Eigen::MatrixXd::Identity(size, size));
+    }
+    set_metric(inv_e_metric);
+  }
+
+  /**
+   * Set the blocks of the inverse mass matrix.
+   *
+   * @param inv_e_metric square blocks along the diagonal
+   * @throw std::invalid_argument if the blocks are not square or do not
+   * add up to the number of dimensions
+   */
+  void set_metric(const std::vector<Eigen::MatrixXd>& inv_e_metric) {
+    Eigen::Index n = 0;
+    for (const Eigen::MatrixXd& block : inv_e_metric) {
+      if (block.rows() != block.cols())
+        throw std::invalid_argument("Blocks of the metric must be square");
+      n += block.rows();
+    }
+    if (n != q.size())
+      throw std::invalid_argument(
+          "Blocks of the metric cover " + std::to_string(n)
+          + " parameters, but there are " + std::to_string(q.size()));
+    inv_e_metric_ = inv_e_metric;
+    update_metric_factor();
+  }
+
+  /**
+   * Return the number of parameters of each block.
+   */
+  std::vector<int> block_sizes() const {
+    std::vector<int> sizes;
+    sizes.reserve(inv_e_metric_.size());
+    for (const Eigen::MatrixXd& block : inv_e_metric_)
+      sizes.push_back(block.rows());
+    return sizes;
+  }
+
+  /**
+   * Recompute the Cholesky factorizations of the blocks.  This must be
+   * called whenever <code>inv_e_metric_</code> is changed other than
+   * through <code>set_metric</code>, as adaptation does.
+   */
+  void update_metric_factor() {
+    inv_e_metric_llt_.resize(inv_e_metric_.size());
+    for (size_t b = 0; b < inv_e_metric_.size(); ++b)
+      inv_e_metric_llt_[b].compute(inv_e_metric_[b]);
+  }
+
+  /**
+   * Write the elements of each block of the inverse mass matrix to
+   * strings and hand them off to the writer.
+   *
+   * @param writer Stan writer callback
+   */
+  inline void write_metric(stan::callbacks::writer& writer) {
+    writer("Elements of inverse mass matrix blocks:");
+    if (inv_e_metric_.empty())
+      writer("");
+    for (size_t b = 0; b < inv_e_metric_.size(); ++b) {
+      writer("Block " + std::to_string(b + 1) + ":");
+      const Eigen::MatrixXd& block = inv_e_metric_[b];
+      for (int i = 0; i < block.rows(); ++i) {
+        std::stringstream block_ss;
+        block_ss << block(i, 0);
+        for (int j = 1; j < block.cols(); ++j)
+          block_ss << ", " << block(i, j);
+        writer(block_ss.str());
+      }
+    }
+  }
+
+  inline std::string metric_type() { return "block_e"; }
+
+  size_t memory_bytes() const {
+    // each Cholesky factor is a matrix the size of its block
+    size_t size = 0;
+    for (const Eigen::MatrixXd& block : inv_e_metric_)
+      size += block.size();
+    return ps_point::memory_bytes() + 2 * size * sizeof(double);
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
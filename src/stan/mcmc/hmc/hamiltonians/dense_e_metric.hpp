@@ -5,13 +5,18 @@
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
 #include <stan/mcmc/hmc/hamiltonians/dense_e_point.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random/normal_distribution.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
 
 namespace stan {
 namespace mcmc {
 
-// Euclidean manifold with dense metric
+/**
+ * Euclidean manifold with dense metric.
+ *
+ * The kinetic energy and the momentum draws use the Cholesky factor of
+ * the inverse metric cached in the point, so they cost a triangular
+ * product or solve instead of a full product or a factorization.
+ */
 template <class Model, class BaseRNG>
 class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
  public:
@@ -19,7 +24,8 @@ class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
       : base_hamiltonian<Model, dense_e_point, BaseRNG>(model) {}
 
   double T(dense_e_point& z) {
-    return 0.5 * z.p.transpose() * z.inv_e_metric_ * z.p;
+    // p^T L L^T p with the inverse metric L L^T
+    return 0.5 * (z.inv_e_metric_llt_.matrixU() * z.p).squaredNorm();
   }
 
   double tau(dense_e_point& z) { return T(z); }
@@ -40,17 +46,22 @@ class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
     return z.g;
   }
 
-  void sample_p(dense_e_point& z, BaseRNG& rng) {
-    typedef typename stan::math::index_type<Eigen::VectorXd>::type idx_t;
-    boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
-        rand_dense_gaus(rng, boost::normal_distribution<>());
-
-    Eigen::VectorXd u(z.p.size());
+  void kick_drift(dense_e_point& z, double kick, double drift,
+                  callbacks::logger& logger) {
+    z.p -= kick * z.g;
+    z.q.noalias() += drift * (z.inv_e_metric_ * z.p);
+  }
 
-    for (idx_t i = 0; i < u.size(); ++i)
-      u(i) = rand_dense_gaus();
+  // one product with the inverse metric instead of the triangular product
+  // of the kinetic energy and the full product of the sharp momentum
+  double H_dtau_dp(dense_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp.noalias() = z.inv_e_metric_ * z.p;
+    return 0.5 * z.p.dot(p_sharp) + this->V(z);
+  }
 
-    z.p = z.inv_e_metric_.llt().matrixU().solve(u);
+  void sample_p(dense_e_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
+    z.inv_e_metric_llt_.matrixU().solveInPlace(z.p);
   }
 };
 
@@ -3,6 +3,7 @@
 
 #include <stan/callbacks/writer.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
 
 namespace stan {
 namespace mcmc {
@@ -17,6 +18,13 @@ class dense_e_point : public ps_point {
    */
   Eigen::MatrixXd inv_e_metric_;
 
+  /**
+   * Cholesky factorization of the inverse mass matrix, which is only
+   * recomputed by <code>set_metric</code> and
+   * <code>update_metric_factor</code>.
+   */
+  Eigen::LLT<Eigen::MatrixXd> inv_e_metric_llt_;
+
   /**
    * Construct a dense point in n-dimensional phase space
    * with identity matrix as inverse mass matrix.
@@ -25,6 +33,7 @@ class dense_e_point : public ps_point {
    */
   explicit dense_e_point(int n) : ps_point(n), inv_e_metric_(n, n) {
     inv_e_metric_.setIdentity();
+    update_metric_factor();
   }
 
   /**
@@ -34,8 +43,16 @@ class dense_e_point : public ps_point {
    */
   void set_metric(const Eigen::MatrixXd& inv_e_metric) {
     inv_e_metric_ = inv_e_metric;
+    update_metric_factor();
   }
 
+  /**
+   * Recompute the Cholesky factorization of the inverse mass matrix.
+   * This must be called whenever <code>inv_e_metric_</code> is changed
+   * other than through <code>set_metric</code>, as adaptation does.
+   */
+  void update_metric_factor() { inv_e_metric_llt_.compute(inv_e_metric_); }
+
   /**
    * Write elements of mass matrix to string and handoff to writer.
    *
@@ -55,6 +72,12 @@ class dense_e_point : public ps_point {
   }
 
   inline std::string metric_type() { return "dense_e"; }
+
+  size_t memory_bytes() const {
+    // the Cholesky factor is a matrix the size of the metric
+    return ps_point::memory_bytes()
+           + 2 * inv_e_metric_.size() * sizeof(double);
+  }
 };
 
 }  // namespace mcmc
@@ -4,8 +4,8 @@
 #include <stan/callbacks/logger.hpp>
 #include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
 #include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random/normal_distribution.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+#include <cmath>
 
 namespace stan {
 namespace mcmc {
@@ -41,12 +41,30 @@ class diag_e_metric : public base_hamiltonian<Model, diag_e_point, BaseRNG> {
     return z.g;
   }
 
-  void sample_p(diag_e_point& z, BaseRNG& rng) {
-    boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
-        rand_diag_gaus(rng, boost::normal_distribution<>());
+  void kick_drift(diag_e_point& z, double kick, double drift,
+                  callbacks::logger& logger) {
+    for (Eigen::Index i = 0; i < z.p.size(); ++i) {
+      z.p(i) -= kick * z.g(i);
+      z.q(i) += drift * (z.inv_e_metric_(i) * z.p(i));
+    }
+  }
 
+  double H_dtau_dp(diag_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp.resize(z.p.size());
+    double two_T = 0;
+    for (Eigen::Index i = 0; i < z.p.size(); ++i) {
+      p_sharp(i) = z.inv_e_metric_(i) * z.p(i);
+      two_T += z.p(i) * p_sharp(i);
+    }
+    return 0.5 * two_T + this->V(z);
+  }
+
+  void sample_p(diag_e_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
+    // the same divisions as scaling each normal draw as it is made, with
+    // rand / sqrt(inv_e_metric_(i)), so the momenta are bitwise unchanged
     for (int i = 0; i < z.p.size(); ++i)
-      z.p(i) = rand_diag_gaus() / sqrt(z.inv_e_metric_(i));
+      z.p(i) /= std::sqrt(z.inv_e_metric_(i));
   }
 };
 
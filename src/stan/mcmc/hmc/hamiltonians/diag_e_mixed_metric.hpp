@@ -0,0 +1,88 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_DIAG_E_MIXED_METRIC_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_DIAG_E_MIXED_METRIC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_mixed_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+#include <cmath>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Euclidean manifold with diagonal metric read in single precision.
+ *
+ * Every use of the metric, in the kinetic energy, the sharp momentum,
+ * the position step and the momentum draws, reads the single precision
+ * diagonal and accumulates in double precision, which cuts the memory
+ * traffic of the metric in half.  Because all of them use the same
+ * rounded diagonal, the sampler is exact for a mass matrix that differs
+ * from the adapted one by a relative 6e-8, and the Metropolis correction
+ * and the U-turn criterion are unaffected.  The position, momentum and
+ * gradient stay in double precision: rounding them inside the
+ * integrator would break the reversibility that the correction relies
+ * on.
+ */
+template <class Model, class BaseRNG>
+class diag_e_mixed_metric
+    : public base_hamiltonian<Model, diag_e_mixed_point, BaseRNG> {
+ public:
+  explicit diag_e_mixed_metric(const Model& model)
+      : base_hamiltonian<Model, diag_e_mixed_point, BaseRNG>(model) {}
+
+  double T(diag_e_mixed_point& z) {
+    double two_T = 0;
+    for (Eigen::Index i = 0; i < z.p.size(); ++i)
+      two_T += z.p(i) * (z.inv_e_metric_f_(i) * z.p(i));
+    return 0.5 * two_T;
+  }
+
+  double tau(diag_e_mixed_point& z) { return T(z); }
+
+  double phi(diag_e_mixed_point& z) { return this->V(z); }
+
+  double dG_dt(diag_e_mixed_point& z, callbacks::logger& logger) {
+    return 2 * T(z) - z.q.dot(z.g);
+  }
+
+  Eigen::VectorXd dtau_dq(diag_e_mixed_point& z, callbacks::logger& logger) {
+    return Eigen::VectorXd::Zero(this->model_.num_params_r());
+  }
+
+  Eigen::VectorXd dtau_dp(diag_e_mixed_point& z) {
+    return z.inv_e_metric_f_.cast<double>().cwiseProduct(z.p);
+  }
+
+  Eigen::VectorXd dphi_dq(diag_e_mixed_point& z, callbacks::logger& logger) {
+    return z.g;
+  }
+
+  void kick_drift(diag_e_mixed_point& z, double kick, double drift,
+                  callbacks::logger& logger) {
+    for (Eigen::Index i = 0; i < z.p.size(); ++i) {
+      z.p(i) -= kick * z.g(i);
+      z.q(i) += drift * (z.inv_e_metric_f_(i) * z.p(i));
+    }
+  }
+
+  double H_dtau_dp(diag_e_mixed_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp.resize(z.p.size());
+    double two_T = 0;
+    for (Eigen::Index i = 0; i < z.p.size(); ++i) {
+      p_sharp(i) = z.inv_e_metric_f_(i) * z.p(i);
+      two_T += z.p(i) * p_sharp(i);
+    }
+    return 0.5 * two_T + this->V(z);
+  }
+
+  void sample_p(diag_e_mixed_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
+    for (int i = 0; i < z.p.size(); ++i)
+      z.p(i) /= std::sqrt(static_cast<double>(z.inv_e_metric_f_(i)));
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,55 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_DIAG_E_MIXED_POINT_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_DIAG_E_MIXED_POINT_HPP
+
+#include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Point in a phase space with a base Euclidean manifold with diagonal
+ * metric, which also keeps the diagonal in single precision for the
+ * leapfrog steps.
+ *
+ * The double precision diagonal stays the one that is adapted, written
+ * and restored; the single precision copy is only recomputed by
+ * <code>set_metric</code> and <code>update_metric_factor</code>.
+ */
+class diag_e_mixed_point : public diag_e_point {
+ public:
+  /**
+   * Diagonal of the inverse mass matrix rounded to single precision.
+   */
+  Eigen::VectorXf inv_e_metric_f_;
+
+  explicit diag_e_mixed_point(int n) : diag_e_point(n) {
+    update_metric_factor();
+  }
+
+  /**
+   * Set elements of mass matrix
+   *
+   * @param inv_e_metric initial mass matrix
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    inv_e_metric_ = inv_e_metric;
+    update_metric_factor();
+  }
+
+  /**
+   * Recompute the single precision diagonal.  This must be called
+   * whenever <code>inv_e_metric_</code> is changed other than through
+   * <code>set_metric</code>, as adaptation does.
+   */
+  void update_metric_factor() { inv_e_metric_f_ = inv_e_metric_.cast<float>(); }
+
+  size_t memory_bytes() const {
+    return diag_e_point::memory_bytes()
+           + inv_e_metric_f_.size() * sizeof(float);
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
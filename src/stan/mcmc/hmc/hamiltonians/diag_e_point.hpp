@@ -52,6 +52,10 @@ class diag_e_point : public ps_point {
   }
 
   inline std::string metric_type() { return "diag_e"; }
+
+  size_t memory_bytes() const {
+    return ps_point::memory_bytes() + inv_e_metric_.size() * sizeof(double);
+  }
 };
 
 }  // namespace mcmc
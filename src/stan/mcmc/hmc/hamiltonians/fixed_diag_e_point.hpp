@@ -0,0 +1,117 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_FIXED_DIAG_E_POINT_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_FIXED_DIAG_E_POINT_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Point in a phase space of a dimension fixed at compile time, with a
+ * base Euclidean manifold with diagonal metric.
+ *
+ * The point holds its position, momentum, gradient and inverse metric
+ * in fixed-size vectors, so it lives wherever it is declared, with no
+ * heap storage and loops over it unrolled by the compiler.  It is the
+ * point of <code>fixed_diag_e_nuts</code>, for models with a handful of
+ * parameters, and otherwise behaves as a <code>diag_e_point</code>.
+ *
+ * @tparam N number of dimensions
+ */
+template <int N>
+class fixed_diag_e_point {
+ public:
+  using vector_t = Eigen::Matrix<double, N, 1>;
+
+  /**
+   * Construct a point at the origin with a unit inverse metric.
+   */
+  fixed_diag_e_point()
+      : q(vector_t::Zero()),
+        p(vector_t::Zero()),
+        g(vector_t::Zero()),
+        inv_e_metric_(vector_t::Ones()) {}
+
+  vector_t q;
+  vector_t p;
+  vector_t g;
+  double V{0};
+
+  /**
+   * Vector of diagonal elements of inverse mass matrix.
+   */
+  vector_t inv_e_metric_;
+
+  /**
+   * Swap the position, momentum, gradient and potential with those of
+   * another point, as <code>ps_point::swap</code> does.  The points of a
+   * sampler share its metric, which is not swapped.
+   *
+   * @param other point to swap with
+   */
+  void swap(fixed_diag_e_point& other) noexcept {
+    q.swap(other.q);
+    p.swap(other.p);
+    g.swap(other.g);
+    std::swap(V, other.V);
+  }
+
+  /**
+   * Set elements of mass matrix
+   *
+   * @param inv_e_metric initial mass matrix
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    inv_e_metric_ = inv_e_metric;
+  }
+
+  void get_param_names(std::vector<std::string>& model_names,
+                       std::vector<std::string>& names) {
+    names.reserve(3 * N);
+    for (int i = 0; i < N; ++i)
+      names.emplace_back(model_names[i]);
+    for (int i = 0; i < N; ++i)
+      names.emplace_back(std::string("p_") + model_names[i]);
+    for (int i = 0; i < N; ++i)
+      names.emplace_back(std::string("g_") + model_names[i]);
+  }
+
+  void get_params(std::vector<double>& values) {
+    values.reserve(3 * N);
+    for (int i = 0; i < N; ++i)
+      values.push_back(q[i]);
+    for (int i = 0; i < N; ++i)
+      values.push_back(p[i]);
+    for (int i = 0; i < N; ++i)
+      values.push_back(g[i]);
+  }
+
+  /**
+   * Write elements of mass matrix to string and handoff to writer.
+   *
+   * @param writer Stan writer callback
+   */
+  void write_metric(stan::callbacks::writer& writer) {
+    writer("Diagonal elements of inverse mass matrix:");
+    std::stringstream inv_e_metric_ss;
+    if (N > 0)
+      inv_e_metric_ss << inv_e_metric_(0);
+    for (int i = 1; i < N; ++i)
+      inv_e_metric_ss << ", " << inv_e_metric_(i);
+    writer(inv_e_metric_ss.str());
+  }
+
+  std::string metric_type() { return "diag_e"; }
+
+  size_t memory_bytes() const { return 4 * N * sizeof(double); }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,65 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_E_METRIC_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_E_METRIC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Euclidean manifold with an inverse metric that is diagonal plus low
+ * rank, <code>diag(d) + U U^T</code>.
+ *
+ * Products with the inverse metric and momentum draws cost
+ * O(<code>n k</code>) operations for rank <code>k</code>, against
+ * O(<code>n^2</code>) for a dense metric.
+ */
+template <class Model, class BaseRNG>
+class lowrank_e_metric
+    : public base_hamiltonian<Model, lowrank_e_point, BaseRNG> {
+ public:
+  explicit lowrank_e_metric(const Model& model)
+      : base_hamiltonian<Model, lowrank_e_point, BaseRNG>(model) {}
+
+  double T(lowrank_e_point& z) {
+    return 0.5
+           * (z.p.dot(z.inv_e_metric_.cwiseProduct(z.p))
+              + (z.inv_e_metric_lowrank_.transpose() * z.p).squaredNorm());
+  }
+
+  double tau(lowrank_e_point& z) { return T(z); }
+
+  double phi(lowrank_e_point& z) { return this->V(z); }
+
+  double dG_dt(lowrank_e_point& z, callbacks::logger& logger) {
+    return 2 * T(z) - z.q.dot(z.g);
+  }
+
+  Eigen::VectorXd dtau_dq(lowrank_e_point& z, callbacks::logger& logger) {
+    return Eigen::VectorXd::Zero(this->model_.num_params_r());
+  }
+
+  Eigen::VectorXd dtau_dp(lowrank_e_point& z) {
+    return z.inv_e_metric_.cwiseProduct(z.p)
+           + z.inv_e_metric_lowrank_
+                 * (z.inv_e_metric_lowrank_.transpose() * z.p);
+  }
+
+  Eigen::VectorXd dphi_dq(lowrank_e_point& z, callbacks::logger& logger) {
+    return z.g;
+  }
+
+  void sample_p(lowrank_e_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
+    z.p += z.sample_basis_
+           * z.sample_scale_.cwiseProduct(z.sample_basis_.transpose() * z.p);
+    z.p = z.p.cwiseQuotient(z.inv_e_metric_.cwiseSqrt());
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,151 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_E_POINT_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_E_POINT_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <sstream>
+#include <string>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Point in a phase space with a base Euclidean manifold whose inverse
+ * mass matrix is a diagonal matrix plus a low-rank matrix,
+ * <code>diag(d) + U U^T</code> with <code>U</code> of size
+ * <code>n</code> by <code>k</code>.
+ *
+ * Only O(<code>n k</code>) memory is used, so the metric can capture
+ * the dominant correlations of a target in dimensions where a dense
+ * metric would not fit.
+ */
+class lowrank_e_point : public ps_point {
+ public:
+  /**
+   * Vector of diagonal elements of inverse mass matrix.
+   */
+  Eigen::VectorXd inv_e_metric_;
+
+  /**
+   * Factor of the low-rank part of the inverse mass matrix, one column
+   * per rank.
+   */
+  Eigen::MatrixXd inv_e_metric_lowrank_;
+
+  /**
+   * Orthonormal basis of the range of the low-rank part scaled by the
+   * inverse square root of the diagonal, and the corrections along it
+   * that turn standard normal draws into momenta.  Only recomputed by
+   * <code>set_metric</code> and <code>update_metric_factor</code>.
+   */
+  Eigen::MatrixXd sample_basis_;
+  Eigen::VectorXd sample_scale_;
+
+  /**
+   * Construct a point in n-dimensional phase space with the identity
+   * matrix as inverse mass matrix.
+   *
+   * @param n number of dimensions
+   */
+  explicit lowrank_e_point(int n)
+      : ps_point(n), inv_e_metric_(n), inv_e_metric_lowrank_(n, 0) {
+    inv_e_metric_.setOnes();
+    update_metric_factor();
+  }
+
+  /**
+   * Set the diagonal of the inverse mass matrix, keeping its low-rank
+   * part.
+   *
+   * @param inv_e_metric positive diagonal elements
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    inv_e_metric_ = inv_e_metric;
+    update_metric_factor();
+  }
+
+  /**
+   * Set the diagonal and the low-rank part of the inverse mass matrix.
+   *
+   * @param inv_e_metric positive diagonal elements
+   * @param inv_e_metric_lowrank factor of the low-rank part, with as
+   * many rows as there are dimensions
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric,
+                  const Eigen::MatrixXd& inv_e_metric_lowrank) {
+    inv_e_metric_ = inv_e_metric;
+    inv_e_metric_lowrank_ = inv_e_metric_lowrank;
+    update_metric_factor();
+  }
+
+  /**
+   * Recompute the basis used to draw momenta.  This must be called
+   * whenever the inverse mass matrix is changed other than through
+   * <code>set_metric</code>.
+   *
+   * With <code>W = diag(d)^{-1/2} U = Q S V^T</code>, the mass matrix is
+   * <code>diag(d)^{-1/2} (I + Q S^2 Q^T)^{-1} diag(d)^{-1/2}</code>, whose
+   * square root only needs the thin singular value decomposition of
+   * <code>W</code>, in O(<code>n k^2</code>) operations.
+   */
+  void update_metric_factor() {
+    Eigen::MatrixXd scaled_lowrank
+        = inv_e_metric_.cwiseSqrt().cwiseInverse().asDiagonal()
+          * inv_e_metric_lowrank_;
+    if (scaled_lowrank.cols() == 0) {
+      sample_basis_.resize(inv_e_metric_.size(), 0);
+      sample_scale_.resize(0);
+      return;
+    }
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd(scaled_lowrank, Eigen::ComputeThinU);
+    sample_basis_ = svd.matrixU();
+    sample_scale_
+        = (1 + svd.singularValues().array().square()).rsqrt().matrix();
+    sample_scale_.array() -= 1;
+  }
+
+  /**
+   * Write the diagonal and the low-rank factor of the inverse mass matrix
+   * to strings and hand them off to the writer.
+   *
+   * @param writer Stan writer callback
+   */
+  inline void write_metric(stan::callbacks::writer& writer) {
+    writer("Diagonal elements of inverse mass matrix:");
+    if (inv_e_metric_.size() == 0) {
+      writer("");
+    } else {
+      std::stringstream inv_e_metric_ss;
+      inv_e_metric_ss << inv_e_metric_(0);
+      for (int i = 1; i < inv_e_metric_.size(); ++i)
+        inv_e_metric_ss << ", " << inv_e_metric_(i);
+      writer(inv_e_metric_ss.str());
+    }
+    writer("Low-rank factor of inverse mass matrix:");
+    if (inv_e_metric_lowrank_.cols() == 0)
+      writer("");
+    for (int i = 0; i < inv_e_metric_lowrank_.rows()
+                    && inv_e_metric_lowrank_.cols() > 0;
+         ++i) {
+      std::stringstream lowrank_ss;
+      lowrank_ss << inv_e_metric_lowrank_(i, 0);
+      for (int j = 1; j < inv_e_metric_lowrank_.cols(); ++j)
+        lowrank_ss << ", " << inv_e_metric_lowrank_(i, j);
+      writer(lowrank_ss.str());
+    }
+  }
+
+  inline std::string metric_type() { return "lowrank_e"; }
+
+  size_t memory_bytes() const {
+    return ps_point::memory_bytes()
+           + (inv_e_metric_.size() + inv_e_metric_lowrank_.size()
+              + sample_basis_.size() + sample_scale_.size())
+                 * sizeof(double);
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <stan/callbacks/writer.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <cstddef>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace stan {
@@ -22,6 +24,21 @@ class ps_point {
   Eigen::VectorXd g;
   double V{0};
 
+  /**
+   * Exchange the position, momentum, gradient and potential with those
+   * of another point, in constant time, as samplers do to move the ends
+   * and the proposals of their trajectories between points without
+   * copying them.  The metrics of derived points are not exchanged.
+   *
+   * @param[in,out] other point
+   */
+  void swap(ps_point& other) noexcept {
+    q.swap(other.q);
+    p.swap(other.p);
+    g.swap(other.g);
+    std::swap(V, other.V);
+  }
+
   virtual inline void get_param_names(std::vector<std::string>& model_names,
                                       std::vector<std::string>& names) {
     names.reserve(q.size() + p.size() + g.size());
@@ -43,6 +60,14 @@ class ps_point {
       values.push_back(g[i]);
   }
 
+  /**
+   * Return the bytes of storage held by the point, its metric included,
+   * for memory accounting.
+   */
+  virtual size_t memory_bytes() const {
+    return (q.size() + p.size() + g.size()) * sizeof(double);
+  }
+
   /**
    * Writes the metric
    *
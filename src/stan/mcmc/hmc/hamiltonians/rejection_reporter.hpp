@@ -0,0 +1,131 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_REJECTION_REPORTER_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_REJECTION_REPORTER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Reporter of the proposals rejected because the log density could not
+ * be evaluated, which counts them by message and writes a rate-limited
+ * report of them instead of a message for every rejection.
+ *
+ * The first rejection of a message writes it in full, with the advice
+ * on what frequent rejections mean the first time of all.  Later
+ * rejections of the same message only write a line with their count
+ * whenever it reaches a power of two, so a model that rejects on every
+ * proposal writes a logarithmic number of lines.  The summary writes the
+ * count of every message, and starts counting afresh.
+ *
+ * Only the first <code>max_messages</code> distinct messages are kept;
+ * the rejections of the others are counted together.
+ */
+class rejection_reporter {
+ public:
+  static constexpr std::size_t max_messages = 16;
+
+  /**
+   * Record a rejection and write its report if it is due.
+   *
+   * @param[in] message message of the error of the log density
+   * @param[in,out] logger logger for the report
+   */
+  void report(const std::string& message, callbacks::logger& logger) {
+    ++num_rejections_;
+    long count = ++find(message);
+    if (!logger.is_enabled(callbacks::log_level::error)
+        || (count & (count - 1)) != 0)
+      return;
+    if (count > 1) {
+      std::stringstream msg;
+      msg << "Informational Message: " << count
+          << " proposals have been rejected so far because of: " << message;
+      logger.error(msg);
+      return;
+    }
+    logger.error(
+        "Informational Message: The current Metropolis proposal "
+        "is about to be rejected because of the following issue:");
+    logger.error(message);
+    if (!advised_) {
+      advised_ = true;
+      logger.error(
+          "If this warning occurs sporadically, such as for highly "
+          "constrained variable types like covariance matrices, "
+          "then the sampler is fine,");
+      logger.error(
+          "but if this warning occurs often then your model may be "
+          "either severely ill-conditioned or misspecified.");
+      logger.error(
+          "Further rejections for the same reason are reported with "
+          "their count at powers of two.");
+    }
+    logger.error("");
+  }
+
+  /**
+   * Return the number of rejections since the last summary.
+   */
+  long num_rejections() const noexcept { return num_rejections_; }
+
+  /**
+   * Return the messages of the rejections since the last summary, with
+   * their counts, in the order they were first seen.
+   */
+  const std::vector<std::pair<std::string, long>>& counts() const noexcept {
+    return counts_;
+  }
+
+  /**
+   * Write the number of rejections of each message since the last
+   * summary, if there were any, and start counting afresh.
+   *
+   * @param[in,out] logger logger for the summary
+   */
+  void write_summary(callbacks::logger& logger) {
+    if (num_rejections_ == 0)
+      return;
+    std::stringstream msg;
+    msg << num_rejections_ << " proposals were rejected because the log "
+        << "density could not be evaluated:";
+    logger.info(msg);
+    for (const auto& count : counts_) {
+      std::stringstream line;
+      line << "  " << count.second << " x " << count.first;
+      logger.info(line);
+    }
+    if (num_others_ > 0) {
+      std::stringstream line;
+      line << "  " << num_others_ << " x other issues";
+      logger.info(line);
+    }
+    counts_.clear();
+    num_others_ = 0;
+    num_rejections_ = 0;
+  }
+
+ private:
+  std::vector<std::pair<std::string, long>> counts_;
+  long num_others_ = 0;
+  long num_rejections_ = 0;
+  bool advised_ = false;
+
+  long& find(const std::string& message) {
+    for (auto& count : counts_)
+      if (count.first == message)
+        return count.second;
+    if (counts_.size() == max_messages)
+      return num_others_;
+    counts_.emplace_back(message, 0);
+    return counts_.back().second;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
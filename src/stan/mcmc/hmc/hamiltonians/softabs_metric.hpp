@@ -38,8 +38,8 @@ class softabs_metric : public base_hamiltonian<Model, softabs_point, BaseRNG> {
   double T(softabs_point& z) { return this->tau(z) + 0.5 * z.log_det_metric; }
 
   double tau(softabs_point& z) {
-    Eigen::VectorXd Qp = z.eigen_deco.eigenvectors().transpose() * z.p;
-    return 0.5 * Qp.transpose() * z.softabs_lambda_inv.cwiseProduct(Qp);
+    z.work_v.noalias() = z.eigen_deco.eigenvectors().transpose() * z.p;
+    return 0.5 * z.work_v.dot(z.softabs_lambda_inv.cwiseProduct(z.work_v));
   }
 
   double phi(softabs_point& z) { return this->V(z) + 0.5 * z.log_det_metric; }
@@ -49,16 +49,18 @@ class softabs_metric : public base_hamiltonian<Model, softabs_point, BaseRNG> {
   }
 
   Eigen::VectorXd dtau_dq(softabs_point& z, callbacks::logger& logger) {
-    Eigen::VectorXd a = z.softabs_lambda_inv.cwiseProduct(
-        z.eigen_deco.eigenvectors().transpose() * z.p);
-    Eigen::MatrixXd A
-        = a.asDiagonal() * z.eigen_deco.eigenvectors().transpose();
-    Eigen::MatrixXd B = z.pseudo_j.selfadjointView<Eigen::Lower>() * A;
-    Eigen::MatrixXd C = A.transpose() * B;
+    // C = A^T J A with A = diag(a) Q^T, formed in the workspace of the
+    // point with a symmetric and a general matrix product
+    z.work_v.noalias() = z.eigen_deco.eigenvectors().transpose() * z.p;
+    z.work_v.array() *= z.softabs_lambda_inv.array();
+    z.work_a.noalias()
+        = z.work_v.asDiagonal() * z.eigen_deco.eigenvectors().transpose();
+    z.work_b.noalias() = z.pseudo_j.selfadjointView<Eigen::Lower>() * z.work_a;
+    z.work_c.noalias() = z.work_a.transpose() * z.work_b;
 
     Eigen::VectorXd b(z.q.size());
     stan::math::grad_tr_mat_times_hessian(softabs_fun<Model>(this->model_, 0),
-                                          z.q, C, b);
+                                          z.q, z.work_c, b);
 
     return 0.5 * b;
   }
@@ -70,14 +72,14 @@ class softabs_metric : public base_hamiltonian<Model, softabs_point, BaseRNG> {
   }
 
   Eigen::VectorXd dphi_dq(softabs_point& z, callbacks::logger& logger) {
-    Eigen::VectorXd a
-        = z.softabs_lambda_inv.cwiseProduct(z.pseudo_j.diagonal());
-    Eigen::MatrixXd A
-        = a.asDiagonal() * z.eigen_deco.eigenvectors().transpose();
-    Eigen::MatrixXd B = z.eigen_deco.eigenvectors() * A;
+    z.work_v = z.softabs_lambda_inv.cwiseProduct(z.pseudo_j.diagonal());
+    z.work_a.noalias()
+        = z.work_v.asDiagonal() * z.eigen_deco.eigenvectors().transpose();
+    z.work_b.noalias() = z.eigen_deco.eigenvectors() * z.work_a;
 
+    Eigen::VectorXd a(z.q.size());
     stan::math::grad_tr_mat_times_hessian(softabs_fun<Model>(this->model_, 0),
-                                          z.q, B, a);
+                                          z.q, z.work_b, a);
 
     return -0.5 * a + z.g;
   }
@@ -20,7 +20,11 @@ class softabs_point : public ps_point {
         log_det_metric(0),
         softabs_lambda(Eigen::VectorXd::Zero(n)),
         softabs_lambda_inv(Eigen::VectorXd::Zero(n)),
-        pseudo_j(Eigen::MatrixXd::Identity(n, n)) {}
+        pseudo_j(Eigen::MatrixXd::Identity(n, n)),
+        work_v(n),
+        work_a(n, n),
+        work_b(n, n),
+        work_c(n, n) {}
 
   // SoftAbs regularization parameter
   double alpha;
@@ -40,11 +44,28 @@ class softabs_point : public ps_point {
   // Psuedo-Jacobian of the eigenvalues
   Eigen::MatrixXd pseudo_j;
 
+  // Workspace of the metric, kept so that the products evaluated at
+  // every fixed point iteration of a step do not allocate
+  Eigen::VectorXd work_v;
+  Eigen::MatrixXd work_a;
+  Eigen::MatrixXd work_b;
+  Eigen::MatrixXd work_c;
+
   virtual inline void write_metric(stan::callbacks::writer& writer) {
     writer("No free parameters for SoftAbs metric");
   }
 
   inline std::string metric_type() { return "softabs"; }
+
+  size_t memory_bytes() const {
+    // the eigendecomposition holds a matrix and a vector the size of the
+    // Hessian
+    return ps_point::memory_bytes()
+           + (2 * hessian.size() + hessian.rows() + softabs_lambda.size()
+              + softabs_lambda_inv.size() + pseudo_j.size() + work_v.size()
+              + work_a.size() + work_b.size() + work_c.size())
+                 * sizeof(double);
+  }
 };
 
 }  // namespace mcmc
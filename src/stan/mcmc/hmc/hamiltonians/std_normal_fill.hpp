@@ -0,0 +1,35 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_STD_NORMAL_FILL_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_STD_NORMAL_FILL_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Fill a vector with independent standard normal draws, in order.
+ *
+ * The draws are the same as those of a <code>variate_generator</code>
+ * over a <code>boost::normal_distribution</code> called once per
+ * element, because the ziggurat sampler behind it keeps no state between
+ * draws; filling the whole vector with one distribution inlines the
+ * sampler into a single loop, and leaves the scaling of the draws to
+ * vectorized expressions over the vector.
+ *
+ * @tparam BaseRNG type of random number generator
+ * @tparam Rows number of rows of the vector, fixed or dynamic
+ * @param[in,out] x vector to fill, of the size it already has
+ * @param[in,out] rng random number generator
+ */
+template <class BaseRNG, int Rows>
+inline void std_normal_fill(Eigen::Matrix<double, Rows, 1>& x, BaseRNG& rng) {
+  boost::random::normal_distribution<double> std_normal;
+  double* values = x.data();
+  for (Eigen::Index i = 0; i < x.size(); ++i)
+    values[i] = std_normal(rng);
+}
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -2,9 +2,8 @@
 #define STAN_MCMC_HMC_HAMILTONIANS_UNIT_E_METRIC_HPP
 
 #include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
 #include <stan/mcmc/hmc/hamiltonians/unit_e_point.hpp>
-#include <boost/random/variate_generator.hpp>
-#include <boost/random/normal_distribution.hpp>
 
 namespace stan {
 namespace mcmc {
@@ -36,12 +35,21 @@ class unit_e_metric : public base_hamiltonian<Model, unit_e_point, BaseRNG> {
     return z.g;
   }
 
-  void sample_p(unit_e_point& z, BaseRNG& rng) {
-    boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
-        rand_unit_gaus(rng, boost::normal_distribution<>());
+  void kick_drift(unit_e_point& z, double kick, double drift,
+                  callbacks::logger& logger) {
+    for (Eigen::Index i = 0; i < z.p.size(); ++i) {
+      z.p(i) -= kick * z.g(i);
+      z.q(i) += drift * z.p(i);
+    }
+  }
 
-    for (int i = 0; i < z.p.size(); ++i)
-      z.p(i) = rand_unit_gaus();
+  double H_dtau_dp(unit_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = z.p;
+    return T(z) + this->V(z);
+  }
+
+  void sample_p(unit_e_point& z, BaseRNG& rng) {
+    std_normal_fill(z.p, rng);
   }
 };
 
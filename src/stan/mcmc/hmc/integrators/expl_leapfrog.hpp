@@ -13,6 +13,17 @@ class expl_leapfrog : public base_leapfrog<Hamiltonian> {
  public:
   expl_leapfrog() : base_leapfrog<Hamiltonian>() {}
 
+  /**
+   * Take a leapfrog step with the first half step of the momentum and
+   * the step of the position fused into one pass over the point.
+   */
+  void evolve(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+              const double epsilon, callbacks::logger& logger) {
+    hamiltonian.kick_drift(z, 0.5 * epsilon, epsilon, logger);
+    hamiltonian.update_potential_gradient(z, logger);
+    end_update_p(z, hamiltonian, 0.5 * epsilon, logger);
+  }
+
   void begin_update_p(typename Hamiltonian::PointType& z,
                       Hamiltonian& hamiltonian, double epsilon,
                       callbacks::logger& logger) {
@@ -30,6 +41,16 @@ class expl_leapfrog : public base_leapfrog<Hamiltonian> {
                     callbacks::logger& logger) {
     z.p -= epsilon * hamiltonian.dphi_dq(z, logger);
   }
+
+  /**
+   * Return the number of gradient evaluations in each step.
+   */
+  static int num_gradients() { return 1; }
+
+  /**
+   * Return the target acceptance statistic for step size adaptation.
+   */
+  static double default_delta() { return 0.8; }
 };
 
 }  // namespace mcmc
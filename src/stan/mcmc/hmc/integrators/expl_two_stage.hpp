@@ -0,0 +1,70 @@
+#ifndef STAN_MCMC_HMC_INTEGRATORS_EXPL_TWO_STAGE_HPP
+#define STAN_MCMC_HMC_INTEGRATORS_EXPL_TWO_STAGE_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/integrators/base_integrator.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * The two-stage splitting integrator of Blanes, Casas and Sanz-Serna,
+ * whose coefficient minimizes the expected energy error of Gaussian
+ * targets.
+ *
+ * Each step is the symmetric composition of momentum updates of
+ * <code>b</code>, <code>1 - 2 b</code> and <code>b</code> times the step
+ * size with two position updates of half the step size, and evaluates
+ * the gradient twice.  It is second order like the leapfrog, but its
+ * energy error is much smaller, so on near-Gaussian targets a step
+ * more than twice the leapfrog step size is accepted as often.
+ */
+template <class Hamiltonian>
+class expl_two_stage : public base_integrator<Hamiltonian> {
+ public:
+  expl_two_stage() : base_integrator<Hamiltonian>() {}
+
+  void evolve(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+              const double epsilon, callbacks::logger& logger) {
+    update_p(z, hamiltonian, b * epsilon, logger);
+    update_q(z, hamiltonian, 0.5 * epsilon, logger);
+    update_p(z, hamiltonian, (1 - 2 * b) * epsilon, logger);
+    update_q(z, hamiltonian, 0.5 * epsilon, logger);
+    update_p(z, hamiltonian, b * epsilon, logger);
+  }
+
+  void update_p(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+                double epsilon, callbacks::logger& logger) {
+    z.p -= epsilon * hamiltonian.dphi_dq(z, logger);
+  }
+
+  void update_q(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+                double epsilon, callbacks::logger& logger) {
+    z.q += epsilon * hamiltonian.dtau_dp(z);
+    hamiltonian.update_potential_gradient(z, logger);
+  }
+
+  /**
+   * Return the number of gradient evaluations in each step.
+   */
+  static int num_gradients() { return 2; }
+
+  /**
+   * Return the target acceptance statistic for step size adaptation.
+   * The energy error grows more slowly with the step size than for the
+   * leapfrog, so a higher target costs fewer gradients per effective
+   * sample than it would with the leapfrog.
+   */
+  static double default_delta() { return 0.85; }
+
+  // momentum coefficient minimizing the energy error of Gaussian targets
+  static constexpr double b = 0.211781;
+};
+
+template <class Hamiltonian>
+constexpr double expl_two_stage<Hamiltonian>::b;
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,74 @@
+#ifndef STAN_MCMC_HMC_INTEGRATORS_EXPL_YOSHIDA_HPP
+#define STAN_MCMC_HMC_INTEGRATORS_EXPL_YOSHIDA_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/integrators/base_integrator.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * The fourth order integrator of Yoshida, made of three leapfrog steps
+ * of <code>w1</code>, <code>w0</code> and <code>w1</code> times the step
+ * size, with the adjacent momentum updates merged.
+ *
+ * Each step evaluates the gradient three times.  The energy error falls
+ * with the fourth power of the step size, so on smooth targets much
+ * larger steps are accepted than with the leapfrog, at the price of
+ * being unstable for smaller step sizes on stiff targets because the
+ * middle step goes backwards.
+ */
+template <class Hamiltonian>
+class expl_yoshida : public base_integrator<Hamiltonian> {
+ public:
+  expl_yoshida() : base_integrator<Hamiltonian>() {}
+
+  void evolve(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+              const double epsilon, callbacks::logger& logger) {
+    update_p(z, hamiltonian, 0.5 * w1 * epsilon, logger);
+    update_q(z, hamiltonian, w1 * epsilon, logger);
+    update_p(z, hamiltonian, 0.5 * (w1 + w0) * epsilon, logger);
+    update_q(z, hamiltonian, w0 * epsilon, logger);
+    update_p(z, hamiltonian, 0.5 * (w0 + w1) * epsilon, logger);
+    update_q(z, hamiltonian, w1 * epsilon, logger);
+    update_p(z, hamiltonian, 0.5 * w1 * epsilon, logger);
+  }
+
+  void update_p(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+                double epsilon, callbacks::logger& logger) {
+    z.p -= epsilon * hamiltonian.dphi_dq(z, logger);
+  }
+
+  void update_q(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
+                double epsilon, callbacks::logger& logger) {
+    z.q += epsilon * hamiltonian.dtau_dp(z);
+    hamiltonian.update_potential_gradient(z, logger);
+  }
+
+  /**
+   * Return the number of gradient evaluations in each step.
+   */
+  static int num_gradients() { return 3; }
+
+  /**
+   * Return the target acceptance statistic for step size adaptation.
+   * The optimal acceptance rate rises with the order of the integrator,
+   * so the target is higher than for the leapfrog.
+   */
+  static double default_delta() { return 0.9; }
+
+  // 1 / (2 - 2^(1/3)) and -2^(1/3) / (2 - 2^(1/3))
+  static constexpr double w1 = 1.3512071919596578;
+  static constexpr double w0 = -1.7024143839193153;
+};
+
+template <class Hamiltonian>
+constexpr double expl_yoshida<Hamiltonian>::w1;
+
+template <class Hamiltonian>
+constexpr double expl_yoshida<Hamiltonian>::w0;
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
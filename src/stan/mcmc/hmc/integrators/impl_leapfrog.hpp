@@ -3,6 +3,8 @@
 
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <stan/mcmc/hmc/integrators/base_leapfrog.hpp>
+#include <string>
+#include <vector>
 
 namespace stan {
 namespace mcmc {
@@ -13,7 +15,12 @@ class impl_leapfrog : public base_leapfrog<Hamiltonian> {
   impl_leapfrog()
       : base_leapfrog<Hamiltonian>(),
         max_num_fixed_point_(10),
-        fixed_point_threshold_(1e-8) {}
+        fixed_point_threshold_(1e-8),
+        warm_epsilon_(0),
+        warm_two_steps_(false),
+        num_steps_(0),
+        num_fixed_point_q_(0),
+        num_fixed_point_p_(0) {}
 
   void begin_update_p(typename Hamiltonian::PointType& z,
                       Hamiltonian& hamiltonian, double epsilon,
@@ -22,22 +29,52 @@ class impl_leapfrog : public base_leapfrog<Hamiltonian> {
     hat_tau(z, hamiltonian, epsilon, this->max_num_fixed_point_, logger);
   }
 
+  /**
+   * Solve the implicit position update by fixed-point iteration, stopping
+   * as soon as the change in the position falls below the fixed-point
+   * threshold.
+   *
+   * When the step continues a run of at least two steps with the same
+   * step size, the iteration starts from the position extrapolated to
+   * second order from the displacements of the previous two steps
+   * instead of the current position.  The extrapolation is accurate to
+   * third order in the step size, so the iteration converges in fewer
+   * metric evaluations despite the one spent at the extrapolated
+   * position.
+   */
   void update_q(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
                 double epsilon, callbacks::logger& logger) {
     // hat{T} = dT/dp * d/dq
     Eigen::VectorXd q_init = z.q + 0.5 * epsilon * hamiltonian.dtau_dp(z);
     Eigen::VectorXd delta_q(z.q.size());
+    Eigen::VectorXd q_start = z.q;
+
+    const bool warm = epsilon == warm_epsilon_
+                      && warm_q_.size() == z.q.size() && z.q == warm_q_;
+    if (warm && warm_two_steps_) {
+      z.q += 2 * warm_delta_q_ - warm_prev_delta_q_;
+      hamiltonian.update_metric(z, logger);
+      ++num_fixed_point_q_;
+    }
 
     for (int n = 0; n < this->max_num_fixed_point_; ++n) {
       delta_q = z.q;
       z.q.noalias() = q_init + 0.5 * epsilon * hamiltonian.dtau_dp(z);
       hamiltonian.update_metric(z, logger);
+      ++num_fixed_point_q_;
 
       delta_q -= z.q;
       if (delta_q.cwiseAbs().maxCoeff() < this->fixed_point_threshold_)
         break;
     }
     hamiltonian.update_gradients(z, logger);
+    ++num_steps_;
+
+    warm_epsilon_ = epsilon;
+    warm_q_ = z.q;
+    warm_two_steps_ = warm;
+    warm_prev_delta_q_.swap(warm_delta_q_);
+    warm_delta_q_ = z.q - q_start;
   }
 
   void end_update_p(typename Hamiltonian::PointType& z,
@@ -62,6 +99,7 @@ class impl_leapfrog : public base_leapfrog<Hamiltonian> {
     for (int n = 0; n < num_fixed_point; ++n) {
       delta_p = z.p;
       z.p.noalias() = p_init - epsilon * hamiltonian.dtau_dq(z, logger);
+      ++num_fixed_point_p_;
       delta_p -= z.p;
       if (delta_p.cwiseAbs().maxCoeff() < this->fixed_point_threshold_)
         break;
@@ -82,9 +120,70 @@ class impl_leapfrog : public base_leapfrog<Hamiltonian> {
       this->fixed_point_threshold_ = t;
   }
 
+  /**
+   * Forget the counts of steps and fixed-point iterations.
+   */
+  void reset_num_fixed_point() {
+    num_steps_ = 0;
+    num_fixed_point_q_ = 0;
+    num_fixed_point_p_ = 0;
+  }
+
+  /**
+   * Return the number of steps taken since the counts were reset.
+   */
+  int num_steps() const { return num_steps_; }
+
+  /**
+   * Return the number of fixed-point iterations of the position update,
+   * each of which evaluates the metric, since the counts were reset.
+   */
+  int num_fixed_point_q() const { return num_fixed_point_q_; }
+
+  /**
+   * Return the number of fixed-point iterations of the momentum updates
+   * since the counts were reset.
+   */
+  int num_fixed_point_p() const { return num_fixed_point_p_; }
+
+  /**
+   * Append the names of the fixed-point diagnostics.
+   *
+   * @param[in,out] names names of the diagnostics
+   */
+  void get_fixed_point_names(std::vector<std::string>& names) const {
+    names.push_back("fixed_point_q__");
+    names.push_back("fixed_point_p__");
+  }
+
+  /**
+   * Append the mean numbers of fixed-point iterations of the position and
+   * momentum updates per step since the counts were reset, or zeros if no
+   * step was taken.
+   *
+   * @param[in,out] values values of the diagnostics
+   */
+  void get_fixed_point_values(std::vector<double>& values) const {
+    const double steps = num_steps_ > 0 ? num_steps_ : 1;
+    values.push_back(num_fixed_point_q_ / steps);
+    values.push_back(num_fixed_point_p_ / steps);
+  }
+
  private:
   int max_num_fixed_point_;
   double fixed_point_threshold_;
+
+  // end point, step size and displacement of the last position update,
+  // and the displacement of the one before if it led to the last
+  Eigen::VectorXd warm_q_;
+  double warm_epsilon_;
+  Eigen::VectorXd warm_delta_q_;
+  bool warm_two_steps_;
+  Eigen::VectorXd warm_prev_delta_q_;
+
+  int num_steps_;
+  int num_fixed_point_q_;
+  int num_fixed_point_p_;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,67 @@
+#ifndef STAN_MCMC_HMC_NUTS_ADAPT_BLOCK_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_ADAPT_BLOCK_E_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/stepsize_block_covar_adapter.hpp>
+#include <stan/mcmc/hmc/nuts/block_e_nuts.hpp>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and adaptive
+ * block diagonal dense metric and adaptive step size
+ */
+template <class Model, class BaseRNG>
+class adapt_block_e_nuts : public block_e_nuts<Model, BaseRNG>,
+                           public stepsize_block_covar_adapter {
+ public:
+  /**
+   * @param model model
+   * @param block_sizes number of parameters of each block of the metric,
+   * which start as identity matrices
+   * @param rng random number generator
+   * @throw std::invalid_argument if the sizes are not positive or do not
+   * add up to the number of parameters
+   */
+  adapt_block_e_nuts(const Model& model, const std::vector<int>& block_sizes,
+                     BaseRNG& rng)
+      : block_e_nuts<Model, BaseRNG>(model, rng),
+        stepsize_block_covar_adapter(block_sizes) {
+    this->z_.set_block_sizes(block_sizes);
+  }
+
+  ~adapt_block_e_nuts() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    sample s = block_e_nuts<Model, BaseRNG>::transition(init_sample, logger);
+
+    if (this->adapt_flag_) {
+      this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
+                                                s.accept_stat());
+
+      bool update = this->block_covar_adaptation_.learn_covariance(
+          this->z_.inv_e_metric_, this->z_.q);
+
+      if (update) {
+        this->z_.update_metric_factor();
+        this->init_stepsize(logger);
+
+        this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
+        this->stepsize_adaptation_.restart();
+      }
+    }
+    return s;
+  }
+
+  void disengage_adaptation() {
+    base_adapter::disengage_adaptation();
+    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->early_abort_.complete_adaptation();
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -33,7 +33,8 @@ class adapt_dense_e_nuts : public dense_e_nuts<Model, BaseRNG>,
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
-        this->init_stepsize(logger);
+        this->z_.update_metric_factor();
+        this->init_stepsize(this->reused_stepsize(), logger);
 
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
         this->stepsize_adaptation_.restart();
@@ -45,6 +46,7 @@ class adapt_dense_e_nuts : public dense_e_nuts<Model, BaseRNG>,
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
     this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->early_abort_.complete_adaptation();
   }
 };
 
@@ -0,0 +1,67 @@
+#ifndef STAN_MCMC_HMC_NUTS_ADAPT_FIXED_DIAG_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_ADAPT_FIXED_DIAG_E_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+#include <stan/mcmc/hmc/nuts/fixed_diag_e_nuts.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and adaptive
+ * diagonal metric and adaptive step size, for models of
+ * <code>N</code> unconstrained parameters.  See
+ * <code>fixed_diag_e_nuts</code>.
+ */
+template <class Model, int N, class BaseRNG>
+class adapt_fixed_diag_e_nuts : public fixed_diag_e_nuts<Model, N, BaseRNG>,
+                                public stepsize_var_adapter {
+ public:
+  adapt_fixed_diag_e_nuts(const Model& model, BaseRNG& rng)
+      : fixed_diag_e_nuts<Model, N, BaseRNG>(model, rng),
+        stepsize_var_adapter(N),
+        inv_metric_(N),
+        q_(N),
+        g_(N) {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    sample s
+        = fixed_diag_e_nuts<Model, N, BaseRNG>::transition(init_sample, logger);
+
+    if (this->adapt_flag_) {
+      this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
+                                                s.accept_stat());
+
+      // the variance adaptation works on dynamic vectors, whose buffers
+      // are allocated once
+      inv_metric_ = this->z_.inv_e_metric_;
+      q_ = this->z_.q;
+      g_ = this->z_.g;
+      bool update = this->var_adaptation_.learn_variance(inv_metric_, q_, g_);
+
+      if (update) {
+        this->z_.inv_e_metric_ = inv_metric_;
+        this->init_stepsize(this->reused_stepsize(), logger);
+
+        this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
+        this->stepsize_adaptation_.restart();
+      }
+    }
+    return s;
+  }
+
+  void disengage_adaptation() {
+    base_adapter::disengage_adaptation();
+    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+  }
+
+ private:
+  Eigen::VectorXd inv_metric_;
+  Eigen::VectorXd q_;
+  Eigen::VectorXd g_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,55 @@
+#ifndef STAN_MCMC_HMC_NUTS_ADAPT_LOWRANK_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_ADAPT_LOWRANK_E_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/stepsize_lowrank_adapter.hpp>
+#include <stan/mcmc/hmc/nuts/lowrank_e_nuts.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and adaptive
+ * diagonal plus low-rank metric and adaptive step size
+ */
+template <class Model, class BaseRNG>
+class adapt_lowrank_e_nuts : public lowrank_e_nuts<Model, BaseRNG>,
+                             public stepsize_lowrank_adapter {
+ public:
+  adapt_lowrank_e_nuts(const Model& model, int rank, BaseRNG& rng)
+      : lowrank_e_nuts<Model, BaseRNG>(model, rng),
+        stepsize_lowrank_adapter(model.num_params_r(), rank) {}
+
+  ~adapt_lowrank_e_nuts() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    sample s = lowrank_e_nuts<Model, BaseRNG>::transition(init_sample, logger);
+
+    if (this->adapt_flag_) {
+      this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
+                                                s.accept_stat());
+
+      bool update = this->lowrank_adaptation_.learn_metric(
+          this->z_.inv_e_metric_, this->z_.inv_e_metric_lowrank_, this->z_.q);
+
+      if (update) {
+        this->z_.update_metric_factor();
+        this->init_stepsize(logger);
+
+        this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
+        this->stepsize_adaptation_.restart();
+      }
+    }
+    return s;
+  }
+
+  void disengage_adaptation() {
+    base_adapter::disengage_adaptation();
+    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->early_abort_.complete_adaptation();
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -34,6 +34,7 @@ class adapt_softabs_nuts : public softabs_nuts<Model, BaseRNG>,
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
     this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->early_abort_.complete_adaptation();
   }
 };
 
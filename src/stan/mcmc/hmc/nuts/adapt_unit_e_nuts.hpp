@@ -34,6 +34,7 @@ class adapt_unit_e_nuts : public unit_e_nuts<Model, BaseRNG>,
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
     this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->early_abort_.complete_adaptation();
   }
 };
 
@@ -1,23 +1,39 @@
 #ifndef STAN_MCMC_HMC_NUTS_BASE_NUTS_HPP
 #define STAN_MCMC_HMC_NUTS_BASE_NUTS_HPP
 
+#include <stan/callbacks/event_tracer.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/base_hmc.hpp>
+#include <stan/mcmc/hmc/early_abort.hpp>
+#include <stan/mcmc/hmc/gradient_budget.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_tree.hpp>
+#include <stan/mcmc/hmc/nuts/trajectory_estimator.hpp>
+#include <stan/mcmc/hmc/tree_weight.hpp>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <deque>
 #include <limits>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace stan {
 namespace mcmc {
 /**
  * The No-U-Turn sampler (NUTS) with multinomial sampling
+ *
+ * @tparam Derived sampler that derives from this class, whose
+ * <code>compute_criterion</code> the tree builder calls directly so that
+ * it can be inlined, or <code>void</code> to call the virtual
+ * <code>compute_criterion</code> of the dynamic type.
  */
 template <class Model, template <class, class> class Hamiltonian,
-          template <class> class Integrator, class BaseRNG>
+          template <class> class Integrator, class BaseRNG,
+          class Derived = void>
 class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
  public:
   base_nuts(const Model& model, BaseRNG& rng)
@@ -27,7 +43,18 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        capped_(false),
+        energy_(0),
+        aborted_(false),
+        max_delta_H_(0),
+        iterative_tree_(false),
+        trajectory_estimator_(nullptr),
+        z_fwd_(this->z_.q.size()),
+        z_bck_(this->z_.q.size()),
+        z_sample_(this->z_.q.size()),
+        z_propose_(this->z_.q.size()) {
+    resize_workspace();
+  }
 
   /**
    * specialized constructor for specified diag mass matrix
@@ -40,7 +67,18 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        capped_(false),
+        energy_(0),
+        aborted_(false),
+        max_delta_H_(0),
+        iterative_tree_(false),
+        trajectory_estimator_(nullptr),
+        z_fwd_(this->z_.q.size()),
+        z_bck_(this->z_.q.size()),
+        z_sample_(this->z_.q.size()),
+        z_propose_(this->z_.q.size()) {
+    resize_workspace();
+  }
 
   /**
    * specialized constructor for specified dense mass matrix
@@ -53,7 +91,18 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        capped_(false),
+        energy_(0),
+        aborted_(false),
+        max_delta_H_(0),
+        iterative_tree_(false),
+        trajectory_estimator_(nullptr),
+        z_fwd_(this->z_.q.size()),
+        z_bck_(this->z_.q.size()),
+        z_sample_(this->z_.q.size()),
+        z_propose_(this->z_.q.size()) {
+    resize_workspace();
+  }
 
   ~base_nuts() {}
 
@@ -66,8 +115,10 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   }
 
   void set_max_depth(int d) {
-    if (d > 0)
+    if (d > 0) {
       max_depth_ = d;
+      resize_workspace();
+    }
   }
 
   void set_max_delta(double d) { max_deltaH_ = d; }
@@ -75,6 +126,76 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int get_max_depth() { return this->max_depth_; }
   double get_max_delta() { return this->max_deltaH_; }
 
+  /**
+   * Abandon a subtree, as for a divergence, at a state whose energy error
+   * exceeds a threshold learned over warmup, as explained for
+   * <code>early_abort</code>.  While it is set the sampler parameters end
+   * with <code>aborted__</code>, which flags the transitions the
+   * threshold ended, so it must be set before their names are written.
+   *
+   * @param min_threshold smallest threshold on the energy error
+   * @param multiplier multiple of the average largest energy error of a
+   *   transition that is the threshold, or zero for a fixed threshold
+   * @throw std::invalid_argument if the minimum is not positive or the
+   *   multiplier is negative
+   */
+  void set_early_abort(double min_threshold, double multiplier = 4) {
+    early_abort_ = early_abort(min_threshold, multiplier);
+  }
+
+  const early_abort& get_early_abort() const noexcept { return early_abort_; }
+
+  /**
+   * Limit the leapfrog steps of each transition, and of all of them
+   * together, as explained for <code>gradient_budget</code>.  While a
+   * budget is set the sampler parameters end with
+   * <code>budget_capped__</code>, which flags the transitions the budget
+   * ended, so it must be set before their names are written.
+   *
+   * @param per_transition largest number of leapfrog steps of a
+   *   transition, or zero for no limit
+   * @param per_run number of leapfrog steps of the run, or zero for no
+   *   limit
+   * @throw std::invalid_argument if a budget is negative
+   */
+  void set_gradient_budget(long per_transition, long per_run = 0) {
+    gradient_budget_ = gradient_budget(per_transition, per_run);
+  }
+
+  const gradient_budget& get_gradient_budget() const noexcept {
+    return gradient_budget_;
+  }
+
+  /**
+   * Select the tree doubling engine used by <code>transition</code>.
+   * Both engines generate identical trajectories and draws.
+   *
+   * @param iterative true to use <code>build_tree_iterative</code>,
+   * false to use the recursive <code>build_tree</code>
+   */
+  void set_iterative_tree(bool iterative) {
+    iterative_tree_ = iterative;
+    if (iterative_tree_)
+      resize_checkpoints(max_depth_ + 1);
+  }
+
+  bool get_iterative_tree() const noexcept { return iterative_tree_; }
+
+  /**
+   * Set the estimator to which <code>transition</code> passes the states
+   * of its trajectories, or null, the default, for none.  The estimator
+   * must outlive the sampler or be unset before it is destroyed.
+   *
+   * @param estimator estimator of trajectory-weighted averages
+   */
+  void set_trajectory_estimator(trajectory_estimator* estimator) noexcept {
+    trajectory_estimator_ = estimator;
+  }
+
+  trajectory_estimator* get_trajectory_estimator() const noexcept {
+    return trajectory_estimator_;
+  }
+
   sample transition(sample& init_sample, callbacks::logger& logger) {
     // Initialize the algorithm
     this->sample_stepsize();
@@ -83,34 +204,53 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
     this->hamiltonian_.sample_p(this->z_, this->rand_int_);
     this->hamiltonian_.init(this->z_, logger);
+    if (trajectory_estimator_)
+      trajectory_estimator_->begin_transition(this->z_.q);
 
-    ps_point z_fwd(this->z_);  // State at forward end of trajectory
-    ps_point z_bck(z_fwd);     // State at backward end of trajectory
+    ps_point& z_fwd = z_fwd_;  // State at forward end of trajectory
+    ps_point& z_bck = z_bck_;  // State at backward end of trajectory
+    ps_point& z_sample = z_sample_;
+    ps_point& z_propose = z_propose_;
 
-    ps_point z_sample(z_fwd);
-    ps_point z_propose(z_fwd);
+    z_fwd = this->z_;
+    z_bck = z_fwd;
+    z_sample = z_fwd;
+    z_propose = z_fwd;
 
     // Momentum and sharp momentum at forward end of forward subtree
-    Eigen::VectorXd p_fwd_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
+    Eigen::VectorXd& p_fwd_fwd = p_fwd_fwd_;
+    Eigen::VectorXd& p_sharp_fwd_fwd = p_sharp_fwd_fwd_;
+    p_fwd_fwd = this->z_.p;
+    p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
 
     // Momentum and sharp momentum at backward end of forward subtree
-    Eigen::VectorXd p_fwd_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_fwd_bck = p_fwd_bck_;
+    Eigen::VectorXd& p_sharp_fwd_bck = p_sharp_fwd_bck_;
+    p_fwd_bck = this->z_.p;
+    p_sharp_fwd_bck = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at forward end of backward subtree
-    Eigen::VectorXd p_bck_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_fwd = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_fwd = p_bck_fwd_;
+    Eigen::VectorXd& p_sharp_bck_fwd = p_sharp_bck_fwd_;
+    p_bck_fwd = this->z_.p;
+    p_sharp_bck_fwd = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at backward end of backward subtree
-    Eigen::VectorXd p_bck_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_bck = p_bck_bck_;
+    Eigen::VectorXd& p_sharp_bck_bck = p_sharp_bck_bck_;
+    p_bck_bck = this->z_.p;
+    p_sharp_bck_bck = p_sharp_fwd_fwd;
 
     // Integrated momenta along trajectory
-    Eigen::VectorXd rho = this->z_.p.transpose();
+    Eigen::VectorXd& rho = rho_;
+    rho = this->z_.p;
 
-    // Log sum of state weights (offset by H0) along trajectory
-    double log_sum_weight = 0;  // log(exp(H0 - H0))
+    Eigen::VectorXd& rho_fwd = rho_fwd_;
+    Eigen::VectorXd& rho_bck = rho_bck_;
+    Eigen::VectorXd& rho_extended = rho_extended_;
+
+    // Sum of state weights (offset by H0) along trajectory
+    tree_weight sum_weight(0);  // exp(H0 - H0)
     double H0 = this->hamiltonian_.H(this->z_);
     int n_leapfrog = 0;
     double sum_metro_prob = 0;
@@ -119,86 +259,92 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     // criterion is no longer satisfied
     this->depth_ = 0;
     this->divergent_ = false;
-
-    while (this->depth_ < this->max_depth_) {
+    this->capped_ = false;
+    this->aborted_ = false;
+    this->max_delta_H_ = 0;
+    const int max_depth = gradient_budget_.max_depth(this->max_depth_);
+
+    while (this->depth_ < max_depth) {
+      callbacks::trace_scope trace("nuts", "tree_doubling", "depth",
+                                   this->depth_);
       // Build a new subtree in a random direction
-      Eigen::VectorXd rho_fwd = Eigen::VectorXd::Zero(rho.size());
-      Eigen::VectorXd rho_bck = Eigen::VectorXd::Zero(rho.size());
+      rho_fwd.setZero(rho.size());
+      rho_bck.setZero(rho.size());
 
       bool valid_subtree = false;
-      double log_sum_weight_subtree = -std::numeric_limits<double>::infinity();
+      tree_weight sum_weight_subtree;
 
       if (this->rand_uniform_() > 0.5) {
-        // Extend the current trajectory forward
-        this->z_.ps_point::operator=(z_fwd);
+        // Extend the current trajectory forward, swapping its end in and
+        // out of the integrated point rather than copying it
+        this->z_.ps_point::swap(z_fwd);
         rho_bck = rho;
         p_bck_fwd = p_fwd_fwd;
         p_sharp_bck_fwd = p_sharp_fwd_fwd;
 
-        valid_subtree = build_tree(
+        valid_subtree = extend_tree(
             this->depth_, z_propose, p_sharp_fwd_bck, p_sharp_fwd_fwd, rho_fwd,
-            p_fwd_bck, p_fwd_fwd, H0, 1, n_leapfrog, log_sum_weight_subtree,
+            p_fwd_bck, p_fwd_fwd, H0, 1, n_leapfrog, sum_weight_subtree,
             sum_metro_prob, logger);
-        z_fwd.ps_point::operator=(this->z_);
+        this->z_.ps_point::swap(z_fwd);
       } else {
         // Extend the current trajectory backwards
-        this->z_.ps_point::operator=(z_bck);
+        this->z_.ps_point::swap(z_bck);
         rho_fwd = rho;
         p_fwd_bck = p_bck_bck;
         p_sharp_fwd_bck = p_sharp_bck_bck;
 
-        valid_subtree = build_tree(
+        valid_subtree = extend_tree(
             this->depth_, z_propose, p_sharp_bck_fwd, p_sharp_bck_bck, rho_bck,
-            p_bck_fwd, p_bck_bck, H0, -1, n_leapfrog, log_sum_weight_subtree,
+            p_bck_fwd, p_bck_bck, H0, -1, n_leapfrog, sum_weight_subtree,
             sum_metro_prob, logger);
-        z_bck.ps_point::operator=(this->z_);
+        this->z_.ps_point::swap(z_bck);
       }
 
+      if (trajectory_estimator_)
+        trajectory_estimator_->end_subtree(valid_subtree);
+
       if (!valid_subtree)
         break;
 
       // Sample from accepted subtree
       ++(this->depth_);
 
-      if (log_sum_weight_subtree > log_sum_weight) {
-        z_sample = z_propose;
+      // the proposal is rewritten by the next subtree, so it is swapped
+      double accept_prob = sum_weight.ratio(sum_weight_subtree);
+      if (accept_prob > 1) {
+        z_sample.swap(z_propose);
       } else {
-        double accept_prob = std::exp(log_sum_weight_subtree - log_sum_weight);
         if (this->rand_uniform_() < accept_prob)
-          z_sample = z_propose;
+          z_sample.swap(z_propose);
       }
 
-      log_sum_weight
-          = math::log_sum_exp(log_sum_weight, log_sum_weight_subtree);
+      sum_weight.add(sum_weight_subtree);
 
       // Break when no-u-turn criterion is no longer satisfied
-      rho = rho_bck + rho_fwd;
-
-      // Demand satisfaction around merged subtrees
-      bool persist_criterion
-          = compute_criterion(p_sharp_bck_bck, p_sharp_fwd_fwd, rho);
-
-      // Demand satisfaction between subtrees
-      Eigen::VectorXd rho_extended = rho_bck + p_fwd_bck;
-
-      persist_criterion
-          &= compute_criterion(p_sharp_bck_bck, p_sharp_fwd_bck, rho_extended);
-
-      rho_extended = rho_fwd + p_bck_fwd;
-      persist_criterion
-          &= compute_criterion(p_sharp_bck_fwd, p_sharp_fwd_fwd, rho_extended);
-
-      if (!persist_criterion)
+      if (!nuts_tree::merged_criterion(
+              *this, p_sharp_bck_bck, p_sharp_bck_fwd, p_bck_fwd, rho_bck,
+              p_sharp_fwd_bck, p_sharp_fwd_fwd, p_fwd_bck, rho_fwd, rho,
+              rho_extended))
         break;
+
+      this->capped_ = this->depth_ == max_depth && max_depth < this->max_depth_;
     }
 
     this->n_leapfrog_ = n_leapfrog;
+    gradient_budget_.record(n_leapfrog, this->capped_);
+    early_abort_.record(std::min(this->max_delta_H_, this->max_deltaH_),
+                        this->aborted_);
+
+    // a trajectory cut short by a stop request is not averaged
+    if (trajectory_estimator_ && !this->stop_requested())
+      trajectory_estimator_->end_transition();
 
     // Compute average acceptance probability across entire trajectory,
     // even over subtrees that may have been rejected
     double accept_prob = sum_metro_prob / static_cast<double>(n_leapfrog);
 
-    this->z_.ps_point::operator=(z_sample);
+    this->z_.ps_point::swap(z_sample);
     this->energy_ = this->hamiltonian_.H(this->z_);
     return sample(this->z_.q, -this->z_.V, accept_prob);
   }
@@ -209,6 +355,10 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     names.push_back("n_leapfrog__");
     names.push_back("divergent__");
     names.push_back("energy__");
+    if (gradient_budget_.enabled())
+      names.push_back("budget_capped__");
+    if (early_abort_.enabled())
+      names.push_back("aborted__");
   }
 
   void get_sampler_params(std::vector<double>& values) {
@@ -217,6 +367,10 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     values.push_back(this->n_leapfrog_);
     values.push_back(this->divergent_);
     values.push_back(this->energy_);
+    if (gradient_budget_.enabled())
+      values.push_back(this->capped_);
+    if (early_abort_.enabled())
+      values.push_back(this->aborted_);
   }
 
   virtual bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
@@ -225,6 +379,20 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     return p_sharp_plus.dot(rho) > 0 && p_sharp_minus.dot(rho) > 0;
   }
 
+  /**
+   * Evaluate the no-U-turn criterion of the tree builder, with a direct
+   * call to the criterion of <code>Derived</code> when there is one.
+   */
+  inline bool criterion(Eigen::VectorXd& p_sharp_minus,
+                        Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    if constexpr (std::is_void<Derived>::value) {
+      return compute_criterion(p_sharp_minus, p_sharp_plus, rho);
+    } else {
+      return static_cast<Derived*>(this)->Derived::compute_criterion(
+          p_sharp_minus, p_sharp_plus, rho);
+    }
+  }
+
   /**
    * Recursively build a new subtree to completion or until
    * the subtree becomes invalid.  Returns validity of the
@@ -249,106 +417,214 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
                   Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end, double H0,
                   double sign, int& n_leapfrog, double& log_sum_weight,
                   double& sum_metro_prob, callbacks::logger& logger) {
-    // Base case
-    if (depth == 0) {
+    tree_weight sum_weight(log_sum_weight);
+    bool valid_subtree
+        = build_tree(depth, z_propose, p_sharp_beg, p_sharp_end, rho, p_beg,
+                     p_end, H0, sign, n_leapfrog, sum_weight, sum_metro_prob,
+                     logger);
+    log_sum_weight = sum_weight.log();
+    return valid_subtree;
+  }
+
+  /**
+   * Recursively build a new subtree as <code>build_tree</code> does,
+   * accumulating the weights of the states without taking logs, with the
+   * tree builder of <code>nuts_tree</code>.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param sum_weight Summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  bool build_tree(int depth, ps_point& z_propose, Eigen::VectorXd& p_sharp_beg,
+                  Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                  Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end, double H0,
+                  double sign, int& n_leapfrog, tree_weight& sum_weight,
+                  double& sum_metro_prob, callbacks::logger& logger) {
+    return nuts_tree::build_tree(*this, depth, z_propose, p_sharp_beg,
+                                 p_sharp_end, rho, p_beg, p_end, H0, sign,
+                                 n_leapfrog, sum_weight, sum_metro_prob,
+                                 logger);
+  }
+
+  /**
+   * Build a new subtree with the same semantics, arguments, and random
+   * number consumption as <code>build_tree</code>, but without
+   * recursion.  Leaves are generated in trajectory order and completed
+   * subtrees are merged bottom up, with the pending initial subtree at
+   * each depth held in a flat array of checkpoints.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param sum_weight Summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  bool build_tree_iterative(int depth, ps_point& z_propose,
+                            Eigen::VectorXd& p_sharp_beg,
+                            Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                            Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end,
+                            double H0, double sign, int& n_leapfrog,
+                            tree_weight& sum_weight, double& sum_metro_prob,
+                            callbacks::logger& logger) {
+    if (static_cast<size_t>(depth) >= tree_checkpoints_.size())
+      resize_checkpoints(depth + 1);
+
+    // Checkpoint k holds a completed initial subtree of depth k waiting
+    // for its final sibling; checkpoint depth holds the current subtree.
+    tree_checkpoint& current = tree_checkpoints_[depth];
+    Eigen::VectorXd& rho_subtree = tree_rho_subtree_;
+    Eigen::VectorXd& rho_extended = tree_rho_extended_;
+
+    const uint64_t n_leaves = uint64_t(1) << depth;
+    for (uint64_t leaf = 0; leaf < n_leaves; ++leaf) {
+      if (n_leapfrog > 0 && this->stop_requested())
+        return false;
       this->integrator_.evolve(this->z_, this->hamiltonian_,
                                sign * this->epsilon_, logger);
       ++n_leapfrog;
 
-      double h = this->hamiltonian_.H(this->z_);
+      double h
+          = this->hamiltonian_.H_dtau_dp(this->z_, current.p_sharp_beg);
       if (std::isnan(h))
         h = std::numeric_limits<double>::infinity();
 
-      if ((h - H0) > this->max_deltaH_)
-        this->divergent_ = true;
+      const bool valid = check_energy_error(h - H0);
 
-      log_sum_weight = math::log_sum_exp(log_sum_weight, H0 - h);
+      current.sum_weight = depth == 0 ? sum_weight : tree_weight();
+      current.sum_weight.add(H0 - h);
+      if (trajectory_estimator_)
+        trajectory_estimator_->add_leaf(H0 - h, this->z_.q);
 
       if (H0 - h > 0)
         sum_metro_prob += 1;
       else
         sum_metro_prob += std::exp(H0 - h);
 
-      z_propose = this->z_;
-
-      p_sharp_beg = this->hamiltonian_.dtau_dp(this->z_);
-      p_sharp_end = p_sharp_beg;
-
-      rho += this->z_.p;
-      p_beg = this->z_.p;
-      p_end = p_beg;
-
-      return !this->divergent_;
-    }
-    // General recursion
-
-    // Build the initial subtree
-    double log_sum_weight_init = -std::numeric_limits<double>::infinity();
+      current.z_propose = this->z_;
 
-    // Momentum and sharp momentum at end of the initial subtree
-    Eigen::VectorXd p_init_end(this->z_.p.size());
-    Eigen::VectorXd p_sharp_init_end(this->z_.p.size());
+      current.p_sharp_end = current.p_sharp_beg;
 
-    Eigen::VectorXd rho_init = Eigen::VectorXd::Zero(rho.size());
+      current.rho = this->z_.p;
+      current.p_beg = this->z_.p;
+      current.p_end = current.p_beg;
 
-    bool valid_init
-        = build_tree(depth - 1, z_propose, p_sharp_beg, p_sharp_init_end,
-                     rho_init, p_beg, p_init_end, H0, sign, n_leapfrog,
-                     log_sum_weight_init, sum_metro_prob, logger);
-
-    if (!valid_init)
-      return false;
+      if (depth == 0)
+        break;
 
-    // Build the final subtree
-    ps_point z_propose_final(this->z_);
+      if (!valid)
+        return false;
 
-    double log_sum_weight_final = -std::numeric_limits<double>::infinity();
+      // Merge every initial subtree that the new leaf completes
+      int level = 0;
+      for (; (leaf >> level) & 1; ++level) {
+        tree_checkpoint& init = tree_checkpoints_[level];
 
-    // Momentum and sharp momentum at beginning of the final subtree
-    Eigen::VectorXd p_final_beg(this->z_.p.size());
-    Eigen::VectorXd p_sharp_final_beg(this->z_.p.size());
+        // Multinomial sample from right subtree
+        tree_weight sum_weight_subtree = init.sum_weight;
+        sum_weight_subtree.add(current.sum_weight);
 
-    Eigen::VectorXd rho_final = Eigen::VectorXd::Zero(rho.size());
+        double accept_prob = sum_weight_subtree.ratio(current.sum_weight);
+        if (!(accept_prob > 1)) {
+          if (!(this->rand_uniform_() < accept_prob))
+            std::swap(init.z_propose, current.z_propose);
+        }
 
-    bool valid_final
-        = build_tree(depth - 1, z_propose_final, p_sharp_final_beg, p_sharp_end,
-                     rho_final, p_final_beg, p_end, H0, sign, n_leapfrog,
-                     log_sum_weight_final, sum_metro_prob, logger);
+        current.sum_weight = level + 1 == depth ? sum_weight : tree_weight();
+        current.sum_weight.add(sum_weight_subtree);
 
-    if (!valid_final)
-      return false;
+        if (!nuts_tree::merged_criterion(
+                *this, init.p_sharp_beg, init.p_sharp_end, init.p_end,
+                init.rho, current.p_sharp_beg, current.p_sharp_end,
+                current.p_beg, current.rho, rho_subtree, rho_extended))
+          return false;
 
-    // Multinomial sample from right subtree
-    double log_sum_weight_subtree
-        = math::log_sum_exp(log_sum_weight_init, log_sum_weight_final);
-    log_sum_weight = math::log_sum_exp(log_sum_weight, log_sum_weight_subtree);
+        current.p_sharp_beg.swap(init.p_sharp_beg);
+        current.p_beg.swap(init.p_beg);
+        current.rho.swap(rho_subtree);
+      }
 
-    if (log_sum_weight_final > log_sum_weight_subtree) {
-      z_propose = z_propose_final;
-    } else {
-      double accept_prob
-          = std::exp(log_sum_weight_final - log_sum_weight_subtree);
-      if (this->rand_uniform_() < accept_prob)
-        z_propose = z_propose_final;
+      // Park the completed initial subtree until its sibling is built
+      if (level < depth)
+        std::swap(tree_checkpoints_[level], current);
     }
 
-    Eigen::VectorXd rho_subtree = rho_init + rho_final;
-    rho += rho_subtree;
+    z_propose.swap(current.z_propose);
+    p_sharp_beg = current.p_sharp_beg;
+    p_sharp_end = current.p_sharp_end;
+    p_beg = current.p_beg;
+    p_end = current.p_end;
+    rho += current.rho;
+    sum_weight = current.sum_weight;
 
-    // Demand satisfaction around merged subtrees
-    bool persist_criterion
-        = compute_criterion(p_sharp_beg, p_sharp_end, rho_subtree);
+    return !this->divergent_ && !this->aborted_;
+  }
 
-    // Demand satisfaction between subtrees
-    rho_subtree = rho_init + p_final_beg;
-    persist_criterion
-        &= compute_criterion(p_sharp_beg, p_sharp_final_beg, rho_subtree);
+  /**
+   * Build a new subtree with the engine selected by
+   * <code>set_iterative_tree</code>.  See <code>build_tree</code> for
+   * a description of the arguments.
+   */
+  bool extend_tree(int depth, ps_point& z_propose, Eigen::VectorXd& p_sharp_beg,
+                   Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                   Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end, double H0,
+                   double sign, int& n_leapfrog, double& log_sum_weight,
+                   double& sum_metro_prob, callbacks::logger& logger) {
+    tree_weight sum_weight(log_sum_weight);
+    bool valid_subtree
+        = extend_tree(depth, z_propose, p_sharp_beg, p_sharp_end, rho, p_beg,
+                      p_end, H0, sign, n_leapfrog, sum_weight, sum_metro_prob,
+                      logger);
+    log_sum_weight = sum_weight.log();
+    return valid_subtree;
+  }
 
-    rho_subtree = rho_final + p_init_end;
-    persist_criterion
-        &= compute_criterion(p_sharp_init_end, p_sharp_end, rho_subtree);
+  bool extend_tree(int depth, ps_point& z_propose, Eigen::VectorXd& p_sharp_beg,
+                   Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                   Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end, double H0,
+                   double sign, int& n_leapfrog, tree_weight& sum_weight,
+                   double& sum_metro_prob, callbacks::logger& logger) {
+    if (iterative_tree_)
+      return build_tree_iterative(depth, z_propose, p_sharp_beg, p_sharp_end,
+                                  rho, p_beg, p_end, H0, sign, n_leapfrog,
+                                  sum_weight, sum_metro_prob, logger);
+    return build_tree(depth, z_propose, p_sharp_beg, p_sharp_end, rho, p_beg,
+                      p_end, H0, sign, n_leapfrog, sum_weight, sum_metro_prob,
+                      logger);
+  }
 
-    return persist_criterion;
+  /**
+   * Record the energy error of a new state of the trajectory, flagging a
+   * divergence or a subtree doomed by the early abort threshold, and
+   * return whether the subtree may go on.
+   *
+   * @param delta_H Hamiltonian of the state less the one of the initial
+   * state
+   */
+  bool check_energy_error(double delta_H) {
+    this->max_delta_H_ = std::max(this->max_delta_H_, delta_H);
+    if (delta_H > this->max_deltaH_)
+      this->divergent_ = true;
+    else if (early_abort_.doomed(delta_H))
+      this->aborted_ = true;
+    return !this->divergent_ && !this->aborted_;
   }
 
   int depth_;
@@ -358,6 +634,188 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int n_leapfrog_;
   bool divergent_;
   double energy_;
+
+  gradient_budget gradient_budget_;
+  bool capped_;
+
+  early_abort early_abort_;
+  bool aborted_;
+  double max_delta_H_;
+
+ protected:
+  friend struct nuts_tree;
+
+  /**
+   * Temporaries used by a single level of <code>build_tree</code>.
+   */
+  struct tree_level_workspace {
+    explicit tree_level_workspace(int n)
+        : z_propose_final(n),
+          p_init_end(n),
+          p_sharp_init_end(n),
+          rho_init(n),
+          p_final_beg(n),
+          p_sharp_final_beg(n),
+          rho_final(n),
+          rho_subtree(n),
+          rho_extended(n) {}
+
+    ps_point z_propose_final;
+    Eigen::VectorXd p_init_end;
+    Eigen::VectorXd p_sharp_init_end;
+    Eigen::VectorXd rho_init;
+    Eigen::VectorXd p_final_beg;
+    Eigen::VectorXd p_sharp_final_beg;
+    Eigen::VectorXd rho_final;
+    Eigen::VectorXd rho_subtree;
+    Eigen::VectorXd rho_extended;
+  };
+
+  /**
+   * Summary of a completed subtree used by
+   * <code>build_tree_iterative</code>.
+   */
+  struct tree_checkpoint {
+    explicit tree_checkpoint(int n)
+        : z_propose(n),
+          p_sharp_beg(n),
+          p_sharp_end(n),
+          p_beg(n),
+          p_end(n),
+          rho(n),
+          sum_weight(0) {}
+
+    ps_point z_propose;
+    Eigen::VectorXd p_sharp_beg;
+    Eigen::VectorXd p_sharp_end;
+    Eigen::VectorXd p_beg;
+    Eigen::VectorXd p_end;
+    Eigen::VectorXd rho;
+    tree_weight sum_weight;
+  };
+
+  /**
+   * Grow the iterative tree checkpoints to hold the given number of
+   * subtree summaries.
+   *
+   * @param n_checkpoints Number of checkpoints to allocate
+   */
+  void resize_checkpoints(int n_checkpoints) {
+    const int n = this->z_.q.size();
+    tree_checkpoints_.reserve(n_checkpoints);
+    while (static_cast<int>(tree_checkpoints_.size()) < n_checkpoints)
+      tree_checkpoints_.emplace_back(n);
+  }
+
+  /**
+   * Grow the per-depth workspace so that trees of the given depth can
+   * be built without allocating.  The levels live in a
+   * <code>std::deque</code>, whose <code>emplace_back</code> never moves
+   * the existing levels, so references into the workspace held by other
+   * levels of an in-progress recursion stay valid whenever it grows.
+   *
+   * @param depth Number of recursion levels to allocate
+   */
+  void resize_workspace(int depth) {
+    const int n = this->z_.q.size();
+    while (static_cast<int>(tree_workspace_.size()) < depth)
+      tree_workspace_.emplace_back(n);
+  }
+
+  /**
+   * Return the workspace of the level of <code>build_tree</code> that
+   * builds a subtree of the given depth, growing the workspace if needed.
+   *
+   * @param depth Depth of the subtree, at least one
+   */
+  tree_level_workspace& tree_level(int depth) {
+    if (static_cast<size_t>(depth) > tree_workspace_.size())
+      resize_workspace(depth);
+    return tree_workspace_[depth - 1];
+  }
+
+  /**
+   * Take a leapfrog step of the current step size from the integrated
+   * point, in the direction of the sign, and return the Hamiltonian at
+   * the new point.
+   *
+   * @param sign Direction in time of the step
+   * @param p_sharp Sharp momentum at the new point
+   * @param logger Logger for messages
+   */
+  double leapfrog(double sign, Eigen::VectorXd& p_sharp,
+                  callbacks::logger& logger) {
+    this->integrator_.evolve(this->z_, this->hamiltonian_,
+                             sign * this->epsilon_, logger);
+    return this->hamiltonian_.H_dtau_dp(this->z_, p_sharp);
+  }
+
+  /**
+   * Pass the integrated point, a new state of the trajectory, to the
+   * trajectory estimator if there is one.
+   *
+   * @param log_weight log weight of the state
+   */
+  void record_leaf(double log_weight) {
+    if (trajectory_estimator_)
+      trajectory_estimator_->add_leaf(log_weight, this->z_.q);
+  }
+
+  /**
+   * Size all buffers used by <code>transition</code> for the current
+   * maximum tree depth.
+   */
+  void resize_workspace() {
+    const int n = this->z_.q.size();
+    p_fwd_fwd_.resize(n);
+    p_sharp_fwd_fwd_.resize(n);
+    p_fwd_bck_.resize(n);
+    p_sharp_fwd_bck_.resize(n);
+    p_bck_fwd_.resize(n);
+    p_sharp_bck_fwd_.resize(n);
+    p_bck_bck_.resize(n);
+    p_sharp_bck_bck_.resize(n);
+    rho_.resize(n);
+    rho_fwd_.resize(n);
+    rho_bck_.resize(n);
+    rho_extended_.resize(n);
+    tree_rho_subtree_.resize(n);
+    tree_rho_extended_.resize(n);
+    resize_workspace(max_depth_);
+    if (iterative_tree_)
+      resize_checkpoints(max_depth_ + 1);
+  }
+
+  bool iterative_tree_;
+  trajectory_estimator* trajectory_estimator_;
+
+  // Trajectory endpoints and proposals reused across transitions
+  ps_point z_fwd_;
+  ps_point z_bck_;
+  ps_point z_sample_;
+  ps_point z_propose_;
+
+  Eigen::VectorXd p_fwd_fwd_;
+  Eigen::VectorXd p_sharp_fwd_fwd_;
+  Eigen::VectorXd p_fwd_bck_;
+  Eigen::VectorXd p_sharp_fwd_bck_;
+  Eigen::VectorXd p_bck_fwd_;
+  Eigen::VectorXd p_sharp_bck_fwd_;
+  Eigen::VectorXd p_bck_bck_;
+  Eigen::VectorXd p_sharp_bck_bck_;
+  Eigen::VectorXd rho_;
+  Eigen::VectorXd rho_fwd_;
+  Eigen::VectorXd rho_bck_;
+  Eigen::VectorXd rho_extended_;
+
+  // One entry per level of build_tree, indexed by depth - 1; a deque so
+  // that growing it keeps references to the existing levels valid
+  std::deque<tree_level_workspace> tree_workspace_;
+
+  // Pending subtrees of build_tree_iterative, indexed by depth
+  std::vector<tree_checkpoint> tree_checkpoints_;
+  Eigen::VectorXd tree_rho_subtree_;
+  Eigen::VectorXd tree_rho_extended_;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,369 @@
+#ifndef STAN_MCMC_HMC_NUTS_BASE_SPECULATIVE_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_BASE_SPECULATIVE_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/tree_weight.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <tbb/task_group.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling, building
+ * subtrees speculatively in parallel.
+ *
+ * The direction of every doubling is drawn up front.  Whenever two
+ * consecutive doublings extend opposite ends of the trajectory the
+ * second subtree does not depend on the first, so both are built
+ * concurrently with <code>tbb::task_group</code>.  If the first
+ * subtree terminates the trajectory the speculative one is discarded.
+ * Building on two threads needs an autodiff stack per thread, so
+ * without <code>STAN_THREADS</code> nothing is built speculatively and
+ * each subtree is built on the calling thread when it is reached.
+ *
+ * Each subtree draws its multinomial proposals from its own generator,
+ * seeded from the chain's generator before the trajectory is built, so
+ * the draws are reproducible regardless of thread scheduling.  They
+ * are not the same draws as <code>base_nuts</code>, but they are the
+ * same with and without <code>STAN_THREADS</code>.
+ *
+ * Subtrees are built by helper samplers that defer to this sampler's
+ * <code>compute_criterion</code>, so with <code>STAN_THREADS</code>
+ * overrides of it and the logger may be called concurrently.
+ *
+ * @tparam Model The type of the Stan model.
+ * @tparam Hamiltonian The type of Hamiltonians over the (unconstrained)
+ * parameter space.
+ * @tparam Integrator The type of integrator (e.g. leapfrog).
+ * @tparam BaseRNG The type of random number generator; must be default
+ * constructible and support <code>seed()</code>.
+ */
+template <class Model, template <class, class> class Hamiltonian,
+          template <class> class Integrator, class BaseRNG>
+class base_speculative_nuts
+    : public base_nuts<Model, Hamiltonian, Integrator, BaseRNG> {
+ public:
+  base_speculative_nuts(const Model& model, BaseRNG& rng)
+      : base_nuts<Model, Hamiltonian, Integrator, BaseRNG>(model, rng),
+        even_rng_(),
+        odd_rng_(),
+        even_builder_(model, even_rng_, *this),
+        odd_builder_(model, odd_rng_, *this),
+        even_subtree_(this->z_.q.size()),
+        odd_subtree_(this->z_.q.size()),
+        n_speculative_(0) {}
+
+  ~base_speculative_nuts() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    // the subtrees stop on the interrupt of this sampler
+    even_builder_.set_interrupt(this->get_interrupt());
+    odd_builder_.set_interrupt(this->get_interrupt());
+
+    // Initialize the algorithm
+    this->sample_stepsize();
+
+    this->seed(init_sample.cont_params());
+
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    this->hamiltonian_.init(this->z_, logger);
+
+    // Subtree builders share the metric, step size and settings
+    for (auto* builder : {&even_builder_, &odd_builder_}) {
+      builder->z() = this->z_;
+      builder->set_nominal_stepsize(this->epsilon_);
+      builder->sample_stepsize();
+      builder->set_max_depth(this->max_depth_);
+      builder->set_max_delta(this->max_deltaH_);
+      builder->early_abort_ = this->early_abort_;
+      builder->set_iterative_tree(this->get_iterative_tree());
+    }
+
+    // Directions and subtree seeds for every possible doubling
+    forward_.resize(this->max_depth_);
+    seeds_.resize(this->max_depth_);
+    for (int j = 0; j < this->max_depth_; ++j) {
+      forward_[j] = this->rand_uniform_() > 0.5;
+      seeds_[j] = this->rand_int_();
+    }
+
+    ps_point& z_fwd = this->z_fwd_;  // State at forward end of trajectory
+    ps_point& z_bck = this->z_bck_;  // State at backward end of trajectory
+    ps_point& z_sample = this->z_sample_;
+
+    z_fwd = this->z_;
+    z_bck = z_fwd;
+    z_sample = z_fwd;
+
+    // Momentum and sharp momentum at forward end of forward subtree
+    Eigen::VectorXd& p_fwd_fwd = this->p_fwd_fwd_;
+    Eigen::VectorXd& p_sharp_fwd_fwd = this->p_sharp_fwd_fwd_;
+    p_fwd_fwd = this->z_.p;
+    p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
+
+    // Momentum and sharp momentum at backward end of forward subtree
+    Eigen::VectorXd& p_fwd_bck = this->p_fwd_bck_;
+    Eigen::VectorXd& p_sharp_fwd_bck = this->p_sharp_fwd_bck_;
+    p_fwd_bck = this->z_.p;
+    p_sharp_fwd_bck = p_sharp_fwd_fwd;
+
+    // Momentum and sharp momentum at forward end of backward subtree
+    Eigen::VectorXd& p_bck_fwd = this->p_bck_fwd_;
+    Eigen::VectorXd& p_sharp_bck_fwd = this->p_sharp_bck_fwd_;
+    p_bck_fwd = this->z_.p;
+    p_sharp_bck_fwd = p_sharp_fwd_fwd;
+
+    // Momentum and sharp momentum at backward end of backward subtree
+    Eigen::VectorXd& p_bck_bck = this->p_bck_bck_;
+    Eigen::VectorXd& p_sharp_bck_bck = this->p_sharp_bck_bck_;
+    p_bck_bck = this->z_.p;
+    p_sharp_bck_bck = p_sharp_fwd_fwd;
+
+    // Integrated momenta along trajectory
+    Eigen::VectorXd& rho = this->rho_;
+    rho = this->z_.p;
+
+    Eigen::VectorXd& rho_fwd = this->rho_fwd_;
+    Eigen::VectorXd& rho_bck = this->rho_bck_;
+    Eigen::VectorXd& rho_extended = this->rho_extended_;
+
+    // Sum of state weights (offset by H0) along trajectory
+    tree_weight sum_weight(0);  // exp(H0 - H0)
+    double H0 = this->hamiltonian_.H(this->z_);
+    int n_leapfrog = 0;
+    double sum_metro_prob = 0;
+
+    // Build a trajectory until the no-u-turn
+    // criterion is no longer satisfied
+    this->depth_ = 0;
+    this->divergent_ = false;
+    this->capped_ = false;
+    this->aborted_ = false;
+    this->max_delta_H_ = 0;
+    n_speculative_ = 0;
+    const int max_depth = this->gradient_budget_.max_depth(this->max_depth_);
+
+    // Doubling whose subtree has already been built speculatively
+    int prebuilt = -1;
+
+    while (this->depth_ < max_depth) {
+      const int j = this->depth_;
+      subtree& tree = subtree_for(j);
+
+      if (prebuilt != j) {
+        if (stan::model::internal::threads_have_autodiff_stacks
+            && j + 1 < max_depth && forward_[j + 1] != forward_[j]) {
+          tbb::task_group group;
+          group.run([&] { build_subtree(j, H0, logger); });
+          group.run([&] { build_subtree(j + 1, H0, logger); });
+          group.wait();
+          prebuilt = j + 1;
+          ++n_speculative_;
+        } else {
+          build_subtree(j, H0, logger);
+        }
+      }
+
+      if (forward_[j]) {
+        // Extend the current trajectory forward
+        rho_bck = rho;
+        p_bck_fwd = p_fwd_fwd;
+        p_sharp_bck_fwd = p_sharp_fwd_fwd;
+
+        p_sharp_fwd_bck = tree.p_sharp_beg;
+        p_sharp_fwd_fwd = tree.p_sharp_end;
+        rho_fwd = tree.rho;
+        p_fwd_bck = tree.p_beg;
+        p_fwd_fwd = tree.p_end;
+        z_fwd.swap(tree.z_end);
+      } else {
+        // Extend the current trajectory backwards
+        rho_fwd = rho;
+        p_fwd_bck = p_bck_bck;
+        p_sharp_fwd_bck = p_sharp_bck_bck;
+
+        p_sharp_bck_fwd = tree.p_sharp_beg;
+        p_sharp_bck_bck = tree.p_sharp_end;
+        rho_bck = tree.rho;
+        p_bck_fwd = tree.p_beg;
+        p_bck_bck = tree.p_end;
+        z_bck.swap(tree.z_end);
+      }
+
+      n_leapfrog += tree.n_leapfrog;
+      sum_metro_prob += tree.sum_metro_prob;
+      if (tree.divergent)
+        this->divergent_ = true;
+      if (tree.aborted)
+        this->aborted_ = true;
+      this->max_delta_H_ = std::max(this->max_delta_H_, tree.max_delta_H);
+
+      if (!tree.valid)
+        break;
+
+      // Sample from accepted subtree
+      ++(this->depth_);
+
+      // the points of a subtree are rewritten by its next build, so they
+      // are swapped out of it rather than copied
+      double accept_prob = sum_weight.ratio(tree.sum_weight);
+      if (accept_prob > 1) {
+        z_sample.swap(tree.z_propose);
+      } else {
+        if (this->rand_uniform_() < accept_prob)
+          z_sample.swap(tree.z_propose);
+      }
+
+      sum_weight.add(tree.sum_weight);
+
+      // Break when no-u-turn criterion is no longer satisfied
+      if (!nuts_tree::merged_criterion(
+              *this, p_sharp_bck_bck, p_sharp_bck_fwd, p_bck_fwd, rho_bck,
+              p_sharp_fwd_bck, p_sharp_fwd_fwd, p_fwd_bck, rho_fwd, rho,
+              rho_extended))
+        break;
+
+      this->capped_ = this->depth_ == max_depth && max_depth < this->max_depth_;
+    }
+
+    this->n_leapfrog_ = n_leapfrog;
+    this->gradient_budget_.record(n_leapfrog, this->capped_);
+    this->early_abort_.record(
+        std::min(this->max_delta_H_, this->max_deltaH_), this->aborted_);
+
+    // Compute average acceptance probability across entire trajectory,
+    // even over subtrees that may have been rejected
+    double accept_prob = sum_metro_prob / static_cast<double>(n_leapfrog);
+
+    this->z_.ps_point::swap(z_sample);
+    this->energy_ = this->hamiltonian_.H(this->z_);
+    return sample(this->z_.q, -this->z_.V, accept_prob);
+  }
+
+  /**
+   * Number of doublings in the last transition whose successor was
+   * built concurrently.
+   */
+  int get_n_speculative() const noexcept { return n_speculative_; }
+
+ protected:
+  /**
+   * Result of building one subtree off an end of the trajectory.
+   */
+  struct subtree {
+    explicit subtree(int n)
+        : z_end(n),
+          z_propose(n),
+          p_sharp_beg(n),
+          p_sharp_end(n),
+          rho(n),
+          p_beg(n),
+          p_end(n),
+          sum_weight(0),
+          sum_metro_prob(0),
+          n_leapfrog(0),
+          max_delta_H(0),
+          valid(false),
+          divergent(false),
+          aborted(false) {}
+
+    ps_point z_end;
+    ps_point z_propose;
+    Eigen::VectorXd p_sharp_beg;
+    Eigen::VectorXd p_sharp_end;
+    Eigen::VectorXd rho;
+    Eigen::VectorXd p_beg;
+    Eigen::VectorXd p_end;
+    tree_weight sum_weight;
+    double sum_metro_prob;
+    int n_leapfrog;
+    double max_delta_H;
+    bool valid;
+    bool divergent;
+    bool aborted;
+  };
+
+  using nuts_t = base_nuts<Model, Hamiltonian, Integrator, BaseRNG>;
+
+  /**
+   * Sampler used to build a single subtree with its own state and
+   * generator, evaluating the no-u-turn criterion of its owner.
+   */
+  class builder_t : public nuts_t {
+   public:
+    builder_t(const Model& model, BaseRNG& rng, nuts_t& owner)
+        : nuts_t(model, rng), owner_(owner) {}
+
+    bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                           Eigen::VectorXd& p_sharp_plus,
+                           Eigen::VectorXd& rho) {
+      return owner_.compute_criterion(p_sharp_minus, p_sharp_plus, rho);
+    }
+
+   private:
+    nuts_t& owner_;
+  };
+
+  // Consecutive doublings never share a builder, generator or result
+  BaseRNG& rng_for(int j) { return j % 2 ? odd_rng_ : even_rng_; }
+  builder_t& builder_for(int j) { return j % 2 ? odd_builder_ : even_builder_; }
+  subtree& subtree_for(int j) { return j % 2 ? odd_subtree_ : even_subtree_; }
+
+  /**
+   * Build the subtree for doubling <code>j</code> from the end of the
+   * trajectory selected by the pre-drawn direction.  Only touches
+   * state owned by doubling <code>j</code>'s parity, so it may run
+   * concurrently with the build for doubling <code>j + 1</code>.
+   *
+   * @param j Index of the doubling, which is also the subtree depth
+   * @param H0 Hamiltonian of initial state
+   * @param logger Logger for messages
+   */
+  void build_subtree(int j, double H0, callbacks::logger& logger) {
+    rng_for(j).seed(seeds_[j]);
+    builder_t& builder = builder_for(j);
+    subtree& tree = subtree_for(j);
+
+    builder.z().ps_point::operator=(forward_[j] ? this->z_fwd_
+                                                : this->z_bck_);
+    builder.divergent_ = false;
+    builder.aborted_ = false;
+    builder.max_delta_H_ = 0;
+
+    tree.rho.setZero(this->z_.q.size());
+    tree.sum_weight = tree_weight();
+    tree.n_leapfrog = 0;
+    tree.sum_metro_prob = 0;
+
+    tree.valid = builder.extend_tree(
+        j, tree.z_propose, tree.p_sharp_beg, tree.p_sharp_end, tree.rho,
+        tree.p_beg, tree.p_end, H0, forward_[j] ? 1 : -1, tree.n_leapfrog,
+        tree.sum_weight, tree.sum_metro_prob, logger);
+    tree.divergent = builder.divergent_;
+    tree.aborted = builder.aborted_;
+    tree.max_delta_H = builder.max_delta_H_;
+    tree.z_end.swap(builder.z());
+  }
+
+  BaseRNG even_rng_;
+  BaseRNG odd_rng_;
+  builder_t even_builder_;
+  builder_t odd_builder_;
+  subtree even_subtree_;
+  subtree odd_subtree_;
+
+  std::vector<bool> forward_;
+  std::vector<typename BaseRNG::result_type> seeds_;
+  int n_speculative_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,49 @@
+#ifndef STAN_MCMC_HMC_NUTS_BLOCK_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_BLOCK_E_NUTS_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/hamiltonians/block_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/block_e_metric.hpp>
+#include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and block diagonal
+ * dense metric
+ */
+template <class Model, class BaseRNG>
+class block_e_nuts : public base_nuts<Model, block_e_metric, expl_leapfrog,
+                                      BaseRNG, block_e_nuts<Model, BaseRNG>> {
+ public:
+  block_e_nuts(const Model& model, BaseRNG& rng)
+      : base_nuts<Model, block_e_metric, expl_leapfrog, BaseRNG,
+                  block_e_nuts<Model, BaseRNG>>(model, rng) {}
+
+  void set_metric(const std::vector<Eigen::MatrixXd>& inv_e_metric) {
+    this->z_.set_metric(inv_e_metric);
+  }
+
+  /**
+   * write stepsize, the sizes of the blocks of the inverse metric and
+   * each block as a JSON object
+   */
+  void write_sampler_state_struct(callbacks::structured_writer& struct_writer) {
+    struct_writer.begin_record();
+    struct_writer.write("stepsize", this->get_nominal_stepsize());
+    struct_writer.write("metric_type", this->z_.metric_type());
+    struct_writer.write("inv_metric_block_sizes", this->z_.block_sizes());
+    for (size_t b = 0; b < this->z_.inv_e_metric_.size(); ++b)
+      struct_writer.write("inv_metric_block_" + std::to_string(b + 1),
+                          this->z_.inv_e_metric_[b]);
+    struct_writer.end_record();
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -13,11 +13,12 @@ namespace mcmc {
  * with a Gaussian-Euclidean disintegration and dense metric
  */
 template <class Model, class BaseRNG>
-class dense_e_nuts
-    : public base_nuts<Model, dense_e_metric, expl_leapfrog, BaseRNG> {
+class dense_e_nuts : public base_nuts<Model, dense_e_metric, expl_leapfrog,
+                                      BaseRNG, dense_e_nuts<Model, BaseRNG>> {
  public:
   dense_e_nuts(const Model& model, BaseRNG& rng)
-      : base_nuts<Model, dense_e_metric, expl_leapfrog, BaseRNG>(model, rng) {}
+      : base_nuts<Model, dense_e_metric, expl_leapfrog, BaseRNG,
+                  dense_e_nuts<Model, BaseRNG>>(model, rng) {}
 };
 
 }  // namespace mcmc
@@ -13,11 +13,12 @@ namespace mcmc {
  * with a Gaussian-Euclidean disintegration and diagonal metric
  */
 template <class Model, class BaseRNG>
-class diag_e_nuts
-    : public base_nuts<Model, diag_e_metric, expl_leapfrog, BaseRNG> {
+class diag_e_nuts : public base_nuts<Model, diag_e_metric, expl_leapfrog,
+                                     BaseRNG, diag_e_nuts<Model, BaseRNG>> {
  public:
   diag_e_nuts(const Model& model, BaseRNG& rng)
-      : base_nuts<Model, diag_e_metric, expl_leapfrog, BaseRNG>(model, rng) {}
+      : base_nuts<Model, diag_e_metric, expl_leapfrog, BaseRNG,
+                  diag_e_nuts<Model, BaseRNG>>(model, rng) {}
 };
 
 }  // namespace mcmc
@@ -0,0 +1,554 @@
+#ifndef STAN_MCMC_HMC_NUTS_FIXED_DIAG_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_FIXED_DIAG_E_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/base_adapter.hpp>
+#include <stan/mcmc/base_mcmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/fixed_diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/rejection_reporter.hpp>
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_tree.hpp>
+#include <stan/mcmc/hmc/tree_weight.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stan/model/gradient_evaluator.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling with a
+ * Gaussian-Euclidean disintegration and diagonal metric, for models
+ * whose number of unconstrained parameters is fixed at compile time.
+ *
+ * This is <code>diag_e_nuts</code> with its point, metric and leapfrog
+ * integrator specialized to <code>N</code> dimensions: every vector of
+ * the sampler state is a fixed-size vector on the stack, so a transition
+ * allocates nothing besides the sample it returns, and the compiler
+ * unrolls the loops over the dimensions.  The trees are built, and the
+ * no-U-turn criterion evaluated, by the code of <code>base_nuts</code>
+ * in <code>nuts_tree</code>, with the scratch space of each level of the
+ * recursion on the stack.  For
+ * models with a handful of parameters this removes most of the cost of
+ * a transition besides the gradients.  Given the same random number
+ * generator it makes the same draws as <code>diag_e_nuts</code>.
+ *
+ * The gradients are evaluated as for the other samplers, through the
+ * dynamically sized buffers of a <code>gradient_evaluator</code> that
+ * are allocated once with the sampler.
+ *
+ * @tparam Model type of the model
+ * @tparam N number of unconstrained parameters of the model
+ * @tparam BaseRNG type of the random number generator
+ */
+template <class Model, int N, class BaseRNG>
+class fixed_diag_e_nuts : public base_mcmc {
+ public:
+  using point_t = fixed_diag_e_point<N>;
+  using vector_t = typename point_t::vector_t;
+
+  /**
+   * @param model model
+   * @param rng random number generator
+   * @throw std::invalid_argument if the model does not have
+   *   <code>N</code> unconstrained parameters
+   */
+  fixed_diag_e_nuts(const Model& model, BaseRNG& rng)
+      : gradient_(model),
+        x_(N),
+        grad_(N),
+        rand_int_(rng),
+        rand_uniform_(rand_int_) {
+    if (model.num_params_r() != static_cast<size_t>(N))
+      throw std::invalid_argument(
+          "fixed_diag_e_nuts: the model does not have the dimension of the"
+          " sampler");
+  }
+
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    z_.set_metric(inv_e_metric);
+  }
+
+  void set_max_depth(int d) {
+    if (d > 0)
+      max_depth_ = d;
+  }
+
+  void set_max_delta(double d) { max_deltaH_ = d; }
+
+  int get_max_depth() { return max_depth_; }
+  double get_max_delta() { return max_deltaH_; }
+
+  void set_nominal_stepsize(double e) {
+    if (e > 0)
+      nom_epsilon_ = e;
+  }
+
+  double get_nominal_stepsize() const noexcept { return nom_epsilon_; }
+
+  double get_current_stepsize() const noexcept { return epsilon_; }
+
+  void set_stepsize_jitter(double j) {
+    if (j > 0 && j < 1)
+      epsilon_jitter_ = j;
+  }
+
+  double get_stepsize_jitter() const noexcept { return epsilon_jitter_; }
+
+  void sample_stepsize() {
+    epsilon_ = nom_epsilon_;
+    if (epsilon_jitter_)
+      epsilon_ *= 1.0 + epsilon_jitter_ * (2.0 * rand_uniform_() - 1.0);
+  }
+
+  point_t& z() { return z_; }
+  const point_t& z() const noexcept { return z_; }
+
+  void seed(const Eigen::VectorXd& q) { z_.q = q; }
+
+  /**
+   * Initialize the step size with the heuristic of
+   * <code>base_hmc::init_stepsize</code>, doubling or halving it until
+   * the acceptance probability of a single leapfrog step crosses 0.8.
+   *
+   * @param logger logger for messages
+   * @throw std::runtime_error if the step size grows without bound or
+   *   shrinks to zero
+   */
+  void init_stepsize(callbacks::logger& logger) {
+    point_t z_init(z_);
+
+    // step size is meaningless in zero-dimensional space
+    if (N == 0) {
+      nom_epsilon_ = std::numeric_limits<double>::quiet_NaN();
+      return;
+    }
+
+    // Skip initialization for extreme step sizes
+    if (nom_epsilon_ == 0 || nom_epsilon_ > 1e7 || std::isnan(nom_epsilon_))
+      return;
+
+    const int direction = trial_step(logger) > std::log(0.8) ? 1 : -1;
+
+    while (1) {
+      z_ = z_init;
+      const double delta_H = trial_step(logger);
+
+      if ((direction == 1) && !(delta_H > std::log(0.8)))
+        break;
+      else if ((direction == -1) && !(delta_H < std::log(0.8)))
+        break;
+      else
+        nom_epsilon_ = direction == 1 ? 2.0 * nom_epsilon_ : 0.5 * nom_epsilon_;
+
+      if (nom_epsilon_ > 1e7)
+        throw std::runtime_error(
+            "Posterior is improper. "
+            "Please check your model.");
+      if (nom_epsilon_ == 0)
+        throw std::runtime_error(
+            "No acceptably small step size could "
+            "be found. Perhaps the posterior is "
+            "not continuous?");
+    }
+
+    z_ = z_init;
+  }
+
+  /**
+   * Initialize the step size from an estimate, as
+   * <code>base_hmc::init_stepsize(epsilon, logger)</code> does.
+   *
+   * @param epsilon estimate of the step size, or NaN for none
+   * @param logger logger for messages
+   * @return <code>true</code> if the estimate was used as it is
+   */
+  bool init_stepsize(double epsilon, callbacks::logger& logger) {
+    if (N == 0 || !(epsilon > 0 && epsilon <= 1e7)) {
+      init_stepsize(logger);
+      return false;
+    }
+    nom_epsilon_ = epsilon;
+
+    point_t z_init(z_);
+    const double delta_H = trial_step(logger);
+    z_ = z_init;
+
+    if (!(delta_H >= std::log(0.8))) {
+      init_stepsize(logger);
+      return false;
+    }
+    return true;
+  }
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    // Initialize the algorithm
+    sample_stepsize();
+
+    seed(init_sample.cont_params());
+
+    sample_p(z_);
+    update_potential_gradient(z_, logger);
+
+    point_t z_fwd(z_);  // State at forward end of trajectory
+    point_t z_bck(z_);  // State at backward end of trajectory
+    point_t z_sample(z_);
+    point_t z_propose(z_);
+
+    // Momentum and sharp momentum at forward end of forward subtree
+    vector_t p_fwd_fwd = z_.p;
+    vector_t p_sharp_fwd_fwd = dtau_dp(z_);
+
+    // Momentum and sharp momentum at backward end of forward subtree
+    vector_t p_fwd_bck = z_.p;
+    vector_t p_sharp_fwd_bck = p_sharp_fwd_fwd;
+
+    // Momentum and sharp momentum at forward end of backward subtree
+    vector_t p_bck_fwd = z_.p;
+    vector_t p_sharp_bck_fwd = p_sharp_fwd_fwd;
+
+    // Momentum and sharp momentum at backward end of backward subtree
+    vector_t p_bck_bck = z_.p;
+    vector_t p_sharp_bck_bck = p_sharp_fwd_fwd;
+
+    // Integrated momenta along trajectory
+    vector_t rho = z_.p;
+    vector_t rho_fwd;
+    vector_t rho_bck;
+    vector_t rho_extended;
+
+    // Sum of state weights (offset by H0) along trajectory
+    tree_weight sum_weight(0);  // exp(H0 - H0)
+    double H0 = H(z_);
+    int n_leapfrog = 0;
+    double sum_metro_prob = 0;
+
+    // Build a trajectory until the no-u-turn
+    // criterion is no longer satisfied
+    depth_ = 0;
+    divergent_ = false;
+
+    while (depth_ < max_depth_) {
+      // Build a new subtree in a random direction
+      rho_fwd.setZero();
+      rho_bck.setZero();
+
+      bool valid_subtree = false;
+      tree_weight sum_weight_subtree;
+
+      if (rand_uniform_() > 0.5) {
+        // Extend the current trajectory forward
+        z_ = z_fwd;
+        rho_bck = rho;
+        p_bck_fwd = p_fwd_fwd;
+        p_sharp_bck_fwd = p_sharp_fwd_fwd;
+
+        valid_subtree = build_tree(
+            depth_, z_propose, p_sharp_fwd_bck, p_sharp_fwd_fwd, rho_fwd,
+            p_fwd_bck, p_fwd_fwd, H0, 1, n_leapfrog, sum_weight_subtree,
+            sum_metro_prob, logger);
+        z_fwd = z_;
+      } else {
+        // Extend the current trajectory backwards
+        z_ = z_bck;
+        rho_fwd = rho;
+        p_fwd_bck = p_bck_bck;
+        p_sharp_fwd_bck = p_sharp_bck_bck;
+
+        valid_subtree = build_tree(
+            depth_, z_propose, p_sharp_bck_fwd, p_sharp_bck_bck, rho_bck,
+            p_bck_fwd, p_bck_bck, H0, -1, n_leapfrog, sum_weight_subtree,
+            sum_metro_prob, logger);
+        z_bck = z_;
+      }
+
+      if (!valid_subtree)
+        break;
+
+      // Sample from accepted subtree
+      ++depth_;
+
+      double accept_prob = sum_weight.ratio(sum_weight_subtree);
+      if (accept_prob > 1) {
+        z_sample = z_propose;
+      } else {
+        if (rand_uniform_() < accept_prob)
+          z_sample = z_propose;
+      }
+
+      sum_weight.add(sum_weight_subtree);
+
+      // Break when no-u-turn criterion is no longer satisfied
+      if (!nuts_tree::merged_criterion(
+              *this, p_sharp_bck_bck, p_sharp_bck_fwd, p_bck_fwd, rho_bck,
+              p_sharp_fwd_bck, p_sharp_fwd_fwd, p_fwd_bck, rho_fwd, rho,
+              rho_extended))
+        break;
+    }
+
+    n_leapfrog_ = n_leapfrog;
+
+    // Compute average acceptance probability across entire trajectory,
+    // even over subtrees that may have been rejected
+    double accept_prob = sum_metro_prob / static_cast<double>(n_leapfrog);
+
+    z_ = z_sample;
+    energy_ = H(z_);
+    return sample(Eigen::VectorXd(z_.q), -z_.V, accept_prob);
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    names.push_back("stepsize__");
+    names.push_back("treedepth__");
+    names.push_back("n_leapfrog__");
+    names.push_back("divergent__");
+    names.push_back("energy__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.push_back(epsilon_);
+    values.push_back(depth_);
+    values.push_back(n_leapfrog_);
+    values.push_back(divergent_);
+    values.push_back(energy_);
+  }
+
+  void get_sampler_diagnostic_names(std::vector<std::string>& model_names,
+                                    std::vector<std::string>& names) {
+    z_.get_param_names(model_names, names);
+  }
+
+  void get_sampler_diagnostics(std::vector<double>& values) {
+    z_.get_params(values);
+  }
+
+  /**
+   * write stepsize and elements of mass matrix
+   */
+  void write_sampler_state(callbacks::writer& writer) {
+    std::stringstream nominal_stepsize;
+    nominal_stepsize << "Step size = " << get_nominal_stepsize();
+    writer(nominal_stepsize.str());
+    z_.write_metric(writer);
+  }
+
+  /**
+   * write stepsize and elements of mass matrix as a JSON object
+   */
+  void write_sampler_state_struct(callbacks::structured_writer& struct_writer) {
+    struct_writer.begin_record();
+    struct_writer.write("stepsize", get_nominal_stepsize());
+    struct_writer.write("metric_type", z_.metric_type());
+    struct_writer.write("inv_metric", Eigen::VectorXd(z_.inv_e_metric_));
+    struct_writer.end_record();
+  }
+
+  void set_gradient_timing(bool timing) { gradient_.set_timing(timing); }
+
+  stan::model::gradient_stats get_gradient_stats() { return gradient_.stats(); }
+
+  void write_rejection_summary(callbacks::logger& logger) {
+    rejections_.write_summary(logger);
+  }
+
+  size_t memory_bytes() const {
+    size_t bytes
+        = z_.memory_bytes() + (x_.size() + grad_.size()) * sizeof(double);
+    // the adaptive samplers are also adapters
+    if (const base_adapter* adapter = dynamic_cast<const base_adapter*>(this))
+      bytes += adapter->memory_bytes();
+    return bytes;
+  }
+
+  int depth_ = 0;
+  int max_depth_ = 5;
+  double max_deltaH_ = 1000;
+
+  int n_leapfrog_ = 0;
+  bool divergent_ = false;
+  double energy_ = 0;
+
+ protected:
+  friend struct nuts_tree;
+
+  /**
+   * Temporaries used by a single level of <code>build_tree</code>, which
+   * live on the stack of the level.
+   */
+  struct tree_level_workspace {
+    point_t z_propose_final;
+    vector_t p_init_end;
+    vector_t p_sharp_init_end;
+    vector_t rho_init;
+    vector_t p_final_beg;
+    vector_t p_sharp_final_beg;
+    vector_t rho_final;
+    vector_t rho_subtree;
+    vector_t rho_extended;
+  };
+
+  /**
+   * Recursively build a new subtree to completion or until the subtree
+   * becomes invalid with the tree builder of <code>base_nuts</code>.
+   * Returns validity of the resulting subtree.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param sum_weight Summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  bool build_tree(int depth, point_t& z_propose, vector_t& p_sharp_beg,
+                  vector_t& p_sharp_end, vector_t& rho, vector_t& p_beg,
+                  vector_t& p_end, double H0, double sign, int& n_leapfrog,
+                  tree_weight& sum_weight, double& sum_metro_prob,
+                  callbacks::logger& logger) {
+    return nuts_tree::build_tree(*this, depth, z_propose, p_sharp_beg,
+                                 p_sharp_end, rho, p_beg, p_end, H0, sign,
+                                 n_leapfrog, sum_weight, sum_metro_prob,
+                                 logger);
+  }
+
+  tree_level_workspace tree_level(int depth) const {
+    return tree_level_workspace();
+  }
+
+  /**
+   * Take a leapfrog step of the current step size in the direction of the
+   * sign and return the Hamiltonian at the new point.
+   */
+  double leapfrog(double sign, vector_t& p_sharp, callbacks::logger& logger) {
+    evolve(z_, sign * epsilon_, logger);
+    return H_dtau_dp(z_, p_sharp);
+  }
+
+  /**
+   * Flag a divergence if the energy error exceeds the largest one
+   * allowed, and return whether the subtree may go on.
+   */
+  bool check_energy_error(double delta_H) {
+    if (delta_H > max_deltaH_)
+      divergent_ = true;
+    return !divergent_;
+  }
+
+  void record_leaf(double log_weight) {}
+
+  static bool criterion(const vector_t& p_sharp_minus,
+                        const vector_t& p_sharp_plus, const vector_t& rho) {
+    return p_sharp_plus.dot(rho) > 0 && p_sharp_minus.dot(rho) > 0;
+  }
+
+  /**
+   * Return the kinetic energy of the point.
+   */
+  static double T(const point_t& z) {
+    return 0.5 * z.p.dot(z.inv_e_metric_.cwiseProduct(z.p));
+  }
+
+  static double H(const point_t& z) { return T(z) + z.V; }
+
+  static vector_t dtau_dp(const point_t& z) {
+    return z.inv_e_metric_.cwiseProduct(z.p);
+  }
+
+  /**
+   * Return the Hamiltonian at the point and write its sharp momentum.
+   */
+  static double H_dtau_dp(const point_t& z, vector_t& p_sharp) {
+    double two_T = 0;
+    for (int i = 0; i < N; ++i) {
+      p_sharp(i) = z.inv_e_metric_(i) * z.p(i);
+      two_T += z.p(i) * p_sharp(i);
+    }
+    return 0.5 * two_T + z.V;
+  }
+
+  void sample_p(point_t& z) {
+    std_normal_fill(z.p, rand_int_);
+    for (int i = 0; i < N; ++i)
+      z.p(i) /= std::sqrt(z.inv_e_metric_(i));
+  }
+
+  /**
+   * Update the potential and its gradient at the point, or make the
+   * potential infinite to reject the proposal if the log density can not
+   * be evaluated there, as <code>base_hamiltonian</code> does.
+   */
+  void update_potential_gradient(point_t& z, callbacks::logger& logger) {
+    x_ = z.q;
+    if (gradient_.try_gradient(x_, z.V, grad_, logger)) {
+      z.V = -z.V;
+    } else {
+      rejections_.report(gradient_.error_message(), logger);
+      z.V = std::numeric_limits<double>::infinity();
+    }
+    z.g = -grad_;
+  }
+
+  /**
+   * Take a leapfrog step, as <code>expl_leapfrog</code> does with a
+   * diagonal metric.
+   */
+  void evolve(point_t& z, double epsilon, callbacks::logger& logger) {
+    for (int i = 0; i < N; ++i) {
+      z.p(i) -= 0.5 * epsilon * z.g(i);
+      z.q(i) += epsilon * (z.inv_e_metric_(i) * z.p(i));
+    }
+    update_potential_gradient(z, logger);
+    z.p -= 0.5 * epsilon * z.g;
+  }
+
+  /**
+   * Take a leapfrog step of the nominal step size from the current point
+   * with a fresh momentum and return the change of the Hamiltonian, as
+   * the step size heuristics do.
+   */
+  double trial_step(callbacks::logger& logger) {
+    sample_p(z_);
+    update_potential_gradient(z_, logger);
+    double H0 = H(z_);
+    evolve(z_, nom_epsilon_, logger);
+    double h = H(z_);
+    if (std::isnan(h))
+      h = std::numeric_limits<double>::infinity();
+    return H0 - h;
+  }
+
+  point_t z_;
+  stan::model::gradient_evaluator<Model> gradient_;
+  rejection_reporter rejections_;
+
+  // buffers of the gradient evaluator, allocated once
+  Eigen::VectorXd x_;
+  Eigen::VectorXd grad_;
+
+  BaseRNG& rand_int_;
+
+  // Uniform(0, 1) RNG
+  boost::uniform_01<BaseRNG&> rand_uniform_;
+
+  double nom_epsilon_ = 0.1;
+  double epsilon_ = 0.1;
+  double epsilon_jitter_ = 0;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
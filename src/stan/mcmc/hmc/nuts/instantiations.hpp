@@ -0,0 +1,85 @@
+#ifndef STAN_MCMC_HMC_NUTS_INSTANTIATIONS_HPP
+#define STAN_MCMC_HMC_NUTS_INSTANTIATIONS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_block_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_unit_e_nuts.hpp>
+#include <stan/model/model_base.hpp>
+#include <stan/services/util/create_rng.hpp>
+
+/**
+ * Explicit instantiations of the Euclidean NUTS samplers for models
+ * passed as <code>stan::model::model_base</code>, as the interfaces do.
+ * None of this code depends on the model class, so it only needs to be
+ * compiled once.
+ *
+ * A single translation unit defines <code>STAN_INSTANTIATE_SAMPLERS</code>
+ * before including this header, which compiles the transitions, the tree
+ * builders and the step size initialization there.  Translation units of
+ * the models define <code>STAN_EXTERN_SAMPLERS</code>, which declares the
+ * same instantiations <code>extern</code> so that the compiler does not
+ * emit them again and the linker takes them from the single unit.  With
+ * neither macro this header has no effect.
+ */
+#if defined(STAN_INSTANTIATE_SAMPLERS)
+#define STAN_SAMPLER_INSTANTIATION template
+#elif defined(STAN_EXTERN_SAMPLERS)
+#define STAN_SAMPLER_INSTANTIATION extern template
+#endif
+
+#ifdef STAN_SAMPLER_INSTANTIATION
+namespace stan {
+namespace mcmc {
+
+STAN_SAMPLER_INSTANTIATION sample
+base_nuts<model::model_base, unit_e_metric, expl_leapfrog, rng_t,
+          unit_e_nuts<model::model_base, rng_t>>::
+    transition(sample&, callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+base_nuts<model::model_base, diag_e_metric, expl_leapfrog, rng_t,
+          diag_e_nuts<model::model_base, rng_t>>::
+    transition(sample&, callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+base_nuts<model::model_base, dense_e_metric, expl_leapfrog, rng_t,
+          dense_e_nuts<model::model_base, rng_t>>::
+    transition(sample&, callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+base_nuts<model::model_base, block_e_metric, expl_leapfrog, rng_t,
+          block_e_nuts<model::model_base, rng_t>>::
+    transition(sample&, callbacks::logger&);
+
+STAN_SAMPLER_INSTANTIATION void
+base_hmc<model::model_base, unit_e_metric, expl_leapfrog,
+         rng_t>::init_stepsize(callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION void
+base_hmc<model::model_base, diag_e_metric, expl_leapfrog,
+         rng_t>::init_stepsize(callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION void
+base_hmc<model::model_base, dense_e_metric, expl_leapfrog,
+         rng_t>::init_stepsize(callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION void
+base_hmc<model::model_base, block_e_metric, expl_leapfrog,
+         rng_t>::init_stepsize(callbacks::logger&);
+
+STAN_SAMPLER_INSTANTIATION sample
+adapt_unit_e_nuts<model::model_base, rng_t>::transition(sample&,
+                                                        callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+adapt_diag_e_nuts<model::model_base, rng_t>::transition(sample&,
+                                                        callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+adapt_dense_e_nuts<model::model_base, rng_t>::transition(sample&,
+                                                         callbacks::logger&);
+STAN_SAMPLER_INSTANTIATION sample
+adapt_block_e_nuts<model::model_base, rng_t>::transition(sample&,
+                                                         callbacks::logger&);
+
+}  // namespace mcmc
+}  // namespace stan
+#undef STAN_SAMPLER_INSTANTIATION
+#endif
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef STAN_MCMC_HMC_NUTS_NUTS_TREE_HPP
+#define STAN_MCMC_HMC_NUTS_NUTS_TREE_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/tree_weight.hpp>
+#include <cmath>
+#include <limits>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * The tree building of the No-U-Turn sampler (NUTS) with multinomial
+ * sampling, shared by the samplers that hold their states in vectors of
+ * different types: <code>base_nuts</code>, with dynamically sized
+ * vectors, and <code>fixed_diag_e_nuts</code>, with vectors of a size
+ * fixed at compile time.
+ *
+ * A sampler, the builder, befriends this class and provides
+ * <ul>
+ * <li> the point <code>z_</code> that is integrated, with members
+ *   <code>q</code> and <code>p</code>, and the generator
+ *   <code>rand_uniform_</code> of uniform draws on (0, 1);</li>
+ * <li> <code>stop_requested()</code>;</li>
+ * <li> <code>double leapfrog(double sign, Vector& p_sharp, logger)</code>,
+ *   which takes a leapfrog step in the direction of the sign and returns
+ *   the Hamiltonian at the new point, writing its sharp momentum;</li>
+ * <li> <code>bool check_energy_error(double delta_H)</code>, which
+ *   records the energy error of a new state and returns whether the
+ *   subtree may go on;</li>
+ * <li> <code>void record_leaf(double log_weight)</code>, called with the
+ *   log weight of every new state;</li>
+ * <li> <code>bool criterion(Vector& p_sharp_minus, Vector& p_sharp_plus,
+ *   Vector& rho)</code>, the no-U-turn criterion;</li>
+ * <li> <code>tree_level(int depth)</code>, which returns the scratch
+ *   space of a level of the recursion, either a reference to storage
+ *   held by the sampler or a value on the stack, with the point
+ *   <code>z_propose_final</code> and the vectors
+ *   <code>p_init_end</code>, <code>p_sharp_init_end</code>,
+ *   <code>rho_init</code>, <code>p_final_beg</code>,
+ *   <code>p_sharp_final_beg</code>, <code>rho_final</code>,
+ *   <code>rho_subtree</code> and <code>rho_extended</code>.</li>
+ * </ul>
+ */
+struct nuts_tree {
+  /**
+   * Evaluate the no-U-turn criterion of the trajectory made of two
+   * adjacent subtrees, around the merged subtrees and between them.  The
+   * minus subtree is the one at the end of the sharp momentum passed
+   * first to the criterion.
+   *
+   * @tparam Builder type of sampler
+   * @tparam Vector type of vectors
+   * @param[in,out] builder sampler
+   * @param[in] p_sharp_minus_beg sharp momentum at the outer end of the
+   *   minus subtree
+   * @param[in] p_sharp_minus_end sharp momentum at the inner end of the
+   *   minus subtree
+   * @param[in] p_minus_end momentum at the inner end of the minus subtree
+   * @param[in] rho_minus summed momentum of the minus subtree
+   * @param[in] p_sharp_plus_beg sharp momentum at the inner end of the
+   *   plus subtree
+   * @param[in] p_sharp_plus_end sharp momentum at the outer end of the
+   *   plus subtree
+   * @param[in] p_plus_beg momentum at the inner end of the plus subtree
+   * @param[in] rho_plus summed momentum of the plus subtree
+   * @param[out] rho summed momentum of the merged subtrees
+   * @param[out] rho_extended scratch space
+   * @return whether the criterion is satisfied
+   */
+  template <class Builder, class Vector>
+  static bool merged_criterion(Builder& builder, Vector& p_sharp_minus_beg,
+                               Vector& p_sharp_minus_end,
+                               const Vector& p_minus_end,
+                               const Vector& rho_minus,
+                               Vector& p_sharp_plus_beg,
+                               Vector& p_sharp_plus_end,
+                               const Vector& p_plus_beg,
+                               const Vector& rho_plus, Vector& rho,
+                               Vector& rho_extended) {
+    rho = rho_minus + rho_plus;
+
+    // Demand satisfaction around merged subtrees
+    bool persist_criterion
+        = builder.criterion(p_sharp_minus_beg, p_sharp_plus_end, rho);
+
+    // Demand satisfaction between subtrees
+    rho_extended = rho_minus + p_plus_beg;
+    persist_criterion
+        &= builder.criterion(p_sharp_minus_beg, p_sharp_plus_beg, rho_extended);
+
+    rho_extended = rho_plus + p_minus_end;
+    persist_criterion
+        &= builder.criterion(p_sharp_minus_end, p_sharp_plus_end, rho_extended);
+
+    return persist_criterion;
+  }
+
+  /**
+   * Recursively build a new subtree from the point of the sampler to
+   * completion or until the subtree becomes invalid.  Returns validity
+   * of the resulting subtree.
+   *
+   * @tparam Builder type of sampler
+   * @tparam Point type of point
+   * @tparam Vector type of vectors
+   * @param builder sampler
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param sum_weight Summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  template <class Builder, class Point, class Vector>
+  static bool build_tree(Builder& builder, int depth, Point& z_propose,
+                         Vector& p_sharp_beg, Vector& p_sharp_end,
+                         Vector& rho, Vector& p_beg, Vector& p_end, double H0,
+                         double sign, int& n_leapfrog,
+                         tree_weight& sum_weight, double& sum_metro_prob,
+                         callbacks::logger& logger) {
+    // Base case
+    if (depth == 0) {
+      // a stop leaves the tree built so far, after at least one step
+      if (n_leapfrog > 0 && builder.stop_requested())
+        return false;
+      // the energy and the sharp momentum share one pass over the point
+      double h = builder.leapfrog(sign, p_sharp_beg, logger);
+      ++n_leapfrog;
+      if (std::isnan(h))
+        h = std::numeric_limits<double>::infinity();
+
+      const bool valid = builder.check_energy_error(h - H0);
+
+      sum_weight.add(H0 - h);
+      builder.record_leaf(H0 - h);
+
+      if (H0 - h > 0)
+        sum_metro_prob += 1;
+      else
+        sum_metro_prob += std::exp(H0 - h);
+
+      z_propose = builder.z_;
+
+      p_sharp_end = p_sharp_beg;
+
+      rho += builder.z_.p;
+      p_beg = builder.z_.p;
+      p_end = p_beg;
+
+      return valid;
+    }
+    // General recursion
+
+    // Scratch space owned by this level of the recursion.  Deeper calls
+    // only touch their own levels, so the buffers are never aliased.
+    auto&& ws = builder.tree_level(depth);
+
+    // Build the initial subtree
+    tree_weight sum_weight_init;
+
+    // Momentum and sharp momentum at end of the initial subtree
+    Vector& p_init_end = ws.p_init_end;
+    Vector& p_sharp_init_end = ws.p_sharp_init_end;
+
+    Vector& rho_init = ws.rho_init;
+    rho_init.setZero(rho.size());
+
+    bool valid_init
+        = build_tree(builder, depth - 1, z_propose, p_sharp_beg,
+                     p_sharp_init_end, rho_init, p_beg, p_init_end, H0, sign,
+                     n_leapfrog, sum_weight_init, sum_metro_prob, logger);
+
+    if (!valid_init)
+      return false;
+
+    // Build the final subtree
+    Point& z_propose_final = ws.z_propose_final;
+    z_propose_final = builder.z_;
+
+    tree_weight sum_weight_final;
+
+    // Momentum and sharp momentum at beginning of the final subtree
+    Vector& p_final_beg = ws.p_final_beg;
+    Vector& p_sharp_final_beg = ws.p_sharp_final_beg;
+
+    Vector& rho_final = ws.rho_final;
+    rho_final.setZero(rho.size());
+
+    bool valid_final
+        = build_tree(builder, depth - 1, z_propose_final, p_sharp_final_beg,
+                     p_sharp_end, rho_final, p_final_beg, p_end, H0, sign,
+                     n_leapfrog, sum_weight_final, sum_metro_prob, logger);
+
+    if (!valid_final)
+      return false;
+
+    // Multinomial sample from right subtree
+    tree_weight sum_weight_subtree = sum_weight_init;
+    sum_weight_subtree.add(sum_weight_final);
+    sum_weight.add(sum_weight_subtree);
+
+    // the final proposal is rewritten by the next build, so it is swapped
+    double accept_prob = sum_weight_subtree.ratio(sum_weight_final);
+    if (accept_prob > 1) {
+      z_propose.swap(z_propose_final);
+    } else {
+      if (builder.rand_uniform_() < accept_prob)
+        z_propose.swap(z_propose_final);
+    }
+
+    Vector& rho_subtree = ws.rho_subtree;
+    bool persist_criterion = merged_criterion(
+        builder, p_sharp_beg, p_sharp_init_end, p_init_end, rho_init,
+        p_sharp_final_beg, p_sharp_end, p_final_beg, rho_final, rho_subtree,
+        ws.rho_extended);
+    rho += rho_subtree;
+
+    return persist_criterion;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
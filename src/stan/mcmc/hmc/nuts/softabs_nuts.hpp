@@ -5,6 +5,8 @@
 #include <stan/mcmc/hmc/hamiltonians/softabs_point.hpp>
 #include <stan/mcmc/hmc/hamiltonians/softabs_metric.hpp>
 #include <stan/mcmc/hmc/integrators/impl_leapfrog.hpp>
+#include <string>
+#include <vector>
 
 namespace stan {
 namespace mcmc {
@@ -18,6 +20,33 @@ class softabs_nuts
  public:
   softabs_nuts(const Model& model, BaseRNG& rng)
       : base_nuts<Model, softabs_metric, impl_leapfrog, BaseRNG>(model, rng) {}
+
+  /**
+   * Take a transition, counting the fixed-point iterations of the
+   * implicit integrator afresh.
+   */
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    this->integrator_.reset_num_fixed_point();
+    return base_sampler::transition(init_sample, logger);
+  }
+
+  /**
+   * Append the mean numbers of fixed-point iterations per leapfrog step
+   * of the position and momentum updates to the sampler diagnostics.
+   */
+  void get_sampler_diagnostic_names(std::vector<std::string>& model_names,
+                                    std::vector<std::string>& names) {
+    base_sampler::get_sampler_diagnostic_names(model_names, names);
+    this->integrator_.get_fixed_point_names(names);
+  }
+
+  void get_sampler_diagnostics(std::vector<double>& values) {
+    base_sampler::get_sampler_diagnostics(values);
+    this->integrator_.get_fixed_point_values(values);
+  }
+
+ private:
+  typedef base_nuts<Model, softabs_metric, impl_leapfrog, BaseRNG> base_sampler;
 };
 
 }  // namespace mcmc
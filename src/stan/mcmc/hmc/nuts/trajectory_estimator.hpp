@@ -0,0 +1,254 @@
+#ifndef STAN_MCMC_HMC_NUTS_TRAJECTORY_ESTIMATOR_HPP
+#define STAN_MCMC_HMC_NUTS_TRAJECTORY_ESTIMATOR_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * <code>trajectory_estimator</code> estimates the posterior means and
+ * standard deviations of selected unconstrained parameters from every
+ * state of the NUTS trajectories rather than from the draws alone.
+ *
+ * Each transition of NUTS evaluates the gradient at every state of its
+ * trajectory but keeps only the one it samples, with probabilities
+ * proportional to the weights <code>exp(H0 - H)</code> of the states.
+ * The average of the parameters over the trajectory with these weights
+ * is a Rao-Blackwellized estimate of the expectation the draw estimates,
+ * with a much lower variance for the same gradients.  The estimator
+ * averages it over the transitions, along with the weighted average of
+ * the squared parameters, from which it estimates the variances.
+ *
+ * Only the subtrees merged into the final trajectory count, the initial
+ * state included.  The leaves of a subtree rejected because it diverged
+ * or turned back on itself are dropped, as they are by the sampler.
+ *
+ * The estimator is attached to a sampler with
+ * <code>base_nuts::set_trajectory_estimator</code>, typically once warmup
+ * is done, and costs on the order of the number of selected parameters
+ * per leapfrog step.
+ */
+class trajectory_estimator {
+ public:
+  /**
+   * Construct an estimator of the unconstrained parameters of the
+   * specified indices.
+   *
+   * @param[in] indices indices of the unconstrained parameters, which
+   *   must be less than their number
+   */
+  explicit trajectory_estimator(std::vector<size_t> indices)
+      : indices_(std::move(indices)),
+        x_(indices_.size()),
+        trajectory_(indices_.size()),
+        subtree_(indices_.size()),
+        sum_mean_(Eigen::VectorXd::Zero(indices_.size())),
+        sum_second_(Eigen::VectorXd::Zero(indices_.size())) {}
+
+  /**
+   * Return the indices of the parameters estimated.
+   */
+  const std::vector<size_t>& indices() const noexcept { return indices_; }
+
+  /**
+   * Return the number of transitions averaged.
+   */
+  size_t num_transitions() const noexcept { return num_transitions_; }
+
+  /**
+   * Return the estimated posterior means of the parameters.
+   *
+   * @throw std::domain_error if no transition was averaged
+   */
+  Eigen::VectorXd mean() const {
+    check_transitions();
+    return sum_mean_ / num_transitions_;
+  }
+
+  /**
+   * Return the estimated posterior variances of the parameters.
+   *
+   * @throw std::domain_error if no transition was averaged
+   */
+  Eigen::VectorXd variance() const {
+    check_transitions();
+    Eigen::VectorXd m = mean();
+    return (sum_second_ / num_transitions_ - m.cwiseProduct(m))
+        .cwiseMax(0.0);
+  }
+
+  /**
+   * Forget the transitions averaged.
+   */
+  void reset() {
+    num_transitions_ = 0;
+    sum_mean_.setZero();
+    sum_second_.setZero();
+  }
+
+  /**
+   * Start a transition from the specified initial state, whose weight is
+   * one.
+   *
+   * @param[in] q unconstrained parameters of the initial state
+   * @throw std::invalid_argument if an index is not less than the
+   *   number of parameters
+   */
+  void begin_transition(const Eigen::VectorXd& q) {
+    for (size_t index : indices_)
+      if (index >= static_cast<size_t>(q.size()))
+        throw std::invalid_argument(
+            "trajectory_estimator: parameter index out of range");
+    trajectory_.clear();
+    subtree_.clear();
+    trajectory_.add(0, gather(q));
+  }
+
+  /**
+   * Add a state to the subtree being built.
+   *
+   * @param[in] log_weight log weight of the state, <code>H0 - H</code>
+   * @param[in] q unconstrained parameters of the state
+   */
+  void add_leaf(double log_weight, const Eigen::VectorXd& q) {
+    subtree_.add(log_weight, gather(q));
+  }
+
+  /**
+   * Merge the subtree built into the trajectory, or drop it if it was
+   * rejected, and start a new subtree.
+   *
+   * @param[in] valid true if the sampler merged the subtree
+   */
+  void end_subtree(bool valid) {
+    if (valid)
+      trajectory_.add(subtree_);
+    subtree_.clear();
+  }
+
+  /**
+   * Add the weighted averages over the trajectory built to the running
+   * estimates.
+   */
+  void end_transition() {
+    const double sum = trajectory_.scaled_sum;
+    if (!(sum > 0))
+      return;
+    sum_mean_ += trajectory_.scaled_x / sum;
+    sum_second_ += trajectory_.scaled_x2 / sum;
+    ++num_transitions_;
+  }
+
+  /**
+   * Write the estimates as messages, one per parameter.
+   *
+   * @param[in,out] writer writer for the messages
+   * @param[in] names names of all of the unconstrained parameters
+   */
+  void write(callbacks::writer& writer,
+             const std::vector<std::string>& names) const {
+    std::stringstream header;
+    header << "Trajectory-weighted estimates over " << num_transitions_
+           << " transitions:";
+    writer(header.str());
+    if (num_transitions_ == 0)
+      return;
+    Eigen::VectorXd m = mean();
+    Eigen::VectorXd v = variance();
+    for (size_t k = 0; k < indices_.size(); ++k) {
+      std::stringstream msg;
+      msg << (indices_[k] < names.size() ? names[indices_[k]]
+                                         : std::to_string(indices_[k]))
+          << ": mean = " << m(k) << ", sd = " << std::sqrt(v(k));
+      writer(msg.str());
+    }
+  }
+
+ private:
+  /**
+   * Weighted sums of the parameters and their squares, held as the
+   * largest log weight and the sums scaled by its exponential, as
+   * <code>tree_weight</code> holds its sums.
+   */
+  struct weighted_sums {
+    explicit weighted_sums(size_t n)
+        : scaled_x(Eigen::VectorXd::Zero(n)),
+          scaled_x2(Eigen::VectorXd::Zero(n)) {}
+
+    double max_log_weight = -std::numeric_limits<double>::infinity();
+    double scaled_sum = 0;
+    Eigen::VectorXd scaled_x;
+    Eigen::VectorXd scaled_x2;
+
+    void clear() {
+      max_log_weight = -std::numeric_limits<double>::infinity();
+      scaled_sum = 0;
+      scaled_x.setZero();
+      scaled_x2.setZero();
+    }
+
+    void rescale(double log_weight) {
+      if (log_weight > max_log_weight) {
+        const double e = std::exp(max_log_weight - log_weight);
+        scaled_sum *= e;
+        scaled_x *= e;
+        scaled_x2 *= e;
+        max_log_weight = log_weight;
+      }
+    }
+
+    void add(double log_weight, const Eigen::VectorXd& x) {
+      if (!(log_weight > -std::numeric_limits<double>::infinity()))
+        return;
+      rescale(log_weight);
+      const double e = std::exp(log_weight - max_log_weight);
+      scaled_sum += e;
+      scaled_x += e * x;
+      scaled_x2 += e * x.cwiseProduct(x);
+    }
+
+    void add(const weighted_sums& other) {
+      if (!(other.scaled_sum > 0))
+        return;
+      rescale(other.max_log_weight);
+      const double e = std::exp(other.max_log_weight - max_log_weight);
+      scaled_sum += e * other.scaled_sum;
+      scaled_x += e * other.scaled_x;
+      scaled_x2 += e * other.scaled_x2;
+    }
+  };
+
+  std::vector<size_t> indices_;
+  Eigen::VectorXd x_;
+  weighted_sums trajectory_;
+  weighted_sums subtree_;
+  size_t num_transitions_ = 0;
+  Eigen::VectorXd sum_mean_;
+  Eigen::VectorXd sum_second_;
+
+  const Eigen::VectorXd& gather(const Eigen::VectorXd& q) {
+    for (size_t k = 0; k < indices_.size(); ++k)
+      x_(k) = q(indices_[k]);
+    return x_;
+  }
+
+  void check_transitions() const {
+    if (num_transitions_ == 0)
+      throw std::domain_error(
+          "trajectory_estimator: no transitions were averaged");
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
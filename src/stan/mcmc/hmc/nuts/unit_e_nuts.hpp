@@ -13,11 +13,12 @@ namespace mcmc {
  * with a Gaussian-Euclidean disintegration and unit metric
  */
 template <class Model, class BaseRNG>
-class unit_e_nuts
-    : public base_nuts<Model, unit_e_metric, expl_leapfrog, BaseRNG> {
+class unit_e_nuts : public base_nuts<Model, unit_e_metric, expl_leapfrog,
+                                     BaseRNG, unit_e_nuts<Model, BaseRNG>> {
  public:
   unit_e_nuts(const Model& model, BaseRNG& rng)
-      : base_nuts<Model, unit_e_metric, expl_leapfrog, BaseRNG>(model, rng) {}
+      : base_nuts<Model, unit_e_metric, expl_leapfrog, BaseRNG,
+                  unit_e_nuts<Model, BaseRNG>>(model, rng) {}
 };
 
 }  // namespace mcmc
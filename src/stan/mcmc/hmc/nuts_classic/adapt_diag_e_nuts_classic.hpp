@@ -30,11 +30,11 @@ class adapt_diag_e_nuts_classic : public diag_e_nuts_classic<Model, BaseRNG>,
       this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
                                                 s.accept_stat());
 
-      bool update = this->var_adaptation_.learn_variance(this->z_.inv_e_metric_,
-                                                         this->z_.q);
+      bool update = this->var_adaptation_.learn_variance(
+          this->z_.inv_e_metric_, this->z_.q, this->z_.g);
 
       if (update) {
-        this->init_stepsize(logger);
+        this->init_stepsize(this->reused_stepsize(), logger);
 
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
         this->stepsize_adaptation_.restart();
@@ -111,14 +111,15 @@ class base_nuts_classic
         util.sign = -1;
       }
 
-      // And build a new subtree in that direction
-      this->z_.ps_point::operator=(*z);
+      // And build a new subtree in that direction, swapping its end in
+      // and out of the integrated point rather than copying it
+      this->z_.ps_point::swap(*z);
 
       int n_valid_subtree
           = build_tree(depth_, *rho, 0, z_propose, util, logger);
       ++(this->depth_);
 
-      *z = this->z_;
+      this->z_.ps_point::swap(*z);
 
       // Metropolis-Hastings sample the fresh subtree
       if (!util.criterion)
@@ -134,22 +135,23 @@ class base_nuts_classic
       }
 
       if (this->rand_uniform_() < subtree_prob)
-        z_sample = z_propose;
+        z_sample.swap(z_propose);
 
       n_valid += n_valid_subtree;
 
       // Check validity of completed tree
-      this->z_.ps_point::operator=(z_plus);
+      this->z_.ps_point::swap(z_plus);
       Eigen::VectorXd delta_rho = rho_minus + rho_init + rho_plus;
 
       util.criterion = compute_criterion(z_minus, this->z_, delta_rho);
+      this->z_.ps_point::swap(z_plus);
     }
 
     this->n_leapfrog_ = util.n_tree;
 
     double accept_prob = util.sum_prob / static_cast<double>(util.n_tree);
 
-    this->z_.ps_point::operator=(z_sample);
+    this->z_.ps_point::swap(z_sample);
     this->energy_ = this->hamiltonian_.H(this->z_);
     return sample(this->z_.q, -this->z_.V, accept_prob);
   }
@@ -228,7 +230,7 @@ class base_nuts_classic
           = static_cast<double>(n2) / static_cast<double>(n1 + n2);
 
       if (util.criterion && (this->rand_uniform_() < accept_prob))
-        z_propose = z_propose_right;
+        z_propose.swap(z_propose_right);
 
       Eigen::VectorXd& subtree_rho = left_subtree_rho;
       subtree_rho += right_subtree_rho;
@@ -0,0 +1,102 @@
+#ifndef STAN_MCMC_HMC_SAMPLER_CHECKPOINT_HPP
+#define STAN_MCMC_HMC_SAMPLER_CHECKPOINT_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
+#include <stan/mcmc/point_checkpoint.hpp>
+#include <stan/mcmc/stepsize_adapter.hpp>
+#include <stan/mcmc/stepsize_covar_adapter.hpp>
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+
+namespace stan {
+namespace mcmc {
+
+inline void write_adaptation_checkpoint(stepsize_adapter& adapter,
+                                        callbacks::structured_writer& writer) {
+  adapter.get_stepsize_adaptation().write_checkpoint(writer);
+}
+
+inline void write_adaptation_checkpoint(stepsize_var_adapter& adapter,
+                                        callbacks::structured_writer& writer) {
+  adapter.get_stepsize_adaptation().write_checkpoint(writer);
+  adapter.get_var_adaptation().write_checkpoint(writer);
+}
+
+inline void write_adaptation_checkpoint(stepsize_covar_adapter& adapter,
+                                        callbacks::structured_writer& writer) {
+  adapter.get_stepsize_adaptation().write_checkpoint(writer);
+  adapter.get_covar_adaptation().write_checkpoint(writer);
+}
+
+inline void read_adaptation_checkpoint(stepsize_adapter& adapter,
+                                       const io::var_context& context) {
+  adapter.get_stepsize_adaptation().read_checkpoint(context);
+}
+
+inline void read_adaptation_checkpoint(stepsize_var_adapter& adapter,
+                                       const io::var_context& context) {
+  adapter.get_stepsize_adaptation().read_checkpoint(context);
+  adapter.get_var_adaptation().read_checkpoint(context);
+}
+
+inline void read_adaptation_checkpoint(stepsize_covar_adapter& adapter,
+                                       const io::var_context& context) {
+  adapter.get_stepsize_adaptation().read_checkpoint(context);
+  adapter.get_covar_adaptation().read_checkpoint(context);
+}
+
+/**
+ * Write the state of an adaptive HMC sampler to a checkpoint: its phase
+ * space point and metric, its nominal step size, whether it is adapting,
+ * and the state of its step size and metric adaptation.
+ *
+ * A checkpoint is written as flat key and value pairs, to be read back
+ * from a <code>var_context</code>, such as the <code>json_data</code> of
+ * a checkpoint written by a <code>json_writer</code>.  Reals are written
+ * with the precision of the stream of the writer, so resuming exactly
+ * requires it to be at least <code>max_digits10</code>.
+ *
+ * @tparam Sampler type of sampler, an HMC sampler with unit, diagonal or
+ * dense metric adaptation
+ * @param[in] sampler sampler
+ * @param[in,out] writer checkpoint writer
+ */
+template <class Sampler>
+void write_sampler_checkpoint(Sampler& sampler,
+                              callbacks::structured_writer& writer) {
+  write_point_checkpoint(sampler.z(), writer);
+  writer.write("stepsize", sampler.get_nominal_stepsize());
+  writer.write("adapting", static_cast<int>(sampler.adapting()));
+  write_adaptation_checkpoint(sampler, writer);
+}
+
+/**
+ * Restore the state of a sampler from a checkpoint written by
+ * <code>write_sampler_checkpoint</code> for a sampler of the same type
+ * and size.  The settings that are not adapted, such as the step size
+ * jitter and maximum tree depth, are not part of the checkpoint.
+ *
+ * @tparam Sampler type of sampler
+ * @param[in,out] sampler sampler
+ * @param[in] context checkpoint
+ * @throw std::invalid_argument if the checkpoint lacks a value or has
+ * values of the wrong sizes
+ */
+template <class Sampler>
+void read_sampler_checkpoint(Sampler& sampler,
+                             const io::var_context& context) {
+  read_adaptation_checkpoint(sampler, context);
+  // disengaging completes the step size adaptation, so the step size is
+  // restored afterwards
+  if (read_checkpoint_scalar(context, "adapting") != 0)
+    sampler.engage_adaptation();
+  else
+    sampler.disengage_adaptation();
+  read_point_checkpoint(sampler.z(), context);
+  sampler.set_nominal_stepsize(read_checkpoint_scalar(context, "stepsize"));
+}
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
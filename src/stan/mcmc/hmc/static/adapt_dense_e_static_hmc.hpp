@@ -36,7 +36,8 @@ class adapt_dense_e_static_hmc : public dense_e_static_hmc<Model, BaseRNG>,
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
-        this->init_stepsize(logger);
+        this->z_.update_metric_factor();
+        this->init_stepsize(this->reused_stepsize(), logger);
         this->update_L_();
 
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
@@ -32,11 +32,11 @@ class adapt_diag_e_static_hmc : public diag_e_static_hmc<Model, BaseRNG>,
                                                 s.accept_stat());
       this->update_L_();
 
-      bool update = this->var_adaptation_.learn_variance(this->z_.inv_e_metric_,
-                                                         this->z_.q);
+      bool update = this->var_adaptation_.learn_variance(
+          this->z_.inv_e_metric_, this->z_.q, this->z_.g);
 
       if (update) {
-        this->init_stepsize(logger);
+        this->init_stepsize(this->reused_stepsize(), logger);
         this->update_L_();
 
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
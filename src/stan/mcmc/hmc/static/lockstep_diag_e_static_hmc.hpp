@@ -0,0 +1,349 @@
+#ifndef STAN_MCMC_HMC_STATIC_LOCKSTEP_DIAG_E_STATIC_HMC_HPP
+#define STAN_MCMC_HMC_STATIC_LOCKSTEP_DIAG_E_STATIC_HMC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/stepsize_adaptation.hpp>
+#include <stan/mcmc/var_adaptation.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Hamiltonian Monte Carlo with a diagonal Euclidean metric and a static
+ * integration time, advancing an ensemble of chains in lockstep.
+ *
+ * Every leapfrog step of every chain is taken together, so each step
+ * evaluates the gradients of all chains with one call to the batched
+ * <code>log_prob_grad_batch</code> of the model, which a model can
+ * implement with vector instructions or on a GPU.  This suits cheap
+ * models run with hundreds of chains, for instance for nested R-hat.
+ *
+ * The chains share their step size, integration time and metric.  While
+ * adapting, the step size is tuned by dual averaging of the acceptance
+ * statistic averaged over the chains, and at the end of each window of
+ * the usual windowed schedule the metric becomes the variance of the
+ * draws of every chain in the window, pooled as in cross-chain warmup.
+ *
+ * The position of chain <code>c</code> is column <code>c</code> of
+ * <code>q()</code>.  Each chain draws its momenta and acceptances from
+ * its own generator, so the chains are reproducible whatever the batched
+ * evaluation does.
+ *
+ * @tparam Model The type of the Stan model, which must provide
+ * <code>log_prob_grad_batch</code> as <code>model_base</code> does.
+ * @tparam BaseRNG The type of random number generator.
+ */
+template <class Model, class BaseRNG>
+class lockstep_diag_e_static_hmc {
+ public:
+  /**
+   * Construct a sampler with one chain for each generator.
+   *
+   * @param model model
+   * @param rngs random number generator of each chain, which must outlive
+   * the sampler
+   * @throw std::invalid_argument if there are no generators
+   */
+  lockstep_diag_e_static_hmc(const Model& model, std::vector<BaseRNG>& rngs)
+      : model_(model),
+        rngs_(rngs),
+        metric_(model.num_params_r()),
+        q_(model.num_params_r(), rngs.size()),
+        g_(model.num_params_r(), rngs.size()),
+        lp_(rngs.size()),
+        accept_stat_(rngs.size()),
+        energy_(rngs.size()),
+        divergent_(rngs.size()),
+        nom_epsilon_(0.1),
+        T_(1),
+        adapt_flag_(false),
+        adaptations_(rngs.size(), var_adaptation(model.num_params_r())) {
+    if (rngs.empty())
+      throw std::invalid_argument("Number of chains must be positive");
+    q_.setZero();
+    g_.setZero();
+    lp_.setZero();
+    accept_stat_.setZero();
+    energy_.setZero();
+    divergent_.setZero();
+    for (var_adaptation& adaptation : adaptations_)
+      adaptation.set_pooling(true);
+    update_L_();
+  }
+
+  size_t num_chains() const noexcept { return rngs_.size(); }
+
+  /**
+   * Set the positions of the chains and evaluate the log density and its
+   * gradient there.
+   *
+   * @param q unconstrained parameters, one column per chain
+   * @param logger logger for messages
+   * @throw std::invalid_argument if the dimensions are wrong
+   */
+  void init(const Eigen::MatrixXd& q, callbacks::logger& logger) {
+    if (q.rows() != q_.rows() || q.cols() != q_.cols())
+      throw std::invalid_argument(
+          "Initial values must have one column per chain");
+    q_ = q;
+    evaluate(logger);
+  }
+
+  /**
+   * Advance every chain by one transition, adapting if adaptation is
+   * engaged.
+   *
+   * @param logger logger for messages
+   * @return acceptance statistic averaged over the chains
+   */
+  double transition(callbacks::logger& logger) {
+    const Eigen::Index n = q_.rows();
+    const Eigen::Index num_chains = q_.cols();
+    boost::random::normal_distribution<double> std_normal;
+    Eigen::VectorXd inv_sd = metric_.inv_e_metric_.cwiseSqrt().cwiseInverse();
+
+    Eigen::MatrixXd p(n, num_chains);
+    for (Eigen::Index c = 0; c < num_chains; ++c)
+      for (Eigen::Index i = 0; i < n; ++i)
+        p(i, c) = std_normal(rngs_[c]) * inv_sd(i);
+    Eigen::VectorXd H0 = hamiltonian(p);
+
+    Eigen::MatrixXd q_init = q_;
+    Eigen::MatrixXd g_init = g_;
+    Eigen::VectorXd lp_init = lp_;
+
+    const double epsilon = nom_epsilon_;
+    p += (0.5 * epsilon) * g_;
+    for (int l = 0; l < L_; ++l) {
+      q_ += epsilon * (metric_.inv_e_metric_.asDiagonal() * p);
+      evaluate(logger);
+      p += (l + 1 == L_ ? 0.5 * epsilon : epsilon) * g_;
+    }
+
+    Eigen::VectorXd h = hamiltonian(p);
+    for (Eigen::Index c = 0; c < num_chains; ++c) {
+      if (std::isnan(h(c)))
+        h(c) = std::numeric_limits<double>::infinity();
+      divergent_(c) = h(c) - H0(c) > max_deltaH_;
+      double accept_prob = std::exp(H0(c) - h(c));
+      boost::random::uniform_01<BaseRNG&> rand_uniform(rngs_[c]);
+      if (accept_prob < 1 && rand_uniform() > accept_prob) {
+        q_.col(c) = q_init.col(c);
+        g_.col(c) = g_init.col(c);
+        lp_(c) = lp_init(c);
+        energy_(c) = H0(c);
+      } else {
+        energy_(c) = h(c);
+      }
+      accept_stat_(c) = accept_prob > 1 ? 1 : accept_prob;
+    }
+
+    const double mean_accept_stat = accept_stat_.mean();
+    if (adapt_flag_)
+      learn(mean_accept_stat);
+    return mean_accept_stat;
+  }
+
+  const Eigen::MatrixXd& q() const noexcept { return q_; }
+
+  /**
+   * Return the log density, up to a constant and with the Jacobian, at
+   * the position of each chain.
+   */
+  const Eigen::VectorXd& lp() const noexcept { return lp_; }
+
+  const Eigen::VectorXd& accept_stat() const noexcept { return accept_stat_; }
+
+  const Eigen::VectorXd& energy() const noexcept { return energy_; }
+
+  const Eigen::VectorXd& divergent() const noexcept { return divergent_; }
+
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    metric_.set_metric(inv_e_metric);
+  }
+
+  const Eigen::VectorXd& get_metric() const noexcept {
+    return metric_.inv_e_metric_;
+  }
+
+  void set_nominal_stepsize(double e) {
+    if (e > 0) {
+      nom_epsilon_ = e;
+      update_L_();
+    }
+  }
+
+  double get_nominal_stepsize() const noexcept { return nom_epsilon_; }
+
+  void set_T(double t) {
+    if (t > 0) {
+      T_ = t;
+      update_L_();
+    }
+  }
+
+  double get_T() const noexcept { return T_; }
+
+  int get_L() const noexcept { return L_; }
+
+  stepsize_adaptation& get_stepsize_adaptation() {
+    return stepsize_adaptation_;
+  }
+
+  void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
+                         unsigned int term_buffer, unsigned int base_window,
+                         callbacks::logger& logger) {
+    // every chain would log the same messages
+    callbacks::logger silent_logger;
+    for (size_t c = 0; c < adaptations_.size(); ++c)
+      adaptations_[c].set_window_params(num_warmup, init_buffer, term_buffer,
+                                        base_window,
+                                        c == 0 ? logger : silent_logger);
+  }
+
+  void engage_adaptation() { adapt_flag_ = true; }
+
+  void disengage_adaptation() {
+    adapt_flag_ = false;
+    stepsize_adaptation_.complete_adaptation(nom_epsilon_);
+    update_L_();
+  }
+
+  bool adapting() const noexcept { return adapt_flag_; }
+
+  void get_sampler_param_names(std::vector<std::string>& names) const {
+    names.push_back("lp__");
+    names.push_back("accept_stat__");
+    names.push_back("stepsize__");
+    names.push_back("int_time__");
+    names.push_back("energy__");
+    names.push_back("divergent__");
+  }
+
+  void get_sampler_params(size_t chain, std::vector<double>& values) const {
+    values.push_back(lp_(chain));
+    values.push_back(accept_stat_(chain));
+    values.push_back(nom_epsilon_);
+    values.push_back(T_);
+    values.push_back(energy_(chain));
+    values.push_back(divergent_(chain));
+  }
+
+  /**
+   * write stepsize and elements of mass matrix
+   */
+  void write_sampler_state(callbacks::writer& writer) {
+    std::stringstream nominal_stepsize;
+    nominal_stepsize << "Step size = " << nom_epsilon_;
+    writer(nominal_stepsize.str());
+    metric_.write_metric(writer);
+  }
+
+  /**
+   * write stepsize and elements of mass matrix as a JSON object
+   */
+  void write_sampler_state_struct(callbacks::structured_writer& struct_writer) {
+    struct_writer.begin_record();
+    struct_writer.write("stepsize", nom_epsilon_);
+    struct_writer.write("metric_type", metric_.metric_type());
+    struct_writer.write("inv_metric", metric_.inv_e_metric_);
+    struct_writer.end_record();
+  }
+
+ protected:
+  const Model& model_;
+  std::vector<BaseRNG>& rngs_;
+  diag_e_point metric_;
+  Eigen::MatrixXd q_;
+  // gradients of the log density, not of the potential
+  Eigen::MatrixXd g_;
+  Eigen::VectorXd lp_;
+  Eigen::VectorXd accept_stat_;
+  Eigen::VectorXd energy_;
+  Eigen::VectorXd divergent_;
+  double nom_epsilon_;
+  double T_;
+  int L_;
+  bool adapt_flag_;
+  stepsize_adaptation stepsize_adaptation_;
+  std::vector<var_adaptation> adaptations_;
+  static constexpr double max_deltaH_ = 1000;
+
+  void update_L_() {
+    L_ = static_cast<int>(T_ / nom_epsilon_);
+    L_ = L_ < 1 ? 1 : L_;
+  }
+
+  Eigen::VectorXd hamiltonian(const Eigen::MatrixXd& p) const {
+    return 0.5
+               * (metric_.inv_e_metric_.asDiagonal() * p.cwiseAbs2())
+                     .colwise()
+                     .sum()
+                     .transpose()
+           - lp_;
+  }
+
+  /**
+   * Evaluate the log density and its gradient at every position.  If
+   * the batch fails, the chains are evaluated one at a time, so that a
+   * domain error only rejects the proposals of the chains that hit it.
+   */
+  void evaluate(callbacks::logger& logger) {
+    std::stringstream msgs;
+    try {
+      model_.log_prob_grad_batch(true, true, q_, lp_, g_, &msgs);
+    } catch (const std::domain_error&) {
+      msgs.str(std::string());
+      Eigen::VectorXd lp;
+      Eigen::MatrixXd g;
+      bool logged = false;
+      for (Eigen::Index c = 0; c < q_.cols(); ++c) {
+        try {
+          model_.log_prob_grad_batch(true, true, q_.col(c), lp, g, &msgs);
+          lp_(c) = lp(0);
+          g_.col(c) = g.col(0);
+        } catch (const std::domain_error& e) {
+          if (!logged) {
+            logger.info(e.what());
+            logged = true;
+          }
+          lp_(c) = -std::numeric_limits<double>::infinity();
+          g_.col(c).setZero();
+        }
+      }
+    }
+    if (msgs.str().length() > 0)
+      logger.info(msgs);
+  }
+
+  void learn(double mean_accept_stat) {
+    stepsize_adaptation_.learn_stepsize(nom_epsilon_, mean_accept_stat);
+    update_L_();
+
+    Eigen::VectorXd unused(q_.rows());
+    for (Eigen::Index c = 0; c < q_.cols(); ++c)
+      adaptations_[c].learn_variance(unused, q_.col(c));
+    if (adaptations_[0].window_complete()) {
+      std::vector<var_adaptation*> pooled;
+      for (var_adaptation& adaptation : adaptations_)
+        pooled.push_back(&adaptation);
+      var_adaptation::pool_variance(pooled, metric_.inv_e_metric_);
+      stepsize_adaptation_.set_mu(std::log(10 * nom_epsilon_));
+      stepsize_adaptation_.restart();
+    }
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
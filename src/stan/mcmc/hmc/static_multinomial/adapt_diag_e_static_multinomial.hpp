@@ -0,0 +1,62 @@
+#ifndef STAN_MCMC_HMC_STATIC_MULTINOMIAL_ADAPT_DIAG_E_STATIC_MULTINOMIAL_HPP
+#define STAN_MCMC_HMC_STATIC_MULTINOMIAL_ADAPT_DIAG_E_STATIC_MULTINOMIAL_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/static_multinomial/diag_e_static_multinomial.hpp>
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Hamiltonian Monte Carlo implementation that samples multinomially
+ * from trajectories with a static integration time with a
+ * Gaussian-Euclidean disintegration and adaptive diagonal metric, adaptive
+ * step size and, if enabled, adaptive integration time
+ */
+template <class Model, class BaseRNG>
+class adapt_diag_e_static_multinomial
+    : public diag_e_static_multinomial<Model, BaseRNG>,
+      public stepsize_var_adapter {
+ public:
+  adapt_diag_e_static_multinomial(const Model& model, BaseRNG& rng)
+      : diag_e_static_multinomial<Model, BaseRNG>(model, rng),
+        stepsize_var_adapter(model.num_params_r()) {}
+
+  ~adapt_diag_e_static_multinomial() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    sample s = diag_e_static_multinomial<Model, BaseRNG>::transition(
+        init_sample, logger);
+
+    if (this->adapt_flag_) {
+      this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
+                                                s.accept_stat());
+      if (this->adapt_trajectory_length_)
+        this->learn_trajectory_length_();
+      this->update_L_();
+
+      bool update = this->var_adaptation_.learn_variance(
+          this->z_.inv_e_metric_, this->z_.q, this->z_.g);
+
+      if (update) {
+        this->init_stepsize(this->reused_stepsize(), logger);
+        this->update_L_();
+
+        this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
+        this->stepsize_adaptation_.restart();
+      }
+    }
+    return s;
+  }
+
+  void disengage_adaptation() {
+    base_adapter::disengage_adaptation();
+    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->complete_trajectory_length_adaptation_();
+    this->update_L_();
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
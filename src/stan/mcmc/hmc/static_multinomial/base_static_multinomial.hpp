@@ -0,0 +1,243 @@
+#ifndef STAN_MCMC_HMC_STATIC_MULTINOMIAL_BASE_STATIC_MULTINOMIAL_HPP
+#define STAN_MCMC_HMC_STATIC_MULTINOMIAL_BASE_STATIC_MULTINOMIAL_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/base_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/trajectory_length_adaptation.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Hamiltonian Monte Carlo implementation that samples multinomially
+ * from trajectories with a static, optionally jittered, integration
+ * time.
+ *
+ * Each transition integrates a trajectory of <code>L</code> leapfrog
+ * steps, or with jitter of a number of steps drawn uniformly between
+ * <code>(1 - jitter) L</code> and <code>L</code>, with the initial point
+ * at a uniformly drawn position along it, and draws the next state from
+ * the points of the trajectory with probabilities proportional to their
+ * densities.  Jittering the trajectory length as in ChEES-HMC avoids the
+ * periodic orbits of a fixed integration time.
+ *
+ * The points the transition keeps are preallocated members, so a
+ * transition allocates no memory, and the initial position, selected
+ * point and its integration time are kept for the adaptation of the
+ * integration time by <code>trajectory_length_adaptation</code>.
+ */
+template <class Model, template <class, class> class Hamiltonian,
+          template <class> class Integrator, class BaseRNG>
+class base_static_multinomial
+    : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
+ public:
+  base_static_multinomial(const Model& model, BaseRNG& rng)
+      : base_hmc<Model, Hamiltonian, Integrator, BaseRNG>(model, rng),
+        T_(1),
+        jitter_(0),
+        energy_(0),
+        n_leapfrog_(0),
+        z_init_(model.num_params_r()),
+        z_sample_(model.num_params_r()),
+        sample_time_(0),
+        accept_prob_(0),
+        trajectory_length_adaptation_(model.num_params_r()),
+        adapt_trajectory_length_(false) {
+    update_L_();
+  }
+
+  ~base_static_multinomial() {}
+
+  void set_metric(const Eigen::MatrixXd& inv_e_metric) {
+    this->z_.set_metric(inv_e_metric);
+  }
+
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    this->z_.set_metric(inv_e_metric);
+  }
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    this->sample_stepsize();
+
+    this->seed(init_sample.cont_params());
+
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    this->hamiltonian_.init(this->z_, logger);
+
+    z_init_ = this->z_;
+    z_sample_ = this->z_;
+    const double H0 = this->hamiltonian_.H(this->z_);
+
+    int num_steps = L_;
+    if (jitter_ > 0) {
+      num_steps = static_cast<int>(
+          std::ceil(L_ * (1 - jitter_ * this->rand_uniform_())));
+      num_steps = num_steps < 1 ? 1 : num_steps;
+    }
+
+    boost::random::uniform_int_distribution<> uniform(0, num_steps);
+    const int num_backward = uniform(this->rand_int_);
+
+    double sum_prob = 1;
+    double sum_metro_prob = 0;
+    int sample_steps = 0;
+
+    auto integrate = [&](int num, int direction) {
+      for (int l = 0; l < num; ++l) {
+        this->integrator_.evolve(this->z_, this->hamiltonian_,
+                                 direction * this->epsilon_, logger);
+
+        double h = this->hamiltonian_.H(this->z_);
+        if (std::isnan(h))
+          h = std::numeric_limits<double>::infinity();
+
+        const double prob = std::exp(H0 - h);
+        sum_prob += prob;
+        sum_metro_prob += prob > 1 ? 1 : prob;
+
+        if (this->rand_uniform_() < prob / sum_prob) {
+          z_sample_ = this->z_;
+          sample_steps = direction * (l + 1);
+        }
+      }
+    };
+
+    integrate(num_backward, -1);
+    this->z_.ps_point::operator=(z_init_);
+    integrate(num_steps - num_backward, 1);
+
+    accept_prob_ = sum_metro_prob / num_steps;
+    n_leapfrog_ = num_steps;
+    sample_time_ = sample_steps * this->epsilon_;
+
+    this->z_.ps_point::operator=(z_sample_);
+    this->energy_ = this->hamiltonian_.H(this->z_);
+    return sample(this->z_.q, -this->hamiltonian_.V(this->z_), accept_prob_);
+  }
+
+  void get_sampler_param_names(std::vector<std::string>& names) {
+    names.push_back("stepsize__");
+    names.push_back("int_time__");
+    names.push_back("n_leapfrog__");
+    names.push_back("energy__");
+  }
+
+  void get_sampler_params(std::vector<double>& values) {
+    values.push_back(this->epsilon_);
+    values.push_back(this->T_);
+    values.push_back(this->n_leapfrog_);
+    values.push_back(this->energy_);
+  }
+
+  void set_nominal_stepsize_and_T(const double e, const double t) {
+    if (e > 0 && t > 0) {
+      this->nom_epsilon_ = e;
+      T_ = t;
+      update_L_();
+    }
+  }
+
+  void set_nominal_stepsize_and_L(const double e, const int l) {
+    if (e > 0 && l > 0) {
+      this->nom_epsilon_ = e;
+      L_ = l;
+      T_ = this->nom_epsilon_ * L_;
+    }
+  }
+
+  void set_T(const double t) {
+    if (t > 0) {
+      T_ = t;
+      update_L_();
+    }
+  }
+
+  void set_nominal_stepsize(const double e) {
+    if (e > 0) {
+      this->nom_epsilon_ = e;
+      update_L_();
+    }
+  }
+
+  /**
+   * Set the fraction by which the number of leapfrog steps of a
+   * transition is jittered below <code>L</code>; one gives the uniform
+   * jitter of ChEES-HMC.
+   *
+   * @param j jitter, between zero and one
+   */
+  void set_trajectory_jitter(const double j) {
+    if (j >= 0 && j <= 1)
+      jitter_ = j;
+  }
+
+  double get_T() { return this->T_; }
+
+  int get_L() { return this->L_; }
+
+  double get_trajectory_jitter() { return this->jitter_; }
+
+  /**
+   * Set whether the integration time is adapted along with the step
+   * size while adaptation is engaged.
+   */
+  void set_adapt_trajectory_length(const bool adapt) {
+    adapt_trajectory_length_ = adapt;
+  }
+
+  bool adapt_trajectory_length() { return adapt_trajectory_length_; }
+
+  trajectory_length_adaptation& get_trajectory_length_adaptation() {
+    return trajectory_length_adaptation_;
+  }
+
+ protected:
+  double T_;
+  int L_;
+  double jitter_;
+  double energy_;
+  int n_leapfrog_;
+  ps_point z_init_;
+  ps_point z_sample_;
+  double sample_time_;
+  double accept_prob_;
+  trajectory_length_adaptation trajectory_length_adaptation_;
+  bool adapt_trajectory_length_;
+
+  void update_L_() {
+    L_ = static_cast<int>(T_ / this->nom_epsilon_);
+    L_ = L_ < 1 ? 1 : L_;
+  }
+
+  /**
+   * Update the integration time from the last transition, whose selected
+   * point is the current point.
+   */
+  void learn_trajectory_length_() {
+    const Eigen::VectorXd velocity = this->hamiltonian_.dtau_dp(this->z_);
+    const Eigen::Matrix<double, 1, 1> time(sample_time_);
+    const Eigen::Matrix<double, 1, 1> accept_prob(accept_prob_);
+    trajectory_length_adaptation_.learn_trajectory_length(
+        T_, z_init_.q, this->z_.q, velocity, time, accept_prob);
+    update_L_();
+  }
+
+  /**
+   * Set the integration time to its adapted value, if it was adapted.
+   */
+  void complete_trajectory_length_adaptation_() {
+    if (adapt_trajectory_length_) {
+      trajectory_length_adaptation_.complete_adaptation(T_);
+      update_L_();
+    }
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,28 @@
+#ifndef STAN_MCMC_HMC_STATIC_MULTINOMIAL_UNIT_E_STATIC_MULTINOMIAL_HPP
+#define STAN_MCMC_HMC_STATIC_MULTINOMIAL_UNIT_E_STATIC_MULTINOMIAL_HPP
+
+#include <stan/mcmc/hmc/static_multinomial/base_static_multinomial.hpp>
+#include <stan/mcmc/hmc/hamiltonians/unit_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/unit_e_metric.hpp>
+#include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Hamiltonian Monte Carlo implementation that samples multinomially
+ * from trajectories with a static integration time with a
+ * Gaussian-Euclidean disintegration and unit metric
+ */
+template <typename Model, class BaseRNG>
+class unit_e_static_multinomial
+    : public base_static_multinomial<Model, unit_e_metric, expl_leapfrog,
+                                     BaseRNG> {
+ public:
+  unit_e_static_multinomial(const Model& model, BaseRNG& rng)
+      : base_static_multinomial<Model, unit_e_metric, expl_leapfrog, BaseRNG>(
+          model, rng) {}
+};
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
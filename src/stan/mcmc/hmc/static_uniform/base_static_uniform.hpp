@@ -65,7 +65,8 @@ class base_static_uniform
         z_sample = this->z_;
     }
 
-    this->z_.ps_point::operator=(z_init);
+    // the initial point is not needed again, so it is swapped back in
+    this->z_.ps_point::swap(z_init);
 
     for (int l = 0; l < L_ - 1 - Lp; ++l) {
       this->integrator_.evolve(this->z_, this->hamiltonian_, this->epsilon_,
@@ -85,7 +86,7 @@ class base_static_uniform
 
     double accept_prob = sum_metro_prob / static_cast<double>(L_);
 
-    this->z_.ps_point::operator=(z_sample);
+    this->z_.ps_point::swap(z_sample);
     this->energy_ = this->hamiltonian_.H(this->z_);
     return sample(this->z_.q, -this->hamiltonian_.V(this->z_), accept_prob);
   }
@@ -0,0 +1,108 @@
+#ifndef STAN_MCMC_HMC_TREE_WEIGHT_HPP
+#define STAN_MCMC_HMC_TREE_WEIGHT_HPP
+
+#include <cmath>
+#include <limits>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Sum of the weights of the states of a trajectory, the exponentials of
+ * the negated energies offset by the initial energy, along with the
+ * weighted sum of a value of each state.
+ *
+ * The sum is held as the largest log weight and the sum of the weights
+ * scaled by its exponential, so adding a state or merging a subtree takes
+ * one <code>exp</code> and no <code>log</code>.  The log of the sum is
+ * only taken when it is needed as a number.
+ */
+class tree_weight {
+ public:
+  /**
+   * Construct the weight of an empty trajectory.
+   */
+  tree_weight()
+      : max_log_weight_(-std::numeric_limits<double>::infinity()),
+        scaled_sum_(0),
+        scaled_value_sum_(0) {}
+
+  /**
+   * Construct the weight of a single state.
+   *
+   * @param log_weight log weight of the state
+   * @param value value of the state to average
+   */
+  explicit tree_weight(double log_weight, double value = 0)
+      : max_log_weight_(log_weight),
+        scaled_sum_(log_weight > -std::numeric_limits<double>::infinity()),
+        scaled_value_sum_(scaled_sum_ * value) {}
+
+  /**
+   * Add a state to the trajectory.
+   *
+   * @param log_weight log weight of the state
+   * @param value value of the state to average
+   */
+  void add(double log_weight, double value = 0) {
+    if (log_weight > max_log_weight_) {
+      const double e = std::exp(max_log_weight_ - log_weight);
+      scaled_sum_ = scaled_sum_ * e + 1;
+      scaled_value_sum_ = scaled_value_sum_ * e + value;
+      max_log_weight_ = log_weight;
+    } else if (log_weight > -std::numeric_limits<double>::infinity()) {
+      const double e = std::exp(log_weight - max_log_weight_);
+      scaled_sum_ += e;
+      scaled_value_sum_ += e * value;
+    }
+  }
+
+  /**
+   * Add the states of another trajectory.
+   *
+   * @param other weight of the other trajectory
+   */
+  void add(const tree_weight& other) {
+    if (other.max_log_weight_ > max_log_weight_) {
+      const double e = std::exp(max_log_weight_ - other.max_log_weight_);
+      scaled_sum_ = scaled_sum_ * e + other.scaled_sum_;
+      scaled_value_sum_ = scaled_value_sum_ * e + other.scaled_value_sum_;
+      max_log_weight_ = other.max_log_weight_;
+    } else if (other.max_log_weight_
+               > -std::numeric_limits<double>::infinity()) {
+      const double e = std::exp(other.max_log_weight_ - max_log_weight_);
+      scaled_sum_ += e * other.scaled_sum_;
+      scaled_value_sum_ += e * other.scaled_value_sum_;
+    }
+  }
+
+  /**
+   * Return the ratio of the weight of another trajectory to this one.
+   *
+   * @param other weight of the other trajectory
+   */
+  double ratio(const tree_weight& other) const {
+    return other.scaled_sum_ / scaled_sum_
+           * std::exp(other.max_log_weight_ - max_log_weight_);
+  }
+
+  /**
+   * Return the log of the summed weights.
+   */
+  double log() const { return max_log_weight_ + std::log(scaled_sum_); }
+
+  /**
+   * Return the weighted average of the values of the states.
+   */
+  double average() const { return scaled_value_sum_ / scaled_sum_; }
+
+ private:
+  double max_log_weight_;    // Largest log weight of a state
+  double scaled_sum_;        // Sum of weights over exp(max_log_weight_)
+  double scaled_value_sum_;  // Sum of weighted values, scaled the same
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
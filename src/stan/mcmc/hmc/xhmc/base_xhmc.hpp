@@ -3,7 +3,9 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/mcmc/hmc/base_hmc.hpp>
+#include <stan/mcmc/hmc/gradient_budget.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/tree_weight.hpp>
 #include <algorithm>
 #include <cmath>
 #include <limits>
@@ -30,7 +32,8 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         x_delta_(0.1),
         n_leapfrog_(0),
         divergent_(0),
-        energy_(0) {}
+        energy_(0),
+        capped_(false) {}
 
   ~base_xhmc() {}
 
@@ -50,6 +53,27 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   double get_max_deltaH() { return this->max_deltaH_; }
   double get_x_delta() { return this->x_delta_; }
 
+  /**
+   * Limit the leapfrog steps of each transition, and of all of them
+   * together, as explained for <code>gradient_budget</code>.  While a
+   * budget is set the sampler parameters end with
+   * <code>budget_capped__</code>, which flags the transitions the budget
+   * ended, so it must be set before their names are written.
+   *
+   * @param per_transition largest number of leapfrog steps of a
+   *   transition, or zero for no limit
+   * @param per_run number of leapfrog steps of the run, or zero for no
+   *   limit
+   * @throw std::invalid_argument if a budget is negative
+   */
+  void set_gradient_budget(long per_transition, long per_run = 0) {
+    gradient_budget_ = gradient_budget(per_transition, per_run);
+  }
+
+  const gradient_budget& get_gradient_budget() const noexcept {
+    return gradient_budget_;
+  }
+
   sample transition(sample& init_sample, callbacks::logger& logger) {
     // Initialize the algorithm
     this->sample_stepsize();
@@ -65,8 +89,8 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     ps_point z_sample(z_plus);
     ps_point z_propose(z_plus);
 
-    double ave = this->hamiltonian_.dG_dt(this->z_, logger);
-    double log_sum_weight = 0;  // log(exp(H0 - H0))
+    // Sum of state weights (offset by H0) and their weighted dG/dt
+    tree_weight sum_weight(0, this->hamiltonian_.dG_dt(this->z_, logger));
 
     double H0 = this->hamiltonian_.H(this->z_);
     int n_leapfrog = 0;
@@ -75,51 +99,56 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     // Build a trajectory until the NUTS criterion is no longer satisfied
     this->depth_ = 0;
     this->divergent_ = 0;
+    this->capped_ = false;
+    const int max_depth = gradient_budget_.max_depth(this->max_depth_);
 
-    while (this->depth_ < this->max_depth_) {
+    while (this->depth_ < max_depth) {
       // Build a new subtree in a random direction
       bool valid_subtree = false;
-      double ave_subtree = 0;
-      double log_sum_weight_subtree = -std::numeric_limits<double>::infinity();
+      tree_weight sum_weight_subtree;
 
+      // the ends are swapped in and out of the integrated point rather
+      // than copied
       if (this->rand_uniform_() > 0.5) {
-        this->z_.ps_point::operator=(z_plus);
-        valid_subtree = build_tree(this->depth_, z_propose, ave_subtree,
-                                   log_sum_weight_subtree, H0, 1, n_leapfrog,
-                                   sum_metro_prob, logger);
-        z_plus.ps_point::operator=(this->z_);
+        this->z_.ps_point::swap(z_plus);
+        valid_subtree
+            = build_tree(this->depth_, z_propose, sum_weight_subtree, H0, 1,
+                         n_leapfrog, sum_metro_prob, logger);
+        this->z_.ps_point::swap(z_plus);
       } else {
-        this->z_.ps_point::operator=(z_minus);
-        valid_subtree = build_tree(this->depth_, z_propose, ave_subtree,
-                                   log_sum_weight_subtree, H0, -1, n_leapfrog,
-                                   sum_metro_prob, logger);
-        z_minus.ps_point::operator=(this->z_);
+        this->z_.ps_point::swap(z_minus);
+        valid_subtree
+            = build_tree(this->depth_, z_propose, sum_weight_subtree, H0, -1,
+                         n_leapfrog, sum_metro_prob, logger);
+        this->z_.ps_point::swap(z_minus);
       }
 
       if (!valid_subtree)
         break;
-      std::tie(ave, log_sum_weight) = stable_sum(
-          ave, log_sum_weight, ave_subtree, log_sum_weight_subtree);
+      sum_weight.add(sum_weight_subtree);
 
       // Sample from an accepted subtree
       ++(this->depth_);
 
-      double accept_prob = std::exp(log_sum_weight_subtree - log_sum_weight);
+      double accept_prob = sum_weight.ratio(sum_weight_subtree);
       if (this->rand_uniform_() < accept_prob)
-        z_sample = z_propose;
+        z_sample.swap(z_propose);
 
       // Break if exhaustion criterion is satisfied
-      if (std::fabs(ave) < x_delta_)
+      if (std::fabs(sum_weight.average()) < x_delta_)
         break;
+
+      this->capped_ = this->depth_ == max_depth && max_depth < this->max_depth_;
     }
 
     this->n_leapfrog_ = n_leapfrog;
+    gradient_budget_.record(n_leapfrog, this->capped_);
 
     // Compute average acceptance probability across entire trajectory,
     // even over subtrees that may have been rejected
     double accept_prob = sum_metro_prob / static_cast<double>(n_leapfrog + 1);
 
-    this->z_.ps_point::operator=(z_sample);
+    this->z_.ps_point::swap(z_sample);
     this->energy_ = this->hamiltonian_.H(this->z_);
     return sample(this->z_.q, -this->z_.V, accept_prob);
   }
@@ -130,6 +159,8 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     names.push_back("n_leapfrog__");
     names.push_back("divergent__");
     names.push_back("energy__");
+    if (gradient_budget_.enabled())
+      names.push_back("budget_capped__");
   }
 
   void get_sampler_params(std::vector<double>& values) {
@@ -138,6 +169,8 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     values.push_back(this->n_leapfrog_);
     values.push_back(this->divergent_);
     values.push_back(this->energy_);
+    if (gradient_budget_.enabled())
+      values.push_back(this->capped_);
   }
 
   /**
@@ -160,6 +193,33 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
                   double& log_sum_weight, double H0, double sign,
                   int& n_leapfrog, double& sum_metro_prob,
                   callbacks::logger& logger) {
+    tree_weight sum_weight(log_sum_weight, ave);
+    bool valid_subtree = build_tree(depth, z_propose, sum_weight, H0, sign,
+                                    n_leapfrog, sum_metro_prob, logger);
+    ave = sum_weight.average();
+    log_sum_weight = sum_weight.log();
+    return valid_subtree;
+  }
+
+  /**
+   * Recursively build a new subtree as <code>build_tree</code> does,
+   * accumulating the weights of the states and their weighted dG/dt
+   * without taking logs.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param sum_weight Summed weights across trajectory, with the weighted
+   * average of dG/dt
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   * @return whether built tree is valid
+   */
+  bool build_tree(int depth, ps_point& z_propose, tree_weight& sum_weight,
+                  double H0, double sign, int& n_leapfrog,
+                  double& sum_metro_prob, callbacks::logger& logger) {
     // Base case
     if (depth == 0) {
       this->integrator_.evolve(this->z_, this->hamiltonian_,
@@ -175,8 +235,7 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
       double dG_dt = this->hamiltonian_.dG_dt(this->z_, logger);
 
-      std::tie(ave, log_sum_weight)
-          = stable_sum(ave, log_sum_weight, dG_dt, H0 - h);
+      sum_weight.add(H0 - h, dG_dt);
 
       if (H0 - h > 0)
         sum_metro_prob += 1;
@@ -190,44 +249,36 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     // General recursion
 
     // Build the left subtree
-    double ave_left = 0;
-    double log_sum_weight_left = -std::numeric_limits<double>::infinity();
+    tree_weight sum_weight_left;
 
-    bool valid_left
-        = build_tree(depth - 1, z_propose, ave_left, log_sum_weight_left, H0,
-                     sign, n_leapfrog, sum_metro_prob, logger);
+    bool valid_left = build_tree(depth - 1, z_propose, sum_weight_left, H0,
+                                 sign, n_leapfrog, sum_metro_prob, logger);
 
     if (!valid_left)
       return false;
-    std::tie(ave, log_sum_weight)
-        = stable_sum(ave, log_sum_weight, ave_left, log_sum_weight_left);
+    sum_weight.add(sum_weight_left);
 
     // Build the right subtree
     ps_point z_propose_right(this->z_);
-    double ave_right = 0;
-    double log_sum_weight_right = -std::numeric_limits<double>::infinity();
+    tree_weight sum_weight_right;
 
-    bool valid_right = build_tree(depth - 1, z_propose_right, ave_right,
-                                  log_sum_weight_right, H0, sign, n_leapfrog,
-                                  sum_metro_prob, logger);
+    bool valid_right
+        = build_tree(depth - 1, z_propose_right, sum_weight_right, H0, sign,
+                     n_leapfrog, sum_metro_prob, logger);
 
     if (!valid_right)
       return false;
-    std::tie(ave, log_sum_weight)
-        = stable_sum(ave, log_sum_weight, ave_right, log_sum_weight_right);
+    sum_weight.add(sum_weight_right);
 
     // Multinomial sample from right subtree
-    double ave_subtree;
-    double log_sum_weight_subtree;
-    std::tie(ave_subtree, log_sum_weight_subtree) = stable_sum(
-        ave_left, log_sum_weight_left, ave_right, log_sum_weight_right);
+    tree_weight sum_weight_subtree = sum_weight_left;
+    sum_weight_subtree.add(sum_weight_right);
 
-    double accept_prob
-        = std::exp(log_sum_weight_right - log_sum_weight_subtree);
+    double accept_prob = sum_weight_subtree.ratio(sum_weight_right);
     if (this->rand_uniform_() < accept_prob)
-      z_propose = z_propose_right;
+      z_propose.swap(z_propose_right);
 
-    return std::abs(ave_subtree) >= x_delta_;
+    return std::abs(sum_weight_subtree.average()) >= x_delta_;
   }
 
   /**
@@ -272,6 +323,9 @@ class base_xhmc : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int n_leapfrog_;
   bool divergent_;
   double energy_;
+
+  gradient_budget gradient_budget_;
+  bool capped_;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,238 @@
+#ifndef STAN_MCMC_LOWRANK_ADAPTATION_HPP
+#define STAN_MCMC_LOWRANK_ADAPTATION_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/windowed_adaptation.hpp>
+#include <boost/random/mixmax.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Windowed adaptation of an inverse metric that is diagonal plus low
+ * rank, <code>diag(d) + U U^T</code>, in O(<code>n k</code>) memory for
+ * <code>n</code> parameters and rank <code>k</code>.
+ *
+ * The diagonal is the variance of the draws of each window, so with
+ * rank zero this matches <code>var_adaptation</code>.  The low-rank part
+ * is made from the leading eigenvectors of the correlation matrix of the
+ * draws, whose eigenvalues above one are the correlations a diagonal
+ * metric misses.
+ *
+ * The draws are not kept.  Instead the product of their scatter matrix,
+ * standardized with the diagonal of the current metric, with an
+ * orthonormal basis of <code>2 k + 5</code> columns is accumulated, in
+ * O(<code>n k</code>) operations per draw.  At the end of a window the
+ * correlation matrix is approximated from that product by the Nystrom
+ * method, and the range of the product becomes the basis of the next
+ * window.  The windows then perform a subspace iteration, so the leading
+ * eigenvectors are resolved better with each window even though the
+ * first basis is random.
+ */
+class lowrank_adaptation : public windowed_adaptation {
+ public:
+  /**
+   * Construct an adaptation for the specified numbers of parameters and
+   * of corrections to the diagonal.
+   *
+   * @param n number of parameters
+   * @param rank number of corrections, reduced to <code>n</code> if more
+   * @throw std::invalid_argument if the rank is negative
+   */
+  lowrank_adaptation(int n, int rank)
+      : windowed_adaptation("low-rank metric"),
+        estimator_(n),
+        rank_(std::min(n, rank)),
+        mean_(Eigen::VectorXd::Zero(n)),
+        num_samples_(0) {
+    if (rank < 0)
+      throw std::invalid_argument("Rank of the metric must be non-negative");
+    const int num_cols = rank_ == 0 ? 0 : std::min(n, 2 * rank_ + 5);
+    // a fixed seed keeps the adaptation reproducible
+    boost::random::mixmax rng(0, 0, 0, 1);
+    boost::random::normal_distribution<double> std_normal;
+    Eigen::MatrixXd gaussian(n, num_cols);
+    for (int j = 0; j < num_cols; ++j)
+      for (int i = 0; i < n; ++i)
+        gaussian(i, j) = std_normal(rng);
+    set_basis(gaussian);
+    product_ = Eigen::MatrixXd::Zero(n, num_cols);
+  }
+
+  int rank() const noexcept { return rank_; }
+
+  /**
+   * Return the bytes of storage held by the estimators of the variances
+   * and of the low-rank corrections.
+   */
+  size_t memory_bytes() const {
+    return (3 * mean_.size() + basis_.size() + product_.size()
+            + inv_scale_.size())
+           * sizeof(double);
+  }
+
+  /**
+   * Add a draw to the current window and, at the end of a window, replace
+   * the inverse metric with the regularized estimate from its draws.
+   *
+   * @param[in,out] var diagonal of the inverse metric
+   * @param[in,out] lowrank factor of the low-rank part of the inverse
+   * metric, with at most <code>rank</code> columns
+   * @param[in] q draw
+   * @return <code>true</code> if the inverse metric was updated
+   * @throw std::runtime_error if the estimate is not finite
+   */
+  bool learn_metric(Eigen::VectorXd& var, Eigen::MatrixXd& lowrank,
+                    const Eigen::VectorXd& q) {
+    if (adaptation_window())
+      add_sample(var, q);
+
+    if (end_adaptation_window()) {
+      compute_next_window();
+
+      estimate(var, lowrank);
+
+      restart_estimator();
+
+      ++adapt_window_counter_;
+      return true;
+    }
+
+    ++adapt_window_counter_;
+    return false;
+  }
+
+ protected:
+  /**
+   * Add a draw to the variance estimator and multiply its Welford update
+   * of the standardized scatter matrix, <code>(n - 1) / n x x^T</code>
+   * for the standardized difference <code>x</code> between the draw and
+   * the mean of the previous ones, with the basis.
+   */
+  void add_sample(const Eigen::VectorXd& var, const Eigen::VectorXd& q) {
+    estimator_.add_sample(q);
+    ++num_samples_;
+    if (rank_ == 0)
+      return;
+    if (num_samples_ == 1)
+      inv_scale_ = (var.array() > 0)
+                       .select(var.array().sqrt().inverse(), 1.0)
+                       .matrix();
+    Eigen::VectorXd delta = q - mean_;
+    mean_ += delta / num_samples_;
+    if (num_samples_ == 1)
+      return;
+    delta.array() *= inv_scale_.array();
+    product_.noalias() += ((num_samples_ - 1.0) / num_samples_) * delta
+                          * (delta.transpose() * basis_);
+  }
+
+  /**
+   * Estimate the inverse metric from the draws of the window, shrinking
+   * the variances towards a small value and the correlation eigenvalues
+   * towards one as <code>var_adaptation</code> does.
+   */
+  void estimate(Eigen::VectorXd& var, Eigen::MatrixXd& lowrank) {
+    const double n = num_samples_;
+    estimator_.sample_variance(var);
+    var = (n / (n + 5.0)) * var
+          + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
+    check_finite(var);
+
+    lowrank.resize(var.size(), 0);
+    if (rank_ == 0 || n < 2)
+      return;
+
+    // change the standardization to the new variances
+    Eigen::VectorXd sd = var.cwiseSqrt();
+    Eigen::MatrixXd product
+        = inv_scale_.cwiseInverse().cwiseQuotient(sd).asDiagonal() * product_;
+
+    // the Nystrom approximation of the scatter matrix is F F^T with
+    // F = product (basis^T product_)^{-1/2}
+    Eigen::MatrixXd core = basis_.transpose() * product_;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> core_solver(
+        0.5 * (core + core.transpose()));
+    Eigen::VectorXd core_values = core_solver.eigenvalues();
+    const double core_threshold = 1e-12 * std::max(core_values.maxCoeff(), 0.0);
+    Eigen::VectorXd core_inv_sqrt = Eigen::VectorXd::Zero(core_values.size());
+    for (Eigen::Index i = 0; i < core_values.size(); ++i)
+      if (core_values(i) > core_threshold)
+        core_inv_sqrt(i) = 1 / std::sqrt(core_values(i));
+    Eigen::MatrixXd factor = product * core_solver.eigenvectors()
+                             * core_inv_sqrt.asDiagonal();
+
+    // eigenvectors of F F^T from those of the small matrix F^T F
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(factor.transpose()
+                                                          * factor);
+    const Eigen::Index num_values = solver.eigenvalues().size();
+    Eigen::VectorXd scales(rank_);
+    Eigen::MatrixXd directions(var.size(), rank_);
+    Eigen::Index num_kept = 0;
+    // the solver sorts the eigenvalues in increasing order
+    for (Eigen::Index i = num_values - 1; i >= 0 && num_kept < rank_; --i) {
+      const double value = solver.eigenvalues()(i);
+      const double correlation
+          = (n / (n + 5.0)) * value / (n - 1.0) + 5.0 / (n + 5.0);
+      if (!(correlation > 1))
+        break;
+      directions.col(num_kept)
+          = factor * solver.eigenvectors().col(i) / std::sqrt(value);
+      scales(num_kept) = std::sqrt(correlation - 1);
+      ++num_kept;
+    }
+    lowrank = sd.asDiagonal() * directions.leftCols(num_kept)
+              * scales.head(num_kept).asDiagonal();
+    check_finite(lowrank);
+
+    set_basis(product);
+  }
+
+  /**
+   * Make the basis an orthonormal basis of the range of the specified
+   * matrix, completed arbitrarily if it is rank deficient.
+   */
+  void set_basis(const Eigen::MatrixXd& m) {
+    Eigen::HouseholderQR<Eigen::MatrixXd> qr(m);
+    basis_ = qr.householderQ() * Eigen::MatrixXd::Identity(m.rows(), m.cols());
+  }
+
+  template <typename T>
+  static void check_finite(const T& x) {
+    if (!x.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
+
+  void restart_estimator() {
+    estimator_.restart();
+    product_.setZero();
+    mean_.setZero();
+    num_samples_ = 0;
+  }
+
+  stan::math::welford_var_estimator estimator_;
+  int rank_;
+  // orthonormal basis and the product of the standardized scatter matrix
+  // of the window with it
+  Eigen::MatrixXd basis_;
+  Eigen::MatrixXd product_;
+  // inverse standard deviations standardizing the draws of the window
+  Eigen::VectorXd inv_scale_;
+  Eigen::VectorXd mean_;
+  double num_samples_;
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+#endif
@@ -0,0 +1,108 @@
+#ifndef STAN_MCMC_POINT_CHECKPOINT_HPP
+#define STAN_MCMC_POINT_CHECKPOINT_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
+#include <stan/mcmc/hmc/hamiltonians/block_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/dense_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_mixed_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Write the position, momentum, potential and gradient of a phase space
+ * point to a checkpoint.  The overloads for points of each metric also
+ * write the metric.
+ *
+ * @param[in] z point
+ * @param[in,out] writer checkpoint writer
+ */
+inline void write_point_checkpoint(const ps_point& z,
+                                   callbacks::structured_writer& writer) {
+  writer.write("point_q", z.q);
+  writer.write("point_p", z.p);
+  writer.write("point_g", z.g);
+  writer.write("point_V", z.V);
+}
+
+inline void write_point_checkpoint(const diag_e_point& z,
+                                   callbacks::structured_writer& writer) {
+  write_point_checkpoint(static_cast<const ps_point&>(z), writer);
+  writer.write("inv_metric", z.inv_e_metric_);
+}
+
+inline void write_point_checkpoint(const dense_e_point& z,
+                                   callbacks::structured_writer& writer) {
+  write_point_checkpoint(static_cast<const ps_point&>(z), writer);
+  writer.write("inv_metric", z.inv_e_metric_);
+}
+
+inline void write_point_checkpoint(const block_e_point& z,
+                                   callbacks::structured_writer& writer) {
+  write_point_checkpoint(static_cast<const ps_point&>(z), writer);
+  writer.write("inv_metric_block_sizes", z.block_sizes());
+  for (size_t b = 0; b < z.inv_e_metric_.size(); ++b)
+    writer.write("inv_metric_block_" + std::to_string(b + 1),
+                 z.inv_e_metric_[b]);
+}
+
+/**
+ * Restore a phase space point, of the same size, from the state written
+ * by <code>write_point_checkpoint</code>.  The overloads for points of
+ * each metric also restore the metric.
+ *
+ * @param[in,out] z point
+ * @param[in] context checkpoint
+ * @throw std::invalid_argument if the checkpoint lacks a value
+ */
+inline void read_point_checkpoint(ps_point& z,
+                                  const io::var_context& context) {
+  z.q = read_checkpoint_vector(context, "point_q", z.q.size());
+  z.p = read_checkpoint_vector(context, "point_p", z.p.size());
+  z.g = read_checkpoint_vector(context, "point_g", z.g.size());
+  z.V = read_checkpoint_scalar(context, "point_V");
+}
+
+inline void read_point_checkpoint(diag_e_point& z,
+                                  const io::var_context& context) {
+  read_point_checkpoint(static_cast<ps_point&>(z), context);
+  z.set_metric(
+      read_checkpoint_vector(context, "inv_metric", z.inv_e_metric_.size()));
+}
+
+inline void read_point_checkpoint(diag_e_mixed_point& z,
+                                  const io::var_context& context) {
+  read_point_checkpoint(static_cast<diag_e_point&>(z), context);
+  z.update_metric_factor();
+}
+
+inline void read_point_checkpoint(dense_e_point& z,
+                                  const io::var_context& context) {
+  read_point_checkpoint(static_cast<ps_point&>(z), context);
+  z.set_metric(read_checkpoint_matrix(context, "inv_metric",
+                                      z.inv_e_metric_.rows(),
+                                      z.inv_e_metric_.cols()));
+}
+
+inline void read_point_checkpoint(block_e_point& z,
+                                  const io::var_context& context) {
+  read_point_checkpoint(static_cast<ps_point&>(z), context);
+  std::vector<Eigen::MatrixXd> inv_e_metric(z.inv_e_metric_.size());
+  for (size_t b = 0; b < z.inv_e_metric_.size(); ++b) {
+    const Eigen::Index size = z.inv_e_metric_[b].rows();
+    inv_e_metric[b] = read_checkpoint_matrix(
+        context, "inv_metric_block_" + std::to_string(b + 1), size, size);
+  }
+  z.set_metric(inv_e_metric);
+}
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
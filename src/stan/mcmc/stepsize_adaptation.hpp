@@ -1,8 +1,12 @@
 #ifndef STAN_MCMC_STEPSIZE_ADAPTATION_HPP
 #define STAN_MCMC_STEPSIZE_ADAPTATION_HPP
 
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
 #include <stan/mcmc/base_adaptation.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
 #include <cmath>
+#include <limits>
 
 namespace stan {
 
@@ -72,6 +76,58 @@ class stepsize_adaptation : public base_adaptation {
 
   void complete_adaptation(double& epsilon) { epsilon = std::exp(x_bar_); }
 
+  /**
+   * Return the step size averaged by the dual averaging since the last
+   * restart scaled by the specified factor, to start the next adaptation
+   * window after a change of metric from what the last window learned
+   * instead of from trial leapfrog steps.  There is no estimate before
+   * ten updates or while the moving average of the acceptance statistic
+   * is more than 0.1 off its target.
+   *
+   * @param scale ratio of the step sizes stable under the new and the
+   * old metric
+   * @return estimate of the step size, or NaN if there is none
+   */
+  double rescaled_stepsize(double scale) const {
+    if (counter_ < 10 || std::fabs(s_bar_) > 0.1 || !(scale > 0)
+        || std::isinf(scale))
+      return std::numeric_limits<double>::quiet_NaN();
+    return std::exp(x_bar_) * scale;
+  }
+
+  /**
+   * Write the dual averaging state and parameters to a checkpoint.
+   *
+   * @param[in,out] writer checkpoint writer
+   */
+  void write_checkpoint(callbacks::structured_writer& writer) const {
+    writer.write("stepsize_adaptation_counter", counter_);
+    writer.write("stepsize_adaptation_s_bar", s_bar_);
+    writer.write("stepsize_adaptation_x_bar", x_bar_);
+    writer.write("stepsize_adaptation_mu", mu_);
+    writer.write("stepsize_adaptation_delta", delta_);
+    writer.write("stepsize_adaptation_gamma", gamma_);
+    writer.write("stepsize_adaptation_kappa", kappa_);
+    writer.write("stepsize_adaptation_t0", t0_);
+  }
+
+  /**
+   * Restore the dual averaging state and parameters from a checkpoint.
+   *
+   * @param[in] context checkpoint
+   * @throw std::invalid_argument if the checkpoint lacks a value
+   */
+  void read_checkpoint(const io::var_context& context) {
+    counter_ = read_checkpoint_scalar(context, "stepsize_adaptation_counter");
+    s_bar_ = read_checkpoint_scalar(context, "stepsize_adaptation_s_bar");
+    x_bar_ = read_checkpoint_scalar(context, "stepsize_adaptation_x_bar");
+    mu_ = read_checkpoint_scalar(context, "stepsize_adaptation_mu");
+    delta_ = read_checkpoint_scalar(context, "stepsize_adaptation_delta");
+    gamma_ = read_checkpoint_scalar(context, "stepsize_adaptation_gamma");
+    kappa_ = read_checkpoint_scalar(context, "stepsize_adaptation_kappa");
+    t0_ = read_checkpoint_scalar(context, "stepsize_adaptation_t0");
+  }
+
  protected:
   double counter_;  // Adaptation iteration
   double s_bar_;    // Moving average statistic
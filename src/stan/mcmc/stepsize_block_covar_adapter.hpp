@@ -0,0 +1,46 @@
+#ifndef STAN_MCMC_STEPSIZE_BLOCK_COVAR_ADAPTER_HPP
+#define STAN_MCMC_STEPSIZE_BLOCK_COVAR_ADAPTER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/base_adapter.hpp>
+#include <stan/mcmc/block_covar_adaptation.hpp>
+#include <stan/mcmc/stepsize_adaptation.hpp>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+class stepsize_block_covar_adapter : public base_adapter {
+ public:
+  explicit stepsize_block_covar_adapter(const std::vector<int>& block_sizes)
+      : block_covar_adaptation_(block_sizes) {}
+
+  stepsize_adaptation& get_stepsize_adaptation() {
+    return stepsize_adaptation_;
+  }
+
+  const stepsize_adaptation& get_stepsize_adaptation() const noexcept {
+    return stepsize_adaptation_;
+  }
+
+  block_covar_adaptation& get_block_covar_adaptation() {
+    return block_covar_adaptation_;
+  }
+
+  void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
+                         unsigned int term_buffer, unsigned int base_window,
+                         callbacks::logger& logger) {
+    block_covar_adaptation_.set_window_params(num_warmup, init_buffer,
+                                              term_buffer, base_window, logger);
+  }
+
+  size_t memory_bytes() const { return block_covar_adaptation_.memory_bytes(); }
+
+ protected:
+  stepsize_adaptation stepsize_adaptation_;
+  block_covar_adaptation block_covar_adaptation_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -24,6 +24,28 @@ class stepsize_covar_adapter : public base_adapter {
 
   covar_adaptation& get_covar_adaptation() { return covar_adaptation_; }
 
+  /**
+   * Set whether the step size that starts each adaptation window after an
+   * update of the metric is the step size adapted over the last window
+   * rescaled by the change of metric, instead of the result of the trial
+   * leapfrog steps of <code>base_hmc::init_stepsize</code>, which remains
+   * the fallback.
+   *
+   * @param reuse true to rescale the adapted step size
+   */
+  void set_stepsize_reuse(bool reuse) {
+    covar_adaptation_.set_estimate_metric_scale(reuse);
+  }
+
+  /**
+   * Return the estimate of the step size for the window after an update
+   * of the metric, or NaN if it is not reused or there is no estimate.
+   */
+  double reused_stepsize() const {
+    return stepsize_adaptation_.rescaled_stepsize(
+        covar_adaptation_.metric_scale());
+  }
+
   void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
                          unsigned int term_buffer, unsigned int base_window,
                          callbacks::logger& logger) {
@@ -31,6 +53,8 @@ class stepsize_covar_adapter : public base_adapter {
                                         base_window, logger);
   }
 
+  size_t memory_bytes() const { return covar_adaptation_.memory_bytes(); }
+
  protected:
   stepsize_adaptation stepsize_adaptation_;
   covar_adaptation covar_adaptation_;
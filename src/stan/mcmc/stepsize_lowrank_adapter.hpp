@@ -0,0 +1,42 @@
+#ifndef STAN_MCMC_STEPSIZE_LOWRANK_ADAPTER_HPP
+#define STAN_MCMC_STEPSIZE_LOWRANK_ADAPTER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/base_adapter.hpp>
+#include <stan/mcmc/lowrank_adaptation.hpp>
+#include <stan/mcmc/stepsize_adaptation.hpp>
+
+namespace stan {
+namespace mcmc {
+
+class stepsize_lowrank_adapter : public base_adapter {
+ public:
+  stepsize_lowrank_adapter(int n, int rank) : lowrank_adaptation_(n, rank) {}
+
+  stepsize_adaptation& get_stepsize_adaptation() {
+    return stepsize_adaptation_;
+  }
+
+  const stepsize_adaptation& get_stepsize_adaptation() const noexcept {
+    return stepsize_adaptation_;
+  }
+
+  lowrank_adaptation& get_lowrank_adaptation() { return lowrank_adaptation_; }
+
+  void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
+                         unsigned int term_buffer, unsigned int base_window,
+                         callbacks::logger& logger) {
+    lowrank_adaptation_.set_window_params(num_warmup, init_buffer,
+                                          term_buffer, base_window, logger);
+  }
+
+  size_t memory_bytes() const { return lowrank_adaptation_.memory_bytes(); }
+
+ protected:
+  stepsize_adaptation stepsize_adaptation_;
+  lowrank_adaptation lowrank_adaptation_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,196 @@
+#ifndef STAN_MCMC_TEMPERATURE_LADDER_HPP
+#define STAN_MCMC_TEMPERATURE_LADDER_HPP
+
+#include <boost/random/uniform_01.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * <code>temperature_ladder</code> holds the temperatures of the replicas
+ * of parallel tempering, from the target at temperature 1 upward, and
+ * proposes the exchanges of states between neighbouring temperatures.
+ *
+ * Exchanges follow the deterministic even-odd scheme: each round either
+ * the pairs whose lower temperature has an even index or those with an
+ * odd one are proposed, alternately, so a state can travel the ladder in
+ * one direction instead of diffusing along it (Syed et al., 2021).
+ *
+ * While adapting, the gaps between temperatures are tuned so that every
+ * pair of neighbours exchanges at the target rate by the stochastic
+ * approximation of Miasojedow, Moulines and Vihola (2013): the log of
+ * each gap moves by the difference between the acceptance probability
+ * of an exchange and the target, with gains decaying as
+ * <code>n^-0.6</code>.  The lowest temperature stays at 1.
+ */
+class temperature_ladder {
+ public:
+  /**
+   * Construct a geometric ladder.
+   *
+   * @param[in] num_replicas number of temperatures; must be positive
+   * @param[in] max_temperature highest temperature; must be at least 1
+   * @param[in] target_swap_rate exchange rate the adaptation aims at for
+   *   every pair of neighbours, in (0, 1)
+   * @throw std::invalid_argument if an argument is out of range
+   */
+  temperature_ladder(size_t num_replicas, double max_temperature,
+                     double target_swap_rate = 0.234)
+      : target_swap_rate_(target_swap_rate),
+        log_gaps_(num_replicas > 0 ? num_replicas - 1 : 0),
+        inv_temperatures_(num_replicas, 1),
+        num_updates_(log_gaps_.size(), 0),
+        num_proposed_(log_gaps_.size(), 0),
+        num_accepted_(log_gaps_.size(), 0) {
+    if (num_replicas == 0)
+      throw std::invalid_argument(
+          "temperature_ladder: num_replicas must be positive");
+    if (!(max_temperature >= 1) || std::isinf(max_temperature))
+      throw std::invalid_argument(
+          "temperature_ladder: max_temperature must be finite and at "
+          "least 1");
+    if (!(target_swap_rate > 0 && target_swap_rate < 1))
+      throw std::invalid_argument(
+          "temperature_ladder: target_swap_rate must be in (0, 1)");
+    const double log_ratio
+        = num_replicas > 1 ? std::log(max_temperature) / (num_replicas - 1)
+                           : 0;
+    for (size_t k = 0; k < log_gaps_.size(); ++k) {
+      const double gap
+          = std::exp(log_ratio * (k + 1)) - std::exp(log_ratio * k);
+      log_gaps_[k] = clamp(std::log(std::max(gap, min_gap)));
+    }
+    update_inv_temperatures();
+  }
+
+  size_t size() const noexcept { return inv_temperatures_.size(); }
+
+  /**
+   * Return the inverse temperature of a replica, 1 for the first.
+   *
+   * @param[in] k index of the replica
+   */
+  double inv_temperature(size_t k) const { return inv_temperatures_.at(k); }
+
+  const std::vector<double>& inv_temperatures() const noexcept {
+    return inv_temperatures_;
+  }
+
+  double temperature(size_t k) const { return 1 / inv_temperature(k); }
+
+  void engage_adaptation() { adapt_ = true; }
+
+  void disengage_adaptation() { adapt_ = false; }
+
+  bool adapting() const noexcept { return adapt_; }
+
+  double target_swap_rate() const noexcept { return target_swap_rate_; }
+
+  /**
+   * Propose a round of exchanges between neighbouring temperatures.
+   * The states are described by their log densities at temperature 1,
+   * which are exchanged along with the states they belong to.
+   *
+   * @tparam RNG type of pseudo random number generator
+   * @param[in,out] log_probs untempered log density of the state held by
+   *   each replica, one per temperature
+   * @param[in,out] rng pseudo random number generator
+   * @return indices of the lower replica of each pair whose states were
+   *   exchanged
+   * @throw std::invalid_argument if there is not one log density per
+   *   temperature
+   */
+  template <class RNG>
+  std::vector<size_t> exchange(std::vector<double>& log_probs, RNG& rng) {
+    if (log_probs.size() != size())
+      throw std::invalid_argument(
+          "temperature_ladder: one log density per temperature required");
+    boost::random::uniform_01<double> uniform;
+    std::vector<size_t> exchanged;
+    for (size_t k = round_ % 2; k + 1 < size(); k += 2) {
+      const double log_alpha
+          = (inv_temperatures_[k] - inv_temperatures_[k + 1])
+            * (log_probs[k + 1] - log_probs[k]);
+      const double alpha = std::isnan(log_alpha)
+                               ? 0
+                               : std::exp(std::min(0.0, log_alpha));
+      ++num_proposed_[k];
+      if (std::log(uniform(rng)) < log_alpha) {
+        ++num_accepted_[k];
+        std::swap(log_probs[k], log_probs[k + 1]);
+        exchanged.push_back(k);
+      }
+      if (adapt_) {
+        const double gain = std::pow(++num_updates_[k], -0.6);
+        log_gaps_[k]
+            = clamp(log_gaps_[k] + gain * (alpha - target_swap_rate_));
+      }
+    }
+    ++round_;
+    if (adapt_)
+      update_inv_temperatures();
+    return exchanged;
+  }
+
+  /**
+   * Return the fraction of the exchanges proposed between a replica and
+   * the next one that were accepted since the last reset, or NaN if none
+   * were proposed.
+   *
+   * @param[in] k index of the lower replica
+   */
+  double swap_rate(size_t k) const {
+    return num_proposed_.at(k) == 0
+               ? std::numeric_limits<double>::quiet_NaN()
+               : static_cast<double>(num_accepted_[k]) / num_proposed_[k];
+  }
+
+  /**
+   * Forget the counts of exchanges, for instance at the end of warmup.
+   */
+  void reset_swap_rates() {
+    std::fill(num_proposed_.begin(), num_proposed_.end(), 0);
+    std::fill(num_accepted_.begin(), num_accepted_.end(), 0);
+  }
+
+ private:
+  // bounds of the gaps between temperatures, which keep every inverse
+  // temperature positive and distinct
+  static constexpr double min_gap = 1e-8;
+  static constexpr double max_gap = 1e8;
+
+  double target_swap_rate_;
+  std::vector<double> log_gaps_;
+  std::vector<double> inv_temperatures_;
+  std::vector<size_t> num_updates_;
+  std::vector<size_t> num_proposed_;
+  std::vector<size_t> num_accepted_;
+  size_t round_ = 0;
+  bool adapt_ = false;
+
+  static double clamp(double log_gap) {
+    return std::min(std::max(log_gap, std::log(min_gap)), std::log(max_gap));
+  }
+
+  void update_inv_temperatures() {
+    double temperature = 1;
+    inv_temperatures_[0] = 1;
+    for (size_t k = 0; k < log_gaps_.size(); ++k) {
+      temperature += std::exp(log_gaps_[k]);
+      inv_temperatures_[k + 1] = 1 / temperature;
+    }
+  }
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef STAN_MCMC_TRAJECTORY_LENGTH_ADAPTATION_HPP
+#define STAN_MCMC_TRAJECTORY_LENGTH_ADAPTATION_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/mcmc/base_adaptation.hpp>
+#include <cmath>
+#include <limits>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Adapts the integration time of static HMC to maximize the ChEES
+ * criterion, the expected change in the squared distance of the draws
+ * from the mean of the target over a transition, following Hoffman,
+ * Radul and Sountsov (2021), "An Adaptive MCMC Scheme for Setting
+ * Trajectory Lengths in Hamiltonian Monte Carlo".
+ *
+ * Each update takes one transition of any number of chains.  The
+ * gradient of the criterion with respect to the log integration time is
+ * estimated from the positions and velocities the chains moved to,
+ * weighted by their acceptance probabilities, and the log integration
+ * time takes an Adam step without momentum.  The mean of the target is
+ * the running mean of the initial positions of every chain since the
+ * last restart, so the criterion can be estimated with a single chain,
+ * although it is much less noisy with many.  The adapted integration
+ * time is the weighted average of the iterates, as in dual averaging.
+ */
+class trajectory_length_adaptation : public base_adaptation {
+ public:
+  explicit trajectory_length_adaptation(int n)
+      : mean_(Eigen::VectorXd::Zero(n)),
+        learning_rate_(0.025),
+        beta_(0.95),
+        kappa_(0.75),
+        max_T_(std::numeric_limits<double>::infinity()) {
+    restart();
+  }
+
+  void set_learning_rate(double r) {
+    if (r > 0)
+      learning_rate_ = r;
+  }
+
+  void set_beta(double b) {
+    if (b >= 0 && b < 1)
+      beta_ = b;
+  }
+
+  void set_kappa(double k) {
+    if (k > 0)
+      kappa_ = k;
+  }
+
+  void set_max_T(double t) {
+    if (t > 0)
+      max_T_ = t;
+  }
+
+  double get_learning_rate() const noexcept { return learning_rate_; }
+
+  double get_beta() const noexcept { return beta_; }
+
+  double get_kappa() const noexcept { return kappa_; }
+
+  double get_max_T() const noexcept { return max_T_; }
+
+  void restart() {
+    counter_ = 0;
+    num_samples_ = 0;
+    second_moment_ = 0;
+    x_bar_ = 0;
+    mean_.setZero();
+  }
+
+  /**
+   * Update the integration time from one transition of every chain.  The
+   * matrices have one column per chain.  A chain whose proposal is not
+   * finite is left out of the estimate.
+   *
+   * @param[in,out] T integration time, updated to the next iterate
+   * @param[in] q_init initial positions
+   * @param[in] q_proposal positions moved to
+   * @param[in] v_proposal velocities, the inverse metric times the
+   * momenta, at the positions moved to
+   * @param[in] times signed integration times from the initial to the
+   * proposed positions
+   * @param[in] accept_prob acceptance probabilities of the proposals
+   */
+  void learn_trajectory_length(
+      double& T, const Eigen::Ref<const Eigen::MatrixXd>& q_init,
+      const Eigen::Ref<const Eigen::MatrixXd>& q_proposal,
+      const Eigen::Ref<const Eigen::MatrixXd>& v_proposal,
+      const Eigen::Ref<const Eigen::VectorXd>& times,
+      const Eigen::Ref<const Eigen::VectorXd>& accept_prob) {
+    ++counter_;
+    for (Eigen::Index c = 0; c < q_init.cols(); ++c) {
+      ++num_samples_;
+      mean_ += (q_init.col(c) - mean_) / num_samples_;
+    }
+
+    double weighted_gradient = 0;
+    double total_weight = 0;
+    for (Eigen::Index c = 0; c < q_proposal.cols(); ++c) {
+      const double weight = accept_prob(c) > 1 ? 1 : accept_prob(c);
+      const double change = (q_proposal.col(c) - mean_).squaredNorm()
+                            - (q_init.col(c) - mean_).squaredNorm();
+      const double gradient = times(c) * change
+                              * (q_proposal.col(c) - mean_)
+                                    .dot(v_proposal.col(c));
+      if (!(weight > 0) || !std::isfinite(gradient))
+        continue;
+      weighted_gradient += weight * gradient;
+      total_weight += weight;
+    }
+    const double g = total_weight > 0 ? weighted_gradient / total_weight : 0;
+
+    // Adam step without momentum on log(T), ascending the criterion
+    second_moment_ = beta_ * second_moment_ + (1 - beta_) * g * g;
+    const double scale
+        = std::sqrt(second_moment_ / (1 - std::pow(beta_, counter_)));
+    double x = std::log(T);
+    if (scale > 0)
+      x += learning_rate_ * g / (scale + 1e-8);
+    if (x > std::log(max_T_))
+      x = std::log(max_T_);
+
+    const double x_eta = std::pow(counter_, -kappa_);
+    x_bar_ = (1.0 - x_eta) * x_bar_ + x_eta * x;
+
+    T = std::exp(x);
+  }
+
+  /**
+   * Set the integration time to the average of the iterates, leaving it
+   * unchanged if there were none since the last restart.
+   *
+   * @param[in,out] T integration time
+   */
+  void complete_adaptation(double& T) {
+    if (counter_ > 0)
+      T = std::exp(x_bar_);
+  }
+
+ protected:
+  Eigen::VectorXd mean_;  // Running mean of the initial positions
+  double learning_rate_;  // Adam learning rate
+  double beta_;           // Decay of the squared gradient average
+  double kappa_;          // Shrinkage of the iterate average
+  double max_T_;          // Largest integration time
+  double counter_;        // Adaptation iteration
+  double num_samples_;    // Number of positions in the mean
+  double second_moment_;  // Moving average of the squared gradient
+  double x_bar_;          // Moving average of log(T)
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
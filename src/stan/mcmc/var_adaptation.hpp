@@ -2,7 +2,10 @@
 #define STAN_MCMC_VAR_ADAPTATION_HPP
 
 #include <stan/math/prim.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
 #include <stan/mcmc/windowed_adaptation.hpp>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace stan {
@@ -12,30 +15,220 @@ namespace mcmc {
 class var_adaptation : public windowed_adaptation {
  public:
   explicit var_adaptation(int n)
-      : windowed_adaptation("variance"), estimator_(n) {}
+      : windowed_adaptation("variance"),
+        estimator_(n),
+        grad_estimator_(n),
+        use_gradients_(false),
+        pooling_(false),
+        window_complete_(false),
+        estimate_metric_scale_(false),
+        metric_scale_(std::numeric_limits<double>::quiet_NaN()),
+        num_params_(n) {}
+
+  /**
+   * When using gradients, each element of the inverse metric is the
+   * geometric mean <code>sqrt(var(q) / var(g))</code> of the variance of
+   * the draws and the inverse variance of the gradients of the log density
+   * at the draws.  Both equal the variance for a Gaussian with
+   * independent components, but the gradients carry curvature information
+   * that the draws only reveal slowly, so the estimate converges in fewer
+   * draws.  Elements whose gradient does not vary fall back on the
+   * variance of the draws.
+   *
+   * @param use_gradients true to combine the gradients with the draws
+   */
+  void set_use_gradients(bool use_gradients) { use_gradients_ = use_gradients; }
+
+  bool use_gradients() const noexcept { return use_gradients_; }
+
+  /**
+   * When pooling, the end of an adaptation window leaves the estimator
+   * and the metric untouched and only flags the window as complete, so
+   * that the estimates of several chains can be combined with
+   * <code>pool_variance</code>.
+   *
+   * @param pooling true to defer metric updates to the caller
+   */
+  void set_pooling(bool pooling) { pooling_ = pooling; }
+
+  bool pooling() const noexcept { return pooling_; }
+
+  /**
+   * Return the bytes of storage held by the estimators of the means and
+   * variances of the draws and of their gradients.
+   */
+  size_t memory_bytes() const { return 4 * num_params_ * sizeof(double); }
+
+  bool window_complete() const noexcept { return window_complete_; }
+
+  /**
+   * Discard the draws of the current window without updating the
+   * metric, as for a chain restarted from the state of another one part
+   * way through warmup.  The window schedule is left as is.
+   */
+  void discard_window() {
+    estimator_.restart();
+    grad_estimator_.restart();
+    window_complete_ = false;
+  }
+
+  /**
+   * Set whether each update of the inverse metric also estimates how much
+   * the update changes the stable step size, as the largest ratio
+   * <code>sqrt(old(i) / new(i))</code> of the scales of the old and the
+   * new diagonal, which is that change when the new diagonal is the
+   * variance of the target.
+   *
+   * @param estimate true to estimate the change of step size
+   */
+  void set_estimate_metric_scale(bool estimate) {
+    estimate_metric_scale_ = estimate;
+  }
+
+  /**
+   * Return the change of the stable step size estimated at the last
+   * update of the inverse metric, or NaN if it was not estimated.
+   */
+  double metric_scale() const noexcept { return metric_scale_; }
+
+  /**
+   * Write the window schedule and the estimators of the current window
+   * to a checkpoint.
+   *
+   * @param[in,out] writer checkpoint writer
+   */
+  void write_checkpoint(callbacks::structured_writer& writer) const {
+    windowed_adaptation::write_checkpoint(writer);
+    write_welford_state(writer, "variance_estimator", estimator_);
+    write_welford_state(writer, "gradient_variance_estimator",
+                        grad_estimator_);
+    writer.write("adaptation_window_complete",
+                 static_cast<int>(window_complete_));
+  }
+
+  /**
+   * Restore the window schedule and the estimators of the current window
+   * from a checkpoint.
+   *
+   * @param[in] context checkpoint
+   * @throw std::invalid_argument if the checkpoint lacks a value
+   */
+  void read_checkpoint(const io::var_context& context) {
+    windowed_adaptation::read_checkpoint(context);
+    read_welford_state(context, "variance_estimator", estimator_);
+    read_welford_state(context, "gradient_variance_estimator",
+                       grad_estimator_);
+    window_complete_
+        = read_checkpoint_scalar(context, "adaptation_window_complete") != 0;
+  }
 
   bool learn_variance(Eigen::VectorXd& var, const Eigen::VectorXd& q) {
-    if (adaptation_window())
+    return learn(var, q, nullptr);
+  }
+
+  /**
+   * Add a draw and the gradient of the log density at it to the current
+   * window and, at the end of a window, replace the inverse metric with
+   * the regularized estimate from the window.  The gradient is only used
+   * with <code>set_use_gradients(true)</code>.
+   *
+   * @param[in,out] var diagonal of the inverse metric
+   * @param[in] q draw
+   * @param[in] g gradient of the log density, or of its negative, at the
+   * draw
+   * @return <code>true</code> if the inverse metric was updated
+   * @throw std::runtime_error if the estimate is not finite
+   */
+  bool learn_variance(Eigen::VectorXd& var, const Eigen::VectorXd& q,
+                      const Eigen::VectorXd& g) {
+    return learn(var, q, &g);
+  }
+
+  /**
+   * Combine the completed windows of several adaptations into a single
+   * regularized variance estimate and restart their estimators.  The
+   * result is the variance of the union of the windows' draws.
+   *
+   * @param adaptations adaptations whose windows are pooled
+   * @param[out] var pooled variance
+   * @throw std::runtime_error if the pooled estimate is not finite
+   */
+  static void pool_variance(const std::vector<var_adaptation*>& adaptations,
+                            Eigen::VectorXd& var) {
+    pool_variance(adaptations, var,
+                  [](double&, Eigen::VectorXd&, Eigen::VectorXd&) {});
+  }
+
+  /**
+   * Pool the completed windows of several adaptations as above, passing
+   * the count, mean and sum of squared deviations of their draws, and of
+   * their gradients when those are used, through
+   * <code>combine_moments(n, mean, m2)</code> first, so that it can
+   * replace them with the moments of the windows of other processes as
+   * well.
+   *
+   * @tparam F type of the callable combining the moments
+   * @param adaptations adaptations whose windows are pooled
+   * @param[out] var pooled variance
+   * @param combine_moments callable updating the moments in place
+   * @throw std::runtime_error if the pooled estimate is not finite
+   */
+  template <typename F>
+  static void pool_variance(const std::vector<var_adaptation*>& adaptations,
+                            Eigen::VectorXd& var, F&& combine_moments) {
+    const double n = pool(adaptations, &var_adaptation::estimator_, var,
+                          combine_moments);
+    if (!adaptations.empty() && adaptations[0]->use_gradients_) {
+      Eigen::VectorXd grad_var(var.size());
+      pool(adaptations, &var_adaptation::grad_estimator_, grad_var,
+           combine_moments);
+      combine_gradients(grad_var, var);
+    }
+    regularize(n, var);
+
+    for (var_adaptation* adaptation : adaptations) {
+      adaptation->estimator_.restart();
+      adaptation->grad_estimator_.restart();
+      adaptation->window_complete_ = false;
+    }
+  }
+
+ protected:
+  bool learn(Eigen::VectorXd& var, const Eigen::VectorXd& q,
+             const Eigen::VectorXd* g) {
+    if (adaptation_window()) {
       estimator_.add_sample(q);
+      if (use_gradients_ && g != nullptr)
+        grad_estimator_.add_sample(*g);
+    }
 
     if (end_adaptation_window()) {
       compute_next_window();
 
-      estimator_.sample_variance(var);
+      if (pooling_) {
+        window_complete_ = true;
+        ++adapt_window_counter_;
+        return false;
+      }
 
-      double n = static_cast<double>(estimator_.num_samples());
-      var = (n / (n + 5.0)) * var
-            + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
+      metric_scale_ = std::numeric_limits<double>::quiet_NaN();
+      Eigen::VectorXd prev_var;
+      if (estimate_metric_scale_)
+        prev_var = var;
 
-      if (!var.allFinite())
-        throw std::runtime_error(
-            "Numerical overflow in metric adaptation. "
-            "This occurs when the sampler encounters extreme values on the "
-            "unconstrained space; this may happen when the posterior density "
-            "function is too wide or improper. "
-            "There may be problems with your model specification.");
+      estimator_.sample_variance(var);
+      if (use_gradients_) {
+        Eigen::VectorXd grad_var = Eigen::VectorXd::Zero(var.size());
+        grad_estimator_.sample_variance(grad_var);
+        combine_gradients(grad_var, var);
+      }
+
+      regularize(estimator_.num_samples(), var);
+      if (estimate_metric_scale_)
+        metric_scale_ = (prev_var.array() / var.array()).sqrt().maxCoeff();
 
       estimator_.restart();
+      grad_estimator_.restart();
 
       ++adapt_window_counter_;
       return true;
@@ -45,8 +238,87 @@ class var_adaptation : public windowed_adaptation {
     return false;
   }
 
- protected:
+  /**
+   * Compute the variance of the union of the windows of the specified
+   * estimator of several adaptations.
+   *
+   * @return number of draws pooled
+   */
+  template <typename F>
+  static double pool(
+      const std::vector<var_adaptation*>& adaptations,
+      stan::math::welford_var_estimator var_adaptation::*estimator,
+      Eigen::VectorXd& var, F& combine_moments) {
+    double n = 0;
+    Eigen::VectorXd mean = Eigen::VectorXd::Zero(var.size());
+    Eigen::VectorXd m2 = Eigen::VectorXd::Zero(var.size());
+    Eigen::VectorXd mean_i(var.size());
+    Eigen::VectorXd var_i(var.size());
+    for (var_adaptation* adaptation : adaptations) {
+      stan::math::welford_var_estimator& estimator_i = adaptation->*estimator;
+      double n_i = estimator_i.num_samples();
+      if (n_i == 0)
+        continue;
+      estimator_i.sample_mean(mean_i);
+      var_i.setZero();
+      estimator_i.sample_variance(var_i);
+
+      double n_prev = n;
+      n += n_i;
+      Eigen::VectorXd delta = mean_i - mean;
+      mean += delta * (n_i / n);
+      m2 += var_i * (n_i - 1.0)
+            + delta.array().square().matrix() * (n_prev * n_i / n);
+    }
+
+    combine_moments(n, mean, m2);
+    var = m2 / (n - 1.0);
+    return n;
+  }
+
+  /**
+   * Replace the variances of the draws with their geometric means with
+   * the inverse variances of the gradients, where those are positive.
+   *
+   * @param[in] grad_var variance of the gradients
+   * @param[in,out] var variance of the draws
+   */
+  static void combine_gradients(const Eigen::VectorXd& grad_var,
+                                Eigen::VectorXd& var) {
+    for (Eigen::Index i = 0; i < var.size(); ++i)
+      if (grad_var(i) > 0)
+        var(i) = std::sqrt(var(i) / grad_var(i));
+  }
+
+  /**
+   * Shrink an estimate from <code>n</code> draws towards a small
+   * multiple of the identity.
+   *
+   * @param n number of draws behind the estimate
+   * @param[in,out] var variance estimate
+   * @throw std::runtime_error if the result is not finite
+   */
+  static void regularize(double n, Eigen::VectorXd& var) {
+    var = (n / (n + 5.0)) * var
+          + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
+
+    if (!var.allFinite())
+      throw std::runtime_error(
+          "Numerical overflow in metric adaptation. "
+          "This occurs when the sampler encounters extreme values on the "
+          "unconstrained space; this may happen when the posterior density "
+          "function is too wide or improper. "
+          "There may be problems with your model specification.");
+  }
+
   stan::math::welford_var_estimator estimator_;
+  stan::math::welford_var_estimator grad_estimator_;
+  bool use_gradients_;
+  bool pooling_;
+  bool window_complete_;
+  bool estimate_metric_scale_;
+  double metric_scale_;
+  int num_params_;
 };
 
 }  // namespace mcmc
@@ -1,8 +1,12 @@
 #ifndef STAN_MCMC_WINDOWED_ADAPTATION_HPP
 #define STAN_MCMC_WINDOWED_ADAPTATION_HPP
 
+#include <stan/callbacks/event_tracer.hpp>
 #include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/var_context.hpp>
 #include <stan/mcmc/base_adaptation.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
 #include <ostream>
 #include <string>
 
@@ -88,7 +92,25 @@ class windowed_adaptation : public base_adaptation {
            && (adapt_window_counter_ != num_warmup_);
   }
 
+  /**
+   * Return the number of iterations, counting the next one, until the
+   * end of the current adaptation window, or zero if no further window
+   * ends before the terminal buffer.
+   *
+   * @return iterations until the end of the current window
+   */
+  unsigned int iterations_to_window_end() const noexcept {
+    if (adapt_next_window_ >= num_warmup_ - adapt_term_buffer_
+        || adapt_window_counter_ > adapt_next_window_)
+      return 0;
+    return adapt_next_window_ - adapt_window_counter_ + 1;
+  }
+
+  unsigned int term_buffer() const noexcept { return adapt_term_buffer_; }
+
   void compute_next_window() {
+    callbacks::trace_instant("adaptation", "window_end", "iteration",
+                             adapt_window_counter_);
     if (adapt_next_window_ == num_warmup_ - adapt_term_buffer_ - 1)
       return;
 
@@ -109,6 +131,40 @@ class windowed_adaptation : public base_adaptation {
     }
   }
 
+  /**
+   * Write the window schedule and position to a checkpoint.
+   *
+   * @param[in,out] writer checkpoint writer
+   */
+  void write_checkpoint(callbacks::structured_writer& writer) const {
+    writer.write("adaptation_num_warmup", num_warmup_);
+    writer.write("adaptation_init_buffer", adapt_init_buffer_);
+    writer.write("adaptation_term_buffer", adapt_term_buffer_);
+    writer.write("adaptation_base_window", adapt_base_window_);
+    writer.write("adaptation_window_counter", adapt_window_counter_);
+    writer.write("adaptation_next_window", adapt_next_window_);
+    writer.write("adaptation_window_size", adapt_window_size_);
+  }
+
+  /**
+   * Restore the window schedule and position from a checkpoint.
+   *
+   * @param[in] context checkpoint
+   * @throw std::invalid_argument if the checkpoint lacks a value
+   */
+  void read_checkpoint(const io::var_context& context) {
+    auto read = [&](const std::string& name) {
+      return static_cast<unsigned int>(read_checkpoint_scalar(context, name));
+    };
+    num_warmup_ = read("adaptation_num_warmup");
+    adapt_init_buffer_ = read("adaptation_init_buffer");
+    adapt_term_buffer_ = read("adaptation_term_buffer");
+    adapt_base_window_ = read("adaptation_base_window");
+    adapt_window_counter_ = read("adaptation_window_counter");
+    adapt_next_window_ = read("adaptation_next_window");
+    adapt_window_size_ = read("adaptation_window_size");
+  }
+
  protected:
   std::string estimator_name_;
 
@@ -0,0 +1,354 @@
+#ifndef STAN_MODEL_ANALYTIC_GRADIENT_MODEL_HPP
+#define STAN_MODEL_ANALYTIC_GRADIENT_MODEL_HPP
+
+#include <stan/io/var_context.hpp>
+#include <stan/math/rev.hpp>
+#include <stan/model/model_base.hpp>
+#include <functional>
+#include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * <code>analytic_gradient_model</code> is a <code>model_base</code> whose
+ * log density and gradient are supplied as functions, such as
+ * hand-written C++ with analytic derivatives, instead of being generated
+ * from a Stan program, so that the services run on it without recording
+ * the evaluation of the density on the autodiff stack.
+ *
+ * The parameters are unconstrained: the log density is a function of the
+ * vector of all their elements, in the order of the parameters and then
+ * in column-major order within each, and the constrained values written
+ * are those same values.  The density is used as given whether or not
+ * the constants or the Jacobian adjustment are asked for.
+ *
+ * <code>stan::model::log_prob_grad</code> with this model as its static
+ * type, and <code>log_prob_grad_batch</code>, call the gradient directly.
+ * Evaluations with autodiff variables, as through a
+ * <code>model_base</code> reference, record a single node with the
+ * precomputed gradient.  Second order autodiff is not supported.
+ *
+ * The functions may be called from several threads at once, as by
+ * parallel chains, whenever the model is.
+ */
+class analytic_gradient_model : public model_base {
+ public:
+  /**
+   * Type of the log density: returns it at the unconstrained parameters.
+   */
+  using log_density_t = std::function<double(const Eigen::VectorXd&)>;
+
+  /**
+   * Type of the gradient: returns the log density at the unconstrained
+   * parameters and writes its gradient, resized to their number.
+   */
+  using gradient_t
+      = std::function<double(const Eigen::VectorXd&, Eigen::VectorXd&)>;
+
+  /**
+   * Construct a model from its log density and gradient.
+   *
+   * @param[in] name name of the model
+   * @param[in] param_names names of the parameters
+   * @param[in] dims dimensions of each parameter, empty for a scalar
+   * @param[in] log_density log density
+   * @param[in] gradient log density and its gradient
+   * @throw std::invalid_argument if there is not one list of dimensions
+   *   per name
+   */
+  analytic_gradient_model(std::string name,
+                          std::vector<std::string> param_names,
+                          std::vector<std::vector<size_t>> dims,
+                          log_density_t log_density, gradient_t gradient)
+      : model_base(num_elements(param_names, dims)),
+        name_(std::move(name)),
+        param_names_(std::move(param_names)),
+        dims_(std::move(dims)),
+        log_density_(std::move(log_density)),
+        gradient_(std::move(gradient)) {}
+
+  using model_base::log_prob;
+  using model_base::transform_inits;
+  using model_base::write_array;
+
+  std::string model_name() const { return name_; }
+
+  std::vector<std::string> model_compile_info() const {
+    return {"analytic_gradient_model"};
+  }
+
+  void get_param_names(std::vector<std::string>& names,
+                       bool include_tparams = true,
+                       bool include_gqs = true) const {
+    names = param_names_;
+  }
+
+  void get_dims(std::vector<std::vector<size_t>>& dimss,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dimss = dims_;
+  }
+
+  void constrained_param_names(std::vector<std::string>& param_names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    for (size_t k = 0; k < param_names_.size(); ++k) {
+      const std::vector<size_t>& dims = dims_[k];
+      const size_t size = std::accumulate(dims.begin(), dims.end(), size_t{1},
+                                          std::multiplies<size_t>());
+      std::vector<size_t> index(dims.size(), 0);
+      for (size_t n = 0; n < size; ++n) {
+        std::string name = param_names_[k];
+        for (size_t i : index)
+          name += "." + std::to_string(i + 1);
+        param_names.push_back(name);
+        // column-major: the first index varies fastest
+        for (size_t d = 0; d < index.size() && ++index[d] == dims[d]; ++d)
+          index[d] = 0;
+      }
+    }
+  }
+
+  void unconstrained_param_names(std::vector<std::string>& param_names,
+                                 bool include_tparams = true,
+                                 bool include_gqs = true) const {
+    constrained_param_names(param_names, include_tparams, include_gqs);
+  }
+
+  /**
+   * Return the log density and write its gradient at the unconstrained
+   * parameters, without autodiff.
+   *
+   * @param[in] params_r unconstrained parameters
+   * @param[out] gradient gradient of the log density
+   * @return log density
+   * @throw std::domain_error if the gradient is not of the size of the
+   *   parameters
+   */
+  double analytic_log_prob_grad(const Eigen::VectorXd& params_r,
+                                Eigen::VectorXd& gradient) const {
+    const double lp = gradient_(params_r, gradient);
+    if (static_cast<size_t>(gradient.size()) != num_params_r())
+      throw std::domain_error("Gradient of model " + name_ + " has "
+                              + std::to_string(gradient.size())
+                              + " elements, but the model has "
+                              + std::to_string(num_params_r())
+                              + " parameters");
+    return lp;
+  }
+
+  double log_prob(Eigen::VectorXd& params_r, std::ostream* msgs) const {
+    return log_density_(params_r);
+  }
+  math::var log_prob(Eigen::Matrix<math::var, -1, 1>& params_r,
+                     std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_jacobian(Eigen::VectorXd& params_r,
+                           std::ostream* msgs) const {
+    return log_density_(params_r);
+  }
+  math::var log_prob_jacobian(Eigen::Matrix<math::var, -1, 1>& params_r,
+                              std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_propto(Eigen::VectorXd& params_r, std::ostream* msgs) const {
+    return log_density_(params_r);
+  }
+  math::var log_prob_propto(Eigen::Matrix<math::var, -1, 1>& params_r,
+                            std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_propto_jacobian(Eigen::VectorXd& params_r,
+                                  std::ostream* msgs) const {
+    return log_density_(params_r);
+  }
+  math::var log_prob_propto_jacobian(Eigen::Matrix<math::var, -1, 1>& params_r,
+                                     std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+
+  double log_prob(std::vector<double>& params_r, std::vector<int>& params_i,
+                  std::ostream* msgs) const {
+    return log_density_(to_vector(params_r));
+  }
+  math::var log_prob(std::vector<math::var>& params_r,
+                     std::vector<int>& params_i, std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_jacobian(std::vector<double>& params_r,
+                           std::vector<int>& params_i,
+                           std::ostream* msgs) const {
+    return log_density_(to_vector(params_r));
+  }
+  math::var log_prob_jacobian(std::vector<math::var>& params_r,
+                              std::vector<int>& params_i,
+                              std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_propto(std::vector<double>& params_r,
+                         std::vector<int>& params_i,
+                         std::ostream* msgs) const {
+    return log_density_(to_vector(params_r));
+  }
+  math::var log_prob_propto(std::vector<math::var>& params_r,
+                            std::vector<int>& params_i,
+                            std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+  double log_prob_propto_jacobian(std::vector<double>& params_r,
+                                  std::vector<int>& params_i,
+                                  std::ostream* msgs) const {
+    return log_density_(to_vector(params_r));
+  }
+  math::var log_prob_propto_jacobian(std::vector<math::var>& params_r,
+                                     std::vector<int>& params_i,
+                                     std::ostream* msgs) const {
+    return var_log_prob(params_r);
+  }
+
+#ifdef STAN_MODEL_FVAR_VAR
+  math::fvar<math::var> log_prob(
+      Eigen::Matrix<math::fvar<math::var>, -1, 1>& params_r,
+      std::ostream* msgs) const {
+    no_second_order();
+  }
+  math::fvar<math::var> log_prob_jacobian(
+      Eigen::Matrix<math::fvar<math::var>, -1, 1>& params_r,
+      std::ostream* msgs) const {
+    no_second_order();
+  }
+  math::fvar<math::var> log_prob_propto(
+      Eigen::Matrix<math::fvar<math::var>, -1, 1>& params_r,
+      std::ostream* msgs) const {
+    no_second_order();
+  }
+  math::fvar<math::var> log_prob_propto_jacobian(
+      Eigen::Matrix<math::fvar<math::var>, -1, 1>& params_r,
+      std::ostream* msgs) const {
+    no_second_order();
+  }
+#endif
+
+  void log_prob_grad_batch(bool propto, bool jacobian,
+                           const Eigen::MatrixXd& params_r,
+                           Eigen::VectorXd& log_prob,
+                           Eigen::MatrixXd& gradients,
+                           std::ostream* msgs = nullptr) const {
+    log_prob.resize(params_r.cols());
+    gradients.resize(params_r.rows(), params_r.cols());
+    Eigen::VectorXd x(params_r.rows());
+    Eigen::VectorXd gradient(params_r.rows());
+    for (Eigen::Index i = 0; i < params_r.cols(); ++i) {
+      x = params_r.col(i);
+      log_prob(i) = analytic_log_prob_grad(x, gradient);
+      gradients.col(i) = gradient;
+    }
+  }
+
+  void transform_inits(const io::var_context& context,
+                       Eigen::VectorXd& params_r, std::ostream* msgs) const {
+    params_r.resize(num_params_r());
+    Eigen::Index n = 0;
+    for (size_t k = 0; k < param_names_.size(); ++k) {
+      context.validate_dims("parameter initialization", param_names_[k],
+                            "double", dims_[k]);
+      for (double value : context.vals_r(param_names_[k]))
+        params_r(n++) = value;
+    }
+  }
+
+  void transform_inits(const io::var_context& context,
+                       std::vector<int>& params_i,
+                       std::vector<double>& params_r,
+                       std::ostream* msgs) const {
+    Eigen::VectorXd params;
+    transform_inits(context, params, msgs);
+    params_r.assign(params.data(), params.data() + params.size());
+  }
+
+  void write_array(stan::rng_t& base_rng, Eigen::VectorXd& params_r,
+                   Eigen::VectorXd& params_constrained_r,
+                   bool include_tparams = true, bool include_gqs = true,
+                   std::ostream* msgs = 0) const {
+    params_constrained_r = params_r;
+  }
+
+  void write_array(stan::rng_t& base_rng, std::vector<double>& params_r,
+                   std::vector<int>& params_i,
+                   std::vector<double>& params_constrained_r,
+                   bool include_tparams = true, bool include_gqs = true,
+                   std::ostream* msgs = 0) const {
+    params_constrained_r = params_r;
+  }
+
+  void unconstrain_array(const Eigen::VectorXd& params_r_constrained,
+                         Eigen::VectorXd& params_r,
+                         std::ostream* msgs = nullptr) const {
+    params_r = params_r_constrained;
+  }
+
+  void unconstrain_array(const std::vector<double>& params_r_constrained,
+                         std::vector<double>& params_r,
+                         std::ostream* msgs = nullptr) const {
+    params_r = params_r_constrained;
+  }
+
+ private:
+  std::string name_;
+  std::vector<std::string> param_names_;
+  std::vector<std::vector<size_t>> dims_;
+  log_density_t log_density_;
+  gradient_t gradient_;
+
+  static size_t num_elements(const std::vector<std::string>& param_names,
+                             const std::vector<std::vector<size_t>>& dims) {
+    if (param_names.size() != dims.size())
+      throw std::invalid_argument(
+          "There must be one list of dimensions per parameter name");
+    size_t n = 0;
+    for (const std::vector<size_t>& d : dims)
+      n += std::accumulate(d.begin(), d.end(), size_t{1},
+                           std::multiplies<size_t>());
+    return n;
+  }
+
+  static Eigen::VectorXd to_vector(const std::vector<double>& params_r) {
+    return Eigen::Map<const Eigen::VectorXd>(params_r.data(),
+                                             params_r.size());
+  }
+
+  /**
+   * Return the log density as a single autodiff node whose partials are
+   * the analytic gradient.
+   */
+  template <typename VecVar>
+  math::var var_log_prob(const VecVar& params_r) const {
+    const size_t size = params_r.size();
+    Eigen::VectorXd x(size);
+    std::vector<math::var> operands(size);
+    for (size_t i = 0; i < size; ++i) {
+      x(i) = params_r[i].val();
+      operands[i] = params_r[i];
+    }
+    Eigen::VectorXd gradient;
+    const double lp = analytic_log_prob_grad(x, gradient);
+    return math::precomputed_gradients(
+        lp, operands,
+        std::vector<double>(gradient.data(), gradient.data() + size));
+  }
+
+  [[noreturn]] void no_second_order() const {
+    throw std::invalid_argument("Model " + name_
+                                + " has no second derivatives");
+  }
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -0,0 +1,127 @@
+#ifndef STAN_MODEL_ANNEALED_MODEL_HPP
+#define STAN_MODEL_ANNEALED_MODEL_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace stan {
+namespace model {
+
+/**
+ * <code>annealed_model</code> wraps a model so that its log density
+ * bridges a reference distribution and the posterior,
+ *
+ * <code>(1 - beta) * log q(theta) + beta * log p(theta)</code>,
+ *
+ * for an inverse temperature <code>beta</code> in [0, 1], where
+ * <code>q</code> is a normal distribution with zero mean and the same
+ * scale in every direction of the unconstrained space and <code>p</code>
+ * is the density of the wrapped model, Jacobian included.  Sequential
+ * Monte Carlo moves its particles along this path, which needs no split
+ * of the model into prior and likelihood, and the reference being
+ * normalized makes the product of the particle weights an estimate of
+ * the normalizing constant of <code>p</code>.
+ *
+ * As for <code>tempered_model</code>, the inverse temperature is read
+ * every time the log density is, so it can change between transitions.
+ *
+ * @tparam M type of model
+ */
+template <class M>
+class annealed_model {
+ public:
+  /**
+   * Construct a wrapper of a model at the specified inverse temperature.
+   *
+   * @param[in] model model, which must outlive the wrapper
+   * @param[in] reference_scale scale of the normal reference distribution
+   * @param[in] inv_temperature inverse temperature, in [0, 1]
+   * @throw std::domain_error if the scale is not positive and finite or
+   *   the inverse temperature is not in [0, 1]
+   */
+  annealed_model(const M& model, double reference_scale,
+                 double inv_temperature = 0)
+      : model_(model), reference_scale_(reference_scale) {
+    if (!(reference_scale > 0) || std::isinf(reference_scale))
+      throw std::domain_error(
+          "annealed_model: reference scale must be positive and finite");
+    set_inv_temperature(inv_temperature);
+  }
+
+  /**
+   * Return the wrapped model.
+   */
+  const M& model() const noexcept { return model_; }
+
+  double reference_scale() const noexcept { return reference_scale_; }
+
+  double inv_temperature() const noexcept { return inv_temperature_; }
+
+  /**
+   * Set the inverse temperature.
+   *
+   * @param[in] inv_temperature inverse temperature, in [0, 1]
+   * @throw std::domain_error if the inverse temperature is not in [0, 1]
+   */
+  void set_inv_temperature(double inv_temperature) {
+    if (!(inv_temperature >= 0 && inv_temperature <= 1))
+      throw std::domain_error(
+          "annealed_model: inverse temperature must be in [0, 1]");
+    inv_temperature_ = inv_temperature;
+  }
+
+  size_t num_params_r() const { return model_.num_params_r(); }
+
+  /**
+   * Return the log density of the reference distribution.
+   *
+   * @tparam propto true to drop the constant terms
+   * @tparam VecR type of vector of unconstrained parameters
+   * @param[in] params_r unconstrained parameters
+   */
+  template <bool propto, typename VecR>
+  auto reference_log_prob(const VecR& params_r) const {
+    using scalar_t = std::decay_t<decltype(params_r[0])>;
+    scalar_t sum_sq = 0;
+    for (size_t i = 0; i < static_cast<size_t>(params_r.size()); ++i)
+      sum_sq += params_r[i] * params_r[i];
+    scalar_t lp = -0.5 * sum_sq / (reference_scale_ * reference_scale_);
+    if (!propto)
+      lp -= params_r.size()
+            * (std::log(reference_scale_) + 0.5 * std::log(2 * M_PI));
+    return lp;
+  }
+
+  /**
+   * Return the log density on the path at the current inverse
+   * temperature, taking the same arguments as the
+   * <code>log_prob</code> of the model.  The model is not evaluated at
+   * inverse temperature 0.
+   *
+   * @tparam propto true to drop the constant terms
+   * @tparam jacobian true to include the Jacobian adjustment
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] args remaining arguments of <code>log_prob</code>
+   */
+  template <bool propto, bool jacobian, typename VecR, typename... Args>
+  auto log_prob(VecR& params_r, Args&&... args) const {
+    auto lp = (1 - inv_temperature_) * reference_log_prob<propto>(params_r);
+    if (inv_temperature_ > 0)
+      lp += inv_temperature_
+            * model_.template log_prob<propto, jacobian>(
+                params_r, std::forward<Args>(args)...);
+    return lp;
+  }
+
+ private:
+  const M& model_;
+  double reference_scale_;
+  double inv_temperature_;
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -0,0 +1,113 @@
+#ifndef STAN_MODEL_DIRECTIONAL_DERIVATIVES_HPP
+#define STAN_MODEL_DIRECTIONAL_DERIVATIVES_HPP
+
+#include <stan/math/mix.hpp>
+#include <stan/model/model_base.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * Compute the directional derivatives of the log density along the
+ * specified directions with forward-mode automatic differentiation, one
+ * evaluation of the log density per direction.
+ *
+ * A model class evaluates its log density of <code>fvar<double></code>,
+ * which uses no autodiff stack, so the directions are evaluated in
+ * parallel on the TBB threads.  A model only known as a
+ * <code>model_base</code> evaluates its log density of
+ * <code>fvar<var></code>, which it provides when Stan is built with
+ * <code>STAN_MODEL_FVAR_VAR</code>; each direction is then evaluated in a
+ * nested scope of the autodiff stack of its thread, in parallel only when
+ * Stan is built with <code>STAN_THREADS</code>, and the tape of the log
+ * density is discarded without a reverse pass.  The messages written for
+ * each direction are appended to the message stream in the order of the
+ * directions.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r Unconstrained parameters.
+ * @param[in] directions Directions, one per column.
+ * @param[out] derivs Directional derivative along each direction.
+ * @param[in,out] msgs stream to which messages are written, or
+ * <code>nullptr</code> to discard them
+ * @throw std::domain_error if the model is a <code>model_base</code> and
+ * Stan is built without <code>STAN_MODEL_FVAR_VAR</code>
+ * @throw std::exception if the log density throws along any direction
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+void directional_derivatives(const M& model, const Eigen::VectorXd& params_r,
+                             const Eigen::MatrixXd& directions,
+                             Eigen::VectorXd& derivs, std::ostream* msgs = 0) {
+  // model_base only overrides the log density of fvar<var>
+  constexpr bool type_erased = std::is_same<M, model_base>::value;
+#ifdef STAN_MODEL_FVAR_VAR
+  constexpr bool supported = true;
+#else
+  constexpr bool supported = !type_erased;
+#endif
+  if constexpr (!supported) {
+    throw std::domain_error(
+        "directional_derivatives: forward-mode derivatives of a model_base"
+        " require STAN_MODEL_FVAR_VAR");
+  } else {
+    using fvar_t = math::fvar<std::conditional_t<type_erased, math::var,
+                                                 double>>;
+    const Eigen::Index num_directions = directions.cols();
+    derivs.resize(num_directions);
+    std::vector<std::string> dir_msgs(msgs == nullptr ? 0 : num_directions);
+
+    auto evaluate = [&](const tbb::blocked_range<Eigen::Index>& r) {
+      std::stringstream ss;
+      std::ostream* out = msgs == nullptr ? nullptr : &ss;
+      Eigen::Matrix<fvar_t, -1, 1> x(params_r.size());
+      auto forward = [&](Eigen::Index d) {
+        for (Eigen::Index k = 0; k < params_r.size(); ++k)
+          x(k) = fvar_t(params_r(k), directions(k, d));
+        return math::value_of_rec(
+            model.template log_prob<propto, jacobian_adjust_transform>(x, out)
+                .d_);
+      };
+      for (Eigen::Index d = r.begin(); d != r.end(); ++d) {
+        if constexpr (type_erased) {
+          math::nested_rev_autodiff nested;
+          derivs(d) = forward(d);
+        } else {
+          derivs(d) = forward(d);
+        }
+        if (msgs != nullptr) {
+          dir_msgs[d] = ss.str();
+          ss.str("");
+        }
+      }
+    };
+    // forward mode over double uses no autodiff stack
+    if (type_erased)
+      internal::parallel_for_if_threads(Eigen::Index{0}, num_directions,
+                                        evaluate);
+    else
+      tbb::parallel_for(
+          tbb::blocked_range<Eigen::Index>(0, num_directions), evaluate);
+
+    for (const std::string& msg : dir_msgs)
+      *msgs << msg;
+  }
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
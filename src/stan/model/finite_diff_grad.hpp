@@ -2,7 +2,13 @@
 #define STAN_MODEL_FINITE_DIFF_GRAD_HPP
 
 #include <stan/callbacks/interrupt.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace stan {
@@ -51,6 +57,140 @@ void finite_diff_grad(const M& model, stan::callbacks::interrupt& interrupt,
   }
 }
 
+/**
+ * Compute the gradient using finite differences for the specified
+ * parameters like <code>finite_diff_grad</code>, with the coordinates
+ * split over the TBB threads.
+ *
+ * Only the log density of doubles is evaluated, which uses no autodiff
+ * stack, so the coordinates are evaluated in parallel whether or not Stan
+ * is built with <code>STAN_THREADS</code>.  The coordinates are taken in
+ * blocks, and the interrupt callback is called on the calling thread
+ * before each block.  The messages written for each coordinate are
+ * appended to the message stream in the order of the coordinates.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam M Class of model.
+ * @param model Model.
+ * @param interrupt interrupt callback to be called before each block of
+ *   coordinates.
+ * @param params_r Real-valued parameters.
+ * @param params_i Integer-valued parameters.
+ * @param[out] grad Vector into which gradient is written.
+ * @param epsilon
+ * @param[in,out] msgs
+ * @param block_size number of coordinates between interrupts
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+void finite_diff_grad_parallel(const M& model,
+                               stan::callbacks::interrupt& interrupt,
+                               const std::vector<double>& params_r,
+                               std::vector<int>& params_i,
+                               std::vector<double>& grad,
+                               double epsilon = 1e-6, std::ostream* msgs = 0,
+                               size_t block_size = 1024) {
+  const size_t n = params_r.size();
+  grad.resize(n);
+  std::vector<std::string> coord_msgs(msgs == nullptr ? 0 : n);
+  auto evaluate = [&](const tbb::blocked_range<size_t>& r) {
+    std::stringstream ss;
+    std::ostream* out = msgs == nullptr ? nullptr : &ss;
+    std::vector<double> perturbed(params_r);
+    for (size_t k = r.begin(); k != r.end(); ++k) {
+      perturbed[k] = params_r[k] + epsilon;
+      double logp_plus
+          = model.template log_prob<propto, jacobian_adjust_transform>(
+              perturbed, params_i, out);
+      perturbed[k] = params_r[k] - epsilon;
+      double logp_minus
+          = model.template log_prob<propto, jacobian_adjust_transform>(
+              perturbed, params_i, out);
+      grad[k] = (logp_plus - logp_minus) / (2 * epsilon);
+      perturbed[k] = params_r[k];
+      if (msgs != nullptr) {
+        coord_msgs[k] = ss.str();
+        ss.str("");
+      }
+    }
+  };
+  block_size = std::max<size_t>(block_size, 1);
+  for (size_t start = 0; start < n; start += block_size) {
+    interrupt();
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(start, std::min(n, start + block_size)),
+        evaluate);
+  }
+  for (const std::string& msg : coord_msgs)
+    *msgs << msg;
+}
+
+/**
+ * Compute the directional derivatives of the log density along the
+ * specified directions using central finite differences, with the
+ * directions split over the TBB threads.
+ *
+ * Each directional derivative takes two evaluations of the log density
+ * however many parameters there are, so checking a few random directions
+ * checks a gradient for far less than checking every coordinate.  The
+ * messages written for each direction are appended to the message stream
+ * in the order of the directions.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam M Class of model.
+ * @param model Model.
+ * @param params_r Real-valued parameters.
+ * @param params_i Integer-valued parameters.
+ * @param directions Directions, one per column.
+ * @param[out] derivs Directional derivative along each direction.
+ * @param epsilon
+ * @param[in,out] msgs
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+void finite_diff_directional(const M& model,
+                             const std::vector<double>& params_r,
+                             std::vector<int>& params_i,
+                             const Eigen::MatrixXd& directions,
+                             Eigen::VectorXd& derivs, double epsilon = 1e-6,
+                             std::ostream* msgs = 0) {
+  const Eigen::Index num_directions = directions.cols();
+  derivs.resize(num_directions);
+  std::vector<std::string> dir_msgs(msgs == nullptr ? 0 : num_directions);
+  auto evaluate = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    std::stringstream ss;
+    std::ostream* out = msgs == nullptr ? nullptr : &ss;
+    std::vector<double> perturbed(params_r.size());
+    for (Eigen::Index d = r.begin(); d != r.end(); ++d) {
+      for (size_t k = 0; k < params_r.size(); ++k)
+        perturbed[k] = params_r[k] + epsilon * directions(k, d);
+      double logp_plus
+          = model.template log_prob<propto, jacobian_adjust_transform>(
+              perturbed, params_i, out);
+      for (size_t k = 0; k < params_r.size(); ++k)
+        perturbed[k] = params_r[k] - epsilon * directions(k, d);
+      double logp_minus
+          = model.template log_prob<propto, jacobian_adjust_transform>(
+              perturbed, params_i, out);
+      derivs(d) = (logp_plus - logp_minus) / (2 * epsilon);
+      if (msgs != nullptr) {
+        dir_msgs[d] = ss.str();
+        ss.str("");
+      }
+    }
+  };
+  tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, num_directions),
+                    evaluate);
+  for (const std::string& msg : dir_msgs)
+    *msgs << msg;
+}
+
 }  // namespace model
 }  // namespace stan
 #endif
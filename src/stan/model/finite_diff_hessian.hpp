@@ -0,0 +1,101 @@
+#ifndef STAN_MODEL_FINITE_DIFF_HESSIAN_HPP
+#define STAN_MODEL_FINITE_DIFF_HESSIAN_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * Compute the Hessian of a function by central finite differences of
+ * its gradient, evaluating the gradients at the perturbed points in
+ * parallel on the TBB threads when Stan is built with
+ * <code>STAN_THREADS</code>, which gives each thread its own autodiff
+ * stack, and serially otherwise.  The Hessian is symmetrized by averaging
+ * it with its transpose.
+ *
+ * The step along each dimension is the cube root of the machine
+ * epsilon scaled by the magnitude of the coordinate, if it is more than
+ * one, as in <code>stan::math::internal::finite_diff_hessian_auto</code>,
+ * which this matches up to rounding.  Only the Hessian is held, so the
+ * memory used is that of the result plus two gradients per thread.
+ *
+ * The gradient functor may be called concurrently from several threads.  A
+ * functor differentiating with reverse mode must evaluate each gradient
+ * in a nested scope of the autodiff stack of the calling thread, as
+ * <code>stan::math::gradient</code> does.  The messages each call writes
+ * are appended to the message stream in the order of the perturbations.
+ *
+ * @tparam F type of the gradient functor, callable as
+ * <code>double grad_fun(const Eigen::VectorXd& x, Eigen::VectorXd& grad,
+ * std::ostream* msgs)</code>, returning the value of the function at
+ * <code>x</code> and writing its gradient to <code>grad</code>
+ * @param[in] grad_fun gradient functor
+ * @param[in] x point at which the Hessian is computed
+ * @param[out] fx value of the function at the point
+ * @param[out] grad_fx gradient of the function at the point
+ * @param[out] hess_fx Hessian of the function at the point
+ * @param[in, out] msgs stream to which messages are written, or
+ * <code>nullptr</code> to discard them
+ */
+template <typename F>
+void finite_diff_hessian(const F& grad_fun, const Eigen::VectorXd& x,
+                         double& fx, Eigen::VectorXd& grad_fx,
+                         Eigen::MatrixXd& hess_fx,
+                         std::ostream* msgs = nullptr) {
+  const Eigen::Index d = x.size();
+  fx = grad_fun(x, grad_fx, msgs);
+  hess_fx.resize(d, d);
+  std::vector<std::string> perturbed_msgs(msgs == nullptr ? 0 : 2 * d);
+
+  // column i holds the difference of the gradients along dimension i
+  auto evaluate = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    Eigen::VectorXd x_temp(x);
+    Eigen::VectorXd g_plus(d);
+    Eigen::VectorXd g_minus(d);
+    std::stringstream ss;
+    std::ostream* ss_ptr = msgs == nullptr ? nullptr : &ss;
+    for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+      const double epsilon = std::cbrt(std::numeric_limits<double>::epsilon())
+                             * std::max(1.0, std::fabs(x(i)));
+      x_temp(i) = x(i) + epsilon;
+      grad_fun(x_temp, g_plus, ss_ptr);
+      if (msgs != nullptr) {
+        perturbed_msgs[2 * i] = ss.str();
+        ss.str("");
+      }
+      x_temp(i) = x(i) - epsilon;
+      grad_fun(x_temp, g_minus, ss_ptr);
+      if (msgs != nullptr) {
+        perturbed_msgs[2 * i + 1] = ss.str();
+        ss.str("");
+      }
+      x_temp(i) = x(i);
+      hess_fx.col(i) = (g_plus - g_minus) / (2 * epsilon);
+    }
+  };
+  internal::parallel_for_if_threads(Eigen::Index{0}, d, evaluate);
+
+  for (Eigen::Index i = 0; i < d; ++i) {
+    for (Eigen::Index j = i + 1; j < d; ++j) {
+      const double h_ij = 0.5 * (hess_fx(i, j) + hess_fx(j, i));
+      hess_fx(i, j) = h_ij;
+      hess_fx(j, i) = h_ij;
+    }
+  }
+  for (const std::string& msg : perturbed_msgs)
+    *msgs << msg;
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -2,6 +2,9 @@
 #define STAN_MODEL_GRAD_HESS_LOG_PROB_HPP
 
 #include <stan/model/log_prob_grad.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <stan/math/rev.hpp>
+#include <tbb/blocked_range.h>
 #include <iostream>
 #include <vector>
 
@@ -14,6 +17,11 @@ namespace model {
  * numerically by finite-differencing the gradient, at a cost of
  * O(params_r.size()^2).
  *
+ * The gradients at the perturbed parameters are evaluated in parallel
+ * on the TBB threads when Stan is built with <code>STAN_THREADS</code>,
+ * which gives each thread its own autodiff stack, each in a nested
+ * autodiff scope.  The result does not depend on the number of threads.
+ *
  * @tparam propto True if calculation is up to proportion
  * (double-only terms dropped).
  * @tparam jacobian_adjust_transform True if the log absolute
@@ -48,23 +56,40 @@ double grad_hess_log_prob(const M& model, std::vector<double>& params_r,
          half_epsilon * coefficients[2], half_epsilon * coefficients[3]};
   double result = log_prob_grad<propto, jacobian_adjust_transform>(
       model, params_r, params_i, gradient, msgs);
-  hessian.assign(params_r.size() * params_r.size(), 0);
-  std::vector<double> temp_grad(params_r.size());
-  std::vector<double> perturbed_params(params_r.begin(), params_r.end());
-  for (size_t d = 0; d < params_r.size(); ++d) {
-    const int row_iter = d * params_r.size();
-    for (int i = 0; i < order; ++i) {
-      perturbed_params[d] = params_r[d] + perturbations[i];
-      log_prob_grad<propto, jacobian_adjust_transform>(model, perturbed_params,
-                                                       params_i, temp_grad);
-      for (size_t dd = 0; dd < params_r.size(); ++dd) {
-        const double increment = half_epsilon_coeff[i] * temp_grad[dd];
-        const int col_iter = dd * params_r.size();
-        hessian[dd + row_iter] += increment;
-        hessian[d + col_iter] += increment;
+  const size_t D = params_r.size();
+  hessian.assign(D * D, 0);
+  // row d gathers the differences of the gradient along dimension d,
+  // and the Hessian is that plus its transpose
+  auto evaluate = [&](const tbb::blocked_range<size_t>& r) {
+    Eigen::VectorXd perturbed_params
+        = Eigen::Map<const Eigen::VectorXd>(params_r.data(), D);
+    Eigen::VectorXd temp_grad(D);
+    double temp_lp;
+    auto log_prob_fun = [&](const Eigen::Matrix<math::var, -1, 1>& theta) {
+      std::vector<math::var> theta_vec(theta.data(),
+                                       theta.data() + theta.size());
+      return model.template log_prob<propto, jacobian_adjust_transform>(
+          theta_vec, params_i, nullptr);
+    };
+    for (size_t d = r.begin(); d != r.end(); ++d) {
+      const size_t row_iter = d * D;
+      for (int i = 0; i < order; ++i) {
+        perturbed_params(d) = params_r[d] + perturbations[i];
+        math::gradient(log_prob_fun, perturbed_params, temp_lp, temp_grad);
+        for (size_t dd = 0; dd < D; ++dd)
+          hessian[dd + row_iter] += half_epsilon_coeff[i] * temp_grad(dd);
       }
+      perturbed_params(d) = params_r[d];
+    }
+  };
+  internal::parallel_for_if_threads(size_t{0}, D, evaluate);
+  for (size_t d = 0; d < D; ++d) {
+    hessian[d + d * D] *= 2;
+    for (size_t dd = d + 1; dd < D; ++dd) {
+      const double sum = hessian[dd + d * D] + hessian[d + dd * D];
+      hessian[dd + d * D] = sum;
+      hessian[d + dd * D] = sum;
     }
-    perturbed_params[d] = params_r[d];
   }
   return result;
 }
@@ -0,0 +1,230 @@
+#ifndef STAN_MODEL_GRADIENT_EVALUATOR_HPP
+#define STAN_MODEL_GRADIENT_EVALUATOR_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/rev.hpp>
+#include <stan/model/gradient_stats.hpp>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace stan {
+namespace model {
+
+/**
+ * Evaluator of the gradient of the log density of a model, for callers
+ * such as samplers that evaluate it at many points in turn.
+ *
+ * It computes what <code>stan::model::gradient</code> does, but keeps
+ * the storage of the autodiff parameters and of the message stream
+ * between calls instead of allocating them for every gradient.  Each
+ * gradient is taken in a nested scope of the autodiff stack of the
+ * calling thread, whose memory is kept by the stack and reused by the
+ * next gradient, so the caller's autodiff variables are left untouched.
+ *
+ * The evaluator counts the gradients it evaluates and records the size
+ * of their autodiff tape, and, when timing is enabled, the wall time
+ * spent in them.
+ *
+ * An evaluator holds state, so it must not be called concurrently.
+ * Concurrent callers should each hold their own.
+ *
+ * @tparam M type of model
+ * @tparam propto true if the normalizing constants are dropped
+ * @tparam jacobian true if the log Jacobian adjustment is included
+ */
+template <class M, bool propto = true, bool jacobian = true>
+class gradient_evaluator {
+ public:
+  explicit gradient_evaluator(const M& model)
+      : model_(model), timing_(false) {}
+
+  // the storage is scratch space, so copies start with their own
+  gradient_evaluator(const gradient_evaluator& other)
+      : model_(other.model_), timing_(other.timing_) {}
+
+  /**
+   * Set whether the wall time of each gradient is measured.
+   */
+  void set_timing(bool timing) { timing_ = timing; }
+
+  /**
+   * Return the work done by this evaluator since it was constructed.
+   */
+  const gradient_stats& stats() const noexcept { return stats_; }
+
+  /**
+   * Compute the log density and its gradient at the specified point.
+   *
+   * @param[in] x unconstrained parameters
+   * @param[out] f log density
+   * @param[out] grad_f gradient of the log density
+   * @param[in,out] msgs stream to which messages are written
+   */
+  void operator()(const Eigen::VectorXd& x, double& f,
+                  Eigen::VectorXd& grad_f, std::ostream* msgs = 0) {
+    ++stats_.num_gradients;
+    if (!timing_) {
+      evaluate(x, f, grad_f, msgs);
+      return;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      evaluate(x, f, grad_f, msgs);
+    } catch (...) {
+      add_time(start);
+      throw;
+    }
+    add_time(start);
+  }
+
+  /**
+   * Compute the log density and its gradient at the specified point,
+   * writing the messages of the model to the logger.
+   *
+   * @param[in] x unconstrained parameters
+   * @param[out] f log density
+   * @param[out] grad_f gradient of the log density
+   * @param[in,out] logger logger for the messages of the model
+   */
+  void operator()(const Eigen::VectorXd& x, double& f,
+                  Eigen::VectorXd& grad_f, callbacks::logger& logger) {
+    msgs_.str(std::string());
+    msgs_.clear();
+    try {
+      (*this)(x, f, grad_f, &msgs_);
+    } catch (std::exception& e) {
+      if (msgs_.tellp() > 0)
+        logger.info(msgs_);
+      throw;
+    }
+    if (msgs_.tellp() > 0)
+      logger.info(msgs_);
+  }
+
+  /**
+   * Compute the log density and its gradient at the specified point,
+   * writing the messages of the model to the logger, and return false
+   * instead of throwing if the log density can not be evaluated there.
+   *
+   * A domain error of the model, which rejects a proposal, is caught
+   * where it is thrown from the model and its message is kept for
+   * <code>error_message()</code>, so callers rejecting many proposals
+   * neither rethrow it nor copy it into a message of their own.  Other
+   * exceptions are thrown.
+   *
+   * @param[in] x unconstrained parameters
+   * @param[out] f log density
+   * @param[out] grad_f gradient of the log density
+   * @param[in,out] logger logger for the messages of the model
+   * @return true if the log density was evaluated
+   */
+  bool try_gradient(const Eigen::VectorXd& x, double& f,
+                    Eigen::VectorXd& grad_f, callbacks::logger& logger) {
+    msgs_.str(std::string());
+    msgs_.clear();
+    ++stats_.num_gradients;
+    const auto start = timing_ ? std::chrono::steady_clock::now()
+                               : std::chrono::steady_clock::time_point();
+    bool ok = true;
+    try {
+      evaluate(x, f, grad_f, &msgs_);
+    } catch (const std::domain_error& e) {
+      error_.assign(e.what());
+      ok = false;
+    } catch (...) {
+      if (timing_)
+        add_time(start);
+      if (msgs_.tellp() > 0)
+        logger.info(msgs_);
+      throw;
+    }
+    if (timing_)
+      add_time(start);
+    if (msgs_.tellp() > 0)
+      logger.info(msgs_);
+    return ok;
+  }
+
+  /**
+   * Compute the log density at the specified point without its gradient,
+   * writing the messages of the model to the logger, and return false
+   * instead of throwing if it can not be evaluated there.  See
+   * <code>try_gradient</code>.
+   *
+   * @param[in] x unconstrained parameters
+   * @param[out] f log density
+   * @param[in,out] logger logger for the messages of the model
+   * @return true if the log density was evaluated
+   */
+  bool try_log_prob(const Eigen::VectorXd& x, double& f,
+                    callbacks::logger& logger) {
+    msgs_.str(std::string());
+    msgs_.clear();
+    bool ok = true;
+    try {
+      stan::math::nested_rev_autodiff nested;
+      x_var_.resize(x.size());
+      for (Eigen::Index i = 0; i < x.size(); ++i)
+        x_var_.coeffRef(i) = x.coeff(i);
+      f = model_.template log_prob<propto, jacobian>(x_var_, &msgs_).val();
+    } catch (const std::domain_error& e) {
+      error_.assign(e.what());
+      ok = false;
+    } catch (...) {
+      if (msgs_.tellp() > 0)
+        logger.info(msgs_);
+      throw;
+    }
+    if (msgs_.tellp() > 0)
+      logger.info(msgs_);
+    return ok;
+  }
+
+  /**
+   * Return the message of the last domain error caught by
+   * <code>try_gradient</code> or <code>try_log_prob</code>.
+   */
+  const std::string& error_message() const noexcept { return error_; }
+
+ private:
+  const M& model_;
+  Eigen::Matrix<stan::math::var, -1, 1> x_var_;
+  std::stringstream msgs_;
+  std::string error_;
+  bool timing_;
+  gradient_stats stats_;
+
+  void evaluate(const Eigen::VectorXd& x, double& f, Eigen::VectorXd& grad_f,
+                std::ostream* msgs) {
+    stan::math::nested_rev_autodiff nested;
+    auto& stack = *stan::math::ChainableStack::instance_;
+    const std::size_t stack_start
+        = stack.var_stack_.size() + stack.var_nochain_stack_.size();
+    // assigning new vars reuses the storage of the previous ones
+    x_var_.resize(x.size());
+    for (Eigen::Index i = 0; i < x.size(); ++i)
+      x_var_.coeffRef(i) = x.coeff(i);
+    stan::math::var f_var
+        = model_.template log_prob<propto, jacobian>(x_var_, msgs);
+    f = f_var.val();
+    stan::math::grad(f_var.vi_);
+    stats_.ad_stack_size = stack.var_stack_.size()
+                           + stack.var_nochain_stack_.size() - stack_start;
+    stats_.ad_bytes_allocated = stack.memory_.bytes_allocated();
+    grad_f.resize(x.size());
+    for (Eigen::Index i = 0; i < x.size(); ++i)
+      grad_f.coeffRef(i) = x_var_.coeff(i).adj();
+  }
+
+  void add_time(const std::chrono::steady_clock::time_point& start) {
+    stats_.gradient_time += std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+  }
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -0,0 +1,40 @@
+#ifndef STAN_MODEL_GRADIENT_STATS_HPP
+#define STAN_MODEL_GRADIENT_STATS_HPP
+
+#include <cstddef>
+
+namespace stan {
+namespace model {
+
+/**
+ * Work done by a gradient evaluator since it was constructed, for
+ * instrumenting the samplers that use it.
+ */
+struct gradient_stats {
+  /**
+   * Number of gradients evaluated, including those that threw.
+   */
+  std::size_t num_gradients = 0;
+
+  /**
+   * Total wall time in seconds spent evaluating gradients, which is only
+   * measured while timing is enabled.
+   */
+  double gradient_time = 0;
+
+  /**
+   * Number of entries the last gradient put on the autodiff stack.
+   */
+  std::size_t ad_stack_size = 0;
+
+  /**
+   * Bytes the arena of the autodiff stack held after the last gradient.
+   * The arena only grows, so an increase is memory allocated on the heap
+   * for the autodiff tape.
+   */
+  std::size_t ad_bytes_allocated = 0;
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
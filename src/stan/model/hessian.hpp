@@ -3,6 +3,9 @@
 
 #include <stan/math/mix.hpp>
 #include <stan/model/model_functional.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <tbb/blocked_range.h>
+#include <algorithm>
 #include <iostream>
 
 namespace stan {
@@ -17,6 +20,65 @@ void hessian(const M& model, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
                                             f, grad_f, hess_f);
 }
 
+/**
+ * Compute the Hessian of the log density of the model exactly, a column
+ * at a time as its product with a coordinate vector by forward-over-
+ * reverse automatic differentiation.  The columns are taken in blocks of
+ * the specified number of tangents, which are evaluated in parallel on
+ * the TBB threads when Stan is built with <code>STAN_THREADS</code>, and
+ * serially otherwise, so that the wall time is that of about
+ * <code>N / num_tangents</code> products for <code>N</code> parameters
+ * with as many threads.  The Hessian is symmetrized by averaging it with
+ * its transpose.
+ *
+ * Only the gradient writes messages, as the products may be taken
+ * concurrently.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian True if the log absolute Jacobian determinant of
+ * inverse parameter transforms is added to the log density.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] x Unconstrained parameters.
+ * @param[out] f Log density at the parameters.
+ * @param[out] grad_f Gradient of the log density.
+ * @param[out] hess_f Hessian of the log density.
+ * @param[in, out] msgs Stream to which print statements in Stan
+ * programs are written, default is 0
+ * @param[in] num_tangents Number of columns evaluated by each task, at
+ * least one.
+ */
+template <bool propto, bool jacobian, class M>
+void hessian(const M& model, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+             double& f, Eigen::Matrix<double, Eigen::Dynamic, 1>& grad_f,
+             Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>& hess_f,
+             std::ostream* msgs = 0, int num_tangents = 4) {
+  stan::math::gradient(model_functional<M, propto, jacobian>(model, msgs), x,
+                       f, grad_f);
+  const Eigen::Index n = x.size();
+  const Eigen::Index width = std::max(1, num_tangents);
+  hess_f.resize(n, n);
+  auto evaluate = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    model_functional<M, propto, jacobian> log_density(model, nullptr);
+    Eigen::VectorXd e = Eigen::VectorXd::Zero(n);
+    Eigen::VectorXd he(n);
+    double fx;
+    for (Eigen::Index b = r.begin(); b != r.end(); ++b) {
+      for (Eigen::Index j = b * width; j < std::min(n, (b + 1) * width); ++j) {
+        e(j) = 1;
+        stan::math::hessian_times_vector(log_density, x, e, fx, he);
+        e(j) = 0;
+        hess_f.col(j) = he;
+      }
+    }
+  };
+  const Eigen::Index num_blocks = (n + width - 1) / width;
+  internal::parallel_for_if_threads(Eigen::Index{0}, num_blocks, evaluate);
+  // the triangles differ by rounding
+  hess_f = 0.5 * (hess_f + hess_f.transpose()).eval();
+}
+
 }  // namespace model
 }  // namespace stan
 #endif
@@ -18,6 +18,36 @@ void hessian_times_vector(
                                    hess_f_dot_v);
 }
 
+/**
+ * Compute the product of the Hessian of the log density of the model
+ * with a vector by forward-over-reverse automatic differentiation,
+ * without forming the Hessian.  Each product costs about as much as a
+ * few gradients.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian True if the log absolute Jacobian determinant of
+ * inverse parameter transforms is added to the log density.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] x Unconstrained parameters.
+ * @param[in] v Vector to multiply by the Hessian.
+ * @param[out] f Log density at the parameters.
+ * @param[out] hess_f_dot_v Product of the Hessian with the vector.
+ * @param[in, out] msgs Stream to which print statements in Stan
+ * programs are written, default is 0
+ */
+template <bool propto, bool jacobian, class M>
+void hessian_times_vector(
+    const M& model, const Eigen::Matrix<double, Eigen::Dynamic, 1>& x,
+    const Eigen::Matrix<double, Eigen::Dynamic, 1>& v, double& f,
+    Eigen::Matrix<double, Eigen::Dynamic, 1>& hess_f_dot_v,
+    std::ostream* msgs = 0) {
+  stan::math::hessian_times_vector(
+      model_functional<M, propto, jacobian>(model, msgs), x, v, f,
+      hess_f_dot_v);
+}
+
 }  // namespace model
 }  // namespace stan
 #endif
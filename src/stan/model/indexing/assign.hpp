@@ -114,6 +114,59 @@ inline void assign(Vec1&& x, const Vec2& y, const char* name,
   }
 }
 
+/**
+ * Assign to a non-contiguous subset of elements in a vector with indexes
+ * checked on construction, checking only the largest index and assigning
+ * the elements according to the layout of the indexes.
+ *
+ * Types:  vector[multi] <- vector
+ *
+ * @tparam Vec1 Eigen type with either dynamic rows or columns, but not both.
+ * @tparam Vec2 Eigen type with either dynamic rows or columns, but not both.
+ * @param[in] x Vector to be assigned.
+ * @param[in] y Value vector.
+ * @param[in] name Name of variable
+ * @param[in] idx Checked index of the cells to assign to.
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ * @throw std::invalid_argument If the value size isn't the same as
+ * the indexed size.
+ */
+template <typename Vec1, typename Vec2,
+          require_all_eigen_vector_t<Vec1, Vec2>* = nullptr>
+inline void assign(Vec1&& x, const Vec2& y, const char* name,
+                   const index_multi_checked& idx) {
+  const auto& y_ref = stan::math::to_ref(y);
+  stan::math::check_size_match("vector[multi] assign", name, idx.ns_.size(),
+                               "right hand side", y_ref.size());
+  idx.check_size("vector[multi] assign", name, x.size());
+  using layout = index_multi_checked::layout;
+  const int assign_size = y_ref.size();
+  if (assign_size == 0)
+    return;
+  const int first = idx.ns_[0] - 1;
+  switch (idx.layout_) {
+    case layout::contiguous:
+      x.segment(first, assign_size) = y_ref;
+      break;
+    case layout::strided:
+      for (int n = 0; n < assign_size; ++n)
+        x.coeffRef(first + n * idx.stride_) = y_ref.coeff(n);
+      break;
+    case layout::runs:
+      // the last of repeated indexes is assigned
+      idx.for_each_run([&](int pos, int start, int run_size, int step) {
+        if (step == 1)
+          x.segment(start, run_size) = y_ref.segment(pos, run_size);
+        else
+          x.coeffRef(start) = y_ref.coeff(pos + run_size - 1);
+      });
+      break;
+    default:
+      for (int n = 0; n < assign_size; ++n)
+        x.coeffRef(idx.ns_[n] - 1) = y_ref.coeff(n);
+  }
+}
+
 /**
  * Assign to a range of an Eigen vector
  *
@@ -286,6 +339,62 @@ inline void assign(Mat1&& x, const Mat2& y, const char* name,
   }
 }
 
+/**
+ * Assign to the rows of a matrix with indexes checked on construction,
+ * checking only the largest index and assigning the rows according to the
+ * layout of the indexes.
+ *
+ * Types:  mat[multi] = mat
+ *
+ * @tparam Mat An Eigen type with dynamic rows and columns.
+ * @tparam Mat2 An Eigen type with dynamic rows and columns.
+ * @param[in] x Matrix variable to be assigned.
+ * @param[in] y Value matrix.
+ * @param[in] name Name of variable
+ * @param[in] idx checked multi index
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ * @throw std::invalid_argument If the dimensions of the indexed
+ * matrix and right-hand side matrix do not match.
+ */
+template <typename Mat1, typename Mat2,
+          require_all_eigen_dense_dynamic_t<Mat1, Mat2>* = nullptr>
+inline void assign(Mat1&& x, const Mat2& y, const char* name,
+                   const index_multi_checked& idx) {
+  const auto& y_ref = stan::math::to_ref(y);
+  stan::math::check_size_match("matrix[multi] assign rows", name,
+                               idx.ns_.size(), "right hand side rows",
+                               y.rows());
+  stan::math::check_size_match("matrix[multi] assign columns", name, x.cols(),
+                               "right hand side columns", y.cols());
+  idx.check_size("matrix[multi] assign row", name, x.rows());
+  using layout = index_multi_checked::layout;
+  const int assign_rows = idx.ns_.size();
+  if (assign_rows == 0)
+    return;
+  const int first = idx.ns_[0] - 1;
+  switch (idx.layout_) {
+    case layout::contiguous:
+      x.middleRows(first, assign_rows) = y_ref;
+      break;
+    case layout::strided:
+      for (int i = 0; i < assign_rows; ++i)
+        x.row(first + i * idx.stride_) = y_ref.row(i);
+      break;
+    case layout::runs:
+      // the last of repeated indexes is assigned
+      idx.for_each_run([&](int pos, int start, int run_size, int step) {
+        if (step == 1)
+          x.middleRows(start, run_size) = y_ref.middleRows(pos, run_size);
+        else
+          x.row(start) = y_ref.row(pos + run_size - 1);
+      });
+      break;
+    default:
+      for (int i = 0; i < assign_rows; ++i)
+        x.row(idx.ns_[i] - 1) = y_ref.row(i);
+  }
+}
+
 /**
  * Assign a matrix to another matrix
  *
@@ -898,6 +1007,43 @@ inline void assign(T&& x, U&& y, const char* name, const Idx1& idx1,
   }
 }
 
+/**
+ * Assign to the elements of an std vector selected by a multiple index
+ * checked on construction, checking only the largest index, with
+ * additional subsetting on each element.
+ *
+ * Types:  x[multi | Idx2] = y
+ *
+ * @tparam T A standard vector.
+ * @tparam Idxs Type of tail of index list.
+ * @tparam U A standard vector
+ * @param[in] x Array variable to be assigned.
+ * @param[in] y Value.
+ * @param[in] name Name of variable
+ * @param[in] idx1 checked first index
+ * @param[in] idxs Remaining indices
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ * @throw std::invalid_argument If the size of the multiple indexing
+ * and size of first dimension of value do not match, or any of
+ * the recursive tail assignment dimensions do not match.
+ */
+template <typename T, typename... Idxs, typename U,
+          require_all_std_vector_t<T, U>* = nullptr>
+inline void assign(T&& x, U&& y, const char* name,
+                   const index_multi_checked& idx1, const Idxs&... idxs) {
+  stan::math::check_size_match("array[multi, ...] assign", name,
+                               idx1.ns_.size(), "right hand side size",
+                               y.size());
+  idx1.check_size("array[multi, ...] assign", name, x.size());
+  for (size_t n = 0; n < y.size(); ++n) {
+    if (std::is_rvalue_reference<U&&>::value) {
+      assign(x[idx1.ns_[n] - 1], std::move(y[n]), name, idxs...);
+    } else {
+      assign(x[idx1.ns_[n] - 1], y[n], name, idxs...);
+    }
+  }
+}
+
 namespace internal {
 template <typename T, T... I>
 inline constexpr auto make_tuple_seq(std::integer_sequence<T, I...>) {
@@ -40,6 +40,10 @@ inline constexpr const char* print_index_type(stan::model::index_omni) {
 inline const char* print_index_type(const stan::math::matrix_cl<int>&) {
   return "multi index";
 }
+
+inline const char* print_index_type(const stan::model::index_multi_cl&) {
+  return "multi index";
+}
 #endif
 }  // namespace internal
 
@@ -162,7 +166,8 @@ inline void assign(ExprLhs&& expr_lhs, const ScalRhs& scal_rhs,
  */
 template <typename ExprLhs, typename ExprRhs, typename RowIndex,
           require_rev_kernel_expression_t<ExprLhs>* = nullptr,
-          require_nonscalar_prim_or_rev_kernel_expression_t<ExprRhs>* = nullptr>
+          require_nonscalar_prim_or_rev_kernel_expression_t<ExprRhs>* = nullptr,
+          require_not_same_t<RowIndex, index_multi_cl>* = nullptr>
 inline void assign(ExprLhs&& expr_lhs, const ExprRhs& expr_rhs,
                    const char* name, RowIndex&& row_index) {
   decltype(auto) lhs_val = rvalue(expr_lhs.val_op(), name, row_index);
@@ -196,6 +201,52 @@ inline void assign(math::var_value<math::matrix_cl<double>>& expr_lhs,
   expr_lhs.vi_ = expr_rhs.vi_;
 }
 
+/**
+ * Assign one primitive or reverse mode kernel generator expression to a reverse
+ * mode one, using a multi-index resident on the device.  The reverse pass
+ * refers to the index on the device instead of keeping a copy of it.
+ *
+ * @tparam ExprLhs type of the assignable rev expression on the left hand side
+ * of the assignment
+ * @tparam ExprRhs type of the prim or rev expression on the right hand side of
+ * the assignment
+ * @param[in,out] expr_lhs expression on the left hand side of the assignment
+ * @param expr_rhs expression on the right hand side of the assignment
+ * @param name Name of lvalue variable
+ * @param row_index index used for indexing `expr_lhs`, which must outlive the
+ * reverse pass
+ * @throw std::out_of_range If the index is out of bounds.
+ * @throw std::invalid_argument If the right hand side size isn't the same as
+ * the indexed left hand side size.
+ */
+template <typename ExprLhs, typename ExprRhs,
+          require_rev_kernel_expression_t<ExprLhs>* = nullptr,
+          require_nonscalar_prim_or_rev_kernel_expression_t<ExprRhs>* = nullptr>
+inline void assign(ExprLhs&& expr_lhs, const ExprRhs& expr_rhs,
+                   const char* name, const index_multi_cl& row_index) {
+  decltype(auto) lhs_val = rvalue(expr_lhs.val_op(), name, row_index);
+  stan::math::check_size_match(internal::print_index_type(row_index),
+                               "left hand side rows", lhs_val.rows(), name,
+                               expr_rhs.rows());
+  stan::math::check_size_match(internal::print_index_type(row_index),
+                               "left hand side columns", lhs_val.cols(), name,
+                               expr_rhs.cols());
+  math::arena_matrix_cl<double> prev_vals = lhs_val;
+  lhs_val = math::value_of(expr_rhs);  // assign the values
+  math::reverse_pass_callback(
+      [expr_lhs, expr_rhs, name, prev_vals, idx = &row_index]() mutable {
+        auto&& lhs_val = rvalue(expr_lhs.val_op(), name, *idx);
+        decltype(auto) lhs_adj = rvalue(expr_lhs.adj(), name, *idx);
+
+        math::results(lhs_val, math::adjoint_of(expr_rhs), lhs_adj)
+            = math::expressions(
+                prev_vals,
+                math::calc_if<!is_constant<ExprRhs>::value>(
+                    math::adjoint_of(expr_rhs) + lhs_adj),
+                math::constant(0.0, lhs_adj.rows(), lhs_adj.cols()));
+      });
+}
+
 /**
  * Assign one primitive or reverse mode kernel generator expression to a reverse
  * mode one, using given indices.
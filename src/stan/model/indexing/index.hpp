@@ -1,6 +1,7 @@
 #ifndef STAN_MODEL_INDEXING_INDEX_HPP
 #define STAN_MODEL_INDEXING_INDEX_HPP
 
+#include <stan/math/prim/err/check_range.hpp>
 #include <stan/math/prim/meta.hpp>
 #include <vector>
 
@@ -44,6 +45,118 @@ struct index_multi {
   explicit index_multi(T&& ns) noexcept : ns_(std::forward<T>(ns)) {}
 };
 
+/**
+ * Structure for a multiple indexing whose indexes are checked once, on
+ * construction, to be in the range of a container of a known size.
+ *
+ * Indexing with it only checks that the container is large enough for
+ * the largest index instead of checking every index, so it suits
+ * indexes, such as group ids in the data, that are constructed once and
+ * applied on every evaluation of the log density.  It is an
+ * <code>index_multi</code>, so it can be used wherever one can, though
+ * only the vector, matrix row and array indexing and assignment skip the
+ * checks of every index.
+ *
+ * The layout of the indexes is classified on construction too, so that
+ * vector and matrix row indexing and assignment copy contiguous indexes
+ * as one segment, strided indexes without loading them, and indexes made
+ * of long runs of consecutive or repeated indexes, such as sorted group
+ * ids, one run at a time.
+ */
+struct index_multi_checked : public index_multi {
+  /**
+   * Layout of the indexes: consecutive, with a constant step greater than
+   * one, made of runs of consecutive or repeated indexes averaging at
+   * least <code>min_run_size</code> indexes, or anything else.
+   */
+  enum class layout { contiguous, strided, runs, arbitrary };
+
+  static constexpr int min_run_size = 4;
+
+  int max_;
+  layout layout_;
+  int stride_;
+  // Position of the first index of each run, followed by the size
+  std::vector<int> run_offsets_;
+
+  /**
+   * Construct a multiple indexing from the specified indexes, checking
+   * that they are in the range of a container of the specified size.
+   *
+   * @param ns multiple indexes.
+   * @param size size of the containers to be indexed.
+   * @param name name of the indexes for error messages.
+   * @throw std::out_of_range if an index is not between one and the
+   * size.
+   */
+  template <typename T, require_std_vector_vt<std::is_integral, T>* = nullptr>
+  index_multi_checked(T&& ns, int size, const char* name = "index")
+      : index_multi(std::forward<T>(ns)),
+        max_(0),
+        layout_(layout::arbitrary),
+        stride_(ns_.size() > 1 ? ns_[1] - ns_[0] : 1) {
+    const int num_indexes = ns_.size();
+    bool constant_stride = true;
+    int run_step = -1;
+    for (int i = 0; i < num_indexes; ++i) {
+      math::check_range("multi index", name, size, ns_[i]);
+      if (ns_[i] > max_)
+        max_ = ns_[i];
+      const int step = i > 0 ? ns_[i] - ns_[i - 1] : -1;
+      constant_stride = constant_stride && (i == 0 || step == stride_);
+      if ((step == 0 || step == 1) && (run_step == -1 || step == run_step)) {
+        run_step = step;
+      } else {
+        run_offsets_.push_back(i);
+        run_step = -1;
+      }
+    }
+    run_offsets_.push_back(num_indexes);
+    if (constant_stride && stride_ == 1)
+      layout_ = layout::contiguous;
+    else if (constant_stride && stride_ > 1)
+      layout_ = layout::strided;
+    else if ((run_offsets_.size() - 1) * min_run_size <= ns_.size())
+      layout_ = layout::runs;
+    if (layout_ != layout::runs)
+      std::vector<int>().swap(run_offsets_);
+  }
+
+  /**
+   * Check that a container of the specified size holds every index,
+   * which needs only the largest index.
+   *
+   * @param function name of the indexing for error messages.
+   * @param name name of the container for error messages.
+   * @param size size of the container.
+   * @throw std::out_of_range if the largest index is greater than the
+   * size.
+   */
+  void check_size(const char* function, const char* name, int size) const {
+    if (max_ > 0)
+      math::check_range(function, name, size, max_);
+  }
+
+  /**
+   * Call the specified functor with the position of the run in the
+   * indexes, its zero-based first index, its size and its step, zero for
+   * repeated and one for consecutive indexes, for each run of the indexes.
+   * Only indexes with the <code>runs</code> layout hold their runs.
+   *
+   * @tparam F type of functor
+   * @param f functor
+   */
+  template <typename F>
+  void for_each_run(F&& f) const {
+    for (size_t k = 0; k + 1 < run_offsets_.size(); ++k) {
+      const int pos = run_offsets_[k];
+      const int run_size = run_offsets_[k + 1] - pos;
+      const int step = run_size > 1 ? ns_[pos + 1] - ns_[pos] : 1;
+      f(pos, ns_[pos] - 1, run_size, step);
+    }
+  }
+};
+
 /**
  * Structure for an indexing that consists of all indexes for a
  * container.  Applying this index is a no-op.
@@ -0,0 +1,175 @@
+#ifndef STAN_MODEL_INDEXING_MULTI_INDEX_KERNELS_HPP
+#define STAN_MODEL_INDEXING_MULTI_INDEX_KERNELS_HPP
+
+#include <stan/math/prim/err/check_range.hpp>
+#include <stan/math/prim/meta.hpp>
+#include <stan/math/rev/core.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+namespace stan {
+
+namespace model {
+
+namespace internal {
+
+/**
+ * Smallest number of coefficients an adjoint scatter must update to be
+ * split over the TBB threads.
+ */
+constexpr Eigen::Index parallel_scatter_size = 1 << 16;
+
+/**
+ * A multiple index split into runs of consecutive indexes, so that the
+ * elements of a run are gathered and their adjoints scattered as one
+ * contiguous segment.
+ *
+ * The arrays live on the autodiff arena, so the structure is cheap to
+ * capture in a reverse pass callback.  When Stan is built with
+ * <code>STAN_THREADS</code> and the index is large, it also holds the
+ * positions of the result ordered by the index they read, so that the
+ * reverse pass can add the adjoints of each index on one thread.
+ */
+struct multi_index_runs {
+  int num_runs_;
+  int size_;
+  // Zero-based index of the first element of each run
+  int* starts_;
+  // Position of each run in the result, followed by the size of the result
+  int* offsets_;
+  // Positions of the result sorted by their index, or null
+  int* order_;
+  // Zero-based indexes of the sorted positions, or null
+  int* targets_;
+};
+
+/**
+ * Return the segment of a vector or the rows of a matrix of the specified
+ * size starting at the specified element or row.
+ */
+template <typename T, require_eigen_vector_t<T>* = nullptr>
+inline auto segment_rows(T&& x, Eigen::Index start, Eigen::Index size) {
+  return x.segment(start, size);
+}
+
+template <typename T, require_eigen_matrix_dynamic_t<T>* = nullptr>
+inline auto segment_rows(T&& x, Eigen::Index start, Eigen::Index size) {
+  return x.middleRows(start, size);
+}
+
+/**
+ * Split the specified one-based indexes into runs of consecutive indexes,
+ * checking that every index is in range.
+ *
+ * @param function name of the indexing for error messages.
+ * @param name name of the indexed variable for error messages.
+ * @param ns one-based indexes.
+ * @param size size of the indexed dimension.
+ * @param stride number of coefficients read by each index.
+ * @throw std::out_of_range if an index is out of range.
+ */
+inline multi_index_runs make_multi_index_runs(const char* function,
+                                              const char* name,
+                                              const std::vector<int>& ns,
+                                              Eigen::Index size,
+                                              Eigen::Index stride = 1) {
+  auto& memalloc = stan::math::ChainableStack::instance_->memalloc_;
+  multi_index_runs runs{0, static_cast<int>(ns.size()), nullptr, nullptr,
+                        nullptr, nullptr};
+  for (int i = 0; i < runs.size_; ++i) {
+    stan::math::check_range(function, name, size, ns[i]);
+    if (i == 0 || ns[i] != ns[i - 1] + 1)
+      ++runs.num_runs_;
+  }
+  runs.starts_ = memalloc.alloc_array<int>(runs.num_runs_);
+  runs.offsets_ = memalloc.alloc_array<int>(runs.num_runs_ + 1);
+  for (int i = 0, k = 0; i < runs.size_; ++i) {
+    if (i == 0 || ns[i] != ns[i - 1] + 1) {
+      runs.starts_[k] = ns[i] - 1;
+      runs.offsets_[k] = i;
+      ++k;
+    }
+  }
+  runs.offsets_[runs.num_runs_] = runs.size_;
+#ifdef STAN_THREADS
+  if (runs.size_ * stride >= parallel_scatter_size) {
+    runs.order_ = memalloc.alloc_array<int>(runs.size_);
+    runs.targets_ = memalloc.alloc_array<int>(runs.size_);
+    std::iota(runs.order_, runs.order_ + runs.size_, 0);
+    std::stable_sort(runs.order_, runs.order_ + runs.size_,
+                     [&ns](int i, int j) { return ns[i] < ns[j]; });
+    for (int k = 0; k < runs.size_; ++k)
+      runs.targets_[k] = ns[runs.order_[k]] - 1;
+  }
+#endif
+  return runs;
+}
+
+/**
+ * Copy the elements or rows of the source selected by a multiple index to
+ * the destination, one run at a time.
+ *
+ * @param runs runs of the multiple index.
+ * @param src indexed vector or matrix.
+ * @param[out] dst result, with one element or row per index.
+ */
+template <typename Src, typename Dst>
+inline void gather(const multi_index_runs& runs, const Src& src, Dst&& dst) {
+  for (int k = 0; k < runs.num_runs_; ++k) {
+    const int run_size = runs.offsets_[k + 1] - runs.offsets_[k];
+    segment_rows(dst, runs.offsets_[k], run_size)
+        = segment_rows(src, runs.starts_[k], run_size);
+  }
+}
+
+/**
+ * Add the elements or rows of the source to the elements or rows of the
+ * destination selected by a multiple index, the adjoint of
+ * <code>gather</code>.
+ *
+ * Repeated indexes accumulate.  When the runs hold the sorted positions,
+ * the sorted positions are split over the TBB threads at boundaries
+ * between indexes, so each element of the destination is only updated by
+ * one thread.  Otherwise the runs are added one segment at a time.
+ *
+ * @param runs runs of the multiple index.
+ * @param src adjoints of the result, with one element or row per index.
+ * @param[in,out] dst adjoints of the indexed vector or matrix.
+ */
+template <typename Src, typename Dst>
+inline void scatter_add(const multi_index_runs& runs, const Src& src,
+                        Dst&& dst) {
+  if (runs.targets_ != nullptr) {
+    const int* targets = runs.targets_;
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, runs.size_),
+        [&](const tbb::blocked_range<int>& r) {
+          // a range adds the indexes whose first position is in it
+          int k = r.begin();
+          while (k > 0 && k < r.end() && targets[k] == targets[k - 1])
+            ++k;
+          if (k == r.end())
+            return;
+          for (; k < runs.size_
+                 && (k < r.end() || targets[k] == targets[k - 1]);
+               ++k) {
+            segment_rows(dst, targets[k], 1)
+                += segment_rows(src, runs.order_[k], 1);
+          }
+        });
+    return;
+  }
+  for (int k = 0; k < runs.num_runs_; ++k) {
+    const int run_size = runs.offsets_[k + 1] - runs.offsets_[k];
+    segment_rows(dst, runs.starts_[k], run_size)
+        += segment_rows(src, runs.offsets_[k], run_size);
+  }
+}
+
+}  // namespace internal
+}  // namespace model
+}  // namespace stan
+#endif
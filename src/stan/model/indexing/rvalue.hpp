@@ -171,6 +171,54 @@ inline auto rvalue(EigVec&& v, const char* name, MultiIndex&& idx) {
       std::forward<MultiIndex>(idx));
 }
 
+/**
+ * Return a non-contiguous subset of elements in a vector with indexes
+ * checked on construction, checking only the largest index and copying
+ * the elements according to the layout of the indexes.
+ *
+ * Types:  vector[multi] = vector
+ *
+ * @tparam EigVec Eigen type with either dynamic rows or columns, but not both.
+ * @param[in] v Eigen vector type.
+ * @param[in] name Name of variable
+ * @param[in] idx Checked sequence of integers.
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ */
+template <typename EigVec, require_eigen_vector_t<EigVec>* = nullptr>
+inline plain_type_t<EigVec> rvalue(EigVec&& v, const char* name,
+                                   const index_multi_checked& idx) {
+  using layout = index_multi_checked::layout;
+  idx.check_size("vector[multi] indexing", name, v.size());
+  const int ret_size = idx.ns_.size();
+  plain_type_t<EigVec> ret(ret_size);
+  if (ret_size == 0)
+    return ret;
+  const int first = idx.ns_[0] - 1;
+  switch (idx.layout_) {
+    case layout::contiguous:
+      ret = v.segment(first, ret_size);
+      break;
+    case layout::strided:
+      for (int i = 0; i < ret_size; ++i)
+        ret.coeffRef(i) = v.coeff(first + i * idx.stride_);
+      break;
+    case layout::runs:
+      idx.for_each_run([&](int pos, int start, int run_size, int step) {
+        if (step == 1)
+          ret.segment(pos, run_size) = v.segment(start, run_size);
+        else
+          ret.segment(pos, run_size).setConstant(v.coeff(start));
+      });
+      break;
+    default: {
+      const auto& v_ref = stan::math::to_ref(v);
+      for (int i = 0; i < ret_size; ++i)
+        ret.coeffRef(i) = v_ref.coeff(idx.ns_[i] - 1);
+    }
+  }
+  return ret;
+}
+
 /**
  * Return a range of a vector
  *
@@ -286,6 +334,54 @@ inline auto rvalue(EigMat&& x, const char* name, MultiIndex&& idx) {
       std::forward<MultiIndex>(idx));
 }
 
+/**
+ * Return the specified Eigen matrix at the specified multi index with
+ * indexes checked on construction, checking only the largest index and
+ * copying the rows according to the layout of the indexes.
+ *
+ * Types:  matrix[multi] = matrix
+ *
+ * @tparam EigMat Eigen type with dynamic rows and columns.
+ * @param[in] x Eigen type
+ * @param[in] name Name of variable
+ * @param[in] idx A checked multi index for selecting a set of rows.
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ */
+template <typename EigMat, require_eigen_dense_dynamic_t<EigMat>* = nullptr>
+inline plain_type_t<EigMat> rvalue(EigMat&& x, const char* name,
+                                   const index_multi_checked& idx) {
+  using layout = index_multi_checked::layout;
+  idx.check_size("matrix[multi] row indexing", name, x.rows());
+  const int ret_rows = idx.ns_.size();
+  plain_type_t<EigMat> ret(ret_rows, x.cols());
+  if (ret_rows == 0)
+    return ret;
+  const int first = idx.ns_[0] - 1;
+  switch (idx.layout_) {
+    case layout::contiguous:
+      ret = x.middleRows(first, ret_rows);
+      break;
+    case layout::strided:
+      for (int i = 0; i < ret_rows; ++i)
+        ret.row(i) = x.row(first + i * idx.stride_);
+      break;
+    case layout::runs:
+      idx.for_each_run([&](int pos, int start, int run_size, int step) {
+        if (step == 1)
+          ret.middleRows(pos, run_size) = x.middleRows(start, run_size);
+        else
+          ret.middleRows(pos, run_size).rowwise() = x.row(start);
+      });
+      break;
+    default: {
+      const auto& x_ref = stan::math::to_ref(x);
+      for (int i = 0; i < ret_rows; ++i)
+        ret.row(i) = x_ref.row(idx.ns_[i] - 1);
+    }
+  }
+  return ret;
+}
+
 /**
  * Return the result of indexing the matrix with a min index
  * returning back a block of rows min:N and all cols
@@ -806,6 +902,34 @@ inline auto rvalue(StdVec&& v, const char* name, const Idx1& idx1,
   return result;
 }
 
+/**
+ * Index an array with a multiple index checked on construction, checking
+ * only the largest index, with the remaining indices applied to each of
+ * the selected elements.
+ *
+ * Types:  array[multi, ...] = array
+ *
+ * @tparam StdVec A standard vector
+ * @tparam Idxs Index list type for the remaining indices.
+ * @param[in] v Container of list elements.
+ * @param[in] name String form of expression being evaluated.
+ * @param[in] idx1 checked first index
+ * @param[in] idxs remaining indices
+ * @return Result of indexing array.
+ * @throw std::out_of_range If any of the indices are out of bounds.
+ */
+template <typename StdVec, typename... Idxs,
+          require_std_vector_t<StdVec>* = nullptr>
+inline auto rvalue(StdVec&& v, const char* name,
+                   const index_multi_checked& idx1, Idxs&&... idxs) {
+  using inner_type = plain_type_t<decltype(rvalue(v[0], name, idxs...))>;
+  idx1.check_size("array[multi, ...] index", name, v.size());
+  std::vector<inner_type> result(idx1.ns_.size());
+  for (size_t i = 0; i < idx1.ns_.size(); ++i)
+    result[i] = rvalue(v[idx1.ns_[i] - 1], name, idxs...);
+  return result;
+}
+
 }  // namespace model
 }  // namespace stan
 #endif
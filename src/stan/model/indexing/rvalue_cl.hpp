@@ -6,9 +6,66 @@
 #include <stan/math/opencl/indexing_rev.hpp>
 #include <stan/model/indexing/index.hpp>
 #include <utility>
+#include <vector>
 
 namespace stan {
 namespace model {
+
+/**
+ * A multiple index resident on the OpenCL device.
+ *
+ * The indexes are checked to be in the range of containers of a known
+ * size and copied to the device once, on construction, so that indexing
+ * a <code>matrix_cl</code> with it neither copies nor checks every index
+ * again, as when a <code>matrix_cl<int></code> is made from an
+ * <code>index_multi</code> for every evaluation.  Indexing only checks
+ * that the container holds the largest index.  The index must outlive the
+ * reverse pass of any reverse mode indexing or assignment it is used in,
+ * so it suits indexes in the data that are made once, beside the data
+ * copied to the device.
+ */
+struct index_multi_cl {
+  // Zero-based indexes, as a column vector
+  math::matrix_cl<int> idx_;
+  int max_;
+
+  /**
+   * Construct a multiple index on the device from the specified indexes,
+   * checking that they are in the range of a container of the specified
+   * size.
+   *
+   * @param ns one-based indexes
+   * @param size size of the containers to be indexed
+   * @param name name of the indexes for error messages
+   * @throw std::out_of_range if an index is not between one and the size
+   */
+  index_multi_cl(const std::vector<int>& ns, int size,
+                 const char* name = "index")
+      : max_(0) {
+    std::vector<int> zero_based(ns.size());
+    for (size_t i = 0; i < ns.size(); ++i) {
+      math::check_range("multi index", name, size, ns[i]);
+      if (ns[i] > max_)
+        max_ = ns[i];
+      zero_based[i] = ns[i] - 1;
+    }
+    idx_ = math::to_matrix_cl(zero_based);
+  }
+
+  /**
+   * Check that a container of the specified size holds every index.
+   *
+   * @param function name of the indexing for error messages
+   * @param name name of the container for error messages
+   * @param size size of the container
+   * @throw std::out_of_range if the largest index is greater than the size
+   */
+  void check_size(const char* function, const char* name, int size) const {
+    if (max_ > 0)
+      math::check_range(function, name, size, max_);
+  }
+};
+
 namespace internal {
 
 inline auto cl_row_index(index_uni i, int rows, const char* name) {
@@ -183,6 +240,25 @@ inline auto rvalue(Expr&& expr, const char* name, const index_uni row_index,
   return res;
 }
 
+/**
+ * Index a prim kernel generator expression with a multi-index resident on
+ * the device.
+ *
+ * @tparam Expr type of the expression
+ * @param expr a prim kernel generator expression to index
+ * @param name name of value being indexed (if named, otherwise an empty string)
+ * @param row_index index, which must outlive the result
+ * @return result of indexing
+ */
+template <typename Expr,
+          require_all_kernel_expressions_and_none_scalar_t<Expr>* = nullptr>
+inline auto rvalue(Expr&& expr, const char* name,
+                   const index_multi_cl& row_index) {
+  row_index.check_size("multi indexing", name, expr.rows());
+  return math::indexing(expr, math::rowwise_broadcast(row_index.idx_),
+                        math::col_index(-1, expr.cols()));
+}
+
 // rev, without multi-index - no data races
 /**
  * Index a rev kernel generator expression with one (non multi-) index.
@@ -307,6 +383,45 @@ inline auto rvalue(Expr&& expr, const char* name,
       });
 }
 
+/**
+ * Index a rev kernel generator expression with a multi-index resident on
+ * the device.  The zero-based indexes on the device are the linear indexes
+ * of a vector, so indexing a vector launches no kernel for them.
+ *
+ * @tparam Expr type of the expression
+ * @param expr a prim kernel generator expression to index
+ * @param name name of value being indexed (if named, otherwise an empty string)
+ * @param row_index index, which must outlive the reverse pass
+ * @return result of indexing
+ */
+template <typename Expr, require_rev_kernel_expression_t<Expr>* = nullptr>
+inline auto rvalue(Expr&& expr, const char* name,
+                   const index_multi_cl& row_index) {
+  row_index.check_size("multi indexing", name, expr.rows());
+  auto row_idx_expr = math::rowwise_broadcast(row_index.idx_);
+  auto col_idx_expr = math::col_index(-1, expr.cols());
+  auto res_expr = math::indexing(expr.val_op(), row_idx_expr, col_idx_expr);
+  math::matrix_cl<double> res;
+  if (expr.cols() == 1) {
+    res = res_expr;
+    const math::matrix_cl<int>* lin_idx = &row_index.idx_;
+    return make_callback_var(
+        res, [expr, lin_idx](
+                 math::vari_value<math::matrix_cl<double>>& res_vari) mutable {
+          math::indexing_rev(expr.adj(), *lin_idx, res_vari.adj());
+        });
+  }
+  auto lin_idx_expr
+      = row_idx_expr + col_idx_expr * static_cast<int>(expr.rows());
+  math::arena_matrix_cl<int> lin_idx;
+  math::results(res, lin_idx) = math::expressions(res_expr, lin_idx_expr);
+  return make_callback_var(
+      res, [expr, lin_idx](
+               math::vari_value<math::matrix_cl<double>>& res_vari) mutable {
+        math::indexing_rev(expr.adj(), lin_idx, res_vari.adj());
+      });
+}
+
 /**
  * Index a rev kernel generator expression with two indices, at least one of
  * which is multi-index.
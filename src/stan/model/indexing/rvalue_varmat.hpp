@@ -4,6 +4,7 @@
 #include <stan/math/rev/core.hpp>
 #include <stan/math/rev/meta.hpp>
 #include <stan/model/indexing/index.hpp>
+#include <stan/model/indexing/multi_index_kernels.hpp>
 #include <stan/model/indexing/rvalue.hpp>
 #include <type_traits>
 #include <vector>
@@ -39,7 +40,8 @@ namespace model {
  */
 
 /**
- * Return a non-contiguous subset of elements in a vector.
+ * Return a non-contiguous subset of elements in a vector.  Runs of
+ * consecutive indexes are copied, and their adjoints added, as segments.
  *
  * Types:  vector[multi] = vector
  *
@@ -54,31 +56,23 @@ namespace model {
  */
 template <typename Vec, require_var_vector_t<Vec>* = nullptr>
 inline auto rvalue(Vec&& x, const char* name, const index_multi& idx) {
-  using stan::math::arena_allocator;
-  using stan::math::check_range;
   using stan::math::reverse_pass_callback;
   using stan::math::var_value;
-  using arena_std_vec = std::vector<int, arena_allocator<int>>;
-  const Eigen::Index x_size = x.size();
-  const auto ret_size = idx.ns_.size();
-  arena_t<value_type_t<Vec>> x_ret_vals(ret_size);
-  arena_std_vec row_idx(ret_size);
-  for (int i = 0; i < ret_size; ++i) {
-    check_range("vector[multi] assign range", name, x_size, idx.ns_[i]);
-    row_idx[i] = idx.ns_[i] - 1;
-    x_ret_vals.coeffRef(i) = x.vi_->val_.coeff(row_idx[i]);
-  }
+  const auto runs = internal::make_multi_index_runs(
+      "vector[multi] assign range", name, idx.ns_, x.size());
+  arena_t<value_type_t<Vec>> x_ret_vals(idx.ns_.size());
+  internal::gather(runs, x.val(), x_ret_vals);
   var_value<plain_type_t<value_type_t<Vec>>> x_ret(x_ret_vals);
-  reverse_pass_callback([x, x_ret, row_idx]() mutable {
-    for (Eigen::Index i = 0; i < row_idx.size(); ++i) {
-      x.adj().coeffRef(row_idx[i]) += x_ret.adj().coeff(i);
-    }
+  reverse_pass_callback([x, x_ret, runs]() mutable {
+    internal::scatter_add(runs, x_ret.adj(), x.adj());
   });
   return x_ret;
 }
 
 /**
- * Return a non-contiguous subset of elements in a matrix.
+ * Return a non-contiguous subset of elements in a matrix.  Runs of
+ * consecutive row indexes are copied, and their adjoints added, as blocks
+ * of rows.
  *
  * Types:  matrix[multi] = matrix
  *
@@ -91,24 +85,15 @@ inline auto rvalue(Vec&& x, const char* name, const index_multi& idx) {
  */
 template <typename VarMat, require_var_dense_dynamic_t<VarMat>* = nullptr>
 inline auto rvalue(VarMat&& x, const char* name, const index_multi& idx) {
-  using stan::math::arena_allocator;
-  using stan::math::check_range;
   using stan::math::reverse_pass_callback;
   using stan::math::var_value;
-  using arena_std_vec = std::vector<int, arena_allocator<int>>;
-  const auto ret_rows = idx.ns_.size();
-  arena_t<value_type_t<VarMat>> x_ret_vals(ret_rows, x.cols());
-  arena_std_vec row_idx(ret_rows);
-  for (int i = 0; i < ret_rows; ++i) {
-    check_range("matrix[multi] subset range", name, x.rows(), idx.ns_[i]);
-    row_idx[i] = idx.ns_[i] - 1;
-    x_ret_vals.row(i) = x.val().row(row_idx[i]);
-  }
+  const auto runs = internal::make_multi_index_runs(
+      "matrix[multi] subset range", name, idx.ns_, x.rows(), x.cols());
+  arena_t<value_type_t<VarMat>> x_ret_vals(idx.ns_.size(), x.cols());
+  internal::gather(runs, x.val(), x_ret_vals);
   var_value<plain_type_t<value_type_t<VarMat>>> x_ret(x_ret_vals);
-  reverse_pass_callback([x, x_ret, row_idx]() mutable {
-    for (Eigen::Index i = 0; i < row_idx.size(); ++i) {
-      x.adj().row(row_idx[i]) += x_ret.adj().row(i);
-    }
+  reverse_pass_callback([x, x_ret, runs]() mutable {
+    internal::scatter_add(runs, x_ret.adj(), x.adj());
   });
   return x_ret;
 }
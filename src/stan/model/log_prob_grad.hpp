@@ -3,15 +3,37 @@
 
 #include <stan/math/rev.hpp>
 #include <iostream>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace stan {
 namespace model {
+namespace internal {
+
+/**
+ * Trait for models that compute their gradient without autodiff, such
+ * as <code>analytic_gradient_model</code>, through a member
+ * <code>double analytic_log_prob_grad(const Eigen::VectorXd&,
+ * Eigen::VectorXd&) const</code>.
+ */
+template <class M, typename = void>
+struct has_analytic_gradient : std::false_type {};
+
+template <class M>
+struct has_analytic_gradient<
+    M, std::void_t<decltype(std::declval<const M&>().analytic_log_prob_grad(
+           std::declval<const Eigen::VectorXd&>(),
+           std::declval<Eigen::VectorXd&>()))>> : std::true_type {};
+
+}  // namespace internal
 
 /**
  * Compute the gradient using reverse-mode automatic
  * differentiation, writing the result into the specified
- * gradient, using the specified perturbation.
+ * gradient, using the specified perturbation.  Models with an
+ * analytic gradient, such as <code>analytic_gradient_model</code>, have
+ * it computed directly, without autodiff.
  *
  * @tparam propto True if calculation is up to proportion
  * (double-only terms dropped).
@@ -31,6 +53,14 @@ double log_prob_grad(const M& model, std::vector<double>& params_r,
                      std::ostream* msgs = 0) {
   using stan::math::var;
   using std::vector;
+  if constexpr (internal::has_analytic_gradient<M>::value) {
+    Eigen::VectorXd grad;
+    const double lp = model.analytic_log_prob_grad(
+        Eigen::Map<const Eigen::VectorXd>(params_r.data(), params_r.size()),
+        grad);
+    gradient.assign(grad.data(), grad.data() + grad.size());
+    return lp;
+  }
   try {
     vector<var> ad_params_r(params_r.size());
     for (size_t i = 0; i < model.num_params_r(); ++i) {
@@ -52,7 +82,9 @@ double log_prob_grad(const M& model, std::vector<double>& params_r,
 /**
  * Compute the gradient using reverse-mode automatic
  * differentiation, writing the result into the specified
- * gradient, using the specified perturbation.
+ * gradient, using the specified perturbation.  Models with an
+ * analytic gradient, such as <code>analytic_gradient_model</code>, have
+ * it computed directly, without autodiff.
  *
  * @tparam propto True if calculation is up to proportion
  * (double-only terms dropped).
@@ -70,6 +102,9 @@ double log_prob_grad(const M& model, Eigen::VectorXd& params_r,
                      Eigen::VectorXd& gradient, std::ostream* msgs = 0) {
   using stan::math::var;
   using std::vector;
+  if constexpr (internal::has_analytic_gradient<M>::value) {
+    return model.analytic_log_prob_grad(params_r, gradient);
+  }
   try {
     Eigen::Matrix<var, Eigen::Dynamic, 1> ad_params_r(params_r.size());
     for (size_t i = 0; i < model.num_params_r(); ++i) {
@@ -0,0 +1,115 @@
+#ifndef STAN_MODEL_LOG_PROB_GRAD_BATCH_HPP
+#define STAN_MODEL_LOG_PROB_GRAD_BATCH_HPP
+
+#include <stan/math/rev/core.hpp>
+#include <stan/math/rev/functor/gradient.hpp>
+#include <stan/model/model_functional.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <tbb/blocked_range.h>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * Compute the log density and its gradient at each of several points,
+ * given as the columns of a matrix, using reverse-mode automatic
+ * differentiation.
+ *
+ * The points are independent, so they are evaluated in parallel on the
+ * TBB threads when Stan is built with <code>STAN_THREADS</code>, which
+ * gives each thread its own autodiff stack, and serially otherwise.  Each
+ * point is differentiated in a nested scope of the autodiff stack of the
+ * thread evaluating it, so this may be called while the caller holds
+ * autodiff variables.  The messages written at each point are appended
+ * to the message stream in the order of the points.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to
+ * the log probability.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r Unconstrained parameters, one point per column.
+ * @param[out] log_prob Log density at each point.
+ * @param[out] gradients Gradient at each point, one per column.
+ * @param[in,out] msgs stream to which messages are written, or
+ * <code>nullptr</code> to discard them
+ * @throw std::exception if the log density throws at any point
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+void log_prob_grad_batch(const M& model, const Eigen::MatrixXd& params_r,
+                         Eigen::VectorXd& log_prob, Eigen::MatrixXd& gradients,
+                         std::ostream* msgs = 0) {
+  const Eigen::Index num_points = params_r.cols();
+  log_prob.resize(num_points);
+  gradients.resize(params_r.rows(), num_points);
+  std::vector<std::string> point_msgs(msgs == nullptr ? 0 : num_points);
+
+  auto evaluate = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    std::stringstream ss;
+    model_functional<M, propto, jacobian_adjust_transform> f(
+        model, msgs == nullptr ? nullptr : &ss);
+    Eigen::VectorXd x(params_r.rows());
+    Eigen::VectorXd grad(params_r.rows());
+    for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+      x = params_r.col(i);
+      stan::math::gradient(f, x, log_prob(i), grad);
+      gradients.col(i) = grad;
+      if (msgs != nullptr) {
+        point_msgs[i] = ss.str();
+        ss.str("");
+      }
+    }
+  };
+  internal::parallel_for_if_threads(Eigen::Index{0}, num_points, evaluate);
+
+  for (const std::string& msg : point_msgs)
+    *msgs << msg;
+}
+
+/**
+ * Compute the log density and its gradient at each of several points,
+ * with the normalizing constants and the Jacobian included as specified
+ * at run time.
+ *
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] propto True if calculation is up to proportion.
+ * @param[in] jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to
+ * the log probability.
+ * @param[in] params_r Unconstrained parameters, one point per column.
+ * @param[out] log_prob Log density at each point.
+ * @param[out] gradients Gradient at each point, one per column.
+ * @param[in,out] msgs stream to which messages are written, or
+ * <code>nullptr</code> to discard them
+ * @throw std::exception if the log density throws at any point
+ */
+template <class M>
+void log_prob_grad_batch(const M& model, bool propto,
+                         bool jacobian_adjust_transform,
+                         const Eigen::MatrixXd& params_r,
+                         Eigen::VectorXd& log_prob, Eigen::MatrixXd& gradients,
+                         std::ostream* msgs = 0) {
+  if (propto && jacobian_adjust_transform)
+    log_prob_grad_batch<true, true>(model, params_r, log_prob, gradients,
+                                    msgs);
+  else if (propto && !jacobian_adjust_transform)
+    log_prob_grad_batch<true, false>(model, params_r, log_prob, gradients,
+                                     msgs);
+  else if (!propto && jacobian_adjust_transform)
+    log_prob_grad_batch<false, true>(model, params_r, log_prob, gradients,
+                                     msgs);
+  else
+    log_prob_grad_batch<false, false>(model, params_r, log_prob, gradients,
+                                      msgs);
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -0,0 +1,77 @@
+#ifndef STAN_MODEL_LOG_PROB_GRAD_CL_HPP
+#define STAN_MODEL_LOG_PROB_GRAD_CL_HPP
+#ifdef STAN_OPENCL
+
+#include <stan/math/opencl/rev.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace stan {
+namespace model {
+namespace internal {
+
+/**
+ * Trait for models that take their parameters and write their gradient
+ * on the OpenCL device, through a member
+ * <code>double device_log_prob_grad(const math::matrix_cl<double>&,
+ * math::matrix_cl<double>&) const</code>.
+ */
+template <class M, typename = void>
+struct has_device_gradient : std::false_type {};
+
+template <class M>
+struct has_device_gradient<
+    M, std::void_t<decltype(std::declval<const M&>().device_log_prob_grad(
+           std::declval<const math::matrix_cl<double>&>(),
+           std::declval<math::matrix_cl<double>&>()))>> : std::true_type {};
+
+}  // namespace internal
+
+/**
+ * Compute the log density and its gradient at parameters held on the
+ * OpenCL device, writing the gradient on the device.  This is the model
+ * entry point a sampler with its state resident on the device evaluates
+ * the model through.
+ *
+ * Models with a member <code>device_log_prob_grad</code> are evaluated
+ * without leaving the device.  Other models, including every model stanc
+ * generates today, read their parameters from the host, so the
+ * parameters are copied to the host, the gradient is computed by
+ * <code>log_prob_grad</code> and copied back.  Such models gain nothing
+ * from a device-resident sampler, which pays two copies per gradient.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to
+ * the log probability.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r Real-valued parameters, as a column vector.
+ * @param[out] gradient Column vector into which gradient is written.
+ * @param[in,out] msgs
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+double log_prob_grad_cl(const M& model,
+                        const math::matrix_cl<double>& params_r,
+                        math::matrix_cl<double>& gradient,
+                        std::ostream* msgs = 0) {
+  if constexpr (internal::has_device_gradient<M>::value) {
+    return model.device_log_prob_grad(params_r, gradient);
+  } else {
+    Eigen::VectorXd host_params_r
+        = math::from_matrix_cl<Eigen::VectorXd>(params_r);
+    Eigen::VectorXd host_gradient;
+    const double lp = log_prob_grad<propto, jacobian_adjust_transform>(
+        model, host_params_r, host_gradient, msgs);
+    gradient = math::to_matrix_cl(host_gradient);
+    return lp;
+  }
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
+#endif
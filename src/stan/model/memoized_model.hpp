@@ -0,0 +1,269 @@
+#ifndef STAN_MODEL_MEMOIZED_MODEL_HPP
+#define STAN_MODEL_MEMOIZED_MODEL_HPP
+
+#include <stan/math/rev.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * <code>memoized_model</code> wraps a model so that the last few
+ * evaluations of its log density, and of its gradient, are remembered
+ * and returned again when the log density is asked for at the same
+ * unconstrained parameters.  Algorithms come back to the points they
+ * have already evaluated more often than it seems: NUTS starts every
+ * transition at the point where the last one ended, initialization and
+ * the Laplace approximation evaluate the gradient at the mode or the
+ * initial values once more, and a line search restarting from its best
+ * point repeats that evaluation.
+ *
+ * Evaluations with autodiff variables are remembered with the gradient
+ * of the log density; a remembered one is returned as a variable with
+ * precomputed gradients, so the caller's autodiff proceeds as if the
+ * model had been evaluated.  Evaluations with doubles are remembered
+ * separately, because dropping the constants of the density does not
+ * drop the same terms for both.  Evaluations with other scalar types,
+ * such as those of higher order autodiff, are passed to the model.
+ *
+ * The points are found by a hash of the bytes of the parameters and
+ * then compared exactly, so a point is only found again if it is equal
+ * to the bit.  Evaluations that throw are not remembered, and messages
+ * the model writes are only written when it is evaluated.
+ *
+ * The wrapper can be used by several threads at once.  Its other
+ * methods are those of the wrapped model.
+ *
+ * @tparam M type of model
+ */
+template <class M>
+class memoized_model {
+ public:
+  /**
+   * Construct a wrapper remembering the specified number of
+   * evaluations, which replace each other oldest first.
+   *
+   * @param[in] model model, which must outlive the wrapper
+   * @param[in] capacity number of evaluations remembered; none are if
+   *   zero
+   */
+  explicit memoized_model(const M& model, size_t capacity = 4)
+      : model_(model), entries_(capacity) {}
+
+  /**
+   * Return the wrapped model.
+   */
+  const M& model() const noexcept { return model_; }
+
+  size_t capacity() const noexcept { return entries_.size(); }
+
+  /**
+   * Return the number of evaluations of the log density that were found
+   * in the cache.
+   */
+  size_t num_hits() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_hits_;
+  }
+
+  /**
+   * Return the number of evaluations of the log density looked for in
+   * the cache, found or not.
+   */
+  size_t num_lookups() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_lookups_;
+  }
+
+  /**
+   * Return the fraction of the evaluations looked for in the cache that
+   * were found, or zero if none were looked for.
+   */
+  double hit_rate() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_lookups_ == 0 ? 0
+                             : static_cast<double>(num_hits_) / num_lookups_;
+  }
+
+  /**
+   * Forget the remembered evaluations and the counts of lookups.
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (entry& e : entries_)
+      e.used = false;
+    next_ = 0;
+    num_hits_ = 0;
+    num_lookups_ = 0;
+  }
+
+  /**
+   * Return the log density of the wrapped model, from the cache if it
+   * was evaluated at the same parameters, taking the same arguments as
+   * the <code>log_prob</code> of the model.
+   *
+   * @tparam propto true to drop the constant terms
+   * @tparam jacobian true to include the Jacobian adjustment
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] args remaining arguments of <code>log_prob</code>
+   */
+  template <bool propto, bool jacobian, typename VecR, typename... Args>
+  auto log_prob(VecR& params_r, Args&&... args) const {
+    using scalar_t = std::decay_t<decltype(params_r[0])>;
+    constexpr bool is_var = std::is_same<scalar_t, stan::math::var>::value;
+    if constexpr (!is_var && !std::is_same<scalar_t, double>::value) {
+      return model_.template log_prob<propto, jacobian>(
+          params_r, std::forward<Args>(args)...);
+    } else {
+      if (entries_.empty())
+        return model_.template log_prob<propto, jacobian>(
+            params_r, std::forward<Args>(args)...);
+      const size_t size = params_r.size();
+      std::vector<double> x(size);
+      for (size_t i = 0; i < size; ++i)
+        x[i] = stan::math::value_of(params_r[i]);
+      const key k{hash(x), propto, jacobian, is_var};
+      double lp;
+      std::vector<double> grad;
+      if (!find(k, x, lp, grad)) {
+        if constexpr (is_var) {
+          stan::math::nested_rev_autodiff nested;
+          std::decay_t<VecR> x_var(params_r.size());
+          for (size_t i = 0; i < size; ++i)
+            x_var[i] = x[i];
+          stan::math::var lp_var = model_.template log_prob<propto, jacobian>(
+              x_var, std::forward<Args>(args)...);
+          stan::math::grad(lp_var.vi_);
+          lp = lp_var.val();
+          grad.resize(size);
+          for (size_t i = 0; i < size; ++i)
+            grad[i] = x_var[i].adj();
+        } else {
+          lp = model_.template log_prob<propto, jacobian>(
+              params_r, std::forward<Args>(args)...);
+        }
+        insert(k, x, lp, grad);
+      }
+      if constexpr (is_var) {
+        std::vector<stan::math::var> operands(size);
+        for (size_t i = 0; i < size; ++i)
+          operands[i] = params_r[i];
+        return stan::math::precomputed_gradients(lp, operands, grad);
+      } else {
+        return lp;
+      }
+    }
+  }
+
+  size_t num_params_r() const { return model_.num_params_r(); }
+
+  template <typename... Args>
+  void get_param_names(Args&&... args) const {
+    model_.get_param_names(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void get_dims(Args&&... args) const {
+    model_.get_dims(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void constrained_param_names(Args&&... args) const {
+    model_.constrained_param_names(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void unconstrained_param_names(Args&&... args) const {
+    model_.unconstrained_param_names(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void transform_inits(Args&&... args) const {
+    model_.transform_inits(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void unconstrain_array(Args&&... args) const {
+    model_.unconstrain_array(std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  void write_array(Args&&... args) const {
+    model_.write_array(std::forward<Args>(args)...);
+  }
+
+ private:
+  struct key {
+    std::uint64_t hash;
+    bool propto;
+    bool jacobian;
+    bool autodiff;
+
+    bool operator==(const key& other) const {
+      return hash == other.hash && propto == other.propto
+             && jacobian == other.jacobian && autodiff == other.autodiff;
+    }
+  };
+
+  struct entry {
+    bool used = false;
+    key k{0, false, false, false};
+    std::vector<double> x;
+    double lp = 0;
+    std::vector<double> grad;
+  };
+
+  const M& model_;
+  mutable std::mutex mutex_;
+  mutable std::vector<entry> entries_;
+  mutable size_t next_ = 0;
+  mutable size_t num_hits_ = 0;
+  mutable size_t num_lookups_ = 0;
+
+  // 64 bit FNV-1a hash of the bytes of the parameters
+  static std::uint64_t hash(const std::vector<double>& x) {
+    std::uint64_t h = 14695981039346656037ULL;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(x.data());
+    for (size_t i = 0; i < x.size() * sizeof(double); ++i) {
+      h ^= p[i];
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  bool find(const key& k, const std::vector<double>& x, double& lp,
+            std::vector<double>& grad) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_lookups_;
+    for (const entry& e : entries_) {
+      if (e.used && e.k == k && e.x == x) {
+        ++num_hits_;
+        lp = e.lp;
+        grad = e.grad;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void insert(const key& k, const std::vector<double>& x, double lp,
+              const std::vector<double>& grad) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entry& e = entries_[next_];
+    next_ = (next_ + 1) % entries_.size();
+    e.used = true;
+    e.k = k;
+    e.x = x;
+    e.lp = lp;
+    e.grad = grad;
+  }
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
@@ -4,8 +4,12 @@
 #ifdef STAN_MODEL_FVAR_VAR
 #include <stan/math/mix.hpp>
 #endif
+#include <stan/io/deserializer.hpp>
+#include <stan/io/serializer.hpp>
 #include <stan/io/var_context.hpp>
 #include <stan/math/rev/core.hpp>
+#include <stan/model/log_prob_grad_batch.hpp>
+#include <stan/model/unconstrain_array_batch.hpp>
 #include <stan/model/prob_grad.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <ostream>
@@ -64,6 +68,84 @@ class model_base : public prob_grad {
    */
   virtual std::vector<std::string> model_compile_info() const = 0;
 
+  /**
+   * Return the number of values the data snapshot of the model holds, or
+   * zero if the model does not support data snapshots.  A snapshot holds
+   * every data member of a constructed model, transformed data included,
+   * with integers as doubles, so that a model made from it does not
+   * repeat the computation of its transformed data.  Snapshots are saved
+   * and loaded by <code>save_model_snapshot</code> and
+   * <code>load_model_snapshot</code>.
+   *
+   * @return number of values of the data snapshot
+   */
+  virtual size_t data_snapshot_size() const { return 0; }
+
+  /**
+   * Write the data members of the model, <code>data_snapshot_size()</code>
+   * values, to the specified serializer.
+   *
+   * @param[in,out] out serializer for the values
+   */
+  virtual void write_data_snapshot(io::serializer<double>& out) const {}
+
+  /**
+   * Replace the data members of the model with those read from the
+   * specified deserializer, in the order they were written by
+   * <code>write_data_snapshot</code>.
+   *
+   * @param[in,out] in deserializer of the values
+   * @return true if the model supports data snapshots and read them
+   */
+  virtual bool read_data_snapshot(io::deserializer<double>& in) {
+    return false;
+  }
+
+  /**
+   * Set the specified sequences to the names and dimensions of the data
+   * variables of the model, in the order they were declared, or clear
+   * them if the model does not support rebinding its data.  The
+   * dimensions are those of the data the model was constructed with.
+   *
+   * @param[in,out] names names of the data variables
+   * @param[in,out] dimss dimensions of each data variable
+   */
+  virtual void get_data_dims(std::vector<std::string>& names,
+                             std::vector<std::vector<size_t> >& dimss) const {
+    names.clear();
+    dimss.clear();
+  }
+
+  /**
+   * Replace the data members of the model with data of the same
+   * dimensions read from the specified context, validating them and
+   * recomputing the transformed data as the constructor does, without
+   * reallocating the model.  Callers check the dimensions first, as
+   * <code>stan::services::util::rebind_data</code> does.  A model that
+   * throws while rebinding must not be used again.
+   *
+   * @param[in] context data of the dimensions from
+   * <code>get_data_dims</code>
+   * @param[in,out] msgs stream to which messages are written
+   * @return true if the model supports rebinding and read the data
+   * @throw std::exception if the data fail the checks of the model
+   */
+  virtual bool rebind_data(const io::var_context& context,
+                           std::ostream* msgs = nullptr) {
+    return false;
+  }
+
+  /**
+   * Return the profiles of the named regions of the model, the
+   * <code>profile</code> blocks of its program, or null if the model
+   * does not record them.  The profiles hold the time, autodiff passes
+   * and autodiff stack of each region, one entry per region and thread.
+   * They are written by <code>stan::services::util::write_profiles</code>.
+   *
+   * @return profiles of the model, or null
+   */
+  virtual const math::profile_map* profile_data() const { return nullptr; }
+
   /**
    * Set the specified argument to sequence of parameters, transformed
    * parameters, and generated quantities in the order in which they
@@ -387,6 +469,57 @@ class model_base : public prob_grad {
                                  Eigen::VectorXd& params_r,
                                  std::ostream* msgs = nullptr) const = 0;
 
+  /**
+   * Compute the log density and its gradient at each of several
+   * unconstrained points, given as the columns of a matrix, with
+   * normalizing constants and the Jacobian adjustment included as
+   * specified.
+   *
+   * <p>The default implementation evaluates the points independently,
+   * in parallel when Stan is built with <code>STAN_THREADS</code>, with
+   * <code>stan::model::log_prob_grad_batch</code>.  Models able to
+   * evaluate many points at once, for instance with vector instructions
+   * or on a GPU, can override it.
+   *
+   * @param[in] propto `true` if normalizing constants should be dropped
+   * @param[in] jacobian `true` if the log Jacobian adjustment is
+   * included
+   * @param[in] params_r unconstrained parameters, one point per column
+   * @param[out] log_prob log density at each point
+   * @param[out] gradients gradient at each point, one per column
+   * @param[in,out] msgs stream to which messages are written
+   */
+  virtual void log_prob_grad_batch(bool propto, bool jacobian,
+                                   const Eigen::MatrixXd& params_r,
+                                   Eigen::VectorXd& log_prob,
+                                   Eigen::MatrixXd& gradients,
+                                   std::ostream* msgs = nullptr) const {
+    stan::model::log_prob_grad_batch(*this, propto, jacobian, params_r,
+                                     log_prob, gradients, msgs);
+  }
+
+  /**
+   * Convert each of several draws of the constrained parameters, given as
+   * the columns of a matrix, to the unconstrained scale, as
+   * <code>unconstrain_array</code> does for one.
+   *
+   * <p>The default implementation converts the draws independently, in
+   * parallel, with <code>stan::model::unconstrain_array_batch</code>.
+   * Models able to convert many draws at once, for instance with vector
+   * instructions, can override it.
+   *
+   * @param[in] params_r_constrained constrained parameters, one draw per
+   * column
+   * @param[out] params_r unconstrained parameters, one draw per column
+   * @param[in,out] msgs stream to which messages are written
+   */
+  virtual void unconstrain_array_batch(
+      const Eigen::MatrixXd& params_r_constrained, Eigen::MatrixXd& params_r,
+      std::ostream* msgs = nullptr) const {
+    stan::model::unconstrain_array_batch(*this, params_r_constrained,
+                                         params_r, msgs);
+  }
+
   // TODO(carpenter): cut redundant std::vector versions from here ===
 
   /**
@@ -148,6 +148,23 @@ class model_base_crtp : public stan::model::model_base {
                                                           params_r, msgs);
   }
 
+  void log_prob_grad_batch(bool propto, bool jacobian,
+                           const Eigen::MatrixXd& params_r,
+                           Eigen::VectorXd& log_prob,
+                           Eigen::MatrixXd& gradients,
+                           std::ostream* msgs = nullptr) const override {
+    stan::model::log_prob_grad_batch(*static_cast<const M*>(this), propto,
+                                     jacobian, params_r, log_prob, gradients,
+                                     msgs);
+  }
+
+  void unconstrain_array_batch(const Eigen::MatrixXd& params_r_constrained,
+                               Eigen::MatrixXd& params_r,
+                               std::ostream* msgs = nullptr) const override {
+    stan::model::unconstrain_array_batch(*static_cast<const M*>(this),
+                                         params_r_constrained, params_r, msgs);
+  }
+
   // TODO(carpenter): remove redundant std::vector methods below here =====
   // ======================================================================
 
@@ -7,8 +7,9 @@
 namespace stan {
 namespace model {
 
-// Interface for automatic differentiation of models
-template <class M>
+// Interface for automatic differentiation of models, by default of the
+// log density up to a constant with the Jacobian adjustment
+template <class M, bool propto = true, bool jacobian = true>
 struct model_functional {
   const M& model;
   std::ostream* o;
@@ -18,7 +19,7 @@ struct model_functional {
   template <typename T>
   T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
     // log_prob() requires non-const but doesn't modify its argument
-    return model.template log_prob<true, true, T>(
+    return model.template log_prob<propto, jacobian, T>(
         const_cast<Eigen::Matrix<T, -1, 1>&>(x), o);
   }
 };
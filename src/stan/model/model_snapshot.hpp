@@ -0,0 +1,291 @@
+#ifndef STAN_MODEL_MODEL_SNAPSHOT_HPP
+#define STAN_MODEL_MODEL_SNAPSHOT_HPP
+
+#include <stan/io/deserializer.hpp>
+#include <stan/io/serializer.hpp>
+#include <stan/io/var_context.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * A snapshot of the data members of a constructed model, memory mapped
+ * from a file, so that a model can be made without computing its
+ * transformed data again.  Its values are read straight from the
+ * mapping by the deserializer it returns.
+ *
+ * The file starts with the 8 byte magic string <code>MAGIC</code>, then
+ * the key of the snapshot, as a length followed by that many bytes, and
+ * the number of values, all sizes being unsigned 64 bit integers.  The
+ * values, doubles, follow at the first offset that is a multiple of
+ * <code>ALIGNMENT</code>.  Everything is written in the byte order of
+ * the machine.
+ *
+ * The key, made by <code>model_snapshot_key</code>, identifies the model
+ * and its data, so that a snapshot is only loaded into the model and
+ * data it was saved from.
+ */
+class model_snapshot {
+ public:
+  static constexpr const char* MAGIC = "STANSNP1";
+  static constexpr std::uint64_t ALIGNMENT = 64;
+
+  /**
+   * Map the specified file.
+   *
+   * @param filename name of a snapshot file
+   * @throw std::invalid_argument if the file is not a snapshot or is
+   * truncated
+   */
+  explicit model_snapshot(const std::string& filename)
+      : region_(map_file(filename)),
+        begin_(static_cast<const char*>(region_.get_address())),
+        size_(region_.get_size()) {
+    const std::string error
+        = "Error: file " + filename + " is not a model snapshot";
+    std::uint64_t pos = 0;
+    auto read_size = [&]() {
+      std::uint64_t value;
+      if (size_ < pos + sizeof(value))
+        throw std::invalid_argument(error);
+      std::memcpy(&value, begin_ + pos, sizeof(value));
+      pos += sizeof(value);
+      return value;
+    };
+    if (size_ < 8 || std::memcmp(begin_, MAGIC, 8) != 0)
+      throw std::invalid_argument(error);
+    pos = 8;
+    const std::uint64_t key_size = read_size();
+    if (size_ - pos < key_size)
+      throw std::invalid_argument(error);
+    key_.assign(begin_ + pos, key_size);
+    pos += key_size;
+    num_values_ = read_size();
+    offset_ = align(pos);
+    if (size_ < offset_
+        || (size_ - offset_) / sizeof(double) < num_values_)
+      throw std::invalid_argument(error);
+  }
+
+  /**
+   * Return the key the snapshot was saved with.
+   */
+  const std::string& key() const noexcept { return key_; }
+
+  /**
+   * Return the number of values of the snapshot.
+   */
+  size_t size() const noexcept { return num_values_; }
+
+  /**
+   * Return the values of the snapshot, in the mapping.
+   */
+  const double* data() const noexcept {
+    return reinterpret_cast<const double*>(begin_ + offset_);
+  }
+
+  /**
+   * Return a deserializer of the values of the snapshot, reading from
+   * the mapping, which must outlive it.
+   */
+  io::deserializer<double> deserializer() const {
+    return io::deserializer<double>(
+        Eigen::Map<const Eigen::VectorXd>(data(), num_values_), no_ints_);
+  }
+
+  /**
+   * Write a snapshot file.
+   *
+   * @param filename name of the file
+   * @param key key of the snapshot
+   * @param values values of the snapshot
+   * @throw std::runtime_error if the file cannot be written
+   */
+  static void write(const std::string& filename, const std::string& key,
+                    const std::vector<double>& values) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    auto write_size = [&](std::uint64_t value) {
+      out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    };
+    out.write(MAGIC, 8);
+    write_size(key.size());
+    out.write(key.data(), key.size());
+    write_size(values.size());
+    const std::uint64_t pos = 8 + 2 * sizeof(std::uint64_t) + key.size();
+    const std::string padding(align(pos) - pos, '\0');
+    out.write(padding.data(), padding.size());
+    out.write(reinterpret_cast<const char*>(values.data()),
+              values.size() * sizeof(double));
+    if (!out)
+      throw std::runtime_error("Error: could not write model snapshot "
+                               + filename);
+  }
+
+ private:
+  boost::interprocess::mapped_region region_;
+  const char* begin_;
+  std::uint64_t size_;
+  std::string key_;
+  std::uint64_t num_values_ = 0;
+  std::uint64_t offset_ = 0;
+  std::vector<int> no_ints_;
+
+  static boost::interprocess::mapped_region map_file(
+      const std::string& filename) {
+    namespace bip = boost::interprocess;
+    if (std::ifstream(filename, std::ios::binary | std::ios::ate).tellg()
+        <= 0)
+      throw std::invalid_argument("Error: file " + filename
+                                  + " is not a model snapshot");
+    bip::file_mapping file(filename.c_str(), bip::read_only);
+    return bip::mapped_region(file, bip::read_only);
+  }
+
+  static std::uint64_t align(std::uint64_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+};
+
+/**
+ * Return a 64 bit FNV-1a hash of the names, dimensions and values of the
+ * variables of a context, as 16 hexadecimal digits.  The variables are
+ * hashed in the order of their names, so the hash does not depend on
+ * the order in which the context lists them.
+ *
+ * @param context data
+ * @return hash of the data
+ */
+inline std::string data_hash(const io::var_context& context) {
+  std::uint64_t hash = 14695981039346656037ULL;
+  auto add = [&](const void* bytes, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < size; ++i) {
+      hash ^= p[i];
+      hash *= 1099511628211ULL;
+    }
+  };
+  auto add_variable = [&](char type, const std::string& name,
+                          const std::vector<size_t>& dims) {
+    add(&type, 1);
+    const std::uint64_t name_size = name.size();
+    add(&name_size, sizeof(name_size));
+    add(name.data(), name.size());
+    const std::uint64_t num_dims = dims.size();
+    add(&num_dims, sizeof(num_dims));
+    for (size_t d : dims) {
+      const std::uint64_t dim = d;
+      add(&dim, sizeof(dim));
+    }
+  };
+
+  std::vector<std::string> names_i;
+  context.names_i(names_i);
+  std::sort(names_i.begin(), names_i.end());
+  for (const std::string& name : names_i) {
+    add_variable('I', name, context.dims_i(name));
+    const std::vector<int> values = context.vals_i(name);
+    add(values.data(), values.size() * sizeof(int));
+  }
+  std::vector<std::string> names_r;
+  context.names_r(names_r);
+  std::sort(names_r.begin(), names_r.end());
+  for (const std::string& name : names_r) {
+    if (std::binary_search(names_i.begin(), names_i.end(), name))
+      continue;
+    add_variable('R', name, context.dims_r(name));
+    const std::vector<double> values = context.vals_r(name);
+    add(values.data(), values.size() * sizeof(double));
+  }
+
+  std::stringstream digits;
+  digits << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return digits.str();
+}
+
+/**
+ * Return the key of the snapshot of a model constructed from the
+ * specified data: the name of the model, its compile information and
+ * the hash of the data, one per line.
+ *
+ * @tparam Model type of model
+ * @param model model
+ * @param context data the model was constructed from
+ * @return key of the snapshot
+ */
+template <class Model>
+std::string model_snapshot_key(const Model& model,
+                               const io::var_context& context) {
+  std::stringstream key;
+  key << model.model_name() << '\n';
+  for (const std::string& info : model.model_compile_info())
+    key << info << '\n';
+  key << "data_hash = " << data_hash(context);
+  return key.str();
+}
+
+/**
+ * Save the snapshot of the data members of a model to a file.
+ *
+ * @tparam Model type of model
+ * @param filename name of the file
+ * @param model model
+ * @param key key of the snapshot, from <code>model_snapshot_key</code>
+ * @return false if the model does not support data snapshots, in which
+ * case no file is written
+ * @throw std::runtime_error if the file cannot be written
+ */
+template <class Model>
+bool save_model_snapshot(const std::string& filename, const Model& model,
+                         const std::string& key) {
+  std::vector<double> values(model.data_snapshot_size());
+  if (values.empty())
+    return false;
+  io::serializer<double> out(values);
+  model.write_data_snapshot(out);
+  model_snapshot::write(filename, key, values);
+  return true;
+}
+
+/**
+ * Load the data members of a model from a snapshot file, if the file
+ * exists and was saved with the specified key from a model with as many
+ * data values.  The model is typically constructed without computing
+ * its transformed data, which the snapshot then provides.  A snapshot
+ * that cannot be loaded leaves the model unchanged, so the caller can
+ * compute the transformed data and save a new snapshot.
+ *
+ * @tparam Model type of model
+ * @param filename name of the file
+ * @param model model
+ * @param key key of the snapshot, from <code>model_snapshot_key</code>
+ * @return true if the snapshot was loaded
+ * @throw std::invalid_argument if the file exists but is not a snapshot
+ */
+template <class Model>
+bool load_model_snapshot(const std::string& filename, Model& model,
+                         const std::string& key) {
+  if (!std::ifstream(filename, std::ios::binary))
+    return false;
+  model_snapshot snapshot(filename);
+  if (snapshot.key() != key || snapshot.size() != model.data_snapshot_size()
+      || snapshot.size() == 0)
+    return false;
+  io::deserializer<double> in = snapshot.deserializer();
+  return model.read_data_snapshot(in);
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
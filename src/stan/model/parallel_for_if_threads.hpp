@@ -0,0 +1,48 @@
+#ifndef STAN_MODEL_PARALLEL_FOR_IF_THREADS_HPP
+#define STAN_MODEL_PARALLEL_FOR_IF_THREADS_HPP
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace stan {
+namespace model {
+namespace internal {
+
+/**
+ * True if Stan is built with <code>STAN_THREADS</code>, which gives each
+ * thread its own autodiff stack, so that threads may differentiate
+ * concurrently.  Without it every thread would share one autodiff stack.
+ */
+#ifdef STAN_THREADS
+constexpr bool threads_have_autodiff_stacks = true;
+#else
+constexpr bool threads_have_autodiff_stacks = false;
+#endif
+
+/**
+ * Apply a body to the range <code>[begin, end)</code>, in parallel on the
+ * TBB threads if <code>threads_have_autodiff_stacks</code> and on the
+ * calling thread, as a single range, otherwise.  Use this for loops whose
+ * iterations use autodiff.
+ *
+ * @tparam Index type of indices
+ * @tparam Body type of body, callable with a
+ *   <code>const tbb::blocked_range<Index>&</code>
+ * @param[in] begin first index
+ * @param[in] end one past the last index
+ * @param[in] body body applied to subranges of the range
+ */
+template <typename Index, typename Body>
+void parallel_for_if_threads(Index begin, Index end, const Body& body) {
+  const tbb::blocked_range<Index> range(begin, end);
+  if constexpr (threads_have_autodiff_stacks) {
+    tbb::parallel_for(range, body);
+  } else {
+    body(range);
+  }
+}
+
+}  // namespace internal
+}  // namespace model
+}  // namespace stan
+#endif
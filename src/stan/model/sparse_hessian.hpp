@@ -0,0 +1,214 @@
+#ifndef STAN_MODEL_SPARSE_HESSIAN_HPP
+#define STAN_MODEL_SPARSE_HESSIAN_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <Eigen/SparseCore>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * Sparsity pattern of a symmetric Hessian with a coloring of its columns,
+ * from which the Hessian is recovered with a product per color.
+ *
+ * A column is either alone in its color, or shares it only with columns
+ * having no nonzero in a common row that is not alone in its color.  The
+ * entries of a column alone in its color are read off its product, and
+ * the other entries off the product of the color of the column, or by
+ * symmetry off that of the row when the row is alone in its color.
+ */
+struct hessian_sparsity {
+  // Rows of the nonzeros of each column, in increasing order
+  std::vector<std::vector<Eigen::Index>> rows;
+  // Color of each column
+  std::vector<int> colors;
+  // Whether each column is alone in its color
+  std::vector<bool> alone;
+  // Number of colors
+  int num_colors = 0;
+
+  Eigen::Index size() const { return rows.size(); }
+};
+
+/**
+ * Color the columns of a symmetric Hessian with the specified sparsity
+ * pattern, so that it is recovered from a product with the Hessian per
+ * color by <code>sparse_hessian</code>.
+ *
+ * The columns with more than the square root of the dimension of
+ * nonzeros, such as those of the hyperparameters of a hierarchical
+ * model, get a color each.  The others are colored greedily, in order of
+ * decreasing number of nonzeros, with the first color not used by a
+ * column with a nonzero in a common row among the others.  The number of
+ * colors is then the number of dense columns plus at most one more than
+ * the largest number of other columns sharing such a row with a column,
+ * which does not grow with the dimension for a hierarchical model.
+ *
+ * @param[in] rows rows of the nonzeros of each column, which must be
+ * symmetric and include the diagonal
+ * @return pattern with its coloring
+ * @throw std::invalid_argument if a row is out of range
+ */
+inline hessian_sparsity color_hessian_sparsity(
+    std::vector<std::vector<Eigen::Index>> rows) {
+  hessian_sparsity pattern;
+  const Eigen::Index n = rows.size();
+  for (auto& column : rows) {
+    std::sort(column.begin(), column.end());
+    column.erase(std::unique(column.begin(), column.end()), column.end());
+    if (!column.empty() && (column.front() < 0 || column.back() >= n))
+      throw std::invalid_argument(
+          "Hessian sparsity: row out of range for dimension "
+          + std::to_string(n));
+  }
+  pattern.rows = std::move(rows);
+  pattern.colors.assign(n, -1);
+  pattern.alone.assign(n, false);
+
+  std::vector<Eigen::Index> order(n);
+  for (Eigen::Index j = 0; j < n; ++j)
+    order[j] = j;
+  std::stable_sort(order.begin(), order.end(),
+                   [&](Eigen::Index a, Eigen::Index b) {
+                     return pattern.rows[a].size() > pattern.rows[b].size();
+                   });
+  for (Eigen::Index j : order) {
+    const double nnz = pattern.rows[j].size();
+    if (nnz * nnz > n) {
+      pattern.alone[j] = true;
+      pattern.colors[j] = pattern.num_colors++;
+    }
+  }
+  // the column each other color was last forbidden for
+  std::vector<Eigen::Index> forbidden_for;
+  for (Eigen::Index j : order) {
+    if (pattern.alone[j])
+      continue;
+    for (Eigen::Index r : pattern.rows[j]) {
+      if (pattern.alone[r])
+        continue;
+      for (Eigen::Index k : pattern.rows[r])
+        if (!pattern.alone[k] && pattern.colors[k] >= 0)
+          forbidden_for[pattern.colors[k]] = j;
+    }
+    int color = 0;
+    while (color < static_cast<int>(forbidden_for.size())
+           && forbidden_for[color] == j)
+      ++color;
+    if (color == static_cast<int>(forbidden_for.size()))
+      forbidden_for.push_back(-1);
+    pattern.colors[j] = color;
+  }
+  // the colors of columns alone come first
+  for (Eigen::Index j = 0; j < n; ++j)
+    if (!pattern.alone[j])
+      pattern.colors[j] += pattern.num_colors;
+  pattern.num_colors += forbidden_for.size();
+  return pattern;
+}
+
+/**
+ * Detect the sparsity pattern of a symmetric Hessian from its products
+ * with the coordinate vectors, and color it for
+ * <code>sparse_hessian</code>.
+ *
+ * This takes one product per dimension, so it is meant to be done once
+ * and the pattern reused, for instance over the iterations of an
+ * optimizer.  An entry is taken to be zero only when it is exactly zero,
+ * so the products should come from automatic differentiation, as with
+ * <code>stan::model::hessian_times_vector</code>, at a point where no
+ * interaction vanishes by accident.  The products are evaluated in
+ * parallel on the TBB threads when Stan is built with
+ * <code>STAN_THREADS</code>, and serially otherwise.
+ *
+ * @tparam F type of the product functor, callable concurrently as
+ * <code>product(const Eigen::VectorXd& v, Eigen::VectorXd& Hv)</code>
+ * @param[in] product functor writing the product of the Hessian with a
+ * vector
+ * @param[in] n dimension of the Hessian
+ * @return pattern with its coloring
+ */
+template <typename F>
+hessian_sparsity detect_hessian_sparsity(const F& product, Eigen::Index n) {
+  std::vector<std::vector<Eigen::Index>> rows(n);
+  auto probe = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    Eigen::VectorXd e = Eigen::VectorXd::Zero(n);
+    Eigen::VectorXd he(n);
+    for (Eigen::Index j = r.begin(); j != r.end(); ++j) {
+      e(j) = 1;
+      product(e, he);
+      e(j) = 0;
+      rows[j].push_back(j);
+      for (Eigen::Index i = 0; i < n; ++i)
+        if (i != j && he(i) != 0)
+          rows[j].push_back(i);
+    }
+  };
+  internal::parallel_for_if_threads(Eigen::Index{0}, n, probe);
+  // a nonzero in either triangle is a nonzero of both
+  for (Eigen::Index j = 0; j < n; ++j)
+    for (Eigen::Index i : rows[j])
+      if (i > j)
+        rows[i].push_back(j);
+  return color_hessian_sparsity(std::move(rows));
+}
+
+/**
+ * Compute a symmetric Hessian with the specified sparsity pattern from
+ * one product per color of the pattern, each with the sum of the
+ * coordinate vectors of the columns of the color.  The products are
+ * evaluated in parallel on the TBB threads when Stan is built with
+ * <code>STAN_THREADS</code>, and serially otherwise, and held until the
+ * Hessian is assembled, so the memory used is that of the result plus
+ * one vector per color.
+ *
+ * @tparam F type of the product functor, callable concurrently as
+ * <code>product(const Eigen::VectorXd& v, Eigen::VectorXd& Hv)</code>
+ * @param[in] product functor writing the product of the Hessian with a
+ * vector
+ * @param[in] pattern sparsity pattern of the Hessian with its coloring
+ * @param[out] hess Hessian, with both triangles
+ */
+template <typename F>
+void sparse_hessian(const F& product, const hessian_sparsity& pattern,
+                    Eigen::SparseMatrix<double>& hess) {
+  const Eigen::Index n = pattern.size();
+  Eigen::MatrixXd products(n, pattern.num_colors);
+  auto evaluate = [&](const tbb::blocked_range<int>& r) {
+    Eigen::VectorXd v(n);
+    Eigen::VectorXd hv(n);
+    for (int c = r.begin(); c != r.end(); ++c) {
+      for (Eigen::Index j = 0; j < n; ++j)
+        v(j) = pattern.colors[j] == c;
+      product(v, hv);
+      products.col(c) = hv;
+    }
+  };
+  internal::parallel_for_if_threads(0, pattern.num_colors, evaluate);
+
+  std::vector<Eigen::Triplet<double>> triplets;
+  for (Eigen::Index j = 0; j < n; ++j) {
+    for (Eigen::Index i : pattern.rows[j]) {
+      const double h_ij = pattern.alone[j] || !pattern.alone[i]
+                              ? products(i, pattern.colors[j])
+                              : products(j, pattern.colors[i]);
+      triplets.emplace_back(i, j, h_ij);
+    }
+  }
+  hess.resize(n, n);
+  hess.setFromTriplets(triplets.begin(), triplets.end());
+  // average the two triangles, which differ by rounding
+  Eigen::SparseMatrix<double> transpose = hess.transpose();
+  hess = 0.5 * (hess + transpose);
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
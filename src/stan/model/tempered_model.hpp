@@ -0,0 +1,85 @@
+#ifndef STAN_MODEL_TEMPERED_MODEL_HPP
+#define STAN_MODEL_TEMPERED_MODEL_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+
+namespace stan {
+namespace model {
+
+/**
+ * <code>tempered_model</code> wraps a model so that its log density is
+ * multiplied by an inverse temperature, the density raised to a power
+ * between zero and one.  It gives the samplers, which only use the
+ * number of parameters and the log density of the model, a flattened
+ * version of the posterior, as the hotter replicas of parallel tempering
+ * use.  The draws are written with the wrapped model.
+ *
+ * The inverse temperature is read every time the log density is, so it
+ * can be changed between transitions of a sampler holding the wrapper.
+ *
+ * @tparam M type of model
+ */
+template <class M>
+class tempered_model {
+ public:
+  /**
+   * Construct a wrapper of a model at the specified inverse temperature.
+   *
+   * @param[in] model model, which must outlive the wrapper
+   * @param[in] inv_temperature inverse temperature, in (0, 1]
+   * @throw std::domain_error if the inverse temperature is not in (0, 1]
+   */
+  explicit tempered_model(const M& model, double inv_temperature = 1)
+      : model_(model) {
+    set_inv_temperature(inv_temperature);
+  }
+
+  /**
+   * Return the wrapped model.
+   */
+  const M& model() const noexcept { return model_; }
+
+  double inv_temperature() const noexcept { return inv_temperature_; }
+
+  /**
+   * Set the inverse temperature.
+   *
+   * @param[in] inv_temperature inverse temperature, in (0, 1]
+   * @throw std::domain_error if the inverse temperature is not in (0, 1]
+   */
+  void set_inv_temperature(double inv_temperature) {
+    if (!(inv_temperature > 0 && inv_temperature <= 1))
+      throw std::domain_error(
+          "tempered_model: inverse temperature must be in (0, 1]");
+    inv_temperature_ = inv_temperature;
+  }
+
+  size_t num_params_r() const { return model_.num_params_r(); }
+
+  /**
+   * Return the log density of the wrapped model times the inverse
+   * temperature, taking the same arguments as the
+   * <code>log_prob</code> of the model.
+   *
+   * @tparam propto true to drop the constant terms
+   * @tparam jacobian true to include the Jacobian adjustment
+   * @param[in] params_r unconstrained parameters
+   * @param[in,out] args remaining arguments of <code>log_prob</code>
+   */
+  template <bool propto, bool jacobian, typename VecR, typename... Args>
+  auto log_prob(VecR& params_r, Args&&... args) const {
+    return inv_temperature_
+           * model_.template log_prob<propto, jacobian>(
+               params_r, std::forward<Args>(args)...);
+  }
+
+ private:
+  const M& model_;
+  double inv_temperature_;
+};
+
+}  // namespace model
+}  // namespace stan
+#endif
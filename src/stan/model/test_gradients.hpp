@@ -3,10 +3,16 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/model/directional_derivatives.hpp>
 #include <stan/model/finite_diff_grad.hpp>
 #include <stan/model/log_prob_grad.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <algorithm>
 #include <cmath>
+#include <iomanip>
+#include <numeric>
 #include <sstream>
+#include <string>
 #include <vector>
 
 namespace stan {
@@ -94,6 +100,294 @@ int test_gradients(const Model& model, std::vector<double>& params_r,
   return num_failed;
 }
 
+namespace internal {
+
+/**
+ * Return directions drawn uniformly from the unit sphere, one per column.
+ *
+ * @tparam RNG Class of random number generator.
+ * @param[in] n dimension of the directions
+ * @param[in] num_directions number of directions
+ * @param[in,out] rng random number generator
+ */
+template <class RNG>
+Eigen::MatrixXd random_directions(size_t n, int num_directions, RNG& rng) {
+  boost::random::normal_distribution<double> std_normal;
+  Eigen::MatrixXd directions(n, num_directions);
+  for (int d = 0; d < num_directions; ++d) {
+    for (size_t k = 0; k < n; ++k)
+      directions(k, d) = std_normal(rng);
+    directions.col(d).normalize();
+  }
+  return directions;
+}
+
+/**
+ * Write the comparisons of the derivatives of the model with those they
+ * are checked against as a table, followed by the comparisons with the
+ * largest absolute errors, largest first, and return the number of
+ * comparisons with more than the allowed error.
+ *
+ * @param[in] lp log density
+ * @param[in] params_r parameters, written next to each comparison when
+ * the derivatives are along the coordinates, or empty when they are
+ * along directions
+ * @param[in] model_deriv derivatives of the model
+ * @param[in] check_deriv derivatives they are checked against
+ * @param[in] check_name heading of the derivatives checked against
+ * @param[in] error amount of absolute error to allow
+ * @param[in] num_worst number of comparisons with the largest errors to
+ * write again
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] parameter_writer Writer callback for file output
+ */
+inline int write_gradient_checks(double lp,
+                                 const std::vector<double>& params_r,
+                                 const std::vector<double>& model_deriv,
+                                 const std::vector<double>& check_deriv,
+                                 const std::string& check_name, double error,
+                                 int num_worst,
+                                 stan::callbacks::logger& logger,
+                                 stan::callbacks::writer& parameter_writer) {
+  auto write = [&](const std::string& line) {
+    parameter_writer(line);
+    logger.info(line);
+  };
+  const bool by_direction = params_r.empty();
+  const size_t num_checks = model_deriv.size();
+
+  std::stringstream lp_msg;
+  lp_msg << " Log probability=" << lp;
+
+  parameter_writer();
+  parameter_writer(lp_msg.str());
+  parameter_writer();
+
+  logger.info("");
+  logger.info(lp_msg);
+  logger.info("");
+
+  std::stringstream header;
+  header << std::setw(10) << (by_direction ? "direction" : "param idx");
+  if (!by_direction)
+    header << std::setw(16) << "value";
+  header << std::setw(16) << "model" << std::setw(16) << check_name
+         << std::setw(16) << "error";
+  auto line = [&](size_t k) {
+    std::stringstream ss;
+    ss << std::setw(10) << k;
+    if (!by_direction)
+      ss << std::setw(16) << params_r[k];
+    ss << std::setw(16) << model_deriv[k] << std::setw(16) << check_deriv[k]
+       << std::setw(16) << (model_deriv[k] - check_deriv[k]);
+    return ss.str();
+  };
+
+  write(header.str());
+  int num_failed = 0;
+  for (size_t k = 0; k < num_checks; k++) {
+    write(line(k));
+    if (std::fabs(model_deriv[k] - check_deriv[k]) > error)
+      num_failed++;
+  }
+
+  const size_t num_reported
+      = std::min(num_checks, static_cast<size_t>(std::max(num_worst, 0)));
+  if (num_reported > 0) {
+    std::vector<size_t> order(num_checks);
+    std::iota(order.begin(), order.end(), 0);
+    std::partial_sort(order.begin(), order.begin() + num_reported,
+                      order.end(), [&](size_t a, size_t b) {
+                        return std::fabs(model_deriv[a] - check_deriv[a])
+                               > std::fabs(model_deriv[b] - check_deriv[b]);
+                      });
+    parameter_writer();
+    logger.info("");
+    write(" Largest errors:");
+    write(header.str());
+    for (size_t i = 0; i < num_reported; ++i)
+      write(line(order[i]));
+  }
+  return num_failed;
+}
+
+}  // namespace internal
+
+/**
+ * Test the log_prob_grad() function's gradients against finite
+ * differences like <code>test_gradients</code>, evaluating the finite
+ * differences in parallel on the TBB threads and optionally along random
+ * directions instead of the coordinates.
+ *
+ * With no directions, the finite difference of every coordinate is
+ * compared with the gradient and written as a table.  With
+ * <code>num_directions</code> directions drawn uniformly from the unit
+ * sphere, the directional derivative along each of them is compared with
+ * the inner product of the gradient and the direction, which costs two
+ * evaluations of the log density per direction rather than per
+ * coordinate.  The comparisons with the largest absolute errors are then
+ * written again, largest first.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam Model Class of model.
+ * @tparam RNG Class of random number generator.
+ * @param[in] model Model.
+ * @param[in] params_r Real-valued parameter vector.
+ * @param[in] params_i Integer-valued parameter vector.
+ * @param[in] epsilon Real-valued scalar saying how much to perturb.
+ *   Reasonable value is 1e-6.
+ * @param[in] error Real-valued scalar saying how much error to allow.
+ *   Reasonable value is 1e-6.
+ * @param[in] num_directions Number of random directions to check, or 0
+ *   to check every coordinate.
+ * @param[in] num_worst Number of comparisons with the largest errors to
+ *   report, or 0 for none.
+ * @param[in,out] rng Random number generator for the directions.
+ * @param[in,out] interrupt callback to be called between blocks of
+ *   finite differences
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] parameter_writer Writer callback for file output
+ * @return number of failed gradient comparisons versus allowed
+ * error, so 0 if all gradients pass
+ */
+template <bool propto, bool jacobian_adjust_transform, class Model,
+          class RNG>
+int test_gradients(const Model& model, std::vector<double>& params_r,
+                   std::vector<int>& params_i, double epsilon, double error,
+                   int num_directions, int num_worst, RNG& rng,
+                   stan::callbacks::interrupt& interrupt,
+                   stan::callbacks::logger& logger,
+                   stan::callbacks::writer& parameter_writer) {
+  std::stringstream msg;
+  std::vector<double> grad;
+  double lp = log_prob_grad<propto, jacobian_adjust_transform>(
+      model, params_r, params_i, grad, &msg);
+  if (msg.str().length() > 0) {
+    logger.info(msg);
+    parameter_writer(msg.str());
+  }
+
+  // the finite differences keep the constants, which cancel, because the
+  // log density of doubles up to a proportion drops every term
+  std::vector<double> model_deriv;
+  std::vector<double> fd_deriv;
+  std::stringstream fd_msg;
+  if (num_directions > 0) {
+    const Eigen::MatrixXd directions
+        = internal::random_directions(params_r.size(), num_directions, rng);
+    interrupt();
+    Eigen::VectorXd derivs;
+    finite_diff_directional<false, jacobian_adjust_transform>(
+        model, params_r, params_i, directions, derivs, epsilon, &fd_msg);
+    const Eigen::VectorXd grad_dot_directions
+        = directions.transpose()
+          * Eigen::Map<const Eigen::VectorXd>(grad.data(), grad.size());
+    model_deriv.assign(grad_dot_directions.data(),
+                       grad_dot_directions.data() + num_directions);
+    fd_deriv.assign(derivs.data(), derivs.data() + num_directions);
+  } else {
+    model_deriv = grad;
+    finite_diff_grad_parallel<false, jacobian_adjust_transform>(
+        model, interrupt, params_r, params_i, fd_deriv, epsilon, &fd_msg);
+  }
+  if (fd_msg.str().length() > 0) {
+    logger.info(fd_msg);
+    parameter_writer(fd_msg.str());
+  }
+
+  return internal::write_gradient_checks(
+      lp, num_directions > 0 ? std::vector<double>() : params_r, model_deriv,
+      fd_deriv, "finite diff", error, num_worst, logger, parameter_writer);
+}
+
+/**
+ * Test the log_prob_grad() function's gradients against directional
+ * derivatives computed with forward-mode automatic differentiation.
+ *
+ * The inner product of the gradient with each of
+ * <code>num_directions</code> directions drawn uniformly from the unit
+ * sphere is compared with the directional derivative along it, which
+ * costs one evaluation of the log density per direction however many
+ * parameters there are, and has no truncation error, so the allowed
+ * error may be far smaller than for finite differences.  With no
+ * directions, the derivative along every coordinate is checked instead.
+ * The comparisons are written as a table, followed by the comparisons
+ * with the largest absolute errors, largest first.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam Model Class of model.
+ * @tparam RNG Class of random number generator.
+ * @param[in] model Model.
+ * @param[in] params_r Real-valued parameter vector.
+ * @param[in] params_i Integer-valued parameter vector.
+ * @param[in] error Real-valued scalar saying how much error to allow.
+ * @param[in] num_directions Number of random directions to check, or 0
+ *   to check every coordinate.
+ * @param[in] num_worst Number of comparisons with the largest errors to
+ *   report, or 0 for none.
+ * @param[in,out] rng Random number generator for the directions.
+ * @param[in,out] interrupt callback to be called before the directional
+ *   derivatives
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] parameter_writer Writer callback for file output
+ * @return number of failed gradient comparisons versus allowed
+ * error, so 0 if all gradients pass
+ * @throw std::domain_error if the model is a <code>model_base</code> and
+ * Stan is built without <code>STAN_MODEL_FVAR_VAR</code>
+ */
+template <bool propto, bool jacobian_adjust_transform, class Model,
+          class RNG>
+int test_gradients_forward(const Model& model, std::vector<double>& params_r,
+                           std::vector<int>& params_i, double error,
+                           int num_directions, int num_worst, RNG& rng,
+                           stan::callbacks::interrupt& interrupt,
+                           stan::callbacks::logger& logger,
+                           stan::callbacks::writer& parameter_writer) {
+  std::stringstream msg;
+  std::vector<double> grad;
+  double lp = log_prob_grad<propto, jacobian_adjust_transform>(
+      model, params_r, params_i, grad, &msg);
+  if (msg.str().length() > 0) {
+    logger.info(msg);
+    parameter_writer(msg.str());
+  }
+
+  const bool by_direction = num_directions > 0;
+  const Eigen::MatrixXd directions
+      = by_direction
+            ? internal::random_directions(params_r.size(), num_directions, rng)
+            : Eigen::MatrixXd::Identity(params_r.size(), params_r.size());
+  interrupt();
+  Eigen::VectorXd derivs;
+  std::stringstream fwd_msg;
+  directional_derivatives<propto, jacobian_adjust_transform>(
+      model,
+      Eigen::Map<const Eigen::VectorXd>(params_r.data(), params_r.size()),
+      directions, derivs, &fwd_msg);
+  if (fwd_msg.str().length() > 0) {
+    logger.info(fwd_msg);
+    parameter_writer(fwd_msg.str());
+  }
+  const Eigen::VectorXd grad_dot_directions
+      = directions.transpose()
+        * Eigen::Map<const Eigen::VectorXd>(grad.data(), grad.size());
+
+  return internal::write_gradient_checks(
+      lp, by_direction ? std::vector<double>() : params_r,
+      std::vector<double>(grad_dot_directions.data(),
+                          grad_dot_directions.data() + derivs.size()),
+      std::vector<double>(derivs.data(), derivs.data() + derivs.size()),
+      "forward diff", error, num_worst, logger, parameter_writer);
+}
+
 }  // namespace model
 }  // namespace stan
 #endif
@@ -0,0 +1,68 @@
+#ifndef STAN_MODEL_UNCONSTRAIN_ARRAY_BATCH_HPP
+#define STAN_MODEL_UNCONSTRAIN_ARRAY_BATCH_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace model {
+
+/**
+ * Convert each of several draws of the constrained parameters, given as
+ * the columns of a matrix, to the unconstrained scale with the
+ * <code>unconstrain_array</code> method of the model.
+ *
+ * The draws are independent and their conversion does not use the
+ * autodiff stack, so they are converted in parallel on the TBB threads,
+ * each range of draws with its own buffers for a draw and its messages.
+ * The messages written for each draw are appended to the message stream
+ * in the order of the draws.
+ *
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r_constrained Constrained parameters, one draw per
+ * column.
+ * @param[out] params_r Unconstrained parameters, one draw per column.
+ * @param[in,out] msgs stream to which messages are written, or
+ * <code>nullptr</code> to discard them
+ * @throw std::exception if a draw can not be converted, such as one out
+ * of the support of its constraints
+ */
+template <class M>
+void unconstrain_array_batch(const M& model,
+                             const Eigen::MatrixXd& params_r_constrained,
+                             Eigen::MatrixXd& params_r,
+                             std::ostream* msgs = 0) {
+  const Eigen::Index num_draws = params_r_constrained.cols();
+  params_r.resize(model.num_params_r(), num_draws);
+  std::vector<std::string> draw_msgs(msgs == nullptr ? 0 : num_draws);
+
+  auto convert = [&](const tbb::blocked_range<Eigen::Index>& r) {
+    std::stringstream ss;
+    Eigen::VectorXd constrained(params_r_constrained.rows());
+    Eigen::VectorXd unconstrained(params_r.rows());
+    for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+      constrained = params_r_constrained.col(i);
+      model.unconstrain_array(constrained, unconstrained,
+                              msgs == nullptr ? nullptr : &ss);
+      params_r.col(i) = unconstrained;
+      if (msgs != nullptr) {
+        draw_msgs[i] = ss.str();
+        ss.str("");
+      }
+    }
+  };
+  tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, num_draws), convert);
+
+  for (const std::string& msg : draw_msgs)
+    *msgs << msg;
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
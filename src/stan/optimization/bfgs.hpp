@@ -1,6 +1,7 @@
 #ifndef STAN_OPTIMIZATION_BFGS_HPP
 #define STAN_OPTIMIZATION_BFGS_HPP
 
+#include <stan/callbacks/interrupt.hpp>
 #include <stan/math/prim.hpp>
 #include <stan/model/log_prob_propto.hpp>
 #include <stan/model/log_prob_grad.hpp>
@@ -8,9 +9,13 @@
 #include <stan/optimization/bfgs_update.hpp>
 #include <stan/optimization/lbfgs_update.hpp>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -24,6 +29,7 @@ typedef enum {
   TERM_ABSGRAD = 30,
   TERM_RELGRAD = 31,
   TERM_MAXIT = 40,
+  TERM_INTERRUPT = 50,
   TERM_LSFAIL = -1
 } TerminationCondition;
 
@@ -39,6 +45,11 @@ class ConvergenceOptions {
   Scalar tolRelGrad{1e+3};
 };
 
+typedef enum {
+  LS_WOLFE = 0,        // WolfeLineSearch()
+  LS_MORE_THUENTE = 1  // MoreThuenteLineSearch()
+} LineSearchMethod;
+
 template <typename Scalar = double>
 class LSOptions {
  public:
@@ -48,6 +59,10 @@ class LSOptions {
   Scalar minAlpha{1e-12};
   Scalar maxLSIts{20};
   Scalar maxLSRestarts{10};
+  LineSearchMethod method{LS_WOLFE};
+  // Trial steps of the Wolfe line search evaluated at once in parallel;
+  // the iterates are the same for any value
+  size_t parallelTrials{1};
 };
 template <typename FunctorType, typename QNUpdateType, typename Scalar = double,
           int DimAtCompile = Eigen::Dynamic>
@@ -64,6 +79,11 @@ class BFGSMinimizer {
   size_t _itNum;
   std::string _note;
   QNUpdateType _qn;
+  const callbacks::interrupt *_interrupt = nullptr;
+
+  bool stop_requested() const {
+    return _interrupt != nullptr && _interrupt->stop_requested();
+  }
 
  public:
   using ls_options_t = LSOptions<Scalar>;
@@ -100,6 +120,16 @@ class BFGSMinimizer {
 
   inline const std::string &note() const noexcept { return _note; }
 
+  /**
+   * Set the interrupt whose <code>stop_requested</code> is polled by
+   * <code>step</code>, or clear it with null.  A step stopped in its line
+   * search leaves the current iterate unchanged and returns
+   * <code>TERM_INTERRUPT</code>.
+   */
+  void set_interrupt(const callbacks::interrupt *interrupt) {
+    _interrupt = interrupt;
+  }
+
   inline std::string get_code_string(int retCode) const noexcept {
     switch (retCode) {
       case TERM_SUCCESS:
@@ -128,6 +158,8 @@ class BFGSMinimizer {
         return std::string(
             "Maximum number of iterations hit, "
             "may not be at an optima");
+      case TERM_INTERRUPT:
+        return std::string("Stopped on request");
       case TERM_LSFAIL:
         return std::string(
             "Line search failed to achieve a sufficient "
@@ -168,6 +200,9 @@ class BFGSMinimizer {
     int retCode(0);
     int resetB(0);
 
+    if (stop_requested())
+      return TERM_INTERRUPT;
+
     _itNum++;
 
     if (_itNum == 1) {
@@ -198,12 +233,22 @@ class BFGSMinimizer {
 
       // Perform the line search.  If successful, the results are in the
       // variables: _xk_1, _fk_1 and _gk_1.
-      retCode
-          = WolfeLineSearch(_func, _alpha, _xk_1, _fk_1, _gk_1, _pk, _xk, _fk,
-                            _gk, _ls_opts.c1, _ls_opts.c2, _ls_opts.minAlpha,
-                            _ls_opts.maxLSIts, _ls_opts.maxLSRestarts);
+      if (_ls_opts.method == LS_MORE_THUENTE)
+        retCode = MoreThuenteLineSearch(
+            _func, _alpha, _xk_1, _fk_1, _gk_1, _pk, _xk, _fk, _gk,
+            _ls_opts.c1, _ls_opts.c2, _ls_opts.minAlpha, _ls_opts.maxLSIts,
+            _ls_opts.maxLSRestarts);
+      else
+        retCode = WolfeLineSearch(
+            _func, _alpha, _xk_1, _fk_1, _gk_1, _pk, _xk, _fk, _gk,
+            _ls_opts.c1, _ls_opts.c2, _ls_opts.minAlpha, _ls_opts.maxLSIts,
+            _ls_opts.maxLSRestarts, _ls_opts.parallelTrials);
       if (retCode) {
-        // Line search failed...
+        // Line search failed, or was stopped
+        if (stop_requested()) {
+          _itNum--;
+          return TERM_INTERRUPT;
+        }
         if (resetB) {
           // did a Hessian reset and it still failed,
           // and nothing left to try
@@ -282,6 +327,12 @@ class BFGSMinimizer {
   }
 };
 
+/**
+ * Adapts a model to the function interface of the minimizers, as the
+ * negative log density and its gradient.  Copies share the count of
+ * gradient evaluations and write their messages whole, so they can be
+ * called concurrently by a parallel line search.
+ */
 template <class M, bool jacobian = false>
 class ModelAdaptor {
  private:
@@ -289,18 +340,17 @@ class ModelAdaptor {
   std::vector<int> _params_i;
   std::ostream *_msgs;
   std::vector<double> _x, _g;
-  size_t _fevals;
+  std::shared_ptr<std::atomic<size_t>> _fevals;
+  std::shared_ptr<std::mutex> _msgs_mutex;
+  const callbacks::interrupt *_interrupt = nullptr;
 
- public:
-  ModelAdaptor(M &model, const std::vector<int> &params_i, std::ostream *msgs)
-      : _model(model), _params_i(params_i), _msgs(msgs), _fevals(0) {}
-
-  size_t fevals() const { return _fevals; }
-  int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f) {
+  int evaluate(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f,
+               Eigen::Matrix<double, Eigen::Dynamic, 1> &g,
+               std::ostream *msgs) {
     using Eigen::Dynamic;
     using Eigen::Matrix;
     using stan::math::index_type;
-    using stan::model::log_prob_propto;
+    using stan::model::log_prob_grad;
     typedef typename index_type<Matrix<double, Dynamic, 1> >::type idx_t;
 
     _x.resize(x.size());
@@ -308,66 +358,98 @@ class ModelAdaptor {
       _x[i] = x[i];
 
     try {
-      f = -log_prob_propto<jacobian>(_model, _x, _params_i, _msgs);
+      f = -log_prob_grad<true, jacobian>(_model, _x, _params_i, _g, msgs);
     } catch (const std::domain_error &e) {
-      if (_msgs)
-        (*_msgs) << e.what() << std::endl;
+      if (msgs)
+        (*msgs) << e.what() << std::endl;
       return 1;
     }
 
+    g.resize(_g.size());
+    for (size_t i = 0; i < _g.size(); i++) {
+      if (!std::isfinite(_g[i])) {
+        if (msgs)
+          *msgs << "Error evaluating model log probability: "
+                   "Non-finite gradient."
+                << std::endl;
+        return 3;
+      }
+      g[i] = -_g[i];
+    }
+
     if (std::isfinite(f)) {
       return 0;
     } else {
-      if (_msgs)
-        *_msgs << "Error evaluating model log probability: "
-                  "Non-finite function evaluation."
-               << std::endl;
+      if (msgs)
+        *msgs << "Error evaluating model log probability: "
+              << "Non-finite function evaluation." << std::endl;
       return 2;
     }
   }
-  int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f,
-                 Eigen::Matrix<double, Eigen::Dynamic, 1> &g) {
+
+ public:
+  ModelAdaptor(M &model, const std::vector<int> &params_i, std::ostream *msgs)
+      : _model(model),
+        _params_i(params_i),
+        _msgs(msgs),
+        _fevals(std::make_shared<std::atomic<size_t>>(0)),
+        _msgs_mutex(std::make_shared<std::mutex>()) {}
+
+  size_t fevals() const { return *_fevals; }
+
+  /**
+   * Set the interrupt polled before each evaluation of the gradient, or
+   * clear it with null.  Once it requests a stop, evaluations fail
+   * without evaluating the model, so a line search ends at once.
+   */
+  void set_interrupt(const callbacks::interrupt *interrupt) {
+    _interrupt = interrupt;
+  }
+
+  int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f) {
     using Eigen::Dynamic;
     using Eigen::Matrix;
     using stan::math::index_type;
-    using stan::model::log_prob_grad;
+    using stan::model::log_prob_propto;
     typedef typename index_type<Matrix<double, Dynamic, 1> >::type idx_t;
 
     _x.resize(x.size());
     for (idx_t i = 0; i < x.size(); i++)
       _x[i] = x[i];
 
-    _fevals++;
-
     try {
-      f = -log_prob_grad<true, jacobian>(_model, _x, _params_i, _g, _msgs);
+      f = -log_prob_propto<jacobian>(_model, _x, _params_i, _msgs);
     } catch (const std::domain_error &e) {
       if (_msgs)
         (*_msgs) << e.what() << std::endl;
       return 1;
     }
 
-    g.resize(_g.size());
-    for (size_t i = 0; i < _g.size(); i++) {
-      if (!std::isfinite(_g[i])) {
-        if (_msgs)
-          *_msgs << "Error evaluating model log probability: "
-                    "Non-finite gradient."
-                 << std::endl;
-        return 3;
-      }
-      g[i] = -_g[i];
-    }
-
     if (std::isfinite(f)) {
       return 0;
     } else {
       if (_msgs)
         *_msgs << "Error evaluating model log probability: "
-               << "Non-finite function evaluation." << std::endl;
+                  "Non-finite function evaluation."
+               << std::endl;
       return 2;
     }
   }
+  int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f,
+                 Eigen::Matrix<double, Eigen::Dynamic, 1> &g) {
+    if (_interrupt != nullptr && _interrupt->stop_requested())
+      return 4;
+    ++*_fevals;
+    if (!_msgs)
+      return evaluate(x, f, g, _msgs);
+    std::stringstream msgs;
+    const int ret = evaluate(x, f, g, &msgs);
+    if (msgs.tellp() > 0) {
+      std::lock_guard<std::mutex> lock(*_msgs_mutex);
+      *_msgs << msgs.str();
+    }
+    return ret;
+  }
   int df(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x,
          Eigen::Matrix<double, Eigen::Dynamic, 1> &g) {
     double f;
@@ -412,6 +494,15 @@ class BFGSLineSearch
     BFGSBase::initialize(params_r);
   }
 
+  /**
+   * Set the interrupt polled by each step and by each gradient
+   * evaluation of its line search, or clear it with null.
+   */
+  void set_interrupt(const callbacks::interrupt *interrupt) {
+    BFGSBase::set_interrupt(interrupt);
+    this->_func.set_interrupt(interrupt);
+  }
+
   size_t grad_evals() { return this->_func.fevals(); }
   double logp() { return -(this->curr_f()); }
   double grad_norm() { return this->curr_g().norm(); }
@@ -1,11 +1,14 @@
 #ifndef STAN_OPTIMIZATION_BFGS_LINESEARCH_HPP
 #define STAN_OPTIMIZATION_BFGS_LINESEARCH_HPP
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <string>
 #include <limits>
+#include <vector>
 
 namespace stan {
 namespace optimization {
@@ -169,6 +172,92 @@ int WolfLSZoom(Scalar &alpha, XType &newX, Scalar &newF, XType &newDF,
   return 0;
 }
 
+/**
+ * An internal utility for implementing WolfeLineSearch(), which evaluates
+ * the trial steps of its bracketing phase ahead of time.
+ *
+ * Until a step satisfies the Wolfe conditions or brackets one, the line
+ * search multiplies the trial step by ten, so the trials that follow the
+ * current one are known before it is evaluated.  When a trial is
+ * requested which has not been evaluated, it and up to
+ * <code>num_trials - 1</code> of its successors are evaluated in
+ * parallel, each but the first on a copy of the function, and the
+ * results are then handed out in order.  The line search makes the same
+ * decisions from the same values as when it evaluates the trials one at
+ * a time; the successors of a trial which ends the bracketing phase or
+ * at which the function fails are discarded.
+ *
+ * @tparam FunctorType A copyable function type as for WolfeLineSearch(),
+ * whose copies can be called concurrently
+ * @tparam Scalar A scalar type
+ * @tparam XType A vector type
+ **/
+template <typename FunctorType, typename Scalar, typename XType>
+class WolfeLSTrials {
+ private:
+  FunctorType &_func;
+  const XType &_x0;
+  const XType &_p;
+  size_t _num_trials;
+  std::vector<Scalar> _alpha, _f;
+  std::vector<XType> _x, _g;
+  std::vector<int> _ret;
+  size_t _next;
+
+ public:
+  WolfeLSTrials(FunctorType &func, const XType &x0, const XType &p,
+                size_t num_trials)
+      : _func(func), _x0(x0), _p(p), _num_trials(num_trials), _next(0) {}
+
+  /**
+   * Evaluate the function at the trial step <code>alpha</code>, as
+   * <code>func(x0 + alpha * p, f, g)</code>.
+   *
+   * @param alpha trial step
+   * @param max_trials largest number of trials left to the line search
+   * @param x trial point
+   * @param f function value at the trial point
+   * @param g gradient at the trial point
+   * @return the value returned by the function, non-zero if it failed
+   **/
+  int operator()(const Scalar &alpha, size_t max_trials, XType &x, Scalar &f,
+                 XType &g) {
+    if (_next >= _alpha.size() || _alpha[_next] != alpha) {
+      const size_t n = std::max(size_t(1), std::min(_num_trials, max_trials));
+      _alpha.resize(n);
+      _alpha[0] = alpha;
+      for (size_t j = 1; j < n; ++j)
+        _alpha[j] = _alpha[j - 1] * 10.0;
+      _f.resize(n);
+      _x.resize(n);
+      _g.resize(n);
+      _ret.resize(n);
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                        [&](const tbb::blocked_range<size_t> &r) {
+                          for (size_t j = r.begin(); j != r.end(); ++j) {
+                            _x[j].noalias() = _x0 + _alpha[j] * _p;
+                            if (j == 0) {
+                              _ret[j] = _func(_x[j], _f[j], _g[j]);
+                            } else {
+                              FunctorType func(_func);
+                              _ret[j] = func(_x[j], _f[j], _g[j]);
+                            }
+                          }
+                        });
+      _next = 0;
+    }
+    x = _x[_next];
+    f = _f[_next];
+    g = _g[_next];
+    const int ret = _ret[_next];
+    ++_next;
+    // the successors were computed as if this trial would succeed
+    if (ret != 0)
+      _alpha.clear();
+    return ret;
+  }
+};
+
 /**
  * Perform a line search which finds an approximate solution to:
  * \f[
@@ -223,6 +312,11 @@ int WolfLSZoom(Scalar &alpha, XType &newX, Scalar &newF, XType &newDF,
  * @param maxLSRestarts Maximum number of times line search will
  * restart with \f$ f() \f$ failing.
  *
+ * @param parallelTrials Number of trial steps of the bracketing phase
+ * evaluated at once, in parallel on copies of <code>func</code> when
+ * larger than one, which must then be safe to call concurrently.  The
+ * result does not depend on it.
+ *
  * @return Returns zero on success, non-zero otherwise.
  **/
 template <typename FunctorType, typename Scalar, typename XType>
@@ -230,7 +324,8 @@ int WolfeLineSearch(FunctorType &func, Scalar &alpha, XType &x1,
                     Scalar &func_val, XType &gradx1, const XType &p,
                     const XType &x0, const Scalar &f0, const XType &gradx0,
                     const Scalar &c1, const Scalar &c2, const Scalar &minAlpha,
-                    const Scalar &maxLSIts, const Scalar &maxLSRestarts) {
+                    const Scalar &maxLSIts, const Scalar &maxLSRestarts,
+                    size_t parallelTrials = 1) {
   const Scalar dfp(gradx0.dot(p));
   const Scalar c1dfp(c1 * dfp);
   const Scalar c2dfp(c2 * dfp);
@@ -244,6 +339,8 @@ int WolfeLineSearch(FunctorType &func, Scalar &alpha, XType &x1,
   Scalar newDFp;
 
   int retCode = 0, nits = 0, lsRestarts = 0, ret;
+  WolfeLSTrials<FunctorType, Scalar, XType> trials(func, x0, p,
+                                                   parallelTrials);
 
   while (1) {
     if (nits >= maxLSIts) {
@@ -252,7 +349,11 @@ int WolfeLineSearch(FunctorType &func, Scalar &alpha, XType &x1,
     }
 
     x1.noalias() = x0 + alpha1 * p;
-    ret = func(x1, func_val, gradx1);
+    if (parallelTrials > 1)
+      ret = trials(alpha1, static_cast<size_t>(std::ceil(maxLSIts - nits)), x1,
+                   func_val, gradx1);
+    else
+      ret = func(x1, func_val, gradx1);
     if (ret != 0) {
       if (lsRestarts >= maxLSRestarts) {
         retCode = 1;
@@ -294,6 +395,316 @@ int WolfeLineSearch(FunctorType &func, Scalar &alpha, XType &x1,
   }
   return retCode;
 }
+
+/**
+ * An internal utility function for implementing MoreThuenteLineSearch(),
+ * which safeguards the next trial step as in the subroutine dcstep of
+ * MINPACK-2 (Moré and Thuente, 1994).
+ *
+ * The step <code>stx</code> is the one with the smallest function value
+ * so far, <code>sty</code> the other end of the interval of uncertainty
+ * and <code>stp</code> the current trial, each with its function value
+ * and directional derivative.  The interval is updated with the trial,
+ * and the trial is replaced by the next step to try, chosen from cubic
+ * and quadratic interpolants of the end points and the trial and kept
+ * within <code>[stpmin, stpmax]</code>.
+ *
+ * @tparam Scalar A scalar type
+ * @param[in,out] stx best step
+ * @param[in,out] fx function value at the best step
+ * @param[in,out] dx directional derivative at the best step
+ * @param[in,out] sty other end of the interval of uncertainty
+ * @param[in,out] fy function value at the other end
+ * @param[in,out] dy directional derivative at the other end
+ * @param[in,out] stp trial step, replaced by the next step to try
+ * @param[in] fp function value at the trial step
+ * @param[in] dp directional derivative at the trial step
+ * @param[in,out] brackt whether a minimizer has been bracketed
+ * @param[in] stpmin lower bound on the next step
+ * @param[in] stpmax upper bound on the next step
+ **/
+template <typename Scalar>
+void MoreThuenteStep(Scalar &stx, Scalar &fx, Scalar &dx, Scalar &sty,
+                     Scalar &fy, Scalar &dy, Scalar &stp, const Scalar &fp,
+                     const Scalar &dp, bool &brackt, const Scalar &stpmin,
+                     const Scalar &stpmax) {
+  const Scalar sgnd = dp * (dx / std::fabs(dx));
+  Scalar stpf, stpc, stpq, theta, s, gamma, p, q, r;
+
+  if (fp > fx) {
+    // Higher function value: the minimizer is bracketed, take the cubic
+    // step if it is closer to stx than the quadratic step
+    theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+    s = std::max(std::fabs(theta), std::max(std::fabs(dx), std::fabs(dp)));
+    gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+    if (stp < stx)
+      gamma = -gamma;
+    p = (gamma - dx) + theta;
+    q = ((gamma - dx) + gamma) + dp;
+    r = p / q;
+    stpc = stx + r * (stp - stx);
+    stpq = stx + ((dx / ((fx - fp) / (stp - stx) + dx)) / 2) * (stp - stx);
+    if (std::fabs(stpc - stx) < std::fabs(stpq - stx))
+      stpf = stpc;
+    else
+      stpf = stpc + (stpq - stpc) / 2;
+    brackt = true;
+  } else if (sgnd < 0) {
+    // Derivatives of opposite sign: the minimizer is bracketed, take the
+    // step farther from stp of the cubic and secant steps
+    theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+    s = std::max(std::fabs(theta), std::max(std::fabs(dx), std::fabs(dp)));
+    gamma = s * std::sqrt((theta / s) * (theta / s) - (dx / s) * (dp / s));
+    if (stp > stx)
+      gamma = -gamma;
+    p = (gamma - dp) + theta;
+    q = ((gamma - dp) + gamma) + dx;
+    r = p / q;
+    stpc = stp + r * (stx - stp);
+    stpq = stp + (dp / (dp - dx)) * (stx - stp);
+    if (std::fabs(stpc - stp) > std::fabs(stpq - stp))
+      stpf = stpc;
+    else
+      stpf = stpq;
+    brackt = true;
+  } else if (std::fabs(dp) < std::fabs(dx)) {
+    // Derivatives of the same sign, decreasing in magnitude: the cubic
+    // step is only used if it tends to infinity in the right direction
+    theta = 3 * (fx - fp) / (stp - stx) + dx + dp;
+    s = std::max(std::fabs(theta), std::max(std::fabs(dx), std::fabs(dp)));
+    gamma = s
+            * std::sqrt(std::max(Scalar(0), (theta / s) * (theta / s)
+                                                 - (dx / s) * (dp / s)));
+    if (stp > stx)
+      gamma = -gamma;
+    p = (gamma - dp) + theta;
+    q = (gamma + (dx - dp)) + gamma;
+    r = p / q;
+    if (r < 0 && gamma != 0)
+      stpc = stp + r * (stx - stp);
+    else if (stp > stx)
+      stpc = stpmax;
+    else
+      stpc = stpmin;
+    stpq = stp + (dp / (dp - dx)) * (stx - stp);
+    if (brackt) {
+      if (std::fabs(stpc - stp) < std::fabs(stpq - stp))
+        stpf = stpc;
+      else
+        stpf = stpq;
+      if (stp > stx)
+        stpf = std::min(stp + 0.66 * (sty - stp), stpf);
+      else
+        stpf = std::max(stp + 0.66 * (sty - stp), stpf);
+    } else {
+      if (std::fabs(stpc - stp) > std::fabs(stpq - stp))
+        stpf = stpc;
+      else
+        stpf = stpq;
+      stpf = std::max(stpmin, std::min(stpmax, stpf));
+    }
+  } else {
+    // Derivatives of the same sign, not decreasing in magnitude: take the
+    // cubic step through stp and sty if bracketed, else a bound
+    if (brackt) {
+      theta = 3 * (fp - fy) / (sty - stp) + dy + dp;
+      s = std::max(std::fabs(theta), std::max(std::fabs(dy), std::fabs(dp)));
+      gamma = s * std::sqrt((theta / s) * (theta / s) - (dy / s) * (dp / s));
+      if (stp > sty)
+        gamma = -gamma;
+      p = (gamma - dp) + theta;
+      q = ((gamma - dp) + gamma) + dy;
+      r = p / q;
+      stpf = stp + r * (sty - stp);
+    } else if (stp > stx) {
+      stpf = stpmax;
+    } else {
+      stpf = stpmin;
+    }
+  }
+
+  // Update the interval which contains a minimizer
+  if (fp > fx) {
+    sty = stp;
+    fy = fp;
+    dy = dp;
+  } else {
+    if (sgnd < 0) {
+      sty = stx;
+      fy = fx;
+      dy = dx;
+    }
+    stx = stp;
+    fx = fp;
+    dx = dp;
+  }
+  stp = stpf;
+}
+
+/**
+ * Perform a line search which finds an approximate solution to:
+ * \f[
+ *       \min_\alpha f(x_0 + \alpha p)
+ * \f]
+ * satisfying the strong Wolfe conditions, with the same arguments and
+ * results as WolfeLineSearch(), using the algorithm of Moré and Thuente
+ * (1994) as implemented in the subroutine dcsrch of MINPACK-2.
+ *
+ * Every trial step narrows an interval of uncertainty held as the step,
+ * function value and directional derivative at each end, so no
+ * evaluation is discarded by a restart, and until a minimizer is
+ * bracketed the search extrapolates from the trials already made.  A
+ * trial at which the function cannot be evaluated becomes an upper bound
+ * on the step, and the search continues from the best step so far.  The
+ * final trial is the returned point, so its gradient serves as the
+ * gradient of the next iterate.
+ *
+ * @tparam FunctorType A type which supports being called as
+ *        ret = func(x,f,g)
+ * where x is the input point, f and g are the function value and
+ * gradient at x and ret is non-zero if function evaluation fails.
+ *
+ * @tparam Scalar A scalar type
+ *
+ * @tparam XType A scalar type
+ *
+ * @param func Function which is being minimized.
+ *
+ * @param alpha First value of \f$ \alpha \f$ to try.  Upon return this
+ * contains the final value of the \f$ \alpha \f$.
+ *
+ * @param x1 Final point, equal to \f$ x_0 + \alpha p \f$.
+ *
+ * @param func_val Final point function value, equal to \f$ f(x_0 + \alpha p)
+ *\f$.
+ *
+ * @param gradx1 Final point gradient, equal to \f$ g(x_0 + \alpha p) \f$.
+ *
+ * @param p Search direction.  It is assumed to be a descent direction such
+ * that \f$ p^T g(x_0) < 0 \f$.
+ *
+ * @param x0 Value of starting point, \f$ x_0 \f$.
+ *
+ * @param f0 Value of function at starting point, \f$ f(x_0) \f$.
+ *
+ * @param gradx0 Value of function gradient at starting point,
+ *    \f$ g(x_0) \f$.
+ *
+ * @param c1 Parameter of the Wolfe conditions. \f$ 0 < c_1 < c_2 < 1 \f$
+ * Typically c1 = 1e-4.
+ *
+ * @param c2 Parameter of the Wolfe conditions. \f$ 0 < c_1 < c_2 < 1 \f$
+ * Typically c2 = 0.9.
+ *
+ * @param minAlpha Smallest allowable step-size.
+ *
+ * @param maxLSIts Maximum number of function evaluations.
+ *
+ * @param maxLSRestarts Maximum number of consecutive trials at which
+ * \f$ f() \f$ fails.
+ *
+ * @return Returns zero on success, non-zero otherwise.
+ **/
+template <typename FunctorType, typename Scalar, typename XType>
+int MoreThuenteLineSearch(FunctorType &func, Scalar &alpha, XType &x1,
+                          Scalar &func_val, XType &gradx1, const XType &p,
+                          const XType &x0, const Scalar &f0,
+                          const XType &gradx0, const Scalar &c1,
+                          const Scalar &c2, const Scalar &minAlpha,
+                          const Scalar &maxLSIts,
+                          const Scalar &maxLSRestarts) {
+  const Scalar xtrapl(1.1), xtrapu(4.0);
+  const Scalar xtol(std::numeric_limits<Scalar>::epsilon());
+  const Scalar dfp(gradx0.dot(p));
+  const Scalar c1dfp(c1 * dfp);
+  if (!(dfp < 0))
+    return 1;
+
+  // Largest step, lowered to any step at which f() fails
+  Scalar maxAlpha(std::numeric_limits<Scalar>::max());
+  Scalar stp(std::max(alpha, minAlpha));
+  bool brackt(false);
+  int stage(1), nits(0), lsRestarts(0);
+  Scalar width(maxAlpha - minAlpha), width1(2 * width);
+
+  // Step, function value and directional derivative at the best step
+  // and at the other end of the interval of uncertainty
+  Scalar stx(0), fx(f0), dx(dfp);
+  Scalar sty(0), fy(f0), dy(dfp);
+  Scalar stmin(0), stmax(stp + xtrapu * stp);
+
+  while (1) {
+    if (nits >= maxLSIts)
+      return 1;
+    nits++;
+
+    x1.noalias() = x0 + stp * p;
+    if (func(x1, func_val, gradx1) != 0) {
+      if (lsRestarts >= maxLSRestarts)
+        return 1;
+      lsRestarts++;
+      maxAlpha = stp;
+      stp = stx + 0.5 * (stp - stx);
+      if (stp <= minAlpha || std::fabs(stp - stx) <= xtol * stp)
+        return 1;
+      continue;
+    }
+    lsRestarts = 0;
+
+    const Scalar fp(func_val);
+    const Scalar dp(gradx1.dot(p));
+    const Scalar ftest(f0 + stp * c1dfp);
+    if (stage == 1 && fp <= ftest && dp >= 0)
+      stage = 2;
+
+    if (fp <= ftest && std::fabs(dp) <= -c2 * dfp) {
+      alpha = stp;
+      return 0;
+    }
+    if (brackt && (stp <= stmin || stp >= stmax))
+      return 1;
+    if (brackt && stmax - stmin <= xtol * stmax)
+      return 1;
+    if (stp == minAlpha && (fp > ftest || dp >= c1dfp))
+      return 1;
+
+    if (stage == 1 && fp <= fx && fp > ftest) {
+      // Use the function modified to have its minimizer where the
+      // sufficient decrease condition holds
+      Scalar fxm(fx - stx * c1dfp), fym(fy - sty * c1dfp);
+      Scalar dxm(dx - c1dfp), dym(dy - c1dfp);
+      MoreThuenteStep(stx, fxm, dxm, sty, fym, dym, stp, fp - stp * c1dfp,
+                      dp - c1dfp, brackt, stmin, stmax);
+      fx = fxm + stx * c1dfp;
+      fy = fym + sty * c1dfp;
+      dx = dxm + c1dfp;
+      dy = dym + c1dfp;
+    } else {
+      MoreThuenteStep(stx, fx, dx, sty, fy, dy, stp, fp, dp, brackt, stmin,
+                      stmax);
+    }
+
+    if (brackt) {
+      // Bisect if the interval did not shrink enough
+      if (std::fabs(sty - stx) >= 0.66 * width1)
+        stp = stx + 0.5 * (sty - stx);
+      width1 = width;
+      width = std::fabs(sty - stx);
+      stmin = std::min(stx, sty);
+      stmax = std::max(stx, sty);
+    } else {
+      stmin = stp + xtrapl * (stp - stx);
+      stmax = stp + xtrapu * (stp - stx);
+    }
+
+    stp = std::max(minAlpha, std::min(stp, maxAlpha));
+    if (stp == maxAlpha)
+      stp = stx + 0.5 * (maxAlpha - stx);
+    if ((brackt && (stp <= stmin || stp >= stmax))
+        || (brackt && stmax - stmin <= xtol * stmax))
+      stp = stx;
+  }
+}
 }  // namespace optimization
 }  // namespace stan
 
@@ -0,0 +1,242 @@
+#ifndef STAN_OPTIMIZATION_COMPACT_LBFGS_UPDATE_HPP
+#define STAN_OPTIMIZATION_COMPACT_LBFGS_UPDATE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace stan {
+namespace optimization {
+/**
+ * Implement a limited memory version of the BFGS update using the
+ * compact representation of Byrd, Nocedal and Schnabel (1994),
+ *
+ * H = gamma I + [S  gamma Y] [R^-T (D + gamma Y'Y) R^-1   -R^-T] [S'      ]
+ *                             [-R^-1                          0 ] [gamma Y']
+ *
+ * where R is the upper triangle of S'Y and D its diagonal.  This is a
+ * drop-in replacement for <code>LBFGSUpdate</code> that computes the
+ * same search direction.
+ *
+ * The update vectors are kept as the columns of two ring matrices, so
+ * a search direction takes two matrix-vector products with the whole
+ * history to form S'g and Y'g, two more to form the direction and some
+ * work on matrices of the size of the history.  The inner products
+ * between update vectors making up S'Y and Y'Y are computed once, when
+ * a vector is added.  Every product with the history is a single
+ * blocked product over contiguous memory instead of a walk over
+ * separately allocated vectors.
+ **/
+template <typename Scalar = double, int DimAtCompile = Eigen::Dynamic>
+class CompactLBFGSUpdate {
+ public:
+  typedef Eigen::Matrix<Scalar, DimAtCompile, 1> VectorT;
+  typedef Eigen::Matrix<Scalar, DimAtCompile, DimAtCompile> HessianT;
+  typedef Eigen::Matrix<Scalar, DimAtCompile, Eigen::Dynamic> HistoryT;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> SmallMatrixT;
+  typedef Eigen::Matrix<Scalar, Eigen::Dynamic, 1> SmallVectorT;
+
+  explicit CompactLBFGSUpdate(size_t L = 5)
+      : _capacity(L), _size(0), _oldest(0), _gammak(1.0) {}
+
+  /**
+   * Set the number of inverse Hessian updates to keep.  The most
+   * recent updates are kept when the history shrinks.
+   *
+   * @param L New size of buffer.
+   **/
+  void set_history_size(size_t L) {
+    size_t keep = std::min(_size, L);
+    if (_S.cols() > 0) {
+      HistoryT S(_S.rows(), L), Y(_Y.rows(), L);
+      SmallMatrixT SY(L, L), YY(L, L);
+      std::vector<size_t> order(keep);
+      for (size_t i = 0; i < keep; ++i)
+        order[i] = slot(_size - keep + i);
+      for (size_t i = 0; i < keep; ++i) {
+        S.col(i) = _S.col(order[i]);
+        Y.col(i) = _Y.col(order[i]);
+        for (size_t j = 0; j < keep; ++j) {
+          SY(i, j) = _SY(order[i], order[j]);
+          YY(i, j) = _YY(order[i], order[j]);
+        }
+      }
+      _S.swap(S);
+      _Y.swap(Y);
+      _SY.swap(SY);
+      _YY.swap(YY);
+    }
+    _capacity = L;
+    _size = keep;
+    _oldest = 0;
+  }
+
+  /**
+   * Return the number of inverse Hessian updates kept.
+   **/
+  size_t history_size() const noexcept { return _capacity; }
+
+  /**
+   * Return the scaling of the initial inverse Hessian approximation,
+   * <code>s'y / y'y</code> for the latest update.
+   **/
+  Scalar gamma() const noexcept { return _gammak; }
+
+  /**
+   * Copy the update vectors of the history, oldest first, to the
+   * columns of two matrices.
+   *
+   * @param[out] S Differences between consecutive state vectors.
+   * @param[out] Y Differences between consecutive gradient vectors.
+   **/
+  void history(HistoryT &S, HistoryT &Y) const {
+    S.resize(_S.rows(), _size);
+    Y.resize(_Y.rows(), _size);
+    for (size_t i = 0; i < _size; ++i) {
+      S.col(i) = _S.col(slot(i));
+      Y.col(i) = _Y.col(slot(i));
+    }
+  }
+
+  /**
+   * Add a new set of update vectors to the history.
+   *
+   * @param yk Difference between the current and previous gradient vector.
+   * @param sk Difference between the current and previous state vector.
+   * @param reset Whether to reset the approximation, forgetting about
+   * previous values.
+   * @return In the case of a reset, returns the optimal scaling of the
+   * initial Hessian
+   * approximation which is useful for predicting step-sizes.
+   **/
+  inline Scalar update(const VectorT &yk, const VectorT &sk,
+                       bool reset = false) {
+    Scalar skyk = yk.dot(sk);
+
+    Scalar B0fact;
+    if (reset) {
+      B0fact = yk.squaredNorm() / skyk;
+      _size = 0;
+      _oldest = 0;
+    } else {
+      B0fact = 1.0;
+    }
+    _gammak = skyk / yk.squaredNorm();
+    if (_capacity == 0)
+      return B0fact;
+
+    if (_S.rows() != yk.size()
+        || _S.cols() != static_cast<Eigen::Index>(_capacity)) {
+      _S.resize(yk.size(), _capacity);
+      _Y.resize(yk.size(), _capacity);
+      _SY.resize(_capacity, _capacity);
+      _YY.resize(_capacity, _capacity);
+      _size = 0;
+      _oldest = 0;
+    }
+
+    // New updates overwrite the oldest slot once the history is full
+    size_t c;
+    if (_size < _capacity) {
+      c = slot(_size);
+      ++_size;
+    } else {
+      c = _oldest;
+      _oldest = (_oldest + 1) % _capacity;
+    }
+    _S.col(c) = sk;
+    _Y.col(c) = yk;
+
+    // Inner products of the new vectors with every stored vector, in
+    // storage order.  The slots in use are always the first _size.
+    const Eigen::Index used = _size;
+    _tmp.noalias() = _S.leftCols(used).transpose() * yk;
+    _SY.col(c).head(used) = _tmp;
+    _tmp.noalias() = _Y.leftCols(used).transpose() * sk;
+    _SY.row(c).head(used) = _tmp.transpose();
+    _tmp.noalias() = _Y.leftCols(used).transpose() * yk;
+    _YY.col(c).head(used) = _tmp;
+    _YY.row(c).head(used) = _tmp.transpose();
+    _SY(c, c) = skyk;
+
+    return B0fact;
+  }
+
+  /**
+   * Compute the search direction based on the current (inverse) Hessian
+   * approximation and given gradient.
+   *
+   * @param[out] pk The negative product of the inverse Hessian and gradient
+   * direction gk.
+   * @param[in] gk Gradient direction.
+   **/
+  inline void search_direction(VectorT &pk, const VectorT &gk) const {
+    const Eigen::Index m = _size;
+    if (m == 0) {
+      pk.noalias() = -_gammak * gk;
+      return;
+    }
+    // S'g and Y'g over every used slot in one product each
+    _Stg.noalias() = _S.leftCols(m).transpose() * gk;
+    _Ytg.noalias() = _Y.leftCols(m).transpose() * gk;
+
+    // Gather the small matrices in chronological order
+    _R.resize(m, m);
+    _YtY.resize(m, m);
+    _a.resize(m);
+    _b.resize(m);
+    for (Eigen::Index i = 0; i < m; ++i) {
+      const size_t si = slot(i);
+      _a(i) = _Stg(si);
+      _b(i) = _gammak * _Ytg(si);
+      for (Eigen::Index j = 0; j < m; ++j) {
+        const size_t sj = slot(j);
+        _R(i, j) = i <= j ? _SY(si, sj) : 0;
+        _YtY(i, j) = _YY(si, sj);
+      }
+    }
+
+    // lower = -R^-1 a, upper = R^-T ((D + gamma Y'Y) R^-1 a - gamma Y'g)
+    auto R = _R.template triangularView<Eigen::Upper>();
+    _lower = R.solve(_a);
+    _upper.noalias() = _gammak * (_YtY * _lower);
+    _upper += _R.diagonal().cwiseProduct(_lower) - _b;
+    R.transpose().solveInPlace(_upper);
+    _lower = -_lower;
+
+    // Scatter the coefficients back to storage order
+    _coef_s.resize(m);
+    _coef_y.resize(m);
+    for (Eigen::Index i = 0; i < m; ++i) {
+      _coef_s(slot(i)) = _upper(i);
+      _coef_y(slot(i)) = _gammak * _lower(i);
+    }
+
+    pk.noalias() = -_gammak * gk;
+    pk.noalias() -= _S.leftCols(m) * _coef_s;
+    pk.noalias() -= _Y.leftCols(m) * _coef_y;
+  }
+
+ protected:
+  size_t _capacity;
+  size_t _size;
+  size_t _oldest;
+  Scalar _gammak;
+  HistoryT _S;
+  HistoryT _Y;
+  SmallMatrixT _SY;
+  SmallMatrixT _YY;
+  SmallVectorT _tmp;
+
+  mutable SmallVectorT _Stg, _Ytg, _a, _b, _lower, _upper, _coef_s, _coef_y;
+  mutable SmallMatrixT _R, _YtY;
+
+  /**
+   * Return the storage column of the i-th oldest update.
+   **/
+  size_t slot(size_t i) const noexcept { return (_oldest + i) % _capacity; }
+};
+}  // namespace optimization
+}  // namespace stan
+
+#endif
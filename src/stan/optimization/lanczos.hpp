@@ -0,0 +1,99 @@
+#ifndef STAN_OPTIMIZATION_LANCZOS_HPP
+#define STAN_OPTIMIZATION_LANCZOS_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace stan {
+namespace optimization {
+
+/**
+ * Approximate eigenvalues and eigenvectors of a symmetric matrix that is
+ * only available through its product with vectors, by the Lanczos
+ * method with full reorthogonalization.
+ *
+ * The Krylov subspace of the specified rank is built from a random
+ * starting vector, and the Ritz pairs of the matrix in that subspace are
+ * returned.  They approximate the eigenvalues at both ends of the
+ * spectrum best, and are exact when the rank is the size of the matrix.
+ * If the subspace becomes invariant before reaching the rank, it is
+ * extended with a new random vector.  The cost is <code>rank</code>
+ * products and O(<code>n * rank^2</code>) operations for the
+ * reorthogonalization, and the memory used is that of the
+ * <code>n</code> by <code>rank</code> basis.
+ *
+ * @tparam F type of the product functor, callable as
+ * <code>product(const Eigen::VectorXd& v, Eigen::VectorXd& Av)</code>
+ * @tparam RNG type of random number generator
+ * @param[in] product functor writing the product of the matrix with a
+ * vector
+ * @param[in] n number of rows and columns of the matrix
+ * @param[in] rank number of eigenpairs, which is reduced to
+ * <code>n</code> if more
+ * @param[in, out] rng random number generator for the starting vectors
+ * @param[out] eigenvalues approximate eigenvalues in increasing order
+ * @param[out] eigenvectors orthonormal approximate eigenvectors, one per
+ * column
+ */
+template <typename F, typename RNG>
+void lanczos_eigen(const F& product, Eigen::Index n, Eigen::Index rank,
+                   RNG& rng, Eigen::VectorXd& eigenvalues,
+                   Eigen::MatrixXd& eigenvectors) {
+  const Eigen::Index m = std::max<Eigen::Index>(0, std::min(rank, n));
+  Eigen::MatrixXd basis(n, m);
+  Eigen::VectorXd alpha = Eigen::VectorXd::Zero(m);
+  Eigen::VectorXd beta = Eigen::VectorXd::Zero(m);
+  boost::random::normal_distribution<double> std_normal;
+
+  // make a random unit vector orthogonal to the first j basis vectors
+  auto random_start = [&](Eigen::Index j) {
+    Eigen::VectorXd v(n);
+    for (Eigen::Index i = 0; i < n; ++i)
+      v(i) = std_normal(rng);
+    for (int pass = 0; pass < 2; ++pass)
+      v -= basis.leftCols(j) * (basis.leftCols(j).transpose() * v);
+    return Eigen::VectorXd(v / v.norm());
+  };
+
+  Eigen::VectorXd w(n);
+  for (Eigen::Index j = 0; j < m; ++j) {
+    if (j == 0)
+      basis.col(0) = random_start(0);
+    product(basis.col(j), w);
+    alpha(j) = basis.col(j).dot(w);
+    w -= alpha(j) * basis.col(j);
+    if (j > 0)
+      w -= beta(j - 1) * basis.col(j - 1);
+    // twice is enough to keep the basis orthogonal to working precision
+    for (int pass = 0; pass < 2; ++pass)
+      w -= basis.leftCols(j + 1) * (basis.leftCols(j + 1).transpose() * w);
+    if (j + 1 == m)
+      break;
+    const double norm = w.norm();
+    const double scale = std::max(1.0, std::fabs(alpha(j)));
+    if (norm > 1e-10 * scale) {
+      beta(j) = norm;
+      basis.col(j + 1) = w / norm;
+    } else {
+      // the subspace is invariant, so carry on from a new direction
+      beta(j) = 0;
+      basis.col(j + 1) = random_start(j + 1);
+    }
+  }
+
+  Eigen::MatrixXd tridiagonal = Eigen::MatrixXd::Zero(m, m);
+  tridiagonal.diagonal() = alpha;
+  if (m > 1) {
+    tridiagonal.diagonal(1) = beta.head(m - 1);
+    tridiagonal.diagonal(-1) = beta.head(m - 1);
+  }
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(tridiagonal);
+  eigenvalues = solver.eigenvalues();
+  eigenvectors = basis * solver.eigenvectors();
+}
+
+}  // namespace optimization
+}  // namespace stan
+#endif
@@ -30,6 +30,31 @@ class LBFGSUpdate {
    **/
   void set_history_size(size_t L) { _buf.rset_capacity(L); }
 
+  /**
+   * Return the scaling of the initial inverse Hessian approximation,
+   * <code>s'y / y'y</code> for the latest update.
+   **/
+  Scalar gamma() const { return _gammak; }
+
+  /**
+   * Copy the update vectors of the history, oldest first, to the
+   * columns of two matrices.
+   *
+   * @param[out] S Differences between consecutive state vectors.
+   * @param[out] Y Differences between consecutive gradient vectors.
+   **/
+  void history(Eigen::Matrix<Scalar, DimAtCompile, Eigen::Dynamic> &S,
+               Eigen::Matrix<Scalar, DimAtCompile, Eigen::Dynamic> &Y) const {
+    const Eigen::Index m = _buf.size();
+    const Eigen::Index n = m > 0 ? std::get<2>(_buf.front()).size() : S.rows();
+    S.resize(n, m);
+    Y.resize(n, m);
+    for (Eigen::Index i = 0; i < m; ++i) {
+      Y.col(i) = std::get<1>(_buf[i]);
+      S.col(i) = std::get<2>(_buf[i]);
+    }
+  }
+
   /**
    * Add a new set of update vectors to the history.
    *
@@ -2,8 +2,13 @@
 #define STAN_OPTIMIZATION_NEWTON_HPP
 
 #include <stan/model/grad_hess_log_prob.hpp>
+#include <stan/model/hessian_times_vector.hpp>
 #include <stan/model/log_prob_grad.hpp>
+#include <stan/model/sparse_hessian.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <Eigen/SparseCholesky>
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 namespace stan {
@@ -71,6 +76,119 @@ double newton_step(M& model, std::vector<double>& params_r,
   return f1;
 }
 
+namespace internal {
+// Product of the Hessian of the log density at a point with a vector,
+// which writes no messages so that it can be called concurrently
+template <typename M, bool jacobian>
+struct log_prob_hessian_times_vector {
+  const M& model;
+  const vector_d& x;
+  void operator()(const vector_d& v, vector_d& hess_v) const {
+    double f;
+    stan::model::hessian_times_vector<true, jacobian>(model, x, v, f, hess_v,
+                                                      nullptr);
+  }
+};
+}  // namespace internal
+
+/**
+ * Detect the sparsity pattern of the Hessian of the log density of the
+ * model at the specified parameters, for <code>sparse_newton_step</code>,
+ * with one Hessian-vector product per parameter.
+ *
+ * @tparam M type of model
+ * @tparam jacobian `true` to include the Jacobian adjustment
+ * @param[in] model model
+ * @param[in] params_r unconstrained parameters
+ * @return pattern of the Hessian with its coloring
+ */
+template <typename M, bool jacobian = false>
+stan::model::hessian_sparsity newton_hessian_sparsity(
+    const M& model, const std::vector<double>& params_r) {
+  vector_d x = Eigen::Map<const vector_d>(params_r.data(), params_r.size());
+  return stan::model::detect_hessian_sparsity(
+      internal::log_prob_hessian_times_vector<M, jacobian>{model, x},
+      x.size());
+}
+
+/**
+ * Take a step of the Newton method with a sparse Hessian, as
+ * <code>newton_step</code> does with a dense one.  The Hessian is
+ * computed by <code>stan::model::sparse_hessian</code> from one
+ * Hessian-vector product per color of the specified sparsity pattern,
+ * and the Newton system is solved by a sparse Cholesky decomposition of
+ * the negative Hessian.  Where that is not positive definite, a multiple
+ * of the identity, from a thousandth of the largest diagonal magnitude
+ * up by factors of ten, is added until it is, which keeps the step an
+ * ascent direction.  The step is then halved until the log density does
+ * not decrease.
+ *
+ * @tparam M type of model
+ * @tparam jacobian `true` to include the Jacobian adjustment
+ * @param[in] model model
+ * @param[in,out] params_r unconstrained parameters
+ * @param[in] params_i integer parameters
+ * @param[in] sparsity sparsity pattern of the Hessian with its coloring
+ * @param[in,out] output_stream stream for messages of the gradients
+ * @return log density at the updated parameters
+ */
+template <typename M, bool jacobian = false>
+double sparse_newton_step(M& model, std::vector<double>& params_r,
+                          std::vector<int>& params_i,
+                          const stan::model::hessian_sparsity& sparsity,
+                          std::ostream* output_stream = 0) {
+  std::vector<double> gradient;
+  double f0 = stan::model::log_prob_grad<true, jacobian>(
+      model, params_r, params_i, gradient, output_stream);
+  vector_d x = Eigen::Map<const vector_d>(params_r.data(), params_r.size());
+  Eigen::SparseMatrix<double> H;
+  stan::model::sparse_hessian(
+      internal::log_prob_hessian_times_vector<M, jacobian>{model, x},
+      sparsity, H);
+  Eigen::SparseMatrix<double> neg_H = -H;
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Lower,
+                       Eigen::AMDOrdering<int>>
+      llt;
+  llt.analyzePattern(neg_H);
+  llt.factorize(neg_H);
+  double shift = 0;
+  const double max_diagonal = neg_H.diagonal().cwiseAbs().maxCoeff();
+  Eigen::SparseMatrix<double> identity(neg_H.rows(), neg_H.cols());
+  identity.setIdentity();
+  while (llt.info() != Eigen::Success) {
+    shift = shift == 0 ? 1e-3 * std::max(max_diagonal, 1e-8) : 10 * shift;
+    if (!std::isfinite(shift))
+      return f0;
+    llt.factorize(neg_H + shift * identity);
+  }
+  vector_d g = Eigen::Map<const vector_d>(gradient.data(), gradient.size());
+  g = llt.solve(g);
+
+  std::vector<double> new_params_r(params_r.size());
+  double step_size = 2;
+  double min_step_size = 1e-50;
+  double f1 = -1e100;
+
+  while (f1 < f0) {
+    step_size *= 0.5;
+    if (step_size < min_step_size)
+      return f0;
+
+    for (size_t i = 0; i < params_r.size(); i++)
+      new_params_r[i] = params_r[i] + step_size * g[i];
+    try {
+      f1 = stan::model::log_prob_grad<true, jacobian>(model, new_params_r,
+                                                      params_i, gradient);
+    } catch (std::domain_error& e) {
+      f1 = -1e100;
+    }
+  }
+  for (size_t i = 0; i < params_r.size(); i++)
+    params_r[i] = new_params_r[i];
+
+  return f1;
+}
+
 }  // namespace optimization
 }  // namespace stan
 #endif
@@ -0,0 +1,193 @@
+#ifndef STAN_OPTIMIZATION_STOCHASTIC_GRADIENT_HPP
+#define STAN_OPTIMIZATION_STOCHASTIC_GRADIENT_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace stan {
+namespace optimization {
+
+/**
+ * Update rule of <code>stochastic_gradient</code>.
+ */
+enum class stochastic_method {
+  /**
+   * Adam: steps along the bias-corrected moving average of the gradients,
+   * scaled elementwise by the square root of the moving average of their
+   * squares.
+   */
+  adam,
+  /**
+   * AdaGrad: steps along the gradient, scaled elementwise by the square
+   * root of the sum of the squares of all of the gradients so far.
+   */
+  adagrad
+};
+
+/**
+ * Decay of the learning rate of <code>stochastic_gradient</code> with the
+ * iterations <code>t = 1, 2, ...</code>.
+ */
+enum class learning_rate_schedule {
+  /** The learning rate itself. */
+  constant,
+  /** The learning rate divided by <code>sqrt(t)</code>. */
+  inverse_sqrt,
+  /**
+   * The learning rate times <code>(1 + cos(pi t / T)) / 2</code>, which
+   * decays to zero at the end <code>T</code> of the schedule and stays
+   * there.
+   */
+  cosine
+};
+
+/**
+ * Settings of <code>stochastic_gradient</code>.
+ */
+struct stochastic_gradient_options {
+  stochastic_method method = stochastic_method::adam;
+  /** Largest step size of a parameter, before the schedule. */
+  double learning_rate = 0.01;
+  learning_rate_schedule schedule = learning_rate_schedule::constant;
+  /** Number of iterations of the cosine schedule. */
+  int schedule_length = 1000;
+  /** Decay of the moving average of the gradients of Adam. */
+  double beta1 = 0.9;
+  /** Decay of the moving average of the squared gradients of Adam. */
+  double beta2 = 0.999;
+  /** Added to the scale of the steps to keep it positive. */
+  double epsilon = 1e-8;
+  /**
+   * Number of iterations after which the iterates are averaged, or a
+   * negative number not to average them.
+   */
+  int averaging_start = -1;
+};
+
+/**
+ * Minimize a function from noisy estimates of its gradient, such as the
+ * gradients of the log density of minibatches of the data, by Adam or
+ * AdaGrad.
+ *
+ * The caller evaluates the gradient at <code>x()</code> and passes it to
+ * <code>step</code>, so the source of the gradients is up to it.  With
+ * averaging, <code>average()</code> is the Polyak average of the iterates
+ * after the first <code>averaging_start</code> ones, which is a less
+ * noisy estimate of the minimum than the last iterate once the iterates
+ * wander around it.
+ */
+class stochastic_gradient {
+ public:
+  /**
+   * Start from the specified parameters.
+   *
+   * @param[in] x initial parameters
+   * @param[in] options settings
+   * @throw std::invalid_argument if the learning rate or epsilon is not
+   *   positive, the decays are not in [0, 1), or the cosine schedule has
+   *   no iterations
+   */
+  stochastic_gradient(const Eigen::VectorXd& x,
+                      const stochastic_gradient_options& options)
+      : options_(options),
+        x_(x),
+        m_(Eigen::VectorXd::Zero(x.size())),
+        v_(Eigen::VectorXd::Zero(x.size())),
+        average_(x) {
+    if (!(options_.learning_rate > 0))
+      throw std::invalid_argument("learning rate must be positive");
+    if (!(options_.epsilon > 0))
+      throw std::invalid_argument("epsilon must be positive");
+    if (!(options_.beta1 >= 0 && options_.beta1 < 1)
+        || !(options_.beta2 >= 0 && options_.beta2 < 1))
+      throw std::invalid_argument("beta1 and beta2 must be in [0, 1)");
+    if (options_.schedule == learning_rate_schedule::cosine
+        && options_.schedule_length <= 0)
+      throw std::invalid_argument("schedule length must be positive");
+  }
+
+  /**
+   * Take a step from the current parameters with the specified gradient of
+   * the function at them.
+   *
+   * @param[in] g gradient
+   */
+  void step(const Eigen::VectorXd& g) {
+    ++iter_;
+    const double rate = learning_rate(iter_);
+    if (options_.method == stochastic_method::adagrad) {
+      v_ += g.cwiseProduct(g);
+      x_.array() -= rate * g.array() / (v_.array().sqrt() + options_.epsilon);
+    } else {
+      m_ = options_.beta1 * m_ + (1 - options_.beta1) * g;
+      v_ = options_.beta2 * v_ + (1 - options_.beta2) * g.cwiseProduct(g);
+      const double m_scale = 1 / (1 - std::pow(options_.beta1, iter_));
+      const double v_scale = 1 / (1 - std::pow(options_.beta2, iter_));
+      x_.array() -= rate * m_scale * m_.array()
+                    / ((v_scale * v_.array()).sqrt() + options_.epsilon);
+    }
+    if (options_.averaging_start >= 0 && iter_ > options_.averaging_start) {
+      ++num_averaged_;
+      average_ += (x_ - average_) / num_averaged_;
+    } else {
+      average_ = x_;
+    }
+  }
+
+  /**
+   * Return the learning rate of the specified iteration.
+   *
+   * @param[in] t iteration, from one
+   */
+  double learning_rate(int t) const {
+    switch (options_.schedule) {
+      case learning_rate_schedule::inverse_sqrt:
+        return options_.learning_rate / std::sqrt(std::max(t, 1));
+      case learning_rate_schedule::cosine: {
+        const double frac
+            = std::min(1.0, static_cast<double>(t) / options_.schedule_length);
+        return options_.learning_rate * 0.5 * (1 + std::cos(M_PI * frac));
+      }
+      default:
+        return options_.learning_rate;
+    }
+  }
+
+  /**
+   * Return the current parameters, at which the next gradient is
+   * evaluated.
+   */
+  const Eigen::VectorXd& x() const noexcept { return x_; }
+
+  /**
+   * Return the average of the iterates after the first
+   * <code>averaging_start</code> ones, or the current parameters until
+   * then or without averaging.
+   */
+  const Eigen::VectorXd& average() const noexcept { return average_; }
+
+  /**
+   * Return the number of steps taken.
+   */
+  int iter_num() const noexcept { return iter_; }
+
+  /**
+   * Return the number of iterates averaged.
+   */
+  int num_averaged() const noexcept { return num_averaged_; }
+
+ private:
+  stochastic_gradient_options options_;
+  Eigen::VectorXd x_;
+  Eigen::VectorXd m_;
+  Eigen::VectorXd v_;
+  Eigen::VectorXd average_;
+  int iter_ = 0;
+  int num_averaged_ = 0;
+};
+
+}  // namespace optimization
+}  // namespace stan
+#endif
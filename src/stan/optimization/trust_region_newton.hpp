@@ -0,0 +1,158 @@
+#ifndef STAN_OPTIMIZATION_TRUST_REGION_NEWTON_HPP
+#define STAN_OPTIMIZATION_TRUST_REGION_NEWTON_HPP
+
+#include <stan/model/hessian_times_vector.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace optimization {
+
+/**
+ * Approximately minimize the quadratic model
+ * <code>g' p + p' H p / 2</code> over the steps <code>p</code> within the
+ * specified radius, by the conjugate gradient method of Steihaug, for a
+ * symmetric matrix <code>H</code> that is only available through its
+ * product with vectors.
+ *
+ * The iterations start from zero and stop once the residual is below the
+ * tolerance, or at the boundary when an iterate would leave the region or
+ * a direction of negative curvature is found, so each costs one product
+ * and no Hessian is formed.
+ *
+ * @tparam F type of the product functor, callable as
+ * <code>product(const Eigen::VectorXd& v, Eigen::VectorXd& Hv)</code>
+ * @param[in] product functor writing the product of the matrix with a
+ * vector
+ * @param[in] g gradient of the quadratic model at zero
+ * @param[in] radius radius of the trust region
+ * @param[in] tol tolerance on the norm of the residual
+ * @param[in] max_iterations largest number of iterations
+ * @param[out] p step
+ * @return value of the quadratic model at the step, at most zero
+ */
+template <typename F>
+double steihaug_cg(const F& product, const Eigen::VectorXd& g, double radius,
+                   double tol, int max_iterations, Eigen::VectorXd& p) {
+  p = Eigen::VectorXd::Zero(g.size());
+  Eigen::VectorXd r = g;
+  Eigen::VectorXd d = -r;
+  Eigen::VectorXd Hd(g.size());
+  double rr = r.squaredNorm();
+  double value = 0;
+  // largest tau with |p + tau d| = radius
+  auto to_boundary = [&]() {
+    const double pd = p.dot(d);
+    const double dd = d.squaredNorm();
+    const double pp = p.squaredNorm();
+    return (-pd + std::sqrt(pd * pd + dd * (radius * radius - pp))) / dd;
+  };
+  for (int j = 0; j < max_iterations && std::sqrt(rr) > tol; ++j) {
+    product(d, Hd);
+    const double dHd = d.dot(Hd);
+    const double rd = r.dot(d);
+    double alpha = rr / dHd;
+    bool boundary = false;
+    if (!(dHd > 0) || (p + alpha * d).norm() >= radius) {
+      alpha = to_boundary();
+      boundary = true;
+    }
+    value += alpha * rd + 0.5 * alpha * alpha * dHd;
+    p += alpha * d;
+    if (boundary)
+      break;
+    r += alpha * Hd;
+    const double rr_new = r.squaredNorm();
+    d = -r + (rr_new / rr) * d;
+    rr = rr_new;
+  }
+  return value;
+}
+
+/**
+ * Take a step of the trust-region Newton method with the truncated
+ * conjugate gradient solver of Steihaug, maximizing the log density of
+ * the model from the specified parameters, which are updated.
+ *
+ * The products of the Hessian with vectors come from
+ * <code>stan::model::hessian_times_vector</code>, so the cost of a step
+ * is a gradient and a few products for each conjugate gradient iteration,
+ * without the Hessian.  A trial step whose actual increase of the log
+ * density is less than a tenth of the increase the quadratic model
+ * predicts is rejected and the radius is shrunk; a step at the boundary
+ * whose prediction is good doubles the radius.  The parameters are left
+ * unchanged if the gradient vanishes or no step is accepted.
+ *
+ * @tparam M type of model
+ * @tparam jacobian `true` to include the Jacobian adjustment
+ * @param[in] model model
+ * @param[in,out] params_r unconstrained parameters
+ * @param[in,out] radius radius of the trust region
+ * @param[in] max_cg_iterations largest number of conjugate gradient
+ * iterations per trial step, the number of parameters if not positive
+ * @param[in,out] output_stream stream for messages of the model
+ * @return log density at the updated parameters
+ */
+template <typename M, bool jacobian = false>
+double trust_region_newton_step(M& model, std::vector<double>& params_r,
+                                double& radius, int max_cg_iterations = 0,
+                                std::ostream* output_stream = 0) {
+  const Eigen::Index n = params_r.size();
+  Eigen::VectorXd x = Eigen::Map<Eigen::VectorXd>(params_r.data(), n);
+  Eigen::VectorXd gradient;
+  double f0 = stan::model::log_prob_grad<true, jacobian>(model, x, gradient,
+                                                         output_stream);
+  // minimize the negative log density
+  Eigen::VectorXd g = -gradient;
+  const double g_norm = g.norm();
+  if (!(g_norm > 0))
+    return f0;
+  const double tol = std::min(0.5, std::sqrt(g_norm)) * g_norm;
+  if (max_cg_iterations <= 0)
+    max_cg_iterations = n;
+  auto product = [&](const Eigen::VectorXd& v, Eigen::VectorXd& Hv) {
+    double f;
+    stan::model::hessian_times_vector<true, jacobian>(model, x, v, f, Hv,
+                                                      output_stream);
+    Hv = -Hv;
+  };
+
+  const double min_radius = 1e-50;
+  Eigen::VectorXd p;
+  Eigen::VectorXd x1(n);
+  Eigen::VectorXd gradient1;
+  while (radius >= min_radius) {
+    const double predicted
+        = -steihaug_cg(product, g, radius, tol, max_cg_iterations, p);
+    if (!(predicted > 0))
+      return f0;
+    x1 = x + p;
+    double f1 = -std::numeric_limits<double>::infinity();
+    try {
+      f1 = stan::model::log_prob_grad<true, jacobian>(model, x1, gradient1,
+                                                      output_stream);
+    } catch (const std::domain_error& e) {
+      // a step out of the support is rejected
+    }
+    const double rho = (f1 - f0) / predicted;
+    const bool at_boundary = p.norm() >= 0.99 * radius;
+    if (!(rho >= 0.25))
+      radius = 0.25 * p.norm();
+    else if (rho > 0.75 && at_boundary)
+      radius *= 2;
+    if (rho >= 0.1) {
+      Eigen::Map<Eigen::VectorXd>(params_r.data(), n) = x1;
+      return f1;
+    }
+  }
+  return f0;
+}
+
+}  // namespace optimization
+}  // namespace stan
+#endif
@@ -0,0 +1,278 @@
+#ifndef STAN_SERVICES_DIAGNOSE_CALIBRATE_THREADS_HPP
+#define STAN_SERVICES_DIAGNOSE_CALIBRATE_THREADS_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace diagnose {
+
+/**
+ * Throughput of the gradient of a model with a number of concurrent
+ * chains, each with a number of threads for its own parallel work.
+ */
+struct thread_layout {
+  size_t num_chains = 1;
+  int threads_per_chain = 1;
+  /** Gradients evaluated per second by all of the chains. */
+  double gradients_per_second = 0;
+  /** Gradients evaluated per second by a chain, on average. */
+  double chain_gradients_per_second = 0;
+  /**
+   * Rate of a single chain with the same threads over the rate of a
+   * chain of this layout; above one when the chains contend for memory
+   * bandwidth, caches or cores.
+   */
+  double slowdown = 1;
+};
+
+/**
+ * Layouts timed by <code>calibrate_threads</code> and the one it
+ * recommends.
+ */
+struct thread_calibration {
+  std::vector<thread_layout> layouts;
+  thread_layout recommended;
+};
+
+namespace internal {
+
+/**
+ * Return 1, 2, 4, ... up to and including the specified maximum.
+ */
+inline std::vector<int> doubling_grid(int max) {
+  std::vector<int> grid;
+  for (int n = 1; n < max; n *= 2)
+    grid.push_back(n);
+  grid.push_back(max);
+  return grid;
+}
+
+/**
+ * Return the number of gradients per second of the log density of a
+ * model evaluated at the specified point for at least the specified time.
+ *
+ * @param[out] num_evals number of gradients timed
+ */
+template <class Model>
+double gradient_rate(const Model& model, const std::vector<double>& params,
+                     double seconds, size_t& num_evals) {
+  using clock = std::chrono::steady_clock;
+  std::vector<double> cont_vector(params);
+  std::vector<int> disc_vector;
+  std::vector<double> gradient;
+  std::stringstream msgs;
+  // the first evaluation allocates the autodiff memory of the thread
+  stan::model::log_prob_grad<true, true>(model, cont_vector, disc_vector,
+                                         gradient, &msgs);
+  num_evals = 0;
+  const clock::time_point start = clock::now();
+  double elapsed = 0;
+  do {
+    stan::model::log_prob_grad<true, true>(model, cont_vector, disc_vector,
+                                           gradient, &msgs);
+    ++num_evals;
+    msgs.str("");
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < seconds);
+  return num_evals / elapsed;
+}
+
+}  // namespace internal
+
+/**
+ * Times the gradient of the log density of a model at its initial point
+ * with different numbers of concurrent chains and of threads per chain,
+ * and recommends the layout of the multi-chain services.
+ *
+ * The chain counts 1, 2, 4, ... up to <code>max_chains</code> are
+ * crossed with the thread counts 1, 2, 4, ... up to
+ * <code>max_threads</code>, keeping the layouts with at most
+ * <code>max_threads</code> threads in all.  For each layout, every chain
+ * evaluates <code>stan::model::log_prob_grad</code> for
+ * <code>seconds_per_layout</code> seconds in its own TBB arena of
+ * <code>threads_per_chain</code> threads, which bounds the threads of the
+ * parallel work of the model, such as <code>reduce_sum</code> or
+ * <code>map_rect</code>, the way <code>util::chain_placement</code>
+ * does.  The chains run at once in an arena of one thread per chain.
+ *
+ * Each layout is written to <code>parameter_writer</code> as a row of
+ * <code>num_chains, threads_per_chain, gradients_per_second,
+ * chain_gradients_per_second, slowdown</code>, where the slowdown of a
+ * layout, the rate of a single chain with the same threads over the rate
+ * of its chains, measures their contention for memory bandwidth and
+ * caches.  The recommended layout is the one using the fewest threads in
+ * all among those within 5% of the largest throughput, so that threads
+ * that add little are left to other work; it is logged and returned in
+ * <code>calibration</code>, from which
+ * <code>util::chain_placement(recommended.num_chains,
+ * recommended.threads_per_chain)</code> configures the arenas of the
+ * multi-chain services.
+ *
+ * @tparam Model A model implementation
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] max_chains largest number of concurrent chains
+ * @param[in] max_threads largest number of threads in all, or zero or
+ *   less for the threads of the current TBB arena
+ * @param[in] seconds_per_layout time spent timing each layout
+ * @param[in,out] interrupt interrupt callback, called between layouts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] parameter_writer Writer callback for the timings
+ * @param[out] calibration timings and recommended layout, or null
+ * @return error_codes::OK if successful, error_codes::CONFIG if the
+ *   arguments or the initial values are invalid, error_codes::SOFTWARE if
+ *   the gradient fails
+ */
+template <class Model>
+int calibrate_threads(Model& model, const stan::io::var_context& init,
+                      unsigned int random_seed, unsigned int chain,
+                      double init_radius, int max_chains, int max_threads,
+                      double seconds_per_layout,
+                      callbacks::interrupt& interrupt,
+                      callbacks::logger& logger,
+                      callbacks::writer& init_writer,
+                      callbacks::writer& parameter_writer,
+                      thread_calibration* calibration = nullptr) {
+  if (max_threads < 1)
+    max_threads = tbb::this_task_arena::max_concurrency();
+  if (max_chains < 1 || !(seconds_per_layout > 0)) {
+    logger.error(
+        "max_chains and seconds_per_layout must be greater than 0.");
+    return error_codes::CONFIG;
+  }
+  max_chains = std::min(max_chains, max_threads);
+
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+  std::vector<double> cont_vector;
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, false,
+                                   logger, init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  logger.info("THREAD CALIBRATION MODE");
+  parameter_writer(std::vector<std::string>{
+      "num_chains", "threads_per_chain", "gradients_per_second",
+      "chain_gradients_per_second", "slowdown"});
+
+  thread_calibration result;
+  for (int threads : internal::doubling_grid(max_threads)) {
+    double single_chain_rate = 0;
+    for (int chains : internal::doubling_grid(max_chains)) {
+      if (chains * threads > max_threads)
+        break;
+      interrupt();
+      std::vector<double> rates(chains, 0);
+      std::vector<size_t> num_evals(chains, 0);
+      const auto start = std::chrono::steady_clock::now();
+      try {
+        tbb::task_arena chain_arena(chains);
+        chain_arena.execute([&] {
+          tbb::parallel_for(
+              tbb::blocked_range<size_t>(0, chains, 1),
+              [&](const tbb::blocked_range<size_t>& r) {
+                for (size_t i = r.begin(); i < r.end(); ++i) {
+                  tbb::task_arena thread_arena(threads);
+                  thread_arena.execute([&] {
+                    rates[i] = internal::gradient_rate(
+                        model, cont_vector, seconds_per_layout, num_evals[i]);
+                  });
+                }
+              },
+              tbb::simple_partitioner());
+        });
+      } catch (const std::exception& e) {
+        logger.error("Gradient evaluation failed:");
+        logger.error(e.what());
+        return error_codes::SOFTWARE;
+      }
+
+      // chains that could not run at once take longer in all
+      const double wall = std::chrono::duration<double>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+      thread_layout layout;
+      layout.num_chains = chains;
+      layout.threads_per_chain = threads;
+      size_t total_evals = 0;
+      for (size_t i = 0; i < rates.size(); ++i) {
+        total_evals += num_evals[i];
+        layout.chain_gradients_per_second += rates[i] / chains;
+      }
+      layout.gradients_per_second = total_evals / wall;
+      if (chains == 1)
+        single_chain_rate = layout.chain_gradients_per_second;
+      layout.slowdown = single_chain_rate / layout.chain_gradients_per_second;
+      result.layouts.push_back(layout);
+
+      std::stringstream msg;
+      msg << std::setw(4) << chains << " chains x " << std::setw(3) << threads
+          << " threads: " << std::setprecision(6)
+          << layout.gradients_per_second << " gradients/s, slowdown "
+          << std::setprecision(3) << layout.slowdown;
+      logger.info(msg);
+      parameter_writer(std::vector<double>{
+          static_cast<double>(chains), static_cast<double>(threads),
+          layout.gradients_per_second, layout.chain_gradients_per_second,
+          layout.slowdown});
+    }
+  }
+
+  double best_rate = 0;
+  for (const thread_layout& layout : result.layouts)
+    best_rate = std::max(best_rate, layout.gradients_per_second);
+  bool chosen = false;
+  for (const thread_layout& layout : result.layouts) {
+    if (layout.gradients_per_second < 0.95 * best_rate)
+      continue;
+    const size_t num_threads = layout.num_chains * layout.threads_per_chain;
+    const size_t chosen_threads = result.recommended.num_chains
+                                  * result.recommended.threads_per_chain;
+    if (!chosen || num_threads < chosen_threads
+        || (num_threads == chosen_threads
+            && layout.gradients_per_second
+                   > result.recommended.gradients_per_second)) {
+      result.recommended = layout;
+      chosen = true;
+    }
+  }
+  std::stringstream msg;
+  msg << "Recommended layout: " << result.recommended.num_chains
+      << " chains with " << result.recommended.threads_per_chain
+      << " threads each, "
+      << result.recommended.num_chains * result.recommended.threads_per_chain
+      << " threads in all.";
+  logger.info(msg);
+  if (calibration)
+    *calibration = result;
+  return error_codes::OK;
+}
+
+}  // namespace diagnose
+}  // namespace services
+}  // namespace stan
+#endif
@@ -58,6 +58,112 @@ int diagnose(Model& model, const stan::io::var_context& init,
   return num_failed;
 }
 
+/**
+ * Method of computing the derivatives the gradients of a model are
+ * checked against: central finite differences or forward-mode automatic
+ * differentiation.
+ */
+enum class test_method { finite_diff, forward_diff };
+
+/**
+ * Checks the gradients of the model computed using reverse mode
+ * autodiff against derivatives computed with the specified method,
+ * either along every coordinate or along random directions, and reports
+ * the comparisons with the largest errors.
+ *
+ * With <code>num_directions</code> of zero every coordinate is checked.
+ * Otherwise that many directions drawn uniformly from the unit sphere are
+ * checked with directional derivatives, which cost two evaluations of
+ * the log density per direction with finite differences and one with
+ * forward mode, rather than per parameter.  Finite differences are
+ * evaluated in parallel; forward mode needs
+ * <code>STAN_MODEL_FVAR_VAR</code> for a <code>model_base</code>.
+ *
+ * @tparam Model A model implementation
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] method method of computing the derivatives checked against
+ * @param[in] epsilon epsilon to use for finite differences
+ * @param[in] error amount of absolute error to allow
+ * @param[in] num_directions number of random directions to check, or 0
+ * to check every parameter
+ * @param[in] num_worst number of comparisons with the largest errors to
+ * report
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] parameter_writer Writer callback for file output
+ * @return the number of comparisons that are not within error of the
+ * derivatives checked against
+ * @throw std::domain_error if forward mode is requested of a
+ * <code>model_base</code> without <code>STAN_MODEL_FVAR_VAR</code>
+ */
+template <class Model>
+int diagnose(Model& model, const stan::io::var_context& init,
+             unsigned int random_seed, unsigned int chain, double init_radius,
+             test_method method, double epsilon, double error,
+             int num_directions, int num_worst,
+             callbacks::interrupt& interrupt, callbacks::logger& logger,
+             callbacks::writer& init_writer,
+             callbacks::writer& parameter_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<int> disc_vector;
+  std::vector<double> cont_vector = util::initialize(
+      model, init, rng, init_radius, false, logger, init_writer);
+
+  logger.info("TEST GRADIENT MODE");
+
+  if (method == test_method::forward_diff)
+    return stan::model::test_gradients_forward<true, true>(
+        model, cont_vector, disc_vector, error, num_directions, num_worst,
+        rng, interrupt, logger, parameter_writer);
+  return stan::model::test_gradients<true, true>(
+      model, cont_vector, disc_vector, epsilon, error, num_directions,
+      num_worst, rng, interrupt, logger, parameter_writer);
+}
+
+/**
+ * Checks the gradients of the model computed using reverse mode
+ * autodiff against finite differences evaluated in parallel, either
+ * along every coordinate or along random directions, and reports the
+ * comparisons with the largest errors.
+ *
+ * @tparam Model A model implementation
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] epsilon epsilon to use for finite differences
+ * @param[in] error amount of absolute error to allow
+ * @param[in] num_directions number of random directions to check, or 0
+ * to check every parameter
+ * @param[in] num_worst number of comparisons with the largest errors to
+ * report
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] parameter_writer Writer callback for file output
+ * @return the number of comparisons that are not within error of the
+ * finite difference calculation
+ */
+template <class Model>
+int diagnose(Model& model, const stan::io::var_context& init,
+             unsigned int random_seed, unsigned int chain, double init_radius,
+             double epsilon, double error, int num_directions, int num_worst,
+             callbacks::interrupt& interrupt, callbacks::logger& logger,
+             callbacks::writer& init_writer,
+             callbacks::writer& parameter_writer) {
+  return diagnose(model, init, random_seed, chain, init_radius,
+                  test_method::finite_diff, epsilon, error, num_directions,
+                  num_worst, interrupt, logger, init_writer,
+                  parameter_writer);
+}
+
 }  // namespace diagnose
 }  // namespace services
 }  // namespace stan
@@ -0,0 +1,133 @@
+#ifndef STAN_SERVICES_EXPERIMENTAL_ADVI_BANDED_HPP
+#define STAN_SERVICES_EXPERIMENTAL_ADVI_BANDED_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/services/util/experimental_message.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/psis_resample.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/variational/advi.hpp>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace experimental {
+namespace advi {
+
+/**
+ * Runs ADVI with a normal approximation whose precision has a banded
+ * Cholesky factor, <code>stan::variational::normal_banded</code>.  It
+ * captures the correlations between neighbouring parameters of time
+ * series and state-space models at a cost per iteration linear in the
+ * number of parameters times the bandwidth, where full rank ADVI is
+ * quadratic.
+ *
+ * @tparam Model A model implementation
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] grad_samples number of samples for Monte Carlo estimate
+ *   of gradients
+ * @param[in] elbo_samples number of samples for Monte Carlo estimate
+ *   of ELBO
+ * @param[in] max_iterations maximum number of iterations
+ * @param[in] tol_rel_obj convergence tolerance on the relative norm of
+ *   the objective
+ * @param[in] eta stepsize scaling parameter for variational inference
+ * @param[in] adapt_engaged adaptation engaged?
+ * @param[in] adapt_iterations number of iterations for eta adaptation
+ * @param[in] eval_elbo evaluate ELBO every Nth iteration
+ * @param[in] output_samples number of posterior samples to draw and
+ *   save
+ * @param[in] bandwidth number of subdiagonals of the Cholesky factor of
+ *   the precision
+ * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] parameter_writer output for parameter values
+ * @param[in,out] diagnostic_writer output for diagnostic values
+ * @param[in] psis_resample whether to resample the draws of the
+ *   approximation, as many of them with replacement, by their Pareto
+ *   smoothed importance weights before they are written, see
+ *   <code>util::psis_resample_writer</code>; the Pareto shape of the
+ *   weights is logged, and above 0.7 the draws should not be used in
+ *   place of a run of NUTS
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int banded(Model& model, const stan::io::var_context& init,
+           unsigned int random_seed, unsigned int chain, double init_radius,
+           int grad_samples, int elbo_samples, int max_iterations,
+           double tol_rel_obj, double eta, bool adapt_engaged,
+           int adapt_iterations, int eval_elbo, int output_samples,
+           int bandwidth, callbacks::interrupt& interrupt,
+           callbacks::logger& logger, callbacks::writer& init_writer,
+           callbacks::writer& parameter_writer,
+           callbacks::writer& diagnostic_writer,
+           bool psis_resample = false) {
+  util::experimental_message(logger);
+
+  if (bandwidth < 1) {
+    logger.error("bandwidth must be greater than 0.");
+    return stan::services::error_codes::CONFIG;
+  }
+
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<int> disc_vector;
+  std::vector<double> cont_vector;
+
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
+                                   init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return stan::services::error_codes::CONFIG;
+  }
+
+  std::vector<std::string> names;
+  names.push_back("lp__");
+  names.push_back("log_p__");
+  names.push_back("log_g__");
+  model.constrained_param_names(names, true, true);
+  // the first row is the mean of the approximation
+  util::psis_resample_writer resampler(parameter_writer, "log_p__", "log_g__",
+                                       1);
+  callbacks::writer& draws_writer
+      = psis_resample ? static_cast<callbacks::writer&>(resampler)
+                      : parameter_writer;
+  draws_writer(names);
+
+  Eigen::VectorXd cont_params
+      = Eigen::Map<Eigen::VectorXd>(&cont_vector[0], cont_vector.size(), 1);
+
+  try {
+    stan::variational::advi<Model, stan::variational::normal_banded,
+                            stan::rng_t>
+        cmd_advi(model, cont_params, rng,
+                 stan::variational::normal_banded(cont_params, bandwidth),
+                 grad_samples, elbo_samples, eval_elbo, output_samples);
+    cmd_advi.set_interrupt(&interrupt);
+    cmd_advi.run(eta, adapt_engaged, adapt_iterations, tol_rel_obj,
+                 max_iterations, logger, draws_writer, diagnostic_writer);
+    if (psis_resample)
+      resampler.resample(rng, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  return stan::services::error_codes::OK;
+}
+}  // namespace advi
+}  // namespace experimental
+}  // namespace services
+}  // namespace stan
+#endif
@@ -310,6 +310,74 @@ struct output_draws {
   static int default_value() { return 1000; }
 };
 
+/**
+ * Rank of the low rank part of the covariance of the low rank
+ * approximation.
+ */
+struct rank {
+  /**
+   * Return the string description of rank.
+   *
+   * @return description
+   */
+  static std::string description() {
+    return "Rank of the low rank part of the covariance of the"
+           " low rank approximation.";
+  }
+
+  /**
+   * Validates rank; must be greater than 0.
+   *
+   * @param[in] rank argument to validate
+   * @throw std::invalid_argument unless rank is greater than zero
+   */
+  static void validate(int rank) {
+    if (!(rank > 0))
+      throw std::invalid_argument("rank must be greater than 0.");
+  }
+
+  /**
+   * Return the default rank.
+   *
+   * @return 5
+   */
+  static int default_value() { return 5; }
+};
+
+/**
+ * Number of subdiagonals of the Cholesky factor of the precision of the
+ * banded approximation.
+ */
+struct bandwidth {
+  /**
+   * Return the string description of bandwidth.
+   *
+   * @return description
+   */
+  static std::string description() {
+    return "Number of subdiagonals of the Cholesky factor of the"
+           " precision of the banded approximation.";
+  }
+
+  /**
+   * Validates bandwidth; must be greater than 0.
+   *
+   * @param[in] bandwidth argument to validate
+   * @throw std::invalid_argument unless bandwidth is greater than zero
+   */
+  static void validate(int bandwidth) {
+    if (!(bandwidth > 0))
+      throw std::invalid_argument("bandwidth must be greater than 0.");
+  }
+
+  /**
+   * Return the default bandwidth.
+   *
+   * @return 1
+   */
+  static int default_value() { return 1; }
+};
+
 }  // namespace advi
 }  // namespace experimental
 }  // namespace services
@@ -4,8 +4,10 @@
 #include <stan/callbacks/interrupt.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/services/experimental/advi/pathfinder_init.hpp>
 #include <stan/services/util/experimental_message.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/psis_resample.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/io/var_context.hpp>
@@ -45,6 +47,16 @@ namespace advi {
  * @param[in,out] init_writer Writer callback for unconstrained inits
  * @param[in,out] parameter_writer output for parameter values
  * @param[in,out] diagnostic_writer output for diagnostic values
+ * @param[in] pathfinder settings of a single-path pathfinder run that
+ *   initializes the approximation, with the mean and covariance of its
+ *   best iteration, or null to start from the initial values with unit
+ *   scales
+ * @param[in] psis_resample whether to resample the draws of the
+ *   approximation, as many of them with replacement, by their Pareto
+ *   smoothed importance weights before they are written, see
+ *   <code>util::psis_resample_writer</code>; the Pareto shape of the
+ *   weights is logged, and above 0.7 the draws should not be used in
+ *   place of a run of NUTS
  * @return error_codes::OK if successful
  */
 template <class Model>
@@ -56,20 +68,34 @@ int fullrank(Model& model, const stan::io::var_context& init,
              callbacks::interrupt& interrupt, callbacks::logger& logger,
              callbacks::writer& init_writer,
              callbacks::writer& parameter_writer,
-             callbacks::writer& diagnostic_writer) {
+             callbacks::writer& diagnostic_writer,
+             const pathfinder_init* pathfinder = nullptr,
+             bool psis_resample = false) {
   util::experimental_message(logger);
 
   stan::rng_t rng = util::create_rng(random_seed, chain);
 
-  std::vector<int> disc_vector;
-  std::vector<double> cont_vector;
-
-  try {
-    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
-                                   init_writer);
-  } catch (const std::exception& e) {
-    logger.error(e.what());
-    return stan::services::error_codes::CONFIG;
+  Eigen::VectorXd cont_params;
+  stan::variational::normal_fullrank initial(0);
+  if (pathfinder != nullptr) {
+    int return_code = pathfinder_initialize(
+        model, init, random_seed, chain, init_radius, *pathfinder, interrupt,
+        logger, init_writer, initial);
+    if (return_code != error_codes::OK)
+      return return_code;
+    cont_params = initial.mu();
+  } else {
+    std::vector<double> cont_vector;
+    try {
+      cont_vector = util::initialize(model, init, rng, init_radius, true,
+                                     logger, init_writer);
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return stan::services::error_codes::CONFIG;
+    }
+    cont_params = Eigen::Map<Eigen::VectorXd>(cont_vector.data(),
+                                              cont_vector.size());
+    initial = stan::variational::normal_fullrank(cont_params);
   }
 
   std::vector<std::string> names;
@@ -77,18 +103,24 @@ int fullrank(Model& model, const stan::io::var_context& init,
   names.push_back("log_p__");
   names.push_back("log_g__");
   model.constrained_param_names(names, true, true);
-  parameter_writer(names);
-
-  Eigen::VectorXd cont_params
-      = Eigen::Map<Eigen::VectorXd>(&cont_vector[0], cont_vector.size(), 1);
+  // the first row is the mean of the approximation
+  util::psis_resample_writer resampler(parameter_writer, "log_p__", "log_g__",
+                                       1);
+  callbacks::writer& draws_writer
+      = psis_resample ? static_cast<callbacks::writer&>(resampler)
+                      : parameter_writer;
+  draws_writer(names);
 
   stan::variational::advi<Model, stan::variational::normal_fullrank,
                           stan::rng_t>
-      cmd_advi(model, cont_params, rng, grad_samples, elbo_samples, eval_elbo,
-               output_samples);
+      cmd_advi(model, cont_params, rng, initial, grad_samples, elbo_samples,
+               eval_elbo, output_samples);
+  cmd_advi.set_interrupt(&interrupt);
   try {
     cmd_advi.run(eta, adapt_engaged, adapt_iterations, tol_rel_obj,
-                 max_iterations, logger, parameter_writer, diagnostic_writer);
+                 max_iterations, logger, draws_writer, diagnostic_writer);
+    if (psis_resample)
+      resampler.resample(rng, logger);
   } catch (const std::exception& e) {
     logger.error(e.what());
     return error_codes::SOFTWARE;
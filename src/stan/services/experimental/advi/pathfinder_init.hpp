@@ -0,0 +1,177 @@
+#ifndef STAN_SERVICES_EXPERIMENTAL_ADVI_PATHFINDER_INIT_HPP
+#define STAN_SERVICES_EXPERIMENTAL_ADVI_PATHFINDER_INIT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/single.hpp>
+#include <stan/variational/families/normal_fullrank.hpp>
+#include <stan/variational/families/normal_meanfield.hpp>
+#include <exception>
+#include <string>
+
+namespace stan {
+namespace services {
+namespace experimental {
+namespace advi {
+
+/**
+ * Settings of the single-path pathfinder run that initializes ADVI, with
+ * the defaults of the pathfinder service.
+ */
+struct pathfinder_init {
+  /** Number of corrections kept by L-BFGS. */
+  int history_size = 5;
+  /** Line search step size of the first iteration. */
+  double init_alpha = 0.001;
+  double tol_obj = 1e-12;
+  double tol_rel_obj = 1e4;
+  double tol_grad = 1e-8;
+  double tol_rel_grad = 1e7;
+  double tol_param = 1e-8;
+  /** Maximum number of L-BFGS iterations. */
+  int num_iterations = 1000;
+  /** Number of draws estimating the ELBO of each iteration. */
+  int num_elbo_draws = 25;
+};
+
+namespace internal {
+
+/**
+ * Return the mean field approximation with the mean and the marginal
+ * scales of a taylor approximation of pathfinder.
+ *
+ * The sparse approximation has the covariance
+ * \f$ D^{1/2} (I + Q (L - I) Q^T) (I + Q (L - I) Q^T)^T D^{1/2} \f$ with
+ * \f$ D \f$ the diagonal alpha and \f$ Q \f$ of orthonormal columns, so
+ * with \f$ P = Q (L - I) \f$ its diagonal is
+ * \f$ \alpha_i (1 + 2 P_i \cdot Q_i + \|P_i\|^2) \f$, found without
+ * forming the covariance.
+ *
+ * @param[in] approx taylor approximation
+ */
+inline stan::variational::normal_meanfield to_meanfield(
+    const pathfinder::internal::taylor_approx_t& approx) {
+  Eigen::VectorXd variance;
+  if (approx.use_full) {
+    variance = approx.L_approx.colwise().squaredNorm().transpose();
+  } else {
+    Eigen::MatrixXd l_minus_i = approx.L_approx;
+    l_minus_i.diagonal().array() -= 1;
+    const Eigen::MatrixXd P = approx.Qk * l_minus_i;
+    variance = approx.alpha.array()
+               * (1 + 2 * (P.array() * approx.Qk.array()).rowwise().sum()
+                  + P.rowwise().squaredNorm().array());
+  }
+  return stan::variational::normal_meanfield(
+      approx.x_center, (0.5 * variance.array().log()).matrix());
+}
+
+/**
+ * Return the full rank approximation with the mean and the covariance of
+ * a taylor approximation of pathfinder.
+ *
+ * The dense approximation draws \f$ L^T u \f$, so its Cholesky factor is
+ * \f$ L^T \f$.  The covariance of the sparse one is formed and
+ * factored.
+ *
+ * @param[in] approx taylor approximation
+ * @throw std::domain_error if the covariance is not positive definite
+ */
+inline stan::variational::normal_fullrank to_fullrank(
+    const pathfinder::internal::taylor_approx_t& approx) {
+  if (approx.use_full)
+    return stan::variational::normal_fullrank(approx.x_center,
+                                              approx.L_approx.transpose());
+  Eigen::MatrixXd l_minus_i = approx.L_approx;
+  l_minus_i.diagonal().array() -= 1;
+  Eigen::MatrixXd factor = (approx.Qk * l_minus_i) * approx.Qk.transpose();
+  factor.diagonal().array() += 1;
+  factor = approx.alpha.array().sqrt().matrix().asDiagonal() * factor;
+  Eigen::LLT<Eigen::MatrixXd> llt(factor * factor.transpose());
+  if (llt.info() != Eigen::Success)
+    throw std::domain_error(
+        "pathfinder covariance is not positive definite");
+  return stan::variational::normal_fullrank(approx.x_center, llt.matrixL());
+}
+
+inline void from_taylor_approx(
+    const pathfinder::internal::taylor_approx_t& approx,
+    stan::variational::normal_meanfield& family) {
+  family = to_meanfield(approx);
+}
+
+inline void from_taylor_approx(
+    const pathfinder::internal::taylor_approx_t& approx,
+    stan::variational::normal_fullrank& family) {
+  family = to_fullrank(approx);
+}
+
+}  // namespace internal
+
+/**
+ * Initialize the approximation of ADVI from a single-path pathfinder run,
+ * with the mean and the covariance of the taylor approximation at the
+ * iteration of the best ELBO, so that the stochastic optimization starts
+ * close to convergence instead of at the initial values.
+ *
+ * The path starts from the initial values of the parameters, which it
+ * writes to <code>init_writer</code>, and neither constrains nor writes
+ * its draws.
+ *
+ * @tparam Model type of the model
+ * @tparam Q variational family, <code>normal_meanfield</code> or
+ *   <code>normal_fullrank</code>
+ * @param[in] model model
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed
+ * @param[in] chain chain id to advance the random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] settings settings of the pathfinder run
+ * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] logger logger for messages
+ * @param[in,out] init_writer writer of the unconstrained initial values
+ * @param[out] family initial approximation
+ * @return error_codes::OK if successful, or the error code of the path
+ */
+template <class Model, class Q>
+int pathfinder_initialize(Model& model, const stan::io::var_context& init,
+                          unsigned int random_seed, unsigned int chain,
+                          double init_radius, const pathfinder_init& settings,
+                          callbacks::interrupt& interrupt,
+                          callbacks::logger& logger,
+                          callbacks::writer& init_writer, Q& family) {
+  callbacks::writer no_parameters;
+  callbacks::structured_writer no_diagnostics;
+  pathfinder::internal::draw_generator_t draws;
+  draws.constrain_path_draws = false;
+  const int return_code = pathfinder::pathfinder_lbfgs_single<false>(
+      model, init, random_seed, chain, init_radius, settings.history_size,
+      settings.init_alpha, settings.tol_obj, settings.tol_rel_obj,
+      settings.tol_grad, settings.tol_rel_grad, settings.tol_param,
+      settings.num_iterations, settings.num_elbo_draws,
+      settings.num_elbo_draws, false, 0, interrupt, logger, init_writer,
+      no_parameters, no_diagnostics, false, &draws);
+  if (return_code != error_codes::OK) {
+    logger.error("Pathfinder initialization of ADVI failed.");
+    return return_code;
+  }
+  try {
+    internal::from_taylor_approx(draws.taylor_approx, family);
+  } catch (const std::exception& e) {
+    logger.error(std::string("Pathfinder initialization of ADVI failed: ")
+                 + e.what());
+    return error_codes::SOFTWARE;
+  }
+  logger.info("ADVI initialized from pathfinder.");
+  return error_codes::OK;
+}
+
+}  // namespace advi
+}  // namespace experimental
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,578 @@
+#ifndef STAN_SERVICES_INSTANTIATIONS_HPP
+#define STAN_SERVICES_INSTANTIATIONS_HPP
+
+#include <stan/mcmc/hmc/nuts/instantiations.hpp>
+#include <stan/model/model_base.hpp>
+#include <stan/services/diagnose/calibrate_threads.hpp>
+#include <stan/services/diagnose/diagnose.hpp>
+#include <stan/services/experimental/advi/banded.hpp>
+#include <stan/services/experimental/advi/fullrank.hpp>
+#include <stan/services/experimental/advi/lowrank.hpp>
+#include <stan/services/experimental/advi/meanfield.hpp>
+#include <stan/services/optimize/bfgs.hpp>
+#include <stan/services/optimize/lbfgs.hpp>
+#include <stan/services/optimize/newton.hpp>
+#include <stan/services/sample/fixed_param.hpp>
+#include <stan/services/sample/hmc_nuts_dense_e.hpp>
+#include <stan/services/sample/hmc_nuts_dense_e_adapt.hpp>
+#include <stan/services/sample/hmc_nuts_dense_e_adapt_checkpoint.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/services/sample/hmc_nuts_lowrank_e_adapt.hpp>
+#include <stan/services/sample/hmc_nuts_unit_e.hpp>
+#include <stan/services/sample/hmc_nuts_unit_e_adapt.hpp>
+#include <stan/services/sample/hmc_static_dense_e.hpp>
+#include <stan/services/sample/hmc_static_dense_e_adapt.hpp>
+#include <stan/services/sample/hmc_static_diag_e.hpp>
+#include <stan/services/sample/hmc_static_diag_e_adapt.hpp>
+#include <stan/services/sample/hmc_static_diag_e_lockstep_adapt.hpp>
+#include <stan/services/sample/hmc_static_unit_e.hpp>
+#include <stan/services/sample/hmc_static_unit_e_adapt.hpp>
+#include <stan/services/sample/standalone_gqs.hpp>
+
+/**
+ * Explicit instantiations of the services for models passed as
+ * <code>stan::model::model_base</code>, so that the services are compiled
+ * once into a library instead of in every model translation unit.
+ *
+ * The library translation unit built by <code>make
+ * bin/libstan_services.a</code> defines
+ * <code>STAN_INSTANTIATE_SERVICES</code> before including this header.
+ * Model translation units that link against the library define
+ * <code>STAN_EXTERN_SERVICES</code> and <code>STAN_EXTERN_SAMPLERS</code>
+ * and include this header, which declares the same instantiations
+ * <code>extern</code> so that the compiler neither instantiates nor emits
+ * the services.  Both must be
+ * compiled with the same flags, for example the same
+ * <code>STAN_THREADS</code> setting.  Calling the services with the
+ * model's own class, or without either macro, instantiates the services
+ * inline as before.
+ */
+#if defined(STAN_INSTANTIATE_SERVICES)
+#define STAN_SERVICES_INSTANTIATION template
+#elif defined(STAN_EXTERN_SERVICES)
+#define STAN_SERVICES_INSTANTIATION extern template
+#endif
+
+#ifdef STAN_SERVICES_INSTANTIATION
+
+namespace stan {
+namespace services {
+namespace diagnose {
+
+STAN_SERVICES_INSTANTIATION int calibrate_threads<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int max_chains, int max_threads, double seconds_per_layout,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& parameter_writer,
+    thread_calibration* calibration);
+
+STAN_SERVICES_INSTANTIATION int diagnose<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    double epsilon, double error, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int diagnose<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    double epsilon, double error, int num_directions, int num_worst,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int diagnose<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    test_method method, double epsilon, double error, int num_directions,
+    int num_worst, callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& parameter_writer);
+
+}  // namespace diagnose
+}  // namespace services
+}  // namespace stan
+
+namespace stan {
+namespace services {
+namespace experimental {
+namespace advi {
+
+STAN_SERVICES_INSTANTIATION int banded<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int grad_samples, int elbo_samples, int max_iterations, double tol_rel_obj,
+    double eta, bool adapt_engaged, int adapt_iterations, int eval_elbo,
+    int output_samples, int bandwidth, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int fullrank<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int grad_samples, int elbo_samples, int max_iterations, double tol_rel_obj,
+    double eta, bool adapt_engaged, int adapt_iterations, int eval_elbo,
+    int output_samples, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int lowrank<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int grad_samples, int elbo_samples, int max_iterations, double tol_rel_obj,
+    double eta, bool adapt_engaged, int adapt_iterations, int eval_elbo,
+    int output_samples, int rank, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int meanfield<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int grad_samples, int elbo_samples, int max_iterations, double tol_rel_obj,
+    double eta, bool adapt_engaged, int adapt_iterations, int eval_elbo,
+    int output_samples, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer, callbacks::writer& diagnostic_writer);
+
+}  // namespace advi
+}  // namespace experimental
+}  // namespace services
+}  // namespace stan
+
+namespace stan {
+namespace services {
+namespace optimize {
+
+STAN_SERVICES_INSTANTIATION int bfgs<model::model_base, false>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    double init_alpha, double tol_obj, double tol_rel_obj, double tol_grad,
+    double tol_rel_grad, double tol_param, int num_iterations,
+    bool save_iterations, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int bfgs<model::model_base, true>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    double init_alpha, double tol_obj, double tol_rel_obj, double tol_grad,
+    double tol_rel_grad, double tol_param, int num_iterations,
+    bool save_iterations, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int lbfgs<model::model_base, false>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int history_size, double init_alpha, double tol_obj, double tol_rel_obj,
+    double tol_grad, double tol_rel_grad, double tol_param, int num_iterations,
+    bool save_iterations, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int lbfgs<model::model_base, true>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int history_size, double init_alpha, double tol_obj, double tol_rel_obj,
+    double tol_grad, double tol_rel_grad, double tol_param, int num_iterations,
+    bool save_iterations, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int newton<model::model_base, false>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_iterations, bool save_iterations, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+STAN_SERVICES_INSTANTIATION int newton<model::model_base, true>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_iterations, bool save_iterations, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& parameter_writer);
+
+}  // namespace optimize
+}  // namespace services
+}  // namespace stan
+
+namespace stan {
+namespace services {
+namespace sample {
+
+STAN_SERVICES_INSTANTIATION int fixed_param<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_samples, int num_thin, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int
+hmc_nuts_dense_e_adapt_checkpointed<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& checkpoint_writer, int checkpoint_interval);
+
+STAN_SERVICES_INSTANTIATION int
+hmc_nuts_dense_e_adapt_resume<model::model_base>(
+    model::model_base& model, const stan::io::var_context& checkpoint,
+    unsigned int random_seed, unsigned int chain, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double stepsize_jitter, int max_depth, double delta,
+    double gamma, double kappa, double t0, unsigned int init_buffer,
+    unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& checkpoint_writer, int checkpoint_interval);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_lowrank_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, int rank, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_lowrank_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    int rank, callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_lowrank_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    int rank, callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_unit_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_unit_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_nuts_unit_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_dense_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, double int_time, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_dense_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, double int_time, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_dense_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_diag_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, double int_time, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_diag_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, double int_time, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_diag_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int
+hmc_static_diag_e_lockstep_adapt<model::model_base>(
+    model::model_base& model, size_t num_chains,
+    const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int init_chain_id, double init_radius, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double int_time, double delta, double gamma, double kappa,
+    double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer,
+    callbacks::structured_writer& metric_writer);
+
+STAN_SERVICES_INSTANTIATION int
+hmc_static_diag_e_lockstep_adapt<model::model_base>(
+    model::model_base& model, size_t num_chains,
+    const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int init_chain_id, double init_radius, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double int_time, double delta, double gamma, double kappa,
+    double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_unit_e<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+STAN_SERVICES_INSTANTIATION int hmc_static_unit_e_adapt<model::model_base>(
+    model::model_base& model, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, double int_time,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer);
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+
+namespace stan {
+namespace services {
+
+STAN_SERVICES_INSTANTIATION int standalone_generate<model::model_base>(
+    const model::model_base& model, const Eigen::MatrixXd& draws,
+    unsigned int seed, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& sample_writer);
+
+STAN_SERVICES_INSTANTIATION int standalone_generate<model::model_base>(
+    const model::model_base& model, const Eigen::MatrixXd& draws,
+    unsigned int seed, size_t block_size, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& sample_writer);
+
+}  // namespace services
+}  // namespace stan
+
+#undef STAN_SERVICES_INSTANTIATION
+#endif
+
+#endif
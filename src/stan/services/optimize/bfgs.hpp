@@ -74,6 +74,7 @@ int bfgs(Model& model, const stan::io::var_context& init,
       jacobian>
       Optimizer;
   Optimizer bfgs(model, cont_vector, disc_vector, &bfgs_ss);
+  bfgs.set_interrupt(&interrupt);
   bfgs._ls_opts.alpha0 = init_alpha;
   bfgs._conv_opts.tolAbsF = tol_obj;
   bfgs._conv_opts.tolRelF = tol_rel_obj;
@@ -6,8 +6,21 @@
 #include <stan/callbacks/writer.hpp>
 #include <stan/callbacks/structured_writer.hpp>
 #include <stan/math/rev.hpp>
+#include <stan/model/finite_diff_hessian.hpp>
+#include <stan/model/hessian_times_vector.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <stan/model/sparse_hessian.hpp>
+#include <stan/optimization/lanczos.hpp>
 #include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/single.hpp>
 #include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/psis_resample.hpp>
+#include <stan/services/util/workspace.hpp>
+#include <Eigen/SparseCholesky>
+#include <tbb/blocked_range.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -16,12 +29,17 @@ namespace stan {
 namespace services {
 namespace internal {
 
-template <bool jacobian, typename Model>
-void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
-                    int draws, bool calculate_lp, unsigned int random_seed,
-                    int refresh, callbacks::interrupt& interrupt,
-                    callbacks::logger& logger, callbacks::writer& sample_writer,
-                    callbacks::structured_writer& hessian_writer) {
+/**
+ * Check the mode and the number of draws of a Laplace approximation and
+ * write the names of the draws to the sample writer.
+ *
+ * @tparam Model a Stan model
+ * @throw std::domain_error if the number of draws is not positive or
+ * the mode is not the size of the unconstrained parameters
+ */
+template <typename Model>
+void write_laplace_names(const Model& model, const Eigen::VectorXd& theta_hat,
+                         int draws, callbacks::writer& sample_writer) {
   if (draws <= 0) {
     throw std::domain_error("Number of draws must be > 0; found draws = "
                             + std::to_string(draws));
@@ -39,10 +57,6 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
         + std::to_string(theta_hat.size()));
   }
 
-  std::vector<std::string> param_tp_gq_names;
-  model.constrained_param_names(param_tp_gq_names, true, true);
-  size_t draw_size = param_tp_gq_names.size();
-
   // write names of params, tps, and gqs to sample writer
   std::vector<std::string> names;
   names.push_back("log_p__");
@@ -51,26 +65,186 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
   static const bool include_gq = true;
   model.constrained_param_names(names, include_tp, include_gq);
   sample_writer(names);
+}
+
+/**
+ * Write the specified number of draws from a normal approximation
+ * centered at the mode to the sample writer, each with the log density
+ * of the model and of the approximation.
+ *
+ * Draws are made in blocks.  The standard normal vectors of a block are
+ * the columns of a matrix that is scaled as a whole, and the log
+ * densities of the model at the draws of the block are evaluated in
+ * parallel on the TBB threads when Stan is built with
+ * <code>STAN_THREADS</code>, each in a nested autodiff scope and without
+ * messages.  The generated quantities and the output are then made one
+ * draw at a time, in order, reusing the same buffers.
+ *
+ * The scale maps a standard normal vector to its offset from the mode,
+ * that is to the product with the inverse of a square root of the
+ * precision of the approximation, so the unnormalized log density of
+ * the approximation is minus half the squared norm of the standard
+ * normal vector.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @tparam Scale type of the functor replacing, in place, each column of
+ * a matrix of standard normal vectors by its offset from the mode
+ */
+template <bool jacobian, typename Model, typename Scale>
+void write_laplace_draws(const Model& model, const Eigen::VectorXd& theta_hat,
+                         int draws, bool calculate_lp,
+                         unsigned int random_seed, int refresh,
+                         callbacks::interrupt& interrupt,
+                         callbacks::logger& logger,
+                         callbacks::writer& sample_writer,
+                         const Scale& scale) {
+  static const bool include_tp = true;
+  static const bool include_gq = true;
+  std::vector<std::string> param_tp_gq_names;
+  model.constrained_param_names(param_tp_gq_names, include_tp, include_gq);
+  size_t draw_size = param_tp_gq_names.size();
+  const Eigen::Index num_unc_params = theta_hat.size();
+  // about 32MB of draws per block
+  const int block_size = static_cast<int>(std::max<Eigen::Index>(
+      1, std::min<Eigen::Index>(
+             256, (Eigen::Index{1} << 22)
+                      / std::max<Eigen::Index>(1, num_unc_params))));
+
+  if (refresh > 0) {
+    logger.info("Generating draws");
+  }
+  // generate draws
+  std::stringstream refresh_msg;
+  stan::rng_t rng = util::create_rng(random_seed, 0);
+  Eigen::MatrixXd unc_draws;
+  Eigen::VectorXd log_qs;
+  Eigen::VectorXd log_ps;
+  Eigen::VectorXd unc_draw;
+  Eigen::VectorXd draw_vec;
+  std::vector<double> draw(draw_size + 2);
+  std::stringstream write_array_msgs;
+  for (int block_begin = 0; block_begin < draws; block_begin += block_size) {
+    const int num_block = std::min(block_size, draws - block_begin);
+    interrupt();
+    unc_draws.resize(num_unc_params, num_block);
+    for (int b = 0; b < num_block; ++b) {
+      for (Eigen::Index n = 0; n < num_unc_params; ++n) {
+        unc_draws(n, b) = math::std_normal_rng(rng);
+      }
+    }
+    log_qs = -0.5 * unc_draws.colwise().squaredNorm().transpose();
+    scale(unc_draws);
+    unc_draws.colwise() += theta_hat;
+
+    log_ps.setConstant(num_block, std::numeric_limits<double>::quiet_NaN());
+    if (calculate_lp) {
+      auto evaluate = [&](const tbb::blocked_range<int>& r) {
+        for (int b = r.begin(); b != r.end(); ++b) {
+          math::nested_rev_autodiff nested;
+          Eigen::Matrix<math::var, -1, 1> theta = unc_draws.col(b);
+          log_ps(b) = model.template log_prob<true, jacobian, math::var>(
+                              theta, nullptr)
+                          .val();
+        }
+      };
+      stan::model::internal::parallel_for_if_threads(0, num_block, evaluate);
+    }
+
+    for (int b = 0; b < num_block; ++b) {
+      const int m = block_begin + b;
+      interrupt();  // allow interpution each iteration
+      if (refresh > 0 && m % refresh == 0) {
+        refresh_msg << "iteration: " << std::to_string(m);
+        logger.info(refresh_msg);
+        refresh_msg.str(std::string());
+      }
+      unc_draw = unc_draws.col(b);
+      write_array_msgs.str(std::string());
+      write_array_msgs.clear();
+      model.write_array(rng, unc_draw, draw_vec, include_tp, include_gq,
+                        &write_array_msgs);
+      if (refresh > 0
+          && write_array_msgs.peek() != std::char_traits<char>::eof())
+        logger.info(write_array_msgs);
+      // output log_p, log_q, draw
+      draw[0] = log_ps(b);
+      draw[1] = log_qs(b);
+      std::copy(draw_vec.data(), draw_vec.data() + draw_size,
+                draw.begin() + 2);
+      sample_writer(draw);
+    }
+  }
+}
+
+/**
+ * Run a Laplace sampler that writes its draws to the specified writer,
+ * either to the sample writer, or, to resample them, to a
+ * <code>util::psis_resample_writer</code> that writes as many draws
+ * resampled by their Pareto smoothed importance weights to the sample
+ * writer once the sampler is done.
+ *
+ * @tparam Sample type of the functor running the sampler with a writer
+ * @param[in] psis_resample whether to resample the draws, which needs
+ * the log densities of the model at the draws
+ * @param[in] random_seed seed of the sampler, with which the draws are
+ * resampled from a stream of their own
+ */
+template <typename Sample>
+void write_psis_resampled(bool psis_resample, unsigned int random_seed,
+                          int refresh, callbacks::interrupt& interrupt,
+                          callbacks::logger& logger,
+                          callbacks::writer& sample_writer,
+                          const Sample& sample) {
+  if (!psis_resample) {
+    sample(sample_writer);
+    return;
+  }
+  util::psis_resample_writer resampler(sample_writer, "log_p__", "log_q__");
+  sample(resampler);
+  interrupt();
+  if (refresh > 0) {
+    logger.info("Pareto smoothed importance resampling");
+  }
+  stan::rng_t rng = util::create_rng(random_seed, 2);
+  resampler.resample(rng, logger);
+}
+
+template <bool jacobian, typename Model>
+void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
+                    int draws, bool calculate_lp, unsigned int random_seed,
+                    int refresh, callbacks::interrupt& interrupt,
+                    callbacks::logger& logger, callbacks::writer& sample_writer,
+                    callbacks::structured_writer& hessian_writer) {
+  write_laplace_names(model, theta_hat, draws, sample_writer);
 
-  // create log density functor for vars and vals
   std::stringstream log_density_msgs;
-  auto log_density_fun
-      = [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta) {
-          return model.template log_prob<true, jacobian, stan::math::var>(
-              const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta),
-              &log_density_msgs);
-        };
 
-  // calculate inverse negative Hessian's Cholesky factor
+  // calculate negative Hessian's Cholesky factor
   if (refresh > 0) {
     logger.info("Calculating Hessian");
   }
+  // the gradients of the perturbations are taken in parallel, each in a
+  // nested autodiff scope and with its own message stream
+  auto log_density_grad = [&model](const Eigen::VectorXd& theta,
+                                   Eigen::VectorXd& grad, std::ostream* msgs) {
+    double lp;
+    math::gradient(
+        [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta_v) {
+          return model.template log_prob<true, jacobian, stan::math::var>(
+              const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta_v),
+              msgs);
+        },
+        theta, lp, grad);
+    return lp;
+  };
   double log_p;          // dummy
   Eigen::VectorXd grad;  // dummy
   Eigen::MatrixXd hessian;
   interrupt();
-  math::internal::finite_diff_hessian_auto(log_density_fun, theta_hat, log_p,
-                                           grad, hessian);
+  stan::model::finite_diff_hessian(log_density_grad, theta_hat, log_p, grad,
+                                   hessian, &log_density_msgs);
   if (refresh > 0 && log_density_msgs.peek() != std::char_traits<char>::eof())
     logger.info(log_density_msgs);
 
@@ -81,57 +255,317 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
   hessian_writer.write("Hessian", hessian);
   hessian_writer.end_record();
 
-  // calculate Cholesky factor and inverse
+  // calculate Cholesky factor
   interrupt();
   if (refresh > 0) {
-    logger.info("Calculating inverse of Cholesky factor");
+    logger.info("Calculating Cholesky factor");
   }
   Eigen::MatrixXd L_neg_hessian = (-hessian).llt().matrixL();
   interrupt();
-  Eigen::MatrixXd inv_sqrt_neg_hessian = L_neg_hessian.inverse().transpose();
-  interrupt();
-  Eigen::MatrixXd half_hessian = 0.5 * hessian;
+
+  // the offset from the mode solves L^T x = z for each block at once
+  write_laplace_draws<jacobian>(
+      model, theta_hat, draws, calculate_lp, random_seed, refresh, interrupt,
+      logger, sample_writer, [&](Eigen::MatrixXd& z) {
+        L_neg_hessian.transpose().triangularView<Eigen::Upper>().solveInPlace(
+            z);
+      });
+}
+
+template <bool jacobian, typename Model>
+void laplace_sample_low_rank(const Model& model,
+                             const Eigen::VectorXd& theta_hat, int draws,
+                             int rank, bool calculate_lp,
+                             unsigned int random_seed, int refresh,
+                             callbacks::interrupt& interrupt,
+                             callbacks::logger& logger,
+                             callbacks::writer& sample_writer,
+                             callbacks::structured_writer& hessian_writer) {
+  if (rank <= 0) {
+    throw std::domain_error("Rank must be > 0; found rank = "
+                            + std::to_string(rank));
+  }
+  write_laplace_names(model, theta_hat, draws, sample_writer);
+
+  std::stringstream log_density_msgs;
+  auto log_density_fun
+      = [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta) {
+          return model.template log_prob<true, jacobian, stan::math::var>(
+              const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta),
+              &log_density_msgs);
+        };
+  // product of the negative Hessian at the mode with a vector
+  auto neg_hessian_times_vector = [&](const Eigen::VectorXd& v,
+                                      Eigen::VectorXd& neg_hess_v) {
+    double lp;
+    stan::model::hessian_times_vector<true, jacobian>(
+        model, theta_hat, v, lp, neg_hess_v, &log_density_msgs);
+    neg_hess_v = -neg_hess_v;
+  };
 
   if (refresh > 0) {
-    logger.info("Generating draws");
+    logger.info("Calculating low-rank approximation of Hessian");
   }
-  // generate draws
-  std::stringstream refresh_msg;
-  stan::rng_t rng = util::create_rng(random_seed, 0);
-  Eigen::VectorXd draw_vec;  // declare draw_vec, msgs here to avoid re-alloc
-  for (int m = 0; m < draws; ++m) {
-    interrupt();  // allow interpution each iteration
-    if (refresh > 0 && m % refresh == 0) {
-      refresh_msg << "iteration: " << std::to_string(m);
-      logger.info(refresh_msg);
-      refresh_msg.str(std::string());
+  double log_p;
+  Eigen::VectorXd grad;
+  interrupt();
+  math::gradient(log_density_fun, theta_hat, log_p, grad);
+  Eigen::VectorXd eigenvalues;
+  Eigen::MatrixXd eigenvectors;
+  stan::rng_t lanczos_rng = util::create_rng(random_seed, 1);
+  optimization::lanczos_eigen(neg_hessian_times_vector, theta_hat.size(),
+                              rank, lanczos_rng, eigenvalues, eigenvectors);
+  if (refresh > 0 && log_density_msgs.peek() != std::char_traits<char>::eof())
+    logger.info(log_density_msgs);
+  if (eigenvalues.size() > 0 && !(eigenvalues(0) > 0)) {
+    throw std::domain_error(
+        "Hessian is not negative definite at the specified mode");
+  }
+
+  interrupt();
+  hessian_writer.begin_record();
+  hessian_writer.write("lp_mode", log_p);
+  hessian_writer.write("gradient", grad);
+  hessian_writer.write("neg_hessian_eigenvalues", eigenvalues);
+  hessian_writer.write("neg_hessian_eigenvectors", eigenvectors);
+  hessian_writer.end_record();
+
+  // the negative Hessian is approximated by its eigenpairs in the Krylov
+  // subspace and by the smallest of their eigenvalues in the rest, which
+  // errs on the side of too wide an approximation where it was not
+  // explored
+  const bool full_rank = eigenvectors.cols() == theta_hat.size();
+  const double rest_scale
+      = eigenvalues.size() > 0 ? 1 / std::sqrt(eigenvalues(0)) : 1;
+  const Eigen::VectorXd eigen_scales = eigenvalues.cwiseSqrt().cwiseInverse();
+  Eigen::MatrixXd coords;
+  write_laplace_draws<jacobian>(
+      model, theta_hat, draws, calculate_lp, random_seed, refresh, interrupt,
+      logger, sample_writer, [&](Eigen::MatrixXd& z) {
+        coords.noalias() = eigenvectors.transpose() * z;
+        if (full_rank) {
+          coords = eigen_scales.asDiagonal() * coords;
+          z.noalias() = eigenvectors * coords;
+        } else {
+          z.noalias() -= eigenvectors * coords;
+          z *= rest_scale;
+          coords = eigen_scales.asDiagonal() * coords;
+          z.noalias() += eigenvectors * coords;
+        }
+      });
+}
+
+template <bool jacobian, typename Model>
+void laplace_sample_sparse(const Model& model,
+                           const Eigen::VectorXd& theta_hat, int draws,
+                           const stan::model::hessian_sparsity* sparsity,
+                           bool calculate_lp, unsigned int random_seed,
+                           int refresh, callbacks::interrupt& interrupt,
+                           callbacks::logger& logger,
+                           callbacks::writer& sample_writer,
+                           callbacks::structured_writer& hessian_writer) {
+  write_laplace_names(model, theta_hat, draws, sample_writer);
+
+  std::stringstream log_density_msgs;
+  auto log_density_fun
+      = [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta) {
+          return model.template log_prob<true, jacobian, stan::math::var>(
+              const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta),
+              &log_density_msgs);
+        };
+  // the products may be taken in parallel, so they write no messages
+  auto hessian_times_vector
+      = [&](const Eigen::VectorXd& v, Eigen::VectorXd& hess_v) {
+          double lp;
+          stan::model::hessian_times_vector<true, jacobian>(
+              model, theta_hat, v, lp, hess_v, nullptr);
+        };
+
+  double log_p;
+  Eigen::VectorXd grad;
+  interrupt();
+  math::gradient(log_density_fun, theta_hat, log_p, grad);
+  if (refresh > 0 && log_density_msgs.peek() != std::char_traits<char>::eof())
+    logger.info(log_density_msgs);
+  stan::model::hessian_sparsity detected;
+  if (sparsity == nullptr) {
+    if (refresh > 0) {
+      logger.info("Detecting sparsity of Hessian");
     }
-    Eigen::VectorXd z(num_unc_params);
-    for (int n = 0; n < num_unc_params; ++n) {
-      z(n) = math::std_normal_rng(rng);
+    detected = stan::model::detect_hessian_sparsity(hessian_times_vector,
+                                                    theta_hat.size());
+    sparsity = &detected;
+  } else if (sparsity->size() != theta_hat.size()) {
+    throw std::domain_error(
+        "Hessian sparsity is wrong size; expected "
+        + std::to_string(theta_hat.size()) + " columns, found "
+        + std::to_string(sparsity->size()));
+  }
+  if (refresh > 0) {
+    logger.info("Calculating sparse Hessian with "
+                + std::to_string(sparsity->num_colors)
+                + " Hessian-vector products");
+  }
+  interrupt();
+  Eigen::SparseMatrix<double> hessian;
+  stan::model::sparse_hessian(hessian_times_vector, *sparsity, hessian);
+
+  interrupt();
+  // the lower triangle as rows of (row, column, value)
+  Eigen::MatrixXd nonzeros((hessian.nonZeros() + hessian.cols()) / 2, 3);
+  Eigen::Index k = 0;
+  for (Eigen::Index j = 0; j < hessian.outerSize(); ++j) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(hessian, j); it;
+         ++it) {
+      if (it.row() >= it.col()) {
+        nonzeros.row(k++) << it.row(), it.col(), it.value();
+      }
     }
-    Eigen::VectorXd unc_draw = theta_hat + inv_sqrt_neg_hessian * z;
-    std::stringstream write_array_msgs;
-    model.write_array(rng, unc_draw, draw_vec, include_tp, include_gq,
-                      &write_array_msgs);
-    if (refresh > 0 && write_array_msgs.peek() != std::char_traits<char>::eof())
-      logger.info(write_array_msgs);
-    // output draw, log_p, log_q
-    std::vector<double> draw(&draw_vec(0), &draw_vec(0) + draw_size);
-
-    double log_p;
-    if (calculate_lp) {
-      log_p = log_density_fun(unc_draw).val();
+  }
+  nonzeros.conservativeResize(k, 3);
+  hessian_writer.begin_record();
+  hessian_writer.write("lp_mode", log_p);
+  hessian_writer.write("gradient", grad);
+  hessian_writer.write("Hessian_nonzeros", nonzeros);
+  hessian_writer.end_record();
+
+  // calculate sparse Cholesky factor, P (-H) P^T = L L^T
+  interrupt();
+  if (refresh > 0) {
+    logger.info("Calculating sparse Cholesky factor");
+  }
+  Eigen::SimplicialLLT<Eigen::SparseMatrix<double>, Eigen::Lower,
+                       Eigen::AMDOrdering<int>>
+      llt(-hessian);
+  if (llt.info() != Eigen::Success) {
+    throw std::domain_error(
+        "Hessian is not negative definite at the specified mode");
+  }
+  interrupt();
+
+  // the offset from the mode is P^T x for the solution of L^T x = z
+  write_laplace_draws<jacobian>(
+      model, theta_hat, draws, calculate_lp, random_seed, refresh, interrupt,
+      logger, sample_writer, [&](Eigen::MatrixXd& z) {
+        z = llt.permutationPinv() * llt.matrixU().solve(z);
+      });
+}
+
+template <bool jacobian, typename Model>
+void laplace_sample_lbfgs(const Model& model, const Eigen::VectorXd& theta_hat,
+                          const Eigen::MatrixXd& s_history,
+                          const Eigen::MatrixXd& y_history, int draws,
+                          bool calculate_lp, unsigned int random_seed,
+                          int refresh, callbacks::interrupt& interrupt,
+                          callbacks::logger& logger,
+                          callbacks::writer& sample_writer,
+                          callbacks::structured_writer& hessian_writer) {
+  const Eigen::Index num_unc_params = theta_hat.size();
+  if (s_history.rows() != num_unc_params || y_history.rows() != num_unc_params
+      || s_history.cols() != y_history.cols()) {
+    throw std::domain_error(
+        "L-BFGS history must hold update vectors of size "
+        + std::to_string(num_unc_params) + " in matching columns; found "
+        + std::to_string(s_history.rows()) + " by "
+        + std::to_string(s_history.cols()) + " and "
+        + std::to_string(y_history.rows()) + " by "
+        + std::to_string(y_history.cols()));
+  }
+  write_laplace_names(model, theta_hat, draws, sample_writer);
+
+  // updates without positive curvature would not give a positive
+  // definite approximation
+  std::vector<Eigen::Index> kept;
+  for (Eigen::Index i = 0; i < s_history.cols(); ++i) {
+    if (pathfinder::internal::check_curve(y_history.col(i), s_history.col(i)))
+      kept.push_back(i);
+  }
+  if (kept.empty()) {
+    throw std::domain_error(
+        "L-BFGS history has no update with positive curvature");
+  }
+  const Eigen::Index history_size = kept.size();
+  Eigen::MatrixXd Skt(num_unc_params, history_size);
+  Eigen::MatrixXd Ykt(num_unc_params, history_size);
+  for (Eigen::Index i = 0; i < history_size; ++i) {
+    Skt.col(i) = s_history.col(kept[i]);
+    Ykt.col(i) = y_history.col(kept[i]);
+  }
+
+  if (refresh > 0) {
+    logger.info("Calculating approximation of Hessian from L-BFGS history");
+  }
+  std::stringstream log_density_msgs;
+  auto log_density_fun
+      = [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta) {
+          return model.template log_prob<true, jacobian, stan::math::var>(
+              const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta),
+              &log_density_msgs);
+        };
+  double log_p;
+  Eigen::VectorXd grad;
+  interrupt();
+  math::gradient(log_density_fun, theta_hat, log_p, grad);
+  if (refresh > 0 && log_density_msgs.peek() != std::char_traits<char>::eof())
+    logger.info(log_density_msgs);
+
+  interrupt();
+  hessian_writer.begin_record();
+  hessian_writer.write("lp_mode", log_p);
+  hessian_writer.write("gradient", grad);
+  hessian_writer.write("lbfgs_s_history", Skt);
+  hessian_writer.write("lbfgs_y_history", Ykt);
+  hessian_writer.end_record();
+
+  // the inverse Hessian of L-BFGS, whose initial approximation is the
+  // identity scaled by s'y / y'y of the latest update, in the compact form
+  // factored by pathfinder, centered at zero by a zero gradient
+  const Eigen::Index last = history_size - 1;
+  const double gamma
+      = Skt.col(last).dot(Ykt.col(last)) / Ykt.col(last).squaredNorm();
+  const Eigen::VectorXd alpha
+      = Eigen::VectorXd::Constant(num_unc_params, gamma);
+  Eigen::MatrixXd SY = Skt.transpose() * Ykt;
+  const Eigen::VectorXd Dk = SY.diagonal();
+  const Eigen::MatrixXd y_alpha_y = gamma * (Ykt.transpose() * Ykt);
+  Eigen::MatrixXd ninvRST = Skt.transpose();
+  SY.triangularView<Eigen::Upper>().solveInPlace(ninvRST);
+  ninvRST = -ninvRST;
+  const Eigen::VectorXd zero = Eigen::VectorXd::Zero(num_unc_params);
+  interrupt();
+  const pathfinder::internal::taylor_approx_t approx
+      = pathfinder::internal::taylor_approximation(Ykt, alpha, Dk, y_alpha_y,
+                                                   ninvRST, zero, zero);
+
+  // L_approx is the transpose of the Cholesky factor L of the dense
+  // inverse Hessian, or of I + R M R^T in the sparse form, where the
+  // inverse Hessian is diag(alpha)^1/2 (I + Q R M R^T Q^T) diag(alpha)^1/2
+  // and I + Q (L - I) Q^T is a square root of the middle factor
+  const Eigen::VectorXd sqrt_alpha = alpha.cwiseSqrt();
+  Eigen::MatrixXd coords;
+  auto scale = [&](Eigen::MatrixXd& z) {
+    // the products that would alias z or coords go through the workspace
+    // of the thread rather than a new temporary every block
+    util::workspace_scope scope;
+    if (approx.use_full) {
+      auto product = scope.get().matrix(z.rows(), z.cols());
+      product.noalias() = approx.L_approx.transpose() * z;
+      z = product;
     } else {
-      log_p = std::numeric_limits<double>::quiet_NaN();
+      coords.noalias() = approx.Qk.transpose() * z;
+      auto product = scope.get().matrix(coords.rows(), coords.cols());
+      product.noalias() = approx.L_approx.transpose() * coords;
+      coords = product - coords;
+      z.noalias() += approx.Qk * coords;
+      z = sqrt_alpha.asDiagonal() * z;
     }
-    draw.insert(draw.begin(), log_p);
-    Eigen::VectorXd diff = unc_draw - theta_hat;
-    double log_q = diff.transpose() * half_hessian * diff;
-    draw.insert(draw.begin() + 1, log_q);
-    sample_writer(draw);
-  }
-}  // namespace internal
+  };
+
+  write_laplace_draws<jacobian>(model, theta_hat, draws, calculate_lp,
+                                random_seed, refresh, interrupt, logger,
+                                sample_writer, scale);
+}
+
 }  // namespace internal
 
 /**
@@ -186,6 +620,68 @@ int laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
   return error_codes::OK;
 }
 
+/**
+ * Take the specified number of draws from the Laplace approximation
+ * for the model at the specified unconstrained mode, as the overload
+ * without <code>psis_resample</code> does, optionally correcting the
+ * draws for the error of the approximation.
+ *
+ * If <code>psis_resample</code> and <code>calculate_lp</code> are set,
+ * the draws are held in memory and then resampled, as many of them with
+ * replacement, by their Pareto smoothed importance weights, the ratios
+ * of the density of the model to the density of the approximation at the
+ * draws, before they are written; see
+ * <code>util::psis_resample_writer</code>.  The resampled draws are
+ * closer to draws of the posterior, and the Pareto shape of the weights,
+ * which is logged, tells whether they are close enough to be used in
+ * place of a run of NUTS: above 0.7 they are not.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] psis_resample whether to resample the draws by Pareto
+ * smoothed importance sampling, which needs <code>calculate_lp</code>
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and Hessian at the mode for diagnostic purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
+                   int draws, bool calculate_lp, bool psis_resample,
+                   unsigned int random_seed, int refresh,
+                   callbacks::interrupt& interrupt, callbacks::logger& logger,
+                   callbacks::writer& sample_writer,
+                   callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::write_psis_resampled(
+        psis_resample && calculate_lp, random_seed, refresh, interrupt,
+        logger, sample_writer, [&](callbacks::writer& writer) {
+          internal::laplace_sample<jacobian>(
+              model, theta_hat, draws, calculate_lp, random_seed, refresh,
+              interrupt, logger, writer, hessian_writer);
+        });
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
 /**
  * Take the specified number of draws from the Laplace approximation
  * for the model at the specified unconstrained mode, writing the
@@ -228,6 +724,354 @@ int laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
                                   dummy_hessian_writer);
 }
 
+/**
+ * Take the specified number of draws from a low-rank Laplace
+ * approximation for the model at the specified unconstrained mode,
+ * writing the draws, unnormalized log density, and unnormalized density
+ * of the approximation to the sample writer and writing messages to the
+ * logger, returning a return code of zero if successful.
+ *
+ * The dense Hessian is never formed.  The negative Hessian at the mode
+ * is approximated from <code>rank</code> Hessian-vector products by the
+ * Lanczos method as its approximate eigenpairs in the Krylov subspace
+ * they span, plus the smallest of those eigenvalues times the identity
+ * on the rest of the space.  This takes O(<code>N * rank</code>) memory
+ * and O(<code>N * rank^2</code>) time for N unconstrained parameters,
+ * and is exact when the rank is N.  The eigenvalues and eigenvectors are
+ * written to the Hessian writer instead of the Hessian.
+ *
+ * Interrupts are called between compute-intensive operations.  To
+ * turn off all console messages sent to the logger, set refresh to 0.
+ * If an exception is thrown by the model, the return value is
+ * non-zero, and if refresh > 0, its message is given to the logger as
+ * an error.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] rank number of Hessian-vector products, which must be
+ * positive
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and approximate eigenpairs of the negative Hessian at the
+ * mode for diagnostic purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample_low_rank(const Model& model,
+                            const Eigen::VectorXd& theta_hat, int draws,
+                            int rank, bool calculate_lp,
+                            unsigned int random_seed, int refresh,
+                            callbacks::interrupt& interrupt,
+                            callbacks::logger& logger,
+                            callbacks::writer& sample_writer,
+                            callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::laplace_sample_low_rank<jacobian>(
+        model, theta_hat, draws, rank, calculate_lp, random_seed, refresh,
+        interrupt, logger, sample_writer, hessian_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Take the specified number of draws from a low-rank Laplace
+ * approximation for the model at the specified unconstrained mode, as
+ * the overload without <code>psis_resample</code> does, optionally
+ * correcting the draws for the error of the approximation.
+ *
+ * If <code>psis_resample</code> and <code>calculate_lp</code> are set,
+ * the draws are held in memory and then resampled, as many of them with
+ * replacement, by their Pareto smoothed importance weights, the ratios
+ * of the density of the model to the density of the approximation at the
+ * draws, before they are written; see
+ * <code>util::psis_resample_writer</code>.  The resampled draws are
+ * closer to draws of the posterior, and the Pareto shape of the weights,
+ * which is logged, tells whether they are close enough to be used in
+ * place of a run of NUTS: above 0.7 they are not.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] rank number of Hessian-vector products, which must be
+ * positive
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] psis_resample whether to resample the draws by Pareto
+ * smoothed importance sampling, which needs <code>calculate_lp</code>
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and approximate eigenpairs of the negative Hessian at the
+ * mode for diagnostic purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample_low_rank(const Model& model,
+                            const Eigen::VectorXd& theta_hat, int draws,
+                            int rank, bool calculate_lp, bool psis_resample,
+                            unsigned int random_seed, int refresh,
+                            callbacks::interrupt& interrupt,
+                            callbacks::logger& logger,
+                            callbacks::writer& sample_writer,
+                            callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::write_psis_resampled(
+        psis_resample && calculate_lp, random_seed, refresh, interrupt,
+        logger, sample_writer, [&](callbacks::writer& writer) {
+          internal::laplace_sample_low_rank<jacobian>(
+              model, theta_hat, draws, rank, calculate_lp, random_seed,
+              refresh, interrupt, logger, writer, hessian_writer);
+        });
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Take the specified number of draws from the Laplace approximation for
+ * the model at the specified unconstrained mode with a sparse Hessian,
+ * writing the draws, unnormalized log density, and unnormalized density
+ * of the approximation to the sample writer and writing messages to the
+ * logger, returning a return code of zero if successful.
+ *
+ * The draws are those of <code>laplace_sample</code>, but no dense matrix
+ * is formed.  The Hessian at the mode is computed by
+ * <code>stan::model::sparse_hessian</code> from one Hessian-vector
+ * product per color of its sparsity pattern, which is detected with one
+ * product per unconstrained parameter unless it is given, and factored by
+ * a sparse Cholesky decomposition with a fill-reducing ordering.  For a
+ * hierarchical model, whose groups only interact through a few
+ * hyperparameters, the number of colors and the memory per parameter do
+ * not grow with the number of groups.  The nonzeros of the lower triangle
+ * of the Hessian are written to the Hessian writer as the rows of a
+ * matrix of their row, column and value.
+ *
+ * Interrupts are called between compute-intensive operations.  To
+ * turn off all console messages sent to the logger, set refresh to 0.
+ * If an exception is thrown by the model, the return value is
+ * non-zero, and if refresh > 0, its message is given to the logger as
+ * an error.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] sparsity sparsity pattern of the Hessian with its coloring,
+ * or <code>nullptr</code> to detect it at the mode
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and nonzeros of the Hessian at the mode for diagnostic
+ * purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample_sparse(
+    const Model& model, const Eigen::VectorXd& theta_hat, int draws,
+    const stan::model::hessian_sparsity* sparsity, bool calculate_lp,
+    unsigned int random_seed, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& sample_writer,
+    callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::laplace_sample_sparse<jacobian>(
+        model, theta_hat, draws, sparsity, calculate_lp, random_seed, refresh,
+        interrupt, logger, sample_writer, hessian_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Take the specified number of draws from the Laplace approximation for
+ * the model at the specified unconstrained mode with a sparse Hessian,
+ * as the overload without <code>psis_resample</code> does, optionally
+ * correcting the draws for the error of the approximation.
+ *
+ * If <code>psis_resample</code> and <code>calculate_lp</code> are set,
+ * the draws are held in memory and then resampled, as many of them with
+ * replacement, by their Pareto smoothed importance weights, the ratios
+ * of the density of the model to the density of the approximation at the
+ * draws, before they are written; see
+ * <code>util::psis_resample_writer</code>.  The resampled draws are
+ * closer to draws of the posterior, and the Pareto shape of the weights,
+ * which is logged, tells whether they are close enough to be used in
+ * place of a run of NUTS: above 0.7 they are not.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] sparsity sparsity pattern of the Hessian with its coloring,
+ * or <code>nullptr</code> to detect it at the mode
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] psis_resample whether to resample the draws by Pareto
+ * smoothed importance sampling, which needs <code>calculate_lp</code>
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and nonzeros of the Hessian at the mode for diagnostic
+ * purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample_sparse(
+    const Model& model, const Eigen::VectorXd& theta_hat, int draws,
+    const stan::model::hessian_sparsity* sparsity, bool calculate_lp,
+    bool psis_resample, unsigned int random_seed, int refresh,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& sample_writer,
+    callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::write_psis_resampled(
+        psis_resample && calculate_lp, random_seed, refresh, interrupt,
+        logger, sample_writer, [&](callbacks::writer& writer) {
+          internal::laplace_sample_sparse<jacobian>(
+              model, theta_hat, draws, sparsity, calculate_lp, random_seed,
+              refresh, interrupt, logger, writer, hessian_writer);
+        });
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Take the specified number of draws from a Laplace approximation for the
+ * model at the specified unconstrained mode whose covariance is the
+ * inverse Hessian approximation of an L-BFGS run that found the mode,
+ * writing the draws, unnormalized log density, and unnormalized density
+ * of the approximation to the sample writer and writing messages to the
+ * logger, returning a return code of zero if successful.
+ *
+ * No Hessian is computed.  The approximation is defined by the update
+ * vectors L-BFGS keeps, as produced by <code>optimize::lbfgs</code>, in
+ * the compact form pathfinder uses, and takes O(<code>N * m</code>)
+ * memory and O(<code>N * m^2</code>) time for N unconstrained parameters
+ * and m updates, along with a single gradient at the mode.  Updates
+ * without positive curvature are dropped.  The approximation is only as
+ * good as the curvature L-BFGS saw on its way to the mode, so the draws
+ * can optionally be resampled by Pareto smoothed importance sampling,
+ * which requires the log density of the draws and holds all of them in
+ * memory.  The update vectors are written to the Hessian writer instead
+ * of the Hessian.
+ *
+ * Interrupts are called between compute-intensive operations.  To
+ * turn off all console messages sent to the logger, set refresh to 0.
+ * If an exception is thrown by the model, the return value is
+ * non-zero, and if refresh > 0, its message is given to the logger as
+ * an error.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] s_history differences between consecutive L-BFGS iterates,
+ * one update per column, oldest first
+ * @param[in] y_history differences between consecutive gradients of the
+ * negative log density in the same columns
+ * @param[in] draws number of draws to generate
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] psis_resample whether to resample the draws by Pareto
+ * smoothed importance sampling, ignored if <code>calculate_lp</code> is
+ * false
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and L-BFGS update vectors at the mode for diagnostic purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample_lbfgs(const Model& model, const Eigen::VectorXd& theta_hat,
+                         const Eigen::MatrixXd& s_history,
+                         const Eigen::MatrixXd& y_history, int draws,
+                         bool calculate_lp, bool psis_resample,
+                         unsigned int random_seed, int refresh,
+                         callbacks::interrupt& interrupt,
+                         callbacks::logger& logger,
+                         callbacks::writer& sample_writer,
+                         callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::write_psis_resampled(
+        psis_resample && calculate_lp, random_seed, refresh, interrupt,
+        logger, sample_writer, [&](callbacks::writer& writer) {
+          internal::laplace_sample_lbfgs<jacobian>(
+              model, theta_hat, s_history, y_history, draws, calculate_lp,
+              random_seed, refresh, interrupt, logger, writer, hessian_writer);
+        });
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
 }  // namespace services
 }  // namespace stan
 
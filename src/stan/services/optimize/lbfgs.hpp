@@ -48,6 +48,13 @@ namespace optimize {
  * @param[in,out] logger Logger for messages
  * @param[in,out] init_writer Writer callback for unconstrained inits
  * @param[in,out] parameter_writer output for parameter values
+ * @param[out] s_history if not null, along with <code>y_history</code>,
+ *   the differences between consecutive
+ *   iterates of the last <code>history_size</code> updates, one per
+ *   column and oldest first, which with <code>y_history</code> define the
+ *   inverse Hessian approximation of L-BFGS at the optimum
+ * @param[out] y_history if not null, the differences between consecutive
+ *   gradients of the negative log density of the same updates
  * @return error_codes::OK if successful
  */
 template <class Model, bool jacobian = false>
@@ -58,7 +65,9 @@ int lbfgs(Model& model, const stan::io::var_context& init,
           double tol_param, int num_iterations, bool save_iterations,
           int refresh, callbacks::interrupt& interrupt,
           callbacks::logger& logger, callbacks::writer& init_writer,
-          callbacks::writer& parameter_writer) {
+          callbacks::writer& parameter_writer,
+          Eigen::MatrixXd* s_history = nullptr,
+          Eigen::MatrixXd* y_history = nullptr) {
   stan::rng_t rng = util::create_rng(random_seed, chain);
 
   std::vector<int> disc_vector;
@@ -77,6 +86,7 @@ int lbfgs(Model& model, const stan::io::var_context& init,
                                              double, Eigen::Dynamic, jacobian>
       Optimizer;
   Optimizer lbfgs(model, cont_vector, disc_vector, &lbfgs_ss);
+  lbfgs.set_interrupt(&interrupt);
   lbfgs.get_qnupdate().set_history_size(history_size);
   lbfgs._ls_opts.alpha0 = init_alpha;
   lbfgs._conv_opts.tolAbsF = tol_obj;
@@ -169,6 +179,8 @@ int lbfgs(Model& model, const stan::io::var_context& init,
     logger.error(e.what());
     return error_codes::SOFTWARE;
   }
+  if (s_history && y_history)
+    lbfgs.get_qnupdate().history(*s_history, *y_history);
 
   if (!save_iterations) {
     std::vector<double> values;
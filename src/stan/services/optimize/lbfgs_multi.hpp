@@ -0,0 +1,263 @@
+#ifndef STAN_SERVICES_OPTIMIZE_LBFGS_MULTI_HPP
+#define STAN_SERVICES_OPTIMIZE_LBFGS_MULTI_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/optimization/bfgs.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace optimize {
+namespace internal {
+
+/**
+ * A mode found by one or more of the runs of a multi-start optimization.
+ */
+struct found_mode {
+  double lp;                   // Largest log density of the runs
+  std::vector<double> params;  // Unconstrained parameters of that run
+  int num_runs;                // Number of runs that converged to it
+};
+
+/**
+ * Merge the result of a run into the modes found so far, counting it
+ * toward a mode whose parameters are all within the tolerance of its
+ * own, or adding it as a new mode, and return the index of the mode.
+ */
+inline size_t merge_mode(std::vector<found_mode>& modes, double lp,
+                         const std::vector<double>& params, double mode_tol) {
+  for (size_t m = 0; m < modes.size(); ++m) {
+    bool same = true;
+    for (size_t k = 0; k < params.size() && same; ++k)
+      same = std::fabs(params[k] - modes[m].params[k]) <= mode_tol;
+    if (same) {
+      ++modes[m].num_runs;
+      if (lp > modes[m].lp) {
+        modes[m].lp = lp;
+        modes[m].params = params;
+      }
+      return m;
+    }
+  }
+  modes.push_back(found_mode{lp, params, 1});
+  return modes.size() - 1;
+}
+
+}  // namespace internal
+
+/**
+ * Runs the L-BFGS algorithm for a model from several initializations in
+ * parallel, sharing the model and its data, and writes the distinct modes
+ * found, from the highest log density down.
+ *
+ * The runs are split over the TBB threads.  Runs whose optima have all
+ * unconstrained parameters within <code>mode_tol</code> of each other
+ * are counted as converging to the same mode.  Once
+ * <code>num_agree</code> runs have converged to the mode with the
+ * highest log density found so far, the runs still going are stopped
+ * and the runs not yet started are skipped; with <code>num_agree</code>
+ * of zero every run is completed.  Runs that fail, or are stopped before
+ * they converge, find no mode.
+ *
+ * Run <code>i</code> draws its initialization from
+ * <code>*init[i]</code> with the random number generator of chain
+ * <code>chain + i</code> and writes it to <code>init_writers[i]</code>.
+ * The parameter writer receives the names <code>lp__</code> and the
+ * constrained parameter names, then one row per mode, and the logger
+ * is told how many runs converged to each mode.
+ *
+ * @tparam Model A model implementation
+ * @tparam jacobian `true` to include Jacobian adjustment (default `false`)
+ * @tparam InitContexts Type of a vector of pointers to
+ * `stan::io::var_context`
+ * @tparam InitWriters Type of a vector of `stan::callbacks::writer`
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init var contexts for the initialization of each run
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id of the first run, to advance the pseudo random
+ *   number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] history_size amount of history to keep for L-BFGS
+ * @param[in] init_alpha line search step size for first iteration
+ * @param[in] tol_obj convergence tolerance on absolute changes in
+ *   objective function value
+ * @param[in] tol_rel_obj convergence tolerance on relative changes
+ *   in objective function value
+ * @param[in] tol_grad convergence tolerance on the norm of the gradient
+ * @param[in] tol_rel_grad convergence tolerance on the relative norm of
+ *   the gradient
+ * @param[in] tol_param convergence tolerance on changes in parameter
+ *   value
+ * @param[in] num_iterations maximum number of iterations of each run
+ * @param[in] num_runs number of runs
+ * @param[in] mode_tol largest difference in any unconstrained parameter
+ *   between optima counted as the same mode
+ * @param[in] num_agree number of runs converging to the best mode after
+ *   which the others are stopped, or 0 to complete every run
+ * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writers Writer callbacks for the unconstrained inits
+ *   of each run
+ * @param[in,out] parameter_writer output for the modes
+ * @return error_codes::OK if at least one run converged
+ */
+template <class Model, bool jacobian = false, typename InitContexts,
+          typename InitWriters>
+int lbfgs_multi(Model& model, InitContexts&& init, unsigned int random_seed,
+                unsigned int chain, double init_radius, int history_size,
+                double init_alpha, double tol_obj, double tol_rel_obj,
+                double tol_grad, double tol_rel_grad, double tol_param,
+                int num_iterations, int num_runs, double mode_tol,
+                int num_agree, callbacks::interrupt& interrupt,
+                callbacks::logger& logger, InitWriters&& init_writers,
+                callbacks::writer& parameter_writer) {
+  typedef stan::optimization::BFGSLineSearch<Model,
+                                             stan::optimization::LBFGSUpdate<>,
+                                             double, Eigen::Dynamic, jacobian>
+      Optimizer;
+  std::vector<internal::found_mode> modes;
+  std::mutex modes_mutex;
+  std::atomic<bool> stop{false};
+  std::atomic<int> num_stopped{0};
+  std::atomic<int> num_interrupted{0};
+  size_t best = 0;
+
+  auto run = [&](int i) {
+    if (stop) {
+      ++num_stopped;
+      return;
+    }
+    if (interrupt.stop_requested()) {
+      ++num_interrupted;
+      return;
+    }
+    stan::rng_t rng = util::create_rng(random_seed, chain + i);
+    std::vector<int> disc_vector;
+    std::vector<double> cont_vector;
+    std::stringstream msg;
+    int ret = 0;
+    try {
+      cont_vector = util::initialize<false>(
+          model, *init[i], rng, init_radius, false, logger, init_writers[i]);
+      Optimizer lbfgs(model, cont_vector, disc_vector, &msg);
+      lbfgs.set_interrupt(&interrupt);
+      lbfgs.get_qnupdate().set_history_size(history_size);
+      lbfgs._ls_opts.alpha0 = init_alpha;
+      lbfgs._conv_opts.tolAbsF = tol_obj;
+      lbfgs._conv_opts.tolRelF = tol_rel_obj;
+      lbfgs._conv_opts.tolAbsGrad = tol_grad;
+      lbfgs._conv_opts.tolRelGrad = tol_rel_grad;
+      lbfgs._conv_opts.tolAbsX = tol_param;
+      lbfgs._conv_opts.maxIts = num_iterations;
+      while (ret == 0) {
+        if (stop) {
+          ++num_stopped;
+          return;
+        }
+        interrupt();
+        ret = lbfgs.step();
+      }
+      if (ret == stan::optimization::TERM_INTERRUPT) {
+        // a run stopped short of convergence is not a mode
+        ++num_interrupted;
+        return;
+      }
+      lbfgs.params_r(cont_vector);
+      if (msg.str().length() > 0)
+        logger.info(msg);
+      std::stringstream run_msg;
+      run_msg << "Optimization " << i << " terminated"
+              << (ret >= 0 ? " normally" : " with error") << " after "
+              << lbfgs.iter_num() << " iterations with log joint probability "
+              << lbfgs.logp() << ": " << lbfgs.get_code_string(ret);
+      if (ret < 0) {
+        logger.warn(run_msg);
+        return;
+      }
+      logger.info(run_msg);
+      std::lock_guard<std::mutex> lock(modes_mutex);
+      const size_t m
+          = internal::merge_mode(modes, lbfgs.logp(), cont_vector, mode_tol);
+      if (modes[m].lp > modes[best].lp)
+        best = m;
+      if (num_agree > 0 && modes[best].num_runs >= num_agree)
+        stop = true;
+    } catch (const std::exception& e) {
+      if (msg.str().length() > 0)
+        logger.info(msg);
+      logger.warn("Optimization " + std::to_string(i)
+                  + " failed: " + e.what());
+    }
+  };
+  tbb::parallel_for(tbb::blocked_range<int>(0, num_runs, 1),
+                    [&](const tbb::blocked_range<int>& r) {
+                      for (int i = r.begin(); i < r.end(); ++i)
+                        run(i);
+                    });
+
+  std::vector<std::string> names;
+  names.push_back("lp__");
+  model.constrained_param_names(names, true, true);
+  parameter_writer(names);
+  if (num_interrupted > 0)
+    logger.info(std::to_string(num_interrupted.load())
+                + " optimizations stopped on request");
+  if (modes.empty()) {
+    logger.error("No optimization converged");
+    return error_codes::SOFTWARE;
+  }
+  if (num_stopped > 0)
+    logger.info(std::to_string(num_stopped.load())
+                + " optimizations stopped early after "
+                + std::to_string(num_agree)
+                + " converged to the best mode");
+
+  std::stable_sort(modes.begin(), modes.end(),
+                   [](const internal::found_mode& a,
+                      const internal::found_mode& b) { return a.lp > b.lp; });
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+  std::vector<int> disc_vector;
+  for (size_t m = 0; m < modes.size(); ++m) {
+    std::stringstream mode_msg;
+    mode_msg << "Mode " << m << ": log joint probability = " << modes[m].lp
+             << ", found by " << modes[m].num_runs << " of " << num_runs
+             << " optimizations";
+    logger.info(mode_msg);
+
+    std::vector<double> values;
+    std::stringstream msg;
+    try {
+      model.write_array(rng, modes[m].params, disc_vector, values, true, true,
+                        &msg);
+    } catch (const std::exception& e) {
+      if (msg.str().length() > 0)
+        logger.info(msg);
+      logger.error(e.what());
+      return error_codes::SOFTWARE;
+    }
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    values.insert(values.begin(), modes[m].lp);
+    parameter_writer(values);
+  }
+  return error_codes::OK;
+}
+
+}  // namespace optimize
+}  // namespace services
+}  // namespace stan
+#endif
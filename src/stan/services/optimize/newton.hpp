@@ -35,6 +35,9 @@ namespace optimize {
  * @param[in,out] logger Logger for messages
  * @param[in,out] init_writer Writer callback for unconstrained inits
  * @param[in,out] parameter_writer output for parameter values
+ * @param[in] sparse_hessian whether to compute the Hessian as a sparse
+ *   matrix from Hessian-vector products, with the sparsity pattern
+ *   detected once at the initial values
  * @return error_codes::OK if successful
  */
 template <class Model, bool jacobian = false>
@@ -42,8 +45,8 @@ int newton(Model& model, const stan::io::var_context& init,
            unsigned int random_seed, unsigned int chain, double init_radius,
            int num_iterations, bool save_iterations,
            callbacks::interrupt& interrupt, callbacks::logger& logger,
-           callbacks::writer& init_writer,
-           callbacks::writer& parameter_writer) {
+           callbacks::writer& init_writer, callbacks::writer& parameter_writer,
+           bool sparse_hessian = false) {
   stan::rng_t rng = util::create_rng(random_seed, chain);
 
   std::vector<int> disc_vector;
@@ -89,6 +92,21 @@ int newton(Model& model, const stan::io::var_context& init,
   model.constrained_param_names(names, true, true);
   parameter_writer(names);
 
+  stan::model::hessian_sparsity sparsity;
+  if (sparse_hessian) {
+    try {
+      sparsity = stan::optimization::newton_hessian_sparsity<Model, jacobian>(
+          model, cont_vector);
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return error_codes::SOFTWARE;
+    }
+    std::stringstream sparsity_msg;
+    sparsity_msg << "Sparse Hessian from " << sparsity.num_colors
+                 << " Hessian-vector products";
+    logger.info(sparsity_msg);
+  }
+
   double lastlp = lp;
   for (int m = 0; m < num_iterations; m++) {
     if (save_iterations) {
@@ -101,9 +119,17 @@ int newton(Model& model, const stan::io::var_context& init,
       parameter_writer(values);
     }
     interrupt();
+    if (interrupt.stop_requested()) {
+      logger.info("Optimization stopped on request.");
+      break;
+    }
     lastlp = lp;
-    lp = stan::optimization::newton_step<Model, jacobian>(model, cont_vector,
-                                                          disc_vector);
+    if (sparse_hessian)
+      lp = stan::optimization::sparse_newton_step<Model, jacobian>(
+          model, cont_vector, disc_vector, sparsity);
+    else
+      lp = stan::optimization::newton_step<Model, jacobian>(
+          model, cont_vector, disc_vector);
 
     std::stringstream msg2;
     msg2 << "Iteration " << std::setw(2) << (m + 1) << "."
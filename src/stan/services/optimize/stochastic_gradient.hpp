@@ -0,0 +1,248 @@
+#ifndef STAN_SERVICES_OPTIMIZE_STOCHASTIC_GRADIENT_HPP
+#define STAN_SERVICES_OPTIMIZE_STOCHASTIC_GRADIENT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/slice_var_context.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/optimization/bfgs.hpp>
+#include <stan/optimization/stochastic_gradient.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace optimize {
+
+/**
+ * Find the posterior mode of a model with large data by a stochastic
+ * gradient method, Adam or AdaGrad, on minibatches of the data, then
+ * polish it with L-BFGS on the full data.
+ *
+ * Each iteration evaluates the gradient of the log density of a model
+ * constructed from a <code>stan::io::slice_var_context</code> of
+ * <code>batch_size</code> rows of the sliced variables of the data,
+ * through <code>stan::optimization::ModelAdaptor</code>.  An epoch takes
+ * enough minibatches to cover the rows once, starting at a random row.
+ * The log density of a minibatch model has to estimate that of the full
+ * data, which a model does by weighting its likelihood by the ratio of the
+ * numbers of rows of the data and of the minibatch, for example from an
+ * unsliced data variable holding the number of rows of the data.
+ *
+ * The mode estimated, the Polyak average of the iterates if
+ * <code>options.averaging_start</code> is not negative, is polished by up
+ * to <code>polish_iterations</code> iterations of L-BFGS on the model of
+ * the full data, which converges in few iterations from a point near the
+ * mode.  Only the final parameters are written.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment (default `false`)
+ * @tparam Model A model implementation
+ * @tparam BatchModelFactory type of a callable returning a pointer, or a
+ *   smart pointer, to a model constructed from a
+ *   <code>stan::io::var_context</code>
+ * @param[in] model model of the full data
+ * @param[in] make_batch_model callable constructing the model of a
+ *   minibatch from its data
+ * @param[in] data data of the model
+ * @param[in] sliced_names names of the data variables whose rows are the
+ *   minibatches
+ * @param[in] size_names names of the integer data variables holding the
+ *   number of rows, presented as the batch size
+ * @param[in] batch_size number of rows of a minibatch
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] options settings of the stochastic gradient method
+ * @param[in] num_epochs number of passes over the data
+ * @param[in] polish_iterations maximum number of iterations of L-BFGS on
+ *   the full data, or zero not to polish
+ * @param[in] history_size amount of history to keep for L-BFGS
+ * @param[in] refresh how often, in iterations, to write output to logger
+ * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] parameter_writer output for parameter values
+ * @return error_codes::OK if successful, error_codes::CONFIG if the
+ *   minibatches or the initial values are invalid, error_codes::SOFTWARE
+ *   if the gradients of the minibatches keep failing or L-BFGS fails
+ */
+template <bool jacobian = false, class Model, class BatchModelFactory>
+int stochastic_gradient(
+    Model& model, BatchModelFactory&& make_batch_model,
+    const stan::io::var_context& data,
+    const std::vector<std::string>& sliced_names,
+    const std::vector<std::string>& size_names, size_t batch_size,
+    const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius,
+    const stan::optimization::stochastic_gradient_options& options,
+    int num_epochs, int polish_iterations, int history_size, int refresh,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& parameter_writer) {
+  // consecutive failed minibatch gradients after which the run fails
+  constexpr int max_failures = 10;
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<int> disc_vector;
+  std::vector<double> cont_vector;
+  size_t num_rows = 0;
+  try {
+    stan::io::slice_var_context batch_data(data, sliced_names, size_names, 0,
+                                           batch_size);
+    num_rows = batch_data.num_rows();
+    auto batch_model = make_batch_model(batch_data);
+    cont_vector = util::initialize<false>(*batch_model, init, rng,
+                                          init_radius, false, logger,
+                                          init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  const Eigen::Index num_params = cont_vector.size();
+  std::unique_ptr<stan::optimization::stochastic_gradient> sgd;
+  try {
+    sgd = std::make_unique<stan::optimization::stochastic_gradient>(
+        Eigen::Map<Eigen::VectorXd>(cont_vector.data(), num_params), options);
+  } catch (const std::invalid_argument& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  std::vector<std::string> names;
+  names.push_back("lp__");
+  model.constrained_param_names(names, true, true);
+  parameter_writer(names);
+
+  const size_t steps_per_epoch = (num_rows + batch_size - 1) / batch_size;
+  boost::random::uniform_int_distribution<size_t> start_row(0, num_rows - 1);
+  std::stringstream msgs;
+  Eigen::VectorXd g;
+  double sum_lp = 0;
+  int num_lp = 0;
+  int failures = 0;
+  try {
+    for (int epoch = 0; epoch < num_epochs; ++epoch) {
+      const size_t offset = start_row(rng);
+      for (size_t step = 0; step < steps_per_epoch; ++step) {
+        interrupt();
+        stan::io::slice_var_context batch_data(data, sliced_names,
+                                               size_names,
+                                               offset + step * batch_size,
+                                               batch_size);
+        auto batch_model = make_batch_model(batch_data);
+        using batch_model_t = std::decay_t<decltype(*batch_model)>;
+        stan::optimization::ModelAdaptor<batch_model_t, jacobian> adaptor(
+            *batch_model, disc_vector, &msgs);
+        double f;
+        if (adaptor(sgd->x(), f, g) != 0) {
+          logger.info(msgs);
+          msgs.str("");
+          if (++failures >= max_failures) {
+            logger.error("Stochastic gradient: the gradients of "
+                         + std::to_string(max_failures)
+                         + " consecutive minibatches failed");
+            return error_codes::SOFTWARE;
+          }
+          continue;
+        }
+        failures = 0;
+        sgd->step(g);
+        sum_lp -= f;
+        ++num_lp;
+        if (refresh > 0 && (sgd->iter_num() % refresh == 0)) {
+          std::stringstream msg;
+          msg << "Epoch " << std::setw(4) << epoch + 1 << ", iteration "
+              << std::setw(7) << sgd->iter_num()
+              << ", mean minibatch log density = " << std::setprecision(6)
+              << sum_lp / num_lp;
+          logger.info(msg);
+          sum_lp = 0;
+          num_lp = 0;
+        }
+        if (msgs.str().length() > 0) {
+          logger.info(msgs);
+          msgs.str("");
+        }
+      }
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  const Eigen::VectorXd& estimate = sgd->average();
+  cont_vector.assign(estimate.data(), estimate.data() + num_params);
+  double lp = -std::numeric_limits<double>::infinity();
+  int ret = 0;
+  std::string error_string;
+  try {
+    if (polish_iterations > 0) {
+      typedef stan::optimization::BFGSLineSearch<
+          Model, stan::optimization::LBFGSUpdate<>, double, Eigen::Dynamic,
+          jacobian>
+          Optimizer;
+      std::stringstream lbfgs_ss;
+      Optimizer lbfgs(model, cont_vector, disc_vector, &lbfgs_ss);
+      lbfgs.set_interrupt(&interrupt);
+      lbfgs.get_qnupdate().set_history_size(history_size);
+      lbfgs._conv_opts.maxIts = polish_iterations;
+      if (refresh > 0) {
+        std::stringstream msg;
+        msg << "Polishing with L-BFGS from log joint probability = "
+            << lbfgs.logp();
+        logger.info(msg);
+      }
+      while (ret == 0) {
+        interrupt();
+        ret = lbfgs.step();
+        if (lbfgs_ss.str().length() > 0) {
+          logger.info(lbfgs_ss);
+          lbfgs_ss.str("");
+        }
+      }
+      lp = lbfgs.logp();
+      lbfgs.params_r(cont_vector);
+      error_string = lbfgs.get_code_string(ret);
+    } else {
+      lp = model.template log_prob<false, jacobian>(cont_vector, disc_vector,
+                                                    &msgs);
+    }
+    std::vector<double> values;
+    model.write_array(rng, cont_vector, disc_vector, values, true, true,
+                      &msgs);
+    if (msgs.str().length() > 0)
+      logger.info(msgs);
+    values.insert(values.begin(), lp);
+    parameter_writer(values);
+  } catch (const std::exception& e) {
+    if (msgs.str().length() > 0)
+      logger.info(msgs);
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  if (ret < 0) {
+    logger.error("Optimization terminated with error: ");
+    logger.error("  " + error_string);
+    return error_codes::SOFTWARE;
+  }
+  logger.info("Optimization terminated normally: ");
+  if (!error_string.empty())
+    logger.info("  " + error_string);
+  return error_codes::OK;
+}
+
+}  // namespace optimize
+}  // namespace services
+}  // namespace stan
+#endif
@@ -7,6 +7,7 @@
 #include <stan/io/var_context.hpp>
 #include <stan/optimization/bfgs.hpp>
 #include <stan/optimization/lbfgs_update.hpp>
+#include <stan/services/pathfinder/path_quality.hpp>
 #include <stan/services/pathfinder/single.hpp>
 #include <stan/services/pathfinder/psis.hpp>
 #include <stan/services/error_codes.hpp>
@@ -14,7 +15,11 @@
 #include <stan/services/util/duration_diff.hpp>
 #include <stan/services/util/initialize.hpp>
 #include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
 #include <boost/random/discrete_distribution.hpp>
+#include <atomic>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -87,6 +92,33 @@ namespace pathfinder {
  *  samples are written to `parameter_writer`. If `false`, no psis resampling is
  * performed and (`num_paths` * `num_draws`) samples are written to
  * `parameter_writer`.
+ * @param[in] regenerate_draws If `true`, the individual pathfinders' draws
+ * are not kept. Only their log probability ratios and what is needed to
+ * regenerate their draws are kept, and the draws that are written to
+ * `parameter_writer` are regenerated once the pathfinders have finished.
+ * The same draws are written either way, but the memory needed no longer
+ * grows with (`num_paths` * `num_draws`) times the number of parameters.
+ * @param[in] elbo_every Positive number of L-BFGS iterations between the
+ * ELBO estimates of each single pathfinder
+ * @param[in] elbo_patience Non-negative number of consecutive ELBO estimates
+ * without improvement after which a single pathfinder stops L-BFGS, or zero
+ * to run L-BFGS to convergence
+ * @param[in] tol_rel_elbo Non-negative relative improvement of the ELBO
+ * that counts as an improvement for `elbo_patience`
+ * @param[in] constrain_resampled_only If `true`, the draws are regenerated as
+ * with `regenerate_draws`, and the individual pathfinders keep only the log
+ * densities of their draws, without constraining them or writing them to
+ * `single_path_parameter_writer`. `write_array` is then only called, in
+ * parallel, for the draws that are written to `parameter_writer`, which with
+ * PSIS resampling are at most `num_multi_draws` of them.
+ * @param[in] min_ess If positive, and with PSIS resampling, the number of
+ * paths adapts to the target: no more paths are launched once the PSIS
+ * weights of the draws of the paths finished have an effective sample size
+ * of at least `min_ess` and a Pareto shape `k` of at most `max_pareto_k`.
+ * The paths already running finish and are resampled from, and at most
+ * `num_paths` paths are run.
+ * @param[in] max_pareto_k Largest Pareto shape `k` that meets the target of
+ * `min_ess`
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContext, typename InitWriter,
@@ -103,7 +135,10 @@ inline int pathfinder_lbfgs_multi(
     std::vector<SingleParamWriter>& single_path_parameter_writer,
     std::vector<SingleDiagnosticWriter>& single_path_diagnostic_writer,
     ParamWriter& parameter_writer, DiagnosticWriter& diagnostic_writer,
-    bool calculate_lp = true, bool psis_resample = true) {
+    bool calculate_lp = true, bool psis_resample = true,
+    bool regenerate_draws = false, int elbo_every = 1, int elbo_patience = 0,
+    double tol_rel_elbo = 0.0, bool constrain_resampled_only = false,
+    double min_ess = 0.0, double max_pareto_k = 0.7) {
   const auto start_pathfinders_time = std::chrono::steady_clock::now();
   std::vector<std::string> param_names;
   param_names.push_back("lp_approx__");
@@ -116,11 +151,29 @@ inline int pathfinder_lbfgs_multi(
   std::vector<Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic>>
       individual_samples;
   individual_samples.resize(num_paths);
+  regenerate_draws = regenerate_draws || constrain_resampled_only;
+  std::vector<internal::draw_generator_t> draw_generators;
+  if (regenerate_draws) {
+    draw_generators.resize(num_paths);
+    for (auto&& draw_generator : draw_generators) {
+      draw_generator.constrain_path_draws = !constrain_resampled_only;
+    }
+  }
   std::atomic<size_t> lp_calls{0};
+  const bool adapt_num_paths = min_ess > 0 && psis_resample && calculate_lp;
+  path_quality quality(max_pareto_k, min_ess);
+  // Each path is its own task, so idle threads steal paths rather than
+  // waiting on a block of long ones, and paths start in index order
+  std::atomic<int> next_path{0};
   try {
     tbb::parallel_for(
-        tbb::blocked_range<int>(0, num_paths), [&](tbb::blocked_range<int> r) {
-          for (int iter = r.begin(); iter < r.end(); ++iter) {
+        tbb::blocked_range<int>(0, num_paths, 1),
+        [&](const tbb::blocked_range<int>& r) {
+          for (int task = r.begin(); task < r.end(); ++task) {
+            if (adapt_num_paths && quality.met()) {
+              return;
+            }
+            const int iter = next_path++;
             auto pathfinder_ret
                 = stan::services::pathfinder::pathfinder_lbfgs_single<true>(
                     model, *(init[iter]), random_seed, stride_id + iter,
@@ -129,7 +182,9 @@ inline int pathfinder_lbfgs_multi(
                     num_elbo_draws, num_draws, save_iterations, refresh,
                     interrupt, logger, init_writers[iter],
                     single_path_parameter_writer[iter],
-                    single_path_diagnostic_writer[iter], calculate_lp);
+                    single_path_diagnostic_writer[iter], calculate_lp,
+                    regenerate_draws ? &draw_generators[iter] : nullptr,
+                    elbo_every, elbo_patience, tol_rel_elbo);
             if (unlikely(std::get<0>(pathfinder_ret) != error_codes::OK)) {
               logger.error(std::string("Pathfinder iteration: ")
                            + std::to_string(iter) + " failed.");
@@ -138,8 +193,12 @@ inline int pathfinder_lbfgs_multi(
             individual_lp_ratios[iter] = std::move(std::get<1>(pathfinder_ret));
             individual_samples[iter] = std::move(std::get<2>(pathfinder_ret));
             lp_calls += std::get<3>(pathfinder_ret);
+            if (adapt_num_paths) {
+              quality.add(individual_lp_ratios[iter]);
+            }
           }
-        });
+        },
+        tbb::simple_partitioner());
   } catch (const std::exception& e) {
     logger.error(e.what());
     return error_codes::SOFTWARE;
@@ -154,13 +213,17 @@ inline int pathfinder_lbfgs_multi(
       std::remove_if(individual_samples.begin(), individual_samples.end(),
                      [](const auto& v) { return v.size() == 0; }),
       individual_samples.end());
+  draw_generators.erase(
+      std::remove_if(draw_generators.begin(), draw_generators.end(),
+                     [](const auto& g) { return g.lp_mat.rows() == 0; }),
+      draw_generators.end());
 
   const auto end_pathfinders_time = std::chrono::steady_clock::now();
 
   const double pathfinders_delta_time = stan::services::util::duration_diff(
       start_pathfinders_time, end_pathfinders_time);
   const auto start_psis_time = std::chrono::steady_clock::now();
-  const size_t successful_pathfinders = individual_samples.size();
+  const size_t successful_pathfinders = individual_lp_ratios.size();
   if (successful_pathfinders == 0) {
     logger.info("No pathfinders ran successfully");
     return error_codes::SOFTWARE;
@@ -169,20 +232,29 @@ inline int pathfinder_lbfgs_multi(
     logger.info("Total log probability function evaluations:"
                 + std::to_string(lp_calls));
   }
+  if (adapt_num_paths && quality.met() && next_path < num_paths) {
+    std::stringstream msg;
+    msg << "Pathfinder: stopped launching paths after " << next_path
+        << " of " << num_paths << ", PSIS Pareto k = " << quality.pareto_k()
+        << ", ESS = " << quality.ess();
+    logger.info(msg.str());
+  }
   size_t num_returned_samples = 0;
   // Because of failure in single pathfinder we can have multiple returned sizes
   for (auto&& ilpr : individual_lp_ratios) {
     num_returned_samples += ilpr.size();
   }
   // Rows are individual parameters and columns are samples per iteration
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples(
-      individual_samples[0].rows(), num_returned_samples);
+  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples;
   Eigen::Index filling_start_row = 0;
-  for (size_t i = 0; i < successful_pathfinders; ++i) {
-    const Eigen::Index individ_num_samples = individual_samples[i].cols();
-    samples.middleCols(filling_start_row, individ_num_samples)
-        = individual_samples[i].matrix();
-    filling_start_row += individ_num_samples;
+  if (!regenerate_draws) {
+    samples.resize(individual_samples[0].rows(), num_returned_samples);
+    for (size_t i = 0; i < successful_pathfinders; ++i) {
+      const Eigen::Index individ_num_samples = individual_samples[i].cols();
+      samples.middleCols(filling_start_row, individ_num_samples)
+          = individual_samples[i].matrix();
+      filling_start_row += individ_num_samples;
+    }
   }
   double psis_delta_time = 0;
   if (psis_resample && calculate_lp) {
@@ -207,13 +279,65 @@ inline int pathfinder_lbfgs_multi(
                      boost::iterator_range<double*>(
                          weight_vals.data(),
                          weight_vals.data() + weight_vals.size())));
-    for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
-      parameter_writer(samples.col(rand_psis_idx()));
+    if (regenerate_draws) {
+      std::vector<Eigen::Index> psis_idxs(num_multi_draws);
+      for (auto&& psis_idx : psis_idxs) {
+        psis_idx = rand_psis_idx();
+      }
+      // Regenerate each selected draw once, grouped by path
+      std::vector<bool> selected(num_returned_samples, false);
+      for (auto&& psis_idx : psis_idxs) {
+        selected[psis_idx] = true;
+      }
+      std::vector<Eigen::Index> selected_col(num_returned_samples, -1);
+      std::vector<std::vector<Eigen::Index>> path_draw_idxs(
+          successful_pathfinders);
+      std::vector<Eigen::Index> path_offsets(successful_pathfinders);
+      Eigen::Index num_selected = 0;
+      filling_start_row = 0;
+      for (size_t i = 0; i < successful_pathfinders; ++i) {
+        path_offsets[i] = num_selected;
+        const Eigen::Index individ_num_samples = individual_lp_ratios[i].size();
+        for (Eigen::Index j = 0; j < individ_num_samples; ++j) {
+          if (selected[filling_start_row + j]) {
+            selected_col[filling_start_row + j] = num_selected++;
+            path_draw_idxs[i].push_back(j);
+          }
+        }
+        filling_start_row += individ_num_samples;
+      }
+      Eigen::MatrixXd selected_draws(param_names.size(), num_selected);
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, successful_pathfinders),
+          [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t i = r.begin(); i != r.end(); ++i) {
+              internal::regenerate_draws(model, draw_generators[i],
+                                         path_draw_idxs[i], selected_draws,
+                                         path_offsets[i]);
+            }
+          });
+      for (auto&& psis_idx : psis_idxs) {
+        parameter_writer(selected_draws.col(selected_col[psis_idx]));
+      }
+    } else {
+      for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
+        parameter_writer(samples.col(rand_psis_idx()));
+      }
     }
     const auto end_psis_time = std::chrono::steady_clock::now();
     psis_delta_time
         = stan::services::util::duration_diff(start_psis_time, end_psis_time);
 
+  } else if (regenerate_draws) {
+    // Write each path's draws in turn so only one path is held at a time
+    for (size_t i = 0; i < successful_pathfinders; ++i) {
+      std::vector<Eigen::Index> draw_idxs(individual_lp_ratios[i].size());
+      std::iota(draw_idxs.begin(), draw_idxs.end(), 0);
+      Eigen::MatrixXd path_draws(param_names.size(), draw_idxs.size());
+      internal::regenerate_draws(model, draw_generators[i], draw_idxs,
+                                 path_draws, 0);
+      parameter_writer(path_draws);
+    }
   } else {
     parameter_writer(samples);
   }
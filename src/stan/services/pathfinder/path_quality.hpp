@@ -0,0 +1,120 @@
+#ifndef STAN_SERVICES_PATHFINDER_PATH_QUALITY_HPP
+#define STAN_SERVICES_PATHFINDER_PATH_QUALITY_HPP
+
+#include <stan/services/pathfinder/psis_engine.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <string>
+
+namespace stan {
+namespace services {
+namespace pathfinder {
+
+/**
+ * Tracks the quality of the PSIS weights of the combined draws of the
+ * pathfinders finished so far, so that multi-path pathfinder can stop
+ * launching paths once the draws it has are good enough to resample.
+ *
+ * The weights are smoothed with the tail length multi-path pathfinder
+ * resamples with.  The quality target is met once the Pareto shape `k`
+ * of their tail is at most the specified maximum and their effective
+ * sample size, <code>(sum w)^2 / sum w^2</code>, at least the specified
+ * minimum.  A shape that could not be estimated, because there are too
+ * few draws, does not meet it.
+ *
+ * Paths can be added from several threads at once.
+ */
+class path_quality {
+ public:
+  /**
+   * @param[in] max_pareto_k largest Pareto shape that meets the target
+   * @param[in] min_ess smallest effective sample size that meets the
+   *   target
+   */
+  path_quality(double max_pareto_k, double min_ess)
+      : max_pareto_k_(max_pareto_k), min_ess_(min_ess) {}
+
+  /**
+   * Add the log importance ratios of the draws of a finished path and
+   * return whether the quality target is met.  Once met it stays met.
+   *
+   * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+   * compile time rows and 1 compile time column.
+   * @param[in] lp_ratios log importance ratios of the draws of the path
+   * @return true if the quality target is met
+   */
+  template <typename EigArray>
+  bool add(const EigArray& lp_ratios) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    const Eigen::Index num_old = lp_ratios_.size();
+    lp_ratios_.conservativeResize(num_old + lp_ratios.size());
+    lp_ratios_.tail(lp_ratios.size()) = lp_ratios;
+    ++num_paths_;
+    const double num_draws = lp_ratios_.size();
+    const auto tail_len
+        = std::min(0.2 * num_draws, 3 * std::sqrt(num_draws));
+    // the final resampling logs the warnings of the draws it keeps
+    ignored_warnings warnings;
+    pareto_k_ = engine_.weights(lp_ratios_, tail_len, weights_, warnings);
+    const double sum = weights_.sum();
+    ess_ = sum > 0 ? sum * sum / weights_.square().sum() : 0.0;
+    if (pareto_k_ <= max_pareto_k_ && ess_ >= min_ess_) {
+      met_ = true;
+    }
+    return met_;
+  }
+
+  /**
+   * Return whether the quality target is met.
+   */
+  bool met() const noexcept { return met_; }
+
+  /**
+   * Return the number of paths added.
+   */
+  size_t num_paths() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return num_paths_;
+  }
+
+  /**
+   * Return the Pareto shape of the weights of the paths added, `NaN` if
+   * it could not be estimated.
+   */
+  double pareto_k() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return pareto_k_;
+  }
+
+  /**
+   * Return the effective sample size of the weights of the paths added.
+   */
+  double ess() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return ess_;
+  }
+
+ private:
+  struct ignored_warnings {
+    void warn(const std::string& message) {}
+  };
+
+  const double max_pareto_k_;
+  const double min_ess_;
+  mutable std::mutex mutex_;
+  std::atomic<bool> met_{false};
+  size_t num_paths_ = 0;
+  double pareto_k_ = std::numeric_limits<double>::quiet_NaN();
+  double ess_ = 0;
+  Eigen::Array<double, Eigen::Dynamic, 1> lp_ratios_;
+  Eigen::Array<double, Eigen::Dynamic, 1> weights_;
+  psis::psis_engine engine_;
+};
+
+}  // namespace pathfinder
+}  // namespace services
+}  // namespace stan
+#endif
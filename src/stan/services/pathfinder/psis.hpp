@@ -4,6 +4,7 @@
 #include <stan/math.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/psis_engine.hpp>
 #include <tbb/parallel_invoke.h>
 #include <iomanip>
 #include <sstream>
@@ -235,47 +236,10 @@ largest_n_elements(const Eigen::Array<double, Eigen::Dynamic, 1>& arr,
 template <typename EigArray, typename Logger>
 inline Eigen::Array<double, Eigen::Dynamic, 1> psis_weights(
     const EigArray& log_ratios, Eigen::Index tail_len, Logger& logger) {
-  // shift log ratios for safer exponentiation
-  const double max_log_ratio = log_ratios.maxCoeff();
-  Eigen::Array<double, Eigen::Dynamic, 1> llr_weights
-      = log_ratios.array() - max_log_ratio;
-  if (tail_len >= 5) {
-    // Get back tail + smallest but not on tail in ascending order
-    std::pair<Eigen::Array<double, Eigen::Dynamic, 1>,
-              Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>>
-        max_n = internal::largest_n_elements(llr_weights, tail_len + 1);
-    auto lw_tail = max_n.first.tail(tail_len);
-    double cutoff = max_n.first(0);
-    if (unlikely(lw_tail.maxCoeff() - lw_tail.minCoeff()
-                 <= std::numeric_limits<double>::min() * 10)) {
-      double eps_diff = lw_tail.maxCoeff() - lw_tail.minCoeff();
-      logger.warn(
-       std::string("In PSIS Weight Calculation: Difference "
-       "between the tails is ") +
-        std::to_string(eps_diff) +
-        " which is too small for estimating the generalized pareto values."
-        " Returning non-pareto smoothed weights.");
-    } else {
-      auto smoothed = internal::psis_smooth_tail(lw_tail, cutoff);
-      auto idx = max_n.second.tail(tail_len);
-      const Eigen::Index idx_size = idx.size();
-      for (Eigen::Index i = 0; i < idx_size; ++i) {
-        llr_weights.coeffRef(idx.coeff(i)) = smoothed.first.coeff(i);
-      }
-      if (smoothed.second > 0.7) {
-        std::stringstream s;
-        s << "Pareto k value (" << std::setprecision(2) << smoothed.second
-          << ") is greater than 0.7. Importance resampling was not able to "
-          << "improve the approximation, which may indicate that the "
-          << "approximation itself is poor.";
-
-        logger.warn(s.str());
-      }
-    }
-  }
-
-  // truncate at max of raw wts (i.e., 0 since max has been subtracted)
-  return (llr_weights.array() < 0.0).select(llr_weights, 0.0).exp().eval();
+  psis_engine engine;
+  Eigen::Array<double, Eigen::Dynamic, 1> weights;
+  engine.weights(log_ratios, tail_len, weights, logger);
+  return weights;
 }
 
 }  // namespace psis
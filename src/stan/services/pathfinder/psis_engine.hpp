@@ -0,0 +1,243 @@
+#ifndef STAN_SERVICES_PSIS_ENGINE_HPP
+#define STAN_SERVICES_PSIS_ENGINE_HPP
+
+#include <stan/math/prim.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace psis {
+
+/**
+ * Computes Pareto smoothed importance sampling (PSIS) weights, keeping the
+ * buffers a call sets up for reuse by later calls.
+ *
+ * Only the tail is ordered: it is found by partial selection, which is
+ * linear in the number of ratios, and then sorted.  The profile likelihood
+ * of the generalized Pareto fit is evaluated one grid point at a time as a
+ * single pass over the tail, so no matrix of the size of the grid times the
+ * tail is formed.
+ *
+ * An engine must not be used from several threads at once; give each
+ * thread its own.
+ */
+class psis_engine {
+ public:
+  /**
+   * Write the PSIS weights of the specified log importance ratios into the
+   * specified result.  The weights are not normalized; they are scaled so
+   * that the largest raw weight is one and truncated there.
+   *
+   * @tparam EigArray An Eigen type inheriting from `ArrayBase` with dynamic
+   * compile time rows and 1 compile time column.
+   * @tparam Logger A type with a `warn(std::string)` method
+   * @param[in] log_ratios Array of logarithms of importance ratios
+   * @param[in] tail_len Size of the tail, no smoothing is done if it is less
+   * than 5
+   * @param[out] weights The weights, resized to the number of ratios
+   * @param[in,out] logger Stream for writing possible warnings
+   * @return The estimated Pareto shape parameter `k`, or `NaN` if the tail
+   * was not smoothed
+   */
+  template <typename EigArray, typename Logger>
+  double weights(const EigArray& log_ratios, Eigen::Index tail_len,
+                 Eigen::Array<double, Eigen::Dynamic, 1>& weights,
+                 Logger& logger) {
+    const Eigen::Index N = log_ratios.size();
+    // shift log ratios for safer exponentiation
+    weights = log_ratios.array() - log_ratios.maxCoeff();
+    double k = std::numeric_limits<double>::quiet_NaN();
+    tail_len = std::min(tail_len, N - 1);
+    if (tail_len >= 5) {
+      select_tail(weights, tail_len);
+      const double cutoff = weights.coeff(idx_[N - tail_len - 1]);
+      tail_.resize(tail_len);
+      for (Eigen::Index i = 0; i < tail_len; ++i) {
+        tail_.coeffRef(i) = weights.coeff(idx_[N - tail_len + i]);
+      }
+      const double tail_spread = tail_.coeff(tail_len - 1) - tail_.coeff(0);
+      if (unlikely(tail_spread <= std::numeric_limits<double>::min() * 10)) {
+        logger.warn(
+            std::string("In PSIS Weight Calculation: Difference "
+                        "between the tails is ")
+            + std::to_string(tail_spread)
+            + " which is too small for estimating the generalized pareto "
+              "values. Returning non-pareto smoothed weights.");
+      } else {
+        k = smooth_tail(cutoff);
+        for (Eigen::Index i = 0; i < tail_len; ++i) {
+          weights.coeffRef(idx_[N - tail_len + i]) = tail_.coeff(i);
+        }
+        if (k > 0.7) {
+          std::stringstream s;
+          s << "Pareto k value (" << std::setprecision(2) << k
+            << ") is greater than 0.7. Importance resampling was not able to "
+            << "improve the approximation, which may indicate that the "
+            << "approximation itself is poor.";
+          logger.warn(s.str());
+        }
+      }
+    }
+    // truncate at max of raw wts (i.e., 0 since max has been subtracted)
+    weights = (weights < 0.0).select(weights, 0.0).exp();
+    return k;
+  }
+
+ private:
+  std::vector<Eigen::Index> idx_;
+  Eigen::Array<double, Eigen::Dynamic, 1> tail_;
+  Eigen::Array<double, Eigen::Dynamic, 1> x_;
+  Eigen::Array<double, Eigen::Dynamic, 1> theta_;
+  Eigen::Array<double, Eigen::Dynamic, 1> l_theta_;
+
+  /**
+   * Order the last `tail_len + 1` entries of `idx_` so that they index
+   * the largest values in ascending order.  Ties are ordered by index.
+   */
+  void select_tail(const Eigen::Array<double, Eigen::Dynamic, 1>& values,
+                   Eigen::Index tail_len) {
+    const Eigen::Index N = values.size();
+    idx_.resize(N);
+    std::iota(idx_.begin(), idx_.end(), 0);
+    auto less = [&values](Eigen::Index a, Eigen::Index b) {
+      return values.coeff(a) < values.coeff(b)
+             || (values.coeff(a) == values.coeff(b) && a < b);
+    };
+    auto tail_begin = idx_.begin() + (N - tail_len - 1);
+    std::nth_element(idx_.begin(), tail_begin, idx_.end(), less);
+    std::sort(tail_begin, idx_.end(), less);
+  }
+
+  /**
+   * Replace the sorted tail in `tail_` with the logs of the order
+   * statistics of the generalized Pareto distribution fit to it.
+   *
+   * @param cutoff The largest log ratio not on the tail
+   * @return The estimated shape parameter
+   */
+  double smooth_tail(double cutoff) {
+    const double exp_cutoff = std::exp(cutoff);
+    x_ = tail_.exp() - exp_cutoff;
+    double sigma;
+    const double k = gpdfit(sigma);
+    if (!std::isinf(k)) {
+      const Eigen::Index x_size = tail_.size();
+      auto p = (Eigen::Array<double, Eigen::Dynamic, 1>::LinSpaced(x_size, 1,
+                                                                   x_size)
+                - 0.5)
+               / x_size;
+      tail_ = (sigma * (-k * (-p).log1p()).expm1() / k + exp_cutoff).log();
+    }
+    return k;
+  }
+
+  /**
+   * Fit a generalized Pareto distribution to the sorted sample in `x_`, as
+   * `internal::gpdfit` does.
+   *
+   * @param[out] sigma The estimated scale parameter
+   * @return The estimated shape parameter
+   */
+  double gpdfit(double& sigma, const Eigen::Index min_grid_pts = 30) {
+    constexpr double prior = 3.0;
+    const Eigen::Index N = x_.size();
+    // See section 4 of Zhang and Stephens (2009)
+    const Eigen::Index M = min_grid_pts + std::floor(std::sqrt(N));
+    // first quartile of sample
+    const double x_1st_qt = x_.coeff(
+        static_cast<Eigen::Index>(std::floor(static_cast<double>(N) / 4.0
+                                             + 0.5))
+        - 1l);
+    auto linspaced_arr = Eigen::Array<double, Eigen::Dynamic, 1>::LinSpaced(
+        M, 1, static_cast<double>(M));
+    theta_ = 1.0 / x_.coeff(N - 1)
+             + (1.0 - (M / (linspaced_arr - 0.5)).sqrt()) / (prior * x_1st_qt);
+    // profile log-lik, one vectorized pass over the sample per grid point
+    l_theta_.resize(M);
+    for (Eigen::Index m = 0; m < M; ++m) {
+      const double theta = theta_.coeff(m);
+      const double k = (-theta * x_).log1p().mean();
+      l_theta_.coeffRef(m) = N * (std::log(-theta / k) - k - 1);
+    }
+    const double theta_hat
+        = (theta_ * (l_theta_ - stan::math::log_sum_exp(l_theta_)).exp()).sum();
+    const double k = (-theta_hat * x_).log1p().mean();
+    sigma = -k / theta_hat;
+    constexpr double a = 10;
+    const double n_plus_a = N + a;
+    return k * N / n_plus_a + a * 0.5 / n_plus_a;
+  }
+};
+
+namespace internal {
+
+/**
+ * Keeps the warnings written while smoothing one set of ratios so that
+ * they can be logged in order once every set is done.
+ */
+struct psis_warnings {
+  std::vector<std::string> messages;
+  void warn(const std::string& message) { messages.push_back(message); }
+};
+
+}  // namespace internal
+
+/**
+ * Compute PSIS weights for each column of a matrix of log importance
+ * ratios.  The columns are smoothed in parallel and the warnings for each
+ * column are logged in column order.
+ *
+ * @tparam Logger A type with a `warn(std::string)` method
+ * @param[in] log_ratios Matrix of logarithms of importance ratios, one set
+ * of ratios per column
+ * @param[in] tail_len Size of the tail of each column
+ * @param[out] weights Weights of each column, resized to the size of
+ * `log_ratios`
+ * @param[in,out] logger Stream for writing possible warnings
+ * @return The estimated Pareto shape parameter of each column, `NaN` for
+ * columns that were not smoothed
+ */
+template <typename Logger>
+inline Eigen::VectorXd psis_weights_by_column(const Eigen::MatrixXd& log_ratios,
+                                              Eigen::Index tail_len,
+                                              Eigen::MatrixXd& weights,
+                                              Logger& logger) {
+  const Eigen::Index num_sets = log_ratios.cols();
+  weights.resize(log_ratios.rows(), num_sets);
+  Eigen::VectorXd pareto_k(num_sets);
+  std::vector<internal::psis_warnings> warnings(num_sets);
+  tbb::enumerable_thread_specific<psis_engine> engines;
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, num_sets),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        psis_engine& engine = engines.local();
+        Eigen::Array<double, Eigen::Dynamic, 1> set_weights;
+        for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+          pareto_k(i) = engine.weights(log_ratios.col(i).array(), tail_len,
+                                       set_weights, warnings[i]);
+          weights.col(i) = set_weights.matrix();
+        }
+      });
+  for (auto&& set_warnings : warnings) {
+    for (auto&& message : set_warnings.messages) {
+      logger.warn(message);
+    }
+  }
+  return pareto_k;
+}
+
+}  // namespace psis
+}  // namespace services
+}  // namespace stan
+
+#endif
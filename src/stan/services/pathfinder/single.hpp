@@ -1,6 +1,7 @@
 #ifndef STAN_SERVICES_PATHFINDER_SINGLE_HPP
 #define STAN_SERVICES_PATHFINDER_SINGLE_HPP
 
+#include <stan/callbacks/event_tracer.hpp>
 #include <stan/callbacks/interrupt.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
@@ -11,10 +12,13 @@
 #include <stan/services/util/initialize.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/duration_diff.hpp>
-#include <boost/circular_buffer.hpp>
+#include <stan/services/util/workspace.hpp>
 #include <tbb/parallel_for.h>
 #include <tbb/concurrent_queue.h>
 #include <tbb/task_group.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <atomic>
@@ -116,16 +120,22 @@ inline Eigen::MatrixXd approximate_samples(
                .colwise()
            + taylor_approx.x_center;
   } else {
-    return (taylor_approx.alpha.array().sqrt().matrix().asDiagonal()
-            * (taylor_approx.Qk
-                   * (taylor_approx.L_approx
-                      - Eigen::MatrixXd::Identity(
-                          taylor_approx.L_approx.rows(),
-                          taylor_approx.L_approx.cols()))
-                   * (taylor_approx.Qk.transpose() * u)
-               + u))
-               .colwise()
-           + taylor_approx.x_center;
+    // the products are formed in the workspace of the thread, in the order
+    // of Qk * (L - I) * (Qk^T * u)
+    util::workspace_scope scope;
+    const Eigen::Index min_size = taylor_approx.L_approx.rows();
+    auto l_minus_i = scope.get().matrix(min_size, min_size);
+    l_minus_i = taylor_approx.L_approx;
+    l_minus_i.diagonal().array() -= 1;
+    auto q_l = scope.get().matrix(taylor_approx.Qk.rows(), min_size);
+    q_l.noalias() = taylor_approx.Qk * l_minus_i;
+    auto q_u = scope.get().matrix(min_size, u.cols());
+    q_u.noalias() = taylor_approx.Qk.transpose() * u;
+    Eigen::MatrixXd draws = u;
+    draws.noalias() += q_l * q_u;
+    draws = taylor_approx.alpha.array().sqrt().matrix().asDiagonal() * draws;
+    draws.colwise() += taylor_approx.x_center;
+    return draws;
   }
 }
 
@@ -188,6 +198,22 @@ generate_matrix(Generator&& variate_generator, const Eigen::Index num_params,
                   [&variate_generator]() { return variate_generator(); });
 }
 
+/**
+ * Fill an Eigen matrix, such as a map into a `util::workspace`, from an rng
+ * generator, in the order `generate_matrix` draws its values.
+ * @tparam Generator A functor with a valid `operator()` used to generate the
+ * samples.
+ * @tparam EigMat A type inheriting from `Eigen::DenseBase`
+ * @param[in,out] variate_generator An rng generator
+ * @param[out] out The matrix to fill
+ */
+template <typename Generator, typename EigMat>
+inline void generate_matrix(Generator&& variate_generator, EigMat&& out) {
+  out = std::decay_t<EigMat>::PlainObject::NullaryExpr(
+      out.rows(), out.cols(),
+      [&variate_generator]() { return variate_generator(); });
+}
+
 /**
  * Estimate the approximate draws given the taylor approximation.
  *
@@ -225,35 +251,44 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
       rand_unit_gaus(rng, boost::normal_distribution<>());
   const auto num_params = taylor_approx.x_center.size();
   size_t lp_fun_calls = 0;
-  Eigen::MatrixXd unit_samps
-      = generate_matrix(rand_unit_gaus, num_params, num_samples);
+  util::workspace_scope scope;
+  auto unit_samps = scope.get().matrix(num_params, num_samples);
+  generate_matrix(rand_unit_gaus, unit_samps);
   Eigen::Array<double, Eigen::Dynamic, 2> lp_mat(num_samples, 2);
   lp_mat.col(0) = (-taylor_approx.logdetcholHk)
                   + -0.5
                         * (unit_samps.array().square().colwise().sum()
                            + num_params * stan::math::LOG_TWO_PI);
   Eigen::MatrixXd approx_samples
-      = approximate_samples(std::move(unit_samps), taylor_approx);
-  const auto log_stream
-      = [](auto& logger, auto& pathfinder_ss, const auto& iter_msg) {
-          if (pathfinder_ss.str().length() == 0)
-            return;
-          logger.info(iter_msg + pathfinder_ss.str());
-          pathfinder_ss.str(std::string());
-        };
-  Eigen::VectorXd approx_samples_col;
-  std::stringstream pathfinder_ss;
+      = approximate_samples(unit_samps, taylor_approx);
   Eigen::Array<double, Eigen::Dynamic, 1> lp_ratio;
   if (calculate_lp) {
-    for (Eigen::Index i = 0; i < num_samples; ++i) {
-      try {
-        approx_samples_col = approx_samples.col(i);
-        ++lp_fun_calls;
-        lp_mat.coeffRef(i, 1) = lp_fun(approx_samples_col, pathfinder_ss);
-      } catch (const std::domain_error& e) {
-        lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
+    // The draws are independent, so the log densities are evaluated in
+    // parallel.  Messages are kept per draw and logged in draw order.
+    std::vector<std::string> lp_msgs(num_samples);
+    tbb::parallel_for(
+        tbb::blocked_range<Eigen::Index>(0, num_samples),
+        [&](const tbb::blocked_range<Eigen::Index>& r) {
+          Eigen::VectorXd approx_samples_col;
+          std::stringstream pathfinder_ss;
+          for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+            try {
+              approx_samples_col = approx_samples.col(i);
+              lp_mat.coeffRef(i, 1) = lp_fun(approx_samples_col, pathfinder_ss);
+            } catch (const std::domain_error& e) {
+              lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
+            }
+            if (pathfinder_ss.str().length() != 0) {
+              lp_msgs[i] = pathfinder_ss.str();
+              pathfinder_ss.str(std::string());
+            }
+          }
+        });
+    lp_fun_calls = num_samples;
+    for (auto&& lp_msg : lp_msgs) {
+      if (lp_msg.length() != 0) {
+        logger.info(iter_msg + lp_msg);
       }
-      log_stream(logger, pathfinder_ss, iter_msg);
     }
     lp_ratio = lp_mat.col(1) - lp_mat.col(0);
   } else {
@@ -273,6 +308,197 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
   }
 }
 
+/**
+ * Write the log densities and the constrained values of one approximate
+ * draw into a column of output draws.
+ *
+ * Each draw is constrained with its own random number generator, seeded
+ * from a stream seed shared by a block of draws and the index of the draw
+ * in that block.  Draws can then be constrained in any order, or again
+ * later, and get the same generated quantities.
+ *
+ * @tparam ConstrainF Type of functor for constraining parameters
+ * @tparam LpRow Type of the log densities of the draw
+ * @tparam Draw Type of the unconstrained draw
+ * @tparam OutCol Type of the output column
+ * @param constrain_fun A functor to transform parameters to the constrained
+ * space
+ * @param stream_seed Seed shared by the block of draws
+ * @param draw_index Index of the draw in its block
+ * @param lp The log density of the approximation and of the model
+ * @param unconstrained_draw The unconstrained draw
+ * @param[out] constrained_draw Output draw with the two log densities
+ * followed by the constrained values
+ */
+template <typename ConstrainF, typename LpRow, typename Draw, typename OutCol>
+inline void constrain_draw(ConstrainF&& constrain_fun,
+                           std::uint64_t stream_seed, Eigen::Index draw_index,
+                           const LpRow& lp, const Draw& unconstrained_draw,
+                           OutCol&& constrained_draw) {
+  stan::rng_t draw_rng(static_cast<std::uint32_t>(stream_seed >> 32),
+                       static_cast<std::uint32_t>(stream_seed),
+                       static_cast<std::uint32_t>(draw_index), 1);
+  Eigen::VectorXd unconstrained_col = unconstrained_draw;
+  Eigen::VectorXd approx_samples_constrained_col;
+  constrained_draw.head(2) = lp.matrix();
+  constrained_draw.tail(constrained_draw.size() - 2)
+      = constrain_fun(draw_rng, unconstrained_col,
+                      approx_samples_constrained_col)
+            .matrix();
+}
+
+/**
+ * Write the log densities and the constrained values of a block of
+ * approximate draws into consecutive columns of a matrix of output draws.
+ * The draws are constrained in parallel with `constrain_draw`.
+ *
+ * @tparam ConstrainF Type of functor for constraining parameters
+ * @tparam LpMat Type of the matrix of log densities, one row per draw
+ * @tparam Draws Type of the matrix of unconstrained draws, one column per
+ * draw
+ * @param constrain_fun A functor to transform parameters to the constrained
+ * space
+ * @param stream_seed Seed shared by the block of draws
+ * @param lp_mat The log density of the approximation and of the model for
+ * each draw
+ * @param unconstrained_draws The unconstrained draws
+ * @param num_draws The number of draws to write, counting from the first
+ * @param[in,out] constrained_draws_mat Output draws, one column per draw
+ * with the two log densities followed by the constrained values
+ * @param offset The column of `constrained_draws_mat` the first draw is
+ * written to
+ */
+template <typename ConstrainF, typename LpMat, typename Draws>
+inline void constrain_draws(ConstrainF&& constrain_fun,
+                            std::uint64_t stream_seed, const LpMat& lp_mat,
+                            const Draws& unconstrained_draws,
+                            Eigen::Index num_draws,
+                            Eigen::MatrixXd& constrained_draws_mat,
+                            Eigen::Index offset) {
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, num_draws),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        for (Eigen::Index i = r.begin(); i != r.end(); ++i) {
+          constrain_draw(constrain_fun, stream_seed, i, lp_mat.row(i),
+                         unconstrained_draws.col(i),
+                         constrained_draws_mat.col(offset + i));
+        }
+      });
+}
+
+/**
+ * Everything needed to regenerate the draws returned by a single pathfinder
+ * without keeping them.  The returned draws are the ELBO draws of the best
+ * iteration, or the first of them, followed by the draws made after the
+ * path finished, and are regenerated from copies of the path generator
+ * taken before each block of draws was made.
+ *
+ * `constrain_path_draws` is set by the caller before the path runs.  If it
+ * is `false` the path neither constrains its draws nor writes them to its
+ * parameter writer, and only keeps their log densities, so `write_array` is
+ * only called for the draws that are regenerated.
+ */
+struct draw_generator_t {
+  // Whether the path constrains and writes its own draws
+  bool constrain_path_draws{true};
+  // The approximation at the best iteration
+  taylor_approx_t taylor_approx;
+  // Generator state the best iteration's ELBO draws were made from
+  stan::rng_t elbo_rng;
+  // Generator state the remaining draws were made from
+  stan::rng_t final_rng;
+  // Number of ELBO draws made at the best iteration
+  Eigen::Index num_elbo_draws{0};
+  // Number of draws made after the path finished
+  Eigen::Index num_final_draws{0};
+  // Seeds for constraining the ELBO and the remaining draws
+  std::uint64_t elbo_stream_seed{0};
+  std::uint64_t final_stream_seed{0};
+  // Approximate and true log density of each returned draw
+  Eigen::Array<double, Eigen::Dynamic, 2> lp_mat;
+};
+
+/**
+ * Make a block of unconstrained approximate draws exactly as
+ * `est_approx_draws` does.
+ *
+ * @param rng A copy of the generator the block was made from
+ * @param taylor_approx The approximation the block was made from
+ * @param num_samples Number of draws in the block
+ * @return Matrix with one draw per column
+ */
+inline Eigen::MatrixXd regenerate_approx_draws(
+    stan::rng_t rng, const taylor_approx_t& taylor_approx,
+    Eigen::Index num_samples) {
+  boost::variate_generator<stan::rng_t&, boost::normal_distribution<>>
+      rand_unit_gaus(rng, boost::normal_distribution<>());
+  util::workspace_scope scope;
+  auto unit_samps
+      = scope.get().matrix(taylor_approx.x_center.size(), num_samples);
+  generate_matrix(rand_unit_gaus, unit_samps);
+  return approximate_samples(unit_samps, taylor_approx);
+}
+
+/**
+ * Regenerate some of the draws returned by a single pathfinder.
+ *
+ * @tparam Model type of model
+ * @param model The model the path was run on
+ * @param generator What the path recorded about its returned draws
+ * @param draw_idxs Indices of the returned draws to regenerate
+ * @param[in,out] constrained_draws_mat Output draws, one column per draw
+ * with the two log densities followed by the constrained values
+ * @param offset The column of `constrained_draws_mat` the first draw is
+ * written to
+ */
+template <class Model>
+inline void regenerate_draws(const Model& model,
+                             const draw_generator_t& generator,
+                             const std::vector<Eigen::Index>& draw_idxs,
+                             Eigen::MatrixXd& constrained_draws_mat,
+                             Eigen::Index offset) {
+  auto constrain_fun = [&model](auto&& rng, auto&& unconstrained_draws,
+                                auto&& constrained_draws) {
+    model.write_array(rng, unconstrained_draws, constrained_draws);
+    return constrained_draws;
+  };
+  const Eigen::Index num_elbo_draws = generator.num_elbo_draws;
+  const bool uses_elbo_draws = std::any_of(
+      draw_idxs.begin(), draw_idxs.end(),
+      [num_elbo_draws](Eigen::Index i) { return i < num_elbo_draws; });
+  const bool uses_final_draws = std::any_of(
+      draw_idxs.begin(), draw_idxs.end(),
+      [num_elbo_draws](Eigen::Index i) { return i >= num_elbo_draws; });
+  Eigen::MatrixXd elbo_draws;
+  Eigen::MatrixXd final_draws;
+  if (uses_elbo_draws) {
+    elbo_draws = regenerate_approx_draws(
+        generator.elbo_rng, generator.taylor_approx, num_elbo_draws);
+  }
+  if (uses_final_draws) {
+    final_draws = regenerate_approx_draws(generator.final_rng,
+                                          generator.taylor_approx,
+                                          generator.num_final_draws);
+  }
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, draw_idxs.size()),
+      [&](const tbb::blocked_range<size_t>& r) {
+        for (size_t k = r.begin(); k != r.end(); ++k) {
+          const Eigen::Index i = draw_idxs[k];
+          if (i < num_elbo_draws) {
+            constrain_draw(constrain_fun, generator.elbo_stream_seed, i,
+                           generator.lp_mat.row(i), elbo_draws.col(i),
+                           constrained_draws_mat.col(offset + k));
+          } else {
+            constrain_draw(constrain_fun, generator.final_stream_seed,
+                           i - num_elbo_draws, generator.lp_mat.row(i),
+                           final_draws.col(i - num_elbo_draws),
+                           constrained_draws_mat.col(offset + k));
+          }
+        }
+      });
+}
+
 /**
  * Construct the full taylor approximation
  * @tparam GradMat Type inheriting from `Eigen::DenseBase` with compile time
@@ -285,37 +511,40 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
  * time rows and columns
  * @tparam EigVec Type inheriting from `Eigen::DenseBase` with 1 compile time
  * column
+ * @tparam CrossMat Type inheriting from `Eigen::DenseBase` with dynamic
+ * compile time rows and columns
  * @param Ykt_mat Matrix of the changes to the gradient with column length of
  * history size.
  * @param alpha The diagonal of the approximate hessian
  * @param Dk vector of Columnwise products of parameter and gradients with size
  * equal to history size
+ * @param y_alpha_y The product `Ykt_mat^T * diag(alpha) * Ykt_mat`
  * @param ninvRST Inverse of the Rk matrix
  * @param point_est The parameters for the given iteration of LBFGS
  * @param grad_est The gradients for the given iteration of LBFGS
  * @return The components of the dense taylor approximation
  */
-template <typename GradMat, typename AlphaVec, typename DkVec, typename InvMat,
-          typename EigVec>
+template <typename GradMat, typename AlphaVec, typename DkVec,
+          typename CrossMat, typename InvMat, typename EigVec>
 inline taylor_approx_t taylor_approximation_dense(
     GradMat&& Ykt_mat, const AlphaVec& alpha, const DkVec& Dk,
-    const InvMat& ninvRST, const EigVec& point_est, const EigVec& grad_est) {
-  auto y_tcrossprod_alpha_expr
-      = Ykt_mat.transpose() * alpha.array().sqrt().matrix().asDiagonal();
-  Eigen::MatrixXd y_tcrossprod_alpha
-      = Eigen::MatrixXd(y_tcrossprod_alpha_expr.rows(),
-                        y_tcrossprod_alpha_expr.rows())
-            .setZero()
-            .selfadjointView<Eigen::Lower>()
-            .rankUpdate(std::move(y_tcrossprod_alpha_expr));
+    const CrossMat& y_alpha_y, const InvMat& ninvRST, const EigVec& point_est,
+    const EigVec& grad_est) {
+  util::workspace_scope scope;
+  const Eigen::Index history_size = Ykt_mat.cols();
+  const Eigen::Index num_params = alpha.size();
+  auto y_tcrossprod_alpha = scope.get().matrix(history_size, history_size);
+  y_tcrossprod_alpha = y_alpha_y;
   /*
    * + DK.asDiagonal() cannot be done on same line
    * See https://forum.kde.org/viewtopic.php?f=74&t=136617
    */
   y_tcrossprod_alpha += Dk.asDiagonal();
 
-  Eigen::MatrixXd y_mul_alpha = Ykt_mat.transpose() * alpha.asDiagonal();
-  Eigen::MatrixXd Hk
+  auto y_mul_alpha = scope.get().matrix(history_size, num_params);
+  y_mul_alpha.noalias() = Ykt_mat.transpose() * alpha.asDiagonal();
+  auto Hk = scope.get().matrix(num_params, num_params);
+  Hk.noalias()
       = y_mul_alpha.transpose() * ninvRST
         + ninvRST.transpose() * (y_mul_alpha + y_tcrossprod_alpha * ninvRST);
   Hk += alpha.asDiagonal();
@@ -338,49 +567,53 @@ inline taylor_approx_t taylor_approximation_dense(
  * time rows and columns
  * @tparam EigVec Type inheriting from `Eigen::DenseBase` with 1 compile time
  * column
+ * @tparam CrossMat Type inheriting from `Eigen::DenseBase` with dynamic
+ * compile time rows and columns
  * @param Ykt_mat Matrix of the changes to the gradient with column length of
  * history size.
  * @param alpha The diagonal of the approximate hessian
  * @param Dk vector of Columnwise products of parameter and gradients with size
  * equal to history size
+ * @param y_alpha_y The product `Ykt_mat^T * diag(alpha) * Ykt_mat`
  * @param ninvRST The solution of X = R^-1 * S
  * @param point_est The parameters for the given iteration of LBFGS
  * @param grad_est The gradients for the given iteration of LBFGS
  * @return The components of the sparse taylor approximation
  */
-template <typename GradMat, typename AlphaVec, typename DkVec, typename InvMat,
-          typename EigVec>
+template <typename GradMat, typename AlphaVec, typename DkVec,
+          typename CrossMat, typename InvMat, typename EigVec>
 inline taylor_approx_t taylor_approximation_sparse(
     GradMat&& Ykt_mat, const AlphaVec& alpha, const DkVec& Dk,
-    const InvMat& ninvRST, const EigVec& point_est, const EigVec& grad_est) {
+    const CrossMat& y_alpha_y, const InvMat& ninvRST, const EigVec& point_est,
+    const EigVec& grad_est) {
   const Eigen::Index history_size = Ykt_mat.cols();
   const Eigen::Index history_size_times_2 = history_size * 2;
   const Eigen::Index num_params = alpha.size();
-  Eigen::MatrixXd y_mul_sqrt_alpha
-      = Ykt_mat.transpose() * alpha.array().sqrt().matrix().asDiagonal();
-  Eigen::MatrixXd Wkbart(history_size_times_2, num_params);
-  Wkbart.topRows(history_size) = y_mul_sqrt_alpha;
-  Wkbart.bottomRows(history_size)
-      = ninvRST * alpha.array().inverse().sqrt().matrix().asDiagonal();
-  Eigen::MatrixXd Mkbar(history_size_times_2, history_size_times_2);
+  // the temporaries live in the workspace of the thread, and Wkbar is
+  // formed as it is instead of transposing Wkbar^T in place
+  util::workspace_scope scope;
+  util::workspace& ws = scope.get();
+  auto Wkbar = ws.matrix(num_params, history_size_times_2);
+  Wkbar.leftCols(history_size)
+      = alpha.array().sqrt().matrix().asDiagonal() * Ykt_mat;
+  Wkbar.rightCols(history_size)
+      = alpha.array().inverse().sqrt().matrix().asDiagonal()
+        * ninvRST.transpose();
+  auto Mkbar = ws.matrix(history_size_times_2, history_size_times_2);
   Mkbar.topLeftCorner(history_size, history_size).setZero();
   Mkbar.topRightCorner(history_size, history_size)
       = Eigen::MatrixXd::Identity(history_size, history_size);
   Mkbar.bottomLeftCorner(history_size, history_size)
       = Eigen::MatrixXd::Identity(history_size, history_size);
-  Eigen::MatrixXd y_tcrossprod_alpha
-      = Eigen::MatrixXd(y_mul_sqrt_alpha.rows(), y_mul_sqrt_alpha.rows())
-            .setZero()
-            .selfadjointView<Eigen::Lower>()
-            .rankUpdate(std::move(y_mul_sqrt_alpha));
+  auto y_tcrossprod_alpha = ws.matrix(history_size, history_size);
+  y_tcrossprod_alpha = y_alpha_y;
   y_tcrossprod_alpha += Dk.asDiagonal();
   Mkbar.bottomRightCorner(history_size, history_size) = y_tcrossprod_alpha;
-  Wkbart.transposeInPlace();
   const auto min_size = std::min(num_params, history_size_times_2);
-  // Note: This is doing the QR decomp inplace using Wkbart's memory
-  Eigen::HouseholderQR<Eigen::Ref<decltype(Wkbart)>> qr(Wkbart);
-  Eigen::MatrixXd Rkbar
-      = qr.matrixQR().topLeftCorner(min_size, history_size_times_2);
+  // Note: This is doing the QR decomp inplace using Wkbar's memory
+  Eigen::HouseholderQR<Eigen::Ref<Eigen::MatrixXd>> qr(Wkbar);
+  auto Rkbar = ws.matrix(min_size, history_size_times_2);
+  Rkbar = qr.matrixQR().topLeftCorner(min_size, history_size_times_2);
   Rkbar.triangularView<Eigen::StrictlyLower>().setZero();
   Eigen::MatrixXd Qk
       = qr.householderQ() * Eigen::MatrixXd::Identity(num_params, min_size);
@@ -419,34 +652,163 @@ inline taylor_approx_t taylor_approximation_sparse(
  * time rows and columns
  * @tparam EigVec Type inheriting from `Eigen::DenseBase` with 1 compile time
  * column
+ * @tparam CrossMat Type inheriting from `Eigen::DenseBase` with dynamic
+ * compile time rows and columns
  * @param Ykt_mat Matrix of the changes to the gradient with column length of
  * history size.
  * @param alpha The diagonal of the approximate hessian
  * @param Dk vector of Columnwise products of parameter and gradients with size
  * equal to history size
- * @param ninvRST
+ * @param y_alpha_y The product `Ykt_mat^T * diag(alpha) * Ykt_mat`
+ * @param ninvRST The solution of X = R^-1 * S
  * @param point_est The parameters for the given iteration of LBFGS
  * @param grad_est The gradients for the given iteration of LBFGS
  * @return The components of either the sparse or dense taylor approximation
  */
-template <typename GradMat, typename AlphaVec, typename DkVec, typename InvMat,
-          typename EigVec>
+template <typename GradMat, typename AlphaVec, typename DkVec,
+          typename CrossMat, typename InvMat, typename EigVec>
 inline taylor_approx_t taylor_approximation(
     GradMat&& Ykt_mat, const AlphaVec& alpha, const DkVec& Dk,
-    const InvMat& ninvRST, const EigVec& point_est, const EigVec& grad_est) {
+    const CrossMat& y_alpha_y, const InvMat& ninvRST, const EigVec& point_est,
+    const EigVec& grad_est) {
   // If twice the current history size is larger than the number of params
   // use a sparse approximation
   const auto history_size = Ykt_mat.cols();
   const auto num_params = Ykt_mat.rows();
   if (2 * history_size >= num_params) {
-    return taylor_approximation_dense(Ykt_mat, alpha, Dk, ninvRST, point_est,
-                                      grad_est);
+    return taylor_approximation_dense(Ykt_mat, alpha, Dk, y_alpha_y, ninvRST,
+                                      point_est, grad_est);
   } else {
-    return taylor_approximation_sparse(Ykt_mat, alpha, Dk, ninvRST, point_est,
-                                       grad_est);
+    return taylor_approximation_sparse(Ykt_mat, alpha, Dk, y_alpha_y, ninvRST,
+                                       point_est, grad_est);
   }
 }
 
+/**
+ * The last `max_size` changes in the parameters and gradients of LBFGS in
+ * the order they were made, along with the products between them that the
+ * taylor approximation needs.  Each new pair of changes only adds one column
+ * to the upper triangular `Rk = S^T Y`, and one row and column to
+ * `Y^T diag(alpha) Y` as long as `alpha` did not change, instead of
+ * recomputing them from the whole history every iteration.
+ */
+class lbfgs_history {
+ public:
+  /**
+   * @param num_params Number of parameters
+   * @param max_size Positive number of changes to keep
+   */
+  lbfgs_history(Eigen::Index num_params, Eigen::Index max_size)
+      : Ykt_(num_params, max_size),
+        Skt_(num_params, max_size),
+        SY_(max_size, max_size),
+        y_alpha_y_(max_size, max_size),
+        ninvRST_(max_size, num_params),
+        size_(0),
+        num_fresh_(0) {}
+
+  /**
+   * Add a change in the parameters and gradients, dropping the oldest once
+   * the history is full.
+   * @param Sk Change in the parameters
+   * @param Yk Change in the gradients
+   */
+  template <typename EigVec1, typename EigVec2>
+  void push(const EigVec1& Sk, const EigVec2& Yk) {
+    if (size_ == Ykt_.cols()) {
+      shift_left(Ykt_);
+      shift_left(Skt_);
+      const Eigen::Index n = size_ - 1;
+      SY_.topLeftCorner(n, n) = SY_.bottomRightCorner(n, n).eval();
+      y_alpha_y_.topLeftCorner(n, n)
+          = y_alpha_y_.bottomRightCorner(n, n).eval();
+      num_fresh_ = std::max<Eigen::Index>(num_fresh_ - 1, 0);
+    } else {
+      ++size_;
+    }
+    const Eigen::Index k = size_ - 1;
+    Skt_.col(k) = Sk;
+    Ykt_.col(k) = Yk;
+    SY_.col(k).head(size_).noalias() = Skt_.leftCols(size_).transpose() * Yk;
+  }
+
+  /**
+   * Return the number of changes held.
+   */
+  Eigen::Index size() const noexcept { return size_; }
+
+  /**
+   * Return the changes in the gradients, oldest first.
+   */
+  auto Ykt() const { return Ykt_.leftCols(size_); }
+
+  /**
+   * Return the changes in the parameters, oldest first.
+   */
+  auto Skt() const { return Skt_.leftCols(size_); }
+
+  /**
+   * Return the products of each change in the parameters with the matching
+   * change in the gradients.
+   */
+  Eigen::VectorXd Dk() const { return SY_.diagonal().head(size_); }
+
+  /**
+   * Return `Ykt^T * diag(alpha) * Ykt`, computing only the rows and columns
+   * of changes added since the last call if `alpha` is the same.
+   * @param alpha The diagonal of the approximate hessian
+   */
+  template <typename AlphaVec>
+  auto y_alpha_y(const AlphaVec& alpha) {
+    if (num_fresh_ > 0
+        && (alpha_.size() != alpha.size()
+            || (alpha_.array() != alpha.array()).any())) {
+      num_fresh_ = 0;
+    }
+    if (num_fresh_ < size_) {
+      const Eigen::Index num_stale = size_ - num_fresh_;
+      Eigen::MatrixXd cross
+          = Ykt().transpose()
+            * (alpha.asDiagonal() * Ykt_.middleCols(num_fresh_, num_stale));
+      y_alpha_y_.block(0, num_fresh_, size_, num_stale) = cross;
+      y_alpha_y_.block(num_fresh_, 0, num_stale, size_) = cross.transpose();
+      alpha_ = alpha;
+      num_fresh_ = size_;
+    }
+    return y_alpha_y_.topLeftCorner(size_, size_);
+  }
+
+  /**
+   * Return `-Rk^-1 * Skt^T`, with `Rk` the upper triangle of `Skt^T Ykt`,
+   * following the unfolded algorithm in the paper for inverse RST.
+   */
+  auto ninvRST() {
+    auto ninvRST = ninvRST_.topRows(size_);
+    ninvRST = Skt().transpose();
+    SY_.topLeftCorner(size_, size_)
+        .template triangularView<Eigen::Upper>()
+        .solveInPlace(ninvRST);
+    ninvRST = -ninvRST;
+    return ninvRST;
+  }
+
+ private:
+  Eigen::MatrixXd Ykt_;
+  Eigen::MatrixXd Skt_;
+  // Upper triangle holds Rk
+  Eigen::MatrixXd SY_;
+  Eigen::MatrixXd y_alpha_y_;
+  Eigen::MatrixXd ninvRST_;
+  Eigen::VectorXd alpha_;
+  Eigen::Index size_;
+  // Number of leading changes whose rows of y_alpha_y_ are up to date
+  Eigen::Index num_fresh_;
+
+  static void shift_left(Eigen::MatrixXd& m) {
+    std::copy(m.data() + m.rows(), m.data() + m.size(), m.data());
+  }
+};
+
 /**
  * Construct the return for directly calling single pathfinder or
  * calling single pathfinder from multi pathfinder.
@@ -497,10 +859,8 @@ inline auto ret_pathfinder(int return_code, EigVec&& lp_ratio, EigMat&& samples,
  * space
  * @param current_params Parameters from iteration of LBFGS
  * @param current_grads Gradients from iteration of LBFGS
- * @param Ykt_mat Matrix of the last `history_size` changes in the gradient.
- * @param[in,out] Skt_mat Matrix of the last `history_size` changes in the
- * parameters. `Skt_mat` is transformed in this function and will hold inverse
- * solution of RS^T
+ * @param[in,out] history The last `history_size` changes in the parameters
+ * and gradients
  * @param num_elbo_draws Number of draws for the ELBO estimation
  * @param iter_msg The beginning of messages that includes the iteration number
  * @param logger A callback writer for messages
@@ -509,22 +869,15 @@ inline auto ret_pathfinder(int return_code, EigVec&& lp_ratio, EigMat&& samples,
  */
 template <typename RNG, typename LPFun, typename ConstrainFun,
           typename AlphaVec, typename CurrentParams, typename CurrentGrads,
-          typename GradMat, typename ParamMat, typename Logger>
+          typename Logger>
 auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
                      AlphaVec&& alpha, CurrentParams&& current_params,
-                     CurrentGrads&& current_grads, GradMat&& Ykt_mat,
-                     ParamMat&& Skt_mat, std::size_t num_elbo_draws,
-                     const std::string& iter_msg, Logger&& logger) {
-  const auto history_size = Ykt_mat.cols();
-  Eigen::MatrixXd Rk = Eigen::MatrixXd::Zero(history_size, history_size);
-  Rk.template triangularView<Eigen::Upper>() = Skt_mat.transpose() * Ykt_mat;
-  Eigen::VectorXd Dk = Rk.diagonal();
-  // Unfolded algorithm in paper for inverse RST
-  Rk.triangularView<Eigen::Upper>().solveInPlace(Skt_mat.transpose());
-  // Skt_mat is now ninvRST
-  Skt_mat = -Skt_mat;
+                     CurrentGrads&& current_grads, lbfgs_history& history,
+                     std::size_t num_elbo_draws, const std::string& iter_msg,
+                     Logger&& logger) {
   internal::taylor_approx_t taylor_appx = internal::taylor_approximation(
-      Ykt_mat, alpha, Dk, Skt_mat.transpose(), current_params, current_grads);
+      history.Ykt(), alpha, history.Dk(), history.y_alpha_y(alpha),
+      history.ninvRST(), current_params, current_grads);
   try {
     return std::make_pair(internal::est_approx_draws<true>(
                               lp_fun, constrain_fun, rng, taylor_appx,
@@ -576,7 +929,9 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
  *   be saved to the parameter_writer
  * @param[in] refresh Output is written to the logger for each iteration modulo
  * the refresh value
- * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] interrupt callback to be called every iteration; a stop
+ *   it requests, polled within the line searches too, ends L-BFGS and the
+ *   best approximation so far is used
  * @param[in] num_elbo_draws (K in paper) number of MC draws to evaluate ELBO
  * @param[in] num_draws (M in paper) number of approximate posterior draws to
  * return
@@ -590,6 +945,19 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
  * probability calculations will be `NA` and psis resampling will not be
  * performed. Setting this parameter to `false` will also set all of the lp
  * ratios to `NaN`.
+ * @param[in,out] draw_generator If not null, filled with what is needed to
+ * regenerate the returned draws with `internal::regenerate_draws`, and the
+ * returned matrix of draws is left empty so that they are not kept. If its
+ * `constrain_path_draws` is `false`, the draws are not constrained or
+ * written to `parameter_writer` either.
+ * @param[in] elbo_every Positive number of L-BFGS iterations between ELBO
+ * estimates. The ELBO is estimated at every iteration that is a multiple of
+ * it and at the last iteration, and only those iterations can be returned.
+ * @param[in] elbo_patience Non-negative number of consecutive ELBO estimates
+ * that may fail to improve on the best one before L-BFGS is stopped early,
+ * or zero to run L-BFGS to convergence
+ * @param[in] tol_rel_elbo Non-negative relative improvement over the best
+ * ELBO an estimate needs to count as an improvement for `elbo_patience`
  * @return If `ReturnLpSamples` is `true`, returns a tuple of the error code,
  * approximate draws, and a vector of the lp ratio. If `false`, only returns an
  * error code `error_codes::OK` if successful, `error_codes::SOFTWARE`
@@ -605,8 +973,18 @@ inline auto pathfinder_lbfgs_single(
     int num_elbo_draws, int num_draws, bool save_iterations, int refresh,
     callbacks::interrupt& interrupt, callbacks::logger& logger,
     callbacks::writer& init_writer, ParamWriter& parameter_writer,
-    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true) {
+    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true,
+    internal::draw_generator_t* draw_generator = nullptr, int elbo_every = 1,
+    int elbo_patience = 0, double tol_rel_elbo = 0.0) {
   const auto start_pathfinder_time = std::chrono::steady_clock::now();
+  if (elbo_every < 1 || elbo_patience < 0 || !(tol_rel_elbo >= 0)) {
+    logger.error(
+        "elbo_every must be positive, and elbo_patience and tol_rel_elbo "
+        "must be non-negative.");
+    return internal::ret_pathfinder<ReturnLpSamples>(
+        error_codes::CONFIG, Eigen::Array<double, Eigen::Dynamic, 1>(0),
+        Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(0, 0), 0);
+  }
   stan::rng_t rng = util::create_rng(random_seed, stride_id);
   std::vector<int> disc_vector;
   std::vector<double> cont_vector;
@@ -641,6 +1019,7 @@ inline auto pathfinder_lbfgs_single(
                                            Eigen::Dynamic, true>;
   Optimizer lbfgs(model, cont_vector, disc_vector, std::move(ls_opts),
                   std::move(conv_opts), std::move(lbfgs_update), &lbfgs_ss);
+  lbfgs.set_interrupt(&interrupt);
   const std::string path_num("Path [" + std::to_string(stride_id) + "] :");
   if (refresh != 0) {
     logger.info(path_num + "Initial log joint density = "
@@ -652,8 +1031,7 @@ inline auto pathfinder_lbfgs_single(
   model.constrained_param_names(names, true, true);
   parameter_writer(names);
   int ret = 0;
-  boost::circular_buffer<Eigen::VectorXd> param_buff(max_history_size);
-  boost::circular_buffer<Eigen::VectorXd> grad_buff(max_history_size);
+  internal::lbfgs_history history(num_parameters, max_history_size);
   Eigen::VectorXd prev_params
       = Eigen::Map<Eigen::VectorXd>(cont_vector.data(), cont_vector.size());
   std::size_t history_size = 0;
@@ -677,11 +1055,13 @@ inline auto pathfinder_lbfgs_single(
   };
   Eigen::VectorXd alpha = Eigen::VectorXd::Ones(num_parameters);
   Eigen::Index best_iteration = -1;
+  // ELBO estimates since the last one that improved enough on the best
+  int num_elbo_plateau = 0;
+  bool elbo_plateau = false;
   internal::elbo_est_t elbo_best;
   internal::taylor_approx_t taylor_approx_best;
+  stan::rng_t elbo_rng_best;
   std::size_t num_evals{lbfgs.grad_evals()};
-  Eigen::MatrixXd Ykt_mat(num_parameters, max_history_size);
-  Eigen::MatrixXd Skt_mat(num_parameters, max_history_size);
   std::string log_header = path_num + " Iter      log prob        ||dx||      "
   "||grad||     alpha      alpha0      # evals       ELBO    Best ELBO        "
   "Notes \n";
@@ -702,7 +1082,19 @@ inline auto pathfinder_lbfgs_single(
   while (ret == 0) {
     std::stringstream msg;
     interrupt();
-    ret = lbfgs.step();
+    {
+      callbacks::trace_scope trace("pathfinder", "lbfgs_iteration",
+                                   "iteration", lbfgs.iter_num());
+      ret = lbfgs.step();
+    }
+    if (ret == stan::optimization::TERM_INTERRUPT) {
+      // the path so far is used as if the ELBO had stopped improving
+      if (refresh != 0)
+        logger.info(path_num + "Stopped on request at Iter: ["
+                    + std::to_string(lbfgs.iter_num()) + "]");
+      elbo_plateau = true;
+      break;
+    }
     double lp = lbfgs.logp();
     bool write_log_cond
         = refresh > 0
@@ -747,12 +1139,11 @@ inline auto pathfinder_lbfgs_single(
       break;
     }
     try {
-      param_buff.push_back(lbfgs.curr_x() - prev_params);
-      grad_buff.push_back(lbfgs.curr_g() - prev_grads);
+      Eigen::VectorXd Sk = lbfgs.curr_x() - prev_params;
+      Eigen::VectorXd Yk = lbfgs.curr_g() - prev_grads;
+      history.push(Sk, Yk);
       prev_params = lbfgs.curr_x();
       prev_grads = lbfgs.curr_g();
-      auto&& Yk = grad_buff.back();
-      auto&& Sk = param_buff.back();
       if (internal::check_curve(Yk, Sk)) {
         double y_alpha_y = Yk.dot(alpha.asDiagonal() * Yk);
         double y_s = Yk.dot(Sk);
@@ -763,22 +1154,30 @@ inline auto pathfinder_lbfgs_single(
                                * Sk))
                          * (Sk.array() / alpha.array()).square());
       }
-      Eigen::Map<Eigen::MatrixXd> Ykt_map(Ykt_mat.data(), num_parameters,
-                                          history_size);
-      for (Eigen::Index i = 0; i < history_size; ++i) {
-        Ykt_map.col(i) = grad_buff[i];
-      }
-      Eigen::Map<Eigen::MatrixXd> Skt_map(Skt_mat.data(), num_parameters,
-                                          history_size);
-      for (Eigen::Index i = 0; i < history_size; ++i) {
-        Skt_map.col(i) = param_buff[i];
+      if (ret == 0 && lbfgs.iter_num() % elbo_every != 0) {
+        // only the history is updated between ELBO estimates
+        print_log_remainder(
+            write_log_cond, msg, ret, num_evals, lbfgs, elbo_best.elbo,
+            std::numeric_limits<double>::quiet_NaN(), lbfgs_ss, logger);
+        if (unlikely(save_iterations)) {
+          diagnostic_writer.write("lbfgs_success", true);
+          diagnostic_writer.write("pathfinder_success", false);
+          diagnostic_writer.write("lbfgs_note", lbfgs_ss.str());
+          diagnostic_writer.end_record();
+        }
+        if (lbfgs_ss.str().length() > 0) {
+          logger.info(lbfgs_ss);
+          lbfgs_ss.str("");
+        }
+        continue;
       }
       std::string iter_msg(path_num + "Iter: ["
                            + std::to_string(lbfgs.iter_num()) + "] ");
 
+      stan::rng_t elbo_rng = rng;
       auto pathfinder_res = internal::pathfinder_impl(
           rng, lp_fun, constrain_fun, alpha, lbfgs.curr_x(), lbfgs.curr_g(),
-          Ykt_map, Skt_map, num_elbo_draws, iter_msg, logger);
+          history, num_elbo_draws, iter_msg, logger);
       num_evals += pathfinder_res.first.fn_calls;
       print_log_remainder(write_log_cond, msg, ret, num_evals, lbfgs,
                           pathfinder_res.first.elbo, pathfinder_res.first.elbo,
@@ -801,11 +1200,28 @@ inline auto pathfinder_lbfgs_single(
         lbfgs_ss.str("");
       }
 
-      if (pathfinder_res.first.elbo > elbo_best.elbo) {
+      const double elbo = pathfinder_res.first.elbo;
+      const double min_improvement = tol_rel_elbo * std::fabs(elbo_best.elbo);
+      const bool improved = std::isfinite(elbo_best.elbo)
+                                ? elbo - elbo_best.elbo > min_improvement
+                                : elbo > elbo_best.elbo;
+      num_elbo_plateau = improved ? 0 : num_elbo_plateau + 1;
+      if (elbo > elbo_best.elbo) {
         elbo_best = std::move(pathfinder_res.first);
         taylor_approx_best = std::move(pathfinder_res.second);
+        elbo_rng_best = elbo_rng;
         best_iteration = lbfgs.iter_num();
       }
+      if (elbo_patience > 0 && num_elbo_plateau >= elbo_patience) {
+        elbo_plateau = true;
+        if (refresh != 0) {
+          logger.info(path_num + "ELBO did not improve in the last "
+                      + std::to_string(elbo_patience)
+                      + " estimates, stopping L-BFGS at Iter: ["
+                      + std::to_string(lbfgs.iter_num()) + "]");
+        }
+        break;
+      }
     } catch (const std::exception& e) {
       if (unlikely(save_iterations)) {
         diagnostic_writer.write("lbfgs_success", true);
@@ -835,7 +1251,7 @@ inline auto pathfinder_lbfgs_single(
   if (unlikely(save_iterations)) {
     diagnostic_writer.end_record();
   }
-  if (unlikely(ret <= 0)) {
+  if (unlikely(ret <= 0 && !elbo_plateau)) {
     std::string prefix_err_msg
         = "Optimization terminated with error: " + lbfgs.get_code_string(ret);
     if (lbfgs.iter_num() < 2) {
@@ -872,7 +1288,34 @@ inline auto pathfinder_lbfgs_single(
   auto&& elbo_lp_ratio = elbo_best.lp_ratio;
   auto&& elbo_lp_mat = elbo_best.lp_mat;
   const int remaining_draws = num_draws - elbo_lp_ratio.rows();
-  const Eigen::Index num_unconstrained_params = names.size() - 2;
+  const stan::rng_t final_rng = rng;
+  std::uint64_t elbo_stream_seed = 0;
+  std::uint64_t final_stream_seed = 0;
+  Eigen::Index num_final_draws = 0;
+  const bool constrain_path_draws
+      = draw_generator == nullptr || draw_generator->constrain_path_draws;
+  // Without constraining, only the log densities of the draws are kept
+  Eigen::Array<double, Eigen::Dynamic, 2> path_lp_mat;
+  auto allocate_draws = [&](Eigen::Index total_size) {
+    if (constrain_path_draws) {
+      constrained_draws_mat
+          = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(names.size(),
+                                                                  total_size);
+    } else {
+      path_lp_mat.resize(total_size, 2);
+    }
+  };
+  auto constrain_block = [&](std::uint64_t stream_seed, const auto& lp_mat,
+                             const auto& unconstrained_draws,
+                             Eigen::Index block_size, Eigen::Index offset) {
+    if (constrain_path_draws) {
+      internal::constrain_draws(constrain_fun, stream_seed, lp_mat,
+                                unconstrained_draws, block_size,
+                                constrained_draws_mat, offset);
+    } else {
+      path_lp_mat.middleRows(offset, block_size) = lp_mat.topRows(block_size);
+    }
+  };
   if (likely(remaining_draws > 0)) {
     try {
       internal::elbo_est_t est_draws = internal::est_approx_draws<false>(
@@ -886,29 +1329,14 @@ inline auto pathfinder_lbfgs_single(
                                                          + new_lp_ratio.size());
       lp_ratio.head(elbo_lp_ratio.size()) = elbo_lp_ratio.array();
       lp_ratio.tail(new_lp_ratio.size()) = new_lp_ratio.array();
-      const auto total_size = elbo_draws.cols() + new_draws.cols();
-      constrained_draws_mat
-          = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(names.size(),
-                                                                  total_size);
-      Eigen::VectorXd unconstrained_col;
-      Eigen::VectorXd approx_samples_constrained_col;
-      for (Eigen::Index i = 0; i < elbo_draws.cols(); ++i) {
-        constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
-        unconstrained_col = elbo_draws.col(i);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
-      }
-      for (Eigen::Index i = elbo_draws.cols(), j = 0; i < total_size;
-           ++i, ++j) {
-        constrained_draws_mat.col(i).head(2) = lp_draws.row(j).matrix();
-        unconstrained_col = new_draws.col(j);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
-      }
+      allocate_draws(elbo_draws.cols() + new_draws.cols());
+      elbo_stream_seed = rng();
+      constrain_block(elbo_stream_seed, elbo_lp_mat, elbo_draws,
+                      elbo_draws.cols(), 0);
+      final_stream_seed = rng();
+      constrain_block(final_stream_seed, lp_draws, new_draws, new_draws.cols(),
+                      elbo_draws.cols());
+      num_final_draws = new_draws.cols();
     } catch (const std::domain_error& e) {
       std::string err_msg = e.what();
       logger.warn(path_num + "Final sampling approximation failed with error: "
@@ -917,40 +1345,40 @@ inline auto pathfinder_lbfgs_single(
           path_num
           + "Returning the approximate samples used for ELBO calculation: "
           + err_msg);
-      constrained_draws_mat
-          = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(
-              names.size(), elbo_draws.cols());
-      Eigen::VectorXd approx_samples_constrained_col;
-      Eigen::VectorXd unconstrained_col;
-      for (Eigen::Index i = 0; i < elbo_draws.cols(); ++i) {
-        constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
-        unconstrained_col = elbo_draws.col(i);
-        constrained_draws_mat.col(i).tail(num_unconstrained_params)
-            = constrain_fun(rng, unconstrained_col,
-                            approx_samples_constrained_col)
-                  .matrix();
-      }
+      allocate_draws(elbo_draws.cols());
+      elbo_stream_seed = rng();
+      constrain_block(elbo_stream_seed, elbo_lp_mat, elbo_draws,
+                      elbo_draws.cols(), 0);
+      num_final_draws = 0;
       lp_ratio = std::move(elbo_best.lp_ratio);
     }
   } else {
     // output only first num_draws from what we computed for ELBO
-    constrained_draws_mat
-        = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>(names.size(),
-                                                                num_draws);
-    Eigen::VectorXd approx_samples_constrained_col;
-    Eigen::VectorXd unconstrained_col;
-    for (Eigen::Index i = 0; i < num_draws; ++i) {
-      constrained_draws_mat.col(i).head(2) = elbo_lp_mat.row(i).matrix();
-      unconstrained_col = elbo_draws.col(i);
-      constrained_draws_mat.col(i).tail(num_unconstrained_params)
-          = constrain_fun(rng, unconstrained_col,
-                          approx_samples_constrained_col)
-                .matrix();
-    }
+    allocate_draws(num_draws);
+    elbo_stream_seed = rng();
+    constrain_block(elbo_stream_seed, elbo_lp_mat, elbo_draws, num_draws, 0);
     lp_ratio = std::move(elbo_best.lp_ratio.head(num_draws));
   }
-  parameter_writer(constrained_draws_mat);
+  if (constrain_path_draws) {
+    parameter_writer(constrained_draws_mat);
+  }
   parameter_writer();
+  if (draw_generator != nullptr) {
+    draw_generator->taylor_approx = std::move(taylor_approx_best);
+    draw_generator->elbo_rng = elbo_rng_best;
+    draw_generator->final_rng = final_rng;
+    draw_generator->num_elbo_draws = elbo_draws.cols();
+    draw_generator->num_final_draws = num_final_draws;
+    draw_generator->elbo_stream_seed = elbo_stream_seed;
+    draw_generator->final_stream_seed = final_stream_seed;
+    if (constrain_path_draws) {
+      draw_generator->lp_mat
+          = constrained_draws_mat.topRows(2).transpose().array();
+    } else {
+      draw_generator->lp_mat = std::move(path_lp_mat);
+    }
+    constrained_draws_mat.resize(0, 0);
+  }
   const auto end_pathfinder_time = std::chrono::steady_clock::now();
   const double pathfinder_delta_time = stan::services::util::duration_diff(
       start_pathfinder_time, end_pathfinder_time);
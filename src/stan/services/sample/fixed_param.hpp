@@ -11,6 +11,7 @@
 #include <stan/services/util/generate_transitions.hpp>
 #include <stan/services/util/initialize.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/setup_chains.hpp>
 #include <chrono>
 #include <vector>
 
@@ -145,15 +146,21 @@ int fixed_param(Model& model, const std::size_t num_chains,
   std::vector<stan::mcmc::sample> samples;
   std::vector<stan::mcmc::fixed_param_sampler> samplers(num_chains);
   rngs.reserve(num_chains);
-  cont_vectors.reserve(num_chains);
   writers.reserve(num_chains);
   samples.reserve(num_chains);
-  for (int i = 0; i < num_chains; ++i) {
+  for (size_t i = 0; i < num_chains; ++i)
     rngs.push_back(util::create_rng(random_seed, chain + i));
-    auto cont_vector = util::initialize(model, *init[i], rngs[i], init_radius,
-                                        false, logger, init_writer[i]);
-    cont_vectors.push_back(
-        Eigen::Map<Eigen::VectorXd>(cont_vector.data(), cont_vector.size()));
+  cont_vectors.resize(num_chains);
+  if (!util::setup_chains(num_chains, chain, logger,
+                          [&](size_t i, callbacks::logger& chain_logger) {
+                            auto cont_vector = util::initialize(
+                                model, *init[i], rngs[i], init_radius, false,
+                                chain_logger, init_writer[i]);
+                            cont_vectors[i] = Eigen::Map<Eigen::VectorXd>(
+                                cont_vector.data(), cont_vector.size());
+                          }))
+    return error_codes::CONFIG;
+  for (size_t i = 0; i < num_chains; ++i) {
     samples.emplace_back(cont_vectors[i], 0, 0);
     writers.emplace_back(sample_writers[i], diagnostic_writers[i], logger);
     // Headers
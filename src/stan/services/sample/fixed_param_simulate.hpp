@@ -0,0 +1,249 @@
+#ifndef STAN_SERVICES_SAMPLE_FIXED_PARAM_SIMULATE_HPP
+#define STAN_SERVICES_SAMPLE_FIXED_PARAM_SIMULATE_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/output_schema.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Simulates draws of the transformed parameters and generated
+ * quantities of a model at fixed unconstrained parameters, as the fixed
+ * parameter sampler does, without the sampler.
+ *
+ * Draws are generated in waves of a few blocks of at most
+ * <code>block_size</code> consecutive draws per thread, and the blocks of
+ * a wave are spread over the TBB threads.  The random number generator of
+ * each draw is made from the seed, the chain and the index of the draw,
+ * so the output is the same for any number of threads or block size, but
+ * differs from that of <code>fixed_param</code>.  A wave is written from
+ * the calling thread once it is generated, one draw at a time and in
+ * order, so the interrupt, the logger and the writer are only called from
+ * the calling thread.
+ *
+ * The columns are those of <code>fixed_param</code>: <code>lp__</code>
+ * and <code>accept_stat__</code>, both zero, then every value of the
+ * model.  The header is sent as a schema to a writer that accepts one.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] cont_params unconstrained parameters at which to simulate
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id of the random number generator streams
+ * @param[in] num_samples Number of draws
+ * @param[in] block_size number of draws generated together by a thread,
+ * which must be positive
+ * @param[in] refresh Controls the output
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] sample_writer Writer for draws
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int fixed_param_simulate(const Model& model,
+                         const Eigen::VectorXd& cont_params,
+                         unsigned int random_seed, unsigned int chain,
+                         int num_samples, size_t block_size, int refresh,
+                         callbacks::interrupt& interrupt,
+                         callbacks::logger& logger,
+                         callbacks::writer& sample_writer) {
+  if (block_size == 0) {
+    logger.error("Block size of draws must be positive.");
+    return error_codes::CONFIG;
+  }
+
+  std::vector<std::string> names{"lp__", "accept_stat__"};
+  const size_t num_sampler_params = names.size();
+  size_t num_cols = 0;
+  if (sample_writer.accepts_schema()) {
+    callbacks::output_schema schema;
+    for (const std::string& name : names)
+      schema.add(name);
+    schema.add_model(model, true, true);
+    num_cols = schema.num_columns();
+    sample_writer(schema);
+  } else {
+    model.constrained_param_names(names, true, true);
+    num_cols = names.size();
+    sample_writer(names);
+  }
+  const size_t num_model_params = num_cols - num_sampler_params;
+
+  // what became of a draw, in the order it is logged
+  enum class outcome { OK, WRITE_ERROR, FAILED };
+  const size_t num_draws = num_samples > 0 ? num_samples : 0;
+  const size_t wave_size = std::min(
+      num_draws, block_size * 4
+                     * static_cast<size_t>(std::max(
+                         1, tbb::this_task_arena::max_concurrency())));
+  std::vector<std::vector<double>> draw_values(wave_size);
+  std::vector<std::string> model_msgs(wave_size);
+  std::vector<std::string> errors(wave_size);
+  std::vector<outcome> outcomes(wave_size);
+  const int it_print_width
+      = std::ceil(std::log10(static_cast<double>(num_samples)));
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t wave_begin = 0; wave_begin < num_draws;) {
+    const size_t wave_rows = std::min(wave_size, num_draws - wave_begin);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, wave_rows, block_size),
+        [&](const tbb::blocked_range<size_t>& r) {
+          Eigen::VectorXd params_r(cont_params);
+          Eigen::VectorXd values;
+          std::stringstream msg;
+          for (size_t slot = r.begin(); slot != r.end(); ++slot) {
+            msg.str("");
+            msg.clear();
+            outcomes[slot] = outcome::OK;
+            values.setConstant(std::numeric_limits<double>::quiet_NaN());
+            try {
+              stan::rng_t rng = util::create_rng(
+                  random_seed, chain,
+                  static_cast<std::uint32_t>(wave_begin + slot), 0);
+              model.write_array(rng, params_r, values, true, true, &msg);
+            } catch (const std::domain_error& e) {
+              errors[slot] = e.what();
+              outcomes[slot] = outcome::WRITE_ERROR;
+            } catch (const std::exception& e) {
+              errors[slot] = e.what();
+              outcomes[slot] = outcome::FAILED;
+            }
+            model_msgs[slot] = msg.str();
+            std::vector<double>& draw = draw_values[slot];
+            draw.assign(num_cols, std::numeric_limits<double>::quiet_NaN());
+            draw[0] = 0;
+            draw[1] = 0;
+            const size_t num_written
+                = std::min<size_t>(num_model_params, values.size());
+            std::copy(values.data(), values.data() + num_written,
+                      draw.begin() + num_sampler_params);
+          }
+        });
+
+    for (size_t slot = 0; slot < wave_rows; ++slot) {
+      const size_t m = wave_begin + slot;
+      try {
+        interrupt();
+      } catch (const std::exception& e) {
+        logger.error(e.what());
+        return error_codes::SOFTWARE;
+      }
+      if (refresh > 0
+          && (m + 1 == num_draws || m == 0 || (m + 1) % refresh == 0)) {
+        std::stringstream message;
+        message << "Iteration: ";
+        message << std::setw(it_print_width) << m + 1 << " / " << num_draws;
+        message << " [" << std::setw(3)
+                << static_cast<int>((100.0 * (m + 1)) / num_draws) << "%] ";
+        message << " (Sampling)";
+        logger.info(message);
+      }
+      if (model_msgs[slot].length() > 0)
+        logger.info(model_msgs[slot]);
+      if (outcomes[slot] == outcome::FAILED) {
+        logger.info(errors[slot]);
+        logger.error(errors[slot]);
+        return error_codes::SOFTWARE;
+      }
+      if (outcomes[slot] == outcome::WRITE_ERROR)
+        logger.info(errors[slot]);
+      sample_writer(draw_values[slot]);
+    }
+    wave_begin += wave_rows;
+  }
+  auto end = std::chrono::steady_clock::now();
+  double sample_delta_t
+      = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+            .count()
+        / 1000.0;
+
+  // the timing goes to the sample writer and the logger
+  callbacks::writer no_diagnostics;
+  util::mcmc_writer writer(sample_writer, no_diagnostics, logger);
+  writer.write_timing(0.0, sample_delta_t);
+  return error_codes::OK;
+}
+
+/**
+ * Simulates draws of the transformed parameters and generated
+ * quantities of a model, as the fixed parameter sampler does, without
+ * the sampler.  The parameters are set once, randomly on the
+ * unconstrained scale where they are not initialized, then the draws are
+ * generated in parallel blocks as by the overload taking the
+ * unconstrained parameters.  With no parameters, the draws are from the
+ * prior predictive distribution; with parameters initialized from a
+ * draw of a fit, from the predictive distribution at that draw.
+ *
+ * A caller holding the draws in memory may pass a
+ * <code>callbacks::matrix_writer</code> of <code>num_samples</code> rows,
+ * and one streaming them to disk a <code>callbacks::binary_writer</code>.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_samples Number of draws
+ * @param[in] block_size number of draws generated together by a thread,
+ * which must be positive
+ * @param[in] refresh Controls the output
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int fixed_param_simulate(Model& model, const stan::io::var_context& init,
+                         unsigned int random_seed, unsigned int chain,
+                         double init_radius, int num_samples,
+                         size_t block_size, int refresh,
+                         callbacks::interrupt& interrupt,
+                         callbacks::logger& logger,
+                         callbacks::writer& init_writer,
+                         callbacks::writer& sample_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, false, logger,
+                                   init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  Eigen::VectorXd cont_params
+      = Eigen::Map<Eigen::VectorXd>(cont_vector.data(), cont_vector.size());
+  return fixed_param_simulate(model, cont_params, random_seed, chain,
+                              num_samples, block_size, refresh, interrupt,
+                              logger, sample_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,397 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_AUTO_E_ADAPT_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_AUTO_E_ADAPT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_lowrank_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/select_metric.hpp>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+namespace internal {
+
+/**
+ * Number of warmup draws from the slow adaptation windows after which
+ * <code>hmc_nuts_auto_e_adapt</code> chooses its metric.
+ */
+constexpr size_t auto_e_min_draws = 100;
+
+template <class Sampler>
+void set_auto_e_tuning(Sampler& sampler, double stepsize,
+                       double stepsize_jitter, int max_depth, double delta,
+                       double gamma, double kappa, double t0) {
+  sampler.set_nominal_stepsize(stepsize);
+  sampler.set_stepsize_jitter(stepsize_jitter);
+  sampler.set_max_depth(max_depth);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+}
+
+/**
+ * Run the warmup iterations after the first <code>start</code> and then
+ * the draws with the specified sampler, as
+ * <code>util::run_adaptive_sampler</code> does after its headers.
+ */
+template <class Sampler, class Model, class RNG>
+void finish_auto_e_adapt(Sampler& sampler, Model& model,
+                         util::mcmc_writer& writer, stan::mcmc::sample& s,
+                         int start, int num_warmup, int num_samples,
+                         int num_thin, int refresh, bool save_warmup,
+                         RNG& rng, callbacks::interrupt& interrupt,
+                         callbacks::logger& logger,
+                         callbacks::writer& sample_writer,
+                         callbacks::structured_writer& metric_writer,
+                         std::chrono::steady_clock::time_point start_warm) {
+  util::generate_transitions(sampler, num_warmup - start, start,
+                             num_warmup + num_samples, num_thin, refresh,
+                             save_warmup, true, writer, s, model, rng,
+                             interrupt, logger, 1, 1, start);
+  writer.wait_for_draws();
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+  sampler.disengage_adaptation();
+  writer.write_adapt_finish(sampler);
+  sampler.write_sampler_state(sample_writer);
+  sampler.write_sampler_state_struct(metric_writer);
+  writer.flush();
+
+  auto start_sample = std::chrono::steady_clock::now();
+  util::generate_transitions(sampler, num_samples, num_warmup,
+                             num_warmup + num_samples, num_thin, refresh, true,
+                             false, writer, s, model, rng, interrupt, logger);
+  writer.wait_for_draws();
+  auto end_sample = std::chrono::steady_clock::now();
+  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              end_sample - start_sample)
+                              .count()
+                          / 1000.0;
+  writer.write_timing(warm_delta_t, sample_delta_t);
+  writer.flush();
+}
+
+/**
+ * Hand the chain over to the sampler of the chosen metric part way
+ * through warmup: it starts from the current draw with the step size
+ * adapted so far, adapts its metric over the windows left and its step
+ * size over the rest of warmup.
+ *
+ * @return false if the step size could not be initialized
+ */
+template <class Sampler, class Probe>
+bool hand_over_auto_e(Sampler& sampler, Probe& probe,
+                      const stan::mcmc::sample& s, int start, int num_warmup,
+                      unsigned int next_window, double stepsize_jitter,
+                      int max_depth, double delta, double gamma, double kappa,
+                      double t0, callbacks::logger& logger) {
+  set_auto_e_tuning(sampler, probe.get_nominal_stepsize(), stepsize_jitter,
+                    max_depth, delta, gamma, kappa, t0);
+  if (next_window > 0)
+    sampler.set_window_params(num_warmup - start, 0,
+                              probe.get_var_adaptation().term_buffer(),
+                              next_window, logger);
+  sampler.engage_adaptation();
+  try {
+    sampler.z().q = s.cont_params();
+    sampler.init_stepsize(logger);
+  } catch (const std::exception& e) {
+    logger.error("Exception initializing step size.");
+    logger.error(e.what());
+    return false;
+  }
+  sampler.get_stepsize_adaptation().set_mu(
+      log(10 * sampler.get_nominal_stepsize()));
+  sampler.get_stepsize_adaptation().restart();
+  return true;
+}
+
+}  // namespace internal
+
+/**
+ * Runs HMC with NUTS with adaptation, choosing during warmup between a
+ * diagonal, a low-rank and a dense Euclidean metric, and saves adapted
+ * tuning parameters.
+ *
+ * Warmup starts with a diagonal metric from the identity, adapted as by
+ * <code>hmc_nuts_diag_e_adapt</code>, and with the wall time of the
+ * gradients measured.  At the end of the first slow adaptation window
+ * that brings the draws of the slow windows to a hundred, or of the last
+ * one, <code>util::select_metric</code> predicts the cost of a draw with
+ * each metric from the correlations of these draws, the time of a
+ * gradient and that of a dense product, and the choice is logged.  If a
+ * low-rank or dense metric is chosen, a sampler with that metric, set
+ * from the draws, takes over from the current draw and step size, adapts
+ * its metric over the windows left and its step size over the rest of
+ * warmup.  The output is that of the adaptive sampler of the chosen
+ * metric, whose metric the adaptation info and <code>metric_writer</code>
+ * report.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] rank maximum rank of the low-rank metric, or zero not to
+ *   consider it
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_auto_e_adapt(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, int rank, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+  try {
+    if (rank < 0)
+      throw std::invalid_argument("Rank of the metric must be non-negative");
+    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
+                                   init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t> probe(model, rng);
+  internal::set_auto_e_tuning(probe, stepsize, stepsize_jitter, max_depth,
+                              delta, gamma, kappa, t0);
+  probe.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                          logger);
+
+  Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
+                                          cont_vector.size());
+  probe.engage_adaptation();
+  try {
+    probe.z().q = cont_params;
+    probe.init_stepsize(logger);
+  } catch (const std::exception& e) {
+    logger.error("Exception initializing step size.");
+    logger.error(e.what());
+    return error_codes::OK;
+  }
+
+  try {
+    util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
+    stan::mcmc::sample s(cont_params, 0, 0);
+    writer.write_sample_names(s, probe, model);
+    writer.write_diagnostic_names(s, probe, model);
+
+    const auto start_warm = std::chrono::steady_clock::now();
+    const int num_iterations = num_warmup + num_samples;
+    stan::mcmc::var_adaptation& adaptation = probe.get_var_adaptation();
+    std::vector<Eigen::VectorXd> draws;
+    unsigned int last_window = 0;
+    int start = 0;
+    bool stopped = false;
+
+    probe.set_gradient_timing(true);
+    const stan::model::gradient_stats gradients_start
+        = probe.get_gradient_stats();
+    while (!stopped && draws.size() < internal::auto_e_min_draws) {
+      const unsigned int n = adaptation.iterations_to_window_end();
+      if (n == 0)
+        break;
+      last_window = 0;
+      for (unsigned int i = 0; i < n; ++i) {
+        const bool in_window = adaptation.adaptation_window();
+        if (util::generate_transitions(probe, 1, start, num_iterations,
+                                       num_thin, refresh, save_warmup, true,
+                                       writer, s, model, rng, interrupt,
+                                       logger, 1, 1, start, nullptr, false)
+            == 0) {
+          stopped = true;
+          break;
+        }
+        ++start;
+        if (in_window) {
+          draws.push_back(s.cont_params());
+          ++last_window;
+        }
+      }
+    }
+    const stan::model::gradient_stats gradients_end
+        = probe.get_gradient_stats();
+    probe.set_gradient_timing(false);
+    probe.write_rejection_summary(logger);
+
+    std::string metric = "diag_e";
+    util::metric_selection selection;
+    if (!stopped && draws.size() >= 2) {
+      const double gradient_time
+          = (gradients_end.gradient_time - gradients_start.gradient_time)
+            / std::max<size_t>(1, gradients_end.num_gradients
+                                      - gradients_start.num_gradients);
+      selection = util::select_metric(
+          draws, gradient_time, util::time_dense_product(model.num_params_r()),
+          rank);
+      metric = selection.metric;
+
+      std::stringstream msg;
+      msg << "Metric selection after " << draws.size()
+          << " warmup draws:" << std::endl
+          << "  diag_e: condition number " << selection.condition_diag
+          << ", predicted time per draw " << selection.cost_diag << " s"
+          << std::endl;
+      if (rank > 0)
+        msg << "  lowrank_e: condition number "
+            << selection.condition_lowrank << ", predicted time per draw "
+            << selection.cost_lowrank << " s" << std::endl;
+      msg << "  dense_e: condition number " << selection.condition_dense
+          << ", predicted time per draw " << selection.cost_dense << " s"
+          << std::endl
+          << "Using the " << metric << " metric.";
+      logger.info(msg);
+    }
+
+    // the windows left start with twice the last one, as they would have
+    const unsigned int next_window
+        = adaptation.iterations_to_window_end() == 0 ? 0 : 2 * last_window;
+    if (metric == "dense_e") {
+      stan::mcmc::adapt_dense_e_nuts<Model, stan::rng_t> sampler(model, rng);
+      sampler.set_metric(selection.covariance);
+      if (!internal::hand_over_auto_e(sampler, probe, s, start, num_warmup,
+                                      next_window, stepsize_jitter, max_depth,
+                                      delta, gamma, kappa, t0, logger))
+        return error_codes::OK;
+      internal::finish_auto_e_adapt(sampler, model, writer, s, start,
+                                    num_warmup, num_samples, num_thin,
+                                    refresh, save_warmup, rng, interrupt,
+                                    logger, sample_writer, metric_writer,
+                                    start_warm);
+    } else if (metric == "lowrank_e") {
+      stan::mcmc::adapt_lowrank_e_nuts<Model, stan::rng_t> sampler(
+          model, rank, rng);
+      sampler.set_metric(selection.lowrank_diag, selection.lowrank_factor);
+      if (!internal::hand_over_auto_e(sampler, probe, s, start, num_warmup,
+                                      next_window, stepsize_jitter, max_depth,
+                                      delta, gamma, kappa, t0, logger))
+        return error_codes::OK;
+      internal::finish_auto_e_adapt(sampler, model, writer, s, start,
+                                    num_warmup, num_samples, num_thin,
+                                    refresh, save_warmup, rng, interrupt,
+                                    logger, sample_writer, metric_writer,
+                                    start_warm);
+    } else {
+      internal::finish_auto_e_adapt(probe, model, writer, s, start,
+                                    num_warmup, num_samples, num_thin,
+                                    refresh, save_warmup, rng, interrupt,
+                                    logger, sample_writer, metric_writer,
+                                    start_warm);
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Runs HMC with NUTS with adaptation, choosing during warmup between a
+ * diagonal, a low-rank and a dense Euclidean metric.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] rank maximum rank of the low-rank metric, or zero not to
+ *   consider it
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_auto_e_adapt(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, int rank, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer) {
+  callbacks::structured_writer dummy_metric_writer;
+  return hmc_nuts_auto_e_adapt(
+      model, init, random_seed, chain, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, rank,
+      interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      dummy_metric_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
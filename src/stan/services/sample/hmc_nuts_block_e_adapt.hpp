@@ -0,0 +1,229 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_BLOCK_E_ADAPT_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_BLOCK_E_ADAPT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_block_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/parameter_blocks.hpp>
+#include <stan/services/util/run_adaptive_sampler.hpp>
+#include <memory>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs HMC with NUTS with adaptation using a block diagonal dense
+ * Euclidean metric, with the identity matrix as initial inverse metric,
+ * and saves adapted tuning parameters.
+ *
+ * Each block of the metric adapts the covariance of a run of
+ * consecutive unconstrained parameters, as the dense metric adapts that
+ * of all of them, and the parameters of different
+ * blocks are taken to be uncorrelated, so the metric costs
+ * O(<code>sum b_i^2</code>) memory and time per gradient for blocks of
+ * sizes <code>b_i</code>.  With a single block it adapts as
+ * <code>hmc_nuts_dense_e_adapt</code> does, and with blocks of one
+ * parameter as <code>hmc_nuts_diag_e_adapt</code> does.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] block_sizes number of unconstrained parameters of each block
+ * of the metric, in order, which must be positive and add up to the
+ * number of unconstrained parameters
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_block_e_adapt(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, const std::vector<int>& block_sizes,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+  using sampler_t = stan::mcmc::adapt_block_e_nuts<Model, stan::rng_t>;
+  std::unique_ptr<sampler_t> sampler;
+  try {
+    sampler = std::make_unique<sampler_t>(model, block_sizes, rng);
+    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
+                                   init_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  sampler->set_nominal_stepsize(stepsize);
+  sampler->set_stepsize_jitter(stepsize_jitter);
+  sampler->set_max_depth(max_depth);
+
+  sampler->get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler->get_stepsize_adaptation().set_delta(delta);
+  sampler->get_stepsize_adaptation().set_gamma(gamma);
+  sampler->get_stepsize_adaptation().set_kappa(kappa);
+  sampler->get_stepsize_adaptation().set_t0(t0);
+
+  sampler->set_window_params(num_warmup, init_buffer, term_buffer, window,
+                             logger);
+
+  try {
+    util::run_adaptive_sampler(*sampler, model, cont_vector, num_warmup,
+                               num_samples, num_thin, refresh, save_warmup, rng,
+                               interrupt, logger, sample_writer,
+                               diagnostic_writer, metric_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Runs HMC with NUTS with adaptation using a block diagonal dense
+ * Euclidean metric with one block per parameter of the model, as found
+ * by <code>util::parameter_blocks</code>, with the identity matrix as
+ * initial inverse metric, and saves adapted tuning parameters.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_block_e_adapt(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  return hmc_nuts_block_e_adapt(
+      model, init, random_seed, chain, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      util::parameter_blocks(model), interrupt, logger, init_writer,
+      sample_writer, diagnostic_writer, metric_writer);
+}
+
+/**
+ * Runs HMC with NUTS with adaptation using a block diagonal dense
+ * Euclidean metric with one block per parameter of the model, with the
+ * identity matrix as initial inverse metric.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_block_e_adapt(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer) {
+  callbacks::structured_writer dummy_metric_writer;
+  return hmc_nuts_block_e_adapt(
+      model, init, random_seed, chain, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, interrupt,
+      logger, init_writer, sample_writer, diagnostic_writer,
+      dummy_metric_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
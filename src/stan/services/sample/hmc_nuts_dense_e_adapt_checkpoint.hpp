@@ -0,0 +1,221 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DENSE_E_ADAPT_CHECKPOINT_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DENSE_E_ADAPT_CHECKPOINT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/inv_metric.hpp>
+#include <stan/services/util/resumable_chain.hpp>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs HMC with NUTS with adaptation using dense Euclidean metric
+ * with a pre-specified dense metric and saves adapted tuning parameters,
+ * as <code>hmc_nuts_dense_e_adapt</code> does, writing a checkpoint of
+ * the chain every <code>checkpoint_interval</code> iterations from which
+ * <code>hmc_nuts_dense_e_adapt_resume</code> resumes it.
+ *
+ * Reals in the checkpoints are written with the precision of the
+ * checkpoint writer, which must be at least <code>max_digits10</code>
+ * for a resumed run to continue exactly as the original one.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] init_inv_metric var context exposing an initial dense
+ *            inverse Euclidean metric (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @param[in,out] checkpoint_writer Writer for checkpoints, one record each
+ * @param[in] checkpoint_interval Number of iterations between checkpoints
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_dense_e_adapt_checkpointed(
+    Model& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& checkpoint_writer, int checkpoint_interval) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+
+  Eigen::MatrixXd inv_metric;
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
+                                   init_writer);
+    inv_metric = util::read_dense_inv_metric(init_inv_metric,
+                                             model.num_params_r(), logger);
+    util::validate_dense_inv_metric(inv_metric, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  stan::mcmc::adapt_dense_e_nuts<Model, stan::rng_t> sampler(model, rng);
+
+  sampler.set_metric(inv_metric);
+
+  sampler.set_nominal_stepsize(stepsize);
+  sampler.set_stepsize_jitter(stepsize_jitter);
+  sampler.set_max_depth(max_depth);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+
+  sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                            logger);
+  try {
+    util::run_checkpointed_adaptive_sampler(
+        sampler, model, cont_vector, num_warmup, num_samples, num_thin,
+        refresh, save_warmup, rng, interrupt, logger, sample_writer,
+        diagnostic_writer, metric_writer, checkpoint_writer,
+        checkpoint_interval, nullptr, chain);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  return error_codes::OK;
+}
+
+/**
+ * Resumes a run of <code>hmc_nuts_dense_e_adapt_checkpointed</code> from
+ * one of its checkpoints, carrying on writing checkpoints as it did.
+ *
+ * The configuration must be that of the original run.  The resumed run
+ * writes neither the initial values nor the headers, and its output
+ * continues from the iteration of the checkpoint: appended to the output
+ * the original run wrote up to that checkpoint, it gives the output of
+ * an uninterrupted run, with the timing being the total of both runs.
+ * Output the original run wrote after the checkpoint must be discarded.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] checkpoint var context of the checkpoint to resume from
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @param[in,out] checkpoint_writer Writer for checkpoints, one record each
+ * @param[in] checkpoint_interval Number of iterations between checkpoints
+ * @return error_codes::OK if successful, error_codes::CONFIG if the
+ * checkpoint is invalid
+ */
+template <class Model>
+int hmc_nuts_dense_e_adapt_resume(
+    Model& model, const stan::io::var_context& checkpoint,
+    unsigned int random_seed, unsigned int chain, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double stepsize_jitter, int max_depth, double delta,
+    double gamma, double kappa, double t0, unsigned int init_buffer,
+    unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& checkpoint_writer, int checkpoint_interval) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  // the state of the chain comes from the checkpoint
+  std::vector<double> cont_vector(model.num_params_r(), 0);
+
+  stan::mcmc::adapt_dense_e_nuts<Model, stan::rng_t> sampler(model, rng);
+
+  sampler.set_nominal_stepsize(stepsize);
+  sampler.set_stepsize_jitter(stepsize_jitter);
+  sampler.set_max_depth(max_depth);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+
+  sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                            logger);
+  util::resumable_chain<true, decltype(sampler), Model, stan::rng_t> resumed(
+      sampler, model, cont_vector, num_warmup, num_samples, num_thin, refresh,
+      save_warmup, rng, interrupt, logger, sample_writer, diagnostic_writer,
+      metric_writer, chain);
+  try {
+    resumed.resume(checkpoint);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  try {
+    util::run_checkpointed_chain(resumed, checkpoint_writer,
+                                 checkpoint_interval);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  return error_codes::OK;
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,219 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DENSE_E_WARM_START_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DENSE_E_WARM_START_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/read_warm_start.hpp>
+#include <stan/services/util/run_adaptive_sampler.hpp>
+#include <stan/services/util/validate_dense_inv_metric.hpp>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs HMC with NUTS with a dense Euclidean metric warm started from the
+ * specified initial values, step size and inverse metric, used as a dense
+ * metric if it is diagonal, such as those read from a previous fit by
+ * <code>util::read_warm_start</code> or derived from a mode and its
+ * Hessian by <code>util::warm_start_from_mode</code>.
+ *
+ * Warmup is the terminal fast window of the usual schedule only: the step
+ * size is adapted over the <code>num_warmup</code> warmup iterations and
+ * the metric is kept.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] start initial values, step size and inverse metric
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] num_warmup Number of warmup samples adapting the step size
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_dense_e_warm_start(
+    Model& model, const util::warm_start& start, unsigned int random_seed,
+    unsigned int chain, int num_warmup, int num_samples, int num_thin,
+    bool save_warmup, int refresh, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  Eigen::MatrixXd inv_metric;
+  try {
+    if (start.inv_metric.rows() == 1)
+      inv_metric = start.inv_metric.row(0).transpose().asDiagonal();
+    else
+      inv_metric = start.inv_metric;
+    util::validate_dense_inv_metric(inv_metric, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  std::vector<double> cont_vector = start.cont_vector;
+  init_writer(cont_vector);
+
+  stan::mcmc::adapt_dense_e_nuts<Model, stan::rng_t> sampler(model, rng);
+
+  sampler.set_metric(inv_metric);
+  sampler.set_nominal_stepsize(start.stepsize);
+  sampler.set_stepsize_jitter(stepsize_jitter);
+  sampler.set_max_depth(max_depth);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * start.stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+
+  // Only the terminal window: the metric is not estimated again
+  if (num_warmup >= 20)
+    sampler.set_window_params(num_warmup, 0, num_warmup, 0, logger);
+
+  try {
+    util::run_adaptive_sampler(sampler, model, cont_vector, num_warmup,
+                               num_samples, num_thin, refresh, save_warmup, rng,
+                               interrupt, logger, sample_writer,
+                               diagnostic_writer, metric_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Runs HMC with NUTS with a dense Euclidean metric warm started from a
+ * previous adaptive fit of the same model, for instance on updated data.
+ * The chain starts from the last draw of the fit with its adapted step
+ * size and inverse metric, used as a dense metric if it was diagonal.
+ *
+ * Warmup is the terminal fast window of the usual schedule only: the step
+ * size is adapted over the <code>num_warmup</code> warmup iterations and
+ * the metric is kept, so a short warmup, such as the default terminal
+ * buffer of 50 iterations, is enough when the posterior has not moved
+ * much.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] previous output of the previous fit
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] num_warmup Number of warmup samples adapting the step size
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_dense_e_warm_start(
+    Model& model, const stan::io::stan_csv& previous, unsigned int random_seed,
+    unsigned int chain, int num_warmup, int num_samples, int num_thin,
+    bool save_warmup, int refresh, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  util::warm_start start;
+  try {
+    start = util::read_warm_start(model, previous);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return hmc_nuts_dense_e_warm_start(
+      model, start, random_seed, chain, num_warmup, num_samples, num_thin,
+      save_warmup, refresh, stepsize_jitter, max_depth, delta, gamma, kappa,
+      t0, interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      metric_writer);
+}
+
+/**
+ * Runs HMC with NUTS with a dense Euclidean metric warm started from a
+ * previous adaptive fit of the same model.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] previous output of the previous fit
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] num_warmup Number of warmup samples adapting the step size
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_dense_e_warm_start(
+    Model& model, const stan::io::stan_csv& previous, unsigned int random_seed,
+    unsigned int chain, int num_warmup, int num_samples, int num_thin,
+    bool save_warmup, int refresh, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer) {
+  callbacks::structured_writer dummy_metric_writer;
+  return hmc_nuts_dense_e_warm_start(
+      model, previous, random_seed, chain, num_warmup, num_samples, num_thin,
+      save_warmup, refresh, stepsize_jitter, max_depth, delta, gamma, kappa,
+      t0, interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      dummy_metric_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
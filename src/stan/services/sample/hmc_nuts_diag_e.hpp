@@ -8,6 +8,9 @@
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
 #include <stan/services/error_codes.hpp>
+#include <stan/services/util/resumable_chain.hpp>
+#include <stan/services/util/setup_chains.hpp>
+#include <stan/services/util/shared_contexts.hpp>
 #include <stan/services/util/run_sampler.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/initialize.hpp>
@@ -174,6 +177,8 @@ int hmc_nuts_diag_e(Model& model, const stan::io::var_context& init,
  * @param[in,out] sample_writer std vector of Writers for draws of each chain.
  * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
  * information of each chain.
+ * @param[in,out] scheduler scheduler interleaving the chains and reporting
+ * their progress, or <code>nullptr</code> to use a default one
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContextPtr, typename InitInvContextPtr,
@@ -188,7 +193,8 @@ int hmc_nuts_diag_e(Model& model, size_t num_chains,
                     callbacks::interrupt& interrupt, callbacks::logger& logger,
                     std::vector<InitWriter>& init_writer,
                     std::vector<SampleWriter>& sample_writer,
-                    std::vector<DiagnosticWriter>& diagnostic_writer) {
+                    std::vector<DiagnosticWriter>& diagnostic_writer,
+                    util::chain_scheduler* scheduler = nullptr) {
   if (num_chains == 1) {
     return hmc_nuts_diag_e(
         model, *init[0], *init_inv_metric[0], random_seed, init_chain_id,
@@ -198,22 +204,33 @@ int hmc_nuts_diag_e(Model& model, size_t num_chains,
   }
   std::vector<stan::rng_t> rngs;
   rngs.reserve(num_chains);
-  std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i)
+    rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
+  std::vector<std::vector<double>> cont_vectors(num_chains);
+  std::vector<Eigen::VectorXd> inv_metrics(num_chains);
+  if (!util::setup_chains(
+          num_chains, init_chain_id, logger,
+          [&](size_t i, callbacks::logger& chain_logger) {
+            cont_vectors[i] = util::initialize(model, *init[i], rngs[i],
+                                               init_radius, true, chain_logger,
+                                               init_writer[i]);
+            if (!util::shares_previous_context(init_inv_metric, i)) {
+              inv_metrics[i] = util::read_diag_inv_metric(
+                  *init_inv_metric[i], model.num_params_r(), chain_logger);
+              util::validate_diag_inv_metric(inv_metrics[i], chain_logger);
+            }
+          }))
+    return error_codes::CONFIG;
   using sample_t = stan::mcmc::diag_e_nuts<Model, stan::rng_t>;
   std::vector<sample_t> samplers;
   samplers.reserve(num_chains);
   try {
-    for (int i = 0; i < num_chains; ++i) {
-      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
-      Eigen::VectorXd inv_metric = util::read_diag_inv_metric(
-          *init_inv_metric[i], model.num_params_r(), logger);
-      util::validate_diag_inv_metric(inv_metric, logger);
-
+    size_t metric_chain = 0;
+    for (size_t i = 0; i < num_chains; ++i) {
+      if (!util::shares_previous_context(init_inv_metric, i))
+        metric_chain = i;
       samplers.emplace_back(model, rngs[i]);
-      samplers[i].set_metric(inv_metric);
+      samplers[i].set_metric(inv_metrics[metric_chain]);
       samplers[i].set_nominal_stepsize(stepsize);
       samplers[i].set_stepsize_jitter(stepsize_jitter);
       samplers[i].set_max_depth(max_depth);
@@ -222,21 +239,12 @@ int hmc_nuts_diag_e(Model& model, size_t num_chains,
     logger.error(e.what());
     return error_codes::CONFIG;
   }
-  tbb::parallel_for(
-      tbb::blocked_range<size_t>(0, num_chains, 1),
-      [num_warmup, num_samples, num_thin, refresh, save_warmup, num_chains,
-       init_chain_id, &samplers, &model, &rngs, &interrupt, &logger,
-       &sample_writer, &cont_vectors,
-       &diagnostic_writer](const tbb::blocked_range<size_t>& r) {
-        for (size_t i = r.begin(); i != r.end(); ++i) {
-          util::run_sampler(samplers[i], model, cont_vectors[i], num_warmup,
-                            num_samples, num_thin, refresh, save_warmup,
-                            rngs[i], interrupt, logger, sample_writer[i],
-                            diagnostic_writer[i], init_chain_id + i,
-                            num_chains);
-        }
-      },
-      tbb::simple_partitioner());
+  util::chain_scheduler default_scheduler;
+  util::run_scheduled_sampler(
+      scheduler == nullptr ? default_scheduler : *scheduler, samplers,
+      model, cont_vectors, num_warmup, num_samples, num_thin, refresh,
+      save_warmup, rngs, interrupt, logger, sample_writer,
+      diagnostic_writer, init_chain_id);
   return error_codes::OK;
 }
 
@@ -296,12 +304,10 @@ int hmc_nuts_diag_e(Model& model, size_t num_chains,
                            max_depth, interrupt, logger, init_writer[0],
                            sample_writer[0], diagnostic_writer[0]);
   }
-  std::vector<std::unique_ptr<stan::io::array_var_context>> unit_e_metrics;
-  unit_e_metrics.reserve(num_chains);
-  for (size_t i = 0; i < num_chains; ++i) {
-    unit_e_metrics.emplace_back(std::make_unique<stan::io::array_var_context>(
-        util::create_unit_e_diag_inv_metric(model.num_params_r())));
-  }
+  stan::io::array_var_context unit_e_context
+      = util::create_unit_e_diag_inv_metric(model.num_params_r());
+  std::vector<const stan::io::array_var_context*> unit_e_metrics
+      = util::shared_contexts(unit_e_context, num_chains);
   return hmc_nuts_diag_e(model, num_chains, init, unit_e_metrics, random_seed,
                          init_chain_id, init_radius, num_warmup, num_samples,
                          num_thin, save_warmup, refresh, stepsize,
@@ -309,6 +315,38 @@ int hmc_nuts_diag_e(Model& model, size_t num_chains,
                          init_writer, sample_writer, diagnostic_writer);
 }
 
+/**
+ * Runs multiple chains of NUTS without adaptation using diag Euclidean metric,
+ * with one inverse metric context shared by all chains, so that the metric is
+ * parsed and read once.  The remaining parameters are those of the overload
+ * taking a std vector of inverse metric contexts.
+ *
+ * @param[in] init_inv_metric var context exposing an initial diag inverse
+ * Euclidean metric for all chains (must be positive definite)
+ */
+template <class Model, typename InitContextPtr, typename InitWriter,
+          typename SampleWriter, typename DiagnosticWriter>
+int hmc_nuts_diag_e(Model& model, size_t num_chains,
+                    const std::vector<InitContextPtr>& init,
+                    const stan::io::var_context& init_inv_metric,
+                    unsigned int random_seed, unsigned int init_chain_id,
+                    double init_radius, int num_warmup, int num_samples,
+                    int num_thin, bool save_warmup, int refresh,
+                    double stepsize, double stepsize_jitter, int max_depth,
+                    callbacks::interrupt& interrupt, callbacks::logger& logger,
+                    std::vector<InitWriter>& init_writer,
+                    std::vector<SampleWriter>& sample_writer,
+                    std::vector<DiagnosticWriter>& diagnostic_writer,
+                    util::chain_scheduler* scheduler = nullptr) {
+  return hmc_nuts_diag_e(
+      model, num_chains, init,
+      util::shared_contexts(init_inv_metric, num_chains),
+      random_seed, init_chain_id, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      scheduler);
+}
+
 }  // namespace sample
 }  // namespace services
 }  // namespace stan
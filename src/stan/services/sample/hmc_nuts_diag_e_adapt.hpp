@@ -12,7 +12,11 @@
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/inv_metric.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/resumable_chain.hpp>
+#include <stan/services/util/setup_chains.hpp>
+#include <stan/services/util/shared_contexts.hpp>
 #include <stan/services/util/run_adaptive_sampler.hpp>
+#include <stan/services/util/run_cross_chain_adaptive_sampler.hpp>
 #include <vector>
 
 namespace stan {
@@ -69,11 +73,14 @@ int hmc_nuts_diag_e_adapt(
   stan::rng_t rng = util::create_rng(random_seed, chain);
 
   std::vector<double> cont_vector;
+  double init_log_prob = 0;
+  std::vector<double> init_gradient;
 
   Eigen::VectorXd inv_metric;
   try {
-    cont_vector = util::initialize(model, init, rng, init_radius, true, logger,
-                                   init_writer);
+    cont_vector
+        = util::initialize(model, init, rng, init_radius, true, logger,
+                           init_writer, 1, &init_log_prob, &init_gradient);
 
     inv_metric = util::read_diag_inv_metric(init_inv_metric,
                                             model.num_params_r(), logger);
@@ -84,6 +91,11 @@ int hmc_nuts_diag_e_adapt(
   }
 
   stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t> sampler(model, rng);
+  // the gradient at the initial values is not evaluated again
+  sampler.seed(
+      Eigen::Map<Eigen::VectorXd>(cont_vector.data(), cont_vector.size()),
+      init_log_prob,
+      Eigen::Map<Eigen::VectorXd>(init_gradient.data(), init_gradient.size()));
 
   sampler.set_metric(inv_metric);
   sampler.set_nominal_stepsize(stepsize);
@@ -323,6 +335,23 @@ int hmc_nuts_diag_e_adapt(
  * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
  * information of each chain.
  * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @param[in] pool_adaptation if true, warm up the chains in lockstep and
+ * pool their metric and step size adaptation so that every chain samples
+ * with the same tuning parameters
+ * @param[in] max_warmup_rhat with pooled adaptation, end warmup early once
+ * the R-hat of lp__ and of every parameter over the last adaptation window
+ * is at most this value (zero disables early termination)
+ * @param[in] min_warmup_ess with pooled adaptation, the effective sample
+ * size over the last adaptation window required to end warmup early
+ * @param[in,out] scheduler scheduler interleaving the chains and reporting
+ * their progress, or <code>nullptr</code> to use a default one
+ * @param[in,out] communicator with pooled adaptation, processes running
+ * the other chains of a run split across processes, each with its own
+ * chains and writers, or <code>nullptr</code> for a single process
+ * @param[in] stuck_chain_threshold with pooled adaptation and at least
+ * three chains, restart a chain from the state of another one at a window
+ * boundary once its lp__, step size or tree depth is this far from those
+ * of the others (one or less disables the check)
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContextPtr, typename InitInvContextPtr,
@@ -340,8 +369,14 @@ int hmc_nuts_diag_e_adapt(
     std::vector<InitWriter>& init_writer,
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer,
-    std::vector<MetricWriter>& metric_writer) {
-  if (num_chains == 1) {
+    std::vector<MetricWriter>& metric_writer, bool pool_adaptation = false,
+    double max_warmup_rhat = 0, double min_warmup_ess = 0,
+    util::chain_scheduler* scheduler = nullptr,
+    util::chain_communicator* communicator = nullptr,
+    double stuck_chain_threshold = 0) {
+  const bool distributed = pool_adaptation && communicator != nullptr
+                           && communicator->size() > 1;
+  if (num_chains == 1 && !distributed) {
     return hmc_nuts_diag_e_adapt(
         model, *init[0], *init_inv_metric[0], random_seed, init_chain_id,
         init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
@@ -352,21 +387,39 @@ int hmc_nuts_diag_e_adapt(
   using sample_t = stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t>;
   std::vector<stan::rng_t> rngs;
   rngs.reserve(num_chains);
-  std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i)
+    rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
+  std::vector<std::vector<double>> cont_vectors(num_chains);
+  std::vector<double> init_log_probs(num_chains, 0);
+  std::vector<std::vector<double>> init_gradients(num_chains);
+  std::vector<Eigen::VectorXd> inv_metrics(num_chains);
+  if (!util::setup_chains(
+          num_chains, init_chain_id, logger,
+          [&](size_t i, callbacks::logger& chain_logger) {
+            cont_vectors[i] = util::initialize(
+                model, *init[i], rngs[i], init_radius, true, chain_logger,
+                init_writer[i], 1, &init_log_probs[i], &init_gradients[i]);
+            if (!util::shares_previous_context(init_inv_metric, i)) {
+              inv_metrics[i] = util::read_diag_inv_metric(
+                  *init_inv_metric[i], model.num_params_r(), chain_logger);
+              util::validate_diag_inv_metric(inv_metrics[i], chain_logger);
+            }
+          }))
+    return error_codes::CONFIG;
   std::vector<sample_t> samplers;
   samplers.reserve(num_chains);
   try {
-    for (int i = 0; i < num_chains; ++i) {
-      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
+    size_t metric_chain = 0;
+    for (size_t i = 0; i < num_chains; ++i) {
+      if (!util::shares_previous_context(init_inv_metric, i))
+        metric_chain = i;
       samplers.emplace_back(model, rngs[i]);
-      Eigen::VectorXd inv_metric = util::read_diag_inv_metric(
-          *init_inv_metric[i], model.num_params_r(), logger);
-      util::validate_diag_inv_metric(inv_metric, logger);
-
-      samplers[i].set_metric(inv_metric);
+      samplers[i].seed(Eigen::Map<Eigen::VectorXd>(cont_vectors[i].data(),
+                                                    cont_vectors[i].size()),
+                       init_log_probs[i],
+                       Eigen::Map<Eigen::VectorXd>(init_gradients[i].data(),
+                                                   init_gradients[i].size()));
+      samplers[i].set_metric(inv_metrics[metric_chain]);
       samplers[i].set_nominal_stepsize(stepsize);
       samplers[i].set_stepsize_jitter(stepsize_jitter);
       samplers[i].set_max_depth(max_depth);
@@ -384,21 +437,20 @@ int hmc_nuts_diag_e_adapt(
     return error_codes::CONFIG;
   }
   try {
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, num_chains, 1),
-        [num_warmup, num_samples, num_thin, refresh, save_warmup, num_chains,
-         init_chain_id, &samplers, &model, &rngs, &interrupt, &logger,
-         &sample_writer, &cont_vectors, &diagnostic_writer,
-         &metric_writer](const tbb::blocked_range<size_t>& r) {
-          for (size_t i = r.begin(); i != r.end(); ++i) {
-            util::run_adaptive_sampler(
-                samplers[i], model, cont_vectors[i], num_warmup, num_samples,
-                num_thin, refresh, save_warmup, rngs[i], interrupt, logger,
-                sample_writer[i], diagnostic_writer[i], metric_writer[i],
-                init_chain_id + i, num_chains);
-          }
-        },
-        tbb::simple_partitioner());
+    if (pool_adaptation) {
+      util::run_cross_chain_adaptive_sampler(
+          samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+          refresh, save_warmup, rngs, interrupt, logger, sample_writer,
+          diagnostic_writer, metric_writer, init_chain_id, max_warmup_rhat,
+          min_warmup_ess, communicator, stuck_chain_threshold);
+      return error_codes::OK;
+    }
+    util::chain_scheduler default_scheduler;
+    util::run_scheduled_adaptive_sampler(
+        scheduler == nullptr ? default_scheduler : *scheduler, samplers,
+        model, cont_vectors, num_warmup, num_samples, num_thin, refresh,
+        save_warmup, rngs, interrupt, logger, sample_writer,
+        diagnostic_writer, metric_writer, init_chain_id);
   } catch (const std::exception& e) {
     logger.error(e.what());
     return error_codes::SOFTWARE;
@@ -550,12 +602,10 @@ int hmc_nuts_diag_e_adapt(
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer,
     std::vector<MetricWriter>& metric_writer) {
-  std::vector<std::unique_ptr<stan::io::array_var_context>> unit_e_metric;
-  unit_e_metric.reserve(num_chains);
-  for (size_t i = 0; i < num_chains; ++i) {
-    unit_e_metric.emplace_back(std::make_unique<stan::io::array_var_context>(
-        util::create_unit_e_diag_inv_metric(model.num_params_r())));
-  }
+  stan::io::array_var_context unit_e_context
+      = util::create_unit_e_diag_inv_metric(model.num_params_r());
+  std::vector<const stan::io::array_var_context*> unit_e_metric
+      = util::shared_contexts(unit_e_context, num_chains);
   if (num_chains == 1) {
     return hmc_nuts_diag_e_adapt(
         model, *init[0], *unit_e_metric[0], random_seed, init_chain_id,
@@ -630,12 +680,10 @@ int hmc_nuts_diag_e_adapt(
     std::vector<InitWriter>& init_writer,
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer) {
-  std::vector<std::unique_ptr<stan::io::array_var_context>> unit_e_metric;
-  unit_e_metric.reserve(num_chains);
-  for (size_t i = 0; i < num_chains; ++i) {
-    unit_e_metric.emplace_back(std::make_unique<stan::io::array_var_context>(
-        util::create_unit_e_diag_inv_metric(model.num_params_r())));
-  }
+  stan::io::array_var_context unit_e_context
+      = util::create_unit_e_diag_inv_metric(model.num_params_r());
+  std::vector<const stan::io::array_var_context*> unit_e_metric
+      = util::shared_contexts(unit_e_context, num_chains);
   std::vector<stan::callbacks::structured_writer> dummy_metric_writer(
       num_chains);
   if (num_chains == 1) {
@@ -654,6 +702,47 @@ int hmc_nuts_diag_e_adapt(
       sample_writer, diagnostic_writer, dummy_metric_writer);
 }
 
+/**
+ * Runs multiple chains of NUTS with adaptation using diag Euclidean metric,
+ * with one initial inverse metric context shared by all chains, so that the
+ * metric is parsed and read once, and saves adapted tuning parameters stepsize
+ * and inverse metric.  The remaining parameters are those of the overload
+ * taking a std vector of inverse metric contexts.
+ *
+ * @param[in] init_inv_metric var context exposing an initial diag inverse
+ * Euclidean metric for all chains (must be positive definite)
+ */
+template <class Model, typename InitContextPtr, typename InitWriter,
+          typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+int hmc_nuts_diag_e_adapt(
+    Model& model, size_t num_chains, const std::vector<InitContextPtr>& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int init_chain_id, double init_radius, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double stepsize_jitter, int max_depth, double delta,
+    double gamma, double kappa, double t0, unsigned int init_buffer,
+    unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<InitWriter>& init_writer,
+    std::vector<SampleWriter>& sample_writer,
+    std::vector<DiagnosticWriter>& diagnostic_writer,
+    std::vector<MetricWriter>& metric_writer, bool pool_adaptation = false,
+    double max_warmup_rhat = 0, double min_warmup_ess = 0,
+    util::chain_scheduler* scheduler = nullptr,
+    util::chain_communicator* communicator = nullptr,
+    double stuck_chain_threshold = 0) {
+  return hmc_nuts_diag_e_adapt(
+      model, num_chains, init,
+      util::shared_contexts(init_inv_metric, num_chains),
+      random_seed, init_chain_id, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, interrupt,
+      logger, init_writer, sample_writer, diagnostic_writer, metric_writer,
+      pool_adaptation, max_warmup_rhat, min_warmup_ess, scheduler,
+      communicator, stuck_chain_threshold);
+}
+
 }  // namespace sample
 }  // namespace services
 }  // namespace stan
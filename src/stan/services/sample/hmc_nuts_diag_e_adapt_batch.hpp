@@ -0,0 +1,162 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_BATCH_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_BATCH_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * The callbacks of one fit of a batch.  A null member is replaced by one
+ * which ignores its input.
+ */
+struct batch_fit_callbacks {
+  std::unique_ptr<callbacks::logger> logger;
+  std::unique_ptr<callbacks::writer> init_writer;
+  std::unique_ptr<callbacks::writer> sample_writer;
+  std::unique_ptr<callbacks::writer> diagnostic_writer;
+  std::unique_ptr<callbacks::structured_writer> metric_writer;
+};
+
+/**
+ * Fits one model class to each of a batch of data sets in one process,
+ * running HMC with NUTS with adaptation using diagonal Euclidean metric,
+ * with identity matrix as initial inv_metric and random inits, for each.
+ *
+ * The fits are TBB tasks, so that fits of small models run side by side
+ * on the threads of the task arena instead of paying for a process and
+ * its startup each.  Fit <code>i</code> constructs its model from
+ * <code>*data[i]</code> and the random seed, draws with the random number
+ * generator of chain <code>init_chain_id + i</code>, and writes through
+ * the callbacks that <code>callback_factory(i)</code> returns, which are
+ * destroyed once the fit ends.  The factory is called from the threads
+ * running the fits, so it must be safe to call concurrently, as must the
+ * interrupt.  Samplers hold a reference to their model, so each fit builds
+ * its own sampler.
+ *
+ * A fit whose model cannot be constructed from its data logs the error to
+ * its own logger and gets <code>error_codes::DATAERR</code>.  The
+ * specified logger only gets a summary of the batch, from the calling
+ * thread.
+ *
+ * @tparam Model Model class, constructible from a data var context, a
+ * random seed and a message stream
+ * @tparam DataContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam CallbackFactory A callable returning the
+ * <code>batch_fit_callbacks</code> of the fit of the specified index
+ * @param[in] data std vector of data var contexts, one per fit
+ * @param[in] random_seed random seed for the models and the random number
+ * generators
+ * @param[in] init_chain_id chain id of the first fit
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for the summary of the batch
+ * @param[in] callback_factory Factory of the callbacks of each fit
+ * @param[out] return_codes If not null, resized to the number of fits and
+ * filled with the return code of each fit
+ * @return error_codes::OK if every fit succeeds, otherwise the return code
+ * of the first fit that failed
+ */
+template <class Model, typename DataContextPtr, typename CallbackFactory>
+int hmc_nuts_diag_e_adapt_batch(
+    const std::vector<DataContextPtr>& data, unsigned int random_seed,
+    unsigned int init_chain_id, double init_radius, int num_warmup,
+    int num_samples, int num_thin, bool save_warmup, int refresh,
+    double stepsize, double stepsize_jitter, int max_depth, double delta,
+    double gamma, double kappa, double t0, unsigned int init_buffer,
+    unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    CallbackFactory&& callback_factory,
+    std::vector<int>* return_codes = nullptr) {
+  const size_t num_fits = data.size();
+  std::vector<int> codes(num_fits, error_codes::OK);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, num_fits, 1),
+      [&](const tbb::blocked_range<size_t>& r) {
+        stan::io::empty_var_context init;
+        for (size_t fit = r.begin(); fit != r.end(); ++fit) {
+          batch_fit_callbacks fit_callbacks = callback_factory(fit);
+          callbacks::logger no_logger;
+          callbacks::writer no_writer;
+          callbacks::structured_writer no_metric_writer;
+          callbacks::logger& fit_logger
+              = fit_callbacks.logger ? *fit_callbacks.logger : no_logger;
+          std::unique_ptr<Model> model;
+          try {
+            std::stringstream msg;
+            model = std::make_unique<Model>(*data[fit], random_seed, &msg);
+            if (msg.str().length() > 0)
+              fit_logger.info(msg);
+          } catch (const std::exception& e) {
+            fit_logger.error(e.what());
+            codes[fit] = error_codes::DATAERR;
+            continue;
+          }
+          codes[fit] = hmc_nuts_diag_e_adapt(
+              *model, init, random_seed, init_chain_id + fit, init_radius,
+              num_warmup, num_samples, num_thin, save_warmup, refresh,
+              stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
+              init_buffer, term_buffer, window, interrupt, fit_logger,
+              fit_callbacks.init_writer ? *fit_callbacks.init_writer
+                                        : no_writer,
+              fit_callbacks.sample_writer ? *fit_callbacks.sample_writer
+                                          : no_writer,
+              fit_callbacks.diagnostic_writer
+                  ? *fit_callbacks.diagnostic_writer
+                  : no_writer,
+              fit_callbacks.metric_writer ? *fit_callbacks.metric_writer
+                                          : no_metric_writer);
+        }
+      });
+  int return_code = error_codes::OK;
+  size_t num_failed = 0;
+  for (int code : codes) {
+    if (code != error_codes::OK) {
+      if (num_failed == 0)
+        return_code = code;
+      ++num_failed;
+    }
+  }
+  std::stringstream summary;
+  summary << "Batch of " << num_fits << " fits: " << num_failed
+          << " failed.";
+  logger.info(summary);
+  if (return_codes != nullptr)
+    *return_codes = std::move(codes);
+  return return_code;
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,233 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_FIXED_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_FIXED_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_fixed_diag_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/inv_metric.hpp>
+#include <stan/services/util/run_adaptive_sampler.hpp>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Largest number of unconstrained parameters for which
+ * <code>hmc_nuts_diag_e_adapt_fixed</code> runs a sampler of a fixed
+ * dimension.
+ */
+constexpr int max_fixed_dimension = 16;
+
+namespace internal {
+
+/**
+ * Call a function with the dimension of a model as a compile-time
+ * constant, if it is between <code>N</code> and
+ * <code>max_fixed_dimension</code>.
+ *
+ * @tparam N smallest dimension tried
+ * @tparam F type of function, callable with a
+ *   <code>std::integral_constant<int, N></code>
+ * @param[in] n dimension
+ * @param[in,out] f function
+ * @return whether the function was called
+ */
+template <int N, class F>
+bool with_fixed_dimension(std::size_t n, F&& f) {
+  if (n == static_cast<std::size_t>(N)) {
+    f(std::integral_constant<int, N>());
+    return true;
+  }
+  if constexpr (N < max_fixed_dimension) {
+    return with_fixed_dimension<N + 1>(n, f);
+  } else {
+    return false;
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Runs HMC with NUTS with adaptation using diagonal Euclidean metric
+ * with a pre-specified diagonal metric and saves adapted tuning
+ * parameters, as <code>hmc_nuts_diag_e_adapt</code> does, with a sampler
+ * specialized to the dimension of models with at most
+ * <code>max_fixed_dimension</code> unconstrained parameters.  See
+ * <code>fixed_diag_e_nuts</code>.  Larger models, and models without
+ * parameters, are sampled by <code>hmc_nuts_diag_e_adapt</code>.
+ *
+ * Each dimension compiles a sampler of its own, which this entry point
+ * selects from <code>model.num_params_r()</code> at run time.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] init_inv_metric var context exposing an initial diagonal
+ *              inverse Euclidean metric (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_diag_e_adapt_fixed(
+    Model& model, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  const std::size_t num_params = model.num_params_r();
+  if (num_params == 0 || num_params > max_fixed_dimension)
+    return hmc_nuts_diag_e_adapt(
+        model, init, init_inv_metric, random_seed, chain, init_radius,
+        num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+        stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+        term_buffer, window, interrupt, logger, init_writer, sample_writer,
+        diagnostic_writer, metric_writer);
+
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+
+  std::vector<double> cont_vector;
+  Eigen::VectorXd inv_metric;
+  try {
+    cont_vector = util::initialize(model, init, rng, init_radius, true,
+                                   logger, init_writer);
+
+    inv_metric = util::read_diag_inv_metric(init_inv_metric, num_params,
+                                            logger);
+    util::validate_diag_inv_metric(inv_metric, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+
+  int return_code = error_codes::OK;
+  internal::with_fixed_dimension<1>(num_params, [&](auto dimension) {
+    constexpr int N = decltype(dimension)::value;
+    stan::mcmc::adapt_fixed_diag_e_nuts<Model, N, stan::rng_t> sampler(model,
+                                                                       rng);
+    sampler.set_metric(inv_metric);
+    sampler.set_nominal_stepsize(stepsize);
+    sampler.set_stepsize_jitter(stepsize_jitter);
+    sampler.set_max_depth(max_depth);
+
+    sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+    sampler.get_stepsize_adaptation().set_delta(delta);
+    sampler.get_stepsize_adaptation().set_gamma(gamma);
+    sampler.get_stepsize_adaptation().set_kappa(kappa);
+    sampler.get_stepsize_adaptation().set_t0(t0);
+
+    sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                              logger);
+
+    try {
+      util::run_adaptive_sampler(sampler, model, cont_vector, num_warmup,
+                                 num_samples, num_thin, refresh, save_warmup,
+                                 rng, interrupt, logger, sample_writer,
+                                 diagnostic_writer, metric_writer);
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return_code = error_codes::SOFTWARE;
+    }
+  });
+  return return_code;
+}
+
+/**
+ * Runs HMC with NUTS with adaptation using diagonal Euclidean metric,
+ * with identity matrix as initial inv_metric, and a sampler specialized
+ * to the dimension of small models.  See the overload with an initial
+ * inverse metric.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] init var context for initialization
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_diag_e_adapt_fixed(
+    Model& model, const stan::io::var_context& init, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer) {
+  auto default_metric
+      = util::create_unit_e_diag_inv_metric(model.num_params_r());
+  return hmc_nuts_diag_e_adapt_fixed(
+      model, init, default_metric, random_seed, chain, init_radius, num_warmup,
+      num_samples, num_thin, save_warmup, refresh, stepsize, stepsize_jitter,
+      max_depth, delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      metric_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,226 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_PARALLEL_TEMPERING_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_PARALLEL_TEMPERING_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/temperature_ladder.hpp>
+#include <stan/model/tempered_model.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/inv_metric.hpp>
+#include <stan/services/util/run_parallel_tempering_sampler.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs HMC with NUTS with adaptation using diagonal Euclidean metric
+ * and parallel tempering, for posteriors with modes that a single chain
+ * does not move between.
+ *
+ * The chain is made of <code>num_replicas</code> replicas, best one per
+ * thread, each a NUTS sampler of the posterior raised to an inverse
+ * temperature in (0, 1], from 1 for the target down to
+ * <code>1 / max_temperature</code> on a geometric ladder.  The replicas
+ * run in parallel and every <code>swap_interval</code> iterations
+ * exchange their states between neighbouring temperatures with the
+ * deterministic even-odd scheme.  Each replica adapts its step size and
+ * metric as the usual adaptive sampler does and, during warmup, the
+ * temperatures adapt so that neighbours exchange with probability
+ * <code>target_swap_rate</code>.  Only the draws at temperature 1 are
+ * written; the final inverse temperatures and swap rates follow the
+ * adaptation info as comments.
+ *
+ * The replicas use the pseudo random number generators of the chain ids
+ * <code>chain</code> to <code>chain + num_replicas - 1</code> and the
+ * exchanges that of <code>chain + num_replicas</code>, so chains run
+ * side by side should leave that many ids between them.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_replicas number of temperatures, at least 1
+ * @param[in] init var context for initialization of every replica
+ * @param[in] init_inv_metric var context exposing an initial diagonal
+ *              inverse Euclidean metric (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] max_temperature initial highest temperature, at least 1
+ * @param[in] swap_interval number of iterations between exchanges,
+ *              at least 1
+ * @param[in] adapt_ladder true to adapt the temperatures during warmup
+ * @param[in] target_swap_rate swap rate the temperatures adapt to, in
+ *              (0, 1)
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits of
+ *              the replica at temperature 1
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_diag_e_adapt_parallel_tempering(
+    Model& model, size_t num_replicas, const stan::io::var_context& init,
+    const stan::io::var_context& init_inv_metric, unsigned int random_seed,
+    unsigned int chain, double init_radius, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize,
+    double stepsize_jitter, int max_depth, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, double max_temperature, int swap_interval,
+    bool adapt_ladder, double target_swap_rate,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer) {
+  using replica_t = stan::model::tempered_model<Model>;
+  using sampler_t = stan::mcmc::adapt_diag_e_nuts<replica_t, stan::rng_t>;
+  std::vector<stan::rng_t> rngs;
+  rngs.reserve(num_replicas);
+  std::vector<std::vector<double>> cont_vectors;
+  cont_vectors.reserve(num_replicas);
+  std::vector<replica_t> replicas;
+  replicas.reserve(num_replicas);
+  std::vector<sampler_t> samplers;
+  samplers.reserve(num_replicas);
+  callbacks::writer no_init_writer;
+  callbacks::logger no_logger;
+  try {
+    if (swap_interval < 1)
+      throw std::invalid_argument("swap_interval must be positive");
+    stan::mcmc::temperature_ladder ladder(num_replicas, max_temperature,
+                                          target_swap_rate);
+    Eigen::VectorXd inv_metric = util::read_diag_inv_metric(
+        init_inv_metric, model.num_params_r(), logger);
+    util::validate_diag_inv_metric(inv_metric, logger);
+    for (size_t k = 0; k < num_replicas; ++k) {
+      // the replicas above temperature 1 do not repeat its messages
+      callbacks::writer& replica_init_writer
+          = k == 0 ? init_writer : no_init_writer;
+      callbacks::logger& replica_logger = k == 0 ? logger : no_logger;
+      rngs.emplace_back(util::create_rng(random_seed, chain + k));
+      cont_vectors.emplace_back(util::initialize(model, init, rngs[k],
+                                                 init_radius, true, logger,
+                                                 replica_init_writer));
+      replicas.emplace_back(model, ladder.inv_temperature(k));
+      samplers.emplace_back(replicas[k], rngs[k]);
+
+      samplers[k].set_metric(inv_metric);
+      samplers[k].set_nominal_stepsize(stepsize);
+      samplers[k].set_stepsize_jitter(stepsize_jitter);
+      samplers[k].set_max_depth(max_depth);
+
+      samplers[k].get_stepsize_adaptation().set_mu(log(10 * stepsize));
+      samplers[k].get_stepsize_adaptation().set_delta(delta);
+      samplers[k].get_stepsize_adaptation().set_gamma(gamma);
+      samplers[k].get_stepsize_adaptation().set_kappa(kappa);
+      samplers[k].get_stepsize_adaptation().set_t0(t0);
+      samplers[k].set_window_params(num_warmup, init_buffer, term_buffer,
+                                    window, replica_logger);
+    }
+    stan::rng_t swap_rng = util::create_rng(random_seed, chain + num_replicas);
+    try {
+      util::run_parallel_tempering_sampler(
+          samplers, replicas, ladder, model, cont_vectors, num_warmup,
+          num_samples, num_thin, refresh, save_warmup, swap_interval,
+          adapt_ladder, rngs, swap_rng, interrupt, logger, sample_writer,
+          diagnostic_writer, chain);
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return error_codes::SOFTWARE;
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Runs HMC with NUTS with adaptation using diagonal Euclidean metric
+ * and parallel tempering, with identity matrix as initial inv_metric.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_replicas number of temperatures, at least 1
+ * @param[in] init var context for initialization of every replica
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in] max_temperature initial highest temperature, at least 1
+ * @param[in] swap_interval number of iterations between exchanges,
+ *              at least 1
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits of
+ *              the replica at temperature 1
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_nuts_diag_e_adapt_parallel_tempering(
+    Model& model, size_t num_replicas, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int chain, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    double max_temperature, int swap_interval,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer) {
+  auto default_metric
+      = util::create_unit_e_diag_inv_metric(model.num_params_r());
+  return hmc_nuts_diag_e_adapt_parallel_tempering(
+      model, num_replicas, init, default_metric, random_seed, chain,
+      init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
+      stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
+      init_buffer, term_buffer, window, max_temperature, swap_interval, true,
+      0.234, interrupt, logger, init_writer, sample_writer,
+      diagnostic_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
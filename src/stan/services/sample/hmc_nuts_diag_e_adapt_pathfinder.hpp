@@ -0,0 +1,182 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_PATHFINDER_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_PATHFINDER_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/multi.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/pathfinder_init.hpp>
+#include <stan/services/util/resumable_chain.hpp>
+#include <stan/services/util/validate_diag_inv_metric.hpp>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs HMC with NUTS with adaptation using a diagonal Euclidean metric,
+ * initialized by multi-path pathfinder, and saves adapted tuning
+ * parameters stepsize and inverse metric.
+ *
+ * One pathfinder is run from each init context, and their approximate
+ * draws are resampled with PSIS.  Each chain starts from a different
+ * resampled draw, and every chain starts warmup with the variances of the
+ * resampled draws on the unconstrained scale as its inverse metric and a
+ * step size guess for that metric, as computed by
+ * <code>util::init_from_draws</code>.  As the chains start close to the
+ * typical set with a reasonable metric, warmup can be much shorter than
+ * usual, for instance without an initial fast interval.
+ *
+ * @tparam Model Model class
+ * @tparam InitContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitWriter A type derived from `stan::callbacks::writer`
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from `stan::callbacks::structured_writer`
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_chains The number of chains to run in parallel.
+ * `init_writer`, `sample_writer`, `diagnostic_writer` and `metric_writer`
+ * must be the same length as this value.
+ * @param[in] init A std vector of init var contexts, one for each
+ * pathfinder
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id first chain id. The pseudo random number generator
+ * will advance for each chain by an integer sequence from `init_chain_id` to
+ * `init_chain_id + num_chains - 1`
+ * @param[in] init_radius radius to initialize the pathfinders
+ * @param[in] history_size amount of history to keep for L-BFGS
+ * @param[in] init_alpha line search step size for first L-BFGS iteration
+ * @param[in] tol_obj convergence tolerance on absolute changes in objective
+ * function value
+ * @param[in] tol_rel_obj convergence tolerance on relative changes in
+ * objective function value
+ * @param[in] tol_grad convergence tolerance on the norm of the gradient
+ * @param[in] tol_rel_grad convergence tolerance on the relative norm of the
+ * gradient
+ * @param[in] tol_param convergence tolerance on changes in the L1 norm of
+ * parameter values
+ * @param[in] num_iterations maximum number of L-BFGS iterations
+ * @param[in] num_elbo_draws number of draws to evaluate the ELBO
+ * @param[in] num_draws number of approximate draws of each pathfinder
+ * @param[in] num_multi_draws number of PSIS resampled draws
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer std vector of Writer callbacks for unconstrained
+ * inits of each chain.
+ * @param[in,out] sample_writer std vector of Writers for draws of each chain.
+ * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
+ * information of each chain.
+ * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model, typename InitContextPtr, typename InitWriter,
+          typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+int hmc_nuts_diag_e_adapt_pathfinder(
+    Model& model, size_t num_chains, const std::vector<InitContextPtr>& init,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int history_size, double init_alpha, double tol_obj, double tol_rel_obj,
+    double tol_grad, double tol_rel_grad, double tol_param,
+    int num_iterations, int num_elbo_draws, int num_draws,
+    int num_multi_draws, int num_warmup, int num_samples, int num_thin,
+    bool save_warmup, int refresh, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<InitWriter>& init_writer,
+    std::vector<SampleWriter>& sample_writer,
+    std::vector<DiagnosticWriter>& diagnostic_writer,
+    std::vector<MetricWriter>& metric_writer) {
+  const size_t num_paths = init.size();
+  std::vector<callbacks::writer> path_init_writers(num_paths);
+  std::vector<callbacks::writer> path_parameter_writers(num_paths);
+  std::vector<callbacks::structured_writer> path_diagnostic_writers(
+      num_paths);
+  util::draws_collector pathfinder_draws;
+  callbacks::writer pathfinder_diagnostic_writer;
+  int return_code = pathfinder::pathfinder_lbfgs_multi(
+      model, init, random_seed, init_chain_id, init_radius, history_size,
+      init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+      num_iterations, num_elbo_draws, num_draws, num_multi_draws, num_paths,
+      false, refresh, interrupt, logger, path_init_writers,
+      path_parameter_writers, path_diagnostic_writers, pathfinder_draws,
+      pathfinder_diagnostic_writer);
+  if (return_code != error_codes::OK)
+    return return_code;
+
+  using sample_t = stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t>;
+  std::vector<stan::rng_t> rngs;
+  rngs.reserve(num_chains);
+  std::vector<sample_t> samplers;
+  samplers.reserve(num_chains);
+  util::chains_init start;
+  try {
+    // lp_approx__ and lp__ precede the parameters
+    start = util::init_from_draws(model, pathfinder_draws.draws(), 2,
+                                  num_chains);
+    util::validate_diag_inv_metric(start.inv_metric, logger);
+    std::stringstream msg;
+    msg << "Pathfinder initialization: step size " << start.stepsize
+        << " from " << pathfinder_draws.draws().size() << " draws";
+    logger.info(msg);
+    for (size_t i = 0; i < num_chains; ++i) {
+      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
+      init_writer[i](start.cont_vectors[i]);
+      samplers.emplace_back(model, rngs[i]);
+
+      samplers[i].set_metric(start.inv_metric);
+      samplers[i].set_nominal_stepsize(start.stepsize);
+      samplers[i].set_stepsize_jitter(stepsize_jitter);
+      samplers[i].set_max_depth(max_depth);
+
+      samplers[i].get_stepsize_adaptation().set_mu(log(10 * start.stepsize));
+      samplers[i].get_stepsize_adaptation().set_delta(delta);
+      samplers[i].get_stepsize_adaptation().set_gamma(gamma);
+      samplers[i].get_stepsize_adaptation().set_kappa(kappa);
+      samplers[i].get_stepsize_adaptation().set_t0(t0);
+      samplers[i].set_window_params(num_warmup, init_buffer, term_buffer,
+                                    window, logger);
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  try {
+    util::chain_scheduler scheduler;
+    util::run_scheduled_adaptive_sampler(
+        scheduler, samplers, model, start.cont_vectors, num_warmup,
+        num_samples, num_thin, refresh, save_warmup, rngs, interrupt, logger,
+        sample_writer, diagnostic_writer, metric_writer, init_chain_id);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
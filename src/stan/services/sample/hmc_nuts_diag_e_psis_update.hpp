@@ -0,0 +1,146 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_PSIS_UPDATE_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_PSIS_UPDATE_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_warm_start.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/psis_reweight.hpp>
+#include <boost/random/discrete_distribution.hpp>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Updates the posterior draws of a previous fit for a model or data that
+ * changed a little, by Pareto smoothed importance sampling when that is
+ * reliable and by HMC with NUTS with a diagonal Euclidean metric warm
+ * started from the fit otherwise.
+ *
+ * The draws of the fit are reweighted by
+ * <code>util::psis_reweight</code>.  If the estimated Pareto shape is at
+ * most <code>max_pareto_k</code>, <code>num_samples</code> draws are
+ * resampled with replacement in proportion to their weights, and the
+ * sample writer receives the names <code>lp__</code> and the constrained
+ * parameter names of the model, followed by one row per draw with its
+ * generated quantities drawn again under the model.  Otherwise, as when
+ * the shape cannot be estimated, the update falls back to
+ * <code>hmc_nuts_diag_e_warm_start</code>, whose output is that of the
+ * sampler.
+ *
+ * @tparam Model Model class
+ * @tparam PreviousModel Model class of the previous fit
+ * @param[in] model Input model (with the updated data instantiated)
+ * @param[in] previous_model Model of the previous fit (with its data)
+ * @param[in] previous output of the previous fit
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] max_pareto_k largest Pareto shape for which the reweighted
+ * draws are used
+ * @param[in] num_warmup Number of warmup samples adapting the step size
+ * if sampling
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples if sampling
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * if sampling
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws
+ * @param[in,out] diagnostic_writer Writer for diagnostic information
+ * @param[in,out] metric_writer Writer for tuning params
+ * @param[out] pareto_k If not null, set to the estimated Pareto shape
+ * @return error_codes::OK if successful
+ */
+template <class Model, class PreviousModel>
+int hmc_nuts_diag_e_psis_update(
+    Model& model, const PreviousModel& previous_model,
+    const stan::io::stan_csv& previous, unsigned int random_seed,
+    unsigned int chain, double max_pareto_k, int num_warmup, int num_samples,
+    int num_thin, bool save_warmup, int refresh, double stepsize_jitter,
+    int max_depth, double delta, double gamma, double kappa, double t0,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& init_writer, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    double* pareto_k = nullptr) {
+  util::psis_reweighting reweighting;
+  try {
+    reweighting = util::psis_reweight(model, previous_model, previous, logger);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  if (pareto_k != nullptr)
+    *pareto_k = reweighting.pareto_k;
+  std::stringstream k_msg;
+  k_msg << "PSIS update: Pareto k = " << std::setprecision(2)
+        << reweighting.pareto_k;
+  if (!(reweighting.pareto_k <= max_pareto_k)) {
+    k_msg << ", sampling warm started from the previous fit.";
+    logger.info(k_msg);
+    return hmc_nuts_diag_e_warm_start(
+        model, previous, random_seed, chain, num_warmup, num_samples,
+        num_thin, save_warmup, refresh, stepsize_jitter, max_depth, delta,
+        gamma, kappa, t0, interrupt, logger, init_writer, sample_writer,
+        diagnostic_writer, metric_writer);
+  }
+  k_msg << ", resampling the previous draws.";
+  logger.info(k_msg);
+
+  std::vector<std::string> names{"lp__"};
+  std::vector<std::string> param_names;
+  model.constrained_param_names(param_names, true, true);
+  names.insert(names.end(), param_names.begin(), param_names.end());
+  sample_writer(names);
+
+  stan::rng_t rng = util::create_rng(random_seed, chain);
+  boost::random::discrete_distribution<Eigen::Index, double> resample(
+      reweighting.weights.data(),
+      reweighting.weights.data() + reweighting.weights.size());
+  std::vector<double> row(names.size());
+  Eigen::VectorXd draw;
+  Eigen::VectorXd constrained;
+  std::stringstream msg;
+  try {
+    for (int m = 0; m < num_samples; ++m) {
+      interrupt();
+      draw = reweighting.draws.col(resample(rng));
+      row[0] = model.template log_prob<false, true>(draw, &msg);
+      model.write_array(rng, draw, constrained, true, true, &msg);
+      if (msg.str().length() > 0) {
+        logger.info(msg);
+        msg.str("");
+      }
+      std::copy(constrained.data(), constrained.data() + constrained.size(),
+                row.begin() + 1);
+      sample_writer(row);
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
@@ -11,6 +11,8 @@
 #include <stan/services/error_codes.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/resumable_chain.hpp>
+#include <stan/services/util/setup_chains.hpp>
 #include <stan/services/util/run_adaptive_sampler.hpp>
 #include <iostream>
 #include <vector>
@@ -181,6 +183,8 @@ int hmc_nuts_unit_e_adapt(
  * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
  * information of each chain.
  * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @param[in,out] scheduler scheduler interleaving the chains and reporting
+ * their progress, or <code>nullptr</code> to use a default one
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContextPtr, typename InitWriter,
@@ -196,7 +200,8 @@ int hmc_nuts_unit_e_adapt(
     std::vector<InitWriter>& init_writer,
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer,
-    std::vector<MetricWriter>& metric_writer) {
+    std::vector<MetricWriter>& metric_writer,
+    util::chain_scheduler* scheduler = nullptr) {
   if (num_chains == 1) {
     return hmc_nuts_unit_e_adapt(
         model, *init[0], random_seed, init_chain_id, init_radius, num_warmup,
@@ -207,15 +212,20 @@ int hmc_nuts_unit_e_adapt(
   using sample_t = stan::mcmc::adapt_unit_e_nuts<Model, stan::rng_t>;
   std::vector<stan::rng_t> rngs;
   rngs.reserve(num_chains);
-  std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i)
+    rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
+  std::vector<std::vector<double>> cont_vectors(num_chains);
+  if (!util::setup_chains(num_chains, init_chain_id, logger,
+                          [&](size_t i, callbacks::logger& chain_logger) {
+                            cont_vectors[i] = util::initialize(
+                                model, *init[i], rngs[i], init_radius, true,
+                                chain_logger, init_writer[i]);
+                          }))
+    return error_codes::CONFIG;
   std::vector<sample_t> samplers;
   samplers.reserve(num_chains);
   try {
-    for (int i = 0; i < num_chains; ++i) {
-      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
+    for (size_t i = 0; i < num_chains; ++i) {
       samplers.emplace_back(model, rngs[i]);
 
       samplers[i].set_nominal_stepsize(stepsize);
@@ -233,21 +243,12 @@ int hmc_nuts_unit_e_adapt(
     return error_codes::CONFIG;
   }
   try {
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, num_chains, 1),
-        [num_warmup, num_samples, num_thin, refresh, save_warmup, num_chains,
-         init_chain_id, &samplers, &model, &rngs, &interrupt, &logger,
-         &sample_writer, &cont_vectors, &diagnostic_writer,
-         &metric_writer](const tbb::blocked_range<size_t>& r) {
-          for (size_t i = r.begin(); i != r.end(); ++i) {
-            util::run_adaptive_sampler(
-                samplers[i], model, cont_vectors[i], num_warmup, num_samples,
-                num_thin, refresh, save_warmup, rngs[i], interrupt, logger,
-                sample_writer[i], diagnostic_writer[i], metric_writer[i],
-                init_chain_id + i, num_chains);
-          }
-        },
-        tbb::simple_partitioner());
+    util::chain_scheduler default_scheduler;
+    util::run_scheduled_adaptive_sampler(
+        scheduler == nullptr ? default_scheduler : *scheduler, samplers,
+        model, cont_vectors, num_warmup, num_samples, num_thin, refresh,
+        save_warmup, rngs, interrupt, logger, sample_writer,
+        diagnostic_writer, metric_writer, init_chain_id);
   } catch (const std::exception& e) {
     logger.error(e.what());
     return error_codes::SOFTWARE;
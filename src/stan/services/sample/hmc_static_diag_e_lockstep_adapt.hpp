@@ -0,0 +1,286 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_STATIC_DIAG_E_LOCKSTEP_ADAPT_HPP
+#define STAN_SERVICES_SAMPLE_HMC_STATIC_DIAG_E_LOCKSTEP_ADAPT_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/static/lockstep_diag_e_static_hmc.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/setup_chains.hpp>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+namespace internal {
+
+/**
+ * Write one row per chain with the chain id, the sampler parameters and
+ * the constrained parameters of the current draws of the ensemble.
+ */
+template <class Model, class Sampler>
+void write_lockstep_draws(Model& model, Sampler& sampler,
+                          std::vector<stan::rng_t>& rngs,
+                          unsigned int init_chain_id,
+                          size_t num_model_params, callbacks::logger& logger,
+                          callbacks::writer& sample_writer) {
+  std::vector<double> values;
+  Eigen::VectorXd cont_params;
+  Eigen::VectorXd model_values;
+  std::stringstream msgs;
+  for (size_t c = 0; c < sampler.num_chains(); ++c) {
+    values.clear();
+    values.push_back(init_chain_id + c);
+    sampler.get_sampler_params(c, values);
+    cont_params = sampler.q().col(c);
+    msgs.str(std::string());
+    // a draw the model fails to write is written as NaN
+    model_values = Eigen::VectorXd::Constant(
+        num_model_params, std::numeric_limits<double>::quiet_NaN());
+    try {
+      model.write_array(rngs[c], cont_params, model_values, true, true, &msgs);
+    } catch (const std::domain_error& e) {
+      logger.info(e.what());
+    }
+    if (msgs.str().length() > 0)
+      logger.info(msgs);
+    values.insert(values.end(), model_values.data(),
+                  model_values.data() + model_values.size());
+    if (static_cast<size_t>(model_values.size()) < num_model_params)
+      values.insert(values.end(), num_model_params - model_values.size(),
+                    std::numeric_limits<double>::quiet_NaN());
+    sample_writer(values);
+  }
+}
+
+}  // namespace internal
+
+/**
+ * Runs static HMC with adaptation using diagonal Euclidean metric on an
+ * ensemble of chains advanced in lockstep, with identity matrix as
+ * initial inv_metric and saves adapted tuning parameters.
+ *
+ * All chains take their leapfrog steps together and each step evaluates
+ * the gradients of every chain with one batched call, so for cheap
+ * models hundreds of chains run at little more than the cost of one.
+ * The chains share their step size and metric, which are adapted from
+ * the acceptance statistics and the draws of the whole ensemble.
+ *
+ * The draws of every chain go to the single sample writer, as one row
+ * per chain and saved iteration whose first column
+ * <code>chain__</code> is the chain id.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_chains number of chains in the ensemble
+ * @param[in] init var context for initialization of every chain
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id id of the first chain, the others following
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] int_time integration time
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws of every chain
+ * @param[in,out] metric_writer Writer for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_static_diag_e_lockstep_adapt(
+    Model& model, size_t num_chains, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double int_time, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer,
+    callbacks::structured_writer& metric_writer) {
+  if (num_chains == 0) {
+    logger.error("Number of chains must be positive");
+    return error_codes::CONFIG;
+  }
+  std::vector<stan::rng_t> rngs;
+  rngs.reserve(num_chains);
+  for (size_t c = 0; c < num_chains; ++c)
+    rngs.emplace_back(util::create_rng(random_seed, init_chain_id + c));
+  std::vector<std::vector<double>> cont_vectors(num_chains);
+  // the chains share the init writer, so their inits are written in order
+  // once all of them are initialized
+  if (!util::setup_chains(num_chains, init_chain_id, logger,
+                          [&](size_t c, callbacks::logger& chain_logger) {
+                            callbacks::writer no_init_writer;
+                            cont_vectors[c] = util::initialize(
+                                model, init, rngs[c], init_radius, c == 0,
+                                chain_logger, no_init_writer);
+                          }))
+    return error_codes::CONFIG;
+  Eigen::MatrixXd cont_params(model.num_params_r(), num_chains);
+  for (size_t c = 0; c < num_chains; ++c) {
+    init_writer(cont_vectors[c]);
+    cont_params.col(c) = Eigen::Map<Eigen::VectorXd>(cont_vectors[c].data(),
+                                                     cont_vectors[c].size());
+  }
+
+  stan::mcmc::lockstep_diag_e_static_hmc<Model, stan::rng_t> sampler(model,
+                                                                     rngs);
+  sampler.set_nominal_stepsize(stepsize);
+  sampler.set_T(int_time);
+
+  sampler.get_stepsize_adaptation().set_mu(log(10 * stepsize));
+  sampler.get_stepsize_adaptation().set_delta(delta);
+  sampler.get_stepsize_adaptation().set_gamma(gamma);
+  sampler.get_stepsize_adaptation().set_kappa(kappa);
+  sampler.get_stepsize_adaptation().set_t0(t0);
+
+  sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
+                            logger);
+
+  std::vector<std::string> names{"chain__"};
+  sampler.get_sampler_param_names(names);
+  std::vector<std::string> model_names;
+  model.constrained_param_names(model_names, true, true);
+  names.insert(names.end(), model_names.begin(), model_names.end());
+
+  const int num_iterations = num_warmup + num_samples;
+  auto run = [&](int start, int num, bool warmup, bool save) {
+    for (int m = 0; m < num; ++m) {
+      interrupt();
+      const int it = start + m;
+      if (refresh > 0
+          && (it + 1 == num_iterations || it == 0 || (it + 1) % refresh == 0)) {
+        int it_print_width
+            = std::ceil(std::log10(static_cast<double>(num_iterations)));
+        std::stringstream message;
+        message << "Iteration: " << std::setw(it_print_width) << it + 1
+                << " / " << num_iterations << " [" << std::setw(3)
+                << static_cast<int>((100.0 * (it + 1)) / num_iterations)
+                << "%] " << (warmup ? " (Warmup)" : " (Sampling)");
+        logger.info(message);
+      }
+      sampler.transition(logger);
+      if (save && m % num_thin == 0)
+        internal::write_lockstep_draws(model, sampler, rngs, init_chain_id,
+                                       model_names.size(), logger,
+                                       sample_writer);
+    }
+  };
+
+  callbacks::writer no_diagnostics;
+  util::mcmc_writer writer(sample_writer, no_diagnostics, logger);
+  try {
+    sampler.engage_adaptation();
+    sampler.init(cont_params, logger);
+    sample_writer(names);
+
+    auto start_warm = std::chrono::steady_clock::now();
+    run(0, num_warmup, true, save_warmup);
+    auto end_warm = std::chrono::steady_clock::now();
+    double warm_delta_t
+        = std::chrono::duration_cast<std::chrono::milliseconds>(end_warm
+                                                                - start_warm)
+              .count()
+          / 1000.0;
+    sampler.disengage_adaptation();
+    sample_writer("Adaptation terminated");
+    sampler.write_sampler_state(sample_writer);
+    sampler.write_sampler_state_struct(metric_writer);
+    writer.flush();
+
+    auto start_sample = std::chrono::steady_clock::now();
+    run(num_warmup, num_samples, false, true);
+    auto end_sample = std::chrono::steady_clock::now();
+    double sample_delta_t
+        = std::chrono::duration_cast<std::chrono::milliseconds>(end_sample
+                                                                - start_sample)
+              .count()
+          / 1000.0;
+    writer.write_timing(warm_delta_t, sample_delta_t);
+    writer.flush();
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Runs static HMC with adaptation using diagonal Euclidean metric on an
+ * ensemble of chains advanced in lockstep, with identity matrix as
+ * initial inv_metric.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_chains number of chains in the ensemble
+ * @param[in] init var context for initialization of every chain
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id id of the first chain, the others following
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] int_time integration time
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer Writer callback for unconstrained inits
+ * @param[in,out] sample_writer Writer for draws of every chain
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int hmc_static_diag_e_lockstep_adapt(
+    Model& model, size_t num_chains, const stan::io::var_context& init,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double int_time, double delta, double gamma,
+    double kappa, double t0, unsigned int init_buffer, unsigned int term_buffer,
+    unsigned int window, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& init_writer,
+    callbacks::writer& sample_writer) {
+  callbacks::structured_writer dummy_metric_writer;
+  return hmc_static_diag_e_lockstep_adapt(
+      model, num_chains, init, random_seed, init_chain_id, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      int_time, delta, gamma, kappa, t0, init_buffer, term_buffer, window,
+      interrupt, logger, init_writer, sample_writer, dummy_metric_writer);
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+#endif
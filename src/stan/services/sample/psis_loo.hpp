@@ -0,0 +1,184 @@
+#ifndef STAN_SERVICES_SAMPLE_PSIS_LOO_HPP
+#define STAN_SERVICES_SAMPLE_PSIS_LOO_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/psis_engine.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+
+/**
+ * Given a set of draws from a fitted model, compute the Pareto smoothed
+ * importance sampling approximation to leave-one-out cross-validation
+ * (PSIS-LOO) from the pointwise log likelihood the model generates, and
+ * write the expected log pointwise predictive density <code>elpd_loo</code>,
+ * the effective number of parameters <code>p_loo</code> and the Pareto
+ * shape <code>pareto_k</code> of each observation to the writer, one row
+ * per observation.  The totals, the standard error of
+ * <code>elpd_loo</code> and the number of observations whose shape is
+ * above 0.7 are logged.
+ *
+ * The log likelihood is the variable <code>log_lik_name</code> of the
+ * model, a transformed parameter or generated quantity of any shape with
+ * one element per observation.  It is copied from <code>write_array</code>
+ * into per-observation buffers of all the draws, never formatted as text.
+ * The observations are processed in blocks of at most
+ * <code>max_buffer_size</code> values: for each block the draws are
+ * evaluated in parallel, then the observations are smoothed in parallel.
+ * When there is more than one block, <code>write_array</code> is called
+ * again for each block.  Draw <code>n</code> uses the random number
+ * generator of chain <code>n + 1</code> in every block, so the result does
+ * not depend on the block size.
+ *
+ * Matrix of draws consists of one row per draw, one column per parameter.
+ *
+ * @tparam Model model class
+ * @param[in] model instantiated model
+ * @param[in] draws sequence of draws of constrained parameters
+ * @param[in] seed seed to use for randomization
+ * @param[in] log_lik_name name of the pointwise log likelihood variable
+ * @param[in,out] interrupt called once per draw and block
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] loo_writer writer for the pointwise results
+ * @param[in] max_buffer_size largest number of log likelihood values held
+ * at once
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int psis_loo(const Model &model, const Eigen::MatrixXd &draws,
+             unsigned int seed, const std::string &log_lik_name,
+             callbacks::interrupt &interrupt, callbacks::logger &logger,
+             callbacks::writer &loo_writer,
+             size_t max_buffer_size = size_t(1) << 27) {
+  if (draws.size() == 0) {
+    logger.error("Empty set of draws from fitted model.");
+    return error_codes::DATAERR;
+  }
+  std::vector<std::string> p_names;
+  model.constrained_param_names(p_names, false, false);
+  if (p_names.size() != draws.cols()) {
+    std::stringstream msg;
+    msg << "Wrong number of parameter values in draws from fitted model.  ";
+    msg << "Expecting " << p_names.size() << " columns, ";
+    msg << "found " << draws.cols() << " columns.";
+    logger.error(msg.str());
+    return error_codes::DATAERR;
+  }
+  std::vector<std::string> names;
+  model.constrained_param_names(names, true, true);
+  std::vector<size_t> log_lik_idxs;
+  for (size_t i = 0; i < names.size(); ++i)
+    if (names[i] == log_lik_name
+        || names[i].compare(0, log_lik_name.size() + 1, log_lik_name + ".")
+               == 0)
+      log_lik_idxs.push_back(i);
+  if (log_lik_idxs.empty()) {
+    logger.error("Model has no variable " + log_lik_name + ".");
+    return error_codes::CONFIG;
+  }
+
+  const Eigen::Index num_draws = draws.rows();
+  const size_t num_obs = log_lik_idxs.size();
+  const size_t block_size = std::max<size_t>(1, max_buffer_size / num_draws);
+  const Eigen::Index tail_len
+      = std::min(0.2 * num_draws, 3 * std::sqrt(num_draws));
+  const double log_num_draws = std::log(num_draws);
+  // one observation per column, so each observation's draws are contiguous
+  Eigen::MatrixXd log_lik(num_draws, std::min(block_size, num_obs));
+  Eigen::Array<double, Eigen::Dynamic, 3> loo(log_lik.cols(), 3);
+  tbb::enumerable_thread_specific<psis::psis_engine> engines;
+  Eigen::Array<double, Eigen::Dynamic, 1> elpd_loo(num_obs);
+  double p_loo = 0;
+  size_t num_high_k = 0;
+
+  loo_writer(std::vector<std::string>{"elpd_loo", "p_loo", "pareto_k"});
+  try {
+    for (size_t begin = 0; begin < num_obs; begin += block_size) {
+      const size_t size = std::min(block_size, num_obs - begin);
+      tbb::parallel_for(
+          tbb::blocked_range<Eigen::Index>(0, num_draws),
+          [&](const tbb::blocked_range<Eigen::Index> &r) {
+            Eigen::VectorXd row(draws.cols());
+            Eigen::VectorXd unconstrained;
+            Eigen::VectorXd vars;
+            std::stringstream msg;
+            for (Eigen::Index n = r.begin(); n != r.end(); ++n) {
+              interrupt();
+              row = draws.row(n);
+              try {
+                model.unconstrain_array(row, unconstrained, &msg);
+              } catch (const std::exception &e) {
+                throw std::invalid_argument(e.what());
+              }
+              stan::rng_t rng = util::create_rng(seed, n + 1);
+              model.write_array(rng, unconstrained, vars, true, true, &msg);
+              for (size_t o = 0; o < size; ++o)
+                log_lik(n, o) = vars.coeff(log_lik_idxs[begin + o]);
+              msg.str("");
+            }
+          });
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, size),
+          [&](const tbb::blocked_range<size_t> &r) {
+            psis::psis_engine &engine = engines.local();
+            callbacks::logger no_logger;
+            Eigen::Array<double, Eigen::Dynamic, 1> weights;
+            for (size_t o = r.begin(); o != r.end(); ++o) {
+              const auto ll = log_lik.col(o).array();
+              const double k
+                  = engine.weights(-ll, tail_len, weights, no_logger);
+              const double log_sum_weights
+                  = stan::math::log_sum_exp(weights.log());
+              loo(o, 0) = stan::math::log_sum_exp(weights.log() + ll)
+                          - log_sum_weights;
+              loo(o, 1) = stan::math::log_sum_exp(ll) - log_num_draws
+                          - loo(o, 0);
+              loo(o, 2) = k;
+            }
+          });
+      std::vector<double> values(3);
+      for (size_t o = 0; o < size; ++o) {
+        for (int j = 0; j < 3; ++j)
+          values[j] = loo(o, j);
+        loo_writer(values);
+        elpd_loo(begin + o) = loo(o, 0);
+        p_loo += loo(o, 1);
+        if (loo(o, 2) > 0.7)
+          ++num_high_k;
+      }
+    }
+  } catch (const std::invalid_argument &e) {
+    logger.error(e.what());
+    return error_codes::DATAERR;
+  } catch (const std::exception &e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  std::stringstream summary;
+  summary << "PSIS-LOO over " << num_obs << " observations: elpd_loo = "
+          << elpd_loo.sum() << " (se "
+          << std::sqrt(num_obs * (elpd_loo - elpd_loo.mean()).square().mean())
+          << "), p_loo = " << p_loo << ", " << num_high_k
+          << " observations with Pareto k above 0.7.";
+  logger.info(summary);
+  return error_codes::OK;
+}
+
+}  // namespace services
+}  // namespace stan
+#endif
@@ -5,11 +5,19 @@
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/io/array_var_context.hpp>
+#include <stan/io/draws_source.hpp>
 #include <stan/math/prim.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/gq_writer.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_invoke.h>
+#include <tbb/task_arena.h>
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -188,6 +196,260 @@ int standalone_generate(const Model &model, const int num_chains,
   return error_any ? error_codes::DATAERR : error_codes::OK;
 }
 
+namespace internal {
+
+/**
+ * Return the pseudo random number generator for the draw with the
+ * specified index when generating quantities in blocks.  It depends only
+ * on the seed and the index, so the quantities generated for a draw do
+ * not depend on how draws are split between threads.
+ *
+ * @param[in] seed the random seed
+ * @param[in] draw index of the draw
+ * @return an stan::rng_t instance
+ * @throw std::invalid_argument if the index is not less than 2^31
+ */
+inline stan::rng_t create_gq_draw_rng(unsigned int seed, size_t draw) {
+  if (draw >= (size_t{1} << 31))
+    throw std::invalid_argument("Draw index must be less than 2^31");
+  return util::create_rng(seed, 1, static_cast<std::uint32_t>(draw), 0);
+}
+
+}  // namespace internal
+
+/**
+ * Given a source of draws from a fitted model, generate corresponding
+ * quantities of interest which are written to callback writer.  Each
+ * draw from the source is a row of values of the constrained parameters.
+ *
+ * Draws are read from the source in waves of a few blocks of at most
+ * <code>block_size</code> consecutive draws per thread, and the blocks of
+ * a wave are spread over the TBB threads, each block reusing its own
+ * buffers for every draw in it.  The next wave is read while a wave is
+ * processed, and a wave is written from the calling thread once it is
+ * processed, so at most two waves of draws and one of generated
+ * quantities are held at a time, however many draws the source has.
+ * The random number generator of each draw is made from the seed and
+ * the index of the draw, so the output is the same for any number of
+ * threads or block size, but differs from that of the serial overload.
+ * The generated quantities and the messages of the model are written in
+ * the order of the draws.  The interrupt, the logger and the writer are
+ * only called from the calling thread.
+ *
+ * Return code indicates success or type of error.
+ *
+ * @tparam Model model class
+ * @param[in] model instantiated model
+ * @param[in,out] draws source of draws of constrained parameters
+ * @param[in] seed seed to use for randomization
+ * @param[in] block_size number of draws processed together by a thread,
+ * which must be positive
+ * @param[in, out] interrupt called every iteration
+ * @param[in, out] logger logger to which to write warning and error messages
+ * @param[in, out] sample_writer writer to which draws are written
+ * @return error code
+ */
+template <class Model>
+int standalone_generate(const Model &model, io::draws_source &draws,
+                        unsigned int seed, size_t block_size,
+                        callbacks::interrupt &interrupt,
+                        callbacks::logger &logger,
+                        callbacks::writer &sample_writer) {
+  if (block_size == 0) {
+    logger.error("Block size of draws must be positive.");
+    return error_codes::CONFIG;
+  }
+
+  std::vector<std::string> p_names;
+  model.constrained_param_names(p_names, false, false);
+  std::vector<std::string> gq_names;
+  model.constrained_param_names(gq_names, false, true);
+  if (!(p_names.size() < gq_names.size())) {
+    logger.error("Model doesn't generate any quantities of interest.");
+    return error_codes::CONFIG;
+  }
+  if (p_names.size() != draws.num_cols()) {
+    std::stringstream msg;
+    msg << "Wrong number of parameter values in draws from fitted model.  ";
+    msg << "Expecting " << p_names.size() << " columns, ";
+    msg << "found " << draws.num_cols() << " columns.";
+    std::string msgstr = msg.str();
+    logger.error(msgstr);
+    return error_codes::DATAERR;
+  }
+
+  const size_t wave_size
+      = block_size * 4
+        * static_cast<size_t>(
+            std::max(1, tbb::this_task_arena::max_concurrency()));
+  Eigen::MatrixXd wave;
+  Eigen::MatrixXd next_wave;
+  size_t wave_rows = 0;
+  try {
+    wave_rows = draws.read(wave_size, wave);
+  } catch (const std::exception &e) {
+    logger.error(e.what());
+    return error_codes::DATAERR;
+  }
+  if (wave_rows == 0) {
+    logger.error("Empty set of draws from fitted model.");
+    return error_codes::DATAERR;
+  }
+  util::gq_writer writer(sample_writer, logger, p_names.size());
+  writer.write_gq_names(model);
+
+  // what became of a draw, in the order it is logged
+  enum class outcome { OK, WRITE_ERROR, UNCONSTRAIN_ERROR, FAILED };
+  const size_t num_params = p_names.size();
+  const size_t num_gqs = gq_names.size() - num_params;
+  const size_t buffer_size = std::min(wave_size, wave_rows);
+  std::vector<std::vector<double>> gq_values(buffer_size);
+  std::vector<std::string> model_msgs(buffer_size);
+  std::vector<std::string> errors(buffer_size);
+  std::vector<outcome> outcomes(buffer_size);
+
+  for (size_t wave_begin = 0; wave_rows > 0;) {
+    if (gq_values.size() < wave_rows) {
+      gq_values.resize(wave_rows);
+      model_msgs.resize(wave_rows);
+      errors.resize(wave_rows);
+      outcomes.resize(wave_rows);
+    }
+    auto generate = [&]() {
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, wave_rows, block_size),
+          [&](const tbb::blocked_range<size_t> &r) {
+            Eigen::VectorXd row(num_params);
+            Eigen::VectorXd unconstrained_params_r(num_params);
+            Eigen::VectorXd values;
+            std::stringstream msg;
+            for (size_t slot = r.begin(); slot != r.end(); ++slot) {
+              msg.str("");
+              msg.clear();
+              try {
+                row = wave.row(slot);
+                model.unconstrain_array(row, unconstrained_params_r, &msg);
+              } catch (const std::exception &e) {
+                model_msgs[slot] = msg.str();
+                errors[slot] = e.what();
+                outcomes[slot] = outcome::UNCONSTRAIN_ERROR;
+                continue;
+              }
+              msg.str("");
+              msg.clear();
+              outcomes[slot] = outcome::OK;
+              values.setConstant(std::numeric_limits<double>::quiet_NaN());
+              try {
+                stan::rng_t rng
+                    = internal::create_gq_draw_rng(seed, wave_begin + slot);
+                model.write_array(rng, unconstrained_params_r, values, false,
+                                  true, &msg);
+              } catch (const std::domain_error &e) {
+                errors[slot] = e.what();
+                outcomes[slot] = outcome::WRITE_ERROR;
+              } catch (const std::exception &e) {
+                errors[slot] = e.what();
+                outcomes[slot] = outcome::FAILED;
+              }
+              model_msgs[slot] = msg.str();
+              std::vector<double> &gqs = gq_values[slot];
+              gqs.assign(num_gqs, std::numeric_limits<double>::quiet_NaN());
+              const size_t num_written
+                  = values.size() > num_params
+                        ? std::min(num_gqs, values.size() - num_params)
+                        : 0;
+              std::copy(values.data() + num_params,
+                        values.data() + num_params + num_written,
+                        gqs.begin());
+            }
+          });
+    };
+    // the next wave is read while this one is generated
+    size_t next_rows = 0;
+    std::string read_error;
+    tbb::parallel_invoke(generate, [&]() {
+      try {
+        next_rows = draws.read(wave_size, next_wave);
+      } catch (const std::exception &e) {
+        read_error = e.what();
+      }
+    });
+
+    for (size_t slot = 0; slot < wave_rows; ++slot) {
+      if (outcomes[slot] == outcome::UNCONSTRAIN_ERROR) {
+        if (model_msgs[slot].length() > 0)
+          logger.error(model_msgs[slot]);
+        logger.error(errors[slot]);
+        return error_codes::DATAERR;
+      }
+      try {
+        interrupt();  // call out to interrupt and fail
+      } catch (const std::exception &e) {
+        logger.error(e.what());
+        return error_codes::SOFTWARE;
+      }
+      if (model_msgs[slot].length() > 0)
+        logger.info(model_msgs[slot]);
+      if (outcomes[slot] == outcome::FAILED) {
+        logger.info(errors[slot]);
+        logger.error(errors[slot]);
+        return error_codes::SOFTWARE;
+      }
+      if (outcomes[slot] == outcome::WRITE_ERROR)
+        logger.info(errors[slot]);
+      sample_writer(gq_values[slot]);
+    }
+    if (!read_error.empty()) {
+      logger.error(read_error);
+      return error_codes::DATAERR;
+    }
+    wave_begin += wave_rows;
+    wave.swap(next_wave);
+    wave_rows = next_rows;
+  }
+  return error_codes::OK;
+}
+
+/**
+ * Given a set of draws from a fitted model, generate corresponding
+ * quantities of interest which are written to callback writer.
+ * Matrix of draws consists of one row per draw, one column per parameter.
+ *
+ * Draws are processed in blocks of at most <code>block_size</code>
+ * consecutive rows spread over the TBB threads, as by the overload taking
+ * a <code>io::draws_source</code>, so the output is the same for any
+ * number of threads or block size, but differs from that of the serial
+ * overload.  The interrupt, the logger and the writer are only called
+ * from the calling thread.
+ *
+ * Return code indicates success or type of error.
+ *
+ * @tparam Model model class
+ * @param[in] model instantiated model
+ * @param[in] draws sequence of draws of constrained parameters
+ * @param[in] seed seed to use for randomization
+ * @param[in] block_size number of draws processed together by a thread,
+ * which must be positive
+ * @param[in, out] interrupt called every iteration
+ * @param[in, out] logger logger to which to write warning and error messages
+ * @param[in, out] sample_writer writer to which draws are written
+ * @return error code
+ */
+template <class Model>
+int standalone_generate(const Model &model, const Eigen::MatrixXd &draws,
+                        unsigned int seed, size_t block_size,
+                        callbacks::interrupt &interrupt,
+                        callbacks::logger &logger,
+                        callbacks::writer &sample_writer) {
+  if (draws.size() == 0) {
+    logger.error("Empty set of draws from fitted model.");
+    return error_codes::DATAERR;
+  }
+  io::matrix_draws_source source(draws);
+  return standalone_generate(model, source, seed, block_size, interrupt,
+                             logger, sample_writer);
+}
+
 /**
  * DEPRECATED: This function assumes dimensions are rectangular,
  * a restriction which the Stan language may soon relax.
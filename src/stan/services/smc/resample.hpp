@@ -0,0 +1,58 @@
+#ifndef STAN_SERVICES_SMC_RESAMPLE_HPP
+#define STAN_SERVICES_SMC_RESAMPLE_HPP
+
+#include <stan/math/prim.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace smc {
+
+/**
+ * Return the indices of the particles kept by systematic resampling:
+ * one uniform offset places as many evenly spaced points on the
+ * cumulative weights as there are particles, so each particle is copied
+ * the floor or the ceiling of its expected number of times.  It has a
+ * lower variance than multinomial resampling and draws a single number.
+ *
+ * @tparam RNG type of pseudo random number generator
+ * @param[in] weights unnormalized, nonnegative weights of the particles
+ * @param[in,out] rng pseudo random number generator
+ * @return index of the particle each new particle copies, in increasing
+ *   order
+ * @throw std::domain_error if a weight is negative or not finite or the
+ *   weights sum to zero
+ */
+template <class RNG>
+std::vector<Eigen::Index> systematic_resample(
+    const Eigen::Array<double, Eigen::Dynamic, 1>& weights, RNG& rng) {
+  const Eigen::Index N = weights.size();
+  if (!(weights >= 0).all() || !weights.allFinite())
+    throw std::domain_error(
+        "systematic_resample: weights must be nonnegative and finite");
+  const double total = weights.sum();
+  if (!(total > 0))
+    throw std::domain_error("systematic_resample: weights sum to zero");
+  boost::random::uniform_01<double> uniform;
+  const double offset = uniform(rng);
+  std::vector<Eigen::Index> indices;
+  indices.reserve(N);
+  double cumulative = 0;
+  Eigen::Index i = 0;
+  for (Eigen::Index n = 0; n < N; ++n) {
+    const double point = (n + offset) / N * total;
+    while (i + 1 < N && cumulative + weights.coeff(i) <= point)
+      cumulative += weights.coeff(i++);
+    indices.push_back(i);
+  }
+  return indices;
+}
+
+}  // namespace smc
+}  // namespace services
+}  // namespace stan
+
+#endif
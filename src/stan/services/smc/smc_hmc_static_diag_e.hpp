@@ -0,0 +1,285 @@
+#ifndef STAN_SERVICES_SMC_SMC_HMC_STATIC_DIAG_E_HPP
+#define STAN_SERVICES_SMC_SMC_HMC_STATIC_DIAG_E_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/hmc/static/diag_e_static_hmc.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stan/model/annealed_model.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/pathfinder/psis.hpp>
+#include <stan/services/smc/resample.hpp>
+#include <stan/services/smc/tempering.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace smc {
+
+/**
+ * Runs sequential Monte Carlo with adaptive tempering and static HMC
+ * moves with a diagonal Euclidean metric.
+ *
+ * The particles start as independent draws from a normal reference
+ * distribution with standard deviation <code>reference_scale</code> on
+ * the unconstrained scale and move along the path of
+ * <code>annealed_model</code> from the reference to the posterior.  At
+ * each stage:
+ *
+ * - the next inverse temperature is chosen so that the effective sample
+ *   size of the incremental weights is <code>target_ess</code> times the
+ *   number of particles,
+ * - the weights, Pareto smoothed by <code>psis_weights</code>, select the
+ *   particles kept by systematic resampling,
+ * - every particle makes <code>num_mutations</code> static HMC
+ *   transitions of <code>num_leapfrog</code> steps at the new inverse
+ *   temperature, all particles in parallel on the TBB threads, with the
+ *   variances of the particles as inverse metric, and
+ * - the step size is scaled by <code>exp(accept - delta)</code> for the
+ *   average acceptance probability <code>accept</code> of the stage.
+ *
+ * The particles at inverse temperature 1 are written as draws, with the
+ * log density of the model in the <code>lp__</code> column, preceded by
+ * comments with the number of stages and the estimate of the log
+ * marginal likelihood: the log of the normalizing constant of the model
+ * density on the unconstrained scale, constant terms and Jacobian
+ * included, which for a model whose density is the joint density of
+ * parameters and data is the log evidence.  It is computed from the raw
+ * incremental weights, which keeps it unbiased on the natural scale.
+ *
+ * Each particle uses the pseudo random number generator of chain id
+ * <code>chain + n</code> for its index <code>n</code> and the resampling
+ * that of <code>chain + num_particles</code>, so the output does not
+ * depend on the number of threads.
+ *
+ * @tparam Model Model class
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_particles number of particles, at least 2
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] chain chain id to advance the pseudo random number generator
+ * @param[in] reference_scale standard deviation of the reference
+ *   distribution
+ * @param[in] target_ess fraction of effective particles kept by each
+ *   stage, in (0, 1)
+ * @param[in] num_mutations number of HMC transitions per particle and
+ *   stage
+ * @param[in] stepsize initial step size of the HMC transitions
+ * @param[in] num_leapfrog number of leapfrog steps of each transition
+ * @param[in] delta acceptance probability the step size adapts to, in
+ *   (0, 1)
+ * @param[in] max_stages maximum number of stages
+ * @param[in] refresh Controls the output
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] sample_writer Writer for draws
+ * @param[out] log_marginal_likelihood if not null, set to the estimate of
+ *   the log marginal likelihood
+ * @return error_codes::OK if successful
+ */
+template <class Model>
+int smc_hmc_static_diag_e(
+    Model& model, unsigned int num_particles, unsigned int random_seed,
+    unsigned int chain, double reference_scale, double target_ess,
+    int num_mutations, double stepsize, int num_leapfrog, double delta,
+    int max_stages, int refresh, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& sample_writer,
+    double* log_marginal_likelihood = nullptr) {
+  using annealed_t = stan::model::annealed_model<Model>;
+  using sampler_t = stan::mcmc::diag_e_static_hmc<annealed_t, stan::rng_t>;
+  const Eigen::Index num_params = model.num_params_r();
+  const Eigen::Index N = num_particles;
+  constexpr double neg_inf = -std::numeric_limits<double>::infinity();
+  try {
+    if (num_particles < 2)
+      throw std::invalid_argument("num_particles must be at least 2");
+    if (!(target_ess > 0 && target_ess < 1))
+      throw std::invalid_argument("target_ess must be in (0, 1)");
+    if (num_mutations < 1 || num_leapfrog < 1 || max_stages < 1)
+      throw std::invalid_argument(
+          "num_mutations, num_leapfrog and max_stages must be positive");
+    if (!(stepsize > 0) || std::isinf(stepsize))
+      throw std::invalid_argument("stepsize must be positive and finite");
+    if (!(delta > 0 && delta < 1))
+      throw std::invalid_argument("delta must be in (0, 1)");
+    annealed_t annealed(model, reference_scale);
+
+    std::vector<stan::rng_t> rngs;
+    rngs.reserve(num_particles);
+    for (unsigned int n = 0; n < num_particles; ++n)
+      rngs.emplace_back(util::create_rng(random_seed, chain + n));
+    stan::rng_t resample_rng
+        = util::create_rng(random_seed, chain + num_particles);
+
+    Eigen::MatrixXd theta(num_params, N);
+    Eigen::Array<double, Eigen::Dynamic, 1> log_p(N);
+    Eigen::Array<double, Eigen::Dynamic, 1> log_q(N);
+    // log density of the model, negative infinity where it throws
+    auto evaluate = [&](Eigen::Index n) {
+      Eigen::VectorXd q = theta.col(n);
+      std::stringstream msg;
+      double lp = neg_inf;
+      try {
+        lp = model.template log_prob<false, true>(q, &msg);
+      } catch (const std::exception&) {
+      }
+      log_p.coeffRef(n) = std::isnan(lp) ? neg_inf : lp;
+      log_q.coeffRef(n) = annealed.template reference_log_prob<false>(q);
+    };
+
+    try {
+      auto start = std::chrono::steady_clock::now();
+      tbb::parallel_for(tbb::blocked_range<Eigen::Index>(0, N),
+                        [&](const tbb::blocked_range<Eigen::Index>& r) {
+                          boost::normal_distribution<double> normal(
+                              0, reference_scale);
+                          for (Eigen::Index n = r.begin(); n != r.end(); ++n) {
+                            for (Eigen::Index d = 0; d < num_params; ++d)
+                              theta.coeffRef(d, n) = normal(rngs[n]);
+                            evaluate(n);
+                          }
+                        });
+
+      const Eigen::Index tail_len = static_cast<Eigen::Index>(
+          std::min(0.2 * N, 3 * std::sqrt(static_cast<double>(N))));
+      Eigen::VectorXd inv_metric
+          = Eigen::VectorXd::Constant(num_params,
+                                      reference_scale * reference_scale);
+      Eigen::Array<double, Eigen::Dynamic, 1> accept(N);
+      double inv_temperature = 0;
+      double log_z = 0;
+      int stage = 0;
+      while (inv_temperature < 1) {
+        if (stage == max_stages)
+          throw std::domain_error(
+              "Sequential Monte Carlo did not reach inverse temperature 1 in "
+              + std::to_string(max_stages) + " stages");
+        ++stage;
+        interrupt();
+
+        const Eigen::Array<double, Eigen::Dynamic, 1> log_ratios
+            = log_p - log_q;
+        const double next
+            = next_inv_temperature(log_ratios, inv_temperature, target_ess);
+        const Eigen::Array<double, Eigen::Dynamic, 1> log_weights
+            = log_ratios.unaryExpr([&](double r) {
+                return std::isnan(r) ? neg_inf : (next - inv_temperature) * r;
+              });
+        log_z += stan::math::log_sum_exp(log_weights) - std::log(N);
+        const Eigen::Array<double, Eigen::Dynamic, 1> weights
+            = psis::psis_weights(log_weights, tail_len, logger);
+        const std::vector<Eigen::Index> parents
+            = systematic_resample(weights, resample_rng);
+        const Eigen::MatrixXd previous = theta;
+        const Eigen::Array<double, Eigen::Dynamic, 1> previous_log_p = log_p;
+        const Eigen::Array<double, Eigen::Dynamic, 1> previous_log_q = log_q;
+        for (Eigen::Index n = 0; n < N; ++n) {
+          theta.col(n) = previous.col(parents[n]);
+          log_p.coeffRef(n) = previous_log_p.coeff(parents[n]);
+          log_q.coeffRef(n) = previous_log_q.coeff(parents[n]);
+        }
+        inv_temperature = next;
+        annealed.set_inv_temperature(inv_temperature);
+
+        // the spread of the particles sets the inverse metric, unless
+        // resampling collapsed it
+        const Eigen::VectorXd mean = theta.rowwise().mean();
+        const Eigen::VectorXd var
+            = (theta.colwise() - mean).array().square().rowwise().sum()
+              / (N - 1);
+        for (Eigen::Index d = 0; d < num_params; ++d)
+          if (var.coeff(d) > 0 && std::isfinite(var.coeff(d)))
+            inv_metric.coeffRef(d) = var.coeff(d);
+
+        tbb::parallel_for(
+            tbb::blocked_range<Eigen::Index>(0, N),
+            [&](const tbb::blocked_range<Eigen::Index>& r) {
+              for (Eigen::Index n = r.begin(); n != r.end(); ++n) {
+                sampler_t sampler(annealed, rngs[n]);
+                sampler.set_metric(inv_metric);
+                sampler.set_nominal_stepsize_and_L(stepsize, num_leapfrog);
+                stan::mcmc::sample s(theta.col(n), 0, 0);
+                double sum_accept = 0;
+                for (int m = 0; m < num_mutations; ++m) {
+                  s = sampler.transition(s, logger);
+                  sum_accept += s.accept_stat();
+                }
+                theta.col(n) = s.cont_params();
+                accept.coeffRef(n) = sum_accept / num_mutations;
+                evaluate(n);
+              }
+            });
+
+        const double mean_accept = accept.mean();
+        if (refresh > 0 && (stage % refresh == 0 || inv_temperature == 1)) {
+          std::stringstream msg;
+          msg << "Stage " << stage << ": inverse temperature "
+              << inv_temperature << ", step size " << stepsize
+              << ", acceptance " << mean_accept;
+          logger.info(msg);
+        }
+        stepsize *= std::exp(mean_accept - delta);
+      }
+      auto end = std::chrono::steady_clock::now();
+      double delta_t
+          = std::chrono::duration_cast<std::chrono::milliseconds>(end - start)
+                .count()
+            / 1000.0;
+
+      std::vector<std::string> names;
+      names.push_back("lp__");
+      model.constrained_param_names(names, true, true);
+      sample_writer(names);
+      std::stringstream stages;
+      stages << "Sequential Monte Carlo stages: " << stage;
+      sample_writer(stages.str());
+      std::stringstream evidence;
+      evidence << "Log marginal likelihood estimate: " << log_z;
+      sample_writer(evidence.str());
+      logger.info(evidence);
+      std::vector<double> values;
+      for (Eigen::Index n = 0; n < N; ++n) {
+        Eigen::VectorXd q = theta.col(n);
+        Eigen::VectorXd constrained;
+        std::stringstream msg;
+        model.write_array(rngs[n], q, constrained, true, true, &msg);
+        if (msg.str().length() > 0)
+          logger.info(msg);
+        values.clear();
+        values.push_back(log_p.coeff(n));
+        values.insert(values.end(), constrained.data(),
+                      constrained.data() + constrained.size());
+        sample_writer(values);
+      }
+      std::stringstream timing;
+      timing << "Elapsed Time: " << delta_t << " seconds (Total)";
+      sample_writer(timing.str());
+      logger.info(timing);
+      if (log_marginal_likelihood)
+        *log_marginal_likelihood = log_z;
+    } catch (const std::exception& e) {
+      logger.error(e.what());
+      return error_codes::SOFTWARE;
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
+}  // namespace smc
+}  // namespace services
+}  // namespace stan
+#endif
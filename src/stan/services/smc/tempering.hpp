@@ -0,0 +1,103 @@
+#ifndef STAN_SERVICES_SMC_TEMPERING_HPP
+#define STAN_SERVICES_SMC_TEMPERING_HPP
+
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace stan {
+namespace services {
+namespace smc {
+
+/**
+ * Return the effective sample size of importance weights,
+ * <code>(sum w)^2 / sum w^2</code>, computed from their logarithms.
+ * Weights with a log of negative infinity or NaN count as zero.
+ *
+ * @param[in] log_weights logarithms of the unnormalized weights
+ * @return effective sample size, or zero if every weight is zero
+ */
+inline double effective_sample_size(
+    const Eigen::Array<double, Eigen::Dynamic, 1>& log_weights) {
+  double max_log = -std::numeric_limits<double>::infinity();
+  for (Eigen::Index i = 0; i < log_weights.size(); ++i)
+    if (log_weights.coeff(i) > max_log)
+      max_log = log_weights.coeff(i);
+  if (!std::isfinite(max_log))
+    return 0;
+  double sum = 0;
+  double sum_sq = 0;
+  for (Eigen::Index i = 0; i < log_weights.size(); ++i) {
+    if (!(log_weights.coeff(i) > -std::numeric_limits<double>::infinity()))
+      continue;
+    const double w = std::exp(log_weights.coeff(i) - max_log);
+    sum += w;
+    sum_sq += w * w;
+  }
+  return sum * sum / sum_sq;
+}
+
+/**
+ * Return the next inverse temperature of adaptive tempering: the largest
+ * one, up to 1, at which the incremental weights
+ * <code>exp((next - inv_temperature) * log_ratios)</code> of equally
+ * weighted particles keep an effective sample size of
+ * <code>target_ess</code> times the number of particles with a finite
+ * log ratio.  It is found by bisection, the effective sample size
+ * decreasing as the step grows.
+ *
+ * @param[in] log_ratios log density of the target minus that of the
+ *   reference at each particle
+ * @param[in] inv_temperature current inverse temperature, in [0, 1)
+ * @param[in] target_ess fraction of the particles to keep, in (0, 1)
+ * @return next inverse temperature, greater than the current one
+ * @throw std::domain_error if no log ratio is finite
+ * @throw std::invalid_argument if an argument is out of range
+ */
+inline double next_inv_temperature(
+    const Eigen::Array<double, Eigen::Dynamic, 1>& log_ratios,
+    double inv_temperature, double target_ess) {
+  if (!(inv_temperature >= 0 && inv_temperature < 1))
+    throw std::invalid_argument(
+        "next_inv_temperature: inverse temperature must be in [0, 1)");
+  if (!(target_ess > 0 && target_ess < 1))
+    throw std::invalid_argument(
+        "next_inv_temperature: target_ess must be in (0, 1)");
+  Eigen::Index num_finite = 0;
+  for (Eigen::Index i = 0; i < log_ratios.size(); ++i)
+    num_finite += std::isfinite(log_ratios.coeff(i));
+  if (num_finite == 0)
+    throw std::domain_error(
+        "next_inv_temperature: the log density is not finite at any "
+        "particle");
+  const double target = target_ess * num_finite;
+  auto sanitized = [&](double step) {
+    return log_ratios.unaryExpr([step](double r) {
+      return std::isnan(r) ? -std::numeric_limits<double>::infinity()
+                           : step * r;
+    });
+  };
+  double high = 1 - inv_temperature;
+  Eigen::Array<double, Eigen::Dynamic, 1> log_weights = sanitized(high);
+  if (effective_sample_size(log_weights) >= target)
+    return 1;
+  double low = 0;
+  for (int n = 0; n < 60 && high - low > 1e-12 * high; ++n) {
+    const double mid = 0.5 * (low + high);
+    log_weights = sanitized(mid);
+    if (effective_sample_size(log_weights) >= target)
+      low = mid;
+    else
+      high = mid;
+  }
+  // never stall on a step that rounds to nothing
+  return std::min(1.0, inv_temperature + std::max(low, 1e-12));
+}
+
+}  // namespace smc
+}  // namespace services
+}  // namespace stan
+
+#endif
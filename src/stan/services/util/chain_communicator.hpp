@@ -0,0 +1,129 @@
+#ifndef STAN_SERVICES_UTIL_CHAIN_COMMUNICATOR_HPP
+#define STAN_SERVICES_UTIL_CHAIN_COMMUNICATOR_HPP
+
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>chain_communicator</code> connects the chains of a run split
+ * across several processes, each running its share of the chains with
+ * the usual multi-chain services and writing them with its own writers.
+ * The services only use it to combine the statistics of the chains of
+ * every process, always in the same order and at the same points of the
+ * run, so every process must make the same calls.
+ *
+ * This base class is a single process; <code>mpi_chain_communicator</code>
+ * implements it with MPI when Stan is built with <code>STAN_MPI</code>.
+ */
+class chain_communicator {
+ public:
+  virtual ~chain_communicator() {}
+
+  /**
+   * Return the index of this process, from 0.
+   */
+  virtual int rank() const { return 0; }
+
+  /**
+   * Return the number of processes.
+   */
+  virtual int size() const { return 1; }
+
+  /**
+   * Return the values of every process, concatenated in the order of
+   * their ranks.  Every process must pass the same number of values.
+   *
+   * @param[in] values values of this process
+   * @return values of all processes
+   */
+  virtual std::vector<double> all_gather(const std::vector<double>& values) {
+    return values;
+  }
+};
+
+/**
+ * Return the index of the first chain of a process and its number of
+ * chains when the chains are split as evenly as possible across the
+ * processes, the first processes taking one more chain each when they
+ * do not divide evenly.  A process with chains <code>first</code> to
+ * <code>first + count - 1</code> runs them with chain ids from
+ * <code>init_chain_id + first</code>.
+ *
+ * @param[in] num_chains total number of chains
+ * @param[in] rank index of the process
+ * @param[in] size number of processes
+ * @return first chain and number of chains of the process
+ * @throw std::invalid_argument if the rank is not in [0, size)
+ */
+inline std::pair<size_t, size_t> local_chains(size_t num_chains, int rank,
+                                              int size) {
+  if (size < 1 || rank < 0 || rank >= size)
+    throw std::invalid_argument(
+        "local_chains: rank must be in [0, size) for a positive size");
+  const size_t base = num_chains / size;
+  const size_t extra = num_chains % size;
+  const size_t r = rank;
+  const size_t first = r * base + std::min(r, extra);
+  return {first, base + (r < extra ? 1 : 0)};
+}
+
+/**
+ * Replace the count, mean and sum of squared deviations of draws of this
+ * process with those of the draws of every process, combined in the
+ * order of their ranks so that every process finds the same moments.
+ *
+ * @tparam M2 type of the sum of squared deviations, a vector for
+ *   variances or a square matrix for covariances
+ * @param[in,out] communicator processes to combine the moments of
+ * @param[in,out] n number of draws
+ * @param[in,out] mean mean of the draws
+ * @param[in,out] m2 sum of squared deviations from the mean
+ */
+template <typename M2>
+void combine_moments(chain_communicator& communicator, double& n,
+                     Eigen::VectorXd& mean, M2& m2) {
+  if (communicator.size() == 1)
+    return;
+  const Eigen::Index dim = mean.size();
+  const Eigen::Index stride = 1 + dim + m2.size();
+  std::vector<double> local(stride);
+  local[0] = n;
+  Eigen::Map<Eigen::VectorXd>(local.data() + 1, dim) = mean;
+  Eigen::Map<Eigen::VectorXd>(local.data() + 1 + dim, m2.size())
+      = Eigen::Map<const Eigen::VectorXd>(m2.data(), m2.size());
+  const std::vector<double> all = communicator.all_gather(local);
+
+  n = 0;
+  mean.setZero();
+  m2.setZero();
+  for (int r = 0; r < communicator.size(); ++r) {
+    const double* values = all.data() + r * stride;
+    const double n_r = values[0];
+    if (n_r == 0)
+      continue;
+    const double n_prev = n;
+    n += n_r;
+    const Eigen::VectorXd delta
+        = Eigen::Map<const Eigen::VectorXd>(values + 1, dim) - mean;
+    mean += delta * (n_r / n);
+    M2 m2_r = Eigen::Map<const M2>(values + 1 + dim, m2.rows(), m2.cols());
+    if constexpr (M2::ColsAtCompileTime == 1)
+      m2_r += delta.array().square().matrix() * (n_prev * n_r / n);
+    else
+      m2_r += (delta * delta.transpose()) * (n_prev * n_r / n);
+    m2 += m2_r;
+  }
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,213 @@
+#ifndef STAN_SERVICES_UTIL_CHAIN_PLACEMENT_HPP
+#define STAN_SERVICES_UTIL_CHAIN_PLACEMENT_HPP
+
+#include <stan/services/util/chain_communicator.hpp>
+#include <tbb/info.h>
+#include <tbb/task_arena.h>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>chain_placement</code> places the chains of a run on the NUMA
+ * nodes of the machine: the chains are split into contiguous groups, one
+ * per node, and each group gets a TBB arena whose threads are bound to
+ * its node.  A chain run in its arena then allocates its autodiff memory,
+ * and any state it creates, on the threads of its node, so its memory is
+ * local to the cores running it.
+ *
+ * Each chain is given <code>threads_per_chain</code> threads for its own
+ * parallel work, such as <code>reduce_sum</code> in the model or the
+ * speculative NUTS samplers.  An arena has the threads of its node, but
+ * no more than its chains can use, and runs at most
+ * <code>num_slots</code> of its chains at once, so that chains times
+ * threads per chain never exceed the threads of the node.
+ *
+ * The scheduler of the multi-chain services uses a placement given with
+ * <code>chain_scheduler::set_placement</code>.  On a machine with a
+ * single node, or when TBB was built without hwloc and does not see the
+ * nodes, the placement is a single arena with the threads of the
+ * machine, which still bounds the within-chain threads.
+ */
+class chain_placement {
+ public:
+  /**
+   * Place the chains on every NUMA node of the machine.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] threads_per_chain number of threads each chain uses for
+   *   its own parallel work
+   * @throw std::invalid_argument if the number of threads per chain is
+   *   not positive
+   */
+  explicit chain_placement(size_t num_chains, int threads_per_chain = 1)
+      : chain_placement(num_chains, threads_per_chain,
+                        tbb::info::numa_nodes()) {}
+
+  /**
+   * Place the chains on the specified NUMA nodes, each with the threads
+   * TBB finds on it.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] threads_per_chain number of threads each chain uses for
+   *   its own parallel work
+   * @param[in] nodes NUMA nodes to place the chains on, as returned by
+   *   <code>tbb::info::numa_nodes()</code>
+   * @throw std::invalid_argument if the number of threads per chain is
+   *   not positive or there is no node
+   */
+  chain_placement(size_t num_chains, int threads_per_chain,
+                  const std::vector<tbb::numa_node_id>& nodes)
+      : chain_placement(num_chains, threads_per_chain, nodes,
+                        default_concurrency(nodes)) {}
+
+  /**
+   * Place the chains on the specified NUMA nodes with the specified
+   * number of threads on each.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] threads_per_chain number of threads each chain uses for
+   *   its own parallel work
+   * @param[in] nodes NUMA nodes to place the chains on
+   * @param[in] node_concurrency number of threads of each node
+   * @throw std::invalid_argument if the number of threads per chain is
+   *   not positive, there is no node, or there is not a positive number
+   *   of threads per node
+   */
+  chain_placement(size_t num_chains, int threads_per_chain,
+                  const std::vector<tbb::numa_node_id>& nodes,
+                  const std::vector<int>& node_concurrency)
+      : threads_per_chain_(threads_per_chain),
+        nodes_(nodes),
+        chain_node_(num_chains) {
+    if (threads_per_chain < 1)
+      throw std::invalid_argument(
+          "chain_placement: threads_per_chain must be positive");
+    if (nodes.empty())
+      throw std::invalid_argument(
+          "chain_placement: at least one NUMA node is required");
+    if (node_concurrency.size() != nodes.size()
+        || *std::min_element(node_concurrency.begin(), node_concurrency.end())
+               < 1)
+      throw std::invalid_argument(
+          "chain_placement: a positive number of threads is required for "
+          "each NUMA node");
+    const int num_nodes = nodes.size();
+    for (int k = 0; k < num_nodes; ++k) {
+      const std::pair<size_t, size_t> chains
+          = local_chains(num_chains, k, num_nodes);
+      for (size_t i = 0; i < chains.second; ++i)
+        chain_node_[chains.first + i] = k;
+      // an arena needs no more threads than its chains use
+      const size_t wanted = std::max<size_t>(chains.second, 1)
+                            * static_cast<size_t>(threads_per_chain);
+      const int concurrency = static_cast<int>(
+          std::min<size_t>(node_concurrency[k], wanted));
+      concurrency_.push_back(concurrency);
+      arenas_.emplace_back(new tbb::task_arena(
+          tbb::task_arena::constraints(nodes[k], concurrency)));
+      arenas_.back()->initialize();
+    }
+  }
+
+  size_t num_chains() const noexcept { return chain_node_.size(); }
+
+  size_t num_nodes() const noexcept { return nodes_.size(); }
+
+  int threads_per_chain() const noexcept { return threads_per_chain_; }
+
+  /**
+   * Return the index of the node a chain is placed on, in
+   * <code>[0, num_nodes())</code>.
+   *
+   * @param[in] chain index of the chain
+   */
+  size_t node_of(size_t chain) const { return chain_node_.at(chain); }
+
+  /**
+   * Return the TBB id of a node.
+   *
+   * @param[in] node index of the node
+   */
+  tbb::numa_node_id numa_id(size_t node) const { return nodes_.at(node); }
+
+  /**
+   * Return the number of threads of the arena of a node.
+   *
+   * @param[in] node index of the node
+   */
+  int concurrency(size_t node) const { return concurrency_.at(node); }
+
+  /**
+   * Return the number of chains of a node that may run at once, so that
+   * their threads fit in its arena; at least one.
+   *
+   * @param[in] node index of the node
+   */
+  size_t num_slots(size_t node) const {
+    return std::max(1, concurrency(node) / threads_per_chain_);
+  }
+
+  /**
+   * Return the arena of a node.
+   *
+   * @param[in] node index of the node
+   */
+  tbb::task_arena& arena(size_t node) { return *arenas_.at(node); }
+
+  /**
+   * Run a function in the arena of the node of a chain and return its
+   * result.  The thread running it is bound to the node while in the
+   * arena, so the memory the function first writes, such as the state of
+   * the chain or a copy of the model data for the chains of the node, is
+   * allocated on that node.
+   *
+   * @tparam F type of the function
+   * @param[in] chain index of the chain
+   * @param[in] f function to run
+   */
+  template <typename F>
+  auto execute(size_t chain, F&& f) -> decltype(f()) {
+    return arena(node_of(chain)).execute(std::forward<F>(f));
+  }
+
+ private:
+  int threads_per_chain_;
+  std::vector<tbb::numa_node_id> nodes_;
+  std::vector<size_t> chain_node_;
+  std::vector<int> concurrency_;
+  std::vector<std::unique_ptr<tbb::task_arena>> arenas_;
+
+  static std::vector<int> default_concurrency(
+      const std::vector<tbb::numa_node_id>& nodes) {
+    std::vector<int> concurrency;
+    for (tbb::numa_node_id node : nodes)
+      concurrency.push_back(tbb::info::default_concurrency(node));
+    return concurrency;
+  }
+};
+
+/**
+ * Return the number of chains that can run at once with the specified
+ * number of threads each for their own parallel work, without running
+ * more threads than TBB has.
+ *
+ * @param[in] threads_per_chain number of threads each chain uses
+ * @return number of concurrent chains, at least one
+ */
+inline size_t max_concurrent_chains(int threads_per_chain) {
+  return std::max(1, tbb::this_task_arena::max_concurrency()
+                         / std::max(1, threads_per_chain));
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,263 @@
+#ifndef STAN_SERVICES_UTIL_CHAIN_SCHEDULER_HPP
+#define STAN_SERVICES_UTIL_CHAIN_SCHEDULER_HPP
+
+#include <stan/services/util/chain_placement.hpp>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Progress of one chain run by a <code>chain_scheduler</code>.
+ */
+struct chain_progress {
+  /// id of the chain, used in output
+  size_t chain_id = 0;
+  /// number of transitions generated so far, warmup included
+  int iteration = 0;
+  /// number of transitions of the whole run, warmup included
+  int num_iterations = 0;
+  /// true while the chain is warming up
+  bool warmup = true;
+  /// true once the chain has written all its output
+  bool finished = false;
+  /// seconds spent running the chain
+  double elapsed = 0;
+};
+
+/**
+ * Runs chains as resumable tasks, each advanced a block of iterations at
+ * a time, on the TBB threads.
+ *
+ * Whenever a thread finishes a block it runs the next block of the ready
+ * chain with the highest priority, and among those of the chain that is
+ * furthest behind, so with more chains than threads the chains finish
+ * together rather than in the order they started.  A thread that finds
+ * no ready chain, because the others are all running or done, leaves
+ * the scheduler, which frees it to take the parallel work inside the
+ * chains still running, such as the tasks of the speculative NUTS
+ * samplers or of <code>reduce_sum</code> in the model.  A slow chain then
+ * no longer leaves the threads of the finished ones idle.
+ *
+ * A task must provide
+ * <code>int run_block(int max_iterations)</code>, which generates at most
+ * that many transitions, <code>bool finished() const</code> and
+ * <code>chain_progress progress() const</code>.  Each task is run by one
+ * thread at a time.
+ *
+ * With a <code>chain_placement</code>, the blocks of each chain run in
+ * the arena of its NUMA node, on the threads of that node only, and at
+ * most <code>num_slots</code> chains of a node run at once, which leaves
+ * each its threads for its own parallel work.
+ */
+class chain_scheduler {
+ public:
+  /**
+   * Construct a scheduler running the specified number of iterations of
+   * a chain at a time.
+   *
+   * @param block_size number of iterations per block
+   * @throw std::invalid_argument if the block size is not positive
+   */
+  explicit chain_scheduler(int block_size = 50) : block_size_(block_size) {
+    if (block_size < 1)
+      throw std::invalid_argument("Block size must be positive");
+  }
+
+  int block_size() const noexcept { return block_size_; }
+
+  /**
+   * Set the priority of a chain; chains with higher priorities are run
+   * first when there are more ready chains than threads.  All chains
+   * have priority zero by default.
+   *
+   * @param chain index of the chain in the tasks passed to
+   * <code>run</code>
+   * @param priority priority of the chain
+   */
+  void set_priority(size_t chain, int priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (priorities_.size() <= chain)
+      priorities_.resize(chain + 1, 0);
+    priorities_[chain] = priority;
+  }
+
+  int priority(size_t chain) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chain < priorities_.size() ? priorities_[chain] : 0;
+  }
+
+  /**
+   * Set the placement of the chains on NUMA nodes used by the following
+   * runs, or none with a null pointer.  The placement must outlive those
+   * runs and have as many chains as the tasks given to them.
+   *
+   * @param placement placement of the chains
+   */
+  void set_placement(chain_placement* placement) noexcept {
+    placement_ = placement;
+  }
+
+  chain_placement* placement() const noexcept { return placement_; }
+
+  /**
+   * Return the progress of every chain of the current or last run.  This
+   * may be called from another thread while the chains run.
+   */
+  std::vector<chain_progress> progress() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return progress_;
+  }
+
+  /**
+   * Run the tasks until all are finished, calling the callback with the
+   * progress of a chain after each of its blocks.  The callback is called
+   * while the scheduler is locked, so it need not be thread safe but
+   * should return quickly.
+   *
+   * If a task throws, no further blocks are started and the first
+   * exception is rethrown once the running blocks are done.
+   *
+   * @tparam Task type of the chain tasks
+   * @tparam F type of the callback, callable as
+   * <code>callback(const chain_progress&)</code>
+   * @param[in,out] tasks chain tasks
+   * @param[in] callback callback for the progress of the chains
+   * @throw std::invalid_argument if the placement is not for as many
+   * chains as there are tasks
+   */
+  template <typename Task, typename F>
+  void run(std::vector<Task>& tasks, const F& callback) {
+    const size_t num_chains = tasks.size();
+    if (placement_ && placement_->num_chains() != num_chains)
+      throw std::invalid_argument(
+          "The chain placement must have one chain per task");
+    std::vector<size_t> ready;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (priorities_.size() < num_chains)
+        priorities_.resize(num_chains, 0);
+      progress_.clear();
+      for (size_t i = 0; i < num_chains; ++i) {
+        progress_.push_back(tasks[i].progress());
+        if (!tasks[i].finished())
+          ready.push_back(i);
+      }
+    }
+    std::exception_ptr error;
+
+    // the ready chain to run next on a node, or on any node without a
+    // placement, or none; the caller must hold the lock
+    auto next_chain = [&](size_t node) {
+      auto behind = [&](size_t a, size_t b) {
+        if (priorities_[a] != priorities_[b])
+          return priorities_[a] > priorities_[b];
+        const chain_progress& p_a = progress_[a];
+        const chain_progress& p_b = progress_[b];
+        // compare the completed fractions without dividing
+        const double done_a = static_cast<double>(p_a.iteration)
+                              * std::max(p_b.num_iterations, 1);
+        const double done_b = static_cast<double>(p_b.iteration)
+                              * std::max(p_a.num_iterations, 1);
+        if (done_a != done_b)
+          return done_a < done_b;
+        return a < b;
+      };
+      auto next = ready.end();
+      for (auto it = ready.begin(); it != ready.end(); ++it) {
+        if (placement_ && placement_->node_of(*it) != node)
+          continue;
+        if (next == ready.end() || behind(*it, *next))
+          next = it;
+      }
+      return next;
+    };
+
+    auto worker = [&](size_t node) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (!error) {
+        auto next = next_chain(node);
+        if (next == ready.end())
+          break;
+        const size_t chain = *next;
+        ready.erase(next);
+        lock.unlock();
+        bool failed = false;
+        try {
+          tasks[chain].run_block(block_size_);
+        } catch (...) {
+          failed = true;
+          lock.lock();
+          if (!error)
+            error = std::current_exception();
+        }
+        if (!failed)
+          lock.lock();
+        progress_[chain] = tasks[chain].progress();
+        if (!failed && !tasks[chain].finished())
+          ready.push_back(chain);
+        callback(progress_[chain]);
+      }
+    };
+
+    if (placement_) {
+      // the workers of each node are started and waited for in its arena
+      const size_t num_nodes = placement_->num_nodes();
+      std::vector<tbb::task_group> workers(num_nodes);
+      for (size_t k = 0; k < num_nodes; ++k) {
+        size_t num_ready = 0;
+        for (size_t chain : ready)
+          num_ready += placement_->node_of(chain) == k;
+        const size_t num_workers
+            = std::min(num_ready, placement_->num_slots(k));
+        placement_->arena(k).execute([&, k, num_workers]() {
+          for (size_t i = 0; i < num_workers; ++i)
+            workers[k].run([&, k]() { worker(k); });
+        });
+      }
+      for (size_t k = 0; k < num_nodes; ++k)
+        placement_->arena(k).execute([&, k]() { workers[k].wait(); });
+    } else {
+      const size_t num_workers = std::min<size_t>(
+          num_chains, std::max(1, tbb::this_task_arena::max_concurrency()));
+      tbb::task_group workers;
+      for (size_t i = 1; i < num_workers; ++i)
+        workers.run([&]() { worker(0); });
+      worker(0);
+      workers.wait();
+    }
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  /**
+   * Run the tasks until all are finished.
+   *
+   * @tparam Task type of the chain tasks
+   * @param[in,out] tasks chain tasks
+   */
+  template <typename Task>
+  void run(std::vector<Task>& tasks) {
+    run(tasks, [](const chain_progress&) {});
+  }
+
+ private:
+  int block_size_;
+  std::vector<int> priorities_;
+  std::vector<chain_progress> progress_;
+  chain_placement* placement_ = nullptr;
+  mutable std::mutex mutex_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
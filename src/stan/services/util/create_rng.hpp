@@ -2,6 +2,8 @@
 #define STAN_SERVICES_UTIL_CREATE_RNG_HPP
 
 #include <boost/random/mixmax.hpp>
+#include <cstdint>
+#include <stdexcept>
 
 namespace stan {
 
@@ -33,6 +35,37 @@ inline rng_t create_rng(unsigned int seed, unsigned int chain) {
   return rng;
 }
 
+/**
+ * Creates a pseudo random number generator for one task of one iteration
+ * of a chain, for work within a chain that runs in parallel.  Its stream
+ * depends only on the four arguments, so the draws of each task do not
+ * depend on the order in which the tasks run or on the number of threads
+ * running them, and the task can be rerun to get the same draws.
+ *
+ * The four arguments are the four 32 bit stream ids of the generator,
+ * which guarantees that distinct arguments give streams that do not
+ * overlap.  The top bit of the first id is set, so these streams are
+ * also distinct from those of <code>create_rng(seed, chain)</code>,
+ * which leaves the iteration 31 bits.  Seeding skips the generator ahead
+ * to its stream, which costs far more than a draw, so a task should
+ * create its generator once rather than per draw.
+ *
+ * @param[in] seed the random seed
+ * @param[in] chain the chain id
+ * @param[in] iteration the iteration of the chain, or any other index of
+ * the parallel region the task belongs to
+ * @param[in] task the index of the task within that region
+ * @return an stan::rng_t instance
+ * @throw std::invalid_argument if the iteration is not less than 2^31
+ */
+inline rng_t create_rng(unsigned int seed, unsigned int chain,
+                        std::uint32_t iteration, std::uint32_t task) {
+  constexpr std::uint32_t task_stream = 0x80000000u;
+  if (iteration & task_stream)
+    throw std::invalid_argument("Iteration must be less than 2^31");
+  return rng_t(task_stream | iteration, task, seed, chain);
+}
+
 }  // namespace util
 }  // namespace services
 }  // namespace stan
@@ -0,0 +1,189 @@
+#ifndef STAN_SERVICES_UTIL_DIAGNOSTIC_OUTPUT_HPP
+#define STAN_SERVICES_UTIL_DIAGNOSTIC_OUTPUT_HPP
+
+#include <stan/services/util/output_selection.hpp>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * The columns of the diagnostic output of a chain chosen by a
+ * <code>diagnostic_output</code> from the full diagnostic names, and how
+ * to compute them from the full diagnostic values.
+ */
+struct diagnostic_columns {
+  /** Columns of the full values written, in order. */
+  std::vector<size_t> columns;
+  /** Whether the norms of the momentum and gradient are appended. */
+  bool norms = false;
+  /** First column of the momentum in the full values. */
+  size_t p_begin = 0;
+  /** First column of the gradient in the full values. */
+  size_t g_begin = 0;
+  /** Number of unconstrained parameters. */
+  size_t num_params = 0;
+
+  /**
+   * Write the chosen values of the full diagnostic values.
+   *
+   * @param[in] values full diagnostic values
+   * @param[out] out chosen values
+   */
+  void apply(const std::vector<double>& values,
+             std::vector<double>& out) const {
+    out.clear();
+    for (size_t c : columns)
+      out.push_back(values[c]);
+    if (!norms)
+      return;
+    double p_norm = 0;
+    double g_norm = 0;
+    for (size_t i = 0; i < num_params; ++i) {
+      p_norm += values[p_begin + i] * values[p_begin + i];
+      g_norm += values[g_begin + i] * values[g_begin + i];
+    }
+    out.push_back(std::sqrt(p_norm));
+    out.push_back(std::sqrt(g_norm));
+  }
+};
+
+/**
+ * <code>diagnostic_output</code> reduces the diagnostic output of an MCMC
+ * chain, which for Hamiltonian samplers is the unconstrained position,
+ * momentum and gradient of every draw, three columns per parameter, so
+ * that it stays affordable for large models.  It can
+ *
+ * - write only every <code>thin()</code>-th diagnostic row, counted over
+ *   the draws that are saved,
+ * - write the position, momentum and gradient of only the unconstrained
+ *   parameters selected by patterns, matched as by
+ *   <code>output_selection</code> against names such as
+ *   <code>theta.2</code>, and
+ * - write, in summary mode, the Euclidean norms of the momentum and the
+ *   gradient, as the columns <code>p_norm__</code> and
+ *   <code>g_norm__</code>, instead of any coordinates.
+ *
+ * The sample and sampler parameters, such as <code>lp__</code> and
+ * <code>energy__</code>, and any further diagnostics of the sampler are
+ * always written.  For a compact encoding, the diagnostic writer can be a
+ * <code>callbacks::binary_writer</code>.
+ *
+ * A default constructed <code>diagnostic_output</code> writes everything.
+ * It is passed by pointer to <code>mcmc_writer</code> and the samplers
+ * running it, and may be shared by chains.
+ */
+class diagnostic_output {
+ public:
+  /**
+   * Write every <code>every</code>-th diagnostic row.
+   *
+   * @param[in] every thinning of the diagnostic rows
+   * @throw std::invalid_argument if <code>every</code> is zero
+   */
+  void set_thin(size_t every) {
+    if (every == 0)
+      throw std::invalid_argument("diagnostic_output: thin must be positive");
+    thin_ = every;
+  }
+
+  /**
+   * Write the coordinates of only the unconstrained parameters selected
+   * by one of the patterns, or of all of them with no patterns.
+   *
+   * @param[in] patterns patterns of the unconstrained parameter names
+   */
+  void set_coordinates(const std::vector<std::string>& patterns) {
+    patterns_ = patterns;
+  }
+
+  /**
+   * Set whether to write the norms of the momentum and the gradient
+   * instead of any coordinates.
+   *
+   * @param[in] summary_only true to write only the norms
+   */
+  void set_summary_only(bool summary_only) { summary_only_ = summary_only; }
+
+  size_t thin() const noexcept { return thin_; }
+
+  const std::vector<std::string>& coordinates() const noexcept {
+    return patterns_;
+  }
+
+  bool summary_only() const noexcept { return summary_only_; }
+
+  /**
+   * Return the columns to write, and set the names of the columns
+   * written, from the full diagnostic names.  The diagnostics of the
+   * sampler are taken to start with the position, momentum and gradient
+   * of each parameter when there are at least three times as many of
+   * them as parameters, and are otherwise all written.
+   *
+   * @param[in,out] names full diagnostic names, replaced by the names of
+   *   the columns written
+   * @param[in] num_leading number of sample and sampler parameters at the
+   *   start of the names
+   * @param[in] param_names unconstrained parameter names
+   * @return columns to write
+   */
+  diagnostic_columns select(std::vector<std::string>& names,
+                            size_t num_leading,
+                            const std::vector<std::string>& param_names) const {
+    diagnostic_columns layout;
+    const size_t n = param_names.size();
+    const bool has_point = names.size() >= num_leading + 3 * n;
+    for (size_t c = 0; c < std::min(num_leading, names.size()); ++c)
+      layout.columns.push_back(c);
+    size_t rest = num_leading;
+    if (has_point) {
+      rest = num_leading + 3 * n;
+      if (!summary_only_) {
+        for (size_t block = 0; block < 3; ++block)
+          for (size_t i = 0; i < n; ++i)
+            if (selected(param_names[i]))
+              layout.columns.push_back(num_leading + block * n + i);
+      }
+      layout.norms = summary_only_;
+      layout.p_begin = num_leading + n;
+      layout.g_begin = num_leading + 2 * n;
+      layout.num_params = n;
+    }
+    for (size_t c = rest; c < names.size(); ++c)
+      layout.columns.push_back(c);
+
+    std::vector<std::string> chosen;
+    for (size_t c : layout.columns)
+      chosen.push_back(names[c]);
+    if (layout.norms) {
+      chosen.push_back("p_norm__");
+      chosen.push_back("g_norm__");
+    }
+    names.swap(chosen);
+    return layout;
+  }
+
+ private:
+  size_t thin_ = 1;
+  std::vector<std::string> patterns_;
+  bool summary_only_ = false;
+
+  bool selected(const std::string& name) const {
+    if (patterns_.empty())
+      return true;
+    for (const std::string& pattern : patterns_)
+      if (output_selection::selects(pattern, name))
+        return true;
+    return false;
+  }
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
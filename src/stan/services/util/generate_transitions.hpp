@@ -1,18 +1,49 @@
 #ifndef STAN_SERVICES_UTIL_GENERATE_TRANSITIONS_HPP
 #define STAN_SERVICES_UTIL_GENERATE_TRANSITIONS_HPP
 
+#include <stan/callbacks/event_tracer.hpp>
+#include <stan/callbacks/instrumentation.hpp>
 #include <stan/callbacks/interrupt.hpp>
 #include <stan/mcmc/base_mcmc.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
+#include <chrono>
 #include <string>
+#include <vector>
 
 namespace stan {
 namespace services {
 namespace util {
+namespace internal {
+
+/**
+ * Sets the interrupt of a sampler for the lifetime of the scope.
+ */
+class sampler_interrupt_scope {
+ public:
+  sampler_interrupt_scope(stan::mcmc::base_mcmc& sampler,
+                          const callbacks::interrupt& interrupt)
+      : sampler_(sampler) {
+    sampler_.set_interrupt(&interrupt);
+  }
+  ~sampler_interrupt_scope() { sampler_.set_interrupt(nullptr); }
+
+ private:
+  stan::mcmc::base_mcmc& sampler_;
+};
+
+}  // namespace internal
 
 /**
  * Generates MCMC transitions.
  *
+ * The sampler polls the interrupt within each transition too, so a stop
+ * requested during a long transition ends it early; such a transition
+ * is not written or counted.  Unless told not to, the sampler writes the
+ * summary of the proposals it rejected once the transitions are done.
+ * Callers that generate a phase over several calls turn that off and
+ * call <code>write_rejection_summary</code> of the sampler once at the
+ * end of the phase, so that a phase gets a single summary.
+ *
  * @tparam Model model class
  * @tparam RNG random number generator class
  * @param[in,out] sampler MCMC sampler used to generate transitions
@@ -33,26 +64,61 @@ namespace util {
  *   iteration's unconstrained parameter values
  * @param[in] model model
  * @param[in,out] base_rng random number generator
- * @param[in,out] callback interrupt callback called once an iteration
+ * @param[in,out] callback interrupt callback called once an iteration,
+ *   whose <code>stop_requested</code> is also polled by the sampler
  * @param[in,out] logger logger for messages
  * @param[in] chain_id The id of the current chain, used in output.
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number.
+ * @param[in] offset number of transitions of this phase already generated
+ *  by earlier calls, so that thinning and refresh stay aligned when a
+ *  phase is generated in pieces
+ * @param[in,out] instrumentation optional callback that receives the
+ *  measurements of each transition, which are only taken if it is not
+ *  null
+ * @param[in] summarize_rejections whether the sampler writes the summary
+ *  of its rejected proposals once the transitions are done
+ * @return number of transitions generated, fewer than
+ *  <code>num_iterations</code> if the interrupt callback requested a stop
  */
 template <class Model, class RNG>
-void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
+int generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
                           int start, int finish, int num_thin, int refresh,
                           bool save, bool warmup,
                           util::mcmc_writer& mcmc_writer,
                           stan::mcmc::sample& init_s, Model& model,
                           RNG& base_rng, callbacks::interrupt& callback,
                           callbacks::logger& logger, size_t chain_id = 1,
-                          size_t num_chains = 1) {
-  for (int m = 0; m < num_iterations; ++m) {
+                          size_t num_chains = 1, int offset = 0,
+                          callbacks::instrumentation* instrumentation = 0,
+                          bool summarize_rejections = true) {
+  using clock = std::chrono::steady_clock;
+  callbacks::trace_scope trace_phase("sample", warmup ? "warmup" : "sampling",
+                                     "chain", chain_id);
+  int leapfrog_index = -1;
+  int tree_depth_index = -1;
+  std::vector<double> sampler_params;
+  if (instrumentation) {
+    sampler.set_gradient_timing(true);
+    std::vector<std::string> names;
+    sampler.get_sampler_param_names(names);
+    for (size_t i = 0; i < names.size(); ++i) {
+      if (names[i] == "n_leapfrog__")
+        leapfrog_index = i;
+      else if (names[i] == "treedepth__")
+        tree_depth_index = i;
+    }
+  }
+  internal::sampler_interrupt_scope interrupt_scope(sampler, callback);
+  int m = 0;
+  for (; m < num_iterations; ++m) {
     callback();
+    if (callback.stop_requested())
+      break;
 
-    if (refresh > 0
-        && (start + m + 1 == finish || m == 0 || (m + 1) % refresh == 0)) {
+    if (refresh > 0 && logger.is_enabled(callbacks::log_level::info)
+        && (start + m + 1 == finish || m + offset == 0
+            || (m + offset + 1) % refresh == 0)) {
       int it_print_width = std::ceil(std::log10(static_cast<double>(finish)));
       std::stringstream message;
       if (num_chains != 1) {
@@ -67,13 +133,78 @@ void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
       logger.info(message);
     }
 
-    init_s = sampler.transition(init_s, logger);
+    if (!instrumentation) {
+      {
+        callbacks::trace_scope trace("sample", "transition", "iteration",
+                                     start + m + 1);
+        init_s = sampler.transition(init_s, logger);
+      }
+      if (callback.stop_requested())
+        break;
+      if (save && (((m + offset) % num_thin) == 0)) {
+        callbacks::trace_scope trace("sample", "write");
+        mcmc_writer.write_sample_params(base_rng, init_s, sampler, model);
+        mcmc_writer.write_diagnostic_params(init_s, sampler);
+      }
+      continue;
+    }
+
+    callbacks::transition_stats stats;
+    stats.chain_id = chain_id;
+    stats.iteration = start + m + 1;
+    stats.num_iterations = finish;
+    stats.warmup = warmup;
+    const stan::model::gradient_stats gradients_start
+        = sampler.get_gradient_stats();
+    const clock::time_point transition_start = clock::now();
+    {
+      callbacks::trace_scope trace("sample", "transition", "iteration",
+                                   start + m + 1);
+      init_s = sampler.transition(init_s, logger);
+    }
+    const clock::time_point transition_end = clock::now();
+    const stan::model::gradient_stats gradients_end
+        = sampler.get_gradient_stats();
+    if (callback.stop_requested())
+      break;
 
-    if (save && ((m % num_thin) == 0)) {
+    if (save && (((m + offset) % num_thin) == 0)) {
+      callbacks::trace_scope trace("sample", "write");
       mcmc_writer.write_sample_params(base_rng, init_s, sampler, model);
       mcmc_writer.write_diagnostic_params(init_s, sampler);
+      stats.write_time
+          = std::chrono::duration<double>(clock::now() - transition_end)
+                .count();
+    }
+
+    stats.transition_time
+        = std::chrono::duration<double>(transition_end - transition_start)
+              .count();
+    stats.gradient_time
+        = gradients_end.gradient_time - gradients_start.gradient_time;
+    stats.num_gradients
+        = gradients_end.num_gradients - gradients_start.num_gradients;
+    stats.ad_stack_size = gradients_end.ad_stack_size;
+    if (gradients_end.ad_bytes_allocated > gradients_start.ad_bytes_allocated)
+      stats.bytes_allocated = gradients_end.ad_bytes_allocated
+                              - gradients_start.ad_bytes_allocated;
+    stats.ad_arena_bytes = gradients_end.ad_bytes_allocated;
+    stats.sampler_bytes = sampler.memory_bytes();
+    if (leapfrog_index >= 0 || tree_depth_index >= 0) {
+      sampler_params.clear();
+      sampler.get_sampler_params(sampler_params);
+      if (leapfrog_index >= 0)
+        stats.num_leapfrog = sampler_params[leapfrog_index];
+      if (tree_depth_index >= 0)
+        stats.tree_depth = sampler_params[tree_depth_index];
     }
+    (*instrumentation)(stats);
   }
+  if (instrumentation)
+    sampler.set_gradient_timing(false);
+  if (summarize_rejections)
+    sampler.write_rejection_summary(logger);
+  return m;
 }
 
 }  // namespace util
@@ -0,0 +1,232 @@
+#ifndef STAN_SERVICES_UTIL_GQ_PIPELINE_HPP
+#define STAN_SERVICES_UTIL_GQ_PIPELINE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * A draw on its way to the sample writer: the values of the sample and
+ * sampler parameters, the unconstrained parameters, and what
+ * <code>write_array</code> made of them.
+ */
+struct gq_draw {
+  std::vector<double> values;
+  Eigen::VectorXd cont_params;
+  Eigen::VectorXd model_values;
+  // messages the model printed writing the draw
+  std::string msgs;
+  // message of a std::domain_error thrown writing the draw, which leaves
+  // its model values not a number
+  std::string error;
+  // any other exception thrown writing the draw, which ends sampling
+  std::exception_ptr exception;
+};
+
+/**
+ * <code>gq_pipeline</code> runs the expensive part of writing draws, the
+ * transformed parameters and generated quantities computed by
+ * <code>write_array</code>, on a pool of worker threads, so that the
+ * thread of a chain can go on with its next transition meanwhile.
+ *
+ * The producer fills the slot returned by <code>next()</code> and
+ * publishes it with <code>push()</code>.  A worker then computes the
+ * draw, and the draws are finished, which writes them, strictly in the
+ * order they were pushed, one at a time, by whichever worker completes
+ * the next one.  At most <code>capacity</code> draws are in the pipeline;
+ * the producer waits for a slot once it is full, so a slow model slows
+ * the chain down instead of growing memory without bound.  The slots are
+ * reused, so after the first <code>capacity</code> draws filling one does
+ * not allocate.
+ *
+ * An exception thrown finishing a draw drops the draws after it and is
+ * rethrown to the producer from the next call to <code>next()</code> or
+ * <code>wait()</code>.
+ */
+class gq_pipeline {
+ public:
+  /**
+   * Type of the computation of the draw of the specified index.
+   */
+  using compute_t = std::function<void(gq_draw&, size_t)>;
+  /**
+   * Type of the finishing of a computed draw.
+   */
+  using finish_t = std::function<void(gq_draw&)>;
+
+  /**
+   * Construct a pipeline and start its worker threads.
+   *
+   * @param[in] compute computation of a draw, called concurrently
+   * @param[in] finish finishing of a draw, called in order and never
+   *   concurrently
+   * @param[in] num_threads number of worker threads; must be positive
+   * @param[in] capacity number of draws in the pipeline; must be positive
+   * @throw std::invalid_argument if the number of threads or the
+   *   capacity is zero
+   */
+  gq_pipeline(compute_t compute, finish_t finish, size_t num_threads,
+              size_t capacity)
+      : compute_(std::move(compute)), finish_(std::move(finish)) {
+    if (num_threads == 0)
+      throw std::invalid_argument("gq_pipeline: no threads");
+    if (capacity == 0)
+      throw std::invalid_argument("gq_pipeline: capacity must be positive");
+    slots_.resize(capacity);
+    workers_.reserve(num_threads);
+    for (size_t n = 0; n < num_threads; ++n)
+      workers_.emplace_back([this]() { work(); });
+  }
+
+  gq_pipeline(const gq_pipeline&) = delete;
+  gq_pipeline& operator=(const gq_pipeline&) = delete;
+
+  /**
+   * Finish the draws in the pipeline and stop the worker threads.
+   */
+  ~gq_pipeline() {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      producer_cv_.wait(lock, [this]() { return finished_ == pushed_; });
+      stop_ = true;
+    }
+    worker_cv_.notify_all();
+    for (std::thread& worker : workers_)
+      worker.join();
+  }
+
+  /**
+   * Return the slot of the next draw, waiting for one if the pipeline is
+   * full.  The slot holds whatever an earlier draw left in it.
+   *
+   * @return slot to fill before calling <code>push()</code>
+   * @throw any exception thrown finishing an earlier draw
+   */
+  gq_draw& next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_cv_.wait(lock, [this]() {
+      return pushed_ - finished_ < slots_.size() || error_;
+    });
+    rethrow();
+    return slots_[pushed_ % slots_.size()].draw;
+  }
+
+  /**
+   * Publish the slot returned by the last call to <code>next()</code>.
+   */
+  void push() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      slots_[pushed_ % slots_.size()].computed = false;
+      ++pushed_;
+    }
+    worker_cv_.notify_one();
+  }
+
+  /**
+   * Wait until every draw pushed has been finished.
+   *
+   * @throw any exception thrown finishing a draw
+   */
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_cv_.wait(lock, [this]() { return finished_ == pushed_; });
+    rethrow();
+  }
+
+  /**
+   * Return the number of draws pushed.
+   */
+  size_t num_draws() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pushed_;
+  }
+
+ private:
+  struct slot {
+    gq_draw draw;
+    bool computed = false;
+  };
+
+  compute_t compute_;
+  finish_t finish_;
+  std::vector<slot> slots_;
+  std::vector<std::thread> workers_;
+  mutable std::mutex mutex_;
+  std::condition_variable worker_cv_;
+  std::condition_variable producer_cv_;
+  // draws pushed, handed to a worker and finished, all counted from the
+  // start, so draw i is in slot i % capacity
+  size_t pushed_ = 0;
+  size_t taken_ = 0;
+  size_t finished_ = 0;
+  bool finishing_ = false;
+  bool stop_ = false;
+  std::exception_ptr error_;
+
+  void rethrow() {
+    if (error_)
+      std::rethrow_exception(std::exchange(error_, nullptr));
+  }
+
+  void work() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      worker_cv_.wait(lock, [this]() { return taken_ < pushed_ || stop_; });
+      if (taken_ == pushed_)
+        return;
+      const size_t index = taken_++;
+      slot& taken = slots_[index % slots_.size()];
+      lock.unlock();
+      if (!error_unlocked())
+        compute_(taken.draw, index);
+      lock.lock();
+      taken.computed = true;
+      if (finishing_)
+        continue;
+      // finish the computed draws in order, unless another worker is
+      // already doing so
+      finishing_ = true;
+      while (finished_ < taken_ && slots_[finished_ % slots_.size()].computed) {
+        slot& next = slots_[finished_ % slots_.size()];
+        const bool failed = static_cast<bool>(error_);
+        lock.unlock();
+        if (!failed) {
+          try {
+            finish_(next.draw);
+          } catch (...) {
+            std::lock_guard<std::mutex> error_lock(mutex_);
+            error_ = std::current_exception();
+          }
+        }
+        lock.lock();
+        ++finished_;
+        producer_cv_.notify_all();
+      }
+      finishing_ = false;
+    }
+  }
+
+  bool error_unlocked() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<bool>(error_);
+  }
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef STAN_SERVICES_UTIL_INITIALIZE_HPP
 #define STAN_SERVICES_UTIL_INITIALIZE_HPP
 
+#include <stan/callbacks/buffered_logger.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/io/var_context.hpp>
@@ -8,14 +9,150 @@
 #include <stan/io/chained_var_context.hpp>
 #include <stan/model/log_prob_grad.hpp>
 #include <stan/math/prim.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
 #include <chrono>
+#include <exception>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace stan {
 namespace services {
 namespace util {
+namespace internal {
+
+/**
+ * Make one attempt at initialization from the specified values: read the
+ * unconstrained parameters from them, then check that the log density
+ * and its gradient are finite there.
+ *
+ * @tparam Jacobian indicates whether to include the Jacobian term when
+ *   evaluating the log density function
+ * @tparam Model the type of the model class
+ * @tparam InitContext the type of the initial values
+ * @param[in] model the model
+ * @param[in] init a var_context with initial values
+ * @param[in] random_context random values of the parameters
+ * @param[in] any_initialized true if <code>init</code> has values of
+ *   some parameters
+ * @param[in,out] logger logger for messages
+ * @param[out] unconstrained unconstrained parameters
+ * @param[out] log_prob log density of <code>log_prob_grad</code>
+ * @param[out] gradient gradient of the log density
+ * @param[out] delta_t seconds taken by the gradient evaluation
+ * @throws exception passed through from the model if the model has a
+ *   fatal error (not a std::domain_error)
+ * @return true if the attempt gives a valid initialization
+ */
+template <bool Jacobian, typename Model, typename InitContext>
+bool try_initialize(Model& model, const InitContext& init,
+                    stan::io::random_var_context& random_context,
+                    bool any_initialized, stan::callbacks::logger& logger,
+                    std::vector<double>& unconstrained, double& log_prob,
+                    std::vector<double>& gradient, double& delta_t) {
+  std::vector<int> disc_vector;
+  std::stringstream msg;
+  try {
+    if (!any_initialized) {
+      unconstrained = random_context.get_unconstrained();
+    } else {
+      stan::io::chained_var_context context(init, random_context);
+
+      model.transform_inits(context, disc_vector, unconstrained, &msg);
+    }
+  } catch (std::domain_error& e) {
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Error evaluating the log probability"
+        " at the initial value.");
+    logger.warn(e.what());
+    return false;
+  } catch (std::exception& e) {
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    logger.error(
+        "Unrecoverable error evaluating the log probability"
+        " at the initial value.");
+    throw;
+  }
+
+  msg.str("");
+  log_prob = 0;
+  try {
+    // we evaluate the log_prob function with propto=false
+    // because we're evaluating with `double` as the type of
+    // the parameters.
+    log_prob = model.template log_prob<false, Jacobian>(unconstrained,
+                                                        disc_vector, &msg);
+    if (msg.str().length() > 0)
+      logger.info(msg);
+  } catch (std::domain_error& e) {
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Error evaluating the log probability"
+        " at the initial value.");
+    logger.warn(e.what());
+    return false;
+  } catch (std::exception& e) {
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    logger.error(
+        "Unrecoverable error evaluating the log probability"
+        " at the initial value.");
+    throw;
+  }
+  if (!std::isfinite(log_prob)) {
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Log probability evaluates to log(0),"
+        " i.e. negative infinity.");
+    logger.warn(
+        "  Stan can't start sampling from this"
+        " initial value.");
+    return false;
+  }
+  std::stringstream log_prob_msg;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    // we evaluate this with propto=true since we're
+    // evaluating with autodiff variables
+    log_prob = stan::model::log_prob_grad<true, Jacobian>(
+        model, unconstrained, disc_vector, gradient, &log_prob_msg);
+  } catch (const std::exception& e) {
+    if (log_prob_msg.str().length() > 0)
+      logger.info(log_prob_msg);
+    logger.error(e.what());
+    throw;
+  }
+  auto end = std::chrono::steady_clock::now();
+  delta_t = std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+                .count()
+            / 1000000.0;
+  if (log_prob_msg.str().length() > 0)
+    logger.info(log_prob_msg);
+
+  if (!std::isfinite(stan::math::sum(gradient))) {
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Gradient evaluated at the initial value"
+        " is not finite.");
+    logger.warn(
+        "  Stan can't start sampling from this"
+        " initial value.");
+    return false;
+  }
+  return true;
+}
+
+}  // namespace internal
 
 /**
  * Returns a valid initial value of the parameters of the model
@@ -43,6 +180,17 @@ namespace util {
  * evaluation of the log probability density function and all its
  * gradients.
  *
+ * With <code>num_concurrent_tries</code> above one, the random
+ * initializations are drawn that many at a time and evaluated in
+ * parallel on the TBB threads, and the first valid one of each batch, in
+ * the order they were drawn, is kept, with the messages of the attempts
+ * before it.  The initialization and messages are then those of attempts
+ * made one at a time, but the random number generator is left past the
+ * draws of the whole batch.
+ *
+ * The log density and gradient found valid can be returned, so that a
+ * sampler seeded with them does not evaluate them again.
+ *
  * @tparam Jacobian indicates whether to include the Jacobian term when
  *   evaluating the log density function
  * @tparam Model the type of the model class
@@ -58,6 +206,13 @@ namespace util {
  *   be printed to the logger
  * @param[in,out] logger logger for messages
  * @param[in,out] init_writer init writer (on the unconstrained scale)
+ * @param[in] num_concurrent_tries number of random initializations
+ *   evaluated at once, (optional, default == 1)
+ * @param[out] log_prob if not null, set to the log density at the
+ *   returned parameters up to a constant, as from
+ *   <code>log_prob_grad<true, Jacobian></code>
+ * @param[out] gradient if not null, set to the gradient of the log
+ *   density at the returned parameters
  * @throws exception passed through from the model if the model has a
  *   fatal error (not a std::domain_error)
  * @throws std::domain_error if the model can not be initialized and
@@ -70,9 +225,11 @@ template <bool Jacobian = true, typename Model, typename InitContext,
 std::vector<double> initialize(Model& model, const InitContext& init, RNG& rng,
                                double init_radius, bool print_timing,
                                stan::callbacks::logger& logger,
-                               stan::callbacks::writer& init_writer) {
+                               stan::callbacks::writer& init_writer,
+                               int num_concurrent_tries = 1,
+                               double* log_prob = nullptr,
+                               std::vector<double>* gradient = nullptr) {
   std::vector<double> unconstrained;
-  std::vector<int> disc_vector;
 
   bool is_fully_initialized = true;
   bool any_initialized = false;
@@ -87,128 +244,116 @@ std::vector<double> initialize(Model& model, const InitContext& init, RNG& rng,
 
   int MAX_INIT_TRIES
       = is_fully_initialized || is_initialized_with_zero ? 1 : 100;
-  int num_init_tries = 0;
-  for (; num_init_tries < MAX_INIT_TRIES; num_init_tries++) {
-    std::stringstream msg;
-    try {
-      stan::io::random_var_context random_context(model, rng, init_radius,
-                                                  is_initialized_with_zero);
-
-      if (!any_initialized) {
-        unconstrained = random_context.get_unconstrained();
-      } else {
-        stan::io::chained_var_context context(init, random_context);
-
-        model.transform_inits(context, disc_vector, unconstrained, &msg);
-      }
-    } catch (std::domain_error& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Error evaluating the log probability"
-          " at the initial value.");
-      logger.warn(e.what());
-      continue;
-    } catch (std::exception& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.error(
-          "Unrecoverable error evaluating the log probability"
-          " at the initial value.");
-      throw;
+  const int batch_size
+      = std::max(1, std::min(num_concurrent_tries, MAX_INIT_TRIES));
+  // one per attempt of a batch, made by the first batch and redrawn in
+  // place by the others
+  std::vector<std::unique_ptr<stan::io::random_var_context>> random_contexts(
+      batch_size);
+  std::vector<std::vector<double>> batch_unconstrained(batch_size);
+  std::vector<std::vector<double>> batch_gradients(batch_size);
+  std::vector<double> batch_log_probs(batch_size);
+  std::vector<double> batch_delta_t(batch_size);
+  std::vector<char> batch_ok(batch_size);
+  std::vector<std::exception_ptr> batch_errors(batch_size);
+  std::vector<callbacks::buffered_logger> batch_loggers(batch_size);
+  std::vector<char> batch_drawn(batch_size);
+  int winner = -1;
+  for (int num_init_tries = 0; num_init_tries < MAX_INIT_TRIES;
+       num_init_tries += batch_size) {
+    const int num = std::min(batch_size, MAX_INIT_TRIES - num_init_tries);
+    // the draws are made in order, from the one generator, up to one
+    // with a fatal error
+    for (int k = 0; k < num; ++k) {
+      batch_drawn[k] = false;
+      batch_errors[k] = nullptr;
     }
-
-    msg.str("");
-    double log_prob(0);
-    try {
-      // we evaluate the log_prob function with propto=false
-      // because we're evaluating with `double` as the type of
-      // the parameters.
-      log_prob = model.template log_prob<false, Jacobian>(unconstrained,
-                                                          disc_vector, &msg);
-      if (msg.str().length() > 0)
-        logger.info(msg);
-    } catch (std::domain_error& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Error evaluating the log probability"
-          " at the initial value.");
-      logger.warn(e.what());
-      continue;
-    } catch (std::exception& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.error(
-          "Unrecoverable error evaluating the log probability"
-          " at the initial value.");
-      throw;
-    }
-    if (!std::isfinite(log_prob)) {
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Log probability evaluates to log(0),"
-          " i.e. negative infinity.");
-      logger.warn(
-          "  Stan can't start sampling from this"
-          " initial value.");
-      continue;
+    for (int k = 0; k < num; ++k) {
+      try {
+        if (random_contexts[k]) {
+          random_contexts[k]->redraw(model, rng);
+        } else {
+          random_contexts[k] = std::make_unique<stan::io::random_var_context>(
+              model, rng, init_radius, is_initialized_with_zero);
+        }
+        batch_drawn[k] = true;
+      } catch (std::domain_error& e) {
+        batch_loggers[k].warn("Rejecting initial value:");
+        batch_loggers[k].warn(
+            "  Error evaluating the log probability"
+            " at the initial value.");
+        batch_loggers[k].warn(e.what());
+      } catch (std::exception& e) {
+        batch_loggers[k].error(
+            "Unrecoverable error evaluating the log probability"
+            " at the initial value.");
+        batch_errors[k] = std::current_exception();
+        break;
+      }
     }
-    std::stringstream log_prob_msg;
-    std::vector<double> gradient;
-    auto start = std::chrono::steady_clock::now();
-    try {
-      // we evaluate this with propto=true since we're
-      // evaluating with autodiff variables
-      log_prob = stan::model::log_prob_grad<true, Jacobian>(
-          model, unconstrained, disc_vector, gradient, &log_prob_msg);
-    } catch (const std::exception& e) {
-      if (log_prob_msg.str().length() > 0)
-        logger.info(log_prob_msg);
-      logger.error(e.what());
-      throw;
+    auto attempt = [&](int k, stan::callbacks::logger& attempt_logger) {
+      batch_ok[k] = false;
+      if (!batch_drawn[k])
+        return;
+      try {
+        batch_ok[k] = internal::try_initialize<Jacobian>(
+            model, init, *random_contexts[k], any_initialized,
+            attempt_logger, batch_unconstrained[k], batch_log_probs[k],
+            batch_gradients[k], batch_delta_t[k]);
+      } catch (...) {
+        batch_errors[k] = std::current_exception();
+      }
+    };
+    if (num == 1) {
+      batch_loggers[0].flush(logger);
+      attempt(0, logger);
+      if (batch_errors[0])
+        std::rethrow_exception(batch_errors[0]);
+      if (batch_ok[0])
+        winner = 0;
+    } else {
+      tbb::parallel_for(tbb::blocked_range<int>(0, num, 1),
+                        [&](const tbb::blocked_range<int>& r) {
+                          for (int k = r.begin(); k != r.end(); ++k)
+                            attempt(k, batch_loggers[k]);
+                        });
+      for (int k = 0; k < num && winner < 0; ++k) {
+        batch_loggers[k].flush(logger);
+        if (batch_errors[k])
+          std::rethrow_exception(batch_errors[k]);
+        if (batch_ok[k])
+          winner = k;
+      }
     }
-    auto end = std::chrono::steady_clock::now();
-    double deltaT
-        = std::chrono::duration_cast<std::chrono::microseconds>(end - start)
-              .count()
-          / 1000000.0;
-    if (log_prob_msg.str().length() > 0)
-      logger.info(log_prob_msg);
-
-    bool gradient_ok = std::isfinite(stan::math::sum(gradient));
+    if (winner >= 0)
+      break;
+  }
 
-    if (!gradient_ok) {
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Gradient evaluated at the initial value"
-          " is not finite.");
-      logger.warn(
-          "  Stan can't start sampling from this"
-          " initial value.");
-    }
-    if (gradient_ok && print_timing) {
+  if (winner >= 0) {
+    if (print_timing) {
       logger.info("");
       std::stringstream msg1;
-      msg1 << "Gradient evaluation took " << deltaT << " seconds";
+      msg1 << "Gradient evaluation took " << batch_delta_t[winner]
+           << " seconds";
       logger.info(msg1);
 
       std::stringstream msg2;
       msg2 << "1000 transitions using 10 leapfrog steps"
            << " per transition would take"
-           << " " << 1e4 * deltaT << " seconds.";
+           << " " << 1e4 * batch_delta_t[winner] << " seconds.";
       logger.info(msg2);
 
       logger.info("Adjust your expectations accordingly!");
       logger.info("");
       logger.info("");
     }
-    if (gradient_ok) {
-      init_writer(unconstrained);
-      return unconstrained;
-    }
+    unconstrained = std::move(batch_unconstrained[winner]);
+    init_writer(unconstrained);
+    if (log_prob)
+      *log_prob = batch_log_probs[winner];
+    if (gradient)
+      *gradient = std::move(batch_gradients[winner]);
+    return unconstrained;
   }
 
   if (!is_initialized_with_zero) {
@@ -0,0 +1,53 @@
+#ifndef STAN_SERVICES_UTIL_LOG_DENSITY_HESSIAN_HPP
+#define STAN_SERVICES_UTIL_LOG_DENSITY_HESSIAN_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/model/hessian.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Compute the exact Hessian of the log density of the model, up to a
+ * constant, at the specified unconstrained parameters, with
+ * <code>stan::model::hessian</code>.  This takes about
+ * <code>N / num_tangents</code> Hessian-vector products of wall time for
+ * <code>N</code> parameters on as many threads, against the
+ * <code>2 N</code> gradients of a finite-difference Hessian, and has no
+ * truncation error.  The messages of the model are logged as info.
+ *
+ * @tparam jacobian true to include the Jacobian adjustment of the
+ * constrained parameters
+ * @tparam Model type of the model
+ * @param[in] model model
+ * @param[in] theta unconstrained parameters
+ * @param[out] log_p log density at the parameters
+ * @param[out] grad gradient of the log density
+ * @param[out] hessian Hessian of the log density
+ * @param[in,out] logger logger for the messages of the model
+ * @param[in] num_tangents number of columns evaluated by each task
+ * @throw std::domain_error if the Hessian is not finite
+ */
+template <bool jacobian, typename Model>
+void log_density_hessian(const Model& model, const Eigen::VectorXd& theta,
+                         double& log_p, Eigen::VectorXd& grad,
+                         Eigen::MatrixXd& hessian, callbacks::logger& logger,
+                         int num_tangents = 4) {
+  std::stringstream msgs;
+  stan::model::hessian<true, jacobian>(model, theta, log_p, grad, hessian,
+                                       &msgs, num_tangents);
+  if (msgs.peek() != std::char_traits<char>::eof())
+    logger.info(msgs);
+  if (!hessian.allFinite())
+    throw std::domain_error("Hessian of the log density is not finite");
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -2,13 +2,23 @@
 #define STAN_SERVICES_UTIL_MCMC_WRITER_HPP
 
 #include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/output_schema.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/mcmc/base_mcmc.hpp>
 #include <stan/mcmc/sample.hpp>
 #include <stan/model/prob_grad.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/diagnostic_output.hpp>
+#include <stan/services/util/gq_pipeline.hpp>
+#include <stan/services/util/output_selection.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cstdint>
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -24,6 +34,77 @@ class mcmc_writer {
   callbacks::writer& sample_writer_;
   callbacks::writer& diagnostic_writer_;
   callbacks::logger& logger_;
+  const output_selection* selection_;
+  // model columns written, set with the names
+  output_columns columns_;
+  const diagnostic_output* diagnostics_;
+  // diagnostic columns written, set with the diagnostic names
+  diagnostic_columns diagnostic_columns_;
+  std::vector<double> diagnostic_values_;
+  std::vector<double> diagnostic_chosen_;
+  size_t num_diagnostic_rows_ = 0;
+
+  // reused from draw to draw so that writing a draw does not allocate
+  gq_draw draw_;
+  std::stringstream msgs_;
+  // runs write_array off the thread of the chain when started
+  std::unique_ptr<gq_pipeline> pipeline_;
+
+  /**
+   * Set the model values of a draw from its unconstrained parameters,
+   * keeping the messages of the model and the error thrown, if any.
+   */
+  template <class Model, class RNG>
+  void compute_model_values(RNG& rng, Model& model, gq_draw& draw,
+                            std::stringstream& msgs) const {
+    msgs.str("");
+    msgs.clear();
+    draw.error.clear();
+    draw.exception = nullptr;
+    // a model that throws before writing must not leave the values of
+    // the previous draw behind
+    draw.model_values.setConstant(std::numeric_limits<double>::quiet_NaN());
+    try {
+      model.write_array(rng, draw.cont_params, draw.model_values,
+                        columns_.include_tparams, columns_.include_gqs,
+                        &msgs);
+    } catch (const std::domain_error& e) {
+      draw.error = e.what();
+    } catch (const std::exception& e) {
+      draw.error = e.what();
+      draw.exception = std::current_exception();
+    }
+    draw.msgs = msgs.str();
+  }
+
+  /**
+   * Log the messages of a draw and write it, or rethrow the exception
+   * thrown computing it.
+   */
+  void finish_draw(gq_draw& draw) {
+    if (draw.msgs.length() > 0)
+      logger_.info(draw.msgs);
+    if (draw.error.length() > 0)
+      logger_.info(draw.error);
+    if (draw.exception)
+      std::rethrow_exception(draw.exception);
+
+    const size_t num_written = draw.model_values.size();
+    if (columns_.all) {
+      draw.values.insert(draw.values.end(), draw.model_values.data(),
+                         draw.model_values.data() + num_written);
+      if (num_written < num_model_params_)
+        draw.values.insert(draw.values.end(), num_model_params_ - num_written,
+                           std::numeric_limits<double>::quiet_NaN());
+    } else {
+      for (size_t c : columns_.columns)
+        draw.values.push_back(c < num_written
+                                  ? draw.model_values[c]
+                                  : std::numeric_limits<double>::quiet_NaN());
+    }
+
+    sample_writer_(draw.values);
+  }
 
  public:
   size_t num_sample_params_;
@@ -36,12 +117,21 @@ class mcmc_writer {
    * @param[in,out] diagnostic_writer diagnostic info is "written" to this
    *   stream
    * @param[in,out] logger messages are written through the logger
+   * @param[in] selection model columns to write, or <code>nullptr</code>
+   *   to write all of them (optional, default == nullptr)
+   * @param[in] diagnostics reduction of the diagnostic output, or
+   *   <code>nullptr</code> to write all of it (optional, default ==
+   *   nullptr)
    */
   mcmc_writer(callbacks::writer& sample_writer,
-              callbacks::writer& diagnostic_writer, callbacks::logger& logger)
+              callbacks::writer& diagnostic_writer, callbacks::logger& logger,
+              const output_selection* selection = nullptr,
+              const diagnostic_output* diagnostics = nullptr)
       : sample_writer_(sample_writer),
         diagnostic_writer_(diagnostic_writer),
         logger_(logger),
+        selection_(selection),
+        diagnostics_(diagnostics),
         num_sample_params_(0),
         num_sampler_params_(0),
         num_model_params_(0) {}
@@ -50,15 +140,24 @@ class mcmc_writer {
    * Outputs parameter string names. First outputs the names stored in
    * the sample object (stan::mcmc::sample), then uses the sampler
    * provided to output sampler specific names, then adds the model
-   * constrained parameter names.
+   * constrained parameter names, restricted to the output selection if
+   * there is one.
    *
    * The names are written to the sample_stream as comma separated values
-   * with a newline at the end.
+   * with a newline at the end.  A sample writer that accepts a schema
+   * is sent the names as an <code>output_schema</code> instead, with
+   * one entry per model variable, unless an output selection picks
+   * columns out of the variables.  When the output selection writes some
+   * columns in single precision, any other sample writer is sent a
+   * schema with one scalar per column, whose names are those of the
+   * columns; writers that do not take precisions write it as names.
    *
    * @tparam Model Model class
    * @param[in] sample a sample (unconstrained) that works with the model
    * @param[in] sampler a stan::mcmc::base_mcmc object
    * @param[in] model the model
+   * @throw std::invalid_argument if a pattern of the output selection
+   *   matches no model variable
    */
   template <class Model>
   void write_sample_names(stan::mcmc::sample& sample,
@@ -71,9 +170,45 @@ class mcmc_writer {
     sampler.get_sampler_param_names(names);
     num_sampler_params_ = names.size() - num_sample_params_;
 
-    model.constrained_param_names(names, true, true);
-    num_model_params_ = names.size() - num_sample_params_ - num_sampler_params_;
+    const bool reduced
+        = selection_ != nullptr && selection_->reduces_precision();
+    if (sample_writer_.accepts_schema()
+        && (selection_ == nullptr || selection_->selects_all())) {
+      callbacks::output_schema schema;
+      for (const std::string& name : names)
+        schema.add(name);
+      schema.add_model(model, true, true);
+      if (reduced)
+        schema.set_precision(
+            [&](const std::string& name) {
+              return std::find(names.begin(), names.end(), name)
+                         == names.end()
+                     && selection_->precision(name)
+                            == callbacks::value_precision::float32;
+            },
+            callbacks::value_precision::float32);
+      columns_ = output_columns();
+      num_model_params_ = schema.num_columns() - names.size();
+      sample_writer_(schema);
+      return;
+    }
 
+    columns_ = selection_ == nullptr ? output_selection().select(model)
+                                     : selection_->select(model);
+    names.insert(names.end(), columns_.names.begin(), columns_.names.end());
+    num_model_params_ = columns_.names.size();
+
+    if (reduced) {
+      // one scalar per column keeps the names of the columns
+      callbacks::output_schema schema;
+      const size_t num_params = num_sample_params_ + num_sampler_params_;
+      for (size_t i = 0; i < names.size(); ++i)
+        schema.add(names[i], i < num_params
+                                 ? callbacks::value_precision::float64
+                                 : selection_->precision(names[i]));
+      sample_writer_(schema);
+      return;
+    }
     sample_writer_(names);
   }
 
@@ -81,10 +216,16 @@ class mcmc_writer {
    * Outputs samples. First outputs the values of the sample params
    * from a stan::mcmc::sample, then outputs the values of the sampler
    * params from a stan::mcmc::base_mcmc, then finally outputs the values
-   * of the model.
+   * of the model.  With an output selection, <code>write_array</code>
+   * is only asked for the transformed parameters or generated quantities
+   * if some of their columns are selected, and only the selected columns
+   * are written.
    *
    * The samples are written to the sample_stream as comma separated
-   * values with a newline at the end.
+   * values with a newline at the end.  The buffers the values are
+   * gathered in belong to this object and are reused for every draw, so
+   * once they have grown to the size of a draw no more memory is
+   * allocated.
    *
    * @tparam Model Model class
    * @tparam RNG Type of random number generator
@@ -97,41 +238,90 @@ class mcmc_writer {
   template <class Model, class RNG>
   void write_sample_params(RNG& rng, stan::mcmc::sample& sample,
                            stan::mcmc::base_mcmc& sampler, Model& model) {
-    std::vector<double> values;
-
-    sample.get_sample_params(values);
-    sampler.get_sampler_params(values);
-
-    std::vector<double> model_values;
-    std::vector<int> params_i;
-    std::stringstream ss;
-    try {
-      std::vector<double> cont_params(
-          sample.cont_params().data(),
-          sample.cont_params().data() + sample.cont_params().size());
-      model.write_array(rng, cont_params, params_i, model_values, true, true,
-                        &ss);
-    } catch (const std::domain_error& e) {
-      if (ss.str().length() > 0)
-        logger_.info(ss);
-      ss.str("");
-      logger_.info(e.what());
-    } catch (const std::exception& e) {
-      if (ss.str().length() > 0)
-        logger_.info(ss);
-      logger_.info(e.what());
-      throw;
+    gq_draw& draw = pipeline_ ? pipeline_->next() : draw_;
+    draw.values.clear();
+    sample.get_sample_params(draw.values);
+    sampler.get_sampler_params(draw.values);
+    draw.cont_params = sample.cont_params();
+    if (pipeline_) {
+      pipeline_->push();
+      return;
     }
-    if (ss.str().length() > 0)
-      logger_.info(ss);
+    compute_model_values(rng, model, draw, msgs_);
+    finish_draw(draw);
+  }
 
-    if (model_values.size() > 0)
-      values.insert(values.end(), model_values.begin(), model_values.end());
-    if (model_values.size() < num_model_params_)
-      values.insert(values.end(), num_model_params_ - model_values.size(),
-                    std::numeric_limits<double>::quiet_NaN());
+  /**
+   * Start running <code>write_array</code> for the draws written by
+   * <code>write_sample_params</code> on the specified number of worker
+   * threads, which write them in order, so that the chain goes on with
+   * its next transition while the generated quantities of its last draws
+   * are computed.  This pays off for models with expensive transformed
+   * parameters or generated quantities.  Must be called after the
+   * sample names are written.
+   *
+   * The draws are then no longer written by the time
+   * <code>write_sample_params</code> returns, but before anything else
+   * is written to the sample writer or the writers are flushed, and
+   * <code>wait_for_draws()</code> waits for them.  The random number
+   * generator passed to <code>write_sample_params</code> is not used.
+   * Instead the generated quantities of each draw use a stream of their
+   * own, which depends on a seed drawn from the specified generator now,
+   * the chain and the index of the draw, so they are the same whatever
+   * the number of threads.  The model and the logger are then called
+   * from the worker threads, concurrently with the thread of the chain.
+   *
+   * @tparam Model Model class
+   * @tparam RNG Type of random number generator
+   * @param[in] model the model, which must outlive the pipeline
+   * @param[in,out] rng generator the seed of the streams is drawn from
+   * @param[in] chain_id id of the chain
+   * @param[in] num_threads number of worker threads
+   * @param[in] capacity number of draws that can wait for their
+   *   generated quantities, or zero for four per thread
+   */
+  template <class Model, class RNG>
+  void start_gq_pipeline(Model& model, RNG& rng, size_t chain_id,
+                         size_t num_threads, size_t capacity = 0) {
+    wait_for_draws();
+    const unsigned int seed = static_cast<unsigned int>(rng());
+    const unsigned int chain = static_cast<unsigned int>(chain_id);
+    pipeline_ = std::make_unique<gq_pipeline>(
+        [this, &model, seed, chain](gq_draw& draw, size_t index) {
+          std::stringstream msgs;
+          try {
+            stan::rng_t draw_rng = util::create_rng(
+                seed, chain, static_cast<std::uint32_t>(index), 0);
+            compute_model_values(draw_rng, model, draw, msgs);
+          } catch (const std::exception& e) {
+            draw.error = e.what();
+            draw.exception = std::current_exception();
+          }
+        },
+        [this](gq_draw& draw) { finish_draw(draw); }, num_threads,
+        capacity > 0 ? capacity : 4 * num_threads);
+  }
 
-    sample_writer_(values);
+  /**
+   * Wait until the draws handed to the worker threads are written, if
+   * the generated quantities pipeline is started.
+   *
+   * @throw any exception thrown writing a draw
+   */
+  void wait_for_draws() {
+    if (pipeline_)
+      pipeline_->wait();
+  }
+
+  /**
+   * Write the draws handed to the worker threads and stop them, so that
+   * the draws are written by <code>write_sample_params</code> again.
+   *
+   * @throw any exception thrown writing a draw
+   */
+  void stop_gq_pipeline() {
+    wait_for_draws();
+    pipeline_.reset();
   }
 
   /**
@@ -142,11 +332,13 @@ class mcmc_writer {
    * @param[in] sampler sampler
    */
   void write_adapt_finish(stan::mcmc::base_mcmc& sampler) {
+    wait_for_draws();
     sample_writer_("Adaptation terminated");
   }
 
   /**
-   * Print diagnostic names
+   * Print diagnostic names, those chosen by the diagnostic output if
+   * there is one.
    *
    * @tparam Model Model class
    * @param[in] sample unconstrained sample
@@ -160,29 +352,45 @@ class mcmc_writer {
 
     sample.get_sample_param_names(names);
     sampler.get_sampler_param_names(names);
+    const size_t num_leading = names.size();
 
     std::vector<std::string> model_names;
     model.unconstrained_param_names(model_names, false, false);
 
     sampler.get_sampler_diagnostic_names(model_names, names);
 
+    if (diagnostics_)
+      diagnostic_columns_
+          = diagnostics_->select(names, num_leading, model_names);
+    num_diagnostic_rows_ = 0;
     diagnostic_writer_(names);
   }
 
   /**
-   * Print diagnostic params to the diagnostic stream.
+   * Print diagnostic params to the diagnostic stream.  With a diagnostic
+   * output, only every <code>thin()</code>-th call writes, and only the
+   * columns it chooses; the other calls return without collecting the
+   * values.
    *
    * @param[in] sample unconstrained sample
    * @param[in] sampler sampler
    */
   void write_diagnostic_params(stan::mcmc::sample& sample,
                                stan::mcmc::base_mcmc& sampler) {
-    std::vector<double> values;
+    if (diagnostics_ && num_diagnostic_rows_++ % diagnostics_->thin() != 0)
+      return;
+    std::vector<double>& values = diagnostic_values_;
+    values.clear();
 
     sample.get_sample_params(values);
     sampler.get_sampler_params(values);
     sampler.get_sampler_diagnostics(values);
 
+    if (diagnostics_) {
+      diagnostic_columns_.apply(values, diagnostic_chosen_);
+      diagnostic_writer_(diagnostic_chosen_);
+      return;
+    }
     diagnostic_writer_(values);
   }
 
@@ -253,10 +461,20 @@ class mcmc_writer {
    * @param[in] sampleDeltaT sample time (sec)
    */
   void write_timing(double warmDeltaT, double sampleDeltaT) {
+    wait_for_draws();
     write_timing(warmDeltaT, sampleDeltaT, sample_writer_);
     write_timing(warmDeltaT, sampleDeltaT, diagnostic_writer_);
     log_timing(warmDeltaT, sampleDeltaT);
   }
+
+  /**
+   * Flushes the sample and diagnostic writers, at the end of a phase.
+   */
+  void flush() {
+    wait_for_draws();
+    sample_writer_.flush();
+    diagnostic_writer_.flush();
+  }
 };
 
 }  // namespace util
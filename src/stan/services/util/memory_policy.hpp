@@ -0,0 +1,213 @@
+#ifndef STAN_SERVICES_UTIL_MEMORY_POLICY_HPP
+#define STAN_SERVICES_UTIL_MEMORY_POLICY_HPP
+
+#include <stan/math/rev.hpp>
+#include <stan/mcmc/hmc/hamiltonians/dense_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/fixed_diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Policy for the memory of the autodiff arena of a chain and of the
+ * buffers of its sampler, which the services apply on the thread of each
+ * chain before its first transition.
+ *
+ * The default policy leaves everything as it was: the arena grows on
+ * demand, and the buffers are ordinary allocations.
+ */
+struct memory_policy {
+  /**
+   * Number of bytes of the autodiff arena reserved on the thread of the
+   * chain before its first gradient, so that the arena does not grow a
+   * block at a time during warmup, or zero to let it grow on demand.
+   */
+  std::size_t ad_arena_bytes = 0;
+  /**
+   * Whether the reserved arena and the position, momentum, gradient and
+   * inverse metric of the sampler are advised to be backed by transparent
+   * huge pages, which cuts the TLB misses of models with many parameters.
+   */
+  bool huge_pages = false;
+  /**
+   * Whether the reserved arena is written once on the thread of the
+   * chain, so that the kernel places its pages on the NUMA node the chain
+   * runs on, such as the one of its <code>chain_placement</code> arena.
+   */
+  bool first_touch = true;
+};
+
+/**
+ * Size of the huge pages that memory is aligned to before it is advised.
+ */
+constexpr std::size_t huge_page_bytes = std::size_t(2) << 20;
+
+namespace internal {
+
+inline std::mutex& memory_policy_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+inline memory_policy& global_memory_policy() {
+  static memory_policy policy;
+  return policy;
+}
+
+}  // namespace internal
+
+/**
+ * Set the memory policy that the services apply to the chains they run
+ * from then on.
+ *
+ * @param[in] policy memory policy
+ */
+inline void set_memory_policy(const memory_policy& policy) {
+  std::lock_guard<std::mutex> lock(internal::memory_policy_mutex());
+  internal::global_memory_policy() = policy;
+}
+
+/**
+ * Return the memory policy that the services apply to the chains they
+ * run, the default one unless <code>set_memory_policy</code> was called.
+ */
+inline memory_policy get_memory_policy() {
+  std::lock_guard<std::mutex> lock(internal::memory_policy_mutex());
+  return internal::global_memory_policy();
+}
+
+/**
+ * Advise the kernel to back the whole huge pages within a range of
+ * memory with transparent huge pages.  The advice only covers the huge
+ * pages that lie entirely in the range, so it never affects memory
+ * outside of it, and ranges shorter than a huge page are left alone.
+ *
+ * @param[in] data start of the range
+ * @param[in] bytes length of the range
+ * @return whether any of the range was advised, which is never the case
+ *   when the platform has no transparent huge pages
+ */
+inline bool advise_huge_pages(void* data, std::size_t bytes) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(data);
+  const std::uintptr_t begin
+      = (start + huge_page_bytes - 1) & ~(huge_page_bytes - 1);
+  const std::uintptr_t end = (start + bytes) & ~(huge_page_bytes - 1);
+  if (data == nullptr || end <= begin)
+    return false;
+  return madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE)
+         == 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * Advise the position, momentum and gradient of a point to be backed by
+ * transparent huge pages.  See <code>advise_huge_pages</code>.
+ *
+ * @param[in,out] z point
+ * @return number of buffers advised
+ */
+inline int advise_huge_pages(mcmc::ps_point& z) {
+  return advise_huge_pages(z.q.data(), z.q.size() * sizeof(double))
+         + advise_huge_pages(z.p.data(), z.p.size() * sizeof(double))
+         + advise_huge_pages(z.g.data(), z.g.size() * sizeof(double));
+}
+
+/**
+ * Advise the buffers of a point and its diagonal inverse metric to be
+ * backed by transparent huge pages.
+ *
+ * @param[in,out] z point
+ * @return number of buffers advised
+ */
+inline int advise_huge_pages(mcmc::diag_e_point& z) {
+  return advise_huge_pages(static_cast<mcmc::ps_point&>(z))
+         + advise_huge_pages(z.inv_e_metric_.data(),
+                             z.inv_e_metric_.size() * sizeof(double));
+}
+
+/**
+ * Advise the buffers of a point and its dense inverse metric to be
+ * backed by transparent huge pages.
+ *
+ * @param[in,out] z point
+ * @return number of buffers advised
+ */
+inline int advise_huge_pages(mcmc::dense_e_point& z) {
+  return advise_huge_pages(static_cast<mcmc::ps_point&>(z))
+         + advise_huge_pages(z.inv_e_metric_.data(),
+                             z.inv_e_metric_.size() * sizeof(double));
+}
+
+/**
+ * Leave a point of a fixed dimension alone, since its buffers are part
+ * of it rather than allocations of their own.
+ *
+ * @tparam N number of dimensions
+ * @return zero
+ */
+template <int N>
+int advise_huge_pages(mcmc::fixed_diag_e_point<N>&) {
+  return 0;
+}
+
+/**
+ * Reserve the autodiff arena of the calling thread under a memory
+ * policy.
+ *
+ * A block of <code>ad_arena_bytes</code> is allocated from the arena,
+ * advised and touched as the policy says, and then released, which keeps
+ * the block in the arena for the gradients that follow.  The arena is
+ * only reserved while the thread has no autodiff in progress, since
+ * releasing it would otherwise free live variables.
+ *
+ * @param[in] policy memory policy
+ * @return number of bytes reserved, zero if nothing was
+ */
+inline std::size_t reserve_ad_arena(const memory_policy& policy) {
+  if (policy.ad_arena_bytes == 0)
+    return 0;
+  auto& stack = *stan::math::ChainableStack::instance_;
+  if (!stan::math::empty_nested() || !stack.var_stack_.empty()
+      || !stack.var_nochain_stack_.empty())
+    return 0;
+  void* block = stack.memalloc_.alloc(policy.ad_arena_bytes);
+  if (policy.huge_pages)
+    advise_huge_pages(block, policy.ad_arena_bytes);
+  if (policy.first_touch)
+    std::memset(block, 0, policy.ad_arena_bytes);
+  stan::math::recover_memory();
+  return policy.ad_arena_bytes;
+}
+
+/**
+ * Apply a memory policy to a sampler and to the autodiff arena of the
+ * calling thread, which should be the thread that runs the chain.
+ *
+ * @tparam Sampler type of HMC sampler
+ * @param[in] policy memory policy
+ * @param[in,out] sampler sampler
+ */
+template <class Sampler>
+void apply_memory_policy(const memory_policy& policy, Sampler& sampler) {
+  reserve_ad_arena(policy);
+  if (policy.huge_pages)
+    advise_huge_pages(sampler.z());
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,147 @@
+#ifndef STAN_SERVICES_UTIL_MODE_WARM_START_HPP
+#define STAN_SERVICES_UTIL_MODE_WARM_START_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/services/util/log_density_hessian.hpp>
+#include <stan/services/util/read_warm_start.hpp>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Return the warm start of a sampler at a mode of the posterior, from an
+ * inverse Hessian of the negative log density there, such as the one of
+ * a finite-difference or exact Hessian, or the inverse Hessian estimate
+ * of L-BFGS.
+ *
+ * The chain starts from the mode, and the inverse metric is the inverse
+ * Hessian, or its diagonal of marginal variances for a diagonal metric.
+ * The inverse Hessian is made symmetric positive definite first: its
+ * eigenvalues are kept above <code>min_eigenvalue</code> times the
+ * largest, so that the directions of a flat or saddle mode get a wide,
+ * rather than a negative, variance.  The step size is the optimal
+ * leapfrog step size for a standard normal of the dimension of the
+ * model, <code>d^(-1/4)</code>, which the sampler refines further before
+ * warmup.
+ *
+ * The warm start is used with the warm start services of NUTS, whose
+ * warmup only adapts the step size, so the early fast and slow windows of
+ * the usual warmup learning the curvature are skipped.
+ *
+ * @param[in] mode mode on the unconstrained scale
+ * @param[in] inv_hessian inverse of the Hessian of the negative log
+ *   density at the mode
+ * @param[in] dense whether the inverse metric is dense rather than a
+ *   single row of its diagonal
+ * @param[in] min_eigenvalue smallest eigenvalue kept, relative to the
+ *   largest
+ * @return warm start
+ * @throw std::invalid_argument if the sizes of the mode and the inverse
+ *   Hessian differ
+ * @throw std::domain_error if the inverse Hessian is not finite or has no
+ *   positive eigenvalue
+ */
+inline warm_start warm_start_from_inv_hessian(
+    const Eigen::VectorXd& mode, const Eigen::MatrixXd& inv_hessian,
+    bool dense, double min_eigenvalue = 1e-8) {
+  const Eigen::Index num_params = mode.size();
+  if (inv_hessian.rows() != num_params || inv_hessian.cols() != num_params)
+    throw std::invalid_argument(
+        "Mode warm start: the inverse Hessian and the mode have different"
+        " sizes");
+  if (!inv_hessian.allFinite())
+    throw std::domain_error(
+        "Mode warm start: the inverse Hessian is not finite");
+
+  warm_start start;
+  start.cont_vector.assign(mode.data(), mode.data() + num_params);
+  start.stepsize
+      = num_params > 0 ? std::pow(static_cast<double>(num_params), -0.25) : 1;
+  if (num_params == 0) {
+    start.inv_metric.resize(dense ? 0 : 1, 0);
+    return start;
+  }
+
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(
+      0.5 * (inv_hessian + inv_hessian.transpose()));
+  const double max_eigenvalue = eigen.eigenvalues().maxCoeff();
+  if (!(max_eigenvalue > 0))
+    throw std::domain_error(
+        "Mode warm start: the inverse Hessian has no positive eigenvalue");
+  const Eigen::VectorXd eigenvalues = eigen.eigenvalues().cwiseMax(
+      min_eigenvalue * max_eigenvalue);
+  if (dense) {
+    start.inv_metric = eigen.eigenvectors() * eigenvalues.asDiagonal()
+                       * eigen.eigenvectors().transpose();
+  } else {
+    start.inv_metric
+        = (eigen.eigenvectors().array().square().matrix() * eigenvalues)
+              .transpose();
+  }
+  return start;
+}
+
+/**
+ * Return the warm start of a sampler at a mode of the posterior, such as
+ * the one found by <code>services::optimize</code>, from the exact
+ * Hessian of the log density there as computed by
+ * <code>log_density_hessian</code>, including the Jacobian adjustment of
+ * the constrained parameters that the sampler targets.  See
+ * <code>warm_start_from_inv_hessian</code>.
+ *
+ * @tparam Model type of the model
+ * @param[in] model model
+ * @param[in] mode mode on the unconstrained scale
+ * @param[in] dense whether the inverse metric is dense rather than a
+ *   single row of its diagonal
+ * @param[in,out] logger logger for the messages of the model
+ * @return warm start
+ * @throw std::domain_error if the Hessian is not finite or the log
+ *   density has no direction of negative curvature at the mode
+ */
+template <class Model>
+warm_start warm_start_from_mode(const Model& model,
+                                const Eigen::VectorXd& mode, bool dense,
+                                callbacks::logger& logger) {
+  double log_p;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hessian;
+  log_density_hessian<true>(model, mode, log_p, grad, hessian, logger);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigen(
+      -0.5 * (hessian + hessian.transpose()));
+  if (mode.size() > 0 && !(eigen.eigenvalues().maxCoeff() > 0))
+    throw std::domain_error(
+        "Mode warm start: the log density has no direction of negative"
+        " curvature at the mode");
+  // the inverse of each eigenvalue of the negative Hessian, those of
+  // non-negative curvature given the widest variance
+  Eigen::VectorXd inv_eigenvalues = eigen.eigenvalues();
+  const double min_positive = mode.size() > 0
+                                  ? (inv_eigenvalues.array() > 0)
+                                        .select(inv_eigenvalues.array(),
+                                                inv_eigenvalues.maxCoeff())
+                                        .minCoeff()
+                                  : 1;
+  inv_eigenvalues = (inv_eigenvalues.array() > 0)
+                        .select(inv_eigenvalues.array().inverse(),
+                                1 / min_positive);
+  const Eigen::MatrixXd inv_hessian = eigen.eigenvectors()
+                                      * inv_eigenvalues.asDiagonal()
+                                      * eigen.eigenvectors().transpose();
+  std::stringstream msg;
+  msg << "Mode warm start: log density " << log_p
+      << " and gradient norm " << grad.norm() << " at the mode";
+  logger.info(msg);
+  return warm_start_from_inv_hessian(mode, inv_hessian, dense);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,65 @@
+#ifndef STAN_SERVICES_UTIL_MPI_CHAIN_COMMUNICATOR_HPP
+#define STAN_SERVICES_UTIL_MPI_CHAIN_COMMUNICATOR_HPP
+
+#ifdef STAN_MPI
+
+#include <stan/services/util/chain_communicator.hpp>
+#include <boost/mpi/collectives.hpp>
+#include <boost/mpi/communicator.hpp>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>mpi_chain_communicator</code> connects the chains run by the
+ * processes of an MPI communicator, one process per rank, typically one
+ * per node with the chains of a node run on its TBB threads:
+ *
+ * <pre>
+ * boost::mpi::environment env;
+ * mpi_chain_communicator communicator{boost::mpi::communicator()};
+ * auto chains = local_chains(num_chains, communicator.rank(),
+ *                            communicator.size());
+ * // inits and writers for chains.second chains, e.g. one file each
+ * hmc_nuts_diag_e_adapt(model, chains.second, inits, inv_metrics,
+ *                       random_seed, init_chain_id + chains.first, ...,
+ *                       true, 0, 0, nullptr, &communicator);
+ * </pre>
+ *
+ * Every rank must call the service with the same arguments apart from
+ * its share of the chains, as the adaptation windows end at the same
+ * iterations on every rank.
+ */
+class mpi_chain_communicator : public chain_communicator {
+ public:
+  /**
+   * Construct a communicator over the processes of an MPI communicator.
+   *
+   * @param[in] comm MPI communicator, shared rather than duplicated
+   */
+  explicit mpi_chain_communicator(const boost::mpi::communicator& comm)
+      : comm_(comm) {}
+
+  int rank() const { return comm_.rank(); }
+
+  int size() const { return comm_.size(); }
+
+  std::vector<double> all_gather(const std::vector<double>& values) {
+    std::vector<double> gathered(values.size() * comm_.size());
+    boost::mpi::all_gather(comm_, values.data(),
+                           static_cast<int>(values.size()), gathered.data());
+    return gathered;
+  }
+
+ private:
+  boost::mpi::communicator comm_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
+#endif
@@ -0,0 +1,210 @@
+#ifndef STAN_SERVICES_UTIL_OUTPUT_SELECTION_HPP
+#define STAN_SERVICES_UTIL_OUTPUT_SELECTION_HPP
+
+#include <stan/callbacks/output_schema.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * The model columns selected for output by an
+ * <code>output_selection</code>, along with what
+ * <code>write_array</code> needs to compute to produce them.
+ */
+struct output_columns {
+  // True if every column is selected, in which case columns is empty
+  bool all = true;
+  // Whether write_array has to compute transformed parameters
+  bool include_tparams = true;
+  // Whether write_array has to compute generated quantities
+  bool include_gqs = true;
+  // Selected columns, as indices into the output of write_array with the
+  // flags above
+  std::vector<size_t> columns;
+  // Names of the selected columns
+  std::vector<std::string> names;
+};
+
+/**
+ * <code>output_selection</code> selects the constrained model columns
+ * written for each draw from a list of patterns.
+ *
+ * A pattern selects a column when it matches either the full column
+ * name, such as <code>theta.2.1</code>, or its variable name, the part
+ * before the first <code>.</code> or <code>:</code>, such as
+ * <code>theta</code>.  In a pattern <code>*</code> matches any number of
+ * characters and <code>?</code> any single character.  The selected
+ * columns keep the order of the model.  Transformed parameters or
+ * generated quantities are only computed when one of their columns is
+ * selected.
+ *
+ * A default constructed selection selects every column.  A selection
+ * also sets the precision of the columns written, which is double
+ * unless patterns of single precision columns are given with
+ * <code>set_float32</code>.
+ */
+class output_selection {
+ public:
+  /**
+   * Construct a selection of every column.
+   */
+  output_selection() {}
+
+  /**
+   * Construct a selection of the columns matching any of the patterns.
+   *
+   * @param[in] patterns patterns of the columns to write
+   */
+  explicit output_selection(const std::vector<std::string>& patterns)
+      : all_(false), patterns_(patterns) {}
+
+  /**
+   * Return true if every column is selected.
+   */
+  bool selects_all() const noexcept { return all_; }
+
+  /**
+   * Write the columns matching any of the patterns in single precision,
+   * matching as for the selection.  The patterns need not match any
+   * column.
+   *
+   * @param[in] patterns patterns of the single precision columns
+   */
+  void set_float32(const std::vector<std::string>& patterns) {
+    float32_patterns_ = patterns;
+  }
+
+  /**
+   * Return true if some columns may be written in single precision.
+   */
+  bool reduces_precision() const noexcept {
+    return !float32_patterns_.empty();
+  }
+
+  /**
+   * Return the precision of a column or variable.
+   *
+   * @param[in] column column or variable name
+   */
+  callbacks::value_precision precision(const std::string& column) const {
+    for (const std::string& pattern : float32_patterns_)
+      if (selects(pattern, column))
+        return callbacks::value_precision::float32;
+    return callbacks::value_precision::float64;
+  }
+
+  /**
+   * Return true if the name matches the pattern, where <code>*</code>
+   * matches any number of characters and <code>?</code> any character.
+   *
+   * @param[in] pattern pattern
+   * @param[in] name name
+   */
+  static bool glob_match(const std::string& pattern, const std::string& name) {
+    size_t p = 0, n = 0;
+    // position of the last star and of the name when it was reached
+    size_t star = std::string::npos, star_n = 0;
+    while (n < name.size()) {
+      if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == name[n])) {
+        ++p;
+        ++n;
+      } else if (p < pattern.size() && pattern[p] == '*') {
+        star = p++;
+        star_n = n;
+      } else if (star != std::string::npos) {
+        p = star + 1;
+        n = ++star_n;
+      } else {
+        return false;
+      }
+    }
+    while (p < pattern.size() && pattern[p] == '*')
+      ++p;
+    return p == pattern.size();
+  }
+
+  /**
+   * Return true if the pattern selects the column.
+   *
+   * @param[in] pattern pattern
+   * @param[in] column constrained column name
+   */
+  static bool selects(const std::string& pattern, const std::string& column) {
+    return glob_match(pattern, column)
+           || glob_match(pattern, column.substr(0, column.find_first_of(".:")));
+  }
+
+  /**
+   * Return the columns of the model that are selected.
+   *
+   * @tparam Model type of model
+   * @param[in] model model
+   * @return selected columns
+   * @throw std::invalid_argument if a pattern matches no column
+   */
+  template <class Model>
+  output_columns select(const Model& model) const {
+    output_columns selected;
+    if (all_) {
+      model.constrained_param_names(selected.names, true, true);
+      return selected;
+    }
+    std::vector<std::string> names;
+    model.constrained_param_names(names, false, false);
+    const size_t num_params = names.size();
+    names.clear();
+    model.constrained_param_names(names, true, false);
+    const size_t num_tparams = names.size() - num_params;
+    names.clear();
+    model.constrained_param_names(names, true, true);
+
+    std::vector<bool> matched(patterns_.size(), false);
+    std::vector<size_t> columns;
+    for (size_t c = 0; c < names.size(); ++c) {
+      bool selected_column = false;
+      for (size_t k = 0; k < patterns_.size(); ++k) {
+        if (selects(patterns_[k], names[c])) {
+          matched[k] = true;
+          selected_column = true;
+        }
+      }
+      if (selected_column)
+        columns.push_back(c);
+    }
+    for (size_t k = 0; k < patterns_.size(); ++k)
+      if (!matched[k])
+        throw std::invalid_argument("Output selection \"" + patterns_[k]
+                                    + "\" matches no model variable");
+
+    selected.all = false;
+    selected.include_tparams = false;
+    selected.include_gqs = false;
+    for (size_t c : columns) {
+      if (c >= num_params + num_tparams)
+        selected.include_gqs = true;
+      else if (c >= num_params)
+        selected.include_tparams = true;
+    }
+    // without transformed parameters the generated quantities move down
+    const size_t shift = selected.include_tparams ? 0 : num_tparams;
+    for (size_t c : columns) {
+      selected.columns.push_back(c < num_params ? c : c - shift);
+      selected.names.push_back(names[c]);
+    }
+    return selected;
+  }
+
+ private:
+  bool all_ = true;
+  std::vector<std::string> patterns_;
+  std::vector<std::string> float32_patterns_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,43 @@
+#ifndef STAN_SERVICES_UTIL_PARAMETER_BLOCKS_HPP
+#define STAN_SERVICES_UTIL_PARAMETER_BLOCKS_HPP
+
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Return the sizes of the runs of unconstrained parameters of a model
+ * that belong to the same parameter of the model, in order, so that each
+ * parameter of the model gets a block of a block diagonal metric.  The
+ * runs are found from the names of the unconstrained parameters, whose
+ * elements share the name of their parameter up to the first period.
+ *
+ * @tparam Model type of model
+ * @param[in] model model
+ * @return number of unconstrained parameters of each parameter of the
+ *   model with at least one
+ */
+template <class Model>
+std::vector<int> parameter_blocks(const Model& model) {
+  std::vector<std::string> names;
+  model.unconstrained_param_names(names, false, false);
+  std::vector<int> sizes;
+  std::string previous;
+  for (const std::string& name : names) {
+    std::string base = name.substr(0, name.find('.'));
+    if (sizes.empty() || base != previous) {
+      sizes.push_back(0);
+      previous = base;
+    }
+    ++sizes.back();
+  }
+  return sizes;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,137 @@
+#ifndef STAN_SERVICES_UTIL_PATHFINDER_INIT_HPP
+#define STAN_SERVICES_UTIL_PATHFINDER_INIT_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/model/unconstrain_array_batch.hpp>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>draws_collector</code> is a writer that keeps the draws written to
+ * it in memory: each vector of values, and each column of a matrix of
+ * values, is a draw.  It collects the output of services such as
+ * pathfinder that write their draws rather than return them.
+ */
+class draws_collector : public callbacks::writer {
+ public:
+  using callbacks::writer::operator();
+
+  void operator()(const std::vector<std::string>& names) { names_ = names; }
+
+  void operator()(const std::vector<double>& state) {
+    draws_.emplace_back(state);
+  }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    for (Eigen::Index j = 0; j < values.cols(); ++j)
+      draws_.emplace_back(values.col(j).data(),
+                          values.col(j).data() + values.rows());
+  }
+
+  const std::vector<std::string>& names() const noexcept { return names_; }
+
+  const std::vector<std::vector<double>>& draws() const noexcept {
+    return draws_;
+  }
+
+ private:
+  std::vector<std::string> names_;
+  std::vector<std::vector<double>> draws_;
+};
+
+/**
+ * Initial state of a set of chains: an unconstrained initial value per
+ * chain and a shared diagonal inverse metric and step size.
+ */
+struct chains_init {
+  std::vector<std::vector<double>> cont_vectors;
+  Eigen::VectorXd inv_metric;
+  double stepsize = 1;
+};
+
+/**
+ * Derives the initial state of a set of chains from approximate draws of
+ * the posterior, such as the PSIS resampled draws of pathfinder.
+ *
+ * The draws are transformed to the unconstrained scale in parallel with
+ * <code>stan::model::unconstrain_array_batch</code>.  The chains start
+ * from draws spread evenly over the sequence, the inverse metric is the
+ * variance of each unconstrained parameter over all the draws,
+ * regularized toward 1e-3 as in metric adaptation, and the step size is
+ * the optimal leapfrog step size for a standard normal of the dimension
+ * of the model, <code>d^(-1/4)</code>, which the sampler refines further
+ * before warmup.  With pathfinder the variances are those of the
+ * diagonal plus low rank normal approximations the draws are taken from.
+ *
+ * @tparam Model type of model
+ * @param[in] model model
+ * @param[in] draws constrained draws, each the values of the constrained
+ *   parameters starting at <code>offset</code>, followed by any
+ *   transformed parameters and generated quantities
+ * @param[in] offset number of values preceding the parameters in a draw,
+ *   2 for the <code>lp_approx__</code> and <code>lp__</code> of pathfinder
+ * @param[in] num_chains number of chains
+ * @return initial state of the chains
+ * @throw std::invalid_argument if there are no draws or a draw has too
+ *   few values
+ */
+template <class Model>
+chains_init init_from_draws(const Model& model,
+                            const std::vector<std::vector<double>>& draws,
+                            size_t offset, size_t num_chains) {
+  if (draws.empty())
+    throw std::invalid_argument("No approximate draws to initialize from");
+  std::vector<std::string> names;
+  model.constrained_param_names(names, false, false);
+  const size_t num_constrained = names.size();
+
+  const size_t num_draws = draws.size();
+  Eigen::MatrixXd constrained(num_constrained, num_draws);
+  for (size_t n = 0; n < num_draws; ++n) {
+    if (draws[n].size() < offset + num_constrained)
+      throw std::invalid_argument("Approximate draw " + std::to_string(n)
+                                  + " has too few values");
+    for (size_t i = 0; i < num_constrained; ++i)
+      constrained(i, n) = draws[n][offset + i];
+  }
+  Eigen::MatrixXd unconstrained;
+  std::stringstream msg;
+  stan::model::unconstrain_array_batch(model, constrained, unconstrained,
+                                       &msg);
+
+  chains_init init;
+  const Eigen::Index dim = unconstrained.rows();
+  Eigen::VectorXd mean = Eigen::VectorXd::Zero(dim);
+  Eigen::VectorXd m2 = Eigen::VectorXd::Zero(dim);
+  for (size_t n = 0; n < num_draws; ++n) {
+    Eigen::VectorXd delta = unconstrained.col(n) - mean;
+    mean += delta / (n + 1.0);
+    m2 += delta.cwiseProduct(unconstrained.col(n) - mean);
+  }
+  const double n = num_draws;
+  Eigen::VectorXd var = num_draws > 1 ? Eigen::VectorXd(m2 / (n - 1))
+                                      : Eigen::VectorXd::Ones(dim);
+  init.inv_metric = (n / (n + 5.0)) * var
+                    + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(dim);
+  init.stepsize = dim > 0 ? std::pow(static_cast<double>(dim), -0.25) : 1;
+
+  for (size_t i = 0; i < num_chains; ++i) {
+    const Eigen::VectorXd start
+        = unconstrained.col((i * num_draws) / num_chains);
+    init.cont_vectors.emplace_back(start.data(), start.data() + start.size());
+  }
+  return init;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,214 @@
+#ifndef STAN_SERVICES_UTIL_PSIS_RESAMPLE_HPP
+#define STAN_SERVICES_UTIL_PSIS_RESAMPLE_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/services/pathfinder/psis_engine.hpp>
+#include <boost/random/discrete_distribution.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Pareto smoothed importance resampling (PSIS) of the draws of an
+ * approximation of the posterior.
+ */
+struct psis_resampling {
+  // Indices of the resampled draws, in the order they were drawn
+  std::vector<std::size_t> indices;
+  // Smoothed weights of the draws, scaled to a largest weight of one
+  Eigen::Array<double, Eigen::Dynamic, 1> weights;
+  // Estimated Pareto shape of the tail of the weights, NaN if unknown
+  double pareto_k = std::numeric_limits<double>::quiet_NaN();
+};
+
+/**
+ * Resample, with replacement, the draws of an approximation of the
+ * posterior with their Pareto smoothed importance weights, so that the
+ * resampled draws are closer to draws of the posterior.  The tail of the
+ * weights is the one pathfinder uses.
+ *
+ * The log importance ratio of a draw is the log density of the model at
+ * the draw minus the log density of the approximation, either up to a
+ * constant.  A draw with a ratio that is NaN gets weight zero.  The
+ * Pareto shape <code>k</code> diagnoses the approximation: above 0.7 the
+ * weights are too variable for the resampled draws to be relied on, and
+ * the engine warns about it.
+ *
+ * @tparam RNG type of the random number generator
+ * @tparam Logger A type with a `warn(std::string)` method
+ * @param[in] log_ratios log importance ratios of the draws
+ * @param[in] num_resampled number of draws to resample
+ * @param[in,out] rng random number generator for the resampling
+ * @param[in,out] logger Logger for messages
+ * @return indices, weights and Pareto shape of the resampling; if no draw
+ * has a finite ratio no draw is resampled
+ */
+template <class RNG, typename Logger>
+psis_resampling psis_resample(
+    const Eigen::Array<double, Eigen::Dynamic, 1>& log_ratios,
+    std::size_t num_resampled, RNG& rng, Logger& logger) {
+  psis_resampling result;
+  const Eigen::Index num_draws = log_ratios.size();
+  Eigen::Array<double, Eigen::Dynamic, 1> ratios
+      = log_ratios.isNaN().select(-std::numeric_limits<double>::infinity(),
+                                  log_ratios);
+  if (num_draws == 0 || !std::isfinite(ratios.maxCoeff())) {
+    result.weights = Eigen::Array<double, Eigen::Dynamic, 1>::Zero(num_draws);
+    logger.warn("PSIS resampling: no draw of the approximation has a finite "
+                "log density ratio.");
+    return result;
+  }
+  const Eigen::Index tail_len
+      = std::min(0.2 * num_draws, 3 * std::sqrt(num_draws));
+  psis::psis_engine engine;
+  result.pareto_k = engine.weights(ratios, tail_len, result.weights, logger);
+  boost::random::discrete_distribution<std::size_t, double> index(
+      result.weights.data(), result.weights.data() + result.weights.size());
+  result.indices.resize(num_resampled);
+  for (auto&& i : result.indices)
+    i = index(rng);
+  return result;
+}
+
+/**
+ * <code>psis_resample_writer</code> is a writer that importance resamples
+ * the draws of an approximation of the posterior on their way to another
+ * writer, for algorithms such as ADVI and the Laplace approximation that
+ * write the log density of the model and of the approximation with each
+ * draw.
+ *
+ * The names, messages and the specified number of leading rows, such as
+ * the mean of ADVI, go straight through.  The draws that follow are kept
+ * until <code>resample</code>, which writes as many draws resampled with
+ * <code>psis_resample</code>.  The log importance ratios of the draws are
+ * the differences of the two columns of the log densities, which the
+ * algorithms evaluate as they draw, in parallel where they can.
+ */
+class psis_resample_writer : public callbacks::writer {
+ public:
+  using callbacks::writer::operator();
+
+  /**
+   * @param[in,out] writer writer for the resampled draws
+   * @param[in] log_p_name name of the column of the log density of the
+   *   model
+   * @param[in] log_q_name name of the column of the log density of the
+   *   approximation
+   * @param[in] num_leading_rows number of rows written before the draws
+   */
+  psis_resample_writer(callbacks::writer& writer,
+                       const std::string& log_p_name,
+                       const std::string& log_q_name,
+                       std::size_t num_leading_rows = 0)
+      : writer_(writer),
+        log_p_name_(log_p_name),
+        log_q_name_(log_q_name),
+        num_leading_rows_(num_leading_rows) {}
+
+  /**
+   * Write the names and find the columns of the log densities.
+   *
+   * @throw std::invalid_argument if a column of the log densities is
+   * missing
+   */
+  void operator()(const std::vector<std::string>& names) {
+    auto log_p = std::find(names.begin(), names.end(), log_p_name_);
+    auto log_q = std::find(names.begin(), names.end(), log_q_name_);
+    if (log_p == names.end() || log_q == names.end())
+      throw std::invalid_argument("PSIS resampling: the draws have no column "
+                                  + (log_p == names.end() ? log_p_name_
+                                                          : log_q_name_));
+    log_p_col_ = log_p - names.begin();
+    log_q_col_ = log_q - names.begin();
+    writer_(names);
+  }
+
+  void operator()(const std::vector<double>& state) {
+    if (num_leading_rows_ > 0) {
+      --num_leading_rows_;
+      writer_(state);
+    } else {
+      draws_.emplace_back(state);
+    }
+  }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    for (Eigen::Index j = 0; j < values.cols(); ++j)
+      (*this)(std::vector<double>(values.col(j).data(),
+                                  values.col(j).data() + values.rows()));
+  }
+
+  void operator()(const std::string& message) { writer_(message); }
+
+  void operator()() { writer_(); }
+
+  void flush() { writer_.flush(); }
+
+  /**
+   * Return the draws kept so far.
+   */
+  const std::vector<std::vector<double>>& draws() const noexcept {
+    return draws_;
+  }
+
+  /**
+   * Write as many draws, resampled with replacement from the draws kept,
+   * to the writer, and forget the draws kept.  If no draw has a finite
+   * log density ratio, the draws are written as they are.
+   *
+   * @tparam RNG type of the random number generator
+   * @tparam Logger A type with `info(std::string)` and
+   *   `warn(std::string)` methods
+   * @param[in,out] rng random number generator for the resampling
+   * @param[in,out] logger Logger for messages
+   * @return estimated Pareto shape of the tail of the weights, NaN if
+   * unknown
+   */
+  template <class RNG, typename Logger>
+  double resample(RNG& rng, Logger& logger) {
+    const std::size_t num_draws = draws_.size();
+    Eigen::Array<double, Eigen::Dynamic, 1> log_ratios(num_draws);
+    for (std::size_t n = 0; n < num_draws; ++n)
+      log_ratios(n) = draws_[n][log_p_col_] - draws_[n][log_q_col_];
+    psis_resampling resampling
+        = psis_resample(log_ratios, num_draws, rng, logger);
+    if (resampling.indices.empty()) {
+      for (auto&& draw : draws_)
+        writer_(draw);
+    } else {
+      std::stringstream msg;
+      msg << "PSIS resampling: Pareto k = " << std::setprecision(2)
+          << resampling.pareto_k;
+      logger.info(msg.str());
+      for (auto&& i : resampling.indices)
+        writer_(draws_[i]);
+    }
+    draws_.clear();
+    return resampling.pareto_k;
+  }
+
+ private:
+  callbacks::writer& writer_;
+  std::string log_p_name_;
+  std::string log_q_name_;
+  std::size_t num_leading_rows_;
+  std::size_t log_p_col_ = 0;
+  std::size_t log_q_col_ = 1;
+  std::vector<std::vector<double>> draws_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,135 @@
+#ifndef STAN_SERVICES_UTIL_PSIS_REWEIGHT_HPP
+#define STAN_SERVICES_UTIL_PSIS_REWEIGHT_HPP
+
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/services/pathfinder/psis_engine.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Pareto smoothed importance sampling (PSIS) weights of the draws of a
+ * previous fit as draws of the posterior of an updated model.
+ */
+struct psis_reweighting {
+  // Draws on the unconstrained scale of the updated model, one per column
+  Eigen::MatrixXd draws;
+  // Smoothed weights of the draws, scaled to a largest weight of one
+  Eigen::Array<double, Eigen::Dynamic, 1> weights;
+  // Estimated Pareto shape of the tail of the weights, NaN if unknown
+  double pareto_k = std::numeric_limits<double>::quiet_NaN();
+};
+
+/**
+ * Reweight the draws of a previous fit so that they represent the
+ * posterior of the specified model, for a model or data that changed a
+ * little since the fit.  The log importance ratio of each draw is the
+ * difference of the log densities of its constrained parameters under the
+ * model and the previous model, without the Jacobian adjustments, which
+ * makes it independent of the transforms.  The ratios are evaluated in
+ * parallel over the draws, and then smoothed by PSIS with the tail length
+ * pathfinder uses.
+ *
+ * A draw outside the support of the model, or whose log density throws,
+ * gets weight zero.  The Pareto shape <code>k</code> diagnoses the
+ * reweighting: values above 0.7 indicate that the weights are too
+ * variable to be relied on, and the model should be refit.
+ *
+ * @tparam Model type of the updated model
+ * @tparam PreviousModel type of the model of the previous fit
+ * @tparam Logger A type with a `warn(std::string)` method
+ * @param[in] model updated model
+ * @param[in] previous_model model of the previous fit
+ * @param[in] previous output of the previous fit
+ * @param[in,out] logger Logger for messages
+ * @return draws, weights and Pareto shape of the reweighting; the shape
+ * is NaN if there are too few draws to estimate it or no draw has a
+ * finite ratio
+ * @throw std::invalid_argument if the fit has no draws or is missing a
+ * parameter of the models
+ */
+template <class Model, class PreviousModel, typename Logger>
+psis_reweighting psis_reweight(const Model& model,
+                               const PreviousModel& previous_model,
+                               const io::stan_csv& previous, Logger& logger) {
+  const Eigen::Index num_draws = previous.samples.rows();
+  if (num_draws == 0)
+    throw std::invalid_argument("PSIS reweighting: the previous fit has no "
+                                "draws");
+  std::vector<std::string> names;
+  model.constrained_param_names(names, false, false);
+  std::vector<Eigen::Index> columns(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::string name = names[i];
+    io::prettify_stan_csv_name(name);
+    auto column = std::find(previous.header.begin(), previous.header.end(),
+                            name);
+    if (column == previous.header.end())
+      throw std::invalid_argument(
+          "PSIS reweighting: the previous fit has no column " + name);
+    columns[i] = column - previous.header.begin();
+  }
+
+  psis_reweighting result;
+  result.draws.resize(model.num_params_r(), num_draws);
+  Eigen::Array<double, Eigen::Dynamic, 1> log_ratios(num_draws);
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, num_draws),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        Eigen::VectorXd constrained(names.size());
+        Eigen::VectorXd unconstrained;
+        Eigen::VectorXd previous_unconstrained;
+        std::stringstream msg;
+        for (Eigen::Index n = r.begin(); n != r.end(); ++n) {
+          for (size_t i = 0; i < columns.size(); ++i)
+            constrained(i) = previous.samples(n, columns[i]);
+          double log_ratio = -std::numeric_limits<double>::infinity();
+          try {
+            model.unconstrain_array(constrained, unconstrained, &msg);
+            previous_model.unconstrain_array(constrained,
+                                             previous_unconstrained, &msg);
+            result.draws.col(n) = unconstrained;
+            log_ratio = model.template log_prob<false, false>(unconstrained,
+                                                               &msg)
+                        - previous_model.template log_prob<false, false>(
+                            previous_unconstrained, &msg);
+          } catch (const std::exception& e) {
+            result.draws.col(n).setConstant(
+                std::numeric_limits<double>::quiet_NaN());
+          }
+          log_ratios(n) = std::isnan(log_ratio)
+                              ? -std::numeric_limits<double>::infinity()
+                              : log_ratio;
+          msg.str("");
+        }
+      });
+
+  if (!std::isfinite(log_ratios.maxCoeff())) {
+    result.weights = Eigen::Array<double, Eigen::Dynamic, 1>::Zero(num_draws);
+    logger.warn("PSIS reweighting: no draw of the previous fit has a finite "
+                "log density under the model.");
+    return result;
+  }
+  const Eigen::Index tail_len = std::min(0.2 * num_draws,
+                                         3 * std::sqrt(num_draws));
+  psis::psis_engine engine;
+  result.pareto_k = engine.weights(log_ratios, tail_len, result.weights,
+                                   logger);
+  return result;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
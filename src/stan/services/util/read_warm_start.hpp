@@ -0,0 +1,91 @@
+#ifndef STAN_SERVICES_UTIL_READ_WARM_START_HPP
+#define STAN_SERVICES_UTIL_READ_WARM_START_HPP
+
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * The state a sampler is warm started from: the last draw of a previous
+ * fit on the unconstrained scale along with its adapted step size and
+ * inverse metric.
+ */
+struct warm_start {
+  std::vector<double> cont_vector;
+  double stepsize = 0;
+  // Diagonal inverse metric as a single row, or dense inverse metric
+  Eigen::MatrixXd inv_metric;
+};
+
+/**
+ * Read the state to warm start a sampler from the output of a previous
+ * adaptive fit of the same model, as parsed by
+ * <code>io::stan_csv_reader</code>.  The constrained parameters of the
+ * last draw are transformed to the unconstrained scale with the
+ * <code>unconstrain_array</code> method of the model.
+ *
+ * @tparam Model type of model
+ * @param[in] model model, possibly with updated data
+ * @param[in] fit output of the previous fit
+ * @return last draw, step size and inverse metric of the fit
+ * @throw std::invalid_argument if the fit has no draws, is missing a
+ *   parameter of the model or has no adapted step size or an inverse
+ *   metric of the wrong size
+ */
+template <class Model>
+warm_start read_warm_start(const Model& model, const io::stan_csv& fit) {
+  if (fit.samples.rows() == 0)
+    throw std::invalid_argument("Warm start: the previous fit has no draws");
+  if (!(fit.adaptation.step_size > 0))
+    throw std::invalid_argument(
+        "Warm start: the previous fit has no adapted step size");
+
+  std::vector<std::string> names;
+  model.constrained_param_names(names, false, false);
+  Eigen::VectorXd constrained(names.size());
+  const Eigen::Index last = fit.samples.rows() - 1;
+  for (size_t i = 0; i < names.size(); ++i) {
+    std::string name = names[i];
+    io::prettify_stan_csv_name(name);
+    auto column = std::find(fit.header.begin(), fit.header.end(), name);
+    if (column == fit.header.end())
+      throw std::invalid_argument("Warm start: the previous fit has no column "
+                                  + name);
+    constrained(i) = fit.samples(last, column - fit.header.begin());
+  }
+
+  warm_start start;
+  Eigen::VectorXd unconstrained;
+  std::stringstream msg;
+  model.unconstrain_array(constrained, unconstrained, &msg);
+  start.cont_vector.assign(unconstrained.data(),
+                           unconstrained.data() + unconstrained.size());
+
+  const Eigen::Index num_params = unconstrained.size();
+  const Eigen::MatrixXd& metric = fit.adaptation.metric;
+  if (metric.cols() != num_params
+      || (metric.rows() != 1 && metric.rows() != num_params)) {
+    std::stringstream message;
+    message << "Warm start: the inverse metric of the previous fit is "
+            << metric.rows() << " by " << metric.cols()
+            << " but the model has " << num_params
+            << " unconstrained parameters";
+    throw std::invalid_argument(message.str());
+  }
+  start.stepsize = fit.adaptation.step_size;
+  start.inv_metric = metric;
+  return start;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
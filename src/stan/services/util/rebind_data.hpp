@@ -0,0 +1,100 @@
+#ifndef STAN_SERVICES_UTIL_REBIND_DATA_HPP
+#define STAN_SERVICES_UTIL_REBIND_DATA_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/io/var_context.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+namespace internal {
+inline std::string dims_string(const std::vector<size_t>& dims) {
+  std::stringstream ss;
+  ss << "(";
+  for (size_t i = 0; i < dims.size(); ++i)
+    ss << (i > 0 ? "," : "") << dims[i];
+  ss << ")";
+  return ss.str();
+}
+}  // namespace internal
+
+/**
+ * Swap the data of the specified context into an existing model, for
+ * refits on new data of the same shapes without constructing a new
+ * model.  Each data variable of the model must be in the context with the
+ * dimensions the model was constructed with, and the dimensions of the
+ * parameters, transformed parameters and generated quantities from
+ * <code>get_dims</code> must be unchanged by the new data, so that
+ * samplers, adaptation and warm starts sized for the model remain valid.
+ *
+ * A model which does not support rebinding is left unchanged and false
+ * is returned, so the caller can construct a new model instead.  A model
+ * which throws while rebinding must not be used again.
+ *
+ * @tparam Model type of model
+ * @param[in,out] model model to rebind
+ * @param[in] data context of the new data
+ * @param[in,out] logger Logger for messages
+ * @return true if the data were rebound, false if the model does not
+ * support rebinding
+ * @throws std::domain_error if the data do not have the dimensions of
+ * the model's data or fail the checks of the model
+ */
+template <class Model>
+bool rebind_data(Model& model, const stan::io::var_context& data,
+                 callbacks::logger& logger) {
+  std::vector<std::string> names;
+  std::vector<std::vector<size_t>> data_dims;
+  model.get_data_dims(names, data_dims);
+  if (names.empty())
+    return false;
+  for (size_t n = 0; n < names.size(); ++n) {
+    if (!data.contains_r(names[n])) {
+      logger.error("Cannot rebind data: variable " + names[n]
+                   + " not found.");
+      throw std::domain_error("Data rebinding failure");
+    }
+    std::vector<size_t> dims = data.dims_r(names[n]);
+    if (dims != data_dims[n]) {
+      logger.error("Cannot rebind data: variable " + names[n]
+                   + " has dimensions " + internal::dims_string(dims)
+                   + " instead of " + internal::dims_string(data_dims[n])
+                   + ".");
+      throw std::domain_error("Data rebinding failure");
+    }
+  }
+  std::vector<std::vector<size_t>> param_dims;
+  model.get_dims(param_dims);
+  try {
+    std::stringstream msg;
+    const bool rebound = model.rebind_data(data, &msg);
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    if (!rebound)
+      return false;
+  } catch (const std::exception& e) {
+    logger.error("Cannot rebind data: ");
+    logger.error(e.what());
+    throw std::domain_error("Data rebinding failure");
+  }
+  std::vector<std::vector<size_t>> rebound_dims;
+  model.get_dims(rebound_dims);
+  if (rebound_dims != param_dims) {
+    logger.error(
+        "Cannot rebind data: the new data change the dimensions of the"
+        " parameters.");
+    throw std::domain_error("Data rebinding failure");
+  }
+  return true;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -0,0 +1,471 @@
+#ifndef STAN_SERVICES_UTIL_RESUMABLE_CHAIN_HPP
+#define STAN_SERVICES_UTIL_RESUMABLE_CHAIN_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/mcmc/checkpoint_state.hpp>
+#include <stan/mcmc/hmc/sampler_checkpoint.hpp>
+#include <stan/mcmc/sample.hpp>
+#include <stan/services/util/chain_scheduler.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * A chain that generates its transitions and writes its output a block
+ * of iterations at a time, so that a <code>chain_scheduler</code> can
+ * interleave it with other chains.  Run to the end, it writes the same
+ * output as <code>run_adaptive_sampler</code> if <code>Adapt</code> is
+ * true and as <code>run_sampler</code> otherwise; the timing reported
+ * for each phase is the time spent running its blocks.
+ *
+ * @tparam Adapt true if the sampler adapts during warmup
+ * @tparam Sampler type of sampler
+ * @tparam Model type of model
+ * @tparam RNG type of random number generator
+ */
+template <bool Adapt, typename Sampler, typename Model, typename RNG>
+class resumable_chain {
+ public:
+  /**
+   * Construct a chain; the arguments are those of
+   * <code>run_adaptive_sampler</code>, all held by reference except the
+   * initial values, which are copied.
+   */
+  resumable_chain(Sampler& sampler, Model& model,
+                  std::vector<double>& cont_vector, int num_warmup,
+                  int num_samples, int num_thin, int refresh,
+                  bool save_warmup, RNG& rng, callbacks::interrupt& interrupt,
+                  callbacks::logger& logger, callbacks::writer& sample_writer,
+                  callbacks::writer& diagnostic_writer,
+                  callbacks::structured_writer& metric_writer,
+                  size_t chain_id = 1, size_t num_chains = 1)
+      : sampler_(sampler),
+        model_(model),
+        num_warmup_(num_warmup),
+        num_samples_(num_samples),
+        num_thin_(num_thin),
+        refresh_(refresh),
+        save_warmup_(save_warmup),
+        rng_(rng),
+        interrupt_(interrupt),
+        logger_(logger),
+        sample_writer_(sample_writer),
+        metric_writer_(metric_writer),
+        writer_(sample_writer, diagnostic_writer, logger),
+        s_(Eigen::VectorXd::Map(cont_vector.data(), cont_vector.size()), 0,
+           0),
+        num_chains_(num_chains),
+        started_(false),
+        finished_(false),
+        iteration_(0),
+        warm_delta_t_(0),
+        sample_delta_t_(0) {
+    progress_.chain_id = chain_id;
+    progress_.num_iterations = num_warmup + num_samples;
+  }
+
+  /**
+   * Generate at most the specified number of transitions, starting the
+   * chain first if it has not started and writing the output at the end
+   * of warmup and of sampling.
+   *
+   * @param max_iterations largest number of transitions to generate
+   * @return number of transitions generated
+   */
+  int run_block(int max_iterations) {
+    if (finished_)
+      return 0;
+    auto start = std::chrono::steady_clock::now();
+    if (!started_) {
+      started_ = true;
+      if (!start_chain(std::integral_constant<bool, Adapt>())) {
+        finished_ = true;
+        progress_.finished = true;
+        return 0;
+      }
+      writer_.write_sample_names(s_, sampler_, model_);
+      writer_.write_diagnostic_names(s_, sampler_, model_);
+      if (num_warmup_ == 0)
+        end_warmup(std::integral_constant<bool, Adapt>());
+    }
+    const int num_iterations = num_warmup_ + num_samples_;
+    int num_generated = 0;
+    while (num_generated < max_iterations && !finished_) {
+      auto block_start = std::chrono::steady_clock::now();
+      const bool warmup = iteration_ < num_warmup_;
+      const int phase_begin = warmup ? 0 : num_warmup_;
+      const int phase_end = warmup ? num_warmup_ : num_iterations;
+      const int num = std::min(max_iterations - num_generated,
+                               phase_end - iteration_);
+      const int generated = util::generate_transitions(
+          sampler_, num, iteration_, num_iterations, num_thin_, refresh_,
+          warmup ? save_warmup_ : true, warmup, writer_, s_, model_, rng_,
+          interrupt_, logger_, progress_.chain_id, num_chains_,
+          iteration_ - phase_begin, nullptr, false);
+      const bool stopped = generated < num;
+      iteration_ += generated;
+      if (iteration_ == phase_end || stopped)
+        sampler_.write_rejection_summary(logger_);
+      num_generated += generated;
+      double delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                           std::chrono::steady_clock::now() - block_start)
+                           .count()
+                       / 1000.0;
+      (warmup ? warm_delta_t_ : sample_delta_t_) += delta_t;
+      if (warmup && (iteration_ == num_warmup_ || stopped))
+        end_warmup(std::integral_constant<bool, Adapt>());
+      if (iteration_ == num_iterations || stopped) {
+        writer_.write_timing(warm_delta_t_, sample_delta_t_);
+        writer_.flush();
+        finished_ = true;
+      }
+    }
+    progress_.iteration = iteration_;
+    progress_.warmup = iteration_ < num_warmup_;
+    progress_.finished = finished_;
+    progress_.elapsed
+        += std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+               .count()
+           / 1000.0;
+    return num_generated;
+  }
+
+  bool finished() const noexcept { return finished_; }
+
+  chain_progress progress() const { return progress_; }
+
+  /**
+   * Write a record with everything needed to resume the chain from its
+   * current iteration: the iteration, the current draw, the time spent
+   * so far, the state of the random number generator and that of the
+   * sampler, as written by <code>write_sampler_checkpoint</code>.  The
+   * output writers are flushed first, so the output up to the checkpoint
+   * is complete.
+   *
+   * @param[in,out] writer checkpoint writer
+   */
+  void write_checkpoint(callbacks::structured_writer& writer) {
+    writer_.flush();
+    writer.begin_record();
+    writer.write("chain_id", progress_.chain_id);
+    writer.write("iteration", iteration_);
+    writer.write("draw", s_.cont_params());
+    writer.write("draw_log_prob", s_.log_prob());
+    writer.write("draw_accept_stat", s_.accept_stat());
+    writer.write("warmup_time", warm_delta_t_);
+    writer.write("sampling_time", sample_delta_t_);
+    stan::mcmc::write_rng_state(writer, "rng_state", rng_);
+    stan::mcmc::write_sampler_checkpoint(sampler_, writer);
+    writer.end_record();
+  }
+
+  /**
+   * Restore the chain from a checkpoint written by
+   * <code>write_checkpoint</code>, instead of starting it.  The chain then
+   * carries on from the iteration of the checkpoint without writing the
+   * headers again, so its output continues the output of the original
+   * run up to that checkpoint.
+   *
+   * @param[in] context checkpoint
+   * @throw std::invalid_argument if the checkpoint is invalid for this
+   * chain or the chain has already run
+   */
+  void resume(const io::var_context& context) {
+    if (started_)
+      throw std::invalid_argument("Cannot resume a chain that has started");
+    const double iteration
+        = stan::mcmc::read_checkpoint_scalar(context, "iteration");
+    if (!(iteration >= 0 && iteration <= num_warmup_ + num_samples_))
+      throw std::invalid_argument(
+          "Checkpoint iteration is outside of the iterations to run");
+    Eigen::VectorXd draw = stan::mcmc::read_checkpoint_vector(
+        context, "draw", s_.cont_params().size());
+    s_ = stan::mcmc::sample(
+        draw, stan::mcmc::read_checkpoint_scalar(context, "draw_log_prob"),
+        stan::mcmc::read_checkpoint_scalar(context, "draw_accept_stat"));
+    warm_delta_t_ = stan::mcmc::read_checkpoint_scalar(context, "warmup_time");
+    sample_delta_t_
+        = stan::mcmc::read_checkpoint_scalar(context, "sampling_time");
+    stan::mcmc::read_rng_state(context, "rng_state", rng_);
+    stan::mcmc::read_sampler_checkpoint(sampler_, context);
+    iteration_ = iteration;
+    started_ = true;
+    finished_ = iteration_ == num_warmup_ + num_samples_;
+    progress_.iteration = iteration_;
+    progress_.warmup = iteration_ < num_warmup_;
+    progress_.finished = finished_;
+  }
+
+ private:
+  bool start_chain(std::true_type) {
+    sampler_.engage_adaptation();
+    try {
+      sampler_.z().q = s_.cont_params();
+      sampler_.init_stepsize(logger_);
+    } catch (const std::exception& e) {
+      logger_.error("Exception initializing step size.");
+      logger_.error(e.what());
+      return false;
+    }
+    return true;
+  }
+
+  bool start_chain(std::false_type) { return true; }
+
+  void end_warmup(std::true_type) {
+    sampler_.disengage_adaptation();
+    writer_.write_adapt_finish(sampler_);
+    sampler_.write_sampler_state(sample_writer_);
+    sampler_.write_sampler_state_struct(metric_writer_);
+    writer_.flush();
+  }
+
+  void end_warmup(std::false_type) {
+    writer_.write_adapt_finish(sampler_);
+    sampler_.write_sampler_state(sample_writer_);
+    writer_.flush();
+  }
+
+  Sampler& sampler_;
+  Model& model_;
+  int num_warmup_;
+  int num_samples_;
+  int num_thin_;
+  int refresh_;
+  bool save_warmup_;
+  RNG& rng_;
+  callbacks::interrupt& interrupt_;
+  callbacks::logger& logger_;
+  callbacks::writer& sample_writer_;
+  callbacks::structured_writer& metric_writer_;
+  services::util::mcmc_writer writer_;
+  stan::mcmc::sample s_;
+  size_t num_chains_;
+  bool started_;
+  bool finished_;
+  int iteration_;
+  double warm_delta_t_;
+  double sample_delta_t_;
+  chain_progress progress_;
+};
+
+/**
+ * Runs several chains of an adaptive sampler independently, interleaved
+ * by the scheduler, with the output of each as written by
+ * <code>run_adaptive_sampler</code>.
+ *
+ * @tparam Sampler Type of adaptive sampler
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from
+ *   `stan::callbacks::structured_writer`
+ * @param[in,out] scheduler scheduler running the chains
+ * @param[in,out] samplers the mcmc sampler of each chain
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vectors initial parameter values of each chain
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] rngs random number generator of each chain
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writers writer for draws of each chain
+ * @param[in,out] diagnostic_writers writer for diagnostic information of
+ *   each chain
+ * @param[in,out] metric_writers writer for adapted stepsize, metric of
+ *   each chain
+ * @param[in] init_chain_id id of the first chain, used in output
+ */
+template <typename Sampler, typename Model, typename RNG,
+          typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+void run_scheduled_adaptive_sampler(
+    chain_scheduler& scheduler, std::vector<Sampler>& samplers, Model& model,
+    std::vector<std::vector<double>>& cont_vectors, int num_warmup,
+    int num_samples, int num_thin, int refresh, bool save_warmup,
+    std::vector<RNG>& rngs, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, std::vector<SampleWriter>& sample_writers,
+    std::vector<DiagnosticWriter>& diagnostic_writers,
+    std::vector<MetricWriter>& metric_writers, size_t init_chain_id = 1) {
+  const size_t num_chains = samplers.size();
+  std::vector<resumable_chain<true, Sampler, Model, RNG>> chains;
+  chains.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i)
+    chains.emplace_back(samplers[i], model, cont_vectors[i], num_warmup,
+                        num_samples, num_thin, refresh, save_warmup, rngs[i],
+                        interrupt, logger, sample_writers[i],
+                        diagnostic_writers[i], metric_writers[i],
+                        init_chain_id + i, num_chains);
+  scheduler.run(chains);
+}
+
+/**
+ * Runs several chains of a sampler without adaptation independently,
+ * interleaved by the scheduler, with the output of each as written by
+ * <code>run_sampler</code>.
+ *
+ * @tparam Sampler Type of sampler
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @param[in,out] scheduler scheduler running the chains
+ * @param[in,out] samplers the mcmc sampler of each chain
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vectors initial parameter values of each chain
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] rngs random number generator of each chain
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writers writer for draws of each chain
+ * @param[in,out] diagnostic_writers writer for diagnostic information of
+ *   each chain
+ * @param[in] init_chain_id id of the first chain, used in output
+ */
+template <typename Sampler, typename Model, typename RNG,
+          typename SampleWriter, typename DiagnosticWriter>
+void run_scheduled_sampler(chain_scheduler& scheduler,
+                           std::vector<Sampler>& samplers, Model& model,
+                           std::vector<std::vector<double>>& cont_vectors,
+                           int num_warmup, int num_samples, int num_thin,
+                           int refresh, bool save_warmup,
+                           std::vector<RNG>& rngs,
+                           callbacks::interrupt& interrupt,
+                           callbacks::logger& logger,
+                           std::vector<SampleWriter>& sample_writers,
+                           std::vector<DiagnosticWriter>& diagnostic_writers,
+                           size_t init_chain_id = 1) {
+  const size_t num_chains = samplers.size();
+  callbacks::structured_writer dummy_metric_writer;
+  std::vector<resumable_chain<false, Sampler, Model, RNG>> chains;
+  chains.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i)
+    chains.emplace_back(samplers[i], model, cont_vectors[i], num_warmup,
+                        num_samples, num_thin, refresh, save_warmup, rngs[i],
+                        interrupt, logger, sample_writers[i],
+                        diagnostic_writers[i], dummy_metric_writer,
+                        init_chain_id + i, num_chains);
+  scheduler.run(chains);
+}
+
+/**
+ * Runs a chain to the end, writing a checkpoint of it every
+ * <code>checkpoint_interval</code> iterations until it finishes.
+ *
+ * @tparam Chain type of chain, a <code>resumable_chain</code>
+ * @param[in,out] chain chain, started or resumed
+ * @param[in,out] checkpoint_writer writer for checkpoints
+ * @param[in] checkpoint_interval number of iterations between
+ *   checkpoints; zero or negative writes none
+ */
+template <typename Chain>
+void run_checkpointed_chain(Chain& chain,
+                            callbacks::structured_writer& checkpoint_writer,
+                            int checkpoint_interval) {
+  const int block_size = checkpoint_interval > 0
+                             ? checkpoint_interval
+                             : std::max(1, chain.progress().num_iterations);
+  while (!chain.finished()) {
+    chain.run_block(block_size);
+    if (checkpoint_interval > 0 && !chain.finished())
+      chain.write_checkpoint(checkpoint_writer);
+  }
+}
+
+/**
+ * Runs the sampler with adaptation as <code>run_adaptive_sampler</code>
+ * does, writing a checkpoint of the chain to the checkpoint writer every
+ * <code>checkpoint_interval</code> iterations, and optionally resuming
+ * from a checkpoint instead of starting from the initial values.
+ *
+ * A resumed run writes no headers, and its output picks up from the
+ * iteration of the checkpoint, so appended to the output of the original
+ * run up to that checkpoint it gives the output of an uninterrupted
+ * run.  Output that the original run wrote after its last checkpoint
+ * must be discarded.
+ *
+ * Each checkpoint is a record of its own.  A checkpoint writer should
+ * keep the last complete record, for example by writing each one to a
+ * new file and renaming it over the previous one on
+ * <code>end_record</code>.
+ *
+ * @tparam Sampler Type of adaptive sampler.
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @param[in,out] sampler the mcmc sampler to use on the model
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vector initial parameter values, ignored when resuming
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] rng random number generator
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writer writer for draws
+ * @param[in,out] diagnostic_writer writer for diagnostic information
+ * @param[in,out] metric_writer writer for adapted stepsize, metric
+ * @param[in,out] checkpoint_writer writer for checkpoints
+ * @param[in] checkpoint_interval number of iterations between
+ *   checkpoints; zero or negative writes none
+ * @param[in] checkpoint checkpoint to resume from, or <code>nullptr</code>
+ *   to start from the initial values
+ * @param[in] chain_id The id for a given chain, (optional, default == 1)
+ * @param[in] num_chains The number of chains used in the program. This
+ *  is used in generate transitions to print out the chain number,
+ *  (optional, default == 1)
+ * @throw std::invalid_argument if the checkpoint is invalid
+ */
+template <typename Sampler, typename Model, typename RNG>
+void run_checkpointed_adaptive_sampler(
+    Sampler& sampler, Model& model, std::vector<double>& cont_vector,
+    int num_warmup, int num_samples, int num_thin, int refresh,
+    bool save_warmup, RNG& rng, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, callbacks::writer& sample_writer,
+    callbacks::writer& diagnostic_writer,
+    callbacks::structured_writer& metric_writer,
+    callbacks::structured_writer& checkpoint_writer, int checkpoint_interval,
+    const io::var_context* checkpoint, size_t chain_id = 1,
+    size_t num_chains = 1) {
+  resumable_chain<true, Sampler, Model, RNG> chain(
+      sampler, model, cont_vector, num_warmup, num_samples, num_thin, refresh,
+      save_warmup, rng, interrupt, logger, sample_writer, diagnostic_writer,
+      metric_writer, chain_id, num_chains);
+  if (checkpoint != nullptr)
+    chain.resume(*checkpoint);
+  run_checkpointed_chain(chain, checkpoint_writer, checkpoint_interval);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -1,11 +1,15 @@
 #ifndef STAN_SERVICES_UTIL_RUN_ADAPTIVE_SAMPLER_HPP
 #define STAN_SERVICES_UTIL_RUN_ADAPTIVE_SAMPLER_HPP
 
+#include <stan/callbacks/instrumentation.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/structured_writer.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/services/util/diagnostic_output.hpp>
 #include <stan/services/util/generate_transitions.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/memory_policy.hpp>
+#include <stan/services/util/output_selection.hpp>
 #include <tbb/parallel_for.h>
 #include <chrono>
 #include <iostream>
@@ -42,6 +46,16 @@ namespace util {
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number,
  *  (optional, default == 1)
+ * @param[in,out] instrumentation callback that receives the measurements
+ *  of each transition, (optional, default == nullptr)
+ * @param[in] selection model columns written for each draw, or all of
+ *  them when null, (optional, default == nullptr)
+ * @param[in] num_gq_threads number of threads computing the transformed
+ *  parameters and generated quantities of the draws while the chain goes
+ *  on, or zero to compute them on the thread of the chain, (optional,
+ *  default == 0)
+ * @param[in] diagnostics reduction of the diagnostic output, or all of it
+ *  when null, (optional, default == nullptr)
  */
 template <typename Sampler, typename Model, typename RNG>
 void run_adaptive_sampler(Sampler& sampler, Model& model,
@@ -53,10 +67,15 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
                           callbacks::writer& sample_writer,
                           callbacks::writer& diagnostic_writer,
                           callbacks::structured_writer& metric_writer,
-                          size_t chain_id = 1, size_t num_chains = 1) {
+                          size_t chain_id = 1, size_t num_chains = 1,
+                          callbacks::instrumentation* instrumentation = 0,
+                          const output_selection* selection = 0,
+                          size_t num_gq_threads = 0,
+                          const diagnostic_output* diagnostics = 0) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
 
+  apply_memory_policy(get_memory_policy(), sampler);
   sampler.engage_adaptation();
   try {
     sampler.z().q = cont_params;
@@ -67,18 +86,22 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
     return;
   }
 
-  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
+  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger,
+                                     selection, diagnostics);
   stan::mcmc::sample s(cont_params, 0, 0);
 
   // Headers
   writer.write_sample_names(s, sampler, model);
   writer.write_diagnostic_names(s, sampler, model);
+  if (num_gq_threads > 0)
+    writer.start_gq_pipeline(model, rng, chain_id, num_gq_threads);
 
   auto start_warm = std::chrono::steady_clock::now();
   util::generate_transitions(sampler, num_warmup, 0, num_warmup + num_samples,
                              num_thin, refresh, save_warmup, true, writer, s,
                              model, rng, interrupt, logger, chain_id,
-                             num_chains);
+                             num_chains, 0, instrumentation);
+  writer.wait_for_draws();
   auto end_warm = std::chrono::steady_clock::now();
   double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                             end_warm - start_warm)
@@ -88,18 +111,21 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
   writer.write_adapt_finish(sampler);
   sampler.write_sampler_state(sample_writer);
   sampler.write_sampler_state_struct(metric_writer);
+  writer.flush();
 
   auto start_sample = std::chrono::steady_clock::now();
   util::generate_transitions(sampler, num_samples, num_warmup,
                              num_warmup + num_samples, num_thin, refresh, true,
                              false, writer, s, model, rng, interrupt, logger,
-                             chain_id, num_chains);
+                             chain_id, num_chains, 0, instrumentation);
+  writer.wait_for_draws();
   auto end_sample = std::chrono::steady_clock::now();
   double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                               end_sample - start_sample)
                               .count()
                           / 1000.0;
   writer.write_timing(warm_delta_t, sample_delta_t);
+  writer.flush();
 }
 
 /**
@@ -127,6 +153,16 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number,
  *  (optional, default == 1)
+ * @param[in,out] instrumentation callback that receives the measurements
+ *  of each transition, (optional, default == nullptr)
+ * @param[in] selection model columns written for each draw, or all of
+ *  them when null, (optional, default == nullptr)
+ * @param[in] num_gq_threads number of threads computing the transformed
+ *  parameters and generated quantities of the draws while the chain goes
+ *  on, or zero to compute them on the thread of the chain, (optional,
+ *  default == 0)
+ * @param[in] diagnostics reduction of the diagnostic output, or all of it
+ *  when null, (optional, default == nullptr)
  */
 template <typename Sampler, typename Model, typename RNG>
 void run_adaptive_sampler(Sampler& sampler, Model& model,
@@ -137,12 +173,17 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
                           callbacks::logger& logger,
                           callbacks::writer& sample_writer,
                           callbacks::writer& diagnostic_writer,
-                          size_t chain_id = 1, size_t num_chains = 1) {
+                          size_t chain_id = 1, size_t num_chains = 1,
+                          callbacks::instrumentation* instrumentation = 0,
+                          const output_selection* selection = 0,
+                          size_t num_gq_threads = 0,
+                          const diagnostic_output* diagnostics = 0) {
   callbacks::structured_writer dummy_metric_writer;
   return run_adaptive_sampler(
       sampler, model, cont_vector, num_warmup, num_samples, num_thin, refresh,
       save_warmup, rng, interrupt, logger, sample_writer, diagnostic_writer,
-      dummy_metric_writer, chain_id, num_chains);
+      dummy_metric_writer, chain_id, num_chains, instrumentation, selection,
+      num_gq_threads, diagnostics);
 }
 
 }  // namespace util
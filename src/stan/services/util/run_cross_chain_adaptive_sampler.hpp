@@ -0,0 +1,588 @@
+#ifndef STAN_SERVICES_UTIL_RUN_CROSS_CHAIN_ADAPTIVE_SAMPLER_HPP
+#define STAN_SERVICES_UTIL_RUN_CROSS_CHAIN_ADAPTIVE_SAMPLER_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/stepsize_covar_adapter.hpp>
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+#include <stan/services/util/chain_communicator.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/warmup_converged.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+inline stan::mcmc::var_adaptation& metric_adaptation(
+    stan::mcmc::stepsize_var_adapter& sampler) {
+  return sampler.get_var_adaptation();
+}
+
+inline stan::mcmc::covar_adaptation& metric_adaptation(
+    stan::mcmc::stepsize_covar_adapter& sampler) {
+  return sampler.get_covar_adaptation();
+}
+
+inline void pool_metric(
+    const std::vector<stan::mcmc::var_adaptation*>& adaptations,
+    Eigen::VectorXd& inv_metric, chain_communicator* communicator = nullptr) {
+  stan::mcmc::var_adaptation::pool_variance(
+      adaptations, inv_metric,
+      [communicator](double& n, Eigen::VectorXd& mean, Eigen::VectorXd& m2) {
+        if (communicator != nullptr)
+          combine_moments(*communicator, n, mean, m2);
+      });
+}
+
+inline void pool_metric(
+    const std::vector<stan::mcmc::covar_adaptation*>& adaptations,
+    Eigen::MatrixXd& inv_metric, chain_communicator* communicator = nullptr) {
+  stan::mcmc::covar_adaptation::pool_covariance(
+      adaptations, inv_metric,
+      [communicator](double& n, Eigen::VectorXd& mean, Eigen::MatrixXd& m2) {
+        if (communicator != nullptr)
+          combine_moments(*communicator, n, mean, m2);
+      });
+}
+
+/**
+ * Set the nominal step size of every chain to the geometric mean of
+ * their nominal step sizes, over the chains of every process if a
+ * communicator is specified.
+ *
+ * @tparam Sampler Type of adaptive sampler
+ * @param[in,out] samplers samplers for each chain
+ * @param[in,out] communicator processes running the other chains, or
+ *   null
+ * @return pooled step size
+ */
+template <typename Sampler>
+double pool_stepsize(std::vector<Sampler>& samplers,
+                     chain_communicator* communicator = nullptr) {
+  double log_epsilon = 0;
+  for (auto& sampler : samplers)
+    log_epsilon += std::log(sampler.get_nominal_stepsize());
+  double num_chains = samplers.size();
+  if (communicator != nullptr && communicator->size() > 1) {
+    const std::vector<double> all
+        = communicator->all_gather({log_epsilon, num_chains});
+    log_epsilon = 0;
+    num_chains = 0;
+    for (size_t r = 0; r < all.size(); r += 2) {
+      log_epsilon += all[r];
+      num_chains += all[r + 1];
+    }
+  }
+  double epsilon = std::exp(log_epsilon / num_chains);
+  for (auto& sampler : samplers)
+    sampler.set_nominal_stepsize(epsilon);
+  return epsilon;
+}
+
+namespace internal {
+
+/**
+ * Return the median of the values.
+ *
+ * @param[in] values values, not empty
+ */
+inline double median(std::vector<double> values) {
+  const size_t half = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + half, values.end());
+  const double upper = values[half];
+  if (values.size() % 2 == 1)
+    return upper;
+  return (*std::max_element(values.begin(), values.begin() + half) + upper)
+         / 2;
+}
+
+}  // namespace internal
+
+/**
+ * Return which chains of a pooled warmup are stuck, judged from their
+ * draws over the last adaptation window against the medians over the
+ * chains.  A chain is stuck if its mean lp__ is below the median by more
+ * than <code>threshold</code> times the median standard deviation of
+ * lp__ within a chain, as when it is caught in a minor mode, if its
+ * nominal step size is less than the median divided by
+ * <code>threshold</code>, or if its mean tree depth exceeds the median by
+ * more than <code>log2(threshold)</code>, the depth by which a step size
+ * that much smaller lengthens the trajectories.  If half of the chains
+ * or more would be stuck, none is, since the medians then say little
+ * about what a healthy chain looks like.
+ *
+ * @param[in] lp_means mean lp__ of each chain
+ * @param[in] lp_sds standard deviation of lp__ of each chain
+ * @param[in] stepsizes nominal step size of each chain
+ * @param[in] treedepths mean tree depth of each chain, or empty for a
+ *   sampler without trees
+ * @param[in] threshold how far from the others a chain must be to be
+ *   stuck, greater than one
+ * @return true for each chain that is stuck
+ */
+inline std::vector<bool> stuck_chains(const std::vector<double>& lp_means,
+                                      const std::vector<double>& lp_sds,
+                                      const std::vector<double>& stepsizes,
+                                      const std::vector<double>& treedepths,
+                                      double threshold) {
+  const size_t num_chains = lp_means.size();
+  std::vector<bool> stuck(num_chains, false);
+  if (num_chains < 3 || !(threshold > 1))
+    return stuck;
+  const double lp_median = internal::median(lp_means);
+  const double lp_sd = internal::median(lp_sds);
+  const double stepsize_median = internal::median(stepsizes);
+  const double depth_median
+      = treedepths.empty() ? 0 : internal::median(treedepths);
+  size_t num_stuck = 0;
+  for (size_t i = 0; i < num_chains; ++i) {
+    stuck[i] = (lp_sd > 0 && lp_median - lp_means[i] > threshold * lp_sd)
+               || stepsizes[i] < stepsize_median / threshold
+               || (!treedepths.empty()
+                   && treedepths[i] > depth_median + std::log2(threshold));
+    num_stuck += stuck[i];
+  }
+  if (2 * num_stuck >= num_chains)
+    stuck.assign(num_chains, false);
+  return stuck;
+}
+
+namespace internal {
+
+/**
+ * Return the largest potential scale reduction, over lp__ and the
+ * unconstrained parameters, of the sampling draws of the chains of every
+ * process, computed from the means and variances of the chains.
+ *
+ * @param[in,out] communicator processes running the chains
+ * @param[in] moments running moments of the draws of each local chain
+ * @param[in] dim number of columns of the draws
+ * @param[out] num_chains number of chains over all processes
+ */
+inline double max_rhat(
+    chain_communicator& communicator,
+    std::vector<stan::math::welford_var_estimator>& moments,
+    Eigen::Index dim, double& num_chains) {
+  const std::vector<double> counts
+      = communicator.all_gather({static_cast<double>(moments.size())});
+  const size_t max_local = *std::max_element(counts.begin(), counts.end());
+  const Eigen::Index stride = 1 + 2 * dim;
+  std::vector<double> local(max_local * stride, 0);
+  Eigen::VectorXd mean(dim);
+  Eigen::VectorXd var(dim);
+  for (size_t i = 0; i < moments.size(); ++i) {
+    moments[i].sample_mean(mean);
+    var.setZero();
+    moments[i].sample_variance(var);
+    local[i * stride] = moments[i].num_samples();
+    Eigen::Map<Eigen::VectorXd>(local.data() + i * stride + 1, dim) = mean;
+    Eigen::Map<Eigen::VectorXd>(local.data() + i * stride + 1 + dim, dim)
+        = var;
+  }
+  const std::vector<double> all = communicator.all_gather(local);
+  std::vector<const double*> chains;
+  double n = std::numeric_limits<double>::infinity();
+  for (size_t k = 0; k < all.size(); k += stride) {
+    if (all[k] < 2)
+      continue;
+    chains.push_back(all.data() + k);
+    n = std::min(n, all[k]);
+  }
+  num_chains = chains.size();
+  if (chains.size() < 2)
+    return 1;
+  double max_rhat = 0;
+  for (Eigen::Index c = 0; c < dim; ++c) {
+    double w = 0;
+    double chains_mean = 0;
+    for (const double* chain : chains) {
+      w += chain[1 + dim + c] / num_chains;
+      chains_mean += chain[1 + c] / num_chains;
+    }
+    double b_over_n = 0;
+    for (const double* chain : chains) {
+      const double d = chain[1 + c] - chains_mean;
+      b_over_n += d * d / (num_chains - 1);
+    }
+    const double rhat
+        = w == 0 ? (b_over_n == 0 ? 1 : std::numeric_limits<double>::infinity())
+                 : std::sqrt(((n - 1) / n * w + b_over_n) / w);
+    max_rhat = std::max(max_rhat, rhat);
+  }
+  return max_rhat;
+}
+
+}  // namespace internal
+
+/**
+ * Runs several chains of an adaptive sampler whose metric adaptation is
+ * shared across chains.  Warmup is generated in lockstep segments that
+ * end at the adaptation window boundaries; at each boundary the metric
+ * estimators of all chains are pooled into a single inverse metric that
+ * every chain continues with, and the step sizes found for it are pooled
+ * by their geometric mean.  The final step size is pooled in the same
+ * way at the end of warmup.  Sampling then proceeds independently.
+ *
+ * If <code>max_warmup_rhat</code> is positive, warmup may also end
+ * early: at each window boundary that leaves further windows to run, the
+ * draws of lp__ and of the unconstrained parameters from the window just
+ * completed are checked with <code>warmup_converged</code>, and once they
+ * pass the remaining windows are skipped and warmup ends after a final
+ * terminal buffer of step size adaptation.
+ *
+ * If <code>stuck_chain_threshold</code> is greater than one and there are
+ * at least three chains, the chains are also checked at each window
+ * boundary with <code>stuck_chains</code>, from the mean and standard
+ * deviation of their lp__, their step sizes and their mean tree depths
+ * over the window just completed.  A stuck chain is restarted from the
+ * current state and step size of a healthy one, its window is left out of
+ * the pooled metric, and it then continues with the pooled metric like
+ * the others.  Each process checks its own chains.
+ *
+ * With a <code>communicator</code>, the chains may be split across
+ * several processes, each calling this function with its own chains and
+ * writers: the metric estimators and step sizes are then pooled over
+ * the chains of every process, warmup ends early only once the chains
+ * of every process pass the check, and after sampling the largest
+ * potential scale reduction over all chains of lp__ and of the
+ * unconstrained parameters is logged.  Every process must use the same
+ * numbers of warmup and sampling iterations and window parameters.
+ *
+ * Each sampler must already be configured with the same window
+ * parameters.
+ *
+ * @tparam Sampler Type of adaptive sampler, one of the diagonal or dense
+ *   metric adapters
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from
+ *   `stan::callbacks::structured_writer`
+ * @param[in,out] samplers the mcmc sampler of each chain
+ * @param[in] model the model concept to use for computing log probability
+ * @param[in] cont_vectors initial parameter values of each chain
+ * @param[in] num_warmup number of warmup draws
+ * @param[in] num_samples number of post warmup draws
+ * @param[in] num_thin number to thin the draws. Must be greater than
+ *   or equal to 1.
+ * @param[in] refresh controls output to the <code>logger</code>
+ * @param[in] save_warmup indicates whether the warmup draws should be
+ *   sent to the sample writer
+ * @param[in,out] rngs random number generator of each chain
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writers writer for draws of each chain
+ * @param[in,out] diagnostic_writers writer for diagnostic information of
+ *   each chain
+ * @param[in,out] metric_writers writer for adapted stepsize, metric of
+ *   each chain
+ * @param[in] init_chain_id id of the first chain, used in output
+ * @param[in] max_warmup_rhat largest R-hat at which warmup may end early;
+ *   zero or negative disables early termination
+ * @param[in] min_warmup_ess smallest effective sample size, over
+ *   all chains, at which warmup may end early
+ * @param[in,out] communicator processes running the other chains of a
+ *   run split across processes, or null for a single process
+ * @param[in] stuck_chain_threshold how far from the others a chain must
+ *   be at a window boundary to be restarted, as for
+ *   <code>stuck_chains</code>; one or less disables the check
+ */
+template <typename Sampler, typename Model, typename RNG,
+          typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+void run_cross_chain_adaptive_sampler(
+    std::vector<Sampler>& samplers, Model& model,
+    std::vector<std::vector<double>>& cont_vectors, int num_warmup,
+    int num_samples, int num_thin, int refresh, bool save_warmup,
+    std::vector<RNG>& rngs, callbacks::interrupt& interrupt,
+    callbacks::logger& logger, std::vector<SampleWriter>& sample_writers,
+    std::vector<DiagnosticWriter>& diagnostic_writers,
+    std::vector<MetricWriter>& metric_writers, size_t init_chain_id = 1,
+    double max_warmup_rhat = 0, double min_warmup_ess = 0,
+    chain_communicator* communicator = nullptr,
+    double stuck_chain_threshold = 0) {
+  const size_t num_chains = samplers.size();
+  const bool distributed = communicator != nullptr && communicator->size() > 1;
+  using adaptation_t = std::decay_t<decltype(metric_adaptation(samplers[0]))>;
+
+  std::vector<services::util::mcmc_writer> writers;
+  writers.reserve(num_chains);
+  std::vector<stan::mcmc::sample> draws;
+  draws.reserve(num_chains);
+  std::vector<adaptation_t*> adaptations;
+  adaptations.reserve(num_chains);
+  for (size_t i = 0; i < num_chains; ++i) {
+    Eigen::Map<Eigen::VectorXd> cont_params(cont_vectors[i].data(),
+                                            cont_vectors[i].size());
+    metric_adaptation(samplers[i]).set_pooling(true);
+    adaptations.push_back(&metric_adaptation(samplers[i]));
+    samplers[i].engage_adaptation();
+    try {
+      samplers[i].z().q = cont_params;
+      samplers[i].init_stepsize(logger);
+    } catch (const std::exception& e) {
+      logger.error("Exception initializing step size.");
+      logger.error(e.what());
+      return;
+    }
+    writers.emplace_back(sample_writers[i], diagnostic_writers[i], logger);
+    draws.emplace_back(cont_params, 0, 0);
+
+    // Headers
+    writers[i].write_sample_names(draws[i], samplers[i], model);
+    writers[i].write_diagnostic_names(draws[i], samplers[i], model);
+  }
+
+  const bool early_stop = max_warmup_rhat > 0;
+  std::vector<Eigen::MatrixXd> warmup_draws;
+  if (early_stop) {
+    for (size_t i = 0; i < num_chains; ++i)
+      warmup_draws.emplace_back(num_warmup, cont_vectors[i].size() + 1);
+  }
+
+  // running mean and sum of squared deviations of lp__ and sum of the
+  // tree depths of each chain over the current window
+  const bool check_stuck = stuck_chain_threshold > 1 && num_chains >= 3;
+  int window_size = 0;
+  std::vector<double> lp_means(num_chains, 0);
+  std::vector<double> lp_m2s(num_chains, 0);
+  std::vector<double> depth_sums(num_chains, 0);
+  std::vector<std::vector<double>> sampler_params(num_chains);
+  std::ptrdiff_t depth_index = -1;
+  if (check_stuck) {
+    std::vector<std::string> names;
+    samplers[0].get_sampler_param_names(names);
+    auto depth = std::find(names.begin(), names.end(), "treedepth__");
+    if (depth != names.end())
+      depth_index = depth - names.begin();
+  }
+  const bool stepwise = early_stop || check_stuck;
+
+  auto start_warm = std::chrono::steady_clock::now();
+  int num_generated = 0;
+  int window_begin = 0;
+  int warmup_end = num_warmup;
+  while (num_generated < warmup_end) {
+    int remaining = warmup_end - num_generated;
+    int num_segment = metric_adaptation(samplers[0]).iterations_to_window_end();
+    if (num_segment == 0 || num_segment > remaining || warmup_end < num_warmup)
+      num_segment = remaining;
+
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, num_chains, 1),
+        [&, num_generated, num_segment](const tbb::blocked_range<size_t>& r) {
+          for (size_t i = r.begin(); i != r.end(); ++i) {
+            if (!stepwise) {
+              util::generate_transitions(
+                  samplers[i], num_segment, num_generated,
+                  num_warmup + num_samples, num_thin, refresh, save_warmup,
+                  true, writers[i], draws[i], model, rngs[i], interrupt,
+                  logger, init_chain_id + i, num_chains, num_generated,
+                  nullptr, false);
+              continue;
+            }
+            for (int m = num_generated; m < num_generated + num_segment; ++m) {
+              util::generate_transitions(
+                  samplers[i], 1, m, num_warmup + num_samples, num_thin,
+                  refresh, save_warmup, true, writers[i], draws[i], model,
+                  rngs[i], interrupt, logger, init_chain_id + i, num_chains,
+                  m, nullptr, false);
+              if (early_stop) {
+                warmup_draws[i](m, 0) = draws[i].log_prob();
+                warmup_draws[i].row(m).tail(draws[i].size_cont())
+                    = draws[i].cont_params().transpose();
+              }
+              if (check_stuck) {
+                const int n = window_size + m - num_generated + 1;
+                const double delta = draws[i].log_prob() - lp_means[i];
+                lp_means[i] += delta / n;
+                lp_m2s[i] += delta * (draws[i].log_prob() - lp_means[i]);
+                if (depth_index >= 0) {
+                  sampler_params[i].clear();
+                  samplers[i].get_sampler_params(sampler_params[i]);
+                  depth_sums[i] += sampler_params[i][depth_index];
+                }
+              }
+            }
+          }
+        },
+        tbb::simple_partitioner());
+    num_generated += num_segment;
+    window_size += num_segment;
+
+    if (adaptations[0]->window_complete() && warmup_end == num_warmup) {
+      std::vector<adaptation_t*> pooled = adaptations;
+      if (check_stuck && window_size > 1) {
+        std::vector<double> lp_sds(num_chains);
+        std::vector<double> stepsizes(num_chains);
+        std::vector<double> depths;
+        for (size_t i = 0; i < num_chains; ++i) {
+          lp_sds[i] = std::sqrt(lp_m2s[i] / (window_size - 1));
+          stepsizes[i] = samplers[i].get_nominal_stepsize();
+          if (depth_index >= 0)
+            depths.push_back(depth_sums[i] / window_size);
+        }
+        const std::vector<bool> stuck = stuck_chains(
+            lp_means, lp_sds, stepsizes, depths, stuck_chain_threshold);
+        std::vector<size_t> healthy;
+        pooled.clear();
+        for (size_t i = 0; i < num_chains; ++i) {
+          if (!stuck[i]) {
+            healthy.push_back(i);
+            pooled.push_back(adaptations[i]);
+          }
+        }
+        size_t next = 0;
+        for (size_t i = 0; i < num_chains; ++i) {
+          if (!stuck[i])
+            continue;
+          const size_t j = healthy[next++ % healthy.size()];
+          std::stringstream msg;
+          msg << "Chain [" << init_chain_id + i << "] is stuck (mean lp__ "
+              << lp_means[i] << ", step size " << stepsizes[i];
+          if (depth_index >= 0)
+            msg << ", mean tree depth " << depths[i];
+          msg << "); restarting it from chain [" << init_chain_id + j
+              << "].";
+          logger.info(msg);
+          draws[i] = draws[j];
+          samplers[i].z().q = draws[j].cont_params();
+          samplers[i].set_nominal_stepsize(stepsizes[j]);
+          adaptations[i]->discard_window();
+        }
+      }
+      window_size = 0;
+      std::fill(lp_means.begin(), lp_means.end(), 0);
+      std::fill(lp_m2s.begin(), lp_m2s.end(), 0);
+      std::fill(depth_sums.begin(), depth_sums.end(), 0);
+
+      auto inv_metric = samplers[0].z().inv_e_metric_;
+      pool_metric(pooled, inv_metric, communicator);
+      for (auto& sampler : samplers) {
+        sampler.z().set_metric(inv_metric);
+        sampler.init_stepsize(logger);
+      }
+      double epsilon = pool_stepsize(samplers, communicator);
+      for (auto& sampler : samplers) {
+        sampler.get_stepsize_adaptation().set_mu(std::log(10 * epsilon));
+        sampler.get_stepsize_adaptation().restart();
+      }
+
+      bool converged
+          = early_stop && adaptations[0]->iterations_to_window_end() != 0
+            && warmup_converged(warmup_draws, window_begin, num_generated,
+                                max_warmup_rhat, min_warmup_ess);
+      if (distributed && early_stop
+          && adaptations[0]->iterations_to_window_end() != 0) {
+        const std::vector<double> all
+            = communicator->all_gather({converged ? 1.0 : 0.0});
+        converged = std::all_of(all.begin(), all.end(),
+                                [](double c) { return c == 1; });
+      }
+      if (converged) {
+        warmup_end = std::min<int>(
+            num_warmup, num_generated + adaptations[0]->term_buffer());
+        std::stringstream msg;
+        msg << "Warmup converged after " << num_generated
+            << " iterations; ending warmup at iteration " << warmup_end
+            << ".";
+        logger.info(msg);
+      }
+      window_begin = num_generated;
+    }
+  }
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+
+  // warmup is generated in segments, each of which leaves the summary of
+  // its rejections to the end of the phase
+  for (auto& sampler : samplers) {
+    sampler.write_rejection_summary(logger);
+    sampler.disengage_adaptation();
+  }
+  pool_stepsize(samplers, communicator);
+  for (size_t i = 0; i < num_chains; ++i) {
+    writers[i].write_adapt_finish(samplers[i]);
+    samplers[i].write_sampler_state(sample_writers[i]);
+    samplers[i].write_sampler_state_struct(metric_writers[i]);
+    writers[i].flush();
+  }
+
+  // running moments of lp__ and the unconstrained parameters of each
+  // chain, for the diagnostics over the chains of every process
+  std::vector<stan::math::welford_var_estimator> moments;
+  if (distributed)
+    moments.assign(num_chains, stan::math::welford_var_estimator(
+                                   model.num_params_r() + 1));
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, num_chains, 1),
+      [&](const tbb::blocked_range<size_t>& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          auto start_sample = std::chrono::steady_clock::now();
+          if (!distributed) {
+            util::generate_transitions(
+                samplers[i], num_samples, warmup_end,
+                warmup_end + num_samples, num_thin, refresh, true, false,
+                writers[i], draws[i], model, rngs[i], interrupt, logger,
+                init_chain_id + i, num_chains);
+          } else {
+            Eigen::VectorXd draw(draws[i].size_cont() + 1);
+            for (int m = 0; m < num_samples; ++m) {
+              if (util::generate_transitions(
+                      samplers[i], 1, warmup_end + m, warmup_end + num_samples,
+                      num_thin, refresh, true, false, writers[i], draws[i],
+                      model, rngs[i], interrupt, logger, init_chain_id + i,
+                      num_chains, m, nullptr, false)
+                  == 0)
+                break;
+              draw(0) = draws[i].log_prob();
+              draw.tail(draws[i].size_cont()) = draws[i].cont_params();
+              moments[i].add_sample(draw);
+            }
+            samplers[i].write_rejection_summary(logger);
+          }
+          auto end_sample = std::chrono::steady_clock::now();
+          double sample_delta_t
+              = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    end_sample - start_sample)
+                    .count()
+                / 1000.0;
+          writers[i].write_timing(warm_delta_t, sample_delta_t);
+          writers[i].flush();
+        }
+      },
+      tbb::simple_partitioner());
+
+  if (distributed) {
+    double num_all_chains = 0;
+    const double rhat = internal::max_rhat(
+        *communicator, moments, model.num_params_r() + 1, num_all_chains);
+    std::stringstream msg;
+    msg << "Largest potential scale reduction over the " << num_all_chains
+        << " chains of " << communicator->size() << " processes: " << rhat;
+    logger.info(msg);
+  }
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,197 @@
+#ifndef STAN_SERVICES_UTIL_RUN_PARALLEL_TEMPERING_SAMPLER_HPP
+#define STAN_SERVICES_UTIL_RUN_PARALLEL_TEMPERING_SAMPLER_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/temperature_ladder.hpp>
+#include <stan/model/tempered_model.hpp>
+#include <stan/services/util/generate_transitions.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Runs parallel tempering: one replica of an adaptive sampler per
+ * temperature of a ladder, each targeting the posterior raised to its
+ * inverse temperature through a <code>tempered_model</code>, all
+ * advanced in parallel on the TBB threads.  Every
+ * <code>swap_interval</code> iterations the replicas wait for each other
+ * and the ladder proposes exchanges of states between neighbouring
+ * temperatures, so the replica at temperature 1 receives states that
+ * crossed between modes at the higher temperatures.  The exchanges are
+ * made by the calling thread between parallel segments, so they need no
+ * locking.
+ *
+ * During warmup every replica adapts its own step size and metric and,
+ * unless <code>adapt_ladder</code> is false, the ladder adapts its
+ * temperatures toward its target swap rate.  Only the draws of the
+ * replica at temperature 1 are written; the final inverse temperatures
+ * and the swap rates of the sampling phase are written as comments to
+ * the sample writer and to the logger.
+ *
+ * @tparam Sampler Type of adaptive sampler of a
+ *   <code>tempered_model</code>
+ * @tparam Model Type of model
+ * @tparam RNG Type of random number generator
+ * @param[in,out] samplers a sampler per temperature, each holding the
+ *   replica of the same index
+ * @param[in,out] replicas tempered models, whose inverse temperatures are
+ *   set from the ladder
+ * @param[in,out] ladder temperatures and exchanges
+ * @param[in] model model, used to write the draws
+ * @param[in] cont_vectors initial unconstrained values of each replica
+ * @param[in] num_warmup number of warmup iterations
+ * @param[in] num_samples number of sampling iterations
+ * @param[in] num_thin period between saved samples
+ * @param[in] refresh period between progress messages
+ * @param[in] save_warmup true to write the warmup draws
+ * @param[in] swap_interval number of iterations between exchanges
+ * @param[in] adapt_ladder true to adapt the temperatures during warmup
+ * @param[in,out] rngs random number generator of each replica
+ * @param[in,out] swap_rng random number generator of the exchanges
+ * @param[in,out] interrupt interrupt callback
+ * @param[in,out] logger logger for messages
+ * @param[in,out] sample_writer writer for the draws at temperature 1
+ * @param[in,out] diagnostic_writer writer for the diagnostics at
+ *   temperature 1
+ * @param[in] chain_id id of the chain, used in progress messages
+ */
+template <typename Sampler, typename Model, typename RNG>
+void run_parallel_tempering_sampler(
+    std::vector<Sampler>& samplers,
+    std::vector<stan::model::tempered_model<Model>>& replicas,
+    stan::mcmc::temperature_ladder& ladder, Model& model,
+    std::vector<std::vector<double>>& cont_vectors, int num_warmup,
+    int num_samples, int num_thin, int refresh, bool save_warmup,
+    int swap_interval, bool adapt_ladder, std::vector<RNG>& rngs,
+    RNG& swap_rng, callbacks::interrupt& interrupt, callbacks::logger& logger,
+    callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
+    size_t chain_id = 1) {
+  const size_t num_replicas = samplers.size();
+  std::vector<stan::mcmc::sample> draws;
+  draws.reserve(num_replicas);
+  for (size_t k = 0; k < num_replicas; ++k) {
+    Eigen::Map<Eigen::VectorXd> cont_params(cont_vectors[k].data(),
+                                            cont_vectors[k].size());
+    replicas[k].set_inv_temperature(ladder.inv_temperature(k));
+    samplers[k].engage_adaptation();
+    try {
+      samplers[k].z().q = cont_params;
+      samplers[k].init_stepsize(logger);
+    } catch (const std::exception& e) {
+      logger.error("Exception initializing step size.");
+      logger.error(e.what());
+      return;
+    }
+    draws.emplace_back(cont_params, 0, 0);
+  }
+
+  // only the replica at temperature 1 writes, the others generate their
+  // transitions with saving turned off
+  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
+  callbacks::writer no_writer;
+  services::util::mcmc_writer no_mcmc_writer(no_writer, no_writer, logger);
+  writer.write_sample_names(draws[0], samplers[0], model);
+  writer.write_diagnostic_names(draws[0], samplers[0], model);
+
+  std::vector<double> log_probs(num_replicas);
+  std::vector<int> num_generated(num_replicas);
+  const int finish = num_warmup + num_samples;
+  // generates a phase in segments separated by rounds of exchanges,
+  // returning false if the interrupt requested a stop
+  auto run_phase = [&](int num_iterations, int start, bool warmup,
+                       bool save) {
+    bool completed = true;
+    for (int done = 0; done < num_iterations; done += swap_interval) {
+      const int segment = std::min(swap_interval, num_iterations - done);
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, num_replicas, 1),
+          [&](const tbb::blocked_range<size_t>& r) {
+            for (size_t k = r.begin(); k != r.end(); ++k) {
+              const bool target = k == 0;
+              num_generated[k] = util::generate_transitions(
+                  samplers[k], segment, start + done, finish, num_thin,
+                  target ? refresh : 0, target && save, warmup,
+                  target ? writer : no_mcmc_writer, draws[k], model, rngs[k],
+                  interrupt, logger, chain_id, 1, done, nullptr, false);
+            }
+          },
+          tbb::simple_partitioner());
+      if (*std::min_element(num_generated.begin(), num_generated.end())
+          < segment) {
+        completed = false;
+        break;
+      }
+
+      for (size_t k = 0; k < num_replicas; ++k)
+        log_probs[k] = draws[k].log_prob() / replicas[k].inv_temperature();
+      for (size_t k : ladder.exchange(log_probs, swap_rng))
+        std::swap(draws[k], draws[k + 1]);
+      if (ladder.adapting()) {
+        for (size_t k = 0; k < num_replicas; ++k)
+          replicas[k].set_inv_temperature(ladder.inv_temperature(k));
+      }
+    }
+    // one summary of the rejections of each replica per phase
+    for (auto& sampler : samplers)
+      sampler.write_rejection_summary(logger);
+    return completed;
+  };
+
+  if (adapt_ladder)
+    ladder.engage_adaptation();
+  auto start_warm = std::chrono::steady_clock::now();
+  const bool warmed_up = run_phase(num_warmup, 0, true, save_warmup);
+  auto end_warm = std::chrono::steady_clock::now();
+  double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            end_warm - start_warm)
+                            .count()
+                        / 1000.0;
+  ladder.disengage_adaptation();
+  ladder.reset_swap_rates();
+  for (auto& sampler : samplers)
+    sampler.disengage_adaptation();
+  writer.write_adapt_finish(samplers[0]);
+  samplers[0].write_sampler_state(sample_writer);
+  std::stringstream temperatures;
+  temperatures << "Inverse temperatures: ";
+  for (size_t k = 0; k < num_replicas; ++k)
+    temperatures << (k > 0 ? ", " : "") << ladder.inv_temperature(k);
+  sample_writer(temperatures.str());
+  logger.info(temperatures);
+  writer.flush();
+
+  auto start_sample = std::chrono::steady_clock::now();
+  if (warmed_up)
+    run_phase(num_samples, num_warmup, false, true);
+  auto end_sample = std::chrono::steady_clock::now();
+  double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              end_sample - start_sample)
+                              .count()
+                          / 1000.0;
+  if (num_replicas > 1) {
+    std::stringstream rates;
+    rates << "Swap rates: ";
+    for (size_t k = 0; k + 1 < num_replicas; ++k)
+      rates << (k > 0 ? ", " : "") << ladder.swap_rate(k);
+    sample_writer(rates.str());
+    logger.info(rates);
+  }
+  writer.write_timing(warm_delta_t, sample_delta_t);
+  writer.flush();
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -1,10 +1,14 @@
 #ifndef STAN_SERVICES_UTIL_RUN_SAMPLER_HPP
 #define STAN_SERVICES_UTIL_RUN_SAMPLER_HPP
 
+#include <stan/callbacks/instrumentation.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/services/util/diagnostic_output.hpp>
 #include <stan/services/util/generate_transitions.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
+#include <stan/services/util/memory_policy.hpp>
+#include <stan/services/util/output_selection.hpp>
 #include <chrono>
 #include <vector>
 
@@ -35,6 +39,14 @@ namespace util {
  * @param[in] chain_id The id for a given chain.
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number.
+ * @param[in,out] instrumentation optional callback that receives the
+ *  measurements of each transition
+ * @param[in] selection optional selection of the model columns written
+ *  for each draw
+ * @param[in] num_gq_threads optional number of threads computing the
+ *  transformed parameters and generated quantities of the draws while the
+ *  chain goes on, or zero to compute them on the thread of the chain
+ * @param[in] diagnostics optional reduction of the diagnostic output
  */
 template <class Model, class RNG>
 void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
@@ -43,21 +55,30 @@ void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
                  RNG& rng, callbacks::interrupt& interrupt,
                  callbacks::logger& logger, callbacks::writer& sample_writer,
                  callbacks::writer& diagnostic_writer, size_t chain_id = 1,
-                 size_t num_chains = 1) {
+                 size_t num_chains = 1,
+                 callbacks::instrumentation* instrumentation = 0,
+                 const output_selection* selection = 0,
+                 size_t num_gq_threads = 0,
+                 const diagnostic_output* diagnostics = 0) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
-  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
+  reserve_ad_arena(get_memory_policy());
+  services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger,
+                                     selection, diagnostics);
   stan::mcmc::sample s(cont_params, 0, 0);
 
   // Headers
   writer.write_sample_names(s, sampler, model);
   writer.write_diagnostic_names(s, sampler, model);
+  if (num_gq_threads > 0)
+    writer.start_gq_pipeline(model, rng, chain_id, num_gq_threads);
 
   auto start_warm = std::chrono::steady_clock::now();
   util::generate_transitions(sampler, num_warmup, 0, num_warmup + num_samples,
                              num_thin, refresh, save_warmup, true, writer, s,
                              model, rng, interrupt, logger, chain_id,
-                             num_chains);
+                             num_chains, 0, instrumentation);
+  writer.wait_for_draws();
   auto end_warm = std::chrono::steady_clock::now();
   double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                             end_warm - start_warm)
@@ -65,18 +86,21 @@ void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
                         / 1000.0;
   writer.write_adapt_finish(sampler);
   sampler.write_sampler_state(sample_writer);
+  writer.flush();
 
   auto start_sample = std::chrono::steady_clock::now();
   util::generate_transitions(sampler, num_samples, num_warmup,
                              num_warmup + num_samples, num_thin, refresh, true,
                              false, writer, s, model, rng, interrupt, logger,
-                             chain_id, num_chains);
+                             chain_id, num_chains, 0, instrumentation);
+  writer.wait_for_draws();
   auto end_sample = std::chrono::steady_clock::now();
   double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                               end_sample - start_sample)
                               .count()
                           / 1000.0;
   writer.write_timing(warm_delta_t, sample_delta_t);
+  writer.flush();
 }
 }  // namespace util
 }  // namespace services
@@ -0,0 +1,213 @@
+#ifndef STAN_SERVICES_UTIL_SELECT_METRIC_HPP
+#define STAN_SERVICES_UTIL_SELECT_METRIC_HPP
+
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * The Euclidean metric chosen by <code>select_metric</code>, with the
+ * predictions it was chosen from and the inverse metric estimated for
+ * it.
+ */
+struct metric_selection {
+  /**
+   * Chosen metric, <code>"diag_e"</code>, <code>"lowrank_e"</code> or
+   * <code>"dense_e"</code>, as named by the metric types of the points.
+   */
+  std::string metric;
+  /**
+   * Predicted condition numbers of the target preconditioned by each
+   * metric, infinite for a metric that cannot be estimated.
+   */
+  double condition_diag;
+  double condition_lowrank;
+  double condition_dense;
+  /**
+   * Predicted costs of a draw with each metric, in seconds, up to a
+   * factor common to the metrics.
+   */
+  double cost_diag;
+  double cost_lowrank;
+  double cost_dense;
+  /**
+   * Regularized covariance of the draws, the inverse metric of the dense
+   * metric.
+   */
+  Eigen::MatrixXd covariance;
+  /**
+   * Diagonal and low-rank factor of the inverse metric of the low-rank
+   * metric, <code>diag(d) + U U^T</code>.
+   */
+  Eigen::VectorXd lowrank_diag;
+  Eigen::MatrixXd lowrank_factor;
+};
+
+/**
+ * Return the wall time of the product of a dense matrix of the specified
+ * size with a vector, which is the cost a dense metric adds to each use
+ * of the inverse metric.  Beyond a thousand dimensions the time is
+ * extrapolated from that of a thousand, quadratically, so that the
+ * measurement stays cheap.
+ *
+ * @param n size of the matrix
+ * @return seconds per product
+ */
+inline double time_dense_product(int n) {
+  const int m = std::min(n, 1000);
+  if (m <= 0)
+    return 0;
+  Eigen::MatrixXd a = Eigen::MatrixXd::Constant(m, m, 1.0 / m);
+  Eigen::VectorXd x = Eigen::VectorXd::Ones(m);
+  Eigen::VectorXd y(m);
+  using clock = std::chrono::steady_clock;
+  const clock::time_point start = clock::now();
+  int num_products = 0;
+  double elapsed = 0;
+  // at least a millisecond, and at least ten products, are timed
+  while (num_products < 10 || elapsed < 1e-3) {
+    y.noalias() = a * x;
+    x.swap(y);
+    ++num_products;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  }
+  // keeps the products from being optimized away
+  volatile double sink = x(0);
+  static_cast<void>(sink);
+  const double scale = static_cast<double>(n) / m;
+  return elapsed / num_products * scale * scale;
+}
+
+/**
+ * Choose between a diagonal, a low-rank and a dense Euclidean metric
+ * from draws of the target, for the least predicted time per draw.
+ *
+ * With a metric whose inverse is the covariance of the target up to
+ * what it fails to capture, the number of leapfrog steps of a draw grows
+ * as the square root of the condition number <code>kappa</code> of the
+ * preconditioned target, as the step size is set by its narrowest
+ * direction and the integration time by its widest.  With the
+ * eigenvalues <code>lambda</code> of the correlation matrix of the
+ * draws, the condition numbers are predicted as
+ * - diagonal: <code>lambda_max / lambda_min</code>;
+ * - low rank: the same without the <code>rank</code> largest
+ *   eigenvalues, which the correction removes;
+ * - dense: that of the noise of a covariance estimated from
+ *   <code>m</code> draws of <code>n</code> parameters,
+ *   <code>((1 + sqrt(n / m)) / (1 - sqrt(n / m)))^2</code>, infinite
+ *   when <code>m</code> is not larger than <code>n</code>.
+ *
+ * Each leapfrog step costs a gradient and two uses of the inverse
+ * metric, which take no time for the diagonal, the specified time of a
+ * dense product for the dense metric, and a fraction
+ * <code>2 rank / n</code> of it for the low-rank one.  The predicted cost
+ * of a draw is <code>sqrt(kappa)</code> times that of a step.  A metric
+ * other than the diagonal is only chosen if it is predicted to be at
+ * least 10% cheaper, as changing the metric costs warmup iterations.
+ *
+ * @param[in] draws draws of the unconstrained parameters
+ * @param[in] gradient_time seconds per gradient
+ * @param[in] product_time seconds per dense product, as measured by
+ *   <code>time_dense_product</code>
+ * @param[in] rank maximum rank of the low-rank metric, or zero not to
+ *   consider it
+ * @return chosen metric, its predictions and its inverse metric
+ * @throw std::invalid_argument if there are fewer than two draws, their
+ *   sizes differ or the rank is negative
+ * @throw std::domain_error if the draws are not finite
+ */
+inline metric_selection select_metric(const std::vector<Eigen::VectorXd>& draws,
+                                      double gradient_time,
+                                      double product_time, int rank) {
+  if (draws.size() < 2)
+    throw std::invalid_argument("select_metric: fewer than two draws");
+  if (rank < 0)
+    throw std::invalid_argument("Rank of the metric must be non-negative");
+  const Eigen::Index n = draws[0].size();
+  const double m = draws.size();
+  Eigen::VectorXd mean = Eigen::VectorXd::Zero(n);
+  for (const Eigen::VectorXd& draw : draws) {
+    if (draw.size() != n)
+      throw std::invalid_argument("select_metric: draws of different sizes");
+    mean += draw;
+  }
+  mean /= m;
+
+  metric_selection selection;
+  Eigen::MatrixXd& covar = selection.covariance;
+  covar = Eigen::MatrixXd::Zero(n, n);
+  for (const Eigen::VectorXd& draw : draws) {
+    Eigen::VectorXd delta = draw - mean;
+    covar.selfadjointView<Eigen::Lower>().rankUpdate(delta);
+  }
+  covar = covar.selfadjointView<Eigen::Lower>();
+  covar /= m - 1;
+  // shrunk towards a small multiple of the identity as covar_adaptation
+  // regularizes its estimates
+  covar = (m / (m + 5.0)) * covar
+          + 1e-3 * (5.0 / (m + 5.0)) * Eigen::MatrixXd::Identity(n, n);
+  if (!covar.allFinite())
+    throw std::domain_error("select_metric: draws are not finite");
+
+  const Eigen::VectorXd sd = covar.diagonal().cwiseSqrt();
+  const Eigen::VectorXd inv_sd = sd.cwiseInverse();
+  Eigen::MatrixXd corr = inv_sd.asDiagonal() * covar * inv_sd.asDiagonal();
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(corr);
+  // ascending
+  const Eigen::VectorXd& lambda = solver.eigenvalues();
+  const double lambda_min = lambda(0);
+  const int k = std::min<int>(rank, n);
+
+  selection.condition_diag = lambda(n - 1) / lambda_min;
+  selection.condition_lowrank
+      = k == 0 ? selection.condition_diag
+               : std::max(k < n ? lambda(n - 1 - k) : 1.0, 1.0) / lambda_min;
+  const double ratio = std::sqrt(n / m);
+  selection.condition_dense = ratio < 1
+                                  ? std::pow((1 + ratio) / (1 - ratio), 2)
+                                  : std::numeric_limits<double>::infinity();
+
+  selection.cost_diag = std::sqrt(selection.condition_diag) * gradient_time;
+  selection.cost_lowrank
+      = k == 0 ? std::numeric_limits<double>::infinity()
+               : std::sqrt(selection.condition_lowrank)
+                     * (gradient_time + 2 * product_time * 2.0 * k / n);
+  selection.cost_dense = std::sqrt(selection.condition_dense)
+                         * (gradient_time + 2 * product_time);
+
+  // the eigenvectors of the correlations above one, the variances a
+  // diagonal metric misses, scaled back to the parameters
+  selection.lowrank_diag = covar.diagonal();
+  selection.lowrank_factor = Eigen::MatrixXd::Zero(n, k);
+  for (int j = 0; j < k; ++j) {
+    const double excess = lambda(n - 1 - j) - 1;
+    if (excess > 0)
+      selection.lowrank_factor.col(j)
+          = std::sqrt(excess)
+            * sd.cwiseProduct(solver.eigenvectors().col(n - 1 - j));
+  }
+
+  const double best = std::min(selection.cost_lowrank, selection.cost_dense);
+  if (!(best < 0.9 * selection.cost_diag))
+    selection.metric = "diag_e";
+  else if (selection.cost_lowrank <= selection.cost_dense)
+    selection.metric = "lowrank_e";
+  else
+    selection.metric = "dense_e";
+  return selection;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
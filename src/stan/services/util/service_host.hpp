@@ -0,0 +1,319 @@
+#ifndef STAN_SERVICES_UTIL_SERVICE_HOST_HPP
+#define STAN_SERVICES_UTIL_SERVICE_HOST_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/model/model_base.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/util/rebind_data.hpp>
+#include <tbb/task_arena.h>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <typeindex>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Objects kept by a <code>service_host</code> for one model between
+ * requests, such as samplers or optimizer state sized for the model, so
+ * that a repeated request can reuse them instead of allocating them
+ * again.  There is at most one object of each type.
+ *
+ * The objects are dropped whenever the model is constructed again, since
+ * they may refer to the old model, but kept when new data are rebound,
+ * which leave the dimensions of the parameters unchanged.
+ */
+class service_workspace {
+ public:
+  /**
+   * Return the object of type <code>T</code>, constructing it first with
+   * <code>make()</code>, which returns a <code>std::unique_ptr<T></code>,
+   * if there is none.
+   *
+   * @tparam T type of the object
+   * @tparam F type of the factory
+   * @param[in] make factory of the object
+   * @return reference to the object, valid until the workspace is cleared
+   */
+  template <class T, class F>
+  T& get(F&& make) {
+    std::shared_ptr<void>& object = objects_[std::type_index(typeid(T))];
+    if (!object)
+      object = std::shared_ptr<T>(make());
+    return *static_cast<T*>(object.get());
+  }
+
+  /**
+   * Return true if there is an object of type <code>T</code>.
+   */
+  template <class T>
+  bool contains() const {
+    return objects_.count(std::type_index(typeid(T))) > 0;
+  }
+
+  size_t size() const noexcept { return objects_.size(); }
+
+  void clear() { objects_.clear(); }
+
+ private:
+  std::map<std::type_index, std::shared_ptr<void>> objects_;
+};
+
+/**
+ * <code>service_host</code> is a long lived host for repeated service
+ * requests, as from an interactive application, which keeps what each
+ * request would otherwise set up before its first gradient: the model
+ * constructed on its data, the parsed data contexts, a TBB arena with its
+ * threads started, and a <code>service_workspace</code> per model.  A
+ * repeated request then costs the time of the algorithm itself.
+ *
+ * Models are registered by name with a factory, and data contexts by
+ * name.  A request names a model and a data context and runs a service,
+ * any callable taking the model and its workspace and returning an
+ * error code, such as a lambda calling
+ * <code>stan::services::optimize::lbfgs</code> with the writers of the
+ * request.  The model is constructed on the first request, and again
+ * only if a request names other data which the model cannot rebind with
+ * <code>rebind_data</code>, such as data of other dimensions.  The seed
+ * is used when the model is constructed, so the transformed data of a
+ * kept model are not redrawn.
+ *
+ * Requests may be made from several threads.  Requests for different
+ * models run concurrently in the arena, while those for one model run
+ * one at a time.  A registered data context must not be changed while
+ * it is registered.
+ */
+class service_host {
+ public:
+  /**
+   * Type of the factories constructing a model from its data, a seed and
+   * a stream for messages, as <code>new_model</code> does.
+   */
+  using model_factory = std::function<std::unique_ptr<model::model_base>(
+      const io::var_context&, unsigned int, std::ostream*)>;
+
+  /**
+   * Construct a host whose requests run in an arena with the specified
+   * number of threads, which are started now.
+   *
+   * @param[in] num_threads number of threads, or
+   *   <code>tbb::task_arena::automatic</code> for those of the machine
+   */
+  explicit service_host(int num_threads = tbb::task_arena::automatic)
+      : arena_(num_threads) {
+    arena_.initialize();
+  }
+
+  service_host(const service_host&) = delete;
+  service_host& operator=(const service_host&) = delete;
+
+  /**
+   * Return the number of threads of the arena the requests run in.
+   */
+  int num_threads() { return arena_.max_concurrency(); }
+
+  /**
+   * Register a model, replacing any model of the same name once no
+   * request is running it.
+   *
+   * @param[in] name name of the model
+   * @param[in] factory factory constructing the model
+   * @throw std::invalid_argument if the factory is empty
+   */
+  void add_model(const std::string& name, model_factory factory) {
+    if (!factory)
+      throw std::invalid_argument("service_host: model " + name
+                                  + " has no factory");
+    std::shared_ptr<model_entry> entry = std::make_shared<model_entry>();
+    entry->factory = std::move(factory);
+    std::lock_guard<std::mutex> lock(mutex_);
+    models_[name] = std::move(entry);
+  }
+
+  /**
+   * Register a parsed data context, replacing any context of the same
+   * name.
+   *
+   * @param[in] name name of the data
+   * @param[in] data data context
+   * @throw std::invalid_argument if the context is null
+   */
+  void add_data(const std::string& name,
+                std::shared_ptr<const io::var_context> data) {
+    if (!data)
+      throw std::invalid_argument("service_host: data " + name
+                                  + " is null");
+    std::lock_guard<std::mutex> lock(mutex_);
+    data_[name] = std::move(data);
+  }
+
+  /**
+   * Unregister a model, which is destroyed once no request is running
+   * it.
+   *
+   * @param[in] name name of the model
+   * @return true if the model was registered
+   */
+  bool remove_model(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return models_.erase(name) > 0;
+  }
+
+  /**
+   * Unregister a data context, which is destroyed once no model is
+   * bound to it.
+   *
+   * @param[in] name name of the data
+   * @return true if the data was registered
+   */
+  bool remove_data(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return data_.erase(name) > 0;
+  }
+
+  /**
+   * Return the number of times the model of the specified name has been
+   * constructed, or zero if there is no such model.
+   */
+  size_t num_constructions(const std::string& name) const {
+    std::shared_ptr<model_entry> entry = find(models_, name);
+    if (!entry)
+      return 0;
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    return entry->num_constructions;
+  }
+
+  /**
+   * Run a service on the model of the specified name, bound to the data
+   * of the specified name, in the arena of the host.  Exceptions thrown
+   * by the service, or in constructing the model, are logged as errors.
+   *
+   * @tparam Service type of the service, callable as
+   *   <code>int(model::model_base&, service_workspace&)</code>
+   * @param[in] model_name name of the model
+   * @param[in] data_name name of the data
+   * @param[in] seed seed used if the model is constructed
+   * @param[in,out] logger logger for messages
+   * @param[in] service service to run
+   * @return error code of the service, <code>error_codes::CONFIG</code>
+   *   if the model or data are not registered, or
+   *   <code>error_codes::SOFTWARE</code> if an exception was thrown
+   */
+  template <class Service>
+  int run(const std::string& model_name, const std::string& data_name,
+          unsigned int seed, callbacks::logger& logger, Service&& service) {
+    std::shared_ptr<model_entry> entry = find(models_, model_name);
+    if (!entry) {
+      logger.error("Model " + model_name + " is not registered.");
+      return error_codes::CONFIG;
+    }
+    std::shared_ptr<const io::var_context> data = find(data_, data_name);
+    if (!data) {
+      logger.error("Data " + data_name + " is not registered.");
+      return error_codes::CONFIG;
+    }
+    std::lock_guard<std::mutex> lock(entry->mutex);
+    int return_code = error_codes::SOFTWARE;
+    arena_.execute([&]() {
+      try {
+        bind(*entry, data, seed, logger);
+        return_code = service(*entry->model, entry->workspace);
+      } catch (const std::exception& e) {
+        logger.error(e.what());
+      }
+    });
+    return return_code;
+  }
+
+ private:
+  struct model_entry {
+    model_factory factory;
+    std::mutex mutex;
+    std::unique_ptr<model::model_base> model;
+    std::shared_ptr<const io::var_context> data;
+    service_workspace workspace;
+    size_t num_constructions = 0;
+  };
+
+  tbb::task_arena arena_;
+  mutable std::mutex mutex_;
+  std::map<std::string, std::shared_ptr<model_entry>> models_;
+  std::map<std::string, std::shared_ptr<const io::var_context>> data_;
+
+  template <class Map>
+  typename Map::mapped_type find(const Map& map,
+                                 const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = map.find(name);
+    return it == map.end() ? nullptr : it->second;
+  }
+
+  /**
+   * Return true if the model supports rebinding and the context has its
+   * data variables with their dimensions.
+   */
+  static bool same_data_dims(const model::model_base& model,
+                             const io::var_context& data) {
+    std::vector<std::string> names;
+    std::vector<std::vector<size_t>> dims;
+    model.get_data_dims(names, dims);
+    if (names.empty())
+      return false;
+    for (size_t n = 0; n < names.size(); ++n)
+      if (!data.contains_r(names[n]) || data.dims_r(names[n]) != dims[n])
+        return false;
+    return true;
+  }
+
+  /**
+   * Bind the model of an entry to the data, rebinding a constructed model
+   * if it supports it and the data have the same dimensions, and
+   * constructing it otherwise.
+   */
+  static void bind(model_entry& entry,
+                   const std::shared_ptr<const io::var_context>& data,
+                   unsigned int seed, callbacks::logger& logger) {
+    if (entry.model && entry.data == data)
+      return;
+    if (entry.model && same_data_dims(*entry.model, *data)) {
+      entry.data.reset();
+      try {
+        if (rebind_data(*entry.model, *data, logger)) {
+          entry.data = data;
+          return;
+        }
+      } catch (...) {
+        // a model which failed to rebind must not be used again
+        entry.workspace.clear();
+        entry.model.reset();
+        throw;
+      }
+    }
+    entry.workspace.clear();
+    entry.model.reset();
+    std::stringstream msg;
+    entry.model = entry.factory(*data, seed, &msg);
+    if (msg.str().length() > 0)
+      logger.info(msg);
+    if (!entry.model)
+      throw std::runtime_error("Model factory returned no model");
+    entry.data = data;
+    ++entry.num_constructions;
+  }
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
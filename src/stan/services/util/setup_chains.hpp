@@ -0,0 +1,86 @@
+#ifndef STAN_SERVICES_UTIL_SETUP_CHAINS_HPP
+#define STAN_SERVICES_UTIL_SETUP_CHAINS_HPP
+
+#include <stan/callbacks/buffered_logger.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <cstddef>
+#include <exception>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Run the setup of each of several chains concurrently, such as their
+ * initialization and the reading of their inverse metrics, so that the
+ * startup of a multi-chain service takes about as long as that of its
+ * slowest chain rather than the sum over its chains.
+ *
+ * The setup of a chain must only use the state of that chain, such as
+ * its own random number generator, so that its results do not depend on
+ * the order in which the chains run.  The messages of each chain are
+ * kept and passed on to the logger in the order of the chains once all
+ * of them are done, so the log is that of a serial setup.
+ *
+ * A chain whose setup throws does not stop the others.  Its error is
+ * logged after its messages, and once the messages of all of the chains
+ * have been logged, so are the number of failed chains.
+ *
+ * @tparam Setup type of the setup, callable as
+ *   <code>void(size_t, callbacks::logger&)</code>
+ * @param[in] num_chains number of chains
+ * @param[in] init_chain_id id of the first chain, used in messages
+ * @param[in,out] logger logger for messages
+ * @param[in] setup setup of the chain of the specified index, logging to
+ *   the specified logger
+ * @return true if the setup of every chain succeeded
+ */
+template <typename Setup>
+inline bool setup_chains(size_t num_chains, unsigned int init_chain_id,
+                         callbacks::logger& logger, Setup&& setup) {
+  std::vector<callbacks::buffered_logger> chain_loggers(num_chains);
+  std::vector<std::string> errors(num_chains);
+  std::vector<char> failed(num_chains, false);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, num_chains, 1),
+      [&](const tbb::blocked_range<size_t>& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          try {
+            setup(i, chain_loggers[i]);
+          } catch (const std::exception& e) {
+            failed[i] = true;
+            errors[i] = e.what();
+          }
+        }
+      },
+      tbb::simple_partitioner());
+
+  size_t num_failed = 0;
+  for (size_t i = 0; i < num_chains; ++i) {
+    chain_loggers[i].flush(logger);
+    if (failed[i]) {
+      ++num_failed;
+      std::stringstream msg;
+      msg << "Chain " << init_chain_id + i << ": " << errors[i];
+      logger.error(msg);
+    }
+  }
+  if (num_failed > 0) {
+    std::stringstream msg;
+    msg << "Setup failed for " << num_failed << " of " << num_chains
+        << " chains.";
+    logger.error(msg);
+  }
+  return num_failed == 0;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef STAN_SERVICES_UTIL_SHARED_CONTEXTS_HPP
+#define STAN_SERVICES_UTIL_SHARED_CONTEXTS_HPP
+
+#include <cstddef>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Return a vector of non-owning pointers to the specified context, one
+ * per chain, for the multi-chain services which take a context per
+ * chain.  All of the chains then read the one parsed init or inverse
+ * metric source, and the services read and validate an inverse metric
+ * once for consecutive chains which share its context.
+ *
+ * The context must outlive the returned pointers.
+ *
+ * @tparam Context A type derived from `stan::io::var_context`
+ * @param[in] context context shared by the chains
+ * @param[in] num_chains number of chains
+ * @return vector of `num_chains` pointers to the context
+ */
+template <typename Context>
+inline std::vector<const Context*> shared_contexts(const Context& context,
+                                                   size_t num_chains) {
+  return std::vector<const Context*>(num_chains, &context);
+}
+
+/**
+ * Return true if the specified chain reads the same context as the
+ * chain before it, so that it can reuse what was read for that chain.
+ *
+ * @tparam ContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @param[in] contexts contexts of each chain
+ * @param[in] chain chain index
+ * @return true if the chain shares the previous chain's context
+ */
+template <typename ContextPtr>
+inline bool shares_previous_context(const std::vector<ContextPtr>& contexts,
+                                    size_t chain) {
+  return chain > 0 && &*contexts[chain] == &*contexts[chain - 1];
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -0,0 +1,448 @@
+#ifndef STAN_SERVICES_UTIL_TERMINATION_CONTROLLER_HPP
+#define STAN_SERVICES_UTIL_TERMINATION_CONTROLLER_HPP
+
+#include <stan/analyze/mcmc/online_diagnostics.hpp>
+#include <stan/analyze/mcmc/online_energy_diagnostics.hpp>
+#include <stan/analyze/mcmc/online_multivariate_ess.hpp>
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/services/util/output_selection.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>termination_controller</code> is an interrupt that stops the
+ * chains of a sampler together once the monitored parameters reach a
+ * target effective sample size and potential scale reduction, or once
+ * a wall clock budget is spent, so the number of samples of a service
+ * becomes an upper bound.
+ *
+ * Each chain feeds its draws to the controller through the writer
+ * returned by <code>monitor(chain)</code>, usually teed with its sample
+ * writer, and is run with the controller as its interrupt:
+ *
+ * <pre>
+ * termination_controller controller(num_chains, 400, 1.01, 30 * 60);
+ * std::vector<callbacks::tee_writer> writers;
+ * for (size_t i = 0; i < num_chains; ++i)
+ *   writers.emplace_back(sample_writers[i], controller.monitor(i));
+ * hmc_nuts_diag_e_adapt(model, num_chains, ..., controller, logger,
+ *                       init_writers, writers, diagnostic_writers);
+ * </pre>
+ *
+ * The monitors keep constant memory per column with
+ * <code>analyze::online_diagnostics</code> and drop the draws written
+ * before the comment <code>Adaptation terminated</code>.  Every
+ * <code>check_every</code> iterations, counted over all chains, the
+ * controller estimates for each monitored column the effective sample
+ * size as the sum of the batch means estimates of the chains and the
+ * potential scale reduction from the means and variances of the chains.
+ * Once every column reaches the targets, or the budget is spent, every
+ * chain stops at its next iteration and the service finishes normally,
+ * writing its timing and remaining output.
+ *
+ * Optionally the controller also requires a multivariate effective
+ * sample size of the monitored columns together, from
+ * <code>analyze::online_multivariate_ess</code>, and energy diagnostics
+ * of the chains, from the <code>energy__</code> and
+ * <code>divergent__</code> columns of their draws with
+ * <code>analyze::online_energy_diagnostics</code>; see
+ * <code>set_min_multivariate_ess</code> and
+ * <code>set_energy_targets</code>.
+ *
+ * The monitors and the interrupt may be called from the threads of
+ * concurrent chains.
+ */
+class termination_controller : public callbacks::interrupt {
+ public:
+  /**
+   * Constructs a controller and starts its clock.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] min_ess effective sample size each monitored column has to
+   *   reach
+   * @param[in] max_rhat largest potential scale reduction of a monitored
+   *   column
+   * @param[in] max_seconds wall clock budget in seconds from construction
+   * @param[in] patterns patterns of the monitored columns, as for
+   *   <code>output_selection</code>; by default every column except those
+   *   whose names end in <code>__</code>
+   * @param[in] check_every number of iterations, over all chains, between
+   *   estimates of the targets
+   * @param[in] num_batches minimum number of batch means of the effective
+   *   sample size estimate of a chain; must be at least 2
+   * @throw std::invalid_argument if there are no chains,
+   *   <code>check_every</code> is zero or <code>num_batches</code> is less
+   *   than 2
+   */
+  termination_controller(
+      size_t num_chains, double min_ess, double max_rhat = 1.01,
+      double max_seconds = std::numeric_limits<double>::infinity(),
+      const std::vector<std::string>& patterns = {}, size_t check_every = 100,
+      size_t num_batches = 32)
+      : min_ess_(min_ess),
+        max_rhat_(max_rhat),
+        max_seconds_(max_seconds),
+        patterns_(patterns),
+        check_every_(check_every),
+        start_(clock::now()) {
+    if (num_chains == 0)
+      throw std::invalid_argument(
+          "termination_controller: num_chains must be positive");
+    if (check_every_ == 0)
+      throw std::invalid_argument(
+          "termination_controller: check_every must be positive");
+    for (size_t i = 0; i < num_chains; ++i)
+      monitors_.emplace_back(new chain_monitor(*this, num_batches));
+  }
+
+  /**
+   * Also require the sum over the chains of the multivariate effective
+   * sample sizes of their monitored columns to reach the specified
+   * target.  The estimate of a chain costs time linear in the number of
+   * monitored columns per draw, with the columns projected on
+   * <code>num_projections</code> random directions, the same in every
+   * chain.  Must be called before the chains write their headers.
+   *
+   * @param[in] min_ess multivariate effective sample size to reach
+   * @param[in] num_projections largest number of random directions to
+   *   project the monitored columns on
+   * @throw std::invalid_argument if <code>num_projections</code> is zero
+   */
+  void set_min_multivariate_ess(double min_ess, size_t num_projections = 16) {
+    {
+      std::lock_guard<std::mutex> lock(check_mutex_);
+      min_multivariate_ess_ = min_ess;
+    }
+    for (auto& m : monitors_) {
+      std::lock_guard<std::mutex> lock(m->mutex);
+      m->multivariate.reset(new analyze::online_multivariate_ess(
+          num_projections, m->num_batches));
+    }
+  }
+
+  /**
+   * Also require the E-BFMI of every chain to be at least the specified
+   * minimum and the fraction of divergent transitions over all chains to
+   * be at most the specified maximum.  Chains whose draws have no
+   * <code>energy__</code> column are not held to the E-BFMI.
+   *
+   * @param[in] min_ebfmi smallest E-BFMI of a chain, for example 0.3
+   * @param[in] max_divergence_rate largest fraction of divergent
+   *   transitions
+   */
+  void set_energy_targets(double min_ebfmi, double max_divergence_rate) {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    min_ebfmi_ = min_ebfmi;
+    max_divergence_rate_ = max_divergence_rate;
+  }
+
+  /**
+   * Return the writer receiving the draws of a chain.
+   *
+   * @param[in] chain index of the chain, from zero
+   */
+  callbacks::writer& monitor(size_t chain) { return *monitors_.at(chain); }
+
+  void operator()() {
+    if (stop_)
+      return;
+    if (elapsed() >= max_seconds_) {
+      deadline_reached_ = true;
+      stop_ = true;
+      return;
+    }
+    if (++num_calls_ % check_every_ == 0 && check())
+      stop_ = true;
+  }
+
+  /**
+   * Return true once the chains should stop.  The budget is checked here
+   * too, so a sampler polling within a transition stops at the deadline
+   * rather than at its next iteration.
+   */
+  bool stop_requested() const {
+    if (stop_)
+      return true;
+    if (elapsed() < max_seconds_)
+      return false;
+    deadline_reached_ = true;
+    stop_ = true;
+    return true;
+  }
+
+  /**
+   * Return true if the chains were stopped by the budget.
+   */
+  bool deadline_reached() const noexcept { return deadline_reached_; }
+
+  /**
+   * Return the seconds elapsed since construction.
+   */
+  double elapsed() const {
+    return std::chrono::duration<double>(clock::now() - start_).count();
+  }
+
+  /**
+   * Estimates the targets from the draws received so far.  Called by the
+   * interrupt every <code>check_every</code> iterations; at most one
+   * estimate runs at a time, and a call made while another is running
+   * returns false.
+   *
+   * @return true if every monitored column reaches the targets
+   */
+  bool check() {
+    std::unique_lock<std::mutex> check_lock(check_mutex_, std::try_to_lock);
+    if (!check_lock.owns_lock())
+      return false;
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto& m : monitors_)
+      locks.emplace_back(m->mutex);
+
+    const analyze::online_diagnostics& first = monitors_[0]->diagnostics;
+    const size_t num_columns = first.num_columns();
+    double min_ess = std::numeric_limits<double>::infinity();
+    double max_rhat = 0;
+    bool any_monitored = false;
+    for (auto& m : monitors_)
+      if (m->diagnostics.num_draws() < 4
+          || m->diagnostics.num_columns() != num_columns)
+        return record(std::numeric_limits<double>::quiet_NaN(),
+                      std::numeric_limits<double>::quiet_NaN());
+    for (size_t c = 0; c < num_columns; ++c) {
+      if (!monitored(first.names(), c))
+        continue;
+      any_monitored = true;
+      double ess = 0;
+      for (auto& m : monitors_)
+        ess += m->diagnostics.ess(c);
+      min_ess = std::min(min_ess, std::isnan(ess) ? 0 : ess);
+      max_rhat = std::max(max_rhat, rhat(c));
+    }
+    if (!any_monitored)
+      return record(std::numeric_limits<double>::quiet_NaN(),
+                    std::numeric_limits<double>::quiet_NaN());
+
+    last_multivariate_ess_ = std::numeric_limits<double>::quiet_NaN();
+    if (min_multivariate_ess_ > 0) {
+      double ess = 0;
+      for (auto& m : monitors_)
+        ess += m->multivariate ? m->multivariate->ess() : 0;
+      last_multivariate_ess_ = ess;
+    }
+    double min_ebfmi = std::numeric_limits<double>::infinity();
+    size_t num_draws = 0;
+    size_t num_divergent = 0;
+    for (auto& m : monitors_) {
+      const double ebfmi = m->energy.ebfmi();
+      if (!std::isnan(ebfmi))
+        min_ebfmi = std::min(min_ebfmi, ebfmi);
+      num_draws += m->energy.num_draws();
+      num_divergent += m->energy.num_divergent();
+    }
+    last_min_ebfmi_ = std::isinf(min_ebfmi)
+                          ? std::numeric_limits<double>::quiet_NaN()
+                          : min_ebfmi;
+    last_divergence_rate_
+        = num_draws == 0 ? std::numeric_limits<double>::quiet_NaN()
+                         : static_cast<double>(num_divergent) / num_draws;
+    return record(min_ess, max_rhat);
+  }
+
+  /**
+   * Return the smallest effective sample size of a monitored column at
+   * the last estimate, or NaN before there is one.
+   */
+  double last_min_ess() const {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    return last_min_ess_;
+  }
+
+  /**
+   * Return the largest potential scale reduction of a monitored column at
+   * the last estimate, or NaN before there is one.
+   */
+  double last_max_rhat() const {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    return last_max_rhat_;
+  }
+
+  /**
+   * Return the multivariate effective sample size at the last estimate,
+   * or NaN before there is one or without a multivariate target.
+   */
+  double last_multivariate_ess() const {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    return last_multivariate_ess_;
+  }
+
+  /**
+   * Return the smallest E-BFMI of a chain at the last estimate, or NaN
+   * before there is one or without energies.
+   */
+  double last_min_ebfmi() const {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    return last_min_ebfmi_;
+  }
+
+  /**
+   * Return the fraction of divergent transitions over all chains at the
+   * last estimate, or NaN before there is one.
+   */
+  double last_divergence_rate() const {
+    std::lock_guard<std::mutex> lock(check_mutex_);
+    return last_divergence_rate_;
+  }
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Writer accumulating the sampling draws of a chain.
+   */
+  class chain_monitor : public callbacks::writer {
+   public:
+    chain_monitor(const termination_controller& controller,
+                  size_t num_batches)
+        : controller(controller),
+          num_batches(num_batches),
+          diagnostics(std::vector<double>(), num_batches) {}
+
+    void operator()(const std::vector<std::string>& names) {
+      std::lock_guard<std::mutex> lock(mutex);
+      diagnostics(names);
+      energy(names);
+      monitored_columns.clear();
+      if (!multivariate)
+        return;
+      std::vector<std::string> monitored_names;
+      for (size_t c = 0; c < names.size(); ++c) {
+        if (controller.monitored(names, c)) {
+          monitored_columns.push_back(c);
+          monitored_names.push_back(names[c]);
+        }
+      }
+      (*multivariate)(monitored_names);
+    }
+
+    void operator()(const std::vector<double>& state) {
+      std::lock_guard<std::mutex> lock(mutex);
+      diagnostics(state);
+      energy(state);
+      if (!multivariate || monitored_columns.empty())
+        return;
+      monitored_values.clear();
+      for (size_t c : monitored_columns)
+        if (c < state.size())
+          monitored_values.push_back(state[c]);
+      (*multivariate)(monitored_values);
+    }
+
+    void operator()(const std::string& message) {
+      if (message != "Adaptation terminated")
+        return;
+      std::lock_guard<std::mutex> lock(mutex);
+      diagnostics.reset();
+      energy.reset();
+      if (multivariate)
+        multivariate->reset();
+    }
+
+    const termination_controller& controller;
+    const size_t num_batches;
+    std::mutex mutex;
+    analyze::online_diagnostics diagnostics;
+    analyze::online_energy_diagnostics energy;
+    std::unique_ptr<analyze::online_multivariate_ess> multivariate;
+    std::vector<size_t> monitored_columns;
+    std::vector<double> monitored_values;
+  };
+
+  double min_ess_;
+  double max_rhat_;
+  double max_seconds_;
+  std::vector<std::string> patterns_;
+  size_t check_every_;
+  clock::time_point start_;
+  std::vector<std::unique_ptr<chain_monitor>> monitors_;
+  std::atomic<size_t> num_calls_{0};
+  mutable std::atomic<bool> stop_{false};
+  mutable std::atomic<bool> deadline_reached_{false};
+  mutable std::mutex check_mutex_;
+  double last_min_ess_ = std::numeric_limits<double>::quiet_NaN();
+  double last_max_rhat_ = std::numeric_limits<double>::quiet_NaN();
+  double min_multivariate_ess_ = 0;
+  double min_ebfmi_ = 0;
+  double max_divergence_rate_ = 1;
+  double last_multivariate_ess_ = std::numeric_limits<double>::quiet_NaN();
+  double last_min_ebfmi_ = std::numeric_limits<double>::quiet_NaN();
+  double last_divergence_rate_ = std::numeric_limits<double>::quiet_NaN();
+
+  bool monitored(const std::vector<std::string>& names, size_t c) const {
+    if (c >= names.size())
+      return false;
+    const std::string& name = names[c];
+    if (patterns_.empty())
+      return name.size() < 2 || name.compare(name.size() - 2, 2, "__") != 0;
+    for (const std::string& pattern : patterns_)
+      if (output_selection::selects(pattern, name))
+        return true;
+    return false;
+  }
+
+  /**
+   * Return the potential scale reduction of a column from the means and
+   * variances of the chains, or 1 for a single chain.
+   */
+  double rhat(size_t c) const {
+    const size_t num_chains = monitors_.size();
+    if (num_chains < 2)
+      return 1;
+    double n = std::numeric_limits<double>::infinity();
+    double w = 0;
+    double mean = 0;
+    for (auto& m : monitors_) {
+      n = std::min(n, static_cast<double>(m->diagnostics.num_draws()));
+      w += m->diagnostics.variance(c) / num_chains;
+      mean += m->diagnostics.mean(c) / num_chains;
+    }
+    double b_over_n = 0;
+    for (auto& m : monitors_) {
+      double d = m->diagnostics.mean(c) - mean;
+      b_over_n += d * d / (num_chains - 1);
+    }
+    if (w == 0)
+      return b_over_n == 0 ? 1 : std::numeric_limits<double>::infinity();
+    return std::sqrt(((n - 1) / n * w + b_over_n) / w);
+  }
+
+  bool record(double min_ess, double max_rhat) {
+    last_min_ess_ = min_ess;
+    last_max_rhat_ = max_rhat;
+    if (!(min_ess >= min_ess_ && max_rhat <= max_rhat_))
+      return false;
+    if (min_multivariate_ess_ > 0
+        && !(last_multivariate_ess_ >= min_multivariate_ess_))
+      return false;
+    if (min_ebfmi_ > 0 && last_min_ebfmi_ < min_ebfmi_)
+      return false;
+    return !(last_divergence_rate_ > max_divergence_rate_);
+  }
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
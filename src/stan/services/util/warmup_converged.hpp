@@ -0,0 +1,61 @@
+#ifndef STAN_SERVICES_UTIL_WARMUP_CONVERGED_HPP
+#define STAN_SERVICES_UTIL_WARMUP_CONVERGED_HPP
+
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Return true if the warmup draws of every chain in rows
+ * <code>[begin, end)</code> meet the convergence thresholds: for every
+ * column the larger of the bulk and tail rank normalized split R-hat is
+ * at most <code>max_rhat</code> and the split effective sample size is
+ * at least <code>min_ess</code>.  Diagnostics that cannot be computed
+ * count as not converged.
+ *
+ * @param draws warmup draws of each chain, one row per iteration and one
+ *   column per quantity, typically lp__ followed by the unconstrained
+ *   parameters the metric is estimated from
+ * @param begin first row to assess
+ * @param end one past the last row to assess
+ * @param max_rhat largest acceptable R-hat
+ * @param min_ess smallest acceptable effective sample size
+ * @return true if all quantities meet the thresholds
+ */
+inline bool warmup_converged(const std::vector<Eigen::MatrixXd>& draws,
+                             Eigen::Index begin, Eigen::Index end,
+                             double max_rhat, double min_ess) {
+  if (draws.empty() || end - begin < 4)
+    return false;
+  const size_t size = end - begin;
+  std::vector<const double*> chain_begins(draws.size());
+  for (Eigen::Index col = 0; col < draws[0].cols(); ++col) {
+    for (size_t chain = 0; chain < draws.size(); ++chain)
+      chain_begins[chain] = draws[chain].col(col).data() + begin;
+
+    std::pair<double, double> rhat
+        = analyze::compute_split_potential_scale_reduction_rank(chain_begins,
+                                                                size);
+    if (!(std::max(rhat.first, rhat.second) <= max_rhat))
+      return false;
+
+    double ess = analyze::compute_split_effective_sample_size(chain_begins,
+                                                              size);
+    if (!(ess >= min_ess))
+      return false;
+  }
+  return true;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,190 @@
+#ifndef STAN_SERVICES_UTIL_WORKSPACE_HPP
+#define STAN_SERVICES_UTIL_WORKSPACE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * <code>workspace</code> is a monotonic arena for the short-lived
+ * matrices and vectors of the services, such as the draws and products of
+ * an iteration of pathfinder, handed out as <code>Eigen::Map</code>s.
+ *
+ * Allocating only bumps an offset into blocks owned by the workspace,
+ * which grows by a new block, twice as large as the last, when the current
+ * one is full.  Blocks are never freed or moved until the workspace is
+ * destroyed, so the maps stay valid until the memory is rewound, and once
+ * the blocks are large enough for an iteration the following iterations
+ * allocate nothing from the heap.
+ *
+ * Memory is given back by rewinding to a mark, most easily with a
+ * <code>workspace_scope</code> around each iteration.  Scopes nest, so
+ * code that runs on a thread while it waits in a parallel loop, such as
+ * another pathfinder, can use the workspace of the thread too.
+ *
+ * A workspace is not thread safe: each thread uses its own, from
+ * <code>workspace::local()</code>.
+ */
+class workspace {
+ public:
+  /**
+   * Position of the workspace to rewind to.
+   */
+  struct mark {
+    std::size_t block = 0;
+    std::size_t offset = 0;
+  };
+
+  /**
+   * @param[in] initial_bytes size of the first block
+   */
+  explicit workspace(std::size_t initial_bytes = 1 << 16)
+      : initial_bytes_(std::max<std::size_t>(initial_bytes, alignment)) {}
+
+  workspace(const workspace&) = delete;
+  workspace& operator=(const workspace&) = delete;
+
+  /**
+   * Return the workspace of the calling thread.
+   */
+  static workspace& local() {
+    thread_local workspace ws;
+    return ws;
+  }
+
+  /**
+   * Return uninitialized memory for the specified number of values,
+   * aligned to 64 bytes.
+   *
+   * @tparam T trivially destructible type of the values
+   * @param[in] n number of values
+   */
+  template <typename T>
+  T* alloc_array(std::size_t n) {
+    const std::size_t bytes = round_up(n * sizeof(T));
+    while (block_ < blocks_.size() && offset_ + bytes > sizes_[block_]) {
+      ++block_;
+      offset_ = 0;
+    }
+    if (block_ == blocks_.size()) {
+      std::size_t size = blocks_.empty() ? initial_bytes_ : 2 * sizes_.back();
+      while (size < bytes)
+        size *= 2;
+      blocks_.emplace_back(new char[size + alignment]);
+      sizes_.push_back(size);
+      offset_ = 0;
+    }
+    char* base = blocks_[block_].get();
+    char* aligned = base + (alignment - reinterpret_cast<std::uintptr_t>(base)
+                                            % alignment)
+                               % alignment;
+    T* result = reinterpret_cast<T*>(aligned + offset_);
+    offset_ += bytes;
+    return result;
+  }
+
+  /**
+   * Return an uninitialized matrix in the workspace.
+   */
+  Eigen::Map<Eigen::MatrixXd> matrix(Eigen::Index rows, Eigen::Index cols) {
+    return Eigen::Map<Eigen::MatrixXd>(alloc_array<double>(rows * cols), rows,
+                                       cols);
+  }
+
+  /**
+   * Return an uninitialized vector in the workspace.
+   */
+  Eigen::Map<Eigen::VectorXd> vector(Eigen::Index size) {
+    return Eigen::Map<Eigen::VectorXd>(alloc_array<double>(size), size);
+  }
+
+  /**
+   * Return the current position, to rewind to later.
+   */
+  mark position() const noexcept { return {block_, offset_}; }
+
+  /**
+   * Give back the memory allocated since the specified position, keeping
+   * the blocks.
+   *
+   * @param[in] m position returned by <code>position()</code>
+   */
+  void rewind(const mark& m) noexcept {
+    block_ = m.block;
+    offset_ = m.offset;
+  }
+
+  /**
+   * Give back all of the memory, keeping the blocks.
+   */
+  void reset() noexcept { rewind(mark()); }
+
+  /**
+   * Return the number of bytes in use, counting the unused ends of the
+   * blocks that were skipped.
+   */
+  std::size_t bytes_used() const noexcept {
+    std::size_t bytes = offset_;
+    for (std::size_t b = 0; b < std::min(block_, sizes_.size()); ++b)
+      bytes += sizes_[b];
+    return bytes;
+  }
+
+  /**
+   * Return the number of bytes of the blocks.
+   */
+  std::size_t bytes_reserved() const noexcept {
+    std::size_t bytes = 0;
+    for (std::size_t size : sizes_)
+      bytes += size;
+    return bytes;
+  }
+
+  /**
+   * Return the number of blocks.
+   */
+  std::size_t num_blocks() const noexcept { return blocks_.size(); }
+
+ private:
+  static constexpr std::size_t alignment = 64;
+  std::size_t initial_bytes_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::vector<std::size_t> sizes_;
+  std::size_t block_ = 0;
+  std::size_t offset_ = 0;
+
+  static std::size_t round_up(std::size_t bytes) noexcept {
+    return (bytes + alignment - 1) / alignment * alignment;
+  }
+};
+
+/**
+ * Rewinds a workspace, by default that of the calling thread, to where it
+ * was at construction when the scope ends.
+ */
+class workspace_scope {
+ public:
+  explicit workspace_scope(workspace& ws = workspace::local())
+      : ws_(ws), mark_(ws.position()) {}
+  workspace_scope(const workspace_scope&) = delete;
+  workspace_scope& operator=(const workspace_scope&) = delete;
+  ~workspace_scope() { ws_.rewind(mark_); }
+
+  workspace& get() noexcept { return ws_; }
+
+ private:
+  workspace& ws_;
+  workspace::mark mark_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
@@ -0,0 +1,156 @@
+#ifndef STAN_SERVICES_UTIL_WRITE_PROFILES_HPP
+#define STAN_SERVICES_UTIL_WRITE_PROFILES_HPP
+
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/math/rev/core.hpp>
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Profile of a named region of a model, summed over the threads that ran
+ * it.
+ */
+struct profile_summary {
+  std::string name;
+
+  /**
+   * Number of threads that ran the region.
+   */
+  std::size_t num_threads = 0;
+
+  /**
+   * Wall time in seconds of the forward passes through the region.
+   */
+  double forward_time = 0;
+
+  /**
+   * Wall time in seconds of the reverse passes through the region.
+   */
+  double reverse_time = 0;
+
+  /**
+   * Number of forward passes with autodiff variables.
+   */
+  std::size_t autodiff_calls = 0;
+
+  /**
+   * Number of forward passes without autodiff variables, as when the
+   * draws are written.
+   */
+  std::size_t no_autodiff_calls = 0;
+
+  /**
+   * Number of reverse passes.
+   */
+  std::size_t reverse_calls = 0;
+
+  /**
+   * Total number of entries the region put on the autodiff stack of
+   * variables that are chained.
+   */
+  std::size_t chain_stack = 0;
+
+  /**
+   * Total number of entries the region put on the autodiff stack of
+   * variables that are not chained.
+   */
+  std::size_t no_chain_stack = 0;
+};
+
+/**
+ * Return the profiles of the regions of a model, with the entries of the
+ * threads that ran each region summed, in the order of their names.
+ *
+ * @param[in] profiles profiles of a model, one entry per region and
+ *   thread
+ * @return profile of each region
+ */
+inline std::vector<profile_summary> summarize_profiles(
+    const stan::math::profile_map& profiles) {
+  std::map<std::string, profile_summary> by_name;
+  std::map<std::string, std::set<std::thread::id>> threads;
+  for (const auto& entry : profiles) {
+    const std::string& name = entry.first.first;
+    const stan::math::profile_info& info = entry.second;
+    profile_summary& summary = by_name[name];
+    summary.name = name;
+    threads[name].insert(entry.first.second);
+    summary.forward_time += info.get_fwd_time();
+    summary.reverse_time += info.get_rev_time();
+    summary.autodiff_calls += info.get_num_AD_fwd_passes();
+    summary.no_autodiff_calls += info.get_num_no_AD_fwd_passes();
+    summary.reverse_calls += info.get_num_rev_passes();
+    summary.chain_stack += info.get_chain_stack_used();
+    summary.no_chain_stack += info.get_nochain_stack_used();
+  }
+  std::vector<profile_summary> summaries;
+  for (auto& named : by_name) {
+    named.second.num_threads = threads[named.first].size();
+    summaries.push_back(named.second);
+  }
+  return summaries;
+}
+
+/**
+ * Write the profiles of the regions of a model as a record named
+ * <code>profiles</code> holding a record for each region, named after
+ * it, with the number of threads that ran it, its total, forward and
+ * reverse times in seconds, its numbers of forward passes with and
+ * without autodiff and of reverse passes, and the entries it put on the
+ * autodiff stacks.
+ *
+ * The profiles accumulate over the life of the model, so they are
+ * usually written once at the end of a run.
+ *
+ * @param[in,out] writer writer for the profiles
+ * @param[in] profiles profiles of a model
+ */
+inline void write_profiles(callbacks::structured_writer& writer,
+                           const stan::math::profile_map& profiles) {
+  writer.begin_record("profiles");
+  for (const profile_summary& summary : summarize_profiles(profiles)) {
+    writer.begin_record(summary.name);
+    writer.write("threads", summary.num_threads);
+    writer.write("total_time", summary.forward_time + summary.reverse_time);
+    writer.write("forward_time", summary.forward_time);
+    writer.write("reverse_time", summary.reverse_time);
+    writer.write("autodiff_calls", summary.autodiff_calls);
+    writer.write("no_autodiff_calls", summary.no_autodiff_calls);
+    writer.write("reverse_calls", summary.reverse_calls);
+    writer.write("chain_stack", summary.chain_stack);
+    writer.write("no_chain_stack", summary.no_chain_stack);
+    writer.end_record();
+  }
+  writer.end_record();
+}
+
+/**
+ * Write the profiles of the regions of a model, if it records them.
+ *
+ * @tparam Model type of model
+ * @param[in,out] writer writer for the profiles
+ * @param[in] model model
+ * @return true if the model records profiles and they were written
+ */
+template <class Model>
+bool write_profiles(callbacks::structured_writer& writer,
+                    const Model& model) {
+  const stan::math::profile_map* profiles = model.profile_data();
+  if (profiles == nullptr)
+    return false;
+  write_profiles(writer, *profiles);
+  return true;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
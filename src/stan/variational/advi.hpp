@@ -2,21 +2,35 @@
 #define STAN_VARIATIONAL_ADVI_HPP
 
 #include <stan/math.hpp>
+#include <stan/callbacks/buffered_logger.hpp>
+#include <stan/callbacks/interrupt.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/callbacks/stream_writer.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/variational/print_progress.hpp>
+#include <stan/variational/rolling_window.hpp>
+#include <stan/variational/families/normal_banded.hpp>
 #include <stan/variational/families/normal_fullrank.hpp>
+#include <stan/variational/families/normal_lowrank.hpp>
 #include <stan/variational/families/normal_meanfield.hpp>
 #include <boost/circular_buffer.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <limits>
+#include <mutex>
 #include <numeric>
 #include <ostream>
 #include <queue>
+#include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace stan {
@@ -47,6 +61,13 @@ class advi {
    * @param[in] n_monte_carlo_elbo number of samples for ELBO computation
    * @param[in] eval_elbo evaluate ELBO at every "eval_elbo" iters
    * @param[in] n_posterior_samples number of samples to draw from posterior
+   * @param[in] parallel whether to evaluate the Monte Carlo draws of the
+   * ELBO and its gradient in parallel; the draws, and so the results, are
+   * the same either way.  The posterior draws written by
+   * <code>run</code> are then also evaluated in parallel, see
+   * <code>write_posterior_draws</code>
+   * @param[in] concurrent_eta whether <code>run</code> adapts eta with
+   * <code>adapt_eta_concurrent</code> rather than <code>adapt_eta</code>
    * @throw std::runtime_error if n_monte_carlo_grad is not positive
    * @throw std::runtime_error if n_monte_carlo_elbo is not positive
    * @throw std::runtime_error if eval_elbo is not positive
@@ -54,14 +75,52 @@ class advi {
    */
   advi(Model& m, Eigen::VectorXd& cont_params, BaseRNG& rng,
        int n_monte_carlo_grad, int n_monte_carlo_elbo, int eval_elbo,
-       int n_posterior_samples)
+       int n_posterior_samples, bool parallel = false,
+       bool concurrent_eta = false)
+      : advi(m, cont_params, rng, Q(cont_params), n_monte_carlo_grad,
+             n_monte_carlo_elbo, eval_elbo, n_posterior_samples, parallel,
+             concurrent_eta) {}
+
+  /**
+   * Constructor for variational families that need more than the
+   * continuous parameters to be initialized, such as the rank of
+   * <code>normal_lowrank</code>.  The approximation starts from the
+   * specified one, with its mean set to the continuous parameters, and
+   * the gradients are stored in approximations like it set to zero.
+   *
+   * @param[in] m stan model
+   * @param[in] cont_params initialization of continuous parameters
+   * @param[in,out] rng random number generator
+   * @param[in] initial initial variational approximation
+   * @param[in] n_monte_carlo_grad number of samples for gradient computation
+   * @param[in] n_monte_carlo_elbo number of samples for ELBO computation
+   * @param[in] eval_elbo evaluate ELBO at every "eval_elbo" iters
+   * @param[in] n_posterior_samples number of samples to draw from posterior
+   * @param[in] parallel whether to evaluate the Monte Carlo draws of the
+   * ELBO and its gradient, and the posterior draws, in parallel
+   * @param[in] concurrent_eta whether <code>run</code> adapts eta with
+   * <code>adapt_eta_concurrent</code> rather than <code>adapt_eta</code>
+   * @throw std::runtime_error if n_monte_carlo_grad is not positive
+   * @throw std::runtime_error if n_monte_carlo_elbo is not positive
+   * @throw std::runtime_error if eval_elbo is not positive
+   * @throw std::runtime_error if n_posterior_samples is not positive
+   * @throw std::domain_error if the dimension of the initial
+   * approximation is not the number of continuous parameters
+   */
+  advi(Model& m, Eigen::VectorXd& cont_params, BaseRNG& rng, const Q& initial,
+       int n_monte_carlo_grad, int n_monte_carlo_elbo, int eval_elbo,
+       int n_posterior_samples, bool parallel = false,
+       bool concurrent_eta = false)
       : model_(m),
         cont_params_(cont_params),
         rng_(rng),
+        initial_(initial),
         n_monte_carlo_grad_(n_monte_carlo_grad),
         n_monte_carlo_elbo_(n_monte_carlo_elbo),
         eval_elbo_(eval_elbo),
-        n_posterior_samples_(n_posterior_samples) {
+        n_posterior_samples_(n_posterior_samples),
+        parallel_(parallel),
+        concurrent_eta_(concurrent_eta) {
     static const char* function = "stan::variational::advi";
     math::check_positive(function,
                          "Number of Monte Carlo samples for gradients",
@@ -72,6 +131,57 @@ class advi {
                          eval_elbo_);
     math::check_positive(function, "Number of posterior samples for output",
                          n_posterior_samples_);
+    math::check_size_match(function, "Dimension of initial approximation",
+                           initial_.dimension(),
+                           "Number of continuous parameters",
+                           cont_params_.size());
+  }
+
+  /**
+   * Set the interrupt whose <code>stop_requested</code> is polled at
+   * every iteration of the eta adaptation and of the stochastic gradient
+   * ascent, or clear it with null.  A stop ends the adaptation with the
+   * best eta so far and the ascent with the current approximation, which
+   * <code>run</code> then writes.
+   *
+   * @param[in] interrupt interrupt, which must outlive its use here, or
+   *   null
+   */
+  void set_interrupt(const callbacks::interrupt* interrupt) {
+    interrupt_ = interrupt;
+  }
+
+  /**
+   * Adapt the number of Monte Carlo draws of each gradient of the ELBO in
+   * <code>stochastic_gradient_ascent</code> to hold the specified
+   * signal-to-noise ratio of the gradient, or return to the fixed number
+   * of draws of the constructor with a target of zero.
+   *
+   * The ascent starts from the number of draws of the constructor, at
+   * least two, and sets the number of draws of each gradient from the
+   * previous one with <code>calc_ELBO_grad_adaptive</code>.  Few draws
+   * are then taken while the gradient is large compared to its noise,
+   * early in the ascent, and more as the gradient vanishes near the
+   * optimum.  The eta adaptation uses the fixed number of draws.
+   *
+   * @param[in] target_snr target ratio of the squared norm of the gradient
+   *   to the expected squared norm of its Monte Carlo error, or zero not
+   *   to adapt the number of draws
+   * @param[in] max_grad_samples largest number of draws of a gradient
+   * @throw std::domain_error if the target is negative or the largest
+   *   number of draws is less than two
+   */
+  void set_adaptive_grad_samples(double target_snr, int max_grad_samples) {
+    static const char* function
+        = "stan::variational::advi::set_adaptive_grad_samples";
+    math::check_nonnegative(function, "Target signal-to-noise ratio",
+                            target_snr);
+    math::check_greater_or_equal(function,
+                                 "Maximum number of Monte Carlo samples "
+                                 "for gradients",
+                                 max_grad_samples, 2);
+    target_snr_ = target_snr;
+    max_grad_samples_ = max_grad_samples;
   }
 
   /**
@@ -89,33 +199,87 @@ class advi {
    * that the variational distribution has somehow collapsed.
    */
   double calc_ELBO(const Q& variational, callbacks::logger& logger) const {
+    return calc_ELBO(variational, rng_, logger);
+  }
+
+  /**
+   * Calculates the Evidence Lower BOund (ELBO) as the two-argument
+   * <code>calc_ELBO</code> does, drawing from the specified generator.
+   *
+   * @param[in] variational variational approximation at which to evaluate
+   * the ELBO.
+   * @param[in,out] rng random number generator for the draws
+   * @param logger logger for messages
+   * @return the evidence lower bound.
+   * @throw std::domain_error If, after n_monte_carlo_elbo_ number of draws
+   * from the variational distribution all give non-finite log joint
+   * evaluations.
+   */
+  double calc_ELBO(const Q& variational, BaseRNG& rng,
+                   callbacks::logger& logger) const {
     static const char* function = "stan::variational::advi::calc_ELBO";
 
     double elbo = 0.0;
     int dim = variational.dimension();
-    Eigen::VectorXd zeta(dim);
-
-    int n_dropped_evaluations = 0;
-    for (int i = 0; i < n_monte_carlo_elbo_;) {
-      variational.sample(rng_, zeta);
+    std::vector<Eigen::VectorXd> zetas;
+    std::vector<double> log_probs;
+    std::vector<std::string> msgs;
+    std::vector<char> succeeded;
+    auto evaluate = [&](int b) {
+      msgs[b].clear();
+      succeeded[b] = false;
       try {
         std::stringstream ss;
-        double log_prob = model_.template log_prob<false, true>(zeta, &ss);
-        if (ss.str().length() > 0)
-          logger.info(ss);
-        stan::math::check_finite(function, "log_prob", log_prob);
-        elbo += log_prob;
-        ++i;
+        log_probs[b] = model_.template log_prob<false, true>(zetas[b], &ss);
+        msgs[b] = ss.str();
+        stan::math::check_finite(function, "log_prob", log_probs[b]);
+        succeeded[b] = true;
       } catch (const std::domain_error& e) {
-        ++n_dropped_evaluations;
-        if (n_dropped_evaluations >= n_monte_carlo_elbo_) {
-          const char* name = "The number of dropped evaluations";
-          const char* msg1 = "has reached its maximum amount (";
-          const char* msg2
-              = "). Your model may be either severely "
-                "ill-conditioned or misspecified.";
-          stan::math::throw_domain_error(function, name, n_monte_carlo_elbo_,
-                                         msg1, msg2);
+      }
+    };
+
+    int n_dropped_evaluations = 0;
+    // A batch makes just enough draws to finish if all of them succeed,
+    // which are the draws a serial loop would make
+    for (int i = 0; i < n_monte_carlo_elbo_;) {
+      const int n_batch = parallel_ ? n_monte_carlo_elbo_ - i : 1;
+      zetas.resize(n_batch);
+      log_probs.resize(n_batch);
+      msgs.resize(n_batch);
+      succeeded.resize(n_batch);
+      for (int b = 0; b < n_batch; ++b) {
+        zetas[b].resize(dim);
+        variational.sample(rng, zetas[b]);
+      }
+      if (n_batch > 1) {
+        // log_prob on doubles does not touch the autodiff stack
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, n_batch),
+            [&](const tbb::blocked_range<int>& r) {
+              for (int b = r.begin(); b != r.end(); ++b) {
+                evaluate(b);
+              }
+            });
+      } else {
+        evaluate(0);
+      }
+      for (int b = 0; b < n_batch; ++b) {
+        if (msgs[b].length() > 0)
+          logger.info(msgs[b]);
+        if (succeeded[b]) {
+          elbo += log_probs[b];
+          ++i;
+        } else {
+          ++n_dropped_evaluations;
+          if (n_dropped_evaluations >= n_monte_carlo_elbo_) {
+            const char* name = "The number of dropped evaluations";
+            const char* msg1 = "has reached its maximum amount (";
+            const char* msg2
+                = "). Your model may be either severely "
+                  "ill-conditioned or misspecified.";
+            stan::math::throw_domain_error(function, name, n_monte_carlo_elbo_,
+                                           msg1, msg2);
+          }
         }
       }
     }
@@ -145,7 +309,75 @@ class advi {
         "Dimension of variables in model", cont_params_.size());
 
     variational.calc_grad(elbo_grad, model_, cont_params_, n_monte_carlo_grad_,
-                          rng_, logger);
+                          rng_, logger, parallel_);
+  }
+
+  /**
+   * Calculates the "black box" gradient of the ELBO from the specified
+   * number of draws and returns the number of draws of the next gradient
+   * holding the target signal-to-noise ratio of
+   * <code>set_adaptive_grad_samples</code>.
+   *
+   * The draws are split in two halves whose gradients <code>a</code> and
+   * <code>b</code> are independent estimates of the gradient, so that
+   * <code>||a - b||^2 / (1 / n_a + 1 / n_b)</code> estimates the trace of
+   * the covariance of the gradient of a single draw.  Dividing it by the
+   * number of draws gives the expected squared norm of the error of the
+   * gradient; the next number of draws is the one which makes the squared
+   * norm of the gradient the target times that, the "norm test" for the
+   * sample size of stochastic gradients.  To keep a noisy estimate from
+   * swinging it, the number of draws at most doubles or halves at each
+   * call, and it stays between two and the maximum.
+   *
+   * @param[in] variational variational approximation at which to evaluate
+   * the ELBO.
+   * @param[out] elbo_grad gradient of ELBO with respect to variational
+   * approximation.
+   * @param[in,out] half_grad gradient of the second half of the draws,
+   * storage with the shape of the approximation
+   * @param[in] n_monte_carlo_grad number of draws, at least two
+   * @param logger logger for messages
+   * @return number of draws of the next gradient
+   */
+  int calc_ELBO_grad_adaptive(const Q& variational, Q& elbo_grad,
+                              Q& half_grad, int n_monte_carlo_grad,
+                              callbacks::logger& logger) const {
+    static const char* function
+        = "stan::variational::advi::calc_ELBO_grad_adaptive";
+
+    stan::math::check_greater_or_equal(
+        function, "Number of Monte Carlo samples for gradients",
+        n_monte_carlo_grad, 2);
+    stan::math::check_size_match(
+        function, "Dimension of elbo_grad", elbo_grad.dimension(),
+        "Dimension of variational q", variational.dimension());
+    stan::math::check_size_match(
+        function, "Dimension of variational q", variational.dimension(),
+        "Dimension of variables in model", cont_params_.size());
+
+    const int n_a = n_monte_carlo_grad / 2;
+    const int n_b = n_monte_carlo_grad - n_a;
+    variational.calc_grad(elbo_grad, model_, cont_params_, n_a, rng_, logger,
+                          parallel_);
+    variational.calc_grad(half_grad, model_, cont_params_, n_b, rng_, logger,
+                          parallel_);
+    // elbo_grad = a - (n_b / n) (a - b), the mean over all of the draws
+    half_grad *= -1.0;
+    half_grad += elbo_grad;
+    const double draw_noise
+        = half_grad.squared_norm() / (1.0 / n_a + 1.0 / n_b);
+    half_grad *= -static_cast<double>(n_b) / n_monte_carlo_grad;
+    elbo_grad += half_grad;
+
+    const double signal = elbo_grad.squared_norm();
+    const int max_samples = std::max(max_grad_samples_, 2);
+    double needed = 2.0 * n_monte_carlo_grad;
+    if (signal > 0)
+      needed = std::ceil(target_snr_ * draw_noise / signal);
+    needed = std::min(needed, 2.0 * n_monte_carlo_grad);
+    needed = std::max(needed, 0.5 * n_monte_carlo_grad);
+    needed = std::min(needed, static_cast<double>(max_samples));
+    return std::max(static_cast<int>(needed), 2);
   }
 
   /**
@@ -190,10 +422,10 @@ class advi {
     }
 
     // Variational family to store gradients
-    Q elbo_grad = Q(model_.num_params_r());
+    Q elbo_grad = zero_family();
 
     // Adaptive step-size sequence
-    Q history_grad_squared = Q(model_.num_params_r());
+    Q history_grad_squared = zero_family();
     double tau = 1.0;
     double pre_factor = 0.9;
     double post_factor = 0.1;
@@ -210,6 +442,11 @@ class advi {
 
       int print_progress_m;
       for (int iter_tune = 1; iter_tune <= adapt_iterations; ++iter_tune) {
+        if (stop_requested()) {
+          logger.info("Eta adaptation stopped on request.");
+          variational = initial_family();
+          return eta_best > 0 ? eta_best : eta;
+        }
         print_progress_m = eta_sequence_index * adapt_iterations + iter_tune;
         variational ::print_progress(print_progress_m, 0,
                                      adapt_iterations * eta_sequence_size,
@@ -225,15 +462,14 @@ class advi {
 
         // Update step-size
         if (iter_tune == 1) {
-          history_grad_squared += elbo_grad.square();
+          history_grad_squared.add_square(elbo_grad, 1.0, 1.0);
         } else {
-          history_grad_squared = pre_factor * history_grad_squared
-                                 + post_factor * elbo_grad.square();
+          history_grad_squared.add_square(elbo_grad, pre_factor, post_factor);
         }
         eta_scaled = eta / sqrt(static_cast<double>(iter_tune));
         // Stochastic gradient update
-        variational
-            += eta_scaled * elbo_grad / (tau + history_grad_squared.sqrt());
+        variational.add_adagrad_step(eta_scaled, elbo_grad,
+                                     history_grad_squared, tau);
       }
 
       // (ROBUST) Compute ELBO. It's OK if it has diverged.
@@ -285,11 +521,181 @@ class advi {
         history_grad_squared.set_to_zero();
       }
       ++eta_sequence_index;
-      variational = Q(cont_params_);
+      variational = initial_family();
     }
     return eta_best;
   }
 
+  /**
+   * Heuristic grid search to adapt eta to the scale of the problem, as
+   * <code>adapt_eta</code> does but trying every eta of the sequence at
+   * once.  Each eta gets its own copy of the initial variational
+   * distribution and its own random number generator, seeded with draws
+   * from the generator of this object in the order of the sequence (or,
+   * for generators that can not be seeded, a copy of that generator after
+   * one more draw), so the
+   * adapted eta is the same however the tries run.  It differs from that
+   * of <code>adapt_eta</code>, whose tries share one stream of draws.
+   *
+   * The tries run concurrently when Stan is built with STAN_THREADS,
+   * since each needs an autodiff stack of its own, and one after another
+   * otherwise.  A try is stopped early when its variational distribution
+   * stops being finite or its ELBO can not be computed at one of the
+   * checks made every <code>eval_elbo</code> iterations, and counts as
+   * diverged.  Once the finished tries decide the eta chosen, the tries
+   * of smaller etas are no longer needed and are stopped.  The messages
+   * of the tries that were needed are logged in the order of the
+   * sequence.
+   *
+   * @param[in] variational initial variational distribution.
+   * @param[in] adapt_iterations number of iterations to spend doing stochastic
+   * gradient ascent at each proposed eta value.
+   * @param[in,out] logger logger for messages
+   * @return adapted (tuned) value of eta via heuristic grid search
+   * @throw std::domain_error If either (a) the initial ELBO cannot be
+   * computed at the initial variational distribution, (b) all step-size
+   * proposals in eta_sequence fail.
+   */
+  double adapt_eta_concurrent(Q& variational, int adapt_iterations,
+                              callbacks::logger& logger) const {
+    static const char* function
+        = "stan::variational::advi::adapt_eta_concurrent";
+
+    stan::math::check_positive(function, "Number of adaptation iterations",
+                               adapt_iterations);
+
+    logger.info("Begin concurrent eta adaptation.");
+
+    // Sequence of eta values to try during adaptation
+    const std::vector<double> eta_sequence = {100, 10, 1, 0.1, 0.01};
+    const int eta_sequence_size = eta_sequence.size();
+
+    double elbo_init;
+    try {
+      elbo_init = calc_ELBO(variational, logger);
+    } catch (const std::domain_error& e) {
+      const char* name
+          = "Cannot compute ELBO using the initial "
+            "variational distribution.";
+      const char* msg1
+          = "Your model may be either "
+            "severely ill-conditioned or misspecified.";
+      stan::math::throw_domain_error(function, name, "", msg1);
+    }
+
+    std::vector<BaseRNG> rngs;
+    for (int i = 0; i < eta_sequence_size; ++i)
+      rngs.push_back(seeded_rng(rng_));
+    std::vector<double> elbos(eta_sequence_size,
+                              -std::numeric_limits<double>::max());
+    std::vector<int> iterations(eta_sequence_size, 0);
+    std::vector<callbacks::buffered_logger> loggers(eta_sequence_size);
+    std::vector<char> done(eta_sequence_size, false);
+    std::mutex done_mutex;
+    std::atomic<int> last_needed(eta_sequence_size - 1);
+
+    auto try_eta = [&](int i) {
+      callbacks::buffered_logger& try_logger = loggers[i];
+      const double eta = eta_sequence[i];
+      Q trial = initial_family();
+      Q elbo_grad = zero_family();
+      Q history_grad_squared = zero_family();
+      const double tau = 1.0;
+      const double pre_factor = 0.9;
+      const double post_factor = 0.1;
+      bool diverged = false;
+      for (int iter_tune = 1; iter_tune <= adapt_iterations; ++iter_tune) {
+        if (i > last_needed.load() || stop_requested()) {
+          diverged = true;
+          break;
+        }
+        try {
+          trial.calc_grad(elbo_grad, model_, cont_params_,
+                          n_monte_carlo_grad_, rngs[i], try_logger,
+                          parallel_);
+        } catch (const std::domain_error& e) {
+          elbo_grad.set_to_zero();
+        }
+        if (iter_tune == 1) {
+          history_grad_squared.add_square(elbo_grad, 1.0, 1.0);
+        } else {
+          history_grad_squared.add_square(elbo_grad, pre_factor, post_factor);
+        }
+        const double eta_scaled = eta / sqrt(static_cast<double>(iter_tune));
+        try {
+          trial.add_adagrad_step(eta_scaled, elbo_grad, history_grad_squared,
+                                 tau);
+          diverged = !std::isfinite(trial.entropy())
+                     || !trial.mean().allFinite();
+          if (!diverged && iter_tune % eval_elbo_ == 0
+              && iter_tune < adapt_iterations)
+            calc_ELBO(trial, rngs[i], try_logger);
+        } catch (const std::domain_error& e) {
+          diverged = true;
+        }
+        iterations[i] = iter_tune;
+        if (diverged)
+          break;
+      }
+      if (!diverged) {
+        try {
+          elbos[i] = calc_ELBO(trial, rngs[i], try_logger);
+        } catch (const std::domain_error& e) {
+        }
+      }
+      std::lock_guard<std::mutex> lock(done_mutex);
+      done[i] = true;
+      int finished = 0;
+      while (finished < eta_sequence_size && done[finished])
+        ++finished;
+      const int chosen = choose_eta(elbos, finished, elbo_init);
+      if (chosen >= 0 && chosen + 1 < last_needed.load())
+        last_needed.store(chosen + 1);
+    };
+    stan::model::internal::parallel_for_if_threads(
+        0, eta_sequence_size, [&](const tbb::blocked_range<int>& r) {
+          for (int i = r.begin(); i != r.end(); ++i)
+            try_eta(i);
+        });
+
+    const int chosen = choose_eta(elbos, eta_sequence_size, elbo_init);
+    if (stop_requested()) {
+      logger.info("Eta adaptation stopped on request.");
+      variational = initial_family();
+      return eta_sequence[std::max(chosen, 0)];
+    }
+    const int num_needed = chosen < 0 ? eta_sequence_size
+                                      : std::min(chosen + 2, eta_sequence_size);
+    for (int i = 0; i < num_needed; ++i) {
+      loggers[i].flush(logger);
+      std::stringstream ss;
+      ss << "eta = " << eta_sequence[i] << ": ";
+      if (elbos[i] > -std::numeric_limits<double>::max())
+        ss << "ELBO = " << elbos[i];
+      else
+        ss << "diverged after " << iterations[i] << " iterations";
+      logger.info(ss);
+    }
+    if (chosen < 0) {
+      const char* name = "All proposed step-sizes";
+      const char* msg1
+          = "failed. Your model may be either "
+            "severely ill-conditioned or misspecified.";
+      stan::math::throw_domain_error(function, name, "", msg1);
+    }
+    std::stringstream ss;
+    ss << "Success!"
+       << " Found best value [eta = " << eta_sequence[chosen] << "]";
+    if (chosen < eta_sequence_size - 1)
+      ss << (" earlier than expected.");
+    else
+      ss << ".";
+    logger.info(ss);
+    logger.info("");
+    variational = initial_family();
+    return eta_sequence[chosen];
+  }
+
   /**
    * Runs stochastic gradient ascent with an adaptive stepsize sequence.
    *
@@ -315,10 +721,15 @@ class advi {
     stan::math::check_positive(function, "Maximum iterations", max_iterations);
 
     // Gradient parameters
-    Q elbo_grad = Q(model_.num_params_r());
+    Q elbo_grad = zero_family();
+    const bool adaptive_grad = target_snr_ > 0;
+    Q half_grad = adaptive_grad ? zero_family() : initial_;
+    int n_grad = std::min(std::max(n_monte_carlo_grad_, 2), max_grad_samples_);
+    double sum_n_grad = 0;
+    int num_grads = 0;
 
     // Stepsize sequence parameters
-    Q history_grad_squared = Q(model_.num_params_r());
+    Q history_grad_squared = zero_family();
     double tau = 1.0;
     double pre_factor = 0.9;
     double post_factor = 0.1;
@@ -335,7 +746,7 @@ class advi {
     // Heuristic to estimate how far to look back in rolling window
     int cb_size
         = static_cast<int>(std::max(0.1 * max_iterations / eval_elbo_, 2.0));
-    boost::circular_buffer<double> elbo_diff(cb_size);
+    rolling_window elbo_diff(cb_size);
 
     logger.info("Begin stochastic gradient ascent.");
     logger.info(
@@ -351,21 +762,32 @@ class advi {
     // Main loop
     bool do_more_iterations = true;
     for (int iter_counter = 1; do_more_iterations; ++iter_counter) {
+      if (stop_requested()) {
+        logger.info("Stochastic gradient ascent stopped on request.");
+        break;
+      }
+
       // Compute gradient using Monte Carlo integration
-      calc_ELBO_grad(variational, elbo_grad, logger);
+      if (adaptive_grad) {
+        sum_n_grad += n_grad;
+        ++num_grads;
+        n_grad = calc_ELBO_grad_adaptive(variational, elbo_grad, half_grad,
+                                         n_grad, logger);
+      } else {
+        calc_ELBO_grad(variational, elbo_grad, logger);
+      }
 
       // Update step-size
       if (iter_counter == 1) {
-        history_grad_squared += elbo_grad.square();
+        history_grad_squared.add_square(elbo_grad, 1.0, 1.0);
       } else {
-        history_grad_squared = pre_factor * history_grad_squared
-                               + post_factor * elbo_grad.square();
+        history_grad_squared.add_square(elbo_grad, pre_factor, post_factor);
       }
       eta_scaled = eta / sqrt(static_cast<double>(iter_counter));
 
       // Stochastic gradient update
-      variational
-          += eta_scaled * elbo_grad / (tau + history_grad_squared.sqrt());
+      variational.add_adagrad_step(eta_scaled, elbo_grad, history_grad_squared,
+                                   tau);
 
       // Check for convergence every "eval_elbo_"th iteration
       if (iter_counter % eval_elbo_ == 0) {
@@ -375,10 +797,8 @@ class advi {
           elbo_best = elbo;
         delta_elbo = rel_difference(elbo, elbo_prev);
         elbo_diff.push_back(delta_elbo);
-        delta_elbo_ave
-            = std::accumulate(elbo_diff.begin(), elbo_diff.end(), 0.0)
-              / static_cast<double>(elbo_diff.size());
-        delta_elbo_med = circ_buff_median(elbo_diff);
+        delta_elbo_ave = elbo_diff.mean();
+        delta_elbo_med = elbo_diff.median();
         std::stringstream ss;
         ss << "  " << std::setw(4) << iter_counter << "  " << std::setw(15)
            << std::fixed << std::setprecision(3) << elbo << "  "
@@ -438,6 +858,12 @@ class advi {
         do_more_iterations = false;
       }
     }
+    if (adaptive_grad && num_grads > 0) {
+      std::stringstream ss;
+      ss << "Mean number of Monte Carlo draws per gradient: " << std::fixed
+         << std::setprecision(1) << sum_n_grad / num_grads;
+      logger.info(ss);
+    }
   }
 
   /**
@@ -460,10 +886,12 @@ class advi {
     diagnostic_writer("iter,time_in_seconds,ELBO");
 
     // Initialize variational approximation
-    Q variational = Q(cont_params_);
+    Q variational = initial_family();
 
     if (adapt_engaged) {
-      eta = adapt_eta(variational, adapt_iterations, logger);
+      eta = concurrent_eta_
+                ? adapt_eta_concurrent(variational, adapt_iterations, logger)
+                : adapt_eta(variational, adapt_iterations, logger);
       parameter_writer("Stepsize adaptation complete.");
       std::stringstream ss;
       ss << "eta = " << eta;
@@ -497,6 +925,11 @@ class advi {
     ss << "Drawing a sample of size " << n_posterior_samples_
        << " from the approximate posterior... ";
     logger.info(ss);
+    if (parallel_) {
+      write_posterior_draws(variational, logger, parameter_writer);
+      logger.info("COMPLETED.");
+      return stan::services::error_codes::OK;
+    }
     double log_p = 0;
     double log_g = 0;
     // Draw posterior sample. log_g is the log normal densities.
@@ -520,6 +953,85 @@ class advi {
     return stan::services::error_codes::OK;
   }
 
+  /**
+   * Draw <code>n_posterior_samples_</code> from the specified
+   * approximation and write them, evaluating <code>write_array</code> and
+   * <code>log_prob</code> for blocks of draws in parallel.
+   *
+   * The draws of each block are made in order from <code>rng_</code>,
+   * followed by the seed of a generator for each draw, so the draws of
+   * the approximation and the generated quantities do not depend on the
+   * number of threads.  They differ from those of the serial loop of
+   * <code>run</code>, which makes both from <code>rng_</code> in turn.
+   * The rows and the messages of the model are written in the order of
+   * the draws from the calling thread.
+   *
+   * @param[in] variational variational approximation to draw from
+   * @param[in,out] logger logger for messages of the model
+   * @param[in,out] parameter_writer writer for the draws
+   */
+  void write_posterior_draws(const Q& variational, callbacks::logger& logger,
+                             callbacks::writer& parameter_writer) const {
+    const int dim = cont_params_.size();
+    // enough draws per block to keep every thread busy, few enough that
+    // the rows of a block stay small next to the fit
+    const int block_size = static_cast<int>(std::max<Eigen::Index>(
+        1, std::min<Eigen::Index>(
+               1024, (Eigen::Index{1} << 22)
+                         / std::max<Eigen::Index>(1, dim))));
+    Eigen::MatrixXd zetas(dim, std::min(block_size, n_posterior_samples_));
+    Eigen::VectorXd zeta(dim);
+    std::vector<double> log_gs;
+    std::vector<BaseRNG> rngs;
+    std::vector<std::vector<double>> rows;
+    std::vector<std::string> msgs;
+    for (int block_begin = 0; block_begin < n_posterior_samples_;
+         block_begin += block_size) {
+      const int n_block = std::min(block_size, n_posterior_samples_
+                                                   - block_begin);
+      log_gs.resize(n_block);
+      rows.resize(n_block);
+      msgs.resize(n_block);
+      for (int b = 0; b < n_block; ++b) {
+        variational.sample_log_g(rng_, zeta, log_gs[b]);
+        zetas.col(b) = zeta;
+      }
+      rngs.clear();
+      for (int b = 0; b < n_block; ++b)
+        rngs.push_back(seeded_rng(rng_));
+      // write_array and log_prob on doubles do not touch the autodiff stack
+      tbb::parallel_for(
+          tbb::blocked_range<int>(0, n_block),
+          [&](const tbb::blocked_range<int>& r) {
+            std::vector<double> cont_vector(dim);
+            std::vector<int> disc_vector;
+            Eigen::VectorXd theta(dim);
+            std::stringstream msg;
+            for (int b = r.begin(); b != r.end(); ++b) {
+              msg.str(std::string());
+              msg.clear();
+              theta = zetas.col(b);
+              std::copy(theta.data(), theta.data() + dim,
+                        cont_vector.begin());
+              std::vector<double>& values = rows[b];
+              model_.write_array(rngs[b], cont_vector, disc_vector, values,
+                                 true, true, &msg);
+              //  log_p: Log probability in the unconstrained space
+              const double log_p
+                  = model_.template log_prob<false, true>(theta, &msg);
+              msgs[b] = msg.str();
+              // lp__, log_p, and log_g.
+              values.insert(values.begin(), {0, log_p, log_gs[b]});
+            }
+          });
+      for (int b = 0; b < n_block; ++b) {
+        if (msgs[b].length() > 0)
+          logger.info(msgs[b]);
+        parameter_writer(rows[b]);
+      }
+    }
+  }
+
   // TODO(akucukelbir): move these things to stan math and test there
 
   /**
@@ -552,14 +1064,90 @@ class advi {
     return std::fabs((curr - prev) / prev);
   }
 
+  /**
+   * Return a generator seeded with a draw from the specified one.
+   */
+  template <class RNG,
+            std::enable_if_t<std::is_constructible<RNG, std::uint32_t>::value>*
+            = nullptr>
+  static RNG seeded_rng(RNG& rng) {
+    return RNG(static_cast<std::uint32_t>(rng()));
+  }
+
+  /**
+   * Return a copy of the specified generator after one more draw, for
+   * generators that can not be seeded.
+   */
+  template <class RNG,
+            std::enable_if_t<!std::is_constructible<RNG, std::uint32_t>::value>*
+            = nullptr>
+  static RNG seeded_rng(RNG& rng) {
+    rng();
+    return rng;
+  }
+
+  /**
+   * Return the index of the eta that <code>adapt_eta</code> chooses from
+   * the final ELBOs of the first etas of the sequence: the first eta
+   * whose ELBO beats the initial ELBO and is not beaten by that of the
+   * next eta, or else the last eta if its ELBO beats the initial ELBO.
+   *
+   * @param[in] elbos final ELBO of each eta of the sequence
+   * @param[in] num_finished number of etas, from the start of the
+   * sequence, whose ELBOs are known
+   * @param[in] elbo_init ELBO of the initial variational distribution
+   * @return index of the chosen eta, or -1 if it is not decided or every
+   * eta failed
+   */
+  static int choose_eta(const std::vector<double>& elbos, int num_finished,
+                        double elbo_init) {
+    for (int i = 1; i < num_finished; ++i)
+      if (elbos[i] < elbos[i - 1] && elbos[i - 1] > elbo_init)
+        return i - 1;
+    const int n = elbos.size();
+    if (num_finished == n && elbos[n - 1] > elbo_init)
+      return n - 1;
+    return -1;
+  }
+
  protected:
+  bool stop_requested() const {
+    return interrupt_ != nullptr && interrupt_->stop_requested();
+  }
+
+  /**
+   * Return the initial approximation centered at the continuous
+   * parameters.
+   */
+  Q initial_family() const {
+    Q variational(initial_);
+    variational.set_mu(cont_params_);
+    return variational;
+  }
+
+  /**
+   * Return an approximation like the initial one with every variational
+   * parameter zero, to hold gradients.
+   */
+  Q zero_family() const {
+    Q variational(initial_);
+    variational.set_to_zero();
+    return variational;
+  }
+
   Model& model_;
   Eigen::VectorXd& cont_params_;
   BaseRNG& rng_;
+  Q initial_;
   int n_monte_carlo_grad_;
   int n_monte_carlo_elbo_;
   int eval_elbo_;
   int n_posterior_samples_;
+  bool parallel_;
+  bool concurrent_eta_;
+  const callbacks::interrupt* interrupt_ = nullptr;
+  double target_snr_ = 0;
+  int max_grad_samples_ = 2;
 };
 }  // namespace variational
 }  // namespace stan
@@ -3,8 +3,18 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/math/prim.hpp>
+#include <stan/model/gradient.hpp>
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <stan/variational/randomized_sobol.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
+#include <memory>
 #include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
 namespace stan {
 namespace variational {
@@ -19,10 +29,30 @@ class base_family {
    */
   virtual int dimension() const = 0;
 
+  /**
+   * Return the number of standard normal draws that
+   * <code>transform</code> takes to make a draw from the approximation,
+   * which is its dimensionality unless it has latent factors.
+   */
+  virtual int draw_dimension() const { return dimension(); }
+
   // Distribution-based operations
   virtual const Eigen::VectorXd& mean() const = 0;
   virtual double entropy() const = 0;
   virtual Eigen::VectorXd transform(const Eigen::VectorXd& eta) const = 0;
+
+  /**
+   * Write the transform of the specified vector to the specified result,
+   * which is not resized once it has the dimension of the approximation.
+   * The result must not be the vector to transform.
+   *
+   * @param[in] eta Vector to transform.
+   * @param[out] zeta Transformed vector.
+   */
+  virtual void transform_into(const Eigen::VectorXd& eta,
+                              Eigen::VectorXd& zeta) const {
+    zeta = transform(eta);
+  }
   /**
    * Assign a draw from this mean field approximation to the
    * specified vector using the specified random number generator.
@@ -36,8 +66,7 @@ class base_family {
   template <class BaseRNG>
   void sample(BaseRNG& rng, Eigen::VectorXd& eta) const {
     // Draw from standard normal and transform to real-coordinate space
-    for (int d = 0; d < dimension(); ++d)
-      eta(d) = stan::math::normal_rng(0, 1, rng);
+    std_normal_fill(rng, eta);
     eta = transform(eta);
   }
   /**
@@ -55,9 +84,7 @@ class base_family {
   template <class BaseRNG>
   void sample_log_g(BaseRNG& rng, Eigen::VectorXd& eta, double& log_g) const {
     // Draw from the approximation
-    for (int d = 0; d < dimension(); ++d) {
-      eta(d) = stan::math::normal_rng(0, 1, rng);
-    }
+    std_normal_fill(rng, eta);
     // Compute the log density before transformation
     log_g = calc_log_g(eta);
     // Transform to real-coordinate space
@@ -74,17 +101,215 @@ class base_family {
    */
   double calc_log_g(const Eigen::VectorXd& eta) const {
     double log_g = 0;
-    for (int d = 0; d < dimension(); ++d) {
+    for (int d = 0; d < eta.size(); ++d) {
       log_g += -stan::math::square(eta(d)) * 0.5;
     }
     return log_g;
   }
+  /**
+   * Set whether the gradients of the ELBO are estimated by randomized
+   * quasi-Monte Carlo, from the points of a randomized Sobol sequence
+   * rather than independent standard normal draws.  Copies of the
+   * approximation keep the option.
+   *
+   * @param[in] quasi_monte_carlo Whether to use randomized quasi-Monte
+   * Carlo draws.
+   */
+  void set_quasi_monte_carlo(bool quasi_monte_carlo) {
+    quasi_monte_carlo_ = quasi_monte_carlo;
+  }
+
+  /**
+   * Return whether the gradients of the ELBO are estimated by randomized
+   * quasi-Monte Carlo.
+   */
+  bool quasi_monte_carlo() const { return quasi_monte_carlo_; }
+
   template <class M, class BaseRNG>
   void calc_grad(base_family& elbo_grad, M& m, Eigen::VectorXd& cont_params,
                  int n_monte_carlo_grad, BaseRNG& rng,
-                 callbacks::logger& logger) const;
+                 callbacks::logger& logger, bool parallel = false) const;
 
  protected:
+  /**
+   * Storage that repeated calls reuse instead of allocating it each
+   * time.  A copy of a family starts with an empty workspace, so
+   * copying a family does not copy it.  Because the workspace is held
+   * by the family, the gradient of one family object must not be
+   * computed by several threads at once.
+   *
+   * @tparam T Type of the storage.
+   */
+  template <class T>
+  class workspace {
+   public:
+    workspace() = default;
+    workspace(const workspace&) {}
+    workspace& operator=(const workspace&) { return *this; }
+    T& get() const { return value_; }
+
+   private:
+    mutable T value_;
+  };
+
+  /**
+   * Monte Carlo draws of <code>calc_grad_draws</code> and the model
+   * gradients at their transforms, one per draw of a batch.
+   */
+  struct grad_draws {
+    std::vector<Eigen::VectorXd> etas;
+    std::vector<Eigen::VectorXd> zetas;
+    std::vector<Eigen::VectorXd> grads;
+    std::vector<std::stringstream> streams;
+    std::vector<std::string> msgs;
+    std::vector<char> succeeded;
+  };
+
+  workspace<grad_draws> grad_draws_;
+
+  /**
+   * Whether <code>calc_grad_draws</code> makes randomized quasi-Monte
+   * Carlo draws.
+   */
+  bool quasi_monte_carlo_ = false;
+
+  /**
+   * Fill the specified vector with standard normal draws.  These are the
+   * draws <code>stan::math::normal_rng(0, 1, rng)</code> makes one at a
+   * time, without the argument checks and generator set up it repeats
+   * for each of them.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] rng Base random number generator.
+   * @param[out] eta Vector to fill, of the size it already has.
+   */
+  template <class BaseRNG>
+  static void std_normal_fill(BaseRNG& rng, Eigen::VectorXd& eta) {
+    boost::random::normal_distribution<double> std_normal;
+    for (Eigen::Index d = 0; d < eta.size(); ++d)
+      eta(d) = std_normal(rng);
+  }
+
+  /**
+   * Evaluate the gradient of the log density of the model at Monte Carlo
+   * draws from this approximation and pass each successful draw to the
+   * specified accumulator.  Draws whose gradient cannot be evaluated, or is
+   * not finite, are dropped and replaced by new draws.
+   *
+   * The standard normal draws are always made in the same order from
+   * `rng` and the accumulator is called in that order, so the result does
+   * not depend on whether the gradients were evaluated in parallel.  With
+   * quasi-Monte Carlo enabled, the draws of each call are the points of a
+   * Sobol sequence with a new random digital shift drawn from `rng`, and
+   * the replacements of dropped draws are its next points.  The
+   * gradients are only evaluated in parallel when Stan is built with
+   * `STAN_THREADS`, which gives each thread its own autodiff stack.
+   *
+   * The draws, their transforms and the gradients are kept in the
+   * workspace of this family, so that the iterations of stochastic
+   * gradient ascent reuse their storage.  The draw passed to the
+   * accumulator is only valid during the call.
+   *
+   * @tparam M Model class.
+   * @tparam BaseRNG Class of base random number generator.
+   * @tparam Accumulator Type of a functor called with the standard normal
+   * draw and the gradient at its transform.
+   * @param[in] m Model.
+   * @param[in] n_monte_carlo_grad Number of successful draws to make.
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] logger logger for messages
+   * @param[in] parallel Whether to evaluate the gradients in parallel.
+   * @param[in] function Name of the calling function for error messages.
+   * @param[in] accumulate Accumulator of the draws.
+   * @throw std::domain_error If the number of dropped draws reaches ten
+   * times `n_monte_carlo_grad`.
+   */
+  template <class M, class BaseRNG, class Accumulator>
+  void calc_grad_draws(M& m, int n_monte_carlo_grad, BaseRNG& rng,
+                       callbacks::logger& logger, bool parallel,
+                       const char* function, Accumulator&& accumulate) const {
+    parallel = parallel && stan::model::internal::threads_have_autodiff_stacks;
+    static const int n_retries = 10;
+    grad_draws& draws = grad_draws_.get();
+    std::vector<Eigen::VectorXd>& etas = draws.etas;
+    std::vector<Eigen::VectorXd>& zetas = draws.zetas;
+    std::vector<Eigen::VectorXd>& grads = draws.grads;
+    std::vector<std::string>& msgs = draws.msgs;
+    std::vector<char>& succeeded = draws.succeeded;
+    auto evaluate = [&](int b) {
+      msgs[b].clear();
+      succeeded[b] = false;
+      // Transform to real-coordinate space
+      transform_into(etas[b], zetas[b]);
+      try {
+        double tmp_lp = 0.0;
+        std::stringstream& ss = draws.streams[b];
+        ss.str(std::string());
+        ss.clear();
+        stan::model::gradient(m, zetas[b], tmp_lp, grads[b], &ss);
+        msgs[b] = ss.str();
+        stan::math::check_finite(function, "Gradient of mu", grads[b]);
+        succeeded[b] = true;
+      } catch (const std::exception& e) {
+      }
+    };
+    std::unique_ptr<randomized_sobol> sobol;
+    if (quasi_monte_carlo_)
+      sobol = std::make_unique<randomized_sobol>(draw_dimension(), rng);
+    // A batch makes just enough draws to finish if all of them succeed,
+    // which are the draws a serial loop would make
+    for (int n_done = 0, n_monte_carlo_drop = 0; n_done < n_monte_carlo_grad;) {
+      const int n_batch = parallel ? n_monte_carlo_grad - n_done : 1;
+      // the workspace only grows, so later batches reuse its entries
+      if (static_cast<int>(etas.size()) < n_batch) {
+        etas.resize(n_batch);
+        zetas.resize(n_batch);
+        grads.resize(n_batch);
+        draws.streams.resize(n_batch);
+        msgs.resize(n_batch);
+        succeeded.resize(n_batch);
+      }
+      for (int b = 0; b < n_batch; ++b) {
+        // Draw from standard normal
+        etas[b].resize(draw_dimension());
+        if (sobol)
+          sobol->fill(rng, etas[b]);
+        else
+          std_normal_fill(rng, etas[b]);
+      }
+      if (n_batch > 1) {
+        tbb::parallel_for(
+            tbb::blocked_range<int>(0, n_batch),
+            [&](const tbb::blocked_range<int>& r) {
+              for (int b = r.begin(); b != r.end(); ++b) {
+                evaluate(b);
+              }
+            });
+      } else {
+        evaluate(0);
+      }
+      for (int b = 0; b < n_batch; ++b) {
+        if (msgs[b].length() > 0)
+          logger.info(msgs[b]);
+        if (succeeded[b]) {
+          accumulate(etas[b], grads[b]);
+          ++n_done;
+        } else {
+          ++n_monte_carlo_drop;
+          if (n_monte_carlo_drop >= n_retries * n_monte_carlo_grad) {
+            const char* name = "The number of dropped evaluations";
+            const char* msg1 = "has reached its maximum amount (";
+            int y = n_retries * n_monte_carlo_grad;
+            const char* msg2
+                = "). Your model may be either severely "
+                  "ill-conditioned or misspecified.";
+            stan::math::throw_domain_error(function, name, y, msg1, msg2);
+          }
+        }
+      }
+    }
+  }
+
   void write_error_msg_(std::ostream* error_msgs,
                         const std::exception& e) const {
     if (!error_msgs) {
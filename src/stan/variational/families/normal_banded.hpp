@@ -0,0 +1,730 @@
+#ifndef STAN_VARIATIONAL_NORMAL_BANDED_HPP
+#define STAN_VARIATIONAL_NORMAL_BANDED_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/model/gradient.hpp>
+#include <stan/variational/base_family.hpp>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+namespace stan {
+
+namespace variational {
+
+/**
+ * Variational family approximation with a multivariate normal
+ * distribution whose precision has a banded Cholesky factor,
+ * Sigma^-1 = L * L.transpose(), for a lower triangular L with diagonal
+ * exp(omega) and <code>bandwidth</code> subdiagonals.
+ *
+ * <p>The posterior of a time series or state-space model has a banded
+ * precision, as each state depends only on its neighbours, so this
+ * captures the correlations along the chain that mean field loses, while
+ * the dense factor of full rank needs memory and time quadratic in the
+ * dimension.  Neither the covariance nor the precision is formed:
+ * a draw solves one banded triangular system, the entropy is a sum over
+ * the diagonal and the gradient of a Monte Carlo draw solves one more, so
+ * everything is linear in the dimension times the bandwidth, as in
+ * Tan and Nott (2018), https://arxiv.org/abs/1605.05622.
+ *
+ * <p>The subdiagonals are stored as a dimension by bandwidth matrix whose
+ * column <code>k</code> holds subdiagonal <code>k + 1</code>, by the row
+ * of the factor: <code>band(i, k) = L(i, i - k - 1)</code>.  The entries
+ * of the first <code>k + 1</code> rows of column <code>k</code> fall
+ * outside of the factor; they are ignored and their gradient is zero.
+ */
+class normal_banded : public base_family {
+ private:
+  /**
+   * Mean vector.
+   */
+  Eigen::VectorXd mu_;
+
+  /**
+   * Log of the diagonal of the Cholesky factor of the precision.
+   */
+  Eigen::VectorXd omega_;
+
+  /**
+   * Subdiagonals of the Cholesky factor of the precision, one row per
+   * dimension and one column per subdiagonal.
+   */
+  Eigen::MatrixXd band_;
+
+  /**
+   * Dimensionality of distribution.
+   */
+  const int dimension_;
+
+  /**
+   * Number of subdiagonals of the Cholesky factor.
+   */
+  const int bandwidth_;
+
+  /**
+   * Raise a domain exception if the specified vector contains
+   * not-a-number values or does not match this distribution's
+   * dimensionality.
+   */
+  void validate_vector(const char* function, const char* name,
+                       const Eigen::VectorXd& x) const {
+    stan::math::check_size_match(function, "Dimension of input vector",
+                                 x.size(), "Dimension of current vector",
+                                 dimension());
+    stan::math::check_not_nan(function, name, x);
+  }
+
+  /**
+   * Raise a domain exception if the specified subdiagonals contain
+   * not-a-number values or do not have one row per dimension and one
+   * column per subdiagonal.
+   */
+  void validate_band(const char* function, const Eigen::MatrixXd& band) const {
+    stan::math::check_size_match(function, "Rows of band matrix",
+                                 band.rows(), "Dimension of current vector",
+                                 dimension());
+    stan::math::check_size_match(function, "Columns of band matrix",
+                                 band.cols(), "Bandwidth of approximation",
+                                 bandwidth());
+    stan::math::check_not_nan(function, "Band matrix", band);
+  }
+
+  /**
+   * Storage for the solves of <code>calc_grad</code>.
+   */
+  struct solves {
+    Eigen::VectorXd z;
+    Eigen::VectorXd u;
+  };
+
+  /**
+   * Workspace of <code>calc_grad</code>.
+   */
+  workspace<solves> solves_;
+
+  /**
+   * Return the number of subdiagonal entries of row <code>i</code> of the
+   * factor.
+   */
+  int row_width(int i) const { return std::min(bandwidth_, i); }
+
+  /**
+   * Return the number of subdiagonal entries of column <code>i</code> of
+   * the factor.
+   */
+  int column_width(int i) const {
+    return std::min(bandwidth_, dimension_ - 1 - i);
+  }
+
+  /**
+   * Write the solution <code>z</code> of <code>L^T z = eta</code> by back
+   * substitution.
+   *
+   * @param[in] eta Right-hand side.
+   * @param[out] z Solution, which must not be the right-hand side.
+   */
+  void solve_transpose(const Eigen::VectorXd& eta, Eigen::VectorXd& z) const {
+    z.resize(dimension_);
+    for (int i = dimension_ - 1; i >= 0; --i) {
+      double sum = eta.coeff(i);
+      const int width = column_width(i);
+      for (int k = 1; k <= width; ++k)
+        sum -= band_.coeff(i + k, k - 1) * z.coeff(i + k);
+      z.coeffRef(i) = sum * std::exp(-omega_.coeff(i));
+    }
+  }
+
+  /**
+   * Write the solution <code>u</code> of <code>L u = g</code> by forward
+   * substitution.
+   *
+   * @param[in] g Right-hand side.
+   * @param[out] u Solution, which must not be the right-hand side.
+   */
+  void solve(const Eigen::VectorXd& g, Eigen::VectorXd& u) const {
+    u.resize(dimension_);
+    for (int i = 0; i < dimension_; ++i) {
+      double sum = g.coeff(i);
+      const int width = row_width(i);
+      for (int k = 1; k <= width; ++k)
+        sum -= band_.coeff(i, k - 1) * u.coeff(i - k);
+      u.coeffRef(i) = sum * std::exp(-omega_.coeff(i));
+    }
+  }
+
+ public:
+  /**
+   * Construct a variational distribution of the specified
+   * dimensionality and bandwidth with a zero mean and an identity
+   * Cholesky factor of the precision.
+   *
+   * @param[in] dimension Dimensionality of distribution.
+   * @param[in] bandwidth Number of subdiagonals of the factor.
+   */
+  normal_banded(size_t dimension, int bandwidth)
+      : mu_(Eigen::VectorXd::Zero(dimension)),
+        omega_(Eigen::VectorXd::Zero(dimension)),
+        band_(Eigen::MatrixXd::Zero(dimension, bandwidth)),
+        dimension_(dimension),
+        bandwidth_(bandwidth) {}
+
+  /**
+   * Construct a variational distribution with the specified mean vector
+   * and an identity Cholesky factor of the precision.
+   *
+   * @param[in] cont_params Mean vector.
+   * @param[in] bandwidth Number of subdiagonals of the factor.
+   */
+  normal_banded(const Eigen::VectorXd& cont_params, int bandwidth)
+      : mu_(cont_params),
+        omega_(Eigen::VectorXd::Zero(cont_params.size())),
+        band_(Eigen::MatrixXd::Zero(cont_params.size(), bandwidth)),
+        dimension_(cont_params.size()),
+        bandwidth_(bandwidth) {}
+
+  /**
+   * Construct a variational distribution with the specified mean, log
+   * diagonal and subdiagonals of the Cholesky factor of the precision.
+   *
+   * @param[in] mu Mean vector.
+   * @param[in] omega Log of the diagonal of the factor.
+   * @param[in] band Subdiagonals of the factor, one row per dimension.
+   * @throw std::domain_error If the sizes of the mean, log diagonal and
+   * rows of the subdiagonals are different, or if any contains a
+   * not-a-number value.
+   */
+  normal_banded(const Eigen::VectorXd& mu, const Eigen::VectorXd& omega,
+                const Eigen::MatrixXd& band)
+      : mu_(mu),
+        omega_(omega),
+        band_(band),
+        dimension_(mu.size()),
+        bandwidth_(band.cols()) {
+    static const char* function = "stan::variational::normal_banded";
+    validate_vector(function, "Mean vector", mu);
+    validate_vector(function, "Log diagonal vector", omega);
+    validate_band(function, band);
+  }
+
+  /**
+   * Return the dimensionality of the approximation.
+   */
+  int dimension() const { return dimension_; }
+
+  /**
+   * Return the number of subdiagonals of the Cholesky factor of the
+   * precision.
+   */
+  int bandwidth() const { return bandwidth_; }
+
+  /**
+   * Return the mean vector.
+   */
+  const Eigen::VectorXd& mu() const { return mu_; }
+
+  /**
+   * Return the log of the diagonal of the Cholesky factor of the
+   * precision.
+   */
+  const Eigen::VectorXd& omega() const { return omega_; }
+
+  /**
+   * Return the subdiagonals of the Cholesky factor of the precision.
+   */
+  const Eigen::MatrixXd& band() const { return band_; }
+
+  /**
+   * Return the Cholesky factor of the precision as a dense matrix, which
+   * takes memory quadratic in the dimension.
+   */
+  Eigen::MatrixXd L_chol_precision() const {
+    Eigen::MatrixXd L = omega_.array().exp().matrix().asDiagonal();
+    for (int i = 0; i < dimension_; ++i)
+      for (int k = 1; k <= row_width(i); ++k)
+        L(i, i - k) = band_(i, k - 1);
+    return L;
+  }
+
+  /**
+   * Set the mean vector to the specified value.
+   *
+   * @param[in] mu Mean vector.
+   * @throw std::domain_error If the mean vector's size does not
+   * match this approximation's dimensionality, or if it contains
+   * not-a-number values.
+   */
+  void set_mu(const Eigen::VectorXd& mu) {
+    static const char* function = "stan::variational::normal_banded::set_mu";
+    validate_vector(function, "Input vector", mu);
+    mu_ = mu;
+  }
+
+  /**
+   * Set the log of the diagonal of the factor to the specified value.
+   *
+   * @param[in] omega Log diagonal vector.
+   * @throw std::domain_error If the vector's size does not match this
+   * approximation's dimensionality, or if it contains not-a-number
+   * values.
+   */
+  void set_omega(const Eigen::VectorXd& omega) {
+    static const char* function
+        = "stan::variational::normal_banded::set_omega";
+    validate_vector(function, "Input vector", omega);
+    omega_ = omega;
+  }
+
+  /**
+   * Set the subdiagonals of the factor to the specified value.
+   *
+   * @param[in] band Subdiagonals of the factor.
+   * @throw std::domain_error If the matrix does not have one row per
+   * dimension and one column per subdiagonal, or if it contains
+   * not-a-number values.
+   */
+  void set_band(const Eigen::MatrixXd& band) {
+    static const char* function
+        = "stan::variational::normal_banded::set_band";
+    validate_band(function, band);
+    band_ = band;
+  }
+
+  /**
+   * Sets the mean, log diagonal and subdiagonals of this approximation
+   * to zero.
+   */
+  void set_to_zero() {
+    mu_.setZero();
+    omega_.setZero();
+    band_.setZero();
+  }
+
+  /**
+   * Return a new banded approximation resulting from squaring the
+   * entries in the mean, log diagonal and subdiagonals.  The new
+   * approximation does not hold any references to this approximation.
+   */
+  normal_banded square() const {
+    return normal_banded(Eigen::VectorXd(mu_.array().square()),
+                         Eigen::VectorXd(omega_.array().square()),
+                         Eigen::MatrixXd(band_.array().square()));
+  }
+
+  /**
+   * Return a new banded approximation resulting from taking the square
+   * root of the entries in the mean, log diagonal and subdiagonals.  The
+   * new approximation does not hold any references to this
+   * approximation.
+   *
+   * <b>Warning:</b>  No checks are carried out to ensure the
+   * entries are non-negative before taking square roots, so
+   * not-a-number values may result.
+   */
+  normal_banded sqrt() const {
+    return normal_banded(Eigen::VectorXd(mu_.array().sqrt()),
+                         Eigen::VectorXd(omega_.array().sqrt()),
+                         Eigen::MatrixXd(band_.array().sqrt()));
+  }
+
+  /**
+   * Return the sum of the squares of the entries of the mean, log
+   * standard deviations and band, the squared Euclidean norm of this
+   * approximation as a vector of its parameters.
+   */
+  double squared_norm() const {
+    return mu_.squaredNorm() + omega_.squaredNorm() + band_.squaredNorm();
+  }
+
+  /**
+   * Return this approximation after setting its parameters to those of
+   * the specified approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after assignment.
+   * @throw std::domain_error If the dimensionality or bandwidth of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_banded& operator=(const normal_banded& rhs) {
+    static const char* function
+        = "stan::variational::normal_banded::operator=";
+    check_same_shape(function, rhs);
+    mu_ = rhs.mu();
+    omega_ = rhs.omega();
+    band_ = rhs.band();
+    return *this;
+  }
+
+  /**
+   * Add the parameters of the specified approximation to this
+   * approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after adding the specified
+   * approximation.
+   * @throw std::domain_error If the dimensionality or bandwidth of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_banded& operator+=(const normal_banded& rhs) {
+    static const char* function
+        = "stan::variational::normal_banded::operator+=";
+    check_same_shape(function, rhs);
+    mu_ += rhs.mu();
+    omega_ += rhs.omega();
+    band_ += rhs.band();
+    return *this;
+  }
+
+  /**
+   * Return this approximation after elementwise division by the
+   * parameters of the specified approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after elementwise division by the
+   * specified approximation.
+   * @throw std::domain_error If the dimensionality or bandwidth of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_banded& operator/=(const normal_banded& rhs) {
+    static const char* function
+        = "stan::variational::normal_banded::operator/=";
+    check_same_shape(function, rhs);
+    mu_.array() /= rhs.mu().array();
+    omega_.array() /= rhs.omega().array();
+    band_.array() /= rhs.band().array();
+    return *this;
+  }
+
+  /**
+   * Return this approximation after adding the specified scalar to
+   * each of its parameters.
+   *
+   * <b>Warning:</b> No finiteness check is made on the scalar, so
+   * it may introduce NaNs.
+   *
+   * @param[in] scalar Scalar to add.
+   * @return This approximation after elementwise addition of the
+   * specified scalar.
+   */
+  normal_banded& operator+=(double scalar) {
+    mu_.array() += scalar;
+    omega_.array() += scalar;
+    band_.array() += scalar;
+    return *this;
+  }
+
+  /**
+   * Return this approximation after multiplying each of its parameters
+   * by the specified scalar.
+   *
+   * <b>Warning:</b> No finiteness check is made on the scalar, so
+   * it may introduce NaNs.
+   *
+   * @param[in] scalar Scalar to multiply by.
+   * @return This approximation after elementwise multiplication by the
+   * specified scalar.
+   */
+  normal_banded& operator*=(double scalar) {
+    mu_ *= scalar;
+    omega_ *= scalar;
+    band_ *= scalar;
+    return *this;
+  }
+
+  /**
+   * Set this approximation to the elementwise weighted sum of itself
+   * and the square of the specified approximation,
+   * decay * this + weight * rhs.square(), without making new
+   * approximations.
+   *
+   * @param[in] rhs Approximation to square.
+   * @param[in] decay Weight of this approximation.
+   * @param[in] weight Weight of the square of the specified
+   * approximation.
+   * @return This approximation after the update.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximation does not match this approximation's dimensionality.
+   */
+  normal_banded& add_square(const normal_banded& rhs, double decay,
+                            double weight) {
+    static const char* function
+        = "stan::variational::normal_banded::add_square";
+    check_same_shape(function, rhs);
+    mu_.array() = decay * mu_.array() + weight * rhs.mu_.array().square();
+    omega_.array()
+        = decay * omega_.array() + weight * rhs.omega_.array().square();
+    band_.array()
+        = decay * band_.array() + weight * rhs.band_.array().square();
+    return *this;
+  }
+
+  /**
+   * Add the adaptive step of stochastic gradient ascent to this
+   * approximation, scale * grad / (tau + history.sqrt()), without
+   * making new approximations.
+   *
+   * @param[in] scale Step size.
+   * @param[in] grad Gradient of the ELBO.
+   * @param[in] history Weighted sum of squared gradients.
+   * @param[in] tau Offset of the square root of the history.
+   * @return This approximation after the step.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximations does not match this approximation's dimensionality.
+   */
+  normal_banded& add_adagrad_step(double scale, const normal_banded& grad,
+                                  const normal_banded& history, double tau) {
+    static const char* function
+        = "stan::variational::normal_banded::add_adagrad_step";
+    check_same_shape(function, grad);
+    check_same_shape(function, history);
+    mu_.array()
+        += scale * grad.mu_.array() / (history.mu_.array().sqrt() + tau);
+    omega_.array()
+        += scale * grad.omega_.array() / (history.omega_.array().sqrt() + tau);
+    band_.array()
+        += scale * grad.band_.array() / (history.band_.array().sqrt() + tau);
+    return *this;
+  }
+
+  /**
+   * Returns the mean vector for this approximation.
+   *
+   * See: <code>mu()</code>.
+   *
+   * @return Mean vector for this approximation.
+   */
+  const Eigen::VectorXd& mean() const { return mu(); }
+
+  /**
+   * Return the entropy of this approximation.
+   *
+   * <p>As Sigma^-1 = L L^T,
+   *   0.5 * dim * (1+log2pi) + 0.5 * log det Sigma
+   * = 0.5 * dim * (1+log2pi) - sum(omega).
+   *
+   * @return Entropy of this approximation.
+   */
+  double entropy() const {
+    return 0.5 * static_cast<double>(dimension())
+               * (1.0 + stan::math::LOG_TWO_PI)
+           - omega_.sum();
+  }
+
+  /**
+   * Return the transform of the specified standard normal draws.
+   *
+   * The transform is defined by
+   * S^{-1}(eta) = L^-T * eta + mu.
+   *
+   * @param[in] eta Vector to transform.
+   * @throw std::domain_error If the specified vector's size does not
+   * match the dimensionality of the approximation.
+   * @return Transformed vector.
+   */
+  Eigen::VectorXd transform(const Eigen::VectorXd& eta) const {
+    Eigen::VectorXd zeta(dimension());
+    transform_into(eta, zeta);
+    return zeta;
+  }
+
+  /**
+   * Write the transform of the specified standard normal draws to the
+   * specified result, as <code>transform</code> returns it.
+   *
+   * @param[in] eta Vector to transform.
+   * @param[out] zeta Transformed vector.
+   * @throw std::domain_error If the specified vector's size does not
+   * match the dimensionality of the approximation.
+   */
+  void transform_into(const Eigen::VectorXd& eta, Eigen::VectorXd& zeta) const {
+    static const char* function
+        = "stan::variational::normal_banded::transform";
+    stan::math::check_size_match(function, "Dimension of input vector",
+                                 eta.size(), "Dimension of mean vector",
+                                 dimension());
+    stan::math::check_not_nan(function, "Input vector", eta);
+    solve_transpose(eta, zeta);
+    zeta += mu_;
+  }
+
+  /**
+   * Assign a draw from this approximation to the specified vector using
+   * the specified random number generator.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] rng Base random number generator.
+   * @param[out] eta Vector to which the draw is assigned, resized to the
+   * dimension of the approximation.
+   */
+  template <class BaseRNG>
+  void sample(BaseRNG& rng, Eigen::VectorXd& eta) const {
+    Eigen::VectorXd draws(dimension());
+    std_normal_fill(rng, draws);
+    eta = transform(draws);
+  }
+
+  /**
+   * Assign a draw from this approximation to the specified vector and
+   * return the log density of the standard normal draws it was made
+   * from, dropping constants.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] rng Base random number generator.
+   * @param[out] eta Vector to which the draw is assigned, resized to the
+   * dimension of the approximation.
+   * @param[out] log_g The log density of the standard normal draws.
+   */
+  template <class BaseRNG>
+  void sample_log_g(BaseRNG& rng, Eigen::VectorXd& eta, double& log_g) const {
+    Eigen::VectorXd draws(dimension());
+    std_normal_fill(rng, draws);
+    log_g = calc_log_g(draws);
+    eta = transform(draws);
+  }
+
+  /**
+   * Calculates the "blackbox" gradient with respect to the location
+   * vector (mu), the log diagonal (omega) and the subdiagonals of the
+   * Cholesky factor of the precision.  It uses the same gradient
+   * computed from a set of Monte Carlo samples.
+   *
+   * <p>For a draw <code>zeta = mu + z</code> with
+   * <code>L^T z = eta</code> and the gradient <code>g</code> of the log
+   * density at <code>zeta</code>, the gradient with respect to
+   * <code>L(i, j)</code> is <code>-z(i) u(j)</code> for
+   * <code>L u = g</code>, so each draw takes two banded solves and adds
+   * to the gradient in time linear in the dimension times the bandwidth.
+   * The entropy only adds -1 to the gradient of each element of omega.
+   *
+   * @tparam M Model class.
+   * @tparam BaseRNG Class of base random number generator.
+   * @param[in] elbo_grad Approximation to store "blackbox" gradient.
+   * @param[in] m Model.
+   * @param[in] cont_params Continuous parameters.
+   * @param[in] n_monte_carlo_grad Sample size for gradient computation.
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] logger logger for messages
+   * @param[in] parallel Whether to evaluate the gradients of the Monte
+   * Carlo draws in parallel, which gives the same result
+   * @throw std::domain_error If the number of divergent
+   * iterations exceeds its specified bounds.
+   */
+  template <class M, class BaseRNG>
+  void calc_grad(normal_banded& elbo_grad, M& m, Eigen::VectorXd& cont_params,
+                 int n_monte_carlo_grad, BaseRNG& rng,
+                 callbacks::logger& logger, bool parallel = false) const {
+    static const char* function
+        = "stan::variational::normal_banded::calc_grad";
+    check_same_shape(function, elbo_grad);
+    stan::math::check_size_match(function, "Dimension of variational q",
+                                 dimension(), "Dimension of variables in model",
+                                 cont_params.size());
+
+    // Accumulate in place, so that repeated calls do not allocate
+    Eigen::VectorXd& mu_grad = elbo_grad.mu_;
+    Eigen::VectorXd& omega_grad = elbo_grad.omega_;
+    Eigen::MatrixXd& band_grad = elbo_grad.band_;
+    mu_grad.setZero();
+    omega_grad.setZero();
+    band_grad.setZero();
+    solves& w = solves_.get();
+
+    // Naive Monte Carlo integration
+    calc_grad_draws(
+        m, n_monte_carlo_grad, rng, logger, parallel, function,
+        [&](const Eigen::VectorXd& eta, const Eigen::VectorXd& tmp_mu_grad) {
+          mu_grad += tmp_mu_grad;
+          solve_transpose(eta, w.z);
+          solve(tmp_mu_grad, w.u);
+          omega_grad.array() -= w.z.array() * w.u.array();
+          for (int i = 0; i < dimension_; ++i) {
+            const int width = row_width(i);
+            for (int k = 1; k <= width; ++k)
+              band_grad.coeffRef(i, k - 1) -= w.z.coeff(i) * w.u.coeff(i - k);
+          }
+        });
+    mu_grad /= static_cast<double>(n_monte_carlo_grad);
+    omega_grad /= static_cast<double>(n_monte_carlo_grad);
+    band_grad /= static_cast<double>(n_monte_carlo_grad);
+    omega_grad.array() *= omega_.array().exp();
+
+    // Add gradient of entropy term, -sum(omega)
+    omega_grad.array() -= 1;
+
+    stan::math::check_not_nan(function, "Gradient of mu", mu_grad);
+    stan::math::check_not_nan(function, "Gradient of omega", omega_grad);
+    stan::math::check_not_nan(function, "Gradient of band", band_grad);
+  }
+
+ private:
+  /**
+   * Raise a domain exception if the specified approximation does not
+   * have the dimensionality and bandwidth of this one.
+   */
+  void check_same_shape(const char* function, const normal_banded& rhs) const {
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of rhs", rhs.dimension());
+    stan::math::check_size_match(function, "Bandwidth of lhs", bandwidth(),
+                                 "Bandwidth of rhs", rhs.bandwidth());
+  }
+};
+
+/**
+ * Return a new approximation resulting from adding the parameters of
+ * the specified approximations.
+ *
+ * @param[in] lhs First approximation.
+ * @param[in] rhs Second approximation.
+ * @return Sum of the specified approximations.
+ * @throw std::domain_error If the dimensionalities or bandwidths do not
+ * match.
+ */
+inline normal_banded operator+(normal_banded lhs, const normal_banded& rhs) {
+  return lhs += rhs;
+}
+
+/**
+ * Return a new approximation resulting from elementwise division of
+ * the first specified approximation by the second.
+ *
+ * @param[in] lhs First approximation.
+ * @param[in] rhs Second approximation.
+ * @return Elementwise division of the specified approximations.
+ * @throw std::domain_error If the dimensionalities or bandwidths do not
+ * match.
+ */
+inline normal_banded operator/(normal_banded lhs, const normal_banded& rhs) {
+  return lhs /= rhs;
+}
+
+/**
+ * Return a new approximation resulting from elementwise addition
+ * of the specified scalar to the parameters of the specified
+ * approximation.
+ *
+ * @param[in] scalar Scalar value
+ * @param[in] rhs Approximation.
+ * @return Addition of scalar to specified approximation.
+ */
+inline normal_banded operator+(double scalar, normal_banded rhs) {
+  return rhs += scalar;
+}
+
+/**
+ * Return a new approximation resulting from elementwise
+ * multiplication of the specified scalar to the parameters of the
+ * specified approximation.
+ *
+ * @param[in] scalar Scalar value
+ * @param[in] rhs Approximation.
+ * @return Multiplication of scalar by the specified approximation.
+ */
+inline normal_banded operator*(double scalar, normal_banded rhs) {
+  return rhs *= scalar;
+}
+
+}  // namespace variational
+}  // namespace stan
+#endif
@@ -35,6 +35,12 @@ class normal_fullrank : public base_family {
    */
   const int dimension_;
 
+  /**
+   * Whether <code>calc_grad</code> uses the "sticking the landing"
+   * estimator.
+   */
+  bool sticking_the_landing_ = false;
+
   /**
    * Raise a domain exception if the specified vector contains
    * not-a-number values.
@@ -135,6 +141,26 @@ class normal_fullrank : public base_family {
    */
   const Eigen::MatrixXd& L_chol() const { return L_chol_; }
 
+  /**
+   * Set whether <code>calc_grad</code> estimates the gradient of the ELBO
+   * with the "sticking the landing" estimator of Roeder, Wu and Duvenaud
+   * (2017) rather than the analytic gradient of the entropy.  It drops
+   * the score function term, whose expectation is zero, from the
+   * gradient of <code>log p - log q</code> at each draw, so its variance
+   * vanishes as the approximation approaches the posterior.
+   *
+   * @param[in] sticking_the_landing Whether to use the estimator.
+   */
+  void set_sticking_the_landing(bool sticking_the_landing) {
+    sticking_the_landing_ = sticking_the_landing;
+  }
+
+  /**
+   * Return whether <code>calc_grad</code> uses the "sticking the
+   * landing" estimator.
+   */
+  bool sticking_the_landing() const { return sticking_the_landing_; }
+
   /**
    * Set the mean vector to the specified value.
    *
@@ -168,8 +194,8 @@ class normal_fullrank : public base_family {
    * matrix to zero.
    */
   void set_to_zero() {
-    mu_ = Eigen::VectorXd::Zero(dimension());
-    L_chol_ = Eigen::MatrixXd::Zero(dimension(), dimension());
+    mu_.setZero();
+    L_chol_.setZero();
   }
 
   /**
@@ -198,6 +224,15 @@ class normal_fullrank : public base_family {
                            Eigen::MatrixXd(L_chol_.array().sqrt()));
   }
 
+  /**
+   * Return the sum of the squares of the entries of the mean vector
+   * and Cholesky factor, the squared Euclidean norm of this
+   * approximation as a vector of its parameters.
+   */
+  double squared_norm() const {
+    return mu_.squaredNorm() + L_chol_.squaredNorm();
+  }
+
   /**
    * Return this approximation after setting its mean vector and
    * Cholesky factor for covariance to the values given by the
@@ -299,6 +334,61 @@ class normal_fullrank : public base_family {
     return *this;
   }
 
+  /**
+   * Set this approximation to the elementwise weighted sum of itself
+   * and the square of the specified approximation,
+   * decay * this + weight * rhs.square(), without making new
+   * approximations.
+   *
+   * @param[in] rhs Approximation to square.
+   * @param[in] decay Weight of this approximation.
+   * @param[in] weight Weight of the square of the specified
+   * approximation.
+   * @return This approximation after the update.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximation does not match this approximation's dimensionality.
+   */
+  normal_fullrank& add_square(const normal_fullrank& rhs, double decay,
+                              double weight) {
+    static const char* function
+        = "stan::variational::normal_fullrank::add_square";
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of rhs", rhs.dimension());
+    mu_.array() = decay * mu_.array() + weight * rhs.mu_.array().square();
+    L_chol_.array()
+        = decay * L_chol_.array() + weight * rhs.L_chol_.array().square();
+    return *this;
+  }
+
+  /**
+   * Add the adaptive step of stochastic gradient ascent to this
+   * approximation, scale * grad / (tau + history.sqrt()), without
+   * making new approximations.
+   *
+   * @param[in] scale Step size.
+   * @param[in] grad Gradient of the ELBO.
+   * @param[in] history Weighted sum of squared gradients.
+   * @param[in] tau Offset of the square root of the history.
+   * @return This approximation after the step.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximations does not match this approximation's dimensionality.
+   */
+  normal_fullrank& add_adagrad_step(double scale, const normal_fullrank& grad,
+                                    const normal_fullrank& history,
+                                    double tau) {
+    static const char* function
+        = "stan::variational::normal_fullrank::add_adagrad_step";
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of gradient", grad.dimension());
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of history", history.dimension());
+    mu_.array()
+        += scale * grad.mu_.array() / (history.mu_.array().sqrt() + tau);
+    L_chol_.array() += scale * grad.L_chol_.array()
+                       / (history.L_chol_.array().sqrt() + tau);
+    return *this;
+  }
+
   /**
    * Returns the mean vector for this approximation.
    *
@@ -341,6 +431,21 @@ class normal_fullrank : public base_family {
    * @return Transformed vector.
    */
   Eigen::VectorXd transform(const Eigen::VectorXd& eta) const {
+    Eigen::VectorXd zeta(dimension());
+    transform_into(eta, zeta);
+    return zeta;
+  }
+
+  /**
+   * Write the transform of the specified vector to the specified
+   * result, as <code>transform</code> returns it.
+   *
+   * @param[in] eta Vector to transform.
+   * @param[out] zeta Transformed vector.
+   * @throw std::domain_error If the specified vector's size does
+   * not match the dimensionality of this approximation.
+   */
+  void transform_into(const Eigen::VectorXd& eta, Eigen::VectorXd& zeta) const {
     static const char* function
         = "stan::variational::normal_fullrank::transform";
     stan::math::check_size_match(function, "Dimension of input vector",
@@ -348,23 +453,21 @@ class normal_fullrank : public base_family {
                                  dimension());
     stan::math::check_not_nan(function, "Input vector", eta);
 
-    return (L_chol_ * eta) + mu_;
+    zeta.noalias() = L_chol_ * eta;
+    zeta += mu_;
   }
 
   template <class BaseRNG>
   void sample(BaseRNG& rng, Eigen::VectorXd& eta) const {
     // Draw from standard normal and transform to real-coordinate space
-    for (int d = 0; d < dimension(); ++d)
-      eta(d) = stan::math::normal_rng(0, 1, rng);
+    std_normal_fill(rng, eta);
     eta = transform(eta);
   }
 
   template <class BaseRNG>
   void sample_log_g(BaseRNG& rng, Eigen::VectorXd& eta, double& log_g) const {
     // Draw from the approximation
-    for (int d = 0; d < dimension(); ++d) {
-      eta(d) = stan::math::normal_rng(0, 1, rng);
-    }
+    std_normal_fill(rng, eta);
     // Compute the log density before transformation
     log_g = calc_log_g(eta);
     // Transform to real-coordinate space
@@ -394,13 +497,15 @@ class normal_fullrank : public base_family {
    * @param[in] n_monte_carlo_grad Sample size for gradient computation.
    * @param[in,out] rng Random number generator.
    * @param[in,out] logger logger for messages
+   * @param[in] parallel Whether to evaluate the gradients of the Monte
+   * Carlo draws in parallel, which gives the same result
    * @throw std::domain_error If the number of divergent
    * iterations exceeds its specified bounds.
    */
   template <class M, class BaseRNG>
   void calc_grad(normal_fullrank& elbo_grad, M& m, Eigen::VectorXd& cont_params,
                  int n_monte_carlo_grad, BaseRNG& rng,
-                 callbacks::logger& logger) const {
+                 callbacks::logger& logger, bool parallel = false) const {
     static const char* function
         = "stan::variational::normal_fullrank::calc_grad";
     stan::math::check_size_match(function, "Dimension of elbo_grad",
@@ -410,56 +515,44 @@ class normal_fullrank : public base_family {
                                  dimension(), "Dimension of variables in model",
                                  cont_params.size());
 
-    Eigen::VectorXd mu_grad = Eigen::VectorXd::Zero(dimension());
-    Eigen::MatrixXd L_grad = Eigen::MatrixXd::Zero(dimension(), dimension());
-    double tmp_lp = 0.0;
-    Eigen::VectorXd tmp_mu_grad = Eigen::VectorXd::Zero(dimension());
-    Eigen::VectorXd eta = Eigen::VectorXd::Zero(dimension());
-    Eigen::VectorXd zeta = Eigen::VectorXd::Zero(dimension());
+    // Accumulate in place, so that repeated calls do not allocate
+    Eigen::VectorXd& mu_grad = elbo_grad.mu_;
+    Eigen::MatrixXd& L_grad = elbo_grad.L_chol_;
+    mu_grad.setZero();
+    L_grad.setZero();
+
+    // Sticking the landing adds the gradient of -log q at the draw,
+    // L^-T * eta, to that of the model
+    Eigen::VectorXd path_grad(sticking_the_landing_ ? dimension() : 0);
 
     // Naive Monte Carlo integration
-    static const int n_retries = 10;
-    for (int i = 0, n_monte_carlo_drop = 0; i < n_monte_carlo_grad;) {
-      // Draw from standard normal and transform to real-coordinate space
-      for (int d = 0; d < dimension(); ++d) {
-        eta(d) = stan::math::normal_rng(0, 1, rng);
-      }
-      zeta = transform(eta);
-      try {
-        std::stringstream ss;
-        stan::model::gradient(m, zeta, tmp_lp, tmp_mu_grad, &ss);
-        if (ss.str().length() > 0)
-          logger.info(ss);
-        stan::math::check_finite(function, "Gradient of mu", tmp_mu_grad);
-
-        mu_grad += tmp_mu_grad;
-        for (int ii = 0; ii < dimension(); ++ii) {
-          for (int jj = 0; jj <= ii; ++jj) {
-            L_grad(ii, jj) += tmp_mu_grad(ii) * eta(jj);
+    calc_grad_draws(
+        m, n_monte_carlo_grad, rng, logger, parallel, function,
+        [&](const Eigen::VectorXd& eta, const Eigen::VectorXd& tmp_mu_grad) {
+          const Eigen::VectorXd* grad = &tmp_mu_grad;
+          if (sticking_the_landing_) {
+            path_grad = eta;
+            L_chol_.triangularView<Eigen::Lower>().transpose().solveInPlace(
+                path_grad);
+            path_grad += tmp_mu_grad;
+            grad = &path_grad;
           }
-        }
-        ++i;
-      } catch (const std::exception& e) {
-        ++n_monte_carlo_drop;
-        if (n_monte_carlo_drop >= n_retries * n_monte_carlo_grad) {
-          const char* name = "The number of dropped evaluations";
-          const char* msg1 = "has reached its maximum amount (";
-          int y = n_retries * n_monte_carlo_grad;
-          const char* msg2
-              = "). Your model may be either severely "
-                "ill-conditioned or misspecified.";
-          stan::math::throw_domain_error(function, name, y, msg1, msg2);
-        }
-      }
-    }
+          mu_grad += *grad;
+          for (int ii = 0; ii < dimension(); ++ii) {
+            for (int jj = 0; jj <= ii; ++jj) {
+              L_grad(ii, jj) += (*grad)(ii) * eta(jj);
+            }
+          }
+        });
     mu_grad /= static_cast<double>(n_monte_carlo_grad);
     L_grad /= static_cast<double>(n_monte_carlo_grad);
 
     // Add gradient of entropy term
-    L_grad.diagonal().array() += L_chol_.diagonal().array().inverse();
+    if (!sticking_the_landing_)
+      L_grad.diagonal().array() += L_chol_.diagonal().array().inverse();
 
-    elbo_grad.set_mu(mu_grad);
-    elbo_grad.set_L_chol(L_grad);
+    stan::math::check_not_nan(function, "Gradient of mu", mu_grad);
+    stan::math::check_not_nan(function, "Gradient of L_chol", L_grad);
   }
 };
 
@@ -0,0 +1,684 @@
+#ifndef STAN_VARIATIONAL_NORMAL_LOWRANK_HPP
+#define STAN_VARIATIONAL_NORMAL_LOWRANK_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim.hpp>
+#include <stan/model/gradient.hpp>
+#include <stan/variational/base_family.hpp>
+#include <algorithm>
+#include <ostream>
+#include <vector>
+
+namespace stan {
+
+namespace variational {
+
+/**
+ * Variational family approximation with a multivariate normal
+ * distribution whose covariance is diagonal plus low rank,
+ * Sigma = diag(exp(2 * omega)) + B * B.transpose(),
+ * for a dimension by rank factor matrix B.
+ *
+ * <p>The covariance is never formed: a draw takes one standard normal
+ * per dimension and one per factor, and the entropy and its gradient
+ * only factor a rank by rank matrix, so for a rank much smaller than
+ * the dimension the approximation costs not much more than the mean
+ * field one while capturing the strongest correlations, as in Ong,
+ * Nott and Smith (2018), https://arxiv.org/abs/1701.03208.
+ */
+class normal_lowrank : public base_family {
+ private:
+  /**
+   * Mean vector.
+   */
+  Eigen::VectorXd mu_;
+
+  /**
+   * Log standard deviation (log scale) vector of the diagonal part.
+   */
+  Eigen::VectorXd omega_;
+
+  /**
+   * Factor matrix of the low rank part, one row per dimension and one
+   * column per factor.
+   */
+  Eigen::MatrixXd B_;
+
+  /**
+   * Dimensionality of distribution.
+   */
+  const int dimension_;
+
+  /**
+   * Rank of the low rank part.
+   */
+  const int rank_;
+
+  /**
+   * Raise a domain exception if the specified vector contains
+   * not-a-number values or does not match this distribution's
+   * dimensionality.
+   */
+  void validate_vector(const char* function, const char* name,
+                       const Eigen::VectorXd& x) const {
+    stan::math::check_size_match(function, "Dimension of input vector",
+                                 x.size(), "Dimension of current vector",
+                                 dimension());
+    stan::math::check_not_nan(function, name, x);
+  }
+
+  /**
+   * Raise a domain exception if the specified factor matrix contains
+   * not-a-number values or does not have one row per dimension and one
+   * column per factor.
+   */
+  void validate_factor(const char* function, const Eigen::MatrixXd& B) const {
+    stan::math::check_size_match(function, "Rows of factor matrix",
+                                 B.rows(), "Dimension of current vector",
+                                 dimension());
+    stan::math::check_size_match(function, "Columns of factor matrix",
+                                 B.cols(), "Rank of approximation", rank());
+    stan::math::check_not_nan(function, "Factor matrix", B);
+  }
+
+  /**
+   * Storage for the factorization of <code>factor_capacitance</code>
+   * and the solve of the entropy gradient.
+   */
+  struct capacitance {
+    Eigen::MatrixXd E;
+    Eigen::MatrixXd C;
+    Eigen::LLT<Eigen::MatrixXd> llt;
+    Eigen::MatrixXd F;
+  };
+
+  /**
+   * Workspace of <code>calc_grad</code>.
+   */
+  workspace<capacitance> capacitance_;
+
+  /**
+   * Compute the Cholesky factorization of the rank by rank matrix
+   * I + B^T diag(exp(-2 * omega)) B, through which the determinant and
+   * inverse of the covariance follow from those of its diagonal.
+   *
+   * @param[in,out] w Storage for the factorization, reused when it was
+   * used for an approximation of the same shape.
+   * @return The factorization, held by the storage.
+   */
+  const Eigen::LLT<Eigen::MatrixXd>& factor_capacitance(
+      capacitance& w) const {
+    w.E.noalias() = (-omega_).array().exp().matrix().asDiagonal() * B_;
+    w.C.setIdentity(rank(), rank());
+    w.C.selfadjointView<Eigen::Lower>().rankUpdate(w.E.transpose());
+    return w.llt.compute(w.C);
+  }
+
+ public:
+  /**
+   * Construct a variational distribution of the specified
+   * dimensionality and rank with a zero mean, zero log standard
+   * deviation and zero factor matrix.
+   *
+   * @param[in] dimension Dimensionality of distribution.
+   * @param[in] rank Rank of the low rank part.
+   */
+  normal_lowrank(size_t dimension, int rank)
+      : mu_(Eigen::VectorXd::Zero(dimension)),
+        omega_(Eigen::VectorXd::Zero(dimension)),
+        B_(Eigen::MatrixXd::Zero(dimension, rank)),
+        dimension_(dimension),
+        rank_(rank) {}
+
+  /**
+   * Construct a variational distribution with the specified mean
+   * vector, zero log standard deviation and small factors along the
+   * first coordinates.  The factors must not start at zero, where the
+   * gradient with respect to them vanishes.
+   *
+   * @param[in] cont_params Mean vector.
+   * @param[in] rank Rank of the low rank part.
+   */
+  normal_lowrank(const Eigen::VectorXd& cont_params, int rank)
+      : mu_(cont_params),
+        omega_(Eigen::VectorXd::Zero(cont_params.size())),
+        B_(0.1 * Eigen::MatrixXd::Identity(cont_params.size(), rank)),
+        dimension_(cont_params.size()),
+        rank_(rank) {}
+
+  /**
+   * Construct a variational distribution with the specified mean,
+   * log standard deviation and factor matrix.
+   *
+   * @param[in] mu Mean vector.
+   * @param[in] omega Log standard deviation vector.
+   * @param[in] B Factor matrix, one row per dimension.
+   * @throw std::domain_error If the sizes of the mean, log standard
+   * deviation and rows of the factor matrix are different, or if any
+   * contains a not-a-number value.
+   */
+  normal_lowrank(const Eigen::VectorXd& mu, const Eigen::VectorXd& omega,
+                 const Eigen::MatrixXd& B)
+      : mu_(mu),
+        omega_(omega),
+        B_(B),
+        dimension_(mu.size()),
+        rank_(B.cols()) {
+    static const char* function = "stan::variational::normal_lowrank";
+    validate_vector(function, "Mean vector", mu);
+    validate_vector(function, "Log std vector", omega);
+    validate_factor(function, B);
+  }
+
+  /**
+   * Return the dimensionality of the approximation.
+   */
+  int dimension() const { return dimension_; }
+
+  /**
+   * Return the number of standard normal draws a draw from the
+   * approximation takes, one per dimension and one per factor.
+   */
+  int draw_dimension() const { return dimension_ + rank_; }
+
+  /**
+   * Return the rank of the low rank part.
+   */
+  int rank() const { return rank_; }
+
+  /**
+   * Return the mean vector.
+   */
+  const Eigen::VectorXd& mu() const { return mu_; }
+
+  /**
+   * Return the log standard deviation vector of the diagonal part.
+   */
+  const Eigen::VectorXd& omega() const { return omega_; }
+
+  /**
+   * Return the factor matrix of the low rank part.
+   */
+  const Eigen::MatrixXd& B() const { return B_; }
+
+  /**
+   * Set the mean vector to the specified value.
+   *
+   * @param[in] mu Mean vector.
+   * @throw std::domain_error If the mean vector's size does not
+   * match this approximation's dimensionality, or if it contains
+   * not-a-number values.
+   */
+  void set_mu(const Eigen::VectorXd& mu) {
+    static const char* function = "stan::variational::normal_lowrank::set_mu";
+    validate_vector(function, "Input vector", mu);
+    mu_ = mu;
+  }
+
+  /**
+   * Set the log standard deviation vector to the specified value.
+   *
+   * @param[in] omega Log standard deviation vector.
+   * @throw std::domain_error If the vector's size does not match this
+   * approximation's dimensionality, or if it contains not-a-number
+   * values.
+   */
+  void set_omega(const Eigen::VectorXd& omega) {
+    static const char* function
+        = "stan::variational::normal_lowrank::set_omega";
+    validate_vector(function, "Input vector", omega);
+    omega_ = omega;
+  }
+
+  /**
+   * Set the factor matrix to the specified value.
+   *
+   * @param[in] B Factor matrix.
+   * @throw std::domain_error If the matrix does not have one row per
+   * dimension and one column per factor, or if it contains not-a-number
+   * values.
+   */
+  void set_B(const Eigen::MatrixXd& B) {
+    static const char* function = "stan::variational::normal_lowrank::set_B";
+    validate_factor(function, B);
+    B_ = B;
+  }
+
+  /**
+   * Sets the mean, log standard deviation and factor matrix of this
+   * approximation to zero.
+   */
+  void set_to_zero() {
+    mu_.setZero();
+    omega_.setZero();
+    B_.setZero();
+  }
+
+  /**
+   * Return a new low rank approximation resulting from squaring the
+   * entries in the mean, log standard deviation and factor matrix.  The
+   * new approximation does not hold any references to this
+   * approximation.
+   */
+  normal_lowrank square() const {
+    return normal_lowrank(Eigen::VectorXd(mu_.array().square()),
+                          Eigen::VectorXd(omega_.array().square()),
+                          Eigen::MatrixXd(B_.array().square()));
+  }
+
+  /**
+   * Return a new low rank approximation resulting from taking the
+   * square root of the entries in the mean, log standard deviation and
+   * factor matrix.  The new approximation does not hold any references
+   * to this approximation.
+   *
+   * <b>Warning:</b>  No checks are carried out to ensure the
+   * entries are non-negative before taking square roots, so
+   * not-a-number values may result.
+   */
+  normal_lowrank sqrt() const {
+    return normal_lowrank(Eigen::VectorXd(mu_.array().sqrt()),
+                          Eigen::VectorXd(omega_.array().sqrt()),
+                          Eigen::MatrixXd(B_.array().sqrt()));
+  }
+
+  /**
+   * Return the sum of the squares of the entries of the mean, log
+   * standard deviations and factor, the squared Euclidean norm of this
+   * approximation as a vector of its parameters.
+   */
+  double squared_norm() const {
+    return mu_.squaredNorm() + omega_.squaredNorm() + B_.squaredNorm();
+  }
+
+  /**
+   * Return this approximation after setting its parameters to those of
+   * the specified approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after assignment.
+   * @throw std::domain_error If the dimensionality or rank of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_lowrank& operator=(const normal_lowrank& rhs) {
+    static const char* function
+        = "stan::variational::normal_lowrank::operator=";
+    check_same_shape(function, rhs);
+    mu_ = rhs.mu();
+    omega_ = rhs.omega();
+    B_ = rhs.B();
+    return *this;
+  }
+
+  /**
+   * Add the parameters of the specified approximation to this
+   * approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after adding the specified
+   * approximation.
+   * @throw std::domain_error If the dimensionality or rank of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_lowrank& operator+=(const normal_lowrank& rhs) {
+    static const char* function
+        = "stan::variational::normal_lowrank::operator+=";
+    check_same_shape(function, rhs);
+    mu_ += rhs.mu();
+    omega_ += rhs.omega();
+    B_ += rhs.B();
+    return *this;
+  }
+
+  /**
+   * Return this approximation after elementwise division by the
+   * parameters of the specified approximation.
+   *
+   * @param[in] rhs Approximation from which to gather the parameters.
+   * @return This approximation after elementwise division by the
+   * specified approximation.
+   * @throw std::domain_error If the dimensionality or rank of the
+   * specified approximation does not match this approximation's.
+   */
+  normal_lowrank& operator/=(const normal_lowrank& rhs) {
+    static const char* function
+        = "stan::variational::normal_lowrank::operator/=";
+    check_same_shape(function, rhs);
+    mu_.array() /= rhs.mu().array();
+    omega_.array() /= rhs.omega().array();
+    B_.array() /= rhs.B().array();
+    return *this;
+  }
+
+  /**
+   * Return this approximation after adding the specified scalar to
+   * each of its parameters.
+   *
+   * <b>Warning:</b> No finiteness check is made on the scalar, so
+   * it may introduce NaNs.
+   *
+   * @param[in] scalar Scalar to add.
+   * @return This approximation after elementwise addition of the
+   * specified scalar.
+   */
+  normal_lowrank& operator+=(double scalar) {
+    mu_.array() += scalar;
+    omega_.array() += scalar;
+    B_.array() += scalar;
+    return *this;
+  }
+
+  /**
+   * Return this approximation after multiplying each of its parameters
+   * by the specified scalar.
+   *
+   * <b>Warning:</b> No finiteness check is made on the scalar, so
+   * it may introduce NaNs.
+   *
+   * @param[in] scalar Scalar to multiply by.
+   * @return This approximation after elementwise multiplication by the
+   * specified scalar.
+   */
+  normal_lowrank& operator*=(double scalar) {
+    mu_ *= scalar;
+    omega_ *= scalar;
+    B_ *= scalar;
+    return *this;
+  }
+
+  /**
+   * Set this approximation to the elementwise weighted sum of itself
+   * and the square of the specified approximation,
+   * decay * this + weight * rhs.square(), without making new
+   * approximations.
+   *
+   * @param[in] rhs Approximation to square.
+   * @param[in] decay Weight of this approximation.
+   * @param[in] weight Weight of the square of the specified
+   * approximation.
+   * @return This approximation after the update.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximation does not match this approximation's dimensionality.
+   */
+  normal_lowrank& add_square(const normal_lowrank& rhs, double decay,
+                             double weight) {
+    static const char* function
+        = "stan::variational::normal_lowrank::add_square";
+    check_same_shape(function, rhs);
+    mu_.array() = decay * mu_.array() + weight * rhs.mu_.array().square();
+    omega_.array()
+        = decay * omega_.array() + weight * rhs.omega_.array().square();
+    B_.array() = decay * B_.array() + weight * rhs.B_.array().square();
+    return *this;
+  }
+
+  /**
+   * Add the adaptive step of stochastic gradient ascent to this
+   * approximation, scale * grad / (tau + history.sqrt()), without
+   * making new approximations.
+   *
+   * @param[in] scale Step size.
+   * @param[in] grad Gradient of the ELBO.
+   * @param[in] history Weighted sum of squared gradients.
+   * @param[in] tau Offset of the square root of the history.
+   * @return This approximation after the step.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximations does not match this approximation's dimensionality.
+   */
+  normal_lowrank& add_adagrad_step(double scale, const normal_lowrank& grad,
+                                   const normal_lowrank& history, double tau) {
+    static const char* function
+        = "stan::variational::normal_lowrank::add_adagrad_step";
+    check_same_shape(function, grad);
+    check_same_shape(function, history);
+    mu_.array()
+        += scale * grad.mu_.array() / (history.mu_.array().sqrt() + tau);
+    omega_.array()
+        += scale * grad.omega_.array() / (history.omega_.array().sqrt() + tau);
+    B_.array() += scale * grad.B_.array() / (history.B_.array().sqrt() + tau);
+    return *this;
+  }
+
+  /**
+   * Returns the mean vector for this approximation.
+   *
+   * See: <code>mu()</code>.
+   *
+   * @return Mean vector for this approximation.
+   */
+  const Eigen::VectorXd& mean() const { return mu(); }
+
+  /**
+   * Return the entropy of this approximation.
+   *
+   * <p>With D = diag(exp(omega)), the matrix determinant lemma gives
+   *   0.5 * dim * (1+log2pi) + 0.5 * log det (D^2 + B B^T)
+   * = 0.5 * dim * (1+log2pi) + sum(omega)
+   *   + 0.5 * log det (I + B^T D^-2 B).
+   *
+   * @return Entropy of this approximation.
+   */
+  double entropy() const {
+    capacitance w;
+    const Eigen::LLT<Eigen::MatrixXd>& llt = factor_capacitance(w);
+    return 0.5 * static_cast<double>(dimension())
+               * (1.0 + stan::math::LOG_TWO_PI)
+           + omega_.sum()
+           + llt.matrixLLT().diagonal().array().log().sum();
+  }
+
+  /**
+   * Return the transform of the specified standard normal draws, one
+   * per dimension followed by one per factor.
+   *
+   * The transform is defined by
+   * S^{-1}(eta) = exp(omega) * eta.head(dim) + B * eta.tail(rank) + mu.
+   *
+   * @param[in] eta Vector to transform.
+   * @throw std::domain_error If the specified vector's size is not
+   * <code>draw_dimension()</code>.
+   * @return Transformed vector.
+   */
+  Eigen::VectorXd transform(const Eigen::VectorXd& eta) const {
+    Eigen::VectorXd zeta(dimension());
+    transform_into(eta, zeta);
+    return zeta;
+  }
+
+  /**
+   * Write the transform of the specified standard normal draws to the
+   * specified result, as <code>transform</code> returns it.
+   *
+   * @param[in] eta Vector to transform.
+   * @param[out] zeta Transformed vector.
+   * @throw std::domain_error If the specified vector's size is not
+   * <code>draw_dimension()</code>.
+   */
+  void transform_into(const Eigen::VectorXd& eta, Eigen::VectorXd& zeta) const {
+    static const char* function
+        = "stan::variational::normal_lowrank::transform";
+    stan::math::check_size_match(function, "Dimension of input vector",
+                                 eta.size(), "Number of draws needed",
+                                 draw_dimension());
+    stan::math::check_not_nan(function, "Input vector", eta);
+    zeta = eta.head(dimension()).cwiseProduct(omega_.array().exp().matrix())
+           + mu_;
+    zeta.noalias() += B_ * eta.tail(rank());
+  }
+
+  /**
+   * Assign a draw from this approximation to the specified vector using
+   * the specified random number generator.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] rng Base random number generator.
+   * @param[out] eta Vector to which the draw is assigned, resized to the
+   * dimension of the approximation.
+   */
+  template <class BaseRNG>
+  void sample(BaseRNG& rng, Eigen::VectorXd& eta) const {
+    Eigen::VectorXd draws(draw_dimension());
+    std_normal_fill(rng, draws);
+    eta = transform(draws);
+  }
+
+  /**
+   * Assign a draw from this approximation to the specified vector and
+   * return the log density of the standard normal draws it was made
+   * from, dropping constants.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] rng Base random number generator.
+   * @param[out] eta Vector to which the draw is assigned, resized to the
+   * dimension of the approximation.
+   * @param[out] log_g The log density of the standard normal draws.
+   */
+  template <class BaseRNG>
+  void sample_log_g(BaseRNG& rng, Eigen::VectorXd& eta, double& log_g) const {
+    Eigen::VectorXd draws(draw_dimension());
+    std_normal_fill(rng, draws);
+    log_g = calc_log_g(draws);
+    eta = transform(draws);
+  }
+
+  /**
+   * Calculates the "blackbox" gradient with respect to the location
+   * vector (mu), the log-std vector (omega) and the factor matrix (B).
+   * It uses the same gradient computed from a set of Monte Carlo
+   * samples.  Each draw adds to the gradient in time linear in the
+   * dimension and rank; the entropy term takes one solve with the
+   * rank by rank matrix of <code>entropy()</code>.
+   *
+   * @tparam M Model class.
+   * @tparam BaseRNG Class of base random number generator.
+   * @param[in] elbo_grad Approximation to store "blackbox" gradient.
+   * @param[in] m Model.
+   * @param[in] cont_params Continuous parameters.
+   * @param[in] n_monte_carlo_grad Sample size for gradient computation.
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] logger logger for messages
+   * @param[in] parallel Whether to evaluate the gradients of the Monte
+   * Carlo draws in parallel, which gives the same result
+   * @throw std::domain_error If the number of divergent
+   * iterations exceeds its specified bounds.
+   */
+  template <class M, class BaseRNG>
+  void calc_grad(normal_lowrank& elbo_grad, M& m, Eigen::VectorXd& cont_params,
+                 int n_monte_carlo_grad, BaseRNG& rng,
+                 callbacks::logger& logger, bool parallel = false) const {
+    static const char* function
+        = "stan::variational::normal_lowrank::calc_grad";
+    check_same_shape(function, elbo_grad);
+    stan::math::check_size_match(function, "Dimension of variational q",
+                                 dimension(), "Dimension of variables in model",
+                                 cont_params.size());
+
+    // Accumulate in place, so that repeated calls do not allocate
+    Eigen::VectorXd& mu_grad = elbo_grad.mu_;
+    Eigen::VectorXd& omega_grad = elbo_grad.omega_;
+    Eigen::MatrixXd& B_grad = elbo_grad.B_;
+    mu_grad.setZero();
+    omega_grad.setZero();
+    B_grad.setZero();
+
+    // Naive Monte Carlo integration
+    calc_grad_draws(
+        m, n_monte_carlo_grad, rng, logger, parallel, function,
+        [&](const Eigen::VectorXd& eta, const Eigen::VectorXd& tmp_mu_grad) {
+          mu_grad += tmp_mu_grad;
+          omega_grad.array()
+              += tmp_mu_grad.array() * eta.head(dimension()).array();
+          B_grad.noalias() += tmp_mu_grad * eta.tail(rank()).transpose();
+        });
+    mu_grad /= static_cast<double>(n_monte_carlo_grad);
+    omega_grad /= static_cast<double>(n_monte_carlo_grad);
+    B_grad /= static_cast<double>(n_monte_carlo_grad);
+    omega_grad.array() *= omega_.array().exp();
+
+    // Add gradient of entropy term, 0.5 * log det Sigma, through
+    // Sigma^-1 B = D^-2 B C^-1 for C = I + B^T D^-2 B
+    capacitance& w = capacitance_.get();
+    w.F = factor_capacitance(w).solve(B_.transpose());
+    B_grad.array()
+        += w.F.transpose().array().colwise() * (-2 * omega_.array()).exp();
+    omega_grad.array()
+        += 1
+           - (-2 * omega_.array()).exp()
+                 * B_.cwiseProduct(w.F.transpose()).rowwise().sum().array();
+
+    stan::math::check_not_nan(function, "Gradient of mu", mu_grad);
+    stan::math::check_not_nan(function, "Gradient of omega", omega_grad);
+    stan::math::check_not_nan(function, "Gradient of B", B_grad);
+  }
+
+ private:
+  /**
+   * Raise a domain exception if the specified approximation does not
+   * have the dimensionality and rank of this one.
+   */
+  void check_same_shape(const char* function,
+                        const normal_lowrank& rhs) const {
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of rhs", rhs.dimension());
+    stan::math::check_size_match(function, "Rank of lhs", rank(),
+                                 "Rank of rhs", rhs.rank());
+  }
+};
+
+/**
+ * Return a new approximation resulting from adding the parameters of
+ * the specified approximations.
+ *
+ * @param[in] lhs First approximation.
+ * @param[in] rhs Second approximation.
+ * @return Sum of the specified approximations.
+ * @throw std::domain_error If the dimensionalities or ranks do not
+ * match.
+ */
+inline normal_lowrank operator+(normal_lowrank lhs, const normal_lowrank& rhs) {
+  return lhs += rhs;
+}
+
+/**
+ * Return a new approximation resulting from elementwise division of
+ * the first specified approximation by the second.
+ *
+ * @param[in] lhs First approximation.
+ * @param[in] rhs Second approximation.
+ * @return Elementwise division of the specified approximations.
+ * @throw std::domain_error If the dimensionalities or ranks do not
+ * match.
+ */
+inline normal_lowrank operator/(normal_lowrank lhs, const normal_lowrank& rhs) {
+  return lhs /= rhs;
+}
+
+/**
+ * Return a new approximation resulting from elementwise addition
+ * of the specified scalar to the parameters of the specified
+ * approximation.
+ *
+ * @param[in] scalar Scalar value
+ * @param[in] rhs Approximation.
+ * @return Addition of scalar to specified approximation.
+ */
+inline normal_lowrank operator+(double scalar, normal_lowrank rhs) {
+  return rhs += scalar;
+}
+
+/**
+ * Return a new approximation resulting from elementwise
+ * multiplication of the specified scalar to the parameters of the
+ * specified approximation.
+ *
+ * @param[in] scalar Scalar value
+ * @param[in] rhs Approximation.
+ * @return Multiplication of scalar by the specified approximation.
+ */
+inline normal_lowrank operator*(double scalar, normal_lowrank rhs) {
+  return rhs *= scalar;
+}
+
+}  // namespace variational
+}  // namespace stan
+#endif
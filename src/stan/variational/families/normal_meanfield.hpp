@@ -34,6 +34,12 @@ class normal_meanfield : public base_family {
    */
   const int dimension_;
 
+  /**
+   * Whether <code>calc_grad</code> uses the "sticking the landing"
+   * estimator.
+   */
+  bool sticking_the_landing_ = false;
+
  public:
   /**
    * Construct a variational distribution of the specified
@@ -94,6 +100,26 @@ class normal_meanfield : public base_family {
    */
   const Eigen::VectorXd& omega() const { return omega_; }
 
+  /**
+   * Set whether <code>calc_grad</code> estimates the gradient of the ELBO
+   * with the "sticking the landing" estimator of Roeder, Wu and Duvenaud
+   * (2017) rather than the analytic gradient of the entropy.  It drops
+   * the score function term, whose expectation is zero, from the
+   * gradient of <code>log p - log q</code> at each draw, so its variance
+   * vanishes as the approximation approaches the posterior.
+   *
+   * @param[in] sticking_the_landing Whether to use the estimator.
+   */
+  void set_sticking_the_landing(bool sticking_the_landing) {
+    sticking_the_landing_ = sticking_the_landing;
+  }
+
+  /**
+   * Return whether <code>calc_grad</code> uses the "sticking the
+   * landing" estimator.
+   */
+  bool sticking_the_landing() const { return sticking_the_landing_; }
+
   /**
    * Set the mean vector to the specified value.
    *
@@ -137,8 +163,8 @@ class normal_meanfield : public base_family {
    * approximation to zero.
    */
   void set_to_zero() {
-    mu_ = Eigen::VectorXd::Zero(dimension());
-    omega_ = Eigen::VectorXd::Zero(dimension());
+    mu_.setZero();
+    omega_.setZero();
   }
 
   /**
@@ -167,6 +193,15 @@ class normal_meanfield : public base_family {
                             Eigen::VectorXd(omega_.array().sqrt()));
   }
 
+  /**
+   * Return the sum of the squares of the entries of the mean and log
+   * standard deviation vectors, the squared Euclidean norm of this
+   * approximation as a vector of its parameters.
+   */
+  double squared_norm() const {
+    return mu_.squaredNorm() + omega_.squaredNorm();
+  }
+
   /**
    * Return this approximation after setting its mean vector and
    * Cholesky factor for covariance to the values given by the
@@ -266,6 +301,62 @@ class normal_meanfield : public base_family {
     return *this;
   }
 
+  /**
+   * Set this approximation to the elementwise weighted sum of itself
+   * and the square of the specified approximation,
+   * decay * this + weight * rhs.square(), without making new
+   * approximations.
+   *
+   * @param[in] rhs Approximation to square.
+   * @param[in] decay Weight of this approximation.
+   * @param[in] weight Weight of the square of the specified
+   * approximation.
+   * @return This approximation after the update.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximation does not match this approximation's dimensionality.
+   */
+  normal_meanfield& add_square(const normal_meanfield& rhs, double decay,
+                               double weight) {
+    static const char* function
+        = "stan::variational::normal_meanfield::add_square";
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of rhs", rhs.dimension());
+    mu_.array() = decay * mu_.array() + weight * rhs.mu_.array().square();
+    omega_.array()
+        = decay * omega_.array() + weight * rhs.omega_.array().square();
+    return *this;
+  }
+
+  /**
+   * Add the adaptive step of stochastic gradient ascent to this
+   * approximation, scale * grad / (tau + history.sqrt()), without
+   * making new approximations.
+   *
+   * @param[in] scale Step size.
+   * @param[in] grad Gradient of the ELBO.
+   * @param[in] history Weighted sum of squared gradients.
+   * @param[in] tau Offset of the square root of the history.
+   * @return This approximation after the step.
+   * @throw std::domain_error If the dimensionality of the specified
+   * approximations does not match this approximation's dimensionality.
+   */
+  normal_meanfield& add_adagrad_step(double scale,
+                                     const normal_meanfield& grad,
+                                     const normal_meanfield& history,
+                                     double tau) {
+    static const char* function
+        = "stan::variational::normal_meanfield::add_adagrad_step";
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of gradient", grad.dimension());
+    stan::math::check_size_match(function, "Dimension of lhs", dimension(),
+                                 "Dimension of history", history.dimension());
+    mu_.array()
+        += scale * grad.mu_.array() / (history.mu_.array().sqrt() + tau);
+    omega_.array()
+        += scale * grad.omega_.array() / (history.omega_.array().sqrt() + tau);
+    return *this;
+  }
+
   /**
    * Returns the mean vector for this approximation.
    *
@@ -304,6 +395,21 @@ class normal_meanfield : public base_family {
    * @return Transformed vector.
    */
   Eigen::VectorXd transform(const Eigen::VectorXd& eta) const {
+    Eigen::VectorXd zeta(dimension());
+    transform_into(eta, zeta);
+    return zeta;
+  }
+
+  /**
+   * Write the transform of the specified vector to the specified
+   * result, as <code>transform</code> returns it.
+   *
+   * @param[in] eta Vector to transform.
+   * @param[out] zeta Transformed vector.
+   * @throw std::domain_error If the specified vector's size does
+   * not match the dimensionality of this approximation.
+   */
+  void transform_into(const Eigen::VectorXd& eta, Eigen::VectorXd& zeta) const {
     static const char* function
         = "stan::variational::normal_meanfield::transform";
     stan::math::check_size_match(function, "Dimension of mean vector",
@@ -311,7 +417,7 @@ class normal_meanfield : public base_family {
                                  eta.size());
     stan::math::check_not_nan(function, "Input vector", eta);
     // exp(omega) * eta + mu
-    return eta.array().cwiseProduct(omega_.array().exp()) + mu_.array();
+    zeta = eta.array().cwiseProduct(omega_.array().exp()) + mu_.array();
   }
 
   /**
@@ -329,13 +435,16 @@ class normal_meanfield : public base_family {
    * computation.
    * @param[in,out] rng Random number generator.
    * @param[in,out] logger logger for messages
+   * @param[in] parallel Whether to evaluate the gradients of the Monte
+   * Carlo draws in parallel, which gives the same result
    * @throw std::domain_error If the number of divergent
    * iterations exceeds its specified bounds.
    */
   template <class M, class BaseRNG>
   void calc_grad(normal_meanfield& elbo_grad, M& m,
                  Eigen::VectorXd& cont_params, int n_monte_carlo_grad,
-                 BaseRNG& rng, callbacks::logger& logger) const {
+                 BaseRNG& rng, callbacks::logger& logger,
+                 bool parallel = false) const {
     static const char* function
         = "stan::variational::normal_meanfield::calc_grad";
 
@@ -346,51 +455,37 @@ class normal_meanfield : public base_family {
                                  dimension(), "Dimension of variables in model",
                                  cont_params.size());
 
-    Eigen::VectorXd mu_grad = Eigen::VectorXd::Zero(dimension());
-    Eigen::VectorXd omega_grad = Eigen::VectorXd::Zero(dimension());
-    double tmp_lp = 0.0;
-    Eigen::VectorXd tmp_mu_grad = Eigen::VectorXd::Zero(dimension());
-    Eigen::VectorXd eta = Eigen::VectorXd::Zero(dimension());
-    Eigen::VectorXd zeta = Eigen::VectorXd::Zero(dimension());
+    // Accumulate in place, so that repeated calls do not allocate
+    Eigen::VectorXd& mu_grad = elbo_grad.mu_;
+    Eigen::VectorXd& omega_grad = elbo_grad.omega_;
+    mu_grad.setZero();
+    omega_grad.setZero();
+
+    // Sticking the landing adds the gradient of -log q at the draw,
+    // eta / sigma, to that of the model
+    const Eigen::ArrayXd inv_sigma = (-omega_.array()).exp();
 
     // Naive Monte Carlo integration
-    static const int n_retries = 10;
-    for (int i = 0, n_monte_carlo_drop = 0; i < n_monte_carlo_grad;) {
-      // Draw from standard normal and transform to real-coordinate space
-      for (int d = 0; d < dimension(); ++d)
-        eta(d) = stan::math::normal_rng(0, 1, rng);
-      zeta = transform(eta);
-      try {
-        std::stringstream ss;
-        stan::model::gradient(m, zeta, tmp_lp, tmp_mu_grad, &ss);
-        if (ss.str().length() > 0)
-          logger.info(ss);
-        stan::math::check_finite(function, "Gradient of mu", tmp_mu_grad);
-        mu_grad += tmp_mu_grad;
-        omega_grad.array() += tmp_mu_grad.array().cwiseProduct(eta.array());
-        ++i;
-      } catch (const std::exception& e) {
-        ++n_monte_carlo_drop;
-        if (n_monte_carlo_drop >= n_retries * n_monte_carlo_grad) {
-          const char* name = "The number of dropped evaluations";
-          const char* msg1 = "has reached its maximum amount (";
-          int y = n_retries * n_monte_carlo_grad;
-          const char* msg2
-              = "). Your model may be either severely "
-                "ill-conditioned or misspecified.";
-          stan::math::throw_domain_error(function, name, y, msg1, msg2);
-        }
-      }
-    }
+    calc_grad_draws(
+        m, n_monte_carlo_grad, rng, logger, parallel, function,
+        [&](const Eigen::VectorXd& eta, const Eigen::VectorXd& tmp_mu_grad) {
+          mu_grad += tmp_mu_grad;
+          omega_grad.array() += tmp_mu_grad.array().cwiseProduct(eta.array());
+          if (sticking_the_landing_) {
+            mu_grad.array() += eta.array() * inv_sigma;
+            omega_grad.array() += eta.array().square() * inv_sigma;
+          }
+        });
     mu_grad /= static_cast<double>(n_monte_carlo_grad);
     omega_grad /= static_cast<double>(n_monte_carlo_grad);
 
     omega_grad.array() = omega_grad.array().cwiseProduct(omega_.array().exp());
 
-    omega_grad.array() += 1.0;  // add entropy gradient (unit)
+    if (!sticking_the_landing_)
+      omega_grad.array() += 1.0;  // add entropy gradient (unit)
 
-    elbo_grad.set_mu(mu_grad);
-    elbo_grad.set_omega(omega_grad);
+    stan::math::check_not_nan(function, "Gradient of mu", mu_grad);
+    stan::math::check_not_nan(function, "Gradient of omega", omega_grad);
   }
 };
 
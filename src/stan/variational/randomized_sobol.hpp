@@ -0,0 +1,100 @@
+#ifndef STAN_VARIATIONAL_RANDOMIZED_SOBOL_HPP
+#define STAN_VARIATIONAL_RANDOMIZED_SOBOL_HPP
+
+#include <stan/math/prim.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/sobol.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace stan {
+namespace variational {
+
+/**
+ * Standard normal draws for randomized quasi-Monte Carlo estimates:
+ * the points of a Sobol sequence, randomized by a random digital shift
+ * and mapped to standard normals by the inverse normal cumulative
+ * distribution function.
+ *
+ * Each point is a standard normal draw, so averages over the points
+ * are unbiased, but the points of a sequence cover the space more
+ * evenly than independent draws, which reduces the variance of smooth
+ * averages.  The Sobol tables only cover the first
+ * <code>max_dimension()</code> dimensions, and the remaining ones get
+ * independent standard normal draws.
+ */
+class randomized_sobol {
+ public:
+  /**
+   * Construct the sequence of the specified dimension, with a digital
+   * shift drawn from the specified generator.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in] dimension Dimension of the points.
+   * @param[in,out] rng Base random number generator.
+   */
+  template <class BaseRNG>
+  randomized_sobol(int dimension, BaseRNG& rng)
+      : dimension_(dimension),
+        shifts_(std::min(dimension, max_dimension())) {
+    boost::random::uniform_int_distribution<std::uint32_t> bits;
+    for (std::uint32_t& shift : shifts_)
+      shift = bits(rng);
+    if (!shifts_.empty())
+      sobol_ = std::make_unique<sobol_t>(shifts_.size());
+  }
+
+  /**
+   * Return the number of dimensions the Sobol tables cover.
+   */
+  static int max_dimension() {
+    return static_cast<int>(boost::random::default_sobol_table::max_dimension);
+  }
+
+  /**
+   * Return the dimension of the points.
+   */
+  int dimension() const { return dimension_; }
+
+  /**
+   * Fill the specified vector with the next point of the sequence.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in,out] rng Base random number generator for the dimensions
+   * the Sobol tables do not cover.
+   * @param[out] eta Vector to fill, of the dimension of the points.
+   * @throw std::invalid_argument If the size of the vector is not the
+   * dimension of the points.
+   */
+  template <class BaseRNG>
+  void fill(BaseRNG& rng, Eigen::VectorXd& eta) {
+    static const char* function = "stan::variational::randomized_sobol::fill";
+    stan::math::check_size_match(function, "Dimension of input vector",
+                                 eta.size(), "Dimension of sequence",
+                                 dimension_);
+    // the midpoint of each of the 2^32 intervals keeps u in (0, 1)
+    static const double scale = 1.0 / 4294967296.0;
+    const int n_sobol = shifts_.size();
+    for (int d = 0; d < n_sobol; ++d) {
+      const std::uint32_t x = static_cast<std::uint32_t>((*sobol_)());
+      eta(d) = stan::math::inv_Phi(((x ^ shifts_[d]) + 0.5) * scale);
+    }
+    boost::random::normal_distribution<double> std_normal;
+    for (int d = n_sobol; d < dimension_; ++d)
+      eta(d) = std_normal(rng);
+  }
+
+ private:
+  using sobol_t = boost::random::sobol_engine<std::uint32_t, 32>;
+
+  int dimension_;
+  std::vector<std::uint32_t> shifts_;
+  std::unique_ptr<sobol_t> sobol_;
+};
+
+}  // namespace variational
+}  // namespace stan
+#endif
@@ -0,0 +1,138 @@
+#ifndef STAN_VARIATIONAL_ROLLING_WINDOW_HPP
+#define STAN_VARIATIONAL_ROLLING_WINDOW_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <vector>
+
+namespace stan {
+
+namespace variational {
+
+/**
+ * Mean and median of the most recent values pushed into a window of
+ * fixed capacity.
+ *
+ * Both statistics are maintained as values enter and leave the window, so
+ * a push costs logarithmic time in the capacity and reading the mean or
+ * the median costs constant time.  The median is the element at index
+ * `size() / 2` of the sorted window, the upper median when the size is
+ * even.  NaN values are ordered after every other value.
+ */
+class rolling_window {
+ public:
+  /**
+   * Construct an empty window.
+   *
+   * @param[in] capacity maximum number of values kept, must be positive
+   */
+  explicit rolling_window(std::size_t capacity)
+      : values_(capacity), head_(0), size_(0), sum_(0.0) {}
+
+  /**
+   * Add a value to the window, dropping the oldest value if the window is
+   * full.
+   *
+   * @param[in] x value to add
+   */
+  void push_back(double x) {
+    if (size_ == values_.size()) {
+      const double oldest = values_[head_];
+      erase(oldest);
+      values_[head_] = x;
+      head_ = (head_ + 1) % values_.size();
+      sum_ -= oldest;
+      // subtracting a value that dominates the sum would leave only
+      // rounding error, so add up the window again instead
+      if (!std::isfinite(sum_) || !std::isfinite(oldest)
+          || std::fabs(oldest) > std::fabs(sum_)) {
+        resum();
+      } else {
+        sum_ += x;
+      }
+    } else {
+      values_[(head_ + size_) % values_.size()] = x;
+      ++size_;
+      sum_ += x;
+    }
+    insert(x);
+  }
+
+  /**
+   * Return the number of values in the window.
+   */
+  std::size_t size() const { return size_; }
+
+  /**
+   * Return the maximum number of values in the window.
+   */
+  std::size_t capacity() const { return values_.size(); }
+
+  /**
+   * Return the mean of the values in the window, which must not be empty.
+   */
+  double mean() const { return sum_ / static_cast<double>(size_); }
+
+  /**
+   * Return the median of the values in the window, which must not be
+   * empty.
+   */
+  double median() const { return *upper_.begin(); }
+
+ private:
+  struct nan_last {
+    bool operator()(double a, double b) const {
+      return a < b || (!std::isnan(a) && std::isnan(b));
+    }
+  };
+  typedef std::multiset<double, nan_last> sorted_t;
+
+  std::vector<double> values_;
+  std::size_t head_;
+  std::size_t size_;
+  double sum_;
+  // the smallest size() / 2 values and the rest, whose least is the median
+  sorted_t lower_;
+  sorted_t upper_;
+
+  void resum() {
+    sum_ = 0.0;
+    for (std::size_t i = 0; i < size_; ++i)
+      sum_ += values_[(head_ + i) % values_.size()];
+  }
+
+  void insert(double x) {
+    if (upper_.empty() || !nan_last()(x, *upper_.begin()))
+      upper_.insert(x);
+    else
+      lower_.insert(x);
+    rebalance();
+  }
+
+  void erase(double x) {
+    if (!nan_last()(x, *upper_.begin()))
+      upper_.erase(upper_.find(x));
+    else
+      lower_.erase(lower_.find(x));
+    rebalance();
+  }
+
+  void rebalance() {
+    if (upper_.size() > lower_.size() + 1) {
+      lower_.insert(*upper_.begin());
+      upper_.erase(upper_.begin());
+    } else if (lower_.size() > upper_.size()) {
+      auto last = std::prev(lower_.end());
+      upper_.insert(*last);
+      lower_.erase(last);
+    }
+  }
+};
+
+}  // namespace variational
+
+}  // namespace stan
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef TEST_BENCHMARK_ANALYTIC_MODELS_HPP
+#define TEST_BENCHMARK_ANALYTIC_MODELS_HPP
+
+#include <stan/math/rev.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <cmath>
+#include <ostream>
+#include <vector>
+
+namespace stan {
+namespace benchmark {
+
+/**
+ * Base of models with analytic log densities of any dimension, written
+ * directly against the model concept so that the benchmarks of the
+ * samplers do not depend on generated code.  The derived class defines
+ * the log density of an Eigen vector, without its constants.
+ *
+ * @tparam Derived type of model
+ */
+template <class Derived>
+class analytic_model : public stan::model::prob_grad {
+ public:
+  explicit analytic_model(size_t n) : stan::model::prob_grad(n) {}
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(std::vector<T>& params_r, std::vector<int>& params_i,
+             std::ostream* msgs = 0) const {
+    const Eigen::Matrix<T, Eigen::Dynamic, 1> x
+        = Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1>>(params_r.data(),
+                                                          params_r.size());
+    return static_cast<const Derived&>(*this)
+        .template log_prob<propto, jacobian>(x, msgs);
+  }
+};
+
+// Independent standard normals.
+class iid_normal_model : public analytic_model<iid_normal_model> {
+ public:
+  explicit iid_normal_model(size_t n) : analytic_model<iid_normal_model>(n) {}
+
+  using analytic_model<iid_normal_model>::log_prob;
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(const Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* msgs = 0) const {
+    return -0.5 * stan::math::dot_self(params_r);
+  }
+};
+
+// Neal's funnel, in which the log scale v ~ normal(0, 3) of the other
+// coordinates x ~ normal(0, exp(v / 2)) is the first coordinate.
+class funnel_model : public analytic_model<funnel_model> {
+ public:
+  explicit funnel_model(size_t n) : analytic_model<funnel_model>(n) {}
+
+  using analytic_model<funnel_model>::log_prob;
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(const Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* msgs = 0) const {
+    const Eigen::Index n = params_r.size();
+    const T& v = params_r(0);
+    return -v * v / 18 - 0.5 * (n - 1) * v
+           - 0.5 * stan::math::exp(-v)
+                 * stan::math::dot_self(params_r.tail(n - 1));
+  }
+};
+
+// Stationary autoregressive process of order one with unit variance and
+// correlation 0.9 between neighbouring coordinates, whose precision is
+// tridiagonal so its log density costs linear time.
+class correlated_normal_model : public analytic_model<correlated_normal_model> {
+ public:
+  explicit correlated_normal_model(size_t n)
+      : analytic_model<correlated_normal_model>(n) {}
+
+  using analytic_model<correlated_normal_model>::log_prob;
+
+  static constexpr double rho = 0.9;
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(const Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* msgs = 0) const {
+    const Eigen::Index n = params_r.size();
+    const Eigen::Matrix<T, Eigen::Dynamic, 1> innovations
+        = params_r.tail(n - 1) - rho * params_r.head(n - 1);
+    return -0.5 * params_r(0) * params_r(0)
+           - 0.5 / (1 - rho * rho) * stan::math::dot_self(innovations);
+  }
+};
+
+}  // namespace benchmark
+}  // namespace stan
+#endif
@@ -0,0 +1,64 @@
+#include <stan/analyze/mcmc/compute_diagnostics.hpp>
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+
+// chains of an AR(1) process with correlation 0.5, one row per draw and
+// one column per parameter
+std::vector<Eigen::MatrixXd> ar1_chains(int num_chains, int num_draws,
+                                        int num_params) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  boost::random::normal_distribution<> std_normal;
+  std::vector<Eigen::MatrixXd> chains(num_chains,
+                                      Eigen::MatrixXd(num_draws, num_params));
+  for (Eigen::MatrixXd& chain : chains)
+    for (int j = 0; j < num_params; ++j) {
+      chain(0, j) = std_normal(rng);
+      for (int i = 1; i < num_draws; ++i)
+        chain(i, j) = 0.5 * chain(i - 1, j) + std_normal(rng);
+    }
+  return chains;
+}
+
+// one parameter of four chains of the specified number of draws
+void effective_sample_size(benchmark::State& state) {
+  const std::vector<Eigen::MatrixXd> chains
+      = ar1_chains(4, state.range(0), 1);
+  std::vector<const double*> draws;
+  for (const Eigen::MatrixXd& chain : chains)
+    draws.push_back(chain.data());
+  std::vector<size_t> sizes(chains.size(), state.range(0));
+  stan::analyze::autocovariance_engine engine;
+  for (auto _ : state)
+    benchmark::DoNotOptimize(
+        stan::analyze::compute_effective_sample_size(draws, sizes, engine));
+  state.SetItemsProcessed(state.iterations() * 4 * state.range(0));
+}
+
+// all the diagnostics of the specified number of parameters of four
+// chains of 1000 draws
+void diagnostics(benchmark::State& state) {
+  const std::vector<Eigen::MatrixXd> chains
+      = ar1_chains(4, 1000, state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(stan::analyze::compute_diagnostics(chains));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK(effective_sample_size)
+    ->RangeMultiplier(10)
+    ->Range(100, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(diagnostics)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,57 @@
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+std::vector<double> draw(int n) {
+  std::vector<double> values(n);
+  for (int i = 0; i < n; ++i)
+    values[i] = 1.0 / (i + 3) - 0.123456789 * i;
+  return values;
+}
+
+// a draw of the specified number of values per iteration, as a CSV row
+void stream_writer_draw(benchmark::State& state) {
+  const std::vector<double> values = draw(state.range(0));
+  std::stringstream ss;
+  stan::callbacks::stream_writer writer(ss);
+  for (auto _ : state) {
+    writer(values);
+    if (ss.tellp() > (1 << 24))
+      ss.str(std::string());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+// a record holding a vector of the specified size per iteration
+void json_writer_record(benchmark::State& state) {
+  const std::vector<double> values = draw(state.range(0));
+  std::stringstream ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss)};
+  for (auto _ : state) {
+    writer.begin_record();
+    writer.write("draw", values);
+    writer.end_record();
+    if (ss.tellp() > (1 << 24))
+      ss.str(std::string());
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+}  // namespace
+
+BENCHMARK(stream_writer_draw)->RangeMultiplier(10)->Range(10, 10000);
+BENCHMARK(json_writer_record)->RangeMultiplier(10)->Range(10, 10000);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,80 @@
+#include <stan/io/json/json_data.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <benchmark/benchmark.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+// draws of a fixed parameter run with the specified number of rows and
+// columns, in the format of CmdStan
+std::string stan_csv(int num_rows, int num_cols) {
+  std::stringstream ss;
+  ss.precision(6);
+  ss << "# model = benchmark_model\n"
+     << "# method = sample (Default)\n"
+     << "#   sample\n"
+     << "#     num_samples = " << num_rows << "\n"
+     << "#     algorithm = fixed_param\n";
+  ss << "lp__,accept_stat__";
+  for (int j = 0; j < num_cols; ++j)
+    ss << ",x." << j + 1;
+  ss << "\n";
+  for (int i = 0; i < num_rows; ++i) {
+    ss << "0,0";
+    for (int j = 0; j < num_cols; ++j)
+      ss << "," << 1.0 / (i + j + 3) - 0.123456 * j;
+    ss << "\n";
+  }
+  ss << "# \n#  Elapsed Time: 0 seconds (Warm-up)\n"
+     << "#                0.001 seconds (Sampling)\n"
+     << "#                0.001 seconds (Total)\n#\n";
+  return ss.str();
+}
+
+// data of a vector and a matrix with the specified number of values each
+std::string json(int n) {
+  std::stringstream ss;
+  ss.precision(17);
+  ss << "{\"N\": " << n << ", \"y\": [";
+  for (int i = 0; i < n; ++i)
+    ss << (i ? ", " : "") << 1.0 / (i + 3);
+  ss << "], \"X\": [[";
+  for (int i = 0; i < n; ++i)
+    ss << (i ? ", " : "") << -0.5 * i;
+  ss << "]]}";
+  return ss.str();
+}
+
+void stan_csv_reader_parse(benchmark::State& state) {
+  const std::string csv = stan_csv(state.range(0), 100);
+  for (auto _ : state) {
+    std::stringstream in(csv);
+    stan::io::stan_csv parsed = stan::io::stan_csv_reader::parse(in, nullptr);
+    benchmark::DoNotOptimize(parsed.samples.data());
+  }
+  state.SetBytesProcessed(state.iterations() * csv.size());
+}
+
+void json_data_parse(benchmark::State& state) {
+  const std::string data = json(state.range(0));
+  for (auto _ : state) {
+    std::stringstream in(data);
+    stan::json::json_data parsed(in);
+    benchmark::DoNotOptimize(parsed.contains_r("y"));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+
+}  // namespace
+
+BENCHMARK(stan_csv_reader_parse)
+    ->RangeMultiplier(10)
+    ->Range(10, 10000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(json_data_parse)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,159 @@
+#include <stan/analyze/mcmc/compute_diagnostics.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/static/adapt_diag_e_static_hmc.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/benchmark/analytic_models.hpp>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <vector>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+constexpr int num_chains = 4;
+constexpr int num_warmup = 1000;
+constexpr int num_samples = 1000;
+
+// peak resident set size of the process in megabytes, or NaN where it
+// is not available
+double peak_rss_mb() {
+#ifndef _WIN32
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss / 1024.0;
+#endif
+  return std::numeric_limits<double>::quiet_NaN();
+}
+
+// the step size of NUTS, from which it adapts
+template <class Sampler>
+void set_integration(Sampler& sampler) {
+  sampler.set_nominal_stepsize(1);
+}
+
+// the step size and integration time of static HMC
+template <class Model, class RNG>
+void set_integration(
+    stan::mcmc::adapt_diag_e_static_hmc<Model, RNG>& sampler) {
+  sampler.set_nominal_stepsize_and_T(1, 2 * stan::math::pi());
+}
+
+// the default adaptation settings of the sampler services
+template <class Sampler>
+void configure(Sampler& sampler) {
+  set_integration(sampler);
+  sampler.set_stepsize_jitter(0);
+  sampler.get_stepsize_adaptation().set_mu(std::log(10.0));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.get_stepsize_adaptation().set_gamma(0.05);
+  sampler.get_stepsize_adaptation().set_kappa(0.75);
+  sampler.get_stepsize_adaptation().set_t0(10);
+  stan::callbacks::logger logger;
+  sampler.set_window_params(num_warmup, 75, 50, 25, logger);
+}
+
+/**
+ * Measure the effective sample size per second of an adaptive sampler:
+ * four chains from the same point make the warmup and sampling
+ * iterations of the sampler services by default, and the bulk and tail
+ * effective sample sizes of the worst parameter are divided by the wall
+ * time of the whole run, warmup included.  It reports them with the
+ * gradients per bulk effective draw and the peak resident set size of
+ * the process, which only grows over the benchmarks.
+ *
+ * Each iteration is a complete run, so the benchmarks make one.  Runs
+ * are compared against a baseline with the <code>compare.py</code> tool
+ * of Google Benchmark, from the JSON reports of
+ * <code>--benchmark_out=report.json --benchmark_out_format=json</code>.
+ */
+template <class Model, template <class, class> class Sampler>
+void ess_per_second(benchmark::State& state) {
+  const int n = state.range(0);
+  Model model(n);
+  stan::callbacks::logger logger;
+  double ess_bulk = 0;
+  double ess_tail = 0;
+  double num_gradients = 0;
+  double seconds = 0;
+  for (auto _ : state) {
+    std::vector<Eigen::MatrixXd> draws(num_chains,
+                                       Eigen::MatrixXd(num_samples, n));
+    num_gradients = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int chain = 0; chain < num_chains; ++chain) {
+      stan::rng_t rng = stan::services::util::create_rng(0, chain + 1);
+      Sampler<Model, stan::rng_t> sampler(model, rng);
+      configure(sampler);
+      stan::mcmc::sample s(Eigen::VectorXd::Constant(n, 0.1), 0, 0);
+      sampler.engage_adaptation();
+      sampler.z().q = s.cont_params();
+      sampler.init_stepsize(logger);
+      for (int m = 0; m < num_warmup; ++m)
+        s = sampler.transition(s, logger);
+      sampler.disengage_adaptation();
+      for (int m = 0; m < num_samples; ++m) {
+        s = sampler.transition(s, logger);
+        draws[chain].row(m) = s.cont_params().transpose();
+      }
+      num_gradients += sampler.get_gradient_stats().num_gradients;
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                            - start)
+                  .count();
+    ess_bulk = std::numeric_limits<double>::infinity();
+    ess_tail = std::numeric_limits<double>::infinity();
+    for (const stan::analyze::parameter_diagnostics& d :
+         stan::analyze::compute_diagnostics(draws)) {
+      ess_bulk = std::min(ess_bulk, d.ess_bulk);
+      ess_tail = std::min(ess_tail, d.ess_tail);
+    }
+  }
+  state.counters["ess_bulk_per_s"] = ess_bulk / seconds;
+  state.counters["ess_tail_per_s"] = ess_tail / seconds;
+  state.counters["gradients_per_ess"] = num_gradients / ess_bulk;
+  state.counters["peak_rss_mb"] = peak_rss_mb();
+}
+
+using stan::benchmark::correlated_normal_model;
+using stan::benchmark::funnel_model;
+using stan::benchmark::iid_normal_model;
+using stan::mcmc::adapt_dense_e_nuts;
+using stan::mcmc::adapt_diag_e_nuts;
+using stan::mcmc::adapt_diag_e_static_hmc;
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(ess_per_second, iid_normal_model, adapt_diag_e_nuts)
+    ->Arg(100)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+BENCHMARK_TEMPLATE(ess_per_second, iid_normal_model, adapt_dense_e_nuts)
+    ->Arg(100)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+BENCHMARK_TEMPLATE(ess_per_second, iid_normal_model, adapt_diag_e_static_hmc)
+    ->Arg(100)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+BENCHMARK_TEMPLATE(ess_per_second, correlated_normal_model, adapt_diag_e_nuts)
+    ->Arg(100)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+BENCHMARK_TEMPLATE(ess_per_second, correlated_normal_model,
+                   adapt_dense_e_nuts)
+    ->Arg(100)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+BENCHMARK_TEMPLATE(ess_per_second, funnel_model, adapt_diag_e_nuts)
+    ->Arg(10)
+    ->Iterations(1)
+    ->Unit(benchmark::kSecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,130 @@
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/hamiltonians/dense_e_metric.hpp>
+#include <stan/mcmc/hmc/hamiltonians/softabs_metric.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/benchmark/analytic_models.hpp>
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+using stan::benchmark::correlated_normal_model;
+using stan::benchmark::funnel_model;
+
+// AR(1) covariance, a dense inverse metric with a spread of eigenvalues
+Eigen::MatrixXd correlated_inv_metric(int n) {
+  Eigen::MatrixXd inv_metric(n, n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      inv_metric(i, j)
+          = std::pow(correlated_normal_model::rho, std::abs(i - j));
+  return inv_metric;
+}
+
+struct dense_e_fixture {
+  explicit dense_e_fixture(int n)
+      : model(n),
+        metric(model),
+        z(n),
+        rng(stan::services::util::create_rng(0, 1)) {
+    z.set_metric(correlated_inv_metric(n));
+    z.q.setConstant(0.1);
+    metric.sample_p(z, rng);
+  }
+
+  correlated_normal_model model;
+  stan::mcmc::dense_e_metric<correlated_normal_model, stan::rng_t> metric;
+  stan::mcmc::dense_e_point z;
+  stan::rng_t rng;
+};
+
+void dense_e_T(benchmark::State& state) {
+  dense_e_fixture f(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.metric.T(f.z));
+}
+
+void dense_e_dtau_dp(benchmark::State& state) {
+  dense_e_fixture f(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.metric.dtau_dp(f.z));
+}
+
+void dense_e_sample_p(benchmark::State& state) {
+  dense_e_fixture f(state.range(0));
+  for (auto _ : state) {
+    f.metric.sample_p(f.z, f.rng);
+    benchmark::DoNotOptimize(f.z.p.data());
+  }
+}
+
+void dense_e_set_metric(benchmark::State& state) {
+  dense_e_fixture f(state.range(0));
+  const Eigen::MatrixXd inv_metric = correlated_inv_metric(state.range(0));
+  for (auto _ : state) {
+    f.z.set_metric(inv_metric);
+    benchmark::DoNotOptimize(f.z.inv_e_metric_.data());
+  }
+}
+
+struct softabs_fixture {
+  explicit softabs_fixture(int n)
+      : model(n),
+        metric(model),
+        z(n),
+        rng(stan::services::util::create_rng(0, 1)) {
+    z.q.setConstant(0.1);
+    metric.init(z, logger);
+    metric.sample_p(z, rng);
+  }
+
+  funnel_model model;
+  stan::mcmc::softabs_metric<funnel_model, stan::rng_t> metric;
+  stan::mcmc::softabs_point z;
+  stan::rng_t rng;
+  stan::callbacks::logger logger;
+};
+
+// the Hessian and its eigendecomposition, once per leapfrog step
+void softabs_update_metric(benchmark::State& state) {
+  softabs_fixture f(state.range(0));
+  for (auto _ : state) {
+    f.metric.update_metric(f.z, f.logger);
+    benchmark::DoNotOptimize(f.z.log_det_metric);
+  }
+}
+
+// the gradient of the Hessian, once per leapfrog step
+void softabs_update_metric_gradient(benchmark::State& state) {
+  softabs_fixture f(state.range(0));
+  for (auto _ : state) {
+    f.metric.update_metric_gradient(f.z, f.logger);
+    benchmark::DoNotOptimize(f.z.pseudo_j.data());
+  }
+}
+
+void softabs_tau(benchmark::State& state) {
+  softabs_fixture f(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.metric.tau(f.z));
+}
+
+void softabs_dtau_dq(benchmark::State& state) {
+  softabs_fixture f(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(f.metric.dtau_dq(f.z, f.logger));
+}
+
+}  // namespace
+
+BENCHMARK(dense_e_T)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(dense_e_dtau_dp)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(dense_e_sample_p)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(dense_e_set_metric)->RangeMultiplier(10)->Range(10, 1000);
+BENCHMARK(softabs_update_metric)->RangeMultiplier(10)->Range(10, 100);
+BENCHMARK(softabs_update_metric_gradient)->RangeMultiplier(10)->Range(10, 100);
+BENCHMARK(softabs_tau)->RangeMultiplier(10)->Range(10, 100);
+BENCHMARK(softabs_dtau_dq)->RangeMultiplier(10)->Range(10, 100);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,75 @@
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/benchmark/analytic_models.hpp>
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+namespace {
+
+/**
+ * Time NUTS transitions with a unit diagonal metric from a point of
+ * high density, with a step size that scales with the dimension as the
+ * optimal step size of a Gaussian does.  Besides the time per
+ * transition, it reports the gradients per second and the leapfrog
+ * steps per transition.
+ */
+template <class Model>
+void diag_e_nuts_transition(benchmark::State& state, double stepsize) {
+  const int n = state.range(0);
+  Model model(n);
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  stan::mcmc::diag_e_nuts<Model, stan::rng_t> sampler(model, rng);
+  sampler.set_nominal_stepsize(stepsize * std::pow(n, -0.25));
+  sampler.set_max_depth(10);
+  stan::callbacks::logger logger;
+
+  Eigen::VectorXd q = Eigen::VectorXd::Constant(n, 0.1);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 10; ++m)
+    s = sampler.transition(s, logger);
+
+  const size_t gradients_start = sampler.get_gradient_stats().num_gradients;
+  double n_leapfrog = 0;
+  for (auto _ : state) {
+    s = sampler.transition(s, logger);
+    std::vector<double> values;
+    sampler.get_sampler_params(values);
+    n_leapfrog += values[2];
+  }
+  state.counters["gradients"] = benchmark::Counter(
+      sampler.get_gradient_stats().num_gradients - gradients_start,
+      benchmark::Counter::kIsRate);
+  state.counters["n_leapfrog"] = benchmark::Counter(
+      n_leapfrog, benchmark::Counter::kAvgIterations);
+}
+
+void iid_normal(benchmark::State& state) {
+  diag_e_nuts_transition<stan::benchmark::iid_normal_model>(state, 1.0);
+}
+
+void funnel(benchmark::State& state) {
+  diag_e_nuts_transition<stan::benchmark::funnel_model>(state, 0.2);
+}
+
+void correlated_normal(benchmark::State& state) {
+  diag_e_nuts_transition<stan::benchmark::correlated_normal_model>(state,
+                                                                   0.4);
+}
+
+}  // namespace
+
+BENCHMARK(iid_normal)
+    ->RangeMultiplier(10)
+    ->Range(10, 100000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(funnel)
+    ->RangeMultiplier(10)
+    ->Range(10, 1000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(correlated_normal)
+    ->RangeMultiplier(10)
+    ->Range(10, 100000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
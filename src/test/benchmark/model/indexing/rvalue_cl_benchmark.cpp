@@ -0,0 +1,111 @@
+// Multi-indexing of a vector with the indexes on the host and resident on
+// the OpenCL device.  The data is resident on the device for the OpenCL
+// benchmarks, so the smallest size at which a cl_* benchmark is faster than
+// its cpu_* counterpart is the size at which offloading the indexing starts
+// to help.  Without STAN_OPENCL only the cpu_* benchmarks are built.
+#include <stan/math.hpp>
+#include <stan/model/indexing.hpp>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+namespace {
+
+using stan::model::index_multi;
+using stan::model::index_multi_checked;
+
+// group ids of n observations of n / 8 groups, in a scrambled order
+std::vector<int> group_ids(int n) {
+  const int num_groups = n / 8 > 0 ? n / 8 : 1;
+  std::vector<int> ns(n);
+  for (int i = 0; i < n; ++i)
+    ns[i] = (i * 7919) % num_groups + 1;
+  return ns;
+}
+
+void cpu_gather(benchmark::State& state) {
+  const int n = state.range(0);
+  const std::vector<int> ns = group_ids(n);
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(n, 0, 1);
+  for (auto _ : state) {
+    Eigen::VectorXd y = stan::model::rvalue(x, "x", index_multi(ns));
+    benchmark::DoNotOptimize(y.data());
+  }
+}
+
+void cpu_gather_checked(benchmark::State& state) {
+  const int n = state.range(0);
+  const index_multi_checked idx(group_ids(n), n);
+  const Eigen::VectorXd x = Eigen::VectorXd::LinSpaced(n, 0, 1);
+  for (auto _ : state) {
+    Eigen::VectorXd y = stan::model::rvalue(x, "x", idx);
+    benchmark::DoNotOptimize(y.data());
+  }
+}
+
+void cpu_gather_grad(benchmark::State& state) {
+  const int n = state.range(0);
+  const std::vector<int> ns = group_ids(n);
+  const Eigen::VectorXd x_val = Eigen::VectorXd::LinSpaced(n, 0, 1);
+  for (auto _ : state) {
+    stan::math::var_value<Eigen::VectorXd> x(x_val);
+    stan::math::var lp
+        = stan::math::sum(stan::model::rvalue(x, "x", index_multi(ns)));
+    lp.grad();
+    benchmark::DoNotOptimize(x.adj().data());
+    stan::math::recover_memory();
+  }
+}
+
+#ifdef STAN_OPENCL
+using stan::model::index_multi_cl;
+
+void cl_gather_upload(benchmark::State& state) {
+  const int n = state.range(0);
+  const std::vector<int> ns = group_ids(n);
+  const stan::math::matrix_cl<double> x(Eigen::VectorXd::LinSpaced(n, 0, 1));
+  for (auto _ : state) {
+    stan::math::matrix_cl<double> y
+        = stan::model::rvalue(x, "x", stan::math::to_matrix_cl(ns));
+    stan::math::opencl_context.queue().finish();
+  }
+}
+
+void cl_gather_resident(benchmark::State& state) {
+  const int n = state.range(0);
+  const index_multi_cl idx(group_ids(n), n);
+  const stan::math::matrix_cl<double> x(Eigen::VectorXd::LinSpaced(n, 0, 1));
+  for (auto _ : state) {
+    stan::math::matrix_cl<double> y = stan::model::rvalue(x, "x", idx);
+    stan::math::opencl_context.queue().finish();
+  }
+}
+
+void cl_gather_grad_resident(benchmark::State& state) {
+  const int n = state.range(0);
+  const index_multi_cl idx(group_ids(n), n);
+  const stan::math::matrix_cl<double> x_val(
+      Eigen::VectorXd::LinSpaced(n, 0, 1));
+  for (auto _ : state) {
+    stan::math::var_value<stan::math::matrix_cl<double>> x(x_val);
+    stan::math::var lp = stan::math::sum(stan::model::rvalue(x, "x", idx));
+    lp.grad();
+    stan::math::opencl_context.queue().finish();
+    stan::math::recover_memory();
+  }
+}
+#endif
+
+}  // namespace
+
+BENCHMARK(cpu_gather)->RangeMultiplier(4)->Range(1 << 8, 1 << 22);
+BENCHMARK(cpu_gather_checked)->RangeMultiplier(4)->Range(1 << 8, 1 << 22);
+BENCHMARK(cpu_gather_grad)->RangeMultiplier(4)->Range(1 << 8, 1 << 22);
+#ifdef STAN_OPENCL
+BENCHMARK(cl_gather_upload)->RangeMultiplier(4)->Range(1 << 8, 1 << 22);
+BENCHMARK(cl_gather_resident)->RangeMultiplier(4)->Range(1 << 8, 1 << 22);
+BENCHMARK(cl_gather_grad_resident)
+    ->RangeMultiplier(4)
+    ->Range(1 << 8, 1 << 22);
+#endif
+
+BENCHMARK_MAIN();
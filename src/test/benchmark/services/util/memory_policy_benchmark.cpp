@@ -0,0 +1,67 @@
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/memory_policy.hpp>
+#include <test/benchmark/analytic_models.hpp>
+#include <benchmark/benchmark.h>
+#include <cmath>
+
+namespace {
+
+/**
+ * Time NUTS transitions with a unit diagonal metric on an iid normal,
+ * with the autodiff arena reserved and the buffers of the sampler
+ * advised to use huge pages, or not, so that the effect of the memory
+ * policy shows on models large enough to miss the TLB.
+ */
+void diag_e_nuts_transition(benchmark::State& state, bool reserve,
+                            bool huge_pages) {
+  const int n = state.range(0);
+  stan::benchmark::iid_normal_model model(n);
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  stan::mcmc::diag_e_nuts<stan::benchmark::iid_normal_model, stan::rng_t>
+      sampler(model, rng);
+  sampler.set_nominal_stepsize(std::pow(n, -0.25));
+  sampler.set_max_depth(10);
+  stan::callbacks::logger logger;
+
+  stan::services::util::memory_policy policy;
+  // an iid normal puts a handful of varis on the arena per parameter
+  policy.ad_arena_bytes = reserve ? 128 * static_cast<std::size_t>(n) : 0;
+  policy.huge_pages = huge_pages;
+  stan::services::util::apply_memory_policy(policy, sampler);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Constant(n, 0.1);
+  stan::mcmc::sample s(q, 0, 0);
+  for (auto _ : state)
+    s = sampler.transition(s, logger);
+}
+
+void default_policy(benchmark::State& state) {
+  diag_e_nuts_transition(state, false, false);
+}
+
+void reserved_arena(benchmark::State& state) {
+  diag_e_nuts_transition(state, true, false);
+}
+
+void huge_pages(benchmark::State& state) {
+  diag_e_nuts_transition(state, true, true);
+}
+
+}  // namespace
+
+BENCHMARK(default_policy)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(reserved_arena)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK(huge_pages)
+    ->RangeMultiplier(10)
+    ->Range(1000, 1000000)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,79 @@
+#include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/autocovariance.hpp>
+#include <stan/analyze/mcmc/autocovariance_engine.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <vector>
+
+class AutocovarianceEngine : public testing::Test {
+ public:
+  void SetUp() {
+    // ar1.csv generated in R with
+    //   > x[1] <- rnorm(1, 0, 1)
+    //   > for (n in 2:1000) x[n] <- rnorm(1, 0.8 * x[n-1], 1)
+    std::fstream f("src/test/unit/analyze/mcmc/ar1.csv");
+    y.resize(1000);
+    for (Eigen::Index i = 0; i < y.size(); ++i)
+      f >> y(i);
+  }
+
+  Eigen::VectorXd y;
+};
+
+TEST_F(AutocovarianceEngine, single_sequence_matches_autocovariance) {
+  Eigen::VectorXd expected(y.size());
+  stan::analyze::autocovariance<double>(y, expected);
+
+  stan::analyze::autocovariance_engine engine;
+  Eigen::VectorXd ac;
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    engine.autocovariance(y, ac);
+    ASSERT_EQ(y.size(), ac.size());
+    for (Eigen::Index i = 0; i < y.size(); ++i)
+      EXPECT_DOUBLE_EQ(expected(i), ac(i));
+  }
+  EXPECT_NEAR(2.69, ac(0), 0.01);
+  EXPECT_NEAR(2.16, ac(1), 0.01);
+  EXPECT_EQ(1U, engine.num_cached_lengths());
+}
+
+TEST_F(AutocovarianceEngine, several_sequences_match_autocovariance) {
+  // an odd number of sequences so that one of them is not paired
+  const Eigen::Index N = 400;
+  Eigen::MatrixXd ys(N, 5);
+  for (Eigen::Index col = 0; col < ys.cols(); ++col)
+    ys.col(col) = y.segment(100 * col, N) * (col + 1);
+
+  stan::analyze::autocovariance_engine engine;
+  Eigen::MatrixXd acovs;
+  engine.autocovariances(ys, acovs);
+  ASSERT_EQ(N, acovs.rows());
+  ASSERT_EQ(ys.cols(), acovs.cols());
+
+  for (Eigen::Index col = 0; col < ys.cols(); ++col) {
+    Eigen::VectorXd seq = ys.col(col);
+    Eigen::VectorXd expected(N);
+    stan::analyze::autocovariance<double>(seq, expected);
+    for (Eigen::Index i = 0; i < N; ++i)
+      EXPECT_NEAR(expected(i), acovs(i, col), 1e-10 * expected(0))
+          << "sequence " << col << ", lag " << i;
+  }
+}
+
+TEST_F(AutocovarianceEngine, buffers_are_kept_per_padded_length) {
+  stan::analyze::autocovariance_engine engine;
+  Eigen::VectorXd ac;
+  engine.autocovariance(y.head(1000), ac);
+  engine.autocovariance(y.head(999), ac);
+  EXPECT_EQ(1U, engine.num_cached_lengths());
+  engine.autocovariance(y.head(100), ac);
+  EXPECT_EQ(2U, engine.num_cached_lengths());
+  EXPECT_EQ(100, ac.size());
+
+  engine.clear();
+  EXPECT_EQ(0U, engine.num_cached_lengths());
+  Eigen::MatrixXd acovs;
+  engine.autocovariances(Eigen::MatrixXd(0, 3), acovs);
+  EXPECT_EQ(0, acovs.rows());
+  EXPECT_EQ(3, acovs.cols());
+}
@@ -0,0 +1,138 @@
+#include <stan/analyze/mcmc/compute_diagnostics.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+class ComputeDiagnostics : public testing::Test {
+ public:
+  void SetUp() {
+    std::ifstream blocker1_stream(
+        "src/test/unit/mcmc/test_csv_files/blocker.1.csv");
+    std::ifstream blocker2_stream(
+        "src/test/unit/mcmc/test_csv_files/blocker.2.csv");
+    std::stringstream out;
+    draws.push_back(
+        stan::io::stan_csv_reader::parse(blocker1_stream, &out).samples);
+    draws.push_back(
+        stan::io::stan_csv_reader::parse(blocker2_stream, &out).samples);
+    EXPECT_EQ("", out.str());
+  }
+
+  std::vector<const double*> columns(Eigen::Index param) {
+    std::vector<const double*> chain_begins;
+    for (const Eigen::MatrixXd& chain : draws)
+      chain_begins.push_back(chain.col(param).data());
+    return chain_begins;
+  }
+
+  std::vector<Eigen::MatrixXd> draws;
+};
+
+TEST_F(ComputeDiagnostics, matches_per_parameter_functions) {
+  std::vector<stan::analyze::parameter_diagnostics> diagnostics
+      = stan::analyze::compute_diagnostics(draws);
+  ASSERT_EQ(draws[0].cols(), diagnostics.size());
+
+  const size_t size = draws[0].rows();
+  for (Eigen::Index param = 4; param < draws[0].cols(); ++param) {
+    std::vector<const double*> chain_begins = columns(param);
+    std::pair<double, double> rhat
+        = stan::analyze::compute_split_potential_scale_reduction_rank(
+            chain_begins, size);
+    EXPECT_FLOAT_EQ(rhat.first, diagnostics[param].rhat_bulk)
+        << "parameter " << param;
+    EXPECT_FLOAT_EQ(rhat.second, diagnostics[param].rhat_tail)
+        << "parameter " << param;
+    EXPECT_FLOAT_EQ(
+        stan::analyze::compute_split_effective_sample_size(chain_begins, size),
+        diagnostics[param].ess)
+        << "parameter " << param;
+  }
+}
+
+TEST_F(ComputeDiagnostics, bulk_and_tail_ess) {
+  std::vector<stan::analyze::parameter_diagnostics> diagnostics
+      = stan::analyze::compute_diagnostics(draws);
+
+  const size_t size = draws[0].rows();
+  const size_t half = size / 2;
+  for (Eigen::Index param = 4; param < draws[0].cols(); ++param) {
+    Eigen::MatrixXd split(half, 2 * draws.size());
+    for (size_t chain = 0; chain < draws.size(); ++chain) {
+      split.col(2 * chain) = draws[chain].col(param).head(half);
+      split.col(2 * chain + 1) = draws[chain].col(param).tail(half);
+    }
+    Eigen::MatrixXd ranks = stan::analyze::rank_transform(split);
+    std::vector<const double*> chain_begins;
+    for (Eigen::Index chain = 0; chain < ranks.cols(); ++chain)
+      chain_begins.push_back(ranks.col(chain).data());
+    EXPECT_FLOAT_EQ(
+        stan::analyze::compute_effective_sample_size(chain_begins, half),
+        diagnostics[param].ess_bulk)
+        << "parameter " << param;
+
+    double q05 = stan::math::quantile(split.reshaped(), 0.05);
+    double q95 = stan::math::quantile(split.reshaped(), 0.95);
+    Eigen::MatrixXd lower = (split.array() <= q05).cast<double>();
+    Eigen::MatrixXd upper = (split.array() >= q95).cast<double>();
+    std::vector<const double*> lower_begins, upper_begins;
+    for (Eigen::Index chain = 0; chain < split.cols(); ++chain) {
+      lower_begins.push_back(lower.col(chain).data());
+      upper_begins.push_back(upper.col(chain).data());
+    }
+    double ess_tail = std::min(
+        stan::analyze::compute_effective_sample_size(lower_begins, half),
+        stan::analyze::compute_effective_sample_size(upper_begins, half));
+    EXPECT_FLOAT_EQ(ess_tail, diagnostics[param].ess_tail)
+        << "parameter " << param;
+    EXPECT_GT(diagnostics[param].ess_bulk, 0);
+  }
+}
+
+TEST_F(ComputeDiagnostics, unequal_chain_lengths_are_trimmed) {
+  std::vector<Eigen::MatrixXd> trimmed = draws;
+  trimmed[1].conservativeResize(draws[1].rows() - 101, Eigen::NoChange);
+  std::vector<Eigen::MatrixXd> shortened = trimmed;
+  shortened[0].conservativeResize(trimmed[1].rows(), Eigen::NoChange);
+
+  std::vector<stan::analyze::parameter_diagnostics> a
+      = stan::analyze::compute_diagnostics(trimmed);
+  std::vector<stan::analyze::parameter_diagnostics> b
+      = stan::analyze::compute_diagnostics(shortened);
+  auto same = [](double x, double y) {
+    return (std::isnan(x) && std::isnan(y)) || x == y;
+  };
+  for (size_t param = 4; param < a.size(); ++param) {
+    EXPECT_TRUE(same(a[param].ess, b[param].ess));
+    EXPECT_TRUE(same(a[param].ess_bulk, b[param].ess_bulk));
+    EXPECT_TRUE(same(a[param].ess_tail, b[param].ess_tail));
+    EXPECT_TRUE(same(a[param].rhat_bulk, b[param].rhat_bulk));
+    EXPECT_TRUE(same(a[param].rhat_tail, b[param].rhat_tail));
+  }
+}
+
+TEST(ComputeDiagnosticsEdgeCases, constant_and_non_finite) {
+  std::vector<Eigen::MatrixXd> draws(2, Eigen::MatrixXd::Ones(100, 2));
+  draws[1](10, 1) = std::numeric_limits<double>::infinity();
+  std::vector<stan::analyze::parameter_diagnostics> diagnostics
+      = stan::analyze::compute_diagnostics(draws);
+  ASSERT_EQ(2, diagnostics.size());
+  for (const auto& d : diagnostics) {
+    EXPECT_TRUE(std::isnan(d.ess));
+    EXPECT_TRUE(std::isnan(d.ess_bulk));
+    EXPECT_TRUE(std::isnan(d.ess_tail));
+    EXPECT_TRUE(std::isnan(d.rhat_bulk));
+    EXPECT_TRUE(std::isnan(d.rhat_tail));
+  }
+
+  EXPECT_TRUE(stan::analyze::compute_diagnostics({}).empty());
+  draws[1].resize(100, 3);
+  EXPECT_THROW(stan::analyze::compute_diagnostics(draws),
+               std::invalid_argument);
+}
@@ -0,0 +1,62 @@
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/analyze/mcmc/compute_many_chain_effective_sample_size.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using stan::analyze::compute_many_chain_effective_sample_size;
+
+namespace {
+Eigen::MatrixXd ar1_draws(Eigen::Index num_draws, Eigen::Index num_chains,
+                          double rho) {
+  std::mt19937 rng(num_draws);
+  std::normal_distribution<double> normal;
+  Eigen::MatrixXd draws(num_draws, num_chains);
+  for (Eigen::Index chain = 0; chain < num_chains; ++chain) {
+    double x = normal(rng);
+    for (Eigen::Index n = 0; n < num_draws; ++n) {
+      x = rho * x + normal(rng);
+      draws(n, chain) = x;
+    }
+  }
+  return draws;
+}
+
+double expected_ess(const Eigen::MatrixXd& draws) {
+  std::vector<const double*> columns;
+  for (Eigen::Index chain = 0; chain < draws.cols(); ++chain)
+    columns.push_back(draws.col(chain).data());
+  std::vector<size_t> sizes(draws.cols(), draws.rows());
+  return stan::analyze::compute_effective_sample_size(columns, sizes);
+}
+}  // namespace
+
+TEST(ManyChainEffectiveSampleSize, matches_effective_sample_size) {
+  for (double rho : {0.9, 0.3, -0.5}) {
+    for (Eigen::Index num_chains : {1, 4, 256}) {
+      Eigen::MatrixXd draws = ar1_draws(50, num_chains, rho);
+      double expected = expected_ess(draws);
+      EXPECT_NEAR(expected, compute_many_chain_effective_sample_size(draws),
+                  1e-8 * expected)
+          << "rho " << rho << " chains " << num_chains;
+    }
+  }
+}
+
+TEST(ManyChainEffectiveSampleSize, map_of_draws) {
+  Eigen::MatrixXd draws = ar1_draws(20, 64, 0.5);
+  Eigen::Map<const Eigen::MatrixXd> view(draws.data(), 20, 64);
+  EXPECT_EQ(compute_many_chain_effective_sample_size(draws),
+            compute_many_chain_effective_sample_size(view));
+}
+
+TEST(ManyChainEffectiveSampleSize, degenerate) {
+  Eigen::MatrixXd draws = ar1_draws(3, 10, 0.5);
+  EXPECT_TRUE(std::isnan(compute_many_chain_effective_sample_size(draws)));
+  draws = Eigen::MatrixXd::Constant(10, 4, 1.0);
+  EXPECT_TRUE(std::isnan(compute_many_chain_effective_sample_size(draws)));
+  draws = ar1_draws(10, 4, 0.5);
+  draws(3, 2) = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_TRUE(std::isnan(compute_many_chain_effective_sample_size(draws)));
+}
@@ -0,0 +1,94 @@
+#include <stan/analyze/mcmc/compute_nested_potential_scale_reduction.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+using stan::analyze::compute_nested_potential_scale_reduction;
+
+namespace {
+// short AR(1) chains, those of superchain k centered at k * offset
+Eigen::MatrixXd ar1_draws(Eigen::Index num_draws, Eigen::Index num_chains,
+                          Eigen::Index num_superchains, double offset) {
+  std::mt19937 rng(num_chains);
+  std::normal_distribution<double> normal;
+  Eigen::MatrixXd draws(num_draws, num_chains);
+  const Eigen::Index per = num_chains / num_superchains;
+  for (Eigen::Index chain = 0; chain < num_chains; ++chain) {
+    double x = 0;
+    for (Eigen::Index n = 0; n < num_draws; ++n) {
+      x = 0.5 * x + normal(rng);
+      draws(n, chain) = x + (chain / per) * offset;
+    }
+  }
+  return draws;
+}
+}  // namespace
+
+TEST(NestedPotentialScaleReduction, matches_definition) {
+  Eigen::MatrixXd draws(3, 4);
+  draws << 1, 2, 4, 3,  //
+      2, 2, 5, 7,       //
+      3, 5, 6, 8;
+  // chain means 2, 3, 5, 6 and variances 1, 3, 1, 7, superchain means
+  // 2.5 and 5.5, between superchain variance 4.5 and within superchain
+  // variance (1 + 3 + 1 + 7) / 4 + (0.5 + 0.5) / 2
+  double expected = std::sqrt(1 + 4.5 / 3.5);
+  EXPECT_DOUBLE_EQ(expected,
+                   compute_nested_potential_scale_reduction(draws, 2));
+
+  // with one chain per superchain it is the unsplit R-hat of the chains
+  // without the (N - 1) / N correction
+  Eigen::RowVectorXd means = draws.colwise().mean();
+  double between = (means.array() - means.mean()).square().sum() / 3;
+  double within = (1 + 3 + 1 + 7) / 4.0;
+  EXPECT_DOUBLE_EQ(std::sqrt(1 + between / within),
+                   compute_nested_potential_scale_reduction(draws, 4));
+}
+
+TEST(NestedPotentialScaleReduction, converges_with_many_short_chains) {
+  Eigen::MatrixXd mixed = ar1_draws(20, 512, 8, 0);
+  EXPECT_LT(compute_nested_potential_scale_reduction(mixed, 8), 1.01);
+  Eigen::MatrixXd stuck = ar1_draws(20, 512, 8, 1);
+  EXPECT_GT(compute_nested_potential_scale_reduction(stuck, 8), 1.1);
+}
+
+TEST(NestedPotentialScaleReduction, map_of_draws) {
+  Eigen::MatrixXd draws = ar1_draws(10, 8, 2, 0.5);
+  Eigen::Map<const Eigen::MatrixXd> view(draws.data(), 10, 8);
+  EXPECT_EQ(compute_nested_potential_scale_reduction(draws, 2),
+            compute_nested_potential_scale_reduction(view, 2));
+}
+
+TEST(NestedPotentialScaleReduction, degenerate) {
+  Eigen::MatrixXd draws = Eigen::MatrixXd::Constant(5, 4, 2.0);
+  EXPECT_TRUE(std::isnan(compute_nested_potential_scale_reduction(draws, 2)));
+  draws(2, 1) = std::numeric_limits<double>::infinity();
+  EXPECT_TRUE(std::isnan(compute_nested_potential_scale_reduction(draws, 2)));
+  EXPECT_THROW(compute_nested_potential_scale_reduction(draws, 3),
+               std::invalid_argument);
+  EXPECT_THROW(compute_nested_potential_scale_reduction(draws, 1),
+               std::invalid_argument);
+}
+
+TEST(NestedPotentialScaleReduction, accumulator_matches) {
+  Eigen::MatrixXd first = ar1_draws(30, 16, 4, 0.3);
+  Eigen::MatrixXd second = ar1_draws(30, 16, 4, -0.2);
+  stan::analyze::nested_rhat_accumulator acc(2, 16, 4);
+  EXPECT_TRUE(std::isnan(acc.rhat()(0)));
+  Eigen::MatrixXd q(2, 16);
+  for (Eigen::Index n = 0; n < 30; ++n) {
+    q.row(0) = first.row(n);
+    q.row(1) = second.row(n);
+    acc.add(q);
+  }
+  EXPECT_EQ(30U, acc.num_draws());
+  Eigen::VectorXd rhat = acc.rhat();
+  EXPECT_FLOAT_EQ(compute_nested_potential_scale_reduction(first, 4), rhat(0));
+  EXPECT_FLOAT_EQ(compute_nested_potential_scale_reduction(second, 4), rhat(1));
+  EXPECT_THROW(acc.add(Eigen::MatrixXd(2, 15)), std::invalid_argument);
+  acc.reset();
+  EXPECT_EQ(0U, acc.num_draws());
+  EXPECT_THROW(stan::analyze::nested_rhat_accumulator(2, 15, 4),
+               std::invalid_argument);
+}
@@ -0,0 +1,84 @@
+#include <stan/analyze/mcmc/online_diagnostics.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <vector>
+
+TEST(OnlineDiagnostics, moments_and_quantiles) {
+  boost::ecuyer1988 rng(4321);
+  boost::normal_distribution<> normal;
+  stan::analyze::online_diagnostics diagnostics;
+  diagnostics(std::vector<std::string>{"lp__", "x"});
+  const int n = 20000;
+  for (int i = 0; i < n; ++i)
+    diagnostics(std::vector<double>{-1.0, 3 + 2 * normal(rng)});
+
+  EXPECT_EQ(2, diagnostics.num_columns());
+  EXPECT_EQ(n, diagnostics.num_draws());
+  EXPECT_EQ("x", diagnostics.names()[1]);
+  EXPECT_NEAR(3, diagnostics.mean(1), 0.05);
+  EXPECT_NEAR(2, diagnostics.sd(1), 0.05);
+  EXPECT_NEAR(3 - 2 * 1.645, diagnostics.quantile(1, 0), 0.1);
+  EXPECT_NEAR(3, diagnostics.quantile(1, 1), 0.1);
+  EXPECT_NEAR(3 + 2 * 1.645, diagnostics.quantile(1, 2), 0.1);
+
+  EXPECT_FLOAT_EQ(-1, diagnostics.mean(0));
+  EXPECT_FLOAT_EQ(0, diagnostics.variance(0));
+  EXPECT_FLOAT_EQ(-1, diagnostics.quantile(0, 1));
+}
+
+TEST(OnlineDiagnostics, exact_quantiles_for_few_draws) {
+  stan::analyze::online_diagnostics diagnostics({0.5});
+  diagnostics(std::vector<double>{3});
+  diagnostics(std::vector<double>{1});
+  diagnostics(std::vector<double>{2});
+  EXPECT_FLOAT_EQ(2, diagnostics.quantile(0, 0));
+  EXPECT_TRUE(std::isnan(diagnostics.ess(0)));
+}
+
+TEST(OnlineDiagnostics, ess_independent_and_autocorrelated) {
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  stan::analyze::online_diagnostics diagnostics;
+  const int n = 100000;
+  const double rho = 0.9;
+  double ar1 = 0;
+  for (int i = 0; i < n; ++i) {
+    ar1 = rho * ar1 + std::sqrt(1 - rho * rho) * normal(rng);
+    diagnostics(std::vector<double>{normal(rng), ar1});
+  }
+
+  EXPECT_NEAR(1, diagnostics.ess(0) / n, 0.35);
+  double expected_ar1 = n * (1 - rho) / (1 + rho);
+  EXPECT_NEAR(1, diagnostics.ess(1) / expected_ar1, 0.35);
+}
+
+TEST(OnlineDiagnostics, header_resets) {
+  stan::analyze::online_diagnostics diagnostics;
+  diagnostics(std::vector<double>{1, 2});
+  diagnostics(std::vector<std::string>{"a"});
+  EXPECT_EQ(0, diagnostics.num_draws());
+  diagnostics(std::vector<double>{5});
+  EXPECT_EQ(1, diagnostics.num_draws());
+  EXPECT_FLOAT_EQ(5, diagnostics.mean(0));
+  EXPECT_THROW(diagnostics(std::vector<double>{1, 2}), std::invalid_argument);
+  diagnostics.reset();
+  EXPECT_EQ(0, diagnostics.num_draws());
+}
+
+TEST(OnlineDiagnostics, potential_scale_reduction) {
+  boost::ecuyer1988 rng(97);
+  boost::normal_distribution<> normal;
+  std::vector<stan::analyze::online_diagnostics> chains(4);
+  EXPECT_TRUE(
+      std::isnan(stan::analyze::online_potential_scale_reduction(chains, 0)));
+  for (int i = 0; i < 5000; ++i)
+    for (size_t j = 0; j < chains.size(); ++j)
+      chains[j](std::vector<double>{normal(rng), normal(rng) + (j == 0) * 2});
+  EXPECT_NEAR(1, stan::analyze::online_potential_scale_reduction(chains, 0),
+              0.01);
+  EXPECT_GT(stan::analyze::online_potential_scale_reduction(chains, 1), 1.2);
+  EXPECT_TRUE(std::isnan(stan::analyze::online_potential_scale_reduction(
+      std::vector<stan::analyze::online_diagnostics>(1, chains[0]), 0)));
+}
@@ -0,0 +1,66 @@
+#include <stan/analyze/mcmc/online_energy_diagnostics.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+TEST(OnlineEnergyDiagnostics, ebfmi_and_divergences) {
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  stan::analyze::online_energy_diagnostics energy;
+  energy(std::vector<std::string>{"stepsize__", "treedepth__",
+                                  "n_leapfrog__", "divergent__",
+                                  "energy__"});
+  EXPECT_TRUE(std::isnan(energy.ebfmi()));
+  EXPECT_TRUE(std::isnan(energy.divergence_rate()));
+
+  const int n = 20000;
+  std::vector<double> energies;
+  for (int i = 0; i < n; ++i) {
+    double e = 10 + 2 * normal(rng);
+    energies.push_back(e);
+    energy(std::vector<double>{0.5, 3, 7, i % 100 == 0 ? 1.0 : 0.0, e});
+  }
+  double mean = 0;
+  for (double e : energies)
+    mean += e / n;
+  double num = 0;
+  double den = 0;
+  for (int i = 0; i < n; ++i) {
+    if (i > 0)
+      num += std::pow(energies[i] - energies[i - 1], 2);
+    den += std::pow(energies[i] - mean, 2);
+  }
+  EXPECT_NEAR(num / den, energy.ebfmi(), 1e-8);
+  // independent energies have an E-BFMI of 2
+  EXPECT_NEAR(2, energy.ebfmi(), 0.1);
+  EXPECT_EQ(n, energy.num_draws());
+  EXPECT_EQ(200, energy.num_divergent());
+  EXPECT_FLOAT_EQ(0.01, energy.divergence_rate());
+}
+
+TEST(OnlineEnergyDiagnostics, slowly_changing_energy) {
+  stan::analyze::online_energy_diagnostics energy;
+  energy(std::vector<std::string>{"lp__", "energy__", "theta"});
+  for (int i = 0; i < 1000; ++i)
+    energy(std::vector<double>{0, std::sin(i / 100.0), 0});
+  EXPECT_LT(energy.ebfmi(), 0.3);
+  EXPECT_EQ(0, energy.num_divergent());
+  EXPECT_FLOAT_EQ(0, energy.divergence_rate());
+
+  energy.reset();
+  EXPECT_EQ(0, energy.num_draws());
+  EXPECT_TRUE(std::isnan(energy.ebfmi()));
+}
+
+TEST(OnlineEnergyDiagnostics, no_energy_column) {
+  stan::analyze::online_energy_diagnostics energy;
+  energy(std::vector<std::string>{"lp__", "theta"});
+  for (int i = 0; i < 10; ++i)
+    energy(std::vector<double>{1.0 * i, 2.0 * i});
+  EXPECT_EQ(10, energy.num_draws());
+  EXPECT_TRUE(std::isnan(energy.ebfmi()));
+  EXPECT_FLOAT_EQ(0, energy.divergence_rate());
+}
@@ -0,0 +1,84 @@
+#include <stan/analyze/mcmc/online_multivariate_ess.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+TEST(OnlineMultivariateEss, independent_draws) {
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  stan::analyze::online_multivariate_ess mess;
+  mess(std::vector<std::string>{"lp__", "a", "b", "treedepth__"});
+  EXPECT_EQ(2, mess.num_parameters());
+  const int n = 50000;
+  for (int i = 0; i < n; ++i) {
+    double a = normal(rng);
+    // correlated but independent across draws
+    mess(std::vector<double>{-1.0 * i, a, a + 0.1 * normal(rng), 3});
+  }
+  EXPECT_EQ(n, mess.num_draws());
+  EXPECT_EQ(2, mess.num_dimensions());
+  EXPECT_NEAR(1, mess.ess() / n, 0.35);
+}
+
+TEST(OnlineMultivariateEss, autocorrelated_draws) {
+  boost::ecuyer1988 rng(4321);
+  boost::normal_distribution<> normal;
+  stan::analyze::online_multivariate_ess mess;
+  const int n = 100000;
+  const double rho = 0.9;
+  double x = 0;
+  double y = 0;
+  for (int i = 0; i < n; ++i) {
+    x = rho * x + std::sqrt(1 - rho * rho) * normal(rng);
+    y = rho * y + std::sqrt(1 - rho * rho) * normal(rng);
+    mess(std::vector<double>{x, y});
+  }
+  // the determinant ratio is that of either coordinate
+  double expected = n * (1 - rho) / (1 + rho);
+  EXPECT_NEAR(1, mess.ess() / expected, 0.35);
+}
+
+TEST(OnlineMultivariateEss, projects_many_parameters) {
+  boost::ecuyer1988 rng(97);
+  boost::normal_distribution<> normal;
+  const size_t num_params = 200;
+  stan::analyze::online_multivariate_ess mess(8);
+  std::vector<double> draw(num_params);
+  const int n = 20000;
+  for (int i = 0; i < n; ++i) {
+    for (double& x : draw)
+      x = normal(rng);
+    // a constant column is left out of the determinants
+    draw[0] = 1;
+    mess(draw);
+  }
+  EXPECT_EQ(num_params, mess.num_parameters());
+  EXPECT_EQ(8, mess.num_dimensions());
+  EXPECT_NEAR(1, mess.ess() / n, 0.35);
+}
+
+TEST(OnlineMultivariateEss, too_few_draws_and_resets) {
+  stan::analyze::online_multivariate_ess mess(16, 4);
+  for (int i = 0; i < 3; ++i)
+    mess(std::vector<double>{1.0 * i, 2.0 * (i % 2)});
+  EXPECT_TRUE(std::isnan(mess.ess()));
+  for (int i = 0; i < 6; ++i)
+    mess(std::vector<double>{5, 5});
+  EXPECT_FALSE(std::isnan(mess.ess()));
+  EXPECT_THROW(mess(std::vector<double>{1, 2, 3}), std::invalid_argument);
+
+  mess.reset();
+  EXPECT_EQ(0, mess.num_draws());
+  for (int i = 0; i < 8; ++i)
+    mess(std::vector<double>{3, 3});
+  EXPECT_TRUE(std::isnan(mess.ess()));
+
+  EXPECT_THROW(stan::analyze::online_multivariate_ess(0),
+               std::invalid_argument);
+  EXPECT_THROW(stan::analyze::online_multivariate_ess(16, 1),
+               std::invalid_argument);
+}
@@ -0,0 +1,83 @@
+#include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
+#include <stan/analyze/mcmc/rank_normalization_engine.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+Eigen::MatrixXd expected_ranks(const Eigen::MatrixXd& chains) {
+  std::vector<std::pair<double, int>> value_with_index;
+  Eigen::MatrixXd ranks;
+  stan::analyze::rank_transform(chains, value_with_index, ranks);
+  return ranks;
+}
+
+// draws with ties, both zeros and negative values, small enough for the
+// comparison sort or large enough for the radix sort
+Eigen::MatrixXd draws(Eigen::Index rows, Eigen::Index cols) {
+  std::mt19937 rng(rows);
+  std::normal_distribution<double> normal(1.0, 3.0);
+  Eigen::MatrixXd chains(rows, cols);
+  for (Eigen::Index i = 0; i < chains.size(); ++i)
+    chains(i) = normal(rng);
+  for (Eigen::Index i = 0; i < chains.size(); i += 7)
+    chains(i) = std::round(chains(i));
+  chains(0) = 0.0;
+  chains(1) = -0.0;
+  return chains;
+}
+}  // namespace
+
+TEST(RankNormalizationEngine, rank_transform_matches) {
+  stan::analyze::rank_normalization_engine engine;
+  Eigen::MatrixXd ranks;
+  for (Eigen::Index rows : {3, 50, 1000, 50}) {
+    Eigen::MatrixXd chains = draws(rows, 4);
+    engine.rank_transform(chains, ranks);
+    Eigen::MatrixXd expected = expected_ranks(chains);
+    ASSERT_EQ(expected.rows(), ranks.rows());
+    ASSERT_EQ(expected.cols(), ranks.cols());
+    for (Eigen::Index i = 0; i < ranks.size(); ++i)
+      EXPECT_EQ(expected(i), ranks(i));
+    EXPECT_EQ(ranks(0), ranks(1));
+  }
+}
+
+TEST(RankNormalizationEngine, folded_rank_transform_matches) {
+  stan::analyze::rank_normalization_engine engine;
+  Eigen::MatrixXd ranks;
+  for (Eigen::Index rows : {2, 51, 1000}) {
+    Eigen::MatrixXd chains = draws(rows, 4);
+    engine.rank_transform(chains, ranks);
+    double median = stan::math::quantile(chains.reshaped(), 0.5);
+    EXPECT_DOUBLE_EQ(median, engine.quantile(0.5));
+    engine.folded_rank_transform(ranks);
+    Eigen::MatrixXd expected
+        = expected_ranks((chains.array() - engine.quantile(0.5)).abs());
+    for (Eigen::Index i = 0; i < ranks.size(); ++i)
+      EXPECT_EQ(expected(i), ranks(i));
+  }
+}
+
+TEST(RankNormalizationEngine, quantile) {
+  stan::analyze::rank_normalization_engine engine;
+  Eigen::MatrixXd ranks;
+  Eigen::MatrixXd chains = draws(999, 3);
+  engine.rank_transform(chains, ranks);
+  for (double p : {0.0, 0.05, 0.5, 0.95, 1.0})
+    EXPECT_DOUBLE_EQ(stan::math::quantile(chains.reshaped(), p),
+                     engine.quantile(p));
+  EXPECT_EQ(chains.minCoeff(), engine.quantile(0));
+  EXPECT_EQ(chains.maxCoeff(), engine.quantile(1));
+}
+
+TEST(RankNormalizationEngine, constant_draws) {
+  stan::analyze::rank_normalization_engine engine;
+  Eigen::MatrixXd ranks;
+  Eigen::MatrixXd chains = Eigen::MatrixXd::Constant(600, 2, 1.5);
+  engine.rank_transform(chains, ranks);
+  EXPECT_NEAR(0.0, ranks.cwiseAbs().maxCoeff(), 1e-12);
+  EXPECT_FLOAT_EQ(1.5, engine.quantile(0.5));
+}
@@ -0,0 +1,98 @@
+#include <stan/callbacks/async_logger.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using stan::callbacks::log_level;
+
+TEST(StanCallbacksAsyncLogger, passes_on_in_order) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger out(debug, info, warn, error, fatal);
+  {
+    stan::callbacks::async_logger logger(out);
+    for (int i = 0; i < 100; ++i)
+      logger.info(std::to_string(i));
+    std::stringstream message;
+    message << "oops";
+    logger.error(message);
+    logger.flush();
+    EXPECT_EQ("oops\n", error.str());
+    logger.fatal("last");
+  }
+  std::string expected;
+  for (int i = 0; i < 100; ++i)
+    expected += std::to_string(i) + "\n";
+  EXPECT_EQ(expected, info.str());
+  EXPECT_EQ("last\n", fatal.str());
+}
+
+TEST(StanCallbacksAsyncLogger, min_level) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger out(debug, info, warn, error, fatal,
+                                     log_level::info);
+  stan::callbacks::async_logger logger(out, log_level::warn);
+  EXPECT_FALSE(logger.is_enabled(log_level::debug));
+  EXPECT_FALSE(logger.is_enabled(log_level::info));
+  EXPECT_TRUE(logger.is_enabled(log_level::warn));
+  logger.debug("d");
+  logger.info("i");
+  logger.warn("w");
+  logger.flush();
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("w\n", warn.str());
+}
+
+TEST(StanCallbacksAsyncLogger, suppresses_repeats) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger out(debug, info, warn, error, fatal);
+  stan::callbacks::async_logger logger(out, log_level::debug, 2);
+  for (int i = 0; i < 5; ++i) {
+    logger.error("rejected");
+    logger.error(std::to_string(i));
+    logger.error("");
+  }
+  logger.info("rejected");
+  EXPECT_EQ(3, logger.num_suppressed());
+  logger.flush();
+  EXPECT_EQ(0, logger.num_suppressed());
+  EXPECT_EQ("rejected\n0\n\nrejected\n1\n\n2\n\n3\n\n4\n\n", error.str());
+  EXPECT_EQ("rejected\nSuppressed 3 repeated log messages.\n", info.str());
+}
+
+TEST(StanCallbacksAsyncLogger, several_threads) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger out(debug, info, warn, error, fatal);
+  stan::callbacks::async_logger logger(out);
+  std::vector<std::thread> chains;
+  for (int c = 0; c < 4; ++c)
+    chains.emplace_back([&logger]() {
+      for (int i = 0; i < 1000; ++i)
+        logger.info("x");
+    });
+  for (std::thread& chain : chains)
+    chain.join();
+  logger.flush();
+  EXPECT_EQ(4000 * 2, info.str().size());
+}
+
+namespace {
+class throwing_logger : public stan::callbacks::logger {
+ public:
+  void info(const std::string& message) {
+    throw std::runtime_error(message);
+  }
+};
+}  // namespace
+
+TEST(StanCallbacksAsyncLogger, rethrows_on_flush) {
+  throwing_logger out;
+  stan::callbacks::async_logger logger(out);
+  logger.info("boom");
+  EXPECT_THROW(logger.flush(), std::runtime_error);
+  EXPECT_NO_THROW(logger.flush());
+}
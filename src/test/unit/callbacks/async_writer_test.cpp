@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/async_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+class matrix_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    matrices.push_back(values);
+  }
+  std::vector<Eigen::MatrixXd> matrices;
+};
+
+class throwing_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const std::string& message) {
+    throw std::runtime_error(message);
+  }
+};
+}  // namespace
+
+TEST(StanCallbacksAsyncWriter, forwards_calls_in_order) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer stream_writer(ss, "# ");
+  {
+    stan::callbacks::async_writer writer(stream_writer, 2);
+    EXPECT_EQ(2, writer.capacity());
+    writer(std::vector<std::string>{"a", "b"});
+    for (int i = 0; i < 10; ++i)
+      writer(std::vector<double>{1.0 * i, 2.0 * i});
+    writer("message");
+    writer();
+  }
+  std::stringstream expected;
+  expected << "a,b\n";
+  for (int i = 0; i < 10; ++i)
+    expected << i << "," << 2 * i << "\n";
+  expected << "# message\n# \n";
+  EXPECT_EQ(expected.str(), ss.str());
+}
+
+TEST(StanCallbacksAsyncWriter, zero_capacity_throws) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer stream_writer(ss);
+  EXPECT_THROW(stan::callbacks::async_writer(stream_writer, 0),
+               std::invalid_argument);
+}
+
+TEST(StanCallbacksAsyncWriter, zero_keep_every_throws) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer stream_writer(ss);
+  EXPECT_THROW(stan::callbacks::async_writer(
+                   stream_writer, 4,
+                   stan::callbacks::async_writer::overflow::block, 0),
+               std::invalid_argument);
+}
+
+TEST(StanCallbacksAsyncWriter, flush_waits_for_queued_calls) {
+  stan::test::unit::instrumented_writer instrumented;
+  stan::callbacks::async_writer writer(instrumented, 4);
+  for (int i = 0; i < 100; ++i)
+    writer(std::vector<double>{1.0 * i});
+  writer.flush();
+  EXPECT_EQ(100, instrumented.call_count("vector_double"));
+  EXPECT_EQ(99, instrumented.vector_double_values().back()[0]);
+}
+
+TEST(StanCallbacksAsyncWriter, matrix) {
+  matrix_writer matrices;
+  stan::callbacks::async_writer writer(matrices);
+  Eigen::MatrixXd values(2, 3);
+  values << 1, 2, 3, 4, 5, 6;
+  writer(values);
+  writer.flush();
+  ASSERT_EQ(1, matrices.matrices.size());
+  EXPECT_EQ(values, matrices.matrices[0]);
+}
+
+TEST(StanCallbacksAsyncWriter, rethrows_wrapped_writer_exception) {
+  throwing_writer throwing;
+  stan::callbacks::async_writer writer(throwing);
+  writer("failure");
+  EXPECT_THROW(writer.flush(), std::runtime_error);
+  EXPECT_NO_THROW(writer.flush());
+}
+
+TEST(StanCallbacksAsyncWriter, keep_every) {
+  stan::test::unit::instrumented_writer instrumented;
+  stan::callbacks::async_writer writer(
+      instrumented, 4, stan::callbacks::async_writer::overflow::block, 10);
+  writer(std::vector<std::string>{"a"});
+  for (int i = 0; i < 95; ++i)
+    writer(std::vector<double>{1.0 * i});
+  writer("message");
+  writer.flush();
+  EXPECT_EQ(1, instrumented.call_count("vector_string"));
+  EXPECT_EQ(1, instrumented.call_count("string"));
+  ASSERT_EQ(10, instrumented.call_count("vector_double"));
+  EXPECT_EQ(0, instrumented.vector_double_values().front()[0]);
+  EXPECT_EQ(90, instrumented.vector_double_values().back()[0]);
+  EXPECT_EQ(0, writer.num_dropped());
+}
+
+TEST(StanCallbacksAsyncWriter, drop_when_full) {
+  std::mutex gate;
+  std::unique_lock<std::mutex> closed(gate);
+  // blocks the background thread on the first draw until the gate opens
+  class gated_writer : public stan::callbacks::writer {
+   public:
+    explicit gated_writer(std::mutex& gate) : gate_(gate) {}
+    void operator()(const std::vector<double>& state) {
+      std::lock_guard<std::mutex> lock(gate_);
+      draws.push_back(state[0]);
+    }
+    std::vector<double> draws;
+
+   private:
+    std::mutex& gate_;
+  } gated(gate);
+  stan::callbacks::async_writer writer(
+      gated, 2, stan::callbacks::async_writer::overflow::drop);
+  writer(std::vector<double>{0});
+  // wait for the background thread to take the first draw
+  while (writer.num_dropped() == 0)
+    writer(std::vector<double>{-1});
+  size_t dropped = writer.num_dropped();
+  closed.unlock();
+  writer.flush();
+  EXPECT_EQ(0, gated.draws.front());
+  EXPECT_LE(gated.draws.size(), 1 + writer.capacity() + 1);
+  EXPECT_EQ(dropped, writer.num_dropped());
+  EXPECT_EQ(writer.capacity(), writer.max_queue_depth());
+  EXPECT_EQ(0, writer.queue_depth());
+}
+
+TEST(StanCallbacksAsyncWriter, forwards_schema) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer stream_writer(ss);
+  {
+    stan::callbacks::async_writer writer(stream_writer);
+    EXPECT_FALSE(writer.accepts_schema());
+    stan::callbacks::output_schema schema;
+    schema.add("lp__");
+    schema.add("theta", {2});
+    writer(schema);
+  }
+  EXPECT_EQ("lp__,theta.1,theta.2\n", ss.str());
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/binary_writer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+
+class StanInterfaceCallbacksBinaryWriter : public ::testing::Test {
+ public:
+  StanInterfaceCallbacksBinaryWriter() : ss() {}
+
+  void SetUp() {
+    ss.str(std::string());
+    ss.clear();
+  }
+
+  std::uint64_t size_at(size_t pos) {
+    std::uint64_t n;
+    std::memcpy(&n, ss.str().data() + pos, sizeof(n));
+    return n;
+  }
+
+  double double_at(size_t pos) {
+    double x;
+    std::memcpy(&x, ss.str().data() + pos, sizeof(x));
+    return x;
+  }
+
+  std::stringstream ss;
+};
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, magic) {
+  stan::callbacks::binary_writer writer(ss);
+  EXPECT_EQ("STANDRW1", ss.str());
+}
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, string_vector) {
+  stan::callbacks::binary_writer writer(ss);
+  writer(std::vector<std::string>{"lp__", "theta"});
+  std::string out = ss.str();
+  ASSERT_EQ(8 + 1 + 8 + (8 + 4) + (8 + 5), out.size());
+  EXPECT_EQ('H', out[8]);
+  EXPECT_EQ(2, size_at(9));
+  EXPECT_EQ(4, size_at(17));
+  EXPECT_EQ("lp__", out.substr(25, 4));
+  EXPECT_EQ(5, size_at(29));
+  EXPECT_EQ("theta", out.substr(37, 5));
+}
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, double_vector_buffered) {
+  stan::callbacks::binary_writer writer(ss, 2);
+  writer(std::vector<double>{1, 2, 3});
+  EXPECT_EQ(8, ss.str().size()) << "first draw is buffered";
+
+  writer(std::vector<double>{4, 5, 6});
+  std::string out = ss.str();
+  ASSERT_EQ(8 + 1 + 16 + 6 * 8, out.size());
+  EXPECT_EQ('D', out[8]);
+  EXPECT_EQ(2, size_at(9));
+  EXPECT_EQ(3, size_at(17));
+  const double expected[] = {1, 4, 2, 5, 3, 6};
+  for (int i = 0; i < 6; ++i)
+    EXPECT_EQ(expected[i], double_at(25 + 8 * i)) << "columnar order";
+}
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, comment_flushes_draws) {
+  stan::callbacks::binary_writer writer(ss);
+  writer(std::vector<double>{1, 2});
+  writer("message");
+  writer();
+  std::string out = ss.str();
+  ASSERT_EQ(8 + (1 + 16 + 16) + (1 + 8 + 7) + (1 + 8), out.size());
+  EXPECT_EQ('D', out[8]);
+  EXPECT_EQ('C', out[41]);
+  EXPECT_EQ(7, size_at(42));
+  EXPECT_EQ("message", out.substr(50, 7));
+  EXPECT_EQ('C', out[57]);
+  EXPECT_EQ(0, size_at(58));
+}
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, destructor_flushes_draws) {
+  {
+    stan::callbacks::binary_writer writer(ss);
+    writer(std::vector<double>{1, 2});
+    EXPECT_EQ(8, ss.str().size());
+  }
+  EXPECT_EQ(8 + 1 + 16 + 16, ss.str().size());
+}
+
+TEST_F(StanInterfaceCallbacksBinaryWriter, eigen_matrix) {
+  stan::callbacks::binary_writer writer(ss);
+  Eigen::MatrixXd values(2, 3);
+  values << 1, 2, 3, 4, 5, 6;
+  writer(values);
+  std::string out = ss.str();
+  ASSERT_EQ(8 + 1 + 16 + 6 * 8, out.size());
+  EXPECT_EQ(3, size_at(9)) << "samples are in the columns";
+  EXPECT_EQ(2, size_at(17));
+  const double expected[] = {1, 2, 3, 4, 5, 6};
+  for (int i = 0; i < 6; ++i)
+    EXPECT_EQ(expected[i], double_at(25 + 8 * i));
+}
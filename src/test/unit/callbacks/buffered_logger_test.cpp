@@ -0,0 +1,23 @@
+#include <stan/callbacks/buffered_logger.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(StanCallbacksBufferedLogger, flush_in_order) {
+  stan::callbacks::buffered_logger buffered;
+  buffered.info("first");
+  std::stringstream second;
+  second << "second";
+  buffered.warn(second);
+  buffered.error("third");
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  buffered.flush(logger);
+  EXPECT_EQ("first\n", info.str());
+  EXPECT_EQ("second\n", warn.str());
+  EXPECT_EQ("third\n", error.str());
+
+  buffered.flush(logger);
+  EXPECT_EQ("first\n", info.str());
+}
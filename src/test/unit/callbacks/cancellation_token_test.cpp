@@ -0,0 +1,46 @@
+#include <stan/callbacks/cancellation_token.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <thread>
+
+namespace {
+class counting_interrupt : public stan::callbacks::interrupt {
+ public:
+  int num_calls = 0;
+  bool stop = false;
+
+  void operator()() { ++num_calls; }
+  bool stop_requested() const { return stop; }
+};
+}  // namespace
+
+TEST(StanCallbacksCancellationToken, cancel) {
+  stan::callbacks::cancellation_token token;
+  EXPECT_FALSE(token.stop_requested());
+  std::thread client([&token]() { token.cancel(); });
+  client.join();
+  EXPECT_TRUE(token.cancelled());
+  EXPECT_TRUE(token.stop_requested());
+}
+
+TEST(StanCallbacksCancellationToken, deadline) {
+  stan::callbacks::cancellation_token token;
+  token.set_deadline(3600);
+  EXPECT_FALSE(token.stop_requested());
+  token.set_deadline(0);
+  EXPECT_TRUE(token.stop_requested());
+  EXPECT_FALSE(token.cancelled());
+  token.set_deadline(std::numeric_limits<double>::infinity());
+  EXPECT_FALSE(token.stop_requested());
+}
+
+TEST(StanCallbacksCancellationToken, wraps_an_interrupt) {
+  counting_interrupt inner;
+  stan::callbacks::cancellation_token token(&inner);
+  token();
+  token();
+  EXPECT_EQ(2, inner.num_calls);
+  EXPECT_FALSE(token.stop_requested());
+  inner.stop = true;
+  EXPECT_TRUE(token.stop_requested());
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/compressed_ostream.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+struct failing_codec : public stan::callbacks::uncompressed_codec {
+  size_t compress(const char* src, size_t n, char* dst,
+                  size_t capacity) const {
+    throw std::runtime_error("failing codec");
+  }
+};
+
+// the frames of a compressed stream, which must be uncompressed
+std::vector<std::string> frames(const std::string& out) {
+  EXPECT_EQ(0, out.compare(0, 8, "STANCMP1"));
+  EXPECT_EQ('N', out[8]);
+  std::vector<std::string> frames;
+  size_t pos = 9;
+  while (pos < out.size()) {
+    std::uint64_t sizes[2];
+    std::memcpy(sizes, out.data() + pos, sizeof(sizes));
+    EXPECT_EQ(sizes[0], sizes[1]);
+    frames.push_back(out.substr(pos + sizeof(sizes), sizes[1]));
+    pos += sizeof(sizes) + sizes[1];
+  }
+  EXPECT_EQ(out.size(), pos);
+  return frames;
+}
+}  // namespace
+
+TEST(StanCallbacksCompressedOstream, frames_in_order) {
+  std::stringstream ss;
+  std::stringstream expected;
+  {
+    stan::callbacks::compressed_ostream<stan::callbacks::uncompressed_codec>
+        out(ss, 16, 3);
+    stan::callbacks::stream_writer writer(out, "# ");
+    writer(std::vector<std::string>{"lp__", "theta"});
+    expected << "lp__,theta\n";
+    for (int i = 0; i < 1000; ++i) {
+      writer(std::vector<double>{i - 500.0, 0.5 * i});
+      expected << i - 500 << "," << 0.5 * i << "\n";
+    }
+    writer("done");
+    expected << "# done\n";
+  }
+  std::vector<std::string> written = frames(ss.str());
+  std::string joined;
+  for (size_t i = 0; i < written.size(); ++i) {
+    if (i + 1 < written.size()) {
+      EXPECT_EQ(16, written[i].size());
+    }
+    joined += written[i];
+  }
+  EXPECT_EQ(expected.str(), joined);
+}
+
+TEST(StanCallbacksCompressedOstream, flush_ends_frame) {
+  std::stringstream ss;
+  stan::callbacks::compressed_ostream<stan::callbacks::uncompressed_codec>
+      out(ss, 1024);
+  out << "abc" << std::flush;
+  EXPECT_EQ(std::vector<std::string>{"abc"}, frames(ss.str()));
+  out << "de";
+  out.close();
+  EXPECT_TRUE(out.good());
+  EXPECT_EQ((std::vector<std::string>{"abc", "de"}), frames(ss.str()));
+  out.close();
+  EXPECT_EQ((std::vector<std::string>{"abc", "de"}), frames(ss.str()));
+}
+
+TEST(StanCallbacksCompressedOstream, codec_failure_makes_stream_bad) {
+  std::stringstream ss;
+  stan::callbacks::compressed_ostream<failing_codec> out(ss, 4);
+  out << "abcdefgh";
+  out << std::flush;
+  EXPECT_TRUE(out.bad());
+  out.close();
+  EXPECT_EQ(9, ss.str().size());
+}
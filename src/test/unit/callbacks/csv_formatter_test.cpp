@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/csv_formatter.hpp>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace {
+std::string stream_row(const std::vector<double>& v, std::ostream& format) {
+  std::stringstream ss;
+  ss.copyfmt(format);
+  for (size_t i = 0; i < v.size(); ++i)
+    ss << (i > 0 ? "," : "") << v[i];
+  ss << "\n";
+  return ss.str();
+}
+}  // namespace
+
+TEST(StanCallbacksCsvFormatter, matches_stream_output) {
+  std::vector<double> x{0,
+                        -1,
+                        1.0 / 3,
+                        12345678.9,
+                        1e-300,
+                        -2.5e21,
+                        std::numeric_limits<double>::infinity(),
+                        -std::numeric_limits<double>::infinity(),
+                        std::numeric_limits<double>::quiet_NaN(),
+                        std::numeric_limits<double>::denorm_min()};
+  stan::callbacks::csv_formatter formatter;
+  for (int precision : {0, 1, 2, 6, 9, 17}) {
+    std::stringstream format;
+    format << std::setprecision(precision);
+    EXPECT_EQ(stream_row(x, format), formatter.format_row(x, format))
+        << "precision " << precision;
+  }
+}
+
+TEST(StanCallbacksCsvFormatter, non_default_flags_fall_back_to_stream) {
+  std::vector<double> x{1.5, -0.25, 1e10};
+  stan::callbacks::csv_formatter formatter;
+  std::stringstream format;
+  format << std::scientific << std::setprecision(3);
+  EXPECT_EQ(stream_row(x, format), formatter.format_row(x, format));
+  format << std::fixed << std::showpos;
+  EXPECT_EQ(stream_row(x, format), formatter.format_row(x, format));
+}
+
+TEST(StanCallbacksCsvFormatter, round_trip) {
+  std::vector<double> x{0.1, 1.0 / 3, -2.5e21, 5e-324};
+  stan::callbacks::csv_formatter formatter(true);
+  std::stringstream format;
+  std::string row = formatter.format_row(x, format);
+
+  std::stringstream in(row);
+  for (double expected : x) {
+    std::string value;
+    std::getline(in, value, expected == x.back() ? '\n' : ',');
+    EXPECT_EQ(expected, std::strtod(value.c_str(), nullptr)) << value;
+  }
+  EXPECT_EQ(0, row.find("0.1,"));
+}
+
+TEST(StanCallbacksCsvFormatter, single_precision_columns) {
+  using stan::callbacks::value_precision;
+  std::vector<double> x{0.1, 0.1, 1.0 / 3, 1e-50};
+  std::vector<value_precision> precisions{
+      value_precision::float64, value_precision::float32,
+      value_precision::float32, value_precision::float32};
+  for (bool round_trip : {false, true}) {
+    stan::callbacks::csv_formatter formatter(round_trip);
+    std::stringstream format;
+    format << std::setprecision(17);
+    std::string row = formatter.format_row(x, format, precisions);
+    std::stringstream in(row);
+    std::string value;
+    std::getline(in, value, ',');
+    EXPECT_EQ(0.1, std::strtod(value.c_str(), nullptr));
+    std::getline(in, value, ',');
+    EXPECT_EQ("0.1", value);
+    std::getline(in, value, ',');
+    EXPECT_EQ("0.33333334", value);
+    std::getline(in, value, '\n');
+    EXPECT_EQ("0", value);
+  }
+  // without a precision per value every column is a double
+  stan::callbacks::csv_formatter formatter;
+  std::stringstream format;
+  std::string doubles = formatter.format_row(x, format);
+  EXPECT_EQ(doubles, formatter.format_row(x, format, {}));
+}
+
+TEST(StanCallbacksCsvFormatter, strings) {
+  stan::callbacks::csv_formatter formatter;
+  std::stringstream format;
+  EXPECT_EQ("lp__,theta\n",
+            formatter.format_row(std::vector<std::string>{"lp__", "theta"},
+                                 format));
+}
+
+TEST(StanCallbacksCsvFormatter, copies_are_independent) {
+  stan::callbacks::csv_formatter formatter(true);
+  std::stringstream format;
+  std::vector<stan::callbacks::csv_formatter> copies(2, formatter);
+  EXPECT_TRUE(copies[1].round_trip());
+  EXPECT_EQ("0.1\n", copies[0].format_row(std::vector<double>{0.1}, format));
+  EXPECT_EQ("2.5\n", copies[1].format_row(std::vector<double>{2.5}, format));
+  format.setf(std::ios_base::fixed);
+  copies[0] = stan::callbacks::csv_formatter();
+  EXPECT_EQ("1.500000\n",
+            copies[0].format_row(std::vector<double>{1.5}, format));
+}
@@ -0,0 +1,51 @@
+#include <stan/callbacks/event_tracer.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+TEST(StanCallbacksEventTracer, inactive) {
+  EXPECT_EQ(nullptr, stan::callbacks::event_tracer::active());
+  stan::callbacks::event_tracer tracer;
+  { stan::callbacks::trace_scope trace("test", "ignored"); }
+  stan::callbacks::trace_instant("test", "ignored");
+  EXPECT_EQ(0U, tracer.num_events());
+}
+
+TEST(StanCallbacksEventTracer, records_events) {
+  stan::callbacks::event_tracer tracer;
+  tracer.start();
+  EXPECT_EQ(&tracer, stan::callbacks::event_tracer::active());
+  { stan::callbacks::trace_scope trace("test", "scope", "depth", 3); }
+  std::thread other(
+      []() { stan::callbacks::trace_instant("test", "instant"); });
+  other.join();
+  tracer.stop();
+  EXPECT_EQ(nullptr, stan::callbacks::event_tracer::active());
+  { stan::callbacks::trace_scope trace("test", "ignored"); }
+  EXPECT_EQ(2U, tracer.num_events());
+
+  std::stringstream out;
+  tracer.write(out);
+  const std::string trace = out.str();
+  EXPECT_EQ(0U, trace.find("{\"traceEvents\":[\n"));
+  EXPECT_NE(std::string::npos,
+            trace.find("{\"name\":\"scope\",\"cat\":\"test\",\"ph\":\"X\""));
+  EXPECT_NE(std::string::npos,
+            trace.find(",\"pid\":1,\"tid\":0,\"args\":{\"depth\":3}}"));
+  EXPECT_NE(std::string::npos,
+            trace.find("{\"name\":\"instant\",\"cat\":\"test\",\"ph\":\"i\""));
+  EXPECT_NE(std::string::npos, trace.find(",\"s\":\"t\",\"pid\":1,\"tid\":1}"));
+  EXPECT_EQ(std::string::npos, trace.find("ignored"));
+  EXPECT_NE(std::string::npos, trace.find("\n],\"displayTimeUnit\":\"ms\"}"));
+}
+
+TEST(StanCallbacksEventTracer, new_tracer_gets_new_buffers) {
+  for (int n = 0; n < 2; ++n) {
+    stan::callbacks::event_tracer tracer;
+    tracer.start();
+    stan::callbacks::trace_instant("test", "instant");
+    EXPECT_EQ(1U, tracer.num_events());
+  }
+  EXPECT_EQ(nullptr, stan::callbacks::event_tracer::active());
+}
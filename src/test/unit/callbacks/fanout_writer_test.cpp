@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/fanout_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+class throwing_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const std::string& message) {
+    throw std::runtime_error(message);
+  }
+};
+}  // namespace
+
+TEST(StanCallbacksFanoutWriter, forwards_to_every_sink) {
+  std::stringstream ss1, ss2;
+  stan::callbacks::stream_writer writer1(ss1, "# ");
+  stan::callbacks::stream_writer writer2(ss2, "# ");
+  stan::callbacks::fanout_writer writer;
+  writer.add_sink(writer1, 2);
+  writer.add_sink(writer2);
+  EXPECT_EQ(2, writer.num_sinks());
+  EXPECT_EQ(2, writer.sink(0).capacity());
+  writer(std::vector<std::string>{"a", "b"});
+  for (int i = 0; i < 10; ++i)
+    writer(std::vector<double>{1.0 * i, 2.0 * i});
+  writer("message");
+  writer();
+  writer.flush();
+
+  std::stringstream expected;
+  expected << "a,b\n";
+  for (int i = 0; i < 10; ++i)
+    expected << i << "," << 2 * i << "\n";
+  expected << "# message\n# \n";
+  EXPECT_EQ(expected.str(), ss1.str());
+  EXPECT_EQ(expected.str(), ss2.str());
+}
+
+TEST(StanCallbacksFanoutWriter, sampled_sink) {
+  stan::test::unit::instrumented_writer all, sampled;
+  stan::callbacks::fanout_writer writer;
+  writer.add_sink(all);
+  writer.add_sink(sampled, 16, stan::callbacks::async_writer::overflow::drop,
+                  100);
+  writer(std::vector<std::string>{"a"});
+  for (int i = 0; i < 1000; ++i)
+    writer(std::vector<double>{1.0 * i});
+  writer.flush();
+  EXPECT_EQ(1000, all.call_count("vector_double"));
+  EXPECT_EQ(1, sampled.call_count("vector_string"));
+  EXPECT_EQ(10 - writer.sink(1).num_dropped(),
+            sampled.call_count("vector_double"));
+}
+
+TEST(StanCallbacksFanoutWriter, sink_exception_reaches_other_sinks) {
+  throwing_writer throwing;
+  stan::test::unit::instrumented_writer instrumented;
+  stan::callbacks::fanout_writer writer;
+  writer.add_sink(throwing);
+  writer.add_sink(instrumented);
+  writer("failure");
+  EXPECT_THROW(writer.flush(), std::runtime_error);
+  EXPECT_EQ(1, instrumented.call_count("string"));
+}
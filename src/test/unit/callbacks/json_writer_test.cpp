@@ -1,6 +1,10 @@
 #include <stan/callbacks/json_writer.hpp>
 #include <test/unit/util.hpp>
 #include <gtest/gtest.h>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <string>
 
 struct deleter_noop {
@@ -297,6 +301,40 @@ TEST_F(StanInterfaceCallbacksJsonWriter, write_empty_eigen_matrix) {
   EXPECT_EQ("\"key\":[]", out);
 }
 
+TEST_F(StanInterfaceCallbacksJsonWriter, write_large_eigen_matrix) {
+  // enough values to be written to the stream in several chunks
+  Eigen::MatrixXd x = Eigen::MatrixXd::Random(200, 300);
+  x(7, 11) = std::numeric_limits<double>::quiet_NaN();
+  x(150, 299) = -std::numeric_limits<double>::infinity();
+  writer.write("key", x);
+
+  std::stringstream expected;
+  expected << "\"key\":[";
+  for (Eigen::Index i = 0; i < x.rows(); ++i) {
+    expected << (i > 0 ? ",[" : "[");
+    for (Eigen::Index j = 0; j < x.cols(); ++j) {
+      if (j > 0)
+        expected << ",";
+      if (std::isnan(x(i, j)))
+        expected << "NaN";
+      else if (std::isinf(x(i, j)))
+        expected << "-Inf";
+      else
+        expected << x(i, j);
+    }
+    expected << "]";
+  }
+  expected << "]";
+  EXPECT_EQ(expected.str(), output_sans_whitespace(ss));
+}
+
+TEST_F(StanInterfaceCallbacksJsonWriter, write_eigen_matrix_stream_format) {
+  ss << std::fixed << std::setprecision(2);
+  Eigen::MatrixXd x{{1.0, 0.126}, {-3.5, 1e-7}};
+  writer.write("key", x);
+  EXPECT_EQ("\"key\":[[1.00,0.13],[-3.50,0.00]]", output_sans_whitespace(ss));
+}
+
 TEST_F(StanInterfaceCallbacksJsonWriter, no_op_writer) {
   std::string key("key");
   std::string value("value");
@@ -0,0 +1,72 @@
+#include <stan/callbacks/matrix_writer.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using stan::callbacks::matrix_writer;
+
+TEST(StanCallbacksMatrixWriter, fills_rows_in_order) {
+  std::vector<double> buffer(6, -1);
+  matrix_writer writer(buffer.data(), 3, 2);
+  writer("config");
+  writer(std::vector<std::string>{"lp__", "x"});
+  writer();
+  EXPECT_EQ(0, writer.num_rows_written());
+  writer(std::vector<double>{1, 2});
+  writer(std::vector<double>{3, 4});
+  EXPECT_EQ(2, writer.num_rows_written());
+  EXPECT_EQ((std::vector<double>{1, 2, 3, 4, -1, -1}), buffer);
+  EXPECT_EQ((std::vector<std::string>{"lp__", "x"}), writer.names());
+}
+
+TEST(StanCallbacksMatrixWriter, column_major_and_matrix) {
+  std::vector<double> buffer(6, -1);
+  matrix_writer writer(buffer.data(), 3, 2,
+                       matrix_writer::layout::column_major);
+  Eigen::MatrixXd values(2, 2);
+  values << 1, 3, 2, 4;
+  writer(values);
+  writer(std::vector<double>{5, 6});
+  EXPECT_EQ(3, writer.num_rows_written());
+  EXPECT_EQ((std::vector<double>{1, 3, 5, 2, 4, 6}), buffer);
+}
+
+TEST(StanCallbacksMatrixWriter, rejects_wrong_sizes) {
+  std::vector<double> buffer(2);
+  matrix_writer writer(buffer.data(), 1, 2);
+  EXPECT_THROW(writer(std::vector<std::string>{"x"}), std::invalid_argument);
+  EXPECT_THROW(writer(std::vector<double>{1, 2, 3}), std::invalid_argument);
+  writer(std::vector<double>{1, 2});
+  EXPECT_THROW(writer(std::vector<double>{1, 2}), std::out_of_range);
+  EXPECT_EQ(1, writer.num_rows_written());
+  EXPECT_THROW(matrix_writer(nullptr, 1, 1), std::invalid_argument);
+}
+
+TEST(StanCallbacksMatrixWriter, num_draws) {
+  EXPECT_EQ(1000, matrix_writer::num_draws(1000, 1000, 1, false));
+  EXPECT_EQ(2000, matrix_writer::num_draws(1000, 1000, 1, true));
+  EXPECT_EQ(4 + 4, matrix_writer::num_draws(10, 10, 3, true));
+  EXPECT_EQ(0, matrix_writer::num_draws(0, 0, 1, true));
+}
+
+TEST(StanCallbacksMatrixWriter, rows_read_while_writing) {
+  const size_t num_rows = 10000;
+  std::vector<double> buffer(num_rows * 2);
+  matrix_writer writer(buffer.data(), num_rows, 2);
+  std::thread sampler([&]() {
+    for (size_t i = 0; i < num_rows; ++i)
+      writer(std::vector<double>{1.0 * i, 2.0 * i});
+  });
+  size_t read = 0;
+  bool consistent = true;
+  while (read < num_rows) {
+    const size_t written = writer.num_rows_written();
+    for (; read < written; ++read)
+      consistent = consistent && buffer[2 * read] == read
+                   && buffer[2 * read + 1] == 2.0 * read;
+  }
+  sampler.join();
+  EXPECT_TRUE(consistent);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/multi_chain_writer.hpp>
+#include <stan/io/multi_chain_reader.hpp>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const std::string filename = "multi_chain_writer_test.mcw";
+
+void write_chain(stan::callbacks::writer& writer, std::size_t chain_id,
+                 int num_draws) {
+  writer(std::vector<std::string>{"lp__", "theta", "sigma"});
+  writer("Adaptation terminated");
+  for (int n = 0; n < num_draws; ++n)
+    writer(std::vector<double>{-1.0 * n, 100.0 * chain_id + n, 0.5 * n});
+}
+
+}  // namespace
+
+TEST(StanInterfaceCallbacksMultiChainWriter, concurrent_chains) {
+  const int num_draws = 1000;
+  {
+    stan::callbacks::multi_chain_writer writer(filename, 64);
+    auto chains = writer.chain_writers(4);
+    std::vector<std::thread> threads;
+    for (auto& chain : chains)
+      threads.emplace_back(
+          [&chain] { write_chain(chain, chain.chain_id(), num_draws); });
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  stan::io::multi_chain_reader reader(filename);
+  EXPECT_EQ((std::vector<std::string>{"lp__", "theta", "sigma"}),
+            reader.header());
+  EXPECT_EQ((std::vector<std::size_t>{1, 2, 3, 4}), reader.chain_ids());
+  for (std::size_t chain_id = 1; chain_id <= 4; ++chain_id) {
+    ASSERT_EQ(num_draws, reader.num_draws(chain_id));
+    ASSERT_EQ(1, reader.comments(chain_id).size());
+    EXPECT_EQ("Adaptation terminated", reader.comments(chain_id)[0]);
+    Eigen::MatrixXd draws = reader.read(chain_id);
+    ASSERT_EQ(num_draws, draws.rows());
+    ASSERT_EQ(3, draws.cols());
+    for (int n = 0; n < num_draws; ++n) {
+      EXPECT_FLOAT_EQ(-1.0 * n, draws(n, 0));
+      EXPECT_FLOAT_EQ(100.0 * chain_id + n, draws(n, 1));
+      EXPECT_FLOAT_EQ(0.5 * n, draws(n, 2));
+    }
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(StanInterfaceCallbacksMultiChainWriter, column_range) {
+  {
+    stan::callbacks::multi_chain_writer writer(filename, 8);
+    auto chains = writer.chain_writers(2, 3);
+    write_chain(chains[0], 3, 20);
+    write_chain(chains[1], 4, 5);
+  }
+
+  stan::io::multi_chain_reader reader(filename);
+  EXPECT_EQ((std::vector<std::size_t>{3, 4}), reader.chain_ids());
+  Eigen::MatrixXd theta = reader.read(4, 1, 1);
+  ASSERT_EQ(5, theta.rows());
+  ASSERT_EQ(1, theta.cols());
+  for (int n = 0; n < 5; ++n)
+    EXPECT_FLOAT_EQ(400.0 + n, theta(n, 0));
+
+  Eigen::MatrixXd tail = reader.read(3, 1);
+  ASSERT_EQ(20, tail.rows());
+  ASSERT_EQ(2, tail.cols());
+  Eigen::MatrixXd named = reader.read(3, {"sigma", "theta"});
+  EXPECT_EQ(tail.col(1), named.col(0));
+  EXPECT_EQ(tail.col(0), named.col(1));
+
+  EXPECT_THROW(reader.read(1), std::invalid_argument);
+  EXPECT_THROW(reader.read(3, {"mu"}), std::invalid_argument);
+  std::remove(filename.c_str());
+}
+
+TEST(StanInterfaceCallbacksMultiChainWriter, different_headers_throw) {
+  stan::callbacks::multi_chain_writer writer(filename);
+  auto chains = writer.chain_writers(2);
+  chains[0](std::vector<std::string>{"lp__", "theta"});
+  EXPECT_THROW(chains[1](std::vector<std::string>{"lp__", "mu"}),
+               std::invalid_argument);
+  EXPECT_THROW(chains[0](std::vector<double>{1, 2, 3}),
+               std::invalid_argument);
+  chains[0](std::vector<double>{1, 2});
+  EXPECT_THROW(chains[0](std::vector<std::string>{"lp__", "theta"}),
+               std::invalid_argument);
+  EXPECT_THROW(writer.chain_writers(1, 2), std::invalid_argument);
+  writer.close();
+  std::remove(filename.c_str());
+}
+
+TEST(StanInterfaceCallbacksMultiChainWriter, unclosed_file_throws) {
+  {
+    stan::callbacks::multi_chain_writer writer(filename, 4);
+    auto chains = writer.chain_writers(1);
+    write_chain(chains[0], 1, 10);
+    chains[0].flush();
+    EXPECT_THROW(stan::io::multi_chain_reader reader(filename),
+                 std::invalid_argument);
+  }
+  stan::io::multi_chain_reader reader(filename);
+  EXPECT_EQ(10, reader.num_draws(1));
+  std::remove(filename.c_str());
+  EXPECT_THROW(stan::io::multi_chain_reader reader(filename),
+               std::invalid_argument);
+}
@@ -0,0 +1,91 @@
+#include <stan/callbacks/output_schema.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+// parameters mu and beta[2, 3], generated quantity y_rep[2]
+struct schema_model {
+  void get_param_names(std::vector<std::string>& names,
+                       bool include_tparams = true,
+                       bool include_gqs = true) const {
+    names = {"mu", "beta"};
+    if (include_gqs)
+      names.push_back("y_rep");
+  }
+
+  void get_dims(std::vector<std::vector<size_t>>& dims,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dims = {{}, {2, 3}};
+    if (include_gqs)
+      dims.push_back({2});
+  }
+};
+
+class names_writer : public stan::callbacks::writer {
+ public:
+  using stan::callbacks::writer::operator();
+  void operator()(const std::vector<std::string>& names) {
+    this->names = names;
+  }
+  std::vector<std::string> names;
+};
+}  // namespace
+
+TEST(StanCallbacksOutputSchema, flatten_column_major) {
+  stan::callbacks::output_schema schema;
+  schema.add("lp__");
+  schema.add("beta", {2, 3});
+  schema.add("empty", {0, 4});
+  schema.add("z", {1});
+  EXPECT_EQ(4, schema.variables().size());
+  EXPECT_EQ(8, schema.num_columns());
+  EXPECT_EQ(6, schema.variables()[1].size());
+
+  std::vector<std::string> names{"first"};
+  schema.flatten(names);
+  EXPECT_EQ((std::vector<std::string>{"first", "lp__", "beta.1.1", "beta.2.1",
+                                      "beta.1.2", "beta.2.2", "beta.1.3",
+                                      "beta.2.3", "z.1"}),
+            names);
+}
+
+TEST(StanCallbacksOutputSchema, add_model) {
+  stan::callbacks::output_schema schema;
+  schema.add("lp__");
+  schema.add_model(schema_model(), true, false);
+  ASSERT_EQ(3, schema.variables().size());
+  EXPECT_EQ("beta", schema.variables()[2].name);
+  EXPECT_EQ(8, schema.num_columns());
+  schema.add_model(schema_model());
+  EXPECT_EQ(17, schema.num_columns());
+  EXPECT_EQ("y_rep", schema.variables().back().name);
+}
+
+TEST(StanCallbacksOutputSchema, writer_flattens_by_default) {
+  stan::callbacks::output_schema schema;
+  schema.add("a");
+  schema.add("b", {2});
+  names_writer writer;
+  EXPECT_FALSE(writer.accepts_schema());
+  writer(schema);
+  EXPECT_EQ((std::vector<std::string>{"a", "b.1", "b.2"}), writer.names);
+}
+
+TEST(StanCallbacksOutputSchema, column_precisions) {
+  using stan::callbacks::value_precision;
+  stan::callbacks::output_schema schema;
+  schema.add("lp__");
+  schema.add_model(schema_model());
+  EXPECT_FALSE(schema.reduced_precision());
+  schema.set_precision(
+      [](const std::string& name) { return name == "y_rep"; },
+      value_precision::float32);
+  EXPECT_TRUE(schema.reduced_precision());
+  std::vector<value_precision> precisions = schema.column_precisions();
+  ASSERT_EQ(10, precisions.size());
+  EXPECT_EQ(value_precision::float64, precisions[7]);
+  EXPECT_EQ(value_precision::float32, precisions[8]);
+  EXPECT_EQ(value_precision::float32, precisions[9]);
+}
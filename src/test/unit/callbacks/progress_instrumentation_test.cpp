@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/callbacks/progress_instrumentation.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+stan::callbacks::transition_stats make_stats(std::size_t chain_id,
+                                             int iteration, int tree_depth) {
+  stan::callbacks::transition_stats stats;
+  stats.chain_id = chain_id;
+  stats.iteration = iteration;
+  stats.num_iterations = 10;
+  stats.warmup = iteration <= 5;
+  stats.transition_time = 0.4;
+  stats.write_time = 0.1;
+  stats.num_gradients = 8;
+  stats.num_leapfrog = 7;
+  stats.tree_depth = tree_depth;
+  return stats;
+}
+}  // namespace
+
+TEST(StanCallbacks, progress_instrumentation_rates) {
+  stan::callbacks::progress_instrumentation progress(4);
+  progress(make_stats(1, 1, 3));
+  progress(make_stats(1, 2, 2));
+  progress(make_stats(1, 3, 3));
+  EXPECT_EQ(0, progress.last().iteration);
+  progress(make_stats(1, 4, 0));
+
+  const stan::callbacks::progress& p = progress.last();
+  EXPECT_EQ(1, p.chain_id);
+  EXPECT_EQ(4, p.iteration);
+  EXPECT_EQ(10, p.num_iterations);
+  EXPECT_TRUE(p.warmup);
+  EXPECT_FLOAT_EQ(2, p.iterations_per_second);
+  EXPECT_FLOAT_EQ(14, p.leapfrogs_per_second);
+  EXPECT_FLOAT_EQ(16, p.gradients_per_second);
+  EXPECT_FLOAT_EQ(3, p.eta);
+  EXPECT_EQ((std::vector<int>{1, 0, 1, 2}), p.tree_depths);
+}
+
+TEST(StanCallbacks, progress_instrumentation_window) {
+  stan::callbacks::progress_instrumentation progress(4);
+  for (int i = 1; i <= 4; ++i)
+    progress(make_stats(1, i, 5));
+  // the next window is slower and shallower
+  for (int i = 5; i <= 8; ++i) {
+    stan::callbacks::transition_stats stats = make_stats(1, i, 1);
+    stats.transition_time = 0.9;
+    progress(stats);
+  }
+  EXPECT_EQ(8, progress.last().iteration);
+  EXPECT_FALSE(progress.last().warmup);
+  EXPECT_FLOAT_EQ(1, progress.last().iterations_per_second);
+  EXPECT_FLOAT_EQ(2, progress.last().eta);
+  EXPECT_EQ((std::vector<int>{0, 4}), progress.last().tree_depths);
+
+  // the last iteration always ends a window
+  progress(make_stats(1, 9, 1));
+  EXPECT_EQ(8, progress.last().iteration);
+  progress(make_stats(1, 10, 1));
+  EXPECT_EQ(10, progress.last().iteration);
+  EXPECT_FLOAT_EQ(0, progress.last().eta);
+}
+
+TEST(StanCallbacks, progress_instrumentation_no_tree) {
+  stan::callbacks::progress_instrumentation progress(1);
+  stan::callbacks::transition_stats stats;
+  stats.iteration = 1;
+  stats.num_iterations = 3;
+  stats.transition_time = 0.5;
+  progress(stats);
+  EXPECT_FLOAT_EQ(2, progress.last().iterations_per_second);
+  EXPECT_FLOAT_EQ(0, progress.last().leapfrogs_per_second);
+  EXPECT_TRUE(progress.last().tree_depths.empty());
+  EXPECT_THROW(stan::callbacks::progress_instrumentation(0),
+               std::invalid_argument);
+}
+
+TEST(StanCallbacks, progress_instrumentation_write) {
+  std::stringstream ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss)};
+  stan::callbacks::progress_instrumentation progress(2, &writer);
+  progress(make_stats(2, 1, 1));
+  EXPECT_TRUE(ss.str().empty());
+  progress(make_stats(2, 2, 1));
+  std::string out = ss.str();
+  out.erase(std::remove_if(out.begin(), out.end(), ::isspace), out.end());
+  EXPECT_NE(std::string::npos, out.find("\"chain_id\":2"));
+  EXPECT_NE(std::string::npos, out.find("\"iteration\":2"));
+  EXPECT_NE(std::string::npos, out.find("\"iterations_per_second\":2"));
+  EXPECT_NE(std::string::npos, out.find("\"eta\":4"));
+  EXPECT_NE(std::string::npos, out.find("\"tree_depths\":[0,2]"));
+}
+
+TEST(StanCallbacks, progress_board_aggregates_chains) {
+  stan::callbacks::progress_board board(3);
+  EXPECT_TRUE(std::isnan(board.eta()));
+
+  std::vector<std::thread> threads;
+  for (std::size_t chain = 1; chain <= 3; ++chain)
+    threads.emplace_back([&board, chain] {
+      stan::callbacks::progress_instrumentation progress(2, nullptr, &board);
+      for (int i = 1; i <= 2 * chain; ++i)
+        progress(make_stats(chain, i, 1));
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(3, board.num_chains());
+  EXPECT_FLOAT_EQ(12.0 / 30, board.fraction_done());
+  EXPECT_FLOAT_EQ(6, board.iterations_per_second());
+  EXPECT_FLOAT_EQ(42, board.leapfrogs_per_second());
+  EXPECT_FLOAT_EQ(48, board.gradients_per_second());
+  EXPECT_FLOAT_EQ(4, board.eta());
+
+  stan::callbacks::progress p;
+  p.chain_id = 4;
+  EXPECT_THROW(board.publish(p), std::out_of_range);
+}
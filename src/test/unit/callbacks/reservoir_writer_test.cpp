@@ -0,0 +1,89 @@
+#include <stan/callbacks/reservoir_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using reservoir = stan::callbacks::reservoir_writer<stan::rng_t>;
+
+TEST(StanCallbacksReservoirWriter, keeps_every_draw_below_capacity) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer output(ss, "# ");
+  reservoir writer(output, 10, stan::services::util::create_rng(3, 1));
+  writer("config");
+  writer(std::vector<std::string>{"lp__", "x"});
+  for (int i = 0; i < 3; ++i)
+    writer(std::vector<double>{0, 1.0 * i});
+  EXPECT_EQ("# config\n", ss.str());
+  writer.write_draws();
+  EXPECT_EQ("# config\nlp__,x\n0,0\n0,1\n0,2\n", ss.str());
+}
+
+TEST(StanCallbacksReservoirWriter, reservoir_is_uniform) {
+  const int num_runs = 2000;
+  const int num_draws = 20;
+  std::vector<int> counts(num_draws, 0);
+  for (int run = 0; run < num_runs; ++run) {
+    stan::test::unit::instrumented_writer output;
+    reservoir writer(output, 5,
+                     stan::services::util::create_rng(run + 1, 1));
+    writer(std::vector<std::string>{"x"});
+    for (int i = 0; i < num_draws; ++i)
+      writer(std::vector<double>{1.0 * i});
+    EXPECT_EQ(5, writer.size());
+    writer.write_draws();
+    std::vector<std::vector<double>> draws = output.vector_double_values();
+    ASSERT_EQ(5, draws.size());
+    for (size_t k = 0; k < draws.size(); ++k) {
+      if (k > 0)
+        EXPECT_LT(draws[k - 1][0], draws[k][0]);
+      ++counts[static_cast<int>(draws[k][0])];
+    }
+  }
+  // each draw is kept with probability 1/4
+  for (int c : counts)
+    EXPECT_NEAR(num_runs / 4.0, c, 75);
+}
+
+TEST(StanCallbacksReservoirWriter, thin_doubles_stride) {
+  stan::test::unit::instrumented_writer output;
+  reservoir writer(output, 4, stan::services::util::create_rng(1, 1),
+                   reservoir::policy::thin);
+  writer(std::vector<std::string>{"x"});
+  for (int i = 0; i < 10; ++i)
+    writer(std::vector<double>{1.0 * i});
+  EXPECT_EQ(10, writer.num_draws());
+  EXPECT_EQ(4, writer.stride());
+  writer.write_draws();
+  std::vector<std::vector<double>> draws = output.vector_double_values();
+  ASSERT_EQ(3, draws.size());
+  EXPECT_EQ(0, draws[0][0]);
+  EXPECT_EQ(4, draws[1][0]);
+  EXPECT_EQ(8, draws[2][0]);
+}
+
+TEST(StanCallbacksReservoirWriter, warmup_and_checkpoints) {
+  std::stringstream ss, checkpoint;
+  stan::callbacks::stream_writer output(ss), checkpoint_writer(checkpoint);
+  reservoir writer(output, 2, stan::services::util::create_rng(1, 1),
+                   reservoir::policy::thin);
+  writer(std::vector<std::string>{"x"});
+  Eigen::MatrixXd warmup(1, 3);
+  warmup << -1, -2, -3;
+  writer(warmup);
+  writer("Adaptation terminated");
+  EXPECT_EQ(0, writer.num_draws());
+  writer(std::vector<double>{5});
+  writer.write_draws(checkpoint_writer);
+  EXPECT_EQ("x\n5\n", checkpoint.str());
+  writer(std::vector<double>{6});
+  writer.write_draws();
+  EXPECT_EQ("Adaptation terminated\nx\n5\n6\n", ss.str());
+
+  EXPECT_THROW(
+      reservoir(output, 0, stan::services::util::create_rng(1, 1)),
+      std::invalid_argument);
+}
@@ -125,3 +125,17 @@ TEST_F(StanInterfaceCallbacksStreamLogger, fatal_stringstream) {
   EXPECT_EQ("", warn.str());
   EXPECT_EQ("", error.str());
 }
+
+TEST_F(StanInterfaceCallbacksStreamLogger, min_level) {
+  EXPECT_TRUE(logger.is_enabled(stan::callbacks::log_level::debug));
+  stan::callbacks::stream_logger warn_logger(
+      debug, info, warn, error, fatal, stan::callbacks::log_level::warn);
+  EXPECT_FALSE(warn_logger.is_enabled(stan::callbacks::log_level::info));
+  EXPECT_TRUE(warn_logger.is_enabled(stan::callbacks::log_level::error));
+  warn_logger.debug(message1);
+  warn_logger.info(message2);
+  warn_logger.warn(message1);
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ(message1 + "\n", warn.str());
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <boost/lexical_cast.hpp>
 #include <stan/callbacks/stream_writer.hpp>
+#include <iomanip>
 
 class StanInterfaceCallbacksStreamWriter : public ::testing::Test {
  public:
@@ -47,3 +48,40 @@ TEST_F(StanInterfaceCallbacksStreamWriter, string) {
   EXPECT_NO_THROW(writer("message"));
   EXPECT_EQ("message\n", ss.str());
 }
+
+TEST_F(StanInterfaceCallbacksStreamWriter, double_vector_precision) {
+  ss << std::setprecision(3);
+  std::vector<double> x{1.23456789, -2.3456789e-7, 345678.91};
+  EXPECT_NO_THROW(writer(x));
+  EXPECT_EQ("1.23,-2.35e-07,3.46e+05\n", ss.str());
+}
+
+TEST_F(StanInterfaceCallbacksStreamWriter, double_vector_round_trip) {
+  stan::callbacks::stream_writer round_trip_writer(ss, "", true);
+  std::vector<double> x{0.1, 1.0 / 3, 1e21};
+  EXPECT_NO_THROW(round_trip_writer(x));
+  EXPECT_EQ("0.1,0.3333333333333333,1e+21\n", ss.str());
+}
+
+TEST_F(StanInterfaceCallbacksStreamWriter, single_precision_schema) {
+  stan::callbacks::output_schema schema;
+  schema.add("lp__");
+  schema.add("y_rep", {2}, stan::callbacks::value_precision::float32);
+  ss << std::setprecision(17);
+  writer(schema);
+  writer(std::vector<double>{0.1, 0.1, 1.0 / 3});
+  EXPECT_EQ("lp__,y_rep.1,y_rep.2\n0.10000000000000001,0.1,0.33333334\n",
+            ss.str());
+  ss.str(std::string());
+  writer(std::vector<std::string>{"lp__", "a", "b"});
+  writer(std::vector<double>{0.1, 0.1, 0.1});
+  EXPECT_EQ("lp__,a,b\n0.10000000000000001,0.10000000000000001,"
+            "0.10000000000000001\n",
+            ss.str());
+}
+
+TEST_F(StanInterfaceCallbacksStreamWriter, flush) {
+  EXPECT_NO_THROW(writer("message"));
+  EXPECT_NO_THROW(writer.flush());
+  EXPECT_EQ("message\n", ss.str());
+}
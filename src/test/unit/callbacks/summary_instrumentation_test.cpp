@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/callbacks/summary_instrumentation.hpp>
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+stan::callbacks::transition_stats make_stats(int iteration, bool warmup,
+                                             double transition_time) {
+  stan::callbacks::transition_stats stats;
+  stats.iteration = iteration;
+  stats.warmup = warmup;
+  stats.transition_time = transition_time;
+  stats.gradient_time = 0.5 * transition_time;
+  stats.write_time = 0.25;
+  stats.num_gradients = 3;
+  stats.ad_stack_size = iteration;
+  stats.bytes_allocated = 8;
+  stats.ad_arena_bytes = 64 * iteration;
+  stats.sampler_bytes = 100;
+  return stats;
+}
+}  // namespace
+
+TEST(StanCallbacks, instrumentation_op) {
+  stan::callbacks::instrumentation instrumentation;
+  stan::callbacks::transition_stats stats;
+  EXPECT_NO_THROW(instrumentation(stats));
+}
+
+TEST(StanCallbacks, summary_instrumentation_phases) {
+  stan::callbacks::summary_instrumentation summary;
+  summary(make_stats(1, true, 2));
+  summary(make_stats(2, true, 4));
+  summary(make_stats(3, false, 1));
+
+  const auto& warmup = summary.warmup();
+  EXPECT_EQ(2, warmup.num_transitions);
+  EXPECT_FLOAT_EQ(6, warmup.transition_time);
+  EXPECT_FLOAT_EQ(3, warmup.gradient_time);
+  EXPECT_FLOAT_EQ(3, warmup.overhead_time());
+  EXPECT_FLOAT_EQ(0.5, warmup.write_time);
+  EXPECT_EQ(6, warmup.num_gradients);
+  EXPECT_EQ(2, warmup.max_ad_stack_size);
+  EXPECT_EQ(16, warmup.bytes_allocated);
+  EXPECT_EQ(128, warmup.max_ad_arena_bytes);
+  EXPECT_EQ(100, warmup.max_sampler_bytes);
+  EXPECT_FLOAT_EQ(4, warmup.max_transition_time);
+  EXPECT_EQ(2, warmup.slowest_iteration);
+
+  const auto& sampling = summary.sampling();
+  EXPECT_EQ(1, sampling.num_transitions);
+  EXPECT_FLOAT_EQ(1, sampling.transition_time);
+  EXPECT_EQ(3, sampling.slowest_iteration);
+}
+
+TEST(StanCallbacks, summary_instrumentation_write) {
+  stan::callbacks::summary_instrumentation summary;
+  summary(make_stats(1, true, 2));
+  std::stringstream ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss)};
+  summary.write(writer);
+  std::string out = ss.str();
+  out.erase(std::remove_if(out.begin(), out.end(), ::isspace), out.end());
+  EXPECT_NE(std::string::npos, out.find("\"warmup\""));
+  EXPECT_NE(std::string::npos, out.find("\"sampling\""));
+  EXPECT_NE(std::string::npos, out.find("\"num_transitions\":1"));
+  EXPECT_NE(std::string::npos, out.find("\"slowest_iteration\":1"));
+  EXPECT_NE(std::string::npos, out.find("\"max_ad_arena_bytes\":64"));
+  EXPECT_NE(std::string::npos, out.find("\"max_sampler_bytes\":100"));
+}
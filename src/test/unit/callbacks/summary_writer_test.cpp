@@ -0,0 +1,67 @@
+#include <stan/callbacks/summary_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(StanCallbacksSummaryWriter, writes_only_comments_and_summary) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer output(ss, "# ");
+  stan::callbacks::summary_writer writer(output, {0.5}, false);
+  writer("model = normal");
+  writer(std::vector<std::string>{"lp__", "x"});
+  for (int i = 0; i < 10; ++i)
+    writer(std::vector<double>{100.0, 100.0 * i});
+  writer("Adaptation terminated");
+  for (int i = 1; i <= 5; ++i)
+    writer(std::vector<double>{-1.0, 1.0 * i});
+  writer();
+  EXPECT_EQ(5, writer.diagnostics().num_draws());
+
+  writer.write_summary();
+  EXPECT_EQ(
+      "# model = normal\n"
+      "# Adaptation terminated\n"
+      "# \n"
+      "# Summary of 5 draws; rows: Mean, StdDev, 50%\n"
+      "lp__,x\n"
+      "-1,3\n"
+      "0,1.58114\n"
+      "-1,3\n",
+      ss.str());
+}
+
+TEST(StanCallbacksSummaryWriter, matrix_columns_are_draws) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer output(ss);
+  stan::callbacks::summary_writer writer(output);
+  writer(std::vector<std::string>{"a", "b"});
+  Eigen::MatrixXd draws(2, 3);
+  draws << 1, 2, 3, 10, 20, 30;
+  writer(draws);
+  EXPECT_EQ(3, writer.diagnostics().num_draws());
+  EXPECT_FLOAT_EQ(2, writer.diagnostics().mean(0));
+  EXPECT_FLOAT_EQ(20, writer.diagnostics().mean(1));
+  EXPECT_FLOAT_EQ(10, writer.diagnostics().sd(1));
+}
+
+TEST(StanCallbacksSummaryWriter, summary_reads_as_draws) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer output(ss, "# ");
+  stan::callbacks::summary_writer writer(output, {0.05, 0.95}, true, 2);
+  writer(std::vector<std::string>{"lp__", "theta.1", "theta.2"});
+  for (int i = 0; i < 100; ++i)
+    writer(std::vector<double>{-0.5 * i, 1.0 * (i % 7), 1.0 * (i % 3)});
+  writer.write_summary();
+
+  std::stringstream out;
+  stan::io::stan_csv csv = stan::io::stan_csv_reader::parse(ss, &out);
+  ASSERT_EQ(3, csv.header.size());
+  EXPECT_EQ("theta[2]", csv.header[2]);
+  ASSERT_EQ(5, csv.samples.rows());
+  EXPECT_FLOAT_EQ(-24.75, csv.samples(0, 0));
+  EXPECT_NEAR(1, csv.samples(0, 2), 0.02);
+  EXPECT_GT(csv.samples(4, 1), 0);
+}
@@ -48,3 +48,13 @@ TEST_F(StanCallbacksTeeWriter, message) {
   EXPECT_EQ(1, writer1.N);
   EXPECT_EQ(1, writer2.N);
 }
+
+TEST_F(StanCallbacksTeeWriter, schema) {
+  stan::callbacks::output_schema schema;
+  schema.add("theta", {2});
+
+  EXPECT_FALSE(tee_writer.accepts_schema());
+  tee_writer(schema);
+  EXPECT_EQ(1, writer1.N);
+  EXPECT_EQ(1, writer2.N);
+}
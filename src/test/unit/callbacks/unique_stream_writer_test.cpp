@@ -66,3 +66,12 @@ TEST_F(StanInterfaceCallbacksStreamWriter, string) {
   EXPECT_NO_THROW(writer("message"));
   EXPECT_EQ("message\n", ss.str());
 }
+
+TEST_F(StanInterfaceCallbacksStreamWriter, double_vector_round_trip) {
+  stan::callbacks::unique_stream_writer<std::stringstream, deleter_noop>
+      round_trip_writer(std::unique_ptr<std::stringstream, deleter_noop>(&ss),
+                        "", true);
+  std::vector<double> x{0.1, 1.0 / 3, 1e21};
+  EXPECT_NO_THROW(round_trip_writer(x));
+  EXPECT_EQ("0.1,0.3333333333333333,1e+21\n", ss.str());
+}
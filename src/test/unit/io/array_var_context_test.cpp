@@ -307,3 +307,32 @@ TEST(array_var_context, ctor_complex) {
   std::vector<std::complex<double>> eta;
   EXPECT_EQ(eta, avc.vals_c("eta"));
 }
+
+TEST(array_var_context, views) {
+  std::vector<std::string> names_r{"alpha"};
+  std::vector<double> vals_r{1.5, 2.5, 3.5};
+  std::vector<std::vector<size_t>> dims_r{{3}};
+  std::vector<std::string> names_i{"n"};
+  std::vector<int> vals_i{4, 5};
+  std::vector<std::vector<size_t>> dims_i{{2}};
+  stan::io::array_var_context avc(names_r, vals_r, dims_r, names_i, vals_i,
+                                  dims_i);
+
+  stan::io::values_view<double> alpha = avc.view_r("alpha");
+  EXPECT_FALSE(alpha.owns_data());
+  EXPECT_EQ(vals_r, alpha.to_vector());
+  // views of the same variable refer to the same storage
+  EXPECT_EQ(alpha.data(), avc.view_r("alpha").data());
+
+  stan::io::values_view<int> n = avc.view_i("n");
+  EXPECT_FALSE(n.owns_data());
+  EXPECT_EQ(vals_i, n.to_vector());
+
+  // integers read as doubles have to be converted
+  stan::io::values_view<double> n_r = avc.view_r("n");
+  EXPECT_TRUE(n_r.owns_data());
+  EXPECT_EQ(std::vector<double>({4, 5}), n_r.to_vector());
+
+  EXPECT_TRUE(avc.view_r("foo").empty());
+  EXPECT_TRUE(avc.view_i("alpha").empty());
+}
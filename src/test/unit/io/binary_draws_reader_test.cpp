@@ -0,0 +1,143 @@
+#include <stan/io/binary_draws_reader.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class StanIoBinaryDrawsReader : public testing::Test {
+ public:
+  void write_draws(size_t chunk_size) {
+    stan::callbacks::binary_writer writer(ss, chunk_size);
+    writer(std::vector<std::string>{"lp__", "a", "b"});
+    for (int i = 0; i < 5; ++i)
+      writer(std::vector<double>{-1.0 * i, 0.5 * i, 2.0 * i});
+    writer("Elapsed Time: 0.1 seconds");
+    writer();
+  }
+
+  std::stringstream ss;
+};
+
+TEST_F(StanIoBinaryDrawsReader, round_trip) {
+  write_draws(2);
+  stan::io::binary_draws data = stan::io::binary_draws_reader::parse(ss);
+
+  ASSERT_EQ(3, data.header.size());
+  EXPECT_EQ("lp__", data.header[0]);
+  EXPECT_EQ("b", data.header[2]);
+  ASSERT_EQ(5, data.samples.rows());
+  ASSERT_EQ(3, data.samples.cols());
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(-1.0 * i, data.samples(i, 0));
+    EXPECT_EQ(0.5 * i, data.samples(i, 1));
+    EXPECT_EQ(2.0 * i, data.samples(i, 2));
+  }
+  ASSERT_EQ(2, data.comments.size());
+  EXPECT_EQ("Elapsed Time: 0.1 seconds", data.comments[0]);
+  EXPECT_EQ("", data.comments[1]);
+  EXPECT_FALSE(data.truncated);
+}
+
+TEST_F(StanIoBinaryDrawsReader, truncated) {
+  write_draws(2);
+  std::string contents = ss.str();
+  // magic, header record, two full chunks of two draws, part of the third
+  std::stringstream in(contents.substr(0, 8 + 39 + 2 * 65 + 20));
+  stan::io::binary_draws data = stan::io::binary_draws_reader::parse(in);
+
+  EXPECT_EQ(3, data.header.size());
+  EXPECT_EQ(4, data.samples.rows());
+  EXPECT_EQ(3, data.samples.cols());
+  EXPECT_EQ(2.0 * 3, data.samples(3, 2));
+  EXPECT_TRUE(data.comments.empty());
+  EXPECT_TRUE(data.truncated);
+}
+
+TEST_F(StanIoBinaryDrawsReader, not_binary) {
+  std::stringstream in("lp__,a,b\n1,2,3\n");
+  EXPECT_THROW(stan::io::binary_draws_reader::parse(in),
+               std::invalid_argument);
+}
+
+TEST_F(StanIoBinaryDrawsReader, schema_header) {
+  {
+    stan::callbacks::binary_writer writer(ss);
+    EXPECT_TRUE(writer.accepts_schema());
+    stan::callbacks::output_schema schema;
+    schema.add("lp__");
+    schema.add("theta", {2, 2});
+    writer(schema);
+    writer(std::vector<double>{1, 2, 3, 4, 5});
+  }
+  stan::io::binary_draws data = stan::io::binary_draws_reader::parse(ss);
+  EXPECT_EQ((std::vector<std::string>{"lp__", "theta.1.1", "theta.2.1",
+                                      "theta.1.2", "theta.2.2"}),
+            data.header);
+  ASSERT_EQ(2, data.schema.variables().size());
+  EXPECT_EQ((std::vector<size_t>{2, 2}), data.schema.variables()[1].dims);
+  ASSERT_EQ(5, data.samples.cols());
+  EXPECT_EQ(5, data.samples(0, 4));
+  EXPECT_FALSE(data.truncated);
+}
+
+TEST_F(StanIoBinaryDrawsReader, truncated_schema_header) {
+  {
+    stan::callbacks::binary_writer writer(ss);
+    stan::callbacks::output_schema schema;
+    schema.add("theta", {3});
+    writer(schema);
+  }
+  std::string bytes = ss.str();
+  std::stringstream truncated(bytes.substr(0, bytes.size() - 4));
+  stan::io::binary_draws data = stan::io::binary_draws_reader::parse(truncated);
+  EXPECT_TRUE(data.truncated);
+  EXPECT_TRUE(data.header.empty());
+}
+
+TEST_F(StanIoBinaryDrawsReader, single_precision_columns) {
+  {
+    stan::callbacks::binary_writer writer(ss, 2);
+    stan::callbacks::output_schema schema;
+    schema.add("lp__");
+    schema.add("y_rep", {2}, stan::callbacks::value_precision::float32);
+    writer(schema);
+    for (int i = 0; i < 3; ++i)
+      writer(std::vector<double>{0.1 * i, 1.0 / 3 + i, -0.1 * i});
+  }
+  // magic, typed schema, then two typed chunks of 2 and 1 draws with a
+  // double and two floats each
+  EXPECT_EQ(8 + 60 + (20 + 2 * 16) + (20 + 16), ss.str().size());
+  stan::io::binary_draws data = stan::io::binary_draws_reader::parse(ss);
+  EXPECT_EQ((std::vector<std::string>{"lp__", "y_rep.1", "y_rep.2"}),
+            data.header);
+  ASSERT_EQ(2, data.schema.variables().size());
+  EXPECT_EQ(stan::callbacks::value_precision::float32,
+            data.schema.variables()[1].precision);
+  ASSERT_EQ(3, data.samples.rows());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(0.1 * i, data.samples(i, 0));
+    EXPECT_EQ(static_cast<float>(1.0 / 3 + i), data.samples(i, 1));
+    EXPECT_EQ(static_cast<float>(-0.1 * i), data.samples(i, 2));
+  }
+  EXPECT_FALSE(data.truncated);
+}
+
+TEST_F(StanIoBinaryDrawsReader, into_chains_buffer) {
+  write_draws(2);
+  stan::mcmc::chains_buffer draws(3);
+  stan::io::binary_draws data
+      = stan::io::binary_draws_reader::parse(ss, draws);
+  EXPECT_EQ(3, data.header.size());
+  EXPECT_EQ(0, data.samples.size());
+  EXPECT_EQ(2, data.comments.size());
+  ASSERT_EQ(1, draws.num_chains());
+  ASSERT_EQ(5, draws.num_draws(0));
+  for (int i = 0; i < 5; ++i)
+    EXPECT_EQ(2.0 * i, draws.draws(2, 0)(i));
+
+  ss.str("");
+  ss.clear();
+  write_draws(2);
+  stan::mcmc::chains_buffer wrong(2);
+  EXPECT_THROW(stan::io::binary_draws_reader::parse(ss, wrong),
+               std::invalid_argument);
+  EXPECT_EQ(0, wrong.num_chains());
+}
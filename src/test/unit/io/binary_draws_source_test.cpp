@@ -0,0 +1,59 @@
+#include <stan/io/binary_draws_source.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+class StanIoBinaryDrawsSource : public testing::Test {
+ public:
+  void SetUp() {
+    stan::callbacks::binary_writer writer(ss, 2);
+    writer("config");
+    writer(std::vector<std::string>{"lp__", "a", "b"});
+    for (int i = 0; i < 5; ++i)
+      writer(std::vector<double>{-1.0 * i, 0.5 * i, 2.0 * i});
+    writer("Elapsed Time: 0.1 seconds");
+  }
+
+  std::stringstream ss;
+};
+
+TEST_F(StanIoBinaryDrawsSource, reads_across_records) {
+  stan::io::binary_draws_source source(ss);
+  EXPECT_EQ(3, source.num_cols());
+  EXPECT_EQ(3, source.data().header.size());
+  Eigen::MatrixXd chunk;
+  ASSERT_EQ(3, source.read(3, chunk));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(2.0 * i, chunk(i, 2));
+  ASSERT_EQ(2, source.read(3, chunk));
+  EXPECT_EQ(-4, chunk(1, 0));
+  EXPECT_EQ(0, source.read(3, chunk));
+  EXPECT_EQ(2, source.data().comments.size());
+}
+
+TEST_F(StanIoBinaryDrawsSource, selected_columns) {
+  stan::io::binary_draws_source source(ss, {"b"});
+  EXPECT_EQ(1, source.num_cols());
+  Eigen::MatrixXd chunk;
+  ASSERT_EQ(5, source.read(10, chunk));
+  EXPECT_EQ(8, chunk(4, 0));
+
+  ss.clear();
+  ss.seekg(0);
+  EXPECT_THROW(stan::io::binary_draws_source(ss, {"c"}),
+               std::invalid_argument);
+}
+
+TEST(StanIoBinaryDrawsSourceEmpty, no_draws) {
+  std::stringstream ss;
+  {
+    stan::callbacks::binary_writer writer(ss);
+    writer(std::vector<std::string>{"a"});
+  }
+  stan::io::binary_draws_source source(ss);
+  EXPECT_EQ(1, source.num_cols());
+  Eigen::MatrixXd chunk;
+  EXPECT_EQ(0, source.read(10, chunk));
+  std::stringstream text("a,b\n");
+  EXPECT_THROW(stan::io::binary_draws_source{text}, std::invalid_argument);
+}
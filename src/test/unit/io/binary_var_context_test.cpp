@@ -0,0 +1,111 @@
+#include <stan/io/binary_var_context.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <complex>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string filename = "binary_var_context_test.bin";
+
+stan::io::array_var_context make_context() {
+  std::vector<std::string> names_r{"y", "x", "sigma", "empty"};
+  std::vector<double> vals_r{1.5, 2.5, 3.5, 1, 2, 3, 4, 5, 6, 0.25};
+  std::vector<std::vector<size_t>> dims_r{{3}, {3, 2}, {}, {0}};
+  std::vector<std::string> names_i{"N", "g"};
+  std::vector<int> vals_i{3, 1, 2, 2};
+  std::vector<std::vector<size_t>> dims_i{{}, {3}};
+  return stan::io::array_var_context(names_r, vals_r, dims_r, names_i, vals_i,
+                                     dims_i);
+}
+
+void write_file(const stan::io::var_context& context) {
+  std::ofstream out(filename, std::ios::binary);
+  stan::io::binary_var_context::write(out, context);
+}
+}  // namespace
+
+TEST(binary_var_context, round_trip) {
+  stan::io::array_var_context avc = make_context();
+  write_file(avc);
+  stan::io::binary_var_context bvc(filename);
+
+  std::vector<std::string> names;
+  bvc.names_r(names);
+  EXPECT_EQ(std::vector<std::string>({"empty", "sigma", "x", "y"}), names);
+  bvc.names_i(names);
+  EXPECT_EQ(std::vector<std::string>({"N", "g"}), names);
+
+  for (const std::string name : {"y", "x", "sigma", "empty", "N", "g"}) {
+    EXPECT_TRUE(bvc.contains_r(name)) << name;
+    EXPECT_EQ(avc.vals_r(name), bvc.vals_r(name)) << name;
+    EXPECT_EQ(avc.dims_r(name), bvc.dims_r(name)) << name;
+  }
+  for (const std::string name : {"N", "g"}) {
+    EXPECT_TRUE(bvc.contains_i(name)) << name;
+    EXPECT_EQ(avc.vals_i(name), bvc.vals_i(name)) << name;
+    EXPECT_EQ(avc.dims_i(name), bvc.dims_i(name)) << name;
+  }
+  EXPECT_FALSE(bvc.contains_i("y"));
+  EXPECT_FALSE(bvc.contains_r("z"));
+  EXPECT_TRUE(bvc.vals_r("z").empty());
+  EXPECT_TRUE(bvc.vals_i("y").empty());
+
+  // real and integer views refer to the mapping
+  stan::io::values_view<double> x = bvc.view_r("x");
+  EXPECT_FALSE(x.owns_data());
+  EXPECT_EQ(0U, reinterpret_cast<std::uintptr_t>(x.data()) % 8);
+  EXPECT_EQ(avc.vals_r("x"), x.to_vector());
+  stan::io::values_view<int> g = bvc.view_i("g");
+  EXPECT_FALSE(g.owns_data());
+  EXPECT_EQ(avc.vals_i("g"), g.to_vector());
+  EXPECT_TRUE(bvc.view_r("g").owns_data());
+
+  EXPECT_NO_THROW(bvc.validate_dims("data initialization", "x", "matrix",
+                                    std::vector<size_t>{3, 2}));
+  EXPECT_THROW(bvc.validate_dims("data initialization", "x", "matrix",
+                                 std::vector<size_t>{2, 3}),
+               std::runtime_error);
+}
+
+TEST(binary_var_context, complex) {
+  // the last index holds the real and imaginary parts
+  std::vector<std::string> names{"z"};
+  std::vector<double> vals{1, 2, 10, 20};
+  std::vector<std::vector<size_t>> dims{{2, 2}};
+  stan::io::array_var_context avc(names, vals, dims);
+  write_file(avc);
+  stan::io::binary_var_context bvc(filename);
+  std::vector<std::complex<double>> expected{{1, 10}, {2, 20}};
+  EXPECT_EQ(expected, bvc.vals_c("z"));
+}
+
+TEST(binary_var_context, invalid_files) {
+  EXPECT_THROW(stan::io::binary_var_context("no_such_file.bin"),
+               std::invalid_argument);
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << "STANDRW1 not a data file";
+  }
+  EXPECT_THROW(stan::io::binary_var_context bvc(filename),
+               std::invalid_argument);
+
+  // truncating a file anywhere makes it invalid
+  stan::io::array_var_context avc = make_context();
+  std::stringstream full;
+  stan::io::binary_var_context::write(full, avc);
+  const std::string contents = full.str();
+  for (size_t size : {size_t(4), size_t(20), contents.size() - 1}) {
+    {
+      std::ofstream out(filename, std::ios::binary);
+      out.write(contents.data(), size);
+    }
+    EXPECT_THROW(stan::io::binary_var_context bvc(filename),
+                 std::invalid_argument)
+        << size;
+  }
+}
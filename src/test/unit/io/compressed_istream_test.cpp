@@ -0,0 +1,111 @@
+#include <stan/io/compressed_istream.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+template <typename Codec>
+std::string compress(const std::string& text, size_t frame_size,
+                     size_t num_threads) {
+  std::stringstream ss;
+  stan::callbacks::compressed_ostream<Codec> out(ss, frame_size,
+                                                 num_threads);
+  out << text;
+  out.close();
+  return ss.str();
+}
+
+template <typename Codec>
+std::string decompress(const std::string& compressed) {
+  std::stringstream ss(compressed);
+  stan::io::compressed_istream<Codec> in(ss);
+  std::stringstream out;
+  out << in.rdbuf();
+  return out.str();
+}
+
+std::string csv_text() {
+  std::stringstream ss;
+  stan::callbacks::stream_writer writer(ss, "# ");
+  writer("model = example");
+  writer(std::vector<std::string>{"lp__", "a", "b"});
+  for (int i = 0; i < 2000; ++i)
+    writer(std::vector<double>{-0.25 * i, 1.0 * i, 1.0 / (i + 1)});
+  return ss.str();
+}
+}  // namespace
+
+TEST(StanIoCompressedIstream, round_trip) {
+  using codec = stan::callbacks::uncompressed_codec;
+  std::string text = csv_text();
+  EXPECT_EQ(text, decompress<codec>(compress<codec>(text, 100, 4)));
+  EXPECT_EQ(text, decompress<codec>(compress<codec>(text, 1 << 20, 1)));
+  EXPECT_EQ("", decompress<codec>(compress<codec>("", 100, 1)));
+}
+
+TEST(StanIoCompressedIstream, parse_csv) {
+  using codec = stan::callbacks::uncompressed_codec;
+  std::ifstream file("src/test/unit/io/test_csv_files/blocker.0.csv");
+  std::stringstream text;
+  text << file.rdbuf();
+  std::stringstream plain(text.str());
+  std::stringstream compressed(compress<codec>(text.str(), 4096, 2));
+  stan::io::compressed_istream<codec> in(compressed);
+
+  std::stringstream out;
+  stan::io::stan_csv expected = stan::io::stan_csv_reader::parse(plain, &out);
+  stan::io::stan_csv parsed = stan::io::stan_csv_reader::parse(in, &out);
+  EXPECT_EQ(expected.header, parsed.header);
+  EXPECT_EQ(expected.metadata.seed, parsed.metadata.seed);
+  EXPECT_EQ(expected.samples, parsed.samples);
+}
+
+TEST(StanIoCompressedIstream, bad_header) {
+  std::stringstream not_compressed("lp__,theta\n");
+  EXPECT_THROW(stan::io::compressed_istream<stan::callbacks::uncompressed_codec>
+                   in(not_compressed),
+               std::invalid_argument);
+  std::string other_codec = compress<stan::callbacks::uncompressed_codec>(
+      "abc", 100, 1);
+  other_codec[8] = 'Z';
+  std::stringstream ss(other_codec);
+  EXPECT_THROW(
+      stan::io::compressed_istream<stan::callbacks::uncompressed_codec> in(ss),
+      std::invalid_argument);
+}
+
+TEST(StanIoCompressedIstream, truncated_frame) {
+  using codec = stan::callbacks::uncompressed_codec;
+  std::string compressed = compress<codec>(csv_text(), 100, 1);
+  std::stringstream ss(compressed.substr(0, compressed.size() - 10));
+  stan::io::compressed_istream<codec> in(ss);
+  std::string line;
+  while (std::getline(in, line)) {
+  }
+  EXPECT_TRUE(in.bad());
+}
+
+#ifdef STAN_ZSTD
+TEST(StanIoCompressedIstream, zstd_round_trip) {
+  using codec = stan::callbacks::zstd_codec;
+  std::string text = csv_text();
+  std::string compressed = compress<codec>(text, 4096, 4);
+  EXPECT_LT(compressed.size(), text.size());
+  EXPECT_EQ(text, decompress<codec>(compressed));
+}
+#endif
+
+#ifdef STAN_LZ4
+TEST(StanIoCompressedIstream, lz4_round_trip) {
+  using codec = stan::callbacks::lz4_codec;
+  std::string text = csv_text();
+  std::string compressed = compress<codec>(text, 4096, 4);
+  EXPECT_LT(compressed.size(), text.size());
+  EXPECT_EQ(text, decompress<codec>(compressed));
+}
+#endif
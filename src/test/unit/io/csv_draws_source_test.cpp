@@ -0,0 +1,60 @@
+#include <stan/io/csv_draws_source.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+const char* csv
+    = "# method = sample (Default)\n"
+      "lp__,accept_stat__,theta.1,theta.2\n"
+      "# Adaptation terminated\n"
+      "# Step size = 0.9\n"
+      "# Diagonal elements of inverse mass matrix:\n"
+      "# 1, 1\n"
+      "-1,0.9,0.5,1.5\n"
+      "-2,0.8,inf,2.5\n"
+      "\n"
+      "-3,0.7,-0.5,3.5\n"
+      "# \n"
+      "#  Elapsed Time: 0.25 seconds (Warm-up)\n"
+      "#                0.5 seconds (Sampling)\n";
+}
+
+TEST(StanIoCsvDrawsSource, all_columns) {
+  std::stringstream in(csv);
+  stan::io::csv_draws_source source(in);
+  EXPECT_EQ(4, source.num_cols());
+  EXPECT_EQ(0.9, source.csv().adaptation.step_size);
+  EXPECT_EQ("theta[1]", source.csv().header[2]);
+  Eigen::MatrixXd chunk;
+  ASSERT_EQ(2, source.read(2, chunk));
+  EXPECT_EQ(-1, chunk(0, 0));
+  EXPECT_EQ(1.5, chunk(0, 3));
+  EXPECT_TRUE(std::isinf(chunk(1, 2)));
+  ASSERT_EQ(1, source.read(2, chunk));
+  EXPECT_EQ(3.5, chunk(0, 3));
+  EXPECT_EQ(0, source.read(2, chunk));
+  EXPECT_EQ(0.25, source.csv().timing.warmup);
+}
+
+TEST(StanIoCsvDrawsSource, selected_columns) {
+  std::stringstream in(csv);
+  stan::io::csv_draws_source source(in, {"theta.2", "theta.1"});
+  EXPECT_EQ(2, source.num_cols());
+  Eigen::MatrixXd chunk;
+  ASSERT_EQ(3, source.read(10, chunk));
+  EXPECT_EQ(1.5, chunk(0, 0));
+  EXPECT_EQ(0.5, chunk(0, 1));
+  EXPECT_EQ(-0.5, chunk(2, 1));
+
+  std::stringstream missing(csv);
+  EXPECT_THROW(stan::io::csv_draws_source(missing, {"sigma"}),
+               std::invalid_argument);
+}
+
+TEST(StanIoCsvDrawsSource, wrong_number_of_columns) {
+  std::stringstream in("lp__,theta\n1,2\n3\n");
+  stan::io::csv_draws_source source(in);
+  Eigen::MatrixXd chunk;
+  EXPECT_THROW(source.read(10, chunk), std::invalid_argument);
+}
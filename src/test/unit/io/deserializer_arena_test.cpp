@@ -0,0 +1,96 @@
+#include <stan/io/deserializer.hpp>
+#include <gtest/gtest.h>
+#include <type_traits>
+#include <vector>
+
+using stan::math::var;
+
+namespace {
+std::vector<var> iota_vars(int n) {
+  std::vector<var> theta;
+  for (int i = 0; i < n; ++i)
+    theta.push_back(static_cast<double>(i));
+  return theta;
+}
+
+size_t arena_bytes() {
+  return stan::math::ChainableStack::instance_->memalloc_.bytes_allocated();
+}
+}  // namespace
+
+TEST(deserializer_arena, read_array_of_vectors) {
+  std::vector<int> theta_i;
+  std::vector<var> theta = iota_vars(10);
+  stan::io::deserializer<var> deserializer(theta, theta_i);
+  using vectors_t = std::vector<Eigen::Matrix<var, -1, 1>>;
+  auto x = deserializer.read_arena<vectors_t>(3, 2);
+  EXPECT_TRUE(
+      (std::is_same<decltype(x), stan::math::arena_t<vectors_t>>::value));
+  ASSERT_EQ(3U, x.size());
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(2, x[i].size());
+    for (int j = 0; j < 2; ++j)
+      EXPECT_FLOAT_EQ(2 * i + j, x[i](j).val());
+  }
+  // the values are the same vars, so gradients flow to the parameters
+  var lp = x[2](1) * 3;
+  lp.grad();
+  EXPECT_FLOAT_EQ(3, theta[5].adj());
+  EXPECT_EQ(4U, deserializer.available());
+  stan::math::recover_memory();
+}
+
+TEST(deserializer_arena, read_array_of_arrays) {
+  std::vector<int> theta_i;
+  std::vector<var> theta = iota_vars(6);
+  stan::io::deserializer<var> deserializer(theta, theta_i);
+  using arrays_t = std::vector<std::vector<var>>;
+  auto x = deserializer.read_arena<arrays_t>(2, 3);
+  EXPECT_TRUE(
+      (std::is_same<decltype(x), stan::math::arena_t<arrays_t>>::value));
+  ASSERT_EQ(2U, x.size());
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(3U, x[i].size());
+    for (int j = 0; j < 3; ++j)
+      EXPECT_FLOAT_EQ(3 * i + j, x[i][j].val());
+  }
+  stan::math::recover_memory();
+}
+
+TEST(deserializer_arena, allocates_in_the_arena) {
+  std::vector<int> theta_i;
+  std::vector<var> theta = iota_vars(400);
+  stan::io::deserializer<var> deserializer(theta, theta_i);
+  const size_t before = arena_bytes();
+  auto x = deserializer.read_arena<std::vector<Eigen::Matrix<var, -1, 1>>>(
+      100, 4);
+  // the elements and the array hold 500 pointers to vars between them
+  EXPECT_GE(arena_bytes() - before, 500 * sizeof(var));
+  EXPECT_EQ(0U, deserializer.available());
+  stan::math::recover_memory();
+}
+
+TEST(deserializer_arena, constrained_reads_take_arena_types) {
+  std::vector<int> theta_i;
+  std::vector<var> theta = iota_vars(6);
+  stan::io::deserializer<var> deserializer(theta, theta_i);
+  using simplexes_t = stan::io::deserializer<var>::arena_read_t<
+      std::vector<Eigen::Matrix<var, -1, 1>>>;
+  var lp = 0;
+  simplexes_t x
+      = deserializer.read_constrain_simplex<simplexes_t, true>(lp, 2, 4);
+  ASSERT_EQ(2U, x.size());
+  for (const auto& simplex : x)
+    EXPECT_FLOAT_EQ(1, stan::math::sum(simplex).val());
+  stan::math::recover_memory();
+}
+
+TEST(deserializer_arena, heap_types_without_var) {
+  std::vector<int> theta_i;
+  std::vector<double> theta{1, 2, 3, 4};
+  stan::io::deserializer<double> deserializer(theta, theta_i);
+  auto x = deserializer.read_arena<std::vector<Eigen::VectorXd>>(2, 2);
+  EXPECT_TRUE(
+      (std::is_same<decltype(x), std::vector<Eigen::VectorXd>>::value));
+  EXPECT_FLOAT_EQ(4, x[1](1));
+}
@@ -0,0 +1,184 @@
+#include <stan/io/deserializer.hpp>
+#include <stan/io/serializer.hpp>
+// expect_near_rel comes from lib/stan_math
+#include <test/unit/math/expect_near_rel.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace {
+std::vector<double> decreasing(int n) {
+  std::vector<double> theta;
+  for (int i = 0; i < n; ++i)
+    theta.push_back(-0.25 * i);
+  return theta;
+}
+}  // namespace
+
+TEST(deserializer_fixed, read) {
+  std::vector<int> theta_i;
+  std::vector<double> theta = decreasing(20);
+  stan::io::deserializer<double> deserializer(theta, theta_i);
+
+  auto x = deserializer.read<Eigen::Matrix<double, 3, 1>>();
+  EXPECT_TRUE((std::is_same<decltype(x),
+                            Eigen::Map<const Eigen::Matrix<double, 3, 1>>>::
+                   value));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FLOAT_EQ(theta[i], x(i));
+
+  auto y = deserializer.read<Eigen::Matrix<double, 1, 2>>(2);
+  EXPECT_EQ(1, y.rows());
+  EXPECT_FLOAT_EQ(theta[3], y(0));
+  EXPECT_FLOAT_EQ(theta[4], y(1));
+
+  Eigen::Matrix2d z = deserializer.read<Eigen::Matrix2d>(2, 2);
+  EXPECT_FLOAT_EQ(theta[5], z(0, 0));
+  EXPECT_FLOAT_EQ(theta[6], z(1, 0));
+  EXPECT_FLOAT_EQ(theta[7], z(0, 1));
+  EXPECT_EQ(12U, deserializer.available());
+
+  EXPECT_THROW(deserializer.read<Eigen::Vector3d>(4), std::invalid_argument);
+  EXPECT_THROW((deserializer.read<Eigen::Matrix<double, 2, 3>>(3, 2)),
+               std::invalid_argument);
+  EXPECT_EQ(12U, deserializer.available());
+  EXPECT_THROW((deserializer.read<Eigen::Matrix<double, 13, 1>>()),
+               std::runtime_error);
+
+  auto empty = deserializer.read<Eigen::Matrix<double, 0, 1>>();
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(12U, deserializer.available());
+}
+
+TEST(deserializer_fixed, read_std_vector) {
+  std::vector<int> theta_i;
+  std::vector<double> theta = decreasing(6);
+  stan::io::deserializer<double> deserializer(theta, theta_i);
+  std::vector<Eigen::Vector2d> x
+      = deserializer.read<std::vector<Eigen::Vector2d>>(3, 2);
+  ASSERT_EQ(3U, x.size());
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_FLOAT_EQ(theta[2 * i + j], x[i](j));
+}
+
+// each constrained read of a fixed-size type matches that of the dynamic
+// type, reading as many values
+TEST(deserializer_fixed, read_constrain_matches_dynamic) {
+  std::vector<int> theta_i;
+  std::vector<double> theta = decreasing(60);
+  stan::io::deserializer<double> fixed(theta, theta_i);
+  stan::io::deserializer<double> dynamic(theta, theta_i);
+  double lp_fixed = 0;
+  double lp_dynamic = 0;
+
+  stan::test::expect_near_rel(
+      "lb",
+      fixed.read_constrain_lb<Eigen::Vector3d, true>(0.5, lp_fixed, 3).eval(),
+      dynamic.read_constrain_lb<Eigen::VectorXd, true>(0.5, lp_dynamic, 3)
+          .eval());
+  stan::test::expect_near_rel(
+      "simplex",
+      stan::math::eval(fixed.read_constrain_simplex<Eigen::Vector4d, true>(
+          lp_fixed, 4)),
+      stan::math::eval(dynamic.read_constrain_simplex<Eigen::VectorXd, true>(
+          lp_dynamic, 4)));
+  stan::test::expect_near_rel(
+      "unit_vector",
+      stan::math::eval(fixed.read_constrain_unit_vector<Eigen::Vector3d, true>(
+          lp_fixed, 3)),
+      stan::math::eval(
+          dynamic.read_constrain_unit_vector<Eigen::VectorXd, true>(lp_dynamic,
+                                                                    3)));
+  stan::test::expect_near_rel(
+      "cholesky_factor_cov",
+      stan::math::eval(
+          fixed.read_constrain_cholesky_factor_cov<Eigen::Matrix<double, 3, 2>,
+                                                   true>(lp_fixed, 3, 2)),
+      stan::math::eval(
+          dynamic.read_constrain_cholesky_factor_cov<Eigen::MatrixXd, true>(
+              lp_dynamic, 3, 2)));
+  stan::test::expect_near_rel(
+      "cholesky_factor_corr",
+      stan::math::eval(
+          fixed.read_constrain_cholesky_factor_corr<Eigen::Matrix3d, true>(
+              lp_fixed, 3)),
+      stan::math::eval(
+          dynamic.read_constrain_cholesky_factor_corr<Eigen::MatrixXd, true>(
+              lp_dynamic, 3)));
+  stan::test::expect_near_rel(
+      "cov_matrix",
+      stan::math::eval(fixed.read_constrain_cov_matrix<Eigen::Matrix2d, true>(
+          lp_fixed, 2)),
+      stan::math::eval(
+          dynamic.read_constrain_cov_matrix<Eigen::MatrixXd, true>(lp_dynamic,
+                                                                   2)));
+  stan::test::expect_near_rel(
+      "corr_matrix",
+      stan::math::eval(fixed.read_constrain_corr_matrix<Eigen::Matrix3d, true>(
+          lp_fixed, 3)),
+      stan::math::eval(
+          dynamic.read_constrain_corr_matrix<Eigen::MatrixXd, true>(lp_dynamic,
+                                                                    3)));
+  EXPECT_FLOAT_EQ(lp_dynamic, lp_fixed);
+  EXPECT_EQ(dynamic.available(), fixed.available());
+
+  EXPECT_THROW((fixed.read_constrain_simplex<Eigen::Vector4d, false>(
+                   lp_fixed, 3)),
+               std::invalid_argument);
+}
+
+TEST(deserializer_fixed, read_free_matches_dynamic) {
+  std::vector<int> theta_i;
+  std::vector<double> theta{0.2, 0.3, 0.5, 2, 0.5, 0, 1};
+  stan::io::deserializer<double> fixed(theta, theta_i);
+  stan::io::deserializer<double> dynamic(theta, theta_i);
+  stan::test::expect_near_rel(
+      "simplex",
+      stan::math::eval(fixed.read_free_simplex<Eigen::Vector3d>(3)),
+      stan::math::eval(dynamic.read_free_simplex<Eigen::VectorXd>(3)));
+  stan::test::expect_near_rel(
+      "cholesky_factor_cov",
+      stan::math::eval(fixed.read_free_cholesky_factor_cov<Eigen::Matrix2d>(
+          2, 2)),
+      stan::math::eval(
+          dynamic.read_free_cholesky_factor_cov<Eigen::MatrixXd>(2, 2)));
+  EXPECT_EQ(0U, fixed.available());
+}
+
+TEST(serializer_fixed, write) {
+  std::vector<double> theta(9, 0.0);
+  stan::io::serializer<double> serializer(theta);
+  Eigen::Vector3d x(1, 2, 3);
+  Eigen::Matrix<double, 1, 2> y(4, 5);
+  Eigen::Matrix2d z;
+  z << 6, 8, 7, 9;
+  serializer.write(x);
+  serializer.write(y);
+  serializer.write(z);
+  for (int i = 0; i < 9; ++i)
+    EXPECT_FLOAT_EQ(i + 1, theta[i]);
+  EXPECT_EQ(0U, serializer.available());
+  EXPECT_THROW(serializer.write(x), std::runtime_error);
+  // nothing to write
+  serializer.write(Eigen::Matrix<double, 0, 1>());
+}
+
+TEST(serializer_fixed, round_trip) {
+  std::vector<double> theta(5, 0.0);
+  stan::io::serializer<double> serializer(theta);
+  Eigen::Vector4d simplex(0.1, 0.2, 0.3, 0.4);
+  serializer.write(2 * Eigen::Matrix<double, 1, 1>::Ones());
+  serializer.write_free_simplex(simplex);
+  EXPECT_EQ(1U, serializer.available());
+
+  std::vector<int> theta_i;
+  stan::io::deserializer<double> deserializer(theta, theta_i);
+  EXPECT_FLOAT_EQ(2, (deserializer.read<Eigen::Matrix<double, 1, 1>>()(0)));
+  double lp = 0;
+  stan::test::expect_near_rel(
+      "simplex", simplex,
+      stan::math::eval(
+          deserializer.read_constrain_simplex<Eigen::Vector4d, false>(lp, 4)));
+}
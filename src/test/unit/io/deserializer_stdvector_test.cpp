@@ -471,3 +471,44 @@ TEST(deserializer_array, corr_matrix) {
     EXPECT_FLOAT_EQ(lp_ref, lp);
   }
 }
+
+// arrays read as one block
+
+TEST(deserializer_array, nested_simplex) {
+  std::vector<int> theta_i;
+  std::vector<double> theta;
+  for (size_t i = 0; i < 100U; ++i)
+    theta.push_back(static_cast<double>(i) / 10);
+
+  stan::io::deserializer<double> deserializer1(theta, theta_i);
+  stan::io::deserializer<double> deserializer2(theta, theta_i);
+
+  double lp_ref = 0.0;
+  double lp = 0.0;
+  auto y = deserializer1.read_constrain_simplex<
+      std::vector<std::vector<Eigen::VectorXd>>, true>(lp, 2, 3, 4);
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      stan::test::expect_near_rel(
+          "deserializer tests", y[i][j],
+          deserializer2.read_constrain_simplex<Eigen::VectorXd, true>(lp_ref,
+                                                                      4));
+    }
+  }
+  EXPECT_FLOAT_EQ(lp_ref, lp);
+  EXPECT_EQ(deserializer2.available(), deserializer1.available());
+}
+
+TEST(deserializer_array, short_array_throws_before_transform) {
+  std::vector<int> theta_i;
+  std::vector<double> theta(10, 0.5);
+  stan::io::deserializer<double> deserializer(theta, theta_i);
+
+  double lp = 0.0;
+  EXPECT_THROW(
+      (deserializer.read_constrain_simplex<std::vector<Eigen::VectorXd>, true>(
+          lp, 4, 4)),
+      std::runtime_error);
+  EXPECT_EQ(0.0, lp);
+  EXPECT_EQ(10U, deserializer.available());
+}
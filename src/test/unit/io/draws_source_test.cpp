@@ -0,0 +1,15 @@
+#include <stan/io/draws_source.hpp>
+#include <gtest/gtest.h>
+
+TEST(StanIoDrawsSource, matrix_in_chunks) {
+  Eigen::MatrixXd draws(5, 2);
+  draws << 1, 2, 3, 4, 5, 6, 7, 8, 9, 10;
+  stan::io::matrix_draws_source source(draws);
+  EXPECT_EQ(2, source.num_cols());
+  Eigen::MatrixXd chunk;
+  ASSERT_EQ(3, source.read(3, chunk));
+  EXPECT_EQ(draws.topRows(3), chunk.topRows(3));
+  ASSERT_EQ(2, source.read(3, chunk));
+  EXPECT_EQ(draws.bottomRows(2), chunk.topRows(2));
+  EXPECT_EQ(0, source.read(3, chunk));
+}
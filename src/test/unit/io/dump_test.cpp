@@ -2,6 +2,9 @@
 #include <stan/io/dump.hpp>
 #include <gtest/gtest.h>
 #include <boost/math/special_functions/fpclassify.hpp>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 
 void test_list3(stan::io::dump_reader& reader,
                 const std::vector<double>& vals) {
@@ -683,3 +686,97 @@ TEST(io_dump, too_large_zero_array) {
   test_exception(
       "a <- structure(double(999918446744073709551616L), .Dim = c(2,3))");
 }
+
+TEST(io_dump, views) {
+  std::string txt = "foo <- c(1.5, 2.5, 3.5)\nbar <- c(1L, 2L)";
+  std::stringstream in(txt);
+  stan::io::dump dump(in);
+
+  stan::io::values_view<double> foo = dump.view_r("foo");
+  EXPECT_FALSE(foo.owns_data());
+  EXPECT_EQ(dump.vals_r("foo"), foo.to_vector());
+  EXPECT_EQ(foo.data(), dump.view_r("foo").data());
+
+  stan::io::values_view<int> bar = dump.view_i("bar");
+  EXPECT_FALSE(bar.owns_data());
+  EXPECT_EQ(dump.vals_i("bar"), bar.to_vector());
+
+  stan::io::values_view<double> bar_r = dump.view_r("bar");
+  EXPECT_TRUE(bar_r.owns_data());
+  EXPECT_EQ(dump.vals_r("bar"), bar_r.to_vector());
+
+  EXPECT_TRUE(dump.view_r("baz").empty());
+}
+
+void expect_same_definitions(const std::string& txt) {
+  std::stringstream in(txt);
+  stan::io::dump_reader reader(in);
+  stan::io::dump_buffer_reader buffer_reader(txt.data(), txt.size());
+  bool has_next = reader.next();
+  while (has_next) {
+    ASSERT_TRUE(buffer_reader.next()) << txt;
+    EXPECT_EQ(reader.name(), buffer_reader.name()) << txt;
+    EXPECT_EQ(reader.dims(), buffer_reader.dims()) << txt;
+    EXPECT_EQ(reader.is_int(), buffer_reader.is_int()) << txt;
+    EXPECT_EQ(reader.int_values(), buffer_reader.int_values()) << txt;
+    std::vector<double> vals = reader.double_values();
+    std::vector<double>& buffer_vals = buffer_reader.double_values();
+    ASSERT_EQ(vals.size(), buffer_vals.size()) << txt;
+    for (size_t i = 0; i < vals.size(); ++i) {
+      if (std::isnan(vals[i]))
+        EXPECT_TRUE(std::isnan(buffer_vals[i])) << txt;
+      else
+        EXPECT_EQ(vals[i], buffer_vals[i]) << txt;
+    }
+    has_next = reader.next();
+  }
+  EXPECT_FALSE(buffer_reader.next()) << txt;
+}
+
+TEST(io_dump, buffer_reader_matches_reader) {
+  for (const std::string txt :
+       {"", "  \n", "a <- 1", "a <- -2.5e3\nb<-3", "a <- c()",
+        "a <- c(1, 2, 3)", "a <- c(1, 2.5, -3)\nb <- c( +1 ,-2 )",
+        "\"a\" <- c(1e-3, .5, 2.)\n'b.c_1' <- c(0, 0.0, 0e10, -0)",
+        "a <- c(2147483647, -2147483647)", "a <- c(1.5, 2147483648)",
+        "a <- c(1, Inf, -Infinity, NaN)", "a <- c(1L, 2L, 3)",
+        "a <- c(- 1)", "a <- structure(c(1, 2, 3, 4, 5, 6),"
+        " .Dim = c(2, 3))\nb <- structure(c(1.5,2),.Dim=c(2L,1L))",
+        "a <- structure(c(1, 2), .Dim = 2:1)",
+        "a <- structure(integer(0), .Dim = c(2, 0))", "a <- 1:4\nb <- c(3)",
+        "a <- double(2)\nb <- c(1,\n2)\nc <- structure(c(1 , 2,\n3,4) , "
+        ".Dim = c( 2 , 2 ) )"})
+    expect_same_definitions(txt);
+}
+
+TEST(io_dump, buffer_reader_errors) {
+  for (const std::string txt :
+       {"a <- c(1, 2", "a <- c(1, 2,)", "a <- c(1 2)", "a <- c(0x10)",
+        "a <- c(1e400)", "a <- c(4.9e-324)", "a <- c(1.5, 1e-400)",
+        "a <- structure(c(1, 2), .Dim = c(2, 1)"}) {
+    EXPECT_THROW(stan::io::dump(txt.data(), txt.size()), std::invalid_argument)
+        << txt;
+    std::stringstream in(txt);
+    EXPECT_THROW(stan::io::dump dump(in), std::invalid_argument) << txt;
+  }
+}
+
+TEST(io_dump, from_file) {
+  std::string txt
+      = "foo <- structure(c(1.5, 2.5, 3.5, 4.5), .Dim = c(2, 2))\n"
+        "bar <- c(1, 2, 3)\nbaz <- 7\n";
+  std::string filename = "dump_from_file_test.data.R";
+  {
+    std::ofstream out(filename);
+    out << txt;
+  }
+  stan::io::dump dump = stan::io::dump::from_file(filename);
+  std::remove(filename.c_str());
+  EXPECT_EQ(std::vector<double>({1.5, 2.5, 3.5, 4.5}), dump.vals_r("foo"));
+  EXPECT_EQ(std::vector<size_t>({2, 2}), dump.dims_r("foo"));
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), dump.vals_i("bar"));
+  EXPECT_EQ(std::vector<int>({7}), dump.vals_i("baz"));
+  EXPECT_TRUE(dump.dims_i("baz").empty());
+  EXPECT_THROW(stan::io::dump::from_file("no_such_file.data.R"),
+               std::invalid_argument);
+}
@@ -0,0 +1,126 @@
+#include <stan/io/json/json_data.hpp>
+#include <stan/io/json/json_error.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string json_dir = "src/test/unit/io/test_json_files/";
+
+void expect_same_vars(const stan::json::json_data& expected,
+                      const stan::json::json_data& found,
+                      const std::string& where) {
+  std::vector<std::string> names, found_names;
+  expected.names_r(names);
+  found.names_r(found_names);
+  EXPECT_EQ(names, found_names) << where;
+  for (const std::string& name : names) {
+    EXPECT_EQ(expected.dims_r(name), found.dims_r(name)) << where << name;
+    std::vector<double> vals = expected.vals_r(name);
+    std::vector<double> found_vals = found.vals_r(name);
+    ASSERT_EQ(vals.size(), found_vals.size()) << where << name;
+    for (size_t i = 0; i < vals.size(); ++i) {
+      if (std::isnan(vals[i]))
+        EXPECT_TRUE(std::isnan(found_vals[i])) << where << name;
+      else
+        EXPECT_EQ(vals[i], found_vals[i]) << where << name;
+    }
+  }
+  expected.names_i(names);
+  found.names_i(found_names);
+  EXPECT_EQ(names, found_names) << where;
+  for (const std::string& name : names) {
+    EXPECT_EQ(expected.dims_i(name), found.dims_i(name)) << where << name;
+    EXPECT_EQ(expected.vals_i(name), found.vals_i(name)) << where << name;
+  }
+}
+
+void expect_same_as_handler(const std::string& txt) {
+  std::stringstream in(txt);
+  stan::json::json_data expected(in);
+  stan::json::json_data found(txt.data(), txt.size());
+  expect_same_vars(expected, found, txt);
+  stan::json::json_data found_parallel(txt.data(), txt.size(), true);
+  expect_same_vars(expected, found_parallel, txt);
+}
+
+void expect_error(const std::string& txt) {
+  std::stringstream in(txt);
+  EXPECT_THROW(stan::json::json_data expected(in), stan::json::json_error)
+      << txt;
+  EXPECT_THROW(stan::json::json_data found(txt.data(), txt.size()),
+               stan::json::json_error)
+      << txt;
+  EXPECT_THROW(stan::json::json_data found(txt.data(), txt.size(), true),
+               stan::json::json_error)
+      << txt;
+}
+}  // namespace
+
+TEST(ioJson, fast_handler_matches_handler) {
+  for (const std::string txt :
+       {"{}", "{ \"foo\" : 1 }", "{ \"foo\" : -1.5e-3 }",
+        "{ \"foo\" : 4294967295, \"bar\" : -9007199254740993 }",
+        "{ \"foo\" : [] }", "{ \"foo\" : [[], []] }",
+        "{ \"foo\" : [1, 2, 3] }", "{ \"foo\" : [1, 2.5, 3] }",
+        "{ \"foo\" : [1, \"Inf\", \"-Infinity\", \"NaN\", NaN] }",
+        "{ \"foo\" : [[1, 2, 3], [4, 5, 6]] }",
+        "{ \"foo\" : [[[1, 2], [3, 4], [5, 6]], [[7, 8], [9, 10], [11, 12]]] }",
+        "{ \"foo\" : [[1.5, 2], [3, 4]], \"bar\" : 2, \"baz\" : [7] }",
+        "{ \"1foo\" : [[1], {\"a\" : null}], \"foo\" : [2] }",
+        "{ \"foo\" : { \"1\" : 1, \"2\" : [1.5, 2.5] }, \"bar\" : 3 }",
+        "{ \"foo\" : [{ \"1\" : 1, \"2\" : [1, 2] }, { \"1\" : 2, \"2\" : [3, "
+        "4.5] }], \"bar\" : [[1, 2]] }",
+        "{ \"foo\" : \"Inf\", \"a\\u0062\" : [1] }",
+        "{ \"foo\" : [1], \"1\" : [\"]}\", {}], \"bar\" : 2 }",
+        "{ \"foo\" : [[{ \"1\" : 1 }, { \"1\" : 2 }]] }"})
+    expect_same_as_handler(txt);
+}
+
+TEST(ioJson, fast_handler_matches_handler_files) {
+  for (const std::string name :
+       {"array_tuple_multi.json", "arrays.json", "d1_array_tuple_1d_real.json",
+        "d1_array_tuple_1d_tuple.json", "d2_array_tuple_1d_real.json",
+        "not_stan_varname.json", "tuple_arr_tuple.json",
+        "tuple_array_3d_2d.json", "tuple_int_real.json", "tuple_nested.json",
+        "vars_plus_comments.json"}) {
+    std::ifstream in(json_dir + name);
+    stan::json::json_data expected(in);
+    stan::json::json_data found
+        = stan::json::json_data::from_file(json_dir + name);
+    expect_same_vars(expected, found, name);
+    stan::json::json_data found_parallel
+        = stan::json::json_data::from_file(json_dir + name, true);
+    expect_same_vars(expected, found_parallel, name);
+  }
+}
+
+TEST(ioJson, fast_handler_errors) {
+  for (const std::string txt :
+       {"[1, 2]", "{ \"foo\" : [[1, 2], [3]] }", "{ \"foo\" : [[1, 2], 3] }",
+        "{ \"foo\" : [1, [2]] }", "{ \"foo\" : [[1], []] }",
+        "{ \"foo\" : null }", "{ \"foo\" : [true] }",
+        "{ \"foo\" : \"bar\" }", "{ \"foo\" : 1, \"foo\" : 2 }",
+        "{ \"foo\" : [1, 2] "})
+    expect_error(txt);
+  for (const std::string name :
+       {"inconsistent_array_tuples_1.json", "inconsistent_array_tuples_2.json",
+        "inconsistent_array_tuples_3.json", "inconsistent_array_tuples_4.json",
+        "redefine_vars_1.json", "redefine_vars_2.json", "redefine_vars_3.json",
+        "redefine_vars_4.json", "redefine_vars_5.json",
+        "redefine_vars_6.json"}) {
+    std::ifstream in(json_dir + name);
+    EXPECT_THROW(stan::json::json_data expected(in), stan::json::json_error)
+        << name;
+    EXPECT_THROW(stan::json::json_data::from_file(json_dir + name),
+                 stan::json::json_error)
+        << name;
+    EXPECT_THROW(stan::json::json_data::from_file(json_dir + name, true),
+                 stan::json::json_error)
+        << name;
+  }
+  EXPECT_THROW(stan::json::json_data::from_file(json_dir + "no_such.json"),
+               std::invalid_argument);
+}
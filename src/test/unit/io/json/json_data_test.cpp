@@ -494,3 +494,24 @@ TEST(ioJson, jsonData_promote_extra_large_int_to_double) {
   test_real_var(jdata, "foo", foo_vals_r, expected_dims);
   test_real_var(jdata, "bar", bar_vals_r, expected_dims);
 }
+
+TEST(ioJson, jsonData_views) {
+  std::string txt = "{ \"foo\" : [1.5, 2.5, 3.5], \"bar\" : [1, 2] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+
+  stan::io::values_view<double> foo = jdata.view_r("foo");
+  EXPECT_FALSE(foo.owns_data());
+  EXPECT_EQ(jdata.vals_r("foo"), foo.to_vector());
+  EXPECT_EQ(foo.data(), jdata.view_r("foo").data());
+
+  stan::io::values_view<int> bar = jdata.view_i("bar");
+  EXPECT_FALSE(bar.owns_data());
+  EXPECT_EQ(jdata.vals_i("bar"), bar.to_vector());
+
+  stan::io::values_view<double> bar_r = jdata.view_r("bar");
+  EXPECT_TRUE(bar_r.owns_data());
+  EXPECT_EQ(jdata.vals_r("bar"), bar_r.to_vector());
+
+  EXPECT_TRUE(jdata.view_r("baz").empty());
+}
@@ -0,0 +1,37 @@
+#include <stan/io/json/json_prescan.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<std::string> scan(const std::string& txt, bool expect_ok = true) {
+  std::vector<stan::json::internal::json_member> members;
+  EXPECT_EQ(expect_ok, stan::json::internal::prescan_members(
+                           txt.data(), txt.size(), members))
+      << txt;
+  std::vector<std::string> result;
+  for (const auto& member : members) {
+    result.push_back(member.key);
+    result.push_back(std::string(member.value, member.size));
+  }
+  return result;
+}
+}  // namespace
+
+TEST(ioJson, prescan_members) {
+  EXPECT_TRUE(scan(" { } ").empty());
+  EXPECT_EQ(std::vector<std::string>({"a", "1"}), scan("{\"a\":1}"));
+  EXPECT_EQ(std::vector<std::string>(
+                {"a", "[1, [2, 3]]", "b", "{ \"1\" : \"x,}]\\\"\" }", "c",
+                 "-Infinity"}),
+            scan("{ \"a\" : [1, [2, 3]] ,\n \"b\" : { \"1\" : \"x,}]\\\"\" },"
+                 " \"c\": -Infinity }\n"));
+}
+
+TEST(ioJson, prescan_members_gives_up) {
+  for (const std::string txt :
+       {"", "[1]", "{", "{ \"a\" : 1", "{ \"a\" : 1 } x", "{ \"a\" 1 }",
+        "{ \"a\\u0062\" : 1 }", "{ \"a\" : }", "{ \"a\" : [1 }",
+        "{ \"a\" : 1, }", "{ \"a\" : \"x }"})
+    scan(txt, false);
+}
@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <stan/io/multi_chain_reader.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string filename = "multi_chain_reader_test.mcw";
+}
+
+TEST(multiChainReader, empty_chains) {
+  {
+    stan::callbacks::multi_chain_writer writer(filename);
+    auto chains = writer.chain_writers(2);
+    chains[0](std::vector<std::string>{"lp__"});
+    chains[1](std::vector<std::string>{"lp__"});
+    chains[1]("no draws");
+  }
+  stan::io::multi_chain_reader reader(filename);
+  EXPECT_EQ(0, reader.num_draws(1));
+  EXPECT_EQ(0, reader.read(2).rows());
+  EXPECT_EQ(1, reader.read(2).cols());
+  EXPECT_EQ(std::vector<std::string>{"no draws"}, reader.comments(2));
+  EXPECT_THROW(reader.num_draws(3), std::invalid_argument);
+  std::remove(filename.c_str());
+}
+
+TEST(multiChainReader, not_a_multi_chain_file) {
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << std::string(256, 'x');
+  }
+  EXPECT_THROW(stan::io::multi_chain_reader reader(filename),
+               std::invalid_argument);
+  std::remove(filename.c_str());
+}
+
+TEST(multiChainReader, truncated_file) {
+  {
+    stan::callbacks::multi_chain_writer writer(filename, 4);
+    auto chains = writer.chain_writers(1);
+    chains[0](std::vector<std::string>{"lp__", "theta"});
+    for (int n = 0; n < 9; ++n)
+      chains[0](std::vector<double>{1.0 * n, 2.0 * n});
+  }
+  std::string contents;
+  {
+    std::ifstream in(filename, std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in), {});
+  }
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << contents.substr(0, 64) << contents.substr(contents.size() - 16);
+  }
+  EXPECT_THROW(stan::io::multi_chain_reader reader(filename),
+               std::invalid_argument);
+  std::remove(filename.c_str());
+}
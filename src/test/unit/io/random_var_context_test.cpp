@@ -174,3 +174,25 @@ TEST_F(random_var_context, construct) {
   EXPECT_THROW_MSG(stan::io::random_var_context(throwing_model, rng, 2, false),
                    std::domain_error, "throwing within write_array");
 }
+
+TEST_F(random_var_context, redraw) {
+  stan::rng_t rng2 = stan::services::util::create_rng(0, 0);
+  stan::io::random_var_context context(model, rng, 2, false);
+  std::vector<double> first = context.get_unconstrained();
+  context.redraw(model, rng);
+
+  stan::io::random_var_context first_context(model, rng2, 2, false);
+  stan::io::random_var_context second_context(model, rng2, 2, false);
+  EXPECT_EQ(first, first_context.get_unconstrained());
+  EXPECT_EQ(second_context.get_unconstrained(), context.get_unconstrained());
+  EXPECT_NE(first, context.get_unconstrained());
+
+  std::vector<std::string> names_r;
+  context.names_r(names_r);
+  for (const std::string& name : names_r) {
+    EXPECT_EQ(second_context.vals_r(name), context.vals_r(name));
+    EXPECT_EQ(context.vals_r(name), context.view_r(name).to_vector());
+    EXPECT_FALSE(context.view_r(name).owns_data());
+  }
+  EXPECT_TRUE(context.view_r("no_such_param").empty());
+}
@@ -0,0 +1,98 @@
+#include <stan/io/read_metric_sidecar.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string filename = "read_metric_sidecar_test.metric";
+
+void write_json(const std::string& metric_type, const Eigen::MatrixXd* dense,
+                const Eigen::VectorXd* diag) {
+  std::unique_ptr<std::ofstream> out(new std::ofstream(filename));
+  stan::callbacks::json_writer<std::ofstream> writer(std::move(out));
+  writer.begin_record();
+  writer.write("stepsize", 0.5);
+  writer.write("metric_type", metric_type);
+  if (dense)
+    writer.write("inv_metric", *dense);
+  else
+    writer.write("inv_metric", *diag);
+  writer.end_record();
+}
+
+void write_text(const std::string& text) {
+  std::ofstream out(filename);
+  out << text;
+}
+}  // namespace
+
+TEST(read_metric_sidecar, dense_json) {
+  Eigen::MatrixXd metric(3, 3);
+  metric << 2, 0.5, 0, 0.5, 1, -0.25, 0, -0.25, 4;
+  write_json("dense_e", &metric, nullptr);
+  stan::io::stan_csv_adaptation adaptation;
+  stan::io::read_metric_sidecar(filename, adaptation);
+  EXPECT_FLOAT_EQ(0.5, adaptation.step_size);
+  ASSERT_EQ(3, adaptation.metric.rows());
+  ASSERT_EQ(3, adaptation.metric.cols());
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_FLOAT_EQ(metric(i, j), adaptation.metric(i, j));
+  std::remove(filename.c_str());
+}
+
+TEST(read_metric_sidecar, diag_json) {
+  Eigen::VectorXd metric(4);
+  metric << 1, 2, 3, 4;
+  write_json("diag_e", nullptr, &metric);
+  stan::io::stan_csv_adaptation adaptation;
+  stan::io::read_metric_sidecar(filename, adaptation);
+  EXPECT_FLOAT_EQ(0.5, adaptation.step_size);
+  ASSERT_EQ(1, adaptation.metric.rows());
+  ASSERT_EQ(4, adaptation.metric.cols());
+  for (int i = 0; i < 4; ++i)
+    EXPECT_FLOAT_EQ(metric(i), adaptation.metric(0, i));
+  std::remove(filename.c_str());
+}
+
+TEST(read_metric_sidecar, binary) {
+  std::vector<std::string> names_r{"stepsize", "inv_metric"};
+  // column major, as var contexts store matrices
+  std::vector<double> vals_r{0.75, 1, 3, 2, 4};
+  std::vector<std::vector<size_t>> dims_r{{}, {2, 2}};
+  stan::io::array_var_context context(names_r, vals_r, dims_r);
+  {
+    std::ofstream out(filename, std::ios::binary);
+    stan::io::binary_var_context::write(out, context);
+  }
+  stan::io::stan_csv_adaptation adaptation;
+  stan::io::read_metric_sidecar(filename, adaptation);
+  EXPECT_FLOAT_EQ(0.75, adaptation.step_size);
+  Eigen::MatrixXd expected(2, 2);
+  expected << 1, 2, 3, 4;
+  EXPECT_EQ(expected, adaptation.metric);
+  std::remove(filename.c_str());
+}
+
+TEST(read_metric_sidecar, errors) {
+  stan::io::stan_csv_adaptation adaptation;
+  EXPECT_THROW(stan::io::read_metric_sidecar("no_such_metric_file.json",
+                                             adaptation),
+               std::invalid_argument);
+  write_text("{\"stepsize\": 0.5}");
+  EXPECT_THROW(stan::io::read_metric_sidecar(filename, adaptation),
+               std::invalid_argument);
+  write_text("{\"stepsize\": 0.5, \"inv_metric\": [[1, 2], [3]]}");
+  EXPECT_THROW(stan::io::read_metric_sidecar(filename, adaptation),
+               std::invalid_argument);
+  write_text("{\"stepsize\": 0.5, \"inv_metric\": [1, 2");
+  EXPECT_THROW(stan::io::read_metric_sidecar(filename, adaptation),
+               stan::json::json_error);
+  std::remove(filename.c_str());
+}
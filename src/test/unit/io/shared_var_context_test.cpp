@@ -0,0 +1,84 @@
+#include <stan/io/shared_var_context.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string segment = "stan_shared_var_context_test_"
+                            + std::to_string(::getpid());
+
+stan::io::array_var_context make_context() {
+  std::vector<std::string> names_r{"y"};
+  std::vector<double> vals_r{1.5, 2.5, 3.5};
+  std::vector<std::vector<size_t>> dims_r{{3}};
+  std::vector<std::string> names_i{"N"};
+  std::vector<int> vals_i{3};
+  std::vector<std::vector<size_t>> dims_i{{}};
+  return stan::io::array_var_context(names_r, vals_r, dims_r, names_i, vals_i,
+                                     dims_i);
+}
+
+struct mock_model {
+  std::vector<double> y;
+  unsigned int seed;
+  mock_model(stan::io::var_context& context, unsigned int seed,
+             std::ostream* msgs)
+      : y(context.vals_r("y")), seed(seed) {}
+};
+}  // namespace
+
+TEST(shared_var_context, created_once) {
+  stan::io::shared_var_context::remove(segment);
+  int loads = 0;
+  auto load = [&]() {
+    ++loads;
+    return make_context();
+  };
+  stan::io::shared_var_context first(segment, load);
+  stan::io::shared_var_context second(segment, load);
+  stan::io::shared_var_context third(segment);
+  EXPECT_EQ(1, loads);
+
+  for (const stan::io::var_context* svc : {&first, &second, &third}) {
+    EXPECT_EQ(std::vector<double>({1.5, 2.5, 3.5}), svc->vals_r("y"));
+    EXPECT_EQ(std::vector<size_t>({3}), svc->dims_r("y"));
+    EXPECT_EQ(std::vector<int>({3}), svc->vals_i("N"));
+    EXPECT_FALSE(svc->view_r("y").owns_data());
+  }
+  // every mapping shows the same segment
+  EXPECT_EQ(0, std::memcmp(first.view_r("y").data(),
+                           third.view_r("y").data(), 3 * sizeof(double)));
+
+  EXPECT_TRUE(stan::io::shared_var_context::remove(segment));
+  EXPECT_EQ(std::vector<double>({1.5, 2.5, 3.5}), first.vals_r("y"));
+  EXPECT_THROW(stan::io::shared_var_context missing(segment),
+               std::invalid_argument);
+}
+
+TEST(shared_var_context, failed_load) {
+  stan::io::shared_var_context::remove(segment);
+  auto load = []() -> stan::io::array_var_context {
+    throw std::domain_error("no data");
+  };
+  EXPECT_THROW(stan::io::shared_var_context svc(segment, load),
+               std::domain_error);
+  stan::io::shared_var_context svc(segment, make_context);
+  EXPECT_EQ(std::vector<int>({3}), svc.vals_i("N"));
+  stan::io::shared_var_context::remove(segment);
+}
+
+TEST(shared_var_context, make_model) {
+  stan::io::shared_var_context::remove(segment);
+  std::unique_ptr<mock_model> model
+      = stan::io::make_model_from_shared_data<mock_model>(
+          segment, make_context, 12, nullptr);
+  EXPECT_EQ(std::vector<double>({1.5, 2.5, 3.5}), model->y);
+  EXPECT_EQ(12U, model->seed);
+  stan::io::shared_var_context::remove(segment);
+}
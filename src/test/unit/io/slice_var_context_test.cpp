@@ -0,0 +1,60 @@
+#include <stan/io/slice_var_context.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// N = 4 rows of y and of the 4 x 2 matrix x, and a scalar sigma
+stan::io::array_var_context make_context() {
+  std::vector<std::string> names_r{"y", "x", "sigma"};
+  std::vector<double> vals_r{1, 2, 3, 4, 10, 20, 30, 40, 50, 60, 70, 80, 0.5};
+  std::vector<std::vector<size_t>> dims_r{{4}, {4, 2}, {}};
+  std::vector<std::string> names_i{"N", "g"};
+  std::vector<int> vals_i{4, 1, 1, 2, 2};
+  std::vector<std::vector<size_t>> dims_i{{}, {4}};
+  return stan::io::array_var_context(names_r, vals_r, dims_r, names_i, vals_i,
+                                     dims_i);
+}
+}  // namespace
+
+TEST(slice_var_context, slices_rows) {
+  stan::io::array_var_context avc = make_context();
+  stan::io::slice_var_context svc(avc, {"y", "x", "g"}, {"N"}, 1, 2);
+  EXPECT_EQ(4U, svc.num_rows());
+  EXPECT_EQ(std::vector<double>({2, 3}), svc.vals_r("y"));
+  EXPECT_EQ(std::vector<size_t>({2}), svc.dims_r("y"));
+  EXPECT_EQ(std::vector<double>({20, 30, 60, 70}), svc.vals_r("x"));
+  EXPECT_EQ(std::vector<size_t>({2, 2}), svc.dims_r("x"));
+  EXPECT_EQ(std::vector<int>({1, 2}), svc.vals_i("g"));
+  EXPECT_EQ(std::vector<size_t>({2}), svc.dims_i("g"));
+  EXPECT_EQ(std::vector<int>({2}), svc.vals_i("N"));
+  EXPECT_EQ(std::vector<double>({2}), svc.vals_r("N"));
+  EXPECT_EQ(std::vector<double>({0.5}), svc.vals_r("sigma"));
+  EXPECT_TRUE(svc.contains_r("sigma"));
+  EXPECT_FALSE(svc.contains_r("z"));
+  EXPECT_NO_THROW(svc.validate_dims("data initialization", "x", "vector",
+                                    std::vector<size_t>{2, 2}));
+}
+
+TEST(slice_var_context, wraps_around) {
+  stan::io::array_var_context avc = make_context();
+  stan::io::slice_var_context svc(avc, {"y", "x"}, {"N"}, 7, 3);
+  EXPECT_EQ(std::vector<double>({4, 1, 2}), svc.vals_r("y"));
+  EXPECT_EQ(std::vector<double>({40, 10, 20, 80, 50, 60}), svc.vals_r("x"));
+}
+
+TEST(slice_var_context, throws) {
+  stan::io::array_var_context avc = make_context();
+  EXPECT_THROW(stan::io::slice_var_context(avc, {"z"}, {}, 0, 1),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::slice_var_context(avc, {"sigma"}, {}, 0, 1),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::slice_var_context(avc, {"y"}, {"sigma"}, 0, 1),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::slice_var_context(avc, {"y"}, {}, 0, 5),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::slice_var_context(avc, {"y"}, {}, 0, 0),
+               std::invalid_argument);
+}
@@ -0,0 +1,95 @@
+#include <stan/io/stan_csv_index.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+const std::string csv_dir = "src/test/unit/io/test_csv_files/";
+}
+
+TEST(StanIoStanCsvIndex, matches_stream_reader) {
+  for (const std::string name :
+       {"eight_schools.csv", "bernoulli_thin.csv", "bernoulli_warmup.csv",
+        "fixed_param_output.csv", "bernoulli_no_samples.csv"}) {
+    std::ifstream in(csv_dir + name, std::ios::binary);
+    stan::io::stan_csv expected = stan::io::stan_csv_reader::parse(in, nullptr);
+    in.clear();
+    in.seekg(0);
+    stan::io::stan_csv_index index = stan::io::stan_csv_index::build(in);
+    EXPECT_EQ(expected.header, index.header()) << name;
+    ASSERT_EQ(expected.samples.rows(), index.num_draws()) << name;
+    Eigen::MatrixXd draws = index.read_draws(in, 0, index.num_draws());
+    EXPECT_EQ(expected.samples.size(), draws.size()) << name;
+    if (draws.size() > 0)
+      EXPECT_TRUE(expected.samples == draws) << name;
+  }
+}
+
+TEST(StanIoStanCsvIndex, range_and_columns) {
+  std::ifstream in(csv_dir + "eight_schools.csv", std::ios::binary);
+  stan::io::stan_csv full = stan::io::stan_csv_reader::parse(in, nullptr);
+  in.clear();
+  in.seekg(0);
+  stan::io::stan_csv_index index = stan::io::stan_csv_index::build(in);
+  const size_t first = index.num_draws() - 10;
+  Eigen::MatrixXd tail
+      = index.read_draws(in, first, 100, {"tau", "lp__", "theta.2"});
+  ASSERT_EQ(10, tail.rows());
+  ASSERT_EQ(3, tail.cols());
+  const std::vector<std::string> names{"tau", "lp__", "theta[2]"};
+  for (size_t k = 0; k < names.size(); ++k) {
+    int col = std::find(full.header.begin(), full.header.end(), names[k])
+              - full.header.begin();
+    EXPECT_TRUE(full.samples.col(col).tail(10) == tail.col(k));
+  }
+  EXPECT_EQ(0, index.read_draws(in, index.num_draws(), 5).rows());
+  EXPECT_THROW(index.read_draws(in, index.num_draws() + 1, 5),
+               std::out_of_range);
+  EXPECT_THROW(index.read_draws(in, 0, 1, {"nope"}), std::invalid_argument);
+}
+
+TEST(StanIoStanCsvIndex, sidecar_round_trip) {
+  std::stringstream csv;
+  csv << "lp__,theta.1,theta.2\n-1,0.5,1.5\n# comment\n-2,0.25,2.5\n";
+  stan::io::stan_csv_index index = stan::io::stan_csv_index::build(csv);
+  std::stringstream sidecar;
+  index.write(sidecar);
+  stan::io::stan_csv_index loaded = stan::io::stan_csv_index::read(sidecar);
+  EXPECT_EQ(index.header(), loaded.header());
+  ASSERT_EQ(2, loaded.num_draws());
+  Eigen::MatrixXd draws = loaded.read_draws(csv, 1, 1);
+  EXPECT_EQ(-2, draws(0, 0));
+  EXPECT_EQ(2.5, draws(0, 2));
+
+  std::stringstream bad("stan_csv_index 1\n10\n2\nlp__\n");
+  EXPECT_THROW(stan::io::stan_csv_index::read(bad), std::invalid_argument);
+}
+
+TEST(StanIoStanCsvIndex, load_or_build) {
+  const std::string filename = "stan_csv_index_test.csv";
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << "lp__,x\n-1,1\n-2,2\n";
+  }
+  std::remove((filename + ".index").c_str());
+  stan::io::stan_csv_index built
+      = stan::io::stan_csv_index::load_or_build(filename);
+  EXPECT_EQ(2, built.num_draws());
+  EXPECT_TRUE(std::ifstream(filename + ".index").good());
+  EXPECT_EQ(2, stan::io::stan_csv_index::load_or_build(filename).num_draws());
+
+  // a sidecar for a file of another size is rebuilt
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::app);
+    out << "-3,3\n";
+  }
+  stan::io::stan_csv_index rebuilt
+      = stan::io::stan_csv_index::load_or_build(filename);
+  ASSERT_EQ(3, rebuilt.num_draws());
+  std::ifstream in(filename, std::ios::binary);
+  EXPECT_EQ(3, rebuilt.read_draws(in, 2, 1)(0, 1));
+  std::remove(filename.c_str());
+  std::remove((filename + ".index").c_str());
+}
@@ -0,0 +1,72 @@
+#include <stan/io/stan_csv_mapped_reader.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+
+namespace {
+const std::string csv_dir = "src/test/unit/io/test_csv_files/";
+
+void expect_same_as_stream_reader(const std::string& name) {
+  std::ifstream in(csv_dir + name);
+  std::stringstream out;
+  stan::io::stan_csv expected = stan::io::stan_csv_reader::parse(in, &out);
+  std::stringstream mapped_out;
+  stan::io::stan_csv mapped
+      = stan::io::stan_csv_mapped_reader::parse(csv_dir + name, &mapped_out);
+
+  EXPECT_EQ(expected.header, mapped.header) << name;
+  EXPECT_EQ(expected.metadata.num_samples, mapped.metadata.num_samples)
+      << name;
+  EXPECT_FLOAT_EQ(expected.adaptation.step_size, mapped.adaptation.step_size)
+      << name;
+  if (expected.samples.rows() > 0)
+    EXPECT_TRUE(expected.adaptation.metric == mapped.adaptation.metric)
+        << name;
+  EXPECT_FLOAT_EQ(expected.timing.warmup, mapped.timing.warmup) << name;
+  EXPECT_FLOAT_EQ(expected.timing.sampling, mapped.timing.sampling) << name;
+  ASSERT_EQ(expected.samples.rows(), mapped.samples.rows()) << name;
+  ASSERT_EQ(expected.samples.cols(), mapped.samples.cols()) << name;
+  EXPECT_TRUE(expected.samples == mapped.samples) << name;
+  EXPECT_EQ(out.str(), mapped_out.str()) << name;
+}
+}  // namespace
+
+TEST(StanIoStanCsvMappedReader, matches_stream_reader) {
+  for (const std::string name :
+       {"blocker.0.csv", "eight_schools.csv", "bernoulli_thin.csv",
+        "bernoulli_warmup.csv", "fixed_param_output.csv",
+        "bernoulli_no_samples.csv", "bernoulli_variational.csv"})
+    expect_same_as_stream_reader(name);
+}
+
+TEST(StanIoStanCsvMappedReader, column_projection) {
+  std::ifstream in(csv_dir + "eight_schools.csv");
+  stan::io::stan_csv full = stan::io::stan_csv_reader::parse(in, nullptr);
+  stan::io::stan_csv projected = stan::io::stan_csv_mapped_reader::parse(
+      csv_dir + "eight_schools.csv", nullptr, {"tau", "lp__", "theta[2]"});
+
+  std::vector<std::string> expected_header{"tau", "lp__", "theta[2]"};
+  EXPECT_EQ(expected_header, projected.header);
+  ASSERT_EQ(full.samples.rows(), projected.samples.rows());
+  ASSERT_EQ(3, projected.samples.cols());
+  for (size_t k = 0; k < expected_header.size(); ++k) {
+    int col = std::find(full.header.begin(), full.header.end(),
+                        expected_header[k])
+              - full.header.begin();
+    EXPECT_TRUE(full.samples.col(col) == projected.samples.col(k));
+  }
+}
+
+TEST(StanIoStanCsvMappedReader, unknown_column) {
+  EXPECT_THROW(stan::io::stan_csv_mapped_reader::parse(
+                   csv_dir + "eight_schools.csv", nullptr, {"not_a_column"}),
+               std::invalid_argument);
+}
+
+TEST(StanIoStanCsvMappedReader, empty_file) {
+  std::ofstream("stan_csv_mapped_reader_empty.csv");
+  EXPECT_THROW(stan::io::stan_csv_mapped_reader::parse(
+                   "stan_csv_mapped_reader_empty.csv", nullptr),
+               std::invalid_argument);
+  std::remove("stan_csv_mapped_reader_empty.csv");
+}
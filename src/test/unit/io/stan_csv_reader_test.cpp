@@ -241,6 +241,49 @@ TEST_F(StanIoStanCsvReader, read_adaptation1) {
   EXPECT_FLOAT_EQ(0.0248957, adaptation.metric(46));
 }
 
+TEST(StanIoStanCsvReaderAdaptation, read_dense_metric) {
+  std::stringstream in;
+  in << "# Adaptation terminated\n"
+     << "# Step size = 0.25\n"
+     << "# Elements of inverse mass matrix:\n"
+     << "# 1, 0.5,-2e-3\n"
+     << "# 0.5, +2, 0\n"
+     << "# -0.002, 0, 3 \n"
+     << "1,2,3\n";
+  stan::io::stan_csv_adaptation adaptation;
+  stan::io::stan_csv_reader::read_adaptation(in, adaptation);
+  EXPECT_FLOAT_EQ(0.25, adaptation.step_size);
+  ASSERT_EQ(3, adaptation.metric.rows());
+  ASSERT_EQ(3, adaptation.metric.cols());
+  Eigen::MatrixXd expected(3, 3);
+  expected << 1, 0.5, -2e-3, 0.5, 2, 0, -0.002, 0, 3;
+  EXPECT_EQ(expected, adaptation.metric);
+  std::string line;
+  std::getline(in, line);
+  EXPECT_EQ("1,2,3", line);
+}
+
+TEST(StanIoStanCsvReaderAdaptation, read_step_size_only) {
+  std::stringstream in;
+  in << "# Adaptation terminated\n"
+     << "# Step size = 1.5\n"
+     << "0,1\n";
+  stan::io::stan_csv_adaptation adaptation;
+  stan::io::stan_csv_reader::read_adaptation(in, adaptation);
+  EXPECT_FLOAT_EQ(1.5, adaptation.step_size);
+  EXPECT_EQ(0, adaptation.metric.size());
+  EXPECT_EQ('0', in.peek());
+}
+
+TEST(StanIoStanCsvReaderAdaptation, parse_double) {
+  const std::string field = "  +1.25e2 ";
+  EXPECT_FLOAT_EQ(125, stan::io::stan_csv_reader::parse_double(
+                           field.data(), field.data() + field.size()));
+  const std::string empty = "  ";
+  EXPECT_FLOAT_EQ(0, stan::io::stan_csv_reader::parse_double(
+                         empty.data(), empty.data() + empty.size()));
+}
+
 TEST_F(StanIoStanCsvReader, read_samples1) {
   Eigen::MatrixXd samples;
   stan::io::stan_csv_timing timing;
@@ -591,3 +634,29 @@ TEST_F(StanIoStanCsvReader, variational) {
   variational_stream.close();
   ASSERT_EQ(1000, variational.metadata.num_samples);
 }
+
+TEST_F(StanIoStanCsvReader, parse_into_buffer) {
+  std::stringstream out;
+  stan::io::stan_csv expected
+      = stan::io::stan_csv_reader::parse(blocker0_stream, &out);
+  stan::mcmc::chains_buffer buffer(expected.header.size());
+  buffer.append(0, expected.samples.topRows(3));
+
+  std::ifstream in("src/test/unit/io/test_csv_files/blocker.0.csv");
+  stan::io::stan_csv parsed
+      = stan::io::stan_csv_reader::parse(in, &out, buffer);
+  EXPECT_EQ("", out.str());
+  EXPECT_EQ(expected.header, parsed.header);
+  EXPECT_EQ(0, parsed.samples.size());
+  EXPECT_FLOAT_EQ(expected.timing.sampling, parsed.timing.sampling);
+  ASSERT_EQ(2, buffer.num_chains());
+  ASSERT_EQ(expected.samples.rows(), buffer.num_draws(1));
+  for (int param = 0; param < buffer.num_params(); ++param)
+    EXPECT_MATRIX_EQ(expected.samples.col(param), buffer.draws(param, 1));
+
+  stan::mcmc::chains_buffer narrow(2);
+  std::ifstream again("src/test/unit/io/test_csv_files/blocker.0.csv");
+  EXPECT_THROW(stan::io::stan_csv_reader::parse(again, &out, narrow),
+               std::invalid_argument);
+  EXPECT_EQ(0, narrow.num_chains());
+}
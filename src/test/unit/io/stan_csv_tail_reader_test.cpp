@@ -0,0 +1,86 @@
+#include <stan/io/stan_csv_tail_reader.hpp>
+#include <stan/analyze/mcmc/online_diagnostics.hpp>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+class StanIoStanCsvTailReader : public testing::Test {
+ public:
+  const std::string filename = "stan_csv_tail_reader_test.csv";
+
+  void SetUp() { std::remove(filename.c_str()); }
+  void TearDown() { std::remove(filename.c_str()); }
+
+  void append(const std::string& text) {
+    std::ofstream out(filename, std::ios::binary | std::ios::app);
+    out << text;
+  }
+};
+}  // namespace
+
+TEST_F(StanIoStanCsvTailReader, reads_appended_draws) {
+  stan::io::stan_csv_tail_reader reader(filename);
+  Eigen::MatrixXd draws;
+  EXPECT_EQ(0, reader.read(draws));
+  EXPECT_FALSE(reader.has_header());
+
+  append(
+      "# method = sample (Default)\n"
+      "#   num_warmup = 2\n"
+      "#   save_warmup = 1\n"
+      "lp__,accept_stat__,theta.1\n"
+      "-5,0.1,9\n");
+  EXPECT_EQ(0, reader.read(draws));
+  ASSERT_TRUE(reader.has_header());
+  EXPECT_EQ("theta[1]", reader.csv().header[2]);
+  EXPECT_EQ(2, reader.csv().metadata.num_warmup);
+
+  append(
+      "-6,0.2,8\n"
+      "# Adaptation terminated\n"
+      "# Step size = 0.5\n"
+      "# Diagonal elements of inverse mass matrix:\n"
+      "# 2\n"
+      "-1,0.9,0.5\n"
+      "-2,0.8,1.");
+  ASSERT_EQ(1, reader.read(draws));
+  EXPECT_EQ(3, draws.cols());
+  EXPECT_EQ(0.5, draws(0, 2));
+  EXPECT_EQ(0.5, reader.csv().adaptation.step_size);
+  EXPECT_EQ(2, reader.csv().adaptation.metric(0, 0));
+
+  append("5\n-3,0.7,2.5\n");
+  ASSERT_EQ(2, reader.read(draws));
+  EXPECT_EQ(1.5, draws(0, 2));
+  EXPECT_EQ(2.5, draws(1, 2));
+  EXPECT_EQ(3, reader.num_draws());
+
+  append(
+      "# \n"
+      "#  Elapsed Time: 0.25 seconds (Warm-up)\n"
+      "#                0.5 seconds (Sampling)\n");
+  EXPECT_EQ(0, reader.read(draws));
+  EXPECT_EQ(0.25, reader.csv().timing.warmup);
+  EXPECT_EQ(0.5, reader.csv().timing.sampling);
+
+  append("1,2\n");
+  EXPECT_THROW(reader.read(draws), std::invalid_argument);
+}
+
+TEST_F(StanIoStanCsvTailReader, feeds_online_diagnostics) {
+  stan::io::stan_csv_tail_reader reader(filename);
+  stan::analyze::online_diagnostics diagnostics;
+  append(
+      "# algorithm = fixed_param\n"
+      "lp__,x\n"
+      "0,1\n");
+  EXPECT_EQ(1, reader.read(diagnostics));
+  EXPECT_EQ(std::vector<std::string>({"lp__", "x"}), diagnostics.names());
+  append("0,3\n");
+  EXPECT_EQ(1, reader.read(diagnostics));
+  EXPECT_EQ(2, diagnostics.num_draws());
+  EXPECT_FLOAT_EQ(2, diagnostics.mean(1));
+}
@@ -0,0 +1,96 @@
+#include <stan/io/view_var_context.hpp>
+#include <gtest/gtest.h>
+#include <complex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+typedef stan::io::view_var_context::variable<double> real_variable;
+typedef stan::io::view_var_context::variable<int> int_variable;
+}  // namespace
+
+TEST(view_var_context, values) {
+  std::vector<double> y{1.5, 2.5, 3.5};
+  std::vector<double> x{1, 2, 3, 4, 5, 6};
+  double sigma = 0.25;
+  std::vector<int> g{1, 2, 2};
+  int N = 3;
+  stan::io::view_var_context context(
+      {{"y", y.data(), {3}},
+       {"x", x.data(), {3, 2}},
+       {"sigma", &sigma, {}},
+       {"empty", nullptr, {0}}},
+      {{"N", &N, {}}, {"g", g.data(), {3}}});
+
+  std::vector<std::string> names;
+  context.names_r(names);
+  EXPECT_EQ(std::vector<std::string>({"empty", "sigma", "x", "y"}), names);
+  context.names_i(names);
+  EXPECT_EQ(std::vector<std::string>({"N", "g"}), names);
+
+  EXPECT_TRUE(context.contains_r("x"));
+  EXPECT_TRUE(context.contains_r("g"));
+  EXPECT_FALSE(context.contains_i("x"));
+  EXPECT_TRUE(context.contains_i("g"));
+  EXPECT_FALSE(context.contains_r("z"));
+
+  EXPECT_EQ(x, context.vals_r("x"));
+  EXPECT_EQ(std::vector<size_t>({3, 2}), context.dims_r("x"));
+  EXPECT_EQ(std::vector<double>({0.25}), context.vals_r("sigma"));
+  EXPECT_TRUE(context.dims_r("sigma").empty());
+  EXPECT_TRUE(context.vals_r("empty").empty());
+  EXPECT_EQ(std::vector<size_t>({0}), context.dims_r("empty"));
+  EXPECT_EQ(std::vector<double>({1, 2, 2}), context.vals_r("g"));
+  EXPECT_EQ(g, context.vals_i("g"));
+  EXPECT_EQ(std::vector<size_t>({3}), context.dims_i("g"));
+  EXPECT_TRUE(context.vals_i("x").empty());
+  EXPECT_TRUE(context.dims_i("x").empty());
+
+  std::vector<std::complex<double>> c = context.vals_c("x");
+  ASSERT_EQ(3, c.size());
+  EXPECT_EQ(std::complex<double>(1, 4), c[0]);
+  EXPECT_EQ(std::complex<double>(3, 6), c[2]);
+
+  EXPECT_NO_THROW(context.validate_dims("data", "x", "double",
+                                        std::vector<size_t>{3, 2}));
+  EXPECT_THROW(context.validate_dims("data", "x", "double",
+                                     std::vector<size_t>{2, 3}),
+               std::exception);
+}
+
+TEST(view_var_context, views_refer_to_caller_memory) {
+  std::vector<double> x{1, 2, 3, 4};
+  std::vector<int> g{5, 6};
+  stan::io::view_var_context context({{"x", x.data(), {2, 2}}},
+                                     {{"g", g.data(), {2}}});
+
+  stan::io::values_view<double> x_view = context.view_r("x");
+  EXPECT_FALSE(x_view.owns_data());
+  EXPECT_EQ(x.data(), x_view.data());
+  EXPECT_EQ(4, x_view.size());
+
+  stan::io::values_view<int> g_view = context.view_i("g");
+  EXPECT_FALSE(g_view.owns_data());
+  EXPECT_EQ(g.data(), g_view.data());
+
+  // integers read as reals are converted
+  stan::io::values_view<double> g_real_view = context.view_r("g");
+  EXPECT_TRUE(g_real_view.owns_data());
+  EXPECT_EQ(std::vector<double>({5, 6}), g_real_view.to_vector());
+
+  // values changed by the caller are seen by the context
+  x[3] = 10;
+  EXPECT_EQ(10, context.vals_r("x")[3]);
+}
+
+TEST(view_var_context, errors) {
+  std::vector<double> x{1, 2};
+  int n = 1;
+  EXPECT_THROW(stan::io::view_var_context({{"x", x.data(), {2}}},
+                                          {{"x", &n, {}}}),
+               std::invalid_argument);
+  EXPECT_THROW(stan::io::view_var_context({{"x", nullptr, {2}}}),
+               std::invalid_argument);
+  EXPECT_NO_THROW(stan::io::view_var_context({{"x", nullptr, {2, 0}}}));
+}
@@ -0,0 +1,117 @@
+#include <stan/mcmc/batched_covar_estimator.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+Eigen::VectorXd draw(int i, int n) {
+  Eigen::VectorXd q(n);
+  for (int j = 0; j < n; ++j)
+    q(j) = std::sin(0.7 * i + 1.3 * j) + 0.01 * i * (j % 3) + j;
+  return q;
+}
+
+void expect_same_estimate(stan::math::welford_covar_estimator& expected,
+                          stan::mcmc::batched_covar_estimator& estimator) {
+  EXPECT_EQ(expected.num_samples(), estimator.num_samples());
+  Eigen::VectorXd mean, expected_mean;
+  expected.sample_mean(expected_mean);
+  estimator.sample_mean(mean);
+  Eigen::MatrixXd covar, expected_covar;
+  expected.sample_covariance(expected_covar);
+  estimator.sample_covariance(covar);
+  ASSERT_EQ(expected_covar.rows(), covar.rows());
+  for (int i = 0; i < covar.rows(); ++i) {
+    EXPECT_NEAR(expected_mean(i), mean(i), 1e-10);
+    for (int j = 0; j < covar.cols(); ++j)
+      EXPECT_NEAR(expected_covar(i, j), covar(i, j), 1e-10);
+  }
+}
+
+}  // namespace
+
+TEST(McmcBatchedCovarEstimator, matches_welford) {
+  const int n = 5;
+  for (int num_draws : {1, 2, 7, 32, 33, 100}) {
+    stan::math::welford_covar_estimator expected(n);
+    stan::mcmc::batched_covar_estimator estimator(n, 8);
+    for (int i = 0; i < num_draws; ++i) {
+      expected.add_sample(draw(i, n));
+      estimator.add_sample(draw(i, n));
+    }
+    expect_same_estimate(expected, estimator);
+  }
+}
+
+TEST(McmcBatchedCovarEstimator, parallel_matches_welford) {
+  const int n = 150;
+  stan::math::welford_covar_estimator expected(n);
+  stan::mcmc::batched_covar_estimator estimator(n);
+  estimator.set_parallel(true);
+  EXPECT_TRUE(estimator.parallel());
+  for (int i = 0; i < 70; ++i) {
+    expected.add_sample(draw(i, n));
+    estimator.add_sample(draw(i, n));
+  }
+  expect_same_estimate(expected, estimator);
+}
+
+TEST(McmcBatchedCovarEstimator, restart) {
+  const int n = 3;
+  stan::mcmc::batched_covar_estimator estimator(n, 4);
+  for (int i = 0; i < 6; ++i)
+    estimator.add_sample(draw(i, n));
+  estimator.restart();
+  EXPECT_EQ(0, estimator.num_samples());
+
+  stan::math::welford_covar_estimator expected(n);
+  for (int i = 0; i < 3; ++i) {
+    expected.add_sample(draw(i + 10, n));
+    estimator.add_sample(draw(i + 10, n));
+  }
+  expect_same_estimate(expected, estimator);
+}
+
+TEST(McmcBatchedCovarEstimator, checkpoint) {
+  const int n = 3;
+  stan::mcmc::batched_covar_estimator estimator(n, 4);
+  for (int i = 0; i < 6; ++i)
+    estimator.add_sample(draw(i, n));
+
+  std::stringstream output;
+  output << std::setprecision(std::numeric_limits<double>::max_digits10);
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&output)};
+  writer.begin_record();
+  estimator.write_checkpoint(writer, "est");
+  writer.end_record();
+
+  std::stringstream input(output.str());
+  stan::json::json_data context(input);
+  stan::mcmc::batched_covar_estimator restored(n, 4);
+  restored.read_checkpoint(context, "est");
+  EXPECT_EQ(estimator.num_samples(), restored.num_samples());
+
+  for (int i = 6; i < 11; ++i) {
+    estimator.add_sample(draw(i, n));
+    restored.add_sample(draw(i, n));
+  }
+  Eigen::MatrixXd covar, restored_covar;
+  estimator.sample_covariance(covar);
+  restored.sample_covariance(restored_covar);
+  EXPECT_TRUE(covar == restored_covar);
+
+  stan::mcmc::batched_covar_estimator small(n, 2);
+  EXPECT_THROW(small.read_checkpoint(context, "est"), std::invalid_argument);
+}
@@ -0,0 +1,50 @@
+#include <stan/mcmc/block_covar_adaptation.hpp>
+#include <stan/mcmc/covar_adaptation.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+TEST(McmcBlockCovarAdaptation, matches_covar_adaptation_per_block) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n_learn = 20;
+  stan::mcmc::block_covar_adaptation adapter({2, 1});
+  stan::mcmc::covar_adaptation first(2);
+  stan::mcmc::covar_adaptation second(1);
+  adapter.set_window_params(50, 0, 0, n_learn, logger);
+  first.set_window_params(50, 0, 0, n_learn, logger);
+  second.set_window_params(50, 0, 0, n_learn, logger);
+
+  std::vector<Eigen::MatrixXd> blocks{Eigen::MatrixXd::Identity(2, 2),
+                                      Eigen::MatrixXd::Identity(1, 1)};
+  Eigen::MatrixXd first_covar = Eigen::MatrixXd::Identity(2, 2);
+  Eigen::MatrixXd second_covar = Eigen::MatrixXd::Identity(1, 1);
+  Eigen::VectorXd q(3);
+  bool updated = false;
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, 0.5 * i + (i % 3), std::sqrt(i);
+    updated = adapter.learn_covariance(blocks, q);
+    first.learn_covariance(first_covar, q.head(2));
+    second.learn_covariance(second_covar, q.tail(1));
+    if (i + 1 < n_learn)
+      EXPECT_FALSE(updated);
+  }
+  EXPECT_TRUE(updated);
+
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_FLOAT_EQ(first_covar(i, j), blocks[0](i, j));
+  EXPECT_FLOAT_EQ(second_covar(0, 0), blocks[1](0, 0));
+  EXPECT_NE(0, blocks[0](0, 1));
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcBlockCovarAdaptation, memory_bytes) {
+  stan::mcmc::block_covar_adaptation adapter({2, 1});
+  EXPECT_EQ((2 * 3 + 1 * 2) * sizeof(double), adapter.memory_bytes());
+}
+
+TEST(McmcBlockCovarAdaptation, non_positive_block_size) {
+  EXPECT_THROW(stan::mcmc::block_covar_adaptation({2, 0}),
+               std::invalid_argument);
+}
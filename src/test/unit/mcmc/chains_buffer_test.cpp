@@ -0,0 +1,115 @@
+#include <stan/mcmc/chains_buffer.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+Eigen::MatrixXd draws(int rows, int cols, double offset) {
+  Eigen::MatrixXd x(rows, cols);
+  for (int i = 0; i < rows; ++i)
+    for (int j = 0; j < cols; ++j)
+      x(i, j) = offset + 100 * j + i;
+  return x;
+}
+
+}  // namespace
+
+TEST(McmcChainsBuffer, append) {
+  stan::mcmc::chains_buffer buffer(3);
+  EXPECT_EQ(3, buffer.num_params());
+  EXPECT_EQ(0, buffer.num_chains());
+
+  Eigen::MatrixXd x0 = draws(5, 3, 0);
+  Eigen::MatrixXd x1 = draws(7, 3, 0.5);
+  buffer.append(0, x0.topRows(2));
+  buffer.append(2, x1);
+  buffer.append(0, x0.bottomRows(3));
+  ASSERT_EQ(3, buffer.num_chains());
+  EXPECT_EQ(5, buffer.num_draws(0));
+  EXPECT_EQ(0, buffer.num_draws(1));
+  EXPECT_EQ(7, buffer.num_draws(2));
+
+  for (int param = 0; param < 3; ++param) {
+    EXPECT_MATRIX_EQ(x0.col(param), buffer.draws(param, 0));
+    EXPECT_MATRIX_EQ(x1.col(param), buffer.draws(param, 2));
+  }
+  EXPECT_THROW(buffer.append(0, draws(1, 2, 0)), std::invalid_argument);
+}
+
+TEST(McmcChainsBuffer, append_draw) {
+  stan::mcmc::chains_buffer buffer(4);
+  Eigen::MatrixXd x = draws(100, 4, 0);
+  for (int i = 0; i < x.rows(); ++i) {
+    buffer.append_draw(1) = x.row(i).transpose();
+    buffer.append_draw(0) = -x.row(i).transpose();
+  }
+  ASSERT_EQ(2, buffer.num_chains());
+  EXPECT_GE(buffer.chain_stride(), 100);
+  for (int param = 0; param < 4; ++param) {
+    EXPECT_MATRIX_EQ(-x.col(param), buffer.draws(param, 0));
+    EXPECT_MATRIX_EQ(x.col(param), buffer.draws(param, 1));
+    EXPECT_EQ(buffer.data(param, 0) + buffer.chain_stride(),
+              buffer.data(param, 1));
+  }
+}
+
+TEST(McmcChainsBuffer, param_view) {
+  stan::mcmc::chains_buffer buffer(2);
+  buffer.append(0, draws(6, 2, 0));
+  buffer.append(1, draws(4, 2, 1000));
+  auto view = buffer.draws(1);
+  ASSERT_EQ(4, view.rows());
+  ASSERT_EQ(2, view.cols());
+  EXPECT_MATRIX_EQ(draws(4, 2, 0).col(1), view.col(0));
+  EXPECT_MATRIX_EQ(draws(4, 2, 1000).col(1), view.col(1));
+
+  buffer.pop_chain();
+  EXPECT_EQ(1, buffer.num_chains());
+  EXPECT_EQ(6, buffer.draws(0).rows());
+}
+
+TEST(McmcChainsBuffer, memory_bytes) {
+  stan::mcmc::chains_buffer buffer(2);
+  EXPECT_EQ(0, buffer.memory_bytes());
+  buffer.append(0, draws(6, 2, 0));
+  buffer.append(1, draws(4, 2, 1000));
+  EXPECT_LE(2 * 2 * 6 * sizeof(double), buffer.memory_bytes());
+}
+
+TEST(McmcChainsBuffer, spilled) {
+  const std::string filename = "chains_buffer_test.spill";
+  {
+    stan::mcmc::chains_buffer buffer(3, filename);
+    stan::mcmc::chains_buffer in_memory(3);
+    EXPECT_TRUE(buffer.spilled());
+    EXPECT_FALSE(in_memory.spilled());
+    EXPECT_TRUE(std::ifstream(filename).good());
+
+    // appending a draw at a time grows the file many times
+    for (int chain = 0; chain < 3; ++chain) {
+      Eigen::MatrixXd x = draws(50 + chain, 3, 0.5 * chain);
+      for (int i = 0; i < x.rows(); ++i) {
+        buffer.append_draw(chain) = x.row(i).transpose();
+        in_memory.append(chain, x.row(i));
+      }
+    }
+    ASSERT_EQ(3, buffer.num_chains());
+    for (int param = 0; param < 3; ++param)
+      for (int chain = 0; chain < 3; ++chain)
+        EXPECT_MATRIX_EQ(in_memory.draws(param, chain),
+                         buffer.draws(param, chain));
+    EXPECT_MATRIX_EQ(in_memory.draws(1), buffer.draws(1));
+    EXPECT_LT(buffer.memory_bytes(), in_memory.memory_bytes());
+
+    stan::mcmc::chains_buffer copy(buffer);
+    EXPECT_FALSE(copy.spilled());
+    EXPECT_MATRIX_EQ(buffer.draws(2), copy.draws(2));
+  }
+  EXPECT_FALSE(std::ifstream(filename).good());
+  EXPECT_FALSE(std::ifstream(filename + ".grow").good());
+  EXPECT_THROW(stan::mcmc::chains_buffer(1, "no/such/dir/spill"),
+               std::invalid_argument);
+}
@@ -1,5 +1,7 @@
 #include <stan/mcmc/chains.hpp>
 #include <stan/io/stan_csv_reader.hpp>
+#include <boost/accumulators/statistics/tail_quantile.hpp>
+#include <test/unit/util.hpp>
 #include <gtest/gtest.h>
 #include <set>
 #include <exception>
@@ -686,6 +688,129 @@ TEST_F(McmcChains, blocker_quantiles) {
     EXPECT_FLOAT_EQ(quantiles(i), quantiles_by_name(i));
   }
 }
+
+TEST_F(McmcChains, blocker_quantiles_match_tail_quantile) {
+  using boost::accumulators::accumulator_set;
+  using boost::accumulators::left;
+  using boost::accumulators::quantile_probability;
+  using boost::accumulators::right;
+  using boost::accumulators::stats;
+  using boost::accumulators::tag::tail;
+  using boost::accumulators::tag::tail_quantile;
+
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::io::stan_csv blocker2
+      = stan::io::stan_csv_reader::parse(blocker2_stream, &out);
+  stan::mcmc::chains<> chains(blocker1);
+  chains.add(blocker2);
+
+  Eigen::VectorXd probs(9);
+  probs << 0.9, 0.025, 0.5, 0.001, 0.975, 0.25, 0.999, 0.5, 0.75;
+  Eigen::MatrixXd all_quantiles = chains.quantiles(probs);
+  ASSERT_EQ(chains.num_params(), all_quantiles.rows());
+  ASSERT_EQ(probs.size(), all_quantiles.cols());
+
+  for (int index = 0; index < chains.num_params(); index++) {
+    Eigen::VectorXd x = chains.samples(index);
+    accumulator_set<double, stats<tail_quantile<left> > > acc_left(
+        tail<left>::cache_size = x.size());
+    accumulator_set<double, stats<tail_quantile<right> > > acc_right(
+        tail<right>::cache_size = x.size());
+    for (int i = 0; i < x.size(); i++) {
+      acc_left(x(i));
+      acc_right(x(i));
+    }
+    Eigen::VectorXd quantiles = chains.quantiles(index, probs);
+    for (int i = 0; i < probs.size(); i++) {
+      double expected
+          = probs(i) < 0.5 ? boost::accumulators::quantile(
+                acc_left, quantile_probability = probs(i))
+                           : boost::accumulators::quantile(
+                               acc_right, quantile_probability = probs(i));
+      EXPECT_EQ(expected, quantiles(i));
+      EXPECT_EQ(expected, all_quantiles(index, i));
+      EXPECT_EQ(expected, chains.quantile(index, probs(i)));
+    }
+  }
+}
+
+TEST_F(McmcChains, add_stream) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::io::stan_csv blocker2
+      = stan::io::stan_csv_reader::parse(blocker2_stream, &out);
+  stan::mcmc::chains<> expected(blocker1);
+  expected.add(blocker2);
+
+  stan::mcmc::chains<> chains(blocker1.header);
+  std::ifstream in1("src/test/unit/mcmc/test_csv_files/blocker.1.csv");
+  chains.add(in1, &out);
+  std::ifstream in2("src/test/unit/mcmc/test_csv_files/blocker.2.csv");
+  chains.add(in2, &out);
+  EXPECT_EQ("", out.str());
+
+  ASSERT_EQ(expected.num_chains(), chains.num_chains());
+  EXPECT_EQ(expected.warmup(), chains.warmup());
+  for (int chain = 0; chain < chains.num_chains(); chain++) {
+    ASSERT_EQ(expected.num_samples(chain), chains.num_samples(chain));
+    for (int index = 0; index < chains.num_params(); index++)
+      EXPECT_MATRIX_EQ(expected.samples(chain, index),
+                       chains.kept_draws(chain, index));
+  }
+  EXPECT_FLOAT_EQ(expected.split_effective_sample_size(5),
+                  chains.split_effective_sample_size(5));
+
+  std::vector<std::string> names(blocker1.header);
+  names[3] = "not_a_param";
+  stan::mcmc::chains<> mismatched(names);
+  std::ifstream in3("src/test/unit/mcmc/test_csv_files/blocker.1.csv");
+  EXPECT_THROW(mismatched.add(in3, &out), std::invalid_argument);
+  EXPECT_EQ(0, mismatched.num_chains());
+}
+
+TEST_F(McmcChains, add_binary) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  std::stringstream binary;
+  {
+    stan::callbacks::binary_writer writer(binary, 100);
+    stan::callbacks::output_schema schema;
+    for (size_t i = 0; i < blocker1.header.size(); ++i)
+      schema.add(blocker1.header[i],
+                 i < 7 ? stan::callbacks::value_precision::float64
+                       : stan::callbacks::value_precision::float32);
+    writer(schema);
+    std::vector<double> row(blocker1.samples.cols());
+    for (Eigen::Index n = 0; n < blocker1.samples.rows(); ++n) {
+      for (size_t i = 0; i < row.size(); ++i)
+        row[i] = blocker1.samples(n, i);
+      writer(row);
+    }
+  }
+
+  stan::mcmc::chains<> chains(blocker1.header);
+  chains.add_binary(binary);
+  ASSERT_EQ(1, chains.num_chains());
+  ASSERT_EQ(blocker1.samples.rows(), chains.num_samples(0));
+  for (int n = 0; n < chains.num_samples(0); ++n) {
+    EXPECT_EQ(blocker1.samples(n, 0), chains.samples(0, 0)(n));
+    EXPECT_EQ(static_cast<float>(blocker1.samples(n, 7)),
+              chains.samples(0, 7)(n));
+  }
+
+  std::vector<std::string> names(blocker1.header);
+  names[3] = "not_a_param";
+  stan::mcmc::chains<> mismatched(names);
+  binary.clear();
+  binary.seekg(0);
+  EXPECT_THROW(mismatched.add_binary(binary), std::invalid_argument);
+  EXPECT_EQ(0, mismatched.num_chains());
+}
+
 TEST_F(McmcChains, blocker_central_interval) {
   std::stringstream out;
   stan::io::stan_csv blocker1
@@ -938,3 +1063,37 @@ TEST_F(McmcChains, blocker_split_potential_scale_reduction_rank) {
               chains.split_potential_scale_reduction_rank(name));
   }
 }
+
+TEST_F(McmcChains, spilled_summaries) {
+  std::stringstream out;
+  stan::io::stan_csv blocker1
+      = stan::io::stan_csv_reader::parse(blocker1_stream, &out);
+  stan::io::stan_csv blocker2
+      = stan::io::stan_csv_reader::parse(blocker2_stream, &out);
+
+  const std::string filename = "chains_test.spill";
+  {
+    stan::mcmc::chains<> chains(blocker1);
+    chains.add(blocker2);
+    stan::mcmc::chains<> spilled(blocker1.header, filename);
+    spilled.add(blocker1);
+    spilled.add(blocker2);
+    EXPECT_TRUE(spilled.draws().spilled());
+    ASSERT_EQ(2, spilled.num_chains());
+
+    Eigen::VectorXd probs(3);
+    probs << 0.05, 0.5, 0.95;
+    EXPECT_MATRIX_EQ(chains.quantiles(probs), spilled.quantiles(probs));
+    for (int i = 0; i < chains.num_params(); ++i) {
+      EXPECT_EQ(chains.mean(i), spilled.mean(i));
+      EXPECT_EQ(chains.sd(i), spilled.sd(i));
+      if (chains.sd(i) > 0) {
+        EXPECT_EQ(chains.split_effective_sample_size(i),
+                  spilled.split_effective_sample_size(i));
+        EXPECT_EQ(chains.split_potential_scale_reduction(i),
+                  spilled.split_potential_scale_reduction(i));
+      }
+    }
+  }
+  EXPECT_FALSE(std::ifstream(filename).good());
+}
@@ -0,0 +1,175 @@
+#include <stan/mcmc/checkpoint_state.hpp>
+#include <stan/mcmc/covar_adaptation.hpp>
+#include <stan/mcmc/stepsize_adaptation.hpp>
+#include <stan/mcmc/var_adaptation.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class McmcCheckpointState : public testing::Test {
+ public:
+  McmcCheckpointState()
+      : writer(std::unique_ptr<std::stringstream, deleter_noop>(&output)) {
+    output << std::setprecision(std::numeric_limits<double>::max_digits10);
+  }
+
+  std::unique_ptr<stan::json::json_data> checkpoint() {
+    input.str(output.str());
+    return std::make_unique<stan::json::json_data>(input);
+  }
+
+  std::stringstream output;
+  std::stringstream input;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer;
+  stan::test::unit::instrumented_logger logger;
+};
+
+}  // namespace
+
+TEST_F(McmcCheckpointState, welford_var_estimator) {
+  stan::math::welford_var_estimator estimator(2);
+  Eigen::VectorXd x(2);
+  x << 1, 2;
+  estimator.add_sample(x);
+  x << 0.3, -1.7;
+  estimator.add_sample(x);
+
+  writer.begin_record();
+  stan::mcmc::write_welford_state(writer, "est", estimator);
+  writer.end_record();
+
+  stan::math::welford_var_estimator restored(2);
+  stan::mcmc::read_welford_state(*checkpoint(), "est", restored);
+  EXPECT_EQ(estimator.num_samples(), restored.num_samples());
+
+  x << 2.1, 0.4;
+  estimator.add_sample(x);
+  restored.add_sample(x);
+  Eigen::VectorXd var(2), restored_var(2);
+  estimator.sample_variance(var);
+  restored.sample_variance(restored_var);
+  EXPECT_TRUE(var == restored_var);
+}
+
+TEST_F(McmcCheckpointState, welford_covar_estimator) {
+  stan::math::welford_covar_estimator estimator(2);
+  Eigen::VectorXd x(2);
+  x << 1, 2;
+  estimator.add_sample(x);
+  x << 0.3, -1.7;
+  estimator.add_sample(x);
+  x << 2.1, 0.4;
+  estimator.add_sample(x);
+
+  writer.begin_record();
+  stan::mcmc::write_welford_state(writer, "est", estimator);
+  writer.end_record();
+
+  stan::math::welford_covar_estimator restored(2);
+  stan::mcmc::read_welford_state(*checkpoint(), "est", restored);
+  Eigen::MatrixXd covar(2, 2), restored_covar(2, 2);
+  estimator.sample_covariance(covar);
+  restored.sample_covariance(restored_covar);
+  EXPECT_TRUE(covar == restored_covar);
+}
+
+TEST_F(McmcCheckpointState, rng) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 2);
+  rng();
+  writer.begin_record();
+  stan::mcmc::write_rng_state(writer, "rng", rng);
+  writer.end_record();
+
+  stan::rng_t restored = stan::services::util::create_rng(0, 0);
+  stan::mcmc::read_rng_state(*checkpoint(), "rng", restored);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(rng(), restored());
+}
+
+TEST_F(McmcCheckpointState, stepsize_adaptation) {
+  stan::mcmc::stepsize_adaptation adaptation;
+  adaptation.set_mu(std::log(10.0));
+  adaptation.set_delta(0.7);
+  adaptation.restart();
+  double epsilon = 1;
+  adaptation.learn_stepsize(epsilon, 0.5);
+  adaptation.learn_stepsize(epsilon, 0.9);
+
+  writer.begin_record();
+  adaptation.write_checkpoint(writer);
+  writer.end_record();
+
+  stan::mcmc::stepsize_adaptation restored;
+  restored.read_checkpoint(*checkpoint());
+  EXPECT_EQ(adaptation.get_mu(), restored.get_mu());
+  EXPECT_EQ(adaptation.get_delta(), restored.get_delta());
+
+  double restored_epsilon = epsilon;
+  adaptation.learn_stepsize(epsilon, 0.6);
+  restored.learn_stepsize(restored_epsilon, 0.6);
+  EXPECT_EQ(epsilon, restored_epsilon);
+  adaptation.complete_adaptation(epsilon);
+  restored.complete_adaptation(restored_epsilon);
+  EXPECT_EQ(epsilon, restored_epsilon);
+}
+
+TEST_F(McmcCheckpointState, covar_adaptation) {
+  const int n = 2;
+  stan::mcmc::covar_adaptation adaptation(n);
+  adaptation.set_window_params(50, 0, 0, 10, logger);
+  Eigen::MatrixXd covar(n, n);
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < 4; ++i) {
+    q << i, 2.0 / (i + 1);
+    adaptation.learn_covariance(covar, q);
+  }
+
+  writer.begin_record();
+  adaptation.write_checkpoint(writer);
+  writer.end_record();
+
+  stan::mcmc::covar_adaptation restored(n);
+  restored.set_window_params(50, 0, 0, 10, logger);
+  restored.read_checkpoint(*checkpoint());
+
+  Eigen::MatrixXd restored_covar(n, n);
+  for (int i = 4; i < 10; ++i) {
+    q << i, 2.0 / (i + 1);
+    EXPECT_EQ(adaptation.learn_covariance(covar, q),
+              restored.learn_covariance(restored_covar, q));
+  }
+  EXPECT_TRUE(covar == restored_covar);
+}
+
+TEST_F(McmcCheckpointState, var_adaptation_size_mismatch) {
+  stan::mcmc::var_adaptation adaptation(3);
+  adaptation.set_window_params(50, 0, 0, 10, logger);
+  writer.begin_record();
+  adaptation.write_checkpoint(writer);
+  writer.end_record();
+
+  stan::mcmc::var_adaptation restored(2);
+  EXPECT_THROW(restored.read_checkpoint(*checkpoint()), std::invalid_argument);
+}
+
+TEST_F(McmcCheckpointState, missing_value) {
+  writer.begin_record();
+  writer.write("other", 1.0);
+  writer.end_record();
+
+  stan::mcmc::stepsize_adaptation restored;
+  EXPECT_THROW(restored.read_checkpoint(*checkpoint()), std::invalid_argument);
+}
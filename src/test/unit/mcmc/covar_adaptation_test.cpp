@@ -27,3 +27,79 @@ TEST(McmcCovarAdaptation, learn_covariance) {
   }
   EXPECT_EQ(0, logger.call_count());
 }
+
+TEST(McmcCovarAdaptation, pool_covariance) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 3;
+  const int n_learn = 10;
+  Eigen::MatrixXd covar(Eigen::MatrixXd::Zero(n, n));
+  Eigen::MatrixXd pooled_covar(Eigen::MatrixXd::Zero(n, n));
+
+  stan::mcmc::covar_adaptation single(n);
+  stan::mcmc::covar_adaptation first(n);
+  stan::mcmc::covar_adaptation second(n);
+  single.set_window_params(100, 0, 0, 2 * n_learn, logger);
+  first.set_window_params(100, 0, 0, n_learn, logger);
+  second.set_window_params(100, 0, 0, n_learn, logger);
+  first.set_pooling(true);
+  second.set_pooling(true);
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, i * i, 1.0 / (i + 1);
+    single.learn_covariance(covar, q);
+    EXPECT_FALSE(first.learn_covariance(pooled_covar, q));
+    q << -2.0 * i, 3.0, std::sqrt(i);
+    single.learn_covariance(covar, q);
+    EXPECT_FALSE(second.learn_covariance(pooled_covar, q));
+  }
+  EXPECT_TRUE(first.window_complete());
+  EXPECT_TRUE(second.window_complete());
+
+  stan::mcmc::covar_adaptation::pool_covariance({&first, &second},
+                                                pooled_covar);
+  EXPECT_FALSE(first.window_complete());
+  EXPECT_FALSE(second.window_complete());
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < n; ++j) {
+      EXPECT_FLOAT_EQ(covar(i, j), pooled_covar(i, j));
+    }
+  }
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcCovarAdaptation, metric_scale) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 2;
+  const int n_learn = 100;
+  Eigen::MatrixXd covar = Eigen::MatrixXd::Identity(n, n);
+
+  stan::mcmc::covar_adaptation adapter(n);
+  adapter.set_window_params(200, 0, 0, n_learn, logger);
+  EXPECT_TRUE(std::isnan(adapter.metric_scale()));
+  adapter.set_estimate_metric_scale(true);
+
+  // draws along the diagonals with variances of about 4 and 0.25
+  Eigen::VectorXd q(n);
+  bool update = false;
+  for (int i = 0; i < n_learn; ++i) {
+    const double a = i % 2 == 0 ? 2 : -2;
+    const double b = (i / 2) % 2 == 0 ? 0.5 : -0.5;
+    q << (a + b) / std::sqrt(2.0), (a - b) / std::sqrt(2.0);
+    update = adapter.learn_covariance(covar, q);
+  }
+  ASSERT_TRUE(update);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(covar);
+  EXPECT_NEAR(1 / std::sqrt(solver.eigenvalues()(0)), adapter.metric_scale(),
+              1e-8);
+  EXPECT_GT(adapter.metric_scale(), 1.5);
+}
+
+TEST(McmcCovarAdaptation, memory_bytes) {
+  // mean and covariance, and a batch of 32 draws with their deviations
+  stan::mcmc::covar_adaptation adapter(3);
+  EXPECT_EQ((3 + 9 + 3 * 32 + 3 * 33) * sizeof(double),
+            adapter.memory_bytes());
+}
@@ -4,6 +4,7 @@
 #include <stan/services/util/create_rng.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <test/unit/util.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
 #include <gtest/gtest.h>
 
 namespace stan {
@@ -67,6 +68,38 @@ TEST(McmcBaseHMC, seed) {
     EXPECT_EQ(q(i), sampler.z().q(i));
 }
 
+TEST(McmcBaseHMC, seed_with_gradient) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::test::unit::instrumented_logger logger;
+
+  Eigen::VectorXd q(2);
+  q << 5, 1;
+  Eigen::VectorXd gradient(2);
+  gradient << 1, -1;
+
+  stan::mcmc::mock_model model(q.size());
+  stan::mcmc::mock_hmc sampler(model, base_rng);
+
+  // the seeded potential and gradient are used instead of the model's
+  sampler.seed(q, 2, gradient);
+  sampler.init_hamiltonian(logger);
+  EXPECT_EQ(5, sampler.z().q(0));
+  EXPECT_EQ(-2, sampler.z().V);
+  EXPECT_EQ(-1, sampler.z().g(0));
+  EXPECT_EQ(1, sampler.z().g(1));
+
+  // but only once
+  sampler.init_hamiltonian(logger);
+  EXPECT_EQ(0, sampler.z().V);
+  EXPECT_EQ(0, sampler.z().g(0));
+
+  // and not once the position has moved
+  sampler.seed(q, 2, gradient);
+  sampler.z().q(0) = 4;
+  sampler.init_hamiltonian(logger);
+  EXPECT_EQ(0, sampler.z().V);
+}
+
 TEST(McmcBaseHMC, set_nominal_stepsize) {
   stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
 
@@ -128,3 +161,39 @@ TEST(McmcBaseHMC, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(McmcBaseHMC, init_stepsize_estimate) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::test::unit::instrumented_logger logger;
+
+  Eigen::VectorXd q(2);
+  q(0) = 5;
+  q(1) = 1;
+
+  stan::mcmc::mock_model model(q.size());
+  stan::mcmc::mock_hmc sampler(model, base_rng);
+  sampler.seed(q);
+
+  // the mock Hamiltonian is constant, so the trial step always accepts
+  EXPECT_TRUE(sampler.init_stepsize(0.3, logger));
+  EXPECT_EQ(0.3, sampler.get_nominal_stepsize());
+  EXPECT_EQ(5, sampler.z().q(0));
+  EXPECT_EQ(1, sampler.z().q(1));
+
+  // without an estimate the heuristic doubles the step size without end
+  EXPECT_THROW(sampler.init_stepsize(std::numeric_limits<double>::quiet_NaN(),
+                                     logger),
+               std::runtime_error);
+  sampler.set_nominal_stepsize(0.1);
+  EXPECT_THROW(sampler.init_stepsize(-1, logger), std::runtime_error);
+}
+
+TEST(McmcBaseHMC, memory_bytes) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::mock_hmc sampler(model, base_rng);
+  // position, momentum and gradient
+  EXPECT_EQ(6 * sizeof(double), sampler.memory_bytes());
+  sampler.seed(Eigen::VectorXd::Zero(2), 0, Eigen::VectorXd::Zero(2));
+  EXPECT_EQ(10 * sizeof(double), sampler.memory_bytes());
+}
@@ -0,0 +1,72 @@
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/mcmc/hmc/dr_hmc/base_dr_hmc.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+class mock_dr_hmc : public base_dr_hmc<mock_model, mock_hamiltonian,
+                                       mock_integrator, stan::rng_t> {
+ public:
+  mock_dr_hmc(const mock_model& m, stan::rng_t& rng)
+      : base_dr_hmc<mock_model, mock_hamiltonian, mock_integrator,
+                    stan::rng_t>(m, rng) {}
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+TEST(McmcDrHmcBaseDrHmc, set_stages) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::mock_dr_hmc sampler(model, base_rng);
+
+  EXPECT_EQ(3, sampler.get_num_stages());
+  EXPECT_EQ(2, sampler.get_stepsize_reduction());
+
+  sampler.set_num_stages(2);
+  sampler.set_num_stages(0);
+  EXPECT_EQ(2, sampler.get_num_stages());
+
+  sampler.set_stepsize_reduction(4);
+  sampler.set_stepsize_reduction(1);
+  sampler.set_stepsize_reduction(-2);
+  EXPECT_EQ(4, sampler.get_stepsize_reduction());
+}
+
+TEST(McmcDrHmcBaseDrHmc, transition_accepts_first_stage) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::mock_dr_hmc sampler(model, base_rng);
+  sampler.set_nominal_stepsize_and_L(0.5, 4);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(2);
+  stan::mcmc::sample init_sample(q, 0, 0);
+  stan::mcmc::sample s = sampler.transition(init_sample, logger);
+
+  // a flat target accepts every proposal, which ends the transition
+  EXPECT_EQ(1, s.accept_stat());
+  EXPECT_EQ(1, sampler.get_stage());
+  EXPECT_EQ(4, sampler.get_n_leapfrog());
+
+  std::vector<std::string> names;
+  sampler.get_sampler_param_names(names);
+  EXPECT_EQ((std::vector<std::string>{"stepsize__", "int_time__",
+                                      "energy__", "stage__",
+                                      "n_leapfrog__"}),
+            names);
+  std::vector<double> values;
+  sampler.get_sampler_params(values);
+  ASSERT_EQ(5U, values.size());
+  EXPECT_EQ(1, values[3]);
+  EXPECT_EQ(4, values[4]);
+  EXPECT_EQ("", error.str());
+}
@@ -0,0 +1,119 @@
+#include <stan/mcmc/hmc/dr_hmc/diag_e_dr_hmc.hpp>
+#include <stan/mcmc/hmc/dr_hmc/dense_e_dr_hmc.hpp>
+#include <stan/mcmc/hmc/dr_hmc/adapt_diag_e_dr_hmc.hpp>
+#include <stan/mcmc/hmc/dr_hmc/adapt_dense_e_dr_hmc.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/util/create_rng.hpp>
+
+#include <test/test-models/good/mcmc/hmc/common/gauss.hpp>
+
+#include <gtest/gtest.h>
+
+typedef gauss_model_namespace::gauss_model gauss_model;
+
+class McmcDrHmc : public testing::Test {
+ public:
+  McmcDrHmc()
+      : logger(debug, info, warn, error, fatal),
+        model(data_var_context),
+        base_rng(stan::services::util::create_rng(4839294, 0)) {}
+
+  // run the sampler on a standard normal and check the draws; returns
+  // the number of draws accepted after the first stage
+  template <class Sampler>
+  int check_draws(Sampler& sampler, int num_draws) {
+    Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+    stan::mcmc::sample s(q, 0, 0);
+    double sum = 0;
+    double sum_sq = 0;
+    int num_rescued = 0;
+    for (int m = 0; m < num_draws; ++m) {
+      s = sampler.transition(s, logger);
+      EXPECT_GE(s.accept_stat(), 0);
+      EXPECT_LE(s.accept_stat(), 1);
+      EXPECT_LE(sampler.get_stage(), sampler.get_num_stages());
+      num_rescued += sampler.get_stage() > 1;
+      sum += s.cont_params()(0);
+      sum_sq += s.cont_params()(0) * s.cont_params()(0);
+    }
+    EXPECT_NEAR(0, sum / num_draws, 0.15);
+    EXPECT_NEAR(1, sum_sq / num_draws, 0.2);
+    EXPECT_EQ("", error.str());
+    return num_rescued;
+  }
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger;
+  stan::io::empty_var_context data_var_context;
+  gauss_model model;
+  stan::rng_t base_rng;
+};
+
+TEST_F(McmcDrHmc, diag_e_transition) {
+  stan::mcmc::diag_e_dr_hmc<gauss_model, stan::rng_t> sampler(model,
+                                                              base_rng);
+  sampler.set_nominal_stepsize_and_T(0.2, 1.2);
+  check_draws(sampler, 10000);
+}
+
+TEST_F(McmcDrHmc, diag_e_rescues_unstable_stepsize) {
+  // a step size above 2 is unstable on a standard normal, so the first
+  // stage nearly always rejects and the later ones sample
+  stan::mcmc::diag_e_dr_hmc<gauss_model, stan::rng_t> sampler(model,
+                                                              base_rng);
+  sampler.set_nominal_stepsize_and_L(2.5, 1);
+  sampler.set_num_stages(3);
+  sampler.set_stepsize_reduction(2);
+  EXPECT_GT(check_draws(sampler, 10000), 5000);
+}
+
+TEST_F(McmcDrHmc, dense_e_transition) {
+  stan::mcmc::dense_e_dr_hmc<gauss_model, stan::rng_t> sampler(model,
+                                                               base_rng);
+  sampler.set_nominal_stepsize_and_T(1.5, 3);
+  sampler.set_num_stages(2);
+  sampler.set_stepsize_reduction(4);
+  check_draws(sampler, 10000);
+}
+
+TEST_F(McmcDrHmc, adapt_diag_e_stepsize) {
+  stan::mcmc::adapt_diag_e_dr_hmc<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  stan::callbacks::logger silent;
+  sampler.set_window_params(1000, 75, 50, 25, silent);
+  sampler.set_nominal_stepsize_and_T(0.1, 1);
+  sampler.get_stepsize_adaptation().set_mu(std::log(10 * 0.1));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.engage_adaptation();
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  sampler.z().q = q;
+  sampler.init_stepsize(logger);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 1000; ++m)
+    s = sampler.transition(s, logger);
+  sampler.disengage_adaptation();
+  EXPECT_GT(sampler.get_nominal_stepsize(), 0.1);
+  EXPECT_LT(sampler.get_nominal_stepsize(), 2);
+  EXPECT_EQ(1, sampler.get_T());
+}
+
+TEST_F(McmcDrHmc, adapt_dense_e_stepsize) {
+  stan::mcmc::adapt_dense_e_dr_hmc<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  stan::callbacks::logger silent;
+  sampler.set_window_params(1000, 75, 50, 25, silent);
+  sampler.set_nominal_stepsize_and_T(0.1, 1);
+  sampler.get_stepsize_adaptation().set_mu(std::log(10 * 0.1));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.engage_adaptation();
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  sampler.z().q = q;
+  sampler.init_stepsize(logger);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 1000; ++m)
+    s = sampler.transition(s, logger);
+  sampler.disengage_adaptation();
+  EXPECT_GT(sampler.get_nominal_stepsize(), 0.1);
+  EXPECT_LT(sampler.get_nominal_stepsize(), 2);
+}
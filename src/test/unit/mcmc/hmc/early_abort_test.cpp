@@ -0,0 +1,55 @@
+#include <stan/mcmc/hmc/early_abort.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+TEST(McmcEarlyAbort, disabled) {
+  stan::mcmc::early_abort abort;
+  EXPECT_FALSE(abort.enabled());
+  EXPECT_TRUE(std::isinf(abort.threshold()));
+  EXPECT_FALSE(abort.doomed(1e300));
+  abort.record(10, false);
+  EXPECT_FALSE(abort.doomed(1e300));
+}
+
+TEST(McmcEarlyAbort, fixed_threshold) {
+  stan::mcmc::early_abort abort(30, 0);
+  EXPECT_TRUE(abort.enabled());
+  EXPECT_FLOAT_EQ(30, abort.threshold());
+  EXPECT_FALSE(abort.doomed(30));
+  EXPECT_TRUE(abort.doomed(31));
+  abort.record(100, true);
+  EXPECT_FLOAT_EQ(30, abort.threshold());
+  EXPECT_EQ(1, abort.num_aborted());
+}
+
+TEST(McmcEarlyAbort, learns_until_adaptation_completes) {
+  stan::mcmc::early_abort abort(20, 4, 0.5);
+  // no threshold until the first transition is recorded
+  EXPECT_FALSE(abort.doomed(1e300));
+
+  abort.record(10, false);
+  EXPECT_FLOAT_EQ(40, abort.threshold());
+  abort.record(2, false);
+  // the average is 6
+  EXPECT_FLOAT_EQ(24, abort.threshold());
+  // a negative error counts as none, and the minimum binds
+  abort.record(-1, false);
+  EXPECT_FLOAT_EQ(20, abort.threshold());
+  abort.record(50, true);
+  EXPECT_FLOAT_EQ(4 * 26.5, abort.threshold());
+
+  abort.complete_adaptation();
+  EXPECT_FALSE(abort.learning());
+  const double threshold = abort.threshold();
+  abort.record(1000, true);
+  EXPECT_FLOAT_EQ(threshold, abort.threshold());
+  EXPECT_EQ(2, abort.num_aborted());
+}
+
+TEST(McmcEarlyAbort, invalid_settings_throw) {
+  EXPECT_THROW(stan::mcmc::early_abort(0, 4), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::early_abort(20, -1), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::early_abort(20, 4, 0), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::early_abort(20, 4, 2), std::invalid_argument);
+}
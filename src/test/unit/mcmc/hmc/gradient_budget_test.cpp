@@ -0,0 +1,46 @@
+#include <stan/mcmc/hmc/gradient_budget.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(McmcGradientBudget, unlimited) {
+  stan::mcmc::gradient_budget budget;
+  EXPECT_FALSE(budget.enabled());
+  EXPECT_EQ(10, budget.max_depth(10));
+  budget.record(1023, false);
+  EXPECT_EQ(10, budget.max_depth(10));
+}
+
+TEST(McmcGradientBudget, per_transition) {
+  // a depth of d takes 2^d - 1 leapfrog steps
+  EXPECT_EQ(1, stan::mcmc::gradient_budget(1, 0).max_depth(10));
+  EXPECT_EQ(1, stan::mcmc::gradient_budget(2, 0).max_depth(10));
+  EXPECT_EQ(2, stan::mcmc::gradient_budget(3, 0).max_depth(10));
+  EXPECT_EQ(6, stan::mcmc::gradient_budget(100, 0).max_depth(10));
+  EXPECT_EQ(7, stan::mcmc::gradient_budget(127, 0).max_depth(10));
+  EXPECT_EQ(4, stan::mcmc::gradient_budget(127, 0).max_depth(4));
+}
+
+TEST(McmcGradientBudget, per_run) {
+  stan::mcmc::gradient_budget budget(15, 40);
+  EXPECT_TRUE(budget.enabled());
+  EXPECT_EQ(4, budget.max_depth(10));
+  budget.record(15, true);
+  budget.record(15, true);
+  EXPECT_EQ(30, budget.spent());
+  EXPECT_EQ(2, budget.num_capped());
+  // 10 steps are left
+  EXPECT_EQ(3, budget.max_depth(10));
+  budget.record(7, false);
+  EXPECT_EQ(2, budget.max_depth(10));
+  budget.record(3, true);
+  // a spent budget still leaves one step
+  EXPECT_EQ(1, budget.max_depth(10));
+  budget.record(1, true);
+  EXPECT_EQ(1, budget.max_depth(10));
+  EXPECT_EQ(4, budget.num_capped());
+}
+
+TEST(McmcGradientBudget, negative_throws) {
+  EXPECT_THROW(stan::mcmc::gradient_budget(-1, 0), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::gradient_budget(0, -1), std::invalid_argument);
+}
@@ -4,6 +4,7 @@
 #include <stan/io/empty_var_context.hpp>
 #include <stan/callbacks/stream_writer.hpp>
 #include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
 #include <test/unit/util.hpp>
 #include <gtest/gtest.h>
 
@@ -55,3 +56,51 @@ TEST(BaseHamiltonian, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+namespace {
+// model whose log density can not be evaluated at negative positions
+class rejecting_model : public stan::mcmc::mock_model {
+ public:
+  rejecting_model() : stan::mcmc::mock_model(1) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    if (params_r(0) < 0)
+      throw std::domain_error("negative position");
+    return -0.5 * params_r(0) * params_r(0);
+  }
+};
+}  // namespace
+
+TEST(BaseHamiltonian, rejections_without_exceptions) {
+  rejecting_model model;
+  stan::mcmc::mock_hamiltonian<rejecting_model, stan::rng_t> metric(model);
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::ps_point z(1);
+
+  z.q(0) = 2;
+  EXPECT_NO_THROW(metric.update_potential_gradient(z, logger));
+  EXPECT_FLOAT_EQ(2, z.V);
+  EXPECT_FLOAT_EQ(2, z.g(0));
+  EXPECT_EQ(0, metric.get_rejections().num_rejections());
+
+  z.q(0) = -1;
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_NO_THROW(metric.update_potential_gradient(z, logger));
+    EXPECT_EQ(std::numeric_limits<double>::infinity(), z.V);
+  }
+  EXPECT_NO_THROW(metric.update_potential(z, logger));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), z.V);
+  EXPECT_EQ(9, metric.get_rejections().num_rejections());
+  EXPECT_EQ(1, logger.find_error("about to be rejected"));
+  EXPECT_EQ(3, logger.find_error("rejected so far"));
+
+  z.q(0) = 1;
+  metric.update_potential(z, logger);
+  EXPECT_FLOAT_EQ(0.5, z.V);
+
+  metric.write_rejection_summary(logger);
+  EXPECT_EQ(1, logger.find_info("9 x negative position"));
+  EXPECT_EQ(0, metric.get_rejections().num_rejections());
+}
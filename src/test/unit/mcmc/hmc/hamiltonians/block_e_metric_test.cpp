@@ -0,0 +1,111 @@
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/block_e_metric.hpp>
+#include <stan/mcmc/hmc/hamiltonians/dense_e_metric.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void set_test_metric(stan::mcmc::block_e_point& z, Eigen::MatrixXd& dense) {
+  Eigen::MatrixXd first(2, 2);
+  first << 2.0, 0.5, 0.5, 1.0;
+  Eigen::MatrixXd second(1, 1);
+  second << 3.0;
+  z.set_metric({first, second});
+  dense = Eigen::MatrixXd::Zero(3, 3);
+  dense.topLeftCorner(2, 2) = first;
+  dense.bottomRightCorner(1, 1) = second;
+}
+
+}  // namespace
+
+TEST(McmcBlockEMetric, matches_dense) {
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::block_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t>
+      dense_metric(model);
+
+  stan::mcmc::block_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  z.p << 0.3, -1.2, 0.7;
+
+  stan::mcmc::dense_e_point z_dense(3);
+  z_dense.set_metric(inv_metric);
+  z_dense.p = z.p;
+
+  EXPECT_FLOAT_EQ(dense_metric.T(z_dense), metric.T(z));
+  Eigen::VectorXd p_sharp = metric.dtau_dp(z);
+  Eigen::VectorXd p_sharp_dense = dense_metric.dtau_dp(z_dense);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FLOAT_EQ(p_sharp_dense(i), p_sharp(i));
+
+  Eigen::VectorXd h_sharp;
+  EXPECT_FLOAT_EQ(dense_metric.T(z_dense), metric.H_dtau_dp(z, h_sharp));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FLOAT_EQ(p_sharp_dense(i), h_sharp(i));
+}
+
+TEST(McmcBlockEMetric, sample_p) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::block_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::block_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  Eigen::MatrixXd m = inv_metric.inverse();
+
+  int n_samples = 10000;
+  Eigen::MatrixXd sample_cov = Eigen::MatrixXd::Zero(3, 3);
+  for (int n = 0; n < n_samples; ++n) {
+    metric.sample_p(z, base_rng);
+    sample_cov += z.p * z.p.transpose() / n_samples;
+  }
+
+  // Covariance matrix within 5sigma of expected value (comes from a Wishart
+  // distribution)
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_LT(std::fabs(m(i, j) - sample_cov(i, j)),
+                5.0 * std::sqrt((m(i, j) * m(i, j) + m(i, i) * m(j, j))
+                                / n_samples));
+}
+
+TEST(McmcBlockEMetric, block_sizes) {
+  stan::mcmc::block_e_point z(3);
+  EXPECT_EQ(std::vector<int>({1, 1, 1}), z.block_sizes());
+  z.set_block_sizes({2, 1});
+  EXPECT_EQ(std::vector<int>({2, 1}), z.block_sizes());
+  EXPECT_TRUE(z.inv_e_metric_[0].isIdentity());
+  EXPECT_THROW(z.set_block_sizes({2, 2}), std::invalid_argument);
+  EXPECT_THROW(z.set_block_sizes({3, 0}), std::invalid_argument);
+  EXPECT_THROW(z.set_metric({Eigen::MatrixXd::Identity(3, 2)}),
+               std::invalid_argument);
+  EXPECT_EQ(std::vector<int>({2, 1}), z.block_sizes());
+}
+
+TEST(McmcBlockEMetric, write_metric) {
+  stan::mcmc::block_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+
+  std::stringstream ss;
+  stan::callbacks::stream_writer writer(ss);
+  z.write_metric(writer);
+  EXPECT_EQ(
+      "Elements of inverse mass matrix blocks:\n"
+      "Block 1:\n"
+      "2, 0.5\n"
+      "0.5, 1\n"
+      "Block 2:\n"
+      "3\n",
+      ss.str());
+  EXPECT_EQ("block_e", z.metric_type());
+}
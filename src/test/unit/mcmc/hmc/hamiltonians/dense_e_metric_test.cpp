@@ -168,3 +168,47 @@ TEST(McmcDenseEMetric, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(McmcDenseEMetric, cached_factor) {
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::dense_e_point z(2);
+  z.p << 0.5, -1.5;
+  EXPECT_FLOAT_EQ(0.5 * z.p.squaredNorm(), metric.T(z));
+
+  Eigen::MatrixXd m_inv(2, 2);
+  m_inv << 2.0, 0.5, 0.5, 1.0;
+  z.set_metric(m_inv);
+  EXPECT_FLOAT_EQ(0.5 * z.p.dot(m_inv * z.p), metric.T(z));
+
+  // changes made directly take effect once the factor is updated
+  z.inv_e_metric_(0, 0) = 3.0;
+  z.update_metric_factor();
+  EXPECT_FLOAT_EQ(0.5 * z.p.dot(z.inv_e_metric_ * z.p), metric.T(z));
+}
+
+TEST(McmcDenseEMetric, fused_steps) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::dense_e_point z(2);
+  Eigen::MatrixXd m_inv(2, 2);
+  m_inv << 2.0, 0.5, 0.5, 1.0;
+  z.set_metric(m_inv);
+  z.q << 1, -2;
+  z.p << 0.5, -1.5;
+  z.g << 0.25, 1;
+  z.V = 1.5;
+
+  Eigen::VectorXd p = z.p - 0.1 * z.g;
+  Eigen::VectorXd q = z.q + 0.2 * m_inv * p;
+  metric.kick_drift(z, 0.1, 0.2, logger);
+  EXPECT_MATRIX_NEAR(p, z.p, 1e-14);
+  EXPECT_MATRIX_NEAR(q, z.q, 1e-14);
+
+  Eigen::VectorXd p_sharp;
+  EXPECT_FLOAT_EQ(metric.H(z), metric.H_dtau_dp(z, p_sharp));
+  EXPECT_MATRIX_NEAR(metric.dtau_dp(z), p_sharp, 1e-14);
+}
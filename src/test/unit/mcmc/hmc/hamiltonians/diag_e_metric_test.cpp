@@ -148,3 +148,27 @@ TEST(McmcDiagEMetric, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(McmcDiagEMetric, fused_steps) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::diag_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::diag_e_point z(3);
+  z.q << 1, -2, 0.5;
+  z.p << 0.5, -1.5, 2;
+  z.g << 0.25, 1, -3;
+  z.V = 1.5;
+  z.inv_e_metric_ << 2, 0.5, 4;
+
+  Eigen::VectorXd p = z.p - 0.1 * z.g;
+  Eigen::VectorXd q = z.q + 0.2 * z.inv_e_metric_.cwiseProduct(p);
+  metric.kick_drift(z, 0.1, 0.2, logger);
+  EXPECT_MATRIX_NEAR(p, z.p, 1e-14);
+  EXPECT_MATRIX_NEAR(q, z.q, 1e-14);
+
+  Eigen::VectorXd p_sharp;
+  EXPECT_FLOAT_EQ(metric.H(z), metric.H_dtau_dp(z, p_sharp));
+  EXPECT_MATRIX_NEAR(metric.dtau_dp(z), p_sharp, 1e-14);
+}
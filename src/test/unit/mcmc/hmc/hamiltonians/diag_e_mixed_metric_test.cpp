@@ -0,0 +1,96 @@
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_metric.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_mixed_metric.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(McmcDiagEMixedMetric, metric_factor) {
+  stan::mcmc::diag_e_mixed_point z(3);
+  EXPECT_MATRIX_EQ(Eigen::VectorXf::Ones(3), z.inv_e_metric_f_);
+
+  Eigen::VectorXd inv_metric(3);
+  inv_metric << 0.1, 2, 3e5;
+  z.set_metric(inv_metric);
+  EXPECT_MATRIX_EQ(inv_metric.cast<float>(), z.inv_e_metric_f_);
+
+  // changes made directly take effect once the factor is updated
+  z.inv_e_metric_(0) = 4;
+  EXPECT_FLOAT_EQ(0.1, z.inv_e_metric_f_(0));
+  z.update_metric_factor();
+  EXPECT_FLOAT_EQ(4, z.inv_e_metric_f_(0));
+}
+
+TEST(McmcDiagEMixedMetric, matches_diag_e_metric) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::diag_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::diag_e_mixed_metric<stan::mcmc::mock_model, stan::rng_t>
+      mixed_metric(model);
+
+  Eigen::VectorXd inv_metric(3);
+  inv_metric << 2, 0.3, 4;
+  stan::mcmc::diag_e_point z(3);
+  stan::mcmc::diag_e_mixed_point z_mixed(3);
+  for (stan::mcmc::diag_e_point* point :
+       {&z, static_cast<stan::mcmc::diag_e_point*>(&z_mixed)}) {
+    point->q << 1, -2, 0.5;
+    point->p << 0.5, -1.5, 2;
+    point->g << 0.25, 1, -3;
+    point->V = 1.5;
+  }
+  z.set_metric(inv_metric);
+  z_mixed.set_metric(inv_metric);
+
+  // the metric is rounded to single precision, everything else is double
+  const double tol = 1e-6;
+  EXPECT_NEAR(metric.T(z), mixed_metric.T(z_mixed), tol);
+  EXPECT_MATRIX_NEAR(metric.dtau_dp(z), mixed_metric.dtau_dp(z_mixed), tol);
+
+  metric.kick_drift(z, 0.1, 0.2, logger);
+  mixed_metric.kick_drift(z_mixed, 0.1, 0.2, logger);
+  EXPECT_MATRIX_NEAR(z.p, z_mixed.p, tol);
+  EXPECT_MATRIX_NEAR(z.q, z_mixed.q, tol);
+
+  Eigen::VectorXd p_sharp;
+  EXPECT_FLOAT_EQ(mixed_metric.H(z_mixed),
+                  mixed_metric.H_dtau_dp(z_mixed, p_sharp));
+  EXPECT_MATRIX_NEAR(mixed_metric.dtau_dp(z_mixed), p_sharp, 1e-14);
+}
+
+TEST(McmcDiagEMixedMetric, sample_p) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::diag_e_mixed_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::diag_e_mixed_point z(2);
+  Eigen::VectorXd inv_metric(2);
+  inv_metric << 4, 0.25;
+  z.set_metric(inv_metric);
+
+  int n_samples = 1000;
+  double m = 0;
+  double m2 = 0;
+
+  for (int i = 0; i < n_samples; ++i) {
+    metric.sample_p(z, base_rng);
+    double tau = metric.tau(z);
+
+    double delta = tau - m;
+    m += delta / static_cast<double>(i + 1);
+    m2 += delta * (tau - m);
+  }
+
+  double var = m2 / (n_samples + 1.0);
+
+  // Mean within 5sigma of expected value (d / 2)
+  EXPECT_TRUE(std::fabs(m - 0.5 * z.q.size()) < 5.0 * sqrt(var));
+
+  // Variance within 10% of expected value (d / 2)
+  EXPECT_TRUE(std::fabs(var - 0.5 * z.q.size()) < 0.1 * z.q.size());
+}
@@ -0,0 +1,113 @@
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/dense_e_metric.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_e_metric.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void set_test_metric(stan::mcmc::lowrank_e_point& z, Eigen::MatrixXd& dense) {
+  Eigen::VectorXd d(3);
+  d << 0.5, 2.0, 1.5;
+  Eigen::MatrixXd u(3, 2);
+  u << 1.0, 0.5, -0.5, 1.0, 0.25, -1.0;
+  z.set_metric(d, u);
+  dense = u * u.transpose();
+  dense.diagonal() += d;
+}
+
+}  // namespace
+
+TEST(McmcLowRankEMetric, matches_dense) {
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::lowrank_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t>
+      dense_metric(model);
+
+  stan::mcmc::lowrank_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  z.p << 0.3, -1.2, 0.7;
+
+  stan::mcmc::dense_e_point z_dense(3);
+  z_dense.set_metric(inv_metric);
+  z_dense.p = z.p;
+
+  EXPECT_FLOAT_EQ(dense_metric.T(z_dense), metric.T(z));
+  Eigen::VectorXd p_sharp = metric.dtau_dp(z);
+  Eigen::VectorXd p_sharp_dense = dense_metric.dtau_dp(z_dense);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_FLOAT_EQ(p_sharp_dense(i), p_sharp(i));
+}
+
+TEST(McmcLowRankEMetric, sample_p) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::lowrank_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::lowrank_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  Eigen::MatrixXd m = inv_metric.inverse();
+
+  int n_samples = 10000;
+  Eigen::MatrixXd sample_cov = Eigen::MatrixXd::Zero(3, 3);
+  for (int n = 0; n < n_samples; ++n) {
+    metric.sample_p(z, base_rng);
+    sample_cov += z.p * z.p.transpose() / n_samples;
+  }
+
+  // Covariance matrix within 5sigma of expected value (comes from a Wishart
+  // distribution)
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_LT(std::fabs(m(i, j) - sample_cov(i, j)),
+                5.0 * std::sqrt((m(i, j) * m(i, j) + m(i, i) * m(j, j))
+                                / n_samples));
+}
+
+TEST(McmcLowRankEMetric, diagonal_only) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::rng_t diag_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::lowrank_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(
+      model);
+  stan::mcmc::lowrank_e_point z(2);
+  Eigen::VectorXd d(2);
+  d << 4.0, 0.25;
+  z.set_metric(d);
+  EXPECT_EQ(0, z.inv_e_metric_lowrank_.cols());
+
+  metric.sample_p(z, base_rng);
+  boost::variate_generator<stan::rng_t&, boost::normal_distribution<> >
+      rand_gaus(diag_rng, boost::normal_distribution<>());
+  for (int i = 0; i < 2; ++i)
+    EXPECT_FLOAT_EQ(rand_gaus() / std::sqrt(d(i)), z.p(i));
+}
+
+TEST(McmcLowRankEMetric, write_metric) {
+  stan::mcmc::lowrank_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+
+  std::stringstream ss;
+  stan::callbacks::stream_writer writer(ss);
+  z.write_metric(writer);
+  EXPECT_EQ(
+      "Diagonal elements of inverse mass matrix:\n"
+      "0.5, 2, 1.5\n"
+      "Low-rank factor of inverse mass matrix:\n"
+      "1, 0.5\n"
+      "-0.5, 1\n"
+      "0.25, -1\n",
+      ss.str());
+  EXPECT_EQ("lowrank_e", z.metric_type());
+}
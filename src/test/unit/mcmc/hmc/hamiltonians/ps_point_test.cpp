@@ -21,5 +21,31 @@ TEST(psPoint, write_metric_streams) {
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
 
+TEST(psPoint, swap) {
+  ps_point a(2);
+  a.q << 1, 2;
+  a.p << 3, 4;
+  a.g << 5, 6;
+  a.V = 7;
+  ps_point b(2);
+  b.q << -1, -2;
+  b.p << -3, -4;
+  b.g << -5, -6;
+  b.V = -7;
+  const double* a_q = a.q.data();
+
+  a.swap(b);
+  EXPECT_EQ(-1, a.q(0));
+  EXPECT_EQ(-4, a.p(1));
+  EXPECT_EQ(-5, a.g(0));
+  EXPECT_EQ(-7, a.V);
+  EXPECT_EQ(2, b.q(1));
+  EXPECT_EQ(3, b.p(0));
+  EXPECT_EQ(6, b.g(1));
+  EXPECT_EQ(7, b.V);
+  // the storage is exchanged, not copied
+  EXPECT_EQ(a_q, b.q.data());
+}
+
 }  // namespace mcmc
 }  // namespace stan
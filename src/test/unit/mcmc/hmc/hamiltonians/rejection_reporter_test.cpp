@@ -0,0 +1,70 @@
+#include <stan/mcmc/hmc/hamiltonians/rejection_reporter.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(McmcRejectionReporter, first_rejection_in_full) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::rejection_reporter reporter;
+  reporter.report("bad scale", logger);
+  EXPECT_EQ(1, reporter.num_rejections());
+  EXPECT_EQ(1, logger.find_error("about to be rejected"));
+  EXPECT_EQ(1, logger.find_error("bad scale"));
+  EXPECT_EQ(1, logger.find_error("ill-conditioned"));
+
+  // a new message is written in full, without the advice again
+  reporter.report("bad location", logger);
+  EXPECT_EQ(2, logger.find_error("about to be rejected"));
+  EXPECT_EQ(1, logger.find_error("bad location"));
+  EXPECT_EQ(1, logger.find_error("ill-conditioned"));
+}
+
+TEST(McmcRejectionReporter, rate_limited) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::rejection_reporter reporter;
+  for (int i = 0; i < 100; ++i)
+    reporter.report("bad scale", logger);
+  EXPECT_EQ(100, reporter.num_rejections());
+  // written in full once, then at 2, 4, ..., 64 rejections
+  EXPECT_EQ(1, logger.find_error("about to be rejected"));
+  EXPECT_EQ(6, logger.find_error("rejected so far"));
+  EXPECT_EQ(1, logger.find_error("64 proposals"));
+  EXPECT_EQ(0, logger.call_count_info());
+  ASSERT_EQ(1U, reporter.counts().size());
+  EXPECT_EQ("bad scale", reporter.counts()[0].first);
+  EXPECT_EQ(100, reporter.counts()[0].second);
+}
+
+TEST(McmcRejectionReporter, summary) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::rejection_reporter reporter;
+  reporter.write_summary(logger);
+  EXPECT_EQ(0, logger.call_count());
+
+  for (int i = 0; i < 3; ++i)
+    reporter.report("bad scale", logger);
+  reporter.report("bad location", logger);
+  reporter.write_summary(logger);
+  EXPECT_EQ(1, logger.find_info("4 proposals were rejected"));
+  EXPECT_EQ(1, logger.find_info("3 x bad scale"));
+  EXPECT_EQ(1, logger.find_info("1 x bad location"));
+  EXPECT_EQ(0, reporter.num_rejections());
+  EXPECT_TRUE(reporter.counts().empty());
+
+  // counting starts afresh
+  reporter.report("bad scale", logger);
+  EXPECT_EQ(3, logger.find_error("about to be rejected"));
+}
+
+TEST(McmcRejectionReporter, other_messages_counted_together) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::rejection_reporter reporter;
+  const std::size_t num_messages
+      = stan::mcmc::rejection_reporter::max_messages + 3;
+  for (std::size_t i = 0; i < num_messages; ++i)
+    reporter.report("issue " + std::to_string(i), logger);
+  EXPECT_EQ(stan::mcmc::rejection_reporter::max_messages,
+            reporter.counts().size());
+  reporter.write_summary(logger);
+  EXPECT_EQ(1, logger.find_info("3 x other issues"));
+}
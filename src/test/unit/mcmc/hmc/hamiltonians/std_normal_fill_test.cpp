@@ -0,0 +1,28 @@
+#include <stan/mcmc/hmc/hamiltonians/std_normal_fill.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <gtest/gtest.h>
+
+TEST(McmcStdNormalFill, matches_variate_generator) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 1);
+  stan::rng_t expected_rng = stan::services::util::create_rng(1234, 1);
+  boost::variate_generator<stan::rng_t&, boost::normal_distribution<> >
+      rand_gaus(expected_rng, boost::normal_distribution<>());
+
+  Eigen::VectorXd x(1000);
+  for (int n = 0; n < 3; ++n) {
+    stan::mcmc::std_normal_fill(x, rng);
+    for (int i = 0; i < x.size(); ++i)
+      EXPECT_EQ(rand_gaus(), x(i));
+  }
+  EXPECT_EQ(expected_rng, rng);
+}
+
+TEST(McmcStdNormalFill, empty) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 1);
+  stan::rng_t expected_rng = stan::services::util::create_rng(1234, 1);
+  Eigen::VectorXd x(0);
+  stan::mcmc::std_normal_fill(x, rng);
+  EXPECT_EQ(expected_rng, rng);
+}
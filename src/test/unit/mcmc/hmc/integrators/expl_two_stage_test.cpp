@@ -0,0 +1,143 @@
+#include <stan/mcmc/hmc/integrators/expl_two_stage.hpp>
+#include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/mcmc/hmc/hamiltonians/unit_e_metric.hpp>
+#include <stan/mcmc/hmc/hamiltonians/diag_e_metric.hpp>
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/static/base_static_hmc.hpp>
+#include <stan/mcmc/hmc/xhmc/base_xhmc.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/test-models/good/mcmc/hmc/integrators/gauss.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+
+typedef stan::mcmc::unit_e_metric<gauss_model_namespace::gauss_model,
+                                  stan::rng_t>
+    unit_e_gauss;
+
+// Error at time one of the trajectory from (1, 1), against the exact
+// rotation of phase space
+double expl_two_stage_error(double epsilon) {
+  stan::io::empty_var_context data_var_context;
+  std::stringstream model_output;
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  gauss_model_namespace::gauss_model model(data_var_context, 0, &model_output);
+
+  stan::mcmc::expl_two_stage<unit_e_gauss> integrator;
+  unit_e_gauss metric(model);
+
+  stan::mcmc::unit_e_point z(1);
+  z.q(0) = 1;
+  z.p(0) = 1;
+  metric.init(z, logger);
+
+  int L = std::round(1 / epsilon);
+  for (int n = 0; n < L; ++n)
+    integrator.evolve(z, metric, epsilon, logger);
+
+  double t = L * epsilon;
+  return std::hypot(z.q(0) - (std::cos(t) + std::sin(t)),
+                    z.p(0) - (std::cos(t) - std::sin(t)));
+}
+
+TEST(McmcHmcIntegratorsExplTwoStage, energy_conservation) {
+  stan::io::empty_var_context data_var_context;
+
+  std::stringstream model_output;
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  gauss_model_namespace::gauss_model model(data_var_context, 0, &model_output);
+
+  stan::mcmc::expl_two_stage<unit_e_gauss> integrator;
+  unit_e_gauss metric(model);
+
+  stan::mcmc::unit_e_point z(1);
+  z.q(0) = 1;
+  z.p(0) = 1;
+
+  metric.init(z, logger);
+  double H0 = metric.H(z);
+  double aveDeltaH = 0;
+
+  double epsilon = 1e-1;
+  double tau = 6.28318530717959;
+  size_t L = tau / epsilon;
+
+  for (size_t n = 0; n < L; ++n) {
+    integrator.evolve(z, metric, epsilon, logger);
+
+    double deltaH = metric.H(z) - H0;
+    aveDeltaH += (deltaH - aveDeltaH) / double(n + 1);
+  }
+
+  // Average error in Hamiltonian should be O(epsilon^{2})
+  EXPECT_NEAR(aveDeltaH, 0, 1e-6);
+
+  EXPECT_EQ("", model_output.str());
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
+TEST(McmcHmcIntegratorsExplTwoStage, order) {
+  // halving the step size divides the error by 2^order
+  double ratio = expl_two_stage_error(0.02) / expl_two_stage_error(0.01);
+  EXPECT_NEAR(4, ratio, 0.5);
+}
+
+TEST(McmcHmcIntegratorsExplTwoStage, default_delta) {
+  EXPECT_EQ(2, stan::mcmc::expl_two_stage<unit_e_gauss>::num_gradients());
+  EXPECT_LT(stan::mcmc::expl_leapfrog<unit_e_gauss>::default_delta(),
+            stan::mcmc::expl_two_stage<unit_e_gauss>::default_delta());
+  EXPECT_GT(1, stan::mcmc::expl_two_stage<unit_e_gauss>::default_delta());
+}
+
+TEST(McmcHmcIntegratorsExplTwoStage, samplers) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+  stan::io::empty_var_context data_var_context;
+  std::stringstream model_output;
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  gauss_model_namespace::gauss_model model(data_var_context, 0, &model_output);
+
+  stan::mcmc::base_nuts<gauss_model_namespace::gauss_model,
+                        stan::mcmc::diag_e_metric, stan::mcmc::expl_two_stage,
+                        stan::rng_t>
+      nuts(model, base_rng);
+  stan::mcmc::base_static_hmc<gauss_model_namespace::gauss_model,
+                              stan::mcmc::unit_e_metric,
+                              stan::mcmc::expl_two_stage, stan::rng_t>
+      static_hmc(model, base_rng);
+  stan::mcmc::base_xhmc<gauss_model_namespace::gauss_model,
+                        stan::mcmc::unit_e_metric, stan::mcmc::expl_two_stage,
+                        stan::rng_t>
+      xhmc(model, base_rng);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  stan::mcmc::sample init_sample(q, 0, 0);
+
+  nuts.set_nominal_stepsize(0.5);
+  stan::mcmc::sample s = nuts.transition(init_sample, logger);
+  EXPECT_TRUE(std::isfinite(s.cont_params()(0)));
+  EXPECT_LT(0.9, s.accept_stat());
+
+  static_hmc.set_nominal_stepsize(0.5);
+  s = static_hmc.transition(init_sample, logger);
+  EXPECT_TRUE(std::isfinite(s.cont_params()(0)));
+  EXPECT_LT(0.9, s.accept_stat());
+
+  xhmc.set_nominal_stepsize(0.5);
+  s = xhmc.transition(init_sample, logger);
+  EXPECT_TRUE(std::isfinite(s.cont_params()(0)));
+  EXPECT_LT(0.9, s.accept_stat());
+
+  EXPECT_EQ("", model_output.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
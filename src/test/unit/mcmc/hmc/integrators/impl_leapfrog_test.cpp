@@ -12,6 +12,8 @@
 #include <gtest/gtest.h>
 
 #include <sstream>
+#include <string>
+#include <vector>
 
 // namespace
 //************************************************************
@@ -583,6 +585,55 @@ TEST_F(McmcHmcIntegratorsImplLeapfrogF, softabs_evolve) {
   EXPECT_EQ("", fatal.str());
 }
 
+TEST_F(McmcHmcIntegratorsImplLeapfrogF, softabs_warm_start) {
+  typedef stan::mcmc::softabs_metric<command_model_namespace::command_model,
+                                     stan::rng_t>
+      metric_t;
+  metric_t hamiltonian(*model);
+
+  stan::mcmc::softabs_point z(1);
+  z.q(0) = 1.99987371079118;
+  z.p(0) = -1.58612292129732;
+  hamiltonian.init(z, logger);
+  stan::mcmc::softabs_point z_cold(z);
+
+  double epsilon = 0.1;
+  for (int n = 0; n < 5; ++n) {
+    softabs_integrator.evolve(z, hamiltonian, epsilon, logger);
+    // a new integrator has no previous step to start from
+    stan::mcmc::impl_leapfrog<metric_t> cold_integrator;
+    cold_integrator.evolve(z_cold, hamiltonian, epsilon, logger);
+    EXPECT_NEAR(z_cold.q(0), z.q(0), 1e-7);
+    EXPECT_NEAR(z_cold.p(0), z.p(0), 1e-7);
+  }
+
+  EXPECT_EQ(5, softabs_integrator.num_steps());
+  EXPECT_LE(5, softabs_integrator.num_fixed_point_q());
+  EXPECT_LE(5, softabs_integrator.num_fixed_point_p());
+
+  std::vector<std::string> names;
+  softabs_integrator.get_fixed_point_names(names);
+  std::vector<double> values;
+  softabs_integrator.get_fixed_point_values(values);
+  ASSERT_EQ(2, names.size());
+  ASSERT_EQ(2, values.size());
+  EXPECT_EQ("fixed_point_q__", names[0]);
+  EXPECT_EQ("fixed_point_p__", names[1]);
+  EXPECT_FLOAT_EQ(softabs_integrator.num_fixed_point_q() / 5.0, values[0]);
+  EXPECT_FLOAT_EQ(softabs_integrator.num_fixed_point_p() / 5.0, values[1]);
+
+  softabs_integrator.reset_num_fixed_point();
+  EXPECT_EQ(0, softabs_integrator.num_steps());
+  EXPECT_EQ(0, softabs_integrator.num_fixed_point_q());
+  EXPECT_EQ(0, softabs_integrator.num_fixed_point_p());
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
 TEST_F(McmcHmcIntegratorsImplLeapfrogF, streams) {
   stan::test::capture_std_streams();
 
@@ -1,4 +1,5 @@
 #include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/callbacks/cancellation_token.hpp>
 #include <stan/callbacks/stream_logger.hpp>
 #include <stan/mcmc/hmc/nuts/base_nuts.hpp>
 #include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
@@ -37,6 +38,23 @@ class rho_inspector_mock_nuts : public base_nuts<mock_model, mock_hamiltonian,
   }
 };
 
+// Tree builder calls the criterion of the derived class directly
+class crtp_rho_inspector_mock_nuts
+    : public base_nuts<mock_model, mock_hamiltonian, mock_integrator,
+                       stan::rng_t, crtp_rho_inspector_mock_nuts> {
+ public:
+  std::vector<double> rho_values;
+  crtp_rho_inspector_mock_nuts(const mock_model& m, stan::rng_t& rng)
+      : base_nuts<mock_model, mock_hamiltonian, mock_integrator, stan::rng_t,
+                  crtp_rho_inspector_mock_nuts>(m, rng) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    rho_values.push_back(rho(0));
+    return true;
+  }
+};
+
 class edge_inspector_mock_nuts
     : public base_nuts<mock_model, mock_hamiltonian, mock_integrator,
                        stan::rng_t> {
@@ -197,6 +215,55 @@ TEST(McmcNutsBaseNuts, build_tree_test) {
   EXPECT_EQ("", fatal.str());
 }
 
+TEST(McmcNutsBaseNuts, build_tree_beyond_max_depth_test) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::ps_point z_propose(model_size);
+
+  Eigen::VectorXd p_begin = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_sharp_begin = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_end = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_sharp_end = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd rho = z_init.p;
+
+  double log_sum_weight = -std::numeric_limits<double>::infinity();
+
+  double H0 = -0.1;
+  int n_leapfrog = 0;
+  double sum_metro_prob = 0;
+
+  stan::mcmc::mock_model model(model_size);
+  stan::mcmc::mock_nuts sampler(model, base_rng);
+
+  // the workspace is sized for a depth of 1 and grows during the tree
+  sampler.set_max_depth(1);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  bool valid_subtree = sampler.build_tree(
+      6, z_propose, p_sharp_begin, p_sharp_end, rho, p_begin, p_end, H0, 1,
+      n_leapfrog, log_sum_weight, sum_metro_prob, logger);
+
+  EXPECT_TRUE(valid_subtree);
+  EXPECT_EQ(64, n_leapfrog);
+  EXPECT_EQ(init_momentum * (n_leapfrog + 1), rho(0));
+  EXPECT_EQ(64 * init_momentum, sampler.z().q(0));
+  EXPECT_FLOAT_EQ(H0 + std::log(n_leapfrog), log_sum_weight);
+  EXPECT_EQ("", error.str());
+}
+
 TEST(McmcNutsBaseNuts, rho_aggregation_test) {
   stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
 
@@ -372,6 +439,45 @@ TEST(McmcNutsBaseNuts, transition) {
   EXPECT_EQ("", fatal.str());
 }
 
+TEST(McmcNutsBaseNuts, transition_stops_on_request) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+  stan::callbacks::cancellation_token token;
+  token.cancel();
+
+  for (bool iterative : {false, true}) {
+    stan::mcmc::mock_nuts sampler(model, base_rng);
+    sampler.set_max_depth(10);
+    sampler.set_iterative_tree(iterative);
+    sampler.set_nominal_stepsize(1);
+    sampler.set_stepsize_jitter(0);
+    sampler.sample_stepsize();
+    sampler.z() = z_init;
+    sampler.set_interrupt(&token);
+    EXPECT_TRUE(sampler.stop_requested());
+
+    // the first step is always taken, then the tree stops growing
+    stan::mcmc::sample s = sampler.transition(init_sample, logger);
+    EXPECT_EQ(1, sampler.n_leapfrog_);
+    EXPECT_EQ(1, sampler.depth_);
+    EXPECT_FALSE(sampler.divergent_);
+    EXPECT_TRUE(std::isfinite(s.accept_stat()));
+
+    sampler.set_interrupt(nullptr);
+    EXPECT_FALSE(sampler.stop_requested());
+    sampler.transition(init_sample, logger);
+    EXPECT_EQ(10, sampler.depth_);
+  }
+}
+
 TEST(McmcNutsBaseNuts, transition_egde_momenta) {
   stan::rng_t base_rng = stan::services::util::create_rng(42424253, 0);
 
@@ -436,3 +542,406 @@ TEST(McmcNutsBaseNuts, transition_egde_momenta) {
   EXPECT_EQ(init_momentum, sampler.p_sharp_minus_values[8]);
   EXPECT_EQ(3 * init_momentum, sampler.p_sharp_plus_values[8]);
 }
+
+TEST(McmcNutsBaseNuts, transition_after_increasing_max_depth) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+  stan::mcmc::mock_nuts sampler(model, base_rng);
+
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  // Workspace is reused across transitions and grown with the max depth
+  for (int max_depth = 2; max_depth <= 8; max_depth += 3) {
+    sampler.set_max_depth(max_depth);
+    sampler.z() = z_init;
+    stan::mcmc::sample s = sampler.transition(init_sample, logger);
+
+    EXPECT_EQ(max_depth, sampler.depth_);
+    EXPECT_EQ((2 << (max_depth - 1)) - 1, sampler.n_leapfrog_);
+    EXPECT_FALSE(sampler.divergent_);
+    EXPECT_EQ(1, s.accept_stat());
+  }
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
+TEST(McmcNutsBaseNuts, build_tree_iterative_matches_recursive) {
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  for (int depth = 0; depth < 5; ++depth) {
+    std::vector<std::vector<double>> rho_values;
+    std::vector<Eigen::VectorXd> results;
+    std::vector<double> log_sum_weights;
+    std::vector<int> n_leapfrogs;
+
+    for (bool iterative : {false, true}) {
+      stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+      stan::mcmc::rho_inspector_mock_nuts sampler(model, base_rng);
+      sampler.set_iterative_tree(iterative);
+      sampler.set_nominal_stepsize(1);
+      sampler.set_stepsize_jitter(0);
+      sampler.sample_stepsize();
+      sampler.z() = z_init;
+
+      stan::mcmc::ps_point z_propose(model_size);
+      Eigen::VectorXd p_begin = Eigen::VectorXd::Zero(model_size);
+      Eigen::VectorXd p_sharp_begin = Eigen::VectorXd::Zero(model_size);
+      Eigen::VectorXd p_end = Eigen::VectorXd::Zero(model_size);
+      Eigen::VectorXd p_sharp_end = Eigen::VectorXd::Zero(model_size);
+      Eigen::VectorXd rho = z_init.p;
+
+      double log_sum_weight = -std::numeric_limits<double>::infinity();
+      double H0 = -0.1;
+      int n_leapfrog = 0;
+      double sum_metro_prob = 0;
+
+      bool valid_subtree = sampler.extend_tree(
+          depth, z_propose, p_sharp_begin, p_sharp_end, rho, p_begin, p_end,
+          H0, 1, n_leapfrog, log_sum_weight, sum_metro_prob, logger);
+      EXPECT_TRUE(valid_subtree);
+
+      Eigen::VectorXd result(7);
+      result << z_propose.q(0), p_sharp_begin(0), p_sharp_end(0), rho(0),
+          p_begin(0), p_end(0), sampler.z().q(0);
+      results.push_back(result);
+      rho_values.push_back(sampler.rho_values);
+      log_sum_weights.push_back(log_sum_weight);
+      n_leapfrogs.push_back(n_leapfrog);
+    }
+
+    EXPECT_EQ(rho_values[0], rho_values[1]);
+    EXPECT_EQ(log_sum_weights[0], log_sum_weights[1]);
+    EXPECT_EQ(n_leapfrogs[0], n_leapfrogs[1]);
+    for (int i = 0; i < results[0].size(); ++i)
+      EXPECT_EQ(results[0](i), results[1](i));
+  }
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
+TEST(McmcNutsBaseNuts, transition_iterative_matches_recursive) {
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::rng_t recursive_rng = stan::services::util::create_rng(42424253, 0);
+  stan::mcmc::edge_inspector_mock_nuts recursive_sampler(model, recursive_rng);
+
+  stan::rng_t iterative_rng = stan::services::util::create_rng(42424253, 0);
+  stan::mcmc::edge_inspector_mock_nuts iterative_sampler(model, iterative_rng);
+  iterative_sampler.set_iterative_tree(true);
+  EXPECT_TRUE(iterative_sampler.get_iterative_tree());
+
+  for (auto* sampler : {&recursive_sampler, &iterative_sampler}) {
+    sampler->set_max_depth(4);
+    sampler->set_nominal_stepsize(1);
+    sampler->set_stepsize_jitter(0);
+    sampler->sample_stepsize();
+    sampler->z() = z_init;
+  }
+
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+  for (int n = 0; n < 5; ++n) {
+    stan::mcmc::sample s_recursive
+        = recursive_sampler.transition(init_sample, logger);
+    stan::mcmc::sample s_iterative
+        = iterative_sampler.transition(init_sample, logger);
+
+    EXPECT_EQ(s_recursive.cont_params()(0), s_iterative.cont_params()(0));
+    EXPECT_EQ(s_recursive.accept_stat(), s_iterative.accept_stat());
+    EXPECT_EQ(recursive_sampler.depth_, iterative_sampler.depth_);
+    EXPECT_EQ(recursive_sampler.n_leapfrog_, iterative_sampler.n_leapfrog_);
+    init_sample = s_recursive;
+  }
+
+  EXPECT_EQ(recursive_sampler.p_sharp_minus_values,
+            iterative_sampler.p_sharp_minus_values);
+  EXPECT_EQ(recursive_sampler.p_sharp_plus_values,
+            iterative_sampler.p_sharp_plus_values);
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
+TEST(McmcNutsBaseNuts, transition_feeds_trajectory_estimator) {
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::rng_t recursive_rng = stan::services::util::create_rng(42424253, 0);
+  stan::mcmc::mock_nuts recursive_sampler(model, recursive_rng);
+  stan::rng_t iterative_rng = stan::services::util::create_rng(42424253, 0);
+  stan::mcmc::mock_nuts iterative_sampler(model, iterative_rng);
+  iterative_sampler.set_iterative_tree(true);
+
+  stan::mcmc::trajectory_estimator recursive_estimator({0});
+  stan::mcmc::trajectory_estimator iterative_estimator({0});
+  recursive_sampler.set_trajectory_estimator(&recursive_estimator);
+  iterative_sampler.set_trajectory_estimator(&iterative_estimator);
+  EXPECT_EQ(&iterative_estimator,
+            iterative_sampler.get_trajectory_estimator());
+
+  for (auto* sampler : {&recursive_sampler, &iterative_sampler}) {
+    sampler->set_max_depth(4);
+    sampler->set_nominal_stepsize(1);
+    sampler->set_stepsize_jitter(0);
+    sampler->sample_stepsize();
+    sampler->z() = z_init;
+  }
+
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+  for (int n = 0; n < 5; ++n) {
+    recursive_sampler.transition(init_sample, logger);
+    iterative_sampler.transition(init_sample, logger);
+  }
+  ASSERT_EQ(5U, recursive_estimator.num_transitions());
+  ASSERT_EQ(5U, iterative_estimator.num_transitions());
+  EXPECT_TRUE(std::isfinite(recursive_estimator.mean()(0)));
+  EXPECT_FLOAT_EQ(recursive_estimator.mean()(0),
+                  iterative_estimator.mean()(0));
+  EXPECT_FLOAT_EQ(recursive_estimator.variance()(0),
+                  iterative_estimator.variance()(0));
+
+  // a transition stopped on request is not averaged
+  stan::callbacks::cancellation_token token;
+  token.cancel();
+  recursive_sampler.set_interrupt(&token);
+  recursive_sampler.transition(init_sample, logger);
+  EXPECT_EQ(5U, recursive_estimator.num_transitions());
+
+  recursive_sampler.set_trajectory_estimator(nullptr);
+  recursive_sampler.set_interrupt(nullptr);
+  recursive_sampler.transition(init_sample, logger);
+  EXPECT_EQ(5U, recursive_estimator.num_transitions());
+}
+
+TEST(McmcNutsBaseNuts, rho_aggregation_crtp) {
+  int model_size = 1;
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(model_size);
+  stan::rng_t virtual_rng = stan::services::util::create_rng(0, 0);
+  stan::mcmc::rho_inspector_mock_nuts virtual_sampler(model, virtual_rng);
+  stan::rng_t crtp_rng = stan::services::util::create_rng(0, 0);
+  stan::mcmc::crtp_rho_inspector_mock_nuts crtp_sampler(model, crtp_rng);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  auto build = [&](auto& sampler) {
+    stan::mcmc::ps_point z_propose(model_size);
+    Eigen::VectorXd p_begin = Eigen::VectorXd::Zero(model_size);
+    Eigen::VectorXd p_sharp_begin = Eigen::VectorXd::Zero(model_size);
+    Eigen::VectorXd p_end = Eigen::VectorXd::Zero(model_size);
+    Eigen::VectorXd p_sharp_end = Eigen::VectorXd::Zero(model_size);
+    Eigen::VectorXd rho = z_init.p;
+    double log_sum_weight = -std::numeric_limits<double>::infinity();
+    int n_leapfrog = 0;
+    double sum_metro_prob = 0;
+
+    sampler.set_nominal_stepsize(1);
+    sampler.set_stepsize_jitter(0);
+    sampler.sample_stepsize();
+    sampler.z() = z_init;
+    sampler.build_tree(3, z_propose, p_sharp_begin, p_sharp_end, rho, p_begin,
+                       p_end, -0.1, 1, n_leapfrog, log_sum_weight,
+                       sum_metro_prob, logger);
+  };
+  build(virtual_sampler);
+  build(crtp_sampler);
+
+  ASSERT_EQ(7 * 3, crtp_sampler.rho_values.size());
+  for (size_t i = 0; i < crtp_sampler.rho_values.size(); ++i)
+    EXPECT_EQ(virtual_sampler.rho_values[i], crtp_sampler.rho_values[i]);
+}
+
+TEST(McmcNutsBaseNuts, transition_gradient_budget) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::mock_nuts sampler(model, base_rng);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+  sampler.set_max_depth(10);
+
+  std::vector<std::string> names;
+  sampler.get_sampler_param_names(names);
+  EXPECT_EQ(5, names.size());
+  sampler.set_gradient_budget(20, 24);
+  names.clear();
+  sampler.get_sampler_param_names(names);
+  ASSERT_EQ(6, names.size());
+  EXPECT_EQ("budget_capped__", names.back());
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  // the budget of 20 steps allows a depth of 4, 15 steps
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(4, sampler.depth_);
+  EXPECT_EQ(15, sampler.n_leapfrog_);
+  std::vector<double> values;
+  sampler.get_sampler_params(values);
+  ASSERT_EQ(6, values.size());
+  EXPECT_EQ(1, values.back());
+
+  // 9 steps of the run are left
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(3, sampler.depth_);
+  EXPECT_EQ(22, sampler.get_gradient_budget().spent());
+
+  sampler.transition(init_sample, logger);
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(1, sampler.depth_);
+  EXPECT_EQ(1, sampler.n_leapfrog_);
+  EXPECT_EQ(4, sampler.get_gradient_budget().num_capped());
+}
+
+TEST(McmcNutsBaseNuts, early_abort_test) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::ps_point z_propose(1);
+  Eigen::VectorXd p_begin = Eigen::VectorXd::Zero(1);
+  Eigen::VectorXd p_sharp_begin = Eigen::VectorXd::Zero(1);
+  Eigen::VectorXd p_end = Eigen::VectorXd::Zero(1);
+  Eigen::VectorXd p_sharp_end = Eigen::VectorXd::Zero(1);
+  Eigen::VectorXd rho = z_init.p;
+  double log_sum_weight = -std::numeric_limits<double>::infinity();
+  double H0 = -0.1;
+  int n_leapfrog = 0;
+  double sum_metro_prob = 0;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::divergent_nuts sampler(model, base_rng);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+
+  std::vector<std::string> names;
+  sampler.get_sampler_param_names(names);
+  EXPECT_EQ(5, names.size());
+  sampler.set_early_abort(100, 0);
+  names.clear();
+  sampler.get_sampler_param_names(names);
+  ASSERT_EQ(6, names.size());
+  EXPECT_EQ("aborted__", names.back());
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  // an energy error of 250 is below the divergence threshold but dooms
+  // the subtree
+  sampler.z().V = -250;
+  bool valid_subtree = sampler.build_tree(
+      0, z_propose, p_sharp_begin, p_sharp_end, rho, p_begin, p_end, H0, 1,
+      n_leapfrog, log_sum_weight, sum_metro_prob, logger);
+  EXPECT_FALSE(valid_subtree);
+  EXPECT_FALSE(sampler.divergent_);
+  EXPECT_TRUE(sampler.aborted_);
+
+  // a divergence is still reported as one
+  sampler.aborted_ = false;
+  sampler.z().V = 750;
+  valid_subtree = sampler.build_tree(
+      0, z_propose, p_sharp_begin, p_sharp_end, rho, p_begin, p_end, H0, 1,
+      n_leapfrog, log_sum_weight, sum_metro_prob, logger);
+  EXPECT_FALSE(valid_subtree);
+  EXPECT_TRUE(sampler.divergent_);
+  EXPECT_FALSE(sampler.aborted_);
+
+  EXPECT_EQ("", error.str());
+}
+
+TEST(McmcNutsBaseNuts, transition_early_abort) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::divergent_nuts sampler(model, base_rng);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+  sampler.set_max_depth(10);
+  sampler.set_early_abort(100, 0);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  // every step raises the energy by 500, so the first one is doomed
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(1, sampler.n_leapfrog_);
+  EXPECT_EQ(0, sampler.depth_);
+  EXPECT_FALSE(sampler.divergent_);
+  std::vector<double> values;
+  sampler.get_sampler_params(values);
+  ASSERT_EQ(6, values.size());
+  EXPECT_EQ(1, values.back());
+  EXPECT_EQ(1, sampler.get_early_abort().num_aborted());
+}
@@ -0,0 +1,170 @@
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/mcmc/hmc/nuts/base_speculative_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+class mock_speculative_nuts
+    : public base_speculative_nuts<mock_model, mock_hamiltonian,
+                                   mock_integrator, stan::rng_t> {
+ public:
+  mock_speculative_nuts(const mock_model& m, stan::rng_t& rng)
+      : base_speculative_nuts<mock_model, mock_hamiltonian, mock_integrator,
+                              stan::rng_t>(m, rng) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    return true;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+TEST(McmcNutsBaseSpeculativeNuts, transition) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+  stan::mcmc::mock_speculative_nuts sampler(model, base_rng);
+
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  // Transition will expand trajectory until max_depth is hit
+  stan::mcmc::sample s = sampler.transition(init_sample, logger);
+
+  EXPECT_EQ(sampler.get_max_depth(), sampler.depth_);
+  EXPECT_EQ((2 << (sampler.get_max_depth() - 1)) - 1, sampler.n_leapfrog_);
+  EXPECT_FALSE(sampler.divergent_);
+  EXPECT_EQ(0, s.log_prob());
+  EXPECT_EQ(1, s.accept_stat());
+
+  // The proposal lies on the trajectory
+  double q = s.cont_params()(0) / init_momentum;
+  EXPECT_EQ(std::round(q), q);
+  EXPECT_LE(std::abs(q), sampler.n_leapfrog_);
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
+
+TEST(McmcNutsBaseSpeculativeNuts, reproducible) {
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  stan::mcmc::mock_model model(model_size);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  std::vector<std::vector<double>> draws(2);
+  int n_speculative = 0;
+  for (int run = 0; run < 2; ++run) {
+    stan::rng_t base_rng = stan::services::util::create_rng(1234, 0);
+    stan::mcmc::mock_speculative_nuts sampler(model, base_rng);
+    sampler.set_max_depth(6);
+    sampler.set_nominal_stepsize(1);
+    sampler.set_stepsize_jitter(0);
+    sampler.sample_stepsize();
+    sampler.z() = z_init;
+
+    stan::mcmc::sample init_sample(z_init.q, 0, 0);
+    for (int n = 0; n < 20; ++n) {
+      init_sample = sampler.transition(init_sample, logger);
+      draws[run].push_back(init_sample.cont_params()(0));
+      n_speculative += sampler.get_n_speculative();
+    }
+  }
+
+  EXPECT_EQ(draws[0], draws[1]);
+#ifdef STAN_THREADS
+  EXPECT_GT(n_speculative, 0);
+#else
+  EXPECT_EQ(0, n_speculative);
+#endif
+}
+
+#ifndef STAN_THREADS
+TEST(McmcNutsBaseSpeculativeNuts, transition_serial_without_threads) {
+  stan::rng_t base_rng = stan::services::util::create_rng(4321, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::mock_speculative_nuts sampler(model, base_rng);
+  sampler.set_max_depth(7);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  // every doubling is still built, one subtree at a time
+  for (int n = 0; n < 10; ++n) {
+    init_sample = sampler.transition(init_sample, logger);
+    EXPECT_EQ(7, sampler.depth_);
+    EXPECT_EQ((1 << 7) - 1, sampler.n_leapfrog_);
+    EXPECT_EQ(0, sampler.get_n_speculative());
+    double q = init_sample.cont_params()(0) / 1.5;
+    EXPECT_EQ(std::round(q), q);
+  }
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+}
+#endif
+
+TEST(McmcNutsBaseSpeculativeNuts, transition_gradient_budget) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::mock_speculative_nuts sampler(model, base_rng);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+  sampler.set_max_depth(8);
+  sampler.set_gradient_budget(10);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(3, sampler.depth_);
+  EXPECT_EQ(7, sampler.n_leapfrog_);
+  EXPECT_TRUE(sampler.capped_);
+}
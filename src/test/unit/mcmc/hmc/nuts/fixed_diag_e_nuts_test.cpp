@@ -0,0 +1,204 @@
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_fixed_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/fixed_diag_e_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+typedef gauss3D_model_namespace::gauss3D_model gauss3D_model;
+
+namespace {
+
+// Runs both samplers from the same seed and point with the same options
+// and expects the same transitions.  Returns the number of divergences.
+int expect_transitions_match(unsigned int seed, double stepsize,
+                             double stepsize_jitter, int max_depth,
+                             double max_delta, int num_transitions) {
+  stan::rng_t fixed_rng = stan::services::util::create_rng(seed, 0);
+  stan::rng_t dynamic_rng = stan::services::util::create_rng(seed, 0);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model model(data_var_context);
+
+  Eigen::VectorXd inv_metric(3);
+  inv_metric << 0.5, 1, 2;
+
+  stan::mcmc::fixed_diag_e_nuts<gauss3D_model, 3, stan::rng_t> fixed_sampler(
+      model, fixed_rng);
+  fixed_sampler.set_metric(inv_metric);
+  fixed_sampler.set_nominal_stepsize(stepsize);
+  fixed_sampler.set_stepsize_jitter(stepsize_jitter);
+  fixed_sampler.set_max_depth(max_depth);
+  fixed_sampler.set_max_delta(max_delta);
+
+  stan::mcmc::diag_e_nuts<gauss3D_model, stan::rng_t> dynamic_sampler(
+      model, dynamic_rng);
+  dynamic_sampler.set_metric(inv_metric);
+  dynamic_sampler.set_nominal_stepsize(stepsize);
+  dynamic_sampler.set_stepsize_jitter(stepsize_jitter);
+  dynamic_sampler.set_max_depth(max_depth);
+  dynamic_sampler.set_max_delta(max_delta);
+
+  Eigen::VectorXd q(3);
+  q << 1, -1, 0.5;
+  stan::mcmc::sample fixed_sample(q, 0, 0);
+  stan::mcmc::sample dynamic_sample(q, 0, 0);
+
+  int num_divergent = 0;
+  for (int n = 0; n < num_transitions; ++n) {
+    fixed_sample = fixed_sampler.transition(fixed_sample, logger);
+    dynamic_sample = dynamic_sampler.transition(dynamic_sample, logger);
+
+    EXPECT_EQ(dynamic_sampler.n_leapfrog_, fixed_sampler.n_leapfrog_);
+    EXPECT_EQ(dynamic_sampler.depth_, fixed_sampler.depth_);
+    EXPECT_EQ(dynamic_sampler.divergent_, fixed_sampler.divergent_);
+    EXPECT_FLOAT_EQ(dynamic_sampler.get_current_stepsize(),
+                    fixed_sampler.get_current_stepsize());
+    EXPECT_NEAR(dynamic_sampler.energy_, fixed_sampler.energy_, 1e-10);
+    EXPECT_NEAR(dynamic_sample.log_prob(), fixed_sample.log_prob(), 1e-10);
+    EXPECT_NEAR(dynamic_sample.accept_stat(), fixed_sample.accept_stat(),
+                1e-10);
+    for (int i = 0; i < 3; ++i)
+      EXPECT_NEAR(dynamic_sample.cont_params()(i),
+                  fixed_sample.cont_params()(i), 1e-10);
+    if (::testing::Test::HasFailure())
+      break;
+    num_divergent += dynamic_sampler.divergent_;
+  }
+
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+  return num_divergent;
+}
+
+}  // namespace
+
+TEST(McmcFixedDiagENuts, transition_matches_diag_e_nuts) {
+  expect_transitions_match(4839294, 0.7, 0.1, 8, 1000, 100);
+}
+
+TEST(McmcFixedDiagENuts, transition_matches_diag_e_nuts_shallow_trees) {
+  expect_transitions_match(1123, 0.05, 0, 3, 1000, 100);
+}
+
+TEST(McmcFixedDiagENuts, transition_matches_diag_e_nuts_deep_trees) {
+  expect_transitions_match(97, 0.01, 0.5, 12, 1000, 20);
+}
+
+TEST(McmcFixedDiagENuts, transition_matches_diag_e_nuts_large_jitter) {
+  expect_transitions_match(50211, 0.9, 0.9, 10, 1000, 100);
+}
+
+TEST(McmcFixedDiagENuts, transition_matches_diag_e_nuts_divergent) {
+  int num_divergent = expect_transitions_match(2718, 1.5, 0.2, 10, 0.5, 100);
+  EXPECT_GT(num_divergent, 0);
+}
+
+namespace {
+
+// Adapts both samplers from the same seed and point with the same options
+// and expects the same transitions and the same adapted tuning.
+void expect_adaptation_matches(unsigned int seed, double delta,
+                               double stepsize_jitter, int max_depth) {
+  stan::rng_t fixed_rng = stan::services::util::create_rng(seed, 0);
+  stan::rng_t dynamic_rng = stan::services::util::create_rng(seed, 0);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model model(data_var_context);
+
+  stan::mcmc::adapt_fixed_diag_e_nuts<gauss3D_model, 3, stan::rng_t>
+      fixed_sampler(model, fixed_rng);
+  stan::mcmc::adapt_diag_e_nuts<gauss3D_model, stan::rng_t> dynamic_sampler(
+      model, dynamic_rng);
+
+  fixed_sampler.set_window_params(150, 15, 25, 10, logger);
+  dynamic_sampler.set_window_params(150, 15, 25, 10, logger);
+  fixed_sampler.get_stepsize_adaptation().set_mu(log(10));
+  dynamic_sampler.get_stepsize_adaptation().set_mu(log(10));
+  fixed_sampler.get_stepsize_adaptation().set_delta(delta);
+  dynamic_sampler.get_stepsize_adaptation().set_delta(delta);
+  fixed_sampler.set_stepsize_jitter(stepsize_jitter);
+  dynamic_sampler.set_stepsize_jitter(stepsize_jitter);
+  fixed_sampler.set_max_depth(max_depth);
+  dynamic_sampler.set_max_depth(max_depth);
+  fixed_sampler.engage_adaptation();
+  dynamic_sampler.engage_adaptation();
+
+  Eigen::VectorXd q(3);
+  q << 1, -1, 0.5;
+  fixed_sampler.z().q = q;
+  dynamic_sampler.z().q = q;
+  fixed_sampler.init_stepsize(logger);
+  dynamic_sampler.init_stepsize(logger);
+  EXPECT_FLOAT_EQ(dynamic_sampler.get_nominal_stepsize(),
+                  fixed_sampler.get_nominal_stepsize());
+
+  stan::mcmc::sample fixed_sample(q, 0, 0);
+  stan::mcmc::sample dynamic_sample(q, 0, 0);
+  for (int n = 0; n < 150; ++n) {
+    fixed_sample = fixed_sampler.transition(fixed_sample, logger);
+    dynamic_sample = dynamic_sampler.transition(dynamic_sample, logger);
+    ASSERT_EQ(dynamic_sampler.n_leapfrog_, fixed_sampler.n_leapfrog_);
+    ASSERT_EQ(dynamic_sampler.depth_, fixed_sampler.depth_);
+  }
+  fixed_sampler.disengage_adaptation();
+  dynamic_sampler.disengage_adaptation();
+
+  EXPECT_FLOAT_EQ(dynamic_sampler.get_nominal_stepsize(),
+                  fixed_sampler.get_nominal_stepsize());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FLOAT_EQ(dynamic_sampler.z().inv_e_metric_(i),
+                    fixed_sampler.z().inv_e_metric_(i));
+    EXPECT_FLOAT_EQ(dynamic_sample.cont_params()(i),
+                    fixed_sample.cont_params()(i));
+  }
+}
+
+}  // namespace
+
+TEST(McmcFixedDiagENuts, adaptation_matches_adapt_diag_e_nuts) {
+  expect_adaptation_matches(3701, 0.8, 0, 10);
+}
+
+TEST(McmcFixedDiagENuts, adaptation_matches_adapt_diag_e_nuts_options) {
+  expect_adaptation_matches(6007, 0.95, 0.3, 5);
+}
+
+TEST(McmcFixedDiagENuts, sampler_params_match_diag_e_nuts) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 0);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model model(data_var_context);
+
+  stan::mcmc::fixed_diag_e_nuts<gauss3D_model, 3, stan::rng_t> fixed_sampler(
+      model, rng);
+  stan::mcmc::diag_e_nuts<gauss3D_model, stan::rng_t> dynamic_sampler(model,
+                                                                      rng);
+
+  std::vector<std::string> fixed_names, dynamic_names;
+  fixed_sampler.get_sampler_param_names(fixed_names);
+  dynamic_sampler.get_sampler_param_names(dynamic_names);
+  EXPECT_EQ(dynamic_names, fixed_names);
+  EXPECT_EQ("diag_e", fixed_sampler.z().metric_type());
+}
+
+TEST(McmcFixedDiagENuts, dimension_mismatch_throws) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 0);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model model(data_var_context);
+
+  typedef stan::mcmc::fixed_diag_e_nuts<gauss3D_model, 2, stan::rng_t>
+      sampler_t;
+  EXPECT_THROW(sampler_t(model, rng), std::invalid_argument);
+}
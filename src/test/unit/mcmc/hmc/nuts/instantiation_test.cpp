@@ -3,9 +3,19 @@
 #include <stan/mcmc/hmc/nuts/unit_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/lowrank_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/block_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_unit_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_lowrank_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_block_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_speculative_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/dense_e_speculative_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_speculative_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_speculative_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_mixed_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_mixed_nuts.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/io/empty_var_context.hpp>
 #include <fstream>
@@ -32,6 +42,10 @@ TEST(McmcNuts, instantiaton_test) {
   stan::mcmc::dense_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
       dense_e_sampler(model, base_rng);
 
+  stan::mcmc::lowrank_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                             stan::rng_t>
+      lowrank_e_sampler(model, base_rng);
+
   stan::mcmc::adapt_unit_e_nuts<gauss3D_model_namespace::gauss3D_model,
                                 stan::rng_t>
       adapt_unit_e_sampler(model, base_rng);
@@ -43,4 +57,39 @@ TEST(McmcNuts, instantiaton_test) {
   stan::mcmc::adapt_dense_e_nuts<gauss3D_model_namespace::gauss3D_model,
                                  stan::rng_t>
       adapt_dense_e_sampler(model, base_rng);
+
+  stan::mcmc::adapt_lowrank_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                                   stan::rng_t>
+      adapt_lowrank_e_sampler(model, 2, base_rng);
+
+  stan::mcmc::block_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      block_e_sampler(model, base_rng);
+
+  stan::mcmc::adapt_block_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                                 stan::rng_t>
+      adapt_block_e_sampler(model, {2, 1}, base_rng);
+
+  stan::mcmc::diag_e_speculative_nuts<gauss3D_model_namespace::gauss3D_model,
+                                      stan::rng_t>
+      diag_e_speculative_sampler(model, base_rng);
+
+  stan::mcmc::dense_e_speculative_nuts<gauss3D_model_namespace::gauss3D_model,
+                                       stan::rng_t>
+      dense_e_speculative_sampler(model, base_rng);
+
+  stan::mcmc::adapt_diag_e_speculative_nuts<
+      gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      adapt_diag_e_speculative_sampler(model, base_rng);
+
+  stan::mcmc::adapt_dense_e_speculative_nuts<
+      gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      adapt_dense_e_speculative_sampler(model, base_rng);
+
+  stan::mcmc::diag_e_mixed_nuts<gauss3D_model_namespace::gauss3D_model,
+                                stan::rng_t>
+      diag_e_mixed_sampler(model, base_rng);
+
+  stan::mcmc::adapt_diag_e_mixed_nuts<gauss3D_model_namespace::gauss3D_model,
+                                      stan::rng_t>
+      adapt_diag_e_mixed_sampler(model, base_rng);
 }
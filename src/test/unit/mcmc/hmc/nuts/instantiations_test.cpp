@@ -0,0 +1,31 @@
+#define STAN_INSTANTIATE_SAMPLERS
+#include <stan/mcmc/hmc/nuts/instantiations.hpp>
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+
+TEST(McmcNutsInstantiations, model_base) {
+  stan::rng_t base_rng = stan::services::util::create_rng(4839294, 0);
+  stan::test::unit::instrumented_logger logger;
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model_namespace::gauss3D_model model(data_var_context);
+  stan::model::model_base& base_model = model;
+
+  stan::mcmc::adapt_diag_e_nuts<stan::model::model_base, stan::rng_t>
+      sampler(base_model, base_rng);
+  sampler.engage_adaptation();
+  sampler.set_window_params(20, 5, 5, 5, logger);
+
+  stan::mcmc::sample s(Eigen::VectorXd::Zero(3), 0, 0);
+  sampler.z().q = s.cont_params();
+  sampler.init_hamiltonian(logger);
+  sampler.init_stepsize(logger);
+  for (int i = 0; i < 20; ++i)
+    s = sampler.transition(s, logger);
+
+  EXPECT_TRUE(std::isfinite(s.log_prob()));
+  EXPECT_GT(sampler.get_nominal_stepsize(), 0);
+}
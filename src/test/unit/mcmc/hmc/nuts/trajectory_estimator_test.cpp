@@ -0,0 +1,90 @@
+#include <stan/mcmc/hmc/nuts/trajectory_estimator.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+Eigen::VectorXd point(double x, double y) {
+  Eigen::VectorXd q(2);
+  q << x, y;
+  return q;
+}
+}  // namespace
+
+TEST(McmcNutsTrajectoryEstimator, weights_the_states) {
+  stan::mcmc::trajectory_estimator estimator({1});
+  EXPECT_EQ(std::vector<size_t>{1}, estimator.indices());
+  EXPECT_THROW(estimator.mean(), std::domain_error);
+  EXPECT_THROW(estimator.variance(), std::domain_error);
+
+  // states 0, 2 and 4 of weights 1, 2 and 1, the last subtree rejected
+  estimator.begin_transition(point(10, 0));
+  estimator.add_leaf(std::log(2.0), point(10, 2));
+  estimator.end_subtree(true);
+  estimator.add_leaf(0, point(10, 4));
+  estimator.add_leaf(-1000, point(10, 100));
+  estimator.end_subtree(true);
+  estimator.add_leaf(5, point(10, 1e6));
+  estimator.end_subtree(false);
+  estimator.end_transition();
+
+  ASSERT_EQ(1U, estimator.num_transitions());
+  EXPECT_FLOAT_EQ(2, estimator.mean()(0));
+  EXPECT_FLOAT_EQ(2, estimator.variance()(0));
+
+  // a transition that stayed at 5
+  estimator.begin_transition(point(0, 5));
+  estimator.add_leaf(-std::numeric_limits<double>::infinity(), point(0, 7));
+  estimator.end_subtree(false);
+  estimator.end_transition();
+
+  ASSERT_EQ(2U, estimator.num_transitions());
+  EXPECT_FLOAT_EQ(3.5, estimator.mean()(0));
+  EXPECT_FLOAT_EQ((6 + 25) / 2.0 - 3.5 * 3.5, estimator.variance()(0));
+
+  estimator.reset();
+  EXPECT_EQ(0U, estimator.num_transitions());
+}
+
+TEST(McmcNutsTrajectoryEstimator, large_log_weights) {
+  stan::mcmc::trajectory_estimator estimator({0});
+  estimator.begin_transition(point(0, 0));
+  estimator.add_leaf(800, point(1, 0));
+  estimator.add_leaf(800, point(3, 0));
+  estimator.end_subtree(true);
+  estimator.end_transition();
+  EXPECT_FLOAT_EQ(2, estimator.mean()(0));
+  EXPECT_FLOAT_EQ(1, estimator.variance()(0));
+}
+
+TEST(McmcNutsTrajectoryEstimator, checks_indices) {
+  stan::mcmc::trajectory_estimator estimator({0, 2});
+  EXPECT_THROW(estimator.begin_transition(point(0, 0)),
+               std::invalid_argument);
+}
+
+TEST(McmcNutsTrajectoryEstimator, write) {
+  std::stringstream out;
+  stan::callbacks::stream_writer writer(out);
+  stan::mcmc::trajectory_estimator estimator({1, 0});
+  estimator.write(writer, {"a", "b"});
+  EXPECT_EQ("Trajectory-weighted estimates over 0 transitions:\n",
+            out.str());
+
+  out.str("");
+  estimator.begin_transition(point(1, 3));
+  estimator.add_leaf(0, point(1, 5));
+  estimator.end_subtree(true);
+  estimator.end_transition();
+  estimator.write(writer, {"a", "b"});
+  EXPECT_EQ(
+      "Trajectory-weighted estimates over 1 transitions:\n"
+      "b: mean = 4, sd = 1\n"
+      "a: mean = 1, sd = 0\n",
+      out.str());
+}
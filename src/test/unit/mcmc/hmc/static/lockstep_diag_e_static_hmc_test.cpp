@@ -0,0 +1,143 @@
+#include <stan/mcmc/hmc/static/lockstep_diag_e_static_hmc.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// independent Gaussians with standard deviations 1, 10 and 0.1; the
+// sampler only needs the size and the batched gradient of a model
+struct lockstep_gauss_model {
+  Eigen::VectorXd sd;
+  bool throw_above_bound;
+  mutable int num_batches;
+
+  lockstep_gauss_model() : sd(3), throw_above_bound(false), num_batches(0) {
+    sd << 1, 10, 0.1;
+  }
+
+  size_t num_params_r() const { return sd.size(); }
+
+  void log_prob_grad_batch(bool propto, bool jacobian,
+                           const Eigen::MatrixXd& q, Eigen::VectorXd& lp,
+                           Eigen::MatrixXd& g, std::ostream* msgs) const {
+    ++num_batches;
+    if (throw_above_bound && (q.row(0).array() > 0.5).any())
+      throw std::domain_error("above bound");
+    Eigen::VectorXd inv_var = sd.cwiseAbs2().cwiseInverse();
+    lp = -0.5 * (inv_var.asDiagonal() * q.cwiseAbs2()).colwise().sum();
+    g = -(inv_var.asDiagonal() * q);
+  }
+};
+
+std::vector<stan::rng_t> make_rngs(int num_chains) {
+  std::vector<stan::rng_t> rngs;
+  for (int c = 0; c < num_chains; ++c)
+    rngs.push_back(stan::services::util::create_rng(3, c));
+  return rngs;
+}
+
+}  // namespace
+
+TEST(McmcLockstepStaticHmc, adapts_to_ensemble) {
+  stan::test::unit::instrumented_logger logger;
+  lockstep_gauss_model model;
+  const int num_chains = 128;
+  std::vector<stan::rng_t> rngs = make_rngs(num_chains);
+  stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model, stan::rng_t>
+      sampler(model, rngs);
+  EXPECT_EQ(num_chains, sampler.num_chains());
+
+  sampler.set_nominal_stepsize(0.1);
+  sampler.set_T(1);
+  sampler.get_stepsize_adaptation().set_mu(std::log(1.0));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.get_stepsize_adaptation().set_gamma(0.05);
+  sampler.get_stepsize_adaptation().set_kappa(0.75);
+  sampler.get_stepsize_adaptation().set_t0(10);
+  sampler.set_window_params(400, 75, 50, 25, logger);
+  sampler.engage_adaptation();
+  sampler.init(Eigen::MatrixXd::Zero(3, num_chains), logger);
+
+  const int num_batches = model.num_batches;
+  for (int i = 0; i < 400; ++i)
+    sampler.transition(logger);
+  sampler.disengage_adaptation();
+  // one batch per leapfrog step serves every chain
+  EXPECT_LE(400, model.num_batches - num_batches);
+
+  // the pooled metric finds the scales of the target
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR(1, sampler.get_metric()(i) / std::pow(model.sd(i), 2), 0.3);
+
+  Eigen::VectorXd second_moment = Eigen::VectorXd::Zero(3);
+  double accept_stat = 0;
+  const int num_samples = 100;
+  for (int i = 0; i < num_samples; ++i) {
+    accept_stat += sampler.transition(logger);
+    second_moment += sampler.q().cwiseAbs2().rowwise().mean();
+  }
+  EXPECT_NEAR(0.8, accept_stat / num_samples, 0.1);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR(1, second_moment(i) / num_samples / std::pow(model.sd(i), 2),
+                0.15);
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST(McmcLockstepStaticHmc, reproducible) {
+  stan::callbacks::logger logger;
+  lockstep_gauss_model model;
+  std::vector<stan::rng_t> rngs1 = make_rngs(4);
+  std::vector<stan::rng_t> rngs2 = make_rngs(4);
+  stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model, stan::rng_t>
+      sampler1(model, rngs1);
+  stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model, stan::rng_t>
+      sampler2(model, rngs2);
+  sampler1.init(Eigen::MatrixXd::Ones(3, 4), logger);
+  sampler2.init(Eigen::MatrixXd::Ones(3, 4), logger);
+  for (int i = 0; i < 10; ++i) {
+    sampler1.transition(logger);
+    sampler2.transition(logger);
+  }
+  EXPECT_TRUE(sampler1.q() == sampler2.q());
+  EXPECT_TRUE(sampler1.lp() == sampler2.lp());
+}
+
+TEST(McmcLockstepStaticHmc, domain_error_rejects_single_chains) {
+  stan::test::unit::instrumented_logger logger;
+  lockstep_gauss_model model;
+  model.throw_above_bound = true;
+  std::vector<stan::rng_t> rngs = make_rngs(16);
+  stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model, stan::rng_t>
+      sampler(model, rngs);
+  sampler.set_nominal_stepsize(0.5);
+  sampler.set_T(0.5);
+  sampler.init(Eigen::MatrixXd::Zero(3, 16), logger);
+  for (int i = 0; i < 50; ++i) {
+    sampler.transition(logger);
+    // chains only ever move to points where the model is defined
+    EXPECT_TRUE((sampler.q().row(0).array() <= 0.5).all());
+    EXPECT_TRUE(sampler.lp().allFinite());
+  }
+  // some chains still move
+  EXPECT_FALSE(sampler.q().isZero());
+  EXPECT_LT(0, logger.find_info("above bound"));
+}
+
+TEST(McmcLockstepStaticHmc, init_checks_dimensions) {
+  stan::callbacks::logger logger;
+  lockstep_gauss_model model;
+  std::vector<stan::rng_t> rngs = make_rngs(2);
+  stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model, stan::rng_t>
+      sampler(model, rngs);
+  EXPECT_THROW(sampler.init(Eigen::MatrixXd::Zero(3, 3), logger),
+               std::invalid_argument);
+  std::vector<stan::rng_t> no_rngs;
+  using sampler_t
+      = stan::mcmc::lockstep_diag_e_static_hmc<lockstep_gauss_model,
+                                               stan::rng_t>;
+  EXPECT_THROW(sampler_t(model, no_rngs), std::invalid_argument);
+}
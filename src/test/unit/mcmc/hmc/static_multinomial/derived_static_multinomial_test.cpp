@@ -0,0 +1,158 @@
+#include <stan/mcmc/hmc/static_multinomial/unit_e_static_multinomial.hpp>
+#include <stan/mcmc/hmc/static_multinomial/diag_e_static_multinomial.hpp>
+#include <stan/mcmc/hmc/static_multinomial/dense_e_static_multinomial.hpp>
+#include <stan/mcmc/hmc/static_multinomial/adapt_unit_e_static_multinomial.hpp>
+#include <stan/mcmc/hmc/static_multinomial/adapt_diag_e_static_multinomial.hpp>
+#include <stan/mcmc/hmc/static_multinomial/adapt_dense_e_static_multinomial.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/util/create_rng.hpp>
+
+#include <test/test-models/good/mcmc/hmc/common/gauss.hpp>
+
+#include <gtest/gtest.h>
+
+typedef gauss_model_namespace::gauss_model gauss_model;
+
+class McmcStaticMultinomial : public testing::Test {
+ public:
+  McmcStaticMultinomial()
+      : logger(debug, info, warn, error, fatal),
+        model(data_var_context),
+        base_rng(stan::services::util::create_rng(4839294, 0)) {}
+
+  // run the sampler on a standard normal and check the draws and
+  // sampler parameters
+  template <class Sampler>
+  void check_draws(Sampler& sampler, int num_draws) {
+    std::vector<std::string> names;
+    sampler.get_sampler_param_names(names);
+    ASSERT_EQ(4, names.size());
+    EXPECT_EQ("n_leapfrog__", names[2]);
+
+    Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+    stan::mcmc::sample s(q, 0, 0);
+    double sum = 0;
+    double sum_sq = 0;
+    for (int m = 0; m < num_draws; ++m) {
+      s = sampler.transition(s, logger);
+      EXPECT_GE(s.accept_stat(), 0);
+      EXPECT_LE(s.accept_stat(), 1);
+      std::vector<double> values;
+      sampler.get_sampler_params(values);
+      const int n_leapfrog = values[2];
+      EXPECT_LE(n_leapfrog, sampler.get_L());
+      EXPECT_GE(n_leapfrog, std::ceil((1 - sampler.get_trajectory_jitter())
+                                      * sampler.get_L()));
+      sum += s.cont_params()(0);
+      sum_sq += s.cont_params()(0) * s.cont_params()(0);
+    }
+    EXPECT_NEAR(0, sum / num_draws, 0.15);
+    EXPECT_NEAR(1, sum_sq / num_draws, 0.2);
+    EXPECT_EQ("", error.str());
+  }
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger;
+  stan::io::empty_var_context data_var_context;
+  gauss_model model;
+  stan::rng_t base_rng;
+};
+
+TEST_F(McmcStaticMultinomial, unit_e_transition) {
+  stan::mcmc::unit_e_static_multinomial<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  sampler.set_nominal_stepsize_and_T(0.2, 1.2);
+  check_draws(sampler, 10000);
+}
+
+TEST_F(McmcStaticMultinomial, diag_e_jittered_transition) {
+  stan::mcmc::diag_e_static_multinomial<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  sampler.set_nominal_stepsize_and_T(0.2, 2);
+  sampler.set_trajectory_jitter(1);
+  EXPECT_EQ(1, sampler.get_trajectory_jitter());
+  check_draws(sampler, 10000);
+}
+
+TEST_F(McmcStaticMultinomial, dense_e_jittered_transition) {
+  stan::mcmc::dense_e_static_multinomial<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  sampler.set_nominal_stepsize_and_T(0.2, 2);
+  sampler.set_trajectory_jitter(0.5);
+  check_draws(sampler, 10000);
+}
+
+TEST_F(McmcStaticMultinomial, trajectory_jitter_range) {
+  stan::mcmc::diag_e_static_multinomial<gauss_model, stan::rng_t> sampler(
+      model, base_rng);
+  sampler.set_trajectory_jitter(0.3);
+  sampler.set_trajectory_jitter(1.5);
+  sampler.set_trajectory_jitter(-1);
+  EXPECT_EQ(0.3, sampler.get_trajectory_jitter());
+}
+
+TEST_F(McmcStaticMultinomial, adapt_unit_e_fixed_trajectory_length) {
+  stan::mcmc::adapt_unit_e_static_multinomial<gauss_model, stan::rng_t>
+      sampler(model, base_rng);
+  sampler.set_nominal_stepsize_and_T(0.1, 1);
+  sampler.get_stepsize_adaptation().set_mu(std::log(1.0));
+  sampler.engage_adaptation();
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 100; ++m)
+    s = sampler.transition(s, logger);
+  sampler.disengage_adaptation();
+  EXPECT_EQ(1, sampler.get_T());
+}
+
+TEST_F(McmcStaticMultinomial, adapt_diag_e_trajectory_length) {
+  stan::mcmc::adapt_diag_e_static_multinomial<gauss_model, stan::rng_t>
+      sampler(model, base_rng);
+  stan::callbacks::logger silent;
+  sampler.set_window_params(1000, 75, 50, 25, silent);
+  sampler.set_nominal_stepsize_and_T(0.2, 0.2);
+  sampler.get_stepsize_adaptation().set_mu(std::log(10 * 0.2));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.set_trajectory_jitter(1);
+  sampler.get_trajectory_length_adaptation().set_learning_rate(0.1);
+  sampler.set_adapt_trajectory_length(true);
+  sampler.engage_adaptation();
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  sampler.z().q = q;
+  sampler.init_stepsize(logger);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 1000; ++m)
+    s = sampler.transition(s, logger);
+  sampler.disengage_adaptation();
+  // the integration time grows from far below the half period pi of a
+  // standard normal
+  EXPECT_GT(sampler.get_T(), 0.5);
+  EXPECT_TRUE(std::isfinite(sampler.get_T()));
+  EXPECT_EQ(std::max(1, static_cast<int>(sampler.get_T()
+                                         / sampler.get_nominal_stepsize())),
+            sampler.get_L());
+}
+
+TEST_F(McmcStaticMultinomial, adapt_dense_e_trajectory_length) {
+  stan::mcmc::adapt_dense_e_static_multinomial<gauss_model, stan::rng_t>
+      sampler(model, base_rng);
+  stan::callbacks::logger silent;
+  sampler.set_window_params(500, 75, 50, 25, silent);
+  sampler.set_nominal_stepsize_and_T(0.2, 0.2);
+  sampler.get_stepsize_adaptation().set_mu(std::log(10 * 0.2));
+  sampler.get_stepsize_adaptation().set_delta(0.8);
+  sampler.set_trajectory_jitter(1);
+  sampler.get_trajectory_length_adaptation().set_learning_rate(0.1);
+  sampler.set_adapt_trajectory_length(true);
+  sampler.engage_adaptation();
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(1);
+  sampler.z().q = q;
+  sampler.init_stepsize(logger);
+  stan::mcmc::sample s(q, 0, 0);
+  for (int m = 0; m < 500; ++m)
+    s = sampler.transition(s, logger);
+  sampler.disengage_adaptation();
+  EXPECT_GT(sampler.get_T(), 0.2);
+  EXPECT_TRUE(std::isfinite(sampler.get_T()));
+}
@@ -0,0 +1,67 @@
+#include <stan/mcmc/hmc/tree_weight.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+double log_sum_exp(double a, double b) {
+  if (a == -std::numeric_limits<double>::infinity())
+    return b;
+  double m = std::max(a, b);
+  return m + std::log(std::exp(a - m) + std::exp(b - m));
+}
+
+}  // namespace
+
+TEST(McmcHmcTreeWeight, empty) {
+  stan::mcmc::tree_weight w;
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), w.log());
+
+  stan::mcmc::tree_weight inf(-std::numeric_limits<double>::infinity());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), inf.log());
+
+  w.add(-std::numeric_limits<double>::infinity());
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), w.log());
+  w.add(inf);
+  EXPECT_EQ(-std::numeric_limits<double>::infinity(), w.log());
+
+  stan::mcmc::tree_weight one(0);
+  EXPECT_EQ(0, one.log());
+  EXPECT_EQ(0, one.ratio(w));
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), w.ratio(one));
+}
+
+TEST(McmcHmcTreeWeight, matches_log_sum_exp) {
+  std::vector<double> log_weights{-0.3, 2.5, -1e3, 1.0, 800, -2, 801.5};
+  stan::mcmc::tree_weight w;
+  double expected = -std::numeric_limits<double>::infinity();
+  for (double log_weight : log_weights) {
+    w.add(log_weight);
+    expected = log_sum_exp(expected, log_weight);
+    EXPECT_NEAR(expected, w.log(), 1e-12 * std::fabs(expected) + 1e-14);
+  }
+}
+
+TEST(McmcHmcTreeWeight, merge_and_ratio) {
+  stan::mcmc::tree_weight left(-1.0, 2.0);
+  left.add(0.5, -1.0);
+  stan::mcmc::tree_weight right(3.0, 4.0);
+  right.add(-2.0, 0.0);
+
+  stan::mcmc::tree_weight both = left;
+  both.add(right);
+
+  const double w_left = std::exp(-1.0) + std::exp(0.5);
+  const double w_right = std::exp(3.0) + std::exp(-2.0);
+  EXPECT_FLOAT_EQ(std::log(w_left + w_right), both.log());
+  EXPECT_FLOAT_EQ(w_right / (w_left + w_right), both.ratio(right));
+  EXPECT_FLOAT_EQ(w_left / w_right, right.ratio(left));
+
+  const double expected_average
+      = (std::exp(-1.0) * 2.0 + std::exp(0.5) * -1.0 + std::exp(3.0) * 4.0)
+        / (w_left + w_right);
+  EXPECT_FLOAT_EQ(expected_average, both.average());
+  EXPECT_FLOAT_EQ(4.0, right.average() * w_right / std::exp(3.0));
+}
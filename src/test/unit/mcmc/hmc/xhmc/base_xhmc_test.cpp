@@ -254,3 +254,36 @@ TEST(McmcXHMCBaseXHMC, transition) {
   EXPECT_EQ("", error.str());
   EXPECT_EQ("", fatal.str());
 }
+
+TEST(McmcXHMCBaseXHMC, transition_gradient_budget) {
+  stan::rng_t base_rng = stan::services::util::create_rng(1234, 0);
+
+  stan::mcmc::ps_point z_init(1);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+
+  stan::mcmc::mock_model model(1);
+  stan::mcmc::mock_xhmc sampler(model, base_rng);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.sample_stepsize();
+  sampler.z() = z_init;
+  sampler.set_gradient_budget(4);
+
+  std::vector<std::string> names;
+  sampler.get_sampler_param_names(names);
+  EXPECT_EQ("budget_capped__", names.back());
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  stan::mcmc::sample init_sample(z_init.q, 0, 0);
+
+  sampler.transition(init_sample, logger);
+  EXPECT_EQ(2, sampler.depth_);
+  EXPECT_EQ(3, sampler.n_leapfrog_);
+  EXPECT_TRUE(sampler.capped_);
+  std::vector<double> values;
+  sampler.get_sampler_params(values);
+  EXPECT_EQ(6, values.size());
+  EXPECT_EQ(1, values.back());
+}
@@ -0,0 +1,110 @@
+#include <stan/mcmc/lowrank_adaptation.hpp>
+#include <stan/mcmc/var_adaptation.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+TEST(McmcLowRankAdaptation, learn_metric_constant) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 10;
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(n);
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::MatrixXd lowrank(n, 0);
+
+  const int n_learn = 10;
+
+  Eigen::VectorXd target_var(Eigen::VectorXd::Ones(n));
+  target_var *= 1e-3 * 5.0 / (n_learn + 5.0);
+
+  stan::mcmc::lowrank_adaptation adapter(n, 3);
+  adapter.set_window_params(50, 0, 0, n_learn, logger);
+
+  bool update = false;
+  for (int i = 0; i < n_learn; ++i)
+    update = adapter.learn_metric(var, lowrank, q);
+  EXPECT_TRUE(update);
+
+  for (int i = 0; i < n; ++i)
+    EXPECT_EQ(target_var(i), var(i));
+  EXPECT_EQ(n, lowrank.rows());
+  EXPECT_EQ(0, lowrank.cols());
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcLowRankAdaptation, rank_zero_matches_variance) {
+  stan::test::unit::instrumented_logger logger;
+  stan::rng_t rng = stan::services::util::create_rng(0, 0);
+  boost::random::normal_distribution<double> std_normal;
+
+  const int n = 4;
+  const int n_learn = 30;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd lowrank_var(Eigen::VectorXd::Zero(n));
+  Eigen::MatrixXd lowrank(n, 0);
+
+  stan::mcmc::var_adaptation var_adapter(n);
+  stan::mcmc::lowrank_adaptation lowrank_adapter(n, 0);
+  var_adapter.set_window_params(100, 0, 0, n_learn, logger);
+  lowrank_adapter.set_window_params(100, 0, 0, n_learn, logger);
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    for (int j = 0; j < n; ++j)
+      q(j) = (j + 1) * std_normal(rng);
+    var_adapter.learn_variance(var, q);
+    lowrank_adapter.learn_metric(lowrank_var, lowrank, q);
+  }
+
+  for (int j = 0; j < n; ++j)
+    EXPECT_FLOAT_EQ(var(j), lowrank_var(j));
+  EXPECT_EQ(0, lowrank.cols());
+}
+
+TEST(McmcLowRankAdaptation, learn_correlation) {
+  stan::test::unit::instrumented_logger logger;
+  stan::rng_t rng = stan::services::util::create_rng(0, 0);
+  boost::random::normal_distribution<double> std_normal;
+
+  // covariance of the identity plus 9 a a^T along a unit vector a
+  const int n = 20;
+  const int n_learn = 2000;
+  Eigen::VectorXd a = Eigen::VectorXd::LinSpaced(n, 1, 2);
+  a.normalize();
+  Eigen::MatrixXd covar = Eigen::MatrixXd::Identity(n, n);
+  covar += 9 * a * a.transpose();
+
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::MatrixXd lowrank(n, 0);
+  stan::mcmc::lowrank_adaptation adapter(n, 2);
+  adapter.set_window_params(3 * n_learn, 0, 0, n_learn, logger);
+
+  Eigen::VectorXd q(n);
+  bool update = false;
+  for (int i = 0; i < n_learn; ++i) {
+    for (int j = 0; j < n; ++j)
+      q(j) = std_normal(rng);
+    q += 3 * std_normal(rng) * a;
+    update = adapter.learn_metric(var, lowrank, q);
+  }
+  ASSERT_TRUE(update);
+  ASSERT_LE(1, lowrank.cols());
+  ASSERT_GE(2, lowrank.cols());
+
+  Eigen::MatrixXd estimate = lowrank * lowrank.transpose();
+  estimate.diagonal() += var;
+  // the metric captures the correlated direction, which has variance 10
+  EXPECT_NEAR(10, a.dot(estimate * a), 1.5);
+  // and almost all of the error of the diagonal metric is corrected
+  double diag_error = (covar - Eigen::MatrixXd(covar.diagonal().asDiagonal()))
+                          .norm();
+  EXPECT_LT((covar - estimate).norm(), 0.3 * diag_error);
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcLowRankAdaptation, negative_rank) {
+  EXPECT_THROW(stan::mcmc::lowrank_adaptation(3, -1), std::invalid_argument);
+}
@@ -0,0 +1,151 @@
+#include <stan/mcmc/point_checkpoint.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class McmcPointCheckpoint : public testing::Test {
+ public:
+  McmcPointCheckpoint()
+      : writer(std::unique_ptr<std::stringstream, deleter_noop>(&output)) {
+    output << std::setprecision(std::numeric_limits<double>::max_digits10);
+  }
+
+  std::unique_ptr<stan::json::json_data> checkpoint() {
+    input.str(output.str());
+    return std::make_unique<stan::json::json_data>(input);
+  }
+
+  template <class Point>
+  void write(const Point& z) {
+    writer.begin_record();
+    stan::mcmc::write_point_checkpoint(z, writer);
+    writer.end_record();
+  }
+
+  std::stringstream output;
+  std::stringstream input;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> writer;
+};
+
+void fill(stan::mcmc::ps_point& z) {
+  for (int i = 0; i < z.q.size(); ++i) {
+    z.q(i) = 0.1 + i;
+    z.p(i) = -1.3 * i;
+    z.g(i) = 2.7 / (i + 1);
+  }
+  z.V = 4.2;
+}
+
+void expect_point_eq(const stan::mcmc::ps_point& expected,
+                     const stan::mcmc::ps_point& z) {
+  for (int i = 0; i < expected.q.size(); ++i) {
+    EXPECT_EQ(expected.q(i), z.q(i));
+    EXPECT_EQ(expected.p(i), z.p(i));
+    EXPECT_EQ(expected.g(i), z.g(i));
+  }
+  EXPECT_EQ(expected.V, z.V);
+}
+
+}  // namespace
+
+TEST_F(McmcPointCheckpoint, ps_point) {
+  stan::mcmc::ps_point z(3);
+  fill(z);
+  write(z);
+
+  stan::mcmc::ps_point restored(3);
+  stan::mcmc::read_point_checkpoint(restored, *checkpoint());
+  expect_point_eq(z, restored);
+}
+
+TEST_F(McmcPointCheckpoint, diag_e_point) {
+  stan::mcmc::diag_e_point z(3);
+  fill(z);
+  Eigen::VectorXd inv_metric(3);
+  inv_metric << 0.5, 1.25, 3;
+  z.set_metric(inv_metric);
+  write(z);
+
+  stan::mcmc::diag_e_point restored(3);
+  stan::mcmc::read_point_checkpoint(restored, *checkpoint());
+  expect_point_eq(z, restored);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(inv_metric(i), restored.inv_e_metric_(i));
+}
+
+TEST_F(McmcPointCheckpoint, diag_e_mixed_point) {
+  stan::mcmc::diag_e_mixed_point z(2);
+  fill(z);
+  Eigen::VectorXd inv_metric(2);
+  inv_metric << 0.1, 7;
+  z.set_metric(inv_metric);
+  write(z);
+
+  stan::mcmc::diag_e_mixed_point restored(2);
+  stan::mcmc::read_point_checkpoint(restored, *checkpoint());
+  expect_point_eq(z, restored);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(inv_metric(i), restored.inv_e_metric_(i));
+    EXPECT_EQ(z.inv_e_metric_f_(i), restored.inv_e_metric_f_(i));
+  }
+}
+
+TEST_F(McmcPointCheckpoint, dense_e_point) {
+  stan::mcmc::dense_e_point z(2);
+  fill(z);
+  Eigen::MatrixXd inv_metric(2, 2);
+  inv_metric << 2, 0.5, 0.5, 1;
+  z.set_metric(inv_metric);
+  write(z);
+
+  stan::mcmc::dense_e_point restored(2);
+  stan::mcmc::read_point_checkpoint(restored, *checkpoint());
+  expect_point_eq(z, restored);
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_EQ(inv_metric(i, j), restored.inv_e_metric_(i, j));
+  EXPECT_FLOAT_EQ(z.inv_e_metric_llt_.matrixL()(1, 0),
+                  restored.inv_e_metric_llt_.matrixL()(1, 0));
+}
+
+TEST_F(McmcPointCheckpoint, block_e_point) {
+  stan::mcmc::block_e_point z(3);
+  fill(z);
+  Eigen::MatrixXd block(2, 2);
+  block << 2, 0.5, 0.5, 1;
+  z.set_metric({block, Eigen::MatrixXd::Constant(1, 1, 3)});
+  write(z);
+
+  stan::mcmc::block_e_point restored(3);
+  restored.set_block_sizes({2, 1});
+  stan::mcmc::read_point_checkpoint(restored, *checkpoint());
+  expect_point_eq(z, restored);
+  EXPECT_EQ((std::vector<int>{2, 1}), restored.block_sizes());
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_EQ(block(i, j), restored.inv_e_metric_[0](i, j));
+  EXPECT_EQ(3, restored.inv_e_metric_[1](0, 0));
+}
+
+TEST_F(McmcPointCheckpoint, missing_metric_throws) {
+  stan::mcmc::ps_point z(2);
+  fill(z);
+  write(z);
+
+  stan::mcmc::diag_e_point restored(2);
+  EXPECT_THROW(stan::mcmc::read_point_checkpoint(restored, *checkpoint()),
+               std::invalid_argument);
+}
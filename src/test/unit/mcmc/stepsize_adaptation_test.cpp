@@ -1,5 +1,7 @@
 #include <stan/mcmc/stepsize_adaptation.hpp>
 #include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
 
 TEST(McmcStepsizeAdaptation, set_mu) {
   stan::mcmc::stepsize_adaptation adaptation;
@@ -141,3 +143,21 @@ TEST(McmcStepsizeAdaptation, learn_stepsize_3) {
   EXPECT_NEAR(0.75, adaptation.kappa(), 1e-14);
   EXPECT_NEAR(10, adaptation.t0(), 1e-14);
 }
+
+TEST(McmcStepsizeAdaptation, rescaled_stepsize) {
+  exposed_adaptation adaptation(50, 0.01, std::log(0.5), 0, 0.8, 0.05, 0.75,
+                                10);
+  EXPECT_FLOAT_EQ(1.0, adaptation.rescaled_stepsize(2.0));
+  EXPECT_TRUE(std::isnan(adaptation.rescaled_stepsize(0)));
+  EXPECT_TRUE(std::isnan(adaptation.rescaled_stepsize(
+      std::numeric_limits<double>::infinity())));
+  EXPECT_TRUE(std::isnan(
+      adaptation.rescaled_stepsize(std::numeric_limits<double>::quiet_NaN())));
+
+  exposed_adaptation off_target(50, 0.3, std::log(0.5), 0, 0.8, 0.05, 0.75,
+                                10);
+  EXPECT_TRUE(std::isnan(off_target.rescaled_stepsize(2.0)));
+
+  exposed_adaptation too_few(5, 0.01, std::log(0.5), 0, 0.8, 0.05, 0.75, 10);
+  EXPECT_TRUE(std::isnan(too_few.rescaled_stepsize(2.0)));
+}
@@ -0,0 +1,101 @@
+#include <stan/mcmc/temperature_ladder.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/chi_squared_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+TEST(McmcTemperatureLadder, geometric) {
+  stan::mcmc::temperature_ladder ladder(4, 8);
+  ASSERT_EQ(4U, ladder.size());
+  EXPECT_FLOAT_EQ(1, ladder.temperature(0));
+  EXPECT_FLOAT_EQ(2, ladder.temperature(1));
+  EXPECT_FLOAT_EQ(4, ladder.temperature(2));
+  EXPECT_FLOAT_EQ(8, ladder.temperature(3));
+  EXPECT_FLOAT_EQ(0.125, ladder.inv_temperature(3));
+  EXPECT_FALSE(ladder.adapting());
+
+  stan::mcmc::temperature_ladder single(1, 8);
+  ASSERT_EQ(1U, single.size());
+  EXPECT_FLOAT_EQ(1, single.inv_temperature(0));
+  boost::ecuyer1988 rng(0);
+  std::vector<double> log_probs{-1};
+  EXPECT_TRUE(single.exchange(log_probs, rng).empty());
+}
+
+TEST(McmcTemperatureLadder, even_odd_rounds) {
+  stan::mcmc::temperature_ladder ladder(5, 16);
+  boost::ecuyer1988 rng(0);
+  // states with equal densities are always exchanged
+  std::vector<double> log_probs(5, -2);
+  std::vector<size_t> even = ladder.exchange(log_probs, rng);
+  std::vector<size_t> odd = ladder.exchange(log_probs, rng);
+  EXPECT_EQ((std::vector<size_t>{0, 2}), even);
+  EXPECT_EQ((std::vector<size_t>{1, 3}), odd);
+  EXPECT_EQ(1, ladder.swap_rate(0));
+  EXPECT_EQ(1, ladder.swap_rate(1));
+  ladder.reset_swap_rates();
+  EXPECT_TRUE(std::isnan(ladder.swap_rate(0)));
+}
+
+TEST(McmcTemperatureLadder, exchange_log_probs) {
+  stan::mcmc::temperature_ladder ladder(2, 2);
+  boost::ecuyer1988 rng(0);
+  // moving the better state to temperature 1 is always accepted
+  std::vector<double> log_probs{-10, 0};
+  EXPECT_EQ((std::vector<size_t>{0}), ladder.exchange(log_probs, rng));
+  EXPECT_EQ(0, log_probs[0]);
+  EXPECT_EQ(-10, log_probs[1]);
+
+  // and the reverse has probability exp(-5)
+  int num_accepted = 0;
+  for (int n = 0; n < 20000; ++n) {
+    std::vector<double> reverse{0, -10};
+    ladder.exchange(reverse, rng);
+    num_accepted += reverse[0] == -10;
+  }
+  EXPECT_NEAR(std::exp(-5) / 2, num_accepted / 20000.0, 0.002);
+}
+
+TEST(McmcTemperatureLadder, adapt_to_target_rate) {
+  // exact draws of a standard normal in 20 dimensions raised to each
+  // inverse temperature, whose log density is -chi^2 / (2 beta)
+  const int dim = 20;
+  stan::mcmc::temperature_ladder ladder(4, 100);
+  boost::ecuyer1988 rng(1234);
+  boost::random::chi_squared_distribution<double> chi_squared(dim);
+  std::vector<double> log_probs(4);
+  auto round = [&]() {
+    for (size_t k = 0; k < 4; ++k)
+      log_probs[k] = -0.5 * chi_squared(rng) / ladder.inv_temperature(k);
+    ladder.exchange(log_probs, rng);
+  };
+
+  ladder.engage_adaptation();
+  for (int n = 0; n < 40000; ++n)
+    round();
+  ladder.disengage_adaptation();
+  ladder.reset_swap_rates();
+  const std::vector<double> adapted = ladder.inv_temperatures();
+  for (int n = 0; n < 20000; ++n)
+    round();
+  EXPECT_EQ(adapted, ladder.inv_temperatures());
+  EXPECT_FLOAT_EQ(1, ladder.inv_temperature(0));
+  for (size_t k = 0; k < 3; ++k) {
+    EXPECT_NEAR(0.234, ladder.swap_rate(k), 0.03) << "pair " << k;
+    EXPECT_GT(adapted[k], adapted[k + 1]);
+  }
+}
+
+TEST(McmcTemperatureLadder, invalid_arguments) {
+  EXPECT_THROW(stan::mcmc::temperature_ladder(0, 10), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::temperature_ladder(3, 0.5), std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::temperature_ladder(3, INFINITY),
+               std::invalid_argument);
+  EXPECT_THROW(stan::mcmc::temperature_ladder(3, 10, 1), std::invalid_argument);
+  stan::mcmc::temperature_ladder ladder(3, 10);
+  boost::ecuyer1988 rng(0);
+  std::vector<double> log_probs(2);
+  EXPECT_THROW(ladder.exchange(log_probs, rng), std::invalid_argument);
+}
@@ -0,0 +1,92 @@
+#include <stan/mcmc/trajectory_length_adaptation.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// adapt to a standard normal target with exact Hamiltonian trajectories,
+// which are rotations of the initial position and momentum
+double adapt_standard_normal(int num_chains, bool jitter, double max_T) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 1);
+  boost::random::normal_distribution<double> std_normal;
+  boost::random::uniform_01<double> uniform;
+  const int n = 10;
+  stan::mcmc::trajectory_length_adaptation adaptation(n);
+  adaptation.set_max_T(max_T);
+
+  double T = 0.2;
+  Eigen::MatrixXd q(n, num_chains);
+  for (int c = 0; c < num_chains; ++c)
+    for (int i = 0; i < n; ++i)
+      q(i, c) = std_normal(rng);
+  Eigen::MatrixXd q_proposal(n, num_chains);
+  Eigen::MatrixXd v_proposal(n, num_chains);
+  Eigen::VectorXd times(num_chains);
+  Eigen::VectorXd accept_prob = Eigen::VectorXd::Ones(num_chains);
+  for (int m = 0; m < 2000; ++m) {
+    for (int c = 0; c < num_chains; ++c) {
+      const double t = jitter ? uniform(rng) * T : T;
+      times(c) = t;
+      for (int i = 0; i < n; ++i) {
+        const double p = std_normal(rng);
+        q_proposal(i, c) = q(i, c) * std::cos(t) + p * std::sin(t);
+        v_proposal(i, c) = -q(i, c) * std::sin(t) + p * std::cos(t);
+      }
+    }
+    adaptation.learn_trajectory_length(T, q, q_proposal, v_proposal, times,
+                                       accept_prob);
+    q = q_proposal;
+  }
+  adaptation.complete_adaptation(T);
+  return T;
+}
+
+}  // namespace
+
+TEST(McmcTrajectoryLengthAdaptation, quarter_period_many_chains) {
+  // a quarter of the period of the trajectories maximizes the criterion
+  EXPECT_NEAR(M_PI / 2, adapt_standard_normal(50, false, 100), 0.1);
+}
+
+TEST(McmcTrajectoryLengthAdaptation, quarter_period_one_chain) {
+  EXPECT_NEAR(M_PI / 2, adapt_standard_normal(1, false, 100), 0.3);
+}
+
+TEST(McmcTrajectoryLengthAdaptation, jitter_lengthens) {
+  // with uniformly jittered trajectories the average length is near the
+  // quarter period
+  double T = adapt_standard_normal(50, true, 100);
+  EXPECT_GT(T, M_PI / 2);
+  EXPECT_LT(T, M_PI);
+}
+
+TEST(McmcTrajectoryLengthAdaptation, max_T) {
+  EXPECT_FLOAT_EQ(0.5, adapt_standard_normal(50, false, 0.5));
+}
+
+TEST(McmcTrajectoryLengthAdaptation, no_iterations) {
+  stan::mcmc::trajectory_length_adaptation adaptation(2);
+  double T = 1.5;
+  adaptation.complete_adaptation(T);
+  EXPECT_EQ(1.5, T);
+}
+
+TEST(McmcTrajectoryLengthAdaptation, rejected_proposals) {
+  stan::mcmc::trajectory_length_adaptation adaptation(2);
+  Eigen::MatrixXd q_init = Eigen::MatrixXd::Ones(2, 2);
+  Eigen::MatrixXd q_proposal = Eigen::MatrixXd::Constant(
+      2, 2, std::numeric_limits<double>::infinity());
+  Eigen::MatrixXd v_proposal = Eigen::MatrixXd::Ones(2, 2);
+  Eigen::VectorXd times = Eigen::VectorXd::Ones(2);
+  Eigen::VectorXd accept_prob = Eigen::VectorXd::Zero(2);
+  double T = 1.5;
+  adaptation.learn_trajectory_length(T, q_init, q_proposal, v_proposal, times,
+                                     accept_prob);
+  EXPECT_FLOAT_EQ(1.5, T);
+  adaptation.complete_adaptation(T);
+  EXPECT_FLOAT_EQ(1.5, T);
+}
@@ -25,3 +25,218 @@ TEST(McmcVarAdaptation, learn_variance) {
 
   EXPECT_EQ(0, logger.call_count());
 }
+
+TEST(McmcVarAdaptation, pool_variance) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 3;
+  const int n_learn = 10;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd pooled_var(Eigen::VectorXd::Zero(n));
+
+  stan::mcmc::var_adaptation single(n);
+  stan::mcmc::var_adaptation first(n);
+  stan::mcmc::var_adaptation second(n);
+  single.set_window_params(100, 0, 0, 2 * n_learn, logger);
+  first.set_window_params(100, 0, 0, n_learn, logger);
+  second.set_window_params(100, 0, 0, n_learn, logger);
+  first.set_pooling(true);
+  second.set_pooling(true);
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, i * i, 1.0 / (i + 1);
+    single.learn_variance(var, q);
+    EXPECT_FALSE(first.learn_variance(pooled_var, q));
+    q << -2.0 * i, 3.0, std::sqrt(i);
+    single.learn_variance(var, q);
+    EXPECT_FALSE(second.learn_variance(pooled_var, q));
+  }
+  EXPECT_TRUE(first.window_complete());
+  EXPECT_TRUE(second.window_complete());
+  for (int i = 0; i < n; ++i)
+    EXPECT_EQ(0, pooled_var(i));
+
+  stan::mcmc::var_adaptation::pool_variance({&first, &second}, pooled_var);
+  EXPECT_FALSE(first.window_complete());
+  EXPECT_FALSE(second.window_complete());
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(var(i), pooled_var(i));
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcVarAdaptation, discard_window) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 2;
+  const int n_learn = 10;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd pooled_var(Eigen::VectorXd::Zero(n));
+
+  stan::mcmc::var_adaptation single(n);
+  stan::mcmc::var_adaptation kept(n);
+  stan::mcmc::var_adaptation discarded(n);
+  for (stan::mcmc::var_adaptation* adaptation : {&single, &kept, &discarded}) {
+    adaptation->set_window_params(100, 0, 0, n_learn, logger);
+    adaptation->set_pooling(true);
+  }
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, 1.0 / (i + 1);
+    single.learn_variance(var, q);
+    kept.learn_variance(pooled_var, q);
+    q << 100.0 * i, -50.0;
+    discarded.learn_variance(pooled_var, q);
+  }
+  EXPECT_TRUE(discarded.window_complete());
+  discarded.discard_window();
+  EXPECT_FALSE(discarded.window_complete());
+
+  stan::mcmc::var_adaptation::pool_variance({&single}, var);
+  stan::mcmc::var_adaptation::pool_variance({&kept, &discarded}, pooled_var);
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(var(i), pooled_var(i));
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcVarAdaptation, learn_variance_gradients) {
+  stan::test::unit::instrumented_logger logger;
+
+  // for independent Gaussians with these variances the gradient of the
+  // negative log density is q / var, so the geometric mean is exact
+  const int n = 3;
+  const int n_learn = 10;
+  Eigen::VectorXd scale(n);
+  scale << 0.5, 2, 10;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd draws_var(Eigen::VectorXd::Zero(n));
+
+  stan::mcmc::var_adaptation adapter(n);
+  stan::mcmc::var_adaptation draws_adapter(n);
+  adapter.set_use_gradients(true);
+  EXPECT_TRUE(adapter.use_gradients());
+  EXPECT_FALSE(draws_adapter.use_gradients());
+  adapter.set_window_params(50, 0, 0, n_learn, logger);
+  draws_adapter.set_window_params(50, 0, 0, n_learn, logger);
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << std::sin(i), std::cos(3.0 * i), i % 3 - 1.0;
+    q.array() *= scale.array();
+    Eigen::VectorXd g = q.cwiseQuotient(scale.cwiseAbs2());
+    adapter.learn_variance(var, q, g);
+    draws_adapter.learn_variance(draws_var, q, g);
+  }
+
+  const double w = n_learn / (n_learn + 5.0);
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(w * scale(i) * scale(i) + 1e-3 * (1 - w), var(i));
+  // without gradients the gradient argument is ignored
+  Eigen::VectorXd expected_var(Eigen::VectorXd::Zero(n));
+  stan::mcmc::var_adaptation expected_adapter(n);
+  expected_adapter.set_window_params(50, 0, 0, n_learn, logger);
+  for (int i = 0; i < n_learn; ++i) {
+    q << std::sin(i), std::cos(3.0 * i), i % 3 - 1.0;
+    q.array() *= scale.array();
+    expected_adapter.learn_variance(expected_var, q);
+  }
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(expected_var(i), draws_var(i));
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcVarAdaptation, learn_variance_constant_gradient) {
+  stan::test::unit::instrumented_logger logger;
+
+  // a constant gradient carries no curvature, so the draws are used
+  const int n = 2;
+  const int n_learn = 10;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd draws_var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd g = Eigen::VectorXd::Ones(n);
+
+  stan::mcmc::var_adaptation adapter(n);
+  stan::mcmc::var_adaptation draws_adapter(n);
+  adapter.set_use_gradients(true);
+  adapter.set_window_params(50, 0, 0, n_learn, logger);
+  draws_adapter.set_window_params(50, 0, 0, n_learn, logger);
+
+  Eigen::VectorXd q(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, i * i;
+    adapter.learn_variance(var, q, g);
+    draws_adapter.learn_variance(draws_var, q);
+  }
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(draws_var(i), var(i));
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcVarAdaptation, pool_variance_gradients) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 2;
+  const int n_learn = 10;
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::VectorXd pooled_var(Eigen::VectorXd::Zero(n));
+
+  stan::mcmc::var_adaptation single(n);
+  stan::mcmc::var_adaptation first(n);
+  stan::mcmc::var_adaptation second(n);
+  for (stan::mcmc::var_adaptation* adapter : {&single, &first, &second})
+    adapter->set_use_gradients(true);
+  single.set_window_params(100, 0, 0, 2 * n_learn, logger);
+  first.set_window_params(100, 0, 0, n_learn, logger);
+  second.set_window_params(100, 0, 0, n_learn, logger);
+  first.set_pooling(true);
+  second.set_pooling(true);
+
+  Eigen::VectorXd q(n);
+  Eigen::VectorXd g(n);
+  for (int i = 0; i < n_learn; ++i) {
+    q << i, std::sqrt(i);
+    g << 2.0 * i, std::cos(i);
+    single.learn_variance(var, q, g);
+    first.learn_variance(pooled_var, q, g);
+    q << -3.0, i * i;
+    g << 1.0 / (i + 1), i;
+    single.learn_variance(var, q, g);
+    second.learn_variance(pooled_var, q, g);
+  }
+
+  stan::mcmc::var_adaptation::pool_variance({&first, &second}, pooled_var);
+  for (int i = 0; i < n; ++i)
+    EXPECT_FLOAT_EQ(var(i), pooled_var(i));
+
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcVarAdaptation, metric_scale) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 2;
+  const int n_learn = 100;
+  Eigen::VectorXd var = Eigen::VectorXd::Ones(n);
+
+  stan::mcmc::var_adaptation adapter(n);
+  adapter.set_window_params(200, 0, 0, n_learn, logger);
+  EXPECT_TRUE(std::isnan(adapter.metric_scale()));
+  adapter.set_estimate_metric_scale(true);
+
+  // draws with variances of about 4 and 0.25
+  Eigen::VectorXd q(n);
+  bool update = false;
+  for (int i = 0; i < n_learn; ++i) {
+    const double sign = i % 2 == 0 ? 1 : -1;
+    q << 2 * sign, 0.5 * sign;
+    update = adapter.learn_variance(var, q);
+  }
+  ASSERT_TRUE(update);
+  EXPECT_FLOAT_EQ(std::sqrt(1 / var(1)), adapter.metric_scale());
+  EXPECT_GT(adapter.metric_scale(), 1.5);
+}
@@ -46,3 +46,16 @@ TEST(McmcWindowedAdaptation, set_window_params3) {
   ASSERT_EQ(0, logger.call_count());
   ASSERT_EQ(0, logger.call_count_info());
 }
+
+TEST(McmcWindowedAdaptation, iterations_to_window_end) {
+  stan::test::unit::instrumented_logger logger;
+
+  stan::mcmc::windowed_adaptation adapter("test");
+
+  adapter.set_window_params(100, 10, 20, 10, logger);
+  EXPECT_EQ(20, adapter.iterations_to_window_end());
+
+  stan::mcmc::windowed_adaptation no_window_adapter("test");
+  no_window_adapter.set_window_params(10, 1, 1, 1, logger);
+  EXPECT_EQ(0, no_window_adapter.iterations_to_window_end());
+}
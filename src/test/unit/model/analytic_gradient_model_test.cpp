@@ -0,0 +1,143 @@
+#include <stan/model/analytic_gradient_model.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// standard normal log density over a scalar mu and a 2 x 2 matrix sigma,
+// counting the gradient evaluations
+struct normal_model {
+  int num_gradients = 0;
+  stan::model::analytic_gradient_model model{
+      "normal",
+      {"mu", "sigma"},
+      {{}, {2, 2}},
+      [](const Eigen::VectorXd& x) { return -0.5 * x.squaredNorm(); },
+      [this](const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        ++num_gradients;
+        grad = -x;
+        return -0.5 * x.squaredNorm();
+      }};
+};
+}  // namespace
+
+TEST(ModelAnalyticGradientModel, names_and_dims) {
+  normal_model normal;
+  const stan::model::model_base& model = normal.model;
+  EXPECT_EQ("normal", model.model_name());
+  EXPECT_EQ(5U, model.num_params_r());
+
+  std::vector<std::string> names;
+  model.get_param_names(names);
+  EXPECT_EQ((std::vector<std::string>{"mu", "sigma"}), names);
+
+  std::vector<std::vector<size_t>> dims;
+  model.get_dims(dims);
+  EXPECT_EQ((std::vector<std::vector<size_t>>{{}, {2, 2}}), dims);
+
+  names.clear();
+  model.constrained_param_names(names);
+  EXPECT_EQ((std::vector<std::string>{"mu", "sigma.1.1", "sigma.2.1",
+                                      "sigma.1.2", "sigma.2.2"}),
+            names);
+  names.clear();
+  model.unconstrained_param_names(names);
+  EXPECT_EQ(5U, names.size());
+}
+
+TEST(ModelAnalyticGradientModel, log_prob_grad_without_autodiff) {
+  normal_model normal;
+  Eigen::VectorXd x(5);
+  x << 1, 2, 3, 4, 5;
+  Eigen::VectorXd grad;
+  const double lp = stan::model::log_prob_grad<true, true>(normal.model, x,
+                                                           grad, nullptr);
+  EXPECT_FLOAT_EQ(-27.5, lp);
+  EXPECT_EQ(1, normal.num_gradients);
+  ASSERT_EQ(5, grad.size());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_FLOAT_EQ(-x(i), grad(i));
+
+  std::vector<double> x_vec{1, 2, 3, 4, 5};
+  std::vector<int> params_i;
+  std::vector<double> grad_vec;
+  EXPECT_FLOAT_EQ(-27.5, (stan::model::log_prob_grad<true, false>(
+                             normal.model, x_vec, params_i, grad_vec)));
+  EXPECT_EQ(2, normal.num_gradients);
+  EXPECT_EQ((std::vector<double>{-1, -2, -3, -4, -5}), grad_vec);
+}
+
+TEST(ModelAnalyticGradientModel, log_prob_through_model_base) {
+  normal_model normal;
+  stan::model::model_base& model = normal.model;
+  Eigen::VectorXd x(5);
+  x << 1, 2, 3, 4, 5;
+  EXPECT_FLOAT_EQ(-27.5, model.log_prob(x, nullptr));
+  EXPECT_FLOAT_EQ(-27.5, model.log_prob_propto_jacobian(x, nullptr));
+  EXPECT_EQ(0, normal.num_gradients);
+
+  Eigen::Matrix<stan::math::var, -1, 1> x_var(5);
+  for (int i = 0; i < 5; ++i)
+    x_var(i) = x(i);
+  stan::math::var lp = model.log_prob_propto(x_var, nullptr);
+  EXPECT_FLOAT_EQ(-27.5, lp.val());
+  lp.grad();
+  for (int i = 0; i < 5; ++i)
+    EXPECT_FLOAT_EQ(-x(i), x_var(i).adj());
+  EXPECT_EQ(1, normal.num_gradients);
+  stan::math::recover_memory();
+
+  Eigen::MatrixXd points(5, 2);
+  points.col(0) = x;
+  points.col(1) = -x;
+  Eigen::VectorXd lps;
+  Eigen::MatrixXd grads;
+  model.log_prob_grad_batch(true, true, points, lps, grads);
+  EXPECT_FLOAT_EQ(-27.5, lps(1));
+  EXPECT_FLOAT_EQ(5, grads(4, 1));
+  EXPECT_EQ(3, normal.num_gradients);
+}
+
+TEST(ModelAnalyticGradientModel, transform_inits_and_write_array) {
+  normal_model normal;
+  const stan::model::model_base& model = normal.model;
+  std::vector<std::string> names{"mu", "sigma"};
+  std::vector<double> values{1, 2, 3, 4, 5};
+  std::vector<std::vector<size_t>> dims{{}, {2, 2}};
+  stan::io::array_var_context context(names, values, dims);
+
+  Eigen::VectorXd params_r;
+  model.transform_inits(context, params_r, nullptr);
+  ASSERT_EQ(5, params_r.size());
+  EXPECT_FLOAT_EQ(5, params_r(4));
+
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd constrained;
+  model.write_array(rng, params_r, constrained);
+  EXPECT_TRUE(constrained.isApprox(params_r));
+  Eigen::VectorXd unconstrained;
+  model.unconstrain_array(constrained, unconstrained);
+  EXPECT_TRUE(unconstrained.isApprox(params_r));
+}
+
+TEST(ModelAnalyticGradientModel, throws_on_bad_sizes) {
+  auto density = [](const Eigen::VectorXd& x) { return 0.0; };
+  auto gradient = [](const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+    grad = Eigen::VectorXd::Zero(1);
+    return 0.0;
+  };
+  EXPECT_THROW((stan::model::analytic_gradient_model("bad", {"a", "b"}, {{}},
+                                                     density, gradient)),
+               std::invalid_argument);
+
+  stan::model::analytic_gradient_model model("wrong", {"a"}, {{3}}, density,
+                                             gradient);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(3);
+  Eigen::VectorXd grad;
+  EXPECT_THROW((stan::model::log_prob_grad<true, true>(model, x, grad)),
+               std::domain_error);
+}
@@ -0,0 +1,52 @@
+#include <stan/model/annealed_model.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// log density -(x - 1)^2 / 2 plus a constant kept only when propto is
+// false
+struct mock_model {
+  size_t num_params_r() const { return 2; }
+
+  template <bool propto, bool jacobian, typename VecR>
+  double log_prob(VecR& params_r, std::ostream* msgs) const {
+    return -0.5 * (params_r[0] - 1) * (params_r[0] - 1) + (propto ? 0 : -1);
+  }
+};
+}  // namespace
+
+TEST(ModelAnnealedModel, log_prob) {
+  mock_model model;
+  stan::model::annealed_model<mock_model> annealed(model, 2);
+  EXPECT_EQ(2U, annealed.num_params_r());
+  EXPECT_EQ(&model, &annealed.model());
+  EXPECT_FLOAT_EQ(2, annealed.reference_scale());
+  EXPECT_FLOAT_EQ(0, annealed.inv_temperature());
+  std::vector<double> x{3, 2};
+  const double ref_propto = -0.5 * 13 / 4;
+  const double ref = ref_propto - 2 * (std::log(2) + 0.5 * std::log(2 * M_PI));
+  EXPECT_FLOAT_EQ(ref_propto, annealed.reference_log_prob<true>(x));
+  EXPECT_FLOAT_EQ(ref, annealed.reference_log_prob<false>(x));
+  EXPECT_FLOAT_EQ(ref, (annealed.log_prob<false, true>(x, nullptr)));
+
+  annealed.set_inv_temperature(0.25);
+  EXPECT_FLOAT_EQ(0.75 * ref_propto - 0.25 * 2,
+                  (annealed.log_prob<true, true>(x, nullptr)));
+  EXPECT_FLOAT_EQ(0.75 * ref - 0.25 * 3,
+                  (annealed.log_prob<false, true>(x, nullptr)));
+  annealed.set_inv_temperature(1);
+  EXPECT_FLOAT_EQ(-3, (annealed.log_prob<false, true>(x, nullptr)));
+}
+
+TEST(ModelAnnealedModel, invalid_arguments) {
+  mock_model model;
+  using annealed_t = stan::model::annealed_model<mock_model>;
+  EXPECT_THROW(annealed_t(model, 0), std::domain_error);
+  EXPECT_THROW(annealed_t(model, INFINITY), std::domain_error);
+  EXPECT_THROW(annealed_t(model, 1, 1.5), std::domain_error);
+  annealed_t annealed(model, 1);
+  EXPECT_THROW(annealed.set_inv_temperature(-0.1), std::domain_error);
+}
@@ -0,0 +1,27 @@
+#include <stan/model/directional_derivatives.hpp>
+#include <test/unit/model/test_model.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+
+TEST(ModelUtil, directional_derivatives) {
+  const int n = 20;
+  TestModel_quadratic model(n);
+  Eigen::VectorXd params_r(n);
+  Eigen::VectorXd grad(n);
+  for (int k = 0; k < n; ++k) {
+    params_r(k) = std::cos(k);
+    grad(k) = -(k + 1) * params_r(k);
+  }
+  Eigen::MatrixXd directions = Eigen::MatrixXd::Identity(n, 5);
+  directions.col(4).setConstant(1 / std::sqrt(n));
+
+  Eigen::VectorXd derivs;
+  std::stringstream msgs;
+  stan::model::directional_derivatives<true, true>(model, params_r,
+                                                   directions, derivs, &msgs);
+  ASSERT_EQ(5, derivs.size());
+  for (int d = 0; d < 5; ++d)
+    EXPECT_FLOAT_EQ(grad.dot(directions.col(d)), derivs(d));
+  EXPECT_EQ("", msgs.str());
+}
@@ -3,6 +3,7 @@
 #include <test/unit/model/test_model.hpp>
 #include <test/test-models/good/model/valid.hpp>
 #include <test/unit/util.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
 #include <stan/callbacks/interrupt.hpp>
 #include <gtest/gtest.h>
 
@@ -127,3 +128,46 @@ TEST(ModelUtil, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(ModelUtil, finite_diff_grad_parallel) {
+  const int n = 2500;
+  TestModel_quadratic model(n);
+  std::vector<double> params_r(n);
+  for (int k = 0; k < n; ++k)
+    params_r[k] = std::sin(k);
+  std::vector<int> params_i(0);
+  std::vector<double> gradient, expected;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  stan::model::finite_diff_grad<false, true>(model, interrupt, params_r,
+                                             params_i, expected);
+  EXPECT_EQ(n, interrupt.call_count());
+  stan::model::finite_diff_grad_parallel<false, true>(
+      model, interrupt, params_r, params_i, gradient, 1e-6, 0, 1000);
+  EXPECT_EQ(n + 3, interrupt.call_count());
+
+  ASSERT_EQ(expected.size(), gradient.size());
+  for (int k = 0; k < n; ++k)
+    EXPECT_FLOAT_EQ(expected[k], gradient[k]);
+}
+
+TEST(ModelUtil, finite_diff_directional) {
+  const int n = 20;
+  TestModel_quadratic model(n);
+  std::vector<double> params_r(n);
+  Eigen::VectorXd grad(n);
+  for (int k = 0; k < n; ++k) {
+    params_r[k] = std::cos(k);
+    grad(k) = -(k + 1) * params_r[k];
+  }
+  std::vector<int> params_i(0);
+  Eigen::MatrixXd directions = Eigen::MatrixXd::Identity(n, 5);
+  directions.col(4).setConstant(1 / std::sqrt(n));
+
+  Eigen::VectorXd derivs;
+  stan::model::finite_diff_directional<false, true>(
+      model, params_r, params_i, directions, derivs);
+  ASSERT_EQ(5, derivs.size());
+  for (int d = 0; d < 5; ++d)
+    EXPECT_NEAR(grad.dot(directions.col(d)), derivs(d), 1e-6);
+}
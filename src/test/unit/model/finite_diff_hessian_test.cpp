@@ -0,0 +1,79 @@
+#include <stan/model/finite_diff_hessian.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+
+namespace {
+// f(x) = sum_i x_i^3 + x_0 x_1 + exp(x_2), which has a known Hessian
+struct cubic_grad {
+  double operator()(const Eigen::VectorXd& x, Eigen::VectorXd& grad,
+                    std::ostream* msgs) const {
+    grad = 3 * x.array().square();
+    grad(0) += x(1);
+    grad(1) += x(0);
+    grad(2) += std::exp(x(2));
+    if (msgs != nullptr)
+      *msgs << "x0=" << x(0) << ";";
+    return x.array().cube().sum() + x(0) * x(1) + std::exp(x(2));
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, finite_diff_hessian) {
+  Eigen::VectorXd x(4);
+  x << 0.5, -1.5, 2.0, 30.0;
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hess;
+  stan::model::finite_diff_hessian(cubic_grad(), x, fx, grad, hess);
+
+  Eigen::VectorXd expected_grad;
+  EXPECT_FLOAT_EQ(cubic_grad()(x, expected_grad, nullptr), fx);
+  ASSERT_EQ(4, grad.size());
+  for (int i = 0; i < 4; ++i)
+    EXPECT_FLOAT_EQ(expected_grad(i), grad(i));
+
+  Eigen::MatrixXd expected_hess = (6 * x).asDiagonal();
+  expected_hess(0, 1) = expected_hess(1, 0) = 1;
+  expected_hess(2, 2) += std::exp(x(2));
+  ASSERT_EQ(4, hess.rows());
+  ASSERT_EQ(4, hess.cols());
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(expected_hess(i, j), hess(i, j),
+                  1e-6 * std::max(1.0, std::fabs(expected_hess(i, j))));
+      EXPECT_EQ(hess(i, j), hess(j, i));
+    }
+  }
+}
+
+TEST(ModelUtil, finite_diff_hessian_msgs_in_order) {
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(3);
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hess;
+  std::stringstream msgs;
+  stan::model::finite_diff_hessian(cubic_grad(), x, fx, grad, hess, &msgs);
+  // the point itself, then the steps up and down along each dimension
+  std::string expected = "x0=0;";
+  std::stringstream step;
+  const double epsilon = std::cbrt(std::numeric_limits<double>::epsilon());
+  step << "x0=" << epsilon << ";x0=" << -epsilon << ";";
+  expected += step.str() + "x0=0;x0=0;x0=0;x0=0;";
+  EXPECT_EQ(expected, msgs.str());
+}
+
+TEST(ModelUtil, finite_diff_hessian_empty) {
+  Eigen::VectorXd x(0);
+  double fx;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hess;
+  stan::model::finite_diff_hessian(
+      [](const Eigen::VectorXd& x, Eigen::VectorXd& grad, std::ostream*) {
+        grad.resize(0);
+        return 2.0;
+      },
+      x, fx, grad, hess);
+  EXPECT_EQ(2.0, fx);
+  EXPECT_EQ(0, hess.size());
+}
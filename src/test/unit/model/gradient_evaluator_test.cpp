@@ -0,0 +1,142 @@
+#include <stan/model/gradient_evaluator.hpp>
+#include <stan/model/gradient.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/model/valid.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(ModelUtil, gradient_evaluator) {
+  stan::io::empty_var_context data_var_context;
+  std::stringstream output;
+  valid_model_namespace::valid_model model(data_var_context, 0, &output);
+  stan::model::gradient_evaluator<valid_model_namespace::valid_model>
+      evaluator(model);
+
+  Eigen::VectorXd x(1);
+  double f;
+  Eigen::VectorXd g;
+  double expected_f;
+  Eigen::VectorXd expected_g;
+  for (double x0 : {-2.0, 0.0, 0.5, 3.0}) {
+    x(0) = x0;
+    evaluator(x, f, g, &output);
+    stan::model::gradient(model, x, expected_f, expected_g, &output);
+    EXPECT_FLOAT_EQ(expected_f, f);
+    ASSERT_EQ(1, g.size());
+    EXPECT_FLOAT_EQ(expected_g(0), g(0));
+    EXPECT_FLOAT_EQ(-x0, g(0));
+  }
+  EXPECT_EQ("", output.str());
+}
+
+TEST(ModelUtil, gradient_evaluator_logger) {
+  stan::io::empty_var_context data_var_context;
+  std::stringstream output;
+  stan::test::unit::instrumented_logger logger;
+  valid_model_namespace::valid_model model(data_var_context, 0, &output);
+  stan::model::gradient_evaluator<valid_model_namespace::valid_model>
+      evaluator(model);
+
+  Eigen::VectorXd x(1);
+  x << 1.5;
+  double f;
+  Eigen::VectorXd g;
+  evaluator(x, f, g, logger);
+  EXPECT_FLOAT_EQ(-0.5 * 1.5 * 1.5, f);
+  EXPECT_FLOAT_EQ(-1.5, g(0));
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(ModelUtil, gradient_evaluator_keeps_outer_stack) {
+  stan::io::empty_var_context data_var_context;
+  valid_model_namespace::valid_model model(data_var_context, 0, nullptr);
+  stan::model::gradient_evaluator<valid_model_namespace::valid_model>
+      evaluator(model);
+  stan::model::gradient_evaluator<valid_model_namespace::valid_model> copy(
+      evaluator);
+
+  // variables of the caller survive the nested evaluations
+  stan::math::var a = 2;
+  stan::math::var b = a * a;
+  Eigen::VectorXd x(1);
+  x << 4;
+  double f;
+  Eigen::VectorXd g;
+  evaluator(x, f, g);
+  copy(x, f, g);
+  EXPECT_FLOAT_EQ(-4, g(0));
+  b.grad();
+  EXPECT_FLOAT_EQ(4, a.adj());
+  stan::math::recover_memory();
+}
+
+TEST(ModelUtil, gradient_evaluator_stats) {
+  stan::io::empty_var_context data_var_context;
+  valid_model_namespace::valid_model model(data_var_context, 0, nullptr);
+  stan::model::gradient_evaluator<valid_model_namespace::valid_model>
+      evaluator(model);
+
+  Eigen::VectorXd x(1);
+  x << 0.5;
+  double f;
+  Eigen::VectorXd g;
+  evaluator(x, f, g);
+  evaluator(x, f, g);
+  EXPECT_EQ(2, evaluator.stats().num_gradients);
+  EXPECT_EQ(0, evaluator.stats().gradient_time);
+  EXPECT_GT(evaluator.stats().ad_stack_size, 0);
+  EXPECT_GT(evaluator.stats().ad_bytes_allocated, 0);
+
+  const size_t stack_size = evaluator.stats().ad_stack_size;
+  evaluator.set_timing(true);
+  evaluator(x, f, g);
+  EXPECT_EQ(3, evaluator.stats().num_gradients);
+  EXPECT_GT(evaluator.stats().gradient_time, 0);
+  // the tape of a gradient does not depend on the earlier ones
+  EXPECT_EQ(stack_size, evaluator.stats().ad_stack_size);
+}
+
+namespace {
+// model whose log density can not be evaluated at negative positions
+struct rejecting_model {
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* msgs = 0) const {
+    if (params_r(0) < 0)
+      throw std::domain_error("negative position");
+    if (msgs)
+      *msgs << "evaluated";
+    return -0.5 * params_r(0) * params_r(0);
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, gradient_evaluator_try_gradient) {
+  rejecting_model model;
+  stan::model::gradient_evaluator<rejecting_model> evaluator(model);
+  stan::test::unit::instrumented_logger logger;
+
+  Eigen::VectorXd x(1);
+  x << 2;
+  double f;
+  Eigen::VectorXd g;
+  EXPECT_TRUE(evaluator.try_gradient(x, f, g, logger));
+  EXPECT_FLOAT_EQ(-2, f);
+  EXPECT_FLOAT_EQ(-2, g(0));
+  EXPECT_EQ(1, logger.find_info("evaluated"));
+
+  x << -1;
+  EXPECT_FALSE(evaluator.try_gradient(x, f, g, logger));
+  EXPECT_EQ("negative position", evaluator.error_message());
+  EXPECT_EQ(2, evaluator.stats().num_gradients);
+  EXPECT_EQ(0, logger.call_count_error());
+
+  x << 3;
+  EXPECT_TRUE(evaluator.try_log_prob(x, f, logger));
+  EXPECT_FLOAT_EQ(-4.5, f);
+  x << -3;
+  EXPECT_FALSE(evaluator.try_log_prob(x, f, logger));
+  EXPECT_EQ(2, evaluator.stats().num_gradients);
+  EXPECT_EQ(0, stan::math::ChainableStack::instance_->var_stack_.size());
+}
@@ -2,6 +2,7 @@
 #include <stan/io/empty_var_context.hpp>
 #include <test/test-models/good/model/valid.hpp>
 #include <gtest/gtest.h>
+#include <sstream>
 
 TEST(ModelUtil, hessian) {
   int dim = 5;
@@ -30,3 +31,55 @@ TEST(ModelUtil, hessian) {
   // &output); EXPECT_THROW(stan::model::hessian(domain_fail_model, x, f,
   // grad_f, hess_f), std::domain_error); EXPECT_EQ("", output.str());
 }
+
+namespace {
+// log density x0 x1 x2 - (x0^2 + 2 x1^2 + 3 x2^2) / 2, plus a constant
+// and a Jacobian term in x2 when they are included
+struct coupled_model {
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& x, std::ostream* msgs = 0) const {
+    if (msgs)
+      *msgs << "evaluated";
+    T lp = (propto ? 0.0 : 2.0) + x(0) * x(1) * x(2)
+           - 0.5 * (x(0) * x(0) + 2 * x(1) * x(1) + 3 * x(2) * x(2));
+    if (jacobian)
+      lp += x(2) * x(2) * x(2);
+    return lp;
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, hessian_propto_jacobian) {
+  coupled_model model;
+  Eigen::VectorXd x(3);
+  x << 0.5, -1, 2;
+  Eigen::MatrixXd expected(3, 3);
+  expected << -1, x(2), x(1), x(2), -2, x(0), x(1), x(0), -3;
+
+  for (int num_tangents : {1, 2, 4}) {
+    double f;
+    Eigen::VectorXd grad_f;
+    Eigen::MatrixXd hess_f;
+    std::stringstream output;
+    stan::model::hessian<true, false>(model, x, f, grad_f, hess_f, &output,
+                                      num_tangents);
+    EXPECT_FLOAT_EQ(-1 - 0.5 * (0.25 + 2 + 12), f);
+    ASSERT_EQ(3, grad_f.size());
+    EXPECT_FLOAT_EQ(x(1) * x(2) - x(0), grad_f(0));
+    ASSERT_EQ(3, hess_f.rows());
+    ASSERT_EQ(3, hess_f.cols());
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        EXPECT_NEAR(expected(i, j), hess_f(i, j), 1e-8);
+    EXPECT_TRUE(hess_f == hess_f.transpose());
+    // only the gradient writes messages
+    EXPECT_EQ("evaluated", output.str());
+  }
+
+  double f;
+  Eigen::VectorXd grad_f;
+  Eigen::MatrixXd hess_f;
+  stan::model::hessian<false, true>(model, x, f, grad_f, hess_f);
+  EXPECT_FLOAT_EQ(2 - 1 - 0.5 * (0.25 + 2 + 12) + 8, f);
+  EXPECT_NEAR(-3 + 6 * x(2), hess_f(2, 2), 1e-8);
+}
@@ -32,3 +32,31 @@ TEST(ModelUtil, hessian_times_vector) {
   //             std::domain_error);
   // EXPECT_EQ("", output.str());
 }
+
+TEST(ModelUtil, hessian_times_vector_jacobian) {
+  int dim = 5;
+
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(dim);
+  Eigen::VectorXd v = Eigen::VectorXd::Ones(dim);
+  double f;
+  double f_default;
+  Eigen::VectorXd hess_f_dot_v(dim);
+  Eigen::VectorXd hess_f_dot_v_default(dim);
+
+  stan::io::empty_var_context data_var_context;
+
+  std::stringstream output;
+  valid_model_namespace::valid_model valid_model(data_var_context, 0, &output);
+  stan::model::hessian_times_vector(valid_model, x, v, f_default,
+                                    hess_f_dot_v_default);
+  EXPECT_NO_THROW(stan::model::hessian_times_vector<true, true>(
+      valid_model, x, v, f, hess_f_dot_v));
+  EXPECT_FLOAT_EQ(f_default, f);
+  for (int i = 0; i < dim; ++i)
+    EXPECT_FLOAT_EQ(hess_f_dot_v_default(i), hess_f_dot_v(i));
+
+  EXPECT_NO_THROW(stan::model::hessian_times_vector<false, false>(
+      valid_model, x, v, f, hess_f_dot_v));
+  EXPECT_FLOAT_EQ(dim, hess_f_dot_v.size());
+  EXPECT_EQ("", output.str());
+}
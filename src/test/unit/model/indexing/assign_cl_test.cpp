@@ -19,6 +19,7 @@ using stan::model::index_max;
 using stan::model::index_min;
 using stan::model::index_min_max;
 using stan::model::index_multi;
+using stan::model::index_multi_cl;
 using stan::model::index_omni;
 using stan::model::index_uni;
 
@@ -156,6 +157,44 @@ TEST(ModelIndexing, assign_opencl_vector_1d) {
       indices);
 }
 
+TEST(ModelIndexing, assign_opencl_index_multi_cl) {
+  Eigen::VectorXd m1(4);
+  m1 << 1, 2, 3, 4;
+  Eigen::VectorXd m2(3);
+  m2 << 4, 5, 6;
+  std::vector<int> ns{1, 4, 2};
+  index_multi idx(ns);
+  index_multi_cl idx_cl(ns, 4);
+
+  Eigen::VectorXd m_test = m1;
+  stan::math::matrix_cl<double> m_test_cl(m1);
+  assign(m_test, m2, "", idx);
+  assign(m_test_cl, stan::math::matrix_cl<double>(m2), "", idx_cl);
+  EXPECT_MATRIX_EQ(m_test, stan::math::from_matrix_cl(m_test_cl));
+  EXPECT_THROW(assign(m_test_cl, stan::math::matrix_cl<double>(5, 1), "",
+                      idx_cl),
+               std::invalid_argument);
+
+  stan::math::vector_v m_v1 = m1;
+  stan::math::vector_v m_v2 = m1;
+  stan::math::vector_v r_v1 = m2;
+  stan::math::vector_v r_v2 = m2;
+  stan::math::var_value<stan::math::matrix_cl<double>> m_v_cl
+      = stan::math::to_matrix_cl(m_v2);
+  stan::math::var_value<stan::math::matrix_cl<double>> r_v_cl
+      = stan::math::to_matrix_cl(r_v2);
+  assign(m_v1, r_v1, "", idx);
+  assign(m_v_cl, r_v_cl, "", idx_cl);
+  stan::math::vector_v res = stan::math::from_matrix_cl(m_v_cl);
+  EXPECT_MATRIX_EQ(m_v1.val(), res.val());
+  set_adjoints1(m_v1);
+  set_adjoints1(res);
+  stan::math::grad();
+  EXPECT_MATRIX_EQ(m_v1.adj(), m_v2.adj());
+  EXPECT_MATRIX_EQ(r_v1.adj(), r_v2.adj());
+  stan::math::recover_memory();
+}
+
 TEST(ModelIndexing, assign_opencl_matrix_1d) {
   Eigen::MatrixXd m1(4, 4);
   m1 << 1, 2, 3, 4, 5, 6, 7, 8, 9, 1, 2, 3, 4, 5, 6, 7;
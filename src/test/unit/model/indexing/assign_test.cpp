@@ -14,6 +14,7 @@ using stan::model::index_max;
 using stan::model::index_min;
 using stan::model::index_min_max;
 using stan::model::index_multi;
+using stan::model::index_multi_checked;
 using stan::model::index_omni;
 using stan::model::index_uni;
 using std::vector;
@@ -396,6 +397,79 @@ TEST(ModelIndexing, lvalueVecMulti) {
   test_throw_ia(xs, ys, index_multi(ns));
 }
 
+TEST(ModelIndexing, lvalueVecMultiChecked) {
+  VectorXd xs(5);
+  xs << 0, 1, 2, 3, 4;
+  VectorXd ys(3);
+  ys << 10, 11, 12;
+  index_multi_checked idx(vector<int>{4, 1, 3}, 5);
+  assign(xs, ys, "", idx);
+  EXPECT_FLOAT_EQ(ys(0), xs(3));
+  EXPECT_FLOAT_EQ(ys(1), xs(0));
+  EXPECT_FLOAT_EQ(ys(2), xs(2));
+  test_throw_ia(xs, VectorXd::Ones(7), idx);
+
+  VectorXd zs(3);
+  test_throw(zs, ys, idx);
+}
+
+TEST(ModelIndexing, lvalueMultiCheckedLayouts) {
+  vector<vector<int>> ns{
+      {2, 3, 4}, {1, 3, 5}, {5, 5, 5, 5, 1, 2, 3, 4}, {3, 1, 2, 5}};
+  for (const auto& n : ns) {
+    index_multi_checked idx(n, 6);
+    VectorXd ys = VectorXd::LinSpaced(n.size(), 10, 20);
+    VectorXd xs = VectorXd::Zero(6);
+    VectorXd xs_expected = xs;
+    assign(xs, ys, "", idx);
+    MatrixXd ym(n.size(), 2);
+    ym << ys, -ys;
+    MatrixXd xm = MatrixXd::Zero(6, 2);
+    MatrixXd xm_expected = xm;
+    assign(xm, ym, "", idx);
+    for (size_t i = 0; i < n.size(); ++i) {
+      xs_expected(n[i] - 1) = ys(i);
+      xm_expected.row(n[i] - 1) = ym.row(i);
+    }
+    for (int i = 0; i < 6; ++i) {
+      EXPECT_FLOAT_EQ(xs_expected(i), xs(i));
+      EXPECT_FLOAT_EQ(xm_expected(i, 0), xm(i, 0));
+      EXPECT_FLOAT_EQ(xm_expected(i, 1), xm(i, 1));
+    }
+  }
+}
+
+TEST(ModelIndexing, lvalueMatrixMultiChecked) {
+  MatrixXd xs = MatrixXd::Zero(3, 2);
+  MatrixXd ys(2, 2);
+  ys << 1, 2, 3, 4;
+  index_multi_checked idx(vector<int>{3, 1}, 3);
+  assign(xs, ys, "", idx);
+  EXPECT_FLOAT_EQ(1, xs(2, 0));
+  EXPECT_FLOAT_EQ(2, xs(2, 1));
+  EXPECT_FLOAT_EQ(3, xs(0, 0));
+  EXPECT_FLOAT_EQ(4, xs(0, 1));
+  EXPECT_FLOAT_EQ(0, xs(1, 0));
+  test_throw_ia(xs, MatrixXd::Ones(2, 3), idx);
+
+  MatrixXd zs(2, 2);
+  test_throw(zs, ys, idx);
+}
+
+TEST(ModelIndexing, lvalueArrayMultiChecked) {
+  vector<vector<double>> xs{{0, 0}, {0, 0}, {0, 0}};
+  vector<double> ys{1, 2};
+  index_multi_checked idx(vector<int>{3, 1}, 3);
+  assign(xs, ys, "", idx, index_uni(2));
+  EXPECT_FLOAT_EQ(1, xs[2][1]);
+  EXPECT_FLOAT_EQ(2, xs[0][1]);
+  EXPECT_FLOAT_EQ(0, xs[1][1]);
+  test_throw_ia(xs, vector<double>{1, 2, 3}, idx, index_uni(2));
+
+  xs.pop_back();
+  test_throw(xs, ys, idx, index_uni(2));
+}
+
 TEST(ModelIndexing, lvalueRowVecMulti) {
   RowVectorXd xs(5);
   xs << 0, 1, 2, 3, 4;
@@ -7,6 +7,7 @@ using stan::model::index_max;
 using stan::model::index_min;
 using stan::model::index_min_max;
 using stan::model::index_multi;
+using stan::model::index_multi_checked;
 using stan::model::index_omni;
 using stan::model::index_uni;
 
@@ -26,6 +27,50 @@ TEST(MathIndexingIndex, index_multi) {
     EXPECT_EQ(ns[i], idx.ns_[i]);
 }
 
+TEST(MathIndexingIndex, index_multi_checked) {
+  std::vector<int> ns{3, 23, 7};
+
+  index_multi_checked idx(ns, 23);
+  EXPECT_EQ(3, idx.ns_.size());
+  for (size_t i = 0; i < ns.size(); ++i)
+    EXPECT_EQ(ns[i], idx.ns_[i]);
+  EXPECT_EQ(23, idx.max_);
+  EXPECT_NO_THROW(idx.check_size("", "", 23));
+  EXPECT_THROW(idx.check_size("", "", 22), std::out_of_range);
+
+  EXPECT_THROW(index_multi_checked(ns, 22), std::out_of_range);
+  ns.push_back(0);
+  EXPECT_THROW(index_multi_checked(ns, 23), std::out_of_range);
+}
+
+TEST(MathIndexingIndex, index_multi_checked_layout) {
+  using layout = index_multi_checked::layout;
+  using ns_t = std::vector<int>;
+  EXPECT_EQ(layout::contiguous, index_multi_checked(ns_t{2, 3, 4}, 5).layout_);
+  EXPECT_EQ(layout::contiguous, index_multi_checked(ns_t{}, 5).layout_);
+
+  index_multi_checked strided(ns_t{1, 3, 5}, 5);
+  EXPECT_EQ(layout::strided, strided.layout_);
+  EXPECT_EQ(2, strided.stride_);
+
+  index_multi_checked runs(ns_t{2, 2, 2, 2, 3, 4, 5, 6, 1, 1, 1, 1}, 6);
+  EXPECT_EQ(layout::runs, runs.layout_);
+  std::vector<int> pos, start, size, step;
+  runs.for_each_run([&](int p, int s, int n, int d) {
+    pos.push_back(p);
+    start.push_back(s);
+    size.push_back(n);
+    step.push_back(d);
+  });
+  EXPECT_EQ((ns_t{0, 4, 8}), pos);
+  EXPECT_EQ((ns_t{1, 2, 0}), start);
+  EXPECT_EQ((ns_t{4, 4, 4}), size);
+  EXPECT_EQ((ns_t{0, 1, 0}), step);
+
+  EXPECT_EQ(layout::arbitrary,
+            index_multi_checked(ns_t{3, 1, 2, 5}, 5).layout_);
+}
+
 TEST(MathIndexingIndex, index_omni) {
   index_omni idx;
   (void)idx;  // just to silence compiler griping about idx being unused
@@ -0,0 +1,87 @@
+#include <stan/model/indexing/multi_index_kernels.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+using stan::model::internal::gather;
+using stan::model::internal::make_multi_index_runs;
+using stan::model::internal::scatter_add;
+
+TEST(ModelIndexingMultiIndexKernels, runs) {
+  std::vector<int> ns{2, 3, 4, 1, 1, 5};
+  auto runs = make_multi_index_runs("", "", ns, 5);
+  EXPECT_EQ(6, runs.size_);
+  ASSERT_EQ(4, runs.num_runs_);
+  EXPECT_EQ(1, runs.starts_[0]);
+  EXPECT_EQ(0, runs.starts_[1]);
+  EXPECT_EQ(0, runs.starts_[2]);
+  EXPECT_EQ(4, runs.starts_[3]);
+  EXPECT_EQ(0, runs.offsets_[0]);
+  EXPECT_EQ(3, runs.offsets_[1]);
+  EXPECT_EQ(4, runs.offsets_[2]);
+  EXPECT_EQ(5, runs.offsets_[3]);
+  EXPECT_EQ(6, runs.offsets_[4]);
+
+  auto empty = make_multi_index_runs("", "", std::vector<int>{}, 5);
+  EXPECT_EQ(0, empty.num_runs_);
+
+  EXPECT_THROW(make_multi_index_runs("", "", ns, 4), std::out_of_range);
+  ns.push_back(0);
+  EXPECT_THROW(make_multi_index_runs("", "", ns, 5), std::out_of_range);
+}
+
+TEST(ModelIndexingMultiIndexKernels, gather_scatter_vector) {
+  std::vector<int> ns{2, 3, 4, 1, 1, 5};
+  auto runs = make_multi_index_runs("", "", ns, 5);
+  Eigen::VectorXd x(5);
+  x << 10, 20, 30, 40, 50;
+  Eigen::VectorXd y(6);
+  gather(runs, x, y);
+  for (size_t i = 0; i < ns.size(); ++i)
+    EXPECT_FLOAT_EQ(x(ns[i] - 1), y(i));
+
+  Eigen::VectorXd x_adj = Eigen::VectorXd::Zero(5);
+  Eigen::VectorXd y_adj(6);
+  y_adj << 1, 2, 3, 4, 5, 6;
+  scatter_add(runs, y_adj, x_adj);
+  EXPECT_FLOAT_EQ(9, x_adj(0));
+  EXPECT_FLOAT_EQ(1, x_adj(1));
+  EXPECT_FLOAT_EQ(2, x_adj(2));
+  EXPECT_FLOAT_EQ(3, x_adj(3));
+  EXPECT_FLOAT_EQ(6, x_adj(4));
+}
+
+TEST(ModelIndexingMultiIndexKernels, gather_scatter_matrix_rows) {
+  std::vector<int> ns{3, 1, 2, 3};
+  auto runs = make_multi_index_runs("", "", ns, 3, 2);
+  Eigen::MatrixXd x(3, 2);
+  x << 1, 2, 3, 4, 5, 6;
+  Eigen::MatrixXd y(4, 2);
+  gather(runs, x, y);
+  for (size_t i = 0; i < ns.size(); ++i)
+    EXPECT_MATRIX_EQ(x.row(ns[i] - 1), y.row(i));
+
+  Eigen::MatrixXd x_adj = Eigen::MatrixXd::Zero(3, 2);
+  scatter_add(runs, Eigen::MatrixXd::Ones(4, 2), x_adj);
+  EXPECT_FLOAT_EQ(1, x_adj(0, 0));
+  EXPECT_FLOAT_EQ(1, x_adj(1, 1));
+  EXPECT_FLOAT_EQ(2, x_adj(2, 0));
+  EXPECT_FLOAT_EQ(2, x_adj(2, 1));
+}
+
+TEST(ModelIndexingMultiIndexKernels, scatter_large) {
+  const int n = 1 << 17;
+  std::vector<int> ns(n);
+  for (int i = 0; i < n; ++i)
+    ns[i] = (i * 7919) % 1000 + 1;
+  auto runs = make_multi_index_runs("", "", ns, 1000);
+  Eigen::VectorXd y_adj = Eigen::VectorXd::LinSpaced(n, 0, 1);
+  Eigen::VectorXd x_adj = Eigen::VectorXd::Zero(1000);
+  scatter_add(runs, y_adj, x_adj);
+  Eigen::VectorXd expected = Eigen::VectorXd::Zero(1000);
+  for (int i = 0; i < n; ++i)
+    expected(ns[i] - 1) += y_adj(i);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_NEAR(expected(i), x_adj(i), 1e-8);
+}
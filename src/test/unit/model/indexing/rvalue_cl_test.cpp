@@ -16,6 +16,7 @@ using stan::model::index_max;
 using stan::model::index_min;
 using stan::model::index_min_max;
 using stan::model::index_multi;
+using stan::model::index_multi_cl;
 using stan::model::index_omni;
 using stan::model::index_uni;
 
@@ -108,6 +109,52 @@ TEST(ModelIndexing, rvalue_opencl_matrix_1d) {
       indices);
 }
 
+TEST(ModelIndexing, rvalue_opencl_index_multi_cl) {
+  Eigen::VectorXd v(4);
+  v << 1, 2, 3, 4;
+  Eigen::MatrixXd m(4, 2);
+  m << 1, 2, 3, 4, 5, 6, 7, 8;
+  std::vector<int> ns{1, 2, 1, 3, 1};
+  index_multi idx(ns);
+  index_multi_cl idx_cl(ns, 4);
+  stan::math::matrix_cl<double> v_cl(v);
+  stan::math::matrix_cl<double> m_cl(m);
+  expect_eq(rvalue(v, "", idx),
+            from_matrix_cl_nonscalar(rvalue(v_cl, "", idx_cl)));
+  expect_eq(rvalue(m, "", idx),
+            from_matrix_cl_nonscalar(rvalue(m_cl, "", idx_cl)));
+
+  stan::math::vector_v v_v1 = v;
+  stan::math::vector_v v_v2 = v;
+  stan::math::var_value<stan::math::matrix_cl<double>> v_v_cl
+      = stan::math::to_matrix_cl(v_v2);
+  auto correct = stan::math::eval(rvalue(v_v1, "", idx));
+  auto res = from_matrix_cl_nonscalar(rvalue(v_v_cl, "", idx_cl));
+  expect_eq(correct.val(), res.val());
+  set_adjoints1(correct);
+  set_adjoints1(res);
+  stan::math::grad();
+  expect_eq(v_v1.adj(), v_v2.adj());
+  stan::math::recover_memory();
+
+  stan::math::matrix_v m_v1 = m;
+  stan::math::matrix_v m_v2 = m;
+  stan::math::var_value<stan::math::matrix_cl<double>> m_v_cl
+      = stan::math::to_matrix_cl(m_v2);
+  auto correct_m = rvalue(m_v1, "", idx);
+  auto res_m = from_matrix_cl_nonscalar(rvalue(m_v_cl, "", idx_cl));
+  expect_eq(correct_m.val(), res_m.val());
+  set_adjoints1(correct_m);
+  set_adjoints1(res_m);
+  stan::math::grad();
+  expect_eq(m_v1.adj(), m_v2.adj());
+  stan::math::recover_memory();
+
+  stan::math::matrix_cl<double> short_cl(Eigen::VectorXd(v.head(2)));
+  EXPECT_THROW(rvalue(short_cl, "", idx_cl), std::out_of_range);
+  EXPECT_THROW(index_multi_cl(ns, 2), std::out_of_range);
+}
+
 TEST(ModelIndexing, rvalue_opencl_matrix_2d) {
   Eigen::MatrixXd m(4, 4);
   m << 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16;
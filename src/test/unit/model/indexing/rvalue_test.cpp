@@ -11,6 +11,7 @@ using stan::model::index_max;
 using stan::model::index_min;
 using stan::model::index_min_max;
 using stan::model::index_multi;
+using stan::model::index_multi_checked;
 using stan::model::index_omni;
 using stan::model::index_uni;
 
@@ -725,6 +726,69 @@ TEST(ModelIndexing, rvalueRowVectorMulti) {
   vector_multi_test<Eigen::RowVectorXd>();
 }
 
+TEST(ModelIndexing, rvalueVectorMultiChecked) {
+  Eigen::VectorXd v(4);
+  v << 1, 2, 3, 4;
+  index_multi_checked idx(std::vector<int>{3, 1, 4, 3}, 4);
+  Eigen::VectorXd vi = rvalue(v, "", idx);
+  EXPECT_EQ(4, vi.size());
+  EXPECT_FLOAT_EQ(3.0, vi(0));
+  EXPECT_FLOAT_EQ(1.0, vi(1));
+  EXPECT_FLOAT_EQ(4.0, vi(2));
+  EXPECT_FLOAT_EQ(3.0, vi(3));
+
+  Eigen::VectorXd w = v.head(3);
+  test_out_of_range(w, idx);
+}
+
+TEST(ModelIndexing, rvalueMultiCheckedLayouts) {
+  Eigen::VectorXd v = Eigen::VectorXd::LinSpaced(6, 1, 6);
+  Eigen::MatrixXd m(6, 2);
+  m << v, -v;
+  std::vector<std::vector<int>> ns{
+      {2, 3, 4}, {1, 3, 5}, {5, 5, 5, 5, 1, 2, 3, 4}, {3, 1, 2, 5}};
+  for (const auto& n : ns) {
+    index_multi_checked idx(n, 6);
+    Eigen::VectorXd vi = rvalue(v, "", idx);
+    Eigen::MatrixXd mi = rvalue(m, "", idx);
+    ASSERT_EQ(n.size(), vi.size());
+    ASSERT_EQ(n.size(), mi.rows());
+    for (size_t i = 0; i < n.size(); ++i) {
+      EXPECT_FLOAT_EQ(v(n[i] - 1), vi(i));
+      EXPECT_FLOAT_EQ(-v(n[i] - 1), mi(i, 1));
+    }
+  }
+}
+
+TEST(ModelIndexing, rvalueMatrixMultiChecked) {
+  Eigen::MatrixXd m(3, 2);
+  m << 0.0, 0.1, 1.0, 1.1, 2.0, 2.1;
+  index_multi_checked idx(std::vector<int>{3, 1}, 3);
+  Eigen::MatrixXd mi = rvalue(m, "", idx);
+  EXPECT_EQ(2, mi.rows());
+  EXPECT_EQ(2, mi.cols());
+  EXPECT_FLOAT_EQ(2.0, mi(0, 0));
+  EXPECT_FLOAT_EQ(2.1, mi(0, 1));
+  EXPECT_FLOAT_EQ(0.0, mi(1, 0));
+  EXPECT_FLOAT_EQ(0.1, mi(1, 1));
+
+  Eigen::MatrixXd n = m.topRows(2);
+  test_out_of_range(n, idx);
+}
+
+TEST(ModelIndexing, rvalueArrayMultiChecked) {
+  std::vector<std::vector<double>> x{{0.0, 0.1}, {1.0, 1.1}, {2.0, 2.1}};
+  index_multi_checked idx(std::vector<int>{2, 3, 2}, 3);
+  std::vector<double> xi = rvalue(x, "", idx, index_uni(2));
+  EXPECT_EQ(3, xi.size());
+  EXPECT_FLOAT_EQ(1.1, xi[0]);
+  EXPECT_FLOAT_EQ(2.1, xi[1]);
+  EXPECT_FLOAT_EQ(1.1, xi[2]);
+
+  x.pop_back();
+  test_out_of_range(x, idx);
+}
+
 TEST(ModelIndexing, rvalueMatrixUni) {
   using Eigen::MatrixXd;
   using Eigen::RowVectorXd;
@@ -0,0 +1,68 @@
+#include <stan/model/log_prob_grad_batch.hpp>
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/model/valid.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(ModelUtil, log_prob_grad_batch) {
+  stan::io::empty_var_context data_var_context;
+  std::stringstream output;
+  stan_model model(data_var_context, 0, &output);
+
+  Eigen::MatrixXd points(1, 4);
+  points << -1.5, 0, 0.25, 3;
+  Eigen::VectorXd log_prob;
+  Eigen::MatrixXd gradients;
+  stan::model::log_prob_grad_batch<true, true>(model, points, log_prob,
+                                               gradients, &output);
+
+  ASSERT_EQ(4, log_prob.size());
+  ASSERT_EQ(1, gradients.rows());
+  ASSERT_EQ(4, gradients.cols());
+  Eigen::VectorXd gradient;
+  for (int i = 0; i < points.cols(); ++i) {
+    Eigen::VectorXd x = points.col(i);
+    double lp = stan::model::log_prob_grad<true, true>(model, x, gradient);
+    EXPECT_FLOAT_EQ(lp, log_prob(i));
+    EXPECT_FLOAT_EQ(gradient(0), gradients(0, i));
+    EXPECT_FLOAT_EQ(-points(0, i), gradients(0, i));
+  }
+  EXPECT_EQ("", output.str());
+}
+
+TEST(ModelUtil, log_prob_grad_batch_model_base) {
+  stan::io::empty_var_context data_var_context;
+  stan_model model(data_var_context, 0, nullptr);
+  const stan::model::model_base& base = model;
+
+  Eigen::MatrixXd points(1, 3);
+  points << -2, 1, 0.5;
+  Eigen::VectorXd log_prob;
+  Eigen::MatrixXd gradients;
+  for (bool propto : {false, true}) {
+    for (bool jacobian : {false, true}) {
+      base.log_prob_grad_batch(propto, jacobian, points, log_prob, gradients);
+      ASSERT_EQ(3, log_prob.size());
+      for (int i = 0; i < points.cols(); ++i) {
+        // the model has no constants to drop and no constraints
+        EXPECT_FLOAT_EQ(-0.5 * points(0, i) * points(0, i), log_prob(i));
+        EXPECT_FLOAT_EQ(-points(0, i), gradients(0, i));
+      }
+    }
+  }
+}
+
+TEST(ModelUtil, log_prob_grad_batch_empty) {
+  stan::io::empty_var_context data_var_context;
+  stan_model model(data_var_context, 0, nullptr);
+
+  Eigen::MatrixXd points(1, 0);
+  Eigen::VectorXd log_prob;
+  Eigen::MatrixXd gradients;
+  stan::model::log_prob_grad_batch<true, true>(model, points, log_prob,
+                                               gradients);
+  EXPECT_EQ(0, log_prob.size());
+  EXPECT_EQ(1, gradients.rows());
+  EXPECT_EQ(0, gradients.cols());
+}
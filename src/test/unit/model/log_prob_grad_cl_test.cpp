@@ -0,0 +1,66 @@
+#ifdef STAN_OPENCL
+#include <stan/model/analytic_gradient_model.hpp>
+#include <stan/model/log_prob_grad_cl.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+// standard normal log density over two parameters
+struct normal_model {
+  stan::model::analytic_gradient_model model{
+      "normal",
+      {"mu"},
+      {{2}},
+      [](const Eigen::VectorXd& x) { return -0.5 * x.squaredNorm(); },
+      [](const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+        grad = -x;
+        return -0.5 * x.squaredNorm();
+      }};
+};
+
+// a model evaluated on the device, counting its evaluations
+struct device_model {
+  mutable int num_gradients = 0;
+  double device_log_prob_grad(const stan::math::matrix_cl<double>& params_r,
+                              stan::math::matrix_cl<double>& gradient) const {
+    ++num_gradients;
+    gradient = stan::math::matrix_cl<double>(-1.0 * params_r);
+    return -0.5
+           * stan::math::from_matrix_cl<Eigen::VectorXd>(params_r)
+                 .squaredNorm();
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, log_prob_grad_cl_copies_host_models) {
+  normal_model normal;
+  const auto& model = normal.model;
+  Eigen::VectorXd q(2);
+  q << 1, -2;
+  stan::math::matrix_cl<double> params_r = stan::math::to_matrix_cl(q);
+  stan::math::matrix_cl<double> gradient;
+
+  double lp = stan::model::log_prob_grad_cl<true, true>(model, params_r,
+                                                        gradient);
+  EXPECT_FLOAT_EQ(-2.5, lp);
+  EXPECT_MATRIX_EQ(-q, stan::math::from_matrix_cl<Eigen::VectorXd>(gradient));
+}
+
+TEST(ModelUtil, log_prob_grad_cl_stays_on_device) {
+  EXPECT_FALSE(stan::model::internal::has_device_gradient<
+               stan::model::analytic_gradient_model>::value);
+  EXPECT_TRUE(stan::model::internal::has_device_gradient<device_model>::value);
+
+  device_model model;
+  Eigen::VectorXd q(2);
+  q << 1, -2;
+  stan::math::matrix_cl<double> params_r = stan::math::to_matrix_cl(q);
+  stan::math::matrix_cl<double> gradient;
+
+  double lp = stan::model::log_prob_grad_cl<true, true>(model, params_r,
+                                                        gradient);
+  EXPECT_EQ(1, model.num_gradients);
+  EXPECT_FLOAT_EQ(-2.5, lp);
+  EXPECT_MATRIX_EQ(-q, stan::math::from_matrix_cl<Eigen::VectorXd>(gradient));
+}
+#endif
@@ -0,0 +1,94 @@
+#include <stan/model/memoized_model.hpp>
+#include <stan/model/gradient_evaluator.hpp>
+#include <gtest/gtest.h>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// log density -x^2 / 2 plus a constant kept only when propto is false,
+// counting its evaluations
+struct mock_model {
+  mutable int num_evaluations = 0;
+
+  size_t num_params_r() const { return 1; }
+
+  template <bool propto, bool jacobian, typename VecR>
+  auto log_prob(VecR& params_r, std::ostream* msgs) const {
+    ++num_evaluations;
+    if (stan::math::value_of(params_r[0]) > 10)
+      throw std::domain_error("too large");
+    return -0.5 * params_r[0] * params_r[0] + (propto ? 0 : -1);
+  }
+};
+}  // namespace
+
+TEST(ModelMemoizedModel, log_prob) {
+  mock_model model;
+  stan::model::memoized_model<mock_model> memoized(model, 2);
+  EXPECT_EQ(1U, memoized.num_params_r());
+  EXPECT_EQ(&model, &memoized.model());
+  EXPECT_EQ(2U, memoized.capacity());
+  EXPECT_FLOAT_EQ(0, memoized.hit_rate());
+
+  std::vector<double> x{2};
+  EXPECT_FLOAT_EQ(-3, (memoized.log_prob<false, true>(x, nullptr)));
+  EXPECT_FLOAT_EQ(-3, (memoized.log_prob<false, true>(x, nullptr)));
+  EXPECT_EQ(1, model.num_evaluations);
+  EXPECT_FLOAT_EQ(-2, (memoized.log_prob<true, true>(x, nullptr)));
+  EXPECT_EQ(2, model.num_evaluations);
+  EXPECT_EQ(1U, memoized.num_hits());
+  EXPECT_EQ(3U, memoized.num_lookups());
+  EXPECT_FLOAT_EQ(1.0 / 3, memoized.hit_rate());
+
+  // a third point replaces the oldest
+  std::vector<double> y{1};
+  EXPECT_FLOAT_EQ(-1.5, (memoized.log_prob<false, true>(y, nullptr)));
+  EXPECT_FLOAT_EQ(-3, (memoized.log_prob<false, true>(x, nullptr)));
+  EXPECT_EQ(4, model.num_evaluations);
+
+  memoized.clear();
+  EXPECT_EQ(0U, memoized.num_lookups());
+  EXPECT_FLOAT_EQ(-3, (memoized.log_prob<false, true>(x, nullptr)));
+  EXPECT_EQ(5, model.num_evaluations);
+}
+
+TEST(ModelMemoizedModel, gradient) {
+  mock_model model;
+  stan::model::memoized_model<mock_model> memoized(model);
+  stan::model::gradient_evaluator<stan::model::memoized_model<mock_model>>
+      evaluator(memoized);
+  Eigen::VectorXd x(1);
+  x << 2;
+  double f;
+  Eigen::VectorXd grad;
+  for (int n = 0; n < 3; ++n) {
+    evaluator(x, f, grad);
+    EXPECT_FLOAT_EQ(-2, f);
+    ASSERT_EQ(1, grad.size());
+    EXPECT_FLOAT_EQ(-2, grad(0));
+  }
+  EXPECT_EQ(1, model.num_evaluations);
+  EXPECT_EQ(2U, memoized.num_hits());
+  EXPECT_EQ(3U, memoized.num_lookups());
+}
+
+TEST(ModelMemoizedModel, throws) {
+  mock_model model;
+  stan::model::memoized_model<mock_model> memoized(model);
+  std::vector<double> x{20};
+  EXPECT_THROW((memoized.log_prob<true, true>(x, nullptr)), std::domain_error);
+  EXPECT_THROW((memoized.log_prob<true, true>(x, nullptr)), std::domain_error);
+  EXPECT_EQ(2, model.num_evaluations);
+  EXPECT_EQ(0U, memoized.num_hits());
+}
+
+TEST(ModelMemoizedModel, no_capacity) {
+  mock_model model;
+  stan::model::memoized_model<mock_model> memoized(model, 0);
+  std::vector<double> x{2};
+  EXPECT_FLOAT_EQ(-2, (memoized.log_prob<true, true>(x, nullptr)));
+  EXPECT_FLOAT_EQ(-2, (memoized.log_prob<true, true>(x, nullptr)));
+  EXPECT_EQ(2, model.num_evaluations);
+  EXPECT_EQ(0U, memoized.num_lookups());
+}
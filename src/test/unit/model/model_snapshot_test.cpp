@@ -0,0 +1,144 @@
+#include <stan/model/model_snapshot.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+const std::string filename = "model_snapshot_test.bin";
+
+stan::io::array_var_context make_context(double y = 1.5) {
+  std::vector<std::string> names_r{"y", "x"};
+  std::vector<double> vals_r{y, 2.5, 1, 2, 3, 4};
+  std::vector<std::vector<size_t>> dims_r{{2}, {2, 2}};
+  std::vector<std::string> names_i{"N"};
+  std::vector<int> vals_i{2};
+  std::vector<std::vector<size_t>> dims_i{{}};
+  return stan::io::array_var_context(names_r, vals_r, dims_r, names_i, vals_i,
+                                     dims_i);
+}
+
+// a model whose transformed data is the Cholesky factor of x
+struct mock_model {
+  int N = 0;
+  Eigen::MatrixXd L;
+  bool supported = true;
+  int num_computed = 0;
+
+  explicit mock_model(bool supported = true) : supported(supported) {}
+
+  void compute(const stan::io::var_context& context) {
+    N = context.vals_i("N")[0];
+    std::vector<double> x = context.vals_r("x");
+    Eigen::Map<Eigen::MatrixXd> X(x.data(), N, N);
+    L = (X * X.transpose()).llt().matrixL();
+    ++num_computed;
+  }
+
+  std::string model_name() const { return "mock_model"; }
+
+  std::vector<std::string> model_compile_info() const {
+    return {"stanc_version = stanc3"};
+  }
+
+  size_t data_snapshot_size() const { return supported ? 1 + L.size() : 0; }
+
+  void write_data_snapshot(stan::io::serializer<double>& out) const {
+    out.write(static_cast<double>(N));
+    out.write(L);
+  }
+
+  bool read_data_snapshot(stan::io::deserializer<double>& in) {
+    N = static_cast<int>(in.read<double>());
+    L = in.read<Eigen::MatrixXd>(N, N);
+    return true;
+  }
+};
+
+class ModelSnapshot : public testing::Test {
+ public:
+  void TearDown() { std::remove(filename.c_str()); }
+};
+}  // namespace
+
+TEST_F(ModelSnapshot, data_hash) {
+  const std::string hash = stan::model::data_hash(make_context());
+  EXPECT_EQ(16, hash.size());
+  EXPECT_EQ(hash, stan::model::data_hash(make_context()));
+  EXPECT_NE(hash, stan::model::data_hash(make_context(1.25)));
+}
+
+TEST_F(ModelSnapshot, round_trip) {
+  stan::io::array_var_context context = make_context();
+  mock_model model;
+  model.compute(context);
+  const std::string key = stan::model::model_snapshot_key(model, context);
+  EXPECT_NE(std::string::npos, key.find("mock_model\nstanc_version"));
+  ASSERT_TRUE(stan::model::save_model_snapshot(filename, model, key));
+
+  stan::model::model_snapshot snapshot(filename);
+  EXPECT_EQ(key, snapshot.key());
+  EXPECT_EQ(5, snapshot.size());
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(snapshot.data())
+                   % alignof(double));
+
+  // the loaded model has the transformed data without computing it
+  mock_model loaded;
+  loaded.L.resize(2, 2);
+  ASSERT_TRUE(stan::model::load_model_snapshot(filename, loaded, key));
+  EXPECT_EQ(0, loaded.num_computed);
+  EXPECT_EQ(2, loaded.N);
+  ASSERT_EQ(2, loaded.L.rows());
+  for (Eigen::Index i = 0; i < model.L.size(); ++i)
+    EXPECT_EQ(model.L(i), loaded.L(i));
+}
+
+TEST_F(ModelSnapshot, rejects_other_model_or_data) {
+  stan::io::array_var_context context = make_context();
+  mock_model model;
+  model.compute(context);
+  ASSERT_TRUE(stan::model::save_model_snapshot(
+      filename, model, stan::model::model_snapshot_key(model, context)));
+
+  // other data give another key, so the snapshot is not loaded
+  mock_model other;
+  other.L.resize(2, 2);
+  const std::string other_key
+      = stan::model::model_snapshot_key(other, make_context(2));
+  EXPECT_FALSE(stan::model::load_model_snapshot(filename, other, other_key));
+  EXPECT_EQ(0, other.N);
+
+  // as does a snapshot of another size
+  other.L.resize(3, 3);
+  EXPECT_FALSE(stan::model::load_model_snapshot(
+      filename, other, stan::model::model_snapshot_key(other, context)));
+
+  EXPECT_FALSE(
+      stan::model::load_model_snapshot("no_such_snapshot.bin", other, ""));
+}
+
+TEST_F(ModelSnapshot, unsupported_model) {
+  mock_model model(false);
+  model.compute(make_context());
+  EXPECT_FALSE(stan::model::save_model_snapshot(filename, model, "key"));
+  EXPECT_FALSE(std::ifstream(filename).good());
+}
+
+TEST_F(ModelSnapshot, invalid_file) {
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << "STANDAT1 not a snapshot";
+  }
+  EXPECT_THROW(stan::model::model_snapshot snapshot(filename),
+               std::invalid_argument);
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(stan::model::model_snapshot::MAGIC, 8);
+  }
+  EXPECT_THROW(stan::model::model_snapshot snapshot(filename),
+               std::invalid_argument);
+}
@@ -0,0 +1,39 @@
+#include <stan/model/parallel_for_if_threads.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(ModelUtil, parallel_for_if_threads_visits_each_index_once) {
+  std::vector<int> visits(1000, 0);
+  stan::model::internal::parallel_for_if_threads(
+      0, 1000, [&](const tbb::blocked_range<int>& r) {
+        for (int i = r.begin(); i != r.end(); ++i)
+          ++visits[i];
+      });
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_EQ(1, visits[i]) << "index " << i;
+}
+
+TEST(ModelUtil, parallel_for_if_threads_empty_range) {
+  int calls = 0;
+  stan::model::internal::parallel_for_if_threads(
+      std::size_t{3}, std::size_t{3},
+      [&](const tbb::blocked_range<std::size_t>& r) { calls += r.size(); });
+  EXPECT_EQ(0, calls);
+}
+
+#ifndef STAN_THREADS
+TEST(ModelUtil, parallel_for_if_threads_serial_without_threads) {
+  EXPECT_FALSE(stan::model::internal::threads_have_autodiff_stacks);
+  const std::thread::id caller = std::this_thread::get_id();
+  int calls = 0;
+  stan::model::internal::parallel_for_if_threads(
+      0, 1000, [&](const tbb::blocked_range<int>& r) {
+        ++calls;
+        EXPECT_EQ(caller, std::this_thread::get_id());
+        EXPECT_EQ(0, r.begin());
+        EXPECT_EQ(1000, r.end());
+      });
+  EXPECT_EQ(1, calls);
+}
+#endif
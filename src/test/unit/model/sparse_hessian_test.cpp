@@ -0,0 +1,105 @@
+#include <stan/model/sparse_hessian.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+// negative Hessian of a hierarchical model: num_hyper hyperparameters
+// interacting with everything, then groups of size group_size
+// interacting within the group
+Eigen::MatrixXd hierarchical_matrix(int num_hyper, int num_groups,
+                                    int group_size) {
+  const int n = num_hyper + num_groups * group_size;
+  Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+  for (int i = 0; i < n; ++i)
+    a(i, i) = n + i;
+  for (int h = 0; h < num_hyper; ++h)
+    for (int i = 0; i < n; ++i)
+      if (i != h)
+        a(h, i) = a(i, h) = 0.25 + 0.01 * i;
+  for (int g = 0; g < num_groups; ++g)
+    for (int i = 0; i < group_size; ++i)
+      for (int j = 0; j < i; ++j) {
+        const int r = num_hyper + g * group_size + i;
+        const int c = num_hyper + g * group_size + j;
+        a(r, c) = a(c, r) = 0.5 + 0.1 * j;
+      }
+  return a;
+}
+
+struct matrix_product {
+  const Eigen::MatrixXd& a;
+  mutable int calls = 0;
+  void operator()(const Eigen::VectorXd& v, Eigen::VectorXd& av) const {
+    ++calls;
+    av = a * v;
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, sparse_hessian_hierarchical) {
+  Eigen::MatrixXd a = hierarchical_matrix(3, 100, 4);
+  const int n = a.rows();
+  matrix_product product{a};
+  stan::model::hessian_sparsity pattern
+      = stan::model::detect_hessian_sparsity(product, n);
+  EXPECT_EQ(n, product.calls);
+  ASSERT_EQ(n, pattern.size());
+
+  int nnz = 0;
+  for (int j = 0; j < n; ++j)
+    for (int i = 0; i < n; ++i)
+      nnz += a(i, j) != 0;
+  int pattern_nnz = 0;
+  for (const auto& column : pattern.rows)
+    pattern_nnz += column.size();
+  EXPECT_EQ(nnz, pattern_nnz);
+  // a color per hyperparameter and one per member of a group
+  EXPECT_EQ(3 + 4, pattern.num_colors);
+
+  product.calls = 0;
+  Eigen::SparseMatrix<double> hess;
+  stan::model::sparse_hessian(product, pattern, hess);
+  EXPECT_EQ(pattern.num_colors, product.calls);
+  ASSERT_EQ(n, hess.rows());
+  ASSERT_EQ(n, hess.cols());
+  EXPECT_EQ(nnz, hess.nonZeros());
+  EXPECT_TRUE(Eigen::MatrixXd(hess).isApprox(a, 1e-12));
+}
+
+TEST(ModelUtil, sparse_hessian_banded) {
+  const int n = 50;
+  Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 4 + i;
+    if (i > 0)
+      a(i, i - 1) = a(i - 1, i) = -1 - 0.1 * i;
+  }
+  matrix_product product{a};
+  stan::model::hessian_sparsity pattern
+      = stan::model::detect_hessian_sparsity(product, n);
+  EXPECT_EQ(3, pattern.num_colors);
+  Eigen::SparseMatrix<double> hess;
+  stan::model::sparse_hessian(product, pattern, hess);
+  EXPECT_TRUE(Eigen::MatrixXd(hess).isApprox(a, 1e-12));
+}
+
+TEST(ModelUtil, color_hessian_sparsity) {
+  // diagonal: every column shares one color
+  std::vector<std::vector<Eigen::Index>> rows{{0}, {1}, {2}, {3}};
+  stan::model::hessian_sparsity pattern
+      = stan::model::color_hessian_sparsity(rows);
+  EXPECT_EQ(1, pattern.num_colors);
+  for (int j = 0; j < 4; ++j)
+    EXPECT_FALSE(pattern.alone[j]);
+
+  Eigen::MatrixXd a = Eigen::VectorXd::LinSpaced(4, 1, 4).asDiagonal();
+  matrix_product product{a};
+  Eigen::SparseMatrix<double> hess;
+  stan::model::sparse_hessian(product, pattern, hess);
+  EXPECT_EQ(1, product.calls);
+  EXPECT_TRUE(Eigen::MatrixXd(hess).isApprox(a, 1e-12));
+
+  rows[1].push_back(7);
+  EXPECT_THROW(stan::model::color_hessian_sparsity(rows),
+               std::invalid_argument);
+}
@@ -0,0 +1,43 @@
+#include <stan/model/tempered_model.hpp>
+#include <gtest/gtest.h>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// log density -x^2 / 2 plus a constant kept only when propto is false
+struct mock_model {
+  size_t num_params_r() const { return 1; }
+
+  template <bool propto, bool jacobian, typename VecR>
+  double log_prob(VecR& params_r, std::ostream* msgs) const {
+    return -0.5 * params_r[0] * params_r[0] + (propto ? 0 : -1)
+           + (jacobian ? -2 : 0);
+  }
+};
+}  // namespace
+
+TEST(ModelTemperedModel, log_prob) {
+  mock_model model;
+  stan::model::tempered_model<mock_model> tempered(model, 0.25);
+  EXPECT_EQ(1U, tempered.num_params_r());
+  EXPECT_EQ(&model, &tempered.model());
+  std::vector<double> x{2};
+  EXPECT_FLOAT_EQ(-0.5, (tempered.log_prob<true, false>(x, nullptr)));
+  EXPECT_FLOAT_EQ(-0.75, (tempered.log_prob<false, false>(x, nullptr)));
+  EXPECT_FLOAT_EQ(-1, (tempered.log_prob<true, true>(x, nullptr)));
+
+  tempered.set_inv_temperature(1);
+  EXPECT_FLOAT_EQ(1, tempered.inv_temperature());
+  EXPECT_FLOAT_EQ(-2, (tempered.log_prob<true, false>(x, nullptr)));
+}
+
+TEST(ModelTemperedModel, invalid_inv_temperature) {
+  mock_model model;
+  using tempered_t = stan::model::tempered_model<mock_model>;
+  EXPECT_THROW(tempered_t(model, 0), std::domain_error);
+  EXPECT_THROW(tempered_t(model, 1.5), std::domain_error);
+  tempered_t tempered(model);
+  EXPECT_THROW(tempered.set_inv_temperature(-1), std::domain_error);
+  EXPECT_FLOAT_EQ(1, tempered.inv_temperature());
+}
@@ -3,6 +3,8 @@
 #include <stan/model/test_gradients.hpp>
 #include <stan/io/empty_var_context.hpp>
 #include <test/test-models/good/model/valid.hpp>
+#include <test/unit/model/test_model.hpp>
+#include <stan/services/util/create_rng.hpp>
 #include <test/unit/util.hpp>
 #include <test/unit/services/instrumented_callbacks.hpp>
 #include <gtest/gtest.h>
@@ -63,3 +65,64 @@ TEST(ModelUtil, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(ModelUtil, test_gradients_parallel) {
+  const int n = 30;
+  TestModel_quadratic model(n);
+  std::vector<double> params_r(n);
+  for (int k = 0; k < n; ++k)
+    params_r[k] = std::sin(k);
+  std::vector<int> params_i(0);
+  stan::callbacks::interrupt interrupt;
+  stan::test::unit::instrumented_logger logger;
+  std::stringstream out;
+  stan::callbacks::stream_writer writer(out);
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+
+  EXPECT_EQ(0, (stan::model::test_gradients<true, true>(
+                   model, params_r, params_i, 1e-6, 1e-6, 0, 3, rng,
+                   interrupt, logger, writer)));
+  EXPECT_EQ(1, logger.find_info("Largest errors"));
+  EXPECT_EQ(2, logger.find_info("param idx"));
+
+  out.str("");
+  EXPECT_EQ(n, (stan::model::test_gradients<true, true>(
+                   model, params_r, params_i, 1e-6, -1, 0, 0, rng, interrupt,
+                   logger, writer)));
+  EXPECT_EQ(std::string::npos, out.str().find("Largest errors"));
+
+  out.str("");
+  EXPECT_EQ(0, (stan::model::test_gradients<true, true>(
+                   model, params_r, params_i, 1e-6, 1e-6, 4, 2, rng,
+                   interrupt, logger, writer)));
+  EXPECT_NE(std::string::npos, out.str().find("direction"));
+  EXPECT_EQ(std::string::npos, out.str().find("       value"));
+}
+
+TEST(ModelUtil, test_gradients_forward) {
+  const int n = 30;
+  TestModel_quadratic model(n);
+  std::vector<double> params_r(n);
+  for (int k = 0; k < n; ++k)
+    params_r[k] = std::sin(k);
+  std::vector<int> params_i(0);
+  stan::callbacks::interrupt interrupt;
+  stan::test::unit::instrumented_logger logger;
+  std::stringstream out;
+  stan::callbacks::stream_writer writer(out);
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+
+  EXPECT_EQ(0, (stan::model::test_gradients_forward<true, true>(
+                   model, params_r, params_i, 1e-10, 5, 2, rng, interrupt,
+                   logger, writer)));
+  EXPECT_EQ(1, logger.find_info("Largest errors"));
+  EXPECT_EQ(2, logger.find_info("forward diff"));
+  EXPECT_EQ(2, logger.find_info("direction"));
+
+  out.str("");
+  EXPECT_EQ(0, (stan::model::test_gradients_forward<true, true>(
+                   model, params_r, params_i, 1e-10, 0, 0, rng, interrupt,
+                   logger, writer)));
+  EXPECT_NE(std::string::npos, out.str().find("param idx"));
+  EXPECT_EQ(std::string::npos, out.str().find("Largest errors"));
+}
@@ -25,4 +25,31 @@ class TestModel_uniform_01 {
   }
 };
 
+// log density -sum((k + 1) * x[k]^2) / 2, with gradient -(k + 1) * x[k]
+class TestModel_quadratic {
+ public:
+  explicit TestModel_quadratic(int n) : n_(n) {}
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(std::vector<T__>& params_r__, std::vector<int>& params_i__,
+               std::ostream* pstream__ = 0) const {
+    T__ lp__(propto__ ? 0.0 : 1.5);
+    for (int k = 0; k < n_; ++k)
+      lp__ -= 0.5 * (k + 1) * params_r__[k] * params_r__[k];
+    return lp__;
+  }
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(Eigen::Matrix<T__, -1, 1>& params_r__,
+               std::ostream* pstream__ = 0) const {
+    std::vector<T__> params_r_vec__(params_r__.data(),
+                                    params_r__.data() + params_r__.size());
+    std::vector<int> params_i__;
+    return log_prob<propto__, jacobian__>(params_r_vec__, params_i__,
+                                          pstream__);
+  }
+
+  int n_;
+};
+
 #endif
@@ -0,0 +1,62 @@
+#include <stan/model/unconstrain_array_batch.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// a positive scalar sigma and an unconstrained mu
+struct positive_model {
+  size_t num_params_r() const { return 2; }
+
+  void unconstrain_array(const Eigen::VectorXd& constrained,
+                         Eigen::VectorXd& unconstrained,
+                         std::ostream* msgs = nullptr) const {
+    if (!(constrained(0) > 0))
+      throw std::domain_error("sigma is not positive");
+    if (msgs)
+      *msgs << constrained(1) << ";";
+    unconstrained.resize(2);
+    unconstrained(0) = std::log(constrained(0));
+    unconstrained(1) = constrained(1);
+  }
+};
+}  // namespace
+
+TEST(ModelUtil, unconstrain_array_batch) {
+  positive_model model;
+  const int num_draws = 1000;
+  Eigen::MatrixXd constrained(2, num_draws);
+  for (int n = 0; n < num_draws; ++n) {
+    constrained(0, n) = std::exp(0.001 * n);
+    constrained(1, n) = n;
+  }
+  Eigen::MatrixXd unconstrained;
+  std::stringstream msgs;
+  stan::model::unconstrain_array_batch(model, constrained, unconstrained,
+                                       &msgs);
+  ASSERT_EQ(2, unconstrained.rows());
+  ASSERT_EQ(num_draws, unconstrained.cols());
+  std::stringstream expected_msgs;
+  for (int n = 0; n < num_draws; ++n) {
+    EXPECT_FLOAT_EQ(0.001 * n, unconstrained(0, n));
+    EXPECT_EQ(n, unconstrained(1, n));
+    expected_msgs << n << ";";
+  }
+  // the messages are in the order of the draws
+  EXPECT_EQ(expected_msgs.str(), msgs.str());
+
+  stan::model::unconstrain_array_batch(model, constrained.leftCols(0),
+                                       unconstrained);
+  EXPECT_EQ(0, unconstrained.cols());
+}
+
+TEST(ModelUtil, unconstrain_array_batch_throws) {
+  positive_model model;
+  Eigen::MatrixXd constrained(2, 3);
+  constrained << 1, -1, 2, 0, 0, 0;
+  Eigen::MatrixXd unconstrained;
+  EXPECT_THROW(stan::model::unconstrain_array_batch(model, constrained,
+                                                   unconstrained),
+               std::domain_error);
+}
@@ -192,3 +192,131 @@ TEST(OptimizationBfgsLinesearch, wolfeLineSearch) {
   EXPECT_LE(f1, f0 + c1 * alpha * p.dot(gradx0));
   EXPECT_LE(std::fabs(p.dot(gradx1)), c2 * std::fabs(p.dot(gradx0)));
 }
+
+TEST(OptimizationBfgsLinesearch, moreThuenteLineSearch) {
+  using stan::optimization::MoreThuenteLineSearch;
+
+  static const double c1 = 1e-4;
+  static const double c2 = 0.9;
+  static const double minAlpha = 1e-16;
+  static const double maxLSIts = 20;
+  static const double maxLSRestarts = 10;
+
+  linesearch_testfunc func1;
+  Eigen::Matrix<double, -1, 1> x0, x1;
+  double f0, f1;
+  Eigen::Matrix<double, -1, 1> p, gradx0, gradx1;
+  double alpha;
+  int ret;
+
+  x0.setOnes(5, 1);
+  func1(x0, f0, gradx0);
+
+  p = -gradx0;
+
+  for (double alpha_init : {2.0, 10.0, 0.25, 1e-3}) {
+    alpha = alpha_init;
+    ret = MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0,
+                                gradx0, c1, c2, minAlpha, maxLSIts,
+                                maxLSRestarts);
+    EXPECT_EQ(0, ret);
+    EXPECT_NEAR(0, (x1 - (x0 + alpha * p)).norm(), 1e-8);
+    EXPECT_EQ(f1, func1(x1));
+    EXPECT_LE(f1, f0 + c1 * alpha * p.dot(gradx0));
+    EXPECT_LE(std::fabs(p.dot(gradx1)), c2 * std::fabs(p.dot(gradx0)));
+  }
+  // the quadratic is minimized exactly from a bracketing step
+  alpha = 2.0;
+  MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0, gradx0, c1,
+                        c2, minAlpha, maxLSIts, maxLSRestarts);
+  EXPECT_NEAR(0.5, alpha, 1e-8);
+  // an acceptable first step is kept
+  alpha = 0.25;
+  MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0, gradx0, c1,
+                        c2, minAlpha, maxLSIts, maxLSRestarts);
+  EXPECT_NEAR(0.25, alpha, 1e-8);
+
+  // not a descent direction
+  alpha = 1.0;
+  ret = MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, gradx0, x0, f0,
+                              gradx0, c1, c2, minAlpha, maxLSIts,
+                              maxLSRestarts);
+  EXPECT_NE(0, ret);
+}
+
+class linesearch_failing_testfunc : public linesearch_testfunc {
+ public:
+  int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f,
+                 Eigen::Matrix<double, Eigen::Dynamic, 1> &g) {
+    // evaluation fails outside the unit ball
+    if (x.norm() > 1.0)
+      return 1;
+    return linesearch_testfunc::operator()(x, f, g);
+  }
+};
+
+TEST(OptimizationBfgsLinesearch, moreThuenteLineSearch_failures) {
+  using stan::optimization::MoreThuenteLineSearch;
+
+  linesearch_failing_testfunc func1;
+  Eigen::Matrix<double, -1, 1> x0, x1;
+  double f0, f1;
+  Eigen::Matrix<double, -1, 1> p, gradx0, gradx1;
+
+  x0.setConstant(4, 0.4);
+  func1(x0, f0, gradx0);
+  p = -gradx0;
+
+  double alpha = 10.0;
+  int ret = MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0,
+                                  gradx0, 1e-4, 0.9, 1e-16, 20.0, 10.0);
+  EXPECT_EQ(0, ret);
+  EXPECT_LE(x1.norm(), 1.0);
+  EXPECT_LE(f1, f0 + 1e-4 * alpha * p.dot(gradx0));
+  EXPECT_LE(std::fabs(p.dot(gradx1)), 0.9 * std::fabs(p.dot(gradx0)));
+
+  alpha = 10.0;
+  ret = MoreThuenteLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0,
+                              gradx0, 1e-4, 0.9, 1e-16, 20.0, 0.0);
+  EXPECT_NE(0, ret);
+}
+
+template <typename F>
+void expect_wolfe_parallel_trials_match(F &func1, const Eigen::VectorXd &x0) {
+  using stan::optimization::WolfeLineSearch;
+  double f0;
+  Eigen::VectorXd gradx0;
+  func1(x0, f0, gradx0);
+  Eigen::VectorXd p = -gradx0;
+
+  for (double alpha_init : {2.0, 10.0, 0.25, 1e-3, 1e-6}) {
+    Eigen::VectorXd x1, gradx1;
+    double f1;
+    double alpha = alpha_init;
+    int ret = WolfeLineSearch(func1, alpha, x1, f1, gradx1, p, x0, f0, gradx0,
+                              1e-4, 0.9, 1e-16, 20.0, 10.0);
+    for (size_t parallel_trials : {2, 3, 8}) {
+      Eigen::VectorXd x1_par, gradx1_par;
+      double f1_par;
+      double alpha_par = alpha_init;
+      int ret_par = WolfeLineSearch(func1, alpha_par, x1_par, f1_par,
+                                    gradx1_par, p, x0, f0, gradx0, 1e-4, 0.9,
+                                    1e-16, 20.0, 10.0, parallel_trials);
+      EXPECT_EQ(ret, ret_par);
+      EXPECT_EQ(alpha, alpha_par);
+      EXPECT_EQ(f1, f1_par);
+      EXPECT_EQ(x1, x1_par);
+      EXPECT_EQ(gradx1, gradx1_par);
+    }
+  }
+}
+
+TEST(OptimizationBfgsLinesearch, wolfeLineSearch_parallelTrials) {
+  linesearch_testfunc func1;
+  Eigen::VectorXd x0 = Eigen::VectorXd::Ones(5);
+  expect_wolfe_parallel_trials_match(func1, x0);
+
+  linesearch_failing_testfunc func2;
+  x0.setConstant(4, 0.4);
+  expect_wolfe_parallel_trials_match(func2, x0);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <stan/optimization/bfgs.hpp>
+#include <stan/callbacks/cancellation_token.hpp>
 #include <stan/io/empty_var_context.hpp>
 #include <test/test-models/good/optimization/rosenbrock.hpp>
 #include <sstream>
@@ -295,6 +296,7 @@ TEST_F(OptimizationBfgsMinimizer, get_code_string) {
          "tolerance");
   EXPECT_TRUE(bfgs.get_code_string(40)
               == "Maximum number of iterations hit, may not be at an optima");
+  EXPECT_TRUE(bfgs.get_code_string(50) == "Stopped on request");
   EXPECT_TRUE(bfgs.get_code_string(-1) == "Line search failed to achieve a sufficient decrease, no more progress can be made");
   EXPECT_TRUE(bfgs.get_code_string(42) == "Unknown termination code");
   EXPECT_TRUE(bfgs.get_code_string(32) == "Unknown termination code");
@@ -349,3 +351,52 @@ TEST_F(OptimizationBfgsMinimizer, minimize) {
 
   EXPECT_FLOAT_EQ(bfgs.minimize(cont_vector), 31);
 }
+
+namespace {
+// quadratic objective which cancels a token at the specified evaluation
+// and fails from then on, as a ModelAdaptor refusing to evaluate would
+struct cancelling_quadratic {
+  stan::callbacks::cancellation_token* token;
+  int cancel_at;
+  int num_evals = 0;
+
+  int operator()(const Eigen::VectorXd& x, double& f, Eigen::VectorXd& g) {
+    if (++num_evals >= cancel_at)
+      token->cancel();
+    if (token->stop_requested())
+      return 4;
+    f = 0.5 * x.squaredNorm();
+    g = x;
+    return 0;
+  }
+  int operator()(const Eigen::VectorXd& x, double& f) {
+    Eigen::VectorXd g;
+    return (*this)(x, f, g);
+  }
+};
+}  // namespace
+
+TEST(OptimizationBfgsMinimizerInterrupt, stops_on_request) {
+  typedef stan::optimization::BFGSMinimizer<
+      cancelling_quadratic, stan::optimization::BFGSUpdate_HInv<> >
+      QuadraticOptimizer;
+  Eigen::VectorXd x0 = Eigen::VectorXd::Constant(3, 2);
+
+  // a stop requested before a step
+  stan::callbacks::cancellation_token before;
+  QuadraticOptimizer bfgs_before(cancelling_quadratic{&before, 1000});
+  bfgs_before.initialize(x0);
+  bfgs_before.set_interrupt(&before);
+  before.cancel();
+  EXPECT_EQ(stan::optimization::TERM_INTERRUPT, bfgs_before.step());
+  EXPECT_EQ(0U, bfgs_before.iter_num());
+
+  // a stop requested inside the line search of the first step
+  stan::callbacks::cancellation_token during;
+  QuadraticOptimizer bfgs_during(cancelling_quadratic{&during, 2});
+  bfgs_during.initialize(x0);
+  bfgs_during.set_interrupt(&during);
+  EXPECT_EQ(stan::optimization::TERM_INTERRUPT, bfgs_during.step());
+  EXPECT_EQ(0U, bfgs_during.iter_num());
+  EXPECT_TRUE(bfgs_during.curr_x().isApprox(x0));
+}
@@ -139,6 +139,39 @@ TEST(OptimizationBfgs, rosenbrock_lbfgs_convergence) {
   EXPECT_LE(bfgs.grad_evals(), 70);
 }
 
+TEST(OptimizationBfgs, rosenbrock_bfgs_more_thuente_convergence) {
+  // -1,1 is the standard initialization for the Rosenbrock function
+  std::vector<double> cont_vector(2);
+  cont_vector[0] = -1;
+  cont_vector[1] = 1;
+  std::vector<int> disc_vector;
+
+  stan::io::empty_var_context dummy_context;
+
+  Model rb_model(dummy_context);
+  std::stringstream out;
+  Optimizer bfgs(rb_model, cont_vector, disc_vector, &out);
+  bfgs._ls_opts.method = stan::optimization::LS_MORE_THUENTE;
+  EXPECT_EQ("", out.str());
+
+  int ret = 0;
+  while (ret == 0) {
+    ret = bfgs.step();
+  }
+  bfgs.params_r(cont_vector);
+
+  // Check that the return code is normal
+  EXPECT_GE(ret, 0);
+
+  // Check the correct minimum was found
+  EXPECT_NEAR(cont_vector[0], 1.0, 1e-6);
+  EXPECT_NEAR(cont_vector[1], 1.0, 1e-6);
+
+  // Check that it didn't take too long to get there
+  EXPECT_LE(bfgs.iter_num(), 35);
+  EXPECT_LE(bfgs.grad_evals(), 70);
+}
+
 TEST(OptimizationBfgs, rosenbrock_lbfgs_termconds) {
   // -1,1 is the standard initialization for the Rosenbrock function
   std::vector<double> cont_vector(2);
@@ -224,6 +257,7 @@ TEST(OptimizationBfgs, LsOptions) {
   EXPECT_FLOAT_EQ(a.c2, 0.9);
   EXPECT_FLOAT_EQ(a.minAlpha, 1e-12);
   EXPECT_FLOAT_EQ(a.alpha0, 1e-3);
+  EXPECT_EQ(stan::optimization::LS_WOLFE, a.method);
 }
 
 TEST(OptimizationBfgs, ModelAdaptor) {
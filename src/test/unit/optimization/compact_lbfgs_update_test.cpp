@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <stan/optimization/compact_lbfgs_update.hpp>
+#include <stan/optimization/lbfgs_update.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+namespace {
+Eigen::VectorXd random_vector(boost::mt19937& rng, int n) {
+  boost::normal_distribution<double> normal;
+  Eigen::VectorXd v(n);
+  for (int i = 0; i < n; ++i)
+    v(i) = normal(rng);
+  return v;
+}
+
+// update pairs with positive curvature, yk = A sk for a fixed
+// positive definite A
+void random_update(boost::mt19937& rng, const Eigen::MatrixXd& A,
+                   Eigen::VectorXd& yk, Eigen::VectorXd& sk) {
+  sk = random_vector(rng, A.rows());
+  yk = A * sk;
+}
+}  // namespace
+
+TEST(OptimizationCompactLbfgsUpdate, lbfgs_update_secant) {
+  typedef stan::optimization::CompactLBFGSUpdate<> QNUpdateT;
+  typedef QNUpdateT::VectorT VectorT;
+
+  const unsigned int nDim = 10;
+  const unsigned int maxRank = 3;
+  VectorT yk(nDim), sk(nDim), sdir(nDim);
+
+  // Construct a set of BFGS update vectors and check that
+  // the secant equation H*yk = sk is always satisfied.
+  for (unsigned int rank = 1; rank <= maxRank; rank++) {
+    QNUpdateT bfgsUp(rank);
+    for (unsigned int i = 0; i < nDim; i++) {
+      sk.setZero(nDim);
+      yk.setZero(nDim);
+      sk[i] = 1;
+      yk[i] = 1;
+
+      bfgsUp.update(yk, sk, i == 0);
+
+      // Because the constructed update vectors are all orthogonal the secant
+      // equation should be exactly satisfied for all nDim updates.
+      for (unsigned int j = 0; j <= std::min(rank, i); j++) {
+        sk.setZero(nDim);
+        yk.setZero(nDim);
+        sk[i - j] = 1;
+        yk[i - j] = 1;
+
+        bfgsUp.search_direction(sdir, yk);
+
+        EXPECT_NEAR((sdir + sk).norm(), 0.0, 1e-10);
+      }
+    }
+  }
+}
+
+TEST(OptimizationCompactLbfgsUpdate, matches_two_loop_recursion) {
+  const int nDim = 20;
+  boost::mt19937 rng(1234);
+  Eigen::MatrixXd B(nDim, nDim);
+  for (int j = 0; j < nDim; ++j)
+    B.col(j) = random_vector(rng, nDim);
+  Eigen::MatrixXd A = B * B.transpose()
+                      + nDim * Eigen::MatrixXd::Identity(nDim, nDim);
+
+  for (size_t rank = 1; rank <= 6; ++rank) {
+    stan::optimization::LBFGSUpdate<> two_loop(rank);
+    stan::optimization::CompactLBFGSUpdate<> compact(rank);
+    Eigen::VectorXd yk, sk, expected(nDim), pk(nDim);
+    // enough updates for the history to wrap around several times
+    for (int i = 0; i < 15; ++i) {
+      random_update(rng, A, yk, sk);
+      bool reset = i == 0 || i == 9;
+      EXPECT_FLOAT_EQ(two_loop.update(yk, sk, reset),
+                      compact.update(yk, sk, reset));
+
+      Eigen::VectorXd gk = random_vector(rng, nDim);
+      two_loop.search_direction(expected, gk);
+      compact.search_direction(pk, gk);
+      EXPECT_NEAR(0, (expected - pk).norm(), 1e-10 * expected.norm())
+          << "rank " << rank << ", update " << i;
+    }
+  }
+}
+
+TEST(OptimizationCompactLbfgsUpdate, set_history_size) {
+  const int nDim = 8;
+  boost::mt19937 rng(4321);
+  Eigen::MatrixXd A = Eigen::VectorXd::LinSpaced(nDim, 1, 8).asDiagonal();
+
+  stan::optimization::CompactLBFGSUpdate<> compact(5);
+  EXPECT_EQ(5U, compact.history_size());
+  std::vector<Eigen::VectorXd> ys, ss;
+  Eigen::VectorXd yk, sk;
+  for (int i = 0; i < 7; ++i) {
+    random_update(rng, A, yk, sk);
+    compact.update(yk, sk, i == 0);
+    ys.push_back(yk);
+    ss.push_back(sk);
+  }
+
+  // shrinking keeps the most recent updates, as a circular buffer does
+  compact.set_history_size(2);
+  EXPECT_EQ(2U, compact.history_size());
+  stan::optimization::LBFGSUpdate<> two_loop(2);
+  for (int i = 5; i < 7; ++i)
+    two_loop.update(ys[i], ss[i], i == 5);
+
+  Eigen::VectorXd gk = random_vector(rng, nDim);
+  Eigen::VectorXd expected(nDim), pk(nDim);
+  two_loop.search_direction(expected, gk);
+  compact.search_direction(pk, gk);
+  EXPECT_NEAR(0, (expected - pk).norm(), 1e-10 * expected.norm());
+
+  // growing keeps every update and makes room for more
+  compact.set_history_size(4);
+  two_loop.set_history_size(4);
+  for (int i = 0; i < 3; ++i) {
+    random_update(rng, A, yk, sk);
+    compact.update(yk, sk);
+    two_loop.update(yk, sk);
+    two_loop.search_direction(expected, gk);
+    compact.search_direction(pk, gk);
+    EXPECT_NEAR(0, (expected - pk).norm(), 1e-10 * expected.norm());
+  }
+}
+
+TEST(OptimizationCompactLbfgsUpdate, history) {
+  const int nDim = 6;
+  boost::mt19937 rng(11);
+  Eigen::MatrixXd A = Eigen::MatrixXd::Identity(nDim, nDim);
+  A(0, 1) = A(1, 0) = 0.5;
+  Eigen::VectorXd yk, sk;
+
+  stan::optimization::CompactLBFGSUpdate<> compact(3);
+  stan::optimization::LBFGSUpdate<> two_loop(3);
+  for (int i = 0; i < 5; ++i) {
+    random_update(rng, A, yk, sk);
+    compact.update(yk, sk, i == 0);
+    two_loop.update(yk, sk, i == 0);
+  }
+
+  // the ring matrices are unrolled to the order of the circular buffer
+  Eigen::MatrixXd S, Y, expected_S, expected_Y;
+  compact.history(S, Y);
+  two_loop.history(expected_S, expected_Y);
+  ASSERT_EQ(3, S.cols());
+  EXPECT_EQ(expected_S, S);
+  EXPECT_EQ(expected_Y, Y);
+  EXPECT_EQ(two_loop.gamma(), compact.gamma());
+}
@@ -0,0 +1,81 @@
+#include <stan/optimization/lanczos.hpp>
+#include <boost/random/mixmax.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+Eigen::MatrixXd test_matrix(int n) {
+  Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 2 + i;
+    if (i > 0)
+      a(i, i - 1) = a(i - 1, i) = 0.5;
+  }
+  return a;
+}
+}  // namespace
+
+TEST(Optimization, lanczos_eigen_full_rank) {
+  Eigen::MatrixXd a = test_matrix(6);
+  boost::random::mixmax rng(0, 1, 1234, 1);
+  Eigen::VectorXd values;
+  Eigen::MatrixXd vectors;
+  stan::optimization::lanczos_eigen(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = a * v; }, 6,
+      6, rng, values, vectors);
+  Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(a);
+  ASSERT_EQ(6, values.size());
+  ASSERT_EQ(6, vectors.rows());
+  ASSERT_EQ(6, vectors.cols());
+  for (int i = 0; i < 6; ++i)
+    EXPECT_NEAR(solver.eigenvalues()(i), values(i), 1e-10);
+  Eigen::MatrixXd rebuilt = vectors * values.asDiagonal() * vectors.transpose();
+  EXPECT_TRUE(rebuilt.isApprox(a, 1e-10));
+}
+
+TEST(Optimization, lanczos_eigen_low_rank) {
+  // a few large eigenvalues over a flat spectrum, as for the negative
+  // Hessian of a posterior with a few stiff directions
+  const int n = 200;
+  Eigen::VectorXd spectrum = Eigen::VectorXd::Ones(n);
+  for (int i = 0; i < 10; ++i)
+    spectrum(n - 1 - i) = 1000.0 / (i + 1);
+  Eigen::MatrixXd q
+      = Eigen::HouseholderQR<Eigen::MatrixXd>(Eigen::MatrixXd::Random(n, n))
+            .householderQ();
+  Eigen::MatrixXd a = q * spectrum.asDiagonal() * q.transpose();
+
+  boost::random::mixmax rng(0, 1, 1234, 1);
+  Eigen::VectorXd values;
+  Eigen::MatrixXd vectors;
+  stan::optimization::lanczos_eigen(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = a * v; }, n,
+      20, rng, values, vectors);
+  ASSERT_EQ(20, values.size());
+  ASSERT_EQ(n, vectors.rows());
+  ASSERT_EQ(20, vectors.cols());
+  EXPECT_TRUE((vectors.transpose() * vectors)
+                  .isApprox(Eigen::MatrixXd::Identity(20, 20), 1e-10));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_NEAR(spectrum(n - 1 - i), values(19 - i), 1e-8);
+    EXPECT_NEAR(
+        0, (a * vectors.col(19 - i) - values(19 - i) * vectors.col(19 - i))
+               .norm(),
+        1e-6);
+  }
+  EXPECT_NEAR(1, values(0), 1e-8);
+}
+
+TEST(Optimization, lanczos_eigen_invariant_subspace) {
+  // the identity makes every Krylov subspace invariant after one step
+  boost::random::mixmax rng(0, 1, 1234, 1);
+  Eigen::VectorXd values;
+  Eigen::MatrixXd vectors;
+  stan::optimization::lanczos_eigen(
+      [](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = 3 * v; }, 5, 3,
+      rng, values, vectors);
+  ASSERT_EQ(3, values.size());
+  for (int i = 0; i < 3; ++i)
+    EXPECT_NEAR(3, values(i), 1e-12);
+  EXPECT_TRUE((vectors.transpose() * vectors)
+                  .isApprox(Eigen::MatrixXd::Identity(3, 3), 1e-10));
+}
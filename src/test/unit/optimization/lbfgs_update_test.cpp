@@ -119,3 +119,36 @@ TEST(OptimizationLbfgsUpdate, search_direction) {
     }
   }
 }
+
+TEST(OptimizationLbfgsUpdate, history) {
+  typedef stan::optimization::LBFGSUpdate<> QNUpdateT;
+  typedef QNUpdateT::VectorT VectorT;
+
+  const unsigned int nDim = 4;
+  QNUpdateT bfgsUp(2);
+  Eigen::MatrixXd S, Y;
+  bfgsUp.history(S, Y);
+  EXPECT_EQ(0, S.cols());
+  EXPECT_EQ(0, Y.cols());
+
+  VectorT yk(nDim), sk(nDim);
+  for (unsigned int i = 0; i < 3; i++) {
+    sk.setConstant(i + 1);
+    yk = 2 * sk;
+    yk[0] = i + 1;
+    bfgsUp.update(yk, sk, i == 0);
+  }
+
+  // only the two latest updates are kept, oldest first
+  bfgsUp.history(S, Y);
+  ASSERT_EQ(nDim, S.rows());
+  ASSERT_EQ(2, S.cols());
+  ASSERT_EQ(nDim, Y.rows());
+  ASSERT_EQ(2, Y.cols());
+  for (unsigned int i = 0; i < 2; i++) {
+    EXPECT_EQ(i + 2, S(1, i));
+    EXPECT_EQ(i + 2, Y(0, i));
+    EXPECT_EQ(2 * (i + 2), Y(1, i));
+  }
+  EXPECT_FLOAT_EQ(yk.dot(sk) / yk.squaredNorm(), bfgsUp.gamma());
+}
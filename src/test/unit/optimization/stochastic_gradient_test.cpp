@@ -0,0 +1,108 @@
+#include <stan/optimization/stochastic_gradient.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <stdexcept>
+
+using stan::optimization::learning_rate_schedule;
+using stan::optimization::stochastic_gradient;
+using stan::optimization::stochastic_gradient_options;
+using stan::optimization::stochastic_method;
+
+namespace {
+// gradient of (x - c)' diag(s) (x - c) / 2 plus noise of the specified
+// standard deviation
+Eigen::VectorXd noisy_gradient(const Eigen::VectorXd& x, double noise,
+                               boost::mt19937& rng) {
+  Eigen::VectorXd c(3);
+  c << 1, -2, 3;
+  Eigen::VectorXd s(3);
+  s << 1, 10, 100;
+  boost::random::normal_distribution<double> normal(0, noise);
+  Eigen::VectorXd g = s.cwiseProduct(x - c);
+  for (Eigen::Index i = 0; i < g.size(); ++i)
+    g(i) += normal(rng);
+  return g;
+}
+
+Eigen::VectorXd minimum() {
+  Eigen::VectorXd c(3);
+  c << 1, -2, 3;
+  return c;
+}
+}  // namespace
+
+TEST(OptimizationStochasticGradient, adam_converges) {
+  boost::mt19937 rng(1);
+  stochastic_gradient_options options;
+  options.learning_rate = 0.1;
+  stochastic_gradient sgd(Eigen::VectorXd::Zero(3), options);
+  for (int t = 0; t < 2000; ++t)
+    sgd.step(noisy_gradient(sgd.x(), 0, rng));
+  EXPECT_EQ(2000, sgd.iter_num());
+  EXPECT_LT((sgd.x() - minimum()).norm(), 1e-3);
+  // without averaging the average is the last iterate
+  EXPECT_EQ(0, sgd.num_averaged());
+  EXPECT_EQ(sgd.x(), sgd.average());
+}
+
+TEST(OptimizationStochasticGradient, adagrad_converges) {
+  boost::mt19937 rng(1);
+  stochastic_gradient_options options;
+  options.method = stochastic_method::adagrad;
+  options.learning_rate = 1;
+  stochastic_gradient sgd(Eigen::VectorXd::Zero(3), options);
+  for (int t = 0; t < 2000; ++t)
+    sgd.step(noisy_gradient(sgd.x(), 0, rng));
+  EXPECT_LT((sgd.x() - minimum()).norm(), 1e-3);
+}
+
+TEST(OptimizationStochasticGradient, averaging_reduces_noise) {
+  boost::mt19937 rng(2);
+  stochastic_gradient_options options;
+  options.learning_rate = 0.05;
+  options.averaging_start = 1000;
+  stochastic_gradient sgd(Eigen::VectorXd::Zero(3), options);
+  for (int t = 0; t < 5000; ++t)
+    sgd.step(noisy_gradient(sgd.x(), 5, rng));
+  EXPECT_EQ(4000, sgd.num_averaged());
+  EXPECT_LT((sgd.average() - minimum()).norm(),
+            (sgd.x() - minimum()).norm());
+  EXPECT_LT((sgd.average() - minimum()).norm(), 0.05);
+}
+
+TEST(OptimizationStochasticGradient, schedules) {
+  stochastic_gradient_options options;
+  options.learning_rate = 0.5;
+  EXPECT_FLOAT_EQ(
+      0.5, stochastic_gradient(Eigen::VectorXd::Zero(1), options)
+               .learning_rate(100));
+  options.schedule = learning_rate_schedule::inverse_sqrt;
+  EXPECT_FLOAT_EQ(
+      0.05, stochastic_gradient(Eigen::VectorXd::Zero(1), options)
+                .learning_rate(100));
+  options.schedule = learning_rate_schedule::cosine;
+  options.schedule_length = 100;
+  stochastic_gradient cosine(Eigen::VectorXd::Zero(1), options);
+  EXPECT_FLOAT_EQ(0.25, cosine.learning_rate(50));
+  EXPECT_NEAR(0, cosine.learning_rate(100), 1e-12);
+  EXPECT_NEAR(0, cosine.learning_rate(200), 1e-12);
+}
+
+TEST(OptimizationStochasticGradient, throws_on_bad_options) {
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stochastic_gradient_options options;
+  options.learning_rate = 0;
+  EXPECT_THROW(stochastic_gradient(x, options), std::invalid_argument);
+  options = stochastic_gradient_options();
+  options.beta1 = 1;
+  EXPECT_THROW(stochastic_gradient(x, options), std::invalid_argument);
+  options = stochastic_gradient_options();
+  options.epsilon = -1;
+  EXPECT_THROW(stochastic_gradient(x, options), std::invalid_argument);
+  options = stochastic_gradient_options();
+  options.schedule = learning_rate_schedule::cosine;
+  options.schedule_length = 0;
+  EXPECT_THROW(stochastic_gradient(x, options), std::invalid_argument);
+}
@@ -0,0 +1,76 @@
+#include <stan/optimization/trust_region_newton.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+Eigen::MatrixXd test_matrix(int n) {
+  Eigen::MatrixXd a = Eigen::MatrixXd::Zero(n, n);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 2 + i;
+    if (i > 0)
+      a(i, i - 1) = a(i - 1, i) = 0.5;
+  }
+  return a;
+}
+
+double quadratic(const Eigen::MatrixXd& a, const Eigen::VectorXd& g,
+                 const Eigen::VectorXd& p) {
+  return g.dot(p) + 0.5 * p.dot(a * p);
+}
+}  // namespace
+
+TEST(Optimization, steihaug_cg_interior) {
+  Eigen::MatrixXd a = test_matrix(5);
+  Eigen::VectorXd g = Eigen::VectorXd::LinSpaced(5, 1, 5);
+  Eigen::VectorXd p;
+  double value = stan::optimization::steihaug_cg(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = a * v; }, g,
+      100, 1e-12, 5, p);
+  Eigen::VectorXd newton = -a.ldlt().solve(g);
+  ASSERT_EQ(5, p.size());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_NEAR(newton(i), p(i), 1e-8);
+  EXPECT_NEAR(quadratic(a, g, p), value, 1e-10);
+}
+
+TEST(Optimization, steihaug_cg_boundary) {
+  Eigen::MatrixXd a = test_matrix(5);
+  Eigen::VectorXd g = Eigen::VectorXd::LinSpaced(5, 1, 5);
+  Eigen::VectorXd p;
+  const double radius = 0.1;
+  double value = stan::optimization::steihaug_cg(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = a * v; }, g,
+      radius, 1e-12, 5, p);
+  EXPECT_NEAR(radius, p.norm(), 1e-12);
+  EXPECT_GT(0, p.dot(g)) << "step should descend";
+  EXPECT_NEAR(quadratic(a, g, p), value, 1e-10);
+}
+
+TEST(Optimization, steihaug_cg_negative_curvature) {
+  Eigen::MatrixXd a = test_matrix(4);
+  a(0, 0) = -3;
+  Eigen::VectorXd g = Eigen::VectorXd::Ones(4);
+  Eigen::VectorXd p;
+  const double radius = 2;
+  double value = stan::optimization::steihaug_cg(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) { av = a * v; }, g,
+      radius, 1e-12, 4, p);
+  EXPECT_NEAR(radius, p.norm(), 1e-12);
+  EXPECT_GT(0, value);
+  EXPECT_NEAR(quadratic(a, g, p), value, 1e-10);
+}
+
+TEST(Optimization, steihaug_cg_zero_gradient) {
+  Eigen::MatrixXd a = test_matrix(3);
+  Eigen::VectorXd g = Eigen::VectorXd::Zero(3);
+  Eigen::VectorXd p;
+  int calls = 0;
+  double value = stan::optimization::steihaug_cg(
+      [&](const Eigen::VectorXd& v, Eigen::VectorXd& av) {
+        ++calls;
+        av = a * v;
+      },
+      g, 1, 1e-8, 3, p);
+  EXPECT_EQ(0, calls);
+  EXPECT_EQ(0, value);
+  EXPECT_EQ(0, p.norm());
+}
@@ -0,0 +1,57 @@
+#include <stan/services/diagnose/calibrate_threads.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/services/test_lp.hpp>
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+
+class ServicesCalibrateThreads : public testing::Test {
+ public:
+  ServicesCalibrateThreads()
+      : init(init_ss), parameter(parameter_ss), model(context, 0, &model_ss) {}
+
+  std::stringstream init_ss, parameter_ss, model_ss;
+  stan::test::unit::instrumented_logger logger;
+  stan::callbacks::stream_writer init, parameter;
+  stan::io::empty_var_context context;
+  stan::callbacks::interrupt interrupt;
+  stan_model model;
+};
+
+TEST_F(ServicesCalibrateThreads, times_layouts) {
+  stan::services::diagnose::thread_calibration calibration;
+  int return_code = stan::services::diagnose::calibrate_threads(
+      model, context, 0, 1, 0, 2, 4, 0.01, interrupt, logger, init,
+      parameter, &calibration);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+  EXPECT_EQ(1, logger.find_info("THREAD CALIBRATION MODE"));
+  EXPECT_EQ(1, logger.find_info("Recommended layout"));
+
+  // 1 and 2 chains with 1 and 2 threads, and 1 chain with 4 threads
+  ASSERT_EQ(5, calibration.layouts.size());
+  for (const auto& layout : calibration.layouts) {
+    EXPECT_LE(layout.num_chains * layout.threads_per_chain, 4);
+    EXPECT_GT(layout.gradients_per_second, 0);
+    EXPECT_GT(layout.chain_gradients_per_second, 0);
+    EXPECT_GT(layout.slowdown, 0);
+  }
+  EXPECT_FLOAT_EQ(1, calibration.layouts[0].slowdown);
+  EXPECT_GE(calibration.recommended.num_chains, 1);
+  EXPECT_LE(calibration.recommended.num_chains
+                * calibration.recommended.threads_per_chain,
+            4);
+  EXPECT_NE(std::string::npos,
+            parameter_ss.str().find("num_chains,threads_per_chain"));
+}
+
+TEST_F(ServicesCalibrateThreads, invalid_arguments) {
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::diagnose::calibrate_threads(
+                model, context, 0, 1, 0, 0, 4, 0.01, interrupt, logger,
+                init, parameter));
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::diagnose::calibrate_threads(
+                model, context, 0, 1, 0, 2, 4, 0, interrupt, logger, init,
+                parameter));
+}
@@ -37,3 +37,41 @@ TEST_F(ServicesDiagnose, diagnose) {
   EXPECT_TRUE(parameter_ss.str().find("Log probability=3.218")
               != std::string::npos);
 }
+
+TEST_F(ServicesDiagnose, diagnose_directions) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+
+  int num_failed = stan::services::diagnose::diagnose(
+      model, context, seed, chain, init_radius, 1e-6, 1e-6, 3, 2, interrupt,
+      logger, init, parameter);
+  EXPECT_EQ(0, num_failed);
+  EXPECT_EQ("", model_ss.str());
+
+  EXPECT_EQ(1, logger.find_info("TEST GRADIENT MODE"));
+  EXPECT_EQ(1, logger.find_info("Log probability=3.218"));
+  EXPECT_EQ(1, logger.find_info("Largest errors"));
+  EXPECT_EQ(2, logger.find_info("direction"));
+
+  EXPECT_EQ("0,0\n", init_ss.str());
+}
+
+TEST_F(ServicesDiagnose, diagnose_forward_diff) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+
+  int num_failed = stan::services::diagnose::diagnose(
+      model, context, seed, chain, init_radius,
+      stan::services::diagnose::test_method::forward_diff, 1e-6, 1e-8, 3, 1,
+      interrupt, logger, init, parameter);
+  EXPECT_EQ(0, num_failed);
+  EXPECT_EQ("", model_ss.str());
+
+  EXPECT_EQ(1, logger.find_info("TEST GRADIENT MODE"));
+  EXPECT_EQ(1, logger.find_info("Log probability=3.218"));
+  EXPECT_EQ(2, logger.find_info("forward diff"));
+
+  EXPECT_EQ("0,0\n", init_ss.str());
+}
@@ -108,3 +108,31 @@ TEST(experimental_advi_defaults, output_draws) {
 
   EXPECT_EQ(1000, output_draws::default_value());
 }
+
+TEST(experimental_advi_defaults, rank) {
+  using stan::services::experimental::advi::rank;
+  EXPECT_EQ(
+      "Rank of the low rank part of the covariance of the"
+      " low rank approximation.",
+      rank::description());
+
+  EXPECT_NO_THROW(rank::validate(rank::default_value()));
+  EXPECT_NO_THROW(rank::validate(1));
+  EXPECT_THROW(rank::validate(0), std::invalid_argument);
+
+  EXPECT_EQ(5, rank::default_value());
+}
+
+TEST(experimental_advi_defaults, bandwidth) {
+  using stan::services::experimental::advi::bandwidth;
+  EXPECT_EQ(
+      "Number of subdiagonals of the Cholesky factor of the"
+      " precision of the banded approximation.",
+      bandwidth::description());
+
+  EXPECT_NO_THROW(bandwidth::validate(bandwidth::default_value()));
+  EXPECT_NO_THROW(bandwidth::validate(3));
+  EXPECT_THROW(bandwidth::validate(0), std::invalid_argument);
+
+  EXPECT_EQ(1, bandwidth::default_value());
+}
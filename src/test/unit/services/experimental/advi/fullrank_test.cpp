@@ -95,3 +95,33 @@ TEST_F(ServicesExperimentalAdvi, fullrank) {
 
   EXPECT_EQ(0, interrupt.call_count());
 }
+
+TEST_F(ServicesExperimentalAdvi, fullrank_pathfinder_init) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int grad_samples = 1;
+  int elbo_samples = 100;
+  int max_iterations = 10000;
+  double tol_rel_obj = 0.01;
+  double eta = 1.0;
+  bool adapt_engaged = true;
+  int adapt_iterations = 50;
+  int eval_elbo = 100;
+  int output_samples = 1000;
+  stan::services::experimental::advi::pathfinder_init pathfinder;
+
+  int return_code = stan::services::experimental::advi ::fullrank(
+      model, context, seed, chain, init_radius, grad_samples, elbo_samples,
+      max_iterations, tol_rel_obj, eta, adapt_engaged, adapt_iterations,
+      eval_elbo, output_samples, interrupt, logger, init, parameter,
+      diagnostic, &pathfinder);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(1, logger.find_info("ADVI initialized from pathfinder"));
+
+  ASSERT_EQ(1, init.vector_double_values().size());
+  ASSERT_EQ(2, init.vector_double_values().at(0).size());
+  ASSERT_EQ(1, parameter.vector_string_values().size());
+  ASSERT_EQ(output_samples + 1, parameter.vector_double_values().size());
+  EXPECT_GT(interrupt.call_count(), 0);
+}
@@ -0,0 +1,74 @@
+#include <stan/services/experimental/advi/pathfinder_init.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+using stan::services::pathfinder::internal::taylor_approx_t;
+
+// Covariance of the draws of an approximation, A A^T with A the
+// transform of standard normals
+Eigen::MatrixXd covariance(const taylor_approx_t& approx) {
+  const Eigen::Index n = approx.x_center.size();
+  Eigen::MatrixXd A = stan::services::pathfinder::internal::approximate_samples(
+      Eigen::MatrixXd::Identity(n, n), approx);
+  A.colwise() -= approx.x_center;
+  return A * A.transpose();
+}
+
+taylor_approx_t dense_approx() {
+  const int n = 4;
+  taylor_approx_t approx;
+  approx.x_center = Eigen::VectorXd::LinSpaced(n, -1, 2);
+  approx.L_approx
+      = Eigen::MatrixXd::Random(n, n).triangularView<Eigen::Upper>();
+  approx.L_approx.diagonal() = Eigen::VectorXd::LinSpaced(n, 0.5, 2);
+  approx.alpha = Eigen::VectorXd::Ones(n);
+  approx.use_full = true;
+  return approx;
+}
+
+taylor_approx_t sparse_approx() {
+  const int n = 6;
+  const int m = 2;
+  taylor_approx_t approx;
+  approx.x_center = Eigen::VectorXd::LinSpaced(n, 3, -2);
+  Eigen::HouseholderQR<Eigen::MatrixXd> qr(Eigen::MatrixXd::Random(n, m));
+  approx.Qk = qr.householderQ() * Eigen::MatrixXd::Identity(n, m);
+  approx.L_approx
+      = Eigen::MatrixXd::Random(m, m).triangularView<Eigen::Upper>();
+  approx.L_approx.diagonal() << 1.5, 0.7;
+  approx.alpha = Eigen::VectorXd::LinSpaced(n, 0.2, 3);
+  approx.use_full = false;
+  return approx;
+}
+
+}  // namespace
+
+TEST(ServicesExperimentalAdviPathfinderInit, meanfield_dense) {
+  taylor_approx_t approx = dense_approx();
+  stan::variational::normal_meanfield q
+      = stan::services::experimental::advi::internal::to_meanfield(approx);
+  EXPECT_TRUE(q.mu().isApprox(approx.x_center));
+  Eigen::VectorXd variance = (2 * q.omega().array()).exp();
+  EXPECT_TRUE(variance.isApprox(covariance(approx).diagonal()));
+}
+
+TEST(ServicesExperimentalAdviPathfinderInit, meanfield_sparse) {
+  taylor_approx_t approx = sparse_approx();
+  stan::variational::normal_meanfield q
+      = stan::services::experimental::advi::internal::to_meanfield(approx);
+  EXPECT_TRUE(q.mu().isApprox(approx.x_center));
+  Eigen::VectorXd variance = (2 * q.omega().array()).exp();
+  EXPECT_TRUE(variance.isApprox(covariance(approx).diagonal()));
+}
+
+TEST(ServicesExperimentalAdviPathfinderInit, fullrank) {
+  for (const taylor_approx_t& approx : {dense_approx(), sparse_approx()}) {
+    stan::variational::normal_fullrank q
+        = stan::services::experimental::advi::internal::to_fullrank(approx);
+    EXPECT_TRUE(q.mu().isApprox(approx.x_center));
+    EXPECT_TRUE(q.L_chol().isLowerTriangular());
+    EXPECT_TRUE((q.L_chol() * q.L_chol().transpose())
+                    .isApprox(covariance(approx)));
+  }
+}
@@ -0,0 +1,28 @@
+#define STAN_INSTANTIATE_SAMPLERS
+#define STAN_INSTANTIATE_SERVICES
+#include <stan/services/instantiations.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+TEST(ServicesInstantiations, model_base) {
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model(context, 0, &model_log);
+  stan::model::model_base& base_model = model;
+
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, parameter, diagnostic;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      base_model, context, 0, 1, 0, 100, 100, 1, false, 0, 0.1, 0, 8, 0.8,
+      0.05, 0.75, 10, 15, 50, 25, interrupt, logger, init, parameter,
+      diagnostic);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(200, interrupt.call_count());
+  EXPECT_EQ(100, parameter.call_count("vector_double"));
+}
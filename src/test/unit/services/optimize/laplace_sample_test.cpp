@@ -10,6 +10,7 @@
 #include <test/test-models/good/services/multi_normal.hpp>
 #include <test/unit/services/instrumented_callbacks.hpp>
 #include <test/unit/util.hpp>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -200,8 +201,337 @@ TEST_F(ServicesLaplaceSample, consoleOutput) {
   std::string console_str = logger_ss.str();
   EXPECT_EQ(1,
             count_matches(
-                "Calculating Hessian\nCalculating inverse of Cholesky factor\n",
+                "Calculating Hessian\nCalculating Cholesky factor\n",
                 console_str));
   EXPECT_EQ(1, count_matches("Generating draws\niteration: 0\niteration: 1",
                              console_str));
 }
+
+TEST_F(ServicesLaplaceSample, lowRankValues) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  int draws = 50000;
+  unsigned int seed = 1234;
+  int refresh = 0;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  // with the full rank the approximation is the dense one
+  int return_code = stan::services::laplace_sample_low_rank<true>(
+      *model, theta_hat, draws, 2, true, seed, refresh, interrupt, logger,
+      sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  EXPECT_EQ(4, draws_csv.header.size());
+  EXPECT_EQ("log_p__", draws_csv.header[0]);
+  EXPECT_EQ("log_q__", draws_csv.header[1]);
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  Eigen::VectorXd log_p = sample.col(0);
+  Eigen::VectorXd log_q = sample.col(1);
+  Eigen::VectorXd y1 = sample.col(2);
+  Eigen::VectorXd y2 = sample.col(3);
+  // the unnormalized densities differ by a constant
+  for (int m = 1; m < draws; ++m)
+    EXPECT_NEAR(log_p(0) - log_q(0), log_p(m) - log_q(m), 1e-4);
+  EXPECT_NEAR(2, stan::math::mean(y1), 0.05);
+  EXPECT_NEAR(3, stan::math::mean(y2), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y1), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y2), 0.05);
+  double sum12 = 0;
+  for (int m = 0; m < draws; ++m)
+    sum12 += (y1(m) - 2) * (y2(m) - 3);
+  EXPECT_NEAR(0.8, sum12 / draws, 0.05);
+}
+
+TEST_F(ServicesLaplaceSample, lowRankHessianOutput) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  std::stringstream hessian_ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> hessian_writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&hessian_ss)};
+  int return_code = stan::services::laplace_sample_low_rank<true>(
+      *model, theta_hat, 10, 1, true, 1234, 100, interrupt, logger,
+      sample_writer, hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+  std::string hessian_str = hessian_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(hessian_str));
+  EXPECT_EQ(count_matches("lp_mode", hessian_str), 1);
+  EXPECT_EQ(count_matches("gradient", hessian_str), 1);
+  EXPECT_EQ(count_matches("neg_hessian_eigenvalues", hessian_str), 1);
+  EXPECT_EQ(count_matches("neg_hessian_eigenvectors", hessian_str), 1);
+  EXPECT_EQ(count_matches("Hessian\"", hessian_str), 0);
+  EXPECT_EQ(11, count_matches("\n", sample_ss.str()));
+}
+
+TEST_F(ServicesLaplaceSample, lowRankNonPositiveRankError) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int RC = stan::services::laplace_sample_low_rank<true>(
+      *model, theta_hat, 10, 0, true, 1234, 1, interrupt, logger,
+      sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, RC);
+}
+
+TEST_F(ServicesLaplaceSample, sparseValues) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  int draws = 50000;
+  unsigned int seed = 1234;
+  int refresh = 0;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int return_code = stan::services::laplace_sample_sparse<true>(
+      *model, theta_hat, draws, nullptr, true, seed, refresh, interrupt,
+      logger, sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  EXPECT_EQ(4, draws_csv.header.size());
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  Eigen::VectorXd log_p = sample.col(0);
+  Eigen::VectorXd log_q = sample.col(1);
+  Eigen::VectorXd y1 = sample.col(2);
+  Eigen::VectorXd y2 = sample.col(3);
+  for (int m = 1; m < draws; ++m)
+    EXPECT_NEAR(log_p(0) - log_q(0), log_p(m) - log_q(m), 1e-4);
+  EXPECT_NEAR(2, stan::math::mean(y1), 0.05);
+  EXPECT_NEAR(3, stan::math::mean(y2), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y1), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y2), 0.05);
+  double sum12 = 0;
+  for (int m = 0; m < draws; ++m)
+    sum12 += (y1(m) - 2) * (y2(m) - 3);
+  EXPECT_NEAR(0.8, sum12 / draws, 0.05);
+}
+
+TEST_F(ServicesLaplaceSample, sparseHessianOutput) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  std::stringstream hessian_ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> hessian_writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&hessian_ss)};
+  stan::model::hessian_sparsity sparsity
+      = stan::model::color_hessian_sparsity({{0, 1}, {0, 1}});
+  int return_code = stan::services::laplace_sample_sparse<true>(
+      *model, theta_hat, 10, &sparsity, true, 1234, 100, interrupt, logger,
+      sample_writer, hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+  std::string hessian_str = hessian_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(hessian_str));
+  EXPECT_EQ(count_matches("lp_mode", hessian_str), 1);
+  EXPECT_EQ(count_matches("gradient", hessian_str), 1);
+  EXPECT_EQ(count_matches("Hessian_nonzeros", hessian_str), 1);
+  EXPECT_EQ(11, count_matches("\n", sample_ss.str()));
+
+  // a pattern of the wrong size
+  stan::model::hessian_sparsity wrong_size
+      = stan::model::color_hessian_sparsity({{0}});
+  return_code = stan::services::laplace_sample_sparse<true>(
+      *model, theta_hat, 10, &wrong_size, true, 1234, 100, interrupt, logger,
+      sample_writer, hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+}
+
+namespace {
+// L-BFGS updates for the negative log density of multi_normal.stan, whose
+// Hessian is the inverse of [[1, 0.8], [0.8, 1]]; the second step is
+// conjugate to the first, so the inverse Hessian approximation is exact
+void multi_normal_history(Eigen::MatrixXd& s_history,
+                          Eigen::MatrixXd& y_history) {
+  s_history.resize(2, 2);
+  y_history.resize(2, 2);
+  s_history << 1, 0.8, 0, 1;
+  y_history << 25.0 / 9, 0, -20.0 / 9, 1;
+}
+}  // namespace
+
+TEST_F(ServicesLaplaceSample, lbfgsValues) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  Eigen::MatrixXd s_history, y_history;
+  multi_normal_history(s_history, y_history);
+  int draws = 50000;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int return_code = stan::services::laplace_sample_lbfgs<true>(
+      *model, theta_hat, s_history, y_history, draws, true, false, 1234, 0,
+      interrupt, logger, sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  EXPECT_EQ(4, draws_csv.header.size());
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  Eigen::VectorXd log_p = sample.col(0);
+  Eigen::VectorXd log_q = sample.col(1);
+  Eigen::VectorXd y1 = sample.col(2);
+  Eigen::VectorXd y2 = sample.col(3);
+  for (int m = 1; m < draws; ++m)
+    EXPECT_NEAR(log_p(0) - log_q(0), log_p(m) - log_q(m), 1e-4);
+  EXPECT_NEAR(2, stan::math::mean(y1), 0.05);
+  EXPECT_NEAR(3, stan::math::mean(y2), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y1), 0.05);
+  EXPECT_NEAR(1, stan::math::variance(y2), 0.05);
+  double sum12 = 0;
+  for (int m = 0; m < draws; ++m)
+    sum12 += (y1(m) - 2) * (y2(m) - 3);
+  EXPECT_NEAR(0.8, sum12 / draws, 0.05);
+}
+
+TEST_F(ServicesLaplaceSample, lbfgsPsisResample) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  Eigen::MatrixXd s_history, y_history;
+  multi_normal_history(s_history, y_history);
+  // halving the changes in the gradients doubles the covariance of the
+  // approximation, which the importance weights correct
+  y_history *= 0.5;
+  int draws = 4000;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int return_code = stan::services::laplace_sample_lbfgs<true>(
+      *model, theta_hat, s_history, y_history, draws, true, true, 1234, 0,
+      interrupt, logger, sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  Eigen::VectorXd y1 = sample.col(2);
+  Eigen::VectorXd y2 = sample.col(3);
+  EXPECT_NEAR(2, stan::math::mean(y1), 0.1);
+  EXPECT_NEAR(3, stan::math::mean(y2), 0.1);
+  // resampling is with replacement
+  std::vector<double> distinct(y1.data(), y1.data() + draws);
+  std::sort(distinct.begin(), distinct.end());
+  EXPECT_LT(std::unique(distinct.begin(), distinct.end()) - distinct.begin(),
+            draws);
+  double sum12 = 0;
+  for (int m = 0; m < draws; ++m)
+    sum12 += (y1(m) - 2) * (y2(m) - 3);
+  EXPECT_NEAR(0.8, sum12 / draws, 0.15);
+}
+
+TEST_F(ServicesLaplaceSample, lbfgsHessianOutput) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  Eigen::MatrixXd s_history, y_history;
+  multi_normal_history(s_history, y_history);
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  std::stringstream hessian_ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> hessian_writer{
+      std::unique_ptr<std::stringstream, deleter_noop>(&hessian_ss)};
+  int return_code = stan::services::laplace_sample_lbfgs<true>(
+      *model, theta_hat, s_history, y_history, 10, true, false, 1234, 100,
+      interrupt, logger, sample_writer, hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+  std::string hessian_str = hessian_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(hessian_str));
+  EXPECT_EQ(count_matches("lp_mode", hessian_str), 1);
+  EXPECT_EQ(count_matches("gradient", hessian_str), 1);
+  EXPECT_EQ(count_matches("lbfgs_s_history", hessian_str), 1);
+  EXPECT_EQ(count_matches("lbfgs_y_history", hessian_str), 1);
+  EXPECT_EQ(count_matches("Hessian\"", hessian_str), 0);
+  EXPECT_EQ(11, count_matches("\n", sample_ss.str()));
+}
+
+TEST_F(ServicesLaplaceSample, lbfgsHistoryErrors) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  Eigen::MatrixXd s_history = Eigen::MatrixXd::Identity(3, 2);
+  Eigen::MatrixXd y_history = Eigen::MatrixXd::Identity(3, 2);
+  int RC = stan::services::laplace_sample_lbfgs<true>(
+      *model, theta_hat, s_history, y_history, 10, true, false, 1234, 1,
+      interrupt, logger, sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, RC);
+
+  // no update has positive curvature
+  s_history = Eigen::MatrixXd::Identity(2, 2);
+  y_history = -s_history;
+  RC = stan::services::laplace_sample_lbfgs<true>(
+      *model, theta_hat, s_history, y_history, 10, true, false, 1234, 1,
+      interrupt, logger, sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, RC);
+  EXPECT_EQ(1, count_matches("positive curvature", msgs.str()));
+}
+
+TEST_F(ServicesLaplaceSample, psisResample) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  int draws = 4000;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int return_code = stan::services::laplace_sample<true>(
+      *model, theta_hat, draws, true, true, 1234, 0, interrupt, logger,
+      sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  EXPECT_EQ("log_p__", draws_csv.header[0]);
+  EXPECT_EQ("log_q__", draws_csv.header[1]);
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  Eigen::VectorXd y1 = sample.col(2);
+  Eigen::VectorXd y2 = sample.col(3);
+  // the approximation is exact, so the weights are all the same
+  EXPECT_NEAR(2, stan::math::mean(y1), 0.1);
+  EXPECT_NEAR(3, stan::math::mean(y2), 0.1);
+  // resampling is with replacement
+  std::vector<double> distinct(y1.data(), y1.data() + draws);
+  std::sort(distinct.begin(), distinct.end());
+  EXPECT_LT(std::unique(distinct.begin(), distinct.end()) - distinct.begin(),
+            draws);
+}
+
+TEST_F(ServicesLaplaceSample, psisResampleNeedsLogDensity) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  int draws = 100;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer dummy_hessian_writer;
+  int return_code = stan::services::laplace_sample<true>(
+      *model, theta_hat, draws, false, true, 1234, 0, interrupt, logger,
+      sample_writer, dummy_hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  // without the log densities the draws are written as they are
+  std::vector<double> distinct(sample.col(2).data(),
+                               sample.col(2).data() + draws);
+  std::sort(distinct.begin(), distinct.end());
+  EXPECT_EQ(draws,
+            std::unique(distinct.begin(), distinct.end()) - distinct.begin());
+}
@@ -0,0 +1,64 @@
+#include <stan/services/optimize/lbfgs_multi.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/bimodal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <memory>
+#include <vector>
+
+struct ServicesOptimizeMulti : public testing::Test {
+  ServicesOptimizeMulti()
+      : init_writers(num_runs, stan::callbacks::stream_writer(init_ss)),
+        parameter(parameter_ss),
+        model(context, 0, &model_ss) {
+    // half of the inits on each side of the boundary between the modes
+    for (int i = 0; i < num_runs; ++i) {
+      inits.emplace_back(std::make_unique<stan::io::array_var_context>(
+          std::vector<std::string>{"x"},
+          std::vector<double>{i % 2 == 0 ? -1.5 - i : 1.5 + i},
+          std::vector<std::vector<size_t>>{std::vector<size_t>{}}));
+    }
+  }
+
+  static constexpr int num_runs = 8;
+  std::stringstream init_ss, parameter_ss, model_ss;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<std::unique_ptr<stan::io::array_var_context>> inits;
+  std::vector<stan::callbacks::stream_writer> init_writers;
+  stan::test::unit::values_writer parameter;
+  stan::io::empty_var_context context;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan_model model;
+};
+
+TEST_F(ServicesOptimizeMulti, finds_both_modes) {
+  int return_code = stan::services::optimize::lbfgs_multi(
+      model, inits, 0, 1, 2, 5, 0.001, 1e-12, 10000, 1e-8, 10000000, 1e-8,
+      2000, num_runs, 1e-3, 0, interrupt, logger, init_writers, parameter);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(0, logger.call_count_error());
+
+  ASSERT_EQ(2, parameter.names_.size());
+  EXPECT_EQ("lp__", parameter.names_[0]);
+  EXPECT_EQ("x", parameter.names_[1]);
+
+  // the modes are written from the highest log density down
+  ASSERT_EQ(2, parameter.states_.size());
+  EXPECT_NEAR(2, parameter.states_[0][1], 1e-3);
+  EXPECT_NEAR(-2, parameter.states_[1][1], 1e-3);
+  EXPECT_GT(parameter.states_[0][0], parameter.states_[1][0]);
+  EXPECT_EQ(1, logger.find_info("Mode 0: log joint probability"));
+  EXPECT_EQ(1, logger.find_info("Mode 1: log joint probability"));
+  EXPECT_EQ(num_runs, logger.find_info("terminated normally"));
+}
+
+TEST_F(ServicesOptimizeMulti, stops_when_runs_agree) {
+  int return_code = stan::services::optimize::lbfgs_multi(
+      model, inits, 0, 1, 2, 5, 0.001, 1e-12, 10000, 1e-8, 10000000, 1e-8,
+      2000, num_runs, 1e-3, 1, interrupt, logger, init_writers, parameter);
+  EXPECT_EQ(0, return_code);
+  ASSERT_LE(1, parameter.states_.size());
+  EXPECT_GE(num_runs, logger.find_info("terminated normally"));
+}
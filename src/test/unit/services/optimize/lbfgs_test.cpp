@@ -57,3 +57,28 @@ TEST_F(ServicesOptimize, rosenbrock) {
   EXPECT_FLOAT_EQ(return_code, 0);
   EXPECT_EQ(22, interrupt.call_count());
 }
+
+TEST_F(ServicesOptimize, rosenbrock_history) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  Eigen::MatrixXd s_history;
+  Eigen::MatrixXd y_history;
+  int return_code = stan::services::optimize::lbfgs(
+      model, context, 0, 1, 0, 5, 0.001, 1e-12, 10000, 1e-8, 10000000, 1e-8,
+      2000, false, 0, interrupt, logger, init, parameter, &s_history,
+      &y_history);
+  EXPECT_EQ(0, return_code);
+  ASSERT_EQ(2, s_history.rows());
+  ASSERT_EQ(5, s_history.cols());
+  ASSERT_EQ(2, y_history.rows());
+  ASSERT_EQ(5, y_history.cols());
+  // the curvature of an accepted update is positive and the last update
+  // ends at the optimum, where the Hessian of the negative log density
+  // is [[802, -400], [-400, 200]]
+  for (int i = 0; i < 5; ++i)
+    EXPECT_GT(s_history.col(i).dot(y_history.col(i)), 0);
+  Eigen::Matrix2d hessian;
+  hessian << 802, -400, -400, 200;
+  Eigen::Vector2d s = s_history.col(4);
+  Eigen::Vector2d y = y_history.col(4);
+  EXPECT_NEAR(0, (hessian * s - y).norm() / y.norm(), 0.1);
+}
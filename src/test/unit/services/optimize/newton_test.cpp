@@ -88,3 +88,25 @@ TEST_F(ServicesOptimize, rosenbrock_no_save_iterations) {
   EXPECT_FLOAT_EQ(return_code, 0);
   EXPECT_LT(0, interrupt.call_count());
 }
+
+TEST_F(ServicesOptimize, rosenbrock_sparse_hessian) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+
+  int num_iterations = 1000;
+  bool save_iterations = false;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::optimize::newton(
+      model, context, seed, chain, init_radius, num_iterations, save_iterations,
+      interrupt, logger, init, parameter, true);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(1, logger.find("Sparse Hessian from"));
+  EXPECT_EQ(1, parameter.states_.size());
+  EXPECT_NEAR(1, parameter.states_.back()[1], 1e-3)
+      << "optimal value should be (1, 1)";
+  EXPECT_NEAR(1, parameter.states_.back()[2], 1e-3)
+      << "optimal value should be (1, 1)";
+}
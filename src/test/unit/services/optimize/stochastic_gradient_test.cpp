@@ -0,0 +1,100 @@
+#include <stan/services/optimize/stochastic_gradient.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/minibatch_normal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <memory>
+#include <vector>
+
+namespace {
+// rows y = 1, ..., 100 of unit variance with a normal(0, 10) prior on
+// their mean, whose mode is 5050 / 100.01
+stan::io::array_var_context make_data() {
+  std::vector<double> y(100);
+  for (int n = 0; n < 100; ++n)
+    y[n] = n + 1;
+  return stan::io::array_var_context({"y"}, y, {{100}}, {"N_total", "N"},
+                                     {100, 100}, {{}, {}});
+}
+}  // namespace
+
+struct ServicesOptimizeStochasticGradient : public testing::Test {
+  ServicesOptimizeStochasticGradient()
+      : data(make_data()),
+        init(init_ss),
+        parameter(parameter_ss),
+        model(data, 0, &model_ss) {}
+
+  std::unique_ptr<stan_model> make_batch_model(
+      const stan::io::var_context& batch_data) {
+    ++num_batch_models;
+    return std::make_unique<stan_model>(batch_data, 0, &model_ss);
+  }
+
+  stan::io::array_var_context data;
+  std::stringstream init_ss, parameter_ss, model_ss;
+  stan::test::unit::instrumented_logger logger;
+  stan::callbacks::stream_writer init;
+  stan::test::unit::values_writer parameter;
+  stan::io::empty_var_context context;
+  stan_model model;
+  int num_batch_models = 0;
+  double mode = 5050 / 100.01;
+};
+
+TEST_F(ServicesOptimizeStochasticGradient, adam_then_polish) {
+  stan::optimization::stochastic_gradient_options options;
+  options.learning_rate = 1;
+  options.averaging_start = 150;
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::optimize::stochastic_gradient(
+      model,
+      [this](const stan::io::var_context& d) { return make_batch_model(d); },
+      data, {"y"}, {"N"}, 10, context, 0, 1, 0, options, 20, 100, 5, 10,
+      interrupt, logger, init, parameter);
+
+  EXPECT_EQ(0, return_code);
+  // one model to initialize and one per minibatch of the 20 epochs
+  EXPECT_EQ(1 + 20 * 10, num_batch_models);
+  EXPECT_EQ(20, logger.find("mean minibatch log density"));
+  EXPECT_EQ(1, logger.find("Polishing with L-BFGS"));
+  ASSERT_EQ(2U, parameter.names_.size());
+  EXPECT_EQ("mu", parameter.names_[1]);
+  ASSERT_EQ(1U, parameter.states_.size());
+  EXPECT_NEAR(mode, parameter.states_.back()[1], 1e-4);
+  EXPECT_LT(0, interrupt.call_count());
+}
+
+TEST_F(ServicesOptimizeStochasticGradient, adagrad_without_polish) {
+  stan::optimization::stochastic_gradient_options options;
+  options.method = stan::optimization::stochastic_method::adagrad;
+  options.learning_rate = 10;
+  options.averaging_start = 300;
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::optimize::stochastic_gradient(
+      model,
+      [this](const stan::io::var_context& d) { return make_batch_model(d); },
+      data, {"y"}, {"N"}, 20, context, 0, 1, 0, options, 100, 0, 5, 0,
+      interrupt, logger, init, parameter);
+
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(0, logger.find("Polishing with L-BFGS"));
+  ASSERT_EQ(1U, parameter.states_.size());
+  // the averaged minibatch iterates are near the mode
+  EXPECT_NEAR(mode, parameter.states_.back()[1], 1);
+}
+
+TEST_F(ServicesOptimizeStochasticGradient, bad_batch_size) {
+  stan::optimization::stochastic_gradient_options options;
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::optimize::stochastic_gradient(
+      model,
+      [this](const stan::io::var_context& d) { return make_batch_model(d); },
+      data, {"y"}, {"N"}, 200, context, 0, 1, 0, options, 1, 0, 5, 0,
+      interrupt, logger, init, parameter);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(1, logger.call_count_error());
+  EXPECT_EQ(0, num_batch_models);
+}
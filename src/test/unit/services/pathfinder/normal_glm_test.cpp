@@ -487,3 +487,187 @@ TEST_F(ServicesPathfinderGLM, multi_noresample_returnlp) {
     }
   }
 }
+
+TEST_F(ServicesPathfinderGLM, multi_regenerate_draws) {
+  constexpr unsigned int seed = 0;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 1;
+  constexpr double num_multi_draws = 100;
+  constexpr int num_paths = 4;
+  constexpr double num_elbo_draws = 100;
+  constexpr double num_draws = 300;
+  constexpr int history_size = 15;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 220;
+  constexpr bool save_iterations = false;
+  constexpr int refresh = 0;
+  constexpr bool calculate_lp = true;
+  constexpr bool resample = true;
+
+  std::unique_ptr<std::ostream> empty_ostream(nullptr);
+  stan::test::test_logger logger(std::move(empty_ostream));
+  std::vector<stan::callbacks::writer> single_path_parameter_writer(num_paths);
+  std::vector<stan::callbacks::json_writer<std::stringstream>>
+      single_path_diagnostic_writer(num_paths);
+  std::vector<std::unique_ptr<decltype(init_init_context())>> single_path_inits;
+  for (int i = 0; i < num_paths; ++i) {
+    single_path_inits.emplace_back(
+        std::make_unique<decltype(init_init_context())>(init_init_context()));
+  }
+  stan::test::mock_callback callback;
+  stan::test::in_memory_writer regenerated(parameter_ss);
+  for (bool regenerate_draws : {false, true}) {
+    int rc = stan::services::pathfinder::pathfinder_lbfgs_multi(
+        model, single_path_inits, seed, chain, init_radius, history_size,
+        init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+        num_iterations, num_elbo_draws, num_draws, num_multi_draws, num_paths,
+        save_iterations, refresh, callback, logger,
+        std::vector<stan::callbacks::stream_writer>(num_paths, init),
+        single_path_parameter_writer, single_path_diagnostic_writer,
+        regenerate_draws ? regenerated : parameter, diagnostics, calculate_lp,
+        resample, regenerate_draws);
+    ASSERT_EQ(rc, 0);
+  }
+
+  // The regenerated draws are the draws that were kept
+  ASSERT_EQ(num_multi_draws, parameter.eigen_states_.size());
+  ASSERT_EQ(parameter.eigen_states_.size(), regenerated.eigen_states_.size());
+  for (size_t i = 0; i < parameter.eigen_states_.size(); ++i) {
+    ASSERT_EQ(10, regenerated.eigen_states_[i].size());
+    for (Eigen::Index j = 0; j < 10; ++j) {
+      EXPECT_DOUBLE_EQ(parameter.eigen_states_[i](j),
+                       regenerated.eigen_states_[i](j))
+          << "draw " << i << ", parameter " << j;
+    }
+  }
+}
+
+TEST_F(ServicesPathfinderGLM, single_elbo_plateau) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = false;
+  constexpr int refresh = 0;
+  constexpr bool calculate_lp = true;
+
+  stan::test::mock_callback callback;
+  std::unique_ptr<std::ostream> empty_ostream(nullptr);
+  stan::test::test_logger logger(std::move(empty_ostream));
+  // log density evaluations for each ELBO schedule
+  auto run = [&](int elbo_every, int elbo_patience, double tol_rel_elbo) {
+    stan::io::array_var_context init_context = init_init_context();
+    auto ret = stan::services::pathfinder::pathfinder_lbfgs_single<true>(
+        model, init_context, seed, chain, init_radius, history_size,
+        init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+        num_iterations, num_elbo_draws, num_draws, save_iterations, refresh,
+        callback, logger, init, parameter, diagnostics, calculate_lp, nullptr,
+        elbo_every, elbo_patience, tol_rel_elbo);
+    EXPECT_EQ(0, std::get<0>(ret));
+    EXPECT_EQ(num_draws, std::get<2>(ret).cols());
+    return static_cast<std::size_t>(std::get<3>(ret));
+  };
+  const std::size_t full_evals = run(1, 0, 0.0);
+  EXPECT_LT(run(1, 3, 1e-3), full_evals);
+  EXPECT_LT(run(5, 0, 0.0), full_evals);
+  EXPECT_LT(run(5, 2, 1e-3), full_evals);
+}
+
+TEST_F(ServicesPathfinderGLM, single_elbo_schedule_config) {
+  stan::test::mock_callback callback;
+  std::unique_ptr<std::ostream> empty_ostream(nullptr);
+  stan::test::test_logger logger(std::move(empty_ostream));
+  stan::io::array_var_context init_context = init_init_context();
+  for (auto schedule : {std::make_tuple(0, 0, 0.0), std::make_tuple(1, -1, 0.0),
+                        std::make_tuple(1, 3, -1e-3)}) {
+    int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+        model, init_context, 3, 1, 2, 35, 1, 0, 0, 0, 0, 0, 400, 80, 500,
+        false, 0, callback, logger, init, parameter, diagnostics, true,
+        nullptr, std::get<0>(schedule), std::get<1>(schedule),
+        std::get<2>(schedule));
+    EXPECT_EQ(stan::services::error_codes::CONFIG, rc);
+  }
+}
+
+TEST_F(ServicesPathfinderGLM, multi_constrain_resampled_only) {
+  constexpr unsigned int seed = 0;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 1;
+  constexpr double num_multi_draws = 100;
+  constexpr int num_paths = 4;
+  constexpr double num_elbo_draws = 100;
+  constexpr double num_draws = 300;
+  constexpr int history_size = 15;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 220;
+  constexpr bool save_iterations = false;
+  constexpr int refresh = 0;
+  constexpr bool calculate_lp = true;
+  constexpr bool resample = true;
+
+  std::unique_ptr<std::ostream> empty_ostream(nullptr);
+  stan::test::test_logger logger(std::move(empty_ostream));
+  std::vector<stan::callbacks::json_writer<std::stringstream>>
+      single_path_diagnostic_writer(num_paths);
+  std::vector<std::unique_ptr<decltype(init_init_context())>> single_path_inits;
+  for (int i = 0; i < num_paths; ++i) {
+    single_path_inits.emplace_back(
+        std::make_unique<decltype(init_init_context())>(init_init_context()));
+  }
+  stan::test::mock_callback callback;
+  stan::test::in_memory_writer lazy(parameter_ss);
+  std::vector<std::stringstream> path_ss(2 * num_paths);
+  for (bool constrain_resampled_only : {false, true}) {
+    std::vector<stan::test::in_memory_writer> single_path_parameter_writer;
+    single_path_parameter_writer.reserve(num_paths);
+    for (int i = 0; i < num_paths; ++i) {
+      single_path_parameter_writer.emplace_back(
+          path_ss[constrain_resampled_only * num_paths + i]);
+    }
+    int rc = stan::services::pathfinder::pathfinder_lbfgs_multi(
+        model, single_path_inits, seed, chain, init_radius, history_size,
+        init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+        num_iterations, num_elbo_draws, num_draws, num_multi_draws, num_paths,
+        save_iterations, refresh, callback, logger,
+        std::vector<stan::callbacks::stream_writer>(num_paths, init),
+        single_path_parameter_writer, single_path_diagnostic_writer,
+        constrain_resampled_only ? lazy : parameter, diagnostics, calculate_lp,
+        resample, false, 1, 0, 0.0, constrain_resampled_only);
+    ASSERT_EQ(rc, 0);
+    // the paths only write their draws when they constrain them
+    for (auto&& path_writer : single_path_parameter_writer) {
+      EXPECT_EQ(constrain_resampled_only, path_writer.values_.size() == 0);
+    }
+  }
+
+  // The same draws are written either way
+  ASSERT_EQ(num_multi_draws, parameter.eigen_states_.size());
+  ASSERT_EQ(parameter.eigen_states_.size(), lazy.eigen_states_.size());
+  for (size_t i = 0; i < parameter.eigen_states_.size(); ++i) {
+    ASSERT_EQ(10, lazy.eigen_states_[i].size());
+    for (Eigen::Index j = 0; j < 10; ++j) {
+      EXPECT_DOUBLE_EQ(parameter.eigen_states_[i](j),
+                       lazy.eigen_states_[i](j))
+          << "draw " << i << ", parameter " << j;
+    }
+  }
+}
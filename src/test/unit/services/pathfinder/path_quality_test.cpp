@@ -0,0 +1,67 @@
+#include <stan/services/pathfinder/path_quality.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+// log ratios of the draws of a path whose approximation has the specified
+// error, the standard deviation of the log ratios
+Eigen::Array<double, Eigen::Dynamic, 1> path_lp_ratios(int num_draws,
+                                                       double error,
+                                                       unsigned int seed) {
+  boost::mt19937 rng(seed);
+  boost::random::normal_distribution<double> normal(0, error);
+  Eigen::Array<double, Eigen::Dynamic, 1> lp_ratios(num_draws);
+  for (int i = 0; i < num_draws; ++i) {
+    lp_ratios(i) = normal(rng);
+  }
+  return lp_ratios;
+}
+}  // namespace
+
+TEST(ServicesPathfinderPathQuality, met_once_enough_draws) {
+  stan::services::pathfinder::path_quality quality(0.7, 250);
+  EXPECT_FALSE(quality.met());
+  EXPECT_FALSE(quality.add(path_lp_ratios(100, 0.1, 1)));
+  EXPECT_FALSE(quality.add(path_lp_ratios(100, 0.1, 2)));
+  EXPECT_TRUE(quality.add(path_lp_ratios(100, 0.1, 3)));
+  EXPECT_TRUE(quality.met());
+  EXPECT_EQ(3U, quality.num_paths());
+  EXPECT_GT(quality.ess(), 250);
+  EXPECT_LE(quality.ess(), 300);
+  EXPECT_LT(quality.pareto_k(), 0.7);
+}
+
+TEST(ServicesPathfinderPathQuality, poor_weights_do_not_meet_target) {
+  stan::services::pathfinder::path_quality quality(0.7, 50);
+  for (unsigned int seed = 1; seed <= 4; ++seed) {
+    EXPECT_FALSE(quality.add(path_lp_ratios(100, 5, seed)));
+  }
+  EXPECT_LT(quality.ess(), 50);
+}
+
+TEST(ServicesPathfinderPathQuality, pareto_k_needs_a_tail) {
+  stan::services::pathfinder::path_quality quality(0.7, 1);
+  // too few draws to smooth the tail
+  EXPECT_FALSE(quality.add(path_lp_ratios(10, 0.1, 1)));
+  EXPECT_TRUE(std::isnan(quality.pareto_k()));
+}
+
+TEST(ServicesPathfinderPathQuality, concurrent_adds) {
+  stan::services::pathfinder::path_quality quality(0.7, 1e6);
+  std::vector<std::thread> threads;
+  for (unsigned int seed = 1; seed <= 8; ++seed) {
+    threads.emplace_back(
+        [&quality, seed]() { quality.add(path_lp_ratios(50, 0.1, seed)); });
+  }
+  for (auto&& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(8U, quality.num_paths());
+  EXPECT_FALSE(quality.met());
+  EXPECT_GT(quality.ess(), 350);
+  EXPECT_LE(quality.ess(), 400);
+}
@@ -0,0 +1,103 @@
+#include <stan/services/pathfinder/psis.hpp>
+#include <stan/services/pathfinder/psis_engine.hpp>
+#include <test/unit/services/pathfinder/util.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/student_t_distribution.hpp>
+
+// Locally tests can use threads but for jenkins we should just use 1 thread
+#ifdef LOCAL_THREADS_TEST
+auto&& threadpool_init = stan::math::init_threadpool_tbb(LOCAL_THREADS_TEST);
+#else
+auto&& threadpool_init = stan::math::init_threadpool_tbb(1);
+#endif
+
+namespace {
+// PSIS weights computed with a full ordering of the tail, as psis_weights
+// did before it used psis_engine
+Eigen::Array<double, Eigen::Dynamic, 1> reference_weights(
+    const Eigen::Array<double, Eigen::Dynamic, 1>& log_ratios,
+    Eigen::Index tail_len) {
+  Eigen::Array<double, Eigen::Dynamic, 1> llr_weights
+      = log_ratios - log_ratios.maxCoeff();
+  auto max_n = stan::services::psis::internal::largest_n_elements(
+      llr_weights, tail_len + 1);
+  auto smoothed = stan::services::psis::internal::psis_smooth_tail(
+      max_n.first.tail(tail_len), max_n.first(0));
+  for (Eigen::Index i = 0; i < tail_len; ++i) {
+    llr_weights(max_n.second(i + 1)) = smoothed.first(i);
+  }
+  return (llr_weights < 0.0).select(llr_weights, 0.0).exp();
+}
+
+Eigen::MatrixXd heavy_tailed_log_ratios(Eigen::Index N, Eigen::Index sets) {
+  boost::mt19937 rng(2024);
+  Eigen::MatrixXd log_ratios(N, sets);
+  for (Eigen::Index j = 0; j < sets; ++j) {
+    boost::random::student_t_distribution<double> t(3 + j);
+    for (Eigen::Index i = 0; i < N; ++i) {
+      log_ratios(i, j) = t(rng);
+    }
+  }
+  return log_ratios;
+}
+}  // namespace
+
+TEST(ServicesPSISEngine, matches_full_sort) {
+  Eigen::MatrixXd log_ratios = heavy_tailed_log_ratios(1000, 3);
+  stan::services::psis::psis_engine engine;
+  stan::test::test_logger logger;
+  Eigen::Array<double, Eigen::Dynamic, 1> weights;
+  for (Eigen::Index j = 0; j < log_ratios.cols(); ++j) {
+    Eigen::Array<double, Eigen::Dynamic, 1> lr = log_ratios.col(j).array();
+    const double k = engine.weights(lr, 95, weights, logger);
+    EXPECT_FALSE(std::isnan(k));
+    Eigen::Array<double, Eigen::Dynamic, 1> expected
+        = reference_weights(lr, 95);
+    ASSERT_EQ(expected.size(), weights.size());
+    for (Eigen::Index i = 0; i < weights.size(); ++i) {
+      EXPECT_NEAR(expected(i), weights(i), 1e-12) << "set " << j << " " << i;
+    }
+    EXPECT_LE(weights.maxCoeff(), 1.0);
+  }
+}
+
+TEST(ServicesPSISEngine, short_tail_is_not_smoothed) {
+  Eigen::Array<double, Eigen::Dynamic, 1> lr(6);
+  lr << 0.5, -1, 2, 0, 1, -3;
+  stan::services::psis::psis_engine engine;
+  stan::test::test_logger logger;
+  Eigen::Array<double, Eigen::Dynamic, 1> weights;
+  EXPECT_TRUE(std::isnan(engine.weights(lr, 4, weights, logger)));
+  for (Eigen::Index i = 0; i < lr.size(); ++i) {
+    EXPECT_FLOAT_EQ(std::exp(lr(i) - 2), weights(i));
+  }
+}
+
+TEST(ServicesPSISEngine, by_column_matches_single_sets) {
+  Eigen::MatrixXd log_ratios = heavy_tailed_log_ratios(400, 7);
+  log_ratios.col(3).setConstant(1.5);
+  stan::test::test_logger logger;
+  Eigen::MatrixXd weights;
+  Eigen::VectorXd pareto_k = stan::services::psis::psis_weights_by_column(
+      log_ratios, 60, weights, logger);
+  ASSERT_EQ(7, pareto_k.size());
+  ASSERT_EQ(log_ratios.rows(), weights.rows());
+  ASSERT_EQ(log_ratios.cols(), weights.cols());
+
+  stan::services::psis::psis_engine engine;
+  Eigen::Array<double, Eigen::Dynamic, 1> expected;
+  for (Eigen::Index j = 0; j < log_ratios.cols(); ++j) {
+    const double k = engine.weights(log_ratios.col(j).array(), 60, expected,
+                                    logger);
+    if (j == 3) {
+      // a constant tail can not be fit and is left as is
+      EXPECT_TRUE(std::isnan(pareto_k(j)));
+    } else {
+      EXPECT_EQ(k, pareto_k(j));
+    }
+    for (Eigen::Index i = 0; i < expected.size(); ++i) {
+      EXPECT_EQ(expected(i), weights(i, j)) << "set " << j << " " << i;
+    }
+  }
+}
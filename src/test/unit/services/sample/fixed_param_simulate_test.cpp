@@ -0,0 +1,98 @@
+#include <stan/services/sample/fixed_param_simulate.hpp>
+#include <gtest/gtest.h>
+#include <stan/callbacks/matrix_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <iostream>
+
+class ServicesSamplesFixedParamSimulate : public testing::Test {
+ public:
+  ServicesSamplesFixedParamSimulate() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, parameter;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSamplesFixedParamSimulate, call_count) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_iterations = 10;
+
+  int refresh = 0;
+  stan::test::unit::instrumented_interrupt interrupt;
+  EXPECT_EQ(interrupt.call_count(), 0);
+
+  int return_code = stan::services::sample::fixed_param_simulate(
+      model, context, seed, chain, init_radius, num_iterations, 3, refresh,
+      interrupt, logger, init, parameter);
+  EXPECT_EQ(0, return_code);
+
+  EXPECT_EQ(num_iterations, interrupt.call_count());
+  EXPECT_EQ(1, parameter.call_count("vector_string"));
+  EXPECT_EQ(num_iterations, parameter.call_count("vector_double"));
+  EXPECT_EQ(1, logger.find_info("Elapsed Time:"));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSamplesFixedParamSimulate, output_matches_fixed_param) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::services::sample::fixed_param_simulate(model, context, 0, 1, 0, 10, 3,
+                                               0, interrupt, logger, init,
+                                               parameter);
+
+  std::vector<std::vector<std::string>> parameter_names
+      = parameter.vector_string_values();
+  std::vector<std::vector<double>> parameter_values
+      = parameter.vector_double_values();
+  ASSERT_EQ(1, parameter_names.size());
+  ASSERT_EQ(4, parameter_names[0].size());
+  EXPECT_EQ("lp__", parameter_names[0][0]);
+  EXPECT_EQ("accept_stat__", parameter_names[0][1]);
+  EXPECT_EQ("x", parameter_names[0][2]);
+  EXPECT_EQ("y", parameter_names[0][3]);
+  ASSERT_EQ(10, parameter_values.size());
+  for (const std::vector<double>& draw : parameter_values) {
+    ASSERT_EQ(4, draw.size());
+    EXPECT_DOUBLE_EQ(0.0, draw[0]);
+    EXPECT_DOUBLE_EQ(0.0, draw[1]);
+    EXPECT_DOUBLE_EQ(0.0, draw[2]);
+    EXPECT_DOUBLE_EQ(0.0, draw[3]);
+  }
+}
+
+TEST_F(ServicesSamplesFixedParamSimulate, block_size_invariant) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::test::unit::instrumented_writer other;
+  stan::services::sample::fixed_param_simulate(model, context, 0, 1, 0, 100,
+                                               1, 0, interrupt, logger, init,
+                                               parameter);
+  stan::services::sample::fixed_param_simulate(model, context, 0, 1, 0, 100,
+                                               17, 0, interrupt, logger, init,
+                                               other);
+  EXPECT_EQ(parameter.vector_double_values(), other.vector_double_values());
+}
+
+TEST_F(ServicesSamplesFixedParamSimulate, matrix_writer) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  std::vector<double> buffer(25 * 4, -1);
+  stan::callbacks::matrix_writer draws(buffer.data(), 25, 4);
+  int return_code = stan::services::sample::fixed_param_simulate(
+      model, context, 0, 1, 0, 25, 4, 0, interrupt, logger, init, draws);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(25, draws.num_rows_written());
+  EXPECT_EQ(std::vector<double>(25 * 4, 0.0), buffer);
+}
+
+TEST_F(ServicesSamplesFixedParamSimulate, zero_block_size) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::sample::fixed_param_simulate(
+      model, context, 0, 1, 0, 10, 0, 0, interrupt, logger, init, parameter);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(0, parameter.call_count("vector_double"));
+  EXPECT_EQ(1, logger.call_count_error());
+}
@@ -0,0 +1,93 @@
+#include <stan/services/sample/hmc_nuts_auto_e_adapt.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <src/test/unit/services/util.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class ServicesSampleHmcNutsAutoEAdapt : public testing::Test {
+ public:
+  ServicesSampleHmcNutsAutoEAdapt() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, parameter, diagnostic;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsAutoEAdapt, call_count) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 400;
+  int num_samples = 400;
+  int num_thin = 5;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .1;
+  double gamma = .1;
+  double kappa = .1;
+  double t0 = .1;
+  unsigned int init_buffer = 50;
+  unsigned int term_buffer = 50;
+  unsigned int window = 100;
+  int rank = 1;
+  stan::test::unit::instrumented_interrupt interrupt;
+  EXPECT_EQ(interrupt.call_count(), 0);
+
+  int return_code = stan::services::sample::hmc_nuts_auto_e_adapt(
+      model, context, random_seed, chain, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, rank,
+      interrupt, logger, init, parameter, diagnostic);
+
+  EXPECT_EQ(0, return_code);
+
+  int num_output_lines = (num_warmup + num_samples) / num_thin;
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+  EXPECT_EQ(1, parameter.call_count("vector_string"));
+  EXPECT_EQ(num_output_lines, parameter.call_count("vector_double"));
+  EXPECT_EQ(1, diagnostic.call_count("vector_string"));
+  EXPECT_EQ(num_output_lines, diagnostic.call_count("vector_double"));
+  EXPECT_EQ(0, logger.call_count_error());
+  EXPECT_EQ(1, logger.find_info("Metric selection after 100 warmup draws"));
+}
+
+TEST_F(ServicesSampleHmcNutsAutoEAdapt, metric_writer) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  std::stringstream ss_metric;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> metric(
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss_metric));
+
+  int return_code = stan::services::sample::hmc_nuts_auto_e_adapt(
+      model, context, 0, 1, 0, 400, 100, 1, false, 0, 0.1, 0, 8, .8, .05, .75,
+      10, 50, 50, 100, 1, interrupt, logger, init, parameter, diagnostic,
+      metric);
+  EXPECT_EQ(0, return_code);
+
+  std::string json = ss_metric.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(json));
+  EXPECT_EQ(1, count_matches("\"metric_type\"", json));
+  EXPECT_EQ(1, count_matches("\"inv_metric\"", json));
+}
+
+TEST_F(ServicesSampleHmcNutsAutoEAdapt, negative_rank) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::sample::hmc_nuts_auto_e_adapt(
+      model, context, 0, 1, 0, 200, 400, 5, true, 0, 0.1, 0, 8, .1, .1, .1,
+      .1, 50, 50, 100, -1, interrupt, logger, init, parameter, diagnostic);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(1, logger.find_error("Rank of the metric"));
+}
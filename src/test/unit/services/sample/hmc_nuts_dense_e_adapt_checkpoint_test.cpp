@@ -0,0 +1,120 @@
+#include <stan/services/sample/hmc_nuts_dense_e_adapt_checkpoint.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+}  // namespace
+
+class ServicesSampleHmcNutsDenseEAdaptCheckpoint : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDenseEAdaptCheckpoint()
+      : model(context, 0, &model_log),
+        checkpoint_writer(
+            std::unique_ptr<std::stringstream, deleter_noop>(&checkpoint_ss)) {
+    checkpoint_ss << std::setprecision(
+        std::numeric_limits<double>::max_digits10);
+  }
+
+  // run with one checkpoint, then resume from it and check the resumed
+  // draws are those the uninterrupted run made after the checkpoint
+  void check_resume(int checkpoint_interval) {
+    auto inv_metric = stan::services::util::create_unit_e_dense_inv_metric(
+        model.num_params_r());
+    stan::test::unit::instrumented_writer init, parameter, diagnostic;
+    int return_code
+        = stan::services::sample::hmc_nuts_dense_e_adapt_checkpointed(
+            model, context, inv_metric, random_seed, chain, init_radius,
+            num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+            stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+            term_buffer, window, interrupt, logger, init, parameter,
+            diagnostic, metric, checkpoint_writer, checkpoint_interval);
+    EXPECT_EQ(0, return_code);
+
+    std::stringstream checkpoint_in(checkpoint_ss.str());
+    stan::json::json_data checkpoint(checkpoint_in);
+    stan::test::unit::instrumented_writer resumed_parameter,
+        resumed_diagnostic;
+    stan::callbacks::structured_writer no_checkpoints;
+    return_code = stan::services::sample::hmc_nuts_dense_e_adapt_resume(
+        model, checkpoint, random_seed, chain, num_warmup, num_samples,
+        num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+        delta, gamma, kappa, t0, init_buffer, term_buffer, window, interrupt,
+        logger, resumed_parameter, resumed_diagnostic, metric, no_checkpoints,
+        0);
+    EXPECT_EQ(0, return_code);
+
+    std::vector<std::vector<double>> draws = parameter.vector_double_values();
+    std::vector<std::vector<double>> resumed
+        = resumed_parameter.vector_double_values();
+    ASSERT_EQ(num_warmup + num_samples, static_cast<int>(draws.size()));
+    ASSERT_EQ(num_warmup + num_samples - checkpoint_interval,
+              static_cast<int>(resumed.size()));
+    for (size_t i = 0; i < resumed.size(); ++i)
+      EXPECT_EQ(draws[checkpoint_interval + i], resumed[i]);
+    EXPECT_EQ(0, resumed_parameter.vector_string_values().size());
+  }
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::callbacks::structured_writer metric;
+  stan::io::empty_var_context context;
+  stan_model model;
+  std::stringstream checkpoint_ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop>
+      checkpoint_writer;
+
+  unsigned int random_seed = 3;
+  unsigned int chain = 1;
+  double init_radius = 2;
+  int num_warmup = 100;
+  int num_samples = 50;
+  int num_thin = 1;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 1;
+  double stepsize_jitter = 0.5;
+  int max_depth = 8;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 15;
+  unsigned int term_buffer = 10;
+  unsigned int window = 25;
+};
+
+TEST_F(ServicesSampleHmcNutsDenseEAdaptCheckpoint, resume_in_warmup) {
+  check_resume(80);
+}
+
+TEST_F(ServicesSampleHmcNutsDenseEAdaptCheckpoint, resume_in_sampling) {
+  check_resume(120);
+}
+
+TEST_F(ServicesSampleHmcNutsDenseEAdaptCheckpoint, bad_checkpoint) {
+  std::stringstream checkpoint_in("{\"iteration\": 10}");
+  stan::json::json_data checkpoint(checkpoint_in);
+  stan::test::unit::instrumented_writer parameter, diagnostic;
+  int return_code = stan::services::sample::hmc_nuts_dense_e_adapt_resume(
+      model, checkpoint, random_seed, chain, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, interrupt,
+      logger, parameter, diagnostic, metric, checkpoint_writer, 50);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(0, parameter.call_count());
+}
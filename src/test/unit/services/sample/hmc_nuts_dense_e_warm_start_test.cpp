@@ -0,0 +1,107 @@
+#include <stan/services/sample/hmc_nuts_dense_e_warm_start.hpp>
+#include <stan/services/sample/hmc_nuts_dense_e_adapt.hpp>
+#include <stan/services/util/mode_warm_start.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <cmath>
+#include <sstream>
+
+class ServicesSampleHmcNutsDenseEWarmStart : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDenseEWarmStart() : model(context, 0, &model_log) {}
+
+  stan::io::stan_csv fit(unsigned int random_seed) {
+    std::stringstream out;
+    stan::callbacks::stream_writer sample_writer(out, "# ");
+    stan::test::unit::instrumented_writer init_writer, diagnostic_writer;
+    stan::test::unit::instrumented_interrupt interrupt;
+    int return_code = stan::services::sample::hmc_nuts_dense_e_adapt(
+        model, context, random_seed, 1, 0, 300, 100, 1, false, 0, 1, 0, 10,
+        0.8, 0.05, 0.75, 10, 75, 50, 25, interrupt, logger, init_writer,
+        sample_writer, diagnostic_writer);
+    EXPECT_EQ(0, return_code);
+    std::stringstream msg;
+    return stan::io::stan_csv_reader::parse(out, &msg);
+  }
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, diagnostic;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsDenseEWarmStart, reuses_adaptation) {
+  stan::io::stan_csv previous = fit(0);
+  ASSERT_EQ(2, previous.adaptation.metric.rows());
+
+  std::stringstream out;
+  stan::callbacks::stream_writer sample_writer(out, "# ");
+  stan::test::unit::instrumented_interrupt interrupt;
+  int num_warmup = 50;
+  int num_samples = 100;
+  int return_code = stan::services::sample::hmc_nuts_dense_e_warm_start(
+      model, previous, 1, 1, num_warmup, num_samples, 1, false, 0, 0, 10, 0.8,
+      0.05, 0.75, 10, interrupt, logger, init, sample_writer, diagnostic);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+
+  // the chain starts from the last draw of the previous fit
+  std::vector<double> start = init.vector_double_values()[0];
+  ASSERT_EQ(2, start.size());
+  const Eigen::Index last = previous.samples.rows() - 1;
+  EXPECT_FLOAT_EQ(previous.samples(last, previous.samples.cols() - 2),
+                  start[0]);
+  EXPECT_FLOAT_EQ(previous.samples(last, previous.samples.cols() - 1),
+                  start[1]);
+
+  // the metric is kept while the step size is adapted again
+  std::stringstream msg;
+  stan::io::stan_csv warm = stan::io::stan_csv_reader::parse(out, &msg);
+  EXPECT_EQ(num_samples, warm.samples.rows());
+  EXPECT_GT(warm.adaptation.step_size, 0);
+  ASSERT_EQ(previous.adaptation.metric.size(), warm.adaptation.metric.size());
+  for (int i = 0; i < warm.adaptation.metric.size(); ++i)
+    EXPECT_NEAR(previous.adaptation.metric(i), warm.adaptation.metric(i),
+                1e-5 * std::fabs(previous.adaptation.metric(i)));
+}
+
+TEST_F(ServicesSampleHmcNutsDenseEWarmStart, no_previous_draws) {
+  stan::io::stan_csv previous;
+  stan::test::unit::instrumented_writer parameter;
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::sample::hmc_nuts_dense_e_warm_start(
+      model, previous, 1, 1, 50, 100, 1, false, 0, 0, 10, 0.8, 0.05, 0.75, 10,
+      interrupt, logger, init, parameter, diagnostic);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(0, interrupt.call_count());
+  EXPECT_EQ(1, logger.find_error("no draws"));
+}
+
+TEST_F(ServicesSampleHmcNutsDenseEWarmStart, from_mode) {
+  // the mode of the rosenbrock density
+  Eigen::VectorXd mode = Eigen::VectorXd::Ones(2);
+  stan::services::util::warm_start start
+      = stan::services::util::warm_start_from_mode(model, mode, true, logger);
+  ASSERT_EQ(2, start.inv_metric.rows());
+
+  stan::test::unit::instrumented_writer parameter;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::callbacks::structured_writer metric_writer;
+  int num_warmup = 50;
+  int num_samples = 100;
+  int return_code = stan::services::sample::hmc_nuts_dense_e_warm_start(
+      model, start, 1, 1, num_warmup, num_samples, 1, false, 0, 0, 10, 0.8,
+      0.05, 0.75, 10, interrupt, logger, init, parameter, diagnostic,
+      metric_writer);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+  std::vector<double> init_values = init.vector_double_values()[0];
+  ASSERT_EQ(2, init_values.size());
+  EXPECT_FLOAT_EQ(1, init_values[0]);
+  EXPECT_FLOAT_EQ(1, init_values[1]);
+}
@@ -0,0 +1,130 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt_batch.hpp>
+#include <gtest/gtest.h>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/services/error_codes.hpp>
+#include <test/test-models/good/services/bernoulli.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+namespace {
+// sums the theta column of the draws of one fit
+class theta_writer : public stan::callbacks::writer {
+ public:
+  theta_writer(int& num_draws, double& sum_theta)
+      : num_draws_(num_draws), sum_theta_(sum_theta) {}
+  using stan::callbacks::writer::operator();
+  void operator()(const std::vector<std::string>& names) {
+    for (size_t n = 0; n < names.size(); ++n)
+      if (names[n] == "theta")
+        theta_ = n;
+  }
+  void operator()(const std::vector<double>& state) {
+    ++num_draws_;
+    sum_theta_ += state[theta_];
+  }
+
+ private:
+  int& num_draws_;
+  double& sum_theta_;
+  size_t theta_ = 0;
+};
+
+class error_logger : public stan::callbacks::logger {
+ public:
+  explicit error_logger(int& num_errors) : num_errors_(num_errors) {}
+  void error(const std::string& message) { ++num_errors_; }
+  void error(const std::stringstream& message) { ++num_errors_; }
+
+ private:
+  int& num_errors_;
+};
+
+std::unique_ptr<stan::io::array_var_context> bernoulli_data(
+    const std::vector<int>& y) {
+  std::vector<int> values{static_cast<int>(y.size())};
+  values.insert(values.end(), y.begin(), y.end());
+  std::vector<std::vector<size_t>> dims{{}, {y.size()}};
+  return std::make_unique<stan::io::array_var_context>(
+      std::vector<std::string>{"N", "y"}, values, dims);
+}
+}  // namespace
+
+class ServicesSampleHmcNutsDiagEAdaptBatch : public testing::Test {
+ public:
+  int run(std::vector<int>* return_codes) {
+    const size_t num_fits = data.size();
+    num_draws.assign(num_fits, 0);
+    sum_theta.assign(num_fits, 0);
+    num_errors.assign(num_fits, 0);
+    std::stringstream summary_ss;
+    stan::callbacks::stream_logger summary_logger(summary_ss, summary_ss,
+                                                  summary_ss, summary_ss,
+                                                  summary_ss);
+    stan::callbacks::interrupt interrupt;
+    int return_code
+        = stan::services::sample::hmc_nuts_diag_e_adapt_batch<stan_model>(
+            data, 0, 1, 2, 200, 400, 1, false, 0, 1, 0, 10, 0.8, 0.05, 0.75,
+            10, 75, 50, 25, interrupt, summary_logger,
+            [&](size_t fit) {
+              stan::services::sample::batch_fit_callbacks callbacks;
+              callbacks.logger
+                  = std::make_unique<error_logger>(num_errors[fit]);
+              callbacks.sample_writer = std::make_unique<theta_writer>(
+                  num_draws[fit], sum_theta[fit]);
+              return callbacks;
+            },
+            return_codes);
+    summary = summary_ss.str();
+    return return_code;
+  }
+
+  std::vector<std::unique_ptr<stan::io::array_var_context>> data;
+  std::vector<int> num_draws;
+  std::vector<double> sum_theta;
+  std::vector<int> num_errors;
+  std::string summary;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptBatch, fits_each_data_set) {
+  for (int fit = 0; fit < 8; ++fit)
+    data.push_back(bernoulli_data(fit % 2 == 0
+                                      ? std::vector<int>(20, 1)
+                                      : std::vector<int>(20, 0)));
+  std::vector<int> return_codes;
+  EXPECT_EQ(stan::services::error_codes::OK, run(&return_codes));
+  ASSERT_EQ(8, return_codes.size());
+  for (int fit = 0; fit < 8; ++fit) {
+    EXPECT_EQ(stan::services::error_codes::OK, return_codes[fit]);
+    EXPECT_EQ(400, num_draws[fit]);
+    EXPECT_EQ(0, num_errors[fit]);
+    // beta(21, 1) and beta(1, 21) posteriors
+    const double mean_theta = sum_theta[fit] / num_draws[fit];
+    if (fit % 2 == 0)
+      EXPECT_GT(mean_theta, 0.9);
+    else
+      EXPECT_LT(mean_theta, 0.1);
+  }
+  EXPECT_NE(std::string::npos, summary.find("Batch of 8 fits: 0 failed."));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptBatch, bad_data_fails_alone) {
+  data.push_back(bernoulli_data({0, 1, 1}));
+  data.push_back(bernoulli_data({0, 2, 1}));
+  data.push_back(bernoulli_data({1, 1, 0}));
+  std::vector<int> return_codes;
+  EXPECT_EQ(stan::services::error_codes::DATAERR, run(&return_codes));
+  EXPECT_EQ(std::vector<int>({stan::services::error_codes::OK,
+                              stan::services::error_codes::DATAERR,
+                              stan::services::error_codes::OK}),
+            return_codes);
+  EXPECT_EQ(400, num_draws[0]);
+  EXPECT_EQ(0, num_draws[1]);
+  EXPECT_EQ(1, num_errors[1]);
+  EXPECT_EQ(400, num_draws[2]);
+  EXPECT_NE(std::string::npos, summary.find("Batch of 3 fits: 1 failed."));
+}
@@ -0,0 +1,82 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt_fixed.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <iostream>
+
+class ServicesSampleHmcNutsDiagEAdaptFixed : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptFixed() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, parameter, diagnostic;
+  stan::callbacks::structured_writer metric;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptFixed, call_count) {
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 400;
+  int num_thin = 5;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double stepsize_jitter = 0;
+  int max_depth = 8;
+  double delta = .1;
+  double gamma = .1;
+  double kappa = .1;
+  double t0 = .1;
+  unsigned int init_buffer = 50;
+  unsigned int term_buffer = 50;
+  unsigned int window = 100;
+  stan::test::unit::instrumented_interrupt interrupt;
+  EXPECT_EQ(interrupt.call_count(), 0);
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt_fixed(
+      model, context, random_seed, chain, init_radius, num_warmup, num_samples,
+      num_thin, save_warmup, refresh, stepsize, stepsize_jitter, max_depth,
+      delta, gamma, kappa, t0, init_buffer, term_buffer, window, interrupt,
+      logger, init, parameter, diagnostic, metric);
+
+  EXPECT_EQ(0, return_code);
+
+  int num_output_lines = (num_warmup + num_samples) / num_thin;
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+  EXPECT_EQ(1, parameter.call_count("vector_string"));
+  EXPECT_EQ(num_output_lines, parameter.call_count("vector_double"));
+  EXPECT_EQ(1, diagnostic.call_count("vector_string"));
+  EXPECT_EQ(num_output_lines, diagnostic.call_count("vector_double"));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptFixed, matches_hmc_nuts_diag_e_adapt) {
+  stan::test::unit::instrumented_writer dynamic_init, dynamic_parameter,
+      dynamic_diagnostic;
+  stan::test::unit::instrumented_interrupt interrupt, dynamic_interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt_fixed(
+      model, context, 0, 1, 0, 100, 100, 1, false, 0, 0.1, 0, 8, 0.8, 0.05,
+      0.75, 10, 15, 25, 10, interrupt, logger, init, parameter, diagnostic,
+      metric);
+  int dynamic_return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, context, 0, 1, 0, 100, 100, 1, false, 0, 0.1, 0, 8, 0.8, 0.05,
+      0.75, 10, 15, 25, 10, dynamic_interrupt, logger, dynamic_init,
+      dynamic_parameter, dynamic_diagnostic, metric);
+
+  EXPECT_EQ(dynamic_return_code, return_code);
+  std::vector<std::vector<double>> draws = parameter.vector_double_values();
+  std::vector<std::vector<double>> dynamic_draws
+      = dynamic_parameter.vector_double_values();
+  ASSERT_EQ(dynamic_draws.size(), draws.size());
+  for (size_t n = 0; n < draws.size(); ++n) {
+    ASSERT_EQ(dynamic_draws[n].size(), draws[n].size());
+    for (size_t i = 0; i < draws[n].size(); ++i)
+      EXPECT_FLOAT_EQ(dynamic_draws[n][i], draws[n][i]);
+  }
+}
@@ -0,0 +1,88 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt_parallel_tempering.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/services/bimodal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+auto&& threadpool_init = stan::math::init_threadpool_tbb(4);
+
+class ServicesSampleHmcNutsDiagEAdaptParallelTempering
+    : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptParallelTempering()
+      : model(context, 0, &model_log) {}
+
+  bool has_comment(const std::string& prefix) {
+    std::vector<std::string> comments = sample_writer.string_values();
+    return std::any_of(comments.begin(), comments.end(),
+                       [&](const std::string& comment) {
+                         return comment.find(prefix) == 0;
+                       });
+  }
+
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::test::unit::instrumented_writer init_writer, sample_writer,
+      diagnostic_writer;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptParallelTempering, visits_both_modes) {
+  int num_warmup = 500;
+  int num_samples = 1000;
+  int return_code
+      = stan::services::sample::hmc_nuts_diag_e_adapt_parallel_tempering(
+          model, 6, context, 0, 1, 2, num_warmup, num_samples, 1, false, 0, 1,
+          0, 10, 0.8, 0.05, 0.75, 10, 75, 50, 25, 100, 1, interrupt, logger,
+          init_writer, sample_writer, diagnostic_writer);
+  ASSERT_EQ(stan::services::error_codes::OK, return_code);
+  EXPECT_EQ(1, init_writer.call_count("vector_double"));
+  std::vector<std::vector<double>> draws
+      = sample_writer.vector_double_values();
+  ASSERT_EQ(num_samples, draws.size());
+  // a single NUTS chain started between the modes stays in one of them
+  int num_positive = 0;
+  for (const auto& draw : draws)
+    num_positive += draw.back() > 0;
+  EXPECT_GT(num_positive, num_samples / 5);
+  EXPECT_LT(num_positive, num_samples * 4 / 5);
+  EXPECT_TRUE(has_comment("Inverse temperatures: 1, "));
+  EXPECT_TRUE(has_comment("Swap rates: "));
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptParallelTempering, one_replica) {
+  int return_code
+      = stan::services::sample::hmc_nuts_diag_e_adapt_parallel_tempering(
+          model, 1, context, 0, 1, 2, 100, 100, 1, false, 0, 1, 0, 10, 0.8,
+          0.05, 0.75, 10, 75, 50, 25, 1, 1, interrupt, logger, init_writer,
+          sample_writer, diagnostic_writer);
+  ASSERT_EQ(stan::services::error_codes::OK, return_code);
+  EXPECT_EQ(100, sample_writer.call_count("vector_double"));
+  EXPECT_TRUE(has_comment("Inverse temperatures: 1"));
+  EXPECT_FALSE(has_comment("Swap rates: "));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptParallelTempering, invalid_arguments) {
+  int return_code
+      = stan::services::sample::hmc_nuts_diag_e_adapt_parallel_tempering(
+          model, 4, context, 0, 1, 2, 100, 100, 1, false, 0, 1, 0, 10, 0.8,
+          0.05, 0.75, 10, 75, 50, 25, 100, 0, interrupt, logger, init_writer,
+          sample_writer, diagnostic_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(1, logger.find_error("swap_interval must be positive"));
+
+  return_code
+      = stan::services::sample::hmc_nuts_diag_e_adapt_parallel_tempering(
+          model, 4, context, 0, 1, 2, 100, 100, 1, false, 0, 1, 0, 10, 0.8,
+          0.05, 0.75, 10, 75, 50, 25, 0.5, 1, interrupt, logger, init_writer,
+          sample_writer, diagnostic_writer);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(1, logger.find_error("max_temperature"));
+  EXPECT_EQ(0, sample_writer.call_count("vector_double"));
+}
@@ -0,0 +1,78 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt_pathfinder.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/json/json_data.hpp>
+#include <test/test-models/good/services/normal_glm.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+auto&& threadpool_init = stan::math::init_threadpool_tbb(1);
+
+namespace {
+stan::json::json_data glm_data() {
+  std::fstream stream(
+      "./src/test/unit/services/pathfinder/"
+      "normal_glm_test.json",
+      std::fstream::in);
+  return stan::json::json_data(stream);
+}
+
+stan::io::array_var_context glm_init() {
+  std::vector<std::string> names_r{"b", "Intercept", "sigma"};
+  std::vector<double> values_r{0, 0, 0, 0, 0, 0, 1};
+  using size_vec = std::vector<size_t>;
+  std::vector<size_vec> dims_r{size_vec{5}, size_vec{}, size_vec{}};
+  return stan::io::array_var_context(names_r, values_r, dims_r);
+}
+}  // namespace
+
+class ServicesSampleHmcNutsDiagEAdaptPathfinder : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptPathfinder()
+      : data(glm_data()),
+        model(data, 0, &model_log),
+        init_writer(num_chains),
+        sample_writer(num_chains),
+        diagnostic_writer(num_chains),
+        metric_writer(num_chains) {
+    for (int i = 0; i < num_paths; ++i)
+      inits.emplace_back(std::make_unique<stan::io::array_var_context>(
+          glm_init()));
+  }
+
+  static constexpr int num_chains = 2;
+  static constexpr int num_paths = 4;
+  std::stringstream model_log;
+  stan::json::json_data data;
+  stan_model model;
+  std::vector<std::unique_ptr<stan::io::array_var_context>> inits;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_interrupt interrupt;
+  std::vector<stan::test::unit::instrumented_writer> init_writer,
+      sample_writer, diagnostic_writer;
+  std::vector<stan::callbacks::structured_writer> metric_writer;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptPathfinder, short_warmup) {
+  int num_warmup = 100;
+  int num_samples = 200;
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt_pathfinder(
+      model, num_chains, inits, 0, 1, 2, 15, 1, 0, 0, 0, 0, 0, 220, 100, 200,
+      100, num_warmup, num_samples, 1, false, 0, 0, 10, 0.8, 0.05, 0.75, 10, 0,
+      50, 50, interrupt, logger, init_writer, sample_writer,
+      diagnostic_writer, metric_writer);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(1, logger.find_info("Pathfinder initialization"));
+
+  for (int i = 0; i < num_chains; ++i) {
+    ASSERT_EQ(1, init_writer[i].call_count("vector_double"));
+    EXPECT_EQ(model.num_params_r(),
+              init_writer[i].vector_double_values()[0].size());
+    EXPECT_EQ(num_samples, sample_writer[i].call_count("vector_double"));
+  }
+  // the chains start from different pathfinder draws
+  EXPECT_NE(init_writer[0].vector_double_values()[0],
+            init_writer[1].vector_double_values()[0]);
+}
@@ -0,0 +1,103 @@
+#include <stan/services/sample/hmc_static_diag_e_lockstep_adapt.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <src/test/unit/services/util.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class ServicesSampleHmcStaticDiagELockstepAdapt : public testing::Test {
+ public:
+  ServicesSampleHmcStaticDiagELockstepAdapt() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, parameter;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcStaticDiagELockstepAdapt, call_count) {
+  size_t num_chains = 8;
+  unsigned int random_seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int num_warmup = 200;
+  int num_samples = 400;
+  int num_thin = 5;
+  bool save_warmup = true;
+  int refresh = 0;
+  double stepsize = 0.1;
+  double int_time = 1;
+  double delta = .8;
+  double gamma = .05;
+  double kappa = .75;
+  double t0 = 10;
+  unsigned int init_buffer = 50;
+  unsigned int term_buffer = 50;
+  unsigned int window = 100;
+  stan::test::unit::instrumented_interrupt interrupt;
+  EXPECT_EQ(interrupt.call_count(), 0);
+
+  int return_code = stan::services::sample::hmc_static_diag_e_lockstep_adapt(
+      model, num_chains, context, random_seed, chain, init_radius, num_warmup,
+      num_samples, num_thin, save_warmup, refresh, stepsize, int_time, delta,
+      gamma, kappa, t0, init_buffer, term_buffer, window, interrupt, logger,
+      init, parameter);
+
+  EXPECT_EQ(0, return_code);
+
+  int num_output_lines = num_chains * (num_warmup + num_samples) / num_thin;
+  EXPECT_EQ(num_warmup + num_samples, interrupt.call_count());
+  EXPECT_EQ(1, parameter.call_count("vector_string"));
+  EXPECT_EQ(num_output_lines, parameter.call_count("vector_double"));
+  EXPECT_EQ(0, logger.call_count_error());
+
+  std::vector<std::string> names = parameter.vector_string_values().front();
+  ASSERT_LT(7, names.size());
+  EXPECT_EQ("chain__", names[0]);
+  EXPECT_EQ("lp__", names[1]);
+  EXPECT_EQ("divergent__", names[6]);
+  EXPECT_EQ("x", names[7]);
+
+  // the rows of an iteration hold the chains in order
+  std::vector<std::vector<double>> draws = parameter.vector_double_values();
+  for (size_t i = 0; i < draws.size(); ++i) {
+    ASSERT_EQ(names.size(), draws[i].size());
+    EXPECT_EQ(chain + i % num_chains, draws[i][0]);
+  }
+}
+
+TEST_F(ServicesSampleHmcStaticDiagELockstepAdapt, metric_writer) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  std::stringstream ss_metric;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> metric(
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss_metric));
+
+  int return_code = stan::services::sample::hmc_static_diag_e_lockstep_adapt(
+      model, 4, context, 0, 1, 0, 200, 100, 1, false, 0, 0.1, 1, .8, .05, .75,
+      10, 50, 50, 100, interrupt, logger, init, parameter, metric);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(4 * 100, parameter.call_count("vector_double"));
+
+  std::string json = ss_metric.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(json));
+  EXPECT_EQ(1, count_matches("\"metric_type\" : \"diag_e\"", json));
+  EXPECT_EQ(1, count_matches("\"inv_metric\"", json));
+}
+
+TEST_F(ServicesSampleHmcStaticDiagELockstepAdapt, no_chains) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::sample::hmc_static_diag_e_lockstep_adapt(
+      model, 0, context, 0, 1, 0, 200, 100, 1, false, 0, 0.1, 1, .8, .05, .75,
+      10, 50, 50, 100, interrupt, logger, init, parameter);
+  EXPECT_EQ(stan::services::error_codes::CONFIG, return_code);
+  EXPECT_EQ(1, logger.find_error("Number of chains must be positive"));
+}
@@ -0,0 +1,122 @@
+#include <stan/services/sample/psis_loo.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+// normal(mu, 1) observations y with a flat prior on mu and the pointwise
+// log likelihood as generated quantities
+struct normal_loo_model {
+  Eigen::VectorXd y;
+
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names = {"mu"};
+    if (include_gqs) {
+      names.push_back("sigma_rep");
+      for (Eigen::Index i = 0; i < y.size(); ++i)
+        names.push_back("log_lik." + std::to_string(i + 1));
+    }
+  }
+
+  void unconstrain_array(const Eigen::VectorXd& constrained,
+                         Eigen::VectorXd& unconstrained,
+                         std::ostream* msgs = nullptr) const {
+    unconstrained = constrained;
+  }
+
+  template <typename RNG>
+  void write_array(RNG& rng, Eigen::VectorXd& unconstrained,
+                   Eigen::VectorXd& vars, bool include_tparams = true,
+                   bool include_gqs = true, std::ostream* msgs = 0) const {
+    vars.resize(2 + y.size());
+    vars(0) = unconstrained(0);
+    vars(1) = boost::random::normal_distribution<double>()(rng);
+    vars.tail(y.size())
+        = -0.5 * (y.array() - unconstrained(0)).square()
+          - 0.5 * std::log(2 * M_PI);
+  }
+};
+
+struct loo_writer : public stan::callbacks::writer {
+  using stan::callbacks::writer::operator();
+  void operator()(const std::vector<std::string>& names) { header = names; }
+  void operator()(const std::vector<double>& state) { rows.push_back(state); }
+  std::vector<std::string> header;
+  std::vector<std::vector<double>> rows;
+};
+
+class ServicesPsisLoo : public testing::Test {
+ public:
+  ServicesPsisLoo() : y(20), draws(4000, 1) {
+    stan::rng_t rng = stan::services::util::create_rng(11, 1);
+    boost::random::normal_distribution<double> normal;
+    for (Eigen::Index i = 0; i < y.size(); ++i)
+      y(i) = normal(rng);
+    // posterior of mu is normal(mean(y), 1 / sqrt(N))
+    for (Eigen::Index n = 0; n < draws.rows(); ++n)
+      draws(n, 0) = y.mean() + normal(rng) / std::sqrt(y.size());
+    model.y = y;
+  }
+
+  Eigen::VectorXd y;
+  Eigen::MatrixXd draws;
+  normal_loo_model model;
+  stan::test::unit::instrumented_logger logger;
+  stan::callbacks::interrupt interrupt;
+};
+}  // namespace
+
+TEST_F(ServicesPsisLoo, matches_exact_loo) {
+  loo_writer writer;
+  EXPECT_EQ(stan::services::error_codes::OK,
+            stan::services::psis_loo(model, draws, 3, "log_lik", interrupt,
+                                     logger, writer));
+  EXPECT_EQ(std::vector<std::string>({"elpd_loo", "p_loo", "pareto_k"}),
+            writer.header);
+  ASSERT_EQ(20, writer.rows.size());
+  const double N = y.size();
+  for (Eigen::Index i = 0; i < y.size(); ++i) {
+    // predictive density of y_i given the other observations
+    const double mean = (y.sum() - y(i)) / (N - 1);
+    const double var = 1 + 1 / (N - 1);
+    const double elpd = -0.5 * (y(i) - mean) * (y(i) - mean) / var
+                        - 0.5 * std::log(2 * M_PI * var);
+    EXPECT_NEAR(elpd, writer.rows[i][0], 0.02);
+    EXPECT_GT(writer.rows[i][1], 0);
+    EXPECT_LT(writer.rows[i][2], 0.5);
+  }
+  EXPECT_EQ(1, logger.find_info("PSIS-LOO over 20 observations"));
+}
+
+TEST_F(ServicesPsisLoo, independent_of_block_size) {
+  loo_writer writer;
+  stan::services::psis_loo(model, draws, 3, "log_lik", interrupt, logger,
+                           writer);
+  loo_writer block_writer;
+  EXPECT_EQ(stan::services::error_codes::OK,
+            stan::services::psis_loo(model, draws, 3, "log_lik", interrupt,
+                                     logger, block_writer, 3 * 4000));
+  EXPECT_EQ(writer.rows, block_writer.rows);
+}
+
+TEST_F(ServicesPsisLoo, errors) {
+  loo_writer writer;
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::psis_loo(model, draws, 3, "log_lik_rep",
+                                     interrupt, logger, writer));
+  EXPECT_EQ(1, logger.find_error("no variable log_lik_rep"));
+  Eigen::MatrixXd wrong(10, 2);
+  EXPECT_EQ(stan::services::error_codes::DATAERR,
+            stan::services::psis_loo(model, wrong, 3, "log_lik", interrupt,
+                                     logger, writer));
+  Eigen::MatrixXd empty(0, 1);
+  EXPECT_EQ(stan::services::error_codes::DATAERR,
+            stan::services::psis_loo(model, empty, 3, "log_lik", interrupt,
+                                     logger, writer));
+}
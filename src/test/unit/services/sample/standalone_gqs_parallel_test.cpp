@@ -2,7 +2,9 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <stan/callbacks/stream_logger.hpp>
+#include <stan/callbacks/stream_writer.hpp>
 #include <stan/callbacks/unique_stream_writer.hpp>
+#include <stan/io/csv_draws_source.hpp>
 #include <stan/io/json/json_data.hpp>
 #include <stan/io/stan_csv_reader.hpp>
 #include <stan/services/error_codes.hpp>
@@ -78,3 +80,78 @@ TEST_F(ServicesStandaloneGQ, genDraws_bernoulli) {
     match_csv_columns(bern_csv.samples, sample_ss[i].str(), 1000, 1, 8);
   }
 }
+
+TEST_F(ServicesStandaloneGQ, genDraws_bernoulli_blocks) {
+  stan::io::stan_csv bern_csv;
+  std::stringstream out;
+  std::ifstream csv_stream;
+  csv_stream.open("src/test/test-models/good/services/bernoulli_fit.csv");
+  bern_csv = stan::io::stan_csv_reader::parse(csv_stream, &out);
+  csv_stream.close();
+  ASSERT_EQ(1000, bern_csv.samples.rows());
+  ASSERT_EQ(19, bern_csv.samples.cols());
+
+  std::vector<std::string> outputs;
+  for (size_t block_size : {1, 7, 2000}) {
+    std::stringstream sample_ss;
+    stan::callbacks::stream_writer sample_writer(sample_ss, "");
+    int return_code = stan::services::standalone_generate(
+        model, bern_csv.samples.middleCols<1>(7), 12345, block_size,
+        interrupt, logger, sample_writer);
+    EXPECT_EQ(return_code, stan::services::error_codes::OK);
+    EXPECT_EQ(count_matches("mu", sample_ss.str()), 1);
+    EXPECT_EQ(count_matches("y_rep", sample_ss.str()), 10);
+    EXPECT_EQ(count_matches("\n", sample_ss.str()), 1001);
+    match_csv_columns(bern_csv.samples, sample_ss.str(), 1000, 1, 8);
+    outputs.push_back(sample_ss.str());
+  }
+  // the draws do not depend on how the draws are split between threads
+  EXPECT_EQ(outputs[0], outputs[1]);
+  EXPECT_EQ(outputs[0], outputs[2]);
+}
+
+TEST_F(ServicesStandaloneGQ, genDraws_bernoulli_streaming) {
+  stan::io::stan_csv bern_csv;
+  std::stringstream out;
+  std::ifstream csv_stream;
+  csv_stream.open("src/test/test-models/good/services/bernoulli_fit.csv");
+  bern_csv = stan::io::stan_csv_reader::parse(csv_stream, &out);
+  csv_stream.close();
+
+  std::stringstream expected_ss;
+  stan::callbacks::stream_writer expected_writer(expected_ss, "");
+  EXPECT_EQ(stan::services::error_codes::OK,
+            stan::services::standalone_generate(
+                model, bern_csv.samples.middleCols<1>(7), 12345, 7, interrupt,
+                logger, expected_writer));
+  for (size_t block_size : {1, 7, 2000}) {
+    std::ifstream in("src/test/test-models/good/services/bernoulli_fit.csv");
+    stan::io::csv_draws_source draws(in, {"theta"});
+    std::stringstream sample_ss;
+    stan::callbacks::stream_writer sample_writer(sample_ss, "");
+    int return_code = stan::services::standalone_generate(
+        model, draws, 12345, block_size, interrupt, logger, sample_writer);
+    EXPECT_EQ(return_code, stan::services::error_codes::OK);
+    EXPECT_EQ(expected_ss.str(), sample_ss.str());
+  }
+
+  std::stringstream empty("lp__,theta\n");
+  stan::io::csv_draws_source no_draws(empty, {"theta"});
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  EXPECT_EQ(stan::services::error_codes::DATAERR,
+            stan::services::standalone_generate(model, no_draws, 12345, 7,
+                                                interrupt, logger,
+                                                sample_writer));
+  EXPECT_EQ("", sample_ss.str());
+}
+
+TEST_F(ServicesStandaloneGQ, genDraws_blocks_zero_size) {
+  Eigen::MatrixXd draws = Eigen::MatrixXd::Constant(2, 1, 0.5);
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  int return_code = stan::services::standalone_generate(
+      model, draws, 12345, 0, interrupt, logger, sample_writer);
+  EXPECT_EQ(return_code, stan::services::error_codes::CONFIG);
+  EXPECT_EQ(count_matches("Block size", logger_ss.str()), 1);
+}
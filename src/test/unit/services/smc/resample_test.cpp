@@ -0,0 +1,46 @@
+#include <stan/services/smc/resample.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+using stan::services::smc::systematic_resample;
+
+TEST(ServicesSmcResample, counts) {
+  boost::ecuyer1988 rng(0);
+  Eigen::ArrayXd weights(4);
+  weights << 0.5, 0, 2.5, 1;
+  for (int n = 0; n < 100; ++n) {
+    std::vector<Eigen::Index> indices = systematic_resample(weights, rng);
+    ASSERT_EQ(4U, indices.size());
+    std::vector<int> counts(4, 0);
+    for (Eigen::Index i : indices)
+      ++counts[i];
+    // expected counts 0.5, 0, 2.5 and 1
+    EXPECT_LE(counts[0], 1);
+    EXPECT_EQ(0, counts[1]);
+    EXPECT_GE(counts[2], 2);
+    EXPECT_LE(counts[2], 3);
+    EXPECT_EQ(1, counts[3]);
+    EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+  }
+}
+
+TEST(ServicesSmcResample, uniform_weights) {
+  boost::ecuyer1988 rng(0);
+  std::vector<Eigen::Index> indices
+      = systematic_resample(Eigen::ArrayXd::Constant(5, 3), rng);
+  EXPECT_EQ((std::vector<Eigen::Index>{0, 1, 2, 3, 4}), indices);
+}
+
+TEST(ServicesSmcResample, invalid_weights) {
+  boost::ecuyer1988 rng(0);
+  EXPECT_THROW(systematic_resample(Eigen::ArrayXd::Zero(3), rng),
+               std::domain_error);
+  Eigen::ArrayXd weights = Eigen::ArrayXd::Ones(3);
+  weights(1) = -1;
+  EXPECT_THROW(systematic_resample(weights, rng), std::domain_error);
+  weights(1) = INFINITY;
+  EXPECT_THROW(systematic_resample(weights, rng), std::domain_error);
+}
@@ -0,0 +1,94 @@
+#include <stan/services/smc/smc_hmc_static_diag_e.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/services/multi_normal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+auto&& threadpool_init = stan::math::init_threadpool_tbb(4);
+
+class ServicesSmcHmcStaticDiagE : public testing::Test {
+ public:
+  ServicesSmcHmcStaticDiagE() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::test::unit::instrumented_writer sample_writer;
+};
+
+TEST_F(ServicesSmcHmcStaticDiagE, multi_normal) {
+  const unsigned int num_particles = 1000;
+  double log_z = NAN;
+  int return_code = stan::services::smc::smc_hmc_static_diag_e(
+      model, num_particles, 0, 1, 2, 0.5, 5, 0.5, 5, 0.65, 100, 1, interrupt,
+      logger, sample_writer, &log_z);
+  ASSERT_EQ(stan::services::error_codes::OK, return_code);
+  EXPECT_EQ(0, logger.call_count_error());
+  EXPECT_GT(logger.find_info("Stage "), 1);
+
+  // the multi-normal density is normalized
+  EXPECT_NEAR(0, log_z, 0.2);
+  std::vector<std::vector<std::string>> headers
+      = sample_writer.vector_string_values();
+  ASSERT_EQ(1, headers.size());
+  EXPECT_EQ((std::vector<std::string>{"lp__", "y.1", "y.2"}), headers[0]);
+  std::vector<std::vector<double>> draws
+      = sample_writer.vector_double_values();
+  ASSERT_EQ(num_particles, draws.size());
+  Eigen::Vector2d mean = Eigen::Vector2d::Zero();
+  double cov = 0;
+  for (const auto& draw : draws) {
+    mean(0) += draw[1];
+    mean(1) += draw[2];
+    cov += (draw[1] - 2) * (draw[2] - 3);
+  }
+  mean /= num_particles;
+  cov /= num_particles;
+  EXPECT_NEAR(2, mean(0), 0.15);
+  EXPECT_NEAR(3, mean(1), 0.15);
+  EXPECT_NEAR(0.8, cov, 0.15);
+}
+
+TEST_F(ServicesSmcHmcStaticDiagE, reproducible) {
+  stan::test::unit::instrumented_writer other_writer;
+  double log_z = NAN;
+  double other_log_z = NAN;
+  stan::services::smc::smc_hmc_static_diag_e(
+      model, 100, 3, 1, 2, 0.5, 2, 0.5, 5, 0.65, 100, 0, interrupt, logger,
+      sample_writer, &log_z);
+  stan::services::smc::smc_hmc_static_diag_e(
+      model, 100, 3, 1, 2, 0.5, 2, 0.5, 5, 0.65, 100, 0, interrupt, logger,
+      other_writer, &other_log_z);
+  EXPECT_EQ(log_z, other_log_z);
+  EXPECT_EQ(sample_writer.vector_double_values(),
+            other_writer.vector_double_values());
+}
+
+TEST_F(ServicesSmcHmcStaticDiagE, invalid_arguments) {
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::smc::smc_hmc_static_diag_e(
+                model, 1, 0, 1, 2, 0.5, 5, 0.5, 5, 0.65, 100, 1, interrupt,
+                logger, sample_writer));
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::smc::smc_hmc_static_diag_e(
+                model, 100, 0, 1, -2, 0.5, 5, 0.5, 5, 0.65, 100, 1, interrupt,
+                logger, sample_writer));
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            stan::services::smc::smc_hmc_static_diag_e(
+                model, 100, 0, 1, 2, 1, 5, 0.5, 5, 0.65, 100, 1, interrupt,
+                logger, sample_writer));
+  EXPECT_EQ(3, logger.call_count_error());
+  EXPECT_EQ(0, sample_writer.call_count("vector_double"));
+
+  // a reference far too narrow for the posterior needs many stages
+  EXPECT_EQ(stan::services::error_codes::SOFTWARE,
+            stan::services::smc::smc_hmc_static_diag_e(
+                model, 100, 0, 1, 0.01, 0.5, 1, 0.5, 1, 0.65, 2, 1, interrupt,
+                logger, sample_writer));
+  EXPECT_EQ(1, logger.find_error("did not reach inverse temperature 1"));
+}
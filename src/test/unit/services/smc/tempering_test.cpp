@@ -0,0 +1,48 @@
+#include <stan/services/smc/tempering.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using stan::services::smc::effective_sample_size;
+using stan::services::smc::next_inv_temperature;
+
+TEST(ServicesSmcTempering, effective_sample_size) {
+  Eigen::ArrayXd log_weights = Eigen::ArrayXd::Constant(10, -700);
+  EXPECT_FLOAT_EQ(10, effective_sample_size(log_weights));
+  log_weights(0) = -std::numeric_limits<double>::infinity();
+  log_weights(1) = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_FLOAT_EQ(8, effective_sample_size(log_weights));
+  // weights 1, 2 and 3
+  Eigen::ArrayXd three(3);
+  three << 0, std::log(2), std::log(3);
+  EXPECT_FLOAT_EQ(36.0 / 14, effective_sample_size(three));
+  EXPECT_EQ(0, effective_sample_size(Eigen::ArrayXd::Constant(
+                   3, -std::numeric_limits<double>::infinity())));
+}
+
+TEST(ServicesSmcTempering, next_inv_temperature) {
+  Eigen::ArrayXd log_ratios = Eigen::ArrayXd::LinSpaced(100, -50, 50);
+  const double next = next_inv_temperature(log_ratios, 0.25, 0.5);
+  ASSERT_GT(next, 0.25);
+  ASSERT_LT(next, 1);
+  EXPECT_NEAR(50, effective_sample_size((next - 0.25) * log_ratios), 1e-6);
+
+  // equal ratios never lose particles
+  EXPECT_EQ(1, next_inv_temperature(Eigen::ArrayXd::Constant(10, -3), 0.5,
+                                    0.5));
+  // particles outside the support do not count toward the target
+  log_ratios.head(50).setConstant(-std::numeric_limits<double>::infinity());
+  const double partial = next_inv_temperature(log_ratios, 0, 0.5);
+  Eigen::ArrayXd tail = log_ratios.tail(50);
+  EXPECT_NEAR(25, effective_sample_size(partial * tail), 1e-6);
+}
+
+TEST(ServicesSmcTempering, invalid_arguments) {
+  Eigen::ArrayXd log_ratios = Eigen::ArrayXd::Zero(5);
+  EXPECT_THROW(next_inv_temperature(log_ratios, 1, 0.5),
+               std::invalid_argument);
+  EXPECT_THROW(next_inv_temperature(log_ratios, 0, 1), std::invalid_argument);
+  log_ratios.setConstant(std::numeric_limits<double>::quiet_NaN());
+  EXPECT_THROW(next_inv_temperature(log_ratios, 0, 0.5), std::domain_error);
+}
@@ -0,0 +1,128 @@
+#include <stan/services/util/chain_communicator.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace {
+// a process among others whose values are fixed
+class fixed_communicator : public stan::services::util::chain_communicator {
+ public:
+  fixed_communicator(int rank, std::vector<std::vector<double>> others)
+      : rank_(rank), others_(std::move(others)) {}
+
+  int rank() const { return rank_; }
+
+  int size() const { return others_.size() + 1; }
+
+  std::vector<double> all_gather(const std::vector<double>& values) {
+    std::vector<double> all;
+    for (int r = 0; r < size(); ++r) {
+      const std::vector<double>& v
+          = r == rank_ ? values : others_[r < rank_ ? r : r - 1];
+      all.insert(all.end(), v.begin(), v.end());
+    }
+    return all;
+  }
+
+ private:
+  int rank_;
+  std::vector<std::vector<double>> others_;
+};
+
+// count, mean and sum of squared deviations of the columns of draws
+void moments(const Eigen::MatrixXd& draws, double& n, Eigen::VectorXd& mean,
+             Eigen::MatrixXd& m2) {
+  n = draws.cols();
+  mean = draws.rowwise().mean();
+  Eigen::MatrixXd centered = draws.colwise() - mean;
+  m2 = centered * centered.transpose();
+}
+
+std::vector<double> pack(double n, const Eigen::VectorXd& mean,
+                         const Eigen::MatrixXd& m2) {
+  std::vector<double> values{n};
+  values.insert(values.end(), mean.data(), mean.data() + mean.size());
+  values.insert(values.end(), m2.data(), m2.data() + m2.size());
+  return values;
+}
+}  // namespace
+
+TEST(ServicesUtilChainCommunicator, single_process) {
+  stan::services::util::chain_communicator communicator;
+  EXPECT_EQ(0, communicator.rank());
+  EXPECT_EQ(1, communicator.size());
+  EXPECT_EQ((std::vector<double>{1, 2}), communicator.all_gather({1, 2}));
+
+  double n = 3;
+  Eigen::VectorXd mean = Eigen::VectorXd::Ones(2);
+  Eigen::VectorXd m2 = Eigen::VectorXd::Constant(2, 4);
+  stan::services::util::combine_moments(communicator, n, mean, m2);
+  EXPECT_EQ(3, n);
+  EXPECT_TRUE(mean.isOnes());
+  EXPECT_TRUE(m2.isConstant(4));
+}
+
+TEST(ServicesUtilChainCommunicator, local_chains) {
+  using stan::services::util::local_chains;
+  using range = std::pair<size_t, size_t>;
+  EXPECT_EQ(range(0, 3), local_chains(10, 0, 4));
+  EXPECT_EQ(range(3, 3), local_chains(10, 1, 4));
+  EXPECT_EQ(range(6, 2), local_chains(10, 2, 4));
+  EXPECT_EQ(range(8, 2), local_chains(10, 3, 4));
+  EXPECT_EQ(range(4, 4), local_chains(8, 1, 2));
+  EXPECT_EQ(range(1, 0), local_chains(1, 1, 2));
+  EXPECT_THROW(local_chains(4, 2, 2), std::invalid_argument);
+  EXPECT_THROW(local_chains(4, 0, 0), std::invalid_argument);
+}
+
+TEST(ServicesUtilChainCommunicator, combine_moments) {
+  Eigen::MatrixXd draws(2, 12);
+  for (int j = 0; j < 12; ++j) {
+    draws(0, j) = j * j - 3.0;
+    draws(1, j) = 1.0 / (j + 1) + 0.5 * j;
+  }
+  double n_all;
+  Eigen::VectorXd mean_all;
+  Eigen::MatrixXd m2_all;
+  moments(draws, n_all, mean_all, m2_all);
+
+  // three processes with 5, 4 and 3 draws, this one the second
+  double n_0, n_2, n;
+  Eigen::VectorXd mean_0, mean_2, mean;
+  Eigen::MatrixXd m2_0, m2_2, m2;
+  moments(draws.leftCols(5), n_0, mean_0, m2_0);
+  moments(draws.middleCols(5, 4), n, mean, m2);
+  moments(draws.rightCols(3), n_2, mean_2, m2_2);
+  Eigen::VectorXd var_mean = mean;
+  Eigen::VectorXd var_m2 = m2.diagonal();
+  double var_n = n;
+
+  fixed_communicator covar_communicator(
+      1, {pack(n_0, mean_0, m2_0), pack(n_2, mean_2, m2_2)});
+  stan::services::util::combine_moments(covar_communicator, n, mean, m2);
+  EXPECT_EQ(12, n);
+  EXPECT_TRUE(mean.isApprox(mean_all));
+  EXPECT_TRUE(m2.isApprox(m2_all));
+
+  Eigen::VectorXd m2_0_diag = m2_0.diagonal();
+  Eigen::VectorXd m2_2_diag = m2_2.diagonal();
+  fixed_communicator var_communicator(
+      1, {pack(n_0, mean_0, m2_0_diag), pack(n_2, mean_2, m2_2_diag)});
+  stan::services::util::combine_moments(var_communicator, var_n, var_mean,
+                                        var_m2);
+  EXPECT_EQ(12, var_n);
+  EXPECT_TRUE(var_mean.isApprox(mean_all));
+  EXPECT_TRUE(var_m2.isApprox(m2_all.diagonal()));
+
+  // processes without draws are skipped
+  double n_empty = 0;
+  Eigen::VectorXd mean_empty = Eigen::VectorXd::Zero(2);
+  Eigen::MatrixXd m2_empty = Eigen::MatrixXd::Zero(2, 2);
+  fixed_communicator empty_communicator(0, {pack(n_all, mean_all, m2_all)});
+  stan::services::util::combine_moments(empty_communicator, n_empty,
+                                        mean_empty, m2_empty);
+  EXPECT_EQ(12, n_empty);
+  EXPECT_TRUE(mean_empty.isApprox(mean_all));
+  EXPECT_TRUE(m2_empty.isApprox(m2_all));
+}
@@ -0,0 +1,50 @@
+#include <stan/services/util/chain_placement.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using stan::services::util::chain_placement;
+
+TEST(ServicesUtilChainPlacement, splits_chains_across_nodes) {
+  chain_placement placement(5, 2, {-1, -1}, {8, 3});
+  EXPECT_EQ(5, placement.num_chains());
+  EXPECT_EQ(2, placement.num_nodes());
+  EXPECT_EQ(2, placement.threads_per_chain());
+  EXPECT_EQ(-1, placement.numa_id(1));
+  for (size_t i = 0; i < 3; ++i)
+    EXPECT_EQ(0, placement.node_of(i));
+  for (size_t i = 3; i < 5; ++i)
+    EXPECT_EQ(1, placement.node_of(i));
+
+  // the first node has more threads than its three chains use
+  EXPECT_EQ(6, placement.concurrency(0));
+  EXPECT_EQ(3, placement.num_slots(0));
+  // the second has too few for its two chains to run at once
+  EXPECT_EQ(3, placement.concurrency(1));
+  EXPECT_EQ(1, placement.num_slots(1));
+}
+
+TEST(ServicesUtilChainPlacement, executes_in_arena_of_chain) {
+  chain_placement placement(2, 1, {-1, -1}, {1, 1});
+  EXPECT_EQ(1, placement.execute(
+                   1, [] { return tbb::this_task_arena::max_concurrency(); }));
+  chain_placement machine(4, 1);
+  EXPECT_LE(1, machine.num_nodes());
+  int sum = 0;
+  for (size_t i = 0; i < 4; ++i)
+    machine.execute(i, [&] { sum += 1; });
+  EXPECT_EQ(4, sum);
+}
+
+TEST(ServicesUtilChainPlacement, max_concurrent_chains) {
+  EXPECT_LE(1, stan::services::util::max_concurrent_chains(1));
+  EXPECT_EQ(1, stan::services::util::max_concurrent_chains(1 << 20));
+}
+
+TEST(ServicesUtilChainPlacement, invalid_arguments) {
+  EXPECT_THROW(chain_placement(2, 0), std::invalid_argument);
+  EXPECT_THROW(chain_placement(2, 1, {}, {}), std::invalid_argument);
+  EXPECT_THROW(chain_placement(2, 1, {-1, -1}, {1}), std::invalid_argument);
+  EXPECT_THROW(chain_placement(2, 1, {-1}, {0}), std::invalid_argument);
+}
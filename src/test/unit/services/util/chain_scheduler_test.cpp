@@ -0,0 +1,138 @@
+#include <stan/services/util/chain_scheduler.hpp>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// a chain that records the order in which its blocks ran
+struct mock_chain {
+  mock_chain(size_t id, int num_iterations, std::atomic<int>* clock,
+             bool fail = false)
+      : iteration(0), clock(clock), fail(fail) {
+    p.chain_id = id;
+    p.num_iterations = num_iterations;
+  }
+
+  int run_block(int max_iterations) {
+    if (fail)
+      throw std::domain_error("mock chain failed");
+    int num = std::min(max_iterations, p.num_iterations - iteration);
+    iteration += num;
+    block_times.push_back((*clock)++);
+    block_sizes.push_back(num);
+    concurrencies.push_back(tbb::this_task_arena::max_concurrency());
+    p.iteration = iteration;
+    p.finished = iteration == p.num_iterations;
+    return num;
+  }
+
+  bool finished() const { return p.finished; }
+
+  stan::services::util::chain_progress progress() const { return p; }
+
+  int iteration;
+  std::atomic<int>* clock;
+  bool fail;
+  std::vector<int> block_times;
+  std::vector<int> block_sizes;
+  std::vector<int> concurrencies;
+  stan::services::util::chain_progress p;
+};
+
+}  // namespace
+
+TEST(ServicesUtilChainScheduler, runs_every_chain_in_blocks) {
+  std::atomic<int> clock(0);
+  std::vector<mock_chain> chains;
+  for (size_t i = 0; i < 5; ++i)
+    chains.emplace_back(i + 1, 100 + 10 * i, &clock);
+  stan::services::util::chain_scheduler scheduler(30);
+  int num_callbacks = 0;
+  scheduler.run(chains, [&](const stan::services::util::chain_progress& p) {
+    ++num_callbacks;
+    EXPECT_LE(p.iteration, p.num_iterations);
+  });
+
+  int num_blocks = 0;
+  for (size_t i = 0; i < chains.size(); ++i) {
+    EXPECT_TRUE(chains[i].finished());
+    EXPECT_EQ(100 + 10 * i, chains[i].iteration);
+    for (size_t j = 0; j + 1 < chains[i].block_sizes.size(); ++j)
+      EXPECT_EQ(30, chains[i].block_sizes[j]);
+    num_blocks += chains[i].block_sizes.size();
+  }
+  EXPECT_EQ(num_blocks, num_callbacks);
+
+  std::vector<stan::services::util::chain_progress> progress
+      = scheduler.progress();
+  ASSERT_EQ(5, progress.size());
+  for (size_t i = 0; i < progress.size(); ++i) {
+    EXPECT_EQ(i + 1, progress[i].chain_id);
+    EXPECT_TRUE(progress[i].finished);
+  }
+}
+
+TEST(ServicesUtilChainScheduler, priority_runs_first) {
+  // with one thread the blocks run one at a time in scheduling order
+  tbb::task_arena arena(1);
+  std::atomic<int> clock(0);
+  std::vector<mock_chain> chains;
+  for (size_t i = 0; i < 3; ++i)
+    chains.emplace_back(i + 1, 100, &clock);
+  stan::services::util::chain_scheduler scheduler(10);
+  scheduler.set_priority(2, 1);
+  EXPECT_EQ(1, scheduler.priority(2));
+  EXPECT_EQ(0, scheduler.priority(0));
+  arena.execute([&] { scheduler.run(chains); });
+
+  // the high priority chain runs to the end before the others start
+  EXPECT_EQ(10, chains[2].block_times.size());
+  EXPECT_EQ(9, chains[2].block_times.back());
+  // and the others advance in turn, the one furthest behind first
+  for (size_t j = 0; j < chains[0].block_times.size(); ++j) {
+    EXPECT_EQ(10 + 2 * j, chains[0].block_times[j]);
+    EXPECT_EQ(11 + 2 * j, chains[1].block_times[j]);
+  }
+}
+
+TEST(ServicesUtilChainScheduler, runs_chains_in_arena_of_their_node) {
+  std::atomic<int> clock(0);
+  std::vector<mock_chain> chains;
+  for (size_t i = 0; i < 4; ++i)
+    chains.emplace_back(i + 1, 100, &clock);
+  // two nodes told apart by the number of threads of their arenas
+  stan::services::util::chain_placement placement(4, 1, {-1, -1}, {1, 2});
+  stan::services::util::chain_scheduler scheduler(10);
+  scheduler.set_placement(&placement);
+  EXPECT_EQ(&placement, scheduler.placement());
+  scheduler.run(chains);
+
+  for (size_t i = 0; i < chains.size(); ++i) {
+    EXPECT_TRUE(chains[i].finished());
+    for (int concurrency : chains[i].concurrencies)
+      EXPECT_EQ(i < 2 ? 1 : 2, concurrency);
+  }
+
+  std::vector<mock_chain> too_many;
+  for (size_t i = 0; i < 5; ++i)
+    too_many.emplace_back(i + 1, 100, &clock);
+  EXPECT_THROW(scheduler.run(too_many), std::invalid_argument);
+}
+
+TEST(ServicesUtilChainScheduler, rethrows_failure) {
+  std::atomic<int> clock(0);
+  std::vector<mock_chain> chains;
+  chains.emplace_back(1, 100, &clock);
+  chains.emplace_back(2, 100, &clock, true);
+  stan::services::util::chain_scheduler scheduler(10);
+  EXPECT_THROW(scheduler.run(chains), std::domain_error);
+  EXPECT_FALSE(chains[1].finished());
+}
+
+TEST(ServicesUtilChainScheduler, block_size_must_be_positive) {
+  EXPECT_THROW(stan::services::util::chain_scheduler(0),
+               std::invalid_argument);
+}
@@ -28,3 +28,23 @@ TEST(rng, initialize_with_zero) {
   rng2();
   EXPECT_NE(rng1, rng2);
 }
+
+TEST(rng, initialize_task_stream) {
+  stan::rng_t rng1 = stan::services::util::create_rng(0, 1, 5, 3);
+  stan::rng_t rng2 = stan::services::util::create_rng(0, 1, 5, 3);
+  EXPECT_EQ(rng1, rng2);
+
+  EXPECT_NE(rng1, stan::services::util::create_rng(0, 1));
+  EXPECT_NE(rng1, stan::services::util::create_rng(0, 1, 5, 4));
+  EXPECT_NE(rng1, stan::services::util::create_rng(0, 1, 6, 3));
+  EXPECT_NE(rng1, stan::services::util::create_rng(0, 2, 5, 3));
+  EXPECT_NE(rng1, stan::services::util::create_rng(1, 1, 5, 3));
+  EXPECT_NE(stan::services::util::create_rng(0, 1, 0, 0),
+            stan::services::util::create_rng(0, 1));
+}
+
+TEST(rng, task_stream_iteration_range) {
+  EXPECT_NO_THROW(stan::services::util::create_rng(0, 1, 0x7fffffffu, 0));
+  EXPECT_THROW(stan::services::util::create_rng(0, 1, 0x80000000u, 0),
+               std::invalid_argument);
+}
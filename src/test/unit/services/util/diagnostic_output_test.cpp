@@ -0,0 +1,92 @@
+#include <stan/services/util/diagnostic_output.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+std::vector<std::string> full_names() {
+  return {"lp__",    "accept_stat__", "energy__", "mu",     "theta.1",
+          "theta.2", "p_mu",          "p_theta.1", "p_theta.2", "g_mu",
+          "g_theta.1", "g_theta.2",   "extra__"};
+}
+
+std::vector<double> full_values() {
+  return {-1, 0.9, 5, 1, 2, 3, 0, 3, 4, 1, 2, 2, 7};
+}
+
+const std::vector<std::string> param_names{"mu", "theta.1", "theta.2"};
+}  // namespace
+
+TEST(ServicesUtilDiagnosticOutput, defaults_write_everything) {
+  stan::services::util::diagnostic_output diagnostics;
+  EXPECT_EQ(1, diagnostics.thin());
+  EXPECT_FALSE(diagnostics.summary_only());
+  std::vector<std::string> names = full_names();
+  stan::services::util::diagnostic_columns columns
+      = diagnostics.select(names, 3, param_names);
+  EXPECT_EQ(full_names(), names);
+  std::vector<double> values;
+  columns.apply(full_values(), values);
+  EXPECT_EQ(full_values(), values);
+}
+
+TEST(ServicesUtilDiagnosticOutput, coordinates) {
+  stan::services::util::diagnostic_output diagnostics;
+  diagnostics.set_coordinates({"theta"});
+  std::vector<std::string> names = full_names();
+  stan::services::util::diagnostic_columns columns
+      = diagnostics.select(names, 3, param_names);
+  std::vector<std::string> expected_names{
+      "lp__",      "accept_stat__", "energy__",  "theta.1", "theta.2",
+      "p_theta.1", "p_theta.2",     "g_theta.1", "g_theta.2", "extra__"};
+  EXPECT_EQ(expected_names, names);
+  std::vector<double> values;
+  columns.apply(full_values(), values);
+  std::vector<double> expected_values{-1, 0.9, 5, 2, 3, 3, 4, 2, 2, 7};
+  EXPECT_EQ(expected_values, values);
+
+  diagnostics.set_coordinates({"mu", "theta.2"});
+  names = full_names();
+  diagnostics.select(names, 3, param_names);
+  EXPECT_EQ(3 + 6 + 1, names.size());
+  EXPECT_EQ("g_theta.2", names[8]);
+}
+
+TEST(ServicesUtilDiagnosticOutput, summary_only) {
+  stan::services::util::diagnostic_output diagnostics;
+  diagnostics.set_summary_only(true);
+  std::vector<std::string> names = full_names();
+  stan::services::util::diagnostic_columns columns
+      = diagnostics.select(names, 3, param_names);
+  std::vector<std::string> expected_names{"lp__",     "accept_stat__",
+                                          "energy__", "extra__",
+                                          "p_norm__", "g_norm__"};
+  EXPECT_EQ(expected_names, names);
+  std::vector<double> values;
+  columns.apply(full_values(), values);
+  ASSERT_EQ(6, values.size());
+  EXPECT_FLOAT_EQ(7, values[3]);
+  EXPECT_FLOAT_EQ(5, values[4]);
+  EXPECT_FLOAT_EQ(3, values[5]);
+}
+
+TEST(ServicesUtilDiagnosticOutput, sampler_without_point) {
+  stan::services::util::diagnostic_output diagnostics;
+  diagnostics.set_summary_only(true);
+  std::vector<std::string> names{"lp__", "accept_stat__"};
+  stan::services::util::diagnostic_columns columns
+      = diagnostics.select(names, 2, param_names);
+  EXPECT_EQ(2, names.size());
+  std::vector<double> values;
+  columns.apply({-1, 1}, values);
+  EXPECT_EQ((std::vector<double>{-1, 1}), values);
+}
+
+TEST(ServicesUtilDiagnosticOutput, invalid_thin) {
+  stan::services::util::diagnostic_output diagnostics;
+  EXPECT_THROW(diagnostics.set_thin(0), std::invalid_argument);
+  diagnostics.set_thin(10);
+  EXPECT_EQ(10, diagnostics.thin());
+}
@@ -1,4 +1,6 @@
 #include <stan/services/util/generate_transitions.hpp>
+#include <stan/callbacks/progress_instrumentation.hpp>
+#include <stan/callbacks/summary_instrumentation.hpp>
 #include <stan/services/sample/fixed_param.hpp>
 #include <stan/services/util/initialize.hpp>
 #include <stan/services/util/create_rng.hpp>
@@ -128,3 +130,140 @@ TEST_F(ServicesSamplesGenerateTransitions, output_sizes) {
   EXPECT_EQ(parameter_names[0].size(), parameter_values[0].size());
   EXPECT_EQ(diagnostic_names[0].size(), diagnostic_values[0].size());
 }
+
+TEST_F(ServicesSamplesGenerateTransitions, instrumentation) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int refresh = 0;
+  int num_iterations = 10;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::callbacks::summary_instrumentation summary;
+
+  stan::rng_t rng = stan::services::util::create_rng(seed, chain);
+
+  std::vector<double> cont_vector = stan::services::util::initialize(
+      model, context, rng, init_radius, false, logger, diagnostic);
+
+  stan::mcmc::fixed_param_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  Eigen::VectorXd cont_params(cont_vector.size());
+  for (size_t i = 0; i < cont_vector.size(); i++)
+    cont_params[i] = cont_vector[i];
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  stan::services::util::generate_transitions(
+      sampler, num_iterations, 5, 20, 2, refresh, true, false, writer, s,
+      model, rng, interrupt, logger, 1, 1, 0, &summary);
+
+  EXPECT_EQ(0, summary.warmup().num_transitions);
+  EXPECT_EQ(num_iterations, summary.sampling().num_transitions);
+  EXPECT_EQ(0, summary.sampling().num_gradients);
+  EXPECT_GE(summary.sampling().transition_time, 0);
+  EXPECT_GE(summary.sampling().write_time, 0);
+  EXPECT_GE(summary.sampling().slowest_iteration, 6);
+  EXPECT_LE(summary.sampling().slowest_iteration, 15);
+  EXPECT_EQ(parameter.call_count("vector_double"), num_iterations / 2);
+}
+
+TEST_F(ServicesSamplesGenerateTransitions, progress_instrumentation) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::callbacks::progress_instrumentation progress(4);
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  std::vector<double> cont_vector = stan::services::util::initialize(
+      model, context, rng, 0, false, logger, diagnostic);
+
+  stan::mcmc::fixed_param_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  Eigen::VectorXd cont_params(cont_vector.size());
+  for (size_t i = 0; i < cont_vector.size(); i++)
+    cont_params[i] = cont_vector[i];
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  stan::services::util::generate_transitions(
+      sampler, 10, 5, 20, 1, 0, true, false, writer, s, model, rng,
+      interrupt, logger, 1, 1, 0, &progress);
+
+  // the fixed parameter sampler reports no leapfrog steps or tree depths
+  EXPECT_EQ(13, progress.last().iteration);
+  EXPECT_EQ(20, progress.last().num_iterations);
+  EXPECT_FLOAT_EQ(0, progress.last().leapfrogs_per_second);
+  EXPECT_TRUE(progress.last().tree_depths.empty());
+}
+
+namespace {
+class stopping_interrupt : public stan::callbacks::interrupt {
+ public:
+  explicit stopping_interrupt(int num_calls) : num_calls_(num_calls) {}
+  void operator()() { --num_calls_; }
+  bool stop_requested() const { return num_calls_ < 0; }
+
+ private:
+  int num_calls_;
+};
+}  // namespace
+
+TEST_F(ServicesSamplesGenerateTransitions, stop_requested) {
+  unsigned int seed = 0;
+  unsigned int chain = 1;
+  double init_radius = 0;
+  int refresh = 0;
+  int num_iterations = 10;
+  stopping_interrupt interrupt(4);
+
+  stan::rng_t rng = stan::services::util::create_rng(seed, chain);
+
+  std::vector<double> cont_vector = stan::services::util::initialize(
+      model, context, rng, init_radius, false, logger, diagnostic);
+
+  stan::mcmc::fixed_param_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  Eigen::VectorXd cont_params(cont_vector.size());
+  for (size_t i = 0; i < cont_vector.size(); i++)
+    cont_params[i] = cont_vector[i];
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  int num_generated = stan::services::util::generate_transitions(
+      sampler, num_iterations, 0, 20, 1, refresh, true, false, writer, s,
+      model, rng, interrupt, logger);
+
+  EXPECT_EQ(4, num_generated);
+  EXPECT_EQ(parameter.call_count("vector_double"), 4);
+}
+
+namespace {
+class summary_counting_sampler : public stan::mcmc::fixed_param_sampler {
+ public:
+  void write_rejection_summary(stan::callbacks::logger& logger) {
+    ++num_summaries;
+  }
+  int num_summaries = 0;
+};
+}  // namespace
+
+TEST_F(ServicesSamplesGenerateTransitions, rejection_summary_per_phase) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  std::vector<double> cont_vector = stan::services::util::initialize(
+      model, context, rng, 0, false, logger, diagnostic);
+
+  summary_counting_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  Eigen::VectorXd cont_params(cont_vector.size());
+  for (size_t i = 0; i < cont_vector.size(); i++)
+    cont_params[i] = cont_vector[i];
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  stan::services::util::generate_transitions(sampler, 10, 0, 20, 1, 0, true,
+                                             false, writer, s, model, rng,
+                                             interrupt, logger);
+  EXPECT_EQ(1, sampler.num_summaries);
+
+  // a phase generated one transition at a time leaves the summary to its
+  // caller
+  for (int m = 10; m < 20; ++m)
+    stan::services::util::generate_transitions(
+        sampler, 1, m, 20, 1, 0, true, false, writer, s, model, rng,
+        interrupt, logger, 1, 1, m - 10, nullptr, false);
+  EXPECT_EQ(1, sampler.num_summaries);
+}
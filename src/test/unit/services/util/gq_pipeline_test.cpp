@@ -0,0 +1,78 @@
+#include <stan/services/util/gq_pipeline.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+// computes the square of the first value, the later draws of a round of
+// four the fastest, so that they are computed out of order
+void square(stan::services::util::gq_draw& draw, size_t index) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(4 - index % 4));
+  draw.model_values
+      = Eigen::VectorXd::Constant(1, draw.values[0] * draw.values[0]);
+}
+}  // namespace
+
+TEST(ServicesUtilGqPipeline, finishes_in_order) {
+  std::vector<double> written;
+  std::atomic<int> num_finishing{0};
+  bool concurrent = false;
+  {
+    stan::services::util::gq_pipeline pipeline(
+        square,
+        [&](stan::services::util::gq_draw& draw) {
+          concurrent |= ++num_finishing > 1;
+          written.push_back(draw.model_values(0));
+          --num_finishing;
+        },
+        4, 3);
+    for (int n = 0; n < 25; ++n) {
+      stan::services::util::gq_draw& draw = pipeline.next();
+      draw.values.assign(1, n);
+      pipeline.push();
+    }
+    EXPECT_EQ(25U, pipeline.num_draws());
+    pipeline.wait();
+    EXPECT_EQ(25U, written.size());
+    for (int n = 25; n < 30; ++n) {
+      pipeline.next().values.assign(1, n);
+      pipeline.push();
+    }
+  }
+  // the destructor finished the last draws
+  ASSERT_EQ(30U, written.size());
+  for (int n = 0; n < 30; ++n)
+    EXPECT_EQ(n * n, written[n]);
+  EXPECT_FALSE(concurrent);
+}
+
+TEST(ServicesUtilGqPipeline, rethrows_to_the_producer) {
+  std::vector<double> written;
+  stan::services::util::gq_pipeline pipeline(
+      square,
+      [&](stan::services::util::gq_draw& draw) {
+        if (draw.values[0] == 2)
+          throw std::runtime_error("writer failed");
+        written.push_back(draw.values[0]);
+      },
+      2, 8);
+  for (int n = 0; n < 6; ++n) {
+    pipeline.next().values.assign(1, n);
+    pipeline.push();
+  }
+  EXPECT_THROW(pipeline.wait(), std::runtime_error);
+  // the draws after the failed one were dropped
+  EXPECT_EQ((std::vector<double>{0, 1}), written);
+  pipeline.wait();
+}
+
+TEST(ServicesUtilGqPipeline, throws_on_bad_sizes) {
+  auto finish = [](stan::services::util::gq_draw& draw) {};
+  EXPECT_THROW(stan::services::util::gq_pipeline(square, finish, 0, 1),
+               std::invalid_argument);
+  EXPECT_THROW(stan::services::util::gq_pipeline(square, finish, 1, 0),
+               std::invalid_argument);
+}
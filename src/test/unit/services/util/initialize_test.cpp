@@ -166,6 +166,40 @@ TEST_F(ServicesUtilInitialize, full_init__print_true) {
   EXPECT_EQ(params[1], init.vector_double_values()[0][1]);
 }
 
+TEST_F(ServicesUtilInitialize, radius_two__concurrent_tries) {
+  double log_prob = 0;
+  std::vector<double> gradient;
+  std::vector<double> params = stan::services::util::initialize(
+      model, empty_context, rng, 2, false, logger, init, 4, &log_prob,
+      &gradient);
+  ASSERT_EQ(model.num_params_r(), params.size()) << "2 parameters";
+  for (double x : params) {
+    EXPECT_GT(x, -2);
+    EXPECT_LT(x, 2);
+  }
+  EXPECT_EQ(0, logger.call_count());
+  ASSERT_EQ(1, init.vector_double_values().size());
+  EXPECT_EQ(params, init.vector_double_values()[0]);
+
+  // the log density and gradient are those at the returned values
+  std::vector<int> disc_vector;
+  std::vector<double> expected_gradient;
+  double expected_log_prob = stan::model::log_prob_grad<true, true>(
+      model, params, disc_vector, expected_gradient);
+  EXPECT_FLOAT_EQ(expected_log_prob, log_prob);
+  ASSERT_EQ(expected_gradient.size(), gradient.size());
+  for (size_t n = 0; n < gradient.size(); ++n)
+    EXPECT_FLOAT_EQ(expected_gradient[n], gradient[n]);
+
+  // the values of a batch are drawn in order, so the first valid one is
+  // that of attempts one at a time
+  stan::rng_t rng_again = stan::services::util::create_rng(0, 1);
+  stan::test::unit::instrumented_writer init_again;
+  EXPECT_EQ(params,
+            stan::services::util::initialize(model, empty_context, rng_again,
+                                             2, false, logger, init_again));
+}
+
 namespace test {
 // Mock Throwing Model throws exception
 class mock_throwing_model : public stan::model::prob_grad {
@@ -279,6 +313,19 @@ TEST_F(ServicesUtilInitialize, model_throws__radius_two) {
   EXPECT_EQ(100, logger.find_warn("throwing within log_prob"));
 }
 
+TEST_F(ServicesUtilInitialize, model_throws__radius_two__concurrent_tries) {
+  test::mock_throwing_model throwing_model;
+
+  EXPECT_THROW(stan::services::util::initialize(
+                   throwing_model, empty_context, rng, 2, false, logger, init,
+                   8),
+               std::domain_error);
+  // the messages of every attempt are passed on, as with one at a time
+  EXPECT_EQ(303, logger.call_count());
+  EXPECT_EQ(300, logger.call_count_warn());
+  EXPECT_EQ(100, logger.find_warn("throwing within log_prob"));
+}
+
 TEST_F(ServicesUtilInitialize, model_throws__full_init) {
   std::vector<std::string> names_r;
   std::vector<double> values_r;
@@ -304,6 +351,40 @@ TEST_F(ServicesUtilInitialize, model_throws__full_init) {
   EXPECT_EQ(100, logger.find_warn("throwing within log_prob"));
 }
 
+TEST_F(ServicesUtilInitialize, radius_two__concurrent_tries) {
+  double log_prob = 0;
+  std::vector<double> gradient;
+  std::vector<double> params = stan::services::util::initialize(
+      model, empty_context, rng, 2, false, logger, init, 4, &log_prob,
+      &gradient);
+  ASSERT_EQ(model.num_params_r(), params.size()) << "2 parameters";
+  for (double x : params) {
+    EXPECT_GT(x, -2);
+    EXPECT_LT(x, 2);
+  }
+  EXPECT_EQ(0, logger.call_count());
+  ASSERT_EQ(1, init.vector_double_values().size());
+  EXPECT_EQ(params, init.vector_double_values()[0]);
+
+  // the log density and gradient are those at the returned values
+  std::vector<int> disc_vector;
+  std::vector<double> expected_gradient;
+  double expected_log_prob = stan::model::log_prob_grad<true, true>(
+      model, params, disc_vector, expected_gradient);
+  EXPECT_FLOAT_EQ(expected_log_prob, log_prob);
+  ASSERT_EQ(expected_gradient.size(), gradient.size());
+  for (size_t n = 0; n < gradient.size(); ++n)
+    EXPECT_FLOAT_EQ(expected_gradient[n], gradient[n]);
+
+  // the values of a batch are drawn in order, so the first valid one is
+  // that of attempts one at a time
+  stan::rng_t rng_again = stan::services::util::create_rng(0, 1);
+  stan::test::unit::instrumented_writer init_again;
+  EXPECT_EQ(params,
+            stan::services::util::initialize(model, empty_context, rng_again,
+                                             2, false, logger, init_again));
+}
+
 namespace test {
 // Mock Throwing Model throws exception
 class mock_error_model : public stan::model::prob_grad {
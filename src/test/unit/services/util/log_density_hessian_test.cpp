@@ -0,0 +1,60 @@
+#include <stan/services/util/log_density_hessian.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// log density -(x0 - x1)^2 / 2 - x1^2, which prints, with a Jacobian
+// term x1 and an infinite curvature at x0 = 1
+struct printing_model {
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& x, std::ostream* msgs = 0) const {
+    if (msgs)
+      *msgs << "x0 = " << x(0);
+    T lp = -0.5 * (x(0) - x(1)) * (x(0) - x(1)) - x(1) * x(1);
+    if (jacobian)
+      lp += x(1);
+    if (x(0) == 1)
+      lp -= x(0) * x(0) * std::numeric_limits<double>::infinity();
+    return lp;
+  }
+};
+}  // namespace
+
+TEST(ServicesUtilLogDensityHessian, exact_hessian) {
+  printing_model model;
+  stan::test::unit::instrumented_logger logger;
+  Eigen::VectorXd theta(2);
+  theta << 0.5, -1;
+  double log_p;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hessian;
+  stan::services::util::log_density_hessian<true>(model, theta, log_p, grad,
+                                                  hessian, logger, 1);
+  EXPECT_FLOAT_EQ(-0.5 * 2.25 - 1 - 1, log_p);
+  ASSERT_EQ(2, grad.size());
+  EXPECT_FLOAT_EQ(-1.5, grad(0));
+  EXPECT_FLOAT_EQ(1.5 + 2 + 1, grad(1));
+  ASSERT_EQ(2, hessian.rows());
+  ASSERT_EQ(2, hessian.cols());
+  EXPECT_NEAR(-1, hessian(0, 0), 1e-8);
+  EXPECT_NEAR(1, hessian(0, 1), 1e-8);
+  EXPECT_NEAR(1, hessian(1, 0), 1e-8);
+  EXPECT_NEAR(-3, hessian(1, 1), 1e-8);
+  EXPECT_EQ(1, logger.find_info("x0 = 0.5"));
+}
+
+TEST(ServicesUtilLogDensityHessian, throws_if_not_finite) {
+  printing_model model;
+  stan::test::unit::instrumented_logger logger;
+  Eigen::VectorXd theta(2);
+  theta << 1, 0;
+  double log_p;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hessian;
+  EXPECT_THROW(stan::services::util::log_density_hessian<false>(
+                   model, theta, log_p, grad, hessian, logger),
+               std::domain_error);
+}
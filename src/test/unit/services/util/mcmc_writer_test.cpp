@@ -4,9 +4,11 @@
 #include <test/unit/services/instrumented_callbacks.hpp>
 #include <test/test-models/good/services/test_lp.hpp>
 #include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/stream_writer.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/io/empty_var_context.hpp>
 #include <stan/services/util/create_rng.hpp>
+#include <stan/services/util/output_selection.hpp>
 
 namespace test {
 // mock_throwing_model_in_write_array throws exception in the write_array()
@@ -259,6 +261,77 @@ TEST_F(ServicesUtil, write_sample_params) {
   EXPECT_EQ(0, logger.call_count());
 }
 
+TEST_F(ServicesUtil, write_sample_params_repeated) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+
+  mcmc_writer.write_sample_names(sample, sampler, model);
+  for (int n = 0; n < 3; ++n)
+    mcmc_writer.write_sample_params(rng, sample, sampler, model);
+  EXPECT_EQ(3, sample_writer.call_count("vector_double"));
+  EXPECT_EQ(0, logger.call_count());
+
+  std::vector<std::vector<double>> values
+      = sample_writer.vector_double_values();
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(mcmc_writer.num_sample_params_ + mcmc_writer.num_sampler_params_
+                + mcmc_writer.num_model_params_,
+            values[0].size());
+  EXPECT_EQ(values[0].size(), values[1].size());
+  EXPECT_EQ(values[0].size(), values[2].size());
+}
+
+TEST_F(ServicesUtil, write_sample_params_pipelined) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+
+  mcmc_writer.write_sample_names(sample, sampler, model);
+  mcmc_writer.start_gq_pipeline(model, rng, 1, 3, 2);
+  for (int n = 0; n < 20; ++n) {
+    stan::mcmc::sample draw(x, n, 2);
+    mcmc_writer.write_sample_params(rng, draw, sampler, model);
+  }
+  // the draws are written before anything else
+  mcmc_writer.write_adapt_finish(sampler);
+  EXPECT_EQ(20, sample_writer.call_count("vector_double"));
+  EXPECT_EQ(1, sample_writer.call_count("string"));
+  EXPECT_EQ(0, logger.call_count());
+
+  std::vector<std::vector<double>> values
+      = sample_writer.vector_double_values();
+  ASSERT_EQ(20, values.size());
+  for (int n = 0; n < 20; ++n) {
+    EXPECT_EQ(n, values[n][0]);
+    EXPECT_EQ(mcmc_writer.num_sample_params_ + mcmc_writer.num_sampler_params_
+                  + mcmc_writer.num_model_params_,
+              values[n].size());
+  }
+  mcmc_writer.stop_gq_pipeline();
+  mcmc_writer.write_sample_params(rng, sample, sampler, model);
+  EXPECT_EQ(21, sample_writer.call_count("vector_double"));
+}
+
+TEST_F(ServicesUtil, throwing_model__write_sample_parameters_pipelined) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+
+  mcmc_writer.write_sample_names(sample, sampler, throwing_model);
+  mcmc_writer.start_gq_pipeline(throwing_model, rng, 1, 2);
+  for (int n = 0; n < 4; ++n)
+    mcmc_writer.write_sample_params(rng, sample, sampler, throwing_model);
+  mcmc_writer.wait_for_draws();
+  EXPECT_EQ(4, sample_writer.call_count("vector_double"));
+  EXPECT_EQ(4, logger.find_info("throwing within write_array"));
+  for (const std::vector<double>& draw : sample_writer.vector_double_values())
+    EXPECT_TRUE(std::isnan(draw.back()));
+}
+
 TEST_F(ServicesUtil, write_adapt_finish) {
   mock_sampler sampler;
 
@@ -293,6 +366,24 @@ TEST_F(ServicesUtil, write_diagnostic_params) {
   EXPECT_EQ(0, logger.call_count());
 }
 
+TEST_F(ServicesUtil, write_diagnostic_params_thinned) {
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+  stan::services::util::diagnostic_output diagnostics;
+  diagnostics.set_thin(3);
+  stan::services::util::mcmc_writer writer(sample_writer, diagnostic_writer,
+                                           logger, nullptr, &diagnostics);
+
+  writer.write_diagnostic_names(sample, sampler, model);
+  for (int i = 0; i < 7; ++i)
+    writer.write_diagnostic_params(sample, sampler);
+  EXPECT_EQ(0, sample_writer.call_count());
+  EXPECT_EQ(1, diagnostic_writer.call_count("vector_string"));
+  EXPECT_EQ(3, diagnostic_writer.call_count("vector_double"));
+  EXPECT_EQ(3, sampler.n_get_sampler_diagnostics);
+}
+
 TEST_F(ServicesUtil, internal_write_timing) {
   stan::test::unit::instrumented_writer writer;
   mcmc_writer.write_timing(0, 0, writer);
@@ -347,3 +438,178 @@ TEST_F(ServicesUtil, throwing_model__write_sample_parameters) {
     EXPECT_TRUE(std::isnan(values[0][i]));
   }
 }
+
+namespace test {
+// writes y.1, y.2, z.1 and xgq as 1, 2, 3 and 4, leaving out the
+// transformed parameter z.1 or the generated quantity xgq as asked, and
+// records what it was asked for
+struct selective_model {
+  mutable bool include_tparams = true;
+  mutable bool include_gqs = true;
+
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names.insert(names.end(), {"y.1", "y.2"});
+    if (include_tparams)
+      names.push_back("z.1");
+    if (include_gqs)
+      names.push_back("xgq");
+  }
+
+  void get_param_names(std::vector<std::string>& names,
+                       bool include_tparams = true,
+                       bool include_gqs = true) const {
+    names = {"y"};
+    if (include_tparams)
+      names.push_back("z");
+    if (include_gqs)
+      names.push_back("xgq");
+  }
+
+  void get_dims(std::vector<std::vector<size_t>>& dims,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dims = {{2}};
+    if (include_tparams)
+      dims.push_back({1});
+    if (include_gqs)
+      dims.push_back({});
+  }
+
+  template <typename RNG>
+  void write_array(RNG& base_rng, Eigen::VectorXd& params_r,
+                   Eigen::VectorXd& vars, bool include_tparams = true,
+                   bool include_gqs = true, std::ostream* pstream = 0) const {
+    this->include_tparams = include_tparams;
+    this->include_gqs = include_gqs;
+    std::vector<double> values{1, 2};
+    if (include_tparams)
+      values.push_back(3);
+    if (include_gqs)
+      values.push_back(4);
+    vars = Eigen::Map<Eigen::VectorXd>(values.data(), values.size());
+  }
+};
+}  // namespace test
+
+TEST_F(ServicesUtil, write_selected_sample_params) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+  test::selective_model selective;
+  stan::services::util::output_selection selection({"xgq", "y.2"});
+  stan::services::util::mcmc_writer writer(sample_writer, diagnostic_writer,
+                                           logger, &selection);
+
+  writer.write_sample_names(sample, sampler, selective);
+  writer.write_sample_params(rng, sample, sampler, selective);
+  EXPECT_FALSE(selective.include_tparams);
+  EXPECT_TRUE(selective.include_gqs);
+  EXPECT_EQ(2, writer.num_model_params_);
+
+  std::vector<std::string> names = sample_writer.vector_string_values()[0];
+  ASSERT_EQ(writer.num_sample_params_ + 2, names.size());
+  EXPECT_EQ("y.2", names[names.size() - 2]);
+  EXPECT_EQ("xgq", names.back());
+  std::vector<double> values = sample_writer.vector_double_values()[0];
+  ASSERT_EQ(names.size(), values.size());
+  EXPECT_EQ(2, values[values.size() - 2]);
+  EXPECT_EQ(4, values.back());
+}
+
+TEST_F(ServicesUtil, write_unselected_sample_params) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+  test::selective_model selective;
+  stan::services::util::mcmc_writer writer(sample_writer, diagnostic_writer,
+                                           logger);
+
+  writer.write_sample_names(sample, sampler, selective);
+  writer.write_sample_params(rng, sample, sampler, selective);
+  EXPECT_TRUE(selective.include_tparams);
+  EXPECT_TRUE(selective.include_gqs);
+  std::vector<double> values = sample_writer.vector_double_values()[0];
+  ASSERT_EQ(writer.num_sample_params_ + 4, values.size());
+  EXPECT_EQ(3, values[values.size() - 2]);
+}
+
+namespace test {
+class schema_writer : public stan::callbacks::writer {
+ public:
+  using stan::callbacks::writer::operator();
+  bool accepts_schema() const { return true; }
+  void operator()(const std::vector<std::string>& names) { ++num_names; }
+  void operator()(const stan::callbacks::output_schema& schema) {
+    this->schema = schema;
+  }
+  void operator()(const std::vector<double>& state) { values = state; }
+  int num_names = 0;
+  stan::callbacks::output_schema schema;
+  std::vector<double> values;
+};
+}  // namespace test
+
+TEST_F(ServicesUtil, write_sample_schema) {
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+  test::selective_model selective;
+  test::schema_writer schema_writer;
+  stan::services::util::mcmc_writer writer(schema_writer, diagnostic_writer,
+                                           logger);
+
+  writer.write_sample_names(sample, sampler, selective);
+  EXPECT_EQ(0, schema_writer.num_names);
+  std::vector<std::string> names;
+  schema_writer.schema.flatten(names);
+  ASSERT_EQ(writer.num_sample_params_ + writer.num_sampler_params_ + 4,
+            names.size());
+  EXPECT_EQ("lp__", names[0]);
+  EXPECT_EQ("y.1", names[names.size() - 4]);
+  EXPECT_EQ("z.1", names[names.size() - 2]);
+  EXPECT_EQ("xgq", names.back());
+  EXPECT_EQ(4, writer.num_model_params_);
+
+  writer.write_sample_params(rng, sample, sampler, selective);
+  EXPECT_EQ(names.size(), schema_writer.values.size());
+  EXPECT_EQ(4, schema_writer.values.back());
+}
+
+TEST_F(ServicesUtil, write_single_precision_columns) {
+  using stan::callbacks::value_precision;
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(2);
+  stan::mcmc::sample sample(x, 1, 2);
+  mock_sampler sampler;
+  test::selective_model selective;
+  stan::services::util::output_selection selection;
+  selection.set_float32({"xgq", "lp__"});
+
+  test::schema_writer schema_writer;
+  stan::services::util::mcmc_writer writer(schema_writer, diagnostic_writer,
+                                           logger, &selection);
+  writer.write_sample_names(sample, sampler, selective);
+  const auto& variables = schema_writer.schema.variables();
+  EXPECT_EQ(value_precision::float64, variables.front().precision);
+  EXPECT_EQ("xgq", variables.back().name);
+  EXPECT_EQ(value_precision::float32, variables.back().precision);
+
+  // other writers get a scalar per column, named as without precisions
+  stan::test::unit::instrumented_writer names_writer;
+  stan::services::util::mcmc_writer names_mcmc_writer(
+      names_writer, diagnostic_writer, logger);
+  names_mcmc_writer.write_sample_names(sample, sampler, selective);
+  std::stringstream ss;
+  stan::callbacks::stream_writer stream(ss);
+  stan::services::util::mcmc_writer stream_mcmc_writer(
+      stream, diagnostic_writer, logger, &selection);
+  stream_mcmc_writer.write_sample_names(sample, sampler, selective);
+  std::vector<std::string> names = names_writer.vector_string_values()[0];
+  std::string header;
+  for (size_t i = 0; i < names.size(); ++i)
+    header += (i > 0 ? "," : "") + names[i];
+  EXPECT_EQ(header + "\n", ss.str());
+}
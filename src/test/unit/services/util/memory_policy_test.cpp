@@ -0,0 +1,57 @@
+#include <stan/services/util/memory_policy.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+using stan::services::util::memory_policy;
+
+TEST(ServicesUtilMemoryPolicy, set_and_get) {
+  memory_policy dflt = stan::services::util::get_memory_policy();
+  EXPECT_EQ(0u, dflt.ad_arena_bytes);
+  EXPECT_FALSE(dflt.huge_pages);
+  EXPECT_TRUE(dflt.first_touch);
+
+  memory_policy policy;
+  policy.ad_arena_bytes = 1 << 20;
+  policy.huge_pages = true;
+  stan::services::util::set_memory_policy(policy);
+  EXPECT_EQ(1u << 20, stan::services::util::get_memory_policy().ad_arena_bytes);
+  EXPECT_TRUE(stan::services::util::get_memory_policy().huge_pages);
+  stan::services::util::set_memory_policy(dflt);
+  EXPECT_EQ(0u, stan::services::util::get_memory_policy().ad_arena_bytes);
+}
+
+TEST(ServicesUtilMemoryPolicy, advise_huge_pages_short_ranges) {
+  std::vector<double> x(100);
+  EXPECT_FALSE(stan::services::util::advise_huge_pages(
+      x.data(), x.size() * sizeof(double)));
+  EXPECT_FALSE(stan::services::util::advise_huge_pages(nullptr, 1 << 24));
+
+  stan::mcmc::diag_e_point z(10);
+  EXPECT_EQ(0, stan::services::util::advise_huge_pages(z));
+  EXPECT_EQ(10, z.q.size());
+  EXPECT_FLOAT_EQ(1, z.inv_e_metric_(9));
+}
+
+TEST(ServicesUtilMemoryPolicy, advise_huge_pages_keeps_contents) {
+  const std::size_t n = 3 * stan::services::util::huge_page_bytes
+                        / sizeof(double);
+  stan::mcmc::dense_e_point z(1);
+  z.q = Eigen::VectorXd::LinSpaced(n, 0, 1);
+  stan::services::util::advise_huge_pages(z.q.data(), n * sizeof(double));
+  EXPECT_FLOAT_EQ(0, z.q(0));
+  EXPECT_FLOAT_EQ(1, z.q(n - 1));
+}
+
+TEST(ServicesUtilMemoryPolicy, reserve_ad_arena) {
+  memory_policy policy;
+  EXPECT_EQ(0u, stan::services::util::reserve_ad_arena(policy));
+
+  policy.ad_arena_bytes = 1 << 20;
+  policy.huge_pages = true;
+  EXPECT_EQ(1u << 20, stan::services::util::reserve_ad_arena(policy));
+  EXPECT_LE(1u << 20,
+            stan::math::ChainableStack::instance_->memalloc_
+                .bytes_allocated());
+  EXPECT_TRUE(stan::math::ChainableStack::instance_->var_stack_.empty());
+}
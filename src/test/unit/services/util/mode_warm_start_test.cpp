@@ -0,0 +1,73 @@
+#include <stan/services/util/mode_warm_start.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+// normal log density -x^T P x / 2 with precision P = [[2, 1], [1, 3]]
+struct normal_model {
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& x, std::ostream* msgs = 0) const {
+    return -0.5 * (2 * x(0) * x(0) + 2 * x(0) * x(1) + 3 * x(1) * x(1));
+  }
+};
+
+Eigen::MatrixXd precision() {
+  Eigen::MatrixXd P(2, 2);
+  P << 2, 1, 1, 3;
+  return P;
+}
+}  // namespace
+
+TEST(ServicesUtilModeWarmStart, dense_from_mode) {
+  stan::test::unit::instrumented_logger logger;
+  Eigen::VectorXd mode = Eigen::VectorXd::Zero(2);
+  stan::services::util::warm_start start
+      = stan::services::util::warm_start_from_mode(normal_model(), mode, true,
+                                                   logger);
+  ASSERT_EQ(2, start.cont_vector.size());
+  EXPECT_FLOAT_EQ(0, start.cont_vector[0]);
+  EXPECT_FLOAT_EQ(std::pow(2.0, -0.25), start.stepsize);
+  ASSERT_EQ(2, start.inv_metric.rows());
+  EXPECT_TRUE(start.inv_metric.isApprox(precision().inverse()));
+  EXPECT_EQ(1, logger.find_info("Mode warm start"));
+}
+
+TEST(ServicesUtilModeWarmStart, diag_from_mode) {
+  stan::test::unit::instrumented_logger logger;
+  Eigen::VectorXd mode = Eigen::VectorXd::Zero(2);
+  stan::services::util::warm_start start
+      = stan::services::util::warm_start_from_mode(normal_model(), mode, false,
+                                                   logger);
+  ASSERT_EQ(1, start.inv_metric.rows());
+  ASSERT_EQ(2, start.inv_metric.cols());
+  // marginal variances, not the inverse curvatures
+  EXPECT_FLOAT_EQ(0.6, start.inv_metric(0, 0));
+  EXPECT_FLOAT_EQ(0.4, start.inv_metric(0, 1));
+}
+
+TEST(ServicesUtilModeWarmStart, inv_hessian_regularized) {
+  Eigen::VectorXd mode(2);
+  mode << 1, -1;
+  Eigen::MatrixXd inv_hessian(2, 2);
+  inv_hessian << 4, 0, 0, -1;
+  stan::services::util::warm_start start
+      = stan::services::util::warm_start_from_inv_hessian(mode, inv_hessian,
+                                                          true, 0.01);
+  EXPECT_FLOAT_EQ(1, start.cont_vector[0]);
+  EXPECT_FLOAT_EQ(-1, start.cont_vector[1]);
+  EXPECT_FLOAT_EQ(4, start.inv_metric(0, 0));
+  EXPECT_FLOAT_EQ(0.04, start.inv_metric(1, 1));
+  EXPECT_NEAR(0, start.inv_metric(0, 1), 1e-12);
+}
+
+TEST(ServicesUtilModeWarmStart, inv_hessian_throws) {
+  Eigen::VectorXd mode = Eigen::VectorXd::Zero(2);
+  EXPECT_THROW(stan::services::util::warm_start_from_inv_hessian(
+                   mode, Eigen::MatrixXd::Identity(3, 3), true),
+               std::invalid_argument);
+  EXPECT_THROW(stan::services::util::warm_start_from_inv_hessian(
+                   mode, -Eigen::MatrixXd::Identity(2, 2), true),
+               std::domain_error);
+}
@@ -0,0 +1,102 @@
+#include <stan/services/util/output_selection.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// parameters theta.1, theta.2 and sigma, transformed parameter
+// tau.1.1, tau.1.2 and generated quantities y_rep.1, y_rep.2 and
+// pair.1:1
+struct layout_model {
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names.insert(names.end(), {"theta.1", "theta.2", "sigma"});
+    if (include_tparams)
+      names.insert(names.end(), {"tau.1.1", "tau.1.2"});
+    if (include_gqs)
+      names.insert(names.end(), {"y_rep.1", "y_rep.2", "pair.1:1"});
+  }
+};
+}  // namespace
+
+using stan::services::util::output_columns;
+using stan::services::util::output_selection;
+
+TEST(ServicesUtilOutputSelection, glob_match) {
+  EXPECT_TRUE(output_selection::glob_match("theta", "theta"));
+  EXPECT_FALSE(output_selection::glob_match("theta", "theta.1"));
+  EXPECT_TRUE(output_selection::glob_match("theta*", "theta.1"));
+  EXPECT_TRUE(output_selection::glob_match("*", ""));
+  EXPECT_TRUE(output_selection::glob_match("t?u*.2", "tau.1.2"));
+  EXPECT_TRUE(output_selection::glob_match("*a*a*", "banana"));
+  EXPECT_FALSE(output_selection::glob_match("*a*b", "banana"));
+  EXPECT_FALSE(output_selection::glob_match("?", ""));
+}
+
+TEST(ServicesUtilOutputSelection, selects_variables_and_columns) {
+  EXPECT_TRUE(output_selection::selects("theta", "theta.2"));
+  EXPECT_TRUE(output_selection::selects("theta.2", "theta.2"));
+  EXPECT_FALSE(output_selection::selects("theta.1", "theta.2"));
+  EXPECT_TRUE(output_selection::selects("pair", "pair.1:1"));
+  EXPECT_FALSE(output_selection::selects("the", "theta.2"));
+}
+
+TEST(ServicesUtilOutputSelection, select_all) {
+  output_selection selection;
+  EXPECT_TRUE(selection.selects_all());
+  output_columns columns = selection.select(layout_model());
+  EXPECT_TRUE(columns.all);
+  EXPECT_TRUE(columns.include_tparams);
+  EXPECT_TRUE(columns.include_gqs);
+  EXPECT_TRUE(columns.columns.empty());
+  EXPECT_EQ(8, columns.names.size());
+}
+
+TEST(ServicesUtilOutputSelection, select_parameters_only) {
+  output_selection selection({"s*", "theta.2"});
+  EXPECT_FALSE(selection.selects_all());
+  output_columns columns = selection.select(layout_model());
+  EXPECT_FALSE(columns.all);
+  EXPECT_FALSE(columns.include_tparams);
+  EXPECT_FALSE(columns.include_gqs);
+  EXPECT_EQ((std::vector<size_t>{1, 2}), columns.columns);
+  EXPECT_EQ((std::vector<std::string>{"theta.2", "sigma"}), columns.names);
+}
+
+TEST(ServicesUtilOutputSelection, select_generated_quantities) {
+  output_columns columns
+      = output_selection({"y_rep.2", "theta"}).select(layout_model());
+  EXPECT_FALSE(columns.include_tparams);
+  EXPECT_TRUE(columns.include_gqs);
+  // the generated quantities follow the parameters directly
+  EXPECT_EQ((std::vector<size_t>{0, 1, 4}), columns.columns);
+  EXPECT_EQ((std::vector<std::string>{"theta.1", "theta.2", "y_rep.2"}),
+            columns.names);
+
+  columns = output_selection({"pair", "tau"}).select(layout_model());
+  EXPECT_TRUE(columns.include_tparams);
+  EXPECT_TRUE(columns.include_gqs);
+  EXPECT_EQ((std::vector<size_t>{3, 4, 7}), columns.columns);
+}
+
+TEST(ServicesUtilOutputSelection, unmatched_pattern_throws) {
+  EXPECT_THROW(output_selection({"theta", "mu"}).select(layout_model()),
+               std::invalid_argument);
+}
+
+TEST(ServicesUtilOutputSelection, single_precision_columns) {
+  using stan::callbacks::value_precision;
+  output_selection selection;
+  EXPECT_FALSE(selection.reduces_precision());
+  EXPECT_EQ(value_precision::float64, selection.precision("y_rep.1"));
+  selection.set_float32({"y_rep", "tau.1.2"});
+  EXPECT_TRUE(selection.reduces_precision());
+  EXPECT_TRUE(selection.selects_all());
+  EXPECT_EQ(value_precision::float32, selection.precision("y_rep.1"));
+  EXPECT_EQ(value_precision::float32, selection.precision("y_rep"));
+  EXPECT_EQ(value_precision::float32, selection.precision("tau.1.2"));
+  EXPECT_EQ(value_precision::float64, selection.precision("tau.1.1"));
+  EXPECT_EQ(value_precision::float64, selection.precision("theta.1"));
+}
@@ -0,0 +1,27 @@
+#include <stan/services/util/parameter_blocks.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+struct named_model {
+  std::vector<std::string> names;
+
+  void unconstrained_param_names(std::vector<std::string>& param_names,
+                                 bool include_tparams, bool include_gqs) const {
+    param_names = names;
+  }
+};
+}  // namespace
+
+TEST(ServicesUtilParameterBlocks, one_block_per_parameter) {
+  named_model model{{"mu", "theta.1", "theta.2", "theta.3", "L.1.1", "L.2.1",
+                     "sigma"}};
+  EXPECT_EQ(std::vector<int>({1, 3, 2, 1}),
+            stan::services::util::parameter_blocks(model));
+}
+
+TEST(ServicesUtilParameterBlocks, no_parameters) {
+  named_model model;
+  EXPECT_TRUE(stan::services::util::parameter_blocks(model).empty());
+}
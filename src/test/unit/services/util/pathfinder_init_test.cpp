@@ -0,0 +1,82 @@
+#include <stan/services/util/pathfinder_init.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// a positive scalar sigma and an unconstrained mu
+struct init_model {
+  size_t num_params_r() const { return 2; }
+
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names.insert(names.end(), {"sigma", "mu"});
+    if (include_gqs)
+      names.push_back("y_rep");
+  }
+
+  void unconstrain_array(const Eigen::VectorXd& constrained,
+                         Eigen::VectorXd& unconstrained,
+                         std::ostream* msgs = nullptr) const {
+    unconstrained = constrained;
+    unconstrained(0) = std::log(constrained(0));
+  }
+};
+}  // namespace
+
+TEST(ServicesUtilPathfinderInit, draws_collector) {
+  stan::services::util::draws_collector collector;
+  collector(std::vector<std::string>{"lp_approx__", "lp__", "x"});
+  collector(std::vector<double>{1, 2, 3});
+  Eigen::MatrixXd draws(3, 2);
+  draws << 4, 7, 5, 8, 6, 9;
+  collector(draws);
+  collector();
+  collector("Elapsed Time: 1 seconds");
+  ASSERT_EQ(3, collector.draws().size());
+  EXPECT_EQ("x", collector.names()[2]);
+  EXPECT_EQ((std::vector<double>{7, 8, 9}), collector.draws()[2]);
+}
+
+TEST(ServicesUtilPathfinderInit, init_from_draws) {
+  std::vector<std::vector<double>> draws;
+  for (int n = 0; n < 100; ++n)
+    draws.push_back({-1, -2, std::exp(0.01 * n), n % 2 == 0 ? 1.0 : -1.0, 5});
+
+  stan::services::util::chains_init init
+      = stan::services::util::init_from_draws(init_model(), draws, 2, 4);
+  ASSERT_EQ(4, init.cont_vectors.size());
+  for (size_t i = 0; i < 4; ++i) {
+    ASSERT_EQ(2, init.cont_vectors[i].size());
+    EXPECT_FLOAT_EQ(0.01 * 25 * i, init.cont_vectors[i][0]);
+  }
+
+  // variances of log(sigma) and mu, regularized with 5 pseudo draws
+  double var_log_sigma = 0.01 * 0.01 * 100 * 101 / 12;
+  double var_mu = 100.0 / 99;
+  ASSERT_EQ(2, init.inv_metric.size());
+  EXPECT_FLOAT_EQ((100 * var_log_sigma + 5e-3) / 105, init.inv_metric(0));
+  EXPECT_FLOAT_EQ((100 * var_mu + 5e-3) / 105, init.inv_metric(1));
+  EXPECT_FLOAT_EQ(std::pow(2, -0.25), init.stepsize);
+}
+
+TEST(ServicesUtilPathfinderInit, more_chains_than_draws) {
+  std::vector<std::vector<double>> draws{{0, 0, 1, 3}};
+  stan::services::util::chains_init init
+      = stan::services::util::init_from_draws(init_model(), draws, 2, 2);
+  ASSERT_EQ(2, init.cont_vectors.size());
+  EXPECT_FLOAT_EQ(3, init.cont_vectors[1][1]);
+  EXPECT_FLOAT_EQ((1 + 5e-3) / 6, init.inv_metric(1));
+}
+
+TEST(ServicesUtilPathfinderInit, invalid_draws) {
+  std::vector<std::vector<double>> draws;
+  EXPECT_THROW(stan::services::util::init_from_draws(init_model(), draws, 2, 1),
+               std::invalid_argument);
+  draws.push_back({0, 0, 1});
+  EXPECT_THROW(stan::services::util::init_from_draws(init_model(), draws, 2, 1),
+               std::invalid_argument);
+}
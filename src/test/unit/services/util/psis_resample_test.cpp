@@ -0,0 +1,138 @@
+#include <stan/services/util/psis_resample.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// draws of a normal(0, 1) approximation of a normal(mu, 1) posterior
+std::vector<std::vector<double>> make_draws(double mu, int num_draws) {
+  std::vector<std::vector<double>> draws;
+  stan::rng_t rng = stan::services::util::create_rng(5, 1);
+  boost::random::normal_distribution<double> normal(0, 1);
+  for (int n = 0; n < num_draws; ++n) {
+    const double x = normal(rng);
+    // log_p__, log_q__, x
+    draws.push_back({-0.5 * (x - mu) * (x - mu), -0.5 * x * x, x});
+  }
+  return draws;
+}
+
+class mean_writer : public stan::callbacks::writer {
+ public:
+  using stan::callbacks::writer::operator();
+  void operator()(const std::vector<double>& state) {
+    sum_ += state[2];
+    ++count_;
+  }
+  double mean() const { return sum_ / count_; }
+  int count() const { return count_; }
+
+ private:
+  double sum_ = 0;
+  int count_ = 0;
+};
+}  // namespace
+
+TEST(ServicesUtilPsisResample, corrects_draws) {
+  stan::test::unit::instrumented_logger logger;
+  std::vector<std::vector<double>> draws = make_draws(0.5, 4000);
+  Eigen::Array<double, Eigen::Dynamic, 1> log_ratios(draws.size());
+  for (size_t n = 0; n < draws.size(); ++n)
+    log_ratios(n) = draws[n][0] - draws[n][1];
+
+  stan::rng_t rng = stan::services::util::create_rng(3, 0);
+  stan::services::util::psis_resampling result
+      = stan::services::util::psis_resample(log_ratios, 4000, rng, logger);
+  ASSERT_EQ(4000, result.indices.size());
+  ASSERT_EQ(4000, result.weights.size());
+  EXPECT_LT(result.pareto_k, 0.5);
+  double mean = 0;
+  for (auto&& i : result.indices)
+    mean += draws[i][2] / 4000;
+  EXPECT_NEAR(0.5, mean, 0.06);
+  EXPECT_EQ(0, logger.call_count_warn());
+}
+
+TEST(ServicesUtilPsisResample, nan_ratios_get_no_weight) {
+  stan::test::unit::instrumented_logger logger;
+  Eigen::Array<double, Eigen::Dynamic, 1> log_ratios
+      = Eigen::Array<double, Eigen::Dynamic, 1>::Zero(100);
+  for (int n = 0; n < 100; n += 2)
+    log_ratios(n) = std::numeric_limits<double>::quiet_NaN();
+
+  stan::rng_t rng = stan::services::util::create_rng(3, 0);
+  stan::services::util::psis_resampling result
+      = stan::services::util::psis_resample(log_ratios, 200, rng, logger);
+  ASSERT_EQ(200, result.indices.size());
+  for (auto&& i : result.indices)
+    EXPECT_EQ(1, i % 2);
+}
+
+TEST(ServicesUtilPsisResample, no_finite_ratio) {
+  stan::test::unit::instrumented_logger logger;
+  Eigen::Array<double, Eigen::Dynamic, 1> log_ratios
+      = Eigen::Array<double, Eigen::Dynamic, 1>::Constant(
+          50, -std::numeric_limits<double>::infinity());
+
+  stan::rng_t rng = stan::services::util::create_rng(3, 0);
+  stan::services::util::psis_resampling result
+      = stan::services::util::psis_resample(log_ratios, 50, rng, logger);
+  EXPECT_TRUE(result.indices.empty());
+  EXPECT_TRUE(std::isnan(result.pareto_k));
+  EXPECT_EQ(1, logger.call_count_warn());
+}
+
+TEST(ServicesUtilPsisResample, writer_resamples_draws) {
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer output;
+  stan::services::util::psis_resample_writer resampler(output, "log_p__",
+                                                       "log_q__", 1);
+  resampler(std::vector<std::string>{"log_p__", "log_q__", "x"});
+  resampler(std::string("message"));
+  resampler(std::vector<double>{0, 0, 0});
+  for (auto&& draw : make_draws(0.5, 1000))
+    resampler(draw);
+
+  EXPECT_EQ(1, output.call_count("vector_string"));
+  EXPECT_EQ(1, output.call_count("string"));
+  EXPECT_EQ(1, output.call_count("vector_double"));
+  EXPECT_EQ(1000, resampler.draws().size());
+
+  stan::rng_t rng = stan::services::util::create_rng(3, 0);
+  double pareto_k = resampler.resample(rng, logger);
+  EXPECT_LT(pareto_k, 0.5);
+  EXPECT_EQ(1001, output.call_count("vector_double"));
+  EXPECT_TRUE(resampler.draws().empty());
+  EXPECT_EQ(1, logger.find_info("Pareto k"));
+}
+
+TEST(ServicesUtilPsisResample, writer_corrects_mean) {
+  stan::test::unit::instrumented_logger logger;
+  mean_writer raw, resampled;
+  stan::services::util::psis_resample_writer resampler(resampled, "log_p__",
+                                                       "log_q__");
+  resampler(std::vector<std::string>{"log_p__", "log_q__", "x"});
+  for (auto&& draw : make_draws(0.5, 4000)) {
+    raw(draw);
+    resampler(draw);
+  }
+  stan::rng_t rng = stan::services::util::create_rng(3, 0);
+  resampler.resample(rng, logger);
+  EXPECT_EQ(4000, resampled.count());
+  EXPECT_NEAR(0, raw.mean(), 0.06);
+  EXPECT_NEAR(0.5, resampled.mean(), 0.06);
+}
+
+TEST(ServicesUtilPsisResample, writer_missing_column_throws) {
+  stan::test::unit::instrumented_writer output;
+  stan::services::util::psis_resample_writer resampler(output, "log_p__",
+                                                       "log_g__");
+  EXPECT_THROW(resampler(std::vector<std::string>{"log_p__", "log_q__", "x"}),
+               std::invalid_argument);
+}
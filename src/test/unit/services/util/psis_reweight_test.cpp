@@ -0,0 +1,121 @@
+#include <stan/services/util/psis_reweight.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// normal(mu, 1) posterior of a positive parameter x, log-transformed
+struct positive_normal_model {
+  double mu;
+  explicit positive_normal_model(double mu) : mu(mu) {}
+
+  size_t num_params_r() const { return 1; }
+
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names = {"x"};
+  }
+
+  void unconstrain_array(const Eigen::VectorXd& constrained,
+                         Eigen::VectorXd& unconstrained,
+                         std::ostream* msgs = nullptr) const {
+    if (!(constrained(0) > 0))
+      throw std::domain_error("x is not positive");
+    unconstrained = constrained.array().log();
+  }
+
+  template <bool propto, bool jacobian, typename T>
+  double log_prob(const T& unconstrained, std::ostream* msgs) const {
+    const double x = std::exp(unconstrained(0));
+    return -0.5 * (x - mu) * (x - mu) + (jacobian ? unconstrained(0) : 0);
+  }
+};
+
+stan::io::stan_csv make_fit(double mu, int num_draws) {
+  stan::io::stan_csv fit;
+  fit.header = {"lp__", "x"};
+  fit.samples.resize(num_draws, 2);
+  stan::rng_t rng = stan::services::util::create_rng(5, 1);
+  boost::random::normal_distribution<double> normal(mu, 1);
+  for (int n = 0; n < num_draws; ++n) {
+    double x;
+    do {
+      x = normal(rng);
+    } while (x <= 0);
+    fit.samples(n, 0) = 0;
+    fit.samples(n, 1) = x;
+  }
+  return fit;
+}
+
+double weighted_mean(const stan::services::util::psis_reweighting& result) {
+  return (result.draws.row(0).array().exp().transpose() * result.weights)
+             .sum()
+         / result.weights.sum();
+}
+}  // namespace
+
+TEST(ServicesUtilPsisReweight, small_update) {
+  stan::test::unit::instrumented_logger logger;
+  positive_normal_model previous_model(3);
+  positive_normal_model model(3.2);
+  stan::io::stan_csv fit = make_fit(3, 4000);
+  stan::services::util::psis_reweighting result
+      = stan::services::util::psis_reweight(model, previous_model, fit,
+                                            logger);
+  ASSERT_EQ(1, result.draws.rows());
+  ASSERT_EQ(4000, result.draws.cols());
+  EXPECT_FLOAT_EQ(std::log(fit.samples(7, 1)), result.draws(0, 7));
+  EXPECT_LT(result.pareto_k, 0.5);
+  EXPECT_NEAR(3.2, weighted_mean(result), 0.05);
+  EXPECT_EQ(0, logger.call_count_warn());
+}
+
+TEST(ServicesUtilPsisReweight, large_update) {
+  stan::test::unit::instrumented_logger logger;
+  positive_normal_model previous_model(3);
+  positive_normal_model model(8);
+  stan::io::stan_csv fit = make_fit(3, 4000);
+  stan::services::util::psis_reweighting result
+      = stan::services::util::psis_reweight(model, previous_model, fit,
+                                            logger);
+  EXPECT_GT(result.pareto_k, 0.7);
+  EXPECT_EQ(1, logger.find_warn("Pareto k value"));
+}
+
+TEST(ServicesUtilPsisReweight, draws_outside_support) {
+  stan::test::unit::instrumented_logger logger;
+  positive_normal_model model(3);
+  stan::io::stan_csv fit = make_fit(3, 100);
+  fit.samples(3, 1) = -1;
+  stan::services::util::psis_reweighting result
+      = stan::services::util::psis_reweight(model, model, fit, logger);
+  EXPECT_EQ(0, result.weights(3));
+  EXPECT_TRUE(std::isnan(result.draws(0, 3)));
+  EXPECT_EQ(1, result.weights(4));
+
+  for (int n = 0; n < 100; ++n)
+    fit.samples(n, 1) = -1;
+  result = stan::services::util::psis_reweight(model, model, fit, logger);
+  EXPECT_TRUE(std::isnan(result.pareto_k));
+  EXPECT_EQ(0, result.weights.sum());
+  EXPECT_EQ(1, logger.find_warn("no draw of the previous fit"));
+}
+
+TEST(ServicesUtilPsisReweight, bad_fit) {
+  stan::test::unit::instrumented_logger logger;
+  positive_normal_model model(3);
+  stan::io::stan_csv fit = make_fit(3, 10);
+  fit.header = {"lp__", "y"};
+  EXPECT_THROW(stan::services::util::psis_reweight(model, model, fit, logger),
+               std::invalid_argument);
+  fit.samples.resize(0, 2);
+  EXPECT_THROW(stan::services::util::psis_reweight(model, model, fit, logger),
+               std::invalid_argument);
+}
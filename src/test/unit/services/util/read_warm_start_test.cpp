@@ -0,0 +1,81 @@
+#include <stan/services/util/read_warm_start.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+// a positive scalar sigma and a vector theta[2]
+struct warm_start_model {
+  void constrained_param_names(std::vector<std::string>& names,
+                               bool include_tparams = true,
+                               bool include_gqs = true) const {
+    names.insert(names.end(), {"sigma", "theta.1", "theta.2"});
+  }
+
+  void unconstrain_array(const Eigen::VectorXd& constrained,
+                         Eigen::VectorXd& unconstrained,
+                         std::ostream* msgs = nullptr) const {
+    unconstrained = constrained;
+    unconstrained(0) = std::log(constrained(0));
+  }
+};
+
+stan::io::stan_csv previous_fit() {
+  stan::io::stan_csv fit;
+  fit.header = {"lp__", "stepsize__", "theta[1]", "sigma", "theta[2]", "gq"};
+  fit.samples.resize(2, 6);
+  fit.samples << -1, 0.5, 1, 2, 3, 0, -2, 0.5, 4, 5, 6, 0;
+  fit.adaptation.step_size = 0.5;
+  fit.adaptation.metric.resize(1, 3);
+  fit.adaptation.metric << 1, 2, 3;
+  return fit;
+}
+}  // namespace
+
+TEST(ServicesUtilReadWarmStart, last_draw_unconstrained) {
+  stan::services::util::warm_start start
+      = stan::services::util::read_warm_start(warm_start_model(),
+                                              previous_fit());
+  ASSERT_EQ(3, start.cont_vector.size());
+  EXPECT_FLOAT_EQ(std::log(5), start.cont_vector[0]);
+  EXPECT_FLOAT_EQ(4, start.cont_vector[1]);
+  EXPECT_FLOAT_EQ(6, start.cont_vector[2]);
+  EXPECT_FLOAT_EQ(0.5, start.stepsize);
+  EXPECT_EQ(1, start.inv_metric.rows());
+  EXPECT_FLOAT_EQ(3, start.inv_metric(0, 2));
+}
+
+TEST(ServicesUtilReadWarmStart, dense_metric) {
+  stan::io::stan_csv fit = previous_fit();
+  fit.adaptation.metric = Eigen::MatrixXd::Identity(3, 3);
+  stan::services::util::warm_start start
+      = stan::services::util::read_warm_start(warm_start_model(), fit);
+  EXPECT_EQ(3, start.inv_metric.rows());
+  EXPECT_EQ(3, start.inv_metric.cols());
+}
+
+TEST(ServicesUtilReadWarmStart, invalid_fits) {
+  warm_start_model model;
+  stan::io::stan_csv fit = previous_fit();
+  fit.samples.resize(0, 6);
+  EXPECT_THROW(stan::services::util::read_warm_start(model, fit),
+               std::invalid_argument);
+
+  fit = previous_fit();
+  fit.adaptation.step_size = 0;
+  EXPECT_THROW(stan::services::util::read_warm_start(model, fit),
+               std::invalid_argument);
+
+  fit = previous_fit();
+  fit.header[3] = "tau";
+  EXPECT_THROW(stan::services::util::read_warm_start(model, fit),
+               std::invalid_argument);
+
+  fit = previous_fit();
+  fit.adaptation.metric.resize(1, 2);
+  EXPECT_THROW(stan::services::util::read_warm_start(model, fit),
+               std::invalid_argument);
+}
@@ -0,0 +1,118 @@
+#include <stan/services/util/rebind_data.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+stan::io::array_var_context make_data(const std::vector<double>& y) {
+  std::vector<std::string> names_r{"y"};
+  std::vector<std::vector<size_t>> dims_r{{y.size()}};
+  std::vector<std::string> names_i{"N"};
+  std::vector<int> vals_i{static_cast<int>(y.size())};
+  std::vector<std::vector<size_t>> dims_i{{}};
+  return stan::io::array_var_context(names_r, y, dims_r, names_i, vals_i,
+                                     dims_i);
+}
+
+// a model with a parameter per observation and the sum of y as
+// transformed data; y must be positive
+struct mock_model {
+  int N = 0;
+  std::vector<double> y;
+  double sum_y = 0;
+  bool supported = true;
+  int num_rebinds = 0;
+
+  explicit mock_model(const stan::io::var_context& context) {
+    read(context);
+  }
+
+  void read(const stan::io::var_context& context) {
+    N = context.vals_i("N")[0];
+    y = context.vals_r("y");
+    sum_y = 0;
+    for (double y_n : y) {
+      if (!(y_n > 0))
+        throw std::domain_error("y is not positive");
+      sum_y += y_n;
+    }
+  }
+
+  void get_data_dims(std::vector<std::string>& names,
+                     std::vector<std::vector<size_t>>& dimss) const {
+    names.clear();
+    dimss.clear();
+    if (supported) {
+      names = {"N", "y"};
+      dimss = {{}, {static_cast<size_t>(N)}};
+    }
+  }
+
+  void get_dims(std::vector<std::vector<size_t>>& dimss,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dimss = {{static_cast<size_t>(N)}};
+  }
+
+  bool rebind_data(const stan::io::var_context& context,
+                   std::ostream* msgs = nullptr) {
+    if (!supported)
+      return false;
+    read(context);
+    ++num_rebinds;
+    return true;
+  }
+};
+}  // namespace
+
+TEST(ServicesUtilRebindData, rebinds_data_of_same_shape) {
+  stan::test::unit::instrumented_logger logger;
+  mock_model model(make_data({1, 2, 3}));
+  EXPECT_TRUE(stan::services::util::rebind_data(model, make_data({4, 5, 6}),
+                                                logger));
+  EXPECT_EQ(1, model.num_rebinds);
+  EXPECT_EQ(3, model.N);
+  EXPECT_EQ(15, model.sum_y);
+  EXPECT_EQ(0, logger.call_count_error());
+}
+
+TEST(ServicesUtilRebindData, unsupported) {
+  stan::test::unit::instrumented_logger logger;
+  mock_model model(make_data({1, 2, 3}));
+  model.supported = false;
+  EXPECT_FALSE(stan::services::util::rebind_data(model, make_data({4, 5, 6}),
+                                                 logger));
+  EXPECT_EQ(6, model.sum_y);
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(ServicesUtilRebindData, rejects_other_shapes) {
+  stan::test::unit::instrumented_logger logger;
+  mock_model model(make_data({1, 2, 3}));
+  EXPECT_THROW(
+      stan::services::util::rebind_data(model, make_data({4, 5}), logger),
+      std::domain_error);
+  EXPECT_EQ(0, model.num_rebinds);
+  EXPECT_EQ(6, model.sum_y);
+  EXPECT_EQ(1, logger.find_error("dimensions (2) instead of (3)"));
+
+  std::vector<std::string> names_r{"y"};
+  std::vector<double> y{4, 5, 6};
+  std::vector<std::vector<size_t>> dims_r{{3}};
+  stan::io::array_var_context no_N(names_r, y, dims_r);
+  EXPECT_THROW(stan::services::util::rebind_data(model, no_N, logger),
+               std::domain_error);
+  EXPECT_EQ(1, logger.find_error("variable N not found"));
+  EXPECT_EQ(0, model.num_rebinds);
+}
+
+TEST(ServicesUtilRebindData, rejects_invalid_data) {
+  stan::test::unit::instrumented_logger logger;
+  mock_model model(make_data({1, 2, 3}));
+  EXPECT_THROW(
+      stan::services::util::rebind_data(model, make_data({4, -5, 6}), logger),
+      std::domain_error);
+  EXPECT_EQ(1, logger.find_error("y is not positive"));
+}
@@ -0,0 +1,170 @@
+#include <stan/services/util/resumable_chain.hpp>
+#include <stan/services/util/run_adaptive_sampler.hpp>
+#include <stan/services/util/run_sampler.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <test/test-models/good/services/test_lp.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+
+class ServicesUtilResumableChain : public testing::Test {
+ public:
+  ServicesUtilResumableChain()
+      : model(context, 0, &model_log),
+        num_chains(3),
+        num_warmup(100),
+        num_samples(50),
+        num_thin(3),
+        refresh(0),
+        save_warmup(true),
+        sample_writers(num_chains),
+        diagnostic_writers(num_chains),
+        metric_writers(num_chains) {
+    for (size_t i = 0; i < num_chains; ++i) {
+      rngs.emplace_back(stan::services::util::create_rng(0, i + 1));
+      cont_vectors.emplace_back(std::vector<double>{0.1 * i, -0.1 * i});
+    }
+  }
+
+  template <typename Sampler>
+  std::vector<Sampler> make_samplers(std::vector<stan::rng_t>& rngs) {
+    std::vector<Sampler> samplers;
+    samplers.reserve(num_chains);
+    for (size_t i = 0; i < num_chains; ++i)
+      samplers.emplace_back(model, rngs[i]);
+    return samplers;
+  }
+
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model;
+  size_t num_chains;
+  int num_warmup, num_samples, num_thin, refresh;
+  bool save_warmup;
+  std::vector<std::vector<double>> cont_vectors;
+  std::vector<stan::rng_t> rngs;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> sample_writers;
+  std::vector<stan::test::unit::instrumented_writer> diagnostic_writers;
+  std::vector<stan::callbacks::structured_writer> metric_writers;
+};
+
+TEST_F(ServicesUtilResumableChain, adaptive_matches_run_adaptive_sampler) {
+  using sampler_t = stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>;
+  auto samplers = make_samplers<sampler_t>(rngs);
+  stan::services::util::chain_scheduler scheduler(7);
+  stan::services::util::run_scheduled_adaptive_sampler(
+      scheduler, samplers, model, cont_vectors, num_warmup, num_samples,
+      num_thin, refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+  EXPECT_EQ(num_chains * (num_warmup + num_samples), interrupt.call_count());
+
+  for (size_t i = 0; i < num_chains; ++i) {
+    stan::rng_t rng = stan::services::util::create_rng(0, i + 1);
+    sampler_t sampler(model, rng);
+    std::vector<double> cont_vector = cont_vectors[i];
+    stan::test::unit::instrumented_writer sample_writer, diagnostic_writer;
+    stan::services::util::run_adaptive_sampler(
+        sampler, model, cont_vector, num_warmup, num_samples, num_thin,
+        refresh, save_warmup, rng, interrupt, logger, sample_writer,
+        diagnostic_writer, metric_writers[i], i + 1, num_chains);
+
+    EXPECT_EQ(sample_writer.vector_string_values(),
+              sample_writers[i].vector_string_values());
+    EXPECT_EQ(sample_writer.vector_double_values(),
+              sample_writers[i].vector_double_values());
+    EXPECT_EQ(diagnostic_writer.vector_double_values(),
+              diagnostic_writers[i].vector_double_values());
+    EXPECT_EQ(sample_writer.call_count("string"),
+              sample_writers[i].call_count("string"));
+    EXPECT_FLOAT_EQ(sampler.get_nominal_stepsize(),
+                    samplers[i].get_nominal_stepsize());
+  }
+
+  std::vector<stan::services::util::chain_progress> progress
+      = scheduler.progress();
+  ASSERT_EQ(num_chains, progress.size());
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(i + 1, progress[i].chain_id);
+    EXPECT_EQ(num_warmup + num_samples, progress[i].iteration);
+    EXPECT_FALSE(progress[i].warmup);
+    EXPECT_TRUE(progress[i].finished);
+  }
+}
+
+TEST_F(ServicesUtilResumableChain, matches_run_sampler) {
+  using sampler_t = stan::mcmc::diag_e_nuts<stan_model, stan::rng_t>;
+  auto samplers = make_samplers<sampler_t>(rngs);
+  stan::services::util::chain_scheduler scheduler(16);
+  stan::services::util::run_scheduled_sampler(
+      scheduler, samplers, model, cont_vectors, num_warmup, num_samples,
+      num_thin, refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers);
+
+  for (size_t i = 0; i < num_chains; ++i) {
+    stan::rng_t rng = stan::services::util::create_rng(0, i + 1);
+    sampler_t sampler(model, rng);
+    std::vector<double> cont_vector = cont_vectors[i];
+    stan::test::unit::instrumented_writer sample_writer, diagnostic_writer;
+    stan::services::util::run_sampler(
+        sampler, model, cont_vector, num_warmup, num_samples, num_thin,
+        refresh, save_warmup, rng, interrupt, logger, sample_writer,
+        diagnostic_writer, i + 1, num_chains);
+
+    EXPECT_EQ(sample_writer.vector_double_values(),
+              sample_writers[i].vector_double_values());
+    EXPECT_EQ(sample_writer.call_count("string"),
+              sample_writers[i].call_count("string"));
+  }
+}
+
+TEST_F(ServicesUtilResumableChain, no_warmup) {
+  num_warmup = 0;
+  using sampler_t = stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>;
+  auto samplers = make_samplers<sampler_t>(rngs);
+  stan::services::util::chain_scheduler scheduler;
+  stan::services::util::run_scheduled_adaptive_sampler(
+      scheduler, samplers, model, cont_vectors, num_warmup, num_samples,
+      num_thin, refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(1, sample_writers[i].call_count("vector_string"));
+    EXPECT_EQ((num_samples + num_thin - 1) / num_thin,
+              sample_writers[i].call_count("vector_double"));
+    EXPECT_FALSE(samplers[i].adapting());
+  }
+}
+
+namespace {
+// counts the summaries of rejections the sampler is asked to write
+class summary_counting_sampler
+    : public stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t> {
+ public:
+  summary_counting_sampler(const stan_model& model, stan::rng_t& rng)
+      : stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>(model, rng) {}
+
+  void write_rejection_summary(stan::callbacks::logger& logger) {
+    ++num_summaries;
+    stan::mcmc::adapt_diag_e_nuts<stan_model,
+                                  stan::rng_t>::write_rejection_summary(logger);
+  }
+
+  int num_summaries = 0;
+};
+}  // namespace
+
+TEST_F(ServicesUtilResumableChain, one_rejection_summary_per_phase) {
+  auto samplers = make_samplers<summary_counting_sampler>(rngs);
+  stan::services::util::chain_scheduler scheduler(7);
+  stan::services::util::run_scheduled_adaptive_sampler(
+      scheduler, samplers, model, cont_vectors, num_warmup, num_samples,
+      num_thin, refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+  // the phases run in blocks of 7 iterations, but each writes one summary
+  for (size_t i = 0; i < num_chains; ++i)
+    EXPECT_EQ(2, samplers[i].num_summaries);
+}
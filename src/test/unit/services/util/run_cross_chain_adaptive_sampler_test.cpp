@@ -0,0 +1,290 @@
+#include <stan/services/util/run_cross_chain_adaptive_sampler.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <test/test-models/good/services/test_lp.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/services/util/chain_communicator.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+// the processes of a run, simulated by threads of this one
+class thread_group {
+ public:
+  explicit thread_group(int size) : size_(size), slots_(size) {}
+
+  int size() const { return size_; }
+
+  std::vector<double> all_gather(int rank, const std::vector<double>& values) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const int generation = generation_;
+    slots_[rank] = values;
+    if (++arrived_ == size_) {
+      result_.clear();
+      for (const auto& slot : slots_)
+        result_.insert(result_.end(), slot.begin(), slot.end());
+      arrived_ = 0;
+      ++generation_;
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [&] { return generation_ != generation; });
+    }
+    return result_;
+  }
+
+ private:
+  int size_;
+  std::vector<std::vector<double>> slots_;
+  std::vector<double> result_;
+  int arrived_ = 0;
+  int generation_ = 0;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+class thread_communicator : public stan::services::util::chain_communicator {
+ public:
+  thread_communicator(thread_group& group, int rank)
+      : group_(group), rank_(rank) {}
+
+  int rank() const { return rank_; }
+
+  int size() const { return group_.size(); }
+
+  std::vector<double> all_gather(const std::vector<double>& values) {
+    return group_.all_gather(rank_, values);
+  }
+
+ private:
+  thread_group& group_;
+  int rank_;
+};
+}  // namespace
+
+class ServicesUtilCrossChain : public testing::Test {
+ public:
+  ServicesUtilCrossChain()
+      : model(context, 0, &model_log),
+        num_chains(4),
+        num_warmup(200),
+        num_samples(10),
+        num_thin(1),
+        refresh(0),
+        save_warmup(false),
+        sample_writers(num_chains),
+        diagnostic_writers(num_chains),
+        metric_writers(num_chains) {
+    for (size_t i = 0; i < num_chains; ++i) {
+      rngs.emplace_back(stan::services::util::create_rng(0, i + 1));
+      cont_vectors.emplace_back(std::vector<double>{0.1 * i, -0.1 * i});
+    }
+  }
+
+  template <typename Sampler>
+  std::vector<Sampler> make_samplers() {
+    std::vector<Sampler> samplers;
+    samplers.reserve(num_chains);
+    for (size_t i = 0; i < num_chains; ++i) {
+      samplers.emplace_back(model, rngs[i]);
+      samplers[i].set_window_params(num_warmup, 15, 50, 25, logger);
+    }
+    return samplers;
+  }
+
+  std::stringstream model_log;
+  stan::io::empty_var_context context;
+  stan_model model;
+  size_t num_chains;
+  int num_warmup, num_samples, num_thin, refresh;
+  bool save_warmup;
+  std::vector<std::vector<double>> cont_vectors;
+  std::vector<stan::rng_t> rngs;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> sample_writers;
+  std::vector<stan::test::unit::instrumented_writer> diagnostic_writers;
+  std::vector<stan::callbacks::structured_writer> metric_writers;
+};
+
+TEST_F(ServicesUtilCrossChain, diag_e_chains_share_adaptation) {
+  auto samplers
+      = make_samplers<stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>>();
+  stan::services::util::run_cross_chain_adaptive_sampler(
+      samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+      refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+
+  for (size_t i = 1; i < num_chains; ++i) {
+    EXPECT_FLOAT_EQ(samplers[0].get_nominal_stepsize(),
+                    samplers[i].get_nominal_stepsize());
+    EXPECT_TRUE(samplers[0].z().inv_e_metric_.isApprox(
+        samplers[i].z().inv_e_metric_));
+  }
+  EXPECT_FALSE(samplers[0].z().inv_e_metric_.isOnes());
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(1, sample_writers[i].call_count("vector_string"))
+        << "header line";
+    EXPECT_EQ(num_samples, sample_writers[i].call_count("vector_double"));
+  }
+}
+
+TEST_F(ServicesUtilCrossChain, dense_e_chains_share_adaptation) {
+  auto samplers = make_samplers<
+      stan::mcmc::adapt_dense_e_nuts<stan_model, stan::rng_t>>();
+  stan::services::util::run_cross_chain_adaptive_sampler(
+      samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+      refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+
+  for (size_t i = 1; i < num_chains; ++i) {
+    EXPECT_FLOAT_EQ(samplers[0].get_nominal_stepsize(),
+                    samplers[i].get_nominal_stepsize());
+    EXPECT_TRUE(samplers[0].z().inv_e_metric_.isApprox(
+        samplers[i].z().inv_e_metric_));
+  }
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(num_samples, sample_writers[i].call_count("vector_double"));
+  }
+}
+
+TEST_F(ServicesUtilCrossChain, warmup_ends_early_once_converged) {
+  num_warmup = 1000;
+  auto samplers
+      = make_samplers<stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>>();
+  stan::services::util::run_cross_chain_adaptive_sampler(
+      samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+      refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers, 1, 1.1, 20);
+
+  EXPECT_EQ(1, logger.find_info("Warmup converged after"));
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_EQ(num_samples, sample_writers[i].call_count("vector_double"));
+  }
+}
+
+TEST_F(ServicesUtilCrossChain, warmup_runs_in_full_without_thresholds) {
+  num_warmup = 1000;
+  auto samplers
+      = make_samplers<stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>>();
+  stan::services::util::run_cross_chain_adaptive_sampler(
+      samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+      refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers);
+
+  EXPECT_EQ(0, logger.find_info("Warmup converged after"));
+}
+
+TEST_F(ServicesUtilCrossChain, chains_share_adaptation_across_processes) {
+  using sampler_t = stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>;
+  const int num_processes = 2;
+  const size_t chains_per_process = num_chains / num_processes;
+  thread_group group(num_processes);
+  std::vector<std::vector<stan::rng_t>> process_rngs(num_processes);
+  std::vector<std::vector<std::vector<double>>> process_inits(num_processes);
+  std::vector<std::vector<sampler_t>> samplers(num_processes);
+  std::vector<stan::test::unit::instrumented_logger> loggers(num_processes);
+  std::vector<stan::test::unit::instrumented_interrupt> interrupts(
+      num_processes);
+  using writers_t = std::vector<stan::test::unit::instrumented_writer>;
+  std::vector<writers_t> writers(num_processes, writers_t(chains_per_process));
+  std::vector<writers_t> diagnostics(num_processes,
+                                     writers_t(chains_per_process));
+  std::vector<std::vector<stan::callbacks::structured_writer>> metrics(
+      num_processes,
+      std::vector<stan::callbacks::structured_writer>(chains_per_process));
+  for (int r = 0; r < num_processes; ++r) {
+    process_rngs[r].reserve(chains_per_process);
+    for (size_t i = 0; i < chains_per_process; ++i) {
+      const size_t chain = r * chains_per_process + i;
+      process_rngs[r].emplace_back(rngs[chain]);
+      process_inits[r].push_back(cont_vectors[chain]);
+      samplers[r].emplace_back(model, process_rngs[r][i]);
+      samplers[r][i].set_window_params(num_warmup, 15, 50, 25, loggers[r]);
+    }
+  }
+
+  std::vector<std::thread> processes;
+  for (int r = 0; r < num_processes; ++r) {
+    processes.emplace_back([&, r] {
+      thread_communicator communicator(group, r);
+      stan::services::util::run_cross_chain_adaptive_sampler(
+          samplers[r], model, process_inits[r], num_warmup, num_samples,
+          num_thin, refresh, save_warmup, process_rngs[r], interrupts[r],
+          loggers[r], writers[r], diagnostics[r], metrics[r],
+          1 + r * chains_per_process, 0, 0, &communicator);
+    });
+  }
+  for (auto& process : processes)
+    process.join();
+
+  sampler_t& first = samplers[0][0];
+  EXPECT_FALSE(first.z().inv_e_metric_.isOnes());
+  for (int r = 0; r < num_processes; ++r) {
+    for (size_t i = 0; i < chains_per_process; ++i) {
+      EXPECT_EQ(first.get_nominal_stepsize(),
+                samplers[r][i].get_nominal_stepsize());
+      EXPECT_EQ(first.z().inv_e_metric_, samplers[r][i].z().inv_e_metric_);
+      EXPECT_EQ(num_samples, writers[r][i].call_count("vector_double"));
+    }
+    EXPECT_EQ(1, loggers[r].find_info(
+                     "Largest potential scale reduction over the 4 chains "
+                     "of 2 processes"));
+  }
+}
+
+TEST(ServicesUtilStuckChains, flags_outlying_chains) {
+  std::vector<double> lp_means{-10, -11, -10.5, -40, -9.5, -10, -11};
+  std::vector<double> lp_sds{1, 1.2, 0.9, 0.1, 1.1, 1, 1};
+  std::vector<double> stepsizes{0.5, 0.6, 0.01, 0.55, 0.45, 0.5, 0.5};
+  std::vector<double> depths{3, 3.2, 3.1, 2.9, 9, 3, 3};
+  EXPECT_EQ(
+      std::vector<bool>({false, false, true, true, true, false, false}),
+      stan::services::util::stuck_chains(lp_means, lp_sds, stepsizes, depths,
+                                         5));
+  EXPECT_EQ(
+      std::vector<bool>({false, false, true, true, false, false, false}),
+      stan::services::util::stuck_chains(lp_means, lp_sds, stepsizes, {}, 5));
+}
+
+TEST(ServicesUtilStuckChains, healthy_chains) {
+  std::vector<double> lp_means{-10, -11, -10.5, -12, -9.5};
+  std::vector<double> lp_sds{1, 1.2, 0.9, 1, 1.1};
+  std::vector<double> stepsizes{0.5, 0.6, 0.4, 0.55, 0.45};
+  std::vector<double> depths{3, 3.2, 3.1, 2.9, 3};
+  EXPECT_EQ(std::vector<bool>(5, false),
+            stan::services::util::stuck_chains(lp_means, lp_sds, stepsizes,
+                                               depths, 5));
+}
+
+TEST(ServicesUtilStuckChains, no_majority_stuck) {
+  std::vector<double> lp_means{-10, -40, -41, -10.5};
+  std::vector<double> lp_sds{1, 1, 1, 1};
+  std::vector<double> stepsizes{0.5, 0.5, 0.5, 0.5};
+  EXPECT_EQ(std::vector<bool>(4, false),
+            stan::services::util::stuck_chains(lp_means, lp_sds, stepsizes,
+                                               {}, 5));
+  EXPECT_EQ(std::vector<bool>(2, false),
+            stan::services::util::stuck_chains({-10, -40}, {1, 1},
+                                               {0.5, 0.5}, {}, 5));
+}
+
+TEST_F(ServicesUtilCrossChain, stuck_chain_check_keeps_healthy_chains) {
+  auto samplers
+      = make_samplers<stan::mcmc::adapt_diag_e_nuts<stan_model, stan::rng_t>>();
+  stan::services::util::run_cross_chain_adaptive_sampler(
+      samplers, model, cont_vectors, num_warmup, num_samples, num_thin,
+      refresh, save_warmup, rngs, interrupt, logger, sample_writers,
+      diagnostic_writers, metric_writers, 1, 0, 0, nullptr, 1000);
+
+  EXPECT_EQ(0, logger.find_info("is stuck"));
+  for (size_t i = 1; i < num_chains; ++i)
+    EXPECT_TRUE(samplers[0].z().inv_e_metric_.isApprox(
+        samplers[i].z().inv_e_metric_));
+  for (size_t i = 0; i < num_chains; ++i)
+    EXPECT_EQ(num_samples, sample_writers[i].call_count("vector_double"));
+}
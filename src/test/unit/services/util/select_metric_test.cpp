@@ -0,0 +1,105 @@
+#include <stan/services/util/select_metric.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// draws of a Gaussian of the specified covariance
+std::vector<Eigen::VectorXd> normal_draws(const Eigen::MatrixXd& covar,
+                                          int num_draws) {
+  stan::rng_t rng = stan::services::util::create_rng(3, 1);
+  boost::random::normal_distribution<> std_normal;
+  Eigen::MatrixXd chol = covar.llt().matrixL();
+  std::vector<Eigen::VectorXd> draws;
+  for (int m = 0; m < num_draws; ++m) {
+    Eigen::VectorXd z(covar.rows());
+    for (int i = 0; i < z.size(); ++i)
+      z(i) = std_normal(rng);
+    draws.push_back(chol * z);
+  }
+  return draws;
+}
+}  // namespace
+
+TEST(ServicesUtilSelectMetric, independent_is_diag) {
+  Eigen::VectorXd sd = Eigen::VectorXd::LinSpaced(5, 0.1, 10);
+  Eigen::MatrixXd covar = sd.cwiseProduct(sd).asDiagonal();
+  stan::services::util::metric_selection selection
+      = stan::services::util::select_metric(normal_draws(covar, 200), 1e-6,
+                                            1e-8, 2);
+  EXPECT_EQ("diag_e", selection.metric);
+  EXPECT_LT(selection.condition_diag, 3);
+  EXPECT_LT(selection.cost_diag, selection.cost_dense);
+  ASSERT_EQ(5, selection.covariance.rows());
+  for (int i = 0; i < 5; ++i)
+    EXPECT_NEAR(1, selection.covariance(i, i) / (sd(i) * sd(i)), 0.3);
+}
+
+TEST(ServicesUtilSelectMetric, correlated_is_dense) {
+  Eigen::MatrixXd covar = Eigen::MatrixXd::Constant(4, 4, 0.95);
+  covar.diagonal().setOnes();
+  covar(0, 1) = covar(1, 0) = -0.5;
+  stan::services::util::metric_selection selection
+      = stan::services::util::select_metric(normal_draws(covar, 200), 1e-6,
+                                            1e-8, 0);
+  EXPECT_EQ("dense_e", selection.metric);
+  EXPECT_GT(selection.condition_diag, 10);
+  EXPECT_TRUE(std::isinf(selection.cost_lowrank));
+  EXPECT_EQ(0, selection.lowrank_factor.cols());
+}
+
+TEST(ServicesUtilSelectMetric, dominant_direction_is_lowrank) {
+  // a single strong correlation among many parameters, whose dense
+  // products cost more than the gradient
+  const int n = 50;
+  Eigen::MatrixXd covar = Eigen::MatrixXd::Identity(n, n);
+  Eigen::VectorXd u = Eigen::VectorXd::Constant(n, 1);
+  covar += 4 * u * u.transpose();
+  std::vector<Eigen::VectorXd> draws = normal_draws(covar, 400);
+  stan::services::util::metric_selection selection
+      = stan::services::util::select_metric(draws, 1e-6, 1e-5, 1);
+  EXPECT_EQ("lowrank_e", selection.metric);
+  EXPECT_LT(selection.condition_lowrank, selection.condition_diag);
+  ASSERT_EQ(n, selection.lowrank_factor.rows());
+  ASSERT_EQ(1, selection.lowrank_factor.cols());
+  // the correction is along the common direction
+  Eigen::VectorXd v = selection.lowrank_factor.col(0).normalized();
+  EXPECT_NEAR(1, std::abs(v.dot(u.normalized())), 0.05);
+
+  // without the low-rank metric, the dense one is too slow to pay off
+  EXPECT_EQ("diag_e",
+            stan::services::util::select_metric(draws, 1e-6, 1e-3, 0).metric);
+}
+
+TEST(ServicesUtilSelectMetric, few_draws_cannot_be_dense) {
+  Eigen::MatrixXd covar = Eigen::MatrixXd::Constant(10, 10, 0.99);
+  covar.diagonal().setOnes();
+  stan::services::util::metric_selection selection
+      = stan::services::util::select_metric(normal_draws(covar, 8), 1e-6, 0,
+                                            0);
+  EXPECT_TRUE(std::isinf(selection.condition_dense));
+  EXPECT_EQ("diag_e", selection.metric);
+}
+
+TEST(ServicesUtilSelectMetric, throws) {
+  using stan::services::util::select_metric;
+  std::vector<Eigen::VectorXd> draws(1, Eigen::VectorXd::Zero(2));
+  EXPECT_THROW(select_metric(draws, 1, 1, 0), std::invalid_argument);
+  draws.push_back(Eigen::VectorXd::Zero(3));
+  EXPECT_THROW(select_metric(draws, 1, 1, 0), std::invalid_argument);
+  draws[1] = Eigen::VectorXd::Zero(2);
+  EXPECT_THROW(select_metric(draws, 1, 1, -1), std::invalid_argument);
+  draws[1](0) = std::numeric_limits<double>::quiet_NaN();
+  EXPECT_THROW(select_metric(draws, 1, 1, 0), std::domain_error);
+}
+
+TEST(ServicesUtilSelectMetric, time_dense_product) {
+  EXPECT_EQ(0, stan::services::util::time_dense_product(0));
+  double t = stan::services::util::time_dense_product(100);
+  EXPECT_GT(t, 0);
+  EXPECT_LT(t, 1e-2);
+}
@@ -0,0 +1,152 @@
+#include <stan/services/util/service_host.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/model/analytic_gradient_model.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+std::shared_ptr<const stan::io::var_context> make_data(
+    const std::vector<double>& y) {
+  std::vector<std::string> names{"y"};
+  std::vector<std::vector<size_t>> dims{{y.size()}};
+  return std::make_shared<stan::io::array_var_context>(names, y, dims);
+}
+
+// normal log density centred on the mean of y, which can be rebound to
+// new y of the same size
+class mean_model : public stan::model::analytic_gradient_model {
+ public:
+  explicit mean_model(const stan::io::var_context& data)
+      : analytic_gradient_model(
+          "mean", {"mu"}, {{}},
+          [this](const Eigen::VectorXd& x) {
+            return -0.5 * (x(0) - mean_) * (x(0) - mean_);
+          },
+          [this](const Eigen::VectorXd& x, Eigen::VectorXd& grad) {
+            grad = Eigen::VectorXd::Constant(1, mean_ - x(0));
+            return -0.5 * (x(0) - mean_) * (x(0) - mean_);
+          }) {
+    read(data);
+  }
+
+  double mean() const { return mean_; }
+
+  void get_data_dims(std::vector<std::string>& names,
+                     std::vector<std::vector<size_t>>& dimss) const {
+    names = {"y"};
+    dimss = {{size_}};
+  }
+
+  bool rebind_data(const stan::io::var_context& data, std::ostream* msgs) {
+    read(data);
+    return true;
+  }
+
+ private:
+  size_t size_ = 0;
+  double mean_ = 0;
+
+  void read(const stan::io::var_context& data) {
+    std::vector<double> y = data.vals_r("y");
+    if (y.empty())
+      throw std::domain_error("y is empty");
+    size_ = y.size();
+    mean_ = 0;
+    for (double y_n : y)
+      mean_ += y_n / y.size();
+  }
+};
+
+stan::services::util::service_host::model_factory mean_factory() {
+  return [](const stan::io::var_context& data, unsigned int seed,
+            std::ostream* msgs) -> std::unique_ptr<stan::model::model_base> {
+    return std::make_unique<mean_model>(data);
+  };
+}
+
+// a service returning OK and recording the mean of the model
+struct mean_service {
+  double& mean;
+
+  int operator()(stan::model::model_base& model,
+                 stan::services::util::service_workspace& workspace) const {
+    mean = dynamic_cast<mean_model&>(model).mean();
+    ++workspace.get<int>([]() { return std::make_unique<int>(0); });
+    return stan::services::error_codes::OK;
+  }
+};
+}  // namespace
+
+TEST(ServicesUtilServiceHost, keeps_the_model_between_requests) {
+  stan::services::util::service_host host(2);
+  EXPECT_EQ(2, host.num_threads());
+  host.add_model("mean", mean_factory());
+  host.add_data("y", make_data({1, 2, 3}));
+  stan::test::unit::instrumented_logger logger;
+
+  double mean = 0;
+  int count = 0;
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(stan::services::error_codes::OK,
+              host.run("mean", "y", 0, logger,
+                       [&](stan::model::model_base& model,
+                           stan::services::util::service_workspace& ws) {
+                         count = ++ws.get<int>(
+                             []() { return std::make_unique<int>(0); });
+                         return mean_service{mean}(model, ws);
+                       }));
+  EXPECT_FLOAT_EQ(2, mean);
+  EXPECT_EQ(1U, host.num_constructions("mean"));
+  // the workspace was kept, so its counter was bumped twice per request
+  EXPECT_EQ(5, count);
+}
+
+TEST(ServicesUtilServiceHost, rebinds_new_data) {
+  stan::services::util::service_host host;
+  host.add_model("mean", mean_factory());
+  host.add_data("a", make_data({1, 2, 3}));
+  host.add_data("b", make_data({4, 5, 6}));
+  host.add_data("c", make_data({1}));
+  stan::test::unit::instrumented_logger logger;
+
+  double mean = 0;
+  EXPECT_EQ(0, host.run("mean", "a", 0, logger, mean_service{mean}));
+  EXPECT_EQ(0, host.run("mean", "b", 0, logger, mean_service{mean}));
+  EXPECT_FLOAT_EQ(5, mean);
+  EXPECT_EQ(1U, host.num_constructions("mean"));
+
+  // data of another size cannot be rebound, so the model is constructed
+  EXPECT_EQ(0, host.run("mean", "c", 0, logger, mean_service{mean}));
+  EXPECT_FLOAT_EQ(1, mean);
+  EXPECT_EQ(2U, host.num_constructions("mean"));
+}
+
+TEST(ServicesUtilServiceHost, errors) {
+  stan::services::util::service_host host;
+  stan::test::unit::instrumented_logger logger;
+  double mean = 0;
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            host.run("mean", "y", 0, logger, mean_service{mean}));
+  EXPECT_EQ(1U, logger.find_error("Model mean is not registered"));
+
+  host.add_model("mean", mean_factory());
+  EXPECT_EQ(stan::services::error_codes::CONFIG,
+            host.run("mean", "y", 0, logger, mean_service{mean}));
+  EXPECT_EQ(1U, logger.find_error("Data y is not registered"));
+
+  host.add_data("y", make_data({}));
+  EXPECT_EQ(stan::services::error_codes::SOFTWARE,
+            host.run("mean", "y", 0, logger, mean_service{mean}));
+  EXPECT_EQ(1U, logger.find_error("y is empty"));
+  EXPECT_EQ(0U, host.num_constructions("mean"));
+
+  EXPECT_TRUE(host.remove_model("mean"));
+  EXPECT_FALSE(host.remove_model("mean"));
+  EXPECT_TRUE(host.remove_data("y"));
+  EXPECT_THROW(host.add_model("mean", nullptr), std::invalid_argument);
+  EXPECT_THROW(host.add_data("y", nullptr), std::invalid_argument);
+}
@@ -0,0 +1,48 @@
+#include <stan/services/util/setup_chains.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ServicesUtilSetupChains, logs_in_chain_order) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  std::vector<int> results(4, 0);
+  EXPECT_TRUE(stan::services::util::setup_chains(
+      4, 1, logger, [&](size_t i, stan::callbacks::logger& chain_logger) {
+        // the first chains finish last
+        std::this_thread::sleep_for(std::chrono::milliseconds(5 * (4 - i)));
+        chain_logger.info("chain " + std::to_string(i));
+        results[i] = i + 1;
+      }));
+  EXPECT_EQ("chain 0\nchain 1\nchain 2\nchain 3\n", info.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4}), results);
+}
+
+TEST(ServicesUtilSetupChains, reports_every_failed_chain) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+  std::vector<char> done(5, false);
+  EXPECT_FALSE(stan::services::util::setup_chains(
+      5, 1, logger, [&](size_t i, stan::callbacks::logger& chain_logger) {
+        if (i % 2 == 1) {
+          chain_logger.error("Rejecting initial value");
+          throw std::domain_error("Initialization failed.");
+        }
+        done[i] = true;
+      }));
+  // the other chains were set up all the same
+  EXPECT_EQ((std::vector<char>{true, false, true, false, true}), done);
+  EXPECT_EQ(
+      "Rejecting initial value\n"
+      "Chain 2: Initialization failed.\n"
+      "Rejecting initial value\n"
+      "Chain 4: Initialization failed.\n"
+      "Setup failed for 2 of 5 chains.\n",
+      error.str());
+}
@@ -0,0 +1,65 @@
+#include <stan/services/util/shared_contexts.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/services/util/read_dense_inv_metric.hpp>
+#include <stan/services/util/read_diag_inv_metric.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+stan::io::array_var_context make_context(std::vector<double> vals,
+                                         std::vector<size_t> dims) {
+  std::vector<std::string> names{"inv_metric"};
+  std::vector<std::vector<size_t>> dimss{dims};
+  return stan::io::array_var_context(names, vals, dimss);
+}
+}  // namespace
+
+TEST(shared_contexts, one_context_per_chain) {
+  stan::io::array_var_context context = make_context({1, 2}, {2});
+  std::vector<const stan::io::array_var_context*> contexts
+      = stan::services::util::shared_contexts(context, 3);
+  ASSERT_EQ(3, contexts.size());
+  for (const auto* chain_context : contexts)
+    EXPECT_EQ(&context, chain_context);
+  EXPECT_FALSE(stan::services::util::shares_previous_context(contexts, 0));
+  EXPECT_TRUE(stan::services::util::shares_previous_context(contexts, 1));
+  EXPECT_TRUE(stan::services::util::shares_previous_context(contexts, 2));
+}
+
+TEST(shared_contexts, distinct_contexts) {
+  std::vector<std::unique_ptr<stan::io::array_var_context>> contexts;
+  contexts.emplace_back(std::make_unique<stan::io::array_var_context>(
+      make_context({1, 2}, {2})));
+  contexts.emplace_back(std::make_unique<stan::io::array_var_context>(
+      make_context({1, 2}, {2})));
+  EXPECT_FALSE(stan::services::util::shares_previous_context(contexts, 1));
+}
+
+TEST(shared_contexts, read_dense_inv_metric) {
+  std::stringstream out;
+  stan::callbacks::stream_logger logger(out, out, out, out, out);
+  stan::io::array_var_context context
+      = make_context({2, 0.5, 0.5, 3}, {2, 2});
+  Eigen::MatrixXd inv_metric
+      = stan::services::util::read_dense_inv_metric(context, 2, logger);
+  Eigen::MatrixXd expected(2, 2);
+  expected << 2, 0.5, 0.5, 3;
+  EXPECT_EQ(expected, inv_metric);
+  EXPECT_THROW(stan::services::util::read_dense_inv_metric(context, 3, logger),
+               std::domain_error);
+}
+
+TEST(shared_contexts, read_diag_inv_metric) {
+  std::stringstream out;
+  stan::callbacks::stream_logger logger(out, out, out, out, out);
+  stan::io::array_var_context context = make_context({2, 3, 4}, {3});
+  Eigen::VectorXd inv_metric
+      = stan::services::util::read_diag_inv_metric(context, 3, logger);
+  Eigen::VectorXd expected(3);
+  expected << 2, 3, 4;
+  EXPECT_EQ(expected, inv_metric);
+}
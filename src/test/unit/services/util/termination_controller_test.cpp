@@ -0,0 +1,151 @@
+#include <stan/services/util/termination_controller.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+void write_draws(stan::callbacks::writer& monitor, boost::ecuyer1988& rng,
+                 int num_draws, double mean) {
+  boost::normal_distribution<> normal;
+  for (int i = 0; i < num_draws; ++i)
+    monitor(std::vector<double>{-1.0 * i, mean + normal(rng)});
+}
+}  // namespace
+
+TEST(ServicesUtilTerminationController, stops_at_target_ess) {
+  boost::ecuyer1988 rng(1234);
+  stan::services::util::termination_controller controller(2, 400, 1.05);
+  std::vector<std::string> names{"lp__", "theta"};
+  for (size_t chain = 0; chain < 2; ++chain) {
+    controller.monitor(chain)(names);
+    write_draws(controller.monitor(chain), rng, 50, 10);
+    controller.monitor(chain)(std::string("Adaptation terminated"));
+  }
+  EXPECT_FALSE(controller.check());
+  EXPECT_TRUE(std::isnan(controller.last_min_ess()));
+
+  for (size_t chain = 0; chain < 2; ++chain)
+    write_draws(controller.monitor(chain), rng, 100, 0);
+  EXPECT_FALSE(controller.check());
+  EXPECT_LT(controller.last_min_ess(), 400);
+
+  for (size_t chain = 0; chain < 2; ++chain)
+    write_draws(controller.monitor(chain), rng, 300, 0);
+  for (int i = 0; i < 99; ++i)
+    controller();
+  EXPECT_FALSE(controller.stop_requested());
+  controller();
+  EXPECT_TRUE(controller.stop_requested());
+  EXPECT_FALSE(controller.deadline_reached());
+  // lp__ decreases steadily but is not monitored
+  EXPECT_GT(controller.last_min_ess(), 400);
+  EXPECT_LT(controller.last_max_rhat(), 1.05);
+}
+
+TEST(ServicesUtilTerminationController, chains_that_disagree_continue) {
+  boost::ecuyer1988 rng(1234);
+  stan::services::util::termination_controller controller(
+      2, 100, 1.01, std::numeric_limits<double>::infinity(), {"theta"});
+  for (size_t chain = 0; chain < 2; ++chain) {
+    controller.monitor(chain)(std::vector<std::string>{"lp__", "theta"});
+    write_draws(controller.monitor(chain), rng, 1000, 2.0 * chain);
+  }
+  EXPECT_FALSE(controller.check());
+  EXPECT_GT(controller.last_min_ess(), 100);
+  EXPECT_GT(controller.last_max_rhat(), 1.1);
+}
+
+TEST(ServicesUtilTerminationController, stops_at_deadline) {
+  stan::services::util::termination_controller controller(1, 400, 1.01, 0);
+  controller();
+  EXPECT_TRUE(controller.stop_requested());
+  EXPECT_TRUE(controller.deadline_reached());
+}
+
+TEST(ServicesUtilTerminationController, concurrent_chains) {
+  const size_t num_chains = 4;
+  stan::services::util::termination_controller controller(
+      num_chains, 200, 1.05, std::numeric_limits<double>::infinity(), {}, 50);
+  std::vector<std::thread> threads;
+  std::vector<int> num_draws(num_chains, 0);
+  for (size_t chain = 0; chain < num_chains; ++chain)
+    threads.emplace_back([&, chain]() {
+      boost::ecuyer1988 rng(chain + 1);
+      controller.monitor(chain)(std::vector<std::string>{"theta"});
+      for (int i = 0; i < 100000 && !controller.stop_requested(); ++i) {
+        controller();
+        write_draws(controller.monitor(chain), rng, 1, 0);
+        ++num_draws[chain];
+      }
+    });
+  for (std::thread& thread : threads)
+    thread.join();
+  EXPECT_TRUE(controller.stop_requested());
+  for (int n : num_draws)
+    EXPECT_LT(n, 100000);
+}
+
+TEST(ServicesUtilTerminationController, invalid_arguments) {
+  EXPECT_THROW(stan::services::util::termination_controller(0, 400),
+               std::invalid_argument);
+  EXPECT_THROW(stan::services::util::termination_controller(
+                   1, 400, 1.01, 10, {}, 0),
+               std::invalid_argument);
+}
+
+TEST(ServicesUtilTerminationController, multivariate_ess_target) {
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  stan::services::util::termination_controller controller(
+      2, 100, 1.05, std::numeric_limits<double>::infinity(), {"a", "b"});
+  controller.set_min_multivariate_ess(3000);
+  for (size_t chain = 0; chain < 2; ++chain) {
+    controller.monitor(chain)(
+        std::vector<std::string>{"lp__", "a", "b", "c"});
+    for (int i = 0; i < 1000; ++i)
+      controller.monitor(chain)(std::vector<double>{
+          -1.0 * i, normal(rng), normal(rng), -1.0 * i});
+  }
+  EXPECT_FALSE(controller.check());
+  EXPECT_GT(controller.last_min_ess(), 100);
+  EXPECT_LT(controller.last_multivariate_ess(), 3000);
+
+  for (size_t chain = 0; chain < 2; ++chain)
+    for (int i = 0; i < 2000; ++i)
+      controller.monitor(chain)(
+          std::vector<double>{0, normal(rng), normal(rng), -1.0 * i});
+  EXPECT_TRUE(controller.check());
+  EXPECT_GT(controller.last_multivariate_ess(), 3000);
+}
+
+TEST(ServicesUtilTerminationController, energy_targets) {
+  boost::ecuyer1988 rng(1234);
+  boost::normal_distribution<> normal;
+  stan::services::util::termination_controller controller(1, 100, 1.05);
+  controller.set_energy_targets(0.3, 0.05);
+  controller.monitor(0)(
+      std::vector<std::string>{"lp__", "divergent__", "energy__", "theta"});
+  for (int i = 0; i < 1000; ++i)
+    controller.monitor(0)(std::vector<double>{
+        0, i % 10 == 0 ? 1.0 : 0.0, normal(rng), normal(rng)});
+  EXPECT_FALSE(controller.check());
+  EXPECT_FLOAT_EQ(0.1, controller.last_divergence_rate());
+  EXPECT_GT(controller.last_min_ebfmi(), 0.3);
+
+  controller.monitor(0)(std::string("Adaptation terminated"));
+  for (int i = 0; i < 1000; ++i)
+    controller.monitor(0)(
+        std::vector<double>{0, 0, std::sin(i / 100.0), normal(rng)});
+  EXPECT_FALSE(controller.check());
+  EXPECT_FLOAT_EQ(0, controller.last_divergence_rate());
+  EXPECT_LT(controller.last_min_ebfmi(), 0.3);
+
+  controller.set_energy_targets(0, 0.05);
+  EXPECT_TRUE(controller.check());
+}
@@ -0,0 +1,45 @@
+#include <stan/services/util/warmup_converged.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/additive_combine.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <vector>
+
+class ServicesUtilWarmupConverged : public testing::Test {
+ public:
+  ServicesUtilWarmupConverged() : rng(1234) {
+    for (int chain = 0; chain < 4; ++chain) {
+      draws.emplace_back(400, 3);
+      for (int m = 0; m < 400; ++m)
+        for (int col = 0; col < 3; ++col)
+          draws[chain](m, col) = boost::normal_distribution<>()(rng);
+    }
+  }
+
+  boost::ecuyer1988 rng;
+  std::vector<Eigen::MatrixXd> draws;
+};
+
+TEST_F(ServicesUtilWarmupConverged, independent_draws) {
+  EXPECT_TRUE(stan::services::util::warmup_converged(draws, 0, 400, 1.05,
+                                                     100));
+  EXPECT_TRUE(stan::services::util::warmup_converged(draws, 200, 400, 1.05,
+                                                     100));
+}
+
+TEST_F(ServicesUtilWarmupConverged, shifted_chain) {
+  draws[2].col(1).array() += 5;
+  EXPECT_FALSE(stan::services::util::warmup_converged(draws, 0, 400, 1.05,
+                                                      100));
+}
+
+TEST_F(ServicesUtilWarmupConverged, ess_threshold) {
+  EXPECT_FALSE(stan::services::util::warmup_converged(draws, 0, 400, 1.05,
+                                                      1e6));
+}
+
+TEST_F(ServicesUtilWarmupConverged, too_few_draws) {
+  EXPECT_FALSE(stan::services::util::warmup_converged(draws, 0, 3, 10, 0));
+  std::vector<Eigen::MatrixXd> no_chains;
+  EXPECT_FALSE(stan::services::util::warmup_converged(no_chains, 0, 400, 10,
+                                                      0));
+}
@@ -0,0 +1,80 @@
+#include <stan/services/util/workspace.hpp>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+
+TEST(ServicesUtilWorkspace, maps_are_aligned_and_disjoint) {
+  stan::services::util::workspace ws(1024);
+  auto a = ws.matrix(3, 5);
+  auto v = ws.vector(7);
+  EXPECT_EQ(3, a.rows());
+  EXPECT_EQ(5, a.cols());
+  EXPECT_EQ(7, v.size());
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(a.data()) % 64);
+  EXPECT_EQ(0, reinterpret_cast<std::uintptr_t>(v.data()) % 64);
+  EXPECT_GE(v.data(), a.data() + a.size());
+
+  a.setConstant(1);
+  v.setConstant(2);
+  EXPECT_EQ(15, a.sum());
+  EXPECT_EQ(14, v.sum());
+  EXPECT_EQ(192, ws.bytes_used());
+}
+
+TEST(ServicesUtilWorkspace, scope_rewinds_and_reuses) {
+  stan::services::util::workspace ws(1024);
+  double* first = nullptr;
+  for (int iteration = 0; iteration < 3; ++iteration) {
+    stan::services::util::workspace_scope scope(ws);
+    auto m = scope.get().matrix(10, 10);
+    if (iteration == 0)
+      first = m.data();
+    EXPECT_EQ(first, m.data());
+    {
+      stan::services::util::workspace_scope nested(ws);
+      nested.get().vector(100);
+      EXPECT_EQ(1024 + 832, ws.bytes_used());
+    }
+    EXPECT_EQ(832, ws.bytes_used());
+  }
+  EXPECT_EQ(0, ws.bytes_used());
+  EXPECT_EQ(2, ws.num_blocks());
+}
+
+TEST(ServicesUtilWorkspace, growth_keeps_maps) {
+  stan::services::util::workspace ws(64);
+  auto small = ws.vector(8);
+  small.setLinSpaced(8, 0, 7);
+  auto large = ws.matrix(100, 100);
+  large.setZero();
+  EXPECT_EQ(2, ws.num_blocks());
+  EXPECT_GE(ws.bytes_reserved(), 64 + 80000);
+  for (int i = 0; i < 8; ++i)
+    EXPECT_EQ(i, small(i));
+
+  ws.reset();
+  EXPECT_EQ(0, ws.bytes_used());
+  ws.matrix(100, 100);
+  EXPECT_EQ(2, ws.num_blocks());
+}
+
+TEST(ServicesUtilWorkspace, local_is_per_thread) {
+  stan::services::util::workspace* main_ws
+      = &stan::services::util::workspace::local();
+  EXPECT_EQ(main_ws, &stan::services::util::workspace::local());
+  stan::services::util::workspace* other_ws = nullptr;
+  std::thread thread(
+      [&] { other_ws = &stan::services::util::workspace::local(); });
+  thread.join();
+  EXPECT_NE(main_ws, other_ws);
+
+  stan::services::util::workspace_scope scope;
+  EXPECT_EQ(main_ws, &scope.get());
+  const std::size_t used = main_ws->bytes_used();
+  {
+    stan::services::util::workspace_scope nested;
+    nested.get().vector(4);
+    EXPECT_EQ(used + 64, main_ws->bytes_used());
+  }
+  EXPECT_EQ(used, main_ws->bytes_used());
+}
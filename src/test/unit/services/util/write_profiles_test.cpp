@@ -0,0 +1,80 @@
+#include <stan/services/util/write_profiles.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+// records the keys and counts written, one line each
+class recording_writer : public stan::callbacks::structured_writer {
+ public:
+  std::stringstream out;
+
+  void begin_record(const std::string& key) { out << key << " {\n"; }
+  void end_record() { out << "}\n"; }
+  void write(const std::string& key, std::size_t value) {
+    out << key << " " << value << "\n";
+  }
+  void write(const std::string& key, double value) {
+    out << key << "\n";
+  }
+};
+
+void run_region(const std::string& name, stan::math::profile_map& profiles) {
+  stan::math::profile<double> profile(name, profiles);
+}
+
+struct mock_model {
+  const stan::math::profile_map* profiles = nullptr;
+
+  const stan::math::profile_map* profile_data() const { return profiles; }
+};
+}  // namespace
+
+TEST(ServicesUtilWriteProfiles, summarize_profiles) {
+  stan::math::profile_map profiles;
+  run_region("b", profiles);
+  run_region("a", profiles);
+  run_region("a", profiles);
+  std::thread other([&]() { run_region("a", profiles); });
+  other.join();
+
+  const std::vector<stan::services::util::profile_summary> summaries
+      = stan::services::util::summarize_profiles(profiles);
+  ASSERT_EQ(2U, summaries.size());
+  EXPECT_EQ("a", summaries[0].name);
+  EXPECT_EQ(2U, summaries[0].num_threads);
+  EXPECT_EQ(3U, summaries[0].no_autodiff_calls);
+  EXPECT_EQ(0U, summaries[0].autodiff_calls);
+  EXPECT_EQ("b", summaries[1].name);
+  EXPECT_EQ(1U, summaries[1].num_threads);
+  EXPECT_EQ(1U, summaries[1].no_autodiff_calls);
+  EXPECT_LE(0, summaries[1].forward_time);
+}
+
+TEST(ServicesUtilWriteProfiles, write_profiles) {
+  stan::math::profile_map profiles;
+  run_region("a", profiles);
+  recording_writer writer;
+  mock_model model;
+  EXPECT_FALSE(stan::services::util::write_profiles(writer, model));
+  EXPECT_EQ("", writer.out.str());
+
+  model.profiles = &profiles;
+  EXPECT_TRUE(stan::services::util::write_profiles(writer, model));
+  EXPECT_EQ(
+      "profiles {\n"
+      "a {\n"
+      "threads 1\n"
+      "total_time\n"
+      "forward_time\n"
+      "reverse_time\n"
+      "autodiff_calls 0\n"
+      "no_autodiff_calls 1\n"
+      "reverse_calls 0\n"
+      "chain_stack 0\n"
+      "no_chain_stack 0\n"
+      "}\n"
+      "}\n",
+      writer.out.str());
+}
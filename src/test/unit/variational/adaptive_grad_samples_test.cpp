@@ -0,0 +1,126 @@
+#include <stan/variational/advi.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// standard normal target
+class std_normal_model : public stan::model::prob_grad {
+ public:
+  explicit std_normal_model(size_t num_params_r)
+      : stan::model::prob_grad(num_params_r) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    T lp = 0;
+    for (int n = 0; n < params_r.size(); ++n)
+      lp = lp + (-0.5) * params_r(n) * params_r(n);
+    return lp;
+  }
+
+  template <typename RNG>
+  void write_array(RNG& base_rng__, Eigen::VectorXd& params_r__,
+                   Eigen::VectorXd& vars__, bool include_tparams__ = true,
+                   bool include_gqs__ = true,
+                   std::ostream* pstream__ = 0) const {
+    vars__ = params_r__;
+  }
+};
+
+typedef stan::variational::advi<std_normal_model,
+                                stan::variational::normal_meanfield,
+                                stan::rng_t>
+    advi_meanfield;
+
+class adaptive_grad_samples_test : public testing::Test {
+ public:
+  adaptive_grad_samples_test()
+      : model(3),
+        rng(stan::services::util::create_rng(0, 1)),
+        logger(log_stream_, log_stream_, log_stream_, log_stream_,
+               log_stream_) {}
+
+  void SetUp() { cont_params = Eigen::VectorXd::Zero(3); }
+
+  std_normal_model model;
+  Eigen::VectorXd cont_params;
+  stan::rng_t rng;
+  std::stringstream log_stream_;
+  stan::callbacks::stream_logger logger;
+};
+
+TEST_F(adaptive_grad_samples_test, shrinks_far_from_optimum) {
+  advi_meanfield advi(model, cont_params, rng, 20, 100, 100, 1);
+  advi.set_adaptive_grad_samples(0.1, 100);
+  stan::variational::normal_meanfield q(Eigen::VectorXd::Constant(3, 50.0),
+                                        Eigen::VectorXd::Zero(3));
+  stan::variational::normal_meanfield grad(3), half(3);
+  EXPECT_EQ(10, advi.calc_ELBO_grad_adaptive(q, grad, half, 20, logger));
+  EXPECT_EQ(5, advi.calc_ELBO_grad_adaptive(q, grad, half, 10, logger));
+  EXPECT_EQ(2, advi.calc_ELBO_grad_adaptive(q, grad, half, 2, logger));
+}
+
+TEST_F(adaptive_grad_samples_test, grows_at_optimum) {
+  advi_meanfield advi(model, cont_params, rng, 20, 100, 100, 1);
+  advi.set_adaptive_grad_samples(16.0, 100);
+  // the exact posterior, where the gradient is all noise
+  stan::variational::normal_meanfield q(Eigen::VectorXd::Zero(3),
+                                        Eigen::VectorXd::Zero(3));
+  stan::variational::normal_meanfield grad(3), half(3);
+  EXPECT_EQ(40, advi.calc_ELBO_grad_adaptive(q, grad, half, 20, logger));
+  EXPECT_EQ(100, advi.calc_ELBO_grad_adaptive(q, grad, half, 80, logger));
+}
+
+TEST_F(adaptive_grad_samples_test, gradient_is_mean_of_halves) {
+  stan::rng_t rng_halves = rng;
+  advi_meanfield advi(model, cont_params, rng, 20, 100, 100, 1);
+  advi.set_adaptive_grad_samples(4.0, 100);
+  stan::variational::normal_meanfield q(Eigen::VectorXd::Constant(3, 1.5),
+                                        Eigen::VectorXd::Constant(3, -0.5));
+  stan::variational::normal_meanfield grad(3), half(3);
+  advi.calc_ELBO_grad_adaptive(q, grad, half, 7, logger);
+
+  stan::variational::normal_meanfield a(3), b(3);
+  q.calc_grad(a, model, cont_params, 3, rng_halves, logger);
+  q.calc_grad(b, model, cont_params, 4, rng_halves, logger);
+  for (int d = 0; d < 3; ++d) {
+    EXPECT_NEAR((3 * a.mu()(d) + 4 * b.mu()(d)) / 7, grad.mu()(d), 1e-10);
+    EXPECT_NEAR((3 * a.omega()(d) + 4 * b.omega()(d)) / 7, grad.omega()(d),
+                1e-10);
+  }
+}
+
+TEST_F(adaptive_grad_samples_test, invalid_settings) {
+  advi_meanfield advi(model, cont_params, rng, 1, 100, 100, 1);
+  EXPECT_THROW(advi.set_adaptive_grad_samples(-1.0, 100), std::domain_error);
+  EXPECT_THROW(advi.set_adaptive_grad_samples(4.0, 1), std::domain_error);
+  EXPECT_NO_THROW(advi.set_adaptive_grad_samples(0.0, 2));
+
+  stan::variational::normal_meanfield q(3), grad(3), half(3);
+  EXPECT_THROW(advi.calc_ELBO_grad_adaptive(q, grad, half, 1, logger),
+               std::domain_error);
+}
+
+TEST_F(adaptive_grad_samples_test, stochastic_gradient_ascent) {
+  cont_params = Eigen::VectorXd::Constant(3, 5.0);
+  advi_meanfield advi(model, cont_params, rng, 1, 100, 50, 1);
+  advi.set_adaptive_grad_samples(4.0, 50);
+  stan::variational::normal_meanfield q(cont_params);
+  std::stringstream diagnostics;
+  stan::callbacks::stream_writer diagnostic_writer(diagnostics);
+  advi.stochastic_gradient_ascent(q, 1.0, 0.01, 1000, logger,
+                                  diagnostic_writer);
+
+  EXPECT_NE(std::string::npos,
+            log_stream_.str().find(
+                "Mean number of Monte Carlo draws per gradient: "));
+  for (int d = 0; d < 3; ++d) {
+    EXPECT_NEAR(0, q.mu()(d), 0.5);
+    EXPECT_NEAR(0, q.omega()(d), 0.5);
+  }
+}
@@ -233,3 +233,41 @@ TEST(advi_test, multivar_no_constraint_meanfield) {
                                           n_monte_carlo_grad, base_rng, logger),
                    std::invalid_argument, error);
 }
+
+TEST(advi_test, multivar_no_constraint_parallel_matches_serial) {
+  stan::io::empty_var_context dummy_context;
+  Model my_model(dummy_context);
+  std::stringstream log_stream;
+  stan::callbacks::stream_logger logger(log_stream, log_stream, log_stream,
+                                        log_stream, log_stream);
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Constant(2, 0.75);
+  Eigen::VectorXd mu = Eigen::VectorXd::Constant(my_model.num_params_r(), 2.5);
+  Eigen::MatrixXd L_chol = Eigen::MatrixXd::Identity(my_model.num_params_r(),
+                                                     my_model.num_params_r());
+  stan::variational::normal_fullrank muL(mu, L_chol);
+
+  // the same draws are made either way, so the results are identical
+  stan::rng_t serial_rng = stan::services::util::create_rng(0, 0);
+  stan::rng_t parallel_rng = stan::services::util::create_rng(0, 0);
+  stan::variational::advi<Model, stan::variational::normal_fullrank,
+                          stan::rng_t>
+      serial_advi(my_model, cont_params, serial_rng, 50, 200, 100, 1);
+  stan::variational::advi<Model, stan::variational::normal_fullrank,
+                          stan::rng_t>
+      parallel_advi(my_model, cont_params, parallel_rng, 50, 200, 100, 1,
+                    true);
+
+  EXPECT_EQ(serial_advi.calc_ELBO(muL, logger),
+            parallel_advi.calc_ELBO(muL, logger));
+
+  stan::variational::normal_fullrank serial_grad(my_model.num_params_r());
+  stan::variational::normal_fullrank parallel_grad(my_model.num_params_r());
+  serial_advi.calc_ELBO_grad(muL, serial_grad, logger);
+  parallel_advi.calc_ELBO_grad(muL, parallel_grad, logger);
+  for (int i = 0; i < my_model.num_params_r(); ++i) {
+    EXPECT_EQ(serial_grad.mu()(i), parallel_grad.mu()(i));
+    for (int j = 0; j < my_model.num_params_r(); ++j) {
+      EXPECT_EQ(serial_grad.L_chol()(i, j), parallel_grad.L_chol()(i, j));
+    }
+  }
+}
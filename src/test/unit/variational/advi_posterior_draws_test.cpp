@@ -0,0 +1,131 @@
+#include <stan/variational/advi.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/uniform_01.hpp>
+#include <gtest/gtest.h>
+#include <tbb/task_arena.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+// standard normal target whose generated quantity is a uniform draw
+class gq_model : public stan::model::prob_grad {
+ public:
+  explicit gq_model(size_t num_params_r)
+      : stan::model::prob_grad(num_params_r) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    T lp = 0;
+    for (int i = 0; i < params_r.size(); ++i)
+      lp -= 0.5 * params_r(i) * params_r(i);
+    return lp;
+  }
+
+  template <typename RNG>
+  void write_array(RNG& base_rng__, std::vector<double>& params_r__,
+                   std::vector<int>& params_i__, std::vector<double>& vars__,
+                   bool include_tparams__ = true, bool include_gqs__ = true,
+                   std::ostream* pstream__ = 0) const {
+    vars__ = params_r__;
+    vars__.push_back(boost::uniform_01<double>()(base_rng__));
+    if (pstream__ && params_r__[0] > 2)
+      *pstream__ << "large " << params_r__[0];
+  }
+};
+
+class rows_writer : public stan::callbacks::writer {
+ public:
+  using stan::callbacks::writer::operator();
+  void operator()(const std::vector<double>& state) { rows.push_back(state); }
+  std::vector<std::vector<double>> rows;
+};
+
+class messages_logger : public stan::callbacks::logger {
+ public:
+  void info(const std::string& message) { messages.push_back(message); }
+  void info(const std::stringstream& message) {
+    messages.push_back(message.str());
+  }
+  std::vector<std::string> messages;
+};
+
+std::vector<std::vector<double>> run_advi(bool parallel,
+                                          messages_logger& logger) {
+  gq_model model(3);
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Zero(3);
+  stan::rng_t rng = stan::services::util::create_rng(7, 0);
+  stan::variational::advi<gq_model, stan::variational::normal_meanfield,
+                          stan::rng_t>
+      advi(model, cont_params, rng, 5, 10, 50, 1500, parallel);
+  rows_writer parameter_writer;
+  stan::callbacks::writer diagnostic_writer;
+  EXPECT_EQ(0, advi.run(0.1, false, 50, 0.01, 20, logger, parameter_writer,
+                        diagnostic_writer));
+  return parameter_writer.rows;
+}
+}  // namespace
+
+TEST(advi_posterior_draws_test, parallel_rows) {
+  messages_logger logger;
+  std::vector<std::vector<double>> rows = run_advi(true, logger);
+  // the mean followed by the draws
+  ASSERT_EQ(1501, rows.size());
+  for (const auto& row : rows)
+    ASSERT_EQ(7, row.size());
+  EXPECT_EQ(0, rows[0][1]);
+  EXPECT_EQ(0, rows[0][2]);
+  double sum_uniform = 0;
+  for (size_t n = 1; n < rows.size(); ++n) {
+    // log_p of the draw and the uniform generated quantity
+    const Eigen::Map<const Eigen::VectorXd> theta(&rows[n][3], 3);
+    EXPECT_FLOAT_EQ(-0.5 * theta.squaredNorm(), rows[n][1]);
+    EXPECT_GT(rows[n][6], 0);
+    EXPECT_LT(rows[n][6], 1);
+    sum_uniform += rows[n][6];
+  }
+  EXPECT_NEAR(0.5, sum_uniform / 1500, 0.05);
+  // the draws get distinct generators
+  EXPECT_NE(rows[1][6], rows[2][6]);
+}
+
+TEST(advi_posterior_draws_test, parallel_messages_in_order) {
+  messages_logger logger;
+  std::vector<std::vector<double>> rows = run_advi(true, logger);
+  std::vector<std::string> expected;
+  for (size_t n = 1; n < rows.size(); ++n)
+    if (rows[n][3] > 2) {
+      std::stringstream msg;
+      msg << "large " << rows[n][3];
+      expected.push_back(msg.str());
+    }
+  std::vector<std::string> found;
+  for (const auto& message : logger.messages)
+    if (message.compare(0, 6, "large ") == 0)
+      found.push_back(message);
+  EXPECT_FALSE(expected.empty());
+  EXPECT_EQ(expected, found);
+}
+
+TEST(advi_posterior_draws_test, parallel_independent_of_threads) {
+  messages_logger logger;
+  std::vector<std::vector<double>> rows = run_advi(true, logger);
+  std::vector<std::vector<double>> one_thread_rows;
+  tbb::task_arena arena(1);
+  arena.execute([&] { one_thread_rows = run_advi(true, logger); });
+  EXPECT_EQ(rows, one_thread_rows);
+}
+
+TEST(advi_posterior_draws_test, serial_unchanged) {
+  messages_logger logger;
+  std::vector<std::vector<double>> rows = run_advi(false, logger);
+  ASSERT_EQ(1501, rows.size());
+  for (size_t n = 1; n < rows.size(); ++n) {
+    const Eigen::Map<const Eigen::VectorXd> theta(&rows[n][3], 3);
+    EXPECT_FLOAT_EQ(-0.5 * theta.squaredNorm(), rows[n][1]);
+  }
+}
@@ -61,3 +61,15 @@ TEST_F(eta_adapt_big_test, eta_should_be_big) {
   EXPECT_EQ(100.0, advi_meanfield_->adapt_eta(meanfield_init, 50, logger));
   EXPECT_EQ(100.0, advi_fullrank_->adapt_eta(fullrank_init, 50, logger));
 }
+
+TEST_F(eta_adapt_big_test, concurrent_eta_should_be_big) {
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params_);
+  stan::variational::normal_fullrank fullrank_init
+      = stan::variational::normal_fullrank(cont_params_);
+
+  EXPECT_EQ(100.0,
+            advi_meanfield_->adapt_eta_concurrent(meanfield_init, 50, logger));
+  EXPECT_EQ(100.0,
+            advi_fullrank_->adapt_eta_concurrent(fullrank_init, 50, logger));
+}
@@ -69,3 +69,23 @@ TEST_F(eta_should_fail_test, eta_adapt_should_fail) {
   EXPECT_THROW_MSG(advi_fullrank_->adapt_eta(fullrank_init, 1, logger),
                    std::domain_error, error);
 }
+
+TEST_F(eta_should_fail_test, concurrent_eta_adapt_should_fail) {
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params_);
+  stan::variational::normal_fullrank fullrank_init
+      = stan::variational::normal_fullrank(cont_params_);
+
+  std::string error
+      = "stan::variational::advi::adapt_eta_concurrent: "
+        "All proposed step-sizes "
+        "failed. Your model may be either "
+        "severely ill-conditioned or misspecified.";
+
+  EXPECT_THROW_MSG(
+      advi_meanfield_->adapt_eta_concurrent(meanfield_init, 1, logger),
+      std::domain_error, error);
+  EXPECT_THROW_MSG(
+      advi_fullrank_->adapt_eta_concurrent(fullrank_init, 1, logger),
+      std::domain_error, error);
+}
@@ -293,6 +293,26 @@ TEST_F(eta_adapt_test, initialize_state_zero_grad_error) {
   delete advi_fullrank;
 }
 
+TEST_F(eta_adapt_test, concurrent_initialize_state_zero_negative_infinity) {
+  model.log_prob_return_value = -std::numeric_limits<double>::infinity();
+
+  stan::variational::advi<mock_model, stan::variational::normal_meanfield,
+                          mock_rng>
+      advi_meanfield(model, cont_params, rng, 1, 100, 100, 1, false, true);
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params);
+
+  std::string error
+      = "stan::variational::advi::adapt_eta_concurrent: "
+        "Cannot compute ELBO using the initial "
+        "variational distribution. "
+        "Your model may be either "
+        "severely ill-conditioned or misspecified.";
+  EXPECT_THROW_MSG(
+      advi_meanfield.adapt_eta_concurrent(meanfield_init, 10, logger),
+      std::domain_error, error);
+}
+
 // TEST_F(eta_adapt_test, gradient_warn_meanfield) {
 //   EXPECT_EQ(0, advi_meanfield_->run(0.1, false, 50, 0.01, 10000));
 //   SUCCEED() << "expecting it to compile and run without problems";
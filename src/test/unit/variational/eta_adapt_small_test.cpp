@@ -62,3 +62,16 @@ TEST_F(eta_adapt_small_test, eta_should_be_small) {
   EXPECT_EQ(0.1, advi_meanfield_->adapt_eta(meanfield_init, 1000, logger));
   EXPECT_EQ(0.1, advi_fullrank_->adapt_eta(fullrank_init, 1000, logger));
 }
+
+TEST_F(eta_adapt_small_test, concurrent_eta_should_be_small) {
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params_);
+  stan::variational::normal_fullrank fullrank_init
+      = stan::variational::normal_fullrank(cont_params_);
+
+  EXPECT_EQ(0.1, advi_meanfield_->adapt_eta_concurrent(meanfield_init, 1000,
+                                                       logger));
+  EXPECT_EQ(0.1,
+            advi_fullrank_->adapt_eta_concurrent(fullrank_init, 1000, logger));
+  EXPECT_NE(std::string::npos, log_stream_.str().find("eta = 1: ELBO = "));
+}
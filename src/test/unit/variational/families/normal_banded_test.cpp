@@ -0,0 +1,205 @@
+#include <stan/variational/families/normal_banded.hpp>
+#include <stan/variational/families/normal_fullrank.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <limits>
+#include <vector>
+
+namespace {
+// standard normal target, or a flat one whose gradient is zero
+class normal_model : public stan::model::prob_grad {
+ public:
+  normal_model(size_t num_params_r, bool flat)
+      : stan::model::prob_grad(num_params_r), flat_(flat) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    T lp = 0;
+    if (!flat_)
+      for (int i = 0; i < params_r.size(); ++i)
+        lp -= 0.5 * params_r(i) * params_r(i);
+    return lp;
+  }
+
+ private:
+  bool flat_;
+};
+
+// bandwidth 2 over 5 dimensions; the first row of the first column and
+// the first two rows of the second fall outside the factor
+stan::variational::normal_banded example() {
+  Eigen::VectorXd mu(5);
+  mu << 5.7, -3.2, 0.1332, 1.0, -0.4;
+  Eigen::VectorXd omega(5);
+  omega << -0.42, 0.8922, 0.4, -1.1, 0.2;
+  Eigen::MatrixXd band(5, 2);
+  band << 9, 9, 0.3, 9, -0.7, 0.2, 0.5, -0.1, 0.6, 0.05;
+  return stan::variational::normal_banded(mu, omega, band);
+}
+
+Eigen::MatrixXd covariance(const stan::variational::normal_banded& q) {
+  Eigen::MatrixXd L = q.L_chol_precision();
+  return (L * L.transpose()).inverse();
+}
+}  // namespace
+
+TEST(normal_banded_test, zero_init) {
+  stan::variational::normal_banded q(10, 3);
+  EXPECT_EQ(10, q.dimension());
+  EXPECT_EQ(3, q.bandwidth());
+  EXPECT_EQ(10, q.draw_dimension());
+  EXPECT_EQ(0.0, q.mu().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.omega().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.band().cwiseAbs().maxCoeff());
+  EXPECT_MATRIX_EQ(Eigen::MatrixXd::Identity(10, 10), q.L_chol_precision());
+}
+
+TEST(normal_banded_test, cont_params_init) {
+  Eigen::VectorXd cont_params = Eigen::VectorXd::LinSpaced(5, -1, 1);
+  stan::variational::normal_banded q(cont_params, 2);
+  EXPECT_MATRIX_EQ(cont_params, q.mean());
+  EXPECT_EQ(0.0, q.omega().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.band().cwiseAbs().maxCoeff());
+  EXPECT_EQ(2, q.band().cols());
+
+  q.set_to_zero();
+  EXPECT_EQ(0.0, q.mu().cwiseAbs().maxCoeff());
+}
+
+TEST(normal_banded_test, validation) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  stan::variational::normal_banded q = example();
+  Eigen::VectorXd v = Eigen::VectorXd::Zero(5);
+  Eigen::MatrixXd band = Eigen::MatrixXd::Zero(5, 2);
+  EXPECT_THROW(q.set_mu(Eigen::VectorXd::Constant(5, nan)), std::domain_error);
+  EXPECT_THROW(q.set_mu(Eigen::VectorXd::Zero(3)), std::invalid_argument);
+  EXPECT_THROW(q.set_omega(Eigen::VectorXd::Constant(5, nan)),
+               std::domain_error);
+  EXPECT_THROW(q.set_band(Eigen::MatrixXd::Zero(5, 3)),
+               std::invalid_argument);
+  EXPECT_THROW(q.set_band(Eigen::MatrixXd::Constant(5, 2, nan)),
+               std::domain_error);
+  Eigen::VectorXd short_omega = Eigen::VectorXd::Zero(3);
+  EXPECT_THROW(stan::variational::normal_banded(v, short_omega, band),
+               std::invalid_argument);
+  EXPECT_THROW(q = stan::variational::normal_banded(5, 1),
+               std::invalid_argument);
+  EXPECT_THROW(q.transform(Eigen::VectorXd::Zero(4)), std::invalid_argument);
+}
+
+TEST(normal_banded_test, factor) {
+  Eigen::MatrixXd L = example().L_chol_precision();
+  Eigen::MatrixXd expected(5, 5);
+  // clang-format off
+  expected << std::exp(-0.42), 0, 0, 0, 0,
+              0.3, std::exp(0.8922), 0, 0, 0,
+              0.2, -0.7, std::exp(0.4), 0, 0,
+              0, -0.1, 0.5, std::exp(-1.1), 0,
+              0, 0, 0.05, 0.6, std::exp(0.2);
+  // clang-format on
+  EXPECT_MATRIX_NEAR(expected, L, 1e-12);
+}
+
+TEST(normal_banded_test, entropy) {
+  stan::variational::normal_banded q = example();
+  Eigen::MatrixXd L_chol = covariance(q).llt().matrixL();
+  stan::variational::normal_fullrank dense(q.mu(), L_chol);
+  EXPECT_FLOAT_EQ(dense.entropy(), q.entropy());
+}
+
+TEST(normal_banded_test, transform) {
+  stan::variational::normal_banded q = example();
+  Eigen::VectorXd eta(5);
+  eta << 7.1, -9.2, 0.59, 1.3, -0.4;
+  Eigen::MatrixXd L = q.L_chol_precision();
+  Eigen::VectorXd expected
+      = q.mu() + L.transpose().triangularView<Eigen::Upper>().solve(eta);
+  EXPECT_MATRIX_NEAR(expected, q.transform(eta), 1e-12);
+  EXPECT_FLOAT_EQ(-0.5 * eta.squaredNorm(), q.calc_log_g(eta));
+}
+
+TEST(normal_banded_test, sample_covariance) {
+  stan::variational::normal_banded q = example();
+  boost::ecuyer1988 rng(1234);
+  const int n = 100000;
+  Eigen::MatrixXd draws(5, n);
+  Eigen::VectorXd eta;
+  double log_g;
+  for (int i = 0; i < n; ++i) {
+    q.sample_log_g(rng, eta, log_g);
+    ASSERT_EQ(5, eta.size());
+    draws.col(i) = eta;
+  }
+  Eigen::VectorXd mean = draws.rowwise().mean();
+  Eigen::MatrixXd centered = draws.colwise() - mean;
+  Eigen::MatrixXd sample_cov = centered * centered.transpose() / (n - 1);
+  Eigen::MatrixXd sigma = covariance(q);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_NEAR(q.mu()(i), mean(i), 0.05);
+    for (int j = 0; j < 5; ++j)
+      EXPECT_NEAR(sigma(i, j), sample_cov(i, j), 0.05 * sigma.norm());
+  }
+}
+
+TEST(normal_banded_test, entropy_gradient) {
+  // with a flat target the gradient is the gradient of the entropy
+  stan::variational::normal_banded q = example();
+  stan::variational::normal_banded grad(5, 2);
+  normal_model model(5, true);
+  Eigen::VectorXd cont_params = q.mu();
+  boost::ecuyer1988 rng(1234);
+  stan::callbacks::logger logger;
+  q.calc_grad(grad, model, cont_params, 10, rng, logger);
+
+  EXPECT_NEAR(0.0, grad.mu().cwiseAbs().maxCoeff(), 1e-12);
+  EXPECT_MATRIX_NEAR(Eigen::VectorXd::Constant(5, -1), grad.omega(), 1e-12);
+  EXPECT_NEAR(0.0, grad.band().cwiseAbs().maxCoeff(), 1e-12);
+}
+
+TEST(normal_banded_test, elbo_gradient) {
+  // for a standard normal target the ELBO is
+  // -0.5 * (mu^T mu + tr Sigma) + entropy, up to a constant, whose
+  // gradient with respect to L is Sigma^2 L from the trace
+  stan::variational::normal_banded q = example();
+  stan::variational::normal_banded grad(5, 2);
+  Eigen::VectorXd cont_params = q.mu();
+  boost::ecuyer1988 rng(1234);
+  stan::callbacks::logger logger;
+  normal_model model(5, false);
+  q.calc_grad(grad, model, cont_params, 100000, rng, logger);
+
+  Eigen::MatrixXd sigma = covariance(q);
+  Eigen::MatrixXd L_grad = sigma * sigma * q.L_chol_precision();
+  EXPECT_MATRIX_NEAR(-q.mu(), grad.mu(), 0.05);
+  for (int i = 0; i < 5; ++i) {
+    const double scale = std::max(1.0, std::abs(L_grad(i, i)));
+    EXPECT_NEAR(L_grad(i, i) * std::exp(q.omega()(i)) - 1, grad.omega()(i),
+                0.05 * scale);
+    for (int k = 0; k < 2; ++k) {
+      if (i > k) {
+        const double g = L_grad(i, i - k - 1);
+        EXPECT_NEAR(g, grad.band()(i, k), 0.05 * std::max(1.0, std::abs(g)));
+      } else {
+        EXPECT_EQ(0.0, grad.band()(i, k));
+      }
+    }
+  }
+}
+
+TEST(normal_banded_test, arithmetic) {
+  stan::variational::normal_banded q = example();
+  stan::variational::normal_banded sum = q + q;
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd(2 * q.band()), sum.band(), 1e-12);
+  stan::variational::normal_banded ratio = sum / q;
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd::Constant(5, 2, 2), ratio.band(), 1e-12);
+  stan::variational::normal_banded scaled = 3.0 * q.square();
+  EXPECT_MATRIX_NEAR(Eigen::VectorXd(3 * q.omega().array().square()),
+                     scaled.omega(), 1e-12);
+  stan::variational::normal_banded shifted = 1.0 + q.square().sqrt();
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd(1 + q.band().array().abs()),
+                     shifted.band(), 1e-12);
+}
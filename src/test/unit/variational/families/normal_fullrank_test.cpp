@@ -1,8 +1,29 @@
 #include <stan/variational/families/normal_fullrank.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <boost/random/additive_combine.hpp>
 #include <vector>
 #include <gtest/gtest.h>
 #include <test/unit/util.hpp>
 
+namespace {
+// standard normal target
+class normal_model : public stan::model::prob_grad {
+ public:
+  explicit normal_model(size_t num_params_r)
+      : stan::model::prob_grad(num_params_r) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    T lp = 0;
+    for (int i = 0; i < params_r.size(); ++i)
+      lp -= 0.5 * params_r(i) * params_r(i);
+    return lp;
+  }
+};
+}  // namespace
+
 TEST(normal_fullrank_test, zero_init) {
   int my_dimension = 10;
 
@@ -157,3 +178,100 @@ TEST(normal_fullrank_test, calc_log_g) {
 
   EXPECT_FLOAT_EQ(log_g_out, log_g_true);
 }
+
+TEST(normal_fullrank_test, in_place_updates) {
+  Eigen::Vector3d mu;
+  mu << 5.7, -3.2, 0.1332;
+  Eigen::Matrix3d L;
+  L << 1.3, 0, 0, 2.1, -0.7, 0, 0.2, 0.5, 1.1;
+  stan::variational::normal_fullrank q(mu, L);
+  stan::variational::normal_fullrank grad(Eigen::VectorXd(-mu),
+                                          Eigen::MatrixXd(0.5 * L));
+  stan::variational::normal_fullrank history(
+      Eigen::VectorXd(mu.cwiseAbs()), Eigen::MatrixXd(L.cwiseAbs()));
+
+  stan::variational::normal_fullrank expected_history
+      = 0.9 * history + 0.1 * grad.square();
+  history.add_square(grad, 0.9, 0.1);
+  EXPECT_MATRIX_NEAR(expected_history.mu(), history.mu(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected_history.L_chol(), history.L_chol(), 1e-14);
+
+  stan::variational::normal_fullrank expected
+      = q + 0.3 * grad / (1.0 + history.sqrt());
+  q.add_adagrad_step(0.3, grad, history, 1.0);
+  EXPECT_MATRIX_NEAR(expected.mu(), q.mu(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected.L_chol(), q.L_chol(), 1e-14);
+
+  Eigen::Vector3d x;
+  x << 7.1, -9.2, 0.59;
+  Eigen::VectorXd zeta(3);
+  q.transform_into(x, zeta);
+  EXPECT_MATRIX_NEAR(q.transform(x), zeta, 1e-14);
+
+  stan::variational::normal_fullrank other(4);
+  EXPECT_THROW(history.add_square(other, 0.9, 0.1), std::invalid_argument);
+  EXPECT_THROW(q.add_adagrad_step(0.3, other, history, 1.0),
+               std::invalid_argument);
+}
+
+TEST(normal_fullrank_test, sticking_the_landing) {
+  normal_model model(3);
+  stan::callbacks::logger logger;
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Zero(3);
+  stan::variational::normal_fullrank grad(3);
+
+  // at the target every draw of the estimator is zero
+  stan::variational::normal_fullrank target(cont_params);
+  target.set_sticking_the_landing(true);
+  EXPECT_TRUE(target.sticking_the_landing());
+  boost::ecuyer1988 rng(1234);
+  target.calc_grad(grad, model, cont_params, 5, rng, logger);
+  EXPECT_NEAR(0, grad.mu().cwiseAbs().maxCoeff(), 1e-5);
+  EXPECT_NEAR(0, grad.L_chol().cwiseAbs().maxCoeff(), 1e-5);
+  target.set_sticking_the_landing(false);
+  target.calc_grad(grad, model, cont_params, 5, rng, logger);
+  EXPECT_GT(grad.L_chol().cwiseAbs().maxCoeff(), 1e-3);
+
+  // elsewhere it has the expectation of the default estimator
+  Eigen::VectorXd mu(3);
+  mu << 0.7, -1.2, 0.3;
+  Eigen::MatrixXd L_chol(3, 3);
+  L_chol << 0.9, 0, 0, 0.3, 1.2, 0, -0.2, 0.4, 0.7;
+  stan::variational::normal_fullrank q(mu, L_chol);
+  stan::variational::normal_fullrank expected(3);
+  q.calc_grad(expected, model, cont_params, 100000, rng, logger);
+  stan::variational::normal_fullrank copy = q;
+  copy.set_sticking_the_landing(true);
+  stan::variational::normal_fullrank copy_of_copy = copy;
+  EXPECT_TRUE(copy_of_copy.sticking_the_landing());
+  copy_of_copy.calc_grad(grad, model, cont_params, 100000, rng, logger);
+  EXPECT_MATRIX_NEAR(expected.mu(), grad.mu(), 0.03);
+  EXPECT_MATRIX_NEAR(expected.L_chol(), grad.L_chol(), 0.03);
+}
+
+TEST(normal_fullrank_test, quasi_monte_carlo) {
+  // for a standard normal target the gradient of mu is -mu
+  normal_model model(3);
+  stan::callbacks::logger logger;
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Zero(3);
+  Eigen::VectorXd mu(3);
+  mu << 0.7, -1.2, 0.3;
+  Eigen::MatrixXd L_chol(3, 3);
+  L_chol << 0.9, 0, 0, 0.3, 1.2, 0, -0.2, 0.4, 0.7;
+  stan::variational::normal_fullrank q(mu, L_chol);
+  stan::variational::normal_fullrank qmc = q;
+  qmc.set_quasi_monte_carlo(true);
+  EXPECT_TRUE(qmc.quasi_monte_carlo());
+  EXPECT_FALSE(q.quasi_monte_carlo());
+  stan::variational::normal_fullrank grad(3);
+  boost::ecuyer1988 rng(1234);
+  double mc_error = 0;
+  double qmc_error = 0;
+  for (int n = 0; n < 50; ++n) {
+    q.calc_grad(grad, model, cont_params, 64, rng, logger);
+    mc_error += (grad.mu() + mu).squaredNorm();
+    qmc.calc_grad(grad, model, cont_params, 64, rng, logger);
+    qmc_error += (grad.mu() + mu).squaredNorm();
+  }
+  EXPECT_LT(qmc_error, 0.25 * mc_error);
+}
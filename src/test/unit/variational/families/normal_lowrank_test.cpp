@@ -0,0 +1,245 @@
+#include <stan/variational/families/normal_lowrank.hpp>
+#include <stan/variational/families/normal_fullrank.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <gtest/gtest.h>
+#include <test/unit/util.hpp>
+#include <limits>
+#include <vector>
+
+namespace {
+// standard normal target, or a flat one whose gradient is zero
+class normal_model : public stan::model::prob_grad {
+ public:
+  normal_model(size_t num_params_r, bool flat)
+      : stan::model::prob_grad(num_params_r), flat_(flat) {}
+
+  template <bool propto, bool jacobian_adjust_transforms, typename T>
+  T log_prob(Eigen::Matrix<T, Eigen::Dynamic, 1>& params_r,
+             std::ostream* output_stream = 0) const {
+    T lp = 0;
+    if (!flat_)
+      for (int i = 0; i < params_r.size(); ++i)
+        lp -= 0.5 * params_r(i) * params_r(i);
+    return lp;
+  }
+
+ private:
+  bool flat_;
+};
+
+stan::variational::normal_lowrank example() {
+  Eigen::VectorXd mu(4);
+  mu << 5.7, -3.2, 0.1332, 1.0;
+  Eigen::VectorXd omega(4);
+  omega << -0.42, 0.8922, 0.4, -1.1;
+  Eigen::MatrixXd B(4, 2);
+  B << 0.9, -0.3, 0.2, 1.4, -0.7, 0.05, 0.3, 0.6;
+  return stan::variational::normal_lowrank(mu, omega, B);
+}
+
+Eigen::MatrixXd covariance(const stan::variational::normal_lowrank& q) {
+  Eigen::MatrixXd sigma = q.B() * q.B().transpose();
+  sigma.diagonal().array() += (2 * q.omega()).array().exp();
+  return sigma;
+}
+}  // namespace
+
+TEST(normal_lowrank_test, zero_init) {
+  stan::variational::normal_lowrank q(10, 3);
+  EXPECT_EQ(10, q.dimension());
+  EXPECT_EQ(3, q.rank());
+  EXPECT_EQ(13, q.draw_dimension());
+  EXPECT_EQ(0.0, q.mu().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.omega().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.B().cwiseAbs().maxCoeff());
+  EXPECT_EQ(3, q.B().cols());
+}
+
+TEST(normal_lowrank_test, cont_params_init) {
+  Eigen::VectorXd cont_params = Eigen::VectorXd::LinSpaced(5, -1, 1);
+  stan::variational::normal_lowrank q(cont_params, 2);
+  EXPECT_MATRIX_EQ(cont_params, q.mean());
+  EXPECT_EQ(0.0, q.omega().cwiseAbs().maxCoeff());
+  EXPECT_MATRIX_EQ(Eigen::MatrixXd(0.1 * Eigen::MatrixXd::Identity(5, 2)),
+                   q.B());
+
+  q.set_to_zero();
+  EXPECT_EQ(0.0, q.mu().cwiseAbs().maxCoeff());
+  EXPECT_EQ(0.0, q.B().cwiseAbs().maxCoeff());
+}
+
+TEST(normal_lowrank_test, validation) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  stan::variational::normal_lowrank q = example();
+  Eigen::VectorXd v = Eigen::VectorXd::Zero(4);
+  Eigen::MatrixXd B = Eigen::MatrixXd::Zero(4, 2);
+  EXPECT_THROW(q.set_mu(Eigen::VectorXd::Constant(4, nan)), std::domain_error);
+  EXPECT_THROW(q.set_mu(Eigen::VectorXd::Zero(3)), std::invalid_argument);
+  EXPECT_THROW(q.set_omega(Eigen::VectorXd::Constant(4, nan)),
+               std::domain_error);
+  EXPECT_THROW(q.set_B(Eigen::MatrixXd::Zero(4, 3)), std::invalid_argument);
+  EXPECT_THROW(q.set_B(Eigen::MatrixXd::Constant(4, 2, nan)),
+               std::domain_error);
+  Eigen::VectorXd short_omega = Eigen::VectorXd::Zero(3);
+  EXPECT_THROW(stan::variational::normal_lowrank(v, short_omega, B),
+               std::invalid_argument);
+  EXPECT_THROW(q = stan::variational::normal_lowrank(4, 1),
+               std::invalid_argument);
+  EXPECT_THROW(q.transform(Eigen::VectorXd::Zero(4)), std::invalid_argument);
+}
+
+TEST(normal_lowrank_test, entropy) {
+  stan::variational::normal_lowrank q = example();
+  Eigen::MatrixXd L_chol = covariance(q).llt().matrixL();
+  stan::variational::normal_fullrank dense(q.mu(), L_chol);
+  EXPECT_FLOAT_EQ(dense.entropy(), q.entropy());
+}
+
+TEST(normal_lowrank_test, transform) {
+  stan::variational::normal_lowrank q = example();
+  Eigen::VectorXd eta(6);
+  eta << 7.1, -9.2, 0.59, 1.3, -0.4, 2.2;
+  Eigen::VectorXd expected
+      = q.mu() + q.omega().array().exp().matrix().cwiseProduct(eta.head(4))
+        + q.B() * eta.tail(2);
+  EXPECT_MATRIX_NEAR(expected, q.transform(eta), 1e-12);
+  EXPECT_FLOAT_EQ(-0.5 * eta.squaredNorm(), q.calc_log_g(eta));
+}
+
+TEST(normal_lowrank_test, sample_covariance) {
+  stan::variational::normal_lowrank q = example();
+  boost::ecuyer1988 rng(1234);
+  const int n = 100000;
+  Eigen::MatrixXd draws(4, n);
+  Eigen::VectorXd eta;
+  double log_g;
+  for (int i = 0; i < n; ++i) {
+    q.sample_log_g(rng, eta, log_g);
+    ASSERT_EQ(4, eta.size());
+    draws.col(i) = eta;
+  }
+  Eigen::VectorXd mean = draws.rowwise().mean();
+  Eigen::MatrixXd centered = draws.colwise() - mean;
+  Eigen::MatrixXd sample_cov = centered * centered.transpose() / (n - 1);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(q.mu()(i), mean(i), 0.02);
+    for (int j = 0; j < 4; ++j)
+      EXPECT_NEAR(covariance(q)(i, j), sample_cov(i, j), 0.05);
+  }
+}
+
+TEST(normal_lowrank_test, entropy_gradient) {
+  // with a flat target the gradient is the gradient of the entropy
+  stan::variational::normal_lowrank q = example();
+  stan::variational::normal_lowrank grad(4, 2);
+  normal_model model(4, true);
+  Eigen::VectorXd cont_params = q.mu();
+  boost::ecuyer1988 rng(1234);
+  stan::callbacks::logger logger;
+  q.calc_grad(grad, model, cont_params, 10, rng, logger);
+
+  const double h = 1e-6;
+  EXPECT_NEAR(0.0, grad.mu().cwiseAbs().maxCoeff(), 1e-12);
+  for (int i = 0; i < 4; ++i) {
+    Eigen::VectorXd omega = q.omega();
+    omega(i) += h;
+    stan::variational::normal_lowrank up(q.mu(), omega, q.B());
+    omega(i) -= 2 * h;
+    stan::variational::normal_lowrank down(q.mu(), omega, q.B());
+    EXPECT_NEAR((up.entropy() - down.entropy()) / (2 * h), grad.omega()(i),
+                1e-6);
+    for (int j = 0; j < 2; ++j) {
+      Eigen::MatrixXd B = q.B();
+      B(i, j) += h;
+      stan::variational::normal_lowrank up(q.mu(), q.omega(), B);
+      B(i, j) -= 2 * h;
+      stan::variational::normal_lowrank down(q.mu(), q.omega(), B);
+      EXPECT_NEAR((up.entropy() - down.entropy()) / (2 * h), grad.B()(i, j),
+                  1e-6);
+    }
+  }
+}
+
+TEST(normal_lowrank_test, elbo_gradient) {
+  // for a standard normal target the ELBO is
+  // -0.5 * (mu^T mu + tr Sigma) + entropy, up to a constant
+  stan::variational::normal_lowrank q = example();
+  stan::variational::normal_lowrank grad(4, 2);
+  stan::variational::normal_lowrank entropy_grad(4, 2);
+  Eigen::VectorXd cont_params = q.mu();
+  boost::ecuyer1988 rng(1234);
+  stan::callbacks::logger logger;
+  normal_model flat(4, true);
+  q.calc_grad(entropy_grad, flat, cont_params, 1, rng, logger);
+  normal_model model(4, false);
+  q.calc_grad(grad, model, cont_params, 100000, rng, logger);
+
+  Eigen::VectorXd var = (2 * q.omega()).array().exp();
+  EXPECT_MATRIX_NEAR(-q.mu(), grad.mu(), 0.05);
+  EXPECT_MATRIX_NEAR(Eigen::VectorXd(entropy_grad.omega() - var),
+                     grad.omega(), 0.05);
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd(entropy_grad.B() - q.B()), grad.B(),
+                     0.05);
+}
+
+TEST(normal_lowrank_test, arithmetic) {
+  stan::variational::normal_lowrank q = example();
+  stan::variational::normal_lowrank sum = q + q;
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd(2 * q.B()), sum.B(), 1e-12);
+  stan::variational::normal_lowrank ratio = sum / q;
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd::Constant(4, 2, 2), ratio.B(), 1e-12);
+  stan::variational::normal_lowrank scaled = 3.0 * q.square();
+  EXPECT_MATRIX_NEAR(Eigen::VectorXd(3 * q.omega().array().square()),
+                     scaled.omega(), 1e-12);
+  stan::variational::normal_lowrank shifted = 1.0 + q.square().sqrt();
+  EXPECT_MATRIX_NEAR(Eigen::MatrixXd(1 + q.B().array().abs()), shifted.B(),
+                     1e-12);
+}
+
+TEST(normal_lowrank_test, in_place_updates) {
+  stan::variational::normal_lowrank q = example();
+  stan::variational::normal_lowrank grad(Eigen::VectorXd(-q.mu()),
+                                         Eigen::VectorXd(0.5 * q.omega()),
+                                         Eigen::MatrixXd(2 * q.B()));
+  stan::variational::normal_lowrank history = q.square().sqrt();
+
+  stan::variational::normal_lowrank expected_history
+      = 0.9 * history + 0.1 * grad.square();
+  history.add_square(grad, 0.9, 0.1);
+  EXPECT_MATRIX_NEAR(expected_history.mu(), history.mu(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected_history.omega(), history.omega(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected_history.B(), history.B(), 1e-14);
+
+  stan::variational::normal_lowrank expected
+      = q + 0.3 * grad / (1.0 + history.sqrt());
+  q.add_adagrad_step(0.3, grad, history, 1.0);
+  EXPECT_MATRIX_NEAR(expected.mu(), q.mu(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected.omega(), q.omega(), 1e-14);
+  EXPECT_MATRIX_NEAR(expected.B(), q.B(), 1e-14);
+
+  stan::variational::normal_lowrank other(4, 1);
+  EXPECT_THROW(history.add_square(other, 0.9, 0.1), std::invalid_argument);
+}
+
+TEST(normal_lowrank_test, repeated_gradients) {
+  // the workspace kept between calls gives the result of a fresh copy
+  stan::variational::normal_lowrank q = example();
+  stan::variational::normal_lowrank grad(4, 2);
+  stan::variational::normal_lowrank fresh_grad(4, 2);
+  normal_model model(4, false);
+  Eigen::VectorXd cont_params = q.mu();
+  stan::callbacks::logger logger;
+  boost::ecuyer1988 rng(1234);
+  q.calc_grad(grad, model, cont_params, 10, rng, logger);
+  q.calc_grad(grad, model, cont_params, 10, rng, logger);
+  boost::ecuyer1988 fresh_rng(1234);
+  stan::variational::normal_lowrank copy = q;
+  copy.calc_grad(fresh_grad, model, cont_params, 10, fresh_rng, logger);
+  stan::variational::normal_lowrank(q).calc_grad(
+      fresh_grad, model, cont_params, 10, fresh_rng, logger);
+  EXPECT_MATRIX_EQ(fresh_grad.mu(), grad.mu());
+  EXPECT_MATRIX_EQ(fresh_grad.omega(), grad.omega());
+  EXPECT_MATRIX_EQ(fresh_grad.B(), grad.B());
+}
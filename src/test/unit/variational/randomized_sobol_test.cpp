@@ -0,0 +1,88 @@
+#include <stan/variational/randomized_sobol.hpp>
+#include <boost/random/additive_combine.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+TEST(randomized_sobol_test, standard_normal_points) {
+  boost::ecuyer1988 rng(1234);
+  stan::variational::randomized_sobol sobol(4, rng);
+  EXPECT_EQ(4, sobol.dimension());
+  Eigen::VectorXd eta(4);
+  Eigen::VectorXd sum = Eigen::VectorXd::Zero(4);
+  Eigen::VectorXd sum_squares = Eigen::VectorXd::Zero(4);
+  const int n = 1024;
+  for (int i = 0; i < n; ++i) {
+    sobol.fill(rng, eta);
+    ASSERT_TRUE(eta.allFinite());
+    sum += eta;
+    sum_squares += eta.cwiseAbs2();
+  }
+  for (int d = 0; d < 4; ++d) {
+    EXPECT_NEAR(0, sum(d) / n, 0.01);
+    EXPECT_NEAR(1, sum_squares(d) / n, 0.02);
+  }
+}
+
+TEST(randomized_sobol_test, shift_from_rng) {
+  boost::ecuyer1988 rng(1234);
+  boost::ecuyer1988 same_rng(1234);
+  stan::variational::randomized_sobol sobol(3, rng);
+  stan::variational::randomized_sobol same(3, same_rng);
+  stan::variational::randomized_sobol other(3, rng);
+  Eigen::VectorXd eta(3);
+  Eigen::VectorXd same_eta(3);
+  Eigen::VectorXd other_eta(3);
+  for (int i = 0; i < 8; ++i) {
+    sobol.fill(rng, eta);
+    same.fill(same_rng, same_eta);
+    other.fill(rng, other_eta);
+    for (int d = 0; d < 3; ++d) {
+      EXPECT_EQ(eta(d), same_eta(d));
+      EXPECT_NE(eta(d), other_eta(d));
+    }
+  }
+}
+
+TEST(randomized_sobol_test, lower_variance) {
+  // variance of the mean of 64 points, over randomizations
+  boost::ecuyer1988 rng(1234);
+  Eigen::VectorXd eta(2);
+  double sum_squares = 0;
+  const int n_shifts = 200;
+  for (int s = 0; s < n_shifts; ++s) {
+    stan::variational::randomized_sobol sobol(2, rng);
+    double sum = 0;
+    for (int i = 0; i < 64; ++i) {
+      sobol.fill(rng, eta);
+      sum += eta(0) + eta(1);
+    }
+    sum_squares += std::pow(sum / 64, 2);
+  }
+  // independent draws give 2 / 64
+  EXPECT_LT(sum_squares / n_shifts, 0.25 * 2.0 / 64);
+}
+
+TEST(randomized_sobol_test, beyond_tables) {
+  boost::ecuyer1988 rng(1234);
+  const int max_dimension
+      = stan::variational::randomized_sobol::max_dimension();
+  EXPECT_GT(max_dimension, 1000);
+  stan::variational::randomized_sobol sobol(max_dimension + 3, rng);
+  Eigen::VectorXd eta(max_dimension + 3);
+  sobol.fill(rng, eta);
+  EXPECT_TRUE(eta.allFinite());
+  Eigen::VectorXd next = eta;
+  sobol.fill(rng, next);
+  EXPECT_NE(eta(max_dimension + 2), next(max_dimension + 2));
+}
+
+TEST(randomized_sobol_test, empty_and_wrong_size) {
+  boost::ecuyer1988 rng(1234);
+  stan::variational::randomized_sobol empty(0, rng);
+  Eigen::VectorXd eta(0);
+  EXPECT_NO_THROW(empty.fill(rng, eta));
+  stan::variational::randomized_sobol sobol(3, rng);
+  Eigen::VectorXd wrong(2);
+  EXPECT_THROW(sobol.fill(rng, wrong), std::invalid_argument);
+}
@@ -0,0 +1,56 @@
+#include <stan/variational/rolling_window.hpp>
+#include <gtest/gtest.h>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace {
+double naive_median(const std::deque<double>& window) {
+  std::vector<double> v(window.begin(), window.end());
+  size_t n = v.size() / 2;
+  std::nth_element(v.begin(), v.begin() + n, v.end());
+  return v[n];
+}
+}  // namespace
+
+TEST(rolling_window_test, matches_naive_statistics) {
+  boost::mt19937 rng(1234);
+  boost::random::uniform_real_distribution<double> unif(-1.0, 1.0);
+  for (size_t capacity : {1, 2, 5, 16}) {
+    stan::variational::rolling_window window(capacity);
+    EXPECT_EQ(capacity, window.capacity());
+    std::deque<double> expected;
+    for (int i = 0; i < 100; ++i) {
+      // repeated values exercise ties between the two halves
+      double x = (i % 7 == 0) ? 0.25 : unif(rng);
+      window.push_back(x);
+      expected.push_back(x);
+      if (expected.size() > capacity)
+        expected.pop_front();
+      ASSERT_EQ(expected.size(), window.size());
+      EXPECT_EQ(naive_median(expected), window.median());
+      EXPECT_NEAR(std::accumulate(expected.begin(), expected.end(), 0.0)
+                      / expected.size(),
+                  window.mean(), 1e-12);
+    }
+  }
+}
+
+TEST(rolling_window_test, recovers_after_huge_values) {
+  // the first relative ELBO difference is against -max(), so it is huge
+  stan::variational::rolling_window window(3);
+  window.push_back(std::numeric_limits<double>::infinity());
+  window.push_back(1e300);
+  window.push_back(0.5);
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), window.mean());
+  EXPECT_EQ(1e300, window.median());
+  window.push_back(0.25);
+  window.push_back(0.75);
+  window.push_back(1.0);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, window.mean());
+  EXPECT_EQ(0.75, window.median());
+}